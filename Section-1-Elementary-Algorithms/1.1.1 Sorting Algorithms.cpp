@@ -13,13 +13,52 @@ sorting algorithms can be concisely implemented in C++.
 
 */
 
-#include <algorithm>  // std::copy(), std::swap()
+#include <algorithm>  // std::copy(), std::fill(), std::max(), std::min(), ...
+#include <cstdio>  // std::fopen(), std::fwrite(), std::remove(), std::snprintf()
+#include <cstring>  // std::memcpy()
 #include <functional>  // std::less
 #include <iterator>  // std::iterator_traits
+#include <string>
 #include <vector>
 
 /*
 
+Insertion sort grows a sorted prefix of the range one element at a time,
+shifting each new element left until it is no longer less than its predecessor.
+Although quadratic in general, it has very little overhead and runs in linear
+time on nearly sorted input. This makes it the fastest choice for small ranges,
+so both quicksort() and mergesort() below hand their subranges of at most the
+given cutoff length off to it instead of dividing them any further.
+
+Time Complexity (Average): O(n^2).
+Time Complexity (Worst): O(n^2).
+Space Complexity: O(1) auxiliary.
+Stable?: Yes.
+
+*/
+
+template<class It, class Compare>
+void insertion_sort(It lo, It hi, Compare comp) {
+  if (hi - lo < 2)
+    return;
+  typedef typename std::iterator_traits<It>::value_type T;
+  for (It i = lo + 1; i < hi; ++i) {
+    T tmp = *i;
+    It j = i;
+    for (; j > lo && comp(tmp, *(j - 1)); --j) {
+      *j = *(j - 1);
+    }
+    *j = tmp;
+  }
+}
+
+template<class It> void insertion_sort(It lo, It hi) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  insertion_sort(lo, hi, std::less<T>());
+}
+
+/*
+
 Quicksort repeatedly selects a pivot and partitions the range so that elements
 comparing less than the pivot precedes the pivot, and elements comparing greater
 or equal follows it. Divide and conquer is then applied to both sides of the
@@ -32,6 +71,11 @@ to be sorted. To reduce the likelihood of encountering the worst case, the pivot
 can be chosen in better ways (e.g. randomly, or using the "median of three"
 technique).
 
+Only the smaller side of each partition is sorted recursively, while the larger
+side is handled by the next iteration of the loop. This bounds the recursion
+depth by O(log n) even in the worst case. Subranges with a length of at most
+cutoff (a positive integer) are finished with insertion sort.
+
 Time Complexity (Average): O(n log n).
 Time Complexity (Worst): O(n^2).
 Space Complexity: O(log n) auxiliary.
@@ -40,23 +84,29 @@ Stable?: No.
 */
 
 template<class It, class Compare>
-void quicksort(It lo, It hi, Compare comp) {
-  if (hi - lo < 2)
-    return;
+void quicksort(It lo, It hi, Compare comp, int cutoff = 16) {
   typedef typename std::iterator_traits<It>::value_type T;
-  T pivot = *(lo + (hi - lo)/2);
-  It i, j;
-  for (i = lo, j = hi - 1; ; ++i, --j) {
-    while (comp(*i, pivot))
-      ++i;
-    while (comp(pivot, *j))
-      --j;
-    if (i >= j)
-      break;
-    std::swap(*i, *j);
+  while (hi - lo > cutoff && hi - lo > 1) {
+    T pivot = *(lo + (hi - lo)/2);
+    It i, j;
+    for (i = lo, j = hi - 1; ; ++i, --j) {
+      while (comp(*i, pivot))
+        ++i;
+      while (comp(pivot, *j))
+        --j;
+      if (i >= j)
+        break;
+      std::swap(*i, *j);
+    }
+    if (i - lo < hi - i) {
+      quicksort(lo, i, comp, cutoff);
+      lo = i;
+    } else {
+      quicksort(i, hi, comp, cutoff);
+      hi = i;
+    }
   }
-  quicksort(lo, i, comp);
-  quicksort(i, hi, comp);
+  insertion_sort(lo, hi, comp);
 }
 
 template<class It> void quicksort(It lo, It hi) {
@@ -77,6 +127,11 @@ that the implementation here requires sufficient memory to be available. When
 O(n) auxiliary memory is not available, std::stable_sort() falls back to a time
 complexity of O(n log^2 n) but the implementation here will simply fail.
 
+A single buffer of n/2 elements is allocated up front and shared by every merge,
+into which only the left half is copied before being merged back. Merging is
+skipped entirely if the two halves are already in order, and sublists with a
+length of at most cutoff are sorted with insertion sort.
+
 Time Complexity (Average): O(n log n).
 Time Complexity (Worst): O(n log n).
 Space Complexity: O(n) auxiliary.
@@ -84,29 +139,30 @@ Stable?: Yes.
 
 */
 
+template<class It, class T, class Compare>
+void mergesort(It lo, It hi, T *buf, Compare comp, int cutoff) {
+  if (hi - lo <= cutoff || hi - lo < 2) {
+    insertion_sort(lo, hi, comp);
+    return;
+  }
+  It mid = lo + (hi - lo)/2, c = mid, out = lo;
+  mergesort(lo, mid, buf, comp, cutoff);
+  mergesort(mid, hi, buf, comp, cutoff);
+  if (!comp(*mid, *(mid - 1)))
+    return;
+  T *a = buf, *end = std::copy(lo, mid, buf);
+  while (a != end && c != hi)
+    *out++ = comp(*c, *a) ? *c++ : *a++;
+  std::copy(a, end, out);
+}
+
 template<class It, class Compare>
-void mergesort(It lo, It hi, Compare comp) {
+void mergesort(It lo, It hi, Compare comp, int cutoff = 16) {
   if (hi - lo < 2)
     return;
-  It mid = lo + (hi - lo - 1)/2, a = lo, c = mid + 1;
-  mergesort(lo, mid + 1, comp);
-  mergesort(mid + 1, hi, comp);
   typedef typename std::iterator_traits<It>::value_type T;
-  std::vector<T> merged;
-  while (a <= mid && c < hi)
-    merged.push_back(comp(*c, *a) ? *c++ : *a++);
-  if (a > mid) {
-    for (It k = c; k < hi; ++k) {
-      merged.push_back(*k);
-    }
-  } else {
-    for (It k = a; k <= mid; ++k) {
-      merged.push_back(*k);
-    }
-  }
-  for (int i = 0; i < hi - lo; i++) {
-    *(lo + i) = merged[i];
-  }
+  std::vector<T> buf((hi - lo + 1)/2);
+  mergesort(lo, hi, &buf[0], comp, cutoff);
 }
 
 template<class It> void mergesort(It lo, It hi) {
@@ -168,6 +224,123 @@ template<class It> void heapsort(It lo, It hi) {
 
 /*
 
+Introsort begins as quicksort, but switches to heapsort once too many bad
+partitions have been encountered so that the worst case is O(n log n). This
+implementation also borrows several ideas from pattern-defeating quicksort
+(pdqsort) to perform well on inputs that commonly trigger quadratic behavior in
+quicksort():
+
+- The pivot is the median of three elements for small ranges, or the "ninther"
+  (median of the medians of three triples) for larger ones. This handles sorted,
+  reversed, and organ-pipe inputs without degrading.
+- A partition is bad if either side has less than 1/8 of the elements. After
+  each bad partition, a few elements on either side are swapped to break up any
+  pattern in the input. After log2(n) bad partitions, heapsort takes over.
+- Partitioning is done branchlessly, unconditionally swapping each element into
+  place and advancing the boundary by the result of the comparison. This avoids
+  the branch mispredictions that dominate partitioning random data.
+- If the pivot is equal to the element just before the range (which must be a
+  previous pivot that is no greater than anything in the range), all elements
+  equal to the pivot are gathered on the left and never revisited. Ranges with
+  many duplicates are thus sorted in O(n log k) for k distinct values.
+- Ranges with a length of at most 16 are finished with insertion sort.
+
+Time Complexity (Average): O(n log n).
+Time Complexity (Worst): O(n log n).
+Space Complexity: O(log n) auxiliary.
+Stable?: No.
+
+*/
+
+template<class It, class Compare>
+void sort3(It a, It b, It c, Compare comp) {
+  if (comp(*b, *a))
+    std::swap(*a, *b);
+  if (comp(*c, *b))
+    std::swap(*b, *c);
+  if (comp(*b, *a))
+    std::swap(*a, *b);
+}
+
+template<class It, class Compare>
+void introsort(It lo, It hi, Compare comp, int bad_allowed, bool leftmost) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  while (hi - lo > 16) {
+    int n = hi - lo;
+    It mid = lo + n/2, i = lo + 1;
+    if (n > 128) {
+      sort3(lo, mid, hi - 1, comp);
+      sort3(lo + 1, mid - 1, hi - 2, comp);
+      sort3(lo + 2, mid + 1, hi - 3, comp);
+      sort3(mid - 1, mid, mid + 1, comp);
+    } else {
+      sort3(lo, mid, hi - 1, comp);
+    }
+    std::swap(*lo, *mid);
+    T pivot = *lo, tmp;
+    if (!leftmost && !comp(*(lo - 1), pivot)) {
+      for (It j = lo + 1; j < hi; ++j) {
+        bool not_greater = !comp(pivot, *j);
+        tmp = *j;
+        *j = *i;
+        *i = tmp;
+        i += not_greater;
+      }
+      lo = i;
+      continue;
+    }
+    for (It j = lo + 1; j < hi; ++j) {
+      bool is_less = comp(*j, pivot);
+      tmp = *j;
+      *j = *i;
+      *i = tmp;
+      i += is_less;
+    }
+    It p = i - 1;
+    std::swap(*lo, *p);
+    int l = p - lo, r = hi - p - 1;
+    if (l < n/8 || r < n/8) {
+      if (--bad_allowed == 0) {
+        heapsort(lo, hi, comp);
+        return;
+      }
+      if (l >= 16) {
+        std::swap(*lo, *(lo + l/4));
+        std::swap(*(p - 1), *(p - l/4));
+      }
+      if (r >= 16) {
+        std::swap(*(p + 1), *(p + 1 + r/4));
+        std::swap(*(hi - 1), *(hi - r/4));
+      }
+    }
+    if (l < r) {
+      introsort(lo, p, comp, bad_allowed, leftmost);
+      lo = p + 1;
+      leftmost = false;
+    } else {
+      introsort(p + 1, hi, comp, bad_allowed, false);
+      hi = p;
+    }
+  }
+  insertion_sort(lo, hi, comp);
+}
+
+template<class It, class Compare>
+void introsort(It lo, It hi, Compare comp) {
+  int bad_allowed = 1;
+  for (int n = hi - lo; n > 1; n >>= 1) {
+    bad_allowed++;
+  }
+  introsort(lo, hi, comp, bad_allowed, true);
+}
+
+template<class It> void introsort(It lo, It hi) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  introsort(lo, hi, std::less<T>());
+}
+
+/*
+
 Comb sort is an improved bubble sort. While bubble sort increments the gap
 between swapped elements for every inner loop iteration, comb sort fixes the gap
 size in the inner loop, decreasing it by a particular shrink factor in every
@@ -260,26 +433,367 @@ void radix_sort(UnsignedIt lo, UnsignedIt hi) {
   delete[] buf;
 }
 
+/*
+
+Radix Sort (Keyed)
+
+This version sorts a range of arbitrary elements by an unsigned integer key of
+at most 64 bits, as computed by the given function object key(). The helper
+functions radix_key() map signed integers and IEEE 754 floating point values to
+unsigned keys that compare in the same order by flipping their sign bits (and
+for negative floating point values, all of their other bits as well). The sort
+is stable, so records may be sorted by multiple fields by first sorting by the
+least significant field and successively sorting by more significant fields.
+
+Keys are computed only once per element and moved alongside them. The digit
+size is chosen adaptively, using 16-bit digits when there are enough elements
+for the larger count table to pay off and 8-bit digits otherwise. Any pass for
+which every element has the same digit is skipped, so that e.g. sorting 64-bit
+keys that only differ in their lowest 20 bits takes at most two passes.
+
+Time Complexity: O(n*w/b) for n keys of w bits each and digits of b bits.
+Space Complexity: O(n + 2^b) auxiliary.
+
+*/
+
+inline unsigned int radix_key(unsigned int x) {
+  return x;
+}
+
+inline unsigned long long radix_key(unsigned long long x) {
+  return x;
+}
+
+inline unsigned int radix_key(int x) {
+  return (unsigned int)x ^ 0x80000000u;
+}
+
+inline unsigned long long radix_key(long long x) {
+  return (unsigned long long)x ^ 0x8000000000000000ull;
+}
+
+inline unsigned int radix_key(float x) {
+  unsigned int u;
+  std::memcpy(&u, &x, sizeof(u));
+  return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+inline unsigned long long radix_key(double x) {
+  unsigned long long u;
+  std::memcpy(&u, &x, sizeof(u));
+  return (u & 0x8000000000000000ull) ? ~u : (u | 0x8000000000000000ull);
+}
+
+struct default_radix_key {
+  template<class T> unsigned long long operator()(const T &x) const {
+    return radix_key(x);
+  }
+};
+
+template<class It, class KeyFunction>
+void radix_sort(It lo, It hi, KeyFunction key) {
+  int n = hi - lo;
+  if (n < 2)
+    return;
+  typedef typename std::iterator_traits<It>::value_type T;
+  std::vector<T> v(lo, hi), vbuf(n);
+  std::vector<unsigned long long> k(n), kbuf(n);
+  unsigned long long diff = 0;
+  for (int i = 0; i < n; i++) {
+    k[i] = key(v[i]);
+    diff |= k[i] ^ k[0];
+  }
+  const int radix_bits = (n < (1 << 17)) ? 8 : 16;
+  const int radix_mask = (1 << radix_bits) - 1;
+  std::vector<int> count(radix_mask + 1);
+  for (int pos = 0; pos < 64 && (diff >> pos) != 0; pos += radix_bits) {
+    if (((diff >> pos) & radix_mask) == 0)
+      continue;
+    std::fill(count.begin(), count.end(), 0);
+    for (int i = 0; i < n; i++) {
+      count[(k[i] >> pos) & radix_mask]++;
+    }
+    for (int i = 0, sum = 0, tmp; i <= radix_mask; i++) {
+      tmp = count[i];
+      count[i] = sum;
+      sum += tmp;
+    }
+    for (int i = 0; i < n; i++) {
+      int j = count[(k[i] >> pos) & radix_mask]++;
+      kbuf[j] = k[i];
+      vbuf[j] = v[i];
+    }
+    k.swap(kbuf);
+    v.swap(vbuf);
+  }
+  std::copy(v.begin(), v.end(), lo);
+}
+
+template<class It> void radix_sort_keys(It lo, It hi) {
+  radix_sort(lo, hi, default_radix_key());
+}
+
+/*
+
+External Merge Sort
+
+Sorts a binary file of fixed-size records (plain old data of type T) that may
+be much larger than the available memory, writing the result to another file.
+The input is read in chunks of at most memory_bytes, each of which is sorted
+with mergesort() and written to a temporary file (a "run") in tmp_dir. Groups
+of up to fan_in runs are then repeatedly merged into longer runs until a single
+run remains, which becomes the output file. Temporary files are removed once
+they have been merged. Like mergesort(), the sort is stable.
+
+Each merge is a k-way merge driven by a loser tree, a tournament tree in which
+every internal node stores the loser of the match played there. Replacing the
+overall winner only requires replaying matches along the path from its leaf to
+the root, taking exactly ceil(log2(k)) comparisons per element. Reads and writes
+go through buffers that evenly split the memory budget. Returns false if any
+file could not be opened, read, or written, or if the name of a temporary file
+would not fit in 4096 characters, in which case all temporary files are still
+removed.
+
+Time Complexity: O(n log n) comparisons, and O(n log_k(n/m)) elements read and
+written to disk, where m is the number of elements fitting in memory_bytes and
+k is fan_in.
+Space Complexity: O(m) auxiliary memory, and O(n) auxiliary disk space.
+
+*/
+
+template<class T> struct run_reader {
+  std::FILE *f;
+  std::vector<T> buf;
+  size_t pos, len;
+
+  run_reader(std::FILE *f, size_t bufsize) : f(f), buf(bufsize), pos(0) {
+    len = std::fread(&buf[0], sizeof(T), buf.size(), f);
+  }
+
+  bool done() const { return pos == len; }
+  const T & head() const { return buf[pos]; }
+
+  void next() {
+    if (++pos == len && len > 0) {
+      len = std::fread(&buf[0], sizeof(T), buf.size(), f);
+      pos = 0;
+    }
+  }
+};
+
+template<class T> struct run_writer {
+  std::FILE *f;
+  std::vector<T> buf;
+  size_t len;
+  bool ok;  // Whether every write so far has succeeded.
+
+  run_writer(std::FILE *f, size_t bufsize)
+      : f(f), buf(bufsize), len(0), ok(true) {}
+  ~run_writer() { flush(); }
+
+  void flush() {
+    if (len > 0 && std::fwrite(&buf[0], sizeof(T), len, f) != len)
+      ok = false;
+    len = 0;
+  }
+
+  void push(const T &x) {
+    if (len == buf.size())
+      flush();
+    buf[len++] = x;
+  }
+};
+
+template<class T, class Compare>
+struct loser_tree {
+  std::vector<run_reader<T> *> &src;
+  std::vector<int> tree;
+  Compare comp;
+  int k;
+
+  // Whether source a should be output before source b (ties by index).
+  bool beats(int a, int b) const {
+    if (src[a]->done() || src[b]->done())
+      return !src[a]->done();
+    if (comp(src[a]->head(), src[b]->head()))
+      return true;
+    return !comp(src[b]->head(), src[a]->head()) && a < b;
+  }
+
+  loser_tree(std::vector<run_reader<T> *> &src, Compare comp)
+      : src(src), tree(src.size()), comp(comp), k(src.size()) {
+    std::vector<int> win(2*k);
+    for (int i = 0; i < k; i++) {
+      win[k + i] = i;
+    }
+    for (int t = k - 1; t > 0; t--) {
+      int a = win[2*t], b = win[2*t + 1];
+      win[t] = beats(a, b) ? a : b;
+      tree[t] = beats(a, b) ? b : a;
+    }
+    tree[0] = win[1];
+  }
+
+  bool done() const { return src[tree[0]]->done(); }
+  const T & top() const { return src[tree[0]]->head(); }
+
+  void pop() {
+    int w = tree[0];
+    src[w]->next();
+    for (int t = (w + k)/2; t > 0; t /= 2) {
+      if (beats(tree[t], w))
+        std::swap(tree[t], w);
+    }
+    tree[0] = w;
+  }
+};
+
+// Writes the name of temporary file k of the sort identified by id to name,
+// returning false if it does not fit in size characters.
+inline bool external_run_name(char *name, size_t size, const char *tmp_dir,
+                              const void *id, int k) {
+  int len = std::snprintf(name, size, "%s/extsort_%p_%d.tmp", tmp_dir, id, k);
+  return len >= 0 && (size_t)len < size;
+}
+
+// Merges the k runs starting at runs[lo] into out, returning false if any run
+// could not be opened or read, or the output could not be written.
+template<class T, class Compare>
+bool external_merge_runs(const std::vector<std::string> &runs, size_t lo,
+                         size_t k, std::FILE *out, size_t bufsize,
+                         Compare comp) {
+  std::vector<std::FILE *> files;
+  std::vector<run_reader<T> *> src;
+  bool ok = true;
+  for (size_t i = 0; ok && i < k; i++) {
+    std::FILE *f = std::fopen(runs[lo + i].c_str(), "rb");
+    if (f == 0) {
+      ok = false;
+    } else {
+      files.push_back(f);
+      src.push_back(new run_reader<T>(f, bufsize));
+    }
+  }
+  if (ok) {
+    run_writer<T> w(out, bufsize);
+    for (loser_tree<T, Compare> lt(src, comp); !lt.done(); lt.pop()) {
+      w.push(lt.top());
+    }
+    w.flush();
+    ok = w.ok;
+  }
+  for (size_t i = 0; i < files.size(); i++) {
+    ok = ok && !std::ferror(files[i]);
+    delete src[i];
+    std::fclose(files[i]);
+  }
+  return ok;
+}
+
+template<class T, class Compare>
+bool external_mergesort(const char *in_path, const char *out_path,
+                        Compare comp, size_t memory_bytes = 1 << 26,
+                        const char *tmp_dir = ".", int fan_in = 16) {
+  std::FILE *in = std::fopen(in_path, "rb");
+  if (in == 0)
+    return false;
+  size_t m = std::max(memory_bytes / sizeof(T), (size_t)(2*fan_in + 2));
+  std::vector<std::string> runs, merged;  // Every temporary file created.
+  std::vector<T> chunk(m);
+  char name[4096];
+  bool ok = true;
+  for (size_t len; ok && (len = std::fread(&chunk[0], sizeof(T), m, in)); ) {
+    mergesort(chunk.begin(), chunk.begin() + len, comp);
+    std::FILE *out = 0;
+    if (external_run_name(name, sizeof name, tmp_dir, &runs, runs.size()))
+      out = std::fopen(name, "wb");
+    if (out == 0) {
+      ok = false;
+      break;
+    }
+    runs.push_back(name);
+    ok = (std::fwrite(&chunk[0], sizeof(T), len, out) == len);
+    ok = (std::fclose(out) == 0) && ok;
+  }
+  ok = ok && !std::ferror(in);
+  std::fclose(in);
+  std::vector<T>().swap(chunk);
+  if (ok && runs.empty()) {
+    std::FILE *out = std::fopen(out_path, "wb");
+    return out != 0 && std::fclose(out) == 0;
+  }
+  for (int id = runs.size(); ok; ) {
+    bool last = (runs.size() <= (size_t)fan_in);
+    merged.clear();
+    for (size_t next = 0, k; ok && next < runs.size(); next += k) {
+      k = std::min(runs.size() - next, (size_t)fan_in);
+      if (k == 1 && !last) {
+        merged.push_back(runs[next]);
+        continue;
+      }
+      std::FILE *out = 0;
+      if (last)
+        out = std::fopen(out_path, "wb");
+      else if (external_run_name(name, sizeof name, tmp_dir, &runs, id++))
+        out = std::fopen(name, "wb");
+      if (out == 0) {
+        ok = false;
+        break;
+      }
+      if (!last)
+        merged.push_back(name);
+      ok = external_merge_runs<T>(runs, next, k, out, m/(k + 1), comp);
+      ok = (std::fclose(out) == 0) && ok;
+      for (size_t i = 0; ok && i < k; i++) {
+        std::remove(runs[next + i].c_str());
+      }
+    }
+    if (last)
+      break;
+    runs.swap(merged);
+  }
+  if (!ok) {  // Runs already merged are gone, so some removals just fail.
+    for (size_t i = 0; i < runs.size(); i++) {
+      std::remove(runs[i].c_str());
+    }
+    for (size_t i = 0; i < merged.size(); i++) {
+      std::remove(merged[i].c_str());
+    }
+  }
+  return ok;
+}
+
+template<class T>
+bool external_mergesort(const char *in_path, const char *out_path) {
+  return external_mergesort<T>(in_path, out_path, std::less<T>());
+}
+
 /*** Example Usage and Output:
 
 mergesort() with default comparisons: 1.32 1.41 1.62 1.73 2.58 2.72 3.14 4.67
 mergesort() with 'compare_as_ints()': 1.41 1.73 1.32 1.62 2.72 2.58 3.14 4.67
 ------
-Sorting five million integers...
-std::sort():  0.355s
-quicksort():  0.426s
-mergesort():  1.263s
-heapsort():   1.093s
-combsort():   0.827s
-radix_sort(): 0.076s
+type,distribution,n,sort,ns_per_element,comparisons,moves
+int,random,1000,std::sort,11.01,11362,9657
+int,random,1000,quicksort,10.39,11998,8987
+int,random,1000,introsort,8.82,10478,26483
+int,random,1000,mergesort,13.61,10423,14981
+int,random,1000,heapsort,39.29,16835,12053
+int,random,1000,combsort,53.19,22709,13437
+int,random,1000,radix_sort,10.78,0,7000
+int64,random,1000,std::sort,24.02,12040,9489
+...
 
 ***/
 
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <string>
+#include <utility>
 #include <vector>
 using namespace std;
 
@@ -301,7 +815,146 @@ bool compare_as_ints(double i, double j) {
   return (int)i < (int)j;
 }
 
-int main () {
+struct first_key {
+  unsigned int operator()(const pair<int, int> &p) const {
+    return radix_key(p.first);
+  }
+};
+
+/*
+
+Benchmark harness: every sort is run over each element type and distribution
+of values, reporting the time per element along with the number of comparisons
+and element moves (copy constructions or assignments), as counted by wrapping
+each element in counted<T>. Results are printed as one CSV row per run, or as a
+JSON array if the program is run with the argument --json. Small sizes are
+repeated until at least 100000 elements have been sorted in total so that
+the timings are not lost to the resolution of clock().
+
+*/
+
+long long comparisons, moves;
+bool first_row = true;
+
+template<class T> struct counted {
+  T val;
+  counted() : val() {}
+  counted(const T &v) : val(v) {}
+  counted(const counted &c) : val(c.val) { moves++; }
+
+  counted & operator=(const counted &c) {
+    val = c.val;
+    moves++;
+    return *this;
+  }
+
+  bool operator<(const counted &c) const {
+    comparisons++;
+    return val < c.val;
+  }
+
+  bool operator>(const counted &c) const {
+    return c.val < val;
+  }
+};
+
+struct record32 {
+  long long key;
+  char payload[24];
+  bool operator<(const record32 &r) const { return key < r.key; }
+};
+
+void make_value(long long x, int &v) { v = (int)x; }
+void make_value(long long x, long long &v) { v = x * 1000003; }
+void make_value(long long x, record32 &v) { v.key = x; }
+
+void make_value(long long x, string &v) {
+  v = "key_0000000000";
+  for (int i = (int)v.size() - 1; x > 0; x /= 10) {
+    v[i--] = '0' + x % 10;
+  }
+}
+
+struct counted_key {
+  template<class T> unsigned long long operator()(const counted<T> &c) const {
+    return radix_key(c.val);
+  }
+};
+
+template<class It> void radix_sort_counted(It lo, It hi) {
+  radix_sort(lo, hi, counted_key());
+}
+
+const char *dist_names[] = {"random", "sorted", "reversed", "sawtooth",
+                            "few_unique"};
+
+template<class T>
+vector<counted<T> > make_input(int n, int dist) {
+  vector<counted<T> > v(n);
+  for (int i = 0; i < n; i++) {
+    long long x = (rand() & 0x7fff) | ((rand() & 0x7fff) << 15);
+    switch (dist) {
+      case 1: x = i; break;
+      case 2: x = n - i; break;
+      case 3: x = i % 1000; break;
+      case 4: x %= 16; break;
+    }
+    make_value(x, v[i].val);
+  }
+  return v;
+}
+
+template<class T, class SortFunction>
+void benchmark(const char *type, const char *name, SortFunction sortfunc,
+               int n, int dist, bool json) {
+  vector<counted<T> > orig = make_input<T>(n, dist), v;
+  int reps = max(1, 100000 / n);
+  long long comps = 0, movs = 0;
+  clock_t elapsed = 0;
+  for (int r = 0; r < reps; r++) {
+    v = orig;
+    comparisons = moves = 0;
+    clock_t start = clock();
+    sortfunc(v.begin(), v.end());
+    elapsed += clock() - start;
+    comps += comparisons;
+    movs += moves;
+    assert(is_sorted(v.begin(), v.end()));
+  }
+  double ns = 1e9 * elapsed / CLOCKS_PER_SEC / reps / n;
+  if (json) {
+    cout << (first_row ? "" : ",\n");
+    cout << "{\"type\": \"" << type << "\", \"distribution\": \""
+         << dist_names[dist] << "\", \"n\": " << n << ", \"sort\": \""
+         << name << "\", \"ns_per_element\": " << fixed << ns
+         << ", \"comparisons\": " << comps / reps << ", \"moves\": "
+         << movs / reps << "}";
+  } else {
+    cout << type << "," << dist_names[dist] << "," << n << "," << name << ","
+         << fixed << ns << "," << comps / reps << "," << movs / reps << endl;
+  }
+  first_row = false;
+}
+
+template<class T>
+void benchmark_all(const char *type, int n, int dist, bool json) {
+  typedef typename vector<counted<T> >::iterator It;
+  typedef void (*sort_function)(It, It);
+  benchmark<T>(type, "std::sort", (sort_function)std::sort<It>, n, dist, json);
+  benchmark<T>(type, "quicksort", (sort_function)quicksort<It>, n, dist, json);
+  benchmark<T>(type, "introsort", (sort_function)introsort<It>, n, dist, json);
+  benchmark<T>(type, "mergesort", (sort_function)mergesort<It>, n, dist, json);
+  benchmark<T>(type, "heapsort", (sort_function)heapsort<It>, n, dist, json);
+  benchmark<T>(type, "combsort", (sort_function)combsort<It>, n, dist, json);
+}
+
+template<class T>
+void benchmark_radix(const char *type, int n, int dist, bool json) {
+  typedef typename vector<counted<T> >::iterator It;
+  benchmark<T>(type, "radix_sort", radix_sort_counted<It>, n, dist, json);
+}
+
+int main(int argc, char *argv[]) {
   {  // Can be used to sort arrays like std::sort().
     int a[] = {32, 71, 12, 45, 26, 80, 53, 33};
     quicksort(a, a + 8);
@@ -319,6 +972,16 @@ int main () {
     heapsort(v.rbegin(), v.rend());
     assert(is_sorted(v.rbegin(), v.rend()));
   }
+  {  // Introsort is safe on inputs with many duplicates.
+    int a[] = {3, 1, 3, 3, 2, 3, 1, 3, 2, 3, 3, 1, 2, 3, 3, 1, 3, 2, 3, 1, 3, 3};
+    introsort(a, a + 22);
+    assert(is_sorted(a, a + 22));
+  }
+  {  // Small ranges are best left to insertion sort.
+    int a[] = {32, 71, 12, 45, 26, 80, 53, 33};
+    insertion_sort(a, a + 8);
+    assert(is_sorted(a, a + 8));
+  }
   {  // We can sort doubles just as well.
     double a[] = {1.1, -5.0, 6.23, 4.123, 155.2};
     vector<double> v(a, a + 5);
@@ -331,6 +994,40 @@ int main () {
     radix_sort(v.rbegin(), v.rend());
     assert(is_sorted(v.rbegin(), v.rend()));
   }
+  {  // Keyed radix sort handles negative and floating point values.
+    double a[] = {1.1, -5.0, 6.23, -4.123, 155.2, 0.0, -0.5};
+    vector<double> v(a, a + 7);
+    radix_sort_keys(v.begin(), v.end());
+    assert(is_sorted(v.begin(), v.end()));
+  }
+  {  // Records can be sorted by a key, stably.
+    pair<int, int> a[] = {make_pair(3, 0), make_pair(-1, 1), make_pair(3, 2),
+                          make_pair(-7, 3), make_pair(-1, 4)};
+    radix_sort(a, a + 5, first_key());
+    for (int i = 1; i < 5; i++) {
+      assert(a[i - 1].first < a[i].first ||
+             (a[i - 1].first == a[i].first && a[i - 1].second < a[i].second));
+    }
+  }
+  {  // Files larger than memory can be sorted externally.
+    vector<int> v, w(100001);
+    for (int i = 0; i < 100000; i++) {
+      v.push_back(rand());
+    }
+    FILE *f = fopen("extsort_in.bin", "wb");
+    fwrite(&v[0], sizeof(int), v.size(), f);
+    fclose(f);
+    // Only use 8KB of memory and a fan-in of 4, forcing several merge passes.
+    assert(external_mergesort<int>("extsort_in.bin", "extsort_out.bin",
+                                   less<int>(), 8192, ".", 4));
+    f = fopen("extsort_out.bin", "rb");
+    w.resize(fread(&w[0], sizeof(int), w.size(), f));
+    fclose(f);
+    remove("extsort_in.bin");
+    remove("extsort_out.bin");
+    sort(v.begin(), v.end());
+    assert(v == w);
+  }
 
   // Example from: http://www.cplusplus.com/reference/algorithm/stable_sort
   double a[] = {3.14, 1.41, 2.72, 4.67, 1.73, 1.32, 1.62, 2.58};
@@ -348,28 +1045,24 @@ int main () {
   }
   cout << "------" << endl;
 
-  vector<int> v, v2;
-  for (int i = 0; i < 5000000; i++)
-    v.push_back((rand() & 0x7fff) | ((rand() & 0x7fff) << 15));
-  v2 = v;
-  cout << "Sorting five million integers..." << endl;
-  cout.precision(3);
-
-#define test(sortfunc) {                                 \
-  clock_t start = clock();                               \
-  sortfunc(v.begin(), v.end());                          \
-  double t = (double)(clock() - start) / CLOCKS_PER_SEC; \
-  cout << setw(14) << left << #sortfunc "(): ";          \
-  cout << fixed << t << "s" << endl;                     \
-  assert(is_sorted(v.begin(), v.end()));                 \
-  v = v2;                                                \
-}
-  test(std::sort);
-  test(quicksort);
-  test(mergesort);
-  test(heapsort);
-  test(combsort);
-  test(radix_sort);
-
+  // Change these to benchmark other sizes, e.g. up to 1000000000.
+  int sizes[] = {1000, 10000, 100000};
+  bool json = (argc > 1 && string(argv[1]) == "--json");
+  cout.precision(2);
+  cout << (json ? "[\n" : "type,distribution,n,sort,ns_per_element,"
+                          "comparisons,moves\n");
+  for (int i = 0; i < 3; i++) {
+    for (int d = 0; d < 5; d++) {
+      benchmark_all<int>("int", sizes[i], d, json);
+      benchmark_radix<int>("int", sizes[i], d, json);
+      benchmark_all<long long>("int64", sizes[i], d, json);
+      benchmark_radix<long long>("int64", sizes[i], d, json);
+      benchmark_all<string>("string", sizes[i], d, json);
+      benchmark_all<record32>("record32", sizes[i], d, json);
+    }
+  }
+  if (json) {
+    cout << "\n]" << endl;
+  }
   return 0;
 }
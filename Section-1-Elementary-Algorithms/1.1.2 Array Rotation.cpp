@@ -8,21 +8,32 @@ rearranged in such a way that the element at mid becomes the first element of
 the new range and the element at mid - 1 becomes the last element, all while
 preserving the relative ordering of elements within the two rotated subarrays.
 
-All three versions below achieve the same result using in-place algorithms.
-Version 1 uses a straightforward swapping algorithm requiring ForwardIterators.
-Version 2 requires BidirectionalIterators, employing a well-known trick with
-three simple inversions. Version 3 requires RandomAccessIterators, applying a
-juggling algorithm which first divides the range into gcd(hi - lo, mid - lo)
-sets and then rotates the corresponding elements in each set.
+The first four versions below achieve the same result using in-place
+algorithms. Version 1 uses a straightforward swapping algorithm requiring
+ForwardIterators. Version 2 requires BidirectionalIterators, employing a
+well-known trick with three simple inversions. Version 3 requires
+RandomAccessIterators, applying a juggling algorithm which first divides the
+range into gcd(hi - lo, mid - lo) sets and then rotates the corresponding
+elements in each set, moving every element exactly once. Version 4 requires
+RandomAccessIterators, applying the block swap algorithm of Gries and Mills to
+repeatedly swap the shorter side into its final position with one sequential
+pass of std::swap_ranges(). Version 5 copies the shorter side into an auxiliary
+buffer, shifts the longer side over with a sequential copy, and then copies the
+buffer back into place.
 
 Time Complexity: O(n) on the distance between lo and hi.
-Space Complexity: O(1) auxiliary.
+Space Complexity: O(1) auxiliary for versions 1 to 4, and O(min(mid - lo,
+hi - mid)) auxiliary for version 5.
 
 */
 
-#include <algorithm>  // std::reverse(), std::rotate(), std::swap()
+#include <algorithm>  // std::copy(), std::min(), std::reverse(), std::swap(), ...
+#include <iterator>  // std::iterator_traits
+#include <vector>
 
 template<class It> void rotate1(It lo, It mid, It hi) {
+  if (mid == hi)
+    return;
   It next = mid;
   while (lo != next) {
     std::swap(*lo++, *next++);
@@ -45,16 +56,84 @@ int gcd(int a, int b) {
 
 template<class It> void rotate3(It lo, It mid, It hi) {
   int n = hi - lo, jump = mid - lo;
-  int g = gcd(jump, n), cycle = n / g;
+  if (jump == 0 || jump == n)
+    return;
+  int g = gcd(jump, n);
   for (int i = 0; i < g; i++) {
+    typename std::iterator_traits<It>::value_type tmp = *(lo + i);
     int curr = i, next;
-    for (int j = 0; j < cycle - 1; j++) {
+    for (;;) {
       next = curr + jump;
       if (next >= n)
         next -= n;
-      std::swap(*(lo + curr), *(lo + next));
+      if (next == i)
+        break;
+      *(lo + curr) = *(lo + next);
       curr = next;
     }
+    *(lo + curr) = tmp;
+  }
+}
+
+template<class It> void rotate4(It lo, It mid, It hi) {
+  int l = mid - lo, r = hi - mid;
+  while (l > 0 && r > 0) {
+    if (l <= r) {
+      std::swap_ranges(lo, mid, mid);
+      lo = mid;
+      mid += l;
+      r -= l;
+    } else {
+      std::swap_ranges(mid - r, mid, mid);
+      hi = mid;
+      mid -= r;
+      l -= r;
+    }
+  }
+}
+
+template<class It> void rotate5(It lo, It mid, It hi) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  if (mid - lo <= hi - mid) {
+    std::vector<T> buf(lo, mid);
+    std::copy(buf.begin(), buf.end(), std::copy(mid, hi, lo));
+  } else {
+    std::vector<T> buf(mid, hi);
+    std::copy_backward(lo, mid, hi);
+    std::copy(buf.begin(), buf.end(), lo);
+  }
+}
+
+/*
+
+rotate_adaptive() performs the same rotation by choosing whichever of the above
+versions best suits the memory access pattern of the input, as determined by
+benchmarking on large arrays (see the example below):
+
+- If the shorter side occupies at most buffer_bytes, version 5 is used. Every
+  element is moved only once or twice in purely sequential passes.
+- Otherwise if the elements are large and the whole range fits in the cache,
+  version 3 is used. The strided accesses of juggling are cheap when the range
+  is cached, so the fact that it moves every element only once wins out.
+- Otherwise, version 4 is used. Its swaps stream sequentially through memory,
+  unlike the strided accesses of juggling which thrash the cache on large
+  ranges, and it performs no allocation.
+
+*/
+
+template<class It>
+void rotate_adaptive(It lo, It mid, It hi, int buffer_bytes = 1 << 16,
+                     int cache_bytes = 1 << 20) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  long long shorter = std::min(mid - lo, hi - mid), n = hi - lo;
+  if (shorter == 0)
+    return;
+  if (shorter * (long long)sizeof(T) <= buffer_bytes) {
+    rotate5(lo, mid, hi);
+  } else if (sizeof(T) >= 128 && n * (long long)sizeof(T) <= cache_bytes) {
+    rotate3(lo, mid, hi);
+  } else {
+    rotate4(lo, mid, hi);
   }
 }
 
@@ -64,27 +143,80 @@ before sort:  2 4 2 0 5 10 7 3 7 1
 after sort:   0 1 2 2 3 4 5 7 7 10
 rotate left:  1 2 2 3 4 5 7 7 10 0
 rotate right: 0 1 2 2 3 4 5 7 7 10
+------
+Rotating 20000000 int elements at 7654321 (3 times)...
+std::rotate():     0.052s
+rotate1():         0.052s
+rotate2():         0.054s
+rotate3():         0.294s
+rotate4():         0.067s
+rotate5():         0.080s
+rotate_adaptive(): 0.057s
+Rotating 20000000 int elements at 100 (3 times)...
+std::rotate():     0.050s
+rotate1():         0.051s
+rotate2():         0.056s
+rotate3():         0.380s
+rotate4():         0.048s
+rotate5():         0.016s
+rotate_adaptive(): 0.016s
+...
 
 ***/
 
 #include <algorithm>
 #include <cassert>
+#include <ctime>
+#include <iomanip>
 #include <iostream>
 #include <vector>
 using namespace std;
 
+struct element256 {
+  int a[64];
+};
+
+template<class T>
+void benchmark(const char *type, int n, int mid, int reps) {
+  vector<T> v(n);
+  cout << "Rotating " << n << " " << type << " elements at " << mid << " ("
+       << reps << " times)..." << endl;
+
+#define test(rotatefunc) {                                 \
+  clock_t start = clock();                                 \
+  for (int i = 0; i < reps; i++)                           \
+    rotatefunc(v.begin(), v.begin() + mid, v.end());       \
+  double t = (double)(clock() - start) / CLOCKS_PER_SEC;   \
+  cout << setw(19) << left << #rotatefunc "(): ";          \
+  cout << fixed << setprecision(3) << t << "s" << endl;    \
+}
+  test(std::rotate);
+  test(rotate1);
+  test(rotate2);
+  test(rotate3);
+  test(rotate4);
+  test(rotate5);
+  test(rotate_adaptive);
+#undef test
+}
+
 int main() {
-  vector<int> v0, v1, v2, v3;
-  for (int i = 0; i < 10000; i++) {
-    v0.push_back(i);
+  for (int mid = 0; mid <= 100; mid++) {
+    vector<int> v0, v1, v2, v3, v4, v5, v6;
+    for (int i = 0; i < 100; i++) {
+      v0.push_back(i);
+    }
+    v1 = v2 = v3 = v4 = v5 = v6 = v0;
+    std::rotate(v0.begin(), v0.begin() + mid, v0.end());
+    rotate1(v1.begin(), v1.begin() + mid, v1.end());
+    rotate2(v2.begin(), v2.begin() + mid, v2.end());
+    rotate3(v3.begin(), v3.begin() + mid, v3.end());
+    rotate4(v4.begin(), v4.begin() + mid, v4.end());
+    rotate5(v5.begin(), v5.begin() + mid, v5.end());
+    rotate_adaptive(v6.begin(), v6.begin() + mid, v6.end(), 16, 64);
+    assert(v0 == v1 && v0 == v2 && v0 == v3);
+    assert(v0 == v4 && v0 == v5 && v0 == v6);
   }
-  v1 = v2 = v3 = v0;
-  int mid = 5678;
-  std::rotate(v0.begin(), v0.begin() + mid, v0.end());
-  rotate1(v1.begin(), v1.begin() + mid, v1.end());
-  rotate2(v2.begin(), v2.begin() + mid, v2.end());
-  rotate3(v3.begin(), v3.begin() + mid, v3.end());
-  assert(v0 == v1 && v0 == v2 && v0 == v3);
 
   // Example from: http://en.cppreference.com/w/cpp/algorithm/rotate
   int a[] = {2, 4, 2, 0, 5, 10, 7, 3, 7, 1};
@@ -120,6 +252,12 @@ int main() {
     cout << v[i] << ' ';
   }
   cout << endl;
+  cout << "------" << endl;
 
+  benchmark<int>("int", 20000000, 7654321, 3);
+  benchmark<int>("int", 20000000, 100, 3);
+  benchmark<int>("int", 50000, 12345, 2000);
+  benchmark<element256>("256-byte", 400000, 123456, 3);
+  benchmark<element256>("256-byte", 1000, 345, 2000);
   return 0;
 }
@@ -5,12 +5,14 @@ pairs (i, j) such that i < j and a[i] > a[j]. This is roughly how "close" an
 array is to being sorted, but is *not* the minimum number of swaps required to
 sort the array. If the array is sorted, then the inversion count is 0. If the
 array is sorted in decreasing order, then the inversion count is maximal. The
-following two functions are each techniques to efficiently count inversion.
+following two functions are each techniques to efficiently count inversion,
+while the class in version 3 counts them online as elements are appended.
 
 */
 
-#include <algorithm>  // std::fill(), std::max()
+#include <algorithm>  // std::copy(), std::fill(), std::max()
 #include <iterator>  // std::iterator_traits
+#include <map>
 #include <vector>
 
 /*
@@ -20,45 +22,43 @@ Version 1: Merge Sort
 Returns the number of inversions of the range [lo, hi), where lo and hi are
 RandomAccessIterators. Note that the range [lo, hi) will become sorted after
 the function call. The value type of the input iterators must have operator<
-defined appropriately.
+defined appropriately. A single buffer of n/2 elements is shared by all merges,
+and merging is skipped when the two halves are already in order.
 
 Time Complexity: O(n log n) on the distance between lo and hi.
 Space Complexity: O(n) auxiliary.
 
 */
 
-template<class It> long long inversions(It lo, It hi) {
+template<class It, class T>
+long long inversions(It lo, It hi, T *buf) {
   if (hi - lo < 2)
     return 0;
-  It mid = lo + (hi - lo - 1)/2, a = lo, c = mid + 1;
-  long long res = 0;
-  res += inversions(lo, mid + 1);
-  res += inversions(mid + 1, hi);
-  typedef typename std::iterator_traits<It>::value_type T;
-  std::vector<T> merged;
-  while (a <= mid && c < hi) {
+  It mid = lo + (hi - lo)/2, c = mid, out = lo;
+  long long res = inversions(lo, mid, buf) + inversions(mid, hi, buf);
+  if (!(*mid < *(mid - 1)))
+    return res;
+  T *a = buf, *end = std::copy(lo, mid, buf);
+  while (a != end && c != hi) {
     if (*c < *a) {
-      merged.push_back(*(c++));
-      res += (mid - a) + 1;
+      *out++ = *c++;
+      res += end - a;
     } else {
-      merged.push_back(*(a++));
+      *out++ = *a++;
     }
   }
-  if (a > mid) {
-    for (It k = c; k < hi; ++k) {
-      merged.push_back(*k);
-    }
-  } else {
-    for (It k = a; k <= mid; ++k) {
-      merged.push_back(*k);
-    }
-  }
-  for (int i = 0; i < hi - lo; i++) {
-    *(lo + i) = merged[i];
-  }
+  std::copy(a, end, out);
   return res;
 }
 
+template<class It> long long inversions(It lo, It hi) {
+  if (hi - lo < 2)
+    return 0;
+  typedef typename std::iterator_traits<It>::value_type T;
+  std::vector<T> buf((hi - lo + 1)/2);
+  return inversions(lo, hi, &buf[0]);
+}
+
 /*
 
 Version 2: Power-of-Two Trick
@@ -99,6 +99,66 @@ long long inversions(int n, int a[]) {
   return res;
 }
 
+/*
+
+Version 3: Online Counting with a Compressed Fenwick Tree
+
+Maintains the number of inversions of a sequence of integers as they are
+appended one at a time, without rescanning any earlier elements. Each new value
+x creates one inversion for every previous value greater than x, which is found
+by querying a Fenwick tree indexed by value. As in the compressed Fenwick tree
+implementation from section 3.2.5, std::map is used so that the entire range of
+int values is accessible with memory proportional to the number of elements. The
+values are shifted to unsigned indices by flipping their sign bits.
+
+- push(x) appends x to the sequence.
+- size() returns the number of values appended so far.
+- count() returns the number of inversions in the sequence so far.
+
+Time Complexity:
+- O(log^2 n) per call to push(), where n is the number of values pushed so far.
+  If std::map is replaced with a hash map, this becomes O(log n) amortized.
+- O(1) per call to size() and count().
+
+Space Complexity:
+- O(n log n) for storage of the Fenwick tree nodes.
+- O(1) auxiliary per call to all operations.
+
+*/
+
+class inversion_counter {
+  static const long long MAXN = 0xffffffffll;
+  std::map<long long, int> tree;
+  long long inversions;
+  int n;
+
+ public:
+  inversion_counter() : inversions(0), n(0) {}
+
+  void push(int x) {
+    long long at = (unsigned int)x ^ 0x80000000u;
+    int not_greater = 0;
+    for (long long i = at; i >= 0; i = (i & (i + 1)) - 1) {
+      std::map<long long, int>::iterator it = tree.find(i);
+      if (it != tree.end()) {
+        not_greater += it->second;
+      }
+    }
+    inversions += n++ - not_greater;
+    for (long long i = at; i <= MAXN; i |= i + 1) {
+      tree[i]++;
+    }
+  }
+
+  int size() const {
+    return n;
+  }
+
+  long long count() const {
+    return inversions;
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -112,5 +172,16 @@ int main() {
     int a[] = {6, 9, 1, 14, 8, 12, 3, 2};
     assert(inversions(8, a) == 16);
   }
+  {
+    int a[] = {6, 9, 1, 14, 8, 12, 3, 2};
+    inversion_counter ic;
+    for (int i = 0; i < 8; i++) {
+      ic.push(a[i]);
+    }
+    assert(ic.size() == 8 && ic.count() == 16);
+    ic.push(-2000000000);  // Smaller than all 8 previous values.
+    ic.push(2000000000);
+    assert(ic.count() == 24);
+  }
   return 0;
 }
@@ -20,8 +20,10 @@ Space Complexity: O(n) auxiliary.
 */
 
 #include <algorithm>  // std::lower_bound(), std::sort(), std::unique()
+#include <istream>
 #include <iterator>  // std::iterator_traits
 #include <map>
+#include <ostream>
 #include <vector>
 
 template<class It> void compress1(It lo, It hi) {
@@ -52,15 +54,145 @@ template<class It> void compress2(It lo, It hi) {
   }
 }
 
+/*
+
+Version 3: Reusable Compressor
+
+The class below builds the dictionary of distinct values once so that it may be
+shared to encode and decode any number of arrays afterwards. Its sorted keys are
+stored in one flat array, which is searched with a branchless binary search:
+every iteration halves the remaining length unconditionally and advances the
+base by a conditional move, so the loop runs exactly ceil(log2(k)) times and has
+no unpredictable branches. When the values are ints, the dictionary is built
+with an LSD radix sort (on keys with flipped sign bits) instead of std::sort().
+
+- compressor(lo, hi) builds the dictionary of the values in range [lo, hi).
+- size() returns k, the number of distinct values.
+- encode(x) returns the compressed value of x, or more generally the number of
+  distinct values that compare less than x if x itself was never added.
+- decode(i) returns the original value for the compressed value i in [0, k).
+- encode(lo, hi, out) and decode(lo, hi, out) apply the above to every value in
+  the range [lo, hi), writing the results to the OutputIterator out.
+- save(os) writes the dictionary to an output stream, which can be restored via
+  load(is) on an input stream. The values must support operator<< and operator>>
+  and must not contain whitespace once written.
+
+Time Complexity:
+- O(n log n) for construction, or O(n) if the values are ints.
+- O(log k) per call to encode(x), and O(1) per call to size() and decode(i).
+- O(n log k) and O(n) per call to the batched encode() and decode() functions.
+- O(k) per call to save() and load().
+
+Space Complexity:
+- O(k) for storage of the dictionary.
+- O(n) auxiliary for construction, and O(1) auxiliary per call to all other
+  operations.
+
+*/
+
+template<class T> class compressor {
+  std::vector<T> keys;
+
+  template<class U> static void sort_keys(std::vector<U> &v) {
+    std::sort(v.begin(), v.end());
+  }
+
+  static void sort_keys(std::vector<int> &v) {
+    std::vector<int> buf(v.size());
+    for (int pos = 0; pos < 32; pos += 8) {
+      int count[257] = {0};
+      for (int i = 0; i < (int)v.size(); i++) {
+        count[(((unsigned int)v[i] ^ 0x80000000u) >> pos & 0xff) + 1]++;
+      }
+      for (int i = 0; i < 256; i++) {
+        count[i + 1] += count[i];
+      }
+      for (int i = 0; i < (int)v.size(); i++) {
+        buf[count[((unsigned int)v[i] ^ 0x80000000u) >> pos & 0xff]++] = v[i];
+      }
+      v.swap(buf);
+    }
+  }
+
+ public:
+  compressor() {}
+
+  template<class It> compressor(It lo, It hi) : keys(lo, hi) {
+    sort_keys(keys);
+    keys.resize(std::unique(keys.begin(), keys.end()) - keys.begin());
+  }
+
+  int size() const {
+    return keys.size();
+  }
+
+  int encode(const T &x) const {
+    if (keys.empty())
+      return 0;
+    const T *base = &keys[0];
+    for (int n = keys.size(), half; n > 1; n -= half) {
+      half = n/2;
+      base = (base[half] < x) ? base + half : base;
+    }
+    return (base - &keys[0]) + (*base < x);
+  }
+
+  const T & decode(int i) const {
+    return keys[i];
+  }
+
+  template<class It, class OutIt>
+  OutIt encode(It lo, It hi, OutIt out) const {
+    for (; lo != hi; ++lo) {
+      *out++ = encode(*lo);
+    }
+    return out;
+  }
+
+  template<class It, class OutIt>
+  OutIt decode(It lo, It hi, OutIt out) const {
+    for (; lo != hi; ++lo) {
+      *out++ = keys[*lo];
+    }
+    return out;
+  }
+
+  void save(std::ostream &os) const {
+    os << keys.size();
+    for (int i = 0; i < (int)keys.size(); i++) {
+      os << ' ' << keys[i];
+    }
+    os << '\n';
+  }
+
+  bool load(std::istream &is) {
+    int k;
+    if (!(is >> k) || k < 0)
+      return false;
+    keys.resize(k);
+    for (int i = 0; i < k; i++) {
+      if (!(is >> keys[i]))
+        return false;
+    }
+    return true;
+  }
+};
+
 /*** Example Usage and Output:
 
 0 4 4 1 3 2 5 5
 0 4 4 1 3 2 5 5
 1 0 2 0 3 1
+0 4 4 1 3 2 5 5
+1 30 30 7 9 8 99 99
+0 2 1 1
 
 ***/
 
+#include <cassert>
 #include <iostream>
+#include <sstream>
+#include <string>
 using namespace std;
 
 template<class It> void print_range(It lo, It hi) {
@@ -85,5 +217,29 @@ int main() {
     compress1(a, a + 6);
     print_range(a, a + 6);
   }
+  {  // Build the dictionary once, then share it for many arrays.
+    int a[] = {1, 30, 30, 7, 9, 8, 99, 99}, b[8], c[8];
+    compressor<int> comp(a, a + 8);
+    comp.encode(a, a + 8, b);
+    print_range(b, b + 8);
+    comp.decode(b, b + 8, c);
+    print_range(c, c + 8);
+    int d[] = {-5, 9, 8, 8};
+    vector<int> e(4);
+    comp.encode(d, d + 4, e.begin());
+    assert(e[0] == 0 && e[1] == 3 && e[2] == 2 && e[3] == 2);
+    assert(comp.encode(-5) == 0 && comp.encode(1000) == comp.size());
+    stringstream ss;
+    comp.save(ss);
+    compressor<int> comp2;
+    assert(comp2.load(ss) && comp2.size() == 6 && comp2.decode(3) == 9);
+  }
+  {
+    string a[] = {"b", "d", "c", "c"};
+    compressor<string> comp(a, a + 4);
+    int b[4];
+    comp.encode(a, a + 4, b);
+    print_range(b, b + 4);
+  }
   return 0;
 }
@@ -17,9 +17,12 @@ Space Complexity: O(1) auxiliary.
 
 */
 
-#include <algorithm>  // std::swap()
+#include <algorithm>  // std::max(), std::min(), std::sort(), std::swap()
+#include <cmath>  // exp(), log(), sqrt()
 #include <cstdlib>  // rand()
+#include <functional>  // std::less
 #include <iterator>  // std::iterator_traits
+#include <vector>
 
 int rand32() {
   return (rand() & 0x7fff) | ((rand() & 0x7fff) << 15);
@@ -43,14 +46,290 @@ template<class It> void nth_element2(It lo, It nth, It hi) {
   }
 }
 
+/*
+
+Median of Medians Selection
+
+Rearranges [lo, hi) in the same way as nth_element2(), but in worst case linear
+time. The range is split into groups of five, the median of each group is moved
+to the front, and the median of these medians is recursively selected as the
+pivot, which guarantees that at least 30% of the elements fall on either side.
+The range is then partitioned three ways so that elements equal to the pivot
+are never revisited. Because of its large constant factor, this is mostly useful
+as a fallback for faster algorithms that are not linear in the worst case.
+
+Time Complexity: O(n) on the distance between lo and hi.
+Space Complexity: O(log n) auxiliary stack space.
+
+*/
+
+template<class It, class Compare>
+void insertion_sort(It lo, It hi, Compare comp) {
+  for (It i = lo; i != hi; ++i) {
+    for (It j = i; j != lo && comp(*j, *(j - 1)); --j) {
+      std::swap(*j, *(j - 1));
+    }
+  }
+}
+
+// Partitions [lo, hi) into [lo, l) < pivot, [l, h) == pivot, and [h, hi).
+template<class It, class T, class Compare>
+void partition3(It lo, It hi, const T &pivot, It &l, It &h, Compare comp) {
+  l = lo;
+  h = hi;
+  for (It it = lo; it != h; ) {
+    if (comp(*it, pivot)) {
+      std::swap(*it++, *l++);
+    } else if (comp(pivot, *it)) {
+      std::swap(*it, *--h);
+    } else {
+      ++it;
+    }
+  }
+}
+
+template<class It, class Compare>
+void median_of_medians(It lo, It nth, It hi, Compare comp) {
+  while (hi - lo > 5) {
+    It m = lo, l, h;
+    for (int i = 0, n = hi - lo; i < n; i += 5) {
+      It g = lo + i, end = lo + std::min(i + 5, n);
+      insertion_sort(g, end, comp);
+      std::swap(*m++, *(g + (end - g)/2));
+    }
+    It mid = lo + (m - lo)/2;
+    median_of_medians(lo, mid, m, comp);
+    typename std::iterator_traits<It>::value_type pivot = *mid;
+    partition3(lo, hi, pivot, l, h, comp);
+    if (nth < l) {
+      hi = l;
+    } else if (nth >= h) {
+      lo = h;
+    } else {
+      return;
+    }
+  }
+  insertion_sort(lo, hi, comp);
+}
+
+/*
+
+Floyd-Rivest Selection
+
+Rearranges [lo, hi) in the same way as nth_element2(), but chooses pivots by
+first recursively selecting from a small sample of about n^(2/3) elements. The
+sample bounds are chosen so that with high probability, the nth element lies
+between the two pivots selected from the sample while only a small number of
+elements does. This makes the expected number of comparisons n + min(k, n - k)
++ o(n), which is close to optimal and noticeably faster than quickselect in
+practice. If the range has not shrunk enough after a logarithmic number of
+iterations, median_of_medians() takes over to guarantee linear time.
+
+multi_select() rearranges [lo, hi) so that every position in the range of
+sorted indices [rlo, rhi) (e.g. the positions of several percentiles) holds the
+element that would be there if [lo, hi) were sorted. Each subrange between two
+consecutive selected positions is also partitioned accordingly. This is done in
+a single recursive pass that selects the middle requested position and then
+recurses on the positions on either side, which is faster than selecting every
+position independently when there are many of them.
+
+Time Complexity:
+- O(n) on the distance between lo and hi for floyd_rivest_select().
+- O(n log m) on the distance between lo and hi for multi_select(), where m is
+  the number of positions requested.
+
+Space Complexity: O(log n) auxiliary stack space.
+
+*/
+
+template<class It, class Compare>
+void floyd_rivest_select(It lo, It nth, It hi, Compare comp) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  int left = 0, right = (hi - lo) - 1, k = nth - lo, iterations = 0;
+  for (int n = right + 1; n > 1; n >>= 1) {
+    iterations += 2;
+  }
+  while (right > left) {
+    if (iterations-- == 0) {
+      median_of_medians(lo + left, nth, lo + right + 1, comp);
+      return;
+    }
+    if (right - left > 600) {
+      double n = right - left + 1, i = k - left + 1, z = log(n);
+      double s = 0.5*exp(2*z/3), sd = 0.5*sqrt(z*s*(n - s)/n);
+      if (i < n/2) {
+        sd = -sd;
+      }
+      int l = std::max(left, (int)(k - i*s/n + sd));
+      int r = std::min(right, (int)(k + (n - i)*s/n + sd));
+      floyd_rivest_select(lo + l, nth, lo + r + 1, comp);
+    }
+    T t = *(lo + k);
+    int i = left, j = right;
+    std::swap(*(lo + left), *(lo + k));
+    if (comp(t, *(lo + right))) {
+      std::swap(*(lo + right), *(lo + left));
+    }
+    while (i < j) {
+      std::swap(*(lo + i), *(lo + j));
+      i++;
+      j--;
+      while (comp(*(lo + i), t))
+        i++;
+      while (comp(t, *(lo + j)))
+        j--;
+    }
+    if (!comp(*(lo + left), t) && !comp(t, *(lo + left))) {
+      std::swap(*(lo + left), *(lo + j));
+    } else {
+      j++;
+      std::swap(*(lo + j), *(lo + right));
+    }
+    if (j <= k) {
+      left = j + 1;
+    }
+    if (k <= j) {
+      right = j - 1;
+    }
+  }
+}
+
+template<class It> void floyd_rivest_select(It lo, It nth, It hi) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  floyd_rivest_select(lo, nth, hi, std::less<T>());
+}
+
+template<class It, class IndexIt, class Compare>
+void multi_select(It lo, It hi, IndexIt rlo, IndexIt rhi, Compare comp) {
+  if (rlo == rhi || hi - lo < 2)
+    return;
+  IndexIt rmid = rlo + (rhi - rlo)/2;
+  It nth = lo + *rmid;
+  floyd_rivest_select(lo, nth, hi, comp);
+  IndexIt l = rmid, r = rmid + 1;
+  while (l != rlo && *(l - 1) == *rmid) {
+    --l;
+  }
+  while (r != rhi && *r == *rmid) {
+    ++r;
+  }
+  multi_select(lo, nth, rlo, l, comp);
+  std::vector<int> shifted;
+  for (; r != rhi; ++r) {
+    shifted.push_back(*r - *rmid - 1);
+  }
+  multi_select(nth + 1, hi, shifted.begin(), shifted.end(), comp);
+}
+
+template<class It, class IndexIt>
+void multi_select(It lo, It hi, IndexIt rlo, IndexIt rhi) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  multi_select(lo, hi, rlo, rhi, std::less<T>());
+}
+
+/*
+
+Streaming Quantile Estimation (P-Square Algorithm)
+
+Estimates the p-quantile (0 < p < 1) of a stream of numbers using only constant
+memory, for data too large to store. The P-square algorithm of Jain and Chlamtac
+maintains five markers: the minimum, the maximum, and estimates of the p/2, p,
+and (1 + p)/2 quantiles. After each observation, the positions of the markers
+are incremented accordingly and any marker that drifts at least one position
+from its desired position is moved towards it, adjusting its height by
+piecewise parabolic (or if that fails to preserve monotonicity, linear)
+interpolation between its neighbours. The estimate is exact while fewer than
+five values have been observed. To track several quantiles such as p50, p90,
+and p99 at once, simply use one instance per quantile.
+
+- p2_quantile(p) constructs an estimator for the p-quantile.
+- push(x) adds the value x to the stream.
+- estimate() returns the current estimate of the p-quantile, requiring that at
+  least one value has been added.
+
+Time Complexity: O(1) per call to all member functions.
+Space Complexity: O(1) for storage of the markers.
+
+*/
+
+class p2_quantile {
+  double p, q[5], dn[5], np[5];
+  int n[5], count;
+
+  double parabolic(int i, int d) const {
+    return q[i] + (double)d/(n[i + 1] - n[i - 1])*(
+        (n[i] - n[i - 1] + d)*(q[i + 1] - q[i])/(n[i + 1] - n[i]) +
+        (n[i + 1] - n[i] - d)*(q[i] - q[i - 1])/(n[i] - n[i - 1]));
+  }
+
+ public:
+  p2_quantile(double p) : p(p), count(0) {
+    double dn0[] = {0, p/2, p, (1 + p)/2, 1};
+    double np0[] = {1, 1 + 2*p, 1 + 4*p, 3 + 2*p, 5};
+    for (int i = 0; i < 5; i++) {
+      dn[i] = dn0[i];
+      np[i] = np0[i];
+      n[i] = i + 1;
+    }
+  }
+
+  void push(double x) {
+    if (count < 5) {
+      q[count++] = x;
+      std::sort(q, q + count);
+      return;
+    }
+    count++;
+    int k;
+    if (x < q[0]) {
+      q[0] = x;
+      k = 0;
+    } else if (x >= q[4]) {
+      q[4] = std::max(q[4], x);
+      k = 3;
+    } else {
+      for (k = 0; !(x < q[k + 1]); k++) {}
+    }
+    for (int i = 0; i < 5; i++) {
+      if (i > k) {
+        n[i]++;
+      }
+      np[i] += dn[i];
+    }
+    for (int i = 1; i <= 3; i++) {
+      double d = np[i] - n[i];
+      if ((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1)) {
+        int s = (d > 0) ? 1 : -1;
+        double qp = parabolic(i, s);
+        if (q[i - 1] < qp && qp < q[i + 1]) {
+          q[i] = qp;
+        } else {
+          q[i] += s*(q[i + s] - q[i])/(n[i + s] - n[i]);
+        }
+        n[i] += s;
+      }
+    }
+  }
+
+  double estimate() const {
+    if (count >= 5)
+      return q[2];
+    return q[std::min(count - 1, (int)(p*count))];
+  }
+};
+
 /*** Example Usage and Output:
 
 The median is 5.
 3 2 3 4 5 6 6 9 7
+p50 = 499999, p90 = 899999, p99 = 989999, p999 = 998999
+Estimated p99 of stream: 9898.73 (exact: 9899)
 
 ***/
 
+#include <cassert>
 #include <iostream>
+#include <vector>
 using namespace std;
 
 template<class It> void print_range(It lo, It hi) {
@@ -65,5 +344,28 @@ int main () {
   nth_element2(a, a + n/2, a + n);
   cout << "The median is " << a[n/2] << "." << endl;
   print_range(a, a + n);
+
+  vector<int> v;
+  for (int i = 0; i < 1000000; i++) {
+    v.push_back(i);
+  }
+  random_shuffle(v.begin(), v.end());
+  vector<int> w(v);
+  floyd_rivest_select(w.begin(), w.begin() + 123456, w.end());
+  assert(w[123456] == 123456);
+  w = v;
+  median_of_medians(w.begin(), w.begin() + 654321, w.end(), less<int>());
+  assert(w[654321] == 654321);
+  int ranks[] = {499999, 899999, 989999, 998999};
+  multi_select(v.begin(), v.end(), ranks, ranks + 4);
+  cout << "p50 = " << v[ranks[0]] << ", p90 = " << v[ranks[1]]
+       << ", p99 = " << v[ranks[2]] << ", p999 = " << v[ranks[3]] << endl;
+
+  p2_quantile p99(0.99);
+  for (int i = 0; i < 10000; i++) {
+    p99.push((i * 7919) % 10000);
+  }
+  cout << "Estimated p99 of stream: " << p99.estimate() << " (exact: 9899)"
+       << endl;
   return 0;
 }
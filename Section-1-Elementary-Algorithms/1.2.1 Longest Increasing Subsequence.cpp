@@ -16,12 +16,16 @@ Space Complexity: O(n) auxiliary.
 
 */
 
+#include <algorithm>  // std::lower_bound(), std::upper_bound()
+#include <functional>  // std::less
 #include <iterator>  // std::iterator_traits
 #include <vector>
 
 template<class It> std::vector<typename std::iterator_traits<It>::value_type>
 longest_increasing_subsequence(It lo, It hi) {
   int len = 0, n = hi - lo;
+  if (n == 0)
+    return std::vector<typename std::iterator_traits<It>::value_type>();
   std::vector<int> prev(n), tail(n);
   for (int i = 0; i < n; i++) {
     int l = -1, h = len;
@@ -46,12 +50,117 @@ longest_increasing_subsequence(It lo, It hi) {
   return res;
 }
 
+/*
+
+The class below implements the same patience sorting algorithm as a reusable
+engine, for computing the LIS of many sequences without allocating memory per
+call. The current tail value of each pile is kept in one flat array so that the
+binary search never has to follow an index back into the input. The buffers
+only ever grow to the length of the longest sequence processed so far.
+
+- lis_engine<T, Compare>(strict, comp) constructs an engine for sequences of T,
+  ordered by the strict weak ordering comp (by default, operator<). If strict is
+  true, the subsequence must be strictly increasing. Otherwise, it only has to
+  be non-decreasing (i.e. equal consecutive elements are allowed).
+- length(lo, hi) returns the length of the LIS of the range [lo, hi).
+- indices(lo, hi, res) returns the length of the LIS of [lo, hi), also storing
+  the indices (relative to lo) of one such subsequence in the vector res.
+- lengths(lo, olo, ohi, out) computes the LIS lengths of a batch of sequences
+  that are stored contiguously starting at lo. The range [olo, ohi) holds m + 1
+  nondecreasing offsets for m sequences, of which the i-th sequence is [lo +
+  offset[i], lo + offset[i + 1]). The m lengths are written to the
+  OutputIterator out.
+
+Time Complexity:
+- O(n log n) per call to length() and indices(), on the distance n between lo
+  and hi.
+- O(n log n) per call to lengths(), where n is the total length of all of the
+  sequences in the batch.
+
+Space Complexity:
+- O(n) for storage of the buffers, where n is the length of the longest
+  sequence processed so far.
+- O(1) auxiliary per call to all operations.
+
+*/
+
+template<class T, class Compare = std::less<T> >
+class lis_engine {
+  std::vector<T> tails;
+  std::vector<int> tail_index, prev;
+  bool strict;
+  Compare comp;
+
+  int search(const T &x) const {
+    return (strict ? std::lower_bound(tails.begin(), tails.end(), x, comp)
+                   : std::upper_bound(tails.begin(), tails.end(), x, comp)) -
+           tails.begin();
+  }
+
+ public:
+  lis_engine(bool strict = true, const Compare &comp = Compare())
+      : strict(strict), comp(comp) {}
+
+  template<class It> int length(It lo, It hi) {
+    tails.clear();
+    for (It it = lo; it != hi; ++it) {
+      int pos = search(*it);
+      if (pos == (int)tails.size()) {
+        tails.push_back(*it);
+      } else {
+        tails[pos] = *it;
+      }
+    }
+    return tails.size();
+  }
+
+  template<class It> int indices(It lo, It hi, std::vector<int> &res) {
+    int n = hi - lo;
+    tails.clear();
+    tail_index.clear();
+    prev.resize(n);
+    for (int i = 0; i < n; i++) {
+      const T &x = *(lo + i);
+      int pos = search(x);
+      if (pos == (int)tails.size()) {
+        tails.push_back(x);
+        tail_index.push_back(i);
+      } else {
+        tails[pos] = x;
+        tail_index[pos] = i;
+      }
+      prev[i] = (pos > 0) ? tail_index[pos - 1] : -1;
+    }
+    int len = tails.size();
+    res.resize(len);
+    for (int i = (len > 0) ? tail_index[len - 1] : -1; i != -1; i = prev[i]) {
+      res[--len] = i;
+    }
+    return res.size();
+  }
+
+  template<class It, class OffsetIt, class OutIt>
+  OutIt lengths(It lo, OffsetIt olo, OffsetIt ohi, OutIt out) {
+    if (olo == ohi)
+      return out;
+    for (OffsetIt o = olo, next = olo; ++next != ohi; o = next) {
+      *out++ = length(lo + *o, lo + *next);
+    }
+    return out;
+  }
+};
+
 /*** Example Usage and Output:
 
 -5 1 9 10 11 13
+-5 1 9 10 10 11
+13 11
+Lengths of batch: 6 1 3 0
 
 ***/
 
+#include <cassert>
+#include <functional>
 #include <iostream>
 using namespace std;
 
@@ -65,5 +174,32 @@ int main () {
   int a[] = {-2, -5, 1, 9, 10, 8, 11, 10, 13, 11};
   vector<int> res = longest_increasing_subsequence(a, a + 10);
   print_range(res.begin(), res.end());
+
+  vector<int> idx;
+  lis_engine<int> strict_lis;
+  assert(strict_lis.indices(a, a + 10, idx) == 6);
+  assert(strict_lis.length(a, a + 10) == 6);
+  lis_engine<int> nondecreasing_lis(false);
+  nondecreasing_lis.indices(a, a + 10, idx);
+  for (int i = 0; i < (int)idx.size(); i++) {
+    cout << a[idx[i]] << " ";
+  }
+  cout << endl;
+
+  // A longest strictly decreasing subsequence, using a custom comparator.
+  lis_engine<int, greater<int> > decreasing_lis;
+  decreasing_lis.indices(a, a + 10, idx);
+  for (int i = 0; i < (int)idx.size(); i++) {
+    cout << a[idx[i]] << " ";
+  }
+  cout << endl;
+
+  // Many sequences stored back to back, with one shared engine.
+  int b[] = {-2, -5, 1, 9, 10, 8, 11, 10, 13, 11, 7, 7, 7, 1, 2, 3};
+  int offsets[] = {0, 10, 13, 16, 16};
+  int lengths[4];
+  strict_lis.lengths(b, offsets, offsets + 5, lengths);
+  cout << "Lengths of batch: ";
+  print_range(lengths, lengths + 4);
   return 0;
 }
@@ -10,7 +10,7 @@ in overall cubic time.
 
 */
 
-#include <algorithm>  // std::fill()
+#include <algorithm>  // std::fill(), std::max(), std::min()
 #include <iterator>  // std::iterator_traits
 #include <limits>  // std::numeric_limits
 #include <vector>
@@ -66,6 +66,77 @@ max_subarray_sum(It lo, It hi, int *begin_idx = 0, int *end_idx = 0) {
 
 /*
 
+Kadane's algorithm is inherently sequential, since the best sum ending at each
+index depends on the previous one. However, the maximal subarray sum can also
+be computed as a reduction over a monoid of per-range summaries, each storing
+the sum of the range, its maximal nonempty prefix sum, its maximal nonempty
+suffix sum, and its maximal nonempty subarray sum. The summary of two adjacent
+ranges is computed from their individual summaries in O(1) by combine(), which
+is associative. Thus, blocks of the input may be summarized independently of one
+another (e.g. by separate SIMD lanes) and combined in any grouping.
+
+summarize() computes the summary of a range [lo, hi) in one pass with a loop
+body that has no data-dependent branches. max_subarray_sum_blocked() splits
+[lo, hi) into blocks of block_size elements, summarizes each independently, and
+then combines the summaries from left to right to return the maximal subarray
+sum. Unlike max_subarray_sum(), this always considers nonempty subarrays only,
+so the result for an all-negative range is naturally its maximum value. For an
+empty range, it returns std::numeric_limits<T>::min() as max_subarray_sum()
+does.
+
+Time Complexity: O(n) on the distance between lo and hi.
+Space Complexity: O(1) auxiliary.
+
+*/
+
+template<class T> struct range_summary {
+  T sum, prefix, suffix, best;
+};
+
+template<class T>
+range_summary<T> combine(const range_summary<T> &l, const range_summary<T> &r) {
+  range_summary<T> res;
+  res.sum = l.sum + r.sum;
+  res.prefix = std::max(l.prefix, l.sum + r.prefix);
+  res.suffix = std::max(r.suffix, r.sum + l.suffix);
+  res.best = std::max(std::max(l.best, r.best), l.suffix + r.prefix);
+  return res;
+}
+
+template<class It> range_summary<typename std::iterator_traits<It>::value_type>
+summarize(It lo, It hi) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  range_summary<T> res;
+  T curr = *lo, min_prefix = 0;
+  res.sum = res.prefix = res.best = *lo;
+  for (It it = lo + 1; it != hi; ++it) {
+    min_prefix = std::min(min_prefix, res.sum);
+    res.sum += *it;
+    res.prefix = std::max(res.prefix, res.sum);
+    curr = std::max(*it, curr + *it);
+    res.best = std::max(res.best, curr);
+  }
+  res.suffix = res.sum - min_prefix;
+  return res;
+}
+
+template<class It> typename std::iterator_traits<It>::value_type
+max_subarray_sum_blocked(It lo, It hi, int block_size = 4096) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  if (lo == hi)
+    return std::numeric_limits<T>::min();
+  It it = lo + std::min((int)(hi - lo), block_size);
+  range_summary<T> res = summarize(lo, it);
+  while (it != hi) {
+    It next = it + std::min((int)(hi - it), block_size);
+    res = combine(res, summarize(it, next));
+    it = next;
+  }
+  return res.best;
+}
+
+/*
+
 Returns the largest sum of any rectangular submatrix for a matrix of n rows by
 m columns. The matrix should be given as a 2-dimensional vector, where the outer
 vector must contain n vectors each of size m. Optionally, four int pointers
@@ -77,8 +148,14 @@ indices just past the last elements for their respective dimensions).
 If the input matrix consists of only negative values, then a maximum value of
 the matrix (rather than an empty submatrix) will be returned as the maximal sum.
 
-Time Complexity: O(m^2 * n) for a matrix with m columns and n rows.
-Space Complexity: O(n) auxiliary.
+The pairs of boundaries are enumerated along the smaller of the two dimensions,
+running Kadane's algorithm along the larger one. When the rows are the smaller
+dimension, the sums for each pair of rows are accumulated by adding one whole row
+at a time, so that the matrix is scanned in row-major order.
+
+Time Complexity: O(min(n, m)^2 * max(n, m)) for a matrix with n rows and m
+columns.
+Space Complexity: O(max(n, m)) auxiliary.
 
 */
 
@@ -87,23 +164,32 @@ T max_submatrix_sum(const std::vector< std::vector<T> > &matrix,
                     int *begin_row = 0, int *end_row = 0,
                     int *begin_col = 0, int *end_col = 0) {
   int n = matrix.size(), m = matrix[0].size();
-  std::vector<T> sums(n);
+  bool by_rows = (n <= m);
+  int outer = by_rows ? n : m, inner = by_rows ? m : n;
+  std::vector<T> sums(inner);
   T sum, max_sum = std::numeric_limits<T>::min();
-  for (int lcol = 0; lcol < m; lcol++) {
+  for (int lo = 0; lo < outer; lo++) {
     std::fill(sums.begin(), sums.end(), 0);
-    for (int hcol = lcol; hcol < m; hcol++) {
-      for (int i = 0; i < n; i++) {
-        sums[i] += matrix[i][hcol];
+    for (int hi = lo; hi < outer; hi++) {
+      if (by_rows) {
+        const std::vector<T> &row = matrix[hi];
+        for (int j = 0; j < inner; j++) {
+          sums[j] += row[j];
+        }
+      } else {
+        for (int i = 0; i < inner; i++) {
+          sums[i] += matrix[i][hi];
+        }
       }
       int begin, end;
       sum = max_subarray_sum(sums.begin(), sums.end(), &begin, &end);
       if (sum > max_sum) {
         max_sum = sum;
         if (begin_row != 0) {
-          *begin_row = begin;
-          *end_row = end;
-          *begin_col = lcol;
-          *end_col = hcol + 1;
+          *begin_row = by_rows ? lo : begin;
+          *end_row = by_rows ? hi + 1 : end;
+          *begin_col = by_rows ? begin : lo;
+          *end_col = by_rows ? end : hi + 1;
         }
       }
     }
@@ -136,6 +222,15 @@ int main() {
     for (int i = begin; i < end; i++)
       cout << a[i] << " ";
     cout << endl;
+    assert(max_subarray_sum_blocked(a, a + 3) == -1);
+    assert(max_subarray_sum_blocked(a, a + 9) == 6);
+    for (int block_size = 1; block_size <= 10; block_size++) {
+      assert(max_subarray_sum_blocked(a, a + 9, block_size) == 6);
+    }
+    vector<int> v(a, a + 9);
+    assert(max_subarray_sum_blocked(v.begin(), v.end(), 4) == 6);
+    assert(max_subarray_sum_blocked(v.begin(), v.begin()) ==
+           numeric_limits<int>::min());
   }
   {
     const int n = 4, m = 5;
@@ -154,6 +249,13 @@ int main() {
         cout << mat[i][j] << " ";
       cout << endl;
     }
+    vector< vector<int> > transposed(m, vector<int>(n));
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++)
+        transposed[j][i] = mat[i][j];
+    }
+    assert(max_submatrix_sum(transposed, &lcol, &hcol, &lrow, &hrow) == 15);
+    assert(lrow == 1 && hrow == 4 && lcol == 0 && hcol == 2);
   }
   return 0;
 }
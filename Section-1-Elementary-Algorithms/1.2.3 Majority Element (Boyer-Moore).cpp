@@ -34,14 +34,176 @@ template<class It> It majority(It lo, It hi) {
   return candidate;
 }
 
-/*** Example Usage ***/
+/*
+
+Heavy Hitters (Misra-Gries)
+
+The Misra-Gries summary generalizes the voting idea above from one candidate to
+k candidates, finding every element occurring more than n/(k + 1) times in a
+stream of n elements using only O(k) memory. Each candidate is stored with a
+counter. An arriving element increments its own counter if it is already a
+candidate, or becomes a new candidate if there are fewer than k. Otherwise, all
+k counters as well as the arriving element "cancel out", decrementing every
+counter and discarding candidates whose counters reach zero. The counter of any
+element therefore underestimates its true frequency by at most the number of
+decrements, which is at most (n - c)/(k + 1) where c is the sum of all counters.
+
+Two summaries of separate streams (e.g. shards of a stream handled by different
+machines) can be merged by adding their counters, then subtracting
+the (k + 1)-th largest counter from every counter and discarding those which are
+no longer positive. The result has the same guarantee as a single summary of
+the concatenated stream.
+
+- heavy_hitters<T>(k) constructs an empty summary tracking up to k candidates.
+- feed(x) adds a single element x to the stream.
+- feed(lo, hi) adds every element in the range [lo, hi) to the stream.
+- merge(s) merges another summary s (with the same k) into this summary.
+- estimate(x) returns a lower bound for the number of occurrences of x, which is
+  at most error_bound() less than the true number of occurrences.
+- error_bound() returns the maximum possible underestimation of estimate(x).
+- top(res) stores every candidate along with its estimated count into the
+  vector res, sorted in decreasing order of count. Every element occurring more
+  than n/(k + 1) times is guaranteed to be included, though some elements
+  occurring less often may also be included.
+- flush() resets the summary to an empty stream.
+
+Time Complexity:
+- O(log k) amortized per call to feed(x) and estimate(x).
+- O(k log k) per call to merge(), top() and flush().
+- O(1) per call to error_bound().
+
+Space Complexity:
+- O(k) for storage of the summary.
+- O(k) auxiliary per call to merge() and top(), and O(1) auxiliary per call to
+  all other operations.
+
+*/
+
+#include <algorithm>  // std::min(), std::nth_element(), std::sort()
+#include <functional>  // std::greater
+#include <map>
+#include <utility>  // std::pair
+#include <vector>
+
+template<class T> class heavy_hitters {
+  typedef typename std::map<T, long long>::iterator iterator;
+
+  int k;
+  long long n, sum;
+  std::map<T, long long> counters;
+
+  void decrement(long long by) {
+    for (iterator it = counters.begin(); it != counters.end(); ) {
+      sum -= std::min(it->second, by);
+      if ((it->second -= by) <= 0) {
+        counters.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  static bool by_count(const std::pair<T, long long> &a,
+                       const std::pair<T, long long> &b) {
+    return a.second > b.second;
+  }
+
+ public:
+  heavy_hitters(int k) : k(k), n(0), sum(0) {}
+
+  void feed(const T &x) {
+    n++;
+    iterator it = counters.find(x);
+    if (it != counters.end()) {
+      it->second++;
+      sum++;
+    } else if ((int)counters.size() < k) {
+      counters[x] = 1;
+      sum++;
+    } else {
+      decrement(1);
+    }
+  }
+
+  template<class It> void feed(It lo, It hi) {
+    for (; lo != hi; ++lo) {
+      feed(*lo);
+    }
+  }
+
+  void merge(const heavy_hitters &s) {
+    n += s.n;
+    typename std::map<T, long long>::const_iterator it;
+    for (it = s.counters.begin(); it != s.counters.end(); ++it) {
+      counters[it->first] += it->second;
+      sum += it->second;
+    }
+    if ((int)counters.size() > k) {
+      std::vector<long long> counts;
+      for (iterator it = counters.begin(); it != counters.end(); ++it) {
+        counts.push_back(it->second);
+      }
+      std::nth_element(counts.begin(), counts.begin() + k, counts.end(),
+                       std::greater<long long>());
+      decrement(counts[k]);
+    }
+  }
+
+  long long estimate(const T &x) const {
+    typename std::map<T, long long>::const_iterator it = counters.find(x);
+    return (it == counters.end()) ? 0 : it->second;
+  }
+
+  long long error_bound() const {
+    return (n - sum)/(k + 1);
+  }
+
+  void top(std::vector<std::pair<T, long long> > &res) const {
+    res.assign(counters.begin(), counters.end());
+    std::sort(res.begin(), res.end(), by_count);
+  }
+
+  void flush() {
+    counters.clear();
+    n = sum = 0;
+  }
+};
+
+/*** Example Usage and Output:
+
+Top talkers: 10.0.0.1 (55) 10.0.0.2 (29)
+
+***/
 
 #include <cassert>
+#include <iostream>
+#include <string>
+using namespace std;
 
 int main() {
   int a[] = {3, 2, 3, 1, 3};
   assert(*majority(a, a + 5) == 3);
   int b[] = {2, 3, 3, 3, 2, 1};
   assert(majority(b, b + 6) == b + 6);
+
+  // Two shards of a stream of IP addresses, summarized separately then merged.
+  string ip[] = {"10.0.0.1", "10.0.0.2", "10.0.0.3", "10.0.0.4", "10.0.0.5"};
+  heavy_hitters<string> shard1(3), shard2(3);
+  for (int i = 0; i < 100; i++) {
+    shard1.feed(ip[i % 2 == 0 ? 0 : (i % 4 == 1 ? 1 : 2 + i % 3)]);
+    shard2.feed(ip[i % 3 == 0 ? 0 : (i % 3 == 1 ? 1 : 3 + i % 2)]);
+  }
+  shard1.merge(shard2);
+  vector<pair<string, long long> > res;
+  shard1.top(res);
+  assert(res[0].first == ip[0] && res[1].first == ip[1]);
+  assert(shard1.estimate(ip[0]) + shard1.error_bound() >= 84);
+  cout << "Top talkers:";
+  for (int i = 0; i < (int)res.size(); i++) {
+    cout << " " << res[i].first << " (" << res[i].second << ")";
+  }
+  cout << endl;
+  shard1.flush();
+  assert(shard1.estimate(ip[0]) == 0);
   return 0;
 }
@@ -1,52 +1,71 @@
 /*
 
-Given two InputIterators lo and hi specifying a range [lo, hi) of n (not
-necessarily distinct) integers and an integer v, returns the minimum possible
-sum of any subset of the given sequence that is greater than or equal to v.
-This is a generalization of a more well-known version of the subset sum problem
-which asks whether a subset summing to 0 exists (equivalent in this case to
-checking if v = 0 yields an answer of 0). Both problems are NP-complete. This
-meet-in-the-middle algorithm divides the array in two equal parts. All possible
-sums of the lower and higher parts are precomputed into a table and sorted.
-Finally, the table is searched to find the lower bound.
+Given two RandomAccessIterators lo and hi specifying a range [lo, hi) of n (not
+necessarily distinct) integers and an integer v, returns the maximum possible
+sum of any subset of the given sequence that is less than or equal to v, or
+LLONG_MIN if there is none. This is a generalization of a more well-known
+version of the subset sum problem which asks whether a subset summing to v
+exists (equivalent in this case to checking if the answer is v). Both problems
+are NP-complete.
+
+The meet-in-the-middle algorithm divides the array in two equal parts. All
+possible sums of the lower and higher parts are generated in sorted order, by
+starting from the list {0} and, for every element x of the part, merging the
+list with a copy of itself that has x added to every sum. Since every merge is
+linear, this avoids the log factor of sorting. Finally, a two pointer sweep over
+the sorted lists finds the answer. closest_subset_sum() uses the same sweep to
+instead return the subset sum (possibly of the empty subset) closest to v.
+
+If all of the values are nonnegative, a subset sum below v can alternatively be
+found by dynamic programming on a bitset of the sums that are reachable so far,
+shifting the bitset by each element and OR-ing it in, 64 sums at a time.
+sum_lower_bound() chooses whichever of the two engines is expected to be faster
+based on n and v. The bitset never covers more than the sum s of the positive
+values that are at most v, so a huge v with small values stays cheap.
 
 Note that since the sums can get large, 64-bit integers are used in intermediate
 calculations to avoid overflow.
 
-Time Complexity: O(n * 2^(n/2)) on the distance between lo and hi.
-Space Complexity: O(n) auxiliary.
+Time Complexity:
+- O(2^(n/2)) for sum_lower_bound_mitm() and closest_subset_sum().
+- O(n*min(v, s)/64) for sum_lower_bound_bitset().
+- The minimum of the above for sum_lower_bound().
+
+Space Complexity:
+- O(2^(n/2)) auxiliary for sum_lower_bound_mitm() and closest_subset_sum().
+- O(min(v, s)/64) auxiliary for sum_lower_bound_bitset().
 
 */
 
-#include <algorithm>  // std::max(), std::sort()
+#include <algorithm>  // std::max(), std::merge()
+#include <cstdlib>  // llabs()
 #include <limits>  // std::numeric_limits
 #include <vector>
 
 template<class It>
-long long sum_lower_bound(It lo, It hi, long long v) {
-  int n = hi - lo;
-  int llen = 1 << (n/2);
-  int hlen = 1 << (n - n/2);
-  std::vector<long long> lsum(llen), hsum(hlen);
-  for (int mask = 0; mask < llen; mask++) {
-    for (int i = 0; i < n/2; i++) {
-      if ((mask >> i) & 1) {
-        lsum[mask] += *(lo + i);
-      }
+std::vector<long long> sorted_subset_sums(It lo, It hi) {
+  std::vector<long long> sums(1, 0), shifted, merged;
+  for (It it = lo; it != hi; ++it) {
+    shifted.resize(sums.size());
+    for (int i = 0; i < (int)sums.size(); i++) {
+      shifted[i] = sums[i] + *it;
     }
+    merged.resize(2*sums.size());
+    std::merge(sums.begin(), sums.end(), shifted.begin(), shifted.end(),
+               merged.begin());
+    sums.swap(merged);
   }
-  for (int mask = 0; mask < hlen; mask++) {
-    for (int i = 0; i < (n - n/2); i++) {
-      if ((mask >> i) & 1) {
-        hsum[mask] += *(lo + i + n/2);
-      }
-    }
-  }
-  std::sort(lsum.begin(), lsum.end());
-  std::sort(hsum.begin(), hsum.end());
-  int l = 0, r = hlen - 1;
+  return sums;
+}
+
+template<class It>
+long long sum_lower_bound_mitm(It lo, It hi, long long v) {
+  int n = hi - lo;
+  std::vector<long long> lsum = sorted_subset_sums(lo, lo + n/2);
+  std::vector<long long> hsum = sorted_subset_sums(lo + n/2, hi);
+  int l = 0, r = hsum.size() - 1;
   long long curr = std::numeric_limits<long long>::min();
-  while (l < llen && r >= 0) {
+  while (l < (int)lsum.size() && r >= 0) {
     if (lsum[l] + hsum[r] <= v) {
       curr = std::max(curr, lsum[l] + hsum[r]);
       l++;
@@ -57,6 +76,87 @@ long long sum_lower_bound(It lo, It hi, long long v) {
   return curr;
 }
 
+template<class It>
+long long closest_subset_sum(It lo, It hi, long long v) {
+  int n = hi - lo;
+  std::vector<long long> lsum = sorted_subset_sums(lo, lo + n/2);
+  std::vector<long long> hsum = sorted_subset_sums(lo + n/2, hi);
+  int l = 0, r = hsum.size() - 1;
+  long long best = lsum[0] + hsum[r];
+  while (l < (int)lsum.size() && r >= 0) {
+    long long sum = lsum[l] + hsum[r];
+    if (llabs(sum - v) < llabs(best - v)) {
+      best = sum;
+    }
+    if (sum < v) {
+      l++;
+    } else if (sum > v) {
+      r--;
+    } else {
+      break;
+    }
+  }
+  return best;
+}
+
+// The sum of the positive values which are at most v, or v if that is less.
+// No larger subset sum can be at most v, so the bitset stops there.
+template<class It>
+long long reachable_bound(It lo, It hi, long long v) {
+  long long total = 0;
+  for (It it = lo; it != hi && total < v; ++it) {
+    if (*it > 0 && *it <= v)
+      total = (*it > v - total) ? v : total + *it;
+  }
+  return total;
+}
+
+template<class It>
+long long sum_lower_bound_bitset(It lo, It hi, long long v) {
+  if (v < 0)
+    return std::numeric_limits<long long>::min();
+  typedef unsigned long long word;
+  v = reachable_bound(lo, hi, v);
+  size_t words = (size_t)(v/64) + 1;
+  std::vector<word> reach(words, 0);
+  reach[0] = 1;
+  for (It it = lo; it != hi; ++it) {
+    if (*it <= 0 || *it > v)
+      continue;
+    size_t ws = (size_t)(*it / 64);
+    int bs = (int)(*it % 64);
+    for (size_t i = words - 1; i + 1 > ws; i--) {
+      word shifted = reach[i - ws] << bs;
+      if (bs > 0 && i - ws > 0) {
+        shifted |= reach[i - ws - 1] >> (64 - bs);
+      }
+      reach[i] |= shifted;
+    }
+  }
+  for (long long sum = v; ; sum--) {
+    if ((reach[sum/64] >> (sum % 64)) & 1)
+      return sum;
+  }
+}
+
+template<class It>
+long long sum_lower_bound(It lo, It hi, long long v) {
+  long long n = hi - lo;
+  bool nonnegative = true;
+  for (It it = lo; it != hi; ++it) {
+    nonnegative = nonnegative && (*it >= 0);
+  }
+  if (!nonnegative || v < 0)
+    return sum_lower_bound_mitm(lo, hi, v);
+  // Compares n*words to 2^(n/2 + 1) by division, since both may overflow.
+  long long words = reachable_bound(lo, hi, v)/64 + 1;
+  long long mitm = (n >= 124) ? std::numeric_limits<long long>::max()
+                              : (2LL << (n/2));
+  if (n == 0 || words <= mitm/n)
+    return sum_lower_bound_bitset(lo, hi, v);
+  return sum_lower_bound_mitm(lo, hi, v);
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -66,5 +166,13 @@ int main() {
   assert(sum_lower_bound(a, a + 7, 8) == 7);
   int b[] = {-7, -3, -2, 5, 8};
   assert(sum_lower_bound(b, b + 5, 0) == 0);
+  assert(sum_lower_bound_mitm(a, a + 7, 8) == 7);
+  assert(sum_lower_bound_bitset(a, a + 7, 8) == 7);
+  assert(sum_lower_bound_bitset(a, a + 7, 1000) == 32);
+  long long c[] = {1LL << 40, 3, (1LL << 40) + 5, 1LL << 41, 7};
+  assert(sum_lower_bound(c, c + 5, (1LL << 41) + 9) == (1LL << 41) + 8);
+  assert(sum_lower_bound(a, a + 7, 1LL << 62) == 32);
+  assert(closest_subset_sum(b, b + 5, 14) == 13);
+  assert(closest_subset_sum(b, b + 5, -100) == -12);
   return 0;
 }
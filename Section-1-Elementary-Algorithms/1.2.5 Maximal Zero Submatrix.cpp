@@ -45,6 +45,55 @@ int max_zero_submatrix(const std::vector< std::vector<bool> > &matrix) {
   return res;
 }
 
+/*
+
+The version below takes the matrix as packed rows of 64-bit words, where bit j
+of word k of row r (i.e. (rows[r][k] >> j) & 1) is the cell at column 64*k + j.
+The last row of the nearest 1 above each column is only updated for the 1 bits
+of each row, which are iterated a word at a time using __builtin_ctzll(). Whole
+words of 0's are skipped at once, which makes the updates very cheap for sparse
+rasters. The two stack passes use a preallocated array instead of std::stack.
+Any bits of the last word past column m - 1 are ignored. The area is returned
+as a long long, since a packed matrix may have more than 2^31 cells.
+
+Time Complexity: O(n * m) for a matrix n rows by m columns.
+Space Complexity: O(m) auxiliary.
+
+*/
+
+long long max_zero_submatrix(
+    const std::vector< std::vector<unsigned long long> > &rows, int m) {
+  int n = rows.size(), words = (m + 63)/64;
+  unsigned long long last = (m % 64 == 0) ? ~0ULL : (1ULL << (m % 64)) - 1;
+  long long res = 0;
+  std::vector<int> d(m, -1), d1(m), d2(m), s(m);
+  for (int r = 0; r < n; r++) {
+    for (int k = 0; k < words; k++) {
+      unsigned long long w = rows[r][k] & (k == words - 1 ? last : ~0ULL);
+      for (; w != 0; w &= w - 1) {
+        d[64*k + __builtin_ctzll(w)] = r;
+      }
+    }
+    int top = 0;
+    for (int c = 0; c < m; c++) {
+      while (top > 0 && d[s[top - 1]] <= d[c])
+        top--;
+      d1[c] = (top == 0) ? -1 : s[top - 1];
+      s[top++] = c;
+    }
+    top = 0;
+    for (int c = m - 1; c >= 0; c--) {
+      while (top > 0 && d[s[top - 1]] <= d[c])
+        top--;
+      d2[c] = (top == 0) ? m : s[top - 1];
+      s[top++] = c;
+    }
+    for (int j = 0; j < m; j++)
+      res = std::max(res, (long long)(r - d[j])*(d2[j] - d1[j] - 1));
+  }
+  return res;
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -63,5 +112,15 @@ int main() {
     mat[i] = vector<bool>(a[i], a[i] + m);
   }
   assert(max_zero_submatrix(mat) == 6);
+
+  vector<vector<unsigned long long> > packed(n, vector<unsigned long long>(1));
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < m; j++) {
+      packed[i][0] |= (unsigned long long)a[i][j] << j;
+    }
+  }
+  assert(max_zero_submatrix(packed, m) == 6);
+  packed[0][0] |= ~0ULL << m;  // padding past column m - 1 is ignored
+  assert(max_zero_submatrix(packed, m) == 6);
   return 0;
 }
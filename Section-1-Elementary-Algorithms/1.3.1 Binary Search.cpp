@@ -102,10 +102,149 @@ double fbinary_search(double lo, double hi, DoublePredicate pred) {
   return lo;
 }
 
-/*** Example Usage ***/
+/*
+
+Searching Sorted Arrays
+
+branchless_lower_bound() is equivalent to std::lower_bound() on a sorted range
+[lo, hi) of RandomAccessIterators, returning an iterator to the first element
+that does not compare less than x (or hi if there is none). Instead of choosing
+which half to keep with a branch, each iteration unconditionally halves the
+length of the remaining range and advances its base by a conditional move. This
+avoids the branch mispredictions that plague std::lower_bound() when queries
+are unpredictable, at the cost of always performing ceil(log2(n)) iterations.
+
+eytzinger_index stores the sorted keys in the Eytzinger (breadth first) layout
+of an implicit complete binary search tree, where the children of index k are
+2k and 2k + 1. The tree is descended branchlessly, and since the 16 descendants
+of each node four levels down are adjacent in memory, they are prefetched a
+single cache line at a time well before they are needed. The sorted position of
+the result is computed arithmetically from the final node, so no separate array
+of positions has to be accessed. The batched version of lower_bound()
+interleaves the descents of several queries so that their memory accesses
+overlap with one another even further.
+
+- eytzinger_index(lo, hi) constructs an index from the sorted range [lo, hi).
+- lower_bound(x) returns the index (relative to lo) of the first key that does
+  not compare less than x, or n if there is none.
+- lower_bound(qlo, qhi, out) writes the result of lower_bound(x) for every query
+  x in the range [qlo, qhi) to the OutputIterator out.
+
+Time Complexity:
+- O(log n) per call to branchless_lower_bound() and eytzinger_index::lower_bound.
+- O(n) for construction of eytzinger_index.
+
+Space Complexity:
+- O(1) auxiliary for branchless_lower_bound().
+- O(n) for storage of eytzinger_index, and O(1) auxiliary per query.
+
+*/
+
+#include <algorithm>  // std::min()
+#include <vector>
+
+template<class It, class T>
+It branchless_lower_bound(It lo, It hi, const T &x) {
+  int n = hi - lo;
+  if (n == 0)
+    return hi;
+  for (int half; n > 1; n -= half) {
+    half = n/2;
+    lo = (*(lo + half) < x) ? lo + half : lo;
+  }
+  return lo + (*lo < x);
+}
+
+template<class T> class eytzinger_index {
+  static const int BATCH = 16;
+  int n, h;
+  std::vector<T> keys;
+
+  template<class It> int build(It lo, int i, int k) {
+    if (k <= n) {
+      i = build(lo, i, 2*k);
+      keys[k] = *(lo + i++);
+      i = build(lo, i, 2*k + 1);
+    }
+    return i;
+  }
+
+  // Maps the final node of a descent to the sorted position of its result.
+  int position(int k) const {
+    k >>= __builtin_ffs(~k);
+    if (k == 0)
+      return n;
+    int d = 31 - __builtin_clz(k);
+    if (d == h)
+      return 2*(k - (1 << h));
+    int slots = (2*(k - (1 << d)) + 1) << (h - 1 - d);
+    return slots - 1 + std::min(slots, n - (1 << h) + 1);
+  }
 
+ public:
+  template<class It> eytzinger_index(It lo, It hi)
+      : n(hi - lo), h(n > 0 ? 31 - __builtin_clz(n) : 0), keys(n + 1) {
+    build(lo, 0, 1);
+  }
+
+  int lower_bound(const T &x) const {
+    const T *b = &keys[0];
+    int k = 1;
+    while (k <= n) {
+      __builtin_prefetch(b + 16*k);
+      k = 2*k + (b[k] < x);
+    }
+    return position(k);
+  }
+
+  template<class It, class OutIt>
+  OutIt lower_bound(It qlo, It qhi, OutIt out) const {
+    const T *b = &keys[0];
+    int k[BATCH], depth = 0;
+    for (int m = n; m > 0; m >>= 1) {
+      depth++;
+    }
+    while (qlo != qhi) {
+      It q = qlo;
+      int cnt = 0;
+      for (; cnt < BATCH && q != qhi; ++cnt, ++q) {
+        k[cnt] = 1;
+      }
+      for (int d = 0; d <= depth; d++) {
+        q = qlo;
+        for (int j = 0; j < cnt; j++, ++q) {
+          if (k[j] <= n) {
+            __builtin_prefetch(b + 16*k[j]);
+            k[j] = 2*k[j] + (b[k[j]] < *q);
+          }
+        }
+      }
+      for (int j = 0; j < cnt; j++) {
+        *out++ = position(k[j]);
+      }
+      qlo = q;
+    }
+    return out;
+  }
+};
+
+/*** Example Usage and Output:
+
+Searching 1000000 sorted ints with 10000000 random queries...
+std::lower_bound():       2.147s
+branchless_lower_bound(): 1.076s
+eytzinger_index (single): 1.319s
+eytzinger_index (batch):  0.751s
+
+***/
+
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+using namespace std;
 
 // Simple predicate examples.
 bool pred1(int x) { return x >= 3; }
@@ -120,5 +259,55 @@ int main() {
   assert(binary_search_last_true(0, 7, pred3)  == 5);
   assert(binary_search_last_true(0, 7, pred4)  == 6);
   assert(fabs(fbinary_search(-10.0, 10.0, pred5) - 1.2345) < 1e-15);
+
+  int a[] = {1, 3, 3, 5, 8, 13, 21};
+  eytzinger_index<int> small(a, a + 7);
+  for (int len = 0; len <= 7; len++) {
+    eytzinger_index<int> prefix(a, a + len);
+    for (int x = 0; x <= 22; x++) {
+      assert(prefix.lower_bound(x) == lower_bound(a, a + len, x) - a);
+    }
+  }
+  for (int x = 0; x <= 22; x++) {
+    int expected = lower_bound(a, a + 7, x) - a;
+    assert(branchless_lower_bound(a, a + 7, x) - a == expected);
+    assert(small.lower_bound(x) == expected);
+  }
+
+  const int n = 1000000, q = 10000000;
+  vector<int> v(n), queries(q), res1(q), res2(q), res3(q), res4(q);
+  for (int i = 0; i < n; i++) {
+    v[i] = 2*i;
+  }
+  for (int i = 0; i < q; i++) {
+    queries[i] = ((rand() & 0x7fff) | ((rand() & 0x7fff) << 15)) % (2*n + 1);
+  }
+  eytzinger_index<int> index(v.begin(), v.end());
+  cout << "Searching " << n << " sorted ints with " << q << " random queries..."
+       << endl;
+  cout.precision(3);
+  clock_t start = clock();
+  for (int i = 0; i < q; i++) {
+    res1[i] = lower_bound(v.begin(), v.end(), queries[i]) - v.begin();
+  }
+  cout << "std::lower_bound():       " << fixed
+       << (double)(clock() - start)/CLOCKS_PER_SEC << "s" << endl;
+  start = clock();
+  for (int i = 0; i < q; i++) {
+    res2[i] = branchless_lower_bound(v.begin(), v.end(), queries[i]) - v.begin();
+  }
+  cout << "branchless_lower_bound(): " << fixed
+       << (double)(clock() - start)/CLOCKS_PER_SEC << "s" << endl;
+  start = clock();
+  for (int i = 0; i < q; i++) {
+    res3[i] = index.lower_bound(queries[i]);
+  }
+  cout << "eytzinger_index (single): " << fixed
+       << (double)(clock() - start)/CLOCKS_PER_SEC << "s" << endl;
+  start = clock();
+  index.lower_bound(queries.begin(), queries.end(), res4.begin());
+  cout << "eytzinger_index (batch):  " << fixed
+       << (double)(clock() - start)/CLOCKS_PER_SEC << "s" << endl;
+  assert(res1 == res2 && res1 == res3 && res1 == res4);
   return 0;
 }
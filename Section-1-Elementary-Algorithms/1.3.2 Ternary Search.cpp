@@ -13,13 +13,40 @@ returns a number x such that f is strictly increasing on the interval [lo, x]
 and strictly decreasing on the interval [x, hi]. For the function to be correct
 and deterministic, such an x must exist and be unique.
 
-Time Complexity: At most O(log n) calls will be made to f, where n is the
-distance between lo and hi divided by the specified absolute error (epsilon).
+golden_section_min() and golden_section_max() compute the same results as the
+functions above, but place the two probes at the golden ratio so that one of
+them is reused by the next iteration. Only one new call to f is made per
+iteration, and the interval shrinks by a factor of ~0.618 each time. Ternary
+search makes two calls per iteration and shrinks by a factor of 2/3.
 
-Space Complexity: O(1) auxiliary.
+golden_section_batch() optimizes n independent unimodal functions at once.
+Function i has domain [lo[i], hi[i]], and its result is stored in x[i]. The
+objective f must be a batch evaluator. Calling f(n, px, fx) must set fx[i] to
+the value of function i at point px[i] for every i in [0, n). Each iteration
+fills px with exactly one new probe per function, stored in a contiguous array.
+This way an expensive objective can be written as a tight, vectorizable loop
+over structure-of-arrays inputs. If maximize is true, the maxima are found
+instead of the minima.
+
+Time Complexity:
+- ternary_search_min() and ternary_search_max() make at most O(log n) calls to
+  f, where n is the distance between lo and hi divided by the specified
+  absolute error (epsilon). Each iteration makes 2 calls.
+- golden_section_min() and golden_section_max() make O(log n) calls to f. Each
+  iteration makes 1 call, for about 28% fewer calls in total.
+- golden_section_batch() makes O(log w) batch calls to f, where w is the widest
+  domain divided by epsilon. Each batch call evaluates n points, and the rest of
+  each iteration is O(n).
+
+Space Complexity:
+- O(1) auxiliary for all single-function versions.
+- O(n) auxiliary for golden_section_batch().
 
 */
 
+#include <cmath>  // std::ceil(), std::log(), std::sqrt()
+#include <vector>
+
 template<class UnimodalFunction>
 double ternary_search_min(double lo, double hi, UnimodalFunction f) {
   const double EPS = 1e-12;
@@ -50,6 +77,110 @@ double ternary_search_max(double lo, double hi, UnimodalFunction f) {
   return hi;
 }
 
+const double GOLDEN_R = (std::sqrt(5.0) - 1)/2;
+
+template<class UnimodalFunction>
+double golden_section_min(double lo, double hi, UnimodalFunction f) {
+  const double EPS = 1e-12;
+  double x1 = hi - GOLDEN_R*(hi - lo), f1 = f(x1);
+  double x2 = lo + GOLDEN_R*(hi - lo), f2 = f(x2);
+  while (hi - lo > EPS) {
+    if (f1 < f2) {
+      hi = x2;
+      x2 = x1;
+      f2 = f1;
+      x1 = hi - GOLDEN_R*(hi - lo);
+      f1 = f(x1);
+    } else {
+      lo = x1;
+      x1 = x2;
+      f1 = f2;
+      x2 = lo + GOLDEN_R*(hi - lo);
+      f2 = f(x2);
+    }
+  }
+  return lo;
+}
+
+template<class UnimodalFunction>
+double golden_section_max(double lo, double hi, UnimodalFunction f) {
+  const double EPS = 1e-12;
+  double x1 = hi - GOLDEN_R*(hi - lo), f1 = f(x1);
+  double x2 = lo + GOLDEN_R*(hi - lo), f2 = f(x2);
+  while (hi - lo > EPS) {
+    if (f1 < f2) {
+      lo = x1;
+      x1 = x2;
+      f1 = f2;
+      x2 = lo + GOLDEN_R*(hi - lo);
+      f2 = f(x2);
+    } else {
+      hi = x2;
+      x2 = x1;
+      f2 = f1;
+      x1 = hi - GOLDEN_R*(hi - lo);
+      f1 = f(x1);
+    }
+  }
+  return hi;
+}
+
+// All intervals shrink by the same ratio, so every function runs for the same
+// number of iterations. This is determined by the widest domain. Keeping the
+// functions in lockstep lets each iteration issue a single batch call.
+template<class BatchFunction>
+void golden_section_batch(int n, const double *lo, const double *hi,
+                          BatchFunction f, double *x, bool maximize = false) {
+  const double EPS = 1e-12;
+  if (n <= 0) {
+    return;
+  }
+  std::vector<double> a(lo, lo + n), b(hi, hi + n);
+  std::vector<double> x1(n), x2(n), f1(n), f2(n), px(n), fx(n);
+  std::vector<char> left(n);
+  double sign = maximize ? -1 : 1, width = 0;
+  for (int i = 0; i < n; i++) {
+    if (b[i] - a[i] > width) {
+      width = b[i] - a[i];
+    }
+    x1[i] = b[i] - GOLDEN_R*(b[i] - a[i]);
+    x2[i] = a[i] + GOLDEN_R*(b[i] - a[i]);
+  }
+  f(n, &x1[0], &f1[0]);
+  f(n, &x2[0], &f2[0]);
+  int iterations = 0;
+  if (width > EPS) {
+    iterations = (int)std::ceil(std::log(EPS/width)/std::log(GOLDEN_R));
+  }
+  for (int it = 0; it < iterations; it++) {
+    for (int i = 0; i < n; i++) {
+      left[i] = (sign*f1[i] < sign*f2[i]);
+      if (left[i]) {
+        b[i] = x2[i];
+        x2[i] = x1[i];
+        f2[i] = f1[i];
+        px[i] = x1[i] = b[i] - GOLDEN_R*(b[i] - a[i]);
+      } else {
+        a[i] = x1[i];
+        x1[i] = x2[i];
+        f1[i] = f2[i];
+        px[i] = x2[i] = a[i] + GOLDEN_R*(b[i] - a[i]);
+      }
+    }
+    f(n, &px[0], &fx[0]);
+    for (int i = 0; i < n; i++) {
+      if (left[i]) {
+        f1[i] = fx[i];
+      } else {
+        f2[i] = fx[i];
+      }
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    x[i] = maximize ? b[i] : a[i];
+  }
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -74,9 +205,59 @@ double f3(double x) {
   return fabs(x - 30);
 }
 
+// A batch of parabolas, where the i-th one is (x - c[i])^2 + 1.
+struct shifted_parabolas {
+  const double *c;
+  int *calls;
+
+  shifted_parabolas(const double *c, int *calls) : c(c), calls(calls) {}
+
+  void operator()(int n, const double *x, double *fx) const {
+    for (int i = 0; i < n; i++) {
+      fx[i] = (x[i] - c[i])*(x[i] - c[i]) + 1;
+    }
+    (*calls)++;
+  }
+};
+
+// As above, but negated so that each function has a maximum at c[i].
+struct negated_parabolas {
+  const double *c;
+
+  negated_parabolas(const double *c) : c(c) {}
+
+  void operator()(int n, const double *x, double *fx) const {
+    for (int i = 0; i < n; i++) {
+      fx[i] = -(x[i] - c[i])*(x[i] - c[i]);
+    }
+  }
+};
+
 int main() {
   assert(eq(ternary_search_min(-1000, 1000, f1), -2));
   assert(eq(ternary_search_max(-1000, 1000, f2), 2.0/19));
   assert(eq(ternary_search_min(-1000, 1000, f3), 30));
+  assert(eq(golden_section_min(-1000, 1000, f1), -2));
+  assert(eq(golden_section_max(-1000, 1000, f2), 2.0/19));
+  assert(eq(golden_section_min(-1000, 1000, f3), 30));
+  const int n = 1000;
+  std::vector<double> lo(n), hi(n), c(n), x(n);
+  for (int i = 0; i < n; i++) {
+    c[i] = i*0.37 - 100;
+    lo[i] = c[i] - 1 - i % 7;
+    hi[i] = c[i] + 1 + i % 11;
+  }
+  int calls = 0;
+  golden_section_batch(n, &lo[0], &hi[0], shifted_parabolas(&c[0], &calls),
+                       &x[0]);
+  for (int i = 0; i < n; i++) {
+    assert(eq(x[i], c[i]));
+  }
+  assert(calls < 70);
+  golden_section_batch(n, &lo[0], &hi[0], negated_parabolas(&c[0]), &x[0],
+                       true);
+  for (int i = 0; i < n; i++) {
+    assert(eq(x[i], c[i]));
+  }
   return 0;
 }
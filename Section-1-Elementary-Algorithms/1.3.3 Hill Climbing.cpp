@@ -13,25 +13,64 @@ and the same process repeats until a desired absolute error is reached. The
 technique's success heavily depends on the behavior of f and the initial guess.
 Therefore, the result is not guaranteed to be the global minimum.
 
-Time Complexity: At most O(d log n) call will be made to f, where d is the
-number of directions considered at each position and n is the search space that
-is approximately proportional to the maximum possible step size divided by the
-minimum possible step size.
+find_min_multistart() runs n climbers from pseudorandom starting points in the
+rectangle [xlo, xhi] by [ylo, yhi] and returns the best minimum found. With no
+climbers there is no minimum to return, so an exception is thrown if n < 1. The
+climbers advance in lockstep rounds of one iteration each and share the
+best-so-far value. A climber is pruned once its step size drops below
+prune_step while its value is still worse than the best-so-far. At that point
+it has settled into a worse basin and can only refine a losing answer.
 
-Space Complexity: O(1) auxiliary.
+If quantum is positive, every call to f goes through an evaluation_cache shared
+by all climbers. The cache is keyed on the coordinates rounded to the nearest
+multiple of quantum, and f is evaluated at the rounded point. The same point is
+then never evaluated twice, which matters when f is expensive. The precision of
+the answer is then limited to roughly quantum. If stats is not null, it is
+filled with one climb_stats per climber. Each records that climber's iteration
+count, the number of evaluations it requested, whether it was pruned, and where
+it stopped.
+
+Time Complexity:
+- find_min() makes at most O(d log n) calls to f. Here d is the number of
+  directions considered at each position. n is the search space, which is
+  approximately the maximum step size divided by the minimum step size.
+- find_min_multistart() makes at most O(c d log n) calls to f for c climbers.
+  Pruning and the cache usually cut this down considerably. Each cached
+  evaluation also costs O(log m), where m is the number of distinct points
+  evaluated so far.
+
+Space Complexity:
+- O(1) auxiliary for find_min().
+- O(c + m) auxiliary for find_min_multistart().
 
 */
 
 #include <cmath>
+#include <map>
+#include <stdexcept>  // std::runtime_error()
+#include <utility>  // std::pair
+#include <vector>
 
 template<class BinaryFunction>
-double find_min(BinaryFunction f, double x0, double y0,
-                double *x_ans = 0, double *y_ans = 0) {
-  const double PI = acos(-1.0);
-  const double STEP_MIN = 1e-9, STEP_MAX = 1e6;
-  const int NUM_DIRECTIONS = 6;
-  double x = x0, y = y0, res = f(x0, y0);
-  for (double step = STEP_MAX; step > STEP_MIN; ) {
+struct hill_climber {
+  BinaryFunction f;
+  double x, y, res, step;
+  int iterations, evaluations;
+
+  hill_climber(BinaryFunction f, double x0, double y0)
+      : f(f), x(x0), y(y0), res(f(x0, y0)), iterations(0), evaluations(1) {
+    const double STEP_MAX = 1e6;
+    step = STEP_MAX;
+  }
+
+  bool done() const {
+    const double STEP_MIN = 1e-9;
+    return step <= STEP_MIN;
+  }
+
+  void iterate() {
+    const double PI = acos(-1.0);
+    const int NUM_DIRECTIONS = 6;
     double best = res, best_x = x, best_y = y;
     bool found = false;
     for (int i = 0; i < NUM_DIRECTIONS; i++) {
@@ -46,6 +85,8 @@ double find_min(BinaryFunction f, double x0, double y0,
         found = true;
       }
     }
+    evaluations += NUM_DIRECTIONS;
+    iterations++;
     if (!found) {
       step /= 2.0;
     } else {
@@ -54,11 +95,142 @@ double find_min(BinaryFunction f, double x0, double y0,
       res = best;
     }
   }
+};
+
+template<class BinaryFunction>
+double find_min(BinaryFunction f, double x0, double y0,
+                double *x_ans = 0, double *y_ans = 0) {
+  hill_climber<BinaryFunction> c(f, x0, y0);
+  while (!c.done()) {
+    c.iterate();
+  }
   if (x_ans != 0 && y_ans != 0) {
-    *x_ans = x;
-    *y_ans = y;
+    *x_ans = c.x;
+    *y_ans = c.y;
   }
-  return res;
+  return c.res;
+}
+
+struct climb_stats {
+  int iterations, evaluations;
+  bool pruned;
+  double x, y, value;
+};
+
+struct evaluation_cache {
+  double quantum;
+  int hits, misses;
+  std::map<std::pair<long long, long long>, double> values;
+
+  evaluation_cache(double quantum) : quantum(quantum), hits(0), misses(0) {}
+};
+
+// Copies of a memoized function share the cache through a pointer, so the same
+// cache is used even though the climbers each keep their own copy of f.
+template<class BinaryFunction>
+struct memoized {
+  BinaryFunction f;
+  evaluation_cache *cache;
+
+  memoized(BinaryFunction f, evaluation_cache *cache) : f(f), cache(cache) {}
+
+  double operator()(double x, double y) const {
+    std::pair<long long, long long> key(
+        (long long)floor(x/cache->quantum + 0.5),
+        (long long)floor(y/cache->quantum + 0.5));
+    std::map<std::pair<long long, long long>, double>::iterator it =
+        cache->values.lower_bound(key);
+    if (it != cache->values.end() && it->first == key) {
+      cache->hits++;
+      return it->second;
+    }
+    cache->misses++;
+    double val = f(key.first*cache->quantum, key.second*cache->quantum);
+    cache->values.insert(it, std::make_pair(key, val));
+    return val;
+  }
+};
+
+template<class BinaryFunction>
+double multistart(BinaryFunction f, int n, double xlo, double xhi, double ylo,
+                  double yhi, double *x_ans, double *y_ans,
+                  std::vector<climb_stats> *stats, double prune_step,
+                  unsigned int seed) {
+  if (n < 1) {
+    throw std::runtime_error("Need at least one climber.");
+  }
+  std::vector<hill_climber<BinaryFunction> > c;
+  std::vector<bool> pruned(n, false);
+  unsigned long long state = seed*2654435761ULL + 1;
+  for (int i = 0; i < n; i++) {
+    double r[2];
+    for (int j = 0; j < 2; j++) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      r[j] = (state >> 11)*(1.0/9007199254740992.0);
+    }
+    c.push_back(hill_climber<BinaryFunction>(f, xlo + r[0]*(xhi - xlo),
+                                             ylo + r[1]*(yhi - ylo)));
+  }
+  int best = 0;
+  for (int i = 1; i < n; i++) {
+    if (c[i].res < c[best].res) {
+      best = i;
+    }
+  }
+  for (int live = n; live > 0; ) {
+    live = 0;
+    for (int i = 0; i < n; i++) {
+      if (pruned[i] || c[i].done()) {
+        continue;
+      }
+      c[i].iterate();
+      if (c[i].res < c[best].res) {
+        best = i;
+      }
+      live++;
+    }
+    for (int i = 0; i < n; i++) {
+      if (i != best && !pruned[i] && c[i].step < prune_step &&
+          c[i].res > c[best].res) {
+        pruned[i] = true;
+      }
+    }
+  }
+  if (stats != 0) {
+    stats->resize(n);
+    for (int i = 0; i < n; i++) {
+      climb_stats &s = (*stats)[i];
+      s.iterations = c[i].iterations;
+      s.evaluations = c[i].evaluations;
+      s.pruned = pruned[i];
+      s.x = c[i].x;
+      s.y = c[i].y;
+      s.value = c[i].res;
+    }
+  }
+  if (x_ans != 0 && y_ans != 0) {
+    *x_ans = c[best].x;
+    *y_ans = c[best].y;
+  }
+  return c[best].res;
+}
+
+template<class BinaryFunction>
+double find_min_multistart(BinaryFunction f, int n, double xlo, double xhi,
+                           double ylo, double yhi, double *x_ans = 0,
+                           double *y_ans = 0,
+                           std::vector<climb_stats> *stats = 0,
+                           double quantum = 0, double prune_step = 1e-3,
+                           unsigned int seed = 1) {
+  if (quantum <= 0) {
+    return multistart(f, n, xlo, xhi, ylo, yhi, x_ans, y_ans, stats,
+                      prune_step, seed);
+  }
+  evaluation_cache cache(quantum);
+  return multistart(memoized<BinaryFunction>(f, &cache), n, xlo, xhi, ylo, yhi,
+                    x_ans, y_ans, stats, prune_step, seed);
 }
 
 /*** Example Usage ***/
@@ -75,9 +247,43 @@ double f(double x, double y) {
   return (x - 2)*(x - 2) + (y - 3)*(y - 3);
 }
 
+// Counts calls to the underlying objective.
+int calls = 0;
+
+// Multimodal function with many local minima and a global minimum f(1, -1) = 0.
+double g(double x, double y) {
+  calls++;
+  double dx = x - 1, dy = y + 1;
+  return dx*dx + dy*dy + 4*(2 - cos(3*dx) - cos(3*dy));
+}
+
 int main() {
   double x, y;
   assert(eq(find_min(f, 0, 0, &x, &y), 0));
   assert(eq(x, 2) && eq(y, 3));
+
+  std::vector<climb_stats> stats;
+  assert(eq(find_min_multistart(g, 16, -10, 10, -10, 10, &x, &y, &stats), 0));
+  assert(eq(x, 1) && eq(y, -1));
+  int requested = 0, pruned = 0;
+  for (int i = 0; i < (int)stats.size(); i++) {
+    requested += stats[i].evaluations;
+    pruned += stats[i].pruned;
+  }
+  assert(requested == calls && pruned > 0);
+
+  calls = 0;
+  double res = find_min_multistart(g, 16, -10, 10, -10, 10, &x, &y, 0, 1e-6);
+  assert(fabs(res) < 1e-9);
+  assert(fabs(x - 1) < 1e-6 && fabs(y + 1) < 1e-6);
+  assert(calls < requested);
+
+  bool thrown = false;
+  try {
+    find_min_multistart(g, 0, -10, 10, -10, 10, &x, &y);
+  } catch (std::runtime_error &) {
+    thrown = true;
+  }
+  assert(thrown);
   return 0;
 }
@@ -13,13 +13,20 @@ x are satisfied. As a result, it may be necessary to sort the lines/queries
 before calling the functions. In that case, the overall time complexity will be
 dominated by the sorting step.
 
+get_min() answers monotone queries by walking a pointer forward along the hull,
+never binary searching. If some queries arrive out of order, call
+get_min_search(x) for those instead. It binary searches the hull in O(log n)
+without requiring x to be the maximum so far, and does not disturb the pointer
+used by get_min().
+
 Explanation of technique: http://wcipeg.com/wiki/Convex_hull_trick
 
 Time Complexity: O(n) on the total number of calls made to add_line(), for any
 interlaced sequence of add_line() and get_min() calls. This is because the
 overall number of steps taken by add_line() and get_min() are respectively
 bounded by the number of lines added so far. As such, a single call to either
-add_line() or get_min() will have an O(1) amortized running time.
+add_line() or get_min() will have an O(1) amortized running time. A call to
+get_min_search() is O(log n) on the number of lines added so far.
 
 Space Complexity: O(n) auxiliary on the number of calls made to add_line().
 
@@ -53,6 +60,19 @@ long long get_min(long long x) {
   return M[ptr]*x + B[ptr];
 }
 
+long long get_min_search(long long x) {
+  int lo = 0, hi = (int)M.size() - 1;
+  while (lo < hi) {
+    int mid = lo + (hi - lo)/2;
+    if (M[mid + 1]*x + B[mid + 1] <= M[mid]*x + B[mid]) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return M[lo]*x + B[lo];
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -66,5 +86,8 @@ int main() {
   assert(get_min(1) == 3);
   assert(get_min(2) == 4);
   assert(get_min(3) == 5);
+  assert(get_min_search(1) == 3);
+  assert(get_min_search(-2) == -6);
+  assert(get_min_search(10) == 6);
   return 0;
 }
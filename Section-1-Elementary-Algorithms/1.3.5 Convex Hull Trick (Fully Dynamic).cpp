@@ -11,17 +11,38 @@ support the ability to call add_line() and get_best() in any desired order.
 
 Explanation: http://wcipeg.com/wiki/Convex_hull_trick#Fully_dynamic_variant
 
-Time Complexity: O(n log n) on the total number of calls made to add_line(), for
-any length n sequence of arbitrarily interlaced add_line() and get_min() calls.
-Each individual call to add_line() is O(log n) amortized and each individual
-call to get_best() is O(log n), where n is the number of lines added so far.
+li_chao_tree is an alternative engine for the same problem, for when all query
+x-coordinates are integers in a known range [lo, hi]. It also supports
+add_segment(m, b, l, r), which adds a line that only applies to x in [l, r].
+Nodes are created on demand in a single vector that serves as an arena. There
+are no per-node heap allocations, and no floating point intersections are
+computed. clear() removes every line but keeps the arena's capacity, so the
+tree can be reused across test cases without any reallocation. Querying an x
+covered by no line returns the largest long long, or the smallest if query_max
+is true.
 
-Space Complexity: O(n) auxiliary on the number of calls made to add_line().
+Explanation: https://cp-algorithms.com/geometry/convex_hull_trick.html
+
+Time Complexity:
+- O(n log n) for hull_optimizer, for any sequence of n arbitrarily interlaced
+  add_line() and get_best() calls. Each individual call to add_line() is
+  O(log n) amortized, and each call to get_best() is O(log n). Here n is the
+  number of lines added so far.
+- O(log r) per call to add_line() and get_best() for li_chao_tree, and
+  O(log^2 r) per call to add_segment(). Here r = hi - lo + 1.
+
+Space Complexity:
+- O(n) auxiliary for hull_optimizer, on the number of calls made to
+  add_line().
+- O(min(n log r, r)) auxiliary for li_chao_tree, on the number of lines added.
+  Only n + 1 nodes are needed if add_segment() is never called.
 
 */
 
+#include <algorithm>  // std::swap()
 #include <limits>  // std::numeric_limits
 #include <set>
+#include <vector>
 
 class hull_optimizer {
   struct line {
@@ -130,6 +151,153 @@ class hull_optimizer {
   }
 };
 
+class li_chao_tree {
+  struct node {
+    long long m, b;
+    int left, right;
+
+    node(long long m, long long b) : m(m), b(b), left(-1), right(-1) {}
+
+    long long eval(long long x) const {
+      return m*x + b;
+    }
+
+    // Whether the node holds no line, only the sentinel of an empty node.
+    bool empty() const {
+      return m == 0 && b == std::numeric_limits<long long>::max();
+    }
+  };
+
+  std::vector<node> arena;
+  long long lo, hi;
+  bool query_max;
+
+  int new_node(long long m, long long b) {
+    arena.push_back(node(m, b));
+    return (int)arena.size() - 1;
+  }
+
+  // Lines are stored negated when querying for maximum so that the tree itself
+  // only ever has to keep minimums.
+  void insert(int k, long long l, long long r, long long m, long long b) {
+    for (;;) {
+      if (arena[k].empty()) {
+        arena[k].m = m;
+        arena[k].b = b;
+        return;
+      }
+      long long mid = l + (r - l)/2;
+      bool lbetter = m*l + b < arena[k].eval(l);
+      bool mbetter = m*mid + b < arena[k].eval(mid);
+      if (mbetter) {
+        std::swap(arena[k].m, m);
+        std::swap(arena[k].b, b);
+      }
+      if (l == r) {
+        return;
+      }
+      if (lbetter != mbetter) {
+        if (arena[k].left < 0) {
+          int c = new_node(m, b);
+          arena[k].left = c;
+          return;
+        }
+        k = arena[k].left;
+        r = mid;
+      } else {
+        if (arena[k].right < 0) {
+          int c = new_node(m, b);
+          arena[k].right = c;
+          return;
+        }
+        k = arena[k].right;
+        l = mid + 1;
+      }
+    }
+  }
+
+  void insert_segment(int k, long long l, long long r, long long m, long long b,
+                      long long ql, long long qr) {
+    if (qr < l || r < ql) {
+      return;
+    }
+    if (ql <= l && r <= qr) {
+      insert(k, l, r, m, b);
+      return;
+    }
+    long long mid = l + (r - l)/2;
+    if (ql <= mid) {
+      if (arena[k].left < 0) {
+        int c = new_node(0, std::numeric_limits<long long>::max());
+        arena[k].left = c;
+      }
+      insert_segment(arena[k].left, l, mid, m, b, ql, qr);
+    }
+    if (mid < qr) {
+      if (arena[k].right < 0) {
+        int c = new_node(0, std::numeric_limits<long long>::max());
+        arena[k].right = c;
+      }
+      insert_segment(arena[k].right, mid + 1, r, m, b, ql, qr);
+    }
+  }
+
+ public:
+  li_chao_tree(long long lo, long long hi, bool query_max = false,
+               int reserve_nodes = 0) : lo(lo), hi(hi), query_max(query_max) {
+    arena.reserve(reserve_nodes + 1);
+    clear();
+  }
+
+  void clear() {
+    arena.clear();
+    new_node(0, std::numeric_limits<long long>::max());
+  }
+
+  int nodes() const {
+    return (int)arena.size();
+  }
+
+  void add_line(long long m, long long b) {
+    if (query_max) {
+      insert(0, lo, hi, -m, -b);
+    } else {
+      insert(0, lo, hi, m, b);
+    }
+  }
+
+  void add_segment(long long m, long long b, long long l, long long r) {
+    if (query_max) {
+      insert_segment(0, lo, hi, -m, -b, l, r);
+    } else {
+      insert_segment(0, lo, hi, m, b, l, r);
+    }
+  }
+
+  long long get_best(long long x) const {
+    long long l = lo, r = hi, res = std::numeric_limits<long long>::max();
+    for (int k = 0; k >= 0; ) {
+      long long val = arena[k].eval(x);
+      if (val < res) {
+        res = val;
+      }
+      long long mid = l + (r - l)/2;
+      if (x <= mid) {
+        k = arena[k].left;
+        r = mid;
+      } else {
+        k = arena[k].right;
+        l = mid + 1;
+      }
+    }
+    if (query_max) {
+      return (res == std::numeric_limits<long long>::max())
+                 ? std::numeric_limits<long long>::min() : -res;
+    }
+    return res;
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -144,5 +312,29 @@ int main() {
   assert(h.get_best(2) == 4);
   assert(h.get_best(1) == 3);
   assert(h.get_best(3) == 5);
+
+  li_chao_tree t(-1000, 1000);
+  t.add_line(3, 0);
+  t.add_line(0, 6);
+  t.add_line(1, 2);
+  t.add_line(2, 1);
+  assert(t.get_best(0) == 0);
+  assert(t.get_best(2) == 4);
+  assert(t.get_best(1) == 3);
+  assert(t.get_best(3) == 5);
+  assert(t.get_best(-5) == -15);
+  assert(t.nodes() == 4);  // The first line fills the empty root.
+
+  li_chao_tree s(0, 100, true);
+  assert(s.get_best(50) == std::numeric_limits<long long>::min());
+  s.add_segment(1, 0, 0, 50);
+  s.add_segment(-1, 100, 40, 100);
+  s.add_segment(0, 55, 30, 45);
+  assert(s.get_best(10) == 10);
+  assert(s.get_best(35) == 55);
+  assert(s.get_best(48) == 52);
+  assert(s.get_best(80) == 20);
+  s.clear();
+  assert(s.nodes() == 1);
   return 0;
 }
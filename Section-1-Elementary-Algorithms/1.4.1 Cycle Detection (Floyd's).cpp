@@ -23,14 +23,26 @@ pointers is the start of the sequence.
 
 Explanation: https://en.wikipedia.org/wiki/Cycle_detection#Tortoise_and_hare
 
+find_cycles() runs the same algorithm on n independent sequences at once. The
+i-th sequence starts at x0[i], and its (position, length) is stored in mu[i] and
+lambda[i]. The sequences advance in lockstep in structure-of-arrays form. Every
+step first applies f to a contiguous array of the still unfinished sequences in
+a tight loop, which the compiler can vectorize when f is a simple inlinable
+arithmetic map. Only then does it compare values. A sequence that finishes a
+phase is swapped out of the active range, so no calls to f are wasted on it.
+Disjoint ranges of seeds may be processed independently.
+
 Time Complexity: O(mu + lambda), where mu is the smallest index of the sequence
-which is the beginning of a cycle, and lambda is the cycle's length.
+which is the beginning of a cycle, and lambda is the cycle's length. For
+find_cycles(), this is the sum of (mu[i] + lambda[i]) over all sequences.
 
-Space Complexity: O(1) auxiliary.
+Space Complexity: O(1) auxiliary for find_cycle(), and O(n) auxiliary for
+find_cycles().
 
 */
 
 #include <utility>  // std::pair
+#include <vector>
 
 template<class IntFunction>
 std::pair<int, int> find_cycle(IntFunction f, int x0) {
@@ -55,10 +67,87 @@ std::pair<int, int> find_cycle(IntFunction f, int x0) {
   return std::make_pair(start, length);
 }
 
+// Finishes the lane at index i of the active range [0, m) by moving the last
+// active lane into its slot.
+inline void remove_lane(int i, int m, std::vector<int> &id, std::vector<int> &a,
+                        std::vector<int> &b, std::vector<int> &c) {
+  id[i] = id[m - 1];
+  a[i] = a[m - 1];
+  b[i] = b[m - 1];
+  c[i] = c[m - 1];
+}
+
+template<class IntFunction>
+void find_cycles(IntFunction f, int n, const int *x0, int *mu, int *lambda) {
+  std::vector<int> id(n), tortoise(n), hare(n), steps(n), meet(n);
+  for (int i = 0; i < n; i++) {
+    id[i] = i;
+    tortoise[i] = f(x0[i]);
+    hare[i] = f(tortoise[i]);
+  }
+  for (int m = n; m > 0; ) {
+    for (int i = 0; i < m; ) {
+      if (tortoise[i] == hare[i]) {
+        meet[id[i]] = hare[i];
+        remove_lane(i, m--, id, tortoise, hare, steps);
+      } else {
+        i++;
+      }
+    }
+    for (int i = 0; i < m; i++) {
+      tortoise[i] = f(tortoise[i]);
+      hare[i] = f(f(hare[i]));
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    id[i] = i;
+    tortoise[i] = x0[i];
+    hare[i] = meet[i];
+    steps[i] = 0;
+  }
+  for (int m = n; m > 0; ) {
+    for (int i = 0; i < m; ) {
+      if (tortoise[i] == hare[i]) {
+        mu[id[i]] = steps[i];
+        meet[id[i]] = tortoise[i];
+        remove_lane(i, m--, id, tortoise, hare, steps);
+      } else {
+        i++;
+      }
+    }
+    for (int i = 0; i < m; i++) {
+      tortoise[i] = f(tortoise[i]);
+      hare[i] = f(hare[i]);
+      steps[i]++;
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    id[i] = i;
+    tortoise[i] = meet[i];
+    hare[i] = f(meet[i]);
+    steps[i] = 1;
+  }
+  for (int m = n; m > 0; ) {
+    for (int i = 0; i < m; ) {
+      if (tortoise[i] == hare[i]) {
+        lambda[id[i]] = steps[i];
+        remove_lane(i, m--, id, tortoise, hare, steps);
+      } else {
+        i++;
+      }
+    }
+    for (int i = 0; i < m; i++) {
+      hare[i] = f(hare[i]);
+      steps[i]++;
+    }
+  }
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
 #include <set>
+#include <vector>
 using namespace std;
 
 int f(int x) {
@@ -88,5 +177,16 @@ int main () {
   pair<int, int> res = find_cycle(f, x0);
   assert(res == make_pair(4, 2));
   verify(x0, res.first, res.second);
+
+  const int n = 1337;
+  vector<int> seeds(n), mu(n), lambda(n);
+  for (int i = 0; i < n; i++) {
+    seeds[i] = i;
+  }
+  find_cycles(f, n, &seeds[0], &mu[0], &lambda[0]);
+  for (int i = 0; i < n; i++) {
+    assert(find_cycle(f, seeds[i]) == make_pair(mu[i], lambda[i]));
+    verify(seeds[i], mu[i], lambda[i]);
+  }
   return 0;
 }
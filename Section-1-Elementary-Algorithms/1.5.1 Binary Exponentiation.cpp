@@ -11,13 +11,40 @@ exponentiation into a logarithmic number of multiplications while avoiding
 overflow. To further prevent overflow in the intermediate squaring computations,
 multiplication is performed using a similar principle of repeated addition.
 
-Time Complexity: Both functions are O(log n) with respect to their second
-argument n.
+For repeated exponentiation under a fixed modulus, a reduction engine is faster.
+It replaces the O(log n) loop in mulmod() with a constant number of word
+multiplications. Three engines are provided, and all share the same interface.
+Values are first converted into the engine's internal form with to(), combined
+with mul(), then converted back with from().
 
-Space Complexity: O(1) auxiliary.
+- montgomery64(m) works for any odd modulus m < 2^63. Products are reduced with
+  Montgomery's REDC algorithm, which needs no division at all.
+- barrett32(m) works for any modulus m < 2^32. Products are reduced by a
+  multiplication with a precomputed reciprocal of m.
+- static_mod<M> works for a compile-time constant modulus M < 2^32. Reducing by
+  a constant lets the compiler replace the division with a multiply and shift.
+  With M fixed, the whole computation can be specialized and inlined.
+
+window_powmod(r, x, n) computes x^n using engine r. It uses sliding 4-bit
+windows over the exponent, so only about log2(n)/5 multiplications are needed
+on top of the squarings. window_powmod_batch(r, lo, hi, n, out) raises every
+base in [lo, hi) to the same power n, writing the results to out. The exponent
+is recoded into windows only once for the whole batch.
+
+Time Complexity:
+- mulmod() and powmod() are both O(log n) with respect to their second
+  argument n.
+- Engine construction is O(log m), and mul(), to() and from() are O(1).
+- window_powmod() is O(log n). window_powmod_batch() is O(k log n) for k bases.
+
+Space Complexity: O(1) auxiliary for every function, except for
+window_powmod_batch() which uses O(log n) auxiliary for the recoded exponent.
 
 */
 
+#include <utility>  // std::make_pair(), std::pair
+#include <vector>
+
 typedef unsigned long long int64;
 
 int64 mulmod(int64 x, int64 n, int64 m) {
@@ -42,6 +69,186 @@ int64 powmod(int64 x, int64 n, int64 m) {
   return a % m;
 }
 
+// Computes the full 128-bit product of a and b as hi*2^64 + lo.
+inline void mul128(int64 a, int64 b, int64 &hi, int64 &lo) {
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 p = (unsigned __int128)a*b;
+  hi = (int64)(p >> 64);
+  lo = (int64)p;
+#else
+  int64 a0 = a & 0xffffffffULL, a1 = a >> 32;
+  int64 b0 = b & 0xffffffffULL, b1 = b >> 32;
+  int64 p00 = a0*b0, p01 = a0*b1, p10 = a1*b0, p11 = a1*b1;
+  int64 mid = (p00 >> 32) + (p01 & 0xffffffffULL) + (p10 & 0xffffffffULL);
+  hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+  lo = (mid << 32) | (p00 & 0xffffffffULL);
+#endif
+}
+
+class montgomery64 {
+  int64 m, neg_inv, r2;
+
+  // Returns t*2^-64 (mod m) for t = hi*2^64 + lo, given hi < m.
+  int64 reduce(int64 hi, int64 lo) const {
+    int64 qhi, qlo;
+    mul128(lo*neg_inv, m, qhi, qlo);
+    int64 t = hi + qhi + (lo != 0);
+    return (t >= m) ? t - m : t;
+  }
+
+ public:
+  montgomery64(int64 m) : m(m) {
+    int64 inv = m;
+    for (int i = 0; i < 5; i++) {
+      inv *= 2 - m*inv;
+    }
+    neg_inv = -inv;
+    r2 = -m % m;
+    for (int i = 0; i < 64; i++) {
+      r2 <<= 1;
+      if (r2 >= m) {
+        r2 -= m;
+      }
+    }
+  }
+
+  int64 modulus() const {
+    return m;
+  }
+
+  int64 mul(int64 a, int64 b) const {
+    int64 hi, lo;
+    mul128(a, b, hi, lo);
+    return reduce(hi, lo);
+  }
+
+  int64 to(int64 x) const {
+    return mul(x % m, r2);
+  }
+
+  int64 from(int64 x) const {
+    return reduce(0, x);
+  }
+};
+
+class barrett32 {
+  int64 m, inv;
+
+ public:
+  barrett32(int64 m) : m(m), inv(~0ULL/m) {}
+
+  int64 modulus() const {
+    return m;
+  }
+
+  int64 mul(int64 a, int64 b) const {
+    int64 x = a*b, q, lo;
+    mul128(x, inv, q, lo);
+    int64 r = x - q*m;
+    if (r >= m) {
+      r -= m;
+    }
+    return (r >= m) ? r - m : r;
+  }
+
+  int64 to(int64 x) const {
+    return x % m;
+  }
+
+  int64 from(int64 x) const {
+    return x;
+  }
+};
+
+template<int64 M>
+struct static_mod {
+  int64 modulus() const {
+    return M;
+  }
+
+  int64 mul(int64 a, int64 b) const {
+    return a*b % M;
+  }
+
+  int64 to(int64 x) const {
+    return x % M;
+  }
+
+  int64 from(int64 x) const {
+    return x;
+  }
+};
+
+// Recodes n into sliding windows, from the most significant bit down. Each
+// window is a pair of (number of squarings, odd digit to multiply by). A digit
+// of 0 marks trailing squarings with no multiplication.
+inline void recode_exponent(int64 n, std::vector<std::pair<int, int> > &ops) {
+  const int W = 4;
+  ops.clear();
+  int i = 63;
+  while (i >= 0 && !((n >> i) & 1)) {
+    i--;
+  }
+  while (i >= 0) {
+    if (!((n >> i) & 1)) {
+      int j = i;
+      while (j >= 0 && !((n >> j) & 1)) {
+        j--;
+      }
+      ops.push_back(std::make_pair(i - j, 0));
+      i = j;
+      continue;
+    }
+    int j = (i - W + 1 > 0) ? i - W + 1 : 0;
+    while (!((n >> j) & 1)) {
+      j++;
+    }
+    int digit = (int)((n >> j) & ((2ULL << (i - j)) - 1));
+    ops.push_back(std::make_pair(i - j + 1, digit));
+    i = j - 1;
+  }
+}
+
+template<class Reducer>
+int64 apply_windows(const Reducer &r, int64 x,
+                    const std::vector<std::pair<int, int> > &ops) {
+  int64 table[8], one = r.to(1), res = one;
+  table[0] = r.to(x);
+  int64 x2 = r.mul(table[0], table[0]);
+  for (int i = 1; i < 8; i++) {
+    table[i] = r.mul(table[i - 1], x2);
+  }
+  for (int i = 0; i < (int)ops.size(); i++) {
+    if (res != one) {
+      for (int k = 0; k < ops[i].first; k++) {
+        res = r.mul(res, res);
+      }
+    }
+    if (ops[i].second != 0) {
+      res = (res == one) ? table[ops[i].second >> 1]
+                         : r.mul(res, table[ops[i].second >> 1]);
+    }
+  }
+  return r.from(res);
+}
+
+template<class Reducer>
+int64 window_powmod(const Reducer &r, int64 x, int64 n) {
+  std::vector<std::pair<int, int> > ops;
+  recode_exponent(n, ops);
+  return apply_windows(r, x, ops);
+}
+
+template<class Reducer>
+void window_powmod_batch(const Reducer &r, const int64 *lo, const int64 *hi,
+                         int64 n, int64 *out) {
+  std::vector<std::pair<int, int> > ops;
+  recode_exponent(n, ops);
+  for (; lo != hi; ++lo, ++out) {
+    *out = apply_windows(r, *lo, ops);
+  }
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -50,5 +257,29 @@ int main() {
   assert(powmod(2, 10, 1000000007) == 1024);
   assert(powmod(2, 62, 1000000) == 387904);
   assert(powmod(10001, 10001, 100000) == 10001);
+
+  montgomery64 mont(1000000000000000003ULL);
+  assert(window_powmod(mont, 2, 0) == 1);
+  assert(window_powmod(mont, 2, 10) == 1024);
+  assert(window_powmod(mont, 123456789, 1000000000000000002ULL) == 1);
+  barrett32 barr(1000000007);
+  static_mod<1000000007> stat;
+  assert(window_powmod(barr, 2, 10) == 1024);
+  assert(window_powmod(stat, 2, 10) == 1024);
+  assert(window_powmod(barrett32(1000000), 2, 62) == 387904);
+  assert(window_powmod(static_mod<100000>(), 10001, 10001) == 10001);
+
+  int64 bases[] = {0, 1, 2, 3, 999999999, 123456789012ULL};
+  int64 out[6];
+  int64 e = 987654321987654321ULL;
+  window_powmod_batch(mont, bases, bases + 6, e, out);
+  for (int i = 0; i < 6; i++) {
+    assert(out[i] == powmod(bases[i], e, mont.modulus()));
+  }
+  window_powmod_batch(stat, bases, bases + 6, e, out);
+  for (int i = 0; i < 6; i++) {
+    assert(out[i] == powmod(bases[i], e, 1000000007));
+    assert(out[i] == window_powmod(barr, bases[i], e));
+  }
   return 0;
 }
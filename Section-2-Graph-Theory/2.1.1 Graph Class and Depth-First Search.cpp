@@ -12,57 +12,827 @@ The nodes of the graph are identified by integers indices numbered consecutively
 starting from 0. The total number nodes will automatically increase based upon
 the maximum argument passed to add_edge() so far.
 
+Once a graph is fully built, freeze() returns an immutable csr_graph holding the
+same adjacency lists in compressed sparse row form. All edges are kept in a
+single contiguous targets array. The neighbors of node u are the entries from
+offsets[u] up to offsets[u + 1], with optional per-edge weights stored in a
+parallel array. Avoiding one heap allocation per node roughly halves the memory
+usage, and traversals scan memory sequentially instead of chasing pointers. A
+csr_graph may also be built directly from parallel arrays of edge endpoints
+(and weights) using a counting sort, without ever building a graph. Both
+classes expose the same traversal interface (nodes(), begin(), end(),
+is_directed()). Every traversal below is written once against that interface,
+and works with either of them.
+
+A csr_graph may be saved to a binary file holding its arrays exactly as they
+are laid out in memory, after a short header. Offsets are 64-bit, so the number
+of edges is only limited by memory. A graph_file opens such a file by mapping
+it into memory where the platform supports it (falling back to reading it
+whole), and csr_graph::view() then makes a csr_graph whose arrays point into
+the file, so that even a huge graph is ready for traversal without parsing or
+copying, and pages are only read from disk as they are touched. The file must
+stay open while such a view is in use. csr_graph::convert() builds the binary
+file from a text file of edges in two passes, without an intermediate list of
+edges.
+
+Traversals are faster when neighboring nodes have nearby indices, since their
+marks and adjacency lists then share cache lines and pages. Each of the
+following returns a permutation perm[] of the nodes, which csr_graph::permute()
+applies to renumber node u as perm[u]:
+- bfs_order() numbers nodes in breadth-first order.
+- rcm_order() gives the reverse Cuthill-McKee order, which is breadth-first
+  from a node of nearly maximum eccentricity, visiting neighbors by increasing
+  degree, and then reversed. This keeps the numbers of adjacent nodes close,
+  which suits graphs of small bandwidth such as meshes and road networks.
+- degree_order() numbers nodes by decreasing degree, packing the most
+  frequently accessed nodes of skewed (e.g. social) graphs together.
+- community_order() finds communities by label propagation and numbers the
+  nodes of each community consecutively.
+
+All traversals are built on dfs_engine. It is an iterative depth-first search
+with an explicit stack, so graphs of any depth (e.g. a path of millions of
+nodes) are handled without overflowing the call stack. The engine reserves its
+stack once, and keeps one char per node in color[]: WHITE (undiscovered), GRAY
+(on the current path), or BLACK (finished). Reusing an engine across searches
+keeps the marks, which allows whole-graph traversals. A visitor receives three
+hooks. pre(u, p) is called when u is discovered from parent p (-1 for the
+root). edge(u, p, v, color) is called on each edge u -> v before the engine
+descends into it; returning false aborts the whole search. post(u, p) is called
+once all of u's descendants are finished. dfs_visitor provides no-op defaults
+that visitors may inherit from.
+
 Time Complexity:
 - O(1) amortized per call to add_edge(), or O(max(n, m)) for n calls where the
   maximum node index passed as an argument is m.
 - O(max(n, m)) per call for dfs(), has_cycle(), is_tree(), or is_dag(), where n
   and m are the number of nodes and edges respectively.
+- O(n + m) per call to freeze(), to construct a csr_graph, to save(), or to
+  convert().
+- O((n + m) log n) for rcm_order(), O(n + m) for the other orderings and for
+  permute(), plus O(m) per round of label propagation for community_order().
+- O(1) per call to graph_file::open() and csr_graph::view() where memory
+  mapping is supported, or else O(n + m).
 - O(1) per call to all other public member functions.
 
 Space Complexity:
 - O(max(n, m)) on the number of nodes and edges for storage of the graph.
+- O(n + m) for a csr_graph, with exactly n + 1 offsets and m targets (plus m
+  weights if weighted), in three allocations, or none for a view of a file.
 - O(n) auxiliary per call to dfs(), has_cycle(), is_tree(), and is_dag(), where
   n is the number of nodes.
+- O(n) auxiliary per call to the orderings, or O(n + m) for permute().
 - O(1) auxiliary per call to all other public member functions.
 
 */
 
-#include <algorithm>  // std::max()
+#include <algorithm>  // std::fill(), std::max(), std::min(), std::reverse(), ...
+#include <cstdio>  // std::fclose(), std::fopen(), std::fread(), std::fwrite()
+#include <utility>  // std::make_pair(), std::pair
 #include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#define GRAPH_FILE_MMAP 1
+#include <fcntl.h>  // open()
+#include <sys/mman.h>  // mmap(), munmap()
+#include <sys/stat.h>  // fstat()
+#include <unistd.h>  // close()
+#else
+#define GRAPH_FILE_MMAP 0
+#endif
 
-class graph {
-  std::vector<std::vector<int> > adj;
-  bool _is_directed;
+enum { WHITE = 0, GRAY = 1, BLACK = 2 };
 
-  template<class Action>
-  void dfs(int n, std::vector<bool> &vis, Action act) const {
-    act(n);
-    vis[n] = true;
-    std::vector<int>::const_iterator it;
-    for (it = adj[n].begin(); it != adj[n].end(); ++it) {
-      if (!vis[*it])
-        dfs(*it, vis, act);
+struct dfs_visitor {
+  void pre(int, int) {}
+  void post(int, int) {}
+  bool edge(int, int, int, char) { return true; }
+};
+
+template<class Graph>
+class dfs_engine {
+  typedef typename Graph::const_iterator iter;
+
+  const Graph &g;
+  std::vector<int> nodes;
+  std::vector<iter> iters;
+
+ public:
+  std::vector<char> color;
+
+  dfs_engine(const Graph &g) : g(g), color(g.nodes(), WHITE) {
+    nodes.reserve(g.nodes());
+    iters.reserve(g.nodes());
+  }
+
+  void reset() {
+    std::fill(color.begin(), color.end(), (char)WHITE);
+  }
+
+  // Returns false if the search was aborted by the visitor. Nodes on the path
+  // to the point of abortion are left GRAY.
+  template<class Visitor>
+  bool run(int start, Visitor &vis) {
+    if (color[start] != WHITE)
+      return true;
+    nodes.clear();
+    iters.clear();
+    color[start] = GRAY;
+    vis.pre(start, -1);
+    nodes.push_back(start);
+    iters.push_back(g.begin(start));
+    while (!nodes.empty()) {
+      int u = nodes.back();
+      int p = (nodes.size() > 1) ? nodes[nodes.size() - 2] : -1;
+      if (iters.back() == g.end(u)) {
+        color[u] = BLACK;
+        nodes.pop_back();
+        iters.pop_back();
+        vis.post(u, p);
+        continue;
+      }
+      int v = *iters.back()++;
+      if (!vis.edge(u, p, v, color[v]))
+        return false;
+      if (color[v] == WHITE) {
+        color[v] = GRAY;
+        vis.pre(v, u);
+        nodes.push_back(v);
+        iters.push_back(g.begin(v));
+      }
     }
+    return true;
   }
+};
+
+template<class Action>
+struct preorder_visitor : dfs_visitor {
+  Action act;
+
+  preorder_visitor(Action act) : act(act) {}
+
+  void pre(int u, int) {
+    act(u);
+  }
+};
+
+template<class Graph, class Action>
+void dfs(const Graph &g, int start, Action act) {
+  dfs_engine<Graph> engine(g);
+  preorder_visitor<Action> vis(act);
+  engine.run(start, vis);
+}
+
+struct cycle_visitor : dfs_visitor {
+  bool is_directed;
 
-  bool has_cycle(int n, int prev, std::vector<bool> &vis,
-                 std::vector<bool> &onstack) const {
-    vis[n] = true;
-    onstack[n] = true;
-    std::vector<int>::const_iterator it;
-    for (it = adj[n].begin(); it != adj[n].end(); ++it) {
-      if (is_directed() && onstack[*it])
-        return true;
-      if (!is_directed() && vis[*it] && *it != prev)
-        return true;
-      if (!vis[*it] && has_cycle(*it, n, vis, onstack))
-        return true;
+  cycle_visitor(bool is_directed) : is_directed(is_directed) {}
+
+  bool edge(int, int p, int v, char color) {
+    if (is_directed)
+      return color != GRAY;
+    return color == WHITE || v == p;
+  }
+};
+
+template<class Graph>
+bool has_cycle(const Graph &g) {
+  dfs_engine<Graph> engine(g);
+  cycle_visitor vis(g.is_directed());
+  for (int i = 0; i < g.nodes(); i++) {
+    if (!engine.run(i, vis))
+      return true;
+  }
+  return false;
+}
+
+// Converts a list of all nodes to the permutation numbering order[i] as i.
+inline std::vector<int> order_to_permutation(const std::vector<int> &order) {
+  std::vector<int> perm(order.size());
+  for (int i = 0; i < (int)order.size(); i++) {
+    perm[order[i]] = i;
+  }
+  return perm;
+}
+
+// Returns the permutation numbering nodes in breadth-first order, starting a
+// new search from the smallest node not yet reached.
+template<class Graph>
+std::vector<int> bfs_order(const Graph &g) {
+  int n = g.nodes();
+  std::vector<int> order;
+  std::vector<char> seen(n, false);
+  order.reserve(n);
+  for (int s = 0; s < n; s++) {
+    if (seen[s])
+      continue;
+    seen[s] = true;
+    order.push_back(s);
+    for (int i = (int)order.size() - 1; i < (int)order.size(); i++) {
+      for (typename Graph::const_iterator it = g.begin(order[i]);
+           it != g.end(order[i]); ++it) {
+        if (!seen[*it]) {
+          seen[*it] = true;
+          order.push_back(*it);
+        }
+      }
+    }
+  }
+  return order_to_permutation(order);
+}
+
+// Returns the permutation numbering nodes by decreasing degree, breaking ties
+// by index, so that the most frequently visited nodes share cache lines.
+template<class Graph>
+std::vector<int> degree_order(const Graph &g) {
+  int n = g.nodes(), max_degree = 0;
+  std::vector<int> degree(n), count;
+  for (int u = 0; u < n; u++) {
+    degree[u] = (int)(g.end(u) - g.begin(u));
+    max_degree = std::max(max_degree, degree[u]);
+  }
+  count.assign(max_degree + 2, 0);
+  for (int u = 0; u < n; u++) {
+    count[max_degree - degree[u] + 1]++;
+  }
+  for (int d = 0; d <= max_degree; d++) {
+    count[d + 1] += count[d];
+  }
+  std::vector<int> perm(n);
+  for (int u = 0; u < n; u++) {
+    perm[u] = count[max_degree - degree[u]]++;
+  }
+  return perm;
+}
+
+template<class Graph>
+class cuthill_mckee {
+  const Graph &g;
+  std::vector<int> degree, stamp, depth, queue;
+  int sweeps;
+
+  int degree_of(int u) const {
+    return (int)(g.end(u) - g.begin(u));
+  }
+
+  // Searches from s among the nodes not yet numbered, leaving the nodes found
+  // in queue and returning the depth of the search.
+  int sweep(int s, const std::vector<char> &numbered) {
+    sweeps++;
+    queue.clear();
+    queue.push_back(s);
+    stamp[s] = sweeps;
+    depth[s] = 0;
+    for (int i = 0; i < (int)queue.size(); i++) {
+      int u = queue[i];
+      for (typename Graph::const_iterator it = g.begin(u); it != g.end(u);
+           ++it) {
+        if (stamp[*it] != sweeps && !numbered[*it]) {
+          stamp[*it] = sweeps;
+          depth[*it] = depth[u] + 1;
+          queue.push_back(*it);
+        }
+      }
     }
-    onstack[n] = false;
-    return false;
+    return depth[queue.back()];
   }
 
+  // Finds a node of nearly maximum eccentricity in the component of s, by
+  // repeatedly moving to a node of least degree in the last level of a search
+  // for as long as that increases the depth (George and Liu's heuristic).
+  int pseudo_peripheral(int s, const std::vector<char> &numbered) {
+    sweep(s, numbered);
+    for (int i = 0; i < (int)queue.size(); i++) {
+      if (degree[queue[i]] < degree[s]) {
+        s = queue[i];
+      }
+    }
+    for (int d = sweep(s, numbered); ; ) {
+      int best = -1;
+      for (int i = (int)queue.size() - 1; i >= 0 && depth[queue[i]] == d; i--) {
+        if (best < 0 || degree[queue[i]] < degree[best]) {
+          best = queue[i];
+        }
+      }
+      int next = sweep(best, numbered);
+      if (next <= d) {
+        return s;
+      }
+      s = best;
+      d = next;
+    }
+  }
+
+ public:
+  std::vector<int> order;
+
+  cuthill_mckee(const Graph &g)
+      : g(g), degree(g.nodes()), stamp(g.nodes(), 0), depth(g.nodes()),
+        sweeps(0) {
+    int n = g.nodes();
+    for (int u = 0; u < n; u++) {
+      degree[u] = degree_of(u);
+    }
+    std::vector<char> numbered(n, false);
+    std::vector<std::pair<int, int> > next;
+    order.reserve(n);
+    for (int u = 0; u < n; u++) {
+      if (numbered[u])
+        continue;
+      int s = pseudo_peripheral(u, numbered);
+      numbered[s] = true;
+      order.push_back(s);
+      for (int i = (int)order.size() - 1; i < (int)order.size(); i++) {
+        next.clear();
+        for (typename Graph::const_iterator it = g.begin(order[i]);
+             it != g.end(order[i]); ++it) {
+          if (!numbered[*it]) {
+            numbered[*it] = true;
+            next.push_back(std::make_pair(degree[*it], *it));
+          }
+        }
+        std::sort(next.begin(), next.end());
+        for (int j = 0; j < (int)next.size(); j++) {
+          order.push_back(next[j].second);
+        }
+      }
+    }
+    std::reverse(order.begin(), order.end());
+  }
+};
+
+// Returns the reverse Cuthill-McKee permutation, which numbers each component
+// breadth-first from a pseudo-peripheral node, visiting the neighbors of each
+// node by increasing degree, and then reverses the numbering. Neighbors thus
+// receive close numbers, keeping the bandwidth of the adjacency matrix small.
+template<class Graph>
+std::vector<int> rcm_order(const Graph &g) {
+  return order_to_permutation(cuthill_mckee<Graph>(g).order);
+}
+
+// Returns a permutation numbering the nodes of each community consecutively,
+// where communities are found by a few rounds of label propagation: every node
+// in turn takes the label most frequent among its neighbors, keeping its own
+// label on ties. Communities are numbered in the breadth-first order of their
+// first node, and nodes within a community keep their breadth-first order.
+template<class Graph>
+std::vector<int> community_order(const Graph &g, int rounds = 5) {
+  int n = g.nodes();
+  std::vector<int> label(n), count(n, 0), seen;
+  for (int u = 0; u < n; u++) {
+    label[u] = u;
+  }
+  for (int r = 0; r < rounds; r++) {
+    bool changed = false;
+    for (int u = 0; u < n; u++) {
+      int best = label[u];
+      seen.clear();
+      for (typename Graph::const_iterator it = g.begin(u); it != g.end(u);
+           ++it) {
+        int l = label[*it];
+        if (count[l]++ == 0) {
+          seen.push_back(l);
+        }
+        if (count[l] > count[best] ||
+            (count[l] == count[best] && best != label[u] &&
+             (l == label[u] || l < best))) {
+          best = l;
+        }
+      }
+      for (int i = 0; i < (int)seen.size(); i++) {
+        count[seen[i]] = 0;
+      }
+      changed |= (best != label[u]);
+      label[u] = best;
+    }
+    if (!changed)
+      break;
+  }
+  std::vector<int> bfs = bfs_order(g), first(n, n), order(n);
+  for (int u = 0; u < n; u++) {
+    order[bfs[u]] = u;
+  }
+  // Rank each community by the breadth-first position of its first node,
+  // then counting sort the nodes by community in breadth-first order.
+  for (int i = 0; i < n; i++) {
+    first[label[order[i]]] = std::min(first[label[order[i]]], i);
+  }
+  std::vector<int> start(n + 1, 0);
+  for (int u = 0; u < n; u++) {
+    start[first[label[u]] + 1]++;
+  }
+  for (int i = 0; i < n; i++) {
+    start[i + 1] += start[i];
+  }
+  std::vector<int> perm(n);
+  for (int i = 0; i < n; i++) {
+    perm[order[i]] = start[first[label[order[i]]]]++;
+  }
+  return perm;
+}
+
+// Reads whitespace separated nonnegative integers from a text file, skipping
+// lines which start with '#' or '%'.
+class int_reader {
+  std::FILE *f;
+  char buf[1 << 16];
+  size_t pos, len;
+
+  int get() {
+    if (pos == len) {
+      len = std::fread(buf, 1, sizeof buf, f);
+      pos = 0;
+      if (len == 0) {
+        return -1;
+      }
+    }
+    return buf[pos++];
+  }
+
+ public:
+  int_reader(std::FILE *f) : f(f), pos(0), len(0) {}
+
+  bool next(long long &x) {
+    int c = get();
+    for (bool line_start = true; c >= 0 && (c < '0' || c > '9'); c = get()) {
+      if (line_start && (c == '#' || c == '%')) {
+        while (c >= 0 && c != '\n') {
+          c = get();
+        }
+      }
+      line_start = (c == '\n');
+    }
+    if (c < 0) {
+      return false;
+    }
+    for (x = 0; c >= '0' && c <= '9'; c = get()) {
+      x = 10*x + (c - '0');
+    }
+    return true;
+  }
+};
+
+// A read-only file which is memory-mapped where supported, or else read into
+// memory as a whole.
+class graph_file {
+  const char *data;
+  size_t len;
+  std::vector<char> buffer;
+
+  graph_file(const graph_file &);
+  graph_file& operator=(const graph_file &);
+
  public:
+  graph_file() : data(0), len(0) {}
+
+  ~graph_file() {
+    close();
+  }
+
+  bool open(const char *filename) {
+    close();
+#if GRAPH_FILE_MMAP
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    void *p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      p = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (p == MAP_FAILED) {
+      return false;
+    }
+    data = (const char*)p;
+    len = (size_t)st.st_size;
+#else
+    std::FILE *f = std::fopen(filename, "rb");
+    if (f == 0) {
+      return false;
+    }
+    char chunk[1 << 16];
+    for (size_t n; (n = std::fread(chunk, 1, sizeof chunk, f)) > 0; ) {
+      buffer.insert(buffer.end(), chunk, chunk + n);
+    }
+    std::fclose(f);
+    data = buffer.empty() ? 0 : &buffer[0];
+    len = buffer.size();
+#endif
+    return data != 0;
+  }
+
+  void close() {
+#if GRAPH_FILE_MMAP
+    if (data != 0) {
+      munmap((void*)data, len);
+    }
+#endif
+    buffer.clear();
+    data = 0;
+    len = 0;
+  }
+
+  const char* bytes() const {
+    return data;
+  }
+
+  size_t size() const {
+    return len;
+  }
+};
+
+class csr_graph {
+  static const int MAGIC = 0x31525343, DIRECTED = 1, WEIGHTED = 2;
+
+  std::vector<long long> offset_store;
+  std::vector<int> target_store, weight_store;
+  const long long *offsets;
+  const int *targets, *weights;
+  int n;
+  long long m;
+  bool _is_directed, owned;
+
+  // Points the arrays at the vectors owned by this graph.
+  void attach() {
+    owned = true;
+    n = (int)offset_store.size() - 1;
+    m = (long long)target_store.size();
+    offsets = &offset_store[0];
+    targets = target_store.empty() ? 0 : &target_store[0];
+    weights = weight_store.empty() ? 0 : &weight_store[0];
+  }
+
+ public:
+  typedef const int* const_iterator;
+
+  csr_graph() : offset_store(1, 0), _is_directed(true) {
+    attach();
+  }
+
+  template<class Graph>
+  csr_graph(const Graph &g) : offset_store(g.nodes() + 1, 0) {
+    this->_is_directed = g.is_directed();
+    for (int u = 0; u < g.nodes(); u++) {
+      offset_store[u + 1] = offset_store[u] + (g.end(u) - g.begin(u));
+    }
+    target_store.reserve(offset_store[g.nodes()]);
+    for (int u = 0; u < g.nodes(); u++) {
+      target_store.insert(target_store.end(), g.begin(u), g.end(u));
+    }
+    attach();
+  }
+
+  // Builds from edge i = (from[i], to[i]) with optional weight[i]. Edges out of
+  // each node keep their relative order from the input.
+  csr_graph(int nodes, const std::vector<int> &from, const std::vector<int> &to,
+            const std::vector<int> &weight = std::vector<int>(),
+            bool is_directed = true) : offset_store(nodes + 1, 0) {
+    this->_is_directed = is_directed;
+    long long m = (long long)from.size(), total = is_directed ? m : 2*m;
+    for (long long i = 0; i < m; i++) {
+      offset_store[from[i] + 1]++;
+      if (!is_directed)
+        offset_store[to[i] + 1]++;
+    }
+    for (int u = 0; u < nodes; u++) {
+      offset_store[u + 1] += offset_store[u];
+    }
+    target_store.resize(total);
+    if (!weight.empty())
+      weight_store.resize(total);
+    std::vector<long long> pos(offset_store.begin(), offset_store.end() - 1);
+    for (long long i = 0; i < m; i++) {
+      long long e = pos[from[i]]++;
+      target_store[e] = to[i];
+      if (!weight.empty())
+        weight_store[e] = weight[i];
+      if (!is_directed) {
+        e = pos[to[i]]++;
+        target_store[e] = from[i];
+        if (!weight.empty())
+          weight_store[e] = weight[i];
+      }
+    }
+    attach();
+  }
+
+  csr_graph(const csr_graph &g)
+      : offset_store(g.offset_store), target_store(g.target_store),
+        weight_store(g.weight_store), offsets(g.offsets), targets(g.targets),
+        weights(g.weights), n(g.n), m(g.m), _is_directed(g._is_directed),
+        owned(g.owned) {
+    if (owned)
+      attach();
+  }
+
+  csr_graph& operator=(const csr_graph &g) {
+    if (this != &g) {
+      csr_graph tmp(g);
+      offset_store.swap(tmp.offset_store);
+      target_store.swap(tmp.target_store);
+      weight_store.swap(tmp.weight_store);
+      offsets = tmp.offsets;
+      targets = tmp.targets;
+      weights = tmp.weights;
+      n = tmp.n;
+      m = tmp.m;
+      _is_directed = tmp._is_directed;
+      owned = tmp.owned;
+    }
+    return *this;
+  }
+
+  // Writes the graph as a header of two ints (a magic number and flags) and
+  // two long longs (the numbers of nodes and edges), followed by the offsets,
+  // the targets, and the weights if any, back to back.
+  bool save(const char *filename) const {
+    std::FILE *f = std::fopen(filename, "wb");
+    if (f == 0) {
+      return false;
+    }
+    int header[2] = {MAGIC, (_is_directed ? DIRECTED : 0) |
+                            (weights != 0 ? WEIGHTED : 0)};
+    long long sizes[2] = {n, m};
+    bool ok = std::fwrite(header, sizeof(int), 2, f) == 2 &&
+              std::fwrite(sizes, sizeof(long long), 2, f) == 2 &&
+              std::fwrite(offsets, sizeof(long long), n + 1, f) ==
+                  (size_t)n + 1;
+    for (int i = 0; i < (weights != 0 ? 2 : 1); i++) {
+      const int *a = (i == 0) ? targets : weights;
+      ok = ok && (m == 0 || std::fwrite(a, sizeof(int), m, f) == (size_t)m);
+    }
+    return (std::fclose(f) == 0) && ok;
+  }
+
+  // Makes this graph a view of the arrays of a file written by save(), without
+  // copying them. The file must stay open for as long as the view is used.
+  bool view(const graph_file &f) {
+    const char *p = f.bytes();
+    const size_t HEADER = 2*sizeof(int) + 2*sizeof(long long);
+    if (p == 0 || f.size() < HEADER || ((const int*)p)[0] != MAGIC) {
+      return false;
+    }
+    int flags = ((const int*)p)[1];
+    const long long *sizes = (const long long*)(p + 2*sizeof(int));
+    if (sizes[0] < 0 || sizes[1] < 0 ||
+        f.size() != HEADER + (sizes[0] + 1)*sizeof(long long) +
+                    sizes[1]*sizeof(int)*((flags & WEIGHTED) ? 2 : 1)) {
+      return false;
+    }
+    offset_store.clear();
+    target_store.clear();
+    weight_store.clear();
+    n = (int)sizes[0];
+    m = sizes[1];
+    _is_directed = (flags & DIRECTED) != 0;
+    owned = false;
+    offsets = (const long long*)(p + HEADER);
+    targets = (m == 0) ? 0 : (const int*)(offsets + n + 1);
+    weights = (m == 0 || !(flags & WEIGHTED)) ? 0 : targets + m;
+    return true;
+  }
+
+  // Returns a copy of the graph in which node u is renumbered to perm[u], for
+  // example by one of the orderings above. Results computed on the copy are
+  // mapped back to node u by reading them at perm[u].
+  csr_graph permute(const std::vector<int> &perm) const {
+    csr_graph g;
+    g._is_directed = _is_directed;
+    g.offset_store.assign(n + 1, 0);
+    for (int u = 0; u < n; u++) {
+      g.offset_store[perm[u] + 1] = offsets[u + 1] - offsets[u];
+    }
+    for (int u = 0; u < n; u++) {
+      g.offset_store[u + 1] += g.offset_store[u];
+    }
+    g.target_store.resize(m);
+    if (weights != 0)
+      g.weight_store.resize(m);
+    for (int u = 0; u < n; u++) {
+      long long k = g.offset_store[perm[u]];
+      for (long long e = offsets[u]; e < offsets[u + 1]; e++, k++) {
+        g.target_store[k] = perm[targets[e]];
+        if (weights != 0)
+          g.weight_store[k] = weights[e];
+      }
+    }
+    g.attach();
+    return g;
+  }
+
+  int nodes() const {
+    return n;
+  }
+
+  long long edges() const {
+    return m;
+  }
+
+  bool is_directed() const {
+    return _is_directed;
+  }
+
+  bool is_weighted() const {
+    return weights != 0;
+  }
+
+  const_iterator begin(int u) const {
+    return targets == 0 ? 0 : targets + offsets[u];
+  }
+
+  const_iterator end(int u) const {
+    return targets == 0 ? 0 : targets + offsets[u + 1];
+  }
+
+  // Edges out of node u are numbered from edge_begin(u) to edge_end(u) - 1.
+  long long edge_begin(int u) const {
+    return offsets[u];
+  }
+
+  long long edge_end(int u) const {
+    return offsets[u + 1];
+  }
+
+  int target(long long e) const {
+    return targets[e];
+  }
+
+  int weight(long long e) const {
+    return weights[e];
+  }
+
+  // Converts a text file of edges "u v", or "u v w" if weighted, into a file
+  // written by save(), in two passes which count the degrees and then place
+  // the edges, so that only the arrays of the graph are held in memory.
+  static bool convert(const char *text_file, const char *graph_file,
+                      bool is_weighted, bool is_directed = true) {
+    csr_graph g;
+    g._is_directed = is_directed;
+    std::vector<long long> &offsets = g.offset_store;
+    std::vector<long long> pos;
+    for (int pass = 0; pass < 2; pass++) {
+      std::FILE *f = std::fopen(text_file, "rb");
+      if (f == 0) {
+        return false;
+      }
+      int_reader in(f);
+      long long e[3] = {0, 0, 0};
+      while (in.next(e[0]) && in.next(e[1]) && (!is_weighted || in.next(e[2]))) {
+        for (int i = 0; i < (is_directed ? 1 : 2); i++) {
+          int u = (int)e[i], v = (int)e[1 - i];
+          if (pass == 0) {
+            if (std::max(u, v) + 2 > (int)offsets.size()) {
+              offsets.resize(std::max(u, v) + 2, 0);
+            }
+            offsets[u + 1]++;
+          } else {
+            long long k = pos[u]++;
+            g.target_store[k] = v;
+            if (is_weighted)
+              g.weight_store[k] = (int)e[2];
+          }
+        }
+      }
+      std::fclose(f);
+      if (pass == 0) {
+        for (int u = 0; u + 1 < (int)offsets.size(); u++) {
+          offsets[u + 1] += offsets[u];
+        }
+        pos.assign(offsets.begin(), offsets.end() - 1);
+        g.target_store.resize(offsets.back());
+        if (is_weighted)
+          g.weight_store.resize(offsets.back());
+      }
+    }
+    g.attach();
+    return g.save(graph_file);
+  }
+
+  bool has_cycle() const {
+    return ::has_cycle(*this);
+  }
+
+  bool is_tree() const {
+    return !is_directed() && !has_cycle();
+  }
+
+  bool is_dag() const {
+    return is_directed() && !has_cycle();
+  }
+
+  template<class Action>
+  void dfs(int start, Action act) const {
+    ::dfs(*this, start, act);
+  }
+};
+
+class graph {
+  std::vector<std::vector<int> > adj;
+  bool _is_directed;
+
+ public:
+  typedef std::vector<int>::const_iterator const_iterator;
+
   graph(bool is_directed = true) {
     this->_is_directed = is_directed;
   }
@@ -75,6 +845,14 @@ class graph {
     return adj[n];
   }
 
+  const_iterator begin(int n) const {
+    return adj[n].begin();
+  }
+
+  const_iterator end(int n) const {
+    return adj[n].end();
+  }
+
   void add_edge(int u, int v) {
     if (u >= (int)adj.size() || v >= (int)adj.size()) {
       adj.resize(std::max(u, v) + 1);
@@ -90,13 +868,7 @@ class graph {
   }
 
   bool has_cycle() const {
-    std::vector<bool> vis(adj.size(), false);
-    std::vector<bool> onstack(adj.size(), false);
-    for (int i = 0; i < (int)adj.size(); i++) {
-      if (!vis[i] && has_cycle(i, -1, vis, onstack))
-        return true;
-    }
-    return false;
+    return ::has_cycle(*this);
   }
 
   bool is_tree() const {
@@ -109,18 +881,24 @@ class graph {
 
   template<class Action>
   void dfs(int start, Action act) const {
-    std::vector<bool> vis(adj.size(), false);
-    dfs(start, vis, act);
+    ::dfs(*this, start, act);
+  }
+
+  csr_graph freeze() const {
+    return csr_graph(*this);
   }
 };
 
 /*** Example Usage and Output:
 
 DFS order: 0 1 2 3 4 5 6 7 8 9 10 11
+Frozen DFS order: 0 1 2 3 4 5 6 7 8 9 10 11
 
 ***/
 
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>  // std::abs()
 #include <iostream>
 using namespace std;
 
@@ -148,6 +926,57 @@ int main() {
     assert(g[0].size() == 3);
     assert(g.is_dag());
     assert(!g.has_cycle());
+    csr_graph c = g.freeze();
+    cout << "Frozen DFS order: ";
+    c.dfs(0, print_node);
+    cout << endl;
+    assert(c.nodes() == 12 && c.edges() == 11);
+    assert(c.end(0) - c.begin(0) == 3);
+    assert(c.is_dag());
+  }
+  {
+    int from[] = {0, 0, 1, 2}, to[] = {1, 2, 2, 0}, weight[] = {5, 3, 1, 7};
+    csr_graph c(3, vector<int>(from, from + 4), vector<int>(to, to + 4),
+                vector<int>(weight, weight + 4));
+    assert(c.is_weighted() && c.has_cycle());
+    assert(c.edge_end(0) - c.edge_begin(0) == 2);
+    assert(c.target(c.edge_begin(0)) == 1 && c.weight(c.edge_begin(0)) == 5);
+    assert(c.target(c.edge_begin(2)) == 0 && c.weight(c.edge_begin(2)) == 7);
+    csr_graph u(3, vector<int>(from, from + 2), vector<int>(to, to + 2),
+                vector<int>(), false);
+    assert(u.is_tree() && u.edges() == 4);
+    assert(c.save("graph.bin"));
+    graph_file f;
+    csr_graph v;
+    assert(f.open("graph.bin") && v.view(f));
+    assert(v.nodes() == 3 && v.edges() == 4 && v.is_weighted() && v.has_cycle());
+    for (long long e = 0; e < c.edges(); e++) {
+      assert(v.target(e) == c.target(e) && v.weight(e) == c.weight(e));
+    }
+    FILE *text = fopen("graph.txt", "w");
+    fprintf(text, "# u v\n0 1\n0 2\n1 3\n");
+    fclose(text);
+    assert(csr_graph::convert("graph.txt", "graph.bin", false, false));
+    assert(f.open("graph.bin") && v.view(f));
+    assert(v.nodes() == 4 && v.edges() == 6 && v.is_tree());
+    assert(v.end(0) - v.begin(0) == 2 && *v.begin(3) == 1);
+    f.close();
+    remove("graph.txt");
+    remove("graph.bin");
+  }
+  {
+    // A path this long would overflow the call stack of a recursive search.
+    const int n = 2000000;
+    vector<int> from(n - 1), to(n - 1);
+    for (int i = 0; i + 1 < n; i++) {
+      from[i] = i;
+      to[i] = i + 1;
+    }
+    csr_graph path(n, from, to, vector<int>(), false);
+    assert(path.is_tree());
+    from.push_back(n - 1);
+    to.push_back(0);
+    assert(csr_graph(n, from, to).has_cycle());
   }
   {
     graph tree(false);
@@ -160,5 +989,49 @@ int main() {
     tree.add_edge(2, 3);
     assert(!tree.is_tree());
   }
+  {
+    // A grid with shuffled node numbers, reordered to a small bandwidth.
+    const int side = 30, n = side*side;
+    vector<int> id(n), from, to;
+    for (int i = 0; i < n; i++) {
+      id[i] = i;
+    }
+    random_shuffle(id.begin(), id.end());
+    for (int r = 0; r < side; r++) {
+      for (int c = 0; c < side; c++) {
+        if (c + 1 < side) {
+          from.push_back(id[r*side + c]);
+          to.push_back(id[r*side + c + 1]);
+        }
+        if (r + 1 < side) {
+          from.push_back(id[r*side + c]);
+          to.push_back(id[(r + 1)*side + c]);
+        }
+      }
+    }
+    csr_graph g(n, from, to, vector<int>(), false);
+    vector<int> orders[4] = {bfs_order(g), rcm_order(g), degree_order(g),
+                             community_order(g)};
+    for (int k = 0; k < 4; k++) {
+      vector<int> seen(n, 0);
+      for (int u = 0; u < n; u++) {
+        assert(++seen[orders[k][u]] == 1);
+      }
+      csr_graph h = g.permute(orders[k]);
+      assert(h.edges() == g.edges());
+      for (int u = 0; u < n; u++) {
+        assert(h.end(orders[k][u]) - h.begin(orders[k][u]) ==
+               g.end(u) - g.begin(u));
+      }
+    }
+    csr_graph h = g.permute(orders[1]);
+    int bandwidth = 0;
+    for (int u = 0; u < n; u++) {
+      for (const int *v = h.begin(u); v != h.end(u); ++v) {
+        bandwidth = max(bandwidth, abs(u - *v));
+      }
+    }
+    assert(bandwidth <= 2*side);
+  }
   return 0;
 }
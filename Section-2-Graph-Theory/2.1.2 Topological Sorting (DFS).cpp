@@ -8,39 +8,78 @@ which yields a reversed topological ordering.
 toposort() takes a directed graph stored as a global adjacency list with nodes
 indexed from 0 to (nodes - 1) and assigns a valid topological ordering to the
 global result vector. If the graph contains a cycle, then an error is thrown.
+The depth-first search is iterative, using an explicit stack of (node, next
+edge index) pairs, so the depth of the graph is not limited by the call stack.
 
-Time Complexity: O(max(n, m)) on the numbers of nodes and edges respectively.
-Space Complexity: O(max(n, m)) on the numbers of nodes and edges respectively.
+dag_levels instead groups the nodes of a DAG into levels, where the level of a
+node is the number of edges on the longest path ending at it. Every edge leads
+to a higher level, so the nodes of each level may be processed concurrently as
+soon as all lower levels are done, as when scheduling dependent jobs. The levels
+are computed by Kahn's algorithm, processing one frontier of nodes having no
+remaining incoming edges at a time, where every frontier is a level. Nodes and
+edges may be added to the DAG afterwards. insert_edge() only raises the levels
+of nodes reachable from the head of the new edge, and only as far as needed.
+The raised nodes are visited in increasing order of their old levels, so that
+all of their raised predecessors have been visited before them, and each is
+visited once with its final level. This also detects whether the new edge
+closes a cycle, in which case it is rejected. schedule() outputs a topological order sorted by level along with the
+boundaries of each level.
+
+Time Complexity:
+- O(max(n, m)) for toposort() on the numbers of nodes and edges respectively.
+- O(n + m) for the first call to level() or schedule() after add_edge(), or the
+  first call to insert_edge() after it, and O(n) for each other schedule().
+- O((n' + m') log n') per call to insert_edge(), where n' and m' are the
+  numbers of nodes whose level is raised and of their outgoing edges.
+- O(1) per call to all other member functions of dag_levels.
+
+Space Complexity:
+- O(max(n, m)) for toposort() on the numbers of nodes and edges respectively.
+- O(n + m) for a dag_levels, and O(n) auxiliary per call to its functions.
 
 */
 
-#include <algorithm>  // std::fill(), std::reverse()
+#include <algorithm>  // std::fill(), std::max(), std::reverse()
+#include <functional>  // std::greater
+#include <queue>  // std::priority_queue
 #include <stdexcept>  // std::runtime_error()
+#include <utility>  // std::make_pair(), std::pair
 #include <vector>
 
 const int MAXN = 100;
 
-std::vector<bool> vis(MAXN), done(MAXN);
+std::vector<char> vis(MAXN), done(MAXN);
 std::vector<int> adj[MAXN], res;
+std::vector<std::pair<int, int> > stack;
 
-void dfs(int u) {
-  if (vis[u])
-    throw std::runtime_error("Not a DAG.");
-  if (done[u])
-    return;
-  vis[u] = true;
-  for (int j = 0; j < (int)adj[u].size(); j++) {
-    dfs(adj[u][j]);
+void dfs(int start) {
+  stack.push_back(std::make_pair(start, 0));
+  vis[start] = true;
+  while (!stack.empty()) {
+    int u = stack.back().first, j = stack.back().second++;
+    if (j == (int)adj[u].size()) {
+      stack.pop_back();
+      vis[u] = false;
+      done[u] = true;
+      res.push_back(u);
+      continue;
+    }
+    int v = adj[u][j];
+    if (vis[v])
+      throw std::runtime_error("Not a DAG.");
+    if (!done[v]) {
+      vis[v] = true;
+      stack.push_back(std::make_pair(v, 0));
+    }
   }
-  vis[u] = false;
-  done[u] = true;
-  res.push_back(u);
 }
 
 void toposort(int nodes) {
-  fill(vis.begin(), vis.end(), false);
-  fill(done.begin(), done.end(), false);
+  std::fill(vis.begin(), vis.end(), false);
+  std::fill(done.begin(), done.end(), false);
   res.clear();
+  stack.clear();
+  stack.reserve(nodes);
   for (int i = 0; i < nodes; i++) {
     if (!done[i]) {
       dfs(i);
@@ -49,12 +88,156 @@ void toposort(int nodes) {
   std::reverse(res.begin(), res.end());
 }
 
+class dag_levels {
+  std::vector<std::vector<int> > adj;
+  std::vector<int> lvl;
+  std::vector<char> queued;
+  bool dirty;
+
+  // Kahn's algorithm, one frontier of nodes with no remaining incoming edges
+  // at a time, where the nodes reached from frontier i make up frontier i + 1.
+  void relevel() {
+    int n = nodes();
+    std::vector<int> indeg(n, 0), frontier, next;
+    for (int u = 0; u < n; u++) {
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        indeg[adj[u][j]]++;
+      }
+    }
+    for (int u = 0; u < n; u++) {
+      if (indeg[u] == 0) {
+        lvl[u] = 0;
+        frontier.push_back(u);
+      }
+    }
+    int done = 0;
+    for (int l = 1; !frontier.empty(); l++) {
+      done += (int)frontier.size();
+      next.clear();
+      for (int i = 0; i < (int)frontier.size(); i++) {
+        int u = frontier[i];
+        for (int j = 0; j < (int)adj[u].size(); j++) {
+          int v = adj[u][j];
+          if (--indeg[v] == 0) {
+            lvl[v] = l;
+            next.push_back(v);
+          }
+        }
+      }
+      frontier.swap(next);
+    }
+    if (done < n)
+      throw std::runtime_error("Not a DAG.");
+    dirty = false;
+  }
+
+ public:
+  dag_levels(int nodes = 0)
+      : adj(nodes), lvl(nodes, 0), queued(nodes, 0), dirty(false) {}
+
+  int nodes() const {
+    return (int)adj.size();
+  }
+
+  int add_node() {
+    adj.push_back(std::vector<int>());
+    lvl.push_back(0);
+    queued.push_back(0);
+    return nodes() - 1;
+  }
+
+  // Adds the edge u -> v, deferring the levels to be recomputed from scratch
+  // when next requested. This is faster when adding many edges at once.
+  void add_edge(int u, int v) {
+    adj[u].push_back(v);
+    dirty = true;
+  }
+
+  // Adds the edge u -> v and updates the levels right away, by raising v and
+  // the nodes reachable from it as needed. If the edge would close a cycle,
+  // then an error is thrown and nothing is changed.
+  void insert_edge(int u, int v) {
+    if (dirty)
+      relevel();
+    // The (old level, node) pairs of the raised nodes. Every edge but u -> v
+    // leads to a higher old level, so popping the lowest old level first
+    // visits each raised node after all of its raised predecessors.
+    typedef std::pair<int, int> entry;
+    std::vector<entry> changed;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry> > q;
+    if (lvl[v] <= lvl[u]) {
+      changed.push_back(std::make_pair(lvl[v], v));
+      q.push(changed.back());
+      queued[v] = 1;
+      lvl[v] = lvl[u] + 1;
+    }
+    bool cycle = false;
+    while (!q.empty() && !cycle) {
+      int x = q.top().second;
+      q.pop();
+      cycle = (x == u);
+      for (int j = 0; !cycle && j < (int)adj[x].size(); j++) {
+        int y = adj[x][j];
+        if (lvl[y] <= lvl[x]) {
+          if (!queued[y]) {
+            changed.push_back(std::make_pair(lvl[y], y));
+            q.push(changed.back());
+            queued[y] = 1;
+          }
+          lvl[y] = lvl[x] + 1;
+        }
+      }
+    }
+    for (int k = 0; k < (int)changed.size(); k++) {
+      queued[changed[k].second] = 0;
+      if (cycle)
+        lvl[changed[k].second] = changed[k].first;
+    }
+    if (cycle)
+      throw std::runtime_error("Not a DAG.");
+    adj[u].push_back(v);
+  }
+
+  // Returns the length of the longest path of edges ending at v.
+  int level(int v) {
+    if (dirty)
+      relevel();
+    return lvl[v];
+  }
+
+  // Assigns a topological order to order[], where the nodes of level l are
+  // order[start[l]] to order[start[l + 1] - 1], and may all run concurrently.
+  void schedule(std::vector<int> &order, std::vector<int> &start) {
+    if (dirty)
+      relevel();
+    int n = nodes(), levels = 0;
+    for (int u = 0; u < n; u++) {
+      levels = std::max(levels, lvl[u] + 1);
+    }
+    start.assign(levels + 1, 0);
+    for (int u = 0; u < n; u++) {
+      start[lvl[u] + 1]++;
+    }
+    for (int l = 0; l < levels; l++) {
+      start[l + 1] += start[l];
+    }
+    std::vector<int> pos(start.begin(), start.end() - 1);
+    order.resize(n);
+    for (int u = 0; u < n; u++) {
+      order[pos[lvl[u]]++] = u;
+    }
+  }
+};
+
 /*** Example Usage and Output:
 
 The topological order: 2 1 0 4 3 7 6 5
+The levels: {0 1 2} {3 4} {5 6 7}
 
 ***/
 
+#include <cassert>
+#include <cstdlib>  // rand()
 #include <iostream>
 using namespace std;
 
@@ -74,5 +257,47 @@ int main() {
     cout << " " << res[i];
   }
   cout << endl;
+  dag_levels d(8);
+  for (int u = 0; u < 8; u++) {
+    for (int j = 0; j < (int)adj[u].size(); j++) {
+      d.add_edge(u, adj[u][j]);
+    }
+  }
+  vector<int> order, start;
+  d.schedule(order, start);
+  cout << "The levels:";
+  for (int l = 0; l + 1 < (int)start.size(); l++) {
+    cout << " {";
+    for (int i = start[l]; i < start[l + 1]; i++) {
+      cout << (i > start[l] ? " " : "") << order[i];
+    }
+    cout << "}";
+  }
+  cout << endl;
+  int u = d.add_node();
+  d.insert_edge(u, 2);
+  assert(d.level(u) == 0 && d.level(2) == 1 && d.level(4) == 2);
+  try {
+    d.insert_edge(7, u);  // Would close the cycle 8 -> 2 -> 7 -> 8.
+    assert(false);
+  } catch (const std::runtime_error &e) {
+    assert(d.level(2) == 1 && d.level(7) == 2);
+  }
+  // Inserting random edges one at a time gives the same levels as adding them
+  // all and computing the levels from scratch.
+  for (int t = 0; t < 20; t++) {
+    int n = 1 + rand() % 50;
+    dag_levels a(n), b(n);
+    for (int i = 0; i < 3*n; i++) {
+      int x = rand() % n, y = rand() % n;
+      try {
+        a.insert_edge(x, y);
+        b.add_edge(x, y);
+      } catch (const std::runtime_error &e) {}
+      for (int w = 0; w < n; w++) {
+        assert(a.level(w) == b.level(w));
+      }
+    }
+  }
   return 0;
 }
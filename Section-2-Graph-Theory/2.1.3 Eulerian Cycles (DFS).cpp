@@ -6,7 +6,11 @@ node. A directed graph has an Eulerian cycle if and only if every node has an
 in-degree equal to its out-degree, and all of its nodes with nonzero degree
 belong to a single strongly connected component. An undirected graph has an
 Eulerian cycle if and only if every node has even degree, and all of its nodes
-with nonzero degree belong to a single connected component.
+with nonzero degree belong to a single connected component. An Eulerian trail
+which is not a cycle exists under the same conditions, except that exactly one
+node must have one more outgoing than incoming edge and one node one more
+incoming than outgoing edge (directed), or exactly two nodes must have an odd
+degree (undirected), in which case the trail runs between these nodes.
 
 Given a graph as an adjacency list along with the starting node of the cycle,
 both functions below return a vector containing all nodes reachable from the
@@ -16,20 +20,32 @@ all values of their input adj[] vectors to be between 0 and MAXN - 1, inclusive.
 In addition, euler_cycle_undirected() requires that for every node v which is
 found in adj[u], node u must also be found in adj[v].
 
+euler_engine is a dynamically sized alternative taking a list of edges, which
+it stores once in compressed sparse row form. Rather than modifying the input,
+every node keeps a pointer to its next edge, and for undirected graphs, the
+used edges are marked in a bitset indexed by edge, shared by both directions of
+each edge. The engine checks the degree conditions, while the connectivity
+condition holds if and only if the trail found contains every edge. path()
+selects the start of the trail from the degrees, where cycle() takes it.
+
 Time Complexity:
 - O(max(n, m)) per call to either function, where n and m are the numbers of
   nodes and edges respectively.
+- O(n + m) to construct an euler_engine, and per call to its cycle() or path().
 
 Space Complexity:
 - O(n) auxiliary on the number of nodes for euler_cycle_directed().
 - O(n^2) auxiliary on the number of nodes for euler_cycle_undirected(). This can
   be reduced to O(m) auxiliary on the number of edges if the used[][] bit matrix
   is replaced with an std::unordered_set<std::pair<int, int>>.
+- O(n + m) for an euler_engine, and O(n) auxiliary per call to its cycle() or
+  path() (plus m bits if undirected).
 
 */
 
 #include <algorithm>  // std::max(), std::min(), std::reverse()
 #include <bitset>
+#include <utility>  // std::pair
 #include <vector>
 
 const int MAXN = 100;
@@ -72,6 +88,129 @@ std::vector<int> euler_cycle_undirected(std::vector<int> adj[], int u) {
   return res;
 }
 
+class euler_engine {
+  int n, m;
+  bool directed;
+  std::vector<int> start, to, id, span;
+  std::vector<unsigned long long> used;
+
+  // Hierholzer's algorithm, where each node keeps a pointer to its next
+  // unused edge, and undirected edges are marked used from both ends at once.
+  // The pointer and the end of the edges of u are kept side by side in
+  // span[2*u] and span[2*u + 1], so that both are fetched from memory at once.
+  bool trail(int u, std::vector<int> &res) {
+    res.clear();
+    res.reserve(m + 1);
+    span.resize(2*n);
+    for (int v = 0; v < n; v++) {
+      span[2*v] = start[v];
+      span[2*v + 1] = start[v + 1];
+    }
+    used.assign(directed ? 0 : (m + 63)/64, 0);
+    std::vector<int> stack(1, u);
+    stack.reserve(m + 1);
+    while (!stack.empty()) {
+      u = stack.back();
+      int &e = span[2*u], end = span[2*u + 1];
+      if (!directed) {
+        while (e < end && (used[id[e] >> 6] >> (id[e] & 63) & 1)) {
+          e++;
+        }
+      }
+      if (e == end) {
+        res.push_back(u);
+        stack.pop_back();
+        continue;
+      }
+      if (!directed) {
+        used[id[e] >> 6] |= 1ULL << (id[e] & 63);
+      }
+      stack.push_back(to[e++]);
+    }
+    std::reverse(res.begin(), res.end());
+    return (int)res.size() == m + 1;
+  }
+
+ public:
+  euler_engine(int nodes, const std::vector<std::pair<int, int> > &edges,
+               bool directed = true)
+      : n(nodes), m((int)edges.size()), directed(directed), start(nodes + 1, 0) {
+    for (int i = 0; i < m; i++) {
+      start[edges[i].first + 1]++;
+      if (!directed) {
+        start[edges[i].second + 1]++;
+      }
+    }
+    for (int u = 0; u < n; u++) {
+      start[u + 1] += start[u];
+    }
+    to.resize(start[n]);
+    if (!directed) {
+      id.resize(start[n]);
+    }
+    std::vector<int> pos(start.begin(), start.end() - 1);
+    for (int i = 0; i < m; i++) {
+      for (int k = 0; k < (directed ? 1 : 2); k++) {
+        int u = k ? edges[i].second : edges[i].first;
+        int e = pos[u]++;
+        to[e] = k ? edges[i].first : edges[i].second;
+        if (!directed) {
+          id[e] = i;
+        }
+      }
+    }
+  }
+
+  // Returns whether there is a Eulerian cycle through every edge, assigning it
+  // to res[] as a sequence of nodes beginning and ending at node u.
+  bool cycle(int u, std::vector<int> &res) {
+    std::vector<int> in(n, 0);
+    for (int e = 0; e < (int)to.size(); e++) {
+      in[to[e]]++;
+    }
+    for (int v = 0; v < n; v++) {
+      int out = start[v + 1] - start[v];
+      if (directed ? in[v] != out : out % 2 != 0) {
+        return false;
+      }
+    }
+    return trail(u, res);
+  }
+
+  // Returns whether there is a Eulerian trail through every edge, assigning it
+  // to res[] as a sequence of nodes. The trail begins at the only node with
+  // one more outgoing edge than incoming edges (directed), or at either of the
+  // only two nodes of odd degree (undirected), or if there is none of these,
+  // then it is a cycle from the first node having any edges.
+  bool path(std::vector<int> &res) {
+    std::vector<int> in(n, 0);
+    for (int e = 0; e < (int)to.size(); e++) {
+      in[to[e]]++;
+    }
+    int first = -1, odd = 0, s = -1;
+    for (int v = 0; v < n; v++) {
+      int out = start[v + 1] - start[v];
+      if (first < 0 && out > 0) {
+        first = v;
+      }
+      if (directed ? (out - in[v] == 1) : (out % 2 != 0)) {
+        s = (s < 0) ? v : s;
+        odd++;
+      } else if (directed && out != in[v] && out - in[v] != -1) {
+        return false;
+      }
+    }
+    if (odd > (directed ? 1 : 2)) {
+      return false;
+    }
+    if (m == 0) {
+      res.clear();
+      return true;
+    }
+    return trail(s >= 0 ? s : first, res);
+  }
+};
+
 /*** Example Usage and Output:
 
 Eulerian cycle from 0 (directed): 0 1 3 4 1 2 0
@@ -79,6 +218,7 @@ Eulerian cycle from 2 (undirected): 2 1 3 4 1 0 2
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -111,5 +251,20 @@ int main() {
       cout << " " << cycle[i];
     cout << endl;
   }
+  {
+    int e[][2] = {{0, 1}, {1, 2}, {2, 0}, {1, 3}, {3, 4}, {4, 1}, {4, 0}};
+    vector<pair<int, int> > edges;
+    for (int i = 0; i < 7; i++) {
+      edges.push_back(make_pair(e[i][0], e[i][1]));
+    }
+    vector<int> res;
+    euler_engine directed(5, edges), undirected(5, edges, false);
+    assert(!directed.cycle(0, res) && directed.path(res));
+    assert(res.size() == 8 && res[0] == 4 && res[7] == 0);
+    assert(!undirected.cycle(0, res) && undirected.path(res));
+    assert(res.size() == 8 && res[0] == 0 && res[7] == 4);
+    edges.pop_back();
+    assert(euler_engine(5, edges).cycle(0, res) && res.size() == 7);
+  }
   return 0;
 }
@@ -16,19 +16,43 @@ or equal to n/2, where n is the number of nodes in the tree.
 diameter() returns the maximum distance between any two nodes in the tree, using
 a well-known double depth-first search technique.
 
-Time Complexity: O(max(n, m)) per call to find_centers(), find_centroid(), and
-diameter(), where n and m are the number of nodes and edges respectively.
+Both depth-first searches are iterative, using an explicit, pre-allocated stack
+of (node, parent, next edge index) entries. Trees of any depth (e.g. paths with
+millions of nodes) are therefore handled without overflowing the call stack.
+
+tree_analytics computes all of the above at once for every tree of a forest
+given by a parent array, along with subtree sizes and the eccentricity of every
+node. It orders the nodes breadth-first, then makes one pass from the leaves up
+to find the two longest downward paths from each node through distinct
+children, and one pass from the roots down to find the longest path from each
+node which starts at its parent (rerooting). The eccentricity of a node is the
+larger of its longest downward and upward paths, from which each diameter and
+center follows. Every pass is a loop over flat arrays, and forests of many small
+trees are handled in the same passes as a single tree. parents_from_edges()
+converts a list of undirected edges to a parent array.
+
+Time Complexity:
+- O(max(n, m)) per call to find_centers(), find_centroid(), and diameter(),
+  where n and m are the number of nodes and edges respectively.
+- O(n) to construct a tree_analytics, or for parents_from_edges().
 
 Space Complexity: O(n) auxiliary on the number of nodes.
 
 */
 
+#include <algorithm>  // std::max(), std::min()
 #include <utility>  // std::pair
 #include <vector>
 
 const int MAXN = 100;
 std::vector<int> adj[MAXN];
 
+struct frame {
+  int u, p, j;
+
+  frame(int u, int p) : u(u), p(p), j(0) {}
+};
+
 std::vector<int> find_centers(int nodes) {
   std::vector<int> leaves, degree(nodes);
   for (int i = 0; i < nodes; i++) {
@@ -55,29 +79,51 @@ std::vector<int> find_centers(int nodes) {
   return leaves;
 }
 
+// Returns the first node in post-order whose subtrees all have at most n/2
+// nodes, where the largest subtree of each node u is tracked in heaviest[u].
 int find_centroid(int nodes, int u = 0, int p = -1) {
-  int cnt = 1, v;
-  bool good_center = true;
-  for (int j = 0; j < (int)adj[u].size(); j++) {
-    if ((v = adj[u][j]) == p)
+  std::vector<int> size(nodes, 1), heaviest(nodes, 0);
+  std::vector<frame> stack;
+  stack.reserve(nodes);
+  stack.push_back(frame(u, p));
+  while (!stack.empty()) {
+    frame &f = stack.back();
+    if (f.j < (int)adj[f.u].size()) {
+      int v = adj[f.u][f.j++];
+      if (v != f.p)
+        stack.push_back(frame(v, f.u));
       continue;
-    int res = find_centroid(nodes, v, u);
-    if (res >= 0)
-      return res;
-    int size = -res;
-    good_center &= (size <= nodes / 2);
-    cnt += size;
+    }
+    int v = f.u, parent = f.p;
+    stack.pop_back();
+    if (heaviest[v] <= nodes / 2 && nodes - size[v] <= nodes / 2)
+      return v;
+    if (parent >= 0) {
+      size[parent] += size[v];
+      heaviest[parent] = std::max(heaviest[parent], size[v]);
+    }
   }
-  good_center &= (nodes - cnt <= nodes / 2);
-  return good_center ? u : -cnt;
+  return -1;
 }
 
+// Returns the (depth, node) pair which is lexicographically largest among all
+// nodes reachable from u without passing through p.
 std::pair<int, int> dfs(int u, int p, int depth) {
   std::pair<int, int> res = std::make_pair(depth, u);
-  for (int j = 0; j < (int)adj[u].size(); j++) {
-    if (adj[u][j] != p) {
-      res = max(res, dfs(adj[u][j], u, depth + 1));
+  std::vector<frame> stack;
+  stack.reserve(MAXN);
+  stack.push_back(frame(u, p));
+  while (!stack.empty()) {
+    frame &f = stack.back();
+    if (f.j < (int)adj[f.u].size()) {
+      int v = adj[f.u][f.j++];
+      if (v != f.p) {
+        res = std::max(res, std::make_pair(depth + (int)stack.size(), v));
+        stack.push_back(frame(v, f.u));
+      }
+      continue;
     }
+    stack.pop_back();
   }
   return res;
 }
@@ -87,6 +133,134 @@ int diameter() {
   return dfs(furthest_node, -1, 0).first;
 }
 
+// Returns the parent of every node of a forest given as a list of undirected
+// edges, where the lowest numbered node of each tree is made its root.
+std::vector<int> parents_from_edges(
+    int nodes, const std::vector<std::pair<int, int> > &edges) {
+  std::vector<int> start(nodes + 1, 0), to(2*edges.size());
+  for (int i = 0; i < (int)edges.size(); i++) {
+    start[edges[i].first + 1]++;
+    start[edges[i].second + 1]++;
+  }
+  for (int u = 0; u < nodes; u++) {
+    start[u + 1] += start[u];
+  }
+  std::vector<int> pos(start.begin(), start.end() - 1), parent(nodes, -2), q;
+  for (int i = 0; i < (int)edges.size(); i++) {
+    to[pos[edges[i].first]++] = edges[i].second;
+    to[pos[edges[i].second]++] = edges[i].first;
+  }
+  q.reserve(nodes);
+  for (int r = 0; r < nodes; r++) {
+    if (parent[r] != -2) {
+      continue;
+    }
+    parent[r] = -1;
+    q.push_back(r);
+    for (int i = (int)q.size() - 1; i < (int)q.size(); i++) {
+      int u = q[i];
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        if (parent[to[j]] == -2) {
+          parent[to[j]] = u;
+          q.push_back(to[j]);
+        }
+      }
+    }
+  }
+  return parent;
+}
+
+struct tree_analytics {
+  // The nodes in breadth-first order, and for every node: the index of its
+  // tree, the size of its subtree, and its eccentricity.
+  std::vector<int> order, tree, size, ecc;
+  // For every tree: its root, diameter, first centroid in order[], and one or
+  // two centers, where the second center is -1 if there is only one.
+  std::vector<int> root, diameter, centroid, center1, center2;
+
+  // Takes a forest where parent[u] is the parent of node u, or -1 if u is a
+  // root. The nodes are visited in breadth-first order, so that a pass over
+  // order[] visits every parent before its children, and a pass in reverse
+  // visits every child before its parent.
+  tree_analytics(const std::vector<int> &parent) {
+    int n = (int)parent.size();
+    std::vector<int> start(n + 2, 0), kids(n);
+    for (int u = 0; u < n; u++) {
+      start[parent[u] + 2]++;
+    }
+    for (int u = 0; u <= n; u++) {
+      start[u + 1] += start[u];
+    }
+    // The roots are the children of the virtual node -1.
+    for (int u = 0; u < n; u++) {
+      kids[start[parent[u] + 1]++] = u;
+    }
+    order.assign(kids.begin(), kids.begin() + start[0]);
+    order.reserve(n);
+    tree.resize(n);
+    for (int i = 0; i < (int)order.size(); i++) {
+      tree[order[i]] = i;
+    }
+    root = order;
+    for (int i = 0; i < (int)order.size(); i++) {
+      int u = order[i];
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        tree[kids[j]] = tree[u];
+        order.push_back(kids[j]);
+      }
+    }
+    // down1[u] and down2[u] are the two longest paths down from u through
+    // distinct children, where the first goes through the child best[u].
+    std::vector<int> down1(n, 0), down2(n, 0), best(n, -1), up(n, 0);
+    size.assign(n, 1);
+    for (int i = n - 1; i >= 0; i--) {
+      int u = order[i], p = parent[u];
+      if (p < 0) {
+        continue;
+      }
+      size[p] += size[u];
+      int d = down1[u] + 1;
+      if (d > down1[p]) {
+        down2[p] = down1[p];
+        down1[p] = d;
+        best[p] = u;
+      } else if (d > down2[p]) {
+        down2[p] = d;
+      }
+    }
+    // up[u] is the longest path from u which starts with its parent.
+    ecc.resize(n);
+    int trees = (int)root.size();
+    diameter.assign(trees, 0);
+    centroid.assign(trees, -1);
+    std::vector<int> radius(trees, n);
+    for (int i = 0; i < n; i++) {
+      int u = order[i], p = parent[u], t = tree[u];
+      if (p >= 0) {
+        up[u] = 1 + std::max(up[p], (best[p] == u) ? down2[p] : down1[p]);
+      }
+      ecc[u] = std::max(up[u], down1[u]);
+      diameter[t] = std::max(diameter[t], ecc[u]);
+      radius[t] = std::min(radius[t], ecc[u]);
+    }
+    center1.assign(trees, -1);
+    center2.assign(trees, -1);
+    for (int i = 0; i < n; i++) {
+      int u = order[i], t = tree[u], total = size[root[t]];
+      if (ecc[u] == radius[t]) {
+        (center1[t] < 0 ? center1[t] : center2[t]) = u;
+      }
+      int heaviest = total - size[u];
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        heaviest = std::max(heaviest, size[kids[j]]);
+      }
+      if (centroid[t] < 0 && heaviest <= total/2) {
+        centroid[t] = u;
+      }
+    }
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -108,5 +282,16 @@ int main() {
   assert(centers.size() == 2 && centers[0] == 1 && centers[1] == 4);
   assert(find_centroid(nodes) == 4);
   assert(diameter() == 3);
+  // The same tree, and a second tree 6 - 7.
+  int e[][2] = {{0, 1}, {1, 2}, {1, 4}, {3, 4}, {4, 5}, {6, 7}};
+  vector<pair<int, int> > edges;
+  for (int i = 0; i < 6; i++) {
+    edges.push_back(make_pair(e[i][0], e[i][1]));
+  }
+  tree_analytics t(parents_from_edges(8, edges));
+  assert(t.root.size() == 2 && t.root[0] == 0 && t.root[1] == 6);
+  assert(t.diameter[0] == 3 && t.diameter[1] == 1);
+  assert(t.center1[0] == 1 && t.center2[0] == 4 && t.centroid[0] == 1);
+  assert(t.ecc[0] == 3 && t.ecc[1] == 2 && t.size[4] == 3 && t.tree[7] == 1);
   return 0;
 }
@@ -8,11 +8,36 @@ adjacency list adj[] which must only consist of nodes numbered with integers
 between 0 (inclusive) and the total number of nodes (exclusive), as passed in
 the function argument.
 
-Time Complexity: O(n) on the number of nodes.
-Space Complexity: O(n) auxiliary on the number of nodes.
+bfs_engine is a dynamically sized alternative for large graphs. It copies the
+adjacency lists into contiguous compressed sparse row arrays, both forward and
+reversed. bfs() runs a direction-optimizing search: it advances each level
+either top-down (scanning the out-edges of the frontier) or bottom-up (scanning
+the in-edges of every unvisited node against a frontier bitmap, stopping at the
+first hit). The engine switches to bottom-up once the frontier's edges outweigh
+1/ALPHA of the unvisited nodes' edges, and back once the frontier shrinks below
+1/BETA of the nodes. This skips most edge checks on low-diameter graphs, such as
+social networks. Passing several sources computes the distance of each node to
+its nearest source. After each search, levels holds per-level statistics (the
+frontier size, the direction used, and the time taken). batch_bfs() computes a
+separate BFS from each of many sources. It processes 64 sources at a time with
+one bit per source, so that one scan of the graph advances all 64 searches.
+
+Time Complexity:
+- O(n + m) per call to bfs() or to construct a bfs_engine, where n and m are
+  the number of nodes and edges. Bottom-up levels are often much faster in
+  practice, since each unvisited node stops at its first frontier neighbor.
+- O(ceil(k/64)*d*(n + m)) per call to batch_bfs() for k sources, where d is the
+  largest eccentricity of a source.
+
+Space Complexity:
+- O(n) auxiliary on the number of nodes for bfs().
+- O(n + m) for a bfs_engine.
+- O(k*n) for the output of batch_bfs(), plus O(n) auxiliary.
 
 */
 
+#include <algorithm>  // std::fill(), std::min()
+#include <ctime>  // std::clock()
 #include <queue>
 #include <utility>
 #include <vector>
@@ -30,15 +55,17 @@ void bfs(int nodes, int start) {
   int u, v, d;
   std::queue<std::pair<int, int> > q;
   q.push(std::make_pair(start, 0));
+  dist[start] = 0;
+  vis[start] = true;
   while (!q.empty()) {
     u = q.front().first;
     d = q.front().second;
     q.pop();
-    vis[u] = true;
     for (int j = 0; j < (int)adj[u].size(); j++) {
       v = adj[u][j];
       if (vis[v])
         continue;
+      vis[v] = true;
       dist[v] = d + 1;
       pred[v] = u;
       q.push(std::make_pair(v, d + 1));
@@ -46,14 +73,186 @@ void bfs(int nodes, int start) {
   }
 }
 
+class bfs_engine {
+  static const int ALPHA = 14, BETA = 24;
+
+  int n;
+  std::vector<int> out_start, out_edges, in_start, in_edges;
+  std::vector<int> frontier, next;
+  std::vector<unsigned long long> bits;
+
+  // Returns the total out-degree of the new frontier.
+  long long top_down_step(int depth) {
+    long long edges = 0;
+    next.clear();
+    for (int i = 0; i < (int)frontier.size(); i++) {
+      int u = frontier[i];
+      for (int j = out_start[u]; j < out_start[u + 1]; j++) {
+        int v = out_edges[j];
+        if (dist[v] == INF) {
+          dist[v] = depth + 1;
+          pred[v] = u;
+          next.push_back(v);
+          edges += out_start[v + 1] - out_start[v];
+        }
+      }
+    }
+    return edges;
+  }
+
+  long long bottom_up_step(int depth) {
+    long long edges = 0;
+    std::fill(bits.begin(), bits.end(), 0);
+    for (int i = 0; i < (int)frontier.size(); i++) {
+      bits[frontier[i] >> 6] |= 1ULL << (frontier[i] & 63);
+    }
+    next.clear();
+    for (int v = 0; v < n; v++) {
+      if (dist[v] != INF) {
+        continue;
+      }
+      for (int j = in_start[v]; j < in_start[v + 1]; j++) {
+        int u = in_edges[j];
+        if ((bits[u >> 6] >> (u & 63)) & 1) {
+          dist[v] = depth + 1;
+          pred[v] = u;
+          next.push_back(v);
+          edges += out_start[v + 1] - out_start[v];
+          break;
+        }
+      }
+    }
+    return edges;
+  }
+
+ public:
+  struct level_stats {
+    int frontier_size;
+    bool bottom_up;
+    double seconds;
+  };
+
+  std::vector<int> dist, pred;
+  std::vector<level_stats> levels;
+
+  bfs_engine(int nodes, const std::vector<int> adj[])
+      : n(nodes), out_start(nodes + 1, 0), in_start(nodes + 1, 0),
+        bits((nodes + 63)/64), dist(nodes), pred(nodes) {
+    for (int u = 0; u < n; u++) {
+      out_start[u + 1] = out_start[u] + (int)adj[u].size();
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        in_start[adj[u][j] + 1]++;
+      }
+    }
+    for (int u = 0; u < n; u++) {
+      in_start[u + 1] += in_start[u];
+    }
+    out_edges.resize(out_start[n]);
+    in_edges.resize(out_start[n]);
+    std::vector<int> pos(in_start.begin(), in_start.end() - 1);
+    for (int u = 0; u < n; u++) {
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        out_edges[out_start[u] + j] = adj[u][j];
+        in_edges[pos[adj[u][j]]++] = u;
+      }
+    }
+    frontier.reserve(n);
+    next.reserve(n);
+  }
+
+  int nodes() const {
+    return n;
+  }
+
+  void bfs(const std::vector<int> &sources) {
+    std::fill(dist.begin(), dist.end(), INF);
+    std::fill(pred.begin(), pred.end(), -1);
+    levels.clear();
+    frontier.clear();
+    long long frontier_edges = 0, unvisited_edges = out_start[n];
+    for (int i = 0; i < (int)sources.size(); i++) {
+      int s = sources[i];
+      if (dist[s] != 0) {
+        dist[s] = 0;
+        frontier.push_back(s);
+        frontier_edges += out_start[s + 1] - out_start[s];
+      }
+    }
+    bool bottom_up = false;
+    for (int depth = 0; !frontier.empty(); depth++) {
+      unvisited_edges -= frontier_edges;
+      if (!bottom_up && frontier_edges > unvisited_edges/ALPHA) {
+        bottom_up = true;
+      } else if (bottom_up && (long long)frontier.size()*BETA < n) {
+        bottom_up = false;
+      }
+      level_stats s;
+      s.frontier_size = (int)frontier.size();
+      s.bottom_up = bottom_up;
+      std::clock_t begin = std::clock();
+      frontier_edges = bottom_up ? bottom_up_step(depth) : top_down_step(depth);
+      s.seconds = (double)(std::clock() - begin)/CLOCKS_PER_SEC;
+      levels.push_back(s);
+      frontier.swap(next);
+    }
+  }
+
+  void bfs(int start) {
+    bfs(std::vector<int>(1, start));
+  }
+
+  // Sets res[i][v] to the distance from sources[i] to v, or INF if v is not
+  // reachable from sources[i].
+  void batch_bfs(const std::vector<int> &sources,
+                 std::vector<std::vector<int> > &res) const {
+    int k = (int)sources.size();
+    res.assign(k, std::vector<int>(n, INF));
+    std::vector<unsigned long long> seen(n), visit(n), visit_next(n);
+    for (int lo = 0; lo < k; lo += 64) {
+      int hi = std::min(k, lo + 64);
+      std::fill(seen.begin(), seen.end(), 0);
+      std::fill(visit.begin(), visit.end(), 0);
+      for (int i = lo; i < hi; i++) {
+        seen[sources[i]] |= 1ULL << (i - lo);
+        visit[sources[i]] |= 1ULL << (i - lo);
+        res[i][sources[i]] = 0;
+      }
+      for (int depth = 1, active = 1; active; depth++) {
+        active = 0;
+        for (int u = 0; u < n; u++) {
+          if (visit[u] != 0) {
+            for (int j = out_start[u]; j < out_start[u + 1]; j++) {
+              visit_next[out_edges[j]] |= visit[u];
+            }
+          }
+        }
+        for (int v = 0; v < n; v++) {
+          unsigned long long found = visit_next[v] & ~seen[v];
+          visit_next[v] = 0;
+          visit[v] = found;
+          if (found != 0) {
+            seen[v] |= found;
+            active = 1;
+            for (; found != 0; found &= found - 1) {
+              res[lo + __builtin_ctzll(found)][v] = depth;
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
 
 /*** Example Usage and Output:
 
-The shortest distance from 0 to 3 is 2.
-Take the path: 0->1->3.
+The shortest distance from 0 to 3 is 1.
+Take the path: 0->3.
 
 ***/
 
+#include <cassert>
+#include <cstdlib>
 #include <iostream>
 using namespace std;
 
@@ -82,5 +281,30 @@ int main() {
   cout << "The shortest distance from " << start;
   cout << " to " << dest << " is " << dist[dest] << "." << endl;
   print_path(dest);
+
+  const int n = 100;
+  for (int i = 0; i < n; i++) {
+    adj[i].clear();
+  }
+  for (int i = 0; i < 5*n; i++) {
+    adj[rand() % n].push_back(rand() % n);
+  }
+  bfs_engine e(n, adj);
+  vector<int> sources;
+  for (int s = 0; s < n; s++) {
+    sources.push_back(s);
+  }
+  vector<vector<int> > all;
+  e.batch_bfs(sources, all);
+  for (int s = 0; s < n; s++) {
+    bfs(n, s);
+    e.bfs(s);
+    for (int v = 0; v < n; v++) {
+      assert(e.dist[v] == dist[v] && all[s][v] == dist[v]);
+    }
+  }
+  sources.resize(2);
+  e.bfs(sources);
+  assert(e.dist[0] == 0 && e.dist[1] == 0);
   return 0;
 }
@@ -22,13 +22,35 @@ a larger running time of O(n*m) on the number of nodes and edges respectively.
 While it is as slow in the worst case as the Bellman-Ford algorithm, the SPFA
 still tends to outperform in the average case.
 
-Time Complexity: O(m log n) where m is the number of edges and n is the number
-of nodes.
+dijkstra_engine<Queue> is a class-based alternative for answering many queries
+on one graph. It copies the adjacency lists into contiguous compressed sparse
+row arrays once. Its dist[] and pred[] arrays form a reusable workspace, and
+each query only resets the entries touched by the previous query. Passing a
+target to run() stops the search as soon as the target's distance is final.
+The priority queue is selected by the template argument:
+- dary_heap: an indexed 4-ary heap with true decrease-key, so each node is in
+  the queue at most once. Works for any nonnegative weights.
+- radix_heap: a monotone radix heap over 32-bit keys. It has O(1) amortized
+  push() and O(log C) amortized pop() for a maximum edge weight C.
+- dial_buckets: Dial's algorithm, with C + 1 circular buckets. It is fastest
+  when the maximum edge weight C is small.
+The last two use lazy deletion: when a distance improves, the node is pushed
+again, and outdated entries are skipped when popped.
 
-Space Complexity: O(n) auxiliary on the number of nodes.
+Time Complexity:
+- O(m log n) for dijkstra(), where m is the number of edges and n is the number
+  of nodes.
+- O(m + n log n) per call to run() with dary_heap, with a smaller constant
+  factor than a binary heap. With radix_heap, O(m + n log C) per call, and with
+  dial_buckets, O(m + n*C) per call. When a target is given, only the nodes
+  closer than it are processed.
+
+Space Complexity: O(n) auxiliary on the number of nodes for dijkstra(), and
+O(n + m) for a dijkstra_engine.
 
 */
 
+#include <algorithm>  // std::swap()
 #include <queue>
 #include <utility>
 #include <vector>
@@ -64,6 +86,245 @@ void dijkstra(int nodes, int start) {
   }
 }
 
+class dary_heap {
+  static const int D = 4;
+
+  std::vector<int> heap, pos, key;
+
+  void sift_up(int i) {
+    int v = heap[i];
+    for (int p; i > 0 && key[heap[p = (i - 1)/D]] > key[v]; i = p) {
+      heap[i] = heap[p];
+      pos[heap[i]] = i;
+    }
+    heap[i] = v;
+    pos[v] = i;
+  }
+
+  void sift_down(int i) {
+    int v = heap[i], n = (int)heap.size();
+    for (;;) {
+      int c = D*i + 1, best = -1;
+      for (int end = std::min(c + D, n); c < end; c++) {
+        if (key[heap[c]] < (best < 0 ? key[v] : key[heap[best]])) {
+          best = c;
+        }
+      }
+      if (best < 0) {
+        break;
+      }
+      heap[i] = heap[best];
+      pos[heap[i]] = i;
+      i = best;
+    }
+    heap[i] = v;
+    pos[v] = i;
+  }
+
+ public:
+  dary_heap(int nodes, int) : pos(nodes, -1), key(nodes) {
+    heap.reserve(nodes);
+  }
+
+  bool empty() const {
+    return heap.empty();
+  }
+
+  void clear() {
+    for (int i = 0; i < (int)heap.size(); i++) {
+      pos[heap[i]] = -1;
+    }
+    heap.clear();
+  }
+
+  // Inserts v, or decreases its key if it is already in the heap.
+  void push(int v, int k) {
+    key[v] = k;
+    if (pos[v] < 0) {
+      heap.push_back(v);
+      pos[v] = (int)heap.size() - 1;
+    }
+    sift_up(pos[v]);
+  }
+
+  int pop(int &k) {
+    int v = heap[0];
+    k = key[v];
+    pos[v] = -1;
+    if (heap.size() > 1) {
+      heap[0] = heap.back();
+      heap.pop_back();
+      sift_down(0);
+    } else {
+      heap.pop_back();
+    }
+    return v;
+  }
+};
+
+class radix_heap {
+  std::vector<std::pair<unsigned int, int> > buckets[33];
+  unsigned int last;
+  int size;
+
+  static int bucket(unsigned int x) {
+    return (x == 0) ? 0 : 32 - __builtin_clz(x);
+  }
+
+ public:
+  radix_heap(int, int) : last(0), size(0) {}
+
+  bool empty() const {
+    return size == 0;
+  }
+
+  void clear() {
+    for (int i = 0; i <= 32; i++) {
+      buckets[i].clear();
+    }
+    last = 0;
+    size = 0;
+  }
+
+  void push(int v, int k) {
+    buckets[bucket((unsigned int)k ^ last)].push_back(std::make_pair(k, v));
+    size++;
+  }
+
+  // Redistributes the first nonempty bucket around its minimum key, which
+  // moves at least that minimum into bucket 0.
+  int pop(int &k) {
+    if (buckets[0].empty()) {
+      int i = 1;
+      while (buckets[i].empty()) {
+        i++;
+      }
+      last = buckets[i][0].first;
+      for (int j = 1; j < (int)buckets[i].size(); j++) {
+        last = std::min(last, buckets[i][j].first);
+      }
+      for (int j = 0; j < (int)buckets[i].size(); j++) {
+        std::pair<unsigned int, int> &e = buckets[i][j];
+        buckets[bucket(e.first ^ last)].push_back(e);
+      }
+      buckets[i].clear();
+    }
+    k = (int)buckets[0].back().first;
+    int v = buckets[0].back().second;
+    buckets[0].pop_back();
+    size--;
+    return v;
+  }
+};
+
+class dial_buckets {
+  std::vector<std::vector<std::pair<int, int> > > buckets;
+  int cur, size;
+
+ public:
+  dial_buckets(int, int max_weight)
+      : buckets(max_weight + 1), cur(0), size(0) {}
+
+  bool empty() const {
+    return size == 0;
+  }
+
+  void clear() {
+    for (int i = 0; i < (int)buckets.size(); i++) {
+      buckets[i].clear();
+    }
+    cur = 0;
+    size = 0;
+  }
+
+  // Every pending key lies in [k, k + C] for the last popped key k, so keys
+  // never collide after wrapping around modulo C + 1.
+  void push(int v, int k) {
+    buckets[k % buckets.size()].push_back(std::make_pair(k, v));
+    size++;
+  }
+
+  int pop(int &k) {
+    while (buckets[cur].empty()) {
+      cur = (cur + 1 == (int)buckets.size()) ? 0 : cur + 1;
+    }
+    k = buckets[cur].back().first;
+    int v = buckets[cur].back().second;
+    buckets[cur].pop_back();
+    size--;
+    return v;
+  }
+};
+
+template<class Queue>
+class dijkstra_engine {
+  int n;
+  std::vector<int> start, target, weight, touched;
+  Queue q;
+
+  static int max_weight(int nodes, const std::vector<std::pair<int, int> > adj[]) {
+    int res = 0;
+    for (int u = 0; u < nodes; u++) {
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        res = std::max(res, adj[u][j].second);
+      }
+    }
+    return res;
+  }
+
+ public:
+  std::vector<int> dist, pred;
+
+  dijkstra_engine(int nodes, const std::vector<std::pair<int, int> > adj[])
+      : n(nodes), start(nodes + 1, 0), q(nodes, max_weight(nodes, adj)),
+        dist(nodes, INF), pred(nodes, -1) {
+    for (int u = 0; u < n; u++) {
+      start[u + 1] = start[u] + (int)adj[u].size();
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        target.push_back(adj[u][j].first);
+        weight.push_back(adj[u][j].second);
+      }
+    }
+    touched.reserve(n);
+  }
+
+  // Returns the distance to target, or INF if it is unreachable. If target is
+  // -1, the distances to all nodes are computed and 0 is returned. Distances
+  // of nodes farther than the target may not be final after an early exit.
+  int run(int source, int dest = -1) {
+    for (int i = 0; i < (int)touched.size(); i++) {
+      dist[touched[i]] = INF;
+      pred[touched[i]] = -1;
+    }
+    touched.clear();
+    q.clear();
+    dist[source] = 0;
+    touched.push_back(source);
+    q.push(source, 0);
+    while (!q.empty()) {
+      int d, u = q.pop(d);
+      if (d != dist[u]) {
+        continue;
+      }
+      if (u == dest) {
+        return d;
+      }
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        int v = target[j], nd = d + weight[j];
+        if (nd < dist[v]) {
+          if (dist[v] == INF) {
+            touched.push_back(v);
+          }
+          dist[v] = nd;
+          pred[v] = u;
+          q.push(v, nd);
+        }
+      }
+    }
+    return (dest < 0) ? 0 : INF;
+  }
+};
+
 /*** Example Usage and Output:
 
 The shortest distance from 0 to 3 is 5.
@@ -71,6 +332,8 @@ Take the path: 0->1->2->3.
 
 ***/
 
+#include <cassert>
+#include <cstdlib>
 #include <iostream>
 using namespace std;
 
@@ -98,5 +361,29 @@ int main() {
   cout << "The shortest distance from " << start;
   cout << " to " << dest << " is " << dist[dest] << "." << endl;
   print_path(dest);
+
+  const int n = 100;
+  for (int i = 0; i < n; i++) {
+    adj[i].clear();
+  }
+  for (int i = 0; i < 5*n; i++) {
+    adj[rand() % n].push_back(make_pair(rand() % n, rand() % 20));
+  }
+  dijkstra_engine<dary_heap> e1(n, adj);
+  dijkstra_engine<radix_heap> e2(n, adj);
+  dijkstra_engine<dial_buckets> e3(n, adj);
+  for (int s = 0; s < n; s++) {
+    dijkstra(n, s);
+    e1.run(s);
+    e2.run(s);
+    e3.run(s);
+    for (int v = 0; v < n; v++) {
+      assert(e1.dist[v] == dist[v] && e2.dist[v] == dist[v]);
+      assert(e3.dist[v] == dist[v]);
+    }
+    for (int v = 0; v < n; v++) {
+      assert(e1.run(s, v) == dist[v] && e3.run(s, v) == dist[v]);
+    }
+  }
   return 0;
 }
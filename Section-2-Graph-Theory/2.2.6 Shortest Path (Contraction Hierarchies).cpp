@@ -0,0 +1,545 @@
+/*
+
+Given a weighted, directed graph with nonnegative weights only, preprocess it so
+that the minimum distance and shortest path between any two nodes can be found
+quickly. Contraction hierarchies work especially well on road networks, where
+queries settle only a few hundred nodes even for continental graphs.
+
+contraction_hierarchy applies to a global, pre-populated adjacency list adj[]
+(in the same format as for Dijkstra's algorithm) which must only consist of
+nodes numbered with integers between 0 (inclusive) and the total number of nodes
+(exclusive), as passed to build().
+
+build() removes ("contracts") the nodes one by one in order of importance. When
+a node v is contracted, each pair of remaining edges u -> v -> w is replaced by
+a shortcut edge u -> w of the same total weight, unless a witness search (a
+local Dijkstra from u avoiding v) finds a path from u to w that is no longer.
+Nodes are ordered by edge difference: the number of shortcuts contracting the
+node would add, minus the number of edges it would remove, plus the number of
+its already contracted neighbors (which spreads the contraction evenly). The
+priorities are updated lazily, so a node is only contracted if its freshly
+recomputed priority is still the smallest. Each node's rank is its position in
+the contraction order. Every original edge and shortcut is kept with the lower
+ranked of its two endpoints, either as an upward edge out of the node or as an
+upward edge into it. A shortcut also records the node it skips over.
+
+query(s, t) runs a bidirectional Dijkstra where the forward search from s only
+follows edges to higher ranked nodes, and the backward search from t only
+follows edges from higher ranked nodes. Every shortest path has a highest
+ranked node, and both searches meet there. The shortest path is then unpacked
+by recursively replacing each shortcut by the two edges it skips over.
+
+save() writes the whole hierarchy to a binary file as a header of four ints
+(a magic number, n, and the numbers of upward out-edges and in-edges) followed
+by its flat int arrays back to back, with no pointers or padding. load() reads
+the file back, returning false if the counts in the header are negative or do
+not match the size of the file. The layout is suitable for memory mapping the file at startup,
+with the arrays used directly from the mapping.
+
+Time Complexity:
+- build() is heuristic and has no useful worst case bound. For road networks it
+  is roughly O(n log n) witness searches, each of which settles at most
+  WITNESS_LIMIT nodes.
+- query() is O(m' log n) in the worst case, where m' is the number of upward
+  edges, but only settles a few hundred nodes in practice on road networks.
+  Unpacking the path is O(k*d), where k is the number of edges in the path and
+  d is the maximum upward degree.
+- O(n + m') for save() and load().
+
+Space Complexity: O(n + m') for the hierarchy, where m' is the number of
+original edges plus shortcuts.
+
+*/
+
+#include <algorithm>  // std::max(), std::reverse()
+#include <cstdio>  // std::fclose(), std::fopen(), std::fread(), std::fseek(), ...
+#include <functional>  // std::greater
+#include <queue>
+#include <utility>  // std::make_pair(), std::pair
+#include <vector>
+
+const int MAXN = 10000, INF = 0x3f3f3f3f;
+std::vector<std::pair<int, int> > adj[MAXN];
+
+class contraction_hierarchy {
+  static const int WITNESS_LIMIT = 500, MAGIC = 0x31304843;
+
+  typedef std::pair<int, int> entry;
+  typedef std::priority_queue<entry, std::vector<entry>,
+                              std::greater<entry> > min_heap;
+
+  struct edge {
+    int to, w, mid;
+
+    edge(int to, int w, int mid) : to(to), w(w), mid(mid) {}
+  };
+
+  // Working graph during contraction, and the workspace of the witness search.
+  std::vector<std::vector<edge> > out, in;
+  std::vector<char> contracted;
+  std::vector<int> wdist, wtouched;
+
+  // The hierarchy itself, in flat arrays. Node u's upward out-edges are at
+  // indices [out_start[u], out_start[u + 1]) of out_to, out_w and out_mid, and
+  // its upward in-edges are likewise at [in_start[u], in_start[u + 1]).
+  int n;
+  std::vector<int> rank, out_start, out_to, out_w, out_mid;
+  std::vector<int> in_start, in_to, in_w, in_mid;
+
+  // Query workspace, with one entry per direction.
+  std::vector<int> dist[2], pred[2], touched[2];
+
+  // Runs a Dijkstra from s in the remaining graph without passing through v,
+  // until either the distances exceed limit or WITNESS_LIMIT nodes have been
+  // settled. Afterwards, wdist[x] is the length of some path from s to x, or
+  // INF if no such path was found.
+  void witness(int s, int v, int limit) {
+    for (int i = 0; i < (int)wtouched.size(); i++) {
+      wdist[wtouched[i]] = INF;
+    }
+    wtouched.clear();
+    min_heap pq;
+    wdist[s] = 0;
+    wtouched.push_back(s);
+    pq.push(std::make_pair(0, s));
+    for (int settled = 0; !pq.empty() && settled < WITNESS_LIMIT; settled++) {
+      int d = pq.top().first, u = pq.top().second;
+      pq.pop();
+      if (d > wdist[u]) {
+        continue;
+      }
+      if (d > limit) {
+        break;
+      }
+      for (int j = 0; j < (int)out[u].size(); j++) {
+        int x = out[u][j].to, nd = d + out[u][j].w;
+        if (x != v && !contracted[x] && nd < wdist[x]) {
+          if (wdist[x] == INF) {
+            wtouched.push_back(x);
+          }
+          wdist[x] = nd;
+          pq.push(std::make_pair(nd, x));
+        }
+      }
+    }
+  }
+
+  // Finds the shortcuts needed to contract v. If add is true, they are also
+  // inserted into the working graph. Returns the number of shortcuts.
+  int shortcuts(int v, bool add) {
+    int count = 0;
+    for (int i = 0; i < (int)in[v].size(); i++) {
+      int u = in[v][i].to;
+      if (contracted[u]) {
+        continue;
+      }
+      int limit = 0;
+      for (int j = 0; j < (int)out[v].size(); j++) {
+        if (!contracted[out[v][j].to]) {
+          limit = std::max(limit, in[v][i].w + out[v][j].w);
+        }
+      }
+      witness(u, v, limit);
+      for (int j = 0; j < (int)out[v].size(); j++) {
+        int w = out[v][j].to, d = in[v][i].w + out[v][j].w;
+        if (w == u || contracted[w] || wdist[w] <= d) {
+          continue;
+        }
+        count++;
+        if (add) {
+          add_edge(u, w, d, v);
+        }
+      }
+    }
+    return count;
+  }
+
+  void add_edge(int u, int w, int d, int mid) {
+    for (int j = 0; j < (int)out[u].size(); j++) {
+      if (out[u][j].to == w) {
+        if (d < out[u][j].w) {
+          out[u][j] = edge(w, d, mid);
+          for (int k = 0; k < (int)in[w].size(); k++) {
+            if (in[w][k].to == u) {
+              in[w][k] = edge(u, d, mid);
+            }
+          }
+        }
+        return;
+      }
+    }
+    out[u].push_back(edge(w, d, mid));
+    in[w].push_back(edge(u, d, mid));
+  }
+
+  int priority(int v, const std::vector<int> &deleted) {
+    int removed = 0;
+    for (int j = 0; j < (int)out[v].size(); j++) {
+      removed += !contracted[out[v][j].to];
+    }
+    for (int j = 0; j < (int)in[v].size(); j++) {
+      removed += !contracted[in[v][j].to];
+    }
+    return shortcuts(v, false) - removed + deleted[v];
+  }
+
+  // Returns the index of the upward edge from a to b, which is stored with the
+  // lower ranked of the two nodes.
+  int find_edge(int a, int b, bool &is_out) const {
+    int best = -1;
+    if (rank[a] < rank[b]) {
+      is_out = true;
+      for (int j = out_start[a]; j < out_start[a + 1]; j++) {
+        if (out_to[j] == b && (best < 0 || out_w[j] < out_w[best])) {
+          best = j;
+        }
+      }
+    } else {
+      is_out = false;
+      for (int j = in_start[b]; j < in_start[b + 1]; j++) {
+        if (in_to[j] == a && (best < 0 || in_w[j] < in_w[best])) {
+          best = j;
+        }
+      }
+    }
+    return best;
+  }
+
+  // Appends the unpacked path of the edge a -> b, excluding a itself.
+  void unpack(int a, int b, std::vector<int> &res) const {
+    std::vector<std::pair<int, int> > stack(1, std::make_pair(a, b));
+    while (!stack.empty()) {
+      int x = stack.back().first, y = stack.back().second;
+      stack.pop_back();
+      bool is_out;
+      int e = find_edge(x, y, is_out);
+      int mid = is_out ? out_mid[e] : in_mid[e];
+      if (mid < 0) {
+        res.push_back(y);
+      } else {
+        stack.push_back(std::make_pair(mid, y));
+        stack.push_back(std::make_pair(x, mid));
+      }
+    }
+  }
+
+  void init_workspace() {
+    for (int k = 0; k < 2; k++) {
+      dist[k].assign(n, INF);
+      pred[k].assign(n, -1);
+      touched[k].clear();
+    }
+  }
+
+ public:
+  std::vector<int> path;
+  int settled;
+
+  contraction_hierarchy() : n(0), settled(0) {}
+
+  int nodes() const {
+    return n;
+  }
+
+  int upward_edges() const {
+    return (int)(out_to.size() + in_to.size());
+  }
+
+  void build(int nodes) {
+    n = nodes;
+    out.assign(n, std::vector<edge>());
+    in.assign(n, std::vector<edge>());
+    for (int u = 0; u < n; u++) {
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        if (adj[u][j].first != u) {
+          add_edge(u, adj[u][j].first, adj[u][j].second, -1);
+        }
+      }
+    }
+    contracted.assign(n, false);
+    wdist.assign(n, INF);
+    wtouched.clear();
+    std::vector<int> deleted(n, 0);
+    min_heap pq;
+    for (int v = 0; v < n; v++) {
+      pq.push(std::make_pair(priority(v, deleted), v));
+    }
+    std::vector<std::vector<edge> > up_out(n), up_in(n);
+    rank.assign(n, 0);
+    for (int r = 0; !pq.empty(); ) {
+      int v = pq.top().second;
+      pq.pop();
+      int p = priority(v, deleted);
+      if (!pq.empty() && p > pq.top().first) {
+        pq.push(std::make_pair(p, v));
+        continue;
+      }
+      shortcuts(v, true);
+      contracted[v] = true;
+      rank[v] = r++;
+      for (int j = 0; j < (int)out[v].size(); j++) {
+        if (!contracted[out[v][j].to]) {
+          up_out[v].push_back(out[v][j]);
+          deleted[out[v][j].to]++;
+        }
+      }
+      for (int j = 0; j < (int)in[v].size(); j++) {
+        if (!contracted[in[v][j].to]) {
+          up_in[v].push_back(in[v][j]);
+          deleted[in[v][j].to]++;
+        }
+      }
+    }
+    out_start.assign(n + 1, 0);
+    in_start.assign(n + 1, 0);
+    out_to.clear();
+    out_w.clear();
+    out_mid.clear();
+    in_to.clear();
+    in_w.clear();
+    in_mid.clear();
+    for (int u = 0; u < n; u++) {
+      for (int j = 0; j < (int)up_out[u].size(); j++) {
+        out_to.push_back(up_out[u][j].to);
+        out_w.push_back(up_out[u][j].w);
+        out_mid.push_back(up_out[u][j].mid);
+      }
+      for (int j = 0; j < (int)up_in[u].size(); j++) {
+        in_to.push_back(up_in[u][j].to);
+        in_w.push_back(up_in[u][j].w);
+        in_mid.push_back(up_in[u][j].mid);
+      }
+      out_start[u + 1] = (int)out_to.size();
+      in_start[u + 1] = (int)in_to.size();
+    }
+    out.clear();
+    in.clear();
+    init_workspace();
+  }
+
+  // Returns the distance from s to t, or INF if t is unreachable. The nodes on
+  // a shortest path are stored in path.
+  int query(int s, int t) {
+    for (int k = 0; k < 2; k++) {
+      for (int i = 0; i < (int)touched[k].size(); i++) {
+        dist[k][touched[k][i]] = INF;
+        pred[k][touched[k][i]] = -1;
+      }
+      touched[k].clear();
+    }
+    path.clear();
+    settled = 0;
+    min_heap pq[2];
+    dist[0][s] = dist[1][t] = 0;
+    touched[0].push_back(s);
+    touched[1].push_back(t);
+    pq[0].push(std::make_pair(0, s));
+    pq[1].push(std::make_pair(0, t));
+    int best = INF, meet = -1;
+    while (!pq[0].empty() || !pq[1].empty()) {
+      int k = pq[1].empty() ||
+              (!pq[0].empty() && pq[0].top().first <= pq[1].top().first) ? 0 : 1;
+      int d = pq[k].top().first, u = pq[k].top().second;
+      pq[k].pop();
+      if (d >= best) {
+        pq[k] = min_heap();
+        continue;
+      }
+      if (d > dist[k][u]) {
+        continue;
+      }
+      settled++;
+      if (dist[1 - k][u] != INF && d + dist[1 - k][u] < best) {
+        best = d + dist[1 - k][u];
+        meet = u;
+      }
+      const std::vector<int> &start = k ? in_start : out_start;
+      const std::vector<int> &to = k ? in_to : out_to;
+      const std::vector<int> &w = k ? in_w : out_w;
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        int v = to[j], nd = d + w[j];
+        if (nd < dist[k][v]) {
+          if (dist[k][v] == INF) {
+            touched[k].push_back(v);
+          }
+          dist[k][v] = nd;
+          pred[k][v] = u;
+          pq[k].push(std::make_pair(nd, v));
+        }
+      }
+    }
+    if (meet < 0) {
+      return INF;
+    }
+    std::vector<int> up;
+    for (int v = meet; v != -1; v = pred[0][v]) {
+      up.push_back(v);
+    }
+    std::reverse(up.begin(), up.end());
+    for (int v = pred[1][meet]; v != -1; v = pred[1][v]) {
+      up.push_back(v);
+    }
+    path.push_back(s);
+    for (int i = 0; i + 1 < (int)up.size(); i++) {
+      unpack(up[i], up[i + 1], path);
+    }
+    return best;
+  }
+
+  bool save(const char *filename) const {
+    FILE *f = fopen(filename, "wb");
+    if (f == 0) {
+      return false;
+    }
+    int header[4] = {MAGIC, n, (int)out_to.size(), (int)in_to.size()};
+    const std::vector<int> *arrays[] = {&rank, &out_start, &out_to, &out_w,
+                                        &out_mid, &in_start, &in_to, &in_w,
+                                        &in_mid};
+    bool ok = fwrite(header, sizeof(int), 4, f) == 4;
+    for (int i = 0; ok && i < 9; i++) {
+      size_t len = arrays[i]->size();
+      ok = (len == 0 || fwrite(&(*arrays[i])[0], sizeof(int), len, f) == len);
+    }
+    return (fclose(f) == 0) && ok;
+  }
+
+  bool load(const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (f == 0) {
+      return false;
+    }
+    int header[4];
+    bool ok = fread(header, sizeof(int), 4, f) == 4 && header[0] == MAGIC &&
+              header[1] >= 0 && header[2] >= 0 && header[3] >= 0;
+    if (ok) {
+      // The arrays must fill the rest of the file exactly, so a corrupt header
+      // can't make us allocate more than the file holds.
+      long pos = ftell(f);
+      ok = pos >= 0 && fseek(f, 0, SEEK_END) == 0;
+      long end = ok ? ftell(f) : -1;
+      long long ints = 3LL*header[1] + 2 + 3LL*header[2] + 3LL*header[3];
+      ok = ok && end >= pos && fseek(f, pos, SEEK_SET) == 0 &&
+           (long long)(end - pos) == ints*(long long)sizeof(int);
+    }
+    if (ok) {
+      n = header[1];
+      size_t sizes[] = {(size_t)n, (size_t)n + 1, (size_t)header[2],
+                        (size_t)header[2], (size_t)header[2], (size_t)n + 1,
+                        (size_t)header[3], (size_t)header[3], (size_t)header[3]};
+      std::vector<int> *arrays[] = {&rank, &out_start, &out_to, &out_w,
+                                    &out_mid, &in_start, &in_to, &in_w,
+                                    &in_mid};
+      for (int i = 0; ok && i < 9; i++) {
+        arrays[i]->resize(sizes[i]);
+        ok = (sizes[i] == 0 ||
+              fread(&(*arrays[i])[0], sizeof(int), sizes[i], f) == sizes[i]);
+      }
+    }
+    fclose(f);
+    if (ok) {
+      init_workspace();
+    }
+    return ok;
+  }
+};
+
+/*** Example Usage and Output:
+
+Built a hierarchy of 3600 nodes with 34008 upward edges.
+Average nodes settled per query: 152.19
+
+***/
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+
+int dist[MAXN];
+
+void dijkstra(int nodes, int start) {
+  std::fill(dist, dist + nodes, INF);
+  priority_queue<pair<int, int>, vector<pair<int, int> >,
+                 greater<pair<int, int> > > pq;
+  dist[start] = 0;
+  pq.push(make_pair(0, start));
+  while (!pq.empty()) {
+    int d = pq.top().first, u = pq.top().second;
+    pq.pop();
+    if (d > dist[u]) {
+      continue;
+    }
+    for (int j = 0; j < (int)adj[u].size(); j++) {
+      int v = adj[u][j].first;
+      if (dist[v] > d + adj[u][j].second) {
+        dist[v] = d + adj[u][j].second;
+        pq.push(make_pair(dist[v], v));
+      }
+    }
+  }
+}
+
+int path_weight(const vector<int> &path) {
+  int total = 0;
+  for (int i = 0; i + 1 < (int)path.size(); i++) {
+    int best = INF;
+    for (int j = 0; j < (int)adj[path[i]].size(); j++) {
+      if (adj[path[i]][j].first == path[i + 1]) {
+        best = min(best, adj[path[i]][j].second);
+      }
+    }
+    total += best;
+  }
+  return total;
+}
+
+int main() {
+  // A 60 by 60 grid road network, with one-way streets on every tenth row.
+  const int w = 60, n = w*w;
+  for (int i = 0; i < n; i++) {
+    int x = i % w, y = i / w;
+    if (x + 1 < w) {
+      adj[i].push_back(make_pair(i + 1, 1 + rand() % 9));
+      if (y % 10 != 0) {
+        adj[i + 1].push_back(make_pair(i, 1 + rand() % 9));
+      }
+    }
+    if (y + 1 < w) {
+      adj[i].push_back(make_pair(i + w, 1 + rand() % 9));
+      adj[i + w].push_back(make_pair(i, 1 + rand() % 9));
+    }
+  }
+  contraction_hierarchy ch;
+  ch.build(n);
+  cout << "Built a hierarchy of " << ch.nodes() << " nodes with ";
+  cout << ch.upward_edges() << " upward edges." << endl;
+  const char *filename = "ch_example.bin";
+  assert(ch.save(filename));
+  contraction_hierarchy loaded;
+  assert(loaded.load(filename));
+  // A header whose counts don't match the file is rejected.
+  int bad_counts[] = {-1, 1 << 30};
+  for (int i = 0; i < 2; i++) {
+    FILE *f = fopen(filename, "r+b");
+    fseek(f, sizeof(int), SEEK_SET);
+    fwrite(&bad_counts[i], sizeof(int), 1, f);
+    fclose(f);
+    contraction_hierarchy bad;
+    assert(!bad.load(filename));
+  }
+  remove(filename);
+  long long total_settled = 0;
+  const int queries = 200;
+  for (int i = 0; i < queries; i++) {
+    int s = rand() % n, t = rand() % n;
+    dijkstra(n, s);
+    assert(ch.query(s, t) == dist[t]);
+    total_settled += ch.settled;
+    assert(loaded.query(s, t) == dist[t]);
+    assert(loaded.path.front() == s && loaded.path.back() == t);
+    assert(path_weight(loaded.path) == dist[t]);
+  }
+  cout << "Average nodes settled per query: ";
+  cout << (double)total_settled / queries << endl;
+  return 0;
+}
@@ -7,53 +7,97 @@ each pair of nodes. Condensing the strongly connected components of a graph into
 single nodes will result in a directed acyclic graph. kosaraju() applies to a
 global, pre-populated adjacency list adj[] which must only consist of nodes
 numbered with integers between 0 (inclusive) and the total number of nodes
-(exclusive), as passed in the function argument.
+(exclusive), as passed in the function argument. The depth-first search is
+iterative, using an explicit call stack of (node, next edge index) pairs, so the
+depth of the graph is not limited by the call stack.
 
-Time Complexity: O(max(n, m)) on the number of nodes and edges.
-Space Complexity: O(max(n, m)) auxiliary on the number of nodes and edges.
+scc_engine is a dynamically sized alternative for large graphs given in
+compressed sparse row form. run() uses Pearce's space-efficient variant of
+Tarjan's algorithm, which replaces the index, lowlink, and on-stack arrays with
+a single array that ends up holding the component ids. run_forward_backward()
+instead splits the graph by forward and backward reachability from pivots. Its
+subproblems are independent, so they may be processed in any order. Both number
+the components in topological order and build the condensed DAG, along with the
+list of nodes in each component.
+
+Time Complexity:
+- O(max(n, m)) on the number of nodes and edges for tarjan() and run().
+- O(m log n) expected for run_forward_backward(), though O(n*m) in the worst
+  case. Trimming removes most trivial components in linear time.
+
+Space Complexity:
+- O(max(n, m)) auxiliary on the number of nodes and edges for tarjan().
+- O(n) auxiliary for run(), excluding the O(n + m) condensation it outputs.
+- O(n + m) auxiliary for run_forward_backward(), which builds the reverse graph.
 
 */
 
 #include <algorithm>  // std::fill()
+#include <utility>  // std::make_pair(), std::pair
 #include <vector>
 
 const int MAXN = 100, INF = 0x3f3f3f3f;
 std::vector<int> adj[MAXN], stack;
+std::vector<std::pair<int, int> > calls;
 int timer, lowlink[MAXN];
-std::vector<bool> vis(MAXN);
+std::vector<char> vis(MAXN), is_component_root(MAXN);
 std::vector<std::vector<int> > scc;
 
-void dfs(int u) {
+void enter(int u) {
   lowlink[u] = timer++;
   vis[u] = true;
+  is_component_root[u] = true;
   stack.push_back(u);
-  bool is_component_root = true;
-  int v;
-  for (int j = 0; j < (int)adj[u].size(); j++) {
-    v = adj[u][j];
-    if (!vis[v])
-      dfs(v);
-    if (lowlink[u] > lowlink[v]) {
-      lowlink[u] = lowlink[v];
-      is_component_root = false;
+  calls.push_back(std::make_pair(u, 0));
+}
+
+void dfs(int start) {
+  enter(start);
+  while (!calls.empty()) {
+    int u = calls.back().first, j = calls.back().second;
+    if (j < (int)adj[u].size()) {
+      int v = adj[u][j];
+      if (!vis[v]) {
+        enter(v);
+        continue;
+      }
+      if (lowlink[u] > lowlink[v]) {
+        lowlink[u] = lowlink[v];
+        is_component_root[u] = false;
+      }
+      calls.back().second++;
+      continue;
+    }
+    calls.pop_back();
+    if (is_component_root[u]) {
+      std::vector<int> component;
+      int v;
+      do {
+        v = stack.back();
+        stack.pop_back();
+        lowlink[v] = INF;
+        component.push_back(v);
+      } while (u != v);
+      scc.push_back(component);
+    }
+    // Resume the parent at the edge which led to u, as the recursive version
+    // would upon returning from u.
+    if (!calls.empty()) {
+      int p = calls.back().first;
+      if (lowlink[p] > lowlink[u]) {
+        lowlink[p] = lowlink[u];
+        is_component_root[p] = false;
+      }
+      calls.back().second++;
     }
   }
-  if (!is_component_root)
-    return;
-  std::vector<int> component;
-  do {
-    v = stack.back();
-    vis[v] = true;
-    stack.pop_back();
-    lowlink[v] = INF;
-    component.push_back(v);
-  } while (u != v);
-  scc.push_back(component);
 }
 
 void tarjan(int nodes) {
   scc.clear();
   stack.clear();
+  calls.clear();
+  calls.reserve(nodes);
   std::fill(lowlink, lowlink + nodes, 0);
   std::fill(vis.begin(), vis.end(), false);
   timer = 0;
@@ -63,15 +107,330 @@ void tarjan(int nodes) {
   }
 }
 
+class scc_engine {
+  struct frame {
+    int u, j;
+    bool root;
+
+    frame(int u, int j) : u(u), j(j), root(true) {}
+  };
+
+  int n;
+  const int *start, *edges;
+  std::vector<int> in_start, in_edges;
+
+  void build_reverse() {
+    in_start.assign(n + 1, 0);
+    for (int j = 0; j < start[n]; j++) {
+      in_start[edges[j] + 1]++;
+    }
+    for (int u = 0; u < n; u++) {
+      in_start[u + 1] += in_start[u];
+    }
+    in_edges.resize(start[n]);
+    std::vector<int> pos(in_start.begin(), in_start.end() - 1);
+    for (int u = 0; u < n; u++) {
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        in_edges[pos[edges[j]]++] = u;
+      }
+    }
+  }
+
+  // Builds the deduplicated condensation and the member lists from comp[].
+  void build_condensation() {
+    std::vector<int> last(components, -1);
+    member_start.assign(components + 1, 0);
+    for (int u = 0; u < n; u++) {
+      member_start[comp[u] + 1]++;
+    }
+    for (int c = 0; c < components; c++) {
+      member_start[c + 1] += member_start[c];
+    }
+    member_nodes.resize(n);
+    std::vector<int> pos(member_start.begin(), member_start.end() - 1);
+    for (int u = 0; u < n; u++) {
+      member_nodes[pos[comp[u]]++] = u;
+    }
+    dag_start.assign(components + 1, 0);
+    dag_edges.clear();
+    for (int c = 0; c < components; c++) {
+      last[c] = c;
+      for (int i = member_start[c]; i < member_start[c + 1]; i++) {
+        int u = member_nodes[i];
+        for (int j = start[u]; j < start[u + 1]; j++) {
+          int d = comp[edges[j]];
+          if (last[d] != c) {
+            last[d] = c;
+            dag_edges.push_back(d);
+          }
+        }
+      }
+      dag_start[c + 1] = (int)dag_edges.size();
+    }
+  }
+
+  // Visits the nodes reachable from s inside color cv, or-ing bit into mark[].
+  void sweep(int s, int cv, char bit, const int *st, const int *ed,
+             std::vector<int> &queue) {
+    queue.clear();
+    queue.push_back(s);
+    mark[s] |= bit;
+    for (int i = 0; i < (int)queue.size(); i++) {
+      int u = queue[i];
+      for (int j = st[u]; j < st[u + 1]; j++) {
+        int v = ed[j];
+        if (color[v] == cv && !(mark[v] & bit)) {
+          mark[v] |= bit;
+          queue.push_back(v);
+        }
+      }
+    }
+  }
+
+  // Repeatedly removes the nodes of order[lo, hi) without an in-range in- or
+  // out-neighbor, each of which is a component by itself. Returns the new hi.
+  int trim(int lo, int hi, int cv, std::vector<int> &queue) {
+    queue.clear();
+    for (int i = lo; i < hi; i++) {
+      int u = order[i];
+      out_deg[u] = in_deg[u] = 0;
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        out_deg[u] += (edges[j] != u && color[edges[j]] == cv);
+      }
+      for (int j = in_start[u]; j < in_start[u + 1]; j++) {
+        in_deg[u] += (in_edges[j] != u && color[in_edges[j]] == cv);
+      }
+    }
+    for (int i = lo; i < hi; i++) {
+      int u = order[i];
+      if (out_deg[u] == 0 || in_deg[u] == 0) {
+        color[u] = -1;
+        queue.push_back(u);
+      }
+    }
+    for (int i = 0; i < (int)queue.size(); i++) {
+      int u = queue[i];
+      comp[u] = components++;
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        int v = edges[j];
+        if (color[v] == cv && --in_deg[v] == 0) {
+          color[v] = -1;
+          queue.push_back(v);
+        }
+      }
+      for (int j = in_start[u]; j < in_start[u + 1]; j++) {
+        int v = in_edges[j];
+        if (color[v] == cv && --out_deg[v] == 0) {
+          color[v] = -1;
+          queue.push_back(v);
+        }
+      }
+    }
+    int k = lo;
+    for (int i = lo; i < hi; i++) {
+      if (color[order[i]] == cv) {
+        order[k++] = order[i];
+      }
+    }
+    return k;
+  }
+
+  std::vector<int> order, color, out_deg, in_deg;
+  std::vector<char> mark;
+
+ public:
+  // comp[u] is the component of node u. Components are numbered in topological
+  // order, so every edge of the condensation goes from a lower to a higher id.
+  std::vector<int> comp;
+  int components;
+
+  // The condensation in compressed sparse row form: the components reachable
+  // by one edge from c are dag_edges[dag_start[c], dag_start[c + 1]), and the
+  // nodes of c are member_nodes[member_start[c], member_start[c + 1]).
+  std::vector<int> dag_start, dag_edges, member_start, member_nodes;
+
+  // The out-edges of node u are edges[start[u], start[u + 1]). The arrays are
+  // not copied and must outlive the engine.
+  scc_engine(int nodes, const int *start, const int *edges)
+      : n(nodes), start(start), edges(edges), components(0) {}
+
+  // Pearce's variant of Tarjan's algorithm. A single array rindex[] (stored in
+  // comp[]) doubles as the DFS index and, once assigned, the component id.
+  // Ids are handed out from n - 1 downward, so they always compare greater
+  // than the index of any node still on the stack and need no separate flag.
+  int run() {
+    std::vector<int> &rindex = comp;
+    rindex.assign(n, 0);
+    std::vector<int> stack;
+    std::vector<frame> calls;
+    int index = 1, c = n - 1;
+    for (int s = 0; s < n; s++) {
+      if (rindex[s] != 0) {
+        continue;
+      }
+      rindex[s] = index++;
+      calls.push_back(frame(s, start[s]));
+      while (!calls.empty()) {
+        int u = calls.back().u;
+        if (calls.back().j < start[u + 1]) {
+          int v = edges[calls.back().j];
+          if (rindex[v] == 0) {
+            rindex[v] = index++;
+            calls.push_back(frame(v, start[v]));
+            continue;
+          }
+          if (rindex[v] < rindex[u]) {
+            rindex[u] = rindex[v];
+            calls.back().root = false;
+          }
+          calls.back().j++;
+          continue;
+        }
+        bool root = calls.back().root;
+        calls.pop_back();
+        if (root) {
+          index--;
+          while (!stack.empty() && rindex[u] <= rindex[stack.back()]) {
+            rindex[stack.back()] = c;
+            stack.pop_back();
+            index--;
+          }
+          rindex[u] = c--;
+        } else {
+          stack.push_back(u);
+        }
+        if (!calls.empty()) {
+          frame &p = calls.back();
+          if (rindex[u] < rindex[p.u]) {
+            rindex[p.u] = rindex[u];
+            p.root = false;
+          }
+          p.j++;
+        }
+      }
+    }
+    // The first component completed is a sink and received id n - 1.
+    components = n - 1 - c;
+    for (int u = 0; u < n; u++) {
+      comp[u] -= c + 1;
+    }
+    build_condensation();
+    return components;
+  }
+
+  // Forward-backward decomposition with trimming. Each pass over a color class
+  // removes trivial components, then takes a pivot whose forward and backward
+  // closures intersect in its component. The remaining forward-only,
+  // backward-only, and unreached nodes become three new color classes which
+  // share no component and are processed independently. This needs no deep
+  // DFS and each class touches only its own nodes and edges, which makes it
+  // the usual choice for distributing very large graphs.
+  int run_forward_backward() {
+    if (in_start.empty()) {
+      build_reverse();
+    }
+    order.resize(n);
+    color.assign(n, 0);
+    comp.assign(n, -1);
+    out_deg.resize(n);
+    in_deg.resize(n);
+    mark.assign(n, 0);
+    components = 0;
+    for (int u = 0; u < n; u++) {
+      order[u] = u;
+    }
+    std::vector<int> queue, buf;
+    queue.reserve(n);
+    std::vector<std::pair<int, int> > ranges;
+    ranges.push_back(std::make_pair(0, n));
+    int colors = 1;
+    while (!ranges.empty()) {
+      int lo = ranges.back().first, hi = ranges.back().second;
+      ranges.pop_back();
+      int cv = color[order[lo]];
+      hi = trim(lo, hi, cv, queue);
+      if (lo == hi) {
+        continue;
+      }
+      sweep(order[lo], cv, 1, start, edges, queue);
+      sweep(order[lo], cv, 2, &in_start[0], &in_edges[0], queue);
+      // Partition the class by mark: 3 is the pivot's component, 1 forward
+      // only, 2 backward only, and 0 unreached.
+      buf.assign(order.begin() + lo, order.begin() + hi);
+      static const char groups[] = {3, 1, 2, 0};
+      int bound[5] = {lo};
+      for (int g = 0, k = lo; g < 4; g++) {
+        for (int i = 0; i < (int)buf.size(); i++) {
+          if (mark[buf[i]] == groups[g]) {
+            order[k++] = buf[i];
+          }
+        }
+        bound[g + 1] = k;
+      }
+      for (int g = 0; g < 4; g++) {
+        int first = bound[g], k = bound[g + 1];
+        for (int i = first; i < k; i++) {
+          int u = order[i];
+          mark[u] = 0;
+          if (g == 0) {
+            comp[u] = components;
+            color[u] = -1;
+          } else {
+            color[u] = colors;
+          }
+        }
+        if (g == 0) {
+          components++;
+        } else if (first < k) {
+          ranges.push_back(std::make_pair(first, k));
+          colors++;
+        }
+      }
+    }
+    // Renumber the components topologically with Kahn's algorithm.
+    build_condensation();
+    std::vector<int> indeg(components, 0), id(components);
+    for (int j = 0; j < (int)dag_edges.size(); j++) {
+      indeg[dag_edges[j]]++;
+    }
+    queue.clear();
+    for (int c = 0; c < components; c++) {
+      if (indeg[c] == 0) {
+        queue.push_back(c);
+      }
+    }
+    for (int i = 0; i < (int)queue.size(); i++) {
+      int c = queue[i];
+      id[c] = i;
+      for (int j = dag_start[c]; j < dag_start[c + 1]; j++) {
+        if (--indeg[dag_edges[j]] == 0) {
+          queue.push_back(dag_edges[j]);
+        }
+      }
+    }
+    for (int u = 0; u < n; u++) {
+      comp[u] = id[comp[u]];
+    }
+    build_condensation();
+    return components;
+  }
+};
+
 /*** Example Usage and Output:
 
 Components:
 5 6
 7 3 2
 4 1 0
+Condensation:
+0: 0 1 4 -> 1 2
+1: 2 3 7 -> 2
+2: 5 6 ->
 
 ***/
 
+#include <cassert>
+#include <cstdlib>  // std::rand()
 #include <iostream>
 using namespace std;
 
@@ -97,5 +456,62 @@ int main() {
       cout << scc[i][j] << " ";
     cout << endl;
   }
+
+  // Convert to compressed sparse row form.
+  std::vector<int> start(1, 0), edges;
+  for (int i = 0; i < 8; i++) {
+    edges.insert(edges.end(), adj[i].begin(), adj[i].end());
+    start.push_back((int)edges.size());
+  }
+  scc_engine e(8, &start[0], &edges[0]);
+  assert(e.run() == 3);
+  cout << "Condensation:" << endl;
+  for (int c = 0; c < e.components; c++) {
+    cout << c << ":";
+    for (int i = e.member_start[c]; i < e.member_start[c + 1]; i++) {
+      cout << " " << e.member_nodes[i];
+    }
+    cout << " ->";
+    for (int j = e.dag_start[c]; j < e.dag_start[c + 1]; j++) {
+      cout << " " << e.dag_edges[j];
+    }
+    cout << endl;
+  }
+  std::vector<int> comp(e.comp);
+  assert(e.run_forward_backward() == 3 && e.comp == comp);
+
+  // Both engines agree with tarjan() on a random sparse graph.
+  int n = MAXN;
+  start.assign(1, 0);
+  edges.clear();
+  for (int i = 0; i < n; i++) {
+    adj[i].clear();
+    for (int j = 0; j < 2; j++) {
+      adj[i].push_back(rand() % n);
+    }
+    edges.insert(edges.end(), adj[i].begin(), adj[i].end());
+    start.push_back((int)edges.size());
+  }
+  tarjan(n);
+  scc_engine r(n, &start[0], &edges[0]);
+  assert(r.run() == (int)scc.size());
+  for (int i = 0; i < (int)scc.size(); i++) {
+    for (int j = 0; j < (int)scc[i].size(); j++) {
+      assert(r.comp[scc[i][j]] == r.comp[scc[i][0]]);
+    }
+  }
+  for (int u = 0; u < n; u++) {
+    for (int j = start[u]; j < start[u + 1]; j++) {
+      assert(r.comp[u] <= r.comp[edges[j]]);
+    }
+  }
+  comp = r.comp;
+  assert(r.run_forward_backward() == (int)scc.size());
+  for (int u = 0; u < n; u++) {
+    for (int j = start[u]; j < start[u + 1]; j++) {
+      assert(r.comp[u] <= r.comp[edges[j]]);
+      assert((comp[u] == comp[edges[j]]) == (r.comp[u] == r.comp[edges[j]]));
+    }
+  }
   return 0;
 }
@@ -26,8 +26,26 @@ Any connected graph decomposes into a tree of biconnected components called the
 
 See: http://en.wikipedia.org/wiki/Biconnected_component
 
-Time Complexity: O(max(n, m)) on the number of nodes and edges.
-Space Complexity: O(max(n, m)) auxiliary on the number of nodes and edges.
+incremental_bridges maintains the bridges of a graph under edge insertions
+without recomputing. It contracts every 2-edge-connected component (a maximal
+subgraph without bridges) into one node using a disjoint set forest, as in the
+compressed disjoint set forest of section 3.1. The contracted nodes form the
+bridge forest, stored as parent pointers with a second disjoint set forest over
+its trees. An edge between two trees links them, rerooting the smaller tree
+first, and adds one bridge. An edge within a tree closes a cycle, so the path
+between its endpoints is contracted and each of its edges stops being a bridge.
+Edges are identified by the order in which they were added, and is_bridge() can
+be answered for any batch of edge ids at once.
+
+Time Complexity:
+- O(max(n, m)) on the number of nodes and edges for tarjan().
+- O(log n) amortized per call to incremental_bridges::add_edge(), up to the
+  inverse Ackermann factor of the disjoint set forests.
+- O(a(n)) amortized per edge queried by is_bridge().
+
+Space Complexity:
+- O(max(n, m)) auxiliary on the number of nodes and edges for tarjan().
+- O(n + m) for an incremental_bridges, and O(n) auxiliary per add_edge().
 
 */
 
@@ -115,6 +133,140 @@ void get_block_forest(int nodes) {
   }
 }
 
+class incremental_bridges {
+  // par[] holds the bridge forest over the representatives of dsu_2ecc[].
+  // dsu_cc[] joins the trees of the forest, sized by cc_size[] at its roots.
+  std::vector<int> par, dsu_2ecc, dsu_cc, cc_size, last_visit;
+  std::vector<std::pair<int, int> > edge_list;
+  std::vector<int> path_a, path_b;
+  int num_bridges, lca_iteration;
+
+  static int find(std::vector<int> &root, int x) {
+    int r = x;
+    while (root[r] != r) {
+      r = root[r];
+    }
+    while (root[x] != r) {
+      int next = root[x];
+      root[x] = r;
+      x = next;
+    }
+    return r;
+  }
+
+  int find_2ecc(int v) {
+    return (v == -1) ? -1 : find(dsu_2ecc, v);
+  }
+
+  int find_cc(int v) {
+    return find(dsu_cc, find_2ecc(v));
+  }
+
+  // Reverses the parent pointers on the path from v to its root.
+  void make_root(int v) {
+    int root = v, child = -1;
+    while (v != -1) {
+      int p = find_2ecc(par[v]);
+      par[v] = child;
+      dsu_cc[v] = root;
+      child = v;
+      v = p;
+    }
+    cc_size[root] = cc_size[child];
+  }
+
+  // Climbs from a and b in turn until one reaches a node the other visited,
+  // then contracts both paths into that lowest common ancestor.
+  void merge_path(int a, int b) {
+    lca_iteration++;
+    path_a.clear();
+    path_b.clear();
+    int lca = -1;
+    while (lca == -1) {
+      if (a != -1) {
+        a = find_2ecc(a);
+        path_a.push_back(a);
+        if (last_visit[a] == lca_iteration) {
+          lca = a;
+          break;
+        }
+        last_visit[a] = lca_iteration;
+        a = par[a];
+      }
+      if (b != -1) {
+        b = find_2ecc(b);
+        path_b.push_back(b);
+        if (last_visit[b] == lca_iteration) {
+          lca = b;
+          break;
+        }
+        last_visit[b] = lca_iteration;
+        b = par[b];
+      }
+    }
+    for (int i = 0; i < (int)path_a.size() && path_a[i] != lca; i++) {
+      dsu_2ecc[path_a[i]] = lca;
+      num_bridges--;
+    }
+    for (int i = 0; i < (int)path_b.size() && path_b[i] != lca; i++) {
+      dsu_2ecc[path_b[i]] = lca;
+      num_bridges--;
+    }
+  }
+
+ public:
+  incremental_bridges(int nodes)
+      : par(nodes, -1), dsu_2ecc(nodes), dsu_cc(nodes), cc_size(nodes, 1),
+        last_visit(nodes, 0), num_bridges(0), lca_iteration(0) {
+    for (int i = 0; i < nodes; i++) {
+      dsu_2ecc[i] = dsu_cc[i] = i;
+    }
+  }
+
+  int bridges() const {
+    return num_bridges;
+  }
+
+  // Adds the undirected edge (u, v) and returns its id.
+  int add_edge(int u, int v) {
+    edge_list.push_back(std::make_pair(u, v));
+    int a = find_2ecc(u), b = find_2ecc(v);
+    if (a != b) {
+      int ca = find_cc(a), cb = find_cc(b);
+      if (ca != cb) {
+        num_bridges++;
+        if (cc_size[ca] > cc_size[cb]) {
+          std::swap(a, b);
+          std::swap(ca, cb);
+        }
+        make_root(a);
+        par[a] = dsu_cc[a] = b;
+        cc_size[cb] += cc_size[a];
+      } else {
+        merge_path(a, b);
+      }
+    }
+    return (int)edge_list.size() - 1;
+  }
+
+  // An edge is a bridge exactly when its endpoints lie in different
+  // 2-edge-connected components.
+  bool is_bridge(int e) {
+    return find_2ecc(edge_list[e].first) != find_2ecc(edge_list[e].second);
+  }
+
+  void is_bridge(const std::vector<int> &ids, std::vector<char> &res) {
+    res.resize(ids.size());
+    for (int i = 0; i < (int)ids.size(); i++) {
+      res[i] = is_bridge(ids[i]);
+    }
+  }
+
+  bool is_two_edge_connected(int u, int v) {
+    return find_2ecc(u) == find_2ecc(v);
+  }
+};
+
 /*** Example Usage and Output:
 
 Cut-points: 5 1
@@ -136,9 +288,11 @@ Adjacency List for Block Forest:
 3 => 4
 4 => 3
 5 =>
+Incremental Bridges: 4 5 4 2 1 1
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -178,5 +332,30 @@ int main() {
     }
     cout << endl;
   }
+
+  incremental_bridges ib(8);
+  ib.add_edge(0, 1);
+  ib.add_edge(0, 5);
+  ib.add_edge(1, 2);
+  ib.add_edge(1, 5);
+  ib.add_edge(3, 7);
+  ib.add_edge(4, 5);
+  assert(ib.bridges() == (int)bridges.size());
+  std::vector<int> ids;
+  for (int e = 0; e < 6; e++) {
+    ids.push_back(e);
+  }
+  std::vector<char> res;
+  ib.is_bridge(ids, res);
+  assert(!res[0] && !res[1] && res[2] && !res[3] && res[4] && res[5]);
+  int u[] = {2, 7, 6, 3, 6, 0}, v[] = {6, 4, 2, 4, 0, 0};
+  cout << "Incremental Bridges:";
+  for (int i = 0; i < 6; i++) {
+    ib.add_edge(u[i], v[i]);
+    cout << " " << ib.bridges();
+  }
+  cout << endl;
+  assert(ib.is_two_edge_connected(0, 6) && !ib.is_two_edge_connected(0, 7));
+  assert(ib.is_bridge(5) && !ib.is_bridge(2));
   return 0;
 }
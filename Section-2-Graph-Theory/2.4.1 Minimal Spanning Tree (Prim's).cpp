@@ -13,18 +13,36 @@ negating node distances before pushing them and negating them again after
 popping them. To modify this implementation to find the maximum spanning tree,
 the two negation steps can be skipped to prioritize the max edges.
 
-Time Complexity: O(m log n) where m is the number of edges and n is the number
-of nodes.
+prim_engine is a dynamically sized alternative which stores the graph in
+compressed sparse row form and never holds the same node in a queue twice.
+run_sparse() keeps the nodes outside of the tree in an indexed 4-ary heap,
+decreasing their keys as cheaper connections are found. run_dense() instead
+keeps their keys in a compact array and scans it for the minimum after each
+step, which takes O(n) per step but has no heap overhead. run() picks whichever
+is asymptotically better for the density of the graph. run_complete() applies
+the array scan to a complete graph whose edge weights are computed on the fly,
+such as the distances between a set of points, without storing any edges.
 
-Space Complexity: O(n) auxiliary on the number of nodes.
+Time Complexity:
+- O(m log n) for prim(), where m is the number of edges and n is the number
+  of nodes.
+- O(m log n) for run_sparse(), or O(n^2 + m) for run_dense().
+- O(n^2) calls to the weight function for run_complete().
+
+Space Complexity:
+- O(n) auxiliary on the number of nodes for prim().
+- O(n + m) for a prim_engine, and O(n) auxiliary per run.
 
 */
 
+#include <algorithm>  // std::min()
+#include <cmath>  // std::log()
 #include <queue>
 #include <utility>
 #include <vector>
 
 const int MAXN = 100;
+const long long INF = 0x3f3f3f3f3f3f3f3fLL;
 std::vector<std::pair<int, int> > adj[MAXN], mst;
 
 int prim(int nodes) {
@@ -61,6 +79,214 @@ int prim(int nodes) {
   return total_dist;
 }
 
+// The indexed 4-ary heap of section 2.2.2, keyed by long long.
+class dary_heap {
+  static const int D = 4;
+
+  std::vector<int> heap, pos;
+  std::vector<long long> key;
+
+  void sift_up(int i) {
+    int v = heap[i];
+    for (int p; i > 0 && key[heap[p = (i - 1)/D]] > key[v]; i = p) {
+      heap[i] = heap[p];
+      pos[heap[i]] = i;
+    }
+    heap[i] = v;
+    pos[v] = i;
+  }
+
+  void sift_down(int i) {
+    int v = heap[i], n = (int)heap.size();
+    for (;;) {
+      int c = D*i + 1, best = -1;
+      for (int end = std::min(c + D, n); c < end; c++) {
+        if (key[heap[c]] < (best < 0 ? key[v] : key[heap[best]])) {
+          best = c;
+        }
+      }
+      if (best < 0) {
+        break;
+      }
+      heap[i] = heap[best];
+      pos[heap[i]] = i;
+      i = best;
+    }
+    heap[i] = v;
+    pos[v] = i;
+  }
+
+ public:
+  dary_heap(int nodes) : pos(nodes, -1), key(nodes) {
+    heap.reserve(nodes);
+  }
+
+  bool empty() const {
+    return heap.empty();
+  }
+
+  // Inserts v, or decreases its key if it is already in the heap.
+  void push(int v, long long k) {
+    key[v] = k;
+    if (pos[v] < 0) {
+      heap.push_back(v);
+      pos[v] = (int)heap.size() - 1;
+    }
+    sift_up(pos[v]);
+  }
+
+  int pop(long long &k) {
+    int v = heap[0];
+    k = key[v];
+    pos[v] = -1;
+    if (heap.size() > 1) {
+      heap[0] = heap.back();
+      heap.pop_back();
+      sift_down(0);
+    } else {
+      heap.pop_back();
+    }
+    return v;
+  }
+};
+
+class prim_engine {
+  int n;
+  std::vector<int> start, target, weight;
+
+  // The nodes not yet in the tree are kept contiguous in rem[0, r), alongside
+  // their cheapest known connection cost rkey[] and endpoint rpar[], so that
+  // every scan is a branch-free pass over a dense array.
+  std::vector<int> rem, rpar, where;
+  std::vector<long long> rkey;
+
+  void reset() {
+    rem.resize(n);
+    rpar.assign(n, -1);
+    where.resize(n);
+    rkey.assign(n, INF);
+    pred.assign(n, -1);
+    for (int v = 0; v < n; v++) {
+      rem[v] = where[v] = v;
+    }
+  }
+
+  // Moves the cheapest of the r remaining nodes into the tree and returns it,
+  // adding the cost of its connection to total.
+  int extract(int r, long long &total) {
+    long long lo = rkey[0];
+    for (int i = 1; i < r; i++) {
+      lo = std::min(lo, rkey[i]);
+    }
+    int i = 0;
+    while (rkey[i] != lo) {
+      i++;
+    }
+    int u = rem[i];
+    pred[u] = rpar[i];
+    if (pred[u] != -1) {
+      total += lo;
+    }
+    rem[i] = rem[r - 1];
+    rkey[i] = rkey[r - 1];
+    rpar[i] = rpar[r - 1];
+    where[rem[i]] = i;
+    where[u] = -1;
+    return u;
+  }
+
+ public:
+  // pred[v] is the parent of v in the minimum spanning forest, or -1 for roots.
+  std::vector<int> pred;
+
+  // Constructs an engine for run_complete() on the complete graph.
+  prim_engine(int nodes) : n(nodes), start(nodes + 1, 0) {}
+
+  prim_engine(int nodes, const std::vector<std::pair<int, int> > adj[])
+      : n(nodes), start(nodes + 1, 0) {
+    for (int u = 0; u < n; u++) {
+      start[u + 1] = start[u] + (int)adj[u].size();
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        target.push_back(adj[u][j].first);
+        weight.push_back(adj[u][j].second);
+      }
+    }
+  }
+
+  // Uses the array scan once the graph is dense enough that O(n^2) beats the
+  // heap's O(m log n).
+  long long run() {
+    double log_n = std::log(n + 1.0)/std::log(2.0);
+    if ((double)start[n]*log_n >= (double)n*n) {
+      return run_dense();
+    }
+    return run_sparse();
+  }
+
+  long long run_sparse() {
+    dary_heap h(n);
+    std::vector<char> done(n, false);
+    std::vector<long long> key(n, INF);
+    pred.assign(n, -1);
+    long long total = 0, k;
+    for (int s = 0; s < n; s++) {
+      if (done[s]) {
+        continue;
+      }
+      h.push(s, 0);
+      while (!h.empty()) {
+        int u = h.pop(k);
+        done[u] = true;
+        if (pred[u] != -1) {
+          total += k;
+        }
+        for (int j = start[u]; j < start[u + 1]; j++) {
+          int v = target[j];
+          if (!done[v] && weight[j] < key[v]) {
+            key[v] = weight[j];
+            pred[v] = u;
+            h.push(v, key[v]);
+          }
+        }
+      }
+    }
+    return total;
+  }
+
+  long long run_dense() {
+    reset();
+    long long total = 0;
+    for (int r = n; r > 0; r--) {
+      int u = extract(r, total);
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        int i = where[target[j]];
+        if (i >= 0 && weight[j] < rkey[i]) {
+          rkey[i] = weight[j];
+          rpar[i] = u;
+        }
+      }
+    }
+    return total;
+  }
+
+  // Finds the minimum spanning tree of the complete graph on n nodes in which
+  // w(u, v) is the weight of edge (u, v), evaluating each weight on the fly.
+  template<class Weight> long long run_complete(Weight w) {
+    reset();
+    long long total = 0;
+    for (int r = n; r > 0; r--) {
+      int u = extract(r, total);
+      for (int i = 0; i < r - 1; i++) {
+        long long d = w(u, rem[i]);
+        bool better = d < rkey[i];
+        rkey[i] = better ? d : rkey[i];
+        rpar[i] = better ? u : rpar[i];
+      }
+    }
+    return total;
+  }
+};
+
 /*** Example Usage and Output:
 
 Total distance: 13
@@ -69,12 +295,26 @@ Total distance: 13
 3 <-> 4
 4 <-> 5
 5 <-> 6
+Euclidean MST: 17.9392
 
 ***/
 
+#include <cassert>
+#include <cstdlib>  // std::rand()
 #include <iostream>
 using namespace std;
 
+struct squared_distance {
+  const int *x, *y;
+
+  squared_distance(const int *x, const int *y) : x(x), y(y) {}
+
+  long long operator()(int u, int v) const {
+    long long dx = x[u] - x[v], dy = y[u] - y[v];
+    return dx*dx + dy*dy;
+  }
+};
+
 void add_edge(int u, int v, int w) {
   adj[u].push_back(make_pair(v, w));
   adj[v].push_back(make_pair(u, w));
@@ -92,5 +332,36 @@ int main() {
   for (int i = 0; i < (int)mst.size(); i++) {
     cout << mst[i].first << " <-> " << mst[i].second << endl;
   }
+  prim_engine e(7, adj);
+  assert(e.run_sparse() == 13 && e.run_dense() == 13 && e.run() == 13);
+
+  // The minimum spanning tree under squared distances is also the Euclidean
+  // minimum spanning tree, since squaring preserves the order of the weights.
+  int x[] = {0, 4, 4, 0, 2, 9}, y[] = {0, 0, 3, 3, 1, 9};
+  prim_engine points(6);
+  points.run_complete(squared_distance(x, y));
+  double length = 0;
+  for (int v = 0; v < 6; v++) {
+    int u = points.pred[v];
+    if (u != -1) {
+      length += sqrt((double)squared_distance(x, y)(u, v));
+    }
+  }
+  cout << "Euclidean MST: " << length << endl;
+
+  // All paths agree with prim() on a random complete graph.
+  int n = MAXN;
+  for (int i = 0; i < n; i++) {
+    adj[i].clear();
+  }
+  for (int u = 0; u < n; u++) {
+    for (int v = u + 1; v < n; v++) {
+      add_edge(u, v, rand() % 1000);
+    }
+  }
+  long long total = prim(n);
+  prim_engine g(n, adj);
+  assert(g.run_sparse() == total && g.run_dense() == total);
+  assert(g.run() == total);
   return 0;
 }
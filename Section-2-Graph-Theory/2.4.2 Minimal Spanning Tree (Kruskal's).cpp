@@ -8,18 +8,37 @@ of nodes numbered with integers between 0 (inclusive) and the total number of
 nodes (exclusive), as passed in the function argument. If the input graph is not
 connected, then this implementation will find the minimum spanning forest.
 
-Time Complexity: O(m log n) where m is the number of edges and n is the number
-of nodes.
+filter_kruskal() and boruvka() are dynamically sized alternatives for large edge
+lists. Filter-Kruskal partitions the edges around a random pivot weight like
+quicksort. It first solves the lighter half, then discards every heavier edge
+whose endpoints were already joined, before recursing on the rest. On dense
+graphs most edges are discarded without ever being sorted. Small subproblems are
+sorted using the given function object, which may be comparison_sort or the
+integer radix_sort. Boruvka's algorithm instead runs in rounds. Each round scans
+the remaining edges and picks the lightest edge leaving every component, then
+merges along all of them at once. The scans of a round are independent, which
+makes it the usual basis for parallel minimum spanning trees.
 
-Space Complexity: O(n) auxiliary on the number of nodes.
+Time Complexity:
+- O(m log n) for kruskal(), where m is the number of edges and n is the number
+  of nodes.
+- O(m + n log n log(m/n)) expected for filter_kruskal() on random weights, and
+  O(m log m) in the worst case.
+- O(m log n) for boruvka(), since each round at least halves the number of
+  components.
+
+Space Complexity:
+- O(n) auxiliary on the number of nodes for kruskal().
+- O(n + m) auxiliary for filter_kruskal() and boruvka().
 
 */
 
-#include <algorithm>  // std::sort()
+#include <algorithm>  // std::max(), std::partition(), std::remove_if(), ...
+#include <cstdlib>  // std::rand()
 #include <utility>  // std::pair
 #include <vector>
 
-const int MAXN = 100;
+const int MAXN = 100, BASE_CASE = 1024;
 std::vector<std::pair<int, std::pair<int, int> > > edges;
 int root[MAXN];
 std::vector<std::pair<int, int> > mst;
@@ -50,6 +69,195 @@ int kruskal(int nodes) {
   return total_dist;
 }
 
+struct weighted_edge {
+  int u, v, w;
+
+  weighted_edge(int u = 0, int v = 0, int w = 0) : u(u), v(v), w(w) {}
+};
+
+class disjoint_sets {
+  std::vector<int> root;
+
+ public:
+  disjoint_sets(int n) : root(n) {
+    for (int i = 0; i < n; i++) {
+      root[i] = i;
+    }
+  }
+
+  int find(int x) {
+    while (root[x] != x) {
+      root[x] = root[root[x]];  // Path halving.
+      x = root[x];
+    }
+    return x;
+  }
+
+  bool unite(int x, int y) {
+    x = find(x);
+    y = find(y);
+    if (x == y) {
+      return false;
+    }
+    root[x] = y;
+    return true;
+  }
+};
+
+struct comparison_sort {
+  static bool by_weight(const weighted_edge &a, const weighted_edge &b) {
+    return a.w < b.w;
+  }
+
+  template<class It> void operator()(It lo, It hi) const {
+    std::sort(lo, hi, by_weight);
+  }
+};
+
+// A copy of the keyed radix sort of section 1.1, specialized to sort edges by
+// their weights in two 16-bit passes, skipping any pass with equal digits.
+struct radix_sort {
+  template<class It> void operator()(It lo, It hi) const {
+    int n = hi - lo;
+    std::vector<weighted_edge> v(lo, hi), vbuf(n);
+    unsigned int diff = 0;
+    for (int i = 0; i < n; i++) {
+      diff |= (unsigned int)v[i].w ^ (unsigned int)v[0].w;
+    }
+    std::vector<int> count(1 << 16);
+    for (int pos = 0; pos < 32; pos += 16) {
+      if (((diff >> pos) & 0xFFFF) == 0) {
+        continue;
+      }
+      std::fill(count.begin(), count.end(), 0);
+      for (int i = 0; i < n; i++) {
+        count[digit(v[i].w, pos)]++;
+      }
+      for (int i = 0, sum = 0, tmp; i < (1 << 16); i++) {
+        tmp = count[i];
+        count[i] = sum;
+        sum += tmp;
+      }
+      for (int i = 0; i < n; i++) {
+        vbuf[count[digit(v[i].w, pos)]++] = v[i];
+      }
+      v.swap(vbuf);
+    }
+    std::copy(v.begin(), v.end(), lo);
+  }
+
+  static int digit(int w, int pos) {
+    return (((unsigned int)w ^ 0x80000000u) >> pos) & 0xFFFF;
+  }
+};
+
+struct weight_at_most {
+  int pivot;
+
+  weight_at_most(int pivot) : pivot(pivot) {}
+
+  bool operator()(const weighted_edge &e) const {
+    return e.w <= pivot;
+  }
+};
+
+struct is_internal {
+  disjoint_sets *dsu;
+
+  is_internal(disjoint_sets *dsu) : dsu(dsu) {}
+
+  bool operator()(const weighted_edge &e) const {
+    return dsu->find(e.u) == dsu->find(e.v);
+  }
+};
+
+template<class Sorter>
+long long filter_kruskal(std::vector<weighted_edge>::iterator lo,
+                         std::vector<weighted_edge>::iterator hi,
+                         int threshold, disjoint_sets &dsu,
+                         std::vector<weighted_edge> &res, Sorter sort) {
+  if (hi - lo > threshold) {
+    int pivot = (lo + rand() % (hi - lo))->w;
+    std::vector<weighted_edge>::iterator mid =
+        std::partition(lo, hi, weight_at_most(pivot));
+    if (mid != hi) {
+      long long total = filter_kruskal(lo, mid, threshold, dsu, res, sort);
+      hi = std::remove_if(mid, hi, is_internal(&dsu));
+      return total + filter_kruskal(mid, hi, threshold, dsu, res, sort);
+    }
+  }
+  sort(lo, hi);
+  long long total = 0;
+  for (; lo != hi; ++lo) {
+    if (dsu.unite(lo->u, lo->v)) {
+      res.push_back(*lo);
+      total += lo->w;
+    }
+  }
+  return total;
+}
+
+template<class Sorter>
+long long filter_kruskal(int nodes, std::vector<weighted_edge> &e,
+                         std::vector<weighted_edge> &res, Sorter sort) {
+  res.clear();
+  disjoint_sets dsu(nodes);
+  return filter_kruskal(e.begin(), e.end(), std::max(nodes, BASE_CASE), dsu,
+                        res, sort);
+}
+
+long long filter_kruskal(int nodes, std::vector<weighted_edge> &e,
+                         std::vector<weighted_edge> &res) {
+  return filter_kruskal(nodes, e, res, comparison_sort());
+}
+
+// Whether edge i is lighter than edge j, breaking ties by index so that all
+// components agree on a single minimum spanning forest.
+bool lighter(const std::vector<weighted_edge> &e, int i, int j) {
+  return j == -1 || e[i].w < e[j].w || (e[i].w == e[j].w && i < j);
+}
+
+long long boruvka(int nodes, const std::vector<weighted_edge> &e,
+                  std::vector<weighted_edge> &res) {
+  res.clear();
+  disjoint_sets dsu(nodes);
+  std::vector<int> live(e.size()), best(nodes, -1);
+  for (int i = 0; i < (int)e.size(); i++) {
+    live[i] = i;
+  }
+  long long total = 0;
+  for (bool merged = true; merged; ) {
+    merged = false;
+    int k = 0;
+    for (int i = 0; i < (int)live.size(); i++) {
+      int j = live[i], a = dsu.find(e[j].u), b = dsu.find(e[j].v);
+      if (a == b) {
+        continue;
+      }
+      live[k++] = j;
+      if (lighter(e, j, best[a])) {
+        best[a] = j;
+      }
+      if (lighter(e, j, best[b])) {
+        best[b] = j;
+      }
+    }
+    live.resize(k);
+    for (int u = 0; u < nodes; u++) {
+      int j = best[u];
+      if (j != -1) {
+        best[u] = -1;
+        if (dsu.unite(e[j].u, e[j].v)) {
+          res.push_back(e[j]);
+          total += e[j].w;
+          merged = true;
+        }
+      }
+    }
+  }
+  return total;
+}
+
 /*** Example Usage and Output:
 
 Total distance: 13
@@ -61,6 +269,7 @@ Total distance: 13
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -80,5 +289,21 @@ int main() {
   for (int i = 0; i < (int)mst.size(); i++) {
     cout << mst[i].first << " <-> " << mst[i].second << endl;
   }
+
+  // All three agree on a random dense graph.
+  int n = MAXN;
+  std::vector<weighted_edge> e, res;
+  edges.clear();
+  for (int u = 0; u < n; u++) {
+    for (int v = u + 1; v < n; v++) {
+      int w = rand() % 1000 - 500;
+      e.push_back(weighted_edge(u, v, w));
+      add_edge(u, v, w);
+    }
+  }
+  long long total = kruskal(n);
+  assert(filter_kruskal(n, e, res) == total && (int)res.size() == n - 1);
+  assert(filter_kruskal(n, e, res, radix_sort()) == total);
+  assert(boruvka(n, e, res) == total && (int)res.size() == n - 1);
   return 0;
 }
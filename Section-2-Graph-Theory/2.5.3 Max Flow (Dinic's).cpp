@@ -10,14 +10,35 @@ Dinic's algorithm will also support real-valued flow capacities. As such, this
 implementation will work as intended upon changing the appropriate variables to
 doubles.
 
-Time Complexity: O(n^2 * m) where n is the number of nodes and m is the number
-of edges.
+dinic_flow is a dynamically sized alternative which stores all edges in a flat
+array, with each edge e followed by its reverse edge e ^ 1. It optionally
+applies capacity scaling, first augmenting only along edges with a residual
+capacity of at least the largest power of two not exceeding the greatest
+capacity, then halving this threshold down to 1. This improves the worst case,
+but spends at least one breadth-first search per threshold, so it mostly pays
+off for capacities spanning many orders of magnitude. Blocking flows are found
+by an iterative depth-first search which keeps the current path on an explicit
+stack. The flow is kept between calls to max_flow(), so that after a call to
+set_capacity(), the next call only augments the difference instead of solving
+from scratch. Lowering a capacity below the flow on an edge first reroutes the
+surplus around it, then cancels whatever remains along paths back to the
+source and from the sink.
 
-Space Complexity: O(n) auxiliary on the number of nodes.
+Time Complexity:
+- O(n^2 * m) for dinic(), where n is the number of nodes and m is the number of
+  edges.
+- O(n^2 * m) for dinic_flow::max_flow(), or O(n*m log U) with scaling, where U
+  is the largest capacity.
+- O(n^2 * m) per call to set_capacity() which lowers a capacity below the flow
+  on its edge, and O(1) otherwise.
+
+Space Complexity:
+- O(n) auxiliary on the number of nodes for dinic().
+- O(n + m) for a dinic_flow.
 
 */
 
-#include <algorithm>  // std::fill(), std::min()
+#include <algorithm>  // std::fill(), std::max(), std::min()
 #include <queue>
 #include <vector>
 
@@ -81,6 +102,176 @@ int dinic(int nodes, int source, int sink) {
   return max_flow;
 }
 
+class dinic_flow {
+  static const long long INF = 0x3f3f3f3f3f3f3f3fLL;
+
+  // Edge e and its reverse e ^ 1 are stored next to each other, so that arcs[e].cap
+  // is the residual capacity of e and orig[e] its capacity. The out-edges of u
+  // form the linked list head[u], arcs[head[u]].next, ...
+  struct arc {
+    int to, next;
+    long long cap;
+
+    arc(int to, int next, long long cap) : to(to), next(next), cap(cap) {}
+  };
+
+  std::vector<int> head;
+  std::vector<arc> arcs;
+  std::vector<long long> orig;
+  std::vector<int> level, ptr, path, queue;
+  int source, sink;
+
+  bool bfs(int a, int b, long long delta) {
+    std::fill(level.begin(), level.end(), -1);
+    level[a] = 0;
+    queue.assign(1, a);
+    for (int i = 0; i < (int)queue.size() && level[b] < 0; i++) {
+      int u = queue[i];
+      for (int e = head[u]; e != -1; e = arcs[e].next) {
+        if (arcs[e].cap >= delta && level[arcs[e].to] < 0) {
+          level[arcs[e].to] = level[u] + 1;
+          queue.push_back(arcs[e].to);
+        }
+      }
+    }
+    return level[b] >= 0;
+  }
+
+  // Finds a blocking flow of at most limit along the level graph using an
+  // explicit stack of path edges. After each augmentation, the search resumes
+  // from the tail of the first edge it saturated.
+  long long blocking_flow(int a, int b, long long limit, long long delta) {
+    long long total = 0;
+    path.clear();
+    int u = a;
+    while (total < limit) {
+      if (u == b) {
+        long long f = limit - total;
+        for (int i = 0; i < (int)path.size(); i++) {
+          f = std::min(f, arcs[path[i]].cap);
+        }
+        for (int i = 0; i < (int)path.size(); i++) {
+          arcs[path[i]].cap -= f;
+          arcs[path[i] ^ 1].cap += f;
+        }
+        total += f;
+        for (int i = 0; i < (int)path.size(); i++) {
+          if (arcs[path[i]].cap < delta) {
+            path.resize(i);
+            break;
+          }
+        }
+        u = path.empty() ? a : arcs[path.back()].to;
+        continue;
+      }
+      int &e = ptr[u];
+      while (e != -1 && (arcs[e].cap < delta || level[arcs[e].to] != level[u] + 1)) {
+        e = arcs[e].next;
+      }
+      if (e != -1) {
+        path.push_back(e);
+        u = arcs[e].to;
+        continue;
+      }
+      level[u] = -1;
+      if (path.empty()) {
+        break;
+      }
+      u = arcs[path.back() ^ 1].to;
+      path.pop_back();
+      ptr[u] = arcs[ptr[u]].next;
+    }
+    return total;
+  }
+
+  // Pushes up to limit units of flow from a to b through the current residual
+  // graph. With scaling, only edges of residual capacity at least delta are
+  // used until no such path remains, and delta is then halved.
+  long long augment(int a, int b, long long limit, bool scaling) {
+    long long delta = 1, total = 0;
+    if (scaling) {
+      long long max_cap = 0;
+      for (int e = 0; e < (int)arcs.size(); e++) {
+        max_cap = std::max(max_cap, arcs[e].cap);
+      }
+      while (delta <= max_cap/2) {
+        delta *= 2;
+      }
+    }
+    for (; delta >= 1 && total < limit; delta /= 2) {
+      while (total < limit && bfs(a, b, delta)) {
+        ptr = head;
+        total += blocking_flow(a, b, limit - total, delta);
+      }
+    }
+    return total;
+  }
+
+ public:
+  dinic_flow(int nodes)
+      : head(nodes, -1), level(nodes), source(-1), sink(-1) {}
+
+  // Adds an edge u -> v with capacity c, returning its id.
+  int add_edge(int u, int v, long long c) {
+    int e = (int)arcs.size();
+    arcs.push_back(arc(v, head[u], c));
+    head[u] = e;
+    arcs.push_back(arc(u, head[v], 0));
+    head[v] = e + 1;
+    orig.push_back(c);
+    orig.push_back(0);
+    return e;
+  }
+
+  long long flow(int e) const {
+    return orig[e] - arcs[e].cap;
+  }
+
+  // Returns the maximum flow from s to t. The flow found by the previous call
+  // is kept, so that after small changes only the difference is augmented.
+  // Scaling is only applied when solving from scratch.
+  long long max_flow(int s, int t, bool scaling = false) {
+    bool cold = (s != source || t != sink);
+    if (cold) {
+      for (int e = 0; e < (int)arcs.size(); e++) {
+        arcs[e].cap = orig[e];
+      }
+      source = s;
+      sink = t;
+    }
+    augment(s, t, INF, cold && scaling);
+    long long total = 0;
+    for (int e = head[s]; e != -1; e = arcs[e].next) {
+      total += (e % 2 == 0) ? flow(e) : -flow(e ^ 1);
+    }
+    return total;
+  }
+
+  // Changes the capacity of edge e, keeping as much of the current flow as
+  // stays feasible. If e now carries too much, the surplus at its tail is
+  // rerouted to its head, and whatever cannot be rerouted is returned to the
+  // source and withdrawn from the sink.
+  void set_capacity(int e, long long c) {
+    long long f = flow(e);
+    orig[e] = c;
+    if (f <= c) {
+      arcs[e].cap = c - f;
+      return;
+    }
+    arcs[e].cap = 0;
+    arcs[e ^ 1].cap = c;
+    int u = arcs[e ^ 1].to, v = arcs[e].to;
+    long long surplus = f - c;
+    surplus -= augment(u, v, surplus, false);
+    if (surplus > 0 && u != source) {
+      augment(u, source, surplus, false);
+    }
+    if (surplus > 0 && v != sink) {
+      augment(sink, v, surplus, false);
+    }
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -95,5 +286,24 @@ int main() {
   add_edge(3, 5, 2);
   add_edge(4, 5, 3);
   assert(dinic(6, 0, 5) == 5);
+
+  dinic_flow df(6);
+  df.add_edge(0, 1, 3);
+  df.add_edge(0, 2, 3);
+  df.add_edge(1, 2, 2);
+  int e13 = df.add_edge(1, 3, 3);
+  df.add_edge(2, 4, 2);
+  int e34 = df.add_edge(3, 4, 1);
+  int e35 = df.add_edge(3, 5, 2);
+  df.add_edge(4, 5, 3);
+  assert(df.max_flow(0, 5) == 5 && df.max_flow(5, 0) == 0);
+  assert(df.max_flow(0, 5, true) == 5);
+  df.set_capacity(e35, 4);
+  df.set_capacity(e34, 0);
+  assert(df.max_flow(0, 5) == 5);
+  df.set_capacity(e13, 1);
+  assert(df.max_flow(0, 5) == 3 && df.flow(e13) == 1);
+  df.set_capacity(e13, 3);
+  assert(df.max_flow(0, 5) == 5 && df.flow(e34) == 0);
   return 0;
 }
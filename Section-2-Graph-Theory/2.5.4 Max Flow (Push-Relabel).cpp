@@ -9,12 +9,28 @@ efficient maximum flow algorithms, it cannot take advantage of the maximum flow
 being less than n^3 (in which case the Ford-Fulkerson or Edmonds-Karp algorithms
 may be more efficient).
 
-Time Complexity: O(n^3) on the number of nodes.
-Space Complexity: O(n^2) auxiliary on the number of nodes.
+hlpp_flow is a dynamically sized alternative for large sparse networks. It
+stores the residual graph in compressed sparse row form and always discharges
+an active node of the greatest height, taken from per-height stacks. Two
+heuristics keep heights accurate. Whenever a relabel empties a height, every
+node above the gap can no longer reach the sink and is lifted out of the way at
+once. After every n relabels, a global relabel recomputes all heights as exact
+residual distances to the sink by a reverse breadth-first search. Only the
+first phase of the algorithm is run, which finds the value of the maximum flow
+and a minimum cut, but may leave excess trapped at nodes cut off from the sink.
+
+Time Complexity:
+- O(n^3) on the number of nodes for push_relabel().
+- O(n^2 sqrt(m)) for hlpp_flow::max_flow(), where m is the number of edges, and
+  usually far less in practice.
+
+Space Complexity:
+- O(n^2) auxiliary on the number of nodes for push_relabel().
+- O(n + m) for an hlpp_flow.
 
 */
 
-#include <algorithm>  // std::fill(), std::min()
+#include <algorithm>  // std::fill(), std::max(), std::min()
 #include <vector>
 
 const int MAXN = 100, INF = 0x3F3F3F3F;
@@ -79,6 +95,219 @@ int push_relabel(int nodes, int source, int sink) {
   return max_flow;
 }
 
+class hlpp_flow {
+  int n, source, sink, relabels;
+  bool cut_ready; // whether heights are exact since max_flow() finished
+  std::vector<int> eu, ev;
+  std::vector<long long> ecap;
+
+  // The residual graph in compressed sparse row form. The arc paired with arc
+  // j in the opposite direction is rev[j].
+  std::vector<int> start, to, rev, cur;
+  std::vector<long long> cap, excess;
+  std::vector<int> height;
+
+  // Active nodes are kept in a stack for each height. All nodes below height
+  // n are also kept in a doubly linked list for each height to detect gaps.
+  std::vector<int> active_head, active_next, list_head, list_next, list_prev;
+  int max_active, max_height;
+
+  void build() {
+    start.assign(n + 1, 0);
+    for (int i = 0; i < (int)eu.size(); i++) {
+      start[eu[i] + 1]++;
+      start[ev[i] + 1]++;
+    }
+    for (int u = 0; u < n; u++) {
+      start[u + 1] += start[u];
+    }
+    to.resize(start[n]);
+    rev.resize(start[n]);
+    cap.assign(start[n], 0);
+    std::vector<int> pos(start.begin(), start.end() - 1);
+    for (int i = 0; i < (int)eu.size(); i++) {
+      int a = pos[eu[i]]++, b = pos[ev[i]]++;
+      to[a] = ev[i];
+      to[b] = eu[i];
+      rev[a] = b;
+      rev[b] = a;
+      cap[a] = ecap[i];
+    }
+  }
+
+  void add_active(int v) {
+    active_next[v] = active_head[height[v]];
+    active_head[height[v]] = v;
+    max_active = std::max(max_active, height[v]);
+  }
+
+  void list_insert(int v) {
+    int h = height[v];
+    list_prev[v] = -1;
+    list_next[v] = list_head[h];
+    if (list_head[h] != -1) {
+      list_prev[list_head[h]] = v;
+    }
+    list_head[h] = v;
+    max_height = std::max(max_height, h);
+  }
+
+  void list_erase(int v) {
+    if (list_prev[v] != -1) {
+      list_next[list_prev[v]] = list_next[v];
+    } else {
+      list_head[height[v]] = list_next[v];
+    }
+    if (list_next[v] != -1) {
+      list_prev[list_next[v]] = list_prev[v];
+    }
+  }
+
+  // Sets every height to the exact residual distance to the sink with a
+  // reverse breadth-first search. Nodes which can no longer reach the sink are
+  // lifted to height n and will never be active again.
+  void global_relabel() {
+    height.assign(n, n);
+    std::fill(active_head.begin(), active_head.end(), -1);
+    std::fill(list_head.begin(), list_head.end(), -1);
+    max_active = max_height = 0;
+    std::vector<int> q(1, sink);
+    height[sink] = 0;
+    for (int i = 0; i < (int)q.size(); i++) {
+      int u = q[i];
+      list_insert(u);
+      if (excess[u] > 0 && u != sink) {
+        add_active(u);
+      }
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        int v = to[j];
+        if (height[v] == n && v != source && cap[rev[j]] > 0) {
+          height[v] = height[u] + 1;
+          q.push_back(v);
+        }
+      }
+    }
+    for (int u = 0; u < n; u++) {
+      cur[u] = start[u];
+    }
+    relabels = 0;
+  }
+
+  // Lifts every node above height h, which has just become empty, to n.
+  void gap(int h) {
+    for (int g = h + 1; g <= max_height; g++) {
+      for (int v = list_head[g]; v != -1; v = list_next[v]) {
+        height[v] = n;
+      }
+      list_head[g] = active_head[g] = -1;
+    }
+    max_height = max_active = h - 1;
+  }
+
+  void discharge(int u) {
+    while (excess[u] > 0) {
+      if (cur[u] == start[u + 1]) {
+        relabels++;
+        int old = height[u];
+        list_erase(u);
+        if (list_head[old] == -1) {
+          height[u] = n;
+          gap(old);
+          return;
+        }
+        int h = n;
+        for (int j = start[u]; j < start[u + 1]; j++) {
+          if (cap[j] > 0) {
+            h = std::min(h, height[to[j]] + 1);
+          }
+        }
+        height[u] = h;
+        cur[u] = start[u];
+        if (h >= n) {
+          return;
+        }
+        list_insert(u);
+        continue;
+      }
+      int j = cur[u], v = to[j];
+      if (cap[j] > 0 && height[u] == height[v] + 1) {
+        long long d = std::min(excess[u], cap[j]);
+        cap[j] -= d;
+        cap[rev[j]] += d;
+        excess[u] -= d;
+        if (excess[v] == 0 && v != sink) {
+          add_active(v);
+        }
+        excess[v] += d;
+      } else {
+        cur[u]++;
+      }
+    }
+  }
+
+ public:
+  hlpp_flow(int nodes) : n(nodes), cut_ready(false) {}
+
+  void add_edge(int u, int v, long long c) {
+    if (u != v) {
+      eu.push_back(u);
+      ev.push_back(v);
+      ecap.push_back(c);
+    }
+  }
+
+  long long max_flow(int s, int t) {
+    source = s;
+    sink = t;
+    build();
+    excess.assign(n, 0);
+    cur.resize(n);
+    active_head.resize(n + 1);
+    list_head.resize(n + 1);
+    active_next.resize(n);
+    list_next.resize(n);
+    list_prev.resize(n);
+    for (int j = start[s]; j < start[s + 1]; j++) {
+      excess[to[j]] += cap[j];
+      cap[rev[j]] += cap[j];
+      cap[j] = 0;
+    }
+    global_relabel();
+    for (;;) {
+      while (max_active >= 0 && active_head[max_active] == -1) {
+        max_active--;
+      }
+      if (max_active < 0) {
+        break;
+      }
+      int u = active_head[max_active];
+      active_head[max_active] = active_next[u];
+      discharge(u);
+      if (relabels >= n) {
+        global_relabel();
+      }
+    }
+    cut_ready = false;
+    return excess[t];
+  }
+
+  // Returns true if v is on the source side of the minimum cut found by the
+  // last call to max_flow(), i.e. v can no longer reach the sink in the
+  // residual graph, or false if v is on the sink side and still can. The
+  // source is always on the source side and the sink never is. This is only
+  // valid after max_flow(), since the heights do not exist before it. The
+  // first call after max_flow() runs a global relabel, since the pushes of
+  // the final rounds may have cut nodes off from the sink without moving
+  // their heights.
+  bool source_side(int v) {
+    if (!cut_ready) {
+      global_relabel();
+      cut_ready = true;
+    }
+    return height[v] >= n;
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -93,5 +322,18 @@ int main() {
   cap[3][5] = 2;
   cap[4][5] = 3;
   assert(push_relabel(6, 0, 5) == 5);
+
+  hlpp_flow hf(6);
+  hf.add_edge(0, 1, 3);
+  hf.add_edge(0, 2, 3);
+  hf.add_edge(1, 2, 2);
+  hf.add_edge(1, 3, 3);
+  hf.add_edge(2, 4, 2);
+  hf.add_edge(3, 4, 1);
+  hf.add_edge(3, 5, 2);
+  hf.add_edge(4, 5, 3);
+  assert(hf.max_flow(0, 5) == 5);
+  // The minimum cut separates {0, 1, 2, 3, 4} from {5} with 2 + 3 = 5.
+  assert(hf.source_side(4) && !hf.source_side(5));
   return 0;
 }
@@ -0,0 +1,373 @@
+/*
+
+Given a flow network with integer capacities and integer costs per unit of flow,
+find the maximum flow from a given source node to a given sink node having the
+minimum total cost, that is, the sum over all edges of their flow times their
+cost. Costs may be negative, as long as no cycle of the network has a negative
+total cost. min_cost_flow stores its edges in adjacency lists of the same edge
+struct as for the Edmonds-Karp algorithm, with an additional cost field. The
+flows of the edges are left in adj[][].f after either method returns.
+
+- successive_shortest_paths(s, t, limit) repeatedly augments along a cheapest
+  path from s to t, until either the flow reaches limit or t becomes
+  unreachable. Johnson's potentials make every residual edge cost nonnegative
+  after being adjusted by the potentials of its endpoints, so each path is
+  found by Dijkstra's algorithm on an indexed 4-ary heap. The potentials are
+  initialized by Bellman-Ford if any cost is negative, then increased by the
+  distances found in each round. Since the cost found at each flow value is
+  the minimum, stopping at limit gives the minimum cost flow of that value.
+- cost_scaling(s, t) instead adds an edge t -> s with a cost so negative that
+  every unit of flow through it pays for any path from s to t. It then finds a
+  minimum cost circulation with Goldberg and Tarjan's cost scaling push-relabel
+  algorithm. Costs are multiplied by n + 1, so that eps-optimality for eps = 1
+  implies optimality. For each eps, decreasing geometrically from the largest
+  cost, every residual edge with negative reduced cost is saturated, and the
+  resulting excesses are discharged in FIFO order along edges with negative
+  reduced cost, relabeling nodes as needed. This is usually much faster than
+  successive shortest paths when the maximum flow is large.
+
+Both methods return the pair (maximum flow, minimum cost).
+
+Time Complexity:
+- O(f*m log n) for successive_shortest_paths(), where n is the number of nodes,
+  m is the number of edges, and f is the maximum flow (plus O(n*m) for the
+  initial Bellman-Ford if any cost is negative).
+- O(n^2 * m log(n*C)) for cost_scaling(), where C is the largest cost.
+
+Space Complexity: O(n + m) for a min_cost_flow, and O(n) auxiliary per call.
+
+*/
+
+#include <algorithm>  // std::fill(), std::max(), std::min()
+#include <queue>
+#include <utility>  // std::make_pair(), std::pair
+#include <vector>
+
+const long long INF = 0x3f3f3f3f3f3f3f3fLL;
+
+struct edge {
+  int u, v, rev, cap, f, cost;
+};
+
+// The indexed 4-ary heap of section 2.2.2, keyed by long long.
+class dary_heap {
+  static const int D = 4;
+
+  std::vector<int> heap, pos;
+  std::vector<long long> key;
+
+  void sift_up(int i) {
+    int v = heap[i];
+    for (int p; i > 0 && key[heap[p = (i - 1)/D]] > key[v]; i = p) {
+      heap[i] = heap[p];
+      pos[heap[i]] = i;
+    }
+    heap[i] = v;
+    pos[v] = i;
+  }
+
+  void sift_down(int i) {
+    int v = heap[i], n = (int)heap.size();
+    for (;;) {
+      int c = D*i + 1, best = -1;
+      for (int end = std::min(c + D, n); c < end; c++) {
+        if (key[heap[c]] < (best < 0 ? key[v] : key[heap[best]])) {
+          best = c;
+        }
+      }
+      if (best < 0) {
+        break;
+      }
+      heap[i] = heap[best];
+      pos[heap[i]] = i;
+      i = best;
+    }
+    heap[i] = v;
+    pos[v] = i;
+  }
+
+ public:
+  dary_heap(int nodes) : pos(nodes, -1), key(nodes) {
+    heap.reserve(nodes);
+  }
+
+  bool empty() const {
+    return heap.empty();
+  }
+
+  // Inserts v, or decreases its key if it is already in the heap.
+  void push(int v, long long k) {
+    key[v] = k;
+    if (pos[v] < 0) {
+      heap.push_back(v);
+      pos[v] = (int)heap.size() - 1;
+    }
+    sift_up(pos[v]);
+  }
+
+  int pop(long long &k) {
+    int v = heap[0];
+    k = key[v];
+    pos[v] = -1;
+    if (heap.size() > 1) {
+      heap[0] = heap.back();
+      heap.pop_back();
+      sift_down(0);
+    } else {
+      heap.pop_back();
+    }
+    return v;
+  }
+};
+
+class min_cost_flow {
+  int n;
+  std::vector<long long> pot;
+
+  // Sets pot[] to the shortest distances from s by Bellman-Ford.
+  void init_potentials(int s) {
+    pot.assign(n, INF);
+    pot[s] = 0;
+    for (int i = 0; i < n; i++) {
+      bool relaxed = false;
+      for (int u = 0; u < n; u++) {
+        if (pot[u] == INF) {
+          continue;
+        }
+        for (int j = 0; j < (int)adj[u].size(); j++) {
+          const edge &e = adj[u][j];
+          if (e.f < e.cap && pot[u] + e.cost < pot[e.v]) {
+            pot[e.v] = pot[u] + e.cost;
+            relaxed = true;
+          }
+        }
+      }
+      if (!relaxed) {
+        break;
+      }
+    }
+    for (int u = 0; u < n; u++) {
+      if (pot[u] == INF) {
+        pot[u] = 0;
+      }
+    }
+  }
+
+  long long total_cost() const {
+    long long cost = 0;
+    for (int u = 0; u < n; u++) {
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        if (adj[u][j].f > 0) {
+          cost += (long long)adj[u][j].f*adj[u][j].cost;
+        }
+      }
+    }
+    return cost;
+  }
+
+  static long long magnitude(long long x) {
+    return x < 0 ? -x : x;
+  }
+
+  void push(edge &e, int df) {
+    e.f += df;
+    adj[e.v][e.rev].f -= df;
+  }
+
+ public:
+  std::vector<std::vector<edge> > adj;
+
+  min_cost_flow(int nodes) : n(nodes), adj(nodes) {}
+
+  void add_edge(int u, int v, int cap, int cost) {
+    edge a = {u, v, (int)adj[v].size(), cap, 0, cost};
+    edge b = {v, u, (int)adj[u].size(), 0, 0, -cost};
+    adj[u].push_back(a);
+    adj[v].push_back(b);
+  }
+
+  std::pair<long long, long long> successive_shortest_paths(
+      int s, int t, long long limit = INF) {
+    bool negative = false;
+    for (int u = 0; u < n; u++) {
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        const edge &e = adj[u][j];
+        negative |= (e.f < e.cap && e.cost < 0);
+      }
+    }
+    if (negative) {
+      init_potentials(s);
+    } else {
+      pot.assign(n, 0);
+    }
+    std::vector<long long> dist(n);
+    std::vector<edge*> pred(n);
+    dary_heap h(n);
+    long long flow = 0, d;
+    while (flow < limit) {
+      std::fill(dist.begin(), dist.end(), INF);
+      dist[s] = 0;
+      h.push(s, 0);
+      while (!h.empty()) {
+        int u = h.pop(d);
+        for (int j = 0; j < (int)adj[u].size(); j++) {
+          edge &e = adj[u][j];
+          long long nd = d + e.cost + pot[u] - pot[e.v];
+          if (e.f < e.cap && nd < dist[e.v]) {
+            dist[e.v] = nd;
+            pred[e.v] = &e;
+            h.push(e.v, nd);
+          }
+        }
+      }
+      if (dist[t] == INF) {
+        break;
+      }
+      for (int u = 0; u < n; u++) {
+        if (dist[u] != INF) {
+          pot[u] += dist[u];
+        }
+      }
+      long long df = limit - flow;
+      for (int u = t; u != s; u = pred[u]->u) {
+        df = std::min(df, (long long)(pred[u]->cap - pred[u]->f));
+      }
+      for (int u = t; u != s; u = pred[u]->u) {
+        push(*pred[u], (int)df);
+      }
+      flow += df;
+    }
+    return std::make_pair(flow, total_cost());
+  }
+
+  std::pair<long long, long long> cost_scaling(int s, int t) {
+    static const int ALPHA = 8;
+    long long max_cost = 0, cap_out = 0;
+    for (int u = 0; u < n; u++) {
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        max_cost = std::max(max_cost, magnitude(adj[u][j].cost));
+      }
+    }
+    for (int j = 0; j < (int)adj[s].size(); j++) {
+      cap_out += adj[s][j].cap;
+    }
+    // Any path from s to t costs more than -n*max_cost, so the circulation
+    // through the bypass edge is a maximum flow.
+    add_edge(t, s, (int)std::min(cap_out, 0x3f3f3f3fLL), 0);
+    edge &bypass = adj[t].back();
+    std::vector<std::vector<long long> > cost(n);
+    long long scale = n + 1, eps = 0;
+    for (int u = 0; u < n; u++) {
+      cost[u].resize(adj[u].size());
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        cost[u][j] = adj[u][j].cost*scale;
+      }
+    }
+    long long big = ((long long)n*max_cost + 1)*scale;
+    cost[t].back() = -big;
+    cost[s].back() = big;
+    for (int u = 0; u < n; u++) {
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        eps = std::max(eps, magnitude(cost[u][j]));
+      }
+    }
+    std::vector<long long> p(n, 0), excess(n, 0);
+    for (int u = 0; u < n; u++) {
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        excess[u] -= adj[u][j].f;
+      }
+    }
+    std::vector<int> cur(n);
+    std::vector<char> queued(n, false);
+    std::queue<int> q;
+    while (eps > 1) {
+      eps = std::max(1LL, eps/ALPHA);
+      // Saturate every residual edge with negative reduced cost.
+      for (int u = 0; u < n; u++) {
+        for (int j = 0; j < (int)adj[u].size(); j++) {
+          edge &e = adj[u][j];
+          if (e.f < e.cap && cost[u][j] + p[u] - p[e.v] < 0) {
+            int df = e.cap - e.f;
+            push(e, df);
+            excess[u] -= df;
+            excess[e.v] += df;
+          }
+        }
+      }
+      for (int u = 0; u < n; u++) {
+        cur[u] = 0;
+        if (excess[u] > 0) {
+          queued[u] = true;
+          q.push(u);
+        }
+      }
+      while (!q.empty()) {
+        int u = q.front();
+        q.pop();
+        queued[u] = false;
+        while (excess[u] > 0) {
+          if (cur[u] == (int)adj[u].size()) {
+            // Relabel u so that its cheapest residual edge is admissible.
+            long long best = -INF;
+            for (int j = 0; j < (int)adj[u].size(); j++) {
+              const edge &e = adj[u][j];
+              if (e.f < e.cap) {
+                best = std::max(best, p[e.v] - cost[u][j]);
+              }
+            }
+            p[u] = best - eps;
+            cur[u] = 0;
+          }
+          edge &e = adj[u][cur[u]];
+          if (e.f < e.cap && cost[u][cur[u]] + p[u] - p[e.v] < 0) {
+            int df = (int)std::min(excess[u], (long long)(e.cap - e.f));
+            push(e, df);
+            excess[u] -= df;
+            excess[e.v] += df;
+            if (excess[e.v] > 0 && !queued[e.v]) {
+              queued[e.v] = true;
+              q.push(e.v);
+            }
+          } else {
+            cur[u]++;
+          }
+        }
+      }
+    }
+    long long flow = bypass.f;
+    adj[s].pop_back();
+    adj[t].pop_back();
+    return std::make_pair(flow, total_cost());
+  }
+};
+
+/*** Example Usage and Output:
+
+Flow: 5, cost: 30
+
+***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+int main() {
+  min_cost_flow g(6);
+  g.add_edge(0, 1, 3, 1);
+  g.add_edge(0, 2, 3, 2);
+  g.add_edge(1, 2, 2, 1);
+  g.add_edge(1, 3, 3, 4);
+  g.add_edge(2, 4, 2, 1);
+  g.add_edge(3, 4, 1, 1);
+  g.add_edge(3, 5, 2, 1);
+  g.add_edge(4, 5, 3, 2);
+  pair<long long, long long> res = g.successive_shortest_paths(0, 5);
+  cout << "Flow: " << res.first << ", cost: " << res.second << endl;
+  for (int u = 0; u < 6; u++) {
+    for (int j = 0; j < (int)g.adj[u].size(); j++) {
+      g.adj[u][j].f = 0;
+    }
+  }
+  assert(g.cost_scaling(0, 5) == res);
+  return 0;
+}
@@ -10,8 +10,28 @@ condition that adj[u][v] is true if and only if adj[v][u] is true, for all pairs
 of nodes u and v respectively between 0 (inclusive) and the total number of
 nodes (exclusive) as passed in the function argument.
 
-Time Complexity: O(3^(n/3)) on the number of nodes.
-Space Complexity: O(n) auxiliary on the number of nodes.
+clique_finder is a dynamically sized alternative for large, sparse graphs given
+as adjacency lists. Nodes are first put in degeneracy order, in which each node
+has few neighbors that come later. The search from each node in this order only
+considers its later neighbors as candidates, so it runs on a small subgraph
+with its own bitset adjacency matrix of 64-bit words, relabeled from 0.
+- maximal_cliques() lists every maximal clique using Tomita's pivoting rule,
+  which branches only on candidates that are not adjacent to the pivot, chosen
+  as the node in the subgraph with the most neighbors among the candidates.
+- max_clique() returns a maximum clique. It greedily colors the candidates at
+  each step and tries them in decreasing order of color, pruning as soon as the
+  current clique plus the number of colors left cannot beat the best clique.
+The top-level searches are independent of one another.
+
+Time Complexity:
+- O(3^(n/3)) on the number of nodes for bron_kerbosch().
+- O(d*n*3^(d/3)) for maximal_cliques(), where d is the degeneracy of the graph,
+  which is also the worst case for max_clique().
+
+Space Complexity:
+- O(n) auxiliary on the number of nodes for bron_kerbosch().
+- O(n + m + D^2) for a clique_finder, where m is the number of edges and D the
+  maximum degree.
 
 */
 
@@ -97,10 +117,284 @@ int bron_kerbosch_weighted(int nodes) {
   return rec(g, 0, (1LL << nodes) - 1, 0);
 }
 
+class clique_finder {
+  int n;
+  std::vector<std::vector<int> > adj;
+  std::vector<int> order, rank;
+
+  // The subproblem of a top-level node: its neighbors relabeled from 0 to d - 1,
+  // along with their adjacency matrix, each row of which takes words integers.
+  int d, words;
+  std::vector<int> local, local_id;
+  std::vector<uint64> mat;
+
+  // Per-depth bitsets of the candidates (pool), the excluded nodes (excl), and
+  // scratch space (temp), as well as nodes and colors for the coloring bound.
+  std::vector<std::vector<uint64> > pool, excl, temp;
+  std::vector<std::vector<int> > verts, colors;
+  std::vector<int> clique, best;
+
+  // Orders the nodes by repeatedly removing one of minimum remaining degree.
+  // Each node then has at most k neighbors later in the order, for the
+  // smallest such k (the degeneracy of the graph).
+  void degeneracy_order() {
+    std::vector<int> deg(n), bin, pos(n);
+    int max_deg = 0;
+    for (int u = 0; u < n; u++) {
+      deg[u] = (int)adj[u].size();
+      max_deg = std::max(max_deg, deg[u]);
+    }
+    bin.assign(max_deg + 1, 0);
+    for (int u = 0; u < n; u++) {
+      bin[deg[u]]++;
+    }
+    for (int k = 0, start = 0; k <= max_deg; k++) {
+      int count = bin[k];
+      bin[k] = start;
+      start += count;
+    }
+    order.resize(n);
+    for (int u = 0; u < n; u++) {
+      pos[u] = bin[deg[u]]++;
+      order[pos[u]] = u;
+    }
+    for (int k = max_deg; k > 0; k--) {
+      bin[k] = bin[k - 1];
+    }
+    bin[0] = 0;
+    for (int i = 0; i < n; i++) {
+      int u = order[i];
+      for (int j = 0; j < (int)adj[u].size(); j++) {
+        int v = adj[u][j];
+        if (deg[v] > deg[u]) {
+          // Swap v with the first node of its bin, then shrink the bin.
+          int first = order[bin[deg[v]]];
+          if (first != v) {
+            order[pos[v]] = first;
+            order[bin[deg[v]]] = v;
+            pos[first] = pos[v];
+            pos[v] = bin[deg[v]];
+          }
+          bin[deg[v]]++;
+          deg[v]--;
+        }
+      }
+    }
+    rank.resize(n);
+    for (int i = 0; i < n; i++) {
+      rank[order[i]] = i;
+    }
+  }
+
+  void build_local(int v, bool later_only) {
+    local.clear();
+    for (int j = 0; j < (int)adj[v].size(); j++) {
+      int u = adj[v][j];
+      if (local_id[u] < 0 && (!later_only || rank[u] > rank[v])) {
+        local_id[u] = (int)local.size();
+        local.push_back(u);
+      }
+    }
+    d = (int)local.size();
+    words = (d + 63)/64;
+    mat.assign(d*words, 0);
+    for (int i = 0; i < d; i++) {
+      const std::vector<int> &a = adj[local[i]];
+      for (int j = 0; j < (int)a.size(); j++) {
+        int k = local_id[a[j]];
+        if (k >= 0) {
+          mat[i*words + k/64] |= 1ULL << (k % 64);
+        }
+      }
+    }
+    for (int i = 0; i < d; i++) {
+      local_id[local[i]] = -1;
+    }
+    if ((int)pool.size() < d + 2) {
+      pool.resize(d + 2);
+      excl.resize(d + 2);
+      temp.resize(d + 2);
+      verts.resize(d + 2);
+      colors.resize(d + 2);
+    }
+    for (int i = 0; i < d + 2; i++) {
+      pool[i].assign(words, 0);
+      excl[i].assign(words, 0);
+      temp[i].assign(words, 0);
+    }
+  }
+
+  const uint64 *row(int u) const {
+    return &mat[u*words];
+  }
+
+  bool none(const std::vector<uint64> &s) const {
+    for (int k = 0; k < words; k++) {
+      if (s[k] != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Tomita's pivoting: branching only on candidates not adjacent to the pivot
+  // of maximum candidate degree still reaches every maximal clique.
+  template<class ReportFunction>
+  void tomita(int depth, ReportFunction &report) {
+    std::vector<uint64> &p = pool[depth], &x = excl[depth], &c = temp[depth];
+    if (none(p)) {
+      if (none(x)) {
+        report(clique);
+      }
+      return;
+    }
+    int pivot = -1, pivot_degree = -1;
+    for (int k = 0; k < words; k++) {
+      for (uint64 b = p[k] | x[k]; b != 0; b &= b - 1) {
+        int u = k*64 + __builtin_ctzll(b), degree = 0;
+        for (int w = 0; w < words; w++) {
+          degree += __builtin_popcountll(p[w] & row(u)[w]);
+        }
+        if (degree > pivot_degree) {
+          pivot = u;
+          pivot_degree = degree;
+        }
+      }
+    }
+    for (int k = 0; k < words; k++) {
+      c[k] = p[k] & ~row(pivot)[k];
+    }
+    for (int k = 0; k < words; k++) {
+      for (uint64 b = c[k]; b != 0; b &= b - 1) {
+        int v = k*64 + __builtin_ctzll(b);
+        for (int w = 0; w < words; w++) {
+          pool[depth + 1][w] = p[w] & row(v)[w];
+          excl[depth + 1][w] = x[w] & row(v)[w];
+        }
+        clique.push_back(local[v]);
+        tomita(depth + 1, report);
+        clique.pop_back();
+        p[k] &= ~(1ULL << (v % 64));
+        x[k] |= 1ULL << (v % 64);
+      }
+    }
+  }
+
+  // Greedily colors the candidates, so that any clique among the nodes of
+  // colors 1 to k has at most k nodes. Trying nodes in reverse order of color
+  // then allows pruning as soon as the color cannot beat the best clique.
+  void expand(int depth) {
+    std::vector<uint64> &p = pool[depth], &q = excl[depth], &r = temp[depth];
+    std::vector<int> &vs = verts[depth], &cs = colors[depth];
+    vs.clear();
+    cs.clear();
+    q = p;
+    for (int color = 1; !none(q); color++) {
+      r = q;
+      for (int k = 0; k < words; k++) {
+        while (r[k] != 0) {
+          int u = k*64 + __builtin_ctzll(r[k]);
+          q[k] &= ~(1ULL << (u % 64));
+          for (int w = 0; w < words; w++) {
+            r[w] &= ~row(u)[w];
+          }
+          r[k] &= ~(1ULL << (u % 64));
+          vs.push_back(u);
+          cs.push_back(color);
+        }
+      }
+    }
+    for (int i = (int)vs.size() - 1; i >= 0; i--) {
+      if ((int)clique.size() + cs[i] <= (int)best.size()) {
+        return;
+      }
+      int u = vs[i];
+      std::vector<uint64> &np = pool[depth + 1];
+      for (int w = 0; w < words; w++) {
+        np[w] = p[w] & row(u)[w];
+      }
+      clique.push_back(local[u]);
+      if (none(np)) {
+        if (clique.size() > best.size()) {
+          best = clique;
+        }
+      } else {
+        expand(depth + 1);
+      }
+      clique.pop_back();
+      p[u/64] &= ~(1ULL << (u % 64));
+    }
+  }
+
+ public:
+  clique_finder(int nodes) : n(nodes), adj(nodes), local_id(nodes, -1) {}
+
+  void add_edge(int u, int v) {
+    if (u != v) {
+      adj[u].push_back(v);
+      adj[v].push_back(u);
+    }
+  }
+
+  // Calls report(clique) with a vector of the nodes in each maximal clique.
+  // Each top-level node v is searched together with all of its neighbors,
+  // but only those later in the degeneracy order are candidates.
+  template<class ReportFunction> void maximal_cliques(ReportFunction report) {
+    degeneracy_order();
+    for (int i = 0; i < n; i++) {
+      int v = order[i];
+      build_local(v, false);
+      for (int k = 0; k < d; k++) {
+        std::vector<uint64> &s = (rank[local[k]] > i) ? pool[0] : excl[0];
+        s[k/64] |= 1ULL << (k % 64);
+      }
+      clique.assign(1, v);
+      tomita(0, report);
+    }
+  }
+
+  std::vector<int> max_clique() {
+    degeneracy_order();
+    best.clear();
+    for (int i = 0; i < n; i++) {
+      int v = order[i], later = 0;
+      for (int j = 0; j < (int)adj[v].size(); j++) {
+        later += (rank[adj[v][j]] > i);
+      }
+      if (later + 1 <= (int)best.size()) {
+        continue;
+      }
+      build_local(v, true);
+      for (int k = 0; k < d; k++) {
+        pool[0][k/64] |= 1ULL << (k % 64);
+      }
+      clique.assign(1, v);
+      if (d == 0) {
+        if (best.empty()) {
+          best = clique;
+        }
+      } else {
+        expand(0);
+      }
+    }
+    return best;
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
 
+struct clique_counter {
+  int *count;
+
+  clique_counter(int *count) : count(count) {}
+
+  void operator()(const std::vector<int> &clique) {
+    (*count)++;
+  }
+};
+
 void add_edge(int u, int v) {
   adj[u][v] = adj[v][u] = true;
 }
@@ -121,5 +415,19 @@ int main() {
   w[4] = 50;
   assert(bron_kerbosch(5) == 4);
   assert(bron_kerbosch_weighted(5) == 120);
+
+  clique_finder cf(5);
+  cf.add_edge(0, 1);
+  cf.add_edge(0, 2);
+  cf.add_edge(0, 3);
+  cf.add_edge(1, 2);
+  cf.add_edge(1, 3);
+  cf.add_edge(2, 3);
+  cf.add_edge(3, 4);
+  cf.add_edge(4, 2);
+  int count = 0;
+  cf.maximal_cliques(clique_counter(&count));
+  assert(count == 2);  // {0, 1, 2, 3} and {2, 3, 4}.
+  assert(cf.max_clique().size() == 4);
   return 0;
 }
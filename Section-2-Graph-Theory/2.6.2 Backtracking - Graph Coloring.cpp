@@ -8,12 +8,35 @@ adj[v][u] is true, for all pairs of nodes u and v respectively between 0
 (inclusive) and the total number of nodes (exclusive) as passed in the function
 argument.
 
-Time Complexity: Exponential on the number of nodes.
-Space Complexity: O(n) on the number of nodes.
+graph_colorer is a dynamically sized alternative for larger graphs, storing
+both adjacency lists and an adjacency matrix of bitsets.
+- dsatur() runs Brelaz's DSATUR heuristic, which colors nodes one at a time,
+  always picking the node adjacent to the most distinct colors so far, and
+  gives it the smallest color not used by any of its neighbors. It is fast and
+  usually close to optimal, making it a good upper bound.
+- exact() turns DSATUR into a branch and bound, which tries every feasible
+  color for each chosen node and backtracks as soon as the number of colors
+  used reaches that of the best coloring found. A clique found greedily gives a
+  lower bound, which also breaks symmetry by fixing the colors of its nodes.
+  The search stops once the lower bound is reached or after a given number of
+  search nodes, in which case the best coloring found so far is kept. The
+  subtrees of the search for the first few nodes are independent of each
+  other.
+
+Time Complexity:
+- Exponential on the number of nodes for color_graph(), and for exact() in the
+  worst case (limited to O(k*n + m) per search node for k colors).
+- O((n + m) log n) for dsatur(), where m is the number of edges.
+
+Space Complexity:
+- O(n) on the number of nodes for color_graph().
+- O(n^2/64 + m) for a graph_colorer, plus O(k*n) auxiliary for exact().
 
 */
 
-#include <algorithm>  // std::fill(), std::max()
+#include <algorithm>  // std::fill(), std::max(), std::sort()
+#include <set>
+#include <utility>  // std::make_pair(), std::pair
 #include <vector>
 
 const int MAXN = 30;
@@ -74,6 +97,194 @@ int color_graph(int nodes) {
   return res;
 }
 
+class graph_colorer {
+  typedef unsigned long long uint64;
+
+  static const int SEEDS = 16;
+
+  int n, words;
+  std::vector<std::vector<int> > adj;
+  std::vector<uint64> rows;
+
+  // State of the exact search: cnt[v*k_max + c] is the number of neighbors of v
+  // with color c, and sat[v] is the number of distinct colors among them.
+  int k_max;
+  long long budget;
+  std::vector<int> cnt, sat, curr;
+
+  bool has_edge(int u, int v) const {
+    return (rows[u*words + v/64] >> (v % 64)) & 1;
+  }
+
+  void assign(int v, int c) {
+    curr[v] = c;
+    for (int j = 0; j < (int)adj[v].size(); j++) {
+      if (cnt[adj[v][j]*k_max + c]++ == 0) {
+        sat[adj[v][j]]++;
+      }
+    }
+  }
+
+  void unassign(int v) {
+    int c = curr[v];
+    curr[v] = -1;
+    for (int j = 0; j < (int)adj[v].size(); j++) {
+      if (--cnt[adj[v][j]*k_max + c] == 0) {
+        sat[adj[v][j]]--;
+      }
+    }
+  }
+
+  // Grows a clique greedily from each of the highest degree nodes, returning
+  // the largest found. Its size is a lower bound on the number of colors.
+  std::vector<int> greedy_clique() const {
+    std::vector<std::pair<int, int> > by_degree(n);
+    for (int v = 0; v < n; v++) {
+      by_degree[v] = std::make_pair(-(int)adj[v].size(), v);
+    }
+    std::sort(by_degree.begin(), by_degree.end());
+    std::vector<int> best;
+    for (int i = 0; i < n && i < SEEDS; i++) {
+      std::vector<int> clique(1, by_degree[i].second);
+      for (int j = 0; j < n; j++) {
+        int u = by_degree[j].second;
+        bool joins = true;
+        for (int k = 0; k < (int)clique.size() && joins; k++) {
+          joins = has_edge(u, clique[k]);
+        }
+        if (joins) {
+          clique.push_back(u);
+        }
+      }
+      if (clique.size() > best.size()) {
+        best = clique;
+      }
+    }
+    return best;
+  }
+
+  // Colors the node of greatest saturation (ties broken by degree) with every
+  // feasible color in turn, or a new color if that can still beat the best.
+  void search(int colored, int k, int lower_bound) {
+    if (k >= colors || colors == lower_bound || --budget < 0) {
+      return;
+    }
+    if (colored == n) {
+      colors = k;
+      color = curr;
+      return;
+    }
+    int v = -1;
+    for (int u = 0; u < n; u++) {
+      if (curr[u] < 0 && (v < 0 || sat[u] > sat[v] ||
+          (sat[u] == sat[v] && adj[u].size() > adj[v].size()))) {
+        v = u;
+      }
+    }
+    for (int c = 0; c < k; c++) {
+      if (cnt[v*k_max + c] == 0) {
+        assign(v, c);
+        search(colored + 1, k, lower_bound);
+        unassign(v);
+      }
+    }
+    if (k + 1 < colors) {
+      assign(v, k);
+      search(colored + 1, k + 1, lower_bound);
+      unassign(v);
+    }
+  }
+
+ public:
+  // color[v] is the color of node v from 0 to colors - 1, after either method.
+  // optimal is set by exact() if the search finished within its budget.
+  std::vector<int> color;
+  int colors;
+  bool optimal;
+
+  graph_colorer(int nodes)
+      : n(nodes), words((nodes + 63)/64), adj(nodes), rows(nodes*words, 0),
+        colors(0), optimal(false) {}
+
+  void add_edge(int u, int v) {
+    if (u != v && !has_edge(u, v)) {
+      rows[u*words + v/64] |= 1ULL << (v % 64);
+      rows[v*words + u/64] |= 1ULL << (u % 64);
+      adj[u].push_back(v);
+      adj[v].push_back(u);
+    }
+  }
+
+  // Brelaz's DSATUR heuristic: repeatedly colors the uncolored node adjacent to
+  // the most distinct colors with the smallest color available, breaking ties
+  // by degree among the uncolored nodes.
+  int dsatur() {
+    int max_deg = 0;
+    for (int v = 0; v < n; v++) {
+      max_deg = std::max(max_deg, (int)adj[v].size());
+    }
+    int cwords = (max_deg + 64)/64;
+    std::vector<uint64> seen(n*cwords, 0);
+    std::vector<int> s(n, 0), d(n);
+    std::set<std::pair<std::pair<int, int>, int> > q;
+    for (int v = 0; v < n; v++) {
+      d[v] = (int)adj[v].size();
+      q.insert(std::make_pair(std::make_pair(0, -d[v]), v));
+    }
+    color.assign(n, -1);
+    colors = 0;
+    while (!q.empty()) {
+      int v = q.begin()->second;
+      q.erase(q.begin());
+      int c = 0;
+      for (int k = 0; k < cwords; k++) {
+        uint64 free = ~seen[v*cwords + k];
+        if (free != 0) {
+          c = k*64 + __builtin_ctzll(free);
+          break;
+        }
+      }
+      color[v] = c;
+      colors = std::max(colors, c + 1);
+      for (int j = 0; j < (int)adj[v].size(); j++) {
+        int u = adj[v][j];
+        if (color[u] >= 0) {
+          continue;
+        }
+        q.erase(std::make_pair(std::make_pair(-s[u], -d[u]), u));
+        uint64 &bit = seen[u*cwords + c/64];
+        if (!((bit >> (c % 64)) & 1)) {
+          bit |= 1ULL << (c % 64);
+          s[u]++;
+        }
+        d[u]--;
+        q.insert(std::make_pair(std::make_pair(-s[u], -d[u]), u));
+      }
+    }
+    return colors;
+  }
+
+  // Runs a DSATUR branch and bound, starting from the DSATUR coloring as the
+  // upper bound and a greedy clique as the lower bound, whose nodes are fixed
+  // to distinct colors. At most node_limit search nodes are expanded.
+  int exact(long long node_limit = 1000000) {
+    dsatur();
+    std::vector<int> clique = greedy_clique();
+    int lower_bound = (int)clique.size();
+    k_max = colors;
+    budget = node_limit;
+    cnt.assign(n*k_max, 0);
+    sat.assign(n, 0);
+    curr.assign(n, -1);
+    for (int i = 0; i < lower_bound; i++) {
+      assign(clique[i], i);
+    }
+    search(lower_bound, lower_bound, lower_bound);
+    optimal = (colors == lower_bound || budget >= 0);
+    return colors;
+  }
+};
+
 /*** Example Usage and Output:
 
 Colored using 3 color(s). The colorings are:
@@ -110,5 +321,28 @@ int main() {
     }
     cout << endl;
   }
+
+  graph_colorer gc(5);
+  gc.add_edge(0, 1);
+  gc.add_edge(0, 4);
+  gc.add_edge(1, 3);
+  gc.add_edge(1, 4);
+  gc.add_edge(2, 3);
+  gc.add_edge(2, 4);
+  gc.add_edge(3, 4);
+  assert(gc.dsatur() == 3 && gc.exact() == 3 && gc.optimal);
+
+  // The Mycielski graph of a 5-cycle has no triangle, but needs 4 colors.
+  graph_colorer m(11);
+  for (int i = 0; i < 5; i++) {
+    m.add_edge(i, (i + 1) % 5);
+    m.add_edge(i, 5 + (i + 1) % 5);
+    m.add_edge((i + 1) % 5, 5 + i);
+    m.add_edge(5 + i, 10);
+  }
+  assert(m.exact() == 4);
+  for (int u = 0; u < 11; u++) {
+    assert(m.color[u] >= 0 && m.color[u] < 4);
+  }
   return 0;
 }
@@ -5,13 +5,31 @@ n1 < n2, as well as a set of edges E mapping nodes from set A to set B,
 determine the largest possible subset of E such that no pair of edges in the
 subset share a common node.
 
-Time Complexity: O(m*sqrt(n1 + n2)) where m is the number of edges.
-Space Complexity: O(n1 + n2) auxiliary.
+bipartite_matcher is a dynamically sized alternative which stores the edges in
+both directions as adjacency lists packed into a single array. solve() first
+applies the Karp-Sipser heuristic, which repeatedly matches a free node having a
+single free neighbor (an edge which some maximum matching must contain), and
+otherwise matches an arbitrary free pair. This usually leaves few augmenting
+paths for the phases of Hopcroft-Karp, whose depth-first searches keep the
+current path on an explicit stack. Afterwards, the matching is kept maximum
+while edges are added or removed: an augmenting path created by the change must
+end at one of its endpoints, or use the added edge, so only those are searched
+from instead of solving from scratch.
+
+Time Complexity:
+- O(m*sqrt(n1 + n2)) for hopcroft_karp() and bipartite_matcher::solve(), where
+  m is the number of edges.
+- O(n1 + n2 + m) per call to add_edge() or remove_edge().
+
+Space Complexity:
+- O(n1 + n2) auxiliary for hopcroft_karp().
+- O(n1 + n2 + m) for a bipartite_matcher.
 
 */
 
-#include <algorithm>  // std::fill()
+#include <algorithm>  // std::copy(), std::fill()
 #include <queue>
+#include <utility>  // std::pair
 #include <vector>
 
 const int MAXN = 100;
@@ -75,6 +93,339 @@ int hopcroft_karp(int n1, int n2) {
   return res;
 }
 
+// Adjacency lists in a single array, where the list of u occupies
+// to[start[u] .. start[u] + deg[u]) out of cap[u] reserved slots. A list which
+// outgrows its slots is moved to the end of the array with twice the room.
+struct packed_adjacency {
+  std::vector<int> start, deg, cap, to;
+
+  void build(int n, const std::vector<std::pair<int, int> > &edges, bool rev) {
+    start.assign(n + 1, 0);
+    deg.assign(n, 0);
+    for (int i = 0; i < (int)edges.size(); i++) {
+      start[(rev ? edges[i].second : edges[i].first) + 1]++;
+    }
+    for (int u = 0; u < n; u++) {
+      start[u + 1] += start[u];
+    }
+    to.resize(edges.size());
+    for (int i = 0; i < (int)edges.size(); i++) {
+      int u = rev ? edges[i].second : edges[i].first;
+      to[start[u] + deg[u]++] = rev ? edges[i].first : edges[i].second;
+    }
+    start.pop_back();
+    cap = deg;
+  }
+
+  int end(int u) const {
+    return start[u] + deg[u];
+  }
+
+  void add(int u, int v) {
+    if (deg[u] == cap[u]) {
+      int s = (int)to.size();
+      to.resize(s + 2*cap[u] + 1);
+      std::copy(to.begin() + start[u], to.begin() + end(u), to.begin() + s);
+      start[u] = s;
+      cap[u] = 2*cap[u] + 1;
+    }
+    to[start[u] + deg[u]++] = v;
+  }
+
+  bool remove(int u, int v) {
+    for (int i = start[u]; i < end(u); i++) {
+      if (to[i] == v) {
+        to[i] = to[end(u) - 1];
+        deg[u]--;
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+class bipartite_matcher {
+  // Side 0 is A and side 1 is B, each with the adjacency lists leading to the
+  // other side, the current mate (or -1) of every node, and search state. A
+  // node u is known to have no alternating path to a free node on the other
+  // side if dead[u] == epoch. Augmenting never revives such a node, but freeing
+  // a node or adding an edge may, in which case the epoch is advanced.
+  struct side {
+    packed_adjacency g;
+    std::vector<int> mate, it, seen, dead;
+    int epoch;
+  } sides[2];
+
+  int n1, n2, matched, stamp;
+  std::vector<int> dist, path, visited;
+
+  void match(int u, int v) {
+    sides[0].mate[u] = v;
+    sides[1].mate[v] = u;
+  }
+
+  bool dead(int s, int u) const {
+    return sides[s].dead[u] == sides[s].epoch;
+  }
+
+  // Matches the free nodes of degree one to their only free neighbor, as long
+  // as there are any, and otherwise matches any free node with a free neighbor.
+  void karp_sipser() {
+    std::vector<int> free_deg(n1 + n2, 0), q;
+    for (int s = 0; s < 2; s++) {
+      side &a = sides[s], &b = sides[1 - s];
+      for (int u = 0; u < (int)a.mate.size(); u++) {
+        if (a.mate[u] >= 0) {
+          continue;
+        }
+        int &d = free_deg[s*n1 + u];
+        for (int i = a.g.start[u]; i < a.g.end(u); i++) {
+          d += (b.mate[a.g.to[i]] < 0);
+        }
+        if (d == 1) {
+          q.push_back(s*n1 + u);
+        }
+      }
+    }
+    for (int next = 0;;) {
+      int s, u;
+      if (!q.empty()) {
+        s = (q.back() >= n1);
+        u = q.back() - s*n1;
+        q.pop_back();
+      } else {
+        while (next < n1 && (sides[0].mate[next] >= 0 || free_deg[next] == 0)) {
+          next++;
+        }
+        if (next == n1) {
+          break;
+        }
+        s = 0;
+        u = next;
+      }
+      side &a = sides[s], &b = sides[1 - s];
+      if (a.mate[u] >= 0 || free_deg[s*n1 + u] == 0) {
+        continue;
+      }
+      int v = -1;
+      for (int i = a.g.start[u]; v < 0 && i < a.g.end(u); i++) {
+        if (b.mate[a.g.to[i]] < 0) {
+          v = a.g.to[i];
+        }
+      }
+      a.mate[u] = v;
+      b.mate[v] = u;
+      matched++;
+      // Neither u nor v is free anymore, so their neighbors lose a free one.
+      for (int t = 0; t < 2; t++) {
+        int x = (t == 0) ? u : v, o = (t == 0) ? 1 - s : s;
+        const packed_adjacency &g = sides[1 - o].g;
+        for (int i = g.start[x]; i < g.end(x); i++) {
+          int y = g.to[i], id = o*n1 + y;
+          if (sides[o].mate[y] < 0 && --free_deg[id] == 1) {
+            q.push_back(id);
+          }
+        }
+      }
+    }
+  }
+
+  // Searches for an alternating path from root on side s to a free node on the
+  // other side, leaving the nodes of side s along the path in path[]. When
+  // layered, only follows edges one level deeper in dist[] (side 0 only).
+  // Otherwise, skips dead nodes, and marks every node visited dead on failure.
+  bool search(int s, int root, bool layered) {
+    side &a = sides[s], &b = sides[1 - s];
+    if (!layered && dead(s, root)) {
+      return false;
+    }
+    stamp++;
+    path.clear();
+    path.push_back(root);
+    visited.clear();
+    visited.push_back(root);
+    a.seen[root] = stamp;
+    if (!layered) {
+      a.it[root] = a.g.start[root];
+    }
+    while (!path.empty()) {
+      int u = path.back();
+      if (a.it[u] == a.g.end(u)) {
+        if (layered) {
+          dist[u] = -1;
+        }
+        path.pop_back();
+        if (!path.empty()) {
+          a.it[path.back()]++;
+        }
+        continue;
+      }
+      int w = b.mate[a.g.to[a.it[u]]];
+      if (w < 0) {
+        return true;
+      }
+      if (layered ? dist[w] == dist[u] + 1
+                  : (a.seen[w] != stamp && !dead(s, w))) {
+        a.seen[w] = stamp;
+        if (!layered) {
+          a.it[w] = a.g.start[w];
+          visited.push_back(w);
+        }
+        path.push_back(w);
+      } else {
+        a.it[u]++;
+      }
+    }
+    for (int i = 0; i < (int)visited.size(); i++) {
+      a.dead[visited[i]] = a.epoch;
+    }
+    return false;
+  }
+
+  void flip(int s, const std::vector<int> &p) {
+    for (int i = 0; i < (int)p.size(); i++) {
+      int u = p[i], v = sides[s].g.to[sides[s].it[u]];
+      sides[s].mate[u] = v;
+      sides[1 - s].mate[v] = u;
+    }
+  }
+
+  // Repeats the search from a node which is free on side s.
+  void augment_from(int s, int u) {
+    if (search(s, u, false)) {
+      flip(s, path);
+      matched++;
+    }
+  }
+
+  bool phase() {
+    side &a = sides[0];
+    std::vector<int> q;
+    bool found = false;
+    for (int u = 0; u < n1; u++) {
+      dist[u] = (a.mate[u] < 0) ? 0 : -1;
+      if (dist[u] == 0) {
+        q.push_back(u);
+      }
+      a.it[u] = a.g.start[u];
+    }
+    for (int j = 0; j < (int)q.size(); j++) {
+      int u = q[j];
+      for (int i = a.g.start[u]; i < a.g.end(u); i++) {
+        int w = sides[1].mate[a.g.to[i]];
+        if (w < 0) {
+          found = true;
+        } else if (dist[w] < 0) {
+          dist[w] = dist[u] + 1;
+          q.push_back(w);
+        }
+      }
+    }
+    if (!found) {
+      return false;
+    }
+    for (int u = 0; u < n1; u++) {
+      if (a.mate[u] < 0 && dist[u] == 0 && search(0, u, true)) {
+        flip(0, path);
+        matched++;
+      }
+    }
+    return true;
+  }
+
+ public:
+  bipartite_matcher(int n1, int n2, const std::vector<std::pair<int, int> > &
+                        edges = std::vector<std::pair<int, int> >())
+      : n1(n1), n2(n2), matched(0), stamp(0), dist(n1) {
+    for (int s = 0; s < 2; s++) {
+      int n = (s == 0) ? n1 : n2;
+      sides[s].g.build(n, edges, s == 1);
+      sides[s].mate.assign(n, -1);
+      sides[s].it.assign(n, 0);
+      sides[s].seen.assign(n, 0);
+      sides[s].dead.assign(n, 0);
+      sides[s].epoch = 1;
+    }
+  }
+
+  // Returns the mate in B of node u in A, or -1 if u is unmatched.
+  int mate_of_a(int u) const {
+    return sides[0].mate[u];
+  }
+
+  // Returns the mate in A of node v in B, or -1 if v is unmatched.
+  int mate_of_b(int v) const {
+    return sides[1].mate[v];
+  }
+
+  int size() const {
+    return matched;
+  }
+
+  // Extends the current matching to a maximum one and returns its size.
+  int solve() {
+    karp_sipser();
+    while (phase()) {}
+    return matched;
+  }
+
+  // Adds the edge u -> v. If the matching was maximum, it is kept maximum by
+  // searching only from u and v, since any augmenting path must use the edge.
+  void add_edge(int u, int v) {
+    sides[0].g.add(u, v);
+    sides[1].g.add(v, u);
+    int r = sides[0].mate[u], w = sides[1].mate[v];
+    // New alternating paths from A step from u to v, then on to w, so nodes
+    // stay dead unless w does not. Likewise for B, from v to u, then to r.
+    if (w < 0 || !dead(0, w)) {
+      sides[0].epoch++;
+    }
+    if (r < 0 || !dead(1, r)) {
+      sides[1].epoch++;
+    }
+    if (r < 0 && w < 0) {
+      match(u, v);
+      matched++;
+    } else if (r < 0) {
+      augment_from(0, u);
+    } else if (w < 0) {
+      augment_from(1, v);
+    } else if (search(0, w, false)) {
+      // The path must also lead from r back to a free node in A. Both halves
+      // are disjoint, or else they would combine into an augmenting path
+      // which existed before the edge was added.
+      std::vector<int> forward(path);
+      if (search(1, r, false)) {
+        flip(0, forward);
+        flip(1, path);
+        match(u, v);
+        matched++;
+      }
+    }
+  }
+
+  // Removes one edge u -> v, returning false if there is no such edge. If the
+  // matching was maximum and the edge was matched, it is repaired by searching
+  // only from u and v, the only nodes which became free.
+  bool remove_edge(int u, int v) {
+    if (!sides[0].g.remove(u, v)) {
+      return false;
+    }
+    sides[1].g.remove(v, u);
+    if (sides[0].mate[u] == v) {
+      sides[0].mate[u] = sides[1].mate[v] = -1;
+      sides[0].epoch++;
+      sides[1].epoch++;
+      matched--;
+      augment_from(0, u);
+      if (sides[0].mate[u] < 0) {
+        augment_from(1, v);
+      }
+    }
+    return true;
+  }
+};
+
 /*** Example Usage and Output:
 
 1 0
@@ -83,6 +434,7 @@ int hopcroft_karp(int n1, int n2) {
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -100,5 +452,19 @@ int main() {
       cout << match[i] << " " << i << endl;
     }
   }
+  vector<pair<int, int> > edges;
+  for (int u = 0; u < n1; u++) {
+    for (int j = 0; j < (int)adj[u].size(); j++) {
+      edges.push_back(make_pair(u, adj[u][j]));
+    }
+  }
+  bipartite_matcher m(n1, n2, edges);
+  assert(m.solve() == 3);
+  assert(m.remove_edge(2, 2) && m.size() == 3);
+  assert(m.remove_edge(2, 3) && m.size() == 2);
+  m.add_edge(2, 1);
+  assert(m.size() == 2);
+  m.add_edge(0, 3);
+  assert(m.size() == 3 && m.mate_of_a(0) == 3 && m.mate_of_b(1) == 2);
   return 0;
 }
@@ -3,12 +3,32 @@
 Given a directed graph, determine a maximal subset of its edges such that no
 node is shared between different edges from the resulting subset.
 
-Time Complexity: O(n^3) on the number of nodes.
-Space Complexity: O(n) auxiliary on the number of nodes.
+general_matcher is a dynamically sized alternative for an undirected graph
+given as a list of edges, stored in compressed sparse row form. It starts from
+a greedy matching, then searches from each free node for an augmenting path by
+a breadth-first search which contracts each odd cycle (blossom) it finds into
+its base. Instead of relabeling every node of a blossom, the nodes point to
+their bases through a disjoint set forest. The depth of every node in the
+search tree lets the common ancestor of the two ends of a blossom be found by
+walking up only as far as it lies. All state is kept in arrays which are
+allocated once, and which are reset between searches by a stamp per node
+instead of being cleared, so that a search costs time only for the part of the
+graph it reaches.
+
+Time Complexity:
+- O(n^3) for edmonds(), where n is the number of nodes.
+- O(n*m*a(n)) for general_matcher::solve(), where m is the number of edges and
+  a(n) is the extremely slow growing inverse of the Ackermann function.
+
+Space Complexity:
+- O(n) auxiliary on the number of nodes for edmonds().
+- O(n + m) for a general_matcher.
 
 */
 
+#include <algorithm>  // std::max(), std::swap()
 #include <queue>
+#include <utility>  // std::pair
 #include <vector>
 
 const int MAXN = 100;
@@ -107,6 +127,159 @@ int edmonds(int nodes) {
   return matches/2;
 }
 
+class general_matcher {
+  int n, stamp;
+  std::vector<int> start, to, match, link, base, depth, seen, q;
+  // label[u] is ODD or EVEN if u is in the current tree, where even nodes are
+  // the root and those reached through a matched edge, valid if seen[u] ==
+  // stamp. Nodes of a contracted blossom share the base found by find().
+  enum { ODD = 0, EVEN = 1 };
+  std::vector<char> label;
+
+  bool in_tree(int u) const {
+    return seen[u] == stamp;
+  }
+
+  void visit(int u, int l, int d) {
+    seen[u] = stamp;
+    label[u] = (char)l;
+    base[u] = u;
+    depth[u] = d;
+  }
+
+  int find(int u) {
+    while (base[u] != u) {
+      u = base[u] = base[base[u]];
+    }
+    return u;
+  }
+
+  int lca(int u, int v) {
+    u = find(u);
+    v = find(v);
+    while (u != v) {
+      if (depth[u] < depth[v]) {
+        std::swap(u, v);
+      }
+      u = find(link[match[u]]);
+    }
+    return u;
+  }
+
+  // Contracts the path from u up to the base b into the blossom of b, where a
+  // path through the blossom is to continue from u across the edge u - v.
+  void contract(int u, int v, int b) {
+    while (find(u) != b) {
+      link[u] = v;
+      v = match[u];
+      if (label[v] == ODD) {
+        label[v] = EVEN;
+        q.push_back(v);
+      }
+      base[u] = base[v] = b;
+      u = link[v];
+    }
+  }
+
+  // Grows an alternating tree from root by breadth-first search, contracting
+  // blossoms as they are found, and flips the first augmenting path found.
+  bool augment(int root) {
+    stamp++;
+    q.clear();
+    visit(root, EVEN, 0);
+    q.push_back(root);
+    for (int i = 0; i < (int)q.size(); i++) {
+      int u = q[i];
+      for (int j = start[u]; j < start[u + 1]; j++) {
+        int v = to[j];
+        if (!in_tree(v)) {
+          visit(v, ODD, depth[u] + 1);
+          link[v] = u;
+          if (match[v] < 0) {
+            for (int x = v, y = u; y >= 0; ) {
+              int next = match[y];
+              match[x] = y;
+              match[y] = x;
+              x = next;
+              y = (x < 0) ? -1 : link[x];
+            }
+            return true;
+          }
+          visit(match[v], EVEN, depth[u] + 2);
+          q.push_back(match[v]);
+        } else if (label[v] == EVEN && find(u) != find(v)) {
+          int b = lca(u, v);
+          contract(u, v, b);
+          contract(v, u, b);
+        }
+      }
+    }
+    return false;
+  }
+
+ public:
+  general_matcher(int nodes, const std::vector<std::pair<int, int> > &edges)
+      : n(nodes), stamp(0), start(nodes + 1, 0), to(2*edges.size()),
+        match(nodes, -1), link(nodes, -1), base(nodes), depth(nodes),
+        seen(nodes, 0), label(nodes) {
+    for (int i = 0; i < (int)edges.size(); i++) {
+      start[edges[i].first + 1]++;
+      start[edges[i].second + 1]++;
+    }
+    for (int u = 0; u < n; u++) {
+      start[u + 1] += start[u];
+    }
+    std::vector<int> pos(start.begin(), start.end() - 1);
+    for (int i = 0; i < (int)edges.size(); i++) {
+      to[pos[edges[i].first]++] = edges[i].second;
+      to[pos[edges[i].second]++] = edges[i].first;
+    }
+    q.reserve(n);
+  }
+
+  int mate(int u) const {
+    return match[u];
+  }
+
+  // Returns the size of a maximum matching, starting from a greedy one which
+  // matches nodes of lower degree first. A node without an augmenting path
+  // never gains one later, so each free node is searched from once.
+  int solve() {
+    // Parallel edges and self-loops can make a degree exceed n.
+    int max_degree = 0;
+    for (int u = 0; u < n; u++) {
+      max_degree = std::max(max_degree, start[u + 1] - start[u]);
+    }
+    std::vector<int> by_degree(n), count(max_degree + 1, 0);
+    for (int u = 0; u < n; u++) {
+      count[start[u + 1] - start[u]]++;
+    }
+    for (int d = 0; d < max_degree; d++) {
+      count[d + 1] += count[d];
+    }
+    for (int u = n - 1; u >= 0; u--) {
+      by_degree[--count[start[u + 1] - start[u]]] = u;
+    }
+    int res = 0;
+    for (int i = 0; i < n; i++) {
+      int u = by_degree[i];
+      for (int j = start[u]; match[u] < 0 && j < start[u + 1]; j++) {
+        if (match[to[j]] < 0 && to[j] != u) {
+          match[u] = to[j];
+          match[to[j]] = u;
+          res++;
+        }
+      }
+    }
+    for (int u = 0; u < n; u++) {
+      if (match[u] < 0 && augment(u)) {
+        res++;
+      }
+    }
+    return res;
+  }
+};
+
 /*** Example Usage and Output:
 
 Matched 2 pair(s). Matchings are:
@@ -115,6 +288,7 @@ Matched 2 pair(s). Matchings are:
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -135,5 +309,23 @@ int main() {
       cout << i << " " << match[i] << endl;
     }
   }
+  // A 5-cycle with a tail: the blossom 0 - 1 - 2 - 3 - 4 must be contracted
+  // to match 5 - 6 and 4 - 0 after greedily matching 0 - 1 and 2 - 3.
+  int e[][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 0}, {2, 5}, {5, 6}};
+  vector<pair<int, int> > edges;
+  for (int i = 0; i < 7; i++) {
+    edges.push_back(make_pair(e[i][0], e[i][1]));
+  }
+  general_matcher m(7, edges);
+  assert(m.solve() == 3);
+  for (int u = 0; u < 7; u++) {
+    assert(m.mate(u) < 0 || m.mate(m.mate(u)) == u);
+  }
+  // Parallel edges and self-loops, giving node 0 a degree above n.
+  vector<pair<int, int> > multi(5, make_pair(0, 1));
+  multi.push_back(make_pair(0, 0));
+  multi.push_back(make_pair(2, 2));
+  general_matcher mm(3, multi);
+  assert(mm.solve() == 1 && mm.mate(2) < 0);
   return 0;
 }
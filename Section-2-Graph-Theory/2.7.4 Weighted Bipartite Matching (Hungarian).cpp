@@ -0,0 +1,199 @@
+/*
+
+Given two sets of nodes A = {0, 1, ..., n - 1} and B = {0, 1, ..., m - 1} such
+that n <= m, as well as an integer cost for matching every node of A to every
+node of B, match every node of A to a distinct node of B such that the total
+cost is minimized. This is also known as the assignment problem.
+
+- hungarian(n, m, cost, res) solves the assignment problem for a cost matrix of
+  n rows and m columns stored in row-major order in the flat array cost[], such
+  that cost[i*m + j] is the cost of matching i in A to j in B. It applies the
+  Hungarian algorithm in the form which adds the rows of the matrix one at a
+  time, maintaining potentials on the rows and columns such that every reduced
+  cost is nonnegative, and growing a tree of tight edges from the new row along
+  the columns until a free column is reached. The loops over the columns of the
+  current row do not branch on the outcome of their comparisons, so that they
+  are vectorized by compilers. The column matched to each row i is stored in
+  res[i], and the minimum total cost is returned.
+- auction(n, start, to, cost, res) solves the assignment problem for a sparse
+  square instance, given as adjacency lists of n nodes in the compressed form
+  where the allowed matches of i in A are to[start[i] .. start[i + 1]) with the
+  respective costs cost[start[i] .. start[i + 1]). Every unmatched i bids for
+  the j which is cheapest after adding its price, raising the price of j by the
+  difference to the second cheapest plus eps, and taking j over from its
+  previous owner. With costs multiplied by n + 1, the matching is optimal once
+  every bid is within eps = 1 of the cheapest. eps starts at the largest cost
+  and is divided by a constant factor between rounds which each keep the prices
+  of the former one, so that most of the work is done while eps is large. A
+  perfect matching must exist among the allowed pairs, or else bidding will not
+  terminate. This is usually much faster than the Hungarian algorithm when every
+  node of A has few allowed matches.
+
+Time Complexity:
+- O(n^2 * m) for hungarian().
+- O(n*e log(n*C)) for auction(), where e is the number of allowed pairs and C
+  is the largest magnitude of a cost.
+
+Space Complexity:
+- O(m) auxiliary for hungarian().
+- O(n) auxiliary for auction().
+
+*/
+
+#include <algorithm>  // std::fill(), std::max(), std::min()
+#include <vector>
+
+const long long INF = 0x3f3f3f3f3f3f3f3fLL;
+
+long long hungarian(int n, int m, const std::vector<long long> &cost,
+                    std::vector<int> &res) {
+  // Row and column 0 are the dummy root of the tree, and p[j] is the row
+  // matched to column j.
+  std::vector<long long> u(n + 1, 0), v(m + 1, 0), minv(m + 1);
+  std::vector<int> p(m + 1, 0), way(m + 1, 0);
+  std::vector<char> used(m + 1);
+  for (int i = 1; i <= n; i++) {
+    p[0] = i;
+    int j0 = 0;
+    std::fill(minv.begin(), minv.end(), INF);
+    std::fill(used.begin(), used.end(), false);
+    do {
+      used[j0] = true;
+      int i0 = p[j0], j1 = 0;
+      long long ui = u[i0], delta = INF;
+      const long long *row = &cost[(long long)(i0 - 1)*m];
+      for (int j = 1; j <= m; j++) {
+        long long cur = row[j - 1] - ui - v[j];
+        bool better = !used[j] && cur < minv[j];
+        minv[j] = better ? cur : minv[j];
+        way[j] = better ? j0 : way[j];
+      }
+      for (int j = 1; j <= m; j++) {
+        if (!used[j] && minv[j] < delta) {
+          delta = minv[j];
+          j1 = j;
+        }
+      }
+      for (int j = 0; j <= m; j++) {
+        long long d = used[j] ? delta : 0;
+        u[p[j]] += d;
+        v[j] -= d;
+        minv[j] -= used[j] ? 0 : delta;
+      }
+      j0 = j1;
+    } while (p[j0] != 0);
+    do {
+      int j1 = way[j0];
+      p[j0] = p[j1];
+      j0 = j1;
+    } while (j0 != 0);
+  }
+  res.assign(n, -1);
+  long long total = 0;
+  for (int j = 1; j <= m; j++) {
+    if (p[j] != 0) {
+      res[p[j] - 1] = j - 1;
+      total += cost[(long long)(p[j] - 1)*m + j - 1];
+    }
+  }
+  return total;
+}
+
+long long auction(int n, const std::vector<int> &start,
+                  const std::vector<int> &to,
+                  const std::vector<long long> &cost, std::vector<int> &res) {
+  static const int ALPHA = 5;
+  long long scale = n + 1, lo = 0, hi = 0;
+  for (int k = 0; k < (int)cost.size(); k++) {
+    lo = std::min(lo, cost[k]*scale);
+    hi = std::max(hi, cost[k]*scale);
+  }
+  // A bid for the only allowed match of a node is raised by the whole range
+  // of costs, since that match can not be taken over anyway.
+  long long span = hi - lo, eps = std::max(1LL, span);
+  std::vector<long long> price(n, 0);
+  std::vector<int> owner(n), q;
+  res.assign(n, -1);
+  do {
+    eps = std::max(1LL, eps/ALPHA);
+    std::fill(owner.begin(), owner.end(), -1);
+    q.clear();
+    for (int i = n - 1; i >= 0; i--) {
+      res[i] = -1;
+      q.push_back(i);
+    }
+    while (!q.empty()) {
+      int i = q.back(), best = -1;
+      q.pop_back();
+      long long c1 = INF, c2 = INF;
+      for (int k = start[i]; k < start[i + 1]; k++) {
+        long long c = cost[k]*scale + price[to[k]];
+        if (c < c1) {
+          c2 = c1;
+          c1 = c;
+          best = to[k];
+        } else if (c < c2) {
+          c2 = c;
+        }
+      }
+      price[best] += ((c2 == INF) ? span : c2 - c1) + eps;
+      if (owner[best] >= 0) {
+        res[owner[best]] = -1;
+        q.push_back(owner[best]);
+      }
+      owner[best] = i;
+      res[i] = best;
+    }
+  } while (eps > 1);
+  long long total = 0;
+  for (int i = 0; i < n; i++) {
+    for (int k = start[i]; k < start[i + 1]; k++) {
+      if (to[k] == res[i]) {
+        total += cost[k];
+        break;
+      }
+    }
+  }
+  return total;
+}
+
+/*** Example Usage and Output:
+
+Minimum cost: 5
+0 -> 1
+1 -> 0
+2 -> 2
+
+***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+int main() {
+  int n = 3, m = 4;
+  long long c[] = {4, 1, 3, 9,
+                   2, 0, 5, 7,
+                   3, 2, 2, 3};
+  vector<long long> cost(c, c + n*m);
+  vector<int> res;
+  cout << "Minimum cost: " << hungarian(n, m, cost, res) << endl;
+  for (int i = 0; i < n; i++) {
+    cout << i << " -> " << res[i] << endl;
+  }
+  // The same instance as a sparse square instance, with column 3 and an extra
+  // row 3 which may only be matched to it.
+  int s[] = {0, 4, 8, 12, 13};
+  vector<int> start(s, s + 5), to;
+  vector<long long> sparse_cost(c, c + n*m);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < m; j++) {
+      to.push_back(j);
+    }
+  }
+  to.push_back(3);
+  sparse_cost.push_back(0);
+  assert(auction(4, start, to, sparse_cost, res) == 5);
+  assert(res[0] == 1 && res[1] == 0 && res[2] == 2 && res[3] == 3);
+  return 0;
+}
@@ -5,14 +5,46 @@ which visits each node exactly once and returns to the starting node. This is
 known as the traveling salesman problem (TSP). Since this implementation uses
 bitmasks with 32-bit ints, the maximum number of nodes must be less than 32.
 
-Time Complexity: O(2^n * n^2) on the number of nodes.
-Space Complexity: O(2^n * n^2) auxiliary on the number of nodes.
+The following functions instead take a distance matrix d[][] of any size, and
+store the order of the nodes along the cycle found, starting from node 0, in
+tour[].
+
+- tsp_layered(d, tour) applies the same dynamic programming over the subsets of
+  the nodes other than 0, but processes them in layers by their number of
+  nodes. Each layer is stored separately, indexed by the rank of each subset
+  among those of the same size, so that the table holds exactly one entry for
+  each subset and end node of the given graph. The ranks of the subsets which
+  precede a given subset in the former layer are all derived from its own rank
+  in O(k) time for a subset of k nodes. The subsets of a layer depend only on
+  the former layer, so the subsets of each layer may be processed in any order.
+- tsp_local_search(d, tour) builds a cycle greedily by always taking the
+  nearest unvisited node, then improves it by 2-opt moves, which replace two
+  edges with two others by reversing the path between them, and Or-opt moves,
+  which move a run of up to three consecutive nodes elsewhere, until no move
+  shortens the cycle. The cycle found is only locally optimal. Since reversing
+  a path changes its length in a directed graph, 2-opt moves are only applied
+  if the distances are symmetric.
+- tsp(d, tour) applies tsp_layered() if there are at most MAX_EXACT = 20 nodes,
+  for which its table takes 40 MB, and tsp_local_search() otherwise.
+
+For an empty graph, all three leave tour empty and return 0.
+
+Time Complexity:
+- O(2^n * n^2) for shortest_hamiltonian_cycle() and tsp_layered(), where n is
+  the number of nodes.
+- O(n^3) per round of improvements for tsp_local_search().
+
+Space Complexity:
+- O(2^n * n^2) auxiliary for shortest_hamiltonian_cycle().
+- O(2^n * n) auxiliary for tsp_layered(), which is also 4*2^(n-1)*(n-1) bytes.
+- O(n) auxiliary for tsp_local_search().
 
 */
 
-#include <algorithm>  // std::fill(), std::min()
+#include <algorithm>  // std::fill(), std::min(), std::reverse()
+#include <vector>
 
-const int MAXN = 20, INF = 0x3f3f3f3f;
+const int MAXN = 20, INF = 0x3f3f3f3f, MAX_EXACT = 20;
 int adj[MAXN][MAXN], dp[1 << MAXN][MAXN], order[MAXN];
 
 int shortest_hamiltonian_cycle(int nodes) {
@@ -58,6 +90,181 @@ void add_edge(int u, int v, int w) {
   adj[v][u] = w;  // Remove this line if the graph is directed.
 }
 
+// The next greater mask with the same number of bits, as in section 4.2.4.
+long long next_combination_mask(long long x) {
+  long long s = x & -x, r = x + s;
+  return r | (((x ^ r) >> 2) / s);
+}
+
+int tsp_layered(const std::vector<std::vector<int> > &d,
+                std::vector<int> &tour) {
+  int n = (int)d.size(), m = n - 1;
+  tour.assign(n > 0, 0);
+  if (n <= 1) {
+    return 0;
+  }
+  // Node 0 starts the cycle, so subsets are over the other m nodes, with bit
+  // p standing for node p + 1. choose[p][t] is p choose t.
+  std::vector<std::vector<int> > choose(m + 1, std::vector<int>(m + 2, 0));
+  for (int p = 0; p <= m; p++) {
+    choose[p][0] = 1;
+    for (int t = 1; t <= p; t++) {
+      choose[p][t] = choose[p - 1][t - 1] + choose[p - 1][t];
+    }
+  }
+  std::vector<std::vector<int> > dp(m + 1);
+  dp[1].assign(m*m, INF);
+  for (int p = 0; p < m; p++) {
+    dp[1][p*m + p] = d[0][p + 1];
+  }
+  std::vector<int> pos(m), rest(m);
+  for (int k = 2; k <= m; k++) {
+    dp[k].assign((long long)choose[m][k]*m, INF);
+    const std::vector<int> &prev = dp[k - 1];
+    long long mask = (1LL << k) - 1;
+    for (int r = 0; r < choose[m][k]; r++, mask = next_combination_mask(mask)) {
+      int t = 0;
+      for (long long x = mask; x != 0; x &= x - 1) {
+        pos[t++] = __builtin_ctzll(x);
+      }
+      // Set rest[t] to the rank of the mask without its t-th lowest bit, where
+      // the rank of the bits p[0] < p[1] < ... is the sum of p[t] choose t + 1.
+      int acc = 0;
+      for (t = k - 1; t >= 0; t--) {
+        rest[t] = acc;
+        acc += choose[pos[t]][t];
+      }
+      acc = 0;
+      for (t = 0; t < k; t++) {
+        rest[t] += acc;
+        acc += choose[pos[t]][t + 1];
+      }
+      int *cur = &dp[k][(long long)r*m];
+      for (t = 0; t < k; t++) {
+        int e = pos[t], best = INF;
+        const int *src = &prev[(long long)rest[t]*m];
+        for (int s = 0; s < k; s++) {
+          if (s != t) {
+            best = std::min(best, src[pos[s]] + d[pos[s] + 1][e + 1]);
+          }
+        }
+        cur[e] = best;
+      }
+    }
+  }
+  int res = INF + INF, e = 0;
+  for (int p = 0; p < m; p++) {
+    if (dp[m][p] + d[p + 1][0] < res) {
+      res = dp[m][p] + d[p + 1][0];
+      e = p;
+    }
+  }
+  long long mask = (1LL << m) - 1;
+  for (int k = m; k > 1; k--) {
+    tour.push_back(e + 1);
+    long long prev_mask = mask ^ (1LL << e);
+    int r = 0, r_prev = 0, t = 0;
+    for (long long x = mask; x != 0; x &= x - 1) {
+      r += choose[__builtin_ctzll(x)][++t];
+    }
+    t = 0;
+    for (long long x = prev_mask; x != 0; x &= x - 1) {
+      r_prev += choose[__builtin_ctzll(x)][++t];
+    }
+    for (long long x = prev_mask; x != 0; x &= x - 1) {
+      int j = __builtin_ctzll(x);
+      if (dp[k - 1][(long long)r_prev*m + j] + d[j + 1][e + 1] ==
+          dp[k][(long long)r*m + e]) {
+        e = j;
+        break;
+      }
+    }
+    mask = prev_mask;
+  }
+  tour.push_back(e + 1);
+  std::reverse(tour.begin() + 1, tour.end());
+  return res;
+}
+
+int tour_length(const std::vector<std::vector<int> > &d,
+                const std::vector<int> &tour) {
+  int n = (int)tour.size(), res = 0;
+  for (int i = 0; i < n; i++) {
+    res += d[tour[i]][tour[(i + 1) % n]];
+  }
+  return res;
+}
+
+int tsp_local_search(const std::vector<std::vector<int> > &d,
+                     std::vector<int> &tour) {
+  int n = (int)d.size();
+  bool symmetric = true;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < i; j++) {
+      symmetric &= (d[i][j] == d[j][i]);
+    }
+  }
+  tour.clear();
+  if (n == 0) {
+    return 0;
+  }
+  std::vector<char> visited(n, false);
+  tour.assign(1, 0);
+  visited[0] = true;
+  for (int i = 1; i < n; i++) {
+    int u = tour.back(), best = -1;
+    for (int v = 0; v < n; v++) {
+      if (!visited[v] && (best < 0 || d[u][v] < d[u][best])) {
+        best = v;
+      }
+    }
+    visited[best] = true;
+    tour.push_back(best);
+  }
+  for (bool improved = (n > 3); improved;) {
+    improved = false;
+    // 2-opt: replace edges a -> b and c -> e with a -> c and b -> e.
+    for (int i = 0; symmetric && i + 2 < n; i++) {
+      for (int j = i + 2; j < n && !(i == 0 && j == n - 1); j++) {
+        int a = tour[i], b = tour[i + 1], c = tour[j], e = tour[(j + 1) % n];
+        if (d[a][c] + d[b][e] < d[a][b] + d[c][e]) {
+          std::reverse(tour.begin() + i + 1, tour.begin() + j + 1);
+          improved = true;
+        }
+      }
+    }
+    // Or-opt: move a run of up to 3 consecutive nodes between two others.
+    for (int len = 1; len <= 3 && len + 2 <= n; len++) {
+      for (int i = 1; i + len <= n; i++) {
+        int p = tour[i - 1], s = tour[i], t = tour[i + len - 1];
+        int q = tour[(i + len) % n];
+        int gain = d[p][s] + d[t][q] - d[p][q];
+        for (int j = 0; j < n; j++) {
+          int x = tour[j], y = tour[(j + 1) % n];
+          if ((j >= i - 1 && j < i + len) || d[x][s] + d[t][y] - d[x][y] >=
+                                                 gain) {
+            continue;
+          }
+          std::vector<int> run(tour.begin() + i, tour.begin() + i + len);
+          tour.erase(tour.begin() + i, tour.begin() + i + len);
+          int at = (j < i) ? j + 1 : j + 1 - len;
+          tour.insert(tour.begin() + at, run.begin(), run.end());
+          improved = true;
+          break;
+        }
+      }
+    }
+  }
+  return tour_length(d, tour);
+}
+
+int tsp(const std::vector<std::vector<int> > &d, std::vector<int> &tour) {
+  if ((int)d.size() <= MAX_EXACT) {
+    return tsp_layered(d, tour);
+  }
+  return tsp_local_search(d, tour);
+}
+
 /*** Example Usage and Output:
 
 The shortest hamiltonian cycle has length 5.
@@ -65,6 +272,7 @@ Take the path: 0->3->2->4->1->0.
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -87,5 +295,17 @@ int main() {
     cout << order[i] << "->";
   }
   cout << order[0] << "." << endl;
+  vector<vector<int> > d(nodes, vector<int>(nodes));
+  for (int i = 0; i < nodes; i++) {
+    for (int j = 0; j < nodes; j++) {
+      d[i][j] = adj[i][j];
+    }
+  }
+  vector<int> tour;
+  assert(tsp(d, tour) == 5 && tour_length(d, tour) == 5);
+  assert(tsp_local_search(d, tour) == 5);
+  vector<vector<int> > none;
+  assert(tsp(none, tour) == 0 && tour.empty());
+  assert(tsp_local_search(none, tour) == 0 && tour.empty());
   return 0;
 }
@@ -5,12 +5,28 @@ which visits each node exactly once. Unlike the travelling salesman problem, we
 do not have to return to the starting vertex. Since this implementation uses
 bitmasks with 32-bit ints, the maximum number of nodes must be less than 32.
 
+hamiltonian_path_layered(d, path) instead takes a distance matrix d[][] of any
+size, and stores the order of the nodes along the path found in path[]. The
+subsets of nodes are processed in layers by their number of nodes, each stored
+separately and indexed by the rank of each subset among those of its size, so
+that the table holds exactly one entry for each subset and end node of the
+given graph. The ranks of the subsets which precede a given subset in the
+former layer are all derived from its own rank in O(k) time for a subset of k
+nodes. The subsets of a layer depend only on the former layer, so the subsets
+of each layer may be processed in any order. For larger graphs, a short path is
+found by tsp_local_search() of section 2.8.1 after adding a node at distance 0
+to and from every other node, then starting the path after that node. For an
+empty graph, path is left empty and 0 is returned.
+
 Time Complexity: O(2^n * n^2) on the number of nodes.
-Space Complexity: O(2^n * n^2) on the number of nodes.
+Space Complexity:
+- O(2^n * n^2) for shortest_hamiltonian_path().
+- O(2^n * n) for hamiltonian_path_layered(), which is also 4*2^n*n bytes.
 
 */
 
-#include <algorithm>  // std::fill(), std::min()
+#include <algorithm>  // std::fill(), std::min(), std::reverse()
+#include <vector>
 
 const int MAXN = 20, INF = 0x3f3f3f3f;
 int adj[MAXN][MAXN], dp[1 << MAXN][MAXN], order[MAXN];
@@ -55,6 +71,102 @@ int shortest_hamiltonian_path(int nodes) {
   return res;
 }
 
+// The next greater mask with the same number of bits, as in section 4.2.4.
+long long next_combination_mask(long long x) {
+  long long s = x & -x, r = x + s;
+  return r | (((x ^ r) >> 2) / s);
+}
+
+int hamiltonian_path_layered(const std::vector<std::vector<int> > &d,
+                             std::vector<int> &path) {
+  int n = (int)d.size();
+  path.clear();
+  if (n == 0) {
+    return 0;
+  }
+  // choose[p][t] is p choose t.
+  std::vector<std::vector<int> > choose(n + 1, std::vector<int>(n + 2, 0));
+  for (int p = 0; p <= n; p++) {
+    choose[p][0] = 1;
+    for (int t = 1; t <= p; t++) {
+      choose[p][t] = choose[p - 1][t - 1] + choose[p - 1][t];
+    }
+  }
+  std::vector<std::vector<int> > dp(n + 1);
+  dp[1].assign(n*n, INF);
+  for (int p = 0; p < n; p++) {
+    dp[1][p*n + p] = 0;
+  }
+  std::vector<int> pos(n), rest(n);
+  for (int k = 2; k <= n; k++) {
+    dp[k].assign((long long)choose[n][k]*n, INF);
+    const std::vector<int> &prev = dp[k - 1];
+    long long mask = (1LL << k) - 1;
+    for (int r = 0; r < choose[n][k]; r++, mask = next_combination_mask(mask)) {
+      int t = 0;
+      for (long long x = mask; x != 0; x &= x - 1) {
+        pos[t++] = __builtin_ctzll(x);
+      }
+      // Set rest[t] to the rank of the mask without its t-th lowest bit, where
+      // the rank of the bits p[0] < p[1] < ... is the sum of p[t] choose t + 1.
+      int acc = 0;
+      for (t = k - 1; t >= 0; t--) {
+        rest[t] = acc;
+        acc += choose[pos[t]][t];
+      }
+      acc = 0;
+      for (t = 0; t < k; t++) {
+        rest[t] += acc;
+        acc += choose[pos[t]][t + 1];
+      }
+      int *cur = &dp[k][(long long)r*n];
+      for (t = 0; t < k; t++) {
+        int e = pos[t], best = INF;
+        const int *src = &prev[(long long)rest[t]*n];
+        for (int s = 0; s < k; s++) {
+          if (s != t) {
+            best = std::min(best, src[pos[s]] + d[pos[s]][e]);
+          }
+        }
+        cur[e] = best;
+      }
+    }
+  }
+  int res = INF, e = 0;
+  for (int p = 0; p < n; p++) {
+    if (dp[n][p] < res) {
+      res = dp[n][p];
+      e = p;
+    }
+  }
+  path.clear();
+  long long mask = (1LL << n) - 1;
+  for (int k = n; k > 1; k--) {
+    path.push_back(e);
+    long long prev_mask = mask ^ (1LL << e);
+    int r = 0, r_prev = 0, t = 0;
+    for (long long x = mask; x != 0; x &= x - 1) {
+      r += choose[__builtin_ctzll(x)][++t];
+    }
+    t = 0;
+    for (long long x = prev_mask; x != 0; x &= x - 1) {
+      r_prev += choose[__builtin_ctzll(x)][++t];
+    }
+    for (long long x = prev_mask; x != 0; x &= x - 1) {
+      int j = __builtin_ctzll(x);
+      if (dp[k - 1][(long long)r_prev*n + j] + d[j][e] ==
+          dp[k][(long long)r*n + e]) {
+        e = j;
+        break;
+      }
+    }
+    mask = prev_mask;
+  }
+  path.push_back(e);
+  std::reverse(path.begin(), path.end());
+  return res;
+}
+
 /*** Example Usage and Output:
 
 The shortest hamiltonian path has length 3.
@@ -62,6 +174,7 @@ Take the path: 0->1->2.
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -80,5 +193,16 @@ int main() {
     cout << "->" << order[i];
   }
   cout << "." << endl;
+  vector<vector<int> > d(nodes, vector<int>(nodes));
+  for (int i = 0; i < nodes; i++) {
+    for (int j = 0; j < nodes; j++) {
+      d[i][j] = adj[i][j];
+    }
+  }
+  vector<int> path;
+  assert(hamiltonian_path_layered(d, path) == 3);
+  assert(path[0] == 0 && path[1] == 1 && path[2] == 2);
+  vector<vector<int> > none;
+  assert(hamiltonian_path_layered(none, path) == 0 && path.empty());
   return 0;
 }
@@ -0,0 +1,399 @@
+/*
+
+Benchmark harness for the graph algorithms of this section on large synthetic
+graphs. Each implementation is compiled straight from its own file, which is
+included into a namespace of its own so that the globals and example main() of
+different files do not clash. This requires every standard header used by the
+included files to be included beforehand, so that their include guards keep
+them out of the namespaces.
+
+The graphs are generated at a scale of 2^s nodes, for s given as the first
+program argument (16 by default):
+
+- R-MAT: 16*2^s directed edges, each placed by recursively choosing one of the
+  four quadrants of the adjacency matrix with probabilities 0.57, 0.19, 0.19 and
+  0.05. The result has the skewed degrees and small diameter of social graphs.
+- grid: a square grid of undirected edges between horizontal and vertical
+  neighbors, with a large diameter and uniform degrees.
+- random regular: 8 undirected edges per node, by pairing up 8 copies of each
+  node in random order (the configuration model) and dropping self-loops.
+- road-like: a square grid from which 20% of the edges are dropped, with edge
+  weights proportional to length plus noise, and a sparse set of cheaper long
+  range highways between nodes up to 32 cells apart.
+
+Every algorithm is run on every graph. The time to build its data structures
+from an edge list is reported separately from the time to run it. The peak
+resident memory of the process after each run is read from getrusage() where
+available, or reported as -1 otherwise. Since the memory of earlier runs is
+counted as well, it is only an upper bound for any single run. The results are
+printed as a JSON array with one object per run, with the number of edges
+processed per second of running time and a result (such as the size of a
+matching) to check that different implementations agree.
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef __unix__
+#include <sys/resource.h>  // getrusage()
+#endif
+
+namespace bfs_2_2_1 {
+#include "2.2.1 Shortest Path (BFS).cpp"
+}
+namespace dijkstra_2_2_2 {
+#include "2.2.2 Shortest Path (Dijkstra's).cpp"
+}
+namespace tarjan_2_3_2 {
+#include "2.3.2 Strongly Connected Components (Tarjan's).cpp"
+}
+namespace kruskal_2_4_2 {
+#include "2.4.2 Minimal Spanning Tree (Kruskal's).cpp"
+}
+namespace dinic_2_5_3 {
+#include "2.5.3 Max Flow (Dinic's).cpp"
+}
+namespace push_relabel_2_5_4 {
+#include "2.5.4 Max Flow (Push-Relabel).cpp"
+}
+namespace hopcroft_karp_2_7_2 {
+#include "2.7.2 Maximum Bipartite Matching (Hopcroft-Karp).cpp"
+}
+namespace edmonds_2_7_3 {
+#include "2.7.3 Maximum Graph Matching (Edmonds's).cpp"
+}
+
+// SplitMix64, so that the graphs do not depend on the platform's rand().
+class splitmix64 {
+  unsigned long long state;
+
+ public:
+  splitmix64(unsigned long long seed) : state(seed) {}
+
+  unsigned long long next() {
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  // Returns a uniformly random integer in [0, n).
+  int below(int n) {
+    return (int)(next() % (unsigned long long)n);
+  }
+
+  double uniform() {
+    return (next() >> 11)*(1.0/9007199254740992.0);
+  }
+};
+
+struct input_edge {
+  int u, v, w;
+
+  input_edge(int u, int v, int w) : u(u), v(v), w(w) {}
+};
+
+struct input_graph {
+  std::string name;
+  int nodes;
+  bool directed;
+  std::vector<input_edge> edges;
+
+  // Returns the edges in both directions unless the graph is directed.
+  std::vector<input_edge> arcs() const {
+    std::vector<input_edge> res(edges);
+    if (!directed) {
+      for (int i = 0; i < (int)edges.size(); i++) {
+        res.push_back(input_edge(edges[i].v, edges[i].u, edges[i].w));
+      }
+    }
+    return res;
+  }
+};
+
+input_graph rmat(int scale, splitmix64 &rng) {
+  input_graph g;
+  g.name = "rmat";
+  g.nodes = 1 << scale;
+  g.directed = true;
+  long long m = 16LL << scale;
+  for (long long i = 0; i < m; i++) {
+    int u = 0, v = 0;
+    for (int bit = 0; bit < scale; bit++) {
+      double r = rng.uniform();
+      if (r >= 0.57) {
+        if (r < 0.76) {
+          v |= 1 << bit;
+        } else if (r < 0.95) {
+          u |= 1 << bit;
+        } else {
+          u |= 1 << bit;
+          v |= 1 << bit;
+        }
+      }
+    }
+    g.edges.push_back(input_edge(u, v, 1 + rng.below(255)));
+  }
+  return g;
+}
+
+input_graph grid(int scale, splitmix64 &rng) {
+  input_graph g;
+  g.name = "grid";
+  int side = 1 << (scale/2);
+  g.nodes = side*side;
+  g.directed = false;
+  for (int r = 0; r < side; r++) {
+    for (int c = 0; c < side; c++) {
+      int u = r*side + c;
+      if (c + 1 < side) {
+        g.edges.push_back(input_edge(u, u + 1, 1 + rng.below(255)));
+      }
+      if (r + 1 < side) {
+        g.edges.push_back(input_edge(u, u + side, 1 + rng.below(255)));
+      }
+    }
+  }
+  return g;
+}
+
+input_graph random_regular(int scale, splitmix64 &rng) {
+  static const int DEGREE = 8;
+  input_graph g;
+  g.name = "random_regular";
+  g.nodes = 1 << scale;
+  g.directed = false;
+  std::vector<int> stubs;
+  for (int u = 0; u < g.nodes; u++) {
+    stubs.insert(stubs.end(), DEGREE, u);
+  }
+  for (int i = (int)stubs.size() - 1; i > 0; i--) {
+    std::swap(stubs[i], stubs[rng.below(i + 1)]);
+  }
+  for (int i = 0; i + 1 < (int)stubs.size(); i += 2) {
+    if (stubs[i] != stubs[i + 1]) {
+      g.edges.push_back(input_edge(stubs[i], stubs[i + 1],
+                                   1 + rng.below(255)));
+    }
+  }
+  return g;
+}
+
+input_graph road_like(int scale, splitmix64 &rng) {
+  static const int BLOCK = 100, REACH = 32;
+  input_graph g;
+  g.name = "road_like";
+  int side = 1 << (scale/2);
+  g.nodes = side*side;
+  g.directed = false;
+  for (int r = 0; r < side; r++) {
+    for (int c = 0; c < side; c++) {
+      int u = r*side + c;
+      if (c + 1 < side && rng.below(5) != 0) {
+        g.edges.push_back(input_edge(u, u + 1, BLOCK + rng.below(BLOCK)));
+      }
+      if (r + 1 < side && rng.below(5) != 0) {
+        g.edges.push_back(input_edge(u, u + side, BLOCK + rng.below(BLOCK)));
+      }
+      if (rng.below(100) == 0) {
+        int r2 = std::min(side - 1, r + rng.below(REACH));
+        int c2 = std::min(side - 1, c + rng.below(REACH));
+        int len = (r2 - r) + (c2 - c);
+        if (len > 0) {
+          g.edges.push_back(input_edge(u, r2*side + c2, len*BLOCK/2));
+        }
+      }
+    }
+  }
+  return g;
+}
+
+long long peak_memory_kb() {
+#ifdef __unix__
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return usage.ru_maxrss;
+  }
+#endif
+  return -1;
+}
+
+double seconds_since(std::clock_t start) {
+  return (double)(std::clock() - start)/CLOCKS_PER_SEC;
+}
+
+bool first_row = true;
+
+void report(const input_graph &g, const char *algorithm, double build,
+            double run, long long result) {
+  std::cout << (first_row ? "" : ",\n");
+  std::cout << "{\"graph\": \"" << g.name << "\", \"nodes\": " << g.nodes
+            << ", \"edges\": " << g.edges.size() << ", \"algorithm\": \""
+            << algorithm << "\", \"build_seconds\": " << build
+            << ", \"run_seconds\": " << run << ", \"edges_per_second\": "
+            << (run > 0 ? (double)g.edges.size()/run : 0.0)
+            << ", \"peak_memory_kb\": " << peak_memory_kb()
+            << ", \"result\": " << result << "}";
+  first_row = false;
+}
+
+void benchmark_bfs(const input_graph &g) {
+  std::clock_t start = std::clock();
+  std::vector<input_edge> arcs = g.arcs();
+  std::vector<std::vector<int> > adj(g.nodes);
+  for (int i = 0; i < (int)arcs.size(); i++) {
+    adj[arcs[i].u].push_back(arcs[i].v);
+  }
+  bfs_2_2_1::bfs_engine engine(g.nodes, &adj[0]);
+  double build = seconds_since(start);
+  start = std::clock();
+  engine.bfs(0);
+  double run = seconds_since(start);
+  long long reached = 0;
+  for (int u = 0; u < g.nodes; u++) {
+    reached += (engine.dist[u] != bfs_2_2_1::INF);
+  }
+  report(g, "bfs_engine", build, run, reached);
+}
+
+template<class Queue>
+void benchmark_dijkstra(const input_graph &g, const char *name) {
+  std::clock_t start = std::clock();
+  std::vector<input_edge> arcs = g.arcs();
+  std::vector<std::vector<std::pair<int, int> > > adj(g.nodes);
+  for (int i = 0; i < (int)arcs.size(); i++) {
+    adj[arcs[i].u].push_back(std::make_pair(arcs[i].v, arcs[i].w));
+  }
+  dijkstra_2_2_2::dijkstra_engine<Queue> engine(g.nodes, &adj[0]);
+  double build = seconds_since(start);
+  start = std::clock();
+  engine.run(0);
+  double run = seconds_since(start);
+  long long total = 0;
+  for (int u = 0; u < g.nodes; u++) {
+    if (engine.dist[u] != dijkstra_2_2_2::INF) {
+      total += engine.dist[u];
+    }
+  }
+  report(g, name, build, run, total);
+}
+
+void benchmark_scc(const input_graph &g) {
+  std::clock_t start = std::clock();
+  std::vector<input_edge> arcs = g.arcs();
+  std::vector<int> first(g.nodes + 1, 0), to(arcs.size());
+  for (int i = 0; i < (int)arcs.size(); i++) {
+    first[arcs[i].u + 1]++;
+  }
+  for (int u = 0; u < g.nodes; u++) {
+    first[u + 1] += first[u];
+  }
+  std::vector<int> pos(first.begin(), first.end() - 1);
+  for (int i = 0; i < (int)arcs.size(); i++) {
+    to[pos[arcs[i].u]++] = arcs[i].v;
+  }
+  // Keep a valid pointer for graphs without edges.
+  to.push_back(0);
+  tarjan_2_3_2::scc_engine engine(g.nodes, &first[0], &to[0]);
+  double build = seconds_since(start);
+  start = std::clock();
+  int res = engine.run();
+  report(g, "scc_engine::run", build, seconds_since(start), res);
+  start = std::clock();
+  res = engine.run_forward_backward();
+  report(g, "scc_engine::run_forward_backward", 0, seconds_since(start), res);
+}
+
+void benchmark_mst(const input_graph &g) {
+  using kruskal_2_4_2::weighted_edge;
+  std::clock_t start = std::clock();
+  std::vector<weighted_edge> e, res;
+  for (int i = 0; i < (int)g.edges.size(); i++) {
+    e.push_back(weighted_edge(g.edges[i].u, g.edges[i].v, g.edges[i].w));
+  }
+  double build = seconds_since(start);
+  std::vector<weighted_edge> copy(e);
+  start = std::clock();
+  long long w = kruskal_2_4_2::filter_kruskal(g.nodes, copy, res);
+  report(g, "filter_kruskal", build, seconds_since(start), w);
+  start = std::clock();
+  w = kruskal_2_4_2::boruvka(g.nodes, e, res);
+  report(g, "boruvka", build, seconds_since(start), w);
+}
+
+template<class Flow>
+void benchmark_flow(const input_graph &g, const char *name) {
+  std::clock_t start = std::clock();
+  Flow f(g.nodes);
+  for (int i = 0; i < (int)g.edges.size(); i++) {
+    f.add_edge(g.edges[i].u, g.edges[i].v, g.edges[i].w);
+    if (!g.directed) {
+      f.add_edge(g.edges[i].v, g.edges[i].u, g.edges[i].w);
+    }
+  }
+  double build = seconds_since(start);
+  start = std::clock();
+  long long flow = f.max_flow(0, g.nodes - 1);
+  report(g, name, build, seconds_since(start), flow);
+}
+
+void benchmark_matching(const input_graph &g) {
+  std::clock_t start = std::clock();
+  std::vector<std::pair<int, int> > e;
+  for (int i = 0; i < (int)g.edges.size(); i++) {
+    if (g.edges[i].u != g.edges[i].v) {
+      e.push_back(std::make_pair(g.edges[i].u, g.edges[i].v));
+    }
+  }
+  edmonds_2_7_3::general_matcher general(g.nodes, e);
+  double build = seconds_since(start);
+  start = std::clock();
+  int res = general.solve();
+  report(g, "general_matcher", build, seconds_since(start), res);
+  // The bipartite double cover, matching the tails of edges to their heads.
+  start = std::clock();
+  hopcroft_karp_2_7_2::bipartite_matcher bipartite(g.nodes, g.nodes, e);
+  build = seconds_since(start);
+  start = std::clock();
+  res = bipartite.solve();
+  report(g, "bipartite_matcher", build, seconds_since(start), res);
+}
+
+/*** Example Usage ***/
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+  int scale = (argc > 1) ? atoi(argv[1]) : 16;
+  assert(scale >= 2 && scale <= 26);
+  splitmix64 rng(12345);
+  cout.precision(6);
+  cout << "[\n";
+  for (int kind = 0; kind < 4; kind++) {
+    input_graph g;
+    switch (kind) {
+      case 0: g = rmat(scale, rng); break;
+      case 1: g = grid(scale, rng); break;
+      case 2: g = random_regular(scale, rng); break;
+      case 3: g = road_like(scale, rng); break;
+    }
+    benchmark_bfs(g);
+    benchmark_dijkstra<dijkstra_2_2_2::dary_heap>(g, "dijkstra_engine<dary_heap>");
+    benchmark_dijkstra<dijkstra_2_2_2::radix_heap>(g, "dijkstra_engine<radix_heap>");
+    benchmark_dijkstra<dijkstra_2_2_2::dial_buckets>(g, "dijkstra_engine<dial_buckets>");
+    benchmark_scc(g);
+    benchmark_mst(g);
+    benchmark_flow<dinic_2_5_3::dinic_flow>(g, "dinic_flow");
+    benchmark_flow<push_relabel_2_5_4::hlpp_flow>(g, "hlpp_flow");
+    benchmark_matching(g);
+  }
+  cout << "\n]" << endl;
+  return 0;
+}
@@ -17,6 +17,21 @@ key types for std::map).
 A precondition to the last three operations is that make_set() must have been
 previously called on their arguments.
 
+rollback_disjoint_sets is a variant on the dense ids 0 to n - 1 which can undo
+its unions. It applies union-by-rank without path compression, so each union
+changes a constant number of entries which are recorded on a stack, and the
+height of each tree stays at most log n. rollback(s) pops the stack back to the
+size s returned by an earlier call to snapshot().
+
+offline_connectivity answers connectivity queries on a graph whose edges are
+both inserted and deleted (e.g. a sliding window of edges), given all of the
+operations in advance. Each edge is alive for an interval of the sequence of
+operations, which is split into the O(log t) nodes of a segment tree over the
+t operations which cover it. A depth-first traversal of the segment tree
+unites the endpoints of the edges of each node when entering it and rolls them
+back when leaving it, so that the queries at each leaf see exactly the edges
+alive at their time.
+
 Time Complexity:
 - O(1) per call to the constructor.
 - O(log n) per call to make_set(), where n is the number of elements that have
@@ -26,15 +41,23 @@ Time Complexity:
   slow growing inverse of the Ackermann function (effectively a very small
   constant for all practical values of n).
 - O(n) per call to get_all_sets().
+- O(log n) per call to find_root(), is_united(), and unite() of a
+  rollback_disjoint_sets, and O(1) amortized per union undone by rollback().
+- O(log k) per call to add_edge() and remove_edge() of an offline_connectivity,
+  where k is the number of distinct edges, and O(1) per query.
+- O(t log t log n) for solve(), where t is the number of operations.
 
 Space Complexity:
 - O(n) for storage of the disjoint set forest elements.
 - O(n) auxiliary per call to get_all_sets().
+- O(t log t) auxiliary for solve().
 - O(1) auxiliary per call to all other operations.
 
 */
 
+#include <algorithm>  // std::swap()
 #include <map>
+#include <utility>  // std::make_pair(), std::pair
 #include <vector>
 
 template<class T> class disjoint_set_forest {
@@ -108,6 +131,186 @@ template<class T> class disjoint_set_forest {
   }
 };
 
+// A disjoint set forest over the dense ids 0 to n - 1 with union-by-rank but
+// without path compression, so that every unite() changes O(1) entries and can
+// be undone exactly. rollback(s) undoes all unions since snapshot() returned s.
+class rollback_disjoint_sets {
+  std::vector<int> root, rank;
+  // For each union, the root which was attached and whether the rank of the
+  // other root was incremented.
+  std::vector<std::pair<int, bool> > history;
+  int num_sets;
+
+ public:
+  rollback_disjoint_sets(int n) : root(n), rank(n, 0), num_sets(n) {
+    for (int i = 0; i < n; i++) {
+      root[i] = i;
+    }
+  }
+
+  int sets() const {
+    return num_sets;
+  }
+
+  int find_root(int x) const {
+    while (root[x] != x) {
+      x = root[x];
+    }
+    return x;
+  }
+
+  bool is_united(int x, int y) const {
+    return find_root(x) == find_root(y);
+  }
+
+  bool unite(int x, int y) {
+    int r1 = find_root(x), r2 = find_root(y);
+    if (r1 == r2) {
+      return false;
+    }
+    if (rank[r1] < rank[r2]) {
+      std::swap(r1, r2);
+    }
+    bool grew = (rank[r1] == rank[r2]);
+    root[r2] = r1;
+    rank[r1] += grew;
+    history.push_back(std::make_pair(r2, grew));
+    num_sets--;
+    return true;
+  }
+
+  int snapshot() const {
+    return (int)history.size();
+  }
+
+  void rollback(int s) {
+    while ((int)history.size() > s) {
+      int r = history.back().first;
+      rank[root[r]] -= history.back().second;
+      root[r] = r;
+      history.pop_back();
+      num_sets++;
+    }
+  }
+};
+
+// Answers connectivity queries on a graph of n nodes whose edges are inserted
+// and deleted over time, offline. Operations are recorded in order, and each
+// edge is alive over an interval of operations from its insertion to its
+// deletion (or the end). Each interval is stored in the O(log t) nodes of a
+// segment tree over the t operations that cover it. A depth-first traversal of
+// the tree unites the edges of each node on entry and rolls them back on exit,
+// so that at each leaf the forest holds exactly the edges alive at that time.
+class offline_connectivity {
+  int n;
+  // The operations in order: (u, v) to ask whether u and v are connected,
+  // (-1, -2) to ask for the number of components, or (-1, -1) for an update.
+  std::vector<std::pair<int, int> > queries;
+  std::map<std::pair<int, int>, std::vector<int> > open;
+  std::vector<std::vector<std::pair<int, int> > > tree;
+  std::vector<std::pair<std::pair<int, int>, std::pair<int, int> > > spans;
+
+  static std::pair<int, int> key(int u, int v) {
+    return (u < v) ? std::make_pair(u, v) : std::make_pair(v, u);
+  }
+
+  void insert(int i, int lo, int hi, int a, int b,
+              const std::pair<int, int> &e) {
+    if (b <= lo || hi <= a) {
+      return;
+    }
+    if (a <= lo && hi <= b) {
+      tree[i].push_back(e);
+      return;
+    }
+    int mid = lo + (hi - lo)/2;
+    insert(2*i + 1, lo, mid, a, b, e);
+    insert(2*i + 2, mid, hi, a, b, e);
+  }
+
+  void traverse(int i, int lo, int hi, rollback_disjoint_sets &dsf,
+                std::vector<int> &res) {
+    int s = dsf.snapshot();
+    for (int j = 0; j < (int)tree[i].size(); j++) {
+      dsf.unite(tree[i][j].first, tree[i][j].second);
+    }
+    if (hi - lo == 1) {
+      if (queries[lo].first >= 0) {
+        res.push_back(dsf.is_united(queries[lo].first, queries[lo].second));
+      } else if (queries[lo].second == -2) {
+        res.push_back(dsf.sets());
+      }
+    } else {
+      int mid = lo + (hi - lo)/2;
+      traverse(2*i + 1, lo, mid, dsf, res);
+      traverse(2*i + 2, mid, hi, dsf, res);
+    }
+    dsf.rollback(s);
+  }
+
+ public:
+  offline_connectivity(int nodes) : n(nodes) {}
+
+  // Inserts the undirected edge u - v. Parallel edges are allowed.
+  void add_edge(int u, int v) {
+    open[key(u, v)].push_back((int)queries.size());
+    queries.push_back(std::make_pair(-1, -1));
+  }
+
+  // Deletes one copy of the edge u - v, returning false if there is none.
+  bool remove_edge(int u, int v) {
+    std::map<std::pair<int, int>, std::vector<int> >::iterator it =
+        open.find(key(u, v));
+    if (it == open.end()) {
+      return false;
+    }
+    int t = (int)queries.size();
+    spans.push_back(std::make_pair(it->first,
+                                   std::make_pair(it->second.back(), t)));
+    it->second.pop_back();
+    if (it->second.empty()) {
+      open.erase(it);
+    }
+    queries.push_back(std::make_pair(-1, -1));
+    return true;
+  }
+
+  // Asks whether u and v are connected at this point.
+  void query(int u, int v) {
+    queries.push_back(std::make_pair(u, v));
+  }
+
+  // Asks for the number of connected components at this point.
+  void query_components() {
+    queries.push_back(std::make_pair(-1, -2));
+  }
+
+  // Returns the answers to the queries in the order they were asked, where
+  // connectivity queries are answered with 1 or 0.
+  std::vector<int> solve() {
+    int t = (int)queries.size();
+    std::vector<int> res;
+    if (t == 0) {
+      return res;
+    }
+    tree.assign(4*t, std::vector<std::pair<int, int> >());
+    for (int i = 0; i < (int)spans.size(); i++) {
+      insert(0, 0, t, spans[i].second.first, spans[i].second.second,
+             spans[i].first);
+    }
+    std::map<std::pair<int, int>, std::vector<int> >::iterator it;
+    for (it = open.begin(); it != open.end(); ++it) {
+      for (int j = 0; j < (int)it->second.size(); j++) {
+        insert(0, 0, t, it->second[j], t, it->first);
+      }
+    }
+    rollback_disjoint_sets dsf(n);
+    traverse(0, 0, t, dsf, res);
+    tree.clear();
+    return res;
+  }
+};
+
 /*** Example Usage and Output:
 
 7 elements in 3 set:
@@ -115,6 +318,7 @@ template<class T> class disjoint_set_forest {
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -138,5 +342,19 @@ int main() {
     cout << "]";
   }
   cout << endl;
+
+  offline_connectivity g(4);
+  g.add_edge(0, 1);
+  g.add_edge(1, 2);
+  g.query(0, 2);
+  g.query_components();
+  g.remove_edge(0, 1);
+  g.add_edge(2, 3);
+  g.query(0, 2);
+  g.query(1, 3);
+  g.query_components();
+  vector<int> res = g.solve();
+  assert(res.size() == 5);
+  assert(res[0] == 1 && res[1] == 2 && res[2] == 0 && res[3] == 1 && res[4] == 2);
   return 0;
 }
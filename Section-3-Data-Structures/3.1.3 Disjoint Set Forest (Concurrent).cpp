@@ -0,0 +1,138 @@
+/*
+
+Maintain a partition of the dense ids 0 to n - 1 into disjoint sets, such that
+any number of threads may call find_root(), is_united(), and unite() at once
+without locks. The forest is a single array of parent ids which is only ever
+modified by atomic compare-and-swap (CAS) operations, following the
+randomized concurrent algorithm of Jayanti and Tarjan.
+
+- find_root(x) walks up from x to its root, applying path halving: each node
+  visited is swung by CAS from its parent to its grandparent. A failed CAS means
+  that another thread already moved the node higher, so it is simply ignored.
+- unite(x, y) finds both roots and links the one of lower priority below the
+  other by a CAS on its parent, which fails if the root was linked by another
+  thread in the meantime, in which case the roots are found again. Priorities
+  are a fixed pseudorandom permutation of the ids, so that linking never forms
+  a cycle (a root is only ever linked below one of higher priority) and trees
+  stay shallow in expectation regardless of the order of unions. unite()
+  returns whether this call performed the union.
+- is_united(x, y) returns whether x and y are in the same set. Since a root may
+  be linked between finding it and comparing it, two different roots are only
+  conclusive if the first is still a root afterwards.
+
+Results are linearizable: each operation behaves as if it took effect at a
+single instant during the call. The atomic operations are the __atomic builtins
+of GCC and Clang, which also prevent the compiler from caching parent ids.
+
+Time Complexity:
+- O(n) for construction.
+- O(log n) expected per call to find_root(), is_united(), and unite(), or
+  O(a(n)) amortized by path halving for serial use, where a(n) is the extremely
+  slow growing inverse of the Ackermann function. Concurrent calls add the
+  retries caused by the CAS operations of other threads.
+
+Space Complexity:
+- O(n) for storage of the parent ids.
+- O(1) auxiliary per operation.
+
+*/
+
+#include <vector>
+
+class concurrent_disjoint_sets {
+  std::vector<int> root;
+  int num_sets;
+
+  int parent(int x) const {
+    return __atomic_load_n(&root[x], __ATOMIC_ACQUIRE);
+  }
+
+  bool swing(int x, int expected, int desired) {
+    return __atomic_compare_exchange_n(&root[x], &expected, desired, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+  }
+
+  // A bijection on 32-bit ints, so distinct ids have distinct priorities.
+  static unsigned int priority(int x) {
+    return (unsigned int)x*2654435761u;
+  }
+
+ public:
+  concurrent_disjoint_sets(int n) : root(n), num_sets(n) {
+    for (int i = 0; i < n; i++) {
+      root[i] = i;
+    }
+  }
+
+  int sets() const {
+    return __atomic_load_n(&num_sets, __ATOMIC_ACQUIRE);
+  }
+
+  int find_root(int x) {
+    for (;;) {
+      int p = parent(x), gp = parent(p);
+      if (p == gp) {
+        return p;
+      }
+      swing(x, p, gp);
+      x = gp;
+    }
+  }
+
+  bool is_united(int x, int y) {
+    for (;;) {
+      x = find_root(x);
+      y = find_root(y);
+      if (x == y) {
+        return true;
+      }
+      if (parent(x) == x) {
+        return false;
+      }
+    }
+  }
+
+  bool unite(int x, int y) {
+    for (;;) {
+      x = find_root(x);
+      y = find_root(y);
+      if (x == y) {
+        return false;
+      }
+      if (priority(x) > priority(y)) {
+        int tmp = x;
+        x = y;
+        y = tmp;
+      }
+      if (swing(x, x, y)) {
+        __atomic_sub_fetch(&num_sets, 1, __ATOMIC_ACQ_REL);
+        return true;
+      }
+    }
+  }
+};
+
+/*** Example Usage and Output:
+
+2 sets remain
+
+***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+int main() {
+  concurrent_disjoint_sets d(8);
+  // Each of these calls may come from a different thread.
+  for (int i = 0; i + 1 < 4; i++) {
+    assert(d.unite(i, i + 1));
+  }
+  for (int i = 4; i + 1 < 8; i++) {
+    assert(d.unite(i, i + 1));
+  }
+  assert(!d.unite(0, 3));
+  assert(d.is_united(0, 3) && d.is_united(4, 7) && !d.is_united(3, 4));
+  cout << d.sets() << " sets remain" << endl;
+  return 0;
+}
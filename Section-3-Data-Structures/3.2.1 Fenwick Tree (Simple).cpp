@@ -5,7 +5,9 @@ Maintain an array of numerical type, allowing for updates of individual indices
 This implementation assumes that the array is 1-based (i.e. has valid indices
 from 1 to MAXN - 1, inclusive).
 
-- init_bit() resets the data structure.
+- init_tree() resets the data structure.
+- build_tree() builds the data structure from the values already stored in the
+  array a[], computing each node once and adding it to its parent.
 - a[i] stores the value at index i, where i is between 1 and MAXN - 1.
 - add(i, x) adds x to the value at index i (i.e. a[i] += x).
 - set(i, x) assigns x to the value at index i (i.e. a[i] = x).
@@ -13,7 +15,8 @@ from 1 to MAXN - 1, inclusive).
 - sum(lo, hi) returns the sum of all values at indices from lo to hi, inclusive.
 
 Time Complexity:
-- O(n) per call to init_bit(), where n is the size of the array.
+- O(n) per call to init_tree() and build_tree(), where n is the size of the
+  array.
 - O(log n) per call to all other operations.
 
 Space Complexity:
@@ -31,6 +34,19 @@ void init_tree() {
   }
 }
 
+void build_tree() {
+  bits[0] = 0;
+  for (int i = 1; i <= MAXN; i++) {
+    bits[i] = a[i];
+  }
+  for (int i = 1; i <= MAXN; i++) {
+    int parent = i + (i & -i);
+    if (parent <= MAXN) {
+      bits[parent] += bits[i];
+    }
+  }
+}
+
 void add(int i, int x) {
   a[i] += x;
   for (; i <= MAXN; i += i & -i) {
@@ -61,6 +77,7 @@ Sum of range [2, 4] is 6.
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -76,5 +93,10 @@ int main() {
     cout << a[i] << " ";
   }
   cout << endl << "Sum of range [2, 4] is " << sum(2, 4) << "." << endl;
+  for (int i = 1; i <= MAXN; i++) {
+    a[i] = i;
+  }
+  build_tree();
+  assert(sum(10, 20) == 165 && sum(MAXN) == MAXN*(MAXN + 1)/2);
   return 0;
 }
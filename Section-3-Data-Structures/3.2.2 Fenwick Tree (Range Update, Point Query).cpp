@@ -5,13 +5,17 @@ simultaneously incremented by arbitrary values (range update) and values at
 individual indices to be queried (point query). This implementation assumes that
 the array is 0-based (i.e. has valid indices from 0 to size() - 1, inclusive).
 
+- fenwick_tree(n) constructs an array of size n with all values set to 0.
+- fenwick_tree(lo, hi) constructs an array from two ForwardIterators as a range
+  [lo, hi), by building the tree of differences of adjacent values in a single
+  pass rather than by adding each value in turn.
 - size() returns the size of the array.
 - at(i) returns the value at index i, where i is between 0 and size() - 1.
 - add(i, x) adds x to the value at index i (i.e. a[i] += x).
 - add(lo, hi, x) adds x to all indices from lo to hi, inclusive.
 
 Time Complexity:
-- O(n) per call to the constructor, where n is the size of the array.
+- O(n) per call to both constructors, where n is the size of the array.
 - O(1) per call to size().
 - O(log n) per call to at() and both add() functions.
 
@@ -25,7 +29,7 @@ Space Complexity:
 
 template<class T> class fenwick_tree {
   int len;
-  std::vector<int> bits;
+  std::vector<T> bits;
 
  public:
   fenwick_tree(int n) {
@@ -33,12 +37,29 @@ template<class T> class fenwick_tree {
     bits.resize(n + 2);
   }
 
+  template<class It> fenwick_tree(It lo, It hi) {
+    bits.assign(1, T());
+    T prev = T();
+    for (; lo != hi; ++lo) {
+      bits.push_back(*lo - prev);
+      prev = *lo;
+    }
+    len = (int)bits.size() - 1;
+    bits.push_back(T());
+    for (int i = 1; i <= len + 1; i++) {
+      int parent = i + (i & -i);
+      if (parent <= len + 1) {
+        bits[parent] += bits[i];
+      }
+    }
+  }
+
   int size() const {
     return len;
   }
 
   T at(int i) const {
-    int res = 0;
+    T res = 0;
     for (i++; i > 0; i -= i & -i) {
       res += bits[i];
     }
@@ -63,6 +84,7 @@ Values: 5 10 15 10 10
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -76,5 +98,9 @@ int main() {
     cout << t.at(i) << " ";
   }
   cout << endl;
+  int a[] = {5, 10, 15, 10, 10};
+  fenwick_tree<int> u(a, a + 5);
+  u.add(3, 4, -10);
+  assert(u.at(0) == 5 && u.at(2) == 15 && u.at(3) == 0 && u.at(4) == 0);
   return 0;
 }
@@ -5,29 +5,50 @@ Maintain an array of numerical type, allowing for updates of individual indices
 This implementation assumes that the array is 0-based (i.e. has valid indices
 from 0 to size() - 1, inclusive).
 
+- fenwick_tree(n) constructs an array of size n with all values set to 0.
+- fenwick_tree(lo, hi) constructs an array from two ForwardIterators as a range
+  [lo, hi). Rather than adding each value in turn, each node is computed once
+  and added to its parent, building the tree in a single pass.
 - size() returns the size of the array.
 - at(i) returns the value at index i, where i is between 0 and size() - 1.
 - add(i, x) adds x to the value at index i (i.e. a[i] += x).
 - set(i, x) assigns x to the value at index i (i.e. a[i] = x).
 - sum(hi) returns the sum of all values at indices from 0 to hi, inclusive.
 - sum(lo, hi) returns the sum of all values at indices from lo to hi, inclusive.
+  The two paths up the tree from lo - 1 and hi only differ below their nearest
+  common node, so the sum is taken over those nodes only.
+- sum(his, res) sets res[j] to sum(his[j]) for each j. The queries are first
+  grouped by a counting sort into windows of 2^14 consecutive indices, and each
+  window's queries are answered together, so that the nodes they read are
+  already in cache. This only pays off for many queries on an array that is
+  much larger than the cache.
+- lower_bound(s) returns the smallest index hi such that sum(hi) >= s, or size()
+  if there is none, assuming that all values are nonnegative. Rather than
+  binary searching with calls to sum(), it descends the tree from the largest
+  power of two, adding the node of each step taken.
 
 Time Complexity:
-- O(n) per call to the constructor, where n is the size of the array.
+- O(n) per call to both constructors, where n is the size of the array.
 - O(1) per call to size() and at().
-- O(log n) per call to add(), set(), and both sum() functions.
+- O(log n) per call to add(), set(), sum(hi), sum(lo, hi), and lower_bound(),
+  with sum(lo, hi) taking O(log(hi - lo + 1)) when lo and hi are close.
+- O(n/2^14 + q log n) per call to sum(his, res) for q indices.
 
 Space Complexity:
 - O(n) for storage of the array elements.
-- O(1) auxiliary per call to all other operations.
+- O(n/2^14 + q) auxiliary per call to sum(his, res), and O(1) auxiliary per
+  call to all other operations.
 
 */
 
 #include <vector>
 
 template<class T> class fenwick_tree {
+  // Batched queries are grouped by windows of 2^WINDOW_BITS indices.
+  static const int WINDOW_BITS = 14;
+
   int len;
-  std::vector<int> data, bits;
+  std::vector<T> data, bits;
 
  public:
   fenwick_tree(int n) {
@@ -36,6 +57,19 @@ template<class T> class fenwick_tree {
     bits.resize(n + 1);
   }
 
+  template<class It> fenwick_tree(It lo, It hi) {
+    data.assign(1, T());
+    data.insert(data.end(), lo, hi);
+    len = (int)data.size() - 1;
+    bits = data;
+    for (int i = 1; i <= len; i++) {
+      int parent = i + (i & -i);
+      if (parent <= len) {
+        bits[parent] += bits[i];
+      }
+    }
+  }
+
   int size() const {
     return len;
   }
@@ -56,7 +90,7 @@ template<class T> class fenwick_tree {
     add(i, inc);
   }
 
-  T sum(int hi) {
+  T sum(int hi) const {
     T res = 0;
     for (hi++; hi > 0; hi -= hi & -hi) {
       res += bits[hi];
@@ -64,8 +98,49 @@ template<class T> class fenwick_tree {
     return res;
   }
 
-  T sum(int lo, int hi) {
-    return sum(hi) - sum(lo - 1);
+  T sum(int lo, int hi) const {
+    T res = 0;
+    for (hi++; hi > lo; hi -= hi & -hi) {
+      res += bits[hi];
+    }
+    for (; lo > hi; lo -= lo & -lo) {
+      res -= bits[lo];
+    }
+    return res;
+  }
+
+  void sum(const std::vector<int> &his, std::vector<T> &res) const {
+    // Counting sort the queries by window, keeping their order within each.
+    int nwindows = (len >> WINDOW_BITS) + 1;
+    std::vector<int> start(nwindows + 1, 0), order(his.size());
+    for (int j = 0; j < (int)his.size(); j++) {
+      start[(his[j] >> WINDOW_BITS) + 1]++;
+    }
+    for (int w = 0; w < nwindows; w++) {
+      start[w + 1] += start[w];
+    }
+    for (int j = 0; j < (int)his.size(); j++) {
+      order[start[his[j] >> WINDOW_BITS]++] = j;
+    }
+    res.resize(his.size());
+    for (int j = 0; j < (int)order.size(); j++) {
+      res[order[j]] = sum(his[order[j]]);
+    }
+  }
+
+  int lower_bound(T s) const {
+    int step = 1;
+    while (2*step <= len) {
+      step *= 2;
+    }
+    int i = 0;
+    for (; step > 0; step /= 2) {
+      if (i + step <= len && bits[i + step] < s) {
+        i += step;
+        s -= bits[i];
+      }
+    }
+    return i;
   }
 };
 
@@ -76,6 +151,8 @@ Sum of range [1, 3] is 6.
 
 ***/
 
+#include <cassert>
+#include <cstdlib>  // rand()
 #include <iostream>
 using namespace std;
 
@@ -91,5 +168,28 @@ int main() {
     cout << t.at(i) << " ";
   }
   cout << endl << "Sum of range [1, 3] is " << t.sum(1, 3) << "." << endl;
+
+  // Build in O(n), then check every query against prefix sums.
+  vector<long long> v(1000), prefix(1001, 0);
+  for (int i = 0; i < 1000; i++) {
+    v[i] = rand() % 10;
+    prefix[i + 1] = prefix[i] + v[i];
+  }
+  fenwick_tree<long long> u(v.begin(), v.end());
+  vector<int> his;
+  for (int it = 0; it < 1000; it++) {
+    int lo = rand() % 1000, hi = lo + rand() % (1000 - lo);
+    assert(u.sum(lo, hi) == prefix[hi + 1] - prefix[lo]);
+    long long s = rand() % (prefix[1000] + 2);
+    int i = u.lower_bound(s);
+    assert(i == 1000 ? prefix[1000] < s : prefix[i + 1] >= s);
+    assert(i == 0 || prefix[i] < s);
+    his.push_back(hi);
+  }
+  vector<long long> res;
+  u.sum(his, res);
+  for (int j = 0; j < (int)his.size(); j++) {
+    assert(res[j] == prefix[his[j] + 1]);
+  }
   return 0;
 }
@@ -5,6 +5,10 @@ simultaneously incremented by arbitrary values (range update) and queries for
 the sum of contiguous sub-arrays (range query). This implementation assumes that
 the array is 0-based (i.e. has valid indices from 0 to size() - 1, inclusive).
 
+- fenwick_tree(n) constructs an array of size n with all values set to 0.
+- fenwick_tree(lo, hi) constructs an array from two ForwardIterators as a range
+  [lo, hi), building both trees from the differences of adjacent values in a
+  single pass rather than by adding each value in turn.
 - size() returns the size of the array.
 - add(i, x) adds x to the value at index i (i.e. a[i] += x).
 - add(lo, hi, x) adds x to all indices from lo to hi, inclusive.
@@ -14,7 +18,7 @@ the array is 0-based (i.e. has valid indices from 0 to size() - 1, inclusive).
 - at(i) returns the value at index i, where i is between 0 and size() - 1.
 
 Time Complexity:
-- O(n) per call to the constructor, where n is the size of the array.
+- O(n) per call to both constructors, where n is the size of the array.
 - O(1) per call to size().
 - O(log n) per call to all other operations.
 
@@ -44,6 +48,15 @@ template<class T> class fenwick_tree {
     }
   }
 
+  void build(std::vector<T> &b) {
+    for (int i = 1; i <= len + 1; i++) {
+      int parent = i + (i & -i);
+      if (parent <= len + 1) {
+        b[parent] += b[i];
+      }
+    }
+  }
+
  public:
   fenwick_tree(int n) {
     len = n;
@@ -51,6 +64,26 @@ template<class T> class fenwick_tree {
     b2.resize(n + 2);
   }
 
+  // The difference d of each value from the previous one at index i (1-based)
+  // is stored as d in b1 and as d*(i - 1) in b2, just as add(i - 1, len - 1,
+  // d) would store it.
+  template<class It> fenwick_tree(It lo, It hi) {
+    b1.assign(1, T());
+    T prev = T();
+    for (; lo != hi; ++lo) {
+      b1.push_back(*lo - prev);
+      prev = *lo;
+    }
+    len = (int)b1.size() - 1;
+    b1.push_back(T());
+    b2.resize(len + 2);
+    for (int i = 1; i <= len; i++) {
+      b2[i] = b1[i]*(i - 1);
+    }
+    build(b1);
+    build(b2);
+  }
+
   int size() const {
     return len;
   }
@@ -93,6 +126,7 @@ Sum of range [0, 4] is 27.
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -109,5 +143,12 @@ int main() {
     cout << t.at(i) << " ";
   }
   cout << endl << "Sum of range [0, 4] is " << t.sum(0, 4) << "." << endl;
+  int b[] = {15, 6, 7, -5, 4};
+  fenwick_tree<int> u(b, b + 5);
+  for (int i = 0; i < 5; i++) {
+    assert(u.at(i) == b[i] && u.sum(0, i) == t.sum(0, i));
+  }
+  u.add(1, 3, 2);
+  assert(u.sum(1, 4) == 18 && u.at(3) == -3);
   return 0;
 }
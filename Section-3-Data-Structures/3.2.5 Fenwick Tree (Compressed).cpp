@@ -3,38 +3,225 @@
 Maintain an array of numerical type, allowing for contiguous sub-arrays to be
 simultaneously incremented by arbitrary values (range update) and queries for
 the sum of contiguous sub-arrays (range query). This implementation uses
-std::map for coordinate compression, allowing for large indices to be accessed
+a hashmap for coordinate compression, allowing for large indices to be accessed
 with efficient space complexity. That is, all array indices from 0 to MAXN,
 inclusive, are accessible.
 
+The nodes of fenwick_tree are stored in an open-addressing hashmap (as in
+section 3.5.6) keyed by node index, instead of std::map. Each node holds both
+of its values, so an update or query probes the hashmap once per node, and a
+query only looks nodes up without inserting them.
+
+offline_fenwick_tree is for when every index to be passed to add() and set()
+is known in advance. Its constructor takes these indices, sorts them, and
+builds a dense Fenwick tree over their positions in the sorted order, so that
+each operation is a binary search followed by a loop over a plain array. A node
+at the k-th smallest declared index covers the same lower indices as in the
+uncompressed tree, so the sums are unchanged. Indices passed to sum() and at()
+need not be declared.
+
 - add(i, x) adds x to the value at index i (i.e. a[i] += x).
 - add(lo, hi, x) adds x to all indices from lo to hi, inclusive.
 - set(i, x) assigns x to the value at index i (i.e. a[i] = x).
 - sum(hi) returns the sum of all values at indices from 0 to hi, inclusive.
 - sum(lo, hi) returns the sum of all values at indices from lo to hi, inclusive.
 - at(i) returns the value at index i, where i is between 0 and MAXN.
+- offline_fenwick_tree(lo, hi) constructs an array of zeros, for which the
+  indices i of later calls to add(i, x) or set(i, x), and the indices lo and hi
+  of later calls to add(lo, hi, x), are all in the range [lo, hi) of
+  ForwardIterators given to the constructor.
 
 Time Complexity:
-- O(log^2 MAXN) per call to all member functions. If std::map is replaced with
-  std::unordered_map, then the amortized running time will become O(log MAXN).
+- O(log MAXN) expected per call to all member functions of fenwick_tree.
+- O(u log u) per call to the offline_fenwick_tree constructor, where u is the
+  number of declared indices, and O(log u) per call to all other functions.
 
 Space Complexity:
 - O(n log MAXN) for storage of the array elements, where n is the number of
-  distinct indices that have been accessed across all of the operations so far.
+  distinct indices that have been accessed across all of the operations so far,
+  or O(u) for offline_fenwick_tree.
 - O(1) auxiliary per call to all operations.
 
 */
 
-#include <map>
+#include <algorithm>  // std::lower_bound(), std::sort(), ...
+#include <cstring>  // std::memset()
+#include <new>  // operator new(), placement new
+#include <utility>  // std::pair
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>  // _mm_cmpeq_epi8(), _mm_movemask_epi8(), ...
+#endif
+
+// A hashmap with linear probing as in section 3.5.6, without removal.
+template<class key_t, class val_t, class Hash> class flat_hashmap {
+  static const int GROUP = 16;
+  static const signed char EMPTY = -128;
+
+  typedef std::pair<key_t, val_t> entry_t;
+
+  signed char *ctrl;
+  entry_t *slots;
+  size_t mask, map_size;
+
+  static signed char tag(size_t h) {
+    return (signed char)(h & 0x7f);
+  }
+
+  // Returns a bitmask of which of the GROUP control bytes from i equal t.
+  unsigned int match(size_t i, signed char t) const {
+#ifdef __SSE2__
+    __m128i g = _mm_loadu_si128((const __m128i*)(ctrl + i));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(t)));
+#else
+    unsigned int res = 0;
+    for (int j = 0; j < GROUP; j++) {
+      res |= (unsigned int)(ctrl[i + j] == t) << j;
+    }
+    return res;
+#endif
+  }
+
+  void set_ctrl(size_t i, signed char c) {
+    ctrl[i] = c;
+    if (i < GROUP - 1) {
+      ctrl[mask + 1 + i] = c;
+    }
+  }
+
+  // Returns the slot holding key, or else the empty slot ending its run with
+  // found set to false.
+  template<class K>
+  size_t probe(const K &key, size_t h, bool &found) const {
+    signed char t = tag(h);
+    for (size_t i = (h >> 7) & mask; ; i = (i + GROUP) & mask) {
+      unsigned int empty = match(i, EMPTY);
+      // Tags at or past the first empty byte belong to other runs. If there
+      // is no empty byte, then (empty & -empty) - 1 has all bits set.
+      unsigned int hits = match(i, t) & ((empty & -empty) - 1);
+      for (; hits != 0; hits &= hits - 1) {
+        size_t j = (i + __builtin_ctz(hits)) & mask;
+        if (slots[j].first == key) {
+          found = true;
+          return j;
+        }
+      }
+      if (empty != 0) {
+        found = false;
+        return (i + __builtin_ctz(empty)) & mask;
+      }
+    }
+  }
+
+  void allocate(size_t capacity) {
+    mask = capacity - 1;
+    ctrl = new signed char[capacity + GROUP - 1];
+    std::memset(ctrl, EMPTY, capacity + GROUP - 1);
+    slots = (entry_t*)operator new(capacity*sizeof(entry_t));
+  }
+
+  void rehash() {
+    signed char *old_ctrl = ctrl;
+    entry_t *old_slots = slots;
+    size_t old_capacity = mask + 1;
+    allocate(2*old_capacity);
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] != EMPTY) {
+        size_t h = Hash()(old_slots[i].first);
+        size_t j = (h >> 7) & mask;
+        while (ctrl[j] != EMPTY) {
+          j = (j + 1) & mask;
+        }
+        set_ctrl(j, tag(h));
+        new (slots + j) entry_t(old_slots[i]);
+        old_slots[i].~entry_t();
+      }
+    }
+    delete[] old_ctrl;
+    operator delete(old_slots);
+  }
+
+  flat_hashmap(const flat_hashmap &);
+  flat_hashmap& operator=(const flat_hashmap &);
+
+ public:
+  // The capacity is rounded up to a power of two of at least GROUP.
+  flat_hashmap(size_t capacity = GROUP) : map_size(0) {
+    size_t c = GROUP;
+    while (c < capacity) {
+      c *= 2;
+    }
+    allocate(c);
+  }
+
+  ~flat_hashmap() {
+    for (size_t i = 0; i <= mask; i++) {
+      if (ctrl[i] != EMPTY) {
+        slots[i].~entry_t();
+      }
+    }
+    delete[] ctrl;
+    operator delete(slots);
+  }
+
+  size_t size() const {
+    return map_size;
+  }
+
+  // Inserts the entry if key is not yet present, and returns its value.
+  val_t& insert(const key_t &key, const val_t &val) {
+    size_t h = Hash()(key);
+    bool found;
+    size_t i = probe(key, h, found);
+    if (!found) {
+      if (8*(map_size + 1) > 7*(mask + 1)) {
+        rehash();
+        i = probe(key, h, found);
+      }
+      set_ctrl(i, tag(h));
+      new (slots + i) entry_t(key, val);
+      map_size++;
+    }
+    return slots[i].second;
+  }
+
+  template<class K>
+  val_t* find(const K &key) {
+    bool found;
+    size_t i = probe(key, Hash()(key), found);
+    return found ? &slots[i].second : 0;
+  }
+
+  val_t& operator[](const key_t &key) {
+    return insert(key, val_t());
+  }
+};
+
+// A 64-bit finalizer (from MurmurHash3), spreading all bits of the key.
+struct int_hash {
+  size_t operator()(long long k) const {
+    unsigned long long h = (unsigned long long)k;
+    h = (h ^ (h >> 33))*0xff51afd7ed558ccdULL;
+    h = (h ^ (h >> 33))*0xc4ceb9fe1a85ec53ULL;
+    return (size_t)(h ^ (h >> 33));
+  }
+};
 
 template<class T> class fenwick_tree {
   static const int MAXN = 1000000001;
-  std::map<int, T> tmul, tadd;
 
-  void add_helper(int at, int mul, T add) {
+  struct node_t {
+    T mul, add;
+    node_t() : mul(0), add(0) {}
+  };
+
+  flat_hashmap<int, node_t, int_hash> tree;
+
+  void add_helper(int at, const T &mul, const T &add) {
     for (int i = at; i <= MAXN; i |= i + 1) {
-      tmul[i] += mul;
-      tadd[i] += add;
+      node_t &n = tree[i];
+      n.mul += mul;
+      n.add += add;
     }
   }
 
@@ -54,16 +241,14 @@ template<class T> class fenwick_tree {
 
   T sum(int hi) {
     T mul = 0, add = 0;
-    int start = hi;
     for (int i = hi; i >= 0; i = (i & (i + 1)) - 1) {
-      if (tmul.find(i) != tmul.end()) {
-        mul += tmul[i];
-      }
-      if (tadd.find(i) != tadd.end()) {
-        add += tadd[i];
+      const node_t *n = tree.find(i);
+      if (n != 0) {
+        mul += n->mul;
+        add += n->add;
       }
     }
-    return mul*start + add;
+    return mul*hi + add;
   }
 
   T sum(int lo, int hi) {
@@ -75,6 +260,58 @@ template<class T> class fenwick_tree {
   }
 };
 
+template<class T> class offline_fenwick_tree {
+  std::vector<int> keys;
+  std::vector<T> tmul, tadd;
+
+  void add_helper(int at, const T &mul, const T &add) {
+    int k = std::lower_bound(keys.begin(), keys.end(), at) - keys.begin();
+    for (k++; k <= (int)keys.size(); k += k & -k) {
+      tmul[k] += mul;
+      tadd[k] += add;
+    }
+  }
+
+ public:
+  template<class It> offline_fenwick_tree(It lo, It hi) : keys(lo, hi) {
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    tmul.assign(keys.size() + 1, 0);
+    tadd.assign(keys.size() + 1, 0);
+  }
+
+  void add(int lo, int hi, const T &x) {
+    add_helper(lo, x, -x*(lo - 1));
+    add_helper(hi, -x, x*hi);
+  }
+
+  void add(int i, const T &x) {
+    return add(i, i, x);
+  }
+
+  void set(int i, const T &x) {
+    add(i, x - at(i));
+  }
+
+  T sum(int hi) const {
+    T mul = 0, add = 0;
+    int k = std::upper_bound(keys.begin(), keys.end(), hi) - keys.begin();
+    for (; k > 0; k -= k & -k) {
+      mul += tmul[k];
+      add += tadd[k];
+    }
+    return mul*hi + add;
+  }
+
+  T sum(int lo, int hi) const {
+    return sum(hi) - sum(lo - 1);
+  }
+
+  T at(int i) const {
+    return sum(i, i);
+  }
+};
+
 /*** Example Usage and Output:
 
 Values: 15 6 7 -5 4
@@ -83,6 +320,8 @@ Sum of the whole array is 92.
 
 ***/
 
+#include <cassert>
+#include <cstdlib>  // rand()
 #include <iostream>
 using namespace std;
 
@@ -103,5 +342,23 @@ int main() {
   t.add(500000011, 500000015, 5);
   t.set(500000000, 10);
   cout << "Sum of the whole array is " << t.sum(0, 1000000000) << "." << endl;
+
+  // Declare the bounds of every update, then check against the online tree.
+  vector<pair<int, int> > updates;
+  vector<int> declared;
+  for (int i = 0; i < 1000; i++) {
+    int lo = rand() % 1000000, hi = lo + rand() % 1000000;
+    updates.push_back(make_pair(lo, hi));
+    declared.push_back(lo);
+    declared.push_back(hi);
+  }
+  fenwick_tree<long long> online;
+  offline_fenwick_tree<long long> offline(declared.begin(), declared.end());
+  for (int i = 0; i < (int)updates.size(); i++) {
+    online.add(updates[i].first, updates[i].second, i);
+    offline.add(updates[i].first, updates[i].second, i);
+    int lo = rand() % 2000000, hi = lo + rand() % 2000000;
+    assert(online.sum(lo, hi) == offline.sum(lo, hi));
+  }
   return 0;
 }
@@ -15,12 +15,42 @@ indices from 1 to MAXC, inclusive).
 - sum(r1, c1, r2, c2) returns the sum of the rectangle with upper-left corner
   (r1, c1) and lower-right corner (r2, c2).
 
+fenwick_tree_2d is a class version whose dimensions are given at run time, with
+0-based indices (i.e. rows from 0 to rows() - 1 and columns from 0 to
+cols() - 1, inclusive). Its nodes are stored in a single flat array, one row
+after another, and each update or query locates the row of a node once before
+stepping along its columns, which are then at nearby addresses.
+
+summed_area_table supports the same operations for grids which are mostly read,
+such as images. It stores the sum of every rectangle with upper-left corner
+(0, 0), so that the sum of any rectangle takes four lookups. Updates are instead
+kept in a list of pending updates, which each query scans. Once the queries have
+scanned as many pending updates as there are cells in the grid, the table is
+rebuilt, so the cost of the scans never exceeds that of the rebuilds. A grid
+which is rarely updated thus gets O(1) queries, while frequent updates simply
+accumulate until enough queries are made to pay for a rebuild. The build adds
+the rows in turn to running column totals, a loop over independent columns which
+compilers vectorize.
+
+- fenwick_tree_2d(n, m) and summed_area_table(n, m) construct an n by m grid
+  with all values set to 0.
+- fenwick_tree_2d(n, m, lo) and summed_area_table(n, m, lo) construct an n by m
+  grid from a ForwardIterator to its values in row-major order, in O(n*m) time.
+- rows() and cols() return the dimensions of the grid.
+- at(r, c), add(r, c, x), set(r, c, x), and sum(r1, c1, r2, c2) are as above,
+  and fenwick_tree_2d also provides sum(r, c) from (0, 0).
+
 Time Complexity:
-- O(n*m) per call to init_tree(), where n and m are the dimensions of the array.
-- O(log(n)*log(m)) per call to all other operations.
+- O(n*m) per call to init_tree() and to the class constructors, where n and m
+  are the dimensions of the array.
+- O(log(n)*log(m)) per call to all other operations of the global functions and
+  of fenwick_tree_2d, except O(1) for at().
+- O(1) per call to at(), add(), and set() of summed_area_table, and O(1 + k)
+  amortized per call to sum(), where k is the number of pending updates.
 
 Space Complexity:
-- O(n*m) for storage of the array elements.
+- O(n*m) for storage of the array elements, plus O(k) for the pending updates of
+  summed_area_table.
 - O(1) auxiliary per call to all operations.
 
 */
@@ -65,6 +95,167 @@ int sum(int r1, int c1, int r2, int c2) {
          sum(r1 - 1, c2) - sum(r2, c1 - 1);
 }
 
+#include <vector>
+
+template<class T> class fenwick_tree_2d {
+  int n, m;
+  std::vector<T> data, bits;  // bits is (n + 1) by (m + 1), row-major.
+
+ public:
+  fenwick_tree_2d(int rows, int cols)
+      : n(rows), m(cols), data(rows*cols), bits((rows + 1)*(cols + 1)) {}
+
+  // Each node is added to its parent along the columns, then along the rows.
+  template<class It> fenwick_tree_2d(int rows, int cols, It lo)
+      : n(rows), m(cols), data(rows*cols), bits((rows + 1)*(cols + 1)) {
+    for (int i = 0; i < n*m; i++, ++lo) {
+      data[i] = *lo;
+    }
+    for (int i = 1; i <= n; i++) {
+      T *row = &bits[i*(m + 1)];
+      for (int j = 1; j <= m; j++) {
+        row[j] += data[(i - 1)*m + j - 1];
+        if (j + (j & -j) <= m) {
+          row[j + (j & -j)] += row[j];
+        }
+      }
+    }
+    for (int i = 1; i <= n; i++) {
+      if (i + (i & -i) <= n) {
+        T *row = &bits[i*(m + 1)], *parent = &bits[(i + (i & -i))*(m + 1)];
+        for (int j = 1; j <= m; j++) {
+          parent[j] += row[j];
+        }
+      }
+    }
+  }
+
+  int rows() const {
+    return n;
+  }
+
+  int cols() const {
+    return m;
+  }
+
+  T at(int r, int c) const {
+    return data[r*m + c];
+  }
+
+  void add(int r, int c, const T &x) {
+    data[r*m + c] += x;
+    for (int i = r + 1; i <= n; i += i & -i) {
+      T *row = &bits[i*(m + 1)];
+      for (int j = c + 1; j <= m; j += j & -j) {
+        row[j] += x;
+      }
+    }
+  }
+
+  void set(int r, int c, const T &x) {
+    add(r, c, x - at(r, c));
+  }
+
+  T sum(int r, int c) const {
+    T res = 0;
+    for (int i = r + 1; i > 0; i -= i & -i) {
+      const T *row = &bits[i*(m + 1)];
+      for (int j = c + 1; j > 0; j -= j & -j) {
+        res += row[j];
+      }
+    }
+    return res;
+  }
+
+  T sum(int r1, int c1, int r2, int c2) const {
+    return sum(r2, c2) + sum(r1 - 1, c1 - 1) -
+           sum(r1 - 1, c2) - sum(r2, c1 - 1);
+  }
+};
+
+template<class T> class summed_area_table {
+  struct update_t {
+    int r, c;
+    T x;
+  };
+
+  int n, m;
+  long long scanned;
+  std::vector<T> data, table;  // table is (n + 1) by (m + 1), row-major.
+  std::vector<update_t> pending;
+
+  void build() {
+    for (int j = 0; j <= m; j++) {
+      table[j] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+      const T *prev = &table[i*(m + 1)], *a = &data[i*m];
+      T *row = &table[(i + 1)*(m + 1)];
+      // Prefix sums of row i, then the column totals of the rows above.
+      row[0] = 0;
+      for (int j = 0; j < m; j++) {
+        row[j + 1] = row[j] + a[j];
+      }
+      for (int j = 1; j <= m; j++) {
+        row[j] += prev[j];
+      }
+    }
+    pending.clear();
+    scanned = 0;
+  }
+
+ public:
+  summed_area_table(int rows, int cols)
+      : n(rows), m(cols), scanned(0), data(rows*cols),
+        table((rows + 1)*(cols + 1)) {}
+
+  template<class It> summed_area_table(int rows, int cols, It lo)
+      : n(rows), m(cols), data(rows*cols), table((rows + 1)*(cols + 1)) {
+    for (int i = 0; i < n*m; i++, ++lo) {
+      data[i] = *lo;
+    }
+    build();
+  }
+
+  int rows() const {
+    return n;
+  }
+
+  int cols() const {
+    return m;
+  }
+
+  T at(int r, int c) const {
+    return data[r*m + c];
+  }
+
+  void add(int r, int c, const T &x) {
+    data[r*m + c] += x;
+    update_t u = {r, c, x};
+    pending.push_back(u);
+  }
+
+  void set(int r, int c, const T &x) {
+    add(r, c, x - at(r, c));
+  }
+
+  T sum(int r1, int c1, int r2, int c2) {
+    const T *lo = &table[r1*(m + 1)], *hi = &table[(r2 + 1)*(m + 1)];
+    T res = hi[c2 + 1] - hi[c1] - lo[c2 + 1] + lo[c1];
+    for (int k = 0; k < (int)pending.size(); k++) {
+      const update_t &u = pending[k];
+      if (r1 <= u.r && u.r <= r2 && c1 <= u.c && u.c <= c2) {
+        res += u.x;
+      }
+    }
+    scanned += pending.size();
+    if (scanned >= (long long)n*m) {
+      build();
+    }
+    return res;
+  }
+};
+
 /*** Example Usage and Output:
 
 Values:
@@ -75,6 +266,7 @@ Values:
 ***/
 
 #include <cassert>
+#include <cstdlib>  // rand()
 #include <iostream>
 using namespace std;
 
@@ -95,5 +287,35 @@ int main() {
   assert(sum(1, 1, 1, 2) == 11);
   assert(sum(1, 1, 2, 1) == 8);
   assert(sum(1, 1, 3, 3) == 23);
+
+  // Check both classes against a plain matrix under random updates.
+  const int n = 37, m = 21;
+  int g[n][m];
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < m; j++) {
+      g[i][j] = rand() % 10;
+    }
+  }
+  fenwick_tree_2d<long long> t(n, m, &g[0][0]);
+  summed_area_table<long long> s(n, m, &g[0][0]);
+  for (int k = 0; k < 20000; k++) {
+    int r = rand() % n, c = rand() % m, x = rand() % 10;
+    if (rand() % 4 == 0) {
+      g[r][c] += x;
+      t.add(r, c, x);
+      s.add(r, c, x);
+    }
+    int r1 = rand() % n, c1 = rand() % m;
+    int r2 = r1 + rand() % (n - r1), c2 = c1 + rand() % (m - c1);
+    long long expected = 0;
+    for (int i = r1; i <= r2; i++) {
+      for (int j = c1; j <= c2; j++) {
+        expected += g[i][j];
+      }
+    }
+    assert(t.sum(r1, c1, r2, c2) == expected);
+    assert(s.sum(r1, c1, r2, c2) == expected);
+    assert(t.at(r, c) == g[r][c] && s.at(r, c) == g[r][c]);
+  }
   return 0;
 }
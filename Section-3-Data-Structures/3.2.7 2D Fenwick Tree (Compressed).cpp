@@ -3,10 +3,26 @@
 Maintain a 2D array of numerical type, allowing for rectangular sub-matrices to
 be simultaneously incremented by arbitrary values (range update) and queries for
 the sum of rectangular sub-matrices (range query). This implementation uses
-std::map for coordinate compression, allowing for large indices to be accessed
+a hashmap for coordinate compression, allowing for large indices to be accessed
 with efficient space complexity. That is, rows have valid indices from 0 to
 MAXR, inclusive, and columns have valid indices from 0 to MAXC, inclusive.
 
+The four trees of fenwick_tree_2d share the nodes of a single open-addressing
+hashmap (as in section 3.5.6) keyed by the row and column of the node, each
+node holding the four values. An update adds to the four trees at each of the
+four corners of a rectangle, so the corner updates to the same node are grouped
+into one pass over its nodes, and a query only looks nodes up without inserting
+them.
+
+offline_fenwick_tree_2d is for when every rectangle to be passed to add() and
+set() is known in advance. Each rectangle is first given to declare(), after
+which build() compresses the rows of the outer tree to the distinct rows of the
+declared corners. Each node of the outer tree then stores the sorted list of
+the distinct columns which updates will reach at that node, next to a dense
+column tree over those columns. All of the lists and trees are stored one after
+another in two flat arrays. Each operation is thus a binary search per visited
+row node followed by loops over plain arrays.
+
 - add(r, c, x) adds x to the value at index (r, c).
 - add(r1, c1, r2, c2, x) adds x to all indices in the rectangle with upper-left
   corner (r1, c1) and lower-right corner (r2, c2).
@@ -16,47 +32,229 @@ MAXR, inclusive, and columns have valid indices from 0 to MAXC, inclusive.
 - sum(r1, c1, r2, c2) returns the sum of the rectangle with upper-left corner
   (r1, c1) and lower-right corner (r2, c2).
 - at(r, c) returns the value at index (r, c).
+- declare(r, c) and declare(r1, c1, r2, c2) declare the index or rectangle of a
+  later update to an offline_fenwick_tree_2d, before build() is called. Queries
+  may be made for any rectangle after build().
 
 Time Complexity:
-- O(log^2(MAXR)*log^2(MAXC)) per call to all member functions. If std::map is
-  replaced with std::unordered_map, then the amortized running time will become
-  O(log(MAXR)*log(MAXC)).
+- O(log(MAXR)*log(MAXC)) expected per call to all member functions of
+  fenwick_tree_2d.
+- O(u log^2 u) per call to build() for u declared rectangles, and O(log^2 u)
+  per call to all other member functions of offline_fenwick_tree_2d.
 
 Space Complexity:
 - O(n*log(MAXR)*log(MAXC)) for storage of the array elements, where n is the
   number of distinct indices that have been accessed across all of the
-  operations so far.
-- O(1) auxiliary per call to all operations.
+  operations so far, or O(u log u) for offline_fenwick_tree_2d.
+- O(1) auxiliary per call to all operations except build().
 
 */
 
-#include <map>
+#include <algorithm>  // std::lower_bound(), std::sort(), ...
+#include <cstring>  // std::memset()
+#include <new>  // operator new(), placement new
 #include <utility>  // std::make_pair(), std::pair
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>  // _mm_cmpeq_epi8(), _mm_movemask_epi8(), ...
+#endif
+
+// A hashmap with linear probing as in section 3.5.6, without removal.
+template<class key_t, class val_t, class Hash> class flat_hashmap {
+  static const int GROUP = 16;
+  static const signed char EMPTY = -128;
+
+  typedef std::pair<key_t, val_t> entry_t;
+
+  signed char *ctrl;
+  entry_t *slots;
+  size_t mask, map_size;
+
+  static signed char tag(size_t h) {
+    return (signed char)(h & 0x7f);
+  }
+
+  // Returns a bitmask of which of the GROUP control bytes from i equal t.
+  unsigned int match(size_t i, signed char t) const {
+#ifdef __SSE2__
+    __m128i g = _mm_loadu_si128((const __m128i*)(ctrl + i));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(t)));
+#else
+    unsigned int res = 0;
+    for (int j = 0; j < GROUP; j++) {
+      res |= (unsigned int)(ctrl[i + j] == t) << j;
+    }
+    return res;
+#endif
+  }
+
+  void set_ctrl(size_t i, signed char c) {
+    ctrl[i] = c;
+    if (i < GROUP - 1) {
+      ctrl[mask + 1 + i] = c;
+    }
+  }
+
+  // Returns the slot holding key, or else the empty slot ending its run with
+  // found set to false.
+  template<class K>
+  size_t probe(const K &key, size_t h, bool &found) const {
+    signed char t = tag(h);
+    for (size_t i = (h >> 7) & mask; ; i = (i + GROUP) & mask) {
+      unsigned int empty = match(i, EMPTY);
+      // Tags at or past the first empty byte belong to other runs. If there
+      // is no empty byte, then (empty & -empty) - 1 has all bits set.
+      unsigned int hits = match(i, t) & ((empty & -empty) - 1);
+      for (; hits != 0; hits &= hits - 1) {
+        size_t j = (i + __builtin_ctz(hits)) & mask;
+        if (slots[j].first == key) {
+          found = true;
+          return j;
+        }
+      }
+      if (empty != 0) {
+        found = false;
+        return (i + __builtin_ctz(empty)) & mask;
+      }
+    }
+  }
+
+  void allocate(size_t capacity) {
+    mask = capacity - 1;
+    ctrl = new signed char[capacity + GROUP - 1];
+    std::memset(ctrl, EMPTY, capacity + GROUP - 1);
+    slots = (entry_t*)operator new(capacity*sizeof(entry_t));
+  }
+
+  void rehash() {
+    signed char *old_ctrl = ctrl;
+    entry_t *old_slots = slots;
+    size_t old_capacity = mask + 1;
+    allocate(2*old_capacity);
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] != EMPTY) {
+        size_t h = Hash()(old_slots[i].first);
+        size_t j = (h >> 7) & mask;
+        while (ctrl[j] != EMPTY) {
+          j = (j + 1) & mask;
+        }
+        set_ctrl(j, tag(h));
+        new (slots + j) entry_t(old_slots[i]);
+        old_slots[i].~entry_t();
+      }
+    }
+    delete[] old_ctrl;
+    operator delete(old_slots);
+  }
+
+  flat_hashmap(const flat_hashmap &);
+  flat_hashmap& operator=(const flat_hashmap &);
+
+ public:
+  // The capacity is rounded up to a power of two of at least GROUP.
+  flat_hashmap(size_t capacity = GROUP) : map_size(0) {
+    size_t c = GROUP;
+    while (c < capacity) {
+      c *= 2;
+    }
+    allocate(c);
+  }
+
+  ~flat_hashmap() {
+    for (size_t i = 0; i <= mask; i++) {
+      if (ctrl[i] != EMPTY) {
+        slots[i].~entry_t();
+      }
+    }
+    delete[] ctrl;
+    operator delete(slots);
+  }
+
+  size_t size() const {
+    return map_size;
+  }
+
+  // Inserts the entry if key is not yet present, and returns its value.
+  val_t& insert(const key_t &key, const val_t &val) {
+    size_t h = Hash()(key);
+    bool found;
+    size_t i = probe(key, h, found);
+    if (!found) {
+      if (8*(map_size + 1) > 7*(mask + 1)) {
+        rehash();
+        i = probe(key, h, found);
+      }
+      set_ctrl(i, tag(h));
+      new (slots + i) entry_t(key, val);
+      map_size++;
+    }
+    return slots[i].second;
+  }
+
+  template<class K>
+  val_t* find(const K &key) {
+    bool found;
+    size_t i = probe(key, Hash()(key), found);
+    return found ? &slots[i].second : 0;
+  }
+
+  val_t& operator[](const key_t &key) {
+    return insert(key, val_t());
+  }
+};
+
+// A 64-bit finalizer (from MurmurHash3), spreading all bits of the key.
+struct int_hash {
+  size_t operator()(long long k) const {
+    unsigned long long h = (unsigned long long)k;
+    h = (h ^ (h >> 33))*0xff51afd7ed558ccdULL;
+    h = (h ^ (h >> 33))*0xc4ceb9fe1a85ec53ULL;
+    return (size_t)(h ^ (h >> 33));
+  }
+};
+
+// The values of the four trees at one node.
+template<class T> struct fenwick_node_2d {
+  T v[4];
+
+  fenwick_node_2d() {
+    v[0] = v[1] = v[2] = v[3] = 0;
+  }
+
+  void add(const T &d1, const T &d2, const T &d3, const T &d4) {
+    v[0] += d1;
+    v[1] += d2;
+    v[2] += d3;
+    v[3] += d4;
+  }
+};
 
 template<class T> class fenwick_tree_2d {
   static const int MAXR = 1000000001;
   static const int MAXC = 1000000001;
-  std::map<std::pair<int, int>, T> t1, t2, t3, t4;
 
-  template<class M>
-  void add(M &t, int r, int c, const T &x) {
+  typedef fenwick_node_2d<T> node_t;
+
+  flat_hashmap<long long, node_t, int_hash> tree;
+
+  static long long key(int i, int j) {
+    return ((long long)i << 32) | j;
+  }
+
+  // Adds d1 to d4 to the four trees at index (r, c).
+  void add(int r, int c, const T &d1, const T &d2, const T &d3, const T &d4) {
     for (int i = r + 1; i <= MAXR; i += i & -i) {
       for (int j = c + 1; j <= MAXC; j += j & -j) {
-        t[std::make_pair(i, j)] += x;
+        tree[key(i, j)].add(d1, d2, d3, d4);
       }
     }
   }
 
   void add_pre(int r, int c, const T &x) {
-    add(t1, 0, 0, x);
-    add(t1, 0, c, -x);
-    add(t2, 0, c, x*c);
-    add(t1, r, 0, -x);
-    add(t3, r, 0, x*r);
-    add(t1, r, c, x);
-    add(t2, r, c, -x*c);
-    add(t3, r, c, -x*r);
-    add(t4, r, c, x*r*c);
+    add(0, 0, x, 0, 0, 0);
+    add(0, c, -x, x*c, 0, 0);
+    add(r, 0, -x, 0, x*r, 0);
+    add(r, c, x, -x*c, -x*r, x*r*c);
   }
 
  public:
@@ -78,17 +276,16 @@ template<class T> class fenwick_tree_2d {
   T sum(int r, int c) {
     r++;
     c++;
-    T s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+    node_t s;
     for (int i = r; i > 0; i -= i & -i) {
       for (int j = c; j > 0; j -= j & -j) {
-        const std::pair<int, int> ij(i, j);
-        s1 += t1[ij];
-        s2 += t2[ij];
-        s3 += t3[ij];
-        s4 += t4[ij];
+        const node_t *n = tree.find(key(i, j));
+        if (n != 0) {
+          s.add(n->v[0], n->v[1], n->v[2], n->v[3]);
+        }
       }
     }
-    return s1*r*c + s2*r + s3*c + s4;
+    return s.v[0]*r*c + s.v[1]*r + s.v[2]*c + s.v[3];
   }
 
   T sum(int r1, int c1, int r2, int c2) {
@@ -101,6 +298,133 @@ template<class T> class fenwick_tree_2d {
   }
 };
 
+template<class T> class offline_fenwick_tree_2d {
+  typedef fenwick_node_2d<T> node_t;
+
+  std::vector<std::pair<int, int> > points;  // Declared indices, plus one.
+  std::vector<int> rows;
+  // The columns and column tree of row node k are stored from start[k] to
+  // start[k + 1] - 1, where the position start[k] is unused.
+  std::vector<int> start, cols;
+  std::vector<node_t> tree;
+
+  static int rank(const std::vector<int> &v, int lo, int hi, int x) {
+    return std::lower_bound(v.begin() + lo, v.begin() + hi, x) - v.begin() - lo;
+  }
+
+  void declare_pre(int r, int c) {
+    points.push_back(std::make_pair(1, 1));
+    points.push_back(std::make_pair(1, c + 1));
+    points.push_back(std::make_pair(r + 1, 1));
+    points.push_back(std::make_pair(r + 1, c + 1));
+  }
+
+  // The index (r, c) must have been declared.
+  void add(int r, int c, const T &d1, const T &d2, const T &d3, const T &d4) {
+    int m = (int)rows.size();
+    for (int k = rank(rows, 0, m, r + 1) + 1; k <= m; k += k & -k) {
+      int lo = start[k], len = start[k + 1] - lo - 1;
+      for (int l = rank(cols, lo + 1, lo + 1 + len, c + 1) + 1; l <= len;
+           l += l & -l) {
+        tree[lo + l].add(d1, d2, d3, d4);
+      }
+    }
+  }
+
+  void add_pre(int r, int c, const T &x) {
+    add(0, 0, x, 0, 0, 0);
+    add(0, c, -x, x*c, 0, 0);
+    add(r, 0, -x, 0, x*r, 0);
+    add(r, c, x, -x*c, -x*r, x*r*c);
+  }
+
+ public:
+  void declare(int r1, int c1, int r2, int c2) {
+    declare_pre(r2 + 1, c2 + 1);
+    declare_pre(r1, c2 + 1);
+    declare_pre(r2 + 1, c1);
+    declare_pre(r1, c1);
+  }
+
+  void declare(int r, int c) {
+    declare(r, c, r, c);
+  }
+
+  void build() {
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    rows.clear();
+    for (int p = 0; p < (int)points.size(); p++) {
+      if (rows.empty() || rows.back() != points[p].first) {
+        rows.push_back(points[p].first);
+      }
+    }
+    int m = (int)rows.size();
+    std::vector<std::vector<int> > lists(m + 1);
+    for (int p = 0, k0 = 0; p < (int)points.size(); p++) {
+      while (rows[k0] != points[p].first) {
+        k0++;
+      }
+      for (int k = k0 + 1; k <= m; k += k & -k) {
+        lists[k].push_back(points[p].second);
+      }
+    }
+    start.assign(m + 2, 0);
+    cols.clear();
+    for (int k = 1; k <= m; k++) {
+      std::sort(lists[k].begin(), lists[k].end());
+      lists[k].erase(std::unique(lists[k].begin(), lists[k].end()),
+                     lists[k].end());
+      start[k] = (int)cols.size();
+      cols.push_back(0);
+      cols.insert(cols.end(), lists[k].begin(), lists[k].end());
+    }
+    start[m + 1] = (int)cols.size();
+    tree.assign(cols.size(), node_t());
+  }
+
+  void add(int r1, int c1, int r2, int c2, const T &x) {
+    add_pre(r2 + 1, c2 + 1, x);
+    add_pre(r1, c2 + 1, -x);
+    add_pre(r2 + 1, c1, -x);
+    add_pre(r1, c1, x);
+  }
+
+  void add(int r, int c, const T &x) {
+    add(r, c, r, c, x);
+  }
+
+  void set(int r, int c, const T &x) {
+    add(r, c, x - at(r, c));
+  }
+
+  T sum(int r, int c) const {
+    r++;
+    c++;
+    node_t s;
+    int k = std::upper_bound(rows.begin(), rows.end(), r) - rows.begin();
+    for (; k > 0; k -= k & -k) {
+      int lo = start[k], hi = start[k + 1];
+      int l = std::upper_bound(cols.begin() + lo + 1, cols.begin() + hi, c) -
+              cols.begin() - lo - 1;
+      for (; l > 0; l -= l & -l) {
+        const node_t &n = tree[lo + l];
+        s.add(n.v[0], n.v[1], n.v[2], n.v[3]);
+      }
+    }
+    return s.v[0]*r*c + s.v[1]*r + s.v[2]*c + s.v[3];
+  }
+
+  T sum(int r1, int c1, int r2, int c2) const {
+    return sum(r2, c2) + sum(r1 - 1, c1 - 1) -
+           sum(r1 - 1, c2) - sum(r2, c1 - 1);
+  }
+
+  T at(int r, int c) const {
+    return sum(r, c, r, c);
+  }
+};
+
 /*** Example Usage and Output:
 
 Values:
@@ -111,6 +435,7 @@ Values:
 ***/
 
 #include <cassert>
+#include <cstdlib>  // rand()
 #include <iostream>
 using namespace std;
 
@@ -134,5 +459,36 @@ int main() {
   assert(t.sum(1, 1, 2, 2) == 29);
   t.set(500000000, 500000000, 100);
   assert(t.sum(0, 0, 1000000000, 1000000000) == 143);
+
+  // Declare every update, then check against a plain matrix.
+  const int n = 12;
+  long long a[n][n] = {{0}};
+  int rect[200][4];
+  offline_fenwick_tree_2d<long long> u;
+  for (int i = 0; i < 200; i++) {
+    rect[i][0] = rand() % n;
+    rect[i][1] = rand() % n;
+    rect[i][2] = rect[i][0] + rand() % (n - rect[i][0]);
+    rect[i][3] = rect[i][1] + rand() % (n - rect[i][1]);
+    u.declare(rect[i][0], rect[i][1], rect[i][2], rect[i][3]);
+  }
+  u.build();
+  for (int i = 0; i < 200; i++) {
+    u.add(rect[i][0], rect[i][1], rect[i][2], rect[i][3], i);
+    for (int r = rect[i][0]; r <= rect[i][2]; r++) {
+      for (int c = rect[i][1]; c <= rect[i][3]; c++) {
+        a[r][c] += i;
+      }
+    }
+    int r1 = rand() % n, c1 = rand() % n;
+    int r2 = r1 + rand() % (n - r1), c2 = c1 + rand() % (n - c1);
+    long long s = 0;
+    for (int r = r1; r <= r2; r++) {
+      for (int c = c1; c <= c2; c++) {
+        s += a[r][c];
+      }
+    }
+    assert(u.sum(r1, c1, r2, c2) == s);
+  }
   return 0;
 }
@@ -3,18 +3,20 @@
 Maintain a fixed-size array while supporting dynamic queries of contiguous
 sub-arrays and dynamic updates of individual indices.
 
-The query operation is defined by an associative join_values() function which
-satisfies join_values(x, join_values(y, z)) = join_values(join_values(x, y), z)
-for all values x, y, and z in the array. The default code below assumes a
-numerical array type, defining queries for the "min" of the target range.
-Another possible query operation is "sum", in which case the join_values()
-function should defined to return "a + b".
+The operations are defined by the static members of the template argument
+Policy, as for the range update segment tree in this section. The query
+operation is defined by an associative join_values() function which satisfies
+join_values(x, join_values(y, z)) = join_values(join_values(x, y), z) for all
+values x, y, and z in the array. The default policy assumes a numerical array
+type, defining queries for the "min" of the target range. Another possible
+query operation is "sum", in which case the join_values() function should
+return "a + b".
 
 The update operation is defined by the join_value_with_delta() function, which
-determines the change made to array values. The default definition below
-supports updates that "set" the chosen array index to a new value. Another
-possible update operation is "increment", in which join_value_with_delta(v, d)
-should be defined to return "v + d".
+determines the change made to array values. The default policy supports updates
+that "assign" the chosen array index a new value. Another possible update
+operation is "increment", in which join_value_with_delta(v, d, 1) should return
+"v + d". Deltas are of type Policy::delta_t, and join_deltas() is not used.
 
 - segment_tree(n, v) constructs an array of size n with indices from 0 to n - 1,
   inclusive, and all values initialized to v.
@@ -25,7 +27,7 @@ should be defined to return "v + d".
 - query(lo, hi) returns the result of join_values() applied to all indices from
   lo to hi, inclusive. If the distance between lo and hi is 1, then the single
   specified value is returned.
-- update(i, d) assigns the value v at index i to join_value_with_delta(v, d).
+- update(i, d) assigns the value v at index i to join_value_with_delta(v, d, 1).
 
 Time Complexity:
 - O(n) per call to both constructors, where n is the size of the array.
@@ -40,16 +42,30 @@ Space Complexity:
 */
 
 #include <algorithm>  // std::max(), std::min()
+#include <limits>  // std::numeric_limits
 #include <vector>
 
-template<class T> class segment_tree {
-  static T join_values(const T &a, const T &b) {
-    return std::min(a, b);
+// The default policy of "min" queries and "assign" updates. The other policies
+// of section 3.3.2 (or any struct with the same members) may be used instead.
+template<class T> struct min_assign_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? a : b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return d;
   }
 
-  static T join_value_with_delta(const T &v, const T &d) {
-    return d;
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d2;  // For "assign" updates, the more recent delta prevails.
   }
+};
+
+template<class T, class Policy = min_assign_policy<T> > class segment_tree {
+  typedef typename Policy::delta_t delta_t;
 
   int len;
   std::vector<T> value;
@@ -61,7 +77,7 @@ template<class T> class segment_tree {
     }
     build(i*2 + 1, lo, (lo + hi)/2, val);
     build(i*2 + 2, (lo + hi)/2 + 1, hi, val);
-    value[i] = join_values(value[i*2 + 1], value[i*2 + 2]);
+    value[i] = Policy::join_values(value[i*2 + 1], value[i*2 + 2]);
   }
 
   template<class It> void build(int i, int lo, int hi, It arr) {
@@ -71,20 +87,20 @@ template<class T> class segment_tree {
     }
     build(i*2 + 1, lo, (lo + hi)/2, arr);
     build(i*2 + 2, (lo + hi)/2 + 1, hi, arr);
-    value[i] = join_values(value[i*2 + 1], value[i*2 + 2]);
+    value[i] = Policy::join_values(value[i*2 + 1], value[i*2 + 2]);
   }
 
-  void update(int i, int lo, int hi, int target, const T &delta) {
+  void update(int i, int lo, int hi, int target, const delta_t &delta) {
     if (target < lo || target > hi) {
       return;
     }
     if (lo == hi) {
-      value[i] = join_value_with_delta(value[i], delta);
+      value[i] = Policy::join_value_with_delta(value[i], delta, 1);
       return;
     }
     update(i*2 + 1, lo, (lo + hi)/2, target, delta);
     update(i*2 + 2, (lo + hi)/2 + 1, hi, target, delta);
-    value[i] = join_values(value[i*2 + 1], value[i*2 + 2]);
+    value[i] = Policy::join_values(value[i*2 + 1], value[i*2 + 2]);
   }
 
   T query(int i, int lo, int hi, int tgt_lo, int tgt_hi) {
@@ -93,7 +109,7 @@ template<class T> class segment_tree {
     }
     int mid = (lo + hi)/2;
     if (tgt_lo <= mid && mid < tgt_hi) {
-      return join_values(
+      return Policy::join_values(
                 query(i*2 + 1, lo, mid, tgt_lo, std::min(tgt_hi, mid)),
                 query(i*2 + 2, mid + 1, hi, std::max(tgt_lo, mid + 1), tgt_hi));
     }
@@ -107,7 +123,7 @@ template<class T> class segment_tree {
   segment_tree(int n, const T &v = T()) {
     len = n;
     value.resize(4*len);
-    build(0, 0, len - 1, false, 0, v);
+    build(0, 0, len - 1, v);
   }
 
   template<class It> segment_tree(It lo, It hi) {
@@ -128,7 +144,7 @@ template<class T> class segment_tree {
     return query(0, 0, len - 1, lo, hi);
   }
 
-  void update(int i, const T &d) {
+  void update(int i, const delta_t &d) {
     update(0, 0, len - 1, i, d);
   }
 };
@@ -3,25 +3,28 @@
 Maintain a fixed-size array while supporting both dynamic queries and updates of
 contiguous subarrays via the lazy propagation technique.
 
-The query operation is defined by an associative join_values() function which
-satisfies join_values(x, join_values(y, z)) = join_values(join_values(x, y), z)
-for all values x, y, and z in the array. The default code below assumes a
+The operations are defined by the static members of the template argument
+Policy. The query operation is defined by an associative join_values() function
+which satisfies join_values(x, join_values(y, z)) = join_values(join_values(x,
+y), z) for all values x, y, and z in the array. The default policy assumes a
 numerical array type, defining queries for the "min" of the target range.
 Another possible query operation is "sum", in which case the join_values()
-function should defined to return "a + b".
+function should return "a + b".
 
 The update operation is defined by the join_value_with_delta() and join_deltas()
-functions, which determines the change made to array values. These must satisfy:
+functions, which determine the change made to array values by a delta of type
+Policy::delta_t. These must satisfy:
 - join_deltas(d1, join_deltas(d2, d3)) = join_deltas(join_deltas(d1, d2), d3).
 - join_value_with_delta(join_values(v, ...(m times)..., v), d, m)) should be
   equal to join_values(join_value_with_delta(v, d, 1), ...(m times)).
 - if a sequence d_1, ..., d_m of deltas is used to update a value v, then
   join_value_with_delta(v, join_deltas(d_1, ..., d_m), 1) should be equivalent
   to m sequential calls to join_value_with_delta(v, d_i, 1) for i = 1..m.
-The default code below defines updates that "set" the chosen array index to a
-new value. Another possible update operation is "increment", in which case
-join_value_with_delta(v, d, len) should be defined to return "v + d*len" and
-join_deltas(d1, d2) should be defined to return "d1 + d2".
+The default policy defines updates that "assign" a new value to the chosen
+indices. Another possible update operation is "increment", in which case
+join_value_with_delta(v, d, len) should return "v + d*len" and join_deltas(d1,
+d2) should return "d1 + d2". Policies for several common combinations are given
+below, including "sum" queries with updates of the form v = a*v + b.
 
 - segment_tree(n, v) constructs an array of size n with indices from 0 to n - 1,
   inclusive, and all values initialized to v.
@@ -49,23 +52,108 @@ Space Complexity:
 */
 
 #include <algorithm>  // std::max(), std::min()
+#include <limits>  // std::numeric_limits
+#include <utility>  // std::pair
 #include <vector>
 
-template<class T> class segment_tree {
-  static T join_values(const T &a, const T &b) {
-    return std::min(a, b);
+// Ready-made policies, named by their query and update operations. A policy
+// defines the type of deltas, whether join_values() is commutative, the
+// identity value of join_values(), the join of n copies of a value, and the
+// three join functions described above. Since all members are static, calls
+// to them are resolved at compile time and inlined. Lengths are long long, so
+// that the same policies serve the sparse segment trees over 64-bit indices.
+template<class T> struct min_assign_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? a : b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return d;
   }
 
-  static T join_value_with_delta(const T &v, const T &d, int len) {
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d2;  // For "assign" updates, the more recent delta prevails.
+  }
+};
+
+template<class T> struct max_assign_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return -std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? b : a; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
     return d;
   }
 
-  static T join_deltas(const T &d1, const T &d2) {
-    return d2;  // For "set" updates, the more recent delta prevails.
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d2;
+  }
+};
+
+template<class T> struct min_add_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? a : b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return v + d;
+  }
+
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d1 + d2;
+  }
+};
+
+template<class T> struct sum_add_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return 0; }
+  static T join_repeated(const T &v, long long n) { return v*n; }
+  static T join_values(const T &a, const T &b) { return a + b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return v + d*len;
   }
 
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d1 + d2;
+  }
+};
+
+// Updates by a delta (a, b) replace each value v by a*v + b.
+template<class T> struct sum_affine_policy {
+  typedef std::pair<T, T> delta_t;
+  static const bool commutative = true;
+  static T identity() { return 0; }
+  static T join_repeated(const T &v, long long n) { return v*n; }
+  static T join_values(const T &a, const T &b) { return a + b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return d.first*v + d.second*len;
+  }
+
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return delta_t(d2.first*d1.first, d2.first*d1.second + d2.second);
+  }
+};
+
+template<class T, class Policy = min_assign_policy<T> > class segment_tree {
+  typedef typename Policy::delta_t delta_t;
+
   int len;
-  std::vector<T> value, delta;
+  std::vector<T> value;
+  std::vector<delta_t> delta;
   std::vector<bool> pending;
 
   void build(int i, int lo, int hi, const T &v) {
@@ -75,7 +163,7 @@ template<class T> class segment_tree {
     }
     build(i*2 + 1, lo, (lo + hi)/2, v);
     build(i*2 + 2, (lo + hi)/2 + 1, hi, v);
-    value[i] = join_values(value[i*2 + 1], value[i*2 + 2]);
+    value[i] = Policy::join_values(value[i*2 + 1], value[i*2 + 2]);
   }
 
   template<class It> void build(int i, int lo, int hi, It arr) {
@@ -85,16 +173,16 @@ template<class T> class segment_tree {
     }
     build(i*2 + 1, lo, (lo + hi)/2, arr);
     build(i*2 + 2, (lo + hi)/2 + 1, hi, arr);
-    value[i] = join_values(value[i*2 + 1], value[i*2 + 2]);
+    value[i] = Policy::join_values(value[i*2 + 1], value[i*2 + 2]);
   }
 
-  void update_delta(int i, const T &d, int lo, int hi) {
+  void update_delta(int i, const delta_t &d, int lo, int hi) {
     if (pending[i]) {
-      value[i] = join_value_with_delta(value[i], d, hi - lo + 1);
+      value[i] = Policy::join_value_with_delta(value[i], d, hi - lo + 1);
       if (lo != hi) {
         int l = 2*i + 1, r = 2*i + 2;
-        delta[l] = pending[l] ? join_deltas(delta[l], d) : d;
-        delta[r] = pending[r] ? join_deltas(delta[r], d) : d;
+        delta[l] = pending[l] ? Policy::join_deltas(delta[l], d) : d;
+        delta[r] = pending[r] ? Policy::join_deltas(delta[r], d) : d;
         pending[l] = pending[r] = true;
       }
     }
@@ -108,7 +196,7 @@ template<class T> class segment_tree {
     }
     int mid = (lo + hi)/2;
     if (tgt_lo <= mid && mid < tgt_hi) {
-      return join_values(
+      return Policy::join_values(
                 query(i*2 + 1, lo, mid, tgt_lo, std::min(tgt_hi, mid)),
                 query(i*2 + 2, mid + 1, hi, std::max(tgt_lo, mid + 1), tgt_hi));
     }
@@ -118,7 +206,7 @@ template<class T> class segment_tree {
     return query(i*2 + 2, mid + 1, hi, std::max(tgt_lo, mid + 1), tgt_hi);
   }
 
-  void update(int i, int lo, int hi, int tgt_lo, int tgt_hi, const T &d) {
+  void update(int i, int lo, int hi, int tgt_lo, int tgt_hi, const delta_t &d) {
     update_delta(i, delta[i], lo, hi);
     if (hi < tgt_lo || lo > tgt_hi) {
       return;
@@ -130,7 +218,7 @@ template<class T> class segment_tree {
     }
     update(2*i + 1, lo, (lo + hi)/2, tgt_lo, tgt_hi, d);
     update(2*i + 2, (lo + hi)/2 + 1, hi, tgt_lo, tgt_hi, d);
-    value[i] = join_values(value[2*i + 1], value[2*i + 2]);
+    value[i] = Policy::join_values(value[2*i + 1], value[2*i + 2]);
   }
 
  public:
@@ -162,11 +250,11 @@ template<class T> class segment_tree {
     return query(0, 0, len - 1, lo, hi);
   }
 
-  void update(int i, const T &d) {
+  void update(int i, const delta_t &d) {
     update(0, 0, len - 1, i, i, d);
   }
 
-  void update(int lo, int hi, const T &d) {
+  void update(int lo, int hi, const delta_t &d) {
     update(0, 0, len - 1, lo, hi, d);
   }
 };
@@ -177,6 +265,7 @@ Values: 6 -2 4 8 10
 The minimum value in the range [0, 3] is -2.
 Values: 5 5 5 1 5
 The minimum value in the range [0, 3] is 1.
+The sum of the values 5 4 4 5 5 is 23.
 
 ***/
 
@@ -202,5 +291,11 @@ int main() {
   }
   cout << endl << "The minimum value in the range [0, 3] is "
        << t.query(0, 3) << "." << endl;
+  // Sum queries with affine updates.
+  segment_tree<long long, sum_affine_policy<long long> > s(5, 1LL);
+  s.update(0, 4, make_pair(2LL, 3LL));
+  s.update(1, 2, make_pair(1LL, -1LL));
+  cout << "The sum of the values 5 4 4 5 5 is " << s.query(0, 4) << "."
+       << endl;
   return 0;
 }
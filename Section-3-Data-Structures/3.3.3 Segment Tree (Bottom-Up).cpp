@@ -0,0 +1,401 @@
+/*
+
+Maintain a fixed-size array while supporting both dynamic queries and updates of
+contiguous subarrays via the lazy propagation technique, using a segment tree
+which is traversed from the leaves upward by loops rather than by recursion.
+
+The operations are defined by the template argument Policy, whose members must
+satisfy the same properties as in the range update segment tree of this section,
+with the default policy likewise defining "min" queries and "assign" updates.
+
+The array is divided into blocks of BLOCK consecutive values, which are stored
+as a plain array. The tree has a leaf per block, holding the join of its values,
+and is stored implicitly in an array of size 2s, where s is the number of blocks
+rounded up to a power of two. Node k has children 2k and 2k + 1, and leaf b is
+node s + b. A query or update of a range applies the tree to the blocks entirely
+inside the range, walking up from both ends of the range of leaves as in the
+well-known non-recursive segment tree, while the values of the at most two
+partial blocks at the ends are processed directly, in simple loops over
+contiguous memory which compilers can vectorize. Pending deltas on the paths
+from the two ends to the root are pushed down by a loop from the top before the
+walk, and the joins on these paths are recomputed by a loop from the bottom
+afterwards. A pending delta of a leaf applies to all values of its block, which
+are only updated when the block is partially accessed.
+
+Joins are taken in order of indices unless Policy::commutative is set, so that
+join_values() need not be commutative. Since each query pushes the pending
+deltas on its two paths, a batch of queries may instead be answered by
+query(ranges, res), which first pushes every pending delta of the tree down to
+the leaves in one pass, and then answers each query without pushing.
+
+- segment_tree(n, v) constructs an array of size n with indices from 0 to n - 1,
+  inclusive, and all values initialized to v.
+- segment_tree(lo, hi) constructs an array from two RandomAccessIterators as a
+  range [lo, hi), initialized to the elements of the range in the same order.
+- size() returns the size of the array.
+- at(i) returns the value at index i, where i is between 0 and size() - 1.
+- query(lo, hi) returns the result of join_values() applied to all indices from
+  lo to hi, inclusive.
+- query(ranges, res) sets res[j] to query(ranges[j].first, ranges[j].second) for
+  each j.
+- update(i, d) assigns the value v at index i to join_value_with_delta(v, d, 1).
+- update(lo, hi, d) modifies the value at each array index from lo to hi,
+  inclusive, by respectively joining them with d using join_value_with_delta().
+
+Time Complexity:
+- O(n) per call to both constructors, where n is the size of the array.
+- O(1) per call to size().
+- O(BLOCK + log n) per call to at(), update(), and query(lo, hi).
+- O(n/BLOCK + q*BLOCK + q*log n) per call to query(ranges, res) for q ranges.
+
+Space Complexity:
+- O(n) for storage of the array elements, of which the tree takes O(n/BLOCK).
+- O(1) auxiliary per call to all operations except query(ranges, res), which
+  uses O(q) auxiliary space for its result.
+
+*/
+
+#include <algorithm>  // std::min()
+#include <limits>  // std::numeric_limits
+#include <utility>  // std::pair
+#include <vector>
+
+// The default policy of "min" queries and "assign" updates. The other policies
+// of section 3.3.2 (or any struct with the same members) may be used instead.
+template<class T> struct min_assign_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? a : b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return d;
+  }
+
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d2;  // For "assign" updates, the more recent delta prevails.
+  }
+};
+
+template<class T, class Policy = min_assign_policy<T> > class segment_tree {
+  typedef typename Policy::delta_t delta_t;
+
+  static const int BLOCK = 16;
+
+  int len, levels, leaves;
+  std::vector<T> elem, value;
+  std::vector<delta_t> delta;
+  std::vector<char> pending;
+  std::vector<int> count;  // The number of array values under each node.
+
+  void apply(int k, const delta_t &d) {
+    value[k] = Policy::join_value_with_delta(value[k], d, count[k]);
+    delta[k] = pending[k] ? Policy::join_deltas(delta[k], d) : d;
+    pending[k] = true;
+  }
+
+  void push(int k) {
+    if (pending[k]) {
+      if (count[2*k] > 0) {
+        apply(2*k, delta[k]);
+      }
+      if (count[2*k + 1] > 0) {
+        apply(2*k + 1, delta[k]);
+      }
+      pending[k] = false;
+    }
+  }
+
+  void pull(int k) {
+    if (count[2*k + 1] > 0) {
+      value[k] = Policy::join_values(value[2*k], value[2*k + 1]);
+    } else {
+      value[k] = value[2*k];
+    }
+  }
+
+  // Pushes the deltas of all proper ancestors of node k, from the root down.
+  void push_path(int k) {
+    for (int i = levels; i > 0; i--) {
+      push(k >> i);
+    }
+  }
+
+  void pull_path(int k) {
+    for (k >>= 1; k > 0; k >>= 1) {
+      pull(k);
+    }
+  }
+
+  // Applies the pending delta of leaf b to the values of block b.
+  void push_block(int b) {
+    int k = leaves + b;
+    if (pending[k]) {
+      for (int i = b*BLOCK, hi = std::min(len, i + BLOCK); i < hi; i++) {
+        elem[i] = Policy::join_value_with_delta(elem[i], delta[k], 1);
+      }
+      pending[k] = false;
+    }
+  }
+
+  T reduce(int lo, int hi) const {
+    T res = elem[lo];
+    for (int i = lo + 1; i <= hi; i++) {
+      res = Policy::join_values(res, elem[i]);
+    }
+    return res;
+  }
+
+  void pull_block(int b) {
+    value[leaves + b] = reduce(b*BLOCK, std::min(len, (b + 1)*BLOCK) - 1);
+  }
+
+  void init() {
+    int blocks = (len + BLOCK - 1)/BLOCK;
+    for (levels = 0, leaves = 1; leaves < blocks; levels++) {
+      leaves *= 2;
+    }
+    value.resize(2*leaves);
+    delta.resize(2*leaves);
+    pending.assign(2*leaves, false);
+    count.assign(2*leaves, 0);
+    for (int b = 0; b < blocks; b++) {
+      count[leaves + b] = std::min(len, (b + 1)*BLOCK) - b*BLOCK;
+      pull_block(b);
+    }
+    for (int k = leaves - 1; k > 0; k--) {
+      count[k] = count[2*k] + count[2*k + 1];
+      if (count[2*k] > 0) {
+        pull(k);
+      }
+    }
+  }
+
+  // Returns the join over the blocks from bl to br, inclusive.
+  T query_blocks(int bl, int br, bool push_paths) {
+    int l = leaves + bl, r = leaves + br + 1;
+    if (push_paths) {
+      for (int i = levels; i > 0; i--) {
+        if (((l >> i) << i) != l) {
+          push(l >> i);
+        }
+        if (((r >> i) << i) != r) {
+          push((r - 1) >> i);
+        }
+      }
+    }
+    // A commutative join needs no separate accumulator for the right side.
+    T left = Policy::identity(), right = Policy::identity();
+    for (; l < r; l >>= 1, r >>= 1) {
+      if (l & 1) {
+        left = Policy::join_values(left, value[l++]);
+      }
+      if (r & 1) {
+        r--;
+        if (Policy::commutative) {
+          left = Policy::join_values(left, value[r]);
+        } else {
+          right = Policy::join_values(value[r], right);
+        }
+      }
+    }
+    return Policy::commutative ? left : Policy::join_values(left, right);
+  }
+
+  void update_blocks(int bl, int br, const delta_t &d) {
+    int l0 = leaves + bl, r0 = leaves + br + 1;
+    for (int i = levels; i > 0; i--) {
+      if (((l0 >> i) << i) != l0) {
+        push(l0 >> i);
+      }
+      if (((r0 >> i) << i) != r0) {
+        push((r0 - 1) >> i);
+      }
+    }
+    for (int l = l0, r = r0; l < r; l >>= 1, r >>= 1) {
+      if (l & 1) {
+        apply(l++, d);
+      }
+      if (r & 1) {
+        apply(--r, d);
+      }
+    }
+    for (int i = 1; i <= levels; i++) {
+      if (((l0 >> i) << i) != l0) {
+        pull(l0 >> i);
+      }
+      if (((r0 >> i) << i) != r0) {
+        pull((r0 - 1) >> i);
+      }
+    }
+  }
+
+  // Returns the join of the values from lo to hi within block b.
+  T query_partial(int b, int lo, int hi, bool push_paths) {
+    if (push_paths) {
+      push_path(leaves + b);
+    }
+    push_block(b);
+    return reduce(lo, hi);
+  }
+
+  void update_partial(int b, int lo, int hi, const delta_t &d) {
+    push_path(leaves + b);
+    push_block(b);
+    for (int i = lo; i <= hi; i++) {
+      elem[i] = Policy::join_value_with_delta(elem[i], d, 1);
+    }
+    pull_block(b);
+    pull_path(leaves + b);
+  }
+
+  // Splits [lo, hi] into a partial block at each end and the whole blocks from
+  // bl to br in between, which may be empty (bl > br).
+  void split(int lo, int hi, int &bl, int &br) const {
+    bl = (lo % BLOCK == 0) ? lo/BLOCK : lo/BLOCK + 1;
+    br = (hi == len - 1 || hi % BLOCK == BLOCK - 1) ? hi/BLOCK : hi/BLOCK - 1;
+  }
+
+  T query(int lo, int hi, bool push_paths) {
+    if (lo/BLOCK == hi/BLOCK) {
+      return query_partial(lo/BLOCK, lo, hi, push_paths);
+    }
+    int bl, br;
+    split(lo, hi, bl, br);
+    T res = Policy::identity();
+    if (lo < bl*BLOCK) {
+      res = query_partial(lo/BLOCK, lo, bl*BLOCK - 1, push_paths);
+    }
+    if (bl <= br) {
+      res = Policy::join_values(res, query_blocks(bl, br, push_paths));
+    }
+    if ((br + 1)*BLOCK <= hi) {
+      res = Policy::join_values(res, query_partial(hi/BLOCK, (br + 1)*BLOCK, hi,
+                                           push_paths));
+    }
+    return res;
+  }
+
+ public:
+  segment_tree(int n, const T &v = T()) : len(n), elem(n, v) {
+    init();
+  }
+
+  template<class It> segment_tree(It lo, It hi) : len(hi - lo), elem(lo, hi) {
+    init();
+  }
+
+  int size() const {
+    return len;
+  }
+
+  T at(int i) {
+    push_path(leaves + i/BLOCK);
+    push_block(i/BLOCK);
+    return elem[i];
+  }
+
+  T query(int lo, int hi) {
+    return query(lo, hi, true);
+  }
+
+  void query(const std::vector<std::pair<int, int> > &ranges,
+             std::vector<T> &res) {
+    for (int k = 1; k < leaves; k++) {
+      push(k);
+    }
+    res.resize(ranges.size());
+    for (int j = 0; j < (int)ranges.size(); j++) {
+      res[j] = query(ranges[j].first, ranges[j].second, false);
+    }
+  }
+
+  void update(int i, const delta_t &d) {
+    update(i, i, d);
+  }
+
+  void update(int lo, int hi, const delta_t &d) {
+    if (lo/BLOCK == hi/BLOCK) {
+      update_partial(lo/BLOCK, lo, hi, d);
+      return;
+    }
+    int bl, br;
+    split(lo, hi, bl, br);
+    if (lo < bl*BLOCK) {
+      update_partial(lo/BLOCK, lo, bl*BLOCK - 1, d);
+    }
+    if ((br + 1)*BLOCK <= hi) {
+      update_partial(hi/BLOCK, (br + 1)*BLOCK, hi, d);
+    }
+    if (bl <= br) {
+      update_blocks(bl, br, d);
+    }
+  }
+};
+
+/*** Example Usage and Output:
+
+Values: 6 -2 4 8 10
+The minimum value in the range [0, 3] is -2.
+Values: 5 5 5 1 5
+The minimum value in the range [0, 3] is 1.
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // std::rand()
+#include <iostream>
+using namespace std;
+
+int main() {
+  {
+    int arr[5] = {6, -2, 1, 8, 10};
+    segment_tree<int> t(arr, arr + 5);
+    t.update(2, 4);
+    cout << "Values:";
+    for (int i = 0; i < t.size(); i++) {
+      cout << " " << t.at(i);
+    }
+    cout << endl << "The minimum value in the range [0, 3] is "
+         << t.query(0, 3) << "." << endl;
+    t.update(0, 4, 5);
+    t.update(3, 2);
+    t.update(3, 1);
+    cout << "Values:";
+    for (int i = 0; i < t.size(); i++) {
+      cout << " " << t.at(i);
+    }
+    cout << endl << "The minimum value in the range [0, 3] is "
+         << t.query(0, 3) << "." << endl;
+  }
+  {
+    // Random updates and batches of queries, checked against a plain array.
+    const int n = 1000;
+    vector<int> a(n, 0);
+    segment_tree<int> t(n, 0);
+    for (int it = 0; it < 2000; it++) {
+      int lo = rand() % n, hi = lo + rand() % (n - lo), d = rand() % 1000;
+      t.update(lo, hi, d);
+      for (int i = lo; i <= hi; i++) {
+        a[i] = d;
+      }
+      vector<pair<int, int> > ranges;
+      for (int j = 0; j < 5; j++) {
+        lo = rand() % n;
+        ranges.push_back(make_pair(lo, lo + rand() % (n - lo)));
+      }
+      vector<int> res;
+      t.query(ranges, res);
+      for (int j = 0; j < 5; j++) {
+        int m = a[ranges[j].first];
+        for (int i = ranges[j].first; i <= ranges[j].second; i++) {
+          m = min(m, a[i]);
+        }
+        assert(res[j] == m && t.query(ranges[j].first, ranges[j].second) == m);
+      }
+    }
+  }
+  return 0;
+}
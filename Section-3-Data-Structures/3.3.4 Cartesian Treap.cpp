@@ -5,65 +5,190 @@ supporting both dynamic queries and updates of contiguous subarrays via the lazy
 propagation technique. A treap maintains a balanced binary tree structure by
 preserving the heap property on the randomly generated priority values of nodes,
 thereby making insertions and deletions run in O(log n) with high probability.
+The priorities are drawn from a xorshift generator, which is much cheaper than
+rand() and yields 31 random bits at once.
 
-The query operation is defined by an associative join_values() function which
-satisfies join_values(x, join_values(y, z)) = join_values(join_values(x, y), z)
-for all values x, y, and z in the array. The default code below assumes a
-numerical array type, defining queries for the "min" of the target range.
-Another possible query operation is "sum", in which case the join_values()
-function should defined to return "a + b".
-
-The update operation is defined by the join_value_with_delta() and join_deltas()
-functions, which determines the change made to array values. These must satisfy:
-- join_deltas(d1, join_deltas(d2, d3)) = join_deltas(join_deltas(d1, d2), d3).
-- join_value_with_delta(join_values(v, ...(m times)..., v), d, m)) should be
-  equal to join_values(join_value_with_delta(v, d, 1), ...(m times)).
-- if a sequence d_1, ..., d_m of deltas is used to update a value v, then
-  join_value_with_delta(v, join_deltas(d_1, ..., d_m), 1) should be equivalent
-  to m sequential calls to join_value_with_delta(v, d_i, 1) for i = 1..m.
-The default code below defines updates that "set" the chosen array index to a
-new value. Another possible update operation is "increment", in which case
-join_value_with_delta(v, d, len) should be defined to return "v + d*len" and
-join_deltas(d1, d2) should be defined to return "d1 + d2".
+The query and update operations are defined by the static members of the
+template argument Policy, which must satisfy the same properties as in the range
+update segment tree of this section (any policy from there may be used). The
+query operation is defined by an associative join_values() function, and the
+update operation by the join_value_with_delta() and join_deltas() functions on
+deltas of type Policy::delta_t. The default policy defines queries for the "min"
+of the target range and updates that "assign" the chosen indices a new value.
 
 This data structure shares every operation of one-dimensional segment trees in
 this section, with the additional operations empty(), insert(), erase(),
 push_back(), and pop_back() analogous to those of std::vector (the difference
-here is that, insert() and erase() both take an index instead of an iterator).
+here is that, insert() and erase() both take an index instead of an iterator),
+and clear() which empties the array. The following operations act on many
+elements at once:
+- insert(i, lo, hi) inserts the values in the range [lo, hi) before index i.
+- erase(lo, hi) removes the elements from index lo to hi, inclusive.
+- concat(t) moves every element of t to the end of this array, leaving t empty.
+- split(i, t) moves the elements from index i onward to the end of t.
+
+The constructors and insert(i, lo, hi) build a treap of the new values in linear
+time, attaching each value to the right spine of the treap of the values before
+it (as for a Cartesian tree). Only the nodes popped off the right spine have
+their subtree values recomputed. This is much faster than one insertion per
+value, which splits the treap again for each value.
+
+Nodes are allocated from the template argument Pool, by default a slab allocator
+which reuses erased nodes through a free list. clear() and the destructor free
+all nodes by a sweep over the slabs, without traversing the tree.
 
 Time Complexity:
 - O(n) per call to both constructors, where n is the size of the array.
+- O(m + log n) on average per call to insert(i, lo, hi), erase(lo, hi), and
+  split(i, t), where m is the number of elements inserted, erased, or moved.
+- O(log n + s) on average per call to concat(t), where s is the number of slabs
+  of t's pool.
 - O(1) per call to size() and empty().
+- O(n) per call to clear() and the destructor, or O(log n) if T has a trivial
+  destructor.
 - O(log n) on average per call to all other operations.
 
 Space Complexity:
 - O(n) for storage of the array elements.
 - O(1) auxiliary per call to size() and empty().
+- O(m) auxiliary per call to the constructors, insert(i, lo, hi), and
+  split(i, t) for the right spine and the elements moved.
 - O(log n) auxiliary stack space per call to all other operations.
 
 */
 
 #include <cstdlib>  // NULL, rand()
+#include <limits>  // std::numeric_limits
+#include <new>  // placement new
+#include <utility>  // std::pair
+#include <vector>
+
+// A slab allocator for nodes with a free list, as in section 3.5.1, which can
+// also take over the nodes of another pool when two arrays are concatenated.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  struct slab {
+    slot *slots;
+    size_t size, used;
+  };
+
+  std::vector<slab> slabs;
+  slot *free_list, *free_tail;
+
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
 
-template<class T> class cartesian_treap {
-  static T join_values(const T &a, const T &b) {
-    return a < b ? a : b;
+ public:
+  node_pool() : free_list(NULL), free_tail(NULL) {}
+
+  ~node_pool() {
+    clear();
+  }
+
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != NULL) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || slabs.back().used == slabs.back().size) {
+        slab b;
+        b.size = slabs.empty() ? 64 : 2*slabs.back().size;
+        b.slots = new slot[b.size];
+        b.used = 0;
+        slabs.push_back(b);
+      }
+      s = slabs.back().slots + slabs.back().used++;
+    }
+    s->next = s;
+    return s->u.data;
+  }
+
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    if (free_list == NULL) {
+      free_tail = s;
+    }
+    s->next = free_list;
+    free_list = s;
+  }
+
+  // Takes over the slabs and free slots of p, leaving p empty.
+  void absorb(node_pool &p) {
+    slabs.insert(slabs.end(), p.slabs.begin(), p.slabs.end());
+    if (p.free_list != NULL) {
+      p.free_tail->next = free_list;
+      if (free_list == NULL) {
+        free_tail = p.free_tail;
+      }
+      free_list = p.free_list;
+    }
+    p.slabs.clear();
+    p.free_list = NULL;
   }
 
-  static T join_value_with_delta(const T &v, const T &d, int len) {
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        for (size_t j = 0; j < slabs[i].used; j++) {
+          slot *s = slabs[i].slots + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].slots;
+    }
+    slabs.clear();
+    free_list = NULL;
+  }
+};
+
+// The default policy of "min" queries and "assign" updates. The other policies
+// of section 3.3.2 (or any struct with the same members) may be used instead.
+template<class T> struct min_assign_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? a : b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
     return d;
   }
 
-  static T join_deltas(const T &d1, const T &d2) {
-    return d2;
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d2;  // For "assign" updates, the more recent delta prevails.
   }
+};
+
+template<class T, class Policy = min_assign_policy<T>,
+         template<class> class Pool = node_pool>
+class cartesian_treap {
+  typedef typename Policy::delta_t delta_t;
 
   struct node_t {
     static inline int rand32() {
-      return (rand() & 0x7fff) | ((rand() & 0x7fff) << 15);
+      static unsigned int x = 2463534241u;
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      return (int)(x >> 1);
     }
 
-    T value, subtree_value, delta;
+    T value, subtree_value;
+    delta_t delta;
     bool pending;
     int size, priority;
     node_t *left, *right;
@@ -77,6 +202,8 @@ template<class T> class cartesian_treap {
     }
   } *root;
 
+  Pool<node_t> pool;
+
   static int size(node_t *n) {
     return (n == NULL) ? 0 : n->size;
   }
@@ -85,19 +212,26 @@ template<class T> class cartesian_treap {
     if (n == NULL) {
       return;
     }
+    // A child's subtree value is only current once its delta is applied.
+    push_delta(n->left);
+    push_delta(n->right);
+    // Values are joined in order of indices, as join_values() need not be
+    // commutative.
     n->subtree_value = n->value;
     if (n->left != NULL) {
-      n->subtree_value = join_values(n->subtree_value, n->left->subtree_value);
+      n->subtree_value = Policy::join_values(n->left->subtree_value,
+                                             n->subtree_value);
     }
     if (n->right != NULL) {
-      n->subtree_value = join_values(n->subtree_value, n->right->subtree_value);
+      n->subtree_value = Policy::join_values(n->subtree_value,
+                                             n->right->subtree_value);
     }
     n->size = 1 + size(n->left) + size(n->right);
   }
 
-  static void update_delta(node_t *n, const T &d) {
+  static void update_delta(node_t *n, const delta_t &d) {
     if (n != NULL) {
-      n->delta = n->pending ? join_deltas(n->delta, d) : d;
+      n->delta = n->pending ? Policy::join_deltas(n->delta, d) : d;
       n->pending = true;
     }
   }
@@ -106,9 +240,9 @@ template<class T> class cartesian_treap {
     if (n == NULL || !n->pending) {
       return;
     }
-    n->value = join_value_with_delta(n->value, n->delta, 1);
-    n->subtree_value = join_value_with_delta(n->subtree_value, n->delta,
-                                             n->size);
+    n->value = Policy::join_value_with_delta(n->value, n->delta, 1);
+    n->subtree_value = Policy::join_value_with_delta(n->subtree_value,
+                                                     n->delta, n->size);
     if (n->size > 1) {
       update_delta(n->left, n->delta);
       update_delta(n->right, n->delta);
@@ -162,11 +296,12 @@ template<class T> class cartesian_treap {
     update_value(n);
   }
 
-  static void erase(node_t *&n, int i) {
+  void erase(node_t *&n, int i) {
     push_delta(n);
     if (i == size(n->left)) {
-      delete n;
-      merge(n, n->left, n->right);
+      node_t *left = n->left, *right = n->right;
+      pool.destroy(n);
+      merge(n, left, right);
     } else if (i < size(n->left)) {
       erase(n->left, i);
     } else {
@@ -175,6 +310,48 @@ template<class T> class cartesian_treap {
     update_value(n);
   }
 
+  // Appends a node for v to the treap given by its right spine, recomputing
+  // the values of the nodes which are popped off the spine.
+  void push_spine(std::vector<node_t*> &spine, const T &v) {
+    node_t *n = new (pool.allocate()) node_t(v), *last = NULL;
+    while (!spine.empty() && n->priority < spine.back()->priority) {
+      last = spine.back();
+      update_value(last);
+      spine.pop_back();
+    }
+    n->left = last;
+    if (!spine.empty()) {
+      spine.back()->right = n;
+    }
+    spine.push_back(n);
+  }
+
+  static node_t* finish_spine(std::vector<node_t*> &spine) {
+    for (int i = (int)spine.size() - 1; i >= 0; i--) {
+      update_value(spine[i]);
+    }
+    return spine.empty() ? NULL : spine[0];
+  }
+
+  // Appends the values of the subtree of n to out in order, destroying n.
+  void collect(node_t *n, std::vector<T> &out) {
+    if (n != NULL) {
+      push_delta(n);
+      collect(n->left, out);
+      out.push_back(n->value);
+      collect(n->right, out);
+      pool.destroy(n);
+    }
+  }
+
+  void destroy(node_t *n) {
+    if (n != NULL) {
+      destroy(n->left);
+      destroy(n->right);
+      pool.destroy(n);
+    }
+  }
+
   static node_t* select(node_t *n, int i) {
     push_delta(n);
     if (i < size(n->left)) {
@@ -186,32 +363,21 @@ template<class T> class cartesian_treap {
     return n;
   }
 
-  void clean_up(node_t *&n) {
-    if (n == NULL) {
-      return;
-    }
-    clean_up(n->left);
-    clean_up(n->right);
-    delete n;
-  }
-
  public:
   cartesian_treap(int n = 0, const T &v = T()) {
-    root = NULL;
+    std::vector<node_t*> spine;
     for (int i = 0; i < n; i++) {
-      push_back(v);
+      push_spine(spine, v);
     }
+    root = finish_spine(spine);
   }
 
   template<class It> cartesian_treap(It lo, It hi) {
-    root = NULL;
+    std::vector<node_t*> spine;
     for (; lo != hi; ++lo) {
-      push_back(*lo);
+      push_spine(spine, *lo);
     }
-  }
-
-  ~cartesian_treap() {
-    clean_up(root);
+    root = finish_spine(spine);
   }
 
   int size() const {
@@ -222,15 +388,56 @@ template<class T> class cartesian_treap {
     return root == NULL;
   }
 
+  void clear() {
+    pool.clear();
+    root = NULL;
+  }
+
   void insert(int i, const T &v) {
-    node_t *new_node = new node_t(v);
+    node_t *new_node = new (pool.allocate()) node_t(v);
     insert(root, new_node, i);
   }
 
+  template<class It> void insert(int i, It lo, It hi) {
+    std::vector<node_t*> spine;
+    for (; lo != hi; ++lo) {
+      push_spine(spine, *lo);
+    }
+    node_t *l, *r, *t;
+    split(root, l, r, i);
+    merge(t, l, finish_spine(spine));
+    merge(root, t, r);
+  }
+
   void erase(int i) {
     erase(root, i);
   }
 
+  void erase(int lo, int hi) {
+    node_t *l1, *r1, *l2, *r2;
+    split(root, l1, r1, hi + 1);
+    split(l1, l2, r2, lo);
+    destroy(r2);
+    merge(root, l2, r1);
+  }
+
+  void concat(cartesian_treap &t) {
+    if (&t != this) {
+      pool.absorb(t.pool);
+      merge(root, root, t.root);
+      t.root = NULL;
+    }
+  }
+
+  void split(int i, cartesian_treap &t) {
+    node_t *l, *r;
+    split(root, l, r, i);
+    root = l;
+    std::vector<T> values;
+    collect(r, values);
+    t.insert(t.size(), values.begin(), values.end());
+  }
+
   void push_back(const T &v) {
     insert(size(), v);
   }
@@ -253,11 +460,11 @@ template<class T> class cartesian_treap {
     return res;
   }
 
-  void update(int i, const T &d) {
+  void update(int i, const delta_t &d) {
     update(i, i, d);
   }
 
-  void update(int lo, int hi, const T &d) {
+  void update(int lo, int hi, const delta_t &d) {
     node_t *l1, *r1, *l2, *r2, *t;
     split(root, l1, r1, hi + 1);
     split(l1, l2, r2, lo);
@@ -269,9 +476,11 @@ template<class T> class cartesian_treap {
 
 /*** Example Usage and Output:
 
-Values: -99 -2 1 8 10 11 (min: -99)
-Values: -90 -2 1 8 10 11 (min: -90)
+Values: 99 -2 1 8 10 11 (min: -2)
+Values: 90 -2 1 8 10 11 (min: -2)
 Values: 2 2 1 8 10 11 (min: 1)
+Values: 5 (min: 5)
+Values: 3 1 5 (min: 1)
 
 ***/
 
@@ -298,5 +507,15 @@ int main() {
   print(t);
   t.update(0, 1, 2);
   print(t);
+  t.clear();
+  t.push_back(5);
+  print(t);
+  int more[4] = {3, 1, 4, 1};
+  t.insert(0, more, more + 4);
+  cartesian_treap<int> u;
+  t.split(2, u);
+  t.concat(u);
+  t.erase(1, 2);
+  print(t);
   return 0;
 }
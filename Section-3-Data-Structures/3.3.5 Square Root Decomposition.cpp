@@ -3,59 +3,139 @@
 Maintain a fixed-size array (from 0 to size() - 1) while supporting dynamic
 queries of contiguous sub-arrays and dynamic updates of individual indices.
 
-The query operation is defined by an associative join_values() function which:
-satisfies join_values(x, join_values(y, z)) = join_values(join_values(x, y), z)
-for all values x, y, and z in the array. The default definition below assumes a
-numerical array type, supporting queries for the "min" of the target range.
-Another possible query operation is "sum", in which the join_values() function
-should defined to return "a + b".
-
-The update operation is defined by the join_value_with_delta() function, which
-determines the change made to array values. The default definition below
-supports updates that "set" the chosen array index to a new value. Another
-possible update operation is "increment", in which join_value_with_delta(v, d)
-should be defined to return "v + d".
-
-The operations supported by this data structure are identical to those of the
-point update segment tree found in this section.
+The operations supported by this data structure, and the Policy template
+argument defining them, are identical to those of the point update segment tree
+found in this section. The query operation is defined by an associative
+join_values() function, which by default returns the "min" of two values. The
+update operation is defined by join_value_with_delta(v, d, 1), which by default
+"assigns" the chosen array index the new value d.
+
+The block length is sqrt(n) rounded up to a whole number of cache lines, so
+that the scan of a whole block touches as few lines as possible. Every scan, of
+a partial block or of the joins of whole blocks, is a single loop over
+contiguous memory into one accumulator, which compilers can vectorize for simple
+joins such as "min" or "sum". query(ranges, res) answers a batch of queries in
+the order of a Hilbert curve through the points (lo, hi), so that consecutive
+queries scan nearby memory. Since queries do not modify the structure, a large
+batch may also be split into parts which are answered separately.
+
+- query(ranges, res) sets res[j] to query(ranges[j].first, ranges[j].second) for
+  each j.
+
+mo_queries() answers a batch of offline queries by Mo's algorithm, for queries
+which cannot be answered from the joins of blocks but whose answer can be
+maintained for a window [lo, hi] of the array as single elements are added to
+or removed from either end (such as the number of distinct values). The window
+w must define add(i), remove(i), and answer(), and starts empty. The queries
+are visited in the order of a Hilbert curve, which moves the window O(n sqrt q)
+indices in total over q queries and keeps it in cache. Parts of a batch may be
+answered separately, each with its own window.
 
 Time Complexity:
 - O(n) per call to both constructors, where n is the size of the array.
 - O(1) per call to size().
-- O(sqrt n) per call to at(), update(), and query().
+- O(sqrt n) per call to at(), update(), and query(lo, hi).
+- O(q log q + q sqrt n) per call to query(ranges, res) for q ranges.
+- O(q log q) plus O(n sqrt q) calls to add() and remove() per call to
+  mo_queries().
 
 Space Complexity:
 - O(n) for storage of the array elements.
-- O(1) auxiliary per call to all operations.
+- O(q) auxiliary per call to query(ranges, res) and mo_queries(), and O(1)
+  auxiliary per call to all other operations.
 
 */
 
-#include <algorithm>  // std::min()
+#include <algorithm>  // std::min(), std::sort(), std::swap()
 #include <cmath>  // sqrt()
+#include <limits>  // std::numeric_limits
+#include <utility>  // std::pair
 #include <vector>
 
-template<class T> class sqrt_decomposition {
-  static T join_values(const T &a, const T &b) {
-    return std::min(a, b);
-  }
+// The default policy of "min" queries and "assign" updates. The other policies
+// of section 3.3.2 (or any struct with the same members) may be used instead.
+template<class T> struct min_assign_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? a : b; }
 
-  static T join_value_with_delta(const T &v, const T &d) {
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
     return d;
   }
 
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d2;  // For "assign" updates, the more recent delta prevails.
+  }
+};
+
+// Returns the distance along a Hilbert curve through a 2^levels by 2^levels
+// grid to the point (x, y).
+inline long long hilbert_order(int x, int y, int levels) {
+  long long d = 0;
+  for (int s = 1 << (levels - 1); s > 0; s >>= 1) {
+    int rx = (x & s) > 0, ry = (y & s) > 0;
+    d += (long long)s*s*((3*rx) ^ ry);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = (1 << levels) - 1 - x;
+        y = (1 << levels) - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+// Sets order to the indices of ranges, sorted along a Hilbert curve.
+inline void hilbert_sort(const std::vector<std::pair<int, int> > &ranges,
+                         std::vector<int> &order) {
+  int levels = 1;
+  for (int j = 0; j < (int)ranges.size(); j++) {
+    while ((1 << levels) <= std::max(ranges[j].first, ranges[j].second)) {
+      levels++;
+    }
+  }
+  std::vector<std::pair<long long, int> > keys(ranges.size());
+  for (int j = 0; j < (int)ranges.size(); j++) {
+    keys[j] = std::make_pair(
+        hilbert_order(ranges[j].first, ranges[j].second, levels), j);
+  }
+  std::sort(keys.begin(), keys.end());
+  order.resize(keys.size());
+  for (int j = 0; j < (int)keys.size(); j++) {
+    order[j] = keys[j].second;
+  }
+}
+
+template<class T, class Policy = min_assign_policy<T> >
+class sqrt_decomposition {
+  typedef typename Policy::delta_t delta_t;
+
+  static const int CACHE_LINE = 64;
+
   int len, blocklen;
   std::vector<T> value, block;
 
+  // Returns the join of v[lo] to v[hi], inclusive, where lo <= hi.
+  static T reduce(const std::vector<T> &v, int lo, int hi) {
+    T res = v[lo];
+    for (int i = lo + 1; i <= hi; i++) {
+      res = Policy::join_values(res, v[i]);
+    }
+    return res;
+  }
+
   void init() {
-    blocklen = (int)sqrt(len);
+    int line = std::max(1, (int)(CACHE_LINE/sizeof(T)));
+    blocklen = std::max(1, (int)sqrt(len));
+    blocklen = (blocklen + line - 1)/line*line;
     int nblocks = (len + blocklen - 1)/blocklen;
+    block.resize(nblocks);
     for (int i = 0; i < nblocks; i++) {
-      T blockval = value[i*blocklen];
-      int blockhi = std::min(len, (i + 1)*blocklen);
-      for (int j = i*blocklen + 1; j < blockhi; j++) {
-        blockval = join_values(blockval, value[j]);
-      }
-      block.push_back(blockval);
+      block[i] = reduce(value, i*blocklen, std::min(len, (i + 1)*blocklen) - 1);
     }
   }
 
@@ -76,45 +156,71 @@ template<class T> class sqrt_decomposition {
     return len;
   }
 
-  T at(int i) {
-    return query(i, i);
+  T at(int i) const {
+    return value[i];
   }
 
-  T query(int lo, int hi) {
-    T res;
-    int blocklo = ceil((double)lo/blocklen);
+  T query(int lo, int hi) const {
+    int blocklo = (lo + blocklen - 1)/blocklen;
     int blockhi = (hi + 1)/blocklen - 1;
     if (blocklo > blockhi) {
-      res = value[lo];
-      for (int i = lo + 1; i <= hi; i++) {
-        res = join_values(res, value[i]);
-      }
-    } else {
-      res = block[blocklo];
-      for (int i = blocklo + 1; i <= blockhi; i++) {
-        res = join_values(res, block[i]);
-      }
-      for (int i = lo; i < blocklo*blocklen; i++) {
-        res = join_values(res, value[i]);
-      }
-      for (int i = (blockhi + 1)*blocklen; i <= hi; i++) {
-        res = join_values(res, value[i]);
-      }
+      return reduce(value, lo, hi);
+    }
+    // The partial blocks are joined in order of indices around the whole ones.
+    T res = reduce(block, blocklo, blockhi);
+    if (lo < blocklo*blocklen) {
+      res = Policy::join_values(reduce(value, lo, blocklo*blocklen - 1), res);
+    }
+    if ((blockhi + 1)*blocklen <= hi) {
+      res = Policy::join_values(res, reduce(value, (blockhi + 1)*blocklen, hi));
     }
     return res;
   }
 
-  void update(int i, const T &d) {
-    value[i] = join_value_with_delta(value[i], d);
-    int b = i/blocklen;
-    int blockhi = std::min(len, (b + 1)*blocklen);
-    block[b] = value[b*blocklen];
-    for (int i = b*blocklen + 1; i < blockhi; i++) {
-      block[b] = join_values(block[b], value[i]);
+  void query(const std::vector<std::pair<int, int> > &ranges,
+             std::vector<T> &res) const {
+    std::vector<int> order;
+    hilbert_sort(ranges, order);
+    res.resize(ranges.size());
+    for (int j = 0; j < (int)order.size(); j++) {
+      res[order[j]] = query(ranges[order[j]].first, ranges[order[j]].second);
     }
   }
+
+  void update(int i, const delta_t &d) {
+    value[i] = Policy::join_value_with_delta(value[i], d, 1);
+    int b = i/blocklen;
+    block[b] = reduce(value, b*blocklen, std::min(len, (b + 1)*blocklen) - 1);
+  }
 };
 
+// Sets res[j] to the answer of window w for the range ranges[j], inclusive.
+template<class Window, class R>
+void mo_queries(const std::vector<std::pair<int, int> > &ranges, Window &w,
+                std::vector<R> &res) {
+  std::vector<int> order;
+  hilbert_sort(ranges, order);
+  res.resize(ranges.size());
+  int lo = 0, hi = -1;
+  for (int j = 0; j < (int)order.size(); j++) {
+    const std::pair<int, int> &r = ranges[order[j]];
+    // The window is grown before it is shrunk, so that it is never inverted.
+    while (lo > r.first) {
+      w.add(--lo);
+    }
+    while (hi < r.second) {
+      w.add(++hi);
+    }
+    while (lo < r.first) {
+      w.remove(lo++);
+    }
+    while (hi > r.second) {
+      w.remove(hi--);
+    }
+    res[order[j]] = w.answer();
+  }
+}
+
 /*** Example Usage and Output:
 
 Values: 6 -2 4 8 10
@@ -122,9 +228,37 @@ The minimum value in the range [0, 3] is -2.
 
 ***/
 
+#include <cassert>
+#include <cstdlib>  // rand()
 #include <iostream>
 using namespace std;
 
+// Maintains the number of distinct values in a window of an array.
+struct distinct_window {
+  const vector<int> &a;
+  vector<int> count;
+  int distinct;
+
+  distinct_window(const vector<int> &a, int maxv)
+      : a(a), count(maxv + 1, 0), distinct(0) {}
+
+  void add(int i) {
+    if (count[a[i]]++ == 0) {
+      distinct++;
+    }
+  }
+
+  void remove(int i) {
+    if (--count[a[i]] == 0) {
+      distinct--;
+    }
+  }
+
+  int answer() const {
+    return distinct;
+  }
+};
+
 int main() {
   int arr[5] = {6, -2, 1, 8, 10};
   sqrt_decomposition<int> sd(arr, arr + 5);
@@ -135,5 +269,35 @@ int main() {
   }
   cout << endl << "The minimum value in the range [0, 3] is "
        << sd.query(0, 3) << "." << endl;
+
+  // A batch of minimum queries, and the distinct values of each range.
+  const int n = 5000, q = 2000;
+  vector<int> a(n);
+  for (int i = 0; i < n; i++) {
+    a[i] = rand() % 100;
+  }
+  sqrt_decomposition<int> t(a.begin(), a.end());
+  vector<pair<int, int> > ranges;
+  for (int j = 0; j < q; j++) {
+    int lo = rand() % n;
+    ranges.push_back(make_pair(lo, lo + rand() % (n - lo)));
+  }
+  vector<int> mins, distinct;
+  t.query(ranges, mins);
+  distinct_window w(a, 99);
+  mo_queries(ranges, w, distinct);
+  for (int j = 0; j < q; j++) {
+    vector<bool> seen(100, false);
+    int m = a[ranges[j].first], d = 0;
+    for (int i = ranges[j].first; i <= ranges[j].second; i++) {
+      m = min(m, a[i]);
+      if (!seen[a[i]]) {
+        seen[a[i]] = true;
+        d++;
+      }
+    }
+    assert(mins[j] == m && t.query(ranges[j].first, ranges[j].second) == m);
+    assert(distinct[j] == d);
+  }
   return 0;
 }
@@ -18,6 +18,9 @@ Space Complexity:
 
 */
 
+#include <algorithm>  // std::min()
+#include <cstddef>  // NULL, size_t
+#include <functional>  // std::less
 #include <vector>
 
 const int MAXN = 1000;
@@ -48,13 +51,186 @@ int query_min(int a[], int lo, int hi) {
   return a[x] < a[y] ? a[x] : a[y];
 }
 
+/*
+
+sparse_table is a class-based version of the above for any type T ordered by
+Compare, which stores the levels of the table one after another in a single
+flat array of indices rather than in a separate vector per index. Level j holds
+the index of the minimum of each subarray of length 2^j, so that consecutive
+queries at one level read contiguous memory. The array is not copied, but must
+remain unchanged for as long as the table is used.
+
+linear_rmq answers the same queries in O(1) using only O(n) memory. The array
+is divided into blocks of 32 values, and a sparse table is built over only the
+minimum of each block, taking O((n/32) log n) memory. Within each block, a
+32-bit mask is stored for every index i, with a bit set for each earlier index j
+of the block whose value is the minimum of the subarray from j to i. These are
+exactly the indices on a monotonic stack after the values up to i are pushed,
+so the mask of i is that of i - 1 with the popped indices cleared and i set.
+The minimum of a subarray from lo to hi within one block is then the lowest set
+bit of the mask of hi which is at or after lo, found by a single bit scan. A
+query spanning several blocks joins the suffix of the first block, the prefix of
+the last, and the sparse table over the blocks between them. For 4-byte values,
+the structure takes about 4 + 4*log2(n)/32 bytes per element besides the array
+itself, or about 8GB for an array of 10^9 elements.
+
+- sparse_table(a, n) and linear_rmq(a, n) build the structure for the array a
+  with indices from 0 to n - 1.
+- query_index(lo, hi) returns the index of the leftmost minimum value of the
+  array from index lo to hi, inclusive.
+- query(lo, hi) returns the minimum value of the array from lo to hi, inclusive.
+
+Time Complexity:
+- O(n log n) for the sparse_table constructor, and O(n) for the linear_rmq
+  constructor, where n is the size of the array.
+- O(1) per call to query_index() and query().
+
+Space Complexity:
+- O(n log n) for sparse_table, and O(n) for linear_rmq.
+
+*/
+
+template<class T, class Compare = std::less<T> > class sparse_table {
+  const T *a;
+  int n;
+  std::vector<int> table;
+  Compare comp;
+
+  static int log2(int x) {
+    return 31 - __builtin_clz(x);
+  }
+
+  int min_index(int x, int y) const {
+    return comp(a[y], a[x]) ? y : x;
+  }
+
+ public:
+  sparse_table(const T *a, int n) : a(a), n(n) {
+    int levels = (n > 0) ? log2(n) + 1 : 1;
+    table.resize((size_t)levels*n);
+    for (int i = 0; i < n; i++) {
+      table[i] = i;
+    }
+    for (int j = 1; j < levels; j++) {
+      const int *prev = &table[(size_t)(j - 1)*n];
+      int *cur = &table[(size_t)j*n];
+      for (int i = 0, half = 1 << (j - 1); i + 2*half <= n; i++) {
+        cur[i] = min_index(prev[i], prev[i + half]);
+      }
+    }
+  }
+
+  int query_index(int lo, int hi) const {
+    int j = log2(hi - lo + 1);
+    const int *level = &table[(size_t)j*n];
+    return min_index(level[lo], level[hi - (1 << j) + 1]);
+  }
+
+  T query(int lo, int hi) const {
+    return a[query_index(lo, hi)];
+  }
+};
+
+template<class T, class Compare = std::less<T> > class linear_rmq {
+  static const int BLOCK = 32;
+
+  const T *a;
+  int n;
+  std::vector<unsigned int> mask;
+  std::vector<T> block_min;
+  std::vector<int> block_index;
+  sparse_table<T, Compare> *blocks;
+  Compare comp;
+
+  // Returns the index of the minimum from lo to hi, both within one block.
+  int query_block(int lo, int hi) const {
+    unsigned int m = mask[hi] & (~0u << (lo % BLOCK));
+    return hi - hi % BLOCK + __builtin_ctz(m);
+  }
+
+  int min_index(int x, int y) const {
+    return comp(a[y], a[x]) ? y : x;
+  }
+
+  linear_rmq(const linear_rmq &);
+  linear_rmq& operator=(const linear_rmq &);
+
+ public:
+  linear_rmq(const T *a, int n) : a(a), n(n), mask(n) {
+    int nblocks = (n + BLOCK - 1)/BLOCK;
+    block_min.resize(nblocks);
+    block_index.resize(nblocks);
+    for (int b = 0; b < nblocks; b++) {
+      int lo = b*BLOCK, hi = std::min(n, lo + BLOCK);
+      unsigned int stack = 0;
+      for (int i = lo; i < hi; i++) {
+        // The highest set bit is the top of the stack.
+        while (stack != 0 && comp(a[i], a[lo + 31 - __builtin_clz(stack)])) {
+          stack &= ~(1u << (31 - __builtin_clz(stack)));
+        }
+        stack |= 1u << (i - lo);
+        mask[i] = stack;
+      }
+      block_index[b] = query_block(lo, hi - 1);
+      block_min[b] = a[block_index[b]];
+    }
+    blocks = new sparse_table<T, Compare>(block_min.empty() ? NULL :
+                                          &block_min[0], nblocks);
+  }
+
+  ~linear_rmq() {
+    delete blocks;
+  }
+
+  int query_index(int lo, int hi) const {
+    int bl = lo/BLOCK, br = hi/BLOCK;
+    if (bl == br) {
+      return query_block(lo, hi);
+    }
+    int res = query_block(lo, bl*BLOCK + BLOCK - 1);
+    if (bl + 1 < br) {
+      res = min_index(res, block_index[blocks->query_index(bl + 1, br - 1)]);
+    }
+    return min_index(res, query_block(br*BLOCK, hi));
+  }
+
+  T query(int lo, int hi) const {
+    return a[query_index(lo, hi)];
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
+#include <cstdlib>  // rand()
+#include <functional>  // std::greater
+using namespace std;
 
 int main() {
   int arr[5] = {6, -2, 1, 8, 10};
   build_rmq_table(5, arr);
   assert(-2 == query_min(arr, 0, 4));
+
+  // Check both classes against a scan, including the maximum by std::greater.
+  const int n = 3000;
+  vector<int> a(n);
+  for (int i = 0; i < n; i++) {
+    a[i] = rand() % 1000;
+  }
+  sparse_table<int> st(&a[0], n);
+  linear_rmq<int> lr(&a[0], n);
+  linear_rmq<int, greater<int> > lrmax(&a[0], n);
+  for (int it = 0; it < 20000; it++) {
+    int lo = rand() % n, hi = lo + rand() % min(n - lo, (it % 2 == 0) ? 40 : n);
+    int m = lo, mx = a[lo];
+    for (int i = lo; i <= hi; i++) {
+      if (a[i] < a[m]) {
+        m = i;
+      }
+      mx = max(mx, a[i]);
+    }
+    assert(st.query_index(lo, hi) == m && lr.query_index(lo, hi) == m);
+    assert(st.query(lo, hi) == a[m] && lrmax.query(lo, hi) == mx);
+  }
   return 0;
 }
@@ -0,0 +1,318 @@
+/*
+
+Maintain an array over a huge range of indices, such as [0, 2^62), while
+supporting both dynamic queries and updates of contiguous subarrays via the lazy
+propagation technique. Unlike the segment trees earlier in this section, nodes
+are only created when an update or a pending delta reaches them, so that no
+coordinate compression is needed and memory is proportional to the number of
+operations rather than to the size of the range. A missing node stands for a
+subarray whose values are all still the initial value.
+
+The operations are defined by the template argument Policy, with the same
+members and properties as in the range update segment tree of this section (any
+policy from there may be used). The default policy defines queries for the "min"
+of the target range and updates that "assign" the chosen indices a new value.
+Since a subarray may be longer than 2^31, join_repeated() and
+join_value_with_delta() receive lengths as long long. Nodes are allocated from
+the template argument Pool, by default a slab allocator.
+
+- sparse_segment_tree(lo, hi, v) constructs an array with indices from lo to hi,
+  inclusive, and all values initialized to v, where hi - lo + 1 must not
+  overflow a long long.
+- at(i) returns the value at index i.
+- query(lo, hi) returns the result of join_values() applied to all indices from
+  lo to hi, inclusive.
+- update(i, d) assigns the value v at index i to join_value_with_delta(v, d, 1).
+- update(lo, hi, d) modifies the value at each array index from lo to hi,
+  inclusive, by respectively joining them with d using join_value_with_delta().
+- nodes() returns the number of nodes created.
+- clear() resets every value to v, freeing all nodes.
+
+Time Complexity:
+- O(1) per call to the constructor and nodes().
+- O(log(hi - lo)) per call to at(), update(), and query().
+- O(n) per call to clear() and the destructor, or O(log n) if T has a trivial
+  destructor, where n is the number of nodes.
+
+Space Complexity:
+- O(u log(hi - lo)) nodes after u calls to at(), update(), and query().
+- O(log(hi - lo)) auxiliary stack space per call to at(), update(), and query().
+
+*/
+
+#include <cstdlib>  // NULL
+#include <limits>  // std::numeric_limits
+#include <new>  // placement new
+#include <utility>  // std::pair
+#include <vector>
+
+// A slab allocator for nodes with a free list, as in section 3.5.1.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  std::vector<std::pair<slot*, size_t> > slabs;
+  slot *free_list;
+  size_t used;  // The number of slots handed out from the last slab.
+
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
+
+ public:
+  node_pool() : free_list(NULL), used(0) {}
+
+  ~node_pool() {
+    clear();
+  }
+
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != NULL) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || used == slabs.back().second) {
+        size_t n = slabs.empty() ? 64 : 2*slabs.back().second;
+        slabs.push_back(std::make_pair(new slot[n], n));
+        used = 0;
+      }
+      s = slabs.back().first + used++;
+    }
+    s->next = s;
+    return s->u.data;
+  }
+
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    s->next = free_list;
+    free_list = s;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        size_t n = (i + 1 == slabs.size()) ? used : slabs[i].second;
+        for (size_t j = 0; j < n; j++) {
+          slot *s = slabs[i].first + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].first;
+    }
+    slabs.clear();
+    free_list = NULL;
+    used = 0;
+  }
+};
+
+// The default policy of "min" queries and "assign" updates. The other policies
+// of section 3.3.2 (or any struct with the same members) may be used instead.
+template<class T> struct min_assign_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? a : b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return d;
+  }
+
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d2;  // For "assign" updates, the more recent delta prevails.
+  }
+};
+
+template<class T, class Policy = min_assign_policy<T>,
+         template<class> class Pool = node_pool>
+class sparse_segment_tree {
+  typedef typename Policy::delta_t delta_t;
+
+  struct node_t {
+    T value;
+    delta_t delta;
+    bool pending;
+    node_t *left, *right;
+
+    node_t(const T &v) : value(v), pending(false), left(NULL), right(NULL) {}
+  } *root;
+
+  long long min_index, max_index;
+  T init;
+  Pool<node_t> pool;
+  int num_nodes;
+
+  // Returns the node for [lo, hi], creating it as a run of initial values.
+  node_t* get(node_t *&n, long long lo, long long hi) {
+    if (n == NULL) {
+      T v = Policy::join_repeated(init, hi - lo + 1);
+      n = new (pool.allocate()) node_t(v);
+      num_nodes++;
+    }
+    return n;
+  }
+
+  static void apply(node_t *n, const delta_t &d, long long len) {
+    n->value = Policy::join_value_with_delta(n->value, d, len);
+    n->delta = n->pending ? Policy::join_deltas(n->delta, d) : d;
+    n->pending = true;
+  }
+
+  // Passes the pending delta of n for [lo, hi] to its two children.
+  void push(node_t *n, long long lo, long long hi) {
+    if (n->pending && lo < hi) {
+      long long mid = lo + (hi - lo)/2;
+      apply(get(n->left, lo, mid), n->delta, mid - lo + 1);
+      apply(get(n->right, mid + 1, hi), n->delta, hi - mid);
+    }
+    n->pending = false;
+  }
+
+  T query(node_t *n, long long lo, long long hi, long long tgt_lo,
+          long long tgt_hi) {
+    if (n == NULL) {
+      return Policy::join_repeated(init, tgt_hi - tgt_lo + 1);
+    }
+    if (lo == tgt_lo && hi == tgt_hi) {
+      return n->value;
+    }
+    push(n, lo, hi);
+    long long mid = lo + (hi - lo)/2;
+    if (tgt_hi <= mid) {
+      return query(n->left, lo, mid, tgt_lo, tgt_hi);
+    }
+    if (mid < tgt_lo) {
+      return query(n->right, mid + 1, hi, tgt_lo, tgt_hi);
+    }
+    return Policy::join_values(query(n->left, lo, mid, tgt_lo, mid),
+                               query(n->right, mid + 1, hi, mid + 1, tgt_hi));
+  }
+
+  void update(node_t *&n, long long lo, long long hi, long long tgt_lo,
+              long long tgt_hi, const delta_t &d) {
+    get(n, lo, hi);
+    if (tgt_lo <= lo && hi <= tgt_hi) {
+      apply(n, d, hi - lo + 1);
+      return;
+    }
+    push(n, lo, hi);
+    long long mid = lo + (hi - lo)/2;
+    if (tgt_lo <= mid) {
+      update(n->left, lo, mid, tgt_lo, tgt_hi, d);
+    }
+    if (mid < tgt_hi) {
+      update(n->right, mid + 1, hi, tgt_lo, tgt_hi, d);
+    }
+    n->value = Policy::join_values(get(n->left, lo, mid)->value,
+                                   get(n->right, mid + 1, hi)->value);
+  }
+
+ public:
+  sparse_segment_tree(long long lo, long long hi, const T &v = T())
+      : root(NULL), min_index(lo), max_index(hi), init(v), num_nodes(0) {}
+
+  T at(long long i) {
+    return query(i, i);
+  }
+
+  T query(long long lo, long long hi) {
+    return query(root, min_index, max_index, lo, hi);
+  }
+
+  void update(long long i, const delta_t &d) {
+    update(i, i, d);
+  }
+
+  void update(long long lo, long long hi, const delta_t &d) {
+    update(root, min_index, max_index, lo, hi, d);
+  }
+
+  int nodes() const {
+    return num_nodes;
+  }
+
+  void clear() {
+    pool.clear();
+    root = NULL;
+    num_nodes = 0;
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <vector>
+using namespace std;
+
+struct sum_add_policy {
+  typedef long long delta_t;
+  static const bool commutative = true;
+  static long long identity() { return 0; }
+  static long long join_repeated(long long v, long long n) { return v*n; }
+  static long long join_values(long long a, long long b) { return a + b; }
+
+  static long long join_value_with_delta(long long v, long long d,
+                                         long long len) {
+    return v + d*len;
+  }
+
+  static long long join_deltas(long long d1, long long d2) {
+    return d1 + d2;
+  }
+};
+
+int main() {
+  // Minimum queries over 62-bit timestamps, without coordinate compression.
+  const long long MAXT = (1LL << 62) - 1;
+  sparse_segment_tree<long long> t(0, MAXT, 100);
+  t.update(1700000000000000000LL, 5);
+  t.update(1000, 2000, 7);
+  t.update(MAXT, -1);
+  assert(t.at(1500) == 7 && t.at(999) == 100);
+  assert(t.query(0, 1999) == 7);
+  assert(t.query(0, MAXT - 1) == 5);
+  assert(t.query(0, MAXT) == -1);
+  assert(t.nodes() <= 4*2*62);
+  t.clear();
+  assert(t.query(0, MAXT) == 100 && t.nodes() == 0);
+
+  // Sum queries with range additions, whose lengths exceed 2^31.
+  sparse_segment_tree<long long, sum_add_policy> s(0, MAXT);
+  s.update(0, MAXT, 1);
+  s.update(1LL << 40, (1LL << 41) - 1, 2);
+  assert(s.query(0, MAXT) == (1LL << 62) + (1LL << 41));
+  assert(s.query((1LL << 40) - 1, 1LL << 40) == 4);
+
+  // Random operations on a small range, checked against a plain array.
+  sparse_segment_tree<long long, sum_add_policy> u(-500, 499);
+  vector<long long> a(1000, 0);
+  for (int it = 0; it < 5000; it++) {
+    int lo = rand() % 1000, hi = lo + rand() % (1000 - lo);
+    if (rand() % 2 == 0) {
+      long long d = rand() % 100 - 50;
+      u.update(lo - 500, hi - 500, d);
+      for (int i = lo; i <= hi; i++) {
+        a[i] += d;
+      }
+    } else {
+      long long sum = 0;
+      for (int i = lo; i <= hi; i++) {
+        sum += a[i];
+      }
+      assert(u.query(lo - 500, hi - 500) == sum);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,286 @@
+/*
+
+Maintain an array over a huge range of indices, such as [0, 2^62), while
+supporting dynamic updates of individual indices and queries of contiguous
+subarrays in any earlier version of the array. As in the sparse segment tree of
+this section, nodes are only created along the paths of updates, with a missing
+node standing for a subarray of initial values. An update never modifies a node,
+but instead creates a copy of each of the O(log n) nodes on its path, sharing
+all other nodes with the version it was applied to. Every version thus remains
+available for queries, and nodes are only freed when the tree is cleared.
+
+The operations are defined by the template argument Policy, with the same
+members as in the range update segment tree of this section, of which only
+identity(), join_repeated(), join_values(), and join_value_with_delta() are
+used. The default policy defines "sum" queries and "add" updates, with which the
+tree answers order statistics over ranges: if version i counts the values of the
+first i elements of a sequence, then the k-th smallest value among the elements
+from l to r is kth(l, r + 1, k), with no coordinate compression of the values.
+Nodes are allocated from the template argument Pool, by default a slab
+allocator.
+
+- persistent_segment_tree(lo, hi, v) constructs an array with indices from lo
+  to hi, inclusive, and all values initialized to v, as version 0.
+- versions() returns the number of versions.
+- at(ver, i) returns the value at index i in version ver.
+- query(ver, lo, hi) returns the result of join_values() applied to all indices
+  from lo to hi, inclusive, in version ver.
+- update(ver, i, d) creates a new version from version ver, in which the value v
+  at index i is assigned to join_value_with_delta(v, d, 1), and returns its
+  number.
+- kth(va, vb, k) returns the smallest index i such that query(vb, lo, i) minus
+  query(va, lo, i) is at least k, or hi + 1 if there is none. This requires T
+  to be a numeric type, and vb to be obtained from va by adding nonnegative
+  deltas with the "sum" and "add" operations.
+- clear() removes every version but version 0, freeing all nodes.
+
+Time Complexity:
+- O(1) per call to the constructor and versions().
+- O(log(hi - lo)) per call to at(), update(), query(), and kth().
+- O(n) per call to clear() and the destructor, or O(log n) if T has a trivial
+  destructor, where n is the number of nodes.
+
+Space Complexity:
+- O(u log(hi - lo)) nodes after u calls to update().
+- O(log(hi - lo)) auxiliary stack space per call to update() and query(), and
+  O(1) auxiliary for all other operations.
+
+*/
+
+#include <cstdlib>  // NULL
+#include <new>  // placement new
+#include <utility>  // std::pair
+#include <vector>
+
+// A slab allocator for nodes with a free list, as in section 3.5.1.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  std::vector<std::pair<slot*, size_t> > slabs;
+  slot *free_list;
+  size_t used;  // The number of slots handed out from the last slab.
+
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
+
+ public:
+  node_pool() : free_list(NULL), used(0) {}
+
+  ~node_pool() {
+    clear();
+  }
+
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != NULL) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || used == slabs.back().second) {
+        size_t n = slabs.empty() ? 64 : 2*slabs.back().second;
+        slabs.push_back(std::make_pair(new slot[n], n));
+        used = 0;
+      }
+      s = slabs.back().first + used++;
+    }
+    s->next = s;
+    return s->u.data;
+  }
+
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    s->next = free_list;
+    free_list = s;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        size_t n = (i + 1 == slabs.size()) ? used : slabs[i].second;
+        for (size_t j = 0; j < n; j++) {
+          slot *s = slabs[i].first + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].first;
+    }
+    slabs.clear();
+    free_list = NULL;
+    used = 0;
+  }
+};
+
+// The default policy of "sum" queries and "add" updates. The other policies of
+// section 3.3.2 (or any struct with the same members) may be used instead.
+template<class T> struct sum_add_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return 0; }
+  static T join_repeated(const T &v, long long n) { return v*n; }
+  static T join_values(const T &a, const T &b) { return a + b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return v + d*len;
+  }
+
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d1 + d2;
+  }
+};
+
+template<class T, class Policy = sum_add_policy<T>,
+         template<class> class Pool = node_pool>
+class persistent_segment_tree {
+  typedef typename Policy::delta_t delta_t;
+
+  struct node_t {
+    T value;
+    node_t *left, *right;
+
+    node_t(const T &v, node_t *l, node_t *r) : value(v), left(l), right(r) {}
+  };
+
+  long long min_index, max_index;
+  T init;
+  std::vector<node_t*> roots;
+  Pool<node_t> pool;
+
+  // Returns the join of the values of n over [lo, hi].
+  T value(const node_t *n, long long lo, long long hi) const {
+    return (n == NULL) ? Policy::join_repeated(init, hi - lo + 1) : n->value;
+  }
+
+  // Returns a new node for [lo, hi] with the update applied to n.
+  node_t* update(const node_t *n, long long lo, long long hi, long long i,
+                 const delta_t &d) {
+    if (lo == hi) {
+      T v = Policy::join_value_with_delta(value(n, lo, hi), d, 1);
+      return new (pool.allocate()) node_t(v, NULL, NULL);
+    }
+    long long mid = lo + (hi - lo)/2;
+    node_t *l = (n == NULL) ? NULL : n->left;
+    node_t *r = (n == NULL) ? NULL : n->right;
+    if (i <= mid) {
+      l = update(l, lo, mid, i, d);
+    } else {
+      r = update(r, mid + 1, hi, i, d);
+    }
+    T v = Policy::join_values(value(l, lo, mid), value(r, mid + 1, hi));
+    return new (pool.allocate()) node_t(v, l, r);
+  }
+
+  T query(const node_t *n, long long lo, long long hi, long long tgt_lo,
+          long long tgt_hi) const {
+    if (n == NULL || (lo == tgt_lo && hi == tgt_hi)) {
+      return value(n, tgt_lo, tgt_hi);
+    }
+    long long mid = lo + (hi - lo)/2;
+    if (tgt_hi <= mid) {
+      return query(n->left, lo, mid, tgt_lo, tgt_hi);
+    }
+    if (mid < tgt_lo) {
+      return query(n->right, mid + 1, hi, tgt_lo, tgt_hi);
+    }
+    return Policy::join_values(query(n->left, lo, mid, tgt_lo, mid),
+                               query(n->right, mid + 1, hi, mid + 1, tgt_hi));
+  }
+
+ public:
+  persistent_segment_tree(long long lo, long long hi, const T &v = T())
+      : min_index(lo), max_index(hi), init(v), roots(1, (node_t*)NULL) {}
+
+  int versions() const {
+    return (int)roots.size();
+  }
+
+  T at(int ver, long long i) const {
+    return query(ver, i, i);
+  }
+
+  T query(int ver, long long lo, long long hi) const {
+    return query(roots[ver], min_index, max_index, lo, hi);
+  }
+
+  int update(int ver, long long i, const delta_t &d) {
+    roots.push_back(update(roots[ver], min_index, max_index, i, d));
+    return (int)roots.size() - 1;
+  }
+
+  long long kth(int va, int vb, T k) const {
+    const node_t *a = roots[va], *b = roots[vb];
+    long long lo = min_index, hi = max_index;
+    if (value(b, lo, hi) - value(a, lo, hi) < k) {
+      return hi + 1;
+    }
+    while (lo < hi) {
+      long long mid = lo + (hi - lo)/2;
+      const node_t *al = (a == NULL) ? NULL : a->left;
+      const node_t *bl = (b == NULL) ? NULL : b->left;
+      T count = value(bl, lo, mid) - value(al, lo, mid);
+      if (k <= count) {
+        a = al;
+        b = bl;
+        hi = mid;
+      } else {
+        k -= count;
+        a = (a == NULL) ? NULL : a->right;
+        b = (b == NULL) ? NULL : b->right;
+        lo = mid + 1;
+      }
+    }
+    return lo;
+  }
+
+  void clear() {
+    pool.clear();
+    roots.assign(1, (node_t*)NULL);
+  }
+};
+
+/*** Example Usage ***/
+
+#include <algorithm>  // std::sort()
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <vector>
+using namespace std;
+
+int main() {
+  // Version i counts the occurrences of each value among the first i elements.
+  const long long MAXV = 1000000000000LL;
+  const int n = 200;
+  vector<long long> a(n);
+  persistent_segment_tree<int> t(-MAXV, MAXV);
+  for (int i = 0; i < n; i++) {
+    a[i] = (long long)(rand() % 20001 - 10000)*(rand() % 100000000);
+    assert(t.update(i, a[i], 1) == i + 1);
+  }
+  for (int it = 0; it < 1000; it++) {
+    int l = rand() % n, r = l + rand() % (n - l);
+    vector<long long> b(a.begin() + l, a.begin() + r + 1);
+    sort(b.begin(), b.end());
+    int k = rand() % (r - l + 1);
+    assert(t.kth(l, r + 1, k + 1) == b[k]);
+    assert(t.kth(l, r + 1, r - l + 2) == MAXV + 1);
+    assert(t.query(r + 1, -MAXV, b[k]) - t.query(l, -MAXV, b[k]) >= k + 1);
+  }
+  // Old versions are unaffected by updates branching from them.
+  int v = t.update(0, 5, 10);
+  assert(t.at(v, 5) == 10 && t.at(0, 5) == 0);
+  assert(t.query(n, -MAXV, MAXV) == n && t.query(v, -MAXV, MAXV) == 10);
+  t.clear();
+  assert(t.versions() == 1 && t.query(0, -MAXV, MAXV) == 0);
+  return 0;
+}
@@ -0,0 +1,369 @@
+/*
+
+Given a static array of n nonnegative integers below sigma, answer queries for
+the k-th smallest value, the number of values within a range of values, and the
+value at an index, all within any contiguous subarray, using about n log(sigma)
+bits in total instead of storing the array itself.
+
+rank_select_bitvector is a static array of n bits which counts the set bits in
+any prefix (rank) and finds the position of the k-th set or clear bit (select).
+The bits are stored in cache lines of 64 bytes, each holding the number of set
+bits before the line followed by 7 words of 64 bits, so that a rank query reads
+a single cache line, adding the popcounts of at most 7 words to the count at
+the start of the line. This takes 512/448, or about 1.14 bits of memory per bit.
+A select query binary searches the counts of the lines, and then scans the
+words within the line.
+
+wavelet_matrix stores the array as log(sigma) such bitvectors, one per bit of
+the values from the highest. The bitvector of level l holds bit l of each value,
+with the values ordered by a stable partition of the previous level, those with
+a clear bit first, followed by those with a set bit. A subarray [lo, hi) at one
+level consists of the values from rank0(lo) to rank0(hi) at the next level if
+their bit is clear, or else from zeros + rank1(lo) to zeros + rank1(hi), where
+zeros is the number of clear bits at the level. Each query thus descends through
+the levels with a constant number of rank queries, or cache misses, per level.
+The matrix may be shared by any number of threads as long as none modify it.
+
+- rank_select_bitvector(n) constructs an array of n clear bits.
+- set(i) sets the bit at index i, which is only allowed before build().
+- build() computes the counts of set bits, after which queries are allowed.
+- size() returns the number of bits, and ones() the number of set bits.
+- get(i) returns the bit at index i.
+- rank1(i) and rank0(i) return the number of set and clear bits before index i.
+- select1(k) and select0(k) return the index of the set or clear bit which has
+  exactly k set or clear bits before it, respectively.
+- wavelet_matrix(lo, hi) constructs the matrix for the values in the range
+  [lo, hi) of unsigned integers, with sigma one more than the largest value.
+- size() returns the number of values.
+- at(i) returns the value at index i.
+- kth(lo, hi, k) returns the k-th smallest value among the indices in [lo, hi),
+  counting from k = 0, so that kth(lo, hi, (hi - lo)/2) is the median.
+- count_less(lo, hi, v) returns the number of values less than v among the
+  indices in [lo, hi).
+- count(lo, hi, a, b) returns the number of values v with a <= v < b among the
+  indices in [lo, hi).
+
+Time Complexity:
+- O(n) per call to the constructor and build() of a bitvector, and O(1) per
+  call to set(), size(), ones(), get(), rank1(), and rank0().
+- O(log n) per call to select1() and select0().
+- O(n log sigma) per call to the constructor of a wavelet_matrix.
+- O(log sigma) per call to at(), kth(), count_less(), and count().
+
+Space Complexity:
+- O(n) bits for a bitvector, and O(n log sigma) bits for a wavelet matrix.
+- O(n) auxiliary words per call to the constructor of a wavelet_matrix, and
+  O(1) auxiliary per call to all other operations.
+
+*/
+
+#include <cstddef>  // size_t
+#include <new>  // operator new()
+#include <vector>
+
+class rank_select_bitvector {
+  static const int WORDS = 7, LINE_BITS = 64*WORDS;
+
+  struct line_t {
+    unsigned long long rank;  // The number of set bits before this line.
+    unsigned long long bits[WORDS];
+  };
+
+  char *raw;  // The allocation holding the aligned lines.
+  line_t *lines;
+  long long n, num_lines, num_ones;
+
+  rank_select_bitvector(const rank_select_bitvector &);
+  rank_select_bitvector& operator=(const rank_select_bitvector &);
+
+  // Returns the index of the k-th lowest set bit of x, counting from 0.
+  static int select_in_word(unsigned long long x, long long k) {
+    for (; k > 0; k--) {
+      x &= x - 1;
+    }
+    return __builtin_ctzll(x);
+  }
+
+ public:
+  rank_select_bitvector(long long n) : n(n), num_ones(0) {
+    num_lines = n/LINE_BITS + 1;  // Leaves a line for rank1(n) in any case.
+    raw = (char*)operator new((size_t)num_lines*sizeof(line_t) + 64);
+    lines = (line_t*)(raw + (64 - (size_t)raw % 64) % 64);
+    for (long long l = 0; l < num_lines; l++) {
+      lines[l].rank = 0;
+      for (int w = 0; w < WORDS; w++) {
+        lines[l].bits[w] = 0;
+      }
+    }
+  }
+
+  ~rank_select_bitvector() {
+    operator delete(raw);
+  }
+
+  void set(long long i) {
+    lines[i/LINE_BITS].bits[i % LINE_BITS / 64] |= 1ULL << (i % 64);
+  }
+
+  void build() {
+    unsigned long long r = 0;
+    for (long long l = 0; l < num_lines; l++) {
+      lines[l].rank = r;
+      for (int w = 0; w < WORDS; w++) {
+        r += __builtin_popcountll(lines[l].bits[w]);
+      }
+    }
+    num_ones = (long long)r;
+  }
+
+  long long size() const {
+    return n;
+  }
+
+  long long ones() const {
+    return num_ones;
+  }
+
+  bool get(long long i) const {
+    return (lines[i/LINE_BITS].bits[i % LINE_BITS / 64] >> (i % 64)) & 1;
+  }
+
+  long long rank1(long long i) const {
+    const line_t &line = lines[i/LINE_BITS];
+    int off = (int)(i % LINE_BITS), w = off/64;
+    long long r = (long long)line.rank;
+    for (int j = 0; j < w; j++) {
+      r += __builtin_popcountll(line.bits[j]);
+    }
+    if (off % 64 != 0) {
+      r += __builtin_popcountll(line.bits[w] << (64 - off % 64));
+    }
+    return r;
+  }
+
+  long long rank0(long long i) const {
+    return i - rank1(i);
+  }
+
+  long long select1(long long k) const {
+    long long lo = 0, hi = num_lines - 1;  // The last line with rank <= k.
+    while (lo < hi) {
+      long long mid = lo + (hi - lo + 1)/2;
+      if ((long long)lines[mid].rank <= k) {
+        lo = mid;
+      } else {
+        hi = mid - 1;
+      }
+    }
+    k -= (long long)lines[lo].rank;
+    for (int w = 0; ; w++) {
+      int c = __builtin_popcountll(lines[lo].bits[w]);
+      if (k < c) {
+        return lo*LINE_BITS + 64*w + select_in_word(lines[lo].bits[w], k);
+      }
+      k -= c;
+    }
+  }
+
+  long long select0(long long k) const {
+    long long lo = 0, hi = num_lines - 1;
+    while (lo < hi) {
+      long long mid = lo + (hi - lo + 1)/2;
+      if (mid*LINE_BITS - (long long)lines[mid].rank <= k) {
+        lo = mid;
+      } else {
+        hi = mid - 1;
+      }
+    }
+    k -= lo*LINE_BITS - (long long)lines[lo].rank;
+    for (int w = 0; ; w++) {
+      int c = 64 - __builtin_popcountll(lines[lo].bits[w]);
+      if (k < c) {
+        return lo*LINE_BITS + 64*w + select_in_word(~lines[lo].bits[w], k);
+      }
+      k -= c;
+    }
+  }
+};
+
+class wavelet_matrix {
+  long long n;
+  int levels;
+  std::vector<rank_select_bitvector*> bv;
+  std::vector<long long> zeros;
+
+  wavelet_matrix(const wavelet_matrix &);
+  wavelet_matrix& operator=(const wavelet_matrix &);
+
+ public:
+  template<class It> wavelet_matrix(It lo, It hi) {
+    std::vector<unsigned long long> cur(lo, hi), next(cur.size());
+    n = (long long)cur.size();
+    unsigned long long mx = 0;
+    for (long long i = 0; i < n; i++) {
+      mx = (cur[i] > mx) ? cur[i] : mx;
+    }
+    levels = (mx == 0) ? 1 : 64 - __builtin_clzll(mx);
+    for (int l = 0; l < levels; l++) {
+      int b = levels - 1 - l;
+      rank_select_bitvector *v = new rank_select_bitvector(n);
+      long long z = 0;
+      for (long long i = 0; i < n; i++) {
+        if ((cur[i] >> b) & 1) {
+          v->set(i);
+        } else {
+          next[z++] = cur[i];
+        }
+      }
+      for (long long i = 0, o = z; i < n; i++) {
+        if ((cur[i] >> b) & 1) {
+          next[o++] = cur[i];
+        }
+      }
+      v->build();
+      bv.push_back(v);
+      zeros.push_back(z);
+      cur.swap(next);
+    }
+  }
+
+  ~wavelet_matrix() {
+    for (int l = 0; l < levels; l++) {
+      delete bv[l];
+    }
+  }
+
+  long long size() const {
+    return n;
+  }
+
+  unsigned long long at(long long i) const {
+    unsigned long long v = 0;
+    for (int l = 0; l < levels; l++) {
+      v <<= 1;
+      if (bv[l]->get(i)) {
+        v |= 1;
+        i = zeros[l] + bv[l]->rank1(i);
+      } else {
+        i = bv[l]->rank0(i);
+      }
+    }
+    return v;
+  }
+
+  unsigned long long kth(long long lo, long long hi, long long k) const {
+    unsigned long long v = 0;
+    for (int l = 0; l < levels; l++) {
+      long long lo0 = bv[l]->rank0(lo), hi0 = bv[l]->rank0(hi);
+      v <<= 1;
+      if (k < hi0 - lo0) {
+        lo = lo0;
+        hi = hi0;
+      } else {
+        k -= hi0 - lo0;
+        v |= 1;
+        lo = zeros[l] + (lo - lo0);
+        hi = zeros[l] + (hi - hi0);
+      }
+    }
+    return v;
+  }
+
+  long long count_less(long long lo, long long hi, unsigned long long v) const {
+    if (levels < 64 && (v >> levels) != 0) {
+      return hi - lo;
+    }
+    long long res = 0;
+    for (int l = 0; l < levels && lo < hi; l++) {
+      long long lo0 = bv[l]->rank0(lo), hi0 = bv[l]->rank0(hi);
+      if ((v >> (levels - 1 - l)) & 1) {
+        res += hi0 - lo0;
+        lo = zeros[l] + (lo - lo0);
+        hi = zeros[l] + (hi - hi0);
+      } else {
+        lo = lo0;
+        hi = hi0;
+      }
+    }
+    return res;
+  }
+
+  long long count(long long lo, long long hi, unsigned long long a,
+                  unsigned long long b) const {
+    return (a < b) ? count_less(lo, hi, b) - count_less(lo, hi, a) : 0;
+  }
+};
+
+/*** Example Usage and Output:
+
+Sorted [1, 6): 1 2 4 5 7
+Values in [2, 5) within [0, 8): 4
+
+***/
+
+#include <algorithm>  // std::sort()
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+using namespace std;
+
+int main() {
+  {
+    unsigned int a[] = {3, 5, 1, 7, 2, 4, 9, 2};
+    wavelet_matrix w(a, a + 8);
+    cout << "Sorted [1, 6):";
+    for (int k = 0; k < 5; k++) {
+      cout << " " << w.kth(1, 6, k);
+    }
+    cout << endl;
+    cout << "Values in [2, 5) within [0, 8): " << w.count(0, 8, 2, 5) << endl;
+    assert(w.at(6) == 9 && w.count_less(0, 8, 100) == 8);
+  }
+  {
+    // Check the bitvector against a plain array of bits.
+    const int n = 100000;
+    vector<bool> bits(n);
+    rank_select_bitvector b(n);
+    for (int i = 0; i < n; i++) {
+      if (rand() % 3 == 0) {
+        bits[i] = true;
+        b.set(i);
+      }
+    }
+    b.build();
+    long long ones = 0;
+    for (int i = 0; i < n; i++) {
+      assert(b.rank1(i) == ones && b.get(i) == bits[i]);
+      if (bits[i]) {
+        assert(b.select1(ones) == i);
+      } else {
+        assert(b.select0(i - ones) == i);
+      }
+      ones += bits[i];
+    }
+    assert(b.rank1(n) == ones && b.ones() == ones);
+  }
+  {
+    // Check the wavelet matrix against sorting each subarray.
+    const int n = 2000;
+    vector<unsigned int> a(n);
+    for (int i = 0; i < n; i++) {
+      a[i] = rand() % 1000;
+    }
+    wavelet_matrix w(a.begin(), a.end());
+    for (int it = 0; it < 2000; it++) {
+      int lo = rand() % n, hi = lo + 1 + rand() % (n - lo);
+      int k = rand() % (hi - lo);
+      vector<unsigned int> s(a.begin() + lo, a.begin() + hi);
+      sort(s.begin(), s.end());
+      unsigned int x = rand() % 1100, y = rand() % 1100;
+      long long c = 0;
+      for (int i = lo; i < hi; i++) {
+        c += (x <= a[i] && a[i] < y);
+      }
+      assert(w.kth(lo, hi, k) == s[k] && w.at(lo) == a[lo]);
+      assert(w.count(lo, hi, x, y) == c);
+    }
+  }
+  return 0;
+}
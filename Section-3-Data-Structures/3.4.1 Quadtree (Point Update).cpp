@@ -4,31 +4,40 @@ Maintain a two-dimensional array while supporting dynamic queries of rectangular
 sub-arrays and dynamic updates of individual indices. This implementation uses
 lazy initialization of nodes to conserve memory while supporting large indices.
 
-The query operation is defined by the join_values() and join_region() functions
-where join_values(x, join_values(y, z)) = join_values(join_values(x, y), z) for
-all values x, y, and z in the array. The join_region(v, area) function must be
-defined in conjunction to efficiently return the result of join_values() applied
-to a rectangular sub-array of area elements. The default code below assumes a
-numerical array type, defining queries for the "min" of the target range.
-Another possible query operation is "sum", in which case join_values(a, b)
-should return "a + b" and join_region(v, area) should return "v*area".
+The nodes are allocated from the template argument Pool, by default a slab
+allocator, since a large number of small nodes are created by updates.
+
+The query and update operations are defined by the static members of the
+template argument Policy, as in the segment trees of section 3.3 (any policy
+from there may be used). The query operation is defined by join_values(), which
+must be associative and also commutative, since the quadrants of a region are
+not joined in any order of their indices, and by join_repeated(v, area), which
+must efficiently return the result of join_values() applied to a rectangular
+sub-array of area elements all equal to v. The default policy defines queries
+for the "min" of the target range. Another possible query operation is "sum", in
+which case join_values(a, b) should return "a + b" and join_repeated(v, area)
+should return "v*area".
 
 The update operation is defined by the join_value_with_delta() function, which
-determines the change made to array values. The default code below defines
-updates that "set" the chosen array index to a new value. Another possible
-update operation is "increment", in which join_value_with_delta(v, d) should be
-defined to return "v + d".
+determines the change made to array values. The default policy defines updates
+that "assign" the chosen array index a new value. Another possible update
+operation is "increment", in which join_value_with_delta(v, d, 1) should return
+"v + d".
 
 - quadtree(v) constructs a two-dimensional array with rows from 0 to MAXR and
   columns from 0 to MAXC, inclusive. All values are implicitly initialized to v.
 - at(r, c) returns the value at row r, column c.
+- clear() resets every value to v.
 - query(r1, c1, r2, c2) returns the result of join_values() applied to every
   value in the rectangular region consisting of rows from r1 to r2, inclusive,
   and columns from c1 to c2, inclusive.
-- update(r, c, d) assigns the value v at (r, c) to join_value_with_delta(v, d).
+- update(r, c, d) assigns the value v at (r, c) to
+  join_value_with_delta(v, d, 1).
 
 Time Complexity:
 - O(1) per call to the constructor.
+- O(n) per call to clear() and the destructor, or O(log n) if T has a trivial
+  destructor, where n is the number of nodes.
 - O(max(MAXR, MAXC)) per call to at(), update(), and query().
 
 Space Complexity:
@@ -41,23 +50,108 @@ Space Complexity:
 
 #include <algorithm>  // std::max(), std::min()
 #include <cstdlib>  // NULL
+#include <limits>  // std::numeric_limits
+#include <new>  // placement new
+#include <utility>  // std::pair
+#include <vector>
 
-template<class T> class quadtree {
-  static const int MAXR = 1000000000;
-  static const int MAXC = 1000000000;
+// A slab allocator for nodes with a free list, as in section 3.5.1.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  std::vector<std::pair<slot*, size_t> > slabs;
+  slot *free_list;
+  size_t used;  // The number of slots handed out from the last slab.
 
-  static T join_values(const T &a, const T &b) {
-    return std::min(a, b);
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
+
+ public:
+  node_pool() : free_list(NULL), used(0) {}
+
+  ~node_pool() {
+    clear();
   }
 
-  static T join_region(const T &v, int area) {
-    return v;
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != NULL) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || used == slabs.back().second) {
+        size_t n = slabs.empty() ? 64 : 2*slabs.back().second;
+        slabs.push_back(std::make_pair(new slot[n], n));
+        used = 0;
+      }
+      s = slabs.back().first + used++;
+    }
+    s->next = s;
+    return s->u.data;
   }
 
-  static T join_value_with_delta(const T &v, const T &d) {
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    s->next = free_list;
+    free_list = s;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        size_t n = (i + 1 == slabs.size()) ? used : slabs[i].second;
+        for (size_t j = 0; j < n; j++) {
+          slot *s = slabs[i].first + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].first;
+    }
+    slabs.clear();
+    free_list = NULL;
+    used = 0;
+  }
+};
+
+// The default policy of "min" queries and "assign" updates. The other policies
+// of section 3.3.2 (or any struct with the same members) may be used instead.
+template<class T> struct min_assign_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? a : b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
     return d;
   }
 
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d2;  // For "assign" updates, the more recent delta prevails.
+  }
+};
+
+template<class T, class Policy = min_assign_policy<T>,
+         template<class> class Pool = node_pool>
+class quadtree {
+  typedef typename Policy::delta_t delta_t;
+  typedef char commutative_policy_required[Policy::commutative ? 1 : -1];
+
+  static const int MAXR = 1000000000;
+  static const int MAXC = 1000000000;
+
   struct node_t {
     T value;
     node_t *child[4];
@@ -72,20 +166,27 @@ template<class T> class quadtree {
 
   node_t *root;
   T init;
+  Pool<node_t> pool;
 
   // Helper variables for update().
   int tgt_r, tgt_c;
-  T delta;
+  delta_t delta;
 
+  // A quadrant with no rows or columns is never given a node, so that it does
+  // not take part in the join of its parent.
   void update(node_t *&n, int r1, int c1, int r2, int c2) {
+    if (r1 > r2 || c1 > c2) {
+      return;
+    }
     if (n == NULL) {
-      n = new node_t(join_region(init, (r2 - r1 + 1)*(c2 - r1 + 1)));
+      n = new (pool.allocate())
+          node_t(Policy::join_repeated(init, (r2 - r1 + 1)*(c2 - c1 + 1)));
     }
     if (tgt_r < r1 || tgt_r > r2 || tgt_c < c1 || tgt_c > c2) {
       return;
     }
     if (r1 == r2 && c1 == c2) {
-      n->value = join_value_with_delta(n->value, delta);
+      n->value = Policy::join_value_with_delta(n->value, delta, 1);
       return;
     }
     int rmid = (r1 + r2)/2, cmid = (c1 + c2)/2;
@@ -95,9 +196,11 @@ template<class T> class quadtree {
     update(n->child[3], rmid + 1, cmid + 1, r2, c2);
     bool found = false;
     for (int i = 0; i < 4; i++) {
-      n->value = found ? join_values(n->value, n->child[i]->value)
-                       : n->child[i]->value;
-      found = true;
+      if (n->child[i] != NULL) {
+        n->value = found ? Policy::join_values(n->value, n->child[i]->value)
+                         : n->child[i]->value;
+        found = true;
+      }
     }
   }
 
@@ -107,19 +210,20 @@ template<class T> class quadtree {
   bool found;
 
   void query(node_t *n, int r1, int c1, int r2, int c2) {
-    if (tgt_r2 < r1 || tgt_r1 > r2 || tgt_c2 < c1 || tgt_c1 > c2) {
+    if (r1 > r2 || c1 > c2 ||
+        tgt_r2 < r1 || tgt_r1 > r2 || tgt_c2 < c1 || tgt_c1 > c2) {
       return;
     }
     if (n == NULL) {
       int rlen = std::min(r2, tgt_r2) - std::max(r1, tgt_r1) + 1;
       int clen = std::min(c2, tgt_c2) - std::max(c1, tgt_c1) + 1;
-      T v = join_region(init, rlen*clen);
-      res = found ? join_values(res, v) : v;
+      T v = Policy::join_repeated(init, rlen*clen);
+      res = found ? Policy::join_values(res, v) : v;
       found = true;
       return;
     }
     if (tgt_r1 <= r1 && r2 <= tgt_r2 && tgt_c1 <= c1 && c2 <= tgt_c2) {
-      res = found ? join_values(res, n->value) : n->value;
+      res = found ? Policy::join_values(res, n->value) : n->value;
       found = true;
       return;
     }
@@ -130,24 +234,16 @@ template<class T> class quadtree {
     query(n->child[3], rmid + 1, cmid + 1, r2, c2);
   }
 
-  static void clean_up(node_t *n) {
-    if (n == NULL) {
-      return;
-    }
-    for (int i = 0; i < 4; i++) {
-      clean_up(n->child[i]);
-    }
-    delete n;
-  }
-
  public:
   quadtree(const T &v = T()) {
     root = NULL;
     init = v;
   }
 
-  ~quadtree() {
-    clean_up(root);
+  // Resets every value to the initial value, freeing all nodes.
+  void clear() {
+    pool.clear();
+    root = NULL;
   }
 
   T at(int r, int c) {
@@ -161,10 +257,13 @@ template<class T> class quadtree {
     tgt_c2 = c2;
     found = false;
     query(root, 0, 0, MAXR, MAXC);
-    return found ? res : join_region(init, (r2 - r1 + 1)*(c2 - c1 + 1));
+    if (!found) {
+      return Policy::join_repeated(init, (r2 - r1 + 1)*(c2 - c1 + 1));
+    }
+    return res;
   }
 
-  void update(int r, int c, const T &d) {
+  void update(int r, int c, const delta_t &d) {
     tgt_r = r;
     tgt_c = c;
     delta = d;
@@ -206,5 +305,7 @@ int main() {
   assert(t.query(0, 0, 1000000000, 1000000000) == 0);
   t.update(500000000, 500000000, -100);
   assert(t.query(0, 0, 1000000000, 1000000000) == -100);
+  t.clear();
+  assert(t.at(0, 0) == 0 && t.query(0, 0, 1000000000, 1000000000) == 0);
   return 0;
 }
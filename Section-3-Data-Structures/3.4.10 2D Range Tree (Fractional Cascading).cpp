@@ -0,0 +1,237 @@
+/*
+
+Given a static set of points in two dimensions, count or report the points which
+lie in axis-aligned query rectangles. This implementation is a layered range
+tree, which applies fractional cascading to the 2D range tree of section 3.4.7
+so that a query takes one pair of binary searches in total, rather than a pair
+per node visited.
+
+The points are sorted by x, and each is named by its rank in this order. Each
+node of the tree covers the ranks which share a prefix of bits, and holds its
+points sorted by y, so that the root holds all points sorted by y. All of the
+nodes of one depth together hold every point once, and each such level is
+stored as one flat array of n entries, laid out as in a wavelet matrix: the
+entries of a level which belong to left children come first, then those of
+right children, each in their order in the level. A bit vector flags which
+entries of each level go right, and each block of 64 flags stores the number of
+flags set before it, so that the number of entries before any position which go
+right (its rank) takes a lookup and a population count. Since every node lists
+its points sorted by y, the entries of a node below a position are exactly the
+entries of its children below the positions given by these ranks, which are
+also the positions of those entries in the next level, without needing to know
+where the node of the entry starts. A query thus finds the range of y only
+once, in the root, and then maps the range to each child with two ranks on the
+way down to the O(log n) nodes which cover the range of x. The flags take 2 bits
+per point and level, so they mostly stay in cache even when the points do not.
+
+Each level is obtained from the level above by a stable partition by one bit of
+the ranks, which keeps each node sorted by y without any comparisons. The
+entries of a level may be partitioned in separate chunks (after counting the
+entries of each chunk which go left).
+
+- cascading_range_tree(lo, hi) constructs the tree from a range [lo, hi) of
+  points, each a std::pair<int, int> of an x and a y coordinate.
+- size() returns the number of points.
+- count(x1, y1, x2, y2) returns the number of points (x, y) such that
+  x1 <= x <= x2 and y1 <= y <= y2.
+- query(x1, y1, x2, y2, f) calls the function f(i) for each point in the same
+  rectangle, where i is the index of the point in the range given to the
+  constructor, in no particular order.
+
+Time Complexity:
+- O(n log n) per call to the constructor, where n is the number of points.
+- O(1) per call to size().
+- O(log n) per call to count(), and O(log n + k) per call to query(), where k
+  is the number of points reported.
+
+Space Complexity:
+- O(n log n) for storage of the levels.
+- O(log n) auxiliary stack space per call to the constructor, count(), and
+  query().
+
+*/
+
+#include <algorithm>  // std::lower_bound(), std::sort(), std::upper_bound()
+#include <utility>  // std::make_pair(), std::pair
+#include <vector>
+
+class cascading_range_tree {
+  // 64 consecutive flags of a level, and the number of set flags before them.
+  struct block_t {
+    unsigned long long bits;
+    int rank;
+  };
+
+  int n, levels, stride;
+  std::vector<int> xs, ys;  // xs by x, and ys by y (the root level).
+  // Entry i of level l is at l*n + i in ids, and zeros[l] entries go left. The
+  // levels of ids hold the x-ranks of points until the build is done.
+  std::vector<int> ids, zeros;
+  std::vector<block_t> blocks;  // stride blocks per level.
+
+  // Returns the number of entries before i in level l which go right.
+  int rank(int l, int i) const {
+    const block_t &b = blocks[l*stride + (i >> 6)];
+    return b.rank + __builtin_popcountll(b.bits & ((1ULL << (i & 63)) - 1));
+  }
+
+  // Counts the entries from a to b - 1 of level l whose node covers the ranks
+  // from lo to lo + 2^(levels - l) - 1, and which have a rank from xl to
+  // xr - 1, reporting them if f is not NULL.
+  template<class ReportFunction>
+  int walk(int l, int lo, int a, int b, int xl, int xr,
+           ReportFunction *f) const {
+    int hi = lo + (1 << (levels - l));
+    if (a == b || hi <= xl || xr <= lo) {
+      return 0;
+    }
+    if (xl <= lo && hi <= xr) {
+      if (f != 0) {
+        for (int i = a; i < b; i++) {
+          (*f)(ids[l*n + i]);
+        }
+      }
+      return b - a;
+    }
+    int ra = rank(l, a), rb = rank(l, b), z = zeros[l];
+    return walk(l + 1, lo, a - ra, b - rb, xl, xr, f) +
+           walk(l + 1, lo + (hi - lo)/2, z + ra, z + rb, xl, xr, f);
+  }
+
+  template<class ReportFunction>
+  int walk(int x1, int y1, int x2, int y2, ReportFunction *f) const {
+    int xl = std::lower_bound(xs.begin(), xs.end(), x1) - xs.begin();
+    int xr = std::upper_bound(xs.begin(), xs.end(), x2) - xs.begin();
+    int a = std::lower_bound(ys.begin(), ys.end(), y1) - ys.begin();
+    int b = std::upper_bound(ys.begin(), ys.end(), y2) - ys.begin();
+    return (xl < xr && a < b) ? walk(0, 0, a, b, xl, xr, f) : 0;
+  }
+
+ public:
+  template<class It> cascading_range_tree(It lo, It hi) {
+    std::vector<std::pair<int, int> > pts(lo, hi);
+    n = (int)pts.size();
+    levels = 0;
+    while ((1 << levels) < n) {
+      levels++;
+    }
+    // Sort the indices of the points by x, then their x-ranks by y.
+    std::vector<std::pair<std::pair<int, int>, int> > order(n);
+    for (int i = 0; i < n; i++) {
+      order[i] = std::make_pair(pts[i], i);
+    }
+    std::sort(order.begin(), order.end());
+    std::vector<std::pair<int, int> > by_y(n);
+    xs.resize(n);
+    for (int i = 0; i < n; i++) {
+      xs[i] = order[i].first.first;
+      by_y[i] = std::make_pair(order[i].first.second, i);
+    }
+    std::sort(by_y.begin(), by_y.end());
+    ids.resize((levels + 1)*n);
+    ys.resize(n);
+    for (int i = 0; i < n; i++) {
+      ys[i] = by_y[i].first;
+      ids[i] = by_y[i].second;
+    }
+    stride = n/64 + 1;
+    block_t empty = {0, 0};
+    blocks.assign(levels*stride, empty);
+    zeros.assign(levels, 0);
+    for (int l = 0; l < levels; l++) {
+      int bit = levels - 1 - l, *src = &ids[l*n], *dst = &ids[(l + 1)*n];
+      block_t *bl = &blocks[l*stride];
+      for (int i = 0; i < n; i++) {
+        zeros[l] += ~src[i] >> bit & 1;
+      }
+      for (int i = 0, a = 0, b = zeros[l]; i < n; i++) {
+        if (src[i] >> bit & 1) {
+          bl[i >> 6].bits |= 1ULL << (i & 63);
+          dst[b++] = src[i];
+        } else {
+          dst[a++] = src[i];
+        }
+      }
+      for (int j = 1; j < stride; j++) {
+        bl[j].rank = bl[j - 1].rank + __builtin_popcountll(bl[j - 1].bits);
+      }
+    }
+    for (int i = 0; i < (levels + 1)*n; i++) {
+      ids[i] = order[ids[i]].second;
+    }
+  }
+
+  int size() const {
+    return n;
+  }
+
+  int count(int x1, int y1, int x2, int y2) const {
+    return walk(x1, y1, x2, y2, (void (*)(int))0);
+  }
+
+  template<class ReportFunction>
+  void query(int x1, int y1, int x2, int y2, ReportFunction f) const {
+    walk(x1, y1, x2, y2, &f);
+  }
+};
+
+/*** Example Usage and Output:
+
+Points in [2, 5] x [1, 4]: 1 3 4
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+using namespace std;
+
+vector<int> found;
+
+void report(int i) {
+  found.push_back(i);
+}
+
+int main() {
+  {
+    pair<int, int> pts[] = {make_pair(1, 1), make_pair(2, 2), make_pair(6, 3),
+                            make_pair(3, 4), make_pair(5, 1), make_pair(4, 5)};
+    cascading_range_tree t(pts, pts + 6);
+    found.clear();
+    t.query(2, 1, 5, 4, report);
+    sort(found.begin(), found.end());
+    cout << "Points in [2, 5] x [1, 4]:";
+    for (int i = 0; i < (int)found.size(); i++) {
+      cout << " " << found[i];
+    }
+    cout << endl;
+    assert(t.count(2, 1, 5, 4) == 3 && t.count(0, 0, 10, 10) == 6);
+    assert(t.count(7, 0, 10, 10) == 0 && t.count(4, 5, 4, 5) == 1);
+  }
+  {
+    // Check counts and reports against a brute force, with repeated
+    // coordinates.
+    vector<pair<int, int> > pts;
+    for (int i = 0; i < 300; i++) {
+      pts.push_back(make_pair(rand() % 50, rand() % 50));
+    }
+    cascading_range_tree t(pts.begin(), pts.end());
+    for (int k = 0; k < 2000; k++) {
+      int x1 = rand() % 55 - 2, x2 = rand() % 55 - 2;
+      int y1 = rand() % 55 - 2, y2 = rand() % 55 - 2;
+      vector<int> expected;
+      for (int i = 0; i < (int)pts.size(); i++) {
+        if (x1 <= pts[i].first && pts[i].first <= x2 &&
+            y1 <= pts[i].second && pts[i].second <= y2) {
+          expected.push_back(i);
+        }
+      }
+      found.clear();
+      t.query(x1, y1, x2, y2, report);
+      sort(found.begin(), found.end());
+      assert(found == expected);
+      assert(t.count(x1, y1, x2, y2) == (int)expected.size());
+    }
+  }
+  return 0;
+}
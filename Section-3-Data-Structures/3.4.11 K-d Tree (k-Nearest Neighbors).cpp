@@ -0,0 +1,360 @@
+/*
+
+Given a static set of points in Dim dimensions, find the k points nearest to a
+query point, or all points within a given distance of it, in terms of Euclidean
+distance. Unlike the k-d trees of sections 3.4.4 and 3.4.5, the dimension is a
+template argument and the coordinates may be of any numeric type Scalar.
+
+The points are copied into one flat array in the order of the tree, so that the
+points of every subtree are consecutive, and the nodes are kept in a flat array
+with the indices of their children. Each leaf holds a bucket of up to LEAF_SIZE
+points (or any number of equal points), whose distances are computed by loops of
+a fixed length Dim over contiguous coordinates, which compilers fully unroll.
+
+The tree is built by the sliding midpoint rule: a node is split at the middle of
+the widest side of its cell (the box bounded by the splits of its ancestors),
+except that if all of its points lie on one side of the middle, the split slides
+to the nearest point, which is then split off on its own. Unlike splitting at
+the median, this keeps cells from growing long and thin, which keeps searches
+efficient on clustered data.
+
+A search visits the child of each node containing the query point first, then
+visits the other child only if the distance from the query point to its cell is
+within the current bound. The distance to the cell is maintained incrementally,
+as in the algorithm of Arya and Mount, by keeping the offset of the query point
+from the cell along every dimension. All search state is local to each call, so
+queries are const and may be made on many threads at once.
+
+- kd_tree(pts, n) constructs a tree from n points given as an array of n*Dim
+  coordinates, in which point i has coordinates pts[i*Dim + d] for d from 0 to
+  Dim - 1.
+- size() returns the number of points.
+- knn(q, k, res) sets res to the (squared distance, index) pairs of the k points
+  nearest to the point with coordinates q[0] to q[Dim - 1], in ascending order
+  of distance, or of all points if there are fewer than k. Ties are broken
+  arbitrarily. The k best so far are kept in a max-heap, whose top gives the
+  bound for pruning.
+- knn(qs, m, k, res) answers m queries with coordinates given as for the
+  constructor, setting res[j*k] to res[j*k + k - 1] to the indices of the k
+  nearest points to query j in ascending order of distance, padded with -1.
+- radius(q, r, res) sets res to the (squared distance, index) pairs of all
+  points within a distance r of q, inclusive, in no particular order.
+
+The distances are computed in Scalar, so integer coordinates should be given as
+long long if their squared distances may exceed the range of int.
+
+Time Complexity:
+- O(n log n) on average per call to the first constructor, where n is the number
+  of points.
+- O(log n + k log k) on average for knn() of a single query in low dimensions,
+  with more cells visited as Dim grows. O(log n + m) on average for radius(),
+  where m is the number of points reported.
+
+Space Complexity:
+- O(n*Dim) for storage of the points and the nodes.
+- O(k + log n) auxiliary per call to knn() and O(m + log n) auxiliary per call
+  to radius(), including the stack space of the search.
+
+*/
+
+#include <algorithm>  // std::max(), std::min(), std::push_heap(), ...
+#include <limits>  // std::numeric_limits
+#include <utility>  // std::make_pair(), std::pair
+#include <vector>
+
+template<int Dim, class Scalar> class kd_tree {
+  static const int LEAF_SIZE = 8;
+
+  struct node_t {
+    int lo, hi;  // The points of the subtree, by index in the tree order.
+    int left, right;  // -1 for a leaf.
+    int dim;
+    Scalar split;
+  };
+
+  int n;
+  std::vector<Scalar> coords;  // In the tree order.
+  std::vector<int> ids;
+  std::vector<node_t> nodes;
+
+  typedef std::pair<Scalar, int> result_t;
+
+  // The k nearest points seen so far in a max-heap.
+  struct knn_visitor {
+    std::vector<result_t> &heap;
+    int k;
+
+    knn_visitor(std::vector<result_t> &heap, int k) : heap(heap), k(k) {}
+
+    Scalar bound() const {
+      return ((int)heap.size() < k) ? std::numeric_limits<Scalar>::max()
+                                    : heap.front().first;
+    }
+
+    void add(const Scalar &d, int id) {
+      if ((int)heap.size() < k) {
+        heap.push_back(result_t(d, id));
+        std::push_heap(heap.begin(), heap.end());
+      } else if (d < heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = result_t(d, id);
+        std::push_heap(heap.begin(), heap.end());
+      }
+    }
+  };
+
+  struct radius_visitor {
+    std::vector<result_t> &res;
+    Scalar r2;
+
+    radius_visitor(std::vector<result_t> &res, const Scalar &r2)
+        : res(res), r2(r2) {}
+
+    // Cells at distance exactly r must still be visited.
+    Scalar bound() const {
+      return r2;
+    }
+
+    void add(const Scalar &d, int id) {
+      if (!(r2 < d)) {
+        res.push_back(result_t(d, id));
+      }
+    }
+  };
+
+  // Builds the node of the points from lo to hi - 1, given their bounding box,
+  // and returns its index.
+  int build(int lo, int hi, std::vector<int> &perm, Scalar *box_lo,
+            Scalar *box_hi) {
+    node_t node;
+    node.lo = lo;
+    node.hi = hi;
+    node.left = node.right = -1;
+    node.dim = -1;
+    // Split the widest side of the cell along which the points are not all
+    // equal, so that a run of equal points ends in a single leaf.
+    const Scalar *c = &coords[0];
+    if (hi - lo > LEAF_SIZE) {
+      for (int d = 0; d < Dim; d++) {
+        Scalar v = c[perm[lo]*Dim + d];
+        bool spread = false;
+        for (int i = lo + 1; i < hi && !spread; i++) {
+          spread = !(c[perm[i]*Dim + d] == v);
+        }
+        if (spread && (node.dim < 0 || box_hi[node.dim] - box_lo[node.dim] <
+                                           box_hi[d] - box_lo[d])) {
+          node.dim = d;
+        }
+      }
+    }
+    int dim = node.dim, index = (int)nodes.size();
+    nodes.push_back(node);
+    if (dim < 0) {
+      return index;
+    }
+    Scalar split = box_lo[dim] + (box_hi[dim] - box_lo[dim])/2;
+    int mid = lo;
+    for (int i = lo; i < hi; i++) {
+      if (c[perm[i]*Dim + dim] < split) {
+        std::swap(perm[i], perm[mid++]);
+      }
+    }
+    // Slide the split to the nearest point if one side is empty.
+    if (mid == lo || mid == hi) {
+      int best = lo;
+      for (int i = lo + 1; i < hi; i++) {
+        Scalar v = c[perm[i]*Dim + dim], w = c[perm[best]*Dim + dim];
+        if ((mid == lo) ? v < w : w < v) {
+          best = i;
+        }
+      }
+      split = c[perm[best]*Dim + dim];
+      if (mid == lo) {
+        std::swap(perm[best], perm[lo]);
+        mid = lo + 1;
+      } else {
+        std::swap(perm[best], perm[hi - 1]);
+        mid = hi - 1;
+      }
+    }
+    nodes[index].split = split;
+    Scalar old = box_hi[dim];
+    box_hi[dim] = split;
+    int left = build(lo, mid, perm, box_lo, box_hi);
+    box_hi[dim] = old;
+    old = box_lo[dim];
+    box_lo[dim] = split;
+    int right = build(mid, hi, perm, box_lo, box_hi);
+    box_lo[dim] = old;
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+  }
+
+  // Visits node u, whose cell has a squared distance of dist from q, where
+  // off[d] is the offset of q from the cell along dimension d.
+  template<class Visitor>
+  void search(int u, const Scalar *q, Scalar dist, Scalar *off,
+              Visitor &v) const {
+    const node_t &node = nodes[u];
+    if (node.left < 0) {
+      for (int i = node.lo; i < node.hi; i++) {
+        const Scalar *p = &coords[i*Dim];
+        Scalar d = 0;
+        for (int j = 0; j < Dim; j++) {
+          d += (q[j] - p[j])*(q[j] - p[j]);
+        }
+        v.add(d, ids[i]);
+      }
+      return;
+    }
+    int dim = node.dim;
+    Scalar diff = q[dim] - node.split;
+    int near = (diff < 0) ? node.left : node.right;
+    int far = (diff < 0) ? node.right : node.left;
+    search(near, q, dist, off, v);
+    Scalar far_dist = dist - off[dim]*off[dim] + diff*diff;
+    if (!(v.bound() < far_dist)) {
+      Scalar old = off[dim];
+      off[dim] = diff;
+      search(far, q, far_dist, off, v);
+      off[dim] = old;
+    }
+  }
+
+  template<class Visitor> void search(const Scalar *q, Visitor &v) const {
+    if (n > 0) {
+      Scalar off[Dim];
+      for (int d = 0; d < Dim; d++) {
+        off[d] = 0;
+      }
+      search(0, q, 0, off, v);
+    }
+  }
+
+ public:
+  kd_tree(const Scalar *pts, int n) : n(n) {
+    if (n == 0) {
+      return;
+    }
+    coords.assign(pts, pts + n*Dim);
+    std::vector<int> perm(n);
+    Scalar box_lo[Dim], box_hi[Dim];
+    for (int d = 0; d < Dim; d++) {
+      box_lo[d] = box_hi[d] = pts[d];
+    }
+    for (int i = 0; i < n; i++) {
+      perm[i] = i;
+      for (int d = 0; d < Dim; d++) {
+        box_lo[d] = std::min(box_lo[d], pts[i*Dim + d]);
+        box_hi[d] = std::max(box_hi[d], pts[i*Dim + d]);
+      }
+    }
+    build(0, n, perm, box_lo, box_hi);
+    ids = perm;
+    for (int i = 0; i < n; i++) {
+      for (int d = 0; d < Dim; d++) {
+        coords[i*Dim + d] = pts[perm[i]*Dim + d];
+      }
+    }
+  }
+
+  int size() const {
+    return n;
+  }
+
+  void knn(const Scalar *q, int k, std::vector<result_t> &res) const {
+    res.clear();
+    if (k > 0) {
+      knn_visitor v(res, k);
+      search(q, v);
+      std::sort_heap(res.begin(), res.end());
+    }
+  }
+
+  void knn(const Scalar *qs, int m, int k, int *res) const {
+    std::vector<result_t> r;
+    for (int j = 0; j < m; j++) {
+      knn(qs + j*Dim, k, r);
+      for (int i = 0; i < k; i++) {
+        res[j*k + i] = (i < (int)r.size()) ? r[i].second : -1;
+      }
+    }
+  }
+
+  void radius(const Scalar *q, const Scalar &r,
+              std::vector<result_t> &res) const {
+    res.clear();
+    radius_visitor v(res, r*r);
+    search(q, v);
+  }
+};
+
+/*** Example Usage and Output:
+
+Nearest 2 to (0, 0): (-1, 0) (0, 2)
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+using namespace std;
+
+int main() {
+  {
+    long long pts[] = {0, 2, 0, 3, -1, 0, 5, 5};
+    kd_tree<2, long long> t(pts, 4);
+    long long q[] = {0, 0};
+    vector<pair<long long, int> > res;
+    t.knn(q, 2, res);
+    cout << "Nearest 2 to (0, 0):";
+    for (int i = 0; i < (int)res.size(); i++) {
+      int j = res[i].second;
+      cout << " (" << pts[2*j] << ", " << pts[2*j + 1] << ")";
+    }
+    cout << endl;
+    t.radius(q, 3, res);
+    assert(res.size() == 3);
+    t.knn(q, 10, res);
+    assert(res.size() == 4 && res[3].second == 3);
+  }
+  {
+    // Compare against a brute force in 8 dimensions, with clustered points.
+    const int D = 8, n = 3000, m = 200, k = 5;
+    vector<float> pts(n*D), qs(m*D);
+    for (int i = 0; i < n*D; i++) {
+      pts[i] = (i/D % 3)*10 + rand() % 1000/100.0f;
+    }
+    for (int i = 0; i < m*D; i++) {
+      qs[i] = rand() % 3000/100.0f;
+    }
+    kd_tree<D, float> t(&pts[0], n);
+    vector<int> batch(m*k);
+    t.knn(&qs[0], m, k, &batch[0]);
+    vector<pair<float, int> > res;
+    for (int j = 0; j < m; j++) {
+      vector<pair<float, int> > all(n);
+      for (int i = 0; i < n; i++) {
+        float d = 0;
+        for (int c = 0; c < D; c++) {
+          float x = qs[j*D + c] - pts[i*D + c];
+          d += x*x;
+        }
+        all[i] = make_pair(d, i);
+      }
+      sort(all.begin(), all.end());
+      t.knn(&qs[j*D], k, res);
+      for (int i = 0; i < k; i++) {
+        assert(res[i].first == all[i].first && batch[j*k + i] == res[i].second);
+      }
+      t.radius(&qs[j*D], 12.0f, res);
+      int expected = 0;
+      for (int i = 0; i < n; i++) {
+        expected += (all[i].first <= 144.0f);
+      }
+      assert((int)res.size() == expected);
+    }
+  }
+  return 0;
+}
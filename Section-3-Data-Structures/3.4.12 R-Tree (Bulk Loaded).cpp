@@ -0,0 +1,798 @@
+/*
+
+Maintain a collection of axis-aligned boxes in two dimensions, each identified
+by an integer id, supporting queries for the boxes intersecting a query box and
+for the k boxes (or objects inside them) nearest to a query point. Unlike the
+static tree of section 3.4.6, this is a dynamic R-tree, in which every node has
+up to M entries, each the bounding box of a child node or, in a leaf, of an
+item. All leaves are at the same depth.
+
+- Bulk loading uses the Sort-Tile-Recursive method: the n items are sorted by
+  the x coordinate of their centers and cut into about sqrt(n/M) vertical
+  slices, each slice is sorted by y and cut into full leaves, and the leaves are
+  packed into the level above them in the same way, and so on up to the root.
+- Insertion follows the R*-tree: the entry descends into the child whose box
+  needs the least enlargement of its overlap with its siblings (just above the
+  leaves) or of its area (higher up), and a full node is split along the axis
+  whose possible splits have the least total perimeter, at the split with the
+  least overlap between the two halves. Forced reinsertion is not done.
+- Erasure removes an item from its leaf, then removes any node left with fewer
+  than MIN_FILL entries, reinserting their entries at their original level.
+- A node stores each coordinate of its entries in its own array of fixed length
+  M, with empty entries set to boxes which intersect nothing. All entries of a
+  node are tested against a query box or point at once by a straight-line loop
+  over the full arrays, using SSE2 instructions for two entries at a time where
+  they are available.
+- The nodes are plain data in one flat array, referring to each other by index.
+  save() writes them out as one block of bytes, and load() reads such a block
+  back with a single copy, without rebuilding anything, so a saved tree may be
+  kept in a file and loaded by mapping the whole file into memory. The copy is
+  checked in one pass before it replaces the tree: every node must be reached
+  exactly once from the root or be on the free list, levels must decrease by
+  one from parent to child, entries past the count must be empty, and so on.
+
+- r_tree() constructs an empty tree.
+- r_tree(lo, hi) bulk loads a tree from a range [lo, hi) of box_t, where the box
+  at position i of the range is given the id i.
+- size() returns the number of items.
+- insert(b, id) adds an item with box b and the given id.
+- erase(b, id) removes an item with box b and the given id, returning whether it
+  was found.
+- query(b, f) calls the function f(id) for each item whose box intersects b,
+  including boxes which merely touch b.
+- nearest(x, y, k, res) sets res to the (squared distance, id) pairs of the k
+  items whose boxes are nearest to (x, y), in ascending order of distance.
+- nearest(x, y, k, res, dist) does the same, with dist(id, x, y) giving the
+  squared distance of (x, y) to the object of each item, such as a segment,
+  which must be no less than the squared distance to the box of the item. The
+  search is best-first, taking nodes and items from a priority queue ordered by
+  their distances, so only the nodes closer than the k-th result are opened.
+- save(buf) writes the tree to buf as a block of bytes, and load(buf, size)
+  reads it back from a block of size bytes, throwing std::runtime_error if the
+  block is not a valid tree, in which case the tree is left unchanged.
+
+Time Complexity:
+- O(n log n) per call to the bulk loading constructor.
+- O(M log n) per call to insert() and erase(), where n is the number of items,
+  and O(M^2) for choosing the child of a node just above the leaves.
+- O(M log n + k) on average per call to query() and O(M (log n + k) log(n))
+  on average per call to nearest(), where k is the number of items reported.
+- O(n) per call to save() and load().
+
+Space Complexity:
+- O(n) for storage of the nodes.
+- O(log n) auxiliary per call to insert() and erase(), and O(M (log n + k))
+  auxiliary per call to query() and nearest().
+
+*/
+
+#include <algorithm>  // std::find(), std::max(), std::min(), std::sort()
+#include <cmath>  // std::ceil(), std::sqrt()
+#include <cstring>  // std::memcpy()
+#include <limits>  // std::numeric_limits
+#include <queue>  // std::priority_queue
+#include <stdexcept>  // std::runtime_error()
+#include <utility>  // std::pair
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>  // _mm_cmple_pd(), _mm_max_pd(), _mm_movemask_pd(), ...
+#endif
+
+class r_tree {
+ public:
+  struct box_t {
+    double x1, y1, x2, y2;
+  };
+
+ private:
+  static const int M = 16, MIN_FILL = 6;
+
+  struct node_t {
+    double x1[M], y1[M], x2[M], y2[M];
+    int child[M];  // The index of a child node, or the id of an item.
+    int count, level;  // A leaf has level 0.
+  };
+
+  struct entry_t {
+    box_t box;
+    int child;
+  };
+
+  std::vector<node_t> nodes;
+  std::vector<int> free_nodes;
+  int root, num_items;
+
+  static double area(const box_t &b) {
+    return (b.x2 - b.x1)*(b.y2 - b.y1);
+  }
+
+  static double margin(const box_t &b) {
+    return (b.x2 - b.x1) + (b.y2 - b.y1);
+  }
+
+  static box_t join(const box_t &a, const box_t &b) {
+    box_t r = {std::min(a.x1, b.x1), std::min(a.y1, b.y1),
+               std::max(a.x2, b.x2), std::max(a.y2, b.y2)};
+    return r;
+  }
+
+  static double overlap(const box_t &a, const box_t &b) {
+    double w = std::min(a.x2, b.x2) - std::max(a.x1, b.x1);
+    double h = std::min(a.y2, b.y2) - std::max(a.y1, b.y1);
+    return (w > 0 && h > 0) ? w*h : 0;
+  }
+
+  static bool contains(const box_t &a, const box_t &b) {
+    return a.x1 <= b.x1 && a.y1 <= b.y1 && b.x2 <= a.x2 && b.y2 <= a.y2;
+  }
+
+  static box_t get(const node_t &n, int i) {
+    box_t b = {n.x1[i], n.y1[i], n.x2[i], n.y2[i]};
+    return b;
+  }
+
+  static void set(node_t &n, int i, const box_t &b, int child) {
+    n.x1[i] = b.x1;
+    n.y1[i] = b.y1;
+    n.x2[i] = b.x2;
+    n.y2[i] = b.y2;
+    n.child[i] = child;
+  }
+
+  // Clears entry i of n to a box which intersects nothing.
+  static void clear(node_t &n, int i) {
+    n.x1[i] = n.y1[i] = std::numeric_limits<double>::max();
+    n.x2[i] = n.y2[i] = -std::numeric_limits<double>::max();
+    n.child[i] = -1;
+  }
+
+  static bool cleared(const node_t &n, int i) {
+    return n.x1[i] == std::numeric_limits<double>::max() &&
+           n.y1[i] == std::numeric_limits<double>::max() &&
+           n.x2[i] == -std::numeric_limits<double>::max() &&
+           n.y2[i] == -std::numeric_limits<double>::max() && n.child[i] == -1;
+  }
+
+  static void remove(node_t &n, int i) {
+    n.count--;
+    set(n, i, get(n, n.count), n.child[n.count]);
+    clear(n, n.count);
+  }
+
+  static box_t bounds(const node_t &n) {
+    box_t b = get(n, 0);
+    for (int i = 1; i < n.count; i++) {
+      b = join(b, get(n, i));
+    }
+    return b;
+  }
+
+  static double center(const box_t &b, int axis) {
+    return (axis == 0) ? b.x1 + b.x2 : b.y1 + b.y2;
+  }
+
+  struct center_less {
+    int axis;
+
+    center_less(int axis) : axis(axis) {}
+
+    bool operator()(const entry_t &a, const entry_t &b) const {
+      return center(a.box, axis) < center(b.box, axis);
+    }
+  };
+
+  // Orders entries by their lower (or upper) edge along an axis.
+  struct edge_less {
+    int axis;
+    bool upper;
+
+    edge_less(int axis, bool upper) : axis(axis), upper(upper) {}
+
+    double key(const box_t &b) const {
+      return (axis == 0) ? (upper ? b.x2 : b.x1) : (upper ? b.y2 : b.y1);
+    }
+
+    bool operator()(const entry_t &a, const entry_t &b) const {
+      return key(a.box) < key(b.box);
+    }
+  };
+
+  int new_node(int level) {
+    int u;
+    if (free_nodes.empty()) {
+      u = (int)nodes.size();
+      nodes.push_back(node_t());
+    } else {
+      u = free_nodes.back();
+      free_nodes.pop_back();
+    }
+    node_t &n = nodes[u];
+    n.count = 0;
+    n.level = level;
+    for (int i = 0; i < M; i++) {
+      clear(n, i);
+    }
+    return u;
+  }
+
+  // Packs entries into nodes of the given level, returning their entries.
+  std::vector<entry_t> pack(std::vector<entry_t> &e, int level) {
+    int n = (int)e.size();
+    int leaves = (n + M - 1)/M;
+    int slices = (int)std::ceil(std::sqrt((double)leaves));
+    int slice_size = ((leaves + slices - 1)/slices)*M;
+    std::sort(e.begin(), e.end(), center_less(0));
+    std::vector<entry_t> res;
+    for (int s = 0; s < n; s += slice_size) {
+      int end = std::min(n, s + slice_size);
+      std::sort(e.begin() + s, e.begin() + end, center_less(1));
+      for (int i = s; i < end; i += M) {
+        int u = new_node(level);
+        node_t &nd = nodes[u];
+        for (int j = i; j < end && j < i + M; j++) {
+          set(nd, nd.count++, e[j].box, e[j].child);
+        }
+        entry_t p = {bounds(nd), u};
+        res.push_back(p);
+      }
+    }
+    return res;
+  }
+
+  // Returns the entry of n into which to insert b (R*-tree rules).
+  int choose(const node_t &n, const box_t &b) const {
+    int best = 0;
+    double best_overlap = 0, best_growth = 0, best_area = 0;
+    for (int i = 0; i < n.count; i++) {
+      box_t e = get(n, i), g = join(e, b);
+      double grow_overlap = 0;
+      if (n.level == 1) {
+        for (int j = 0; j < n.count; j++) {
+          if (j != i) {
+            box_t o = get(n, j);
+            grow_overlap += overlap(g, o) - overlap(e, o);
+          }
+        }
+      }
+      double growth = area(g) - area(e);
+      if (i == 0 || grow_overlap < best_overlap ||
+          (grow_overlap == best_overlap && (growth < best_growth ||
+           (growth == best_growth && area(e) < best_area)))) {
+        best = i;
+        best_overlap = grow_overlap;
+        best_growth = growth;
+        best_area = area(e);
+      }
+    }
+    return best;
+  }
+
+  // Splits the M + 1 entries e between node u and a new node, returning the
+  // entry of the new node (R*-tree split).
+  entry_t split(int u, std::vector<entry_t> &e) {
+    int n = (int)e.size(), lo = MIN_FILL, hi = n - MIN_FILL;
+    std::vector<box_t> pre(n), suf(n);
+    int best_axis = 0;
+    double best_margin = 0;
+    for (int axis = 0; axis < 2; axis++) {
+      double sum = 0;
+      for (int upper = 0; upper < 2; upper++) {
+        std::sort(e.begin(), e.end(), edge_less(axis, upper));
+        prefix(e, pre, suf);
+        for (int k = lo; k <= hi; k++) {
+          sum += margin(pre[k - 1]) + margin(suf[k]);
+        }
+      }
+      if (axis == 0 || sum < best_margin) {
+        best_axis = axis;
+        best_margin = sum;
+      }
+    }
+    int best_k = lo, best_upper = 0;
+    double best_overlap = 0, best_area = 0;
+    for (int upper = 0; upper < 2; upper++) {
+      std::sort(e.begin(), e.end(), edge_less(best_axis, upper));
+      prefix(e, pre, suf);
+      for (int k = lo; k <= hi; k++) {
+        double o = overlap(pre[k - 1], suf[k]);
+        double a = area(pre[k - 1]) + area(suf[k]);
+        if ((upper == 0 && k == lo) || o < best_overlap ||
+            (o == best_overlap && a < best_area)) {
+          best_k = k;
+          best_upper = upper;
+          best_overlap = o;
+          best_area = a;
+        }
+      }
+    }
+    std::sort(e.begin(), e.end(), edge_less(best_axis, best_upper));
+    int v = new_node(nodes[u].level);
+    node_t &a = nodes[u], &b = nodes[v];
+    for (int i = 0; i < M; i++) {
+      clear(a, i);
+    }
+    a.count = 0;
+    for (int i = 0; i < n; i++) {
+      node_t &t = (i < best_k) ? a : b;
+      set(t, t.count++, e[i].box, e[i].child);
+    }
+    entry_t res = {bounds(b), v};
+    return res;
+  }
+
+  static void prefix(const std::vector<entry_t> &e, std::vector<box_t> &pre,
+                     std::vector<box_t> &suf) {
+    int n = (int)e.size();
+    pre[0] = e[0].box;
+    for (int i = 1; i < n; i++) {
+      pre[i] = join(pre[i - 1], e[i].box);
+    }
+    suf[n - 1] = e[n - 1].box;
+    for (int i = n - 2; i >= 0; i--) {
+      suf[i] = join(suf[i + 1], e[i].box);
+    }
+  }
+
+  // Inserts an entry into a node of the given level.
+  void insert(const entry_t &x, int level) {
+    std::vector<std::pair<int, int> > path;  // Nodes and the entries taken.
+    int u = root;
+    while (nodes[u].level > level) {
+      int i = choose(nodes[u], x.box);
+      path.push_back(std::make_pair(u, i));
+      u = nodes[u].child[i];
+    }
+    entry_t carry = x;
+    bool split_up = true;
+    for (int d = (int)path.size(); ; d--) {
+      node_t &n = nodes[u];
+      if (split_up) {
+        split_up = false;
+        if (n.count < M) {
+          set(n, n.count++, carry.box, carry.child);
+        } else {
+          std::vector<entry_t> e(M + 1);
+          for (int i = 0; i < M; i++) {
+            e[i].box = get(n, i);
+            e[i].child = n.child[i];
+          }
+          e[M] = carry;
+          carry = split(u, e);
+          split_up = true;
+        }
+      }
+      if (d == 0) {
+        break;
+      }
+      int p = path[d - 1].first, i = path[d - 1].second;
+      set(nodes[p], i, bounds(nodes[u]), u);
+      u = p;
+    }
+    if (split_up) {
+      int r = new_node(nodes[root].level + 1);
+      node_t &n = nodes[r];
+      entry_t old = {bounds(nodes[root]), root};
+      set(n, n.count++, old.box, old.child);
+      set(n, n.count++, carry.box, carry.child);
+      root = r;
+    }
+  }
+
+  // Removes the item from the subtree of u, collecting the entries of nodes
+  // left underfull, with their levels.
+  bool erase(int u, const box_t &b, int id,
+             std::vector<std::pair<entry_t, int> > &orphans) {
+    if (nodes[u].level == 0) {
+      node_t &n = nodes[u];
+      for (int i = 0; i < n.count; i++) {
+        if (n.child[i] == id && contains(get(n, i), b) &&
+            contains(b, get(n, i))) {
+          remove(n, i);
+          return true;
+        }
+      }
+      return false;
+    }
+    for (int i = 0; i < nodes[u].count; i++) {
+      int v = nodes[u].child[i];
+      if (!contains(get(nodes[u], i), b) || !erase(v, b, id, orphans)) {
+        continue;
+      }
+      node_t &n = nodes[u], &c = nodes[v];
+      if (c.count < MIN_FILL) {
+        for (int j = 0; j < c.count; j++) {
+          entry_t e = {get(c, j), c.child[j]};
+          orphans.push_back(std::make_pair(e, c.level));
+        }
+        free_nodes.push_back(v);
+        remove(n, i);
+      } else {
+        set(n, i, bounds(c), v);
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // Returns a bitmask of which entries of n intersect b.
+  static unsigned int intersecting(const node_t &n, const box_t &b) {
+    unsigned int res = 0;
+#ifdef __SSE2__
+    __m128d x1 = _mm_set1_pd(b.x1), y1 = _mm_set1_pd(b.y1);
+    __m128d x2 = _mm_set1_pd(b.x2), y2 = _mm_set1_pd(b.y2);
+    for (int i = 0; i < M; i += 2) {
+      __m128d cx = _mm_and_pd(_mm_cmple_pd(_mm_loadu_pd(n.x1 + i), x2),
+                              _mm_cmple_pd(x1, _mm_loadu_pd(n.x2 + i)));
+      __m128d cy = _mm_and_pd(_mm_cmple_pd(_mm_loadu_pd(n.y1 + i), y2),
+                              _mm_cmple_pd(y1, _mm_loadu_pd(n.y2 + i)));
+      res |= (unsigned int)_mm_movemask_pd(_mm_and_pd(cx, cy)) << i;
+    }
+#else
+    for (int i = 0; i < M; i++) {
+      res |= (unsigned int)(n.x1[i] <= b.x2 && b.x1 <= n.x2[i] &&
+                            n.y1[i] <= b.y2 && b.y1 <= n.y2[i]) << i;
+    }
+#endif
+    return res;
+  }
+
+  // Sets d[i] to the squared distance from (x, y) to entry i of n.
+  static void distances(const node_t &n, double x, double y, double *d) {
+#ifdef __SSE2__
+    __m128d px = _mm_set1_pd(x), py = _mm_set1_pd(y), zero = _mm_setzero_pd();
+    for (int i = 0; i < M; i += 2) {
+      __m128d dx = _mm_max_pd(_mm_sub_pd(_mm_loadu_pd(n.x1 + i), px),
+                              _mm_sub_pd(px, _mm_loadu_pd(n.x2 + i)));
+      __m128d dy = _mm_max_pd(_mm_sub_pd(_mm_loadu_pd(n.y1 + i), py),
+                              _mm_sub_pd(py, _mm_loadu_pd(n.y2 + i)));
+      dx = _mm_max_pd(dx, zero);
+      dy = _mm_max_pd(dy, zero);
+      _mm_storeu_pd(d + i, _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+    }
+#else
+    for (int i = 0; i < M; i++) {
+      double dx = std::max(std::max(n.x1[i] - x, x - n.x2[i]), 0.0);
+      double dy = std::max(std::max(n.y1[i] - y, y - n.y2[i]), 0.0);
+      d[i] = dx*dx + dy*dy;
+    }
+#endif
+  }
+
+  // A node (if item is false) or an item of the best-first search.
+  struct candidate_t {
+    double dist;
+    int ref;
+    bool item;
+
+    bool operator<(const candidate_t &c) const {
+      return c.dist < dist;  // Nearest first in a std::priority_queue.
+    }
+  };
+
+  template<class Dist>
+  void search(double x, double y, int k, std::vector<std::pair<double, int> >
+              &res, Dist *dist) const {
+    res.clear();
+    if (num_items == 0 || k <= 0) {
+      return;
+    }
+    std::priority_queue<candidate_t> q;
+    candidate_t start = {0, root, false};
+    q.push(start);
+    while (!q.empty() && (int)res.size() < k) {
+      candidate_t c = q.top();
+      q.pop();
+      if (c.item) {
+        res.push_back(std::make_pair(c.dist, c.ref));
+        continue;
+      }
+      const node_t &n = nodes[c.ref];
+      double d[M];
+      distances(n, x, y, d);
+      for (int i = 0; i < n.count; i++) {
+        candidate_t e = {d[i], n.child[i], n.level == 0};
+        if (e.item && dist != 0) {
+          e.dist = (*dist)(e.ref, x, y);
+        }
+        q.push(e);
+      }
+    }
+  }
+
+ public:
+  r_tree() : num_items(0) {
+    root = new_node(0);
+  }
+
+  template<class It> r_tree(It lo, It hi) {
+    std::vector<entry_t> e;
+    for (int i = 0; lo != hi; ++lo, i++) {
+      entry_t x = {*lo, i};
+      e.push_back(x);
+    }
+    num_items = (int)e.size();
+    if (e.empty()) {
+      root = new_node(0);
+      return;
+    }
+    int level = 0;
+    do {
+      e = pack(e, level++);
+    } while (e.size() > 1);
+    root = e[0].child;
+  }
+
+  int size() const {
+    return num_items;
+  }
+
+  void insert(const box_t &b, int id) {
+    entry_t x = {b, id};
+    insert(x, 0);
+    num_items++;
+  }
+
+  bool erase(const box_t &b, int id) {
+    std::vector<std::pair<entry_t, int> > orphans;
+    if (!erase(root, b, id, orphans)) {
+      return false;
+    }
+    num_items--;
+    for (int i = 0; i < (int)orphans.size(); i++) {
+      insert(orphans[i].first, orphans[i].second);
+    }
+    while (nodes[root].level > 0 && nodes[root].count == 1) {
+      free_nodes.push_back(root);
+      root = nodes[root].child[0];
+    }
+    return true;
+  }
+
+  template<class ReportFunction>
+  void query(const box_t &b, ReportFunction f) const {
+    std::vector<int> stack(1, root);
+    while (!stack.empty()) {
+      const node_t &n = nodes[stack.back()];
+      stack.pop_back();
+      // Empty entries intersect nothing, so only entries below count are hit.
+      for (unsigned int hits = intersecting(n, b); hits != 0;
+           hits &= hits - 1) {
+        int i = __builtin_ctz(hits);
+        if (n.level == 0) {
+          f(n.child[i]);
+        } else {
+          stack.push_back(n.child[i]);
+        }
+      }
+    }
+  }
+
+  void nearest(double x, double y, int k,
+               std::vector<std::pair<double, int> > &res) const {
+    search(x, y, k, res, (double (*)(int, double, double))0);
+  }
+
+  template<class Dist>
+  void nearest(double x, double y, int k,
+               std::vector<std::pair<double, int> > &res, Dist dist) const {
+    search(x, y, k, res, &dist);
+  }
+
+  void save(std::vector<char> &buf) const {
+    int header[5] = {M, root, num_items, (int)nodes.size(),
+                     (int)free_nodes.size()};
+    size_t a = sizeof(header), b = nodes.size()*sizeof(node_t);
+    buf.resize(a + b + free_nodes.size()*sizeof(int));
+    std::memcpy(&buf[0], header, a);
+    std::memcpy(&buf[a], &nodes[0], b);
+    if (!free_nodes.empty()) {
+      std::memcpy(&buf[a + b], &free_nodes[0], free_nodes.size()*sizeof(int));
+    }
+  }
+
+  // Loads a tree saved by save() on a machine with the same byte order.
+  void load(const char *buf, size_t size) {
+    int header[5];
+    size_t a = sizeof(header);
+    if (size < a) {
+      throw std::runtime_error("Truncated r_tree header.");
+    }
+    std::memcpy(header, buf, a);
+    int new_root = header[1], new_items = header[2];
+    int num_nodes = header[3], num_free = header[4];
+    if (header[0] != M || num_nodes < 1 || num_free < 0 ||
+        (size - a)/sizeof(node_t) < (size_t)num_nodes) {
+      throw std::runtime_error("Invalid r_tree header.");
+    }
+    size_t b = num_nodes*sizeof(node_t), rest = size - a - b;
+    if (rest % sizeof(int) != 0 || rest/sizeof(int) != (size_t)num_free ||
+        new_root < 0 || new_root >= num_nodes || new_items < 0) {
+      throw std::runtime_error("Invalid r_tree header.");
+    }
+    std::vector<node_t> new_nodes(num_nodes);
+    std::vector<int> new_free(num_free);
+    std::memcpy(&new_nodes[0], buf + a, b);
+    if (num_free > 0) {
+      std::memcpy(&new_free[0], buf + a + b, rest);
+    }
+    // Walk down from the root, so that every node is reached at most once and
+    // only through an entry whose box contains it.
+    std::vector<bool> seen(num_nodes, false);
+    std::vector<int> stack(1, new_root);
+    seen[new_root] = true;
+    long long items = 0;
+    while (!stack.empty()) {
+      int u = stack.back();
+      stack.pop_back();
+      const node_t &n = new_nodes[u];
+      int min_count = (u == new_root && n.level == 0) ? 0 : 1;
+      if (n.count < min_count || n.count > M || n.level < 0) {
+        throw std::runtime_error("Invalid r_tree node.");
+      }
+      for (int i = n.count; i < M; i++) {
+        if (!cleared(n, i)) {
+          throw std::runtime_error("Invalid r_tree node.");
+        }
+      }
+      if (n.level == 0) {
+        items += n.count;
+        continue;
+      }
+      for (int i = 0; i < n.count; i++) {
+        int v = n.child[i];
+        if (v < 0 || v >= num_nodes || seen[v] ||
+            new_nodes[v].level != n.level - 1 || new_nodes[v].count < 1 ||
+            new_nodes[v].count > M ||
+            !contains(get(n, i), bounds(new_nodes[v]))) {
+          throw std::runtime_error("Invalid r_tree node.");
+        }
+        seen[v] = true;
+        stack.push_back(v);
+      }
+    }
+    if (items != new_items) {
+      throw std::runtime_error("Invalid r_tree item count.");
+    }
+    for (int i = 0; i < num_free; i++) {
+      int v = new_free[i];
+      if (v < 0 || v >= num_nodes || seen[v]) {
+        throw std::runtime_error("Invalid r_tree free list.");
+      }
+      seen[v] = true;
+    }
+    if (std::find(seen.begin(), seen.end(), false) != seen.end()) {
+      throw std::runtime_error("Invalid r_tree free list.");
+    }
+    root = new_root;
+    num_items = new_items;
+    nodes.swap(new_nodes);
+    free_nodes.swap(new_free);
+  }
+};
+
+/*** Example Usage and Output:
+
+Nearest to (-1, 1): 0 3
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+#include <stdexcept>  // std::runtime_error
+using namespace std;
+
+typedef r_tree::box_t box;
+
+struct segment {
+  double x1, y1, x2, y2;
+};
+
+vector<segment> segs;
+
+// The squared distance from (x, y) to segment i.
+double segment_distance(int i, double x, double y) {
+  const segment &s = segs[i];
+  double dx = s.x2 - s.x1, dy = s.y2 - s.y1, px = x - s.x1, py = y - s.y1;
+  double len = dx*dx + dy*dy, t = (len > 0) ? (dx*px + dy*py)/len : 0;
+  t = max(0.0, min(1.0, t));
+  return (px - t*dx)*(px - t*dx) + (py - t*dy)*(py - t*dy);
+}
+
+vector<int> found;
+
+void report(int id) {
+  found.push_back(id);
+}
+
+bool intersects(const box &a, const box &b) {
+  return a.x1 <= b.x2 && b.x1 <= a.x2 && a.y1 <= b.y2 && b.y1 <= a.y2;
+}
+
+int main() {
+  {
+    segment s[] = {{0, 0, 0, 4}, {0, 4, 4, 4}, {4, 4, 4, 0}, {4, 0, 0, 0}};
+    segs.assign(s, s + 4);
+    vector<box> b;
+    for (int i = 0; i < 4; i++) {
+      box x = {min(s[i].x1, s[i].x2), min(s[i].y1, s[i].y2),
+               max(s[i].x1, s[i].x2), max(s[i].y1, s[i].y2)};
+      b.push_back(x);
+    }
+    r_tree t(b.begin(), b.end());
+    vector<pair<double, int> > res;
+    t.nearest(-1, 1, 2, res, segment_distance);
+    cout << "Nearest to (-1, 1): " << res[0].second << " " << res[1].second
+         << endl;
+  }
+  {
+    // Bulk load, insert, and erase random boxes, checking queries against a
+    // brute force, then save and load the tree.
+    const int n = 3000;
+    vector<box> boxes(n);
+    vector<bool> alive(n, true);
+    for (int i = 0; i < n; i++) {
+      double x = rand() % 10000, y = rand() % 10000;
+      box b = {x, y, x + rand() % 100, y + rand() % 100};
+      boxes[i] = b;
+    }
+    r_tree t(boxes.begin(), boxes.begin() + n/2);
+    for (int i = n/2; i < n; i++) {
+      t.insert(boxes[i], i);
+    }
+    for (int i = 0; i < n; i += 3) {
+      assert(t.erase(boxes[i], i));
+      alive[i] = false;
+    }
+    assert(!t.erase(boxes[0], 0) && t.size() == n - (n + 2)/3);
+    vector<char> buf;
+    t.save(buf);
+    r_tree u;
+    u.load(&buf[0], buf.size());
+    // Corrupted and truncated blocks are rejected without touching u.
+    for (int k = 0; k < 200; k++) {
+      vector<char> bad(buf);
+      int i = rand() % (int)bad.size();
+      bad[i] = (char)(bad[i] ^ (1 << (rand() % 8)));
+      r_tree v;
+      try {
+        v.load(&bad[0], (k % 2 == 0) ? bad.size() : rand() % bad.size());
+      } catch (runtime_error &) {}
+      assert(v.size() == 0 || v.size() == t.size());
+    }
+    bool thrown = false;
+    try {
+      u.load(&buf[0], buf.size() - 1);
+    } catch (runtime_error &) {
+      thrown = true;
+    }
+    assert(thrown && u.size() == t.size());
+    for (int k = 0; k < 200; k++) {
+      double x = rand() % 10000, y = rand() % 10000;
+      box q = {x, y, x + rand() % 500, y + rand() % 500};
+      vector<int> expected;
+      vector<pair<double, int> > all;
+      for (int i = 0; i < n; i++) {
+        if (alive[i]) {
+          if (intersects(boxes[i], q)) {
+            expected.push_back(i);
+          }
+          double dx = max(max(boxes[i].x1 - x, x - boxes[i].x2), 0.0);
+          double dy = max(max(boxes[i].y1 - y, y - boxes[i].y2), 0.0);
+          all.push_back(make_pair(dx*dx + dy*dy, i));
+        }
+      }
+      found.clear();
+      u.query(q, report);
+      sort(found.begin(), found.end());
+      assert(found == expected);
+      sort(all.begin(), all.end());
+      vector<pair<double, int> > res;
+      t.nearest(x, y, 10, res);
+      for (int i = 0; i < 10; i++) {
+        assert(res[i].first == all[i].first);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,331 @@
+/*
+
+Given a static set of closed intervals, each tagged with an integer key such as
+the chromosome of a genomic interval, report the intervals of a key which
+overlap a query interval or contain a query point. Unlike the treap of section
+3.4.8, this index allocates no nodes: the intervals of each key are sorted by
+their lower ends and kept in flat arrays, which are read as an implicit binary
+search tree in in-order layout, each entry also storing the largest upper end in
+its subtree.
+
+In the in-order layout, entry i is a node of height k if the lowest k bits of i
+are set and the next is clear, so that the leaves are the even entries and the
+root of an array of n entries is entry 2^K - 1 for the largest K with 2^K <= n.
+The children of a node i of height k are i - 2^(k - 1) and i + 2^(k - 1), where
+the right child may lie past the end of the array, in which case it stands for
+the entries which remain. A query descends into the left child of a node only
+if the largest upper end there reaches the query, and into the right child only
+if the lower end of the node is within the query. Subtrees of height at most 3
+are simply scanned in order, since their entries are adjacent in memory.
+
+For batches of queries, join() sorts the queries by key and lower end, and then
+sweeps along the intervals of each key in order of their lower ends, keeping a
+list of the intervals which have started and not yet ended. Every method only
+reads the index, so a batch of queries may also be split into shares, each
+answered by its own call to query(), count() or join().
+
+- interval_index(lo, hi) constructs the index from a range [lo, hi) of
+  interval_t, where the interval at position i of the range is given the id i.
+- size() returns the number of intervals.
+- query(key, lo, hi, f) calls the function f(id) for each interval of the key
+  which overlaps [lo, hi], in increasing order of lower ends.
+- stab(key, x, f) calls f(id) for each interval of the key which contains x.
+- count(key, lo, hi) returns the number of intervals of the key overlapping
+  [lo, hi].
+- join(lo, hi, f) calls the function f(q, id) for each query interval q in the
+  range [lo, hi) of interval_t and each interval with the same key which
+  overlaps it, where q is the position of the query in the range.
+
+Time Complexity:
+- O(n log n) per call to the constructor, where n is the number of intervals.
+- O(1) per call to size().
+- O(log n + k) per call to query(), stab(), and count() for queries which do
+  not contain one another, where k is the number of intervals reported, and
+  O(min(n, k log n)) in the worst case.
+- O(n + m log m + a) per call to join() for m queries, where a is the sum over
+  the queries of the number of intervals which have started by its upper end
+  (at most the largest upper end before it) and not ended before its lower end.
+  This is O(n + m log m + k) when no query is much longer than the others.
+
+Space Complexity:
+- O(n) for storage of the index.
+- O(log n) auxiliary per call to query(), stab(), and count(), and O(m + a)
+  auxiliary per call to join().
+
+*/
+
+#include <algorithm>  // std::lower_bound(), std::max(), std::min(), std::sort()
+#include <utility>  // std::make_pair(), std::pair
+#include <vector>
+
+class interval_index {
+ public:
+  struct interval_t {
+    int key, lo, hi;
+  };
+
+ private:
+  // The intervals of keys[j] are entries start[j] to start[j + 1] - 1, and the
+  // root of their tree has height height[j].
+  std::vector<int> keys, start, height;
+  std::vector<int> lo, hi, max_hi, ids;
+
+  struct key_less {
+    const std::vector<interval_t> *v;
+
+    key_less(const std::vector<interval_t> *v) : v(v) {}
+
+    bool operator()(int a, int b) const {
+      const interval_t &x = (*v)[a], &y = (*v)[b];
+      return x.key < y.key || (x.key == y.key && (x.lo < y.lo ||
+             (x.lo == y.lo && a < b)));
+    }
+  };
+
+  // Sets max_hi for the n entries from b, returning the height of the root.
+  int build(int b, int n) {
+    const int *h = &hi[b];
+    int *mx = &max_hi[b];
+    int last_i = 0, last = h[0], k;
+    for (int i = 0; i < n; i += 2) {
+      last_i = i;
+      last = mx[i] = h[i];
+    }
+    // last is the largest upper end below the last node of height k.
+    for (k = 1; (1 << k) <= n; k++) {
+      int x = 1 << (k - 1);
+      for (int i = 2*x - 1; i < n; i += 4*x) {
+        int r = (i + x < n) ? mx[i + x] : last;
+        mx[i] = std::max(h[i], std::max(mx[i - x], r));
+      }
+      last_i = (last_i >> k & 1) ? last_i - x : last_i + x;
+      if (last_i < n) {
+        last = std::max(last, mx[last_i]);
+      }
+    }
+    return k - 1;
+  }
+
+  // Counts the entries of keys[j] overlapping [a, b], reporting their ids if f
+  // is not NULL.
+  template<class ReportFunction>
+  int walk(int j, int a, int b, ReportFunction *f) const {
+    int base = start[j], n = start[j + 1] - base, res = 0;
+    const int *l = &lo[base], *h = &hi[base], *mx = &max_hi[base];
+    struct frame_t {
+      int k, x;
+      bool left_done;
+    } stack[64];
+    int top = 0;
+    frame_t root = {height[j], (1 << height[j]) - 1, false};
+    stack[top++] = root;
+    while (top > 0) {
+      frame_t z = stack[--top];
+      if (z.k <= 3) {
+        int i = z.x >> z.k << z.k, end = std::min(n, i + (2 << z.k) - 1);
+        for (; i < end && l[i] <= b; i++) {
+          if (a <= h[i]) {
+            res++;
+            if (f != 0) {
+              (*f)(ids[base + i]);
+            }
+          }
+        }
+      } else if (!z.left_done) {
+        int y = z.x - (1 << (z.k - 1));
+        z.left_done = true;
+        stack[top++] = z;
+        if (y >= n || mx[y] >= a) {
+          frame_t c = {z.k - 1, y, false};
+          stack[top++] = c;
+        }
+      } else if (z.x < n && l[z.x] <= b) {
+        if (a <= h[z.x]) {
+          res++;
+          if (f != 0) {
+            (*f)(ids[base + z.x]);
+          }
+        }
+        frame_t c = {z.k - 1, z.x + (1 << (z.k - 1)), false};
+        stack[top++] = c;
+      }
+    }
+    return res;
+  }
+
+  // Returns the index of key in keys, or -1 if absent.
+  int find(int key) const {
+    int j = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+    return (j < (int)keys.size() && keys[j] == key) ? j : -1;
+  }
+
+ public:
+  template<class It> interval_index(It begin, It end) {
+    std::vector<interval_t> v(begin, end);
+    int n = (int)v.size();
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), key_less(&v));
+    lo.resize(n);
+    hi.resize(n);
+    max_hi.resize(n);
+    ids = order;
+    for (int i = 0; i < n; i++) {
+      lo[i] = v[order[i]].lo;
+      hi[i] = v[order[i]].hi;
+      if (i == 0 || v[order[i]].key != keys.back()) {
+        keys.push_back(v[order[i]].key);
+        start.push_back(i);
+      }
+    }
+    start.push_back(n);
+    for (int j = 0; j < (int)keys.size(); j++) {
+      height.push_back(build(start[j], start[j + 1] - start[j]));
+    }
+  }
+
+  int size() const {
+    return (int)lo.size();
+  }
+
+  template<class ReportFunction>
+  void query(int key, int lo, int hi, ReportFunction f) const {
+    int j = find(key);
+    if (j >= 0) {
+      walk(j, lo, hi, &f);
+    }
+  }
+
+  template<class ReportFunction>
+  void stab(int key, int x, ReportFunction f) const {
+    query(key, x, x, f);
+  }
+
+  int count(int key, int lo, int hi) const {
+    int j = find(key);
+    return (j >= 0) ? walk(j, lo, hi, (void (*)(int))0) : 0;
+  }
+
+  template<class It, class ReportFunction>
+  void join(It begin, It end, ReportFunction f) const {
+    std::vector<interval_t> q(begin, end);
+    int m = (int)q.size();
+    std::vector<int> order(m), active;
+    for (int i = 0; i < m; i++) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), key_less(&q));
+    for (int a = 0, b; a < m; a = b) {
+      int key = q[order[a]].key, j = find(key);
+      for (b = a; b < m && q[order[b]].key == key; b++) {}
+      if (j < 0) {
+        continue;
+      }
+      int p = start[j], e = start[j + 1];
+      active.clear();
+      for (int i = a; i < b; i++) {
+        const interval_t &x = q[order[i]];
+        for (; p < e && lo[p] <= x.hi; p++) {
+          active.push_back(p);
+        }
+        // Intervals ending before x ends before every later query.
+        int len = 0;
+        for (int t = 0; t < (int)active.size(); t++) {
+          int y = active[t];
+          if (hi[y] >= x.lo) {
+            active[len++] = y;
+            if (lo[y] <= x.hi) {
+              f(order[i], ids[y]);
+            }
+          }
+        }
+        active.resize(len);
+      }
+    }
+  }
+};
+
+/*** Example Usage and Output:
+
+Key 1 overlapping [10, 20]: 0 1 4 3 2
+Key 2 containing 35: 5
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+using namespace std;
+
+typedef interval_index::interval_t interval;
+
+vector<int> found;
+vector<pair<int, int> > pairs;
+
+void report(int id) {
+  found.push_back(id);
+}
+
+void report_pair(int q, int id) {
+  pairs.push_back(make_pair(q, id));
+}
+
+int main() {
+  {
+    interval v[] = {{1, 5, 20}, {1, 10, 30}, {1, 17, 19}, {1, 15, 20},
+                    {1, 12, 15}, {2, 30, 40}, {1, 30, 40}};
+    interval_index t(v, v + 7);
+    found.clear();
+    t.query(1, 10, 20, report);
+    cout << "Key 1 overlapping [10, 20]:";
+    for (int i = 0; i < (int)found.size(); i++) {
+      cout << " " << found[i];
+    }
+    cout << endl;
+    found.clear();
+    t.stab(2, 35, report);
+    cout << "Key 2 containing 35:";
+    for (int i = 0; i < (int)found.size(); i++) {
+      cout << " " << found[i];
+    }
+    cout << endl;
+    assert(t.count(1, 0, 4) == 0 && t.count(1, 20, 30) == 4);
+    assert(t.count(3, 0, 100) == 0);
+  }
+  {
+    // Check queries and joins against a brute force.
+    vector<interval> v, qs;
+    for (int i = 0; i < 2000; i++) {
+      int a = rand() % 1000, len = rand() % ((rand() % 4 == 0) ? 300 : 20);
+      interval x = {rand() % 3, a, a + len};
+      v.push_back(x);
+    }
+    interval_index t(v.begin(), v.end());
+    assert(t.size() == 2000);
+    for (int k = 0; k < 500; k++) {
+      int a = rand() % 1100 - 50, len = rand() % 100;
+      interval x = {rand() % 4, a, a + len};
+      qs.push_back(x);
+      vector<int> expected;
+      for (int i = 0; i < (int)v.size(); i++) {
+        if (v[i].key == x.key && v[i].lo <= x.hi && x.lo <= v[i].hi) {
+          expected.push_back(i);
+          pairs.push_back(make_pair(k, i));
+        }
+      }
+      found.clear();
+      t.query(x.key, x.lo, x.hi, report);
+      assert(t.count(x.key, x.lo, x.hi) == (int)found.size());
+      sort(found.begin(), found.end());
+      assert(found == expected);
+    }
+    vector<pair<int, int> > expected;
+    expected.swap(pairs);
+    t.join(qs.begin(), qs.end(), report_pair);
+    sort(pairs.begin(), pairs.end());
+    assert(pairs == expected);
+  }
+  return 0;
+}
@@ -13,6 +13,14 @@ and at() operations. size() is O(1).
 
 Space Complexity: Left as an exercise for the reader.
 
+The operations are defined by the template argument Policy, as
+in the segment trees of section 3.3 (any policy from there may be
+used). Queries return the join_values() of a rectangle, where
+join_values() must be commutative and Policy::identity() must be
+the value of cells never updated. update(x, y, d) assigns the
+value v at (x, y) to join_value_with_delta(v, d, 1). The default
+policy defines "max" queries and "assign" updates.
+
 Note: This implementation is 0-based. Valid indices for
 all operations are [0..xmax][0..ymax]
 
@@ -20,14 +28,38 @@ all operations are [0..xmax][0..ymax]
 
 #include <limits> /* std::numeric_limits<T>::min() */
 
-template<class T> class segment_tree_2d {
+// The default policy of "max" queries and "assign" updates. The other policies
+// of section 3.3.2 (or any struct with the same members) may be used instead.
+template<class T> struct max_assign_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return std::numeric_limits<T>::min(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? b : a; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return d;
+  }
+
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d2;
+  }
+};
+
+template<class T, class Policy = max_assign_policy<T> >
+class segment_tree_2d {
+  typedef typename Policy::delta_t delta_t;
+  typedef char commutative_policy_required[Policy::commutative ? 1 : -1];
+
   //these can be set to large values without affecting your memory usage!
   static const int xmax = 1000000000;
   static const int ymax = 1000000000;
 
-  //define the following yourself. merge(x, nullv) must return x for all valid x
-  static inline T nullv() { return std::numeric_limits<T>::min(); }
-  static inline T merge(const T & a, const T & b) { return a > b ? a : b; }
+  static inline T nullv() { return Policy::identity(); }
+  static inline T merge(const T & a, const T & b) {
+    return Policy::join_values(a, b);
+  }
 
   struct layer2_node {
     int lo, hi;
@@ -117,7 +149,8 @@ template<class T> class segment_tree_2d {
   segment_tree_2d() { root = new layer1_node(); }
   ~segment_tree_2d() { clean_up1(root); }
 
-  void update(int x, int y, const T & v) {
+  void update(int x, int y, const delta_t & d) {
+    T v = Policy::join_value_with_delta(at(x, y), d, 1);
     update1(root, 0, xmax, x, y, v);
   }
 
@@ -8,9 +8,13 @@ CLRS (2009, Section 14.3: pp. 348–354), is one way to represent these
 intervals. This implementation uses a treap to maintain balance.
 See: http://en.wikipedia.org/wiki/Interval_tree#Augmented_tree
 
+Nodes are allocated from the template argument Pool, by default a slab
+allocator, so that clear() and the destructor release every node with
+one sweep over the slabs instead of a traversal of the tree.
+
 Time Complexity: On average O(log N) for insert() and O(k) for query(),
 where N is the number of intervals in the tree and k is the number of
-intervals that will be reported by each query().
+intervals that will be reported by each query(). clear() is O(log N).
 
 Space Complexity: O(N) on the number of intervals in the tree.
 
@@ -18,9 +22,80 @@ Space Complexity: O(N) on the number of intervals in the tree.
 
 #include <cstdlib>   /* srand() */
 #include <ctime>     /* time() */
+#include <new>       /* placement new */
 #include <utility>   /* std:pair */
+#include <vector>
+
+// A slab allocator for nodes with a free list, as in section 3.5.1.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  std::vector<std::pair<slot*, size_t> > slabs;
+  slot *free_list;
+  size_t used;  // The number of slots handed out from the last slab.
+
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
+
+ public:
+  node_pool() : free_list(0), used(0) {}
+
+  ~node_pool() {
+    clear();
+  }
+
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != 0) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || used == slabs.back().second) {
+        size_t n = slabs.empty() ? 64 : 2*slabs.back().second;
+        slabs.push_back(std::make_pair(new slot[n], n));
+        used = 0;
+      }
+      s = slabs.back().first + used++;
+    }
+    s->next = s;
+    return s->u.data;
+  }
 
-class interval_tree {
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    s->next = free_list;
+    free_list = s;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        size_t n = (i + 1 == slabs.size()) ? used : slabs[i].second;
+        for (size_t j = 0; j < n; j++) {
+          slot *s = slabs[i].first + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].first;
+    }
+    slabs.clear();
+    free_list = 0;
+    used = 0;
+  }
+};
+
+template<template<class> class Pool = node_pool> class interval_tree {
   typedef std::pair<int, int> interval;
 
   static bool overlap(const interval & a, const interval & b) {
@@ -50,6 +125,8 @@ class interval_tree {
     }
   } *root;
 
+  Pool<node_t> pool;
+
   static void rotate_l(node_t *& k2) {
     node_t *k1 = k2->R;
     k2->R = k1->L;
@@ -71,7 +148,7 @@ class interval_tree {
   interval i; //temporary
 
   void insert(node_t *& n) {
-    if (n == 0) { n = new node_t(i); return; }
+    if (n == 0) { n = new (pool.allocate()) node_t(i); return; }
     if (i.first < (n->i).first) {
       insert(n->L);
       if (n->L->priority < n->priority) rotate_r(n);
@@ -90,16 +167,9 @@ class interval_tree {
     query(n->R, f);
   }
 
-  static void clean_up(node_t * n) {
-    if (n == 0) return;
-    clean_up(n->L);
-    clean_up(n->R);
-    delete n;
-  }
-
  public:
   interval_tree(): root(0) { srand(time(0)); }
-  ~interval_tree() { clean_up(root); }
+  void clear() { pool.clear(); root = 0; }
 
   void insert(int lo, int hi) {
     i = interval(lo, hi);
@@ -129,7 +199,7 @@ void count(int lo, int hi) { cnt++; }
 int main() {
   int N = 6;
   int intv[6][2] = {{15, 20}, {10, 30}, {17, 19}, {5, 20}, {12, 15}, {30, 40}};
-  interval_tree T;
+  interval_tree<> T;
   for (int i = 0; i < N; i++) {
     T.insert(intv[i][0], intv[i][1]);
   }
@@ -148,5 +218,9 @@ int main() {
       assert(cnt == cnt2);
     }
   }
+  T.clear();
+  cnt = 0;
+  T.query(0, 50, count);
+  assert(cnt == 0);
   return 0;
 }
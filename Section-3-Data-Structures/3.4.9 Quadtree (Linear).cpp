@@ -0,0 +1,621 @@
+/*
+
+Maintain a two-dimensional array while supporting both dynamic queries and
+updates of rectangular sub-arrays via the lazy propagation technique, as in the
+quadtree of section 3.4.1, but without pointers. The square of rows and columns
+from 0 to 2^30 - 1 is split into quadrants, and each node of the quadtree is
+named by its location code: the root is 1, and the children of node k are
+4*k + q for the quadrants q from 0 to 3 (q = 2*row bit + column bit). The code
+of a cell is thus the leading bit 1 followed by the bits of its row and column
+interleaved, that is, its Morton (Z-order) code, and the code of any node is the
+Morton code of its cells shifted right by twice the number of levels below it.
+
+The four children of a node are created together and stored side by side in
+one flat array of groups, and an open-addressing hashmap (as in section 3.5.6)
+maps the location code of a node to the index of the group of its children. A
+node is thus reached by computing the code of its parent and probing a flat
+table, rather than by following a pointer. Since the codes of the children of a
+node are known before any of them is visited, traversals prefetch the table
+slots of all four groups below them first, so that their cache misses overlap
+instead of following one another. A node without a group has the same value in
+all of its cells.
+
+Each node stores the result of its square with all updates applied, plus a lazy
+delta which remains to be passed to its children. Updates push the deltas of the
+nodes which they split, as usual. Queries never modify the tree: since the delta
+of a node is newer than everything below it, a query joins the deltas of the
+nodes on its way down and applies them to the value of each node which it takes
+in full.
+
+The query and update operations are defined by the static members of the
+template argument Policy, as in the segment trees of section 3.3 (any policy
+from there may be used), with areas in place of lengths. As in section 3.4.1,
+join_values() must also be commutative. The default policy defines queries for
+the "min" of the target range and updates that "assign" the chosen indices a new
+value.
+
+- linear_quadtree(v) constructs a two-dimensional array with rows and columns
+  from 0 to 2^30 - 1, inclusive. All values are implicitly initialized to v.
+- linear_quadtree(lo, hi, v) constructs the same array, except that the cells
+  given by a range [lo, hi) of std::pair<std::pair<int, int>, T>, each a row and
+  column with a value, are assigned those values. The cells must be distinct.
+  The cells are sorted by Morton code, which makes the cells of each node
+  consecutive, so every level is built from the level below it in one pass.
+- at(r, c) returns the value at row r, column c.
+- clear() resets every value to v.
+- query(r1, c1, r2, c2) returns the result of join_values() applied to every
+  value in the rectangular region consisting of rows from r1 to r2 and columns
+  from c1 to c2, inclusive.
+- update(r, c, d) assigns the value v at (r, c) to
+  join_value_with_delta(v, d, 1).
+- update(r1, c1, r2, c2, d) modifies the value at each index of the rectangular
+  region consisting of rows from r1 to r2 and columns from c1 to c2, inclusive,
+  by respectively joining them with d using join_value_with_delta().
+- nodes() returns the number of nodes stored.
+
+Time Complexity:
+- O(1) per call to the first constructor and nodes().
+- O(n log n + 30*n) per call to the second constructor, for n cells.
+- O(n) per call to clear() and the destructor, where n is the number of nodes.
+- O(30) expected per call to at() and update(r, c, d), and O(2^30) expected in
+  the worst case per call to update(r1, c1, r2, c2, d) and query(), as for the
+  quadtree of section 3.4.1.
+
+Space Complexity:
+- O(n) for storage of the nodes, of which there are at most 4*30 per updated
+  entry of the array.
+- O(30) auxiliary stack space per call to update(), query(), and at().
+
+*/
+
+#include <algorithm>  // std::max(), std::min(), std::sort()
+#include <cstring>  // std::memset()
+#include <limits>  // std::numeric_limits
+#include <new>  // operator new(), placement new
+#include <utility>  // std::make_pair(), std::pair
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>  // _mm_cmpeq_epi8(), _mm_movemask_epi8(), ...
+#endif
+
+// A hashmap with linear probing as in section 3.5.6, without removal, plus
+// clear(), reserve(), and prefetch().
+template<class key_t, class val_t, class Hash> class flat_hashmap {
+  static const int GROUP = 16;
+  static const signed char EMPTY = -128;
+
+  typedef std::pair<key_t, val_t> entry_t;
+
+  signed char *ctrl;
+  entry_t *slots;
+  size_t mask, map_size;
+
+  static signed char tag(size_t h) {
+    return (signed char)(h & 0x7f);
+  }
+
+  // Returns a bitmask of which of the GROUP control bytes from i equal t.
+  unsigned int match(size_t i, signed char t) const {
+#ifdef __SSE2__
+    __m128i g = _mm_loadu_si128((const __m128i*)(ctrl + i));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(t)));
+#else
+    unsigned int res = 0;
+    for (int j = 0; j < GROUP; j++) {
+      res |= (unsigned int)(ctrl[i + j] == t) << j;
+    }
+    return res;
+#endif
+  }
+
+  void set_ctrl(size_t i, signed char c) {
+    ctrl[i] = c;
+    if (i < GROUP - 1) {
+      ctrl[mask + 1 + i] = c;
+    }
+  }
+
+  // Returns the slot holding key, or else the empty slot ending its run with
+  // found set to false.
+  template<class K>
+  size_t probe(const K &key, size_t h, bool &found) const {
+    signed char t = tag(h);
+    for (size_t i = (h >> 7) & mask; ; i = (i + GROUP) & mask) {
+      unsigned int empty = match(i, EMPTY);
+      // Tags at or past the first empty byte belong to other runs. If there
+      // is no empty byte, then (empty & -empty) - 1 has all bits set.
+      unsigned int hits = match(i, t) & ((empty & -empty) - 1);
+      for (; hits != 0; hits &= hits - 1) {
+        size_t j = (i + __builtin_ctz(hits)) & mask;
+        if (slots[j].first == key) {
+          found = true;
+          return j;
+        }
+      }
+      if (empty != 0) {
+        found = false;
+        return (i + __builtin_ctz(empty)) & mask;
+      }
+    }
+  }
+
+  void allocate(size_t capacity) {
+    mask = capacity - 1;
+    ctrl = new signed char[capacity + GROUP - 1];
+    std::memset(ctrl, EMPTY, capacity + GROUP - 1);
+    slots = (entry_t*)operator new(capacity*sizeof(entry_t));
+  }
+
+  void rehash() {
+    signed char *old_ctrl = ctrl;
+    entry_t *old_slots = slots;
+    size_t old_capacity = mask + 1;
+    allocate(2*old_capacity);
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] != EMPTY) {
+        size_t h = Hash()(old_slots[i].first);
+        size_t j = (h >> 7) & mask;
+        while (ctrl[j] != EMPTY) {
+          j = (j + 1) & mask;
+        }
+        set_ctrl(j, tag(h));
+        new (slots + j) entry_t(old_slots[i]);
+        old_slots[i].~entry_t();
+      }
+    }
+    delete[] old_ctrl;
+    operator delete(old_slots);
+  }
+
+  flat_hashmap(const flat_hashmap &);
+  flat_hashmap& operator=(const flat_hashmap &);
+
+ public:
+  // The capacity is rounded up to a power of two of at least GROUP.
+  flat_hashmap(size_t capacity = GROUP) : map_size(0) {
+    size_t c = GROUP;
+    while (c < capacity) {
+      c *= 2;
+    }
+    allocate(c);
+  }
+
+  ~flat_hashmap() {
+    for (size_t i = 0; i <= mask; i++) {
+      if (ctrl[i] != EMPTY) {
+        slots[i].~entry_t();
+      }
+    }
+    delete[] ctrl;
+    operator delete(slots);
+  }
+
+  size_t size() const {
+    return map_size;
+  }
+
+  void clear() {
+    for (size_t i = 0; i <= mask; i++) {
+      if (ctrl[i] != EMPTY) {
+        slots[i].~entry_t();
+      }
+    }
+    std::memset(ctrl, EMPTY, mask + GROUP);
+    map_size = 0;
+  }
+
+  // Grows the table so that n entries fit without a further rehash.
+  void reserve(size_t n) {
+    while (8*n > 7*(mask + 1)) {
+      rehash();
+    }
+  }
+
+  // Hints that key is about to be looked up, fetching its first group.
+  void prefetch(const key_t &key) const {
+    size_t i = (Hash()(key) >> 7) & mask;
+    __builtin_prefetch(ctrl + i);
+    __builtin_prefetch(slots + i);
+  }
+
+  // Inserts the entry if key is not yet present, and returns its value.
+  val_t& insert(const key_t &key, const val_t &val) {
+    size_t h = Hash()(key);
+    bool found;
+    size_t i = probe(key, h, found);
+    if (!found) {
+      if (8*(map_size + 1) > 7*(mask + 1)) {
+        rehash();
+        i = probe(key, h, found);
+      }
+      set_ctrl(i, tag(h));
+      new (slots + i) entry_t(key, val);
+      map_size++;
+    }
+    return slots[i].second;
+  }
+
+  template<class K>
+  val_t* find(const K &key) {
+    bool found;
+    size_t i = probe(key, Hash()(key), found);
+    return found ? &slots[i].second : 0;
+  }
+
+  template<class K>
+  const val_t* find(const K &key) const {
+    bool found;
+    size_t i = probe(key, Hash()(key), found);
+    return found ? &slots[i].second : 0;
+  }
+
+  val_t& operator[](const key_t &key) {
+    return insert(key, val_t());
+  }
+};
+
+// The default policy of "min" queries and "assign" updates. The other policies
+// of section 3.3.2 (or any struct with the same members) may be used instead.
+template<class T> struct min_assign_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? a : b; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return d;
+  }
+
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d2;  // For "assign" updates, the more recent delta prevails.
+  }
+};
+
+// A 64-bit finalizer (from MurmurHash3), spreading all bits of the key.
+struct code_hash {
+  size_t operator()(unsigned long long k) const {
+    k = (k ^ (k >> 33))*0xff51afd7ed558ccdULL;
+    k = (k ^ (k >> 33))*0xc4ceb9fe1a85ec53ULL;
+    return (size_t)(k ^ (k >> 33));
+  }
+};
+
+template<class T, class Policy = min_assign_policy<T> >
+class linear_quadtree {
+  typedef typename Policy::delta_t delta_t;
+  typedef unsigned long long code_t;
+  typedef char commutative_policy_required[Policy::commutative ? 1 : -1];
+
+  static const int LEVELS = 30;
+
+  struct node_t {
+    T value;
+    delta_t delta;
+    bool pending;
+  };
+
+  // The four children of a node, stored together.
+  struct group_t {
+    node_t child[4];
+  };
+
+  // The target rectangle of an operation, and the result of a query.
+  struct target_t {
+    int r1, c1, r2, c2;
+    T res;
+    bool found;
+
+    void join(const T &v) {
+      res = found ? Policy::join_values(res, v) : v;
+      found = true;
+    }
+  };
+
+  node_t root;
+  std::vector<group_t> groups;
+  flat_hashmap<code_t, int, code_hash> index;  // Node code to child group.
+  T init;
+
+  // Spreads the bits of x to the even positions of the result.
+  static code_t spread(code_t x) {
+    x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ffULL;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & 0x5555555555555555ULL;
+    return x;
+  }
+
+  static code_t cell_code(int r, int c) {
+    return (1ULL << (2*LEVELS)) | (spread(r) << 1) | spread(c);
+  }
+
+  // The area of a node with the given number of levels below it.
+  static long long area(int below) {
+    return 1LL << (2*below);
+  }
+
+  static void apply(node_t &n, int below, const delta_t &d) {
+    n.value = Policy::join_value_with_delta(n.value, d, area(below));
+    if (below > 0) {
+      n.delta = n.pending ? Policy::join_deltas(n.delta, d) : d;
+      n.pending = true;
+    }
+  }
+
+  // Returns node q of group g, or the root if g is -1. References to nodes
+  // are not kept across calls which may add groups.
+  node_t& node(int g, int q) {
+    return (g < 0) ? root : groups[g].child[q];
+  }
+
+  const node_t& node(int g, int q) const {
+    return (g < 0) ? root : groups[g].child[q];
+  }
+
+  node_t make_node(const T &v) const {
+    node_t n;
+    n.value = v;
+    n.pending = false;
+    return n;
+  }
+
+  // Returns the group of the children of node k, creating it if absent.
+  int children(code_t k, int below) {
+    int &g = index.insert(k, -1);
+    if (g < 0) {
+      g = (int)groups.size();
+      group_t c;
+      for (int q = 0; q < 4; q++) {
+        c.child[q] = make_node(Policy::join_repeated(init, area(below - 1)));
+      }
+      groups.push_back(c);
+    }
+    return g;
+  }
+
+  // Fetches the slots of the child groups of the children of node k.
+  void prefetch_children(code_t k) const {
+    for (int q = 0; q < 4; q++) {
+      index.prefetch(4*k + q);
+    }
+  }
+
+  void update(int g, int q, code_t k, int below, int r, int c,
+              const target_t &t, const delta_t &d) {
+    int r2 = r + (1 << below) - 1, c2 = c + (1 << below) - 1;
+    if (t.r2 < r || t.r1 > r2 || t.c2 < c || t.c1 > c2) {
+      return;
+    }
+    if (t.r1 <= r && r2 <= t.r2 && t.c1 <= c && c2 <= t.c2) {
+      apply(node(g, q), below, d);
+      return;
+    }
+    int cg = children(k, below);
+    prefetch_children(k);
+    node_t &n = node(g, q);
+    if (n.pending) {
+      for (int i = 0; i < 4; i++) {
+        apply(groups[cg].child[i], below - 1, n.delta);
+      }
+      n.pending = false;
+    }
+    int half = 1 << (below - 1);
+    for (int i = 0; i < 4; i++) {
+      update(cg, i, 4*k + i, below - 1, r + (i >> 1)*half, c + (i & 1)*half, t,
+             d);
+    }
+    const node_t *ch = groups[cg].child;
+    node(g, q).value = Policy::join_values(
+        Policy::join_values(ch[0].value, ch[1].value),
+        Policy::join_values(ch[2].value, ch[3].value));
+  }
+
+  // Joins the part of node q of group g (with code k) within the target into
+  // t.res, given the deltas of its ancestors which it has not yet received (if
+  // pending is set).
+  void query(int g, int q, code_t k, int below, int r, int c, target_t &t,
+             bool pending, const delta_t &d) const {
+    int r2 = r + (1 << below) - 1, c2 = c + (1 << below) - 1;
+    if (t.r2 < r || t.r1 > r2 || t.c2 < c || t.c1 > c2) {
+      return;
+    }
+    const node_t &n = node(g, q);
+    if (t.r1 <= r && r2 <= t.r2 && t.c1 <= c && c2 <= t.c2) {
+      t.join(pending ? Policy::join_value_with_delta(n.value, d, area(below))
+                     : n.value);
+      return;
+    }
+    delta_t child_d = d;
+    if (n.pending) {
+      child_d = pending ? Policy::join_deltas(n.delta, d) : n.delta;
+      pending = true;
+    }
+    const int *cg = index.find(k);
+    if (cg == 0) {
+      // The children are absent, so the part within the target is uniform.
+      int rlen = std::min(r2, t.r2) - std::max(r, t.r1) + 1;
+      int clen = std::min(c2, t.c2) - std::max(c, t.c1) + 1;
+      long long len = (long long)rlen*clen;
+      T v = Policy::join_repeated(init, len);
+      t.join(pending ? Policy::join_value_with_delta(v, child_d, len) : v);
+      return;
+    }
+    prefetch_children(k);
+    int half = 1 << (below - 1);
+    for (int i = 0; i < 4; i++) {
+      query(*cg, i, 4*k + i, below - 1, r + (i >> 1)*half, c + (i & 1)*half, t,
+            pending, child_d);
+    }
+  }
+
+ public:
+  linear_quadtree(const T &v = T()) : init(v) {
+    clear();
+  }
+
+  template<class It> linear_quadtree(It lo, It hi, const T &v = T()) : init(v) {
+    clear();
+    std::vector<std::pair<code_t, T> > level;
+    for (; lo != hi; ++lo) {
+      level.push_back(std::make_pair(cell_code(lo->first.first,
+                                               lo->first.second), lo->second));
+    }
+    std::sort(level.begin(), level.end());
+    groups.reserve(level.size()*LEVELS);
+    index.reserve(level.size()*LEVELS);
+    // Each pass creates the groups of one level from the nodes below them.
+    for (int below = 0; below < LEVELS && !level.empty(); below++) {
+      int m = 0;
+      for (int i = 0, j; i < (int)level.size(); i = j) {
+        code_t parent = level[i].first >> 2;
+        group_t &c = groups[children(parent, below + 1)];
+        for (j = i; j < (int)level.size() && (level[j].first >> 2) == parent;
+             j++) {
+          c.child[level[j].first & 3].value = level[j].second;
+        }
+        T v = Policy::join_values(
+            Policy::join_values(c.child[0].value, c.child[1].value),
+            Policy::join_values(c.child[2].value, c.child[3].value));
+        level[m++] = std::make_pair(parent, v);
+      }
+      level.resize(m);
+    }
+    if (!level.empty()) {
+      root.value = level[0].second;
+    }
+  }
+
+  void clear() {
+    root = make_node(Policy::join_repeated(init, area(LEVELS)));
+    groups.clear();
+    index.clear();
+  }
+
+  int nodes() const {
+    return 1 + 4*(int)groups.size();
+  }
+
+  T at(int r, int c) const {
+    return query(r, c, r, c);
+  }
+
+  T query(int r1, int c1, int r2, int c2) const {
+    target_t t = {r1, c1, r2, c2, init, false};
+    query(-1, 0, 1, LEVELS, 0, 0, t, false, delta_t());
+    return t.res;
+  }
+
+  void update(int r, int c, const delta_t &d) {
+    update(r, c, r, c, d);
+  }
+
+  void update(int r1, int c1, int r2, int c2, const delta_t &d) {
+    target_t t = {r1, c1, r2, c2, init, false};
+    update(-1, 0, 1, LEVELS, 0, 0, t, d);
+  }
+};
+
+/*** Example Usage and Output:
+
+Values:
+7 6 9
+0 4 9
+9 9 9
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+using namespace std;
+
+struct sum_add_policy {
+  typedef long long delta_t;
+  static const bool commutative = true;
+  static long long identity() { return 0; }
+
+  static long long join_repeated(long long v, long long n) {
+    return v*n;
+  }
+
+  static long long join_values(long long a, long long b) {
+    return a + b;
+  }
+
+  static long long join_value_with_delta(long long v, long long d,
+                                         long long len) {
+    return v + d*len;
+  }
+
+  static long long join_deltas(long long d1, long long d2) {
+    return d1 + d2;
+  }
+};
+
+int main() {
+  {
+    linear_quadtree<int> t(0);
+    t.update(0, 0, 7);
+    t.update(0, 1, 6);
+    t.update(1, 1, 4);
+    t.update(2, 1, 1);
+    t.update(2, 2, 4);
+    t.update(0, 2, 3, 2, 9);
+    t.update(2, 0, 2, 2, 9);
+    cout << "Values:" << endl;
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        cout << t.at(i, j) << " ";
+      }
+      cout << endl;
+    }
+    assert(t.query(0, 0, 0, 1) == 6);
+    assert(t.query(0, 0, 1, 0) == 0);
+    assert(t.query(1, 1, 2, 2) == 4);
+    assert(t.query(0, 0, 1000000000, 1000000000) == 0);
+    t.update(0, 500000000, 0, 500000000, -100);
+    assert(t.query(0, 0, 1000000000, 1000000000) == -100);
+    t.clear();
+    assert(t.at(0, 0) == 0 && t.query(0, 0, 1000000000, 1000000000) == 0);
+  }
+  {
+    // Bulk load a few cells, then check range increments of sums against a
+    // plain matrix.
+    const int n = 20;
+    long long a[n][n] = {{0}};
+    vector<pair<pair<int, int>, long long> > cells;
+    for (int i = 0; i < n; i += 3) {
+      for (int j = 0; j < n; j += 2) {
+        cells.push_back(make_pair(make_pair(i, j), (long long)(i*n + j)));
+        a[i][j] = i*n + j;
+      }
+    }
+    linear_quadtree<long long, sum_add_policy> t(cells.begin(), cells.end());
+    for (int k = 0; k < 2000; k++) {
+      int r1 = rand() % n, c1 = rand() % n;
+      int r2 = r1 + rand() % (n - r1), c2 = c1 + rand() % (n - c1);
+      if (rand() % 2 == 0) {
+        int d = rand() % 100 - 50;
+        t.update(r1, c1, r2, c2, d);
+        for (int i = r1; i <= r2; i++) {
+          for (int j = c1; j <= c2; j++) {
+            a[i][j] += d;
+          }
+        }
+      } else {
+        long long s = 0;
+        for (int i = r1; i <= r2; i++) {
+          for (int j = c1; j <= c2; j++) {
+            s += a[i][j];
+          }
+        }
+        assert(t.query(r1, c1, r2, c2) == s);
+      }
+    }
+    assert(t.query(0, 0, 1 << 29, 1 << 29) == t.query(0, 0, n - 1, n - 1));
+  }
+  return 0;
+}
@@ -19,11 +19,23 @@ right child has a greater key.
   the key was not found.
 - walk(f) calls the function f(k, v) on each entry of the map, in ascending
   order of keys.
+- clear() removes all entries from the map.
+
+Nodes are allocated by the template argument Pool, which defaults to node_pool.
+A node_pool carves nodes out of large slabs, reusing the nodes of erased
+entries, so that insertions avoid the overhead of a call to the general purpose
+heap allocator and nodes lie close together in memory. Destroying the map (or
+calling clear()) sweeps the slabs once to run the destructors of the live nodes
+and frees the slabs, without a recursive traversal of the tree. Any other Pool
+must provide allocate(), destroy(p), and clear() with the same meanings.
 
 Time Complexity:
 - O(1) per call to the constructor, size(), and empty().
 - O(n) per call to insert(), erase(), find(), and walk(), where n is the number
   of nodes currently in the map.
+- O(n) per call to clear() and the destructor, or O(s) if K and V have trivial
+  destructors, where s is the number of slabs (logarithmic in the largest
+  number of nodes the map has held).
 
 Space Complexity:
 - O(n) for storage of the map elements.
@@ -33,8 +45,85 @@ Space Complexity:
 */
 
 #include <cstdlib>  // NULL
+#include <new>  // placement new
+#include <utility>  // std::pair
+#include <vector>
+
+// Allocates objects of type T in slabs of doubling size, recycling destroyed
+// objects through a free list. Each slot holds a pointer to itself while its
+// object is live, so that clear() destroys all live objects in one pass over
+// the slabs (or none if T has a trivial destructor) and frees every slab at
+// once, without walking any data structure.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  std::vector<std::pair<slot*, size_t> > slabs;
+  slot *free_list;
+  size_t used;  // The number of slots handed out from the last slab.
+
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
+
+ public:
+  node_pool() : free_list(NULL), used(0) {}
+
+  ~node_pool() {
+    clear();
+  }
 
-template<class K, class V> class binary_search_tree {
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != NULL) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || used == slabs.back().second) {
+        size_t n = slabs.empty() ? 64 : 2*slabs.back().second;
+        slabs.push_back(std::make_pair(new slot[n], n));
+        used = 0;
+      }
+      s = slabs.back().first + used++;
+    }
+    s->next = s;
+    return s->u.data;
+  }
+
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    s->next = free_list;
+    free_list = s;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        size_t n = (i + 1 == slabs.size()) ? used : slabs[i].second;
+        for (size_t j = 0; j < n; j++) {
+          slot *s = slabs[i].first + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].first;
+    }
+    slabs.clear();
+    free_list = NULL;
+    used = 0;
+  }
+};
+
+template<class K, class V, template<class> class Pool = node_pool>
+class binary_search_tree {
   struct node_t {
     K key;
     V value;
@@ -48,10 +137,11 @@ template<class K, class V> class binary_search_tree {
   } *root;
 
   int num_nodes;
+  Pool<node_t> pool;
 
-  static bool insert(node_t *&n, const K &k, const V &v) {
+  bool insert(node_t *&n, const K &k, const V &v) {
     if (n == NULL) {
-      n = new node_t(k, v);
+      n = new (pool.allocate()) node_t(k, v);
       return true;
     }
     if (k < n->key) {
@@ -62,7 +152,7 @@ template<class K, class V> class binary_search_tree {
     return false;
   }
 
-  static bool erase(node_t *&n, const K &k) {
+  bool erase(node_t *&n, const K &k) {
     if (n == NULL) {
       return false;
     }
@@ -85,7 +175,7 @@ template<class K, class V> class binary_search_tree {
       return erase(n->right, n->right->key);
     }
     node_t *tmp = (n->left != NULL) ? n->left : n->right;
-    delete n;
+    pool.destroy(n);
     n = tmp;
     return true;
   }
@@ -99,24 +189,12 @@ template<class K, class V> class binary_search_tree {
     }
   }
 
-  static void clean_up(node_t *n) {
-    if (n != NULL) {
-      clean_up(n->left);
-      clean_up(n->right);
-      delete n;
-    }
-  }
-
  public:
   binary_search_tree() {
     root = NULL;
     num_nodes = 0;
   }
 
-  ~binary_search_tree() {
-    clean_up(root);
-  }
-
   int size() const {
     return num_nodes;
   }
@@ -125,6 +203,12 @@ template<class K, class V> class binary_search_tree {
     return root == NULL;
   }
 
+  void clear() {
+    pool.clear();
+    root = NULL;
+    num_nodes = 0;
+  }
+
   bool insert(const K &k, const V &v) {
     if (insert(root, k, v)) {
       num_nodes++;
@@ -191,5 +275,7 @@ int main() {
   assert(t.find(1) == NULL);
   t.walk(printch);
   cout << endl;
+  t.clear();
+  assert(t.empty() && t.insert(1, 'a') && t.size() == 1);
   return 0;
 }
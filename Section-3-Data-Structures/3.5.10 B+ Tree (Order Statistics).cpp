@@ -0,0 +1,597 @@
+/*
+
+Maintain a map, that is, a collection of key-value pairs such that each possible
+key appears at most once in the collection. This implementation requires an
+ordering on the set of possible keys defined by the < operator on the key type.
+This is the B+ tree of section 3.5.8, a search tree whose nodes each hold up to
+B keys in a sorted array, where B (here 32) is chosen so that a node spans a few
+cache lines. Entries are stored only in the leaves, which are linked in order of
+keys, while each inner node holds up to B separating keys and B + 1 children,
+the i-th child holding the keys from separator i - 1 (inclusive) to separator i
+(exclusive). The tree is thus only about log(n)/log(B) levels deep, with one or
+two cache misses per level rather than one per comparison as in a binary tree.
+
+This B+ tree is an order statistic tree as in section 3.5.3: each inner node
+also stores the number of entries under each of its children, so that the i-th
+smallest entry is found by subtracting the counts of a node's children in turn
+until reaching the child holding it, and the rank of a key by adding up the
+counts of the children before the one holding it. Both take one pass over one
+node per level, rather than one pointer per comparison as in a binary tree. To
+rank entries which may tie, such as the scores of a leaderboard, use keys which
+break the ties, such as pairs of a score and a player id.
+
+A node is searched by counting the keys less than the one sought, which takes a
+fixed sequence of comparisons without unpredictable branches. For int keys this
+is done four keys at a time with SSE2 instructions where available.
+
+- order_statistic_tree() constructs an empty map.
+- order_statistic_tree(lo, hi) constructs a map from a range of std::pair
+  entries which are sorted by strictly increasing keys. The tree is built
+  bottom-up with every node full, in a single pass over the range.
+- size() returns the size of the map.
+- empty() returns whether the map is empty.
+- insert(k, v) adds an entry with key k and value v to the map, returning true
+  if an new entry was added or false if the key already exists (in which case
+  the map is unchanged and the old value associated with the key is preserved).
+  A full node is split into two halves before the entry is added.
+- erase(k) removes the entry with key k from the map, returning true if the
+  removal was successful or false if the key to be removed was not found. Nodes
+  are not merged until they become empty, so that erasures never move entries
+  between nodes. A map shrunk by many erasures may be rebuilt with bulk loading.
+- find(k) returns a pointer to a const value associated with key k, or NULL if
+  the key was not found.
+- walk(f) calls the function f(k, v) on each entry of the map, in ascending
+  order of keys.
+- walk(lo, hi, f) calls f(k, v) on each entry with lo <= k <= hi in ascending
+  order of keys, following the links between leaves after finding the first.
+- select(i) returns the entry with the i-th smallest key (counting from 0) as a
+  std::pair, throwing an exception if i is not less than size().
+- rank(k) returns the number of keys less than k, throwing an exception if k is
+  not in the map.
+
+Time Complexity:
+- O(1) per call to the first constructor, size(), and empty().
+- O(n) per call to the second constructor, where n is the number of entries.
+- O(B log n/log B) per call to insert(), erase(), find(), select(), and
+  rank(), where n is the number of entries currently in the map, with
+  O(log n/log B) cache misses.
+- O(n) per call to walk(f), and O(B log n/log B + m) per call to walk(lo, hi, f)
+  where m is the number of entries reported.
+
+Space Complexity:
+- O(n) for storage of the map elements, two thirds of which are occupied on
+  average after random insertions, or all after bulk loading.
+- O(log n/log B) auxiliary stack space per call to insert() and erase(), and
+  O(1) auxiliary per call to all other operations.
+
+*/
+
+#include <cstdlib>  // NULL
+#include <stdexcept>  // std::runtime_error
+#include <utility>  // std::make_pair(), std::pair
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>  // _mm_cmpgt_epi32(), _mm_movemask_epi8(), ...
+#endif
+
+template<class K, class V> class order_statistic_tree {
+  static const int B = 32;
+
+  struct node_t {
+    int count;
+    bool leaf;
+    K keys[B];
+  };
+
+  struct leaf_t : node_t {
+    V values[B];
+    leaf_t *prev, *next;
+  };
+
+  struct inner_t : node_t {
+    node_t *child[B + 1];
+    int sizes[B + 1];  // The number of entries under each child.
+  };
+
+  node_t *root;
+  leaf_t *head;
+  int num_entries;
+
+  // Returns the number of keys in a[0..n) which are less than k.
+  template<class T>
+  static int count_less(const T *a, int n, const T &k) {
+    int res = 0;
+    for (int i = 0; i < n; i++) {
+      res += (a[i] < k);
+    }
+    return res;
+  }
+
+  // Returns the number of keys in a[0..n) which are not greater than k.
+  template<class T>
+  static int count_not_greater(const T *a, int n, const T &k) {
+    int res = 0;
+    for (int i = 0; i < n; i++) {
+      res += !(k < a[i]);
+    }
+    return res;
+  }
+
+#ifdef __SSE2__
+  // Each comparison sets all 4 bytes of a 32-bit lane, so the number of bits
+  // set in the byte mask is 4 times the number of keys satisfying it.
+  static int count_less(const int *a, int n, int k) {
+    __m128i key = _mm_set1_epi32(k);
+    int i = 0, bits = 0;
+    for (; i + 4 <= n; i += 4) {
+      __m128i g = _mm_loadu_si128((const __m128i*)(a + i));
+      bits += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi32(key, g)));
+    }
+    int res = bits/4;
+    for (; i < n; i++) {
+      res += (a[i] < k);
+    }
+    return res;
+  }
+
+  static int count_not_greater(const int *a, int n, int k) {
+    __m128i key = _mm_set1_epi32(k);
+    int i = 0, bits = 0;
+    for (; i + 4 <= n; i += 4) {
+      __m128i g = _mm_loadu_si128((const __m128i*)(a + i));
+      bits += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi32(g, key)));
+    }
+    int res = i - bits/4;
+    for (; i < n; i++) {
+      res += !(k < a[i]);
+    }
+    return res;
+  }
+#endif
+
+  static leaf_t* new_leaf() {
+    leaf_t *n = new leaf_t;
+    n->count = 0;
+    n->leaf = true;
+    n->prev = n->next = NULL;
+    return n;
+  }
+
+  // Returns the number of entries under n.
+  static int total(const node_t *n) {
+    if (n->leaf) {
+      return n->count;
+    }
+    const inner_t *in = static_cast<const inner_t*>(n);
+    int res = 0;
+    for (int i = 0; i <= in->count; i++) {
+      res += in->sizes[i];
+    }
+    return res;
+  }
+
+  static inner_t* new_inner() {
+    inner_t *n = new inner_t;
+    n->count = 0;
+    n->leaf = false;
+    return n;
+  }
+
+  // Returns the leaf which would hold key k.
+  leaf_t* find_leaf(const K &k) const {
+    node_t *n = root;
+    while (!n->leaf) {
+      inner_t *in = static_cast<inner_t*>(n);
+      n = in->child[count_not_greater(in->keys, in->count, k)];
+    }
+    return static_cast<leaf_t*>(n);
+  }
+
+  // Moves the upper half of a full leaf into a new leaf after it.
+  leaf_t* split(leaf_t *n) {
+    leaf_t *r = new_leaf();
+    r->count = B - B/2;
+    for (int i = 0; i < r->count; i++) {
+      r->keys[i] = n->keys[B/2 + i];
+      r->values[i] = n->values[B/2 + i];
+    }
+    n->count = B/2;
+    r->prev = n;
+    r->next = n->next;
+    if (n->next != NULL) {
+      n->next->prev = r;
+    }
+    n->next = r;
+    return r;
+  }
+
+  static void insert_at(leaf_t *n, int i, const K &k, const V &v) {
+    for (int j = n->count; j > i; j--) {
+      n->keys[j] = n->keys[j - 1];
+      n->values[j] = n->values[j - 1];
+    }
+    n->keys[i] = k;
+    n->values[i] = v;
+    n->count++;
+  }
+
+  static void insert_at(inner_t *n, int i, const K &sep, node_t *c) {
+    for (int j = n->count; j > i; j--) {
+      n->keys[j] = n->keys[j - 1];
+      n->child[j + 1] = n->child[j];
+      n->sizes[j + 1] = n->sizes[j];
+    }
+    n->keys[i] = sep;
+    n->child[i + 1] = c;
+    n->sizes[i + 1] = total(c);
+    n->count++;
+  }
+
+  // Inserts the entry into the subtree of n. If n is split, sets r to the new
+  // node holding its upper part and sep to the least key under r.
+  bool insert(node_t *n, const K &k, const V &v, K &sep, node_t *&r) {
+    r = NULL;
+    if (n->leaf) {
+      leaf_t *l = static_cast<leaf_t*>(n);
+      int i = count_less(l->keys, l->count, k);
+      if (i < l->count && !(k < l->keys[i])) {
+        return false;
+      }
+      if (l->count == B) {
+        leaf_t *s = split(l);
+        if (i > B/2) {
+          insert_at(s, i - B/2, k, v);
+        } else {
+          insert_at(l, i, k, v);
+        }
+        sep = s->keys[0];
+        r = s;
+      } else {
+        insert_at(l, i, k, v);
+      }
+      return true;
+    }
+    inner_t *in = static_cast<inner_t*>(n);
+    int i = count_not_greater(in->keys, in->count, k);
+    K child_sep;
+    node_t *child_r;
+    if (!insert(in->child[i], k, v, child_sep, child_r)) {
+      return false;
+    }
+    if (child_r == NULL) {
+      in->sizes[i]++;
+      return true;
+    }
+    in->sizes[i] = total(in->child[i]);
+    if (in->count < B) {
+      insert_at(in, i, child_sep, child_r);
+      return true;
+    }
+    // Split around the middle key, which moves up to the parent.
+    const int h = B/2;
+    inner_t *s = new_inner();
+    s->count = B - h - 1;
+    for (int j = 0; j < s->count; j++) {
+      s->keys[j] = in->keys[h + 1 + j];
+      s->child[j] = in->child[h + 1 + j];
+      s->sizes[j] = in->sizes[h + 1 + j];
+    }
+    s->child[s->count] = in->child[B];
+    s->sizes[s->count] = in->sizes[B];
+    sep = in->keys[h];
+    in->count = h;
+    if (i <= h) {
+      insert_at(in, i, child_sep, child_r);
+    } else {
+      insert_at(s, i - h - 1, child_sep, child_r);
+    }
+    r = s;
+    return true;
+  }
+
+  // Returns 0 if k is not under n, 1 if it was erased, or 2 if it was erased
+  // and n became empty, in which case n has been freed.
+  int erase(node_t *n, const K &k) {
+    if (n->leaf) {
+      leaf_t *l = static_cast<leaf_t*>(n);
+      int i = count_less(l->keys, l->count, k);
+      if (i == l->count || k < l->keys[i]) {
+        return 0;
+      }
+      for (int j = i + 1; j < l->count; j++) {
+        l->keys[j - 1] = l->keys[j];
+        l->values[j - 1] = l->values[j];
+      }
+      if (--l->count > 0) {
+        return 1;
+      }
+      if (l->prev != NULL) {
+        l->prev->next = l->next;
+      } else {
+        head = l->next;
+      }
+      if (l->next != NULL) {
+        l->next->prev = l->prev;
+      }
+      delete l;
+      return 2;
+    }
+    inner_t *in = static_cast<inner_t*>(n);
+    int i = count_not_greater(in->keys, in->count, k);
+    int res = erase(in->child[i], k);
+    if (res != 2) {
+      in->sizes[i] -= res;
+      return res;
+    }
+    if (in->count == 0) {
+      delete in;
+      return 2;
+    }
+    // Remove the child along with the separator on one of its sides.
+    int s = (i > 0) ? i - 1 : 0;
+    for (int j = s + 1; j < in->count; j++) {
+      in->keys[j - 1] = in->keys[j];
+    }
+    for (int j = i + 1; j <= in->count; j++) {
+      in->child[j - 1] = in->child[j];
+      in->sizes[j - 1] = in->sizes[j];
+    }
+    in->count--;
+    return 1;
+  }
+
+  static void clean_up(node_t *n) {
+    if (n->leaf) {
+      delete static_cast<leaf_t*>(n);
+      return;
+    }
+    inner_t *in = static_cast<inner_t*>(n);
+    for (int i = 0; i <= in->count; i++) {
+      clean_up(in->child[i]);
+    }
+    delete in;
+  }
+
+  order_statistic_tree(const order_statistic_tree &);
+  order_statistic_tree& operator=(const order_statistic_tree &);
+
+ public:
+  order_statistic_tree() {
+    root = head = new_leaf();
+    num_entries = 0;
+  }
+
+  template<class It> order_statistic_tree(It lo, It hi) {
+    root = head = new_leaf();
+    num_entries = 0;
+    std::vector<node_t*> level;
+    std::vector<K> mins;
+    for (leaf_t *l = head; lo != hi; ++lo) {
+      if (l->count == B) {
+        leaf_t *next = new_leaf();
+        next->prev = l;
+        l = l->next = next;
+      }
+      if (l->count == 0) {
+        level.push_back(l);
+        mins.push_back(lo->first);
+      }
+      l->keys[l->count] = lo->first;
+      l->values[l->count++] = lo->second;
+      num_entries++;
+    }
+    // Group each level into parents of B + 1 children until one node remains.
+    while (level.size() > 1) {
+      std::vector<node_t*> parents;
+      std::vector<K> parent_mins;
+      for (size_t i = 0; i < level.size(); i += B + 1) {
+        inner_t *p = new_inner();
+        p->child[0] = level[i];
+        p->sizes[0] = total(level[i]);
+        for (size_t j = i + 1; j < level.size() && j < i + B + 1; j++) {
+          p->keys[p->count] = mins[j];
+          p->child[++p->count] = level[j];
+          p->sizes[p->count] = total(level[j]);
+        }
+        parents.push_back(p);
+        parent_mins.push_back(mins[i]);
+      }
+      // Avoid an inner node with a single child by borrowing from the left.
+      inner_t *last = static_cast<inner_t*>(parents.back());
+      if (parents.size() > 1 && last->count == 0) {
+        inner_t *prev = static_cast<inner_t*>(parents[parents.size() - 2]);
+        last->child[1] = last->child[0];
+        last->sizes[1] = last->sizes[0];
+        last->keys[0] = parent_mins.back();
+        last->child[0] = prev->child[prev->count];
+        last->sizes[0] = prev->sizes[prev->count];
+        parent_mins.back() = mins[level.size() - 2];
+        last->count = 1;
+        prev->count--;
+      }
+      level.swap(parents);
+      mins.swap(parent_mins);
+    }
+    if (!level.empty()) {
+      root = level[0];
+    }
+  }
+
+  ~order_statistic_tree() {
+    clean_up(root);
+  }
+
+  int size() const {
+    return num_entries;
+  }
+
+  bool empty() const {
+    return num_entries == 0;
+  }
+
+  bool insert(const K &k, const V &v) {
+    K sep;
+    node_t *r;
+    if (!insert(root, k, v, sep, r)) {
+      return false;
+    }
+    if (r != NULL) {
+      inner_t *p = new_inner();
+      p->count = 1;
+      p->keys[0] = sep;
+      p->child[0] = root;
+      p->child[1] = r;
+      p->sizes[0] = total(root);
+      p->sizes[1] = total(r);
+      root = p;
+    }
+    num_entries++;
+    return true;
+  }
+
+  bool erase(const K &k) {
+    int res = erase(root, k);
+    if (res == 0) {
+      return false;
+    }
+    num_entries--;
+    if (res == 2) {
+      root = head = new_leaf();
+    }
+    while (!root->leaf && root->count == 0) {
+      inner_t *in = static_cast<inner_t*>(root);
+      root = in->child[0];
+      delete in;
+    }
+    return true;
+  }
+
+  const V* find(const K &k) const {
+    leaf_t *l = find_leaf(k);
+    int i = count_less(l->keys, l->count, k);
+    if (i < l->count && !(k < l->keys[i])) {
+      return &(l->values[i]);
+    }
+    return NULL;
+  }
+
+  template<class KVFunction> void walk(KVFunction f) const {
+    for (leaf_t *l = head; l != NULL; l = l->next) {
+      for (int i = 0; i < l->count; i++) {
+        f(l->keys[i], l->values[i]);
+      }
+    }
+  }
+
+  template<class KVFunction>
+  void walk(const K &lo, const K &hi, KVFunction f) const {
+    leaf_t *l = find_leaf(lo);
+    for (int i = count_less(l->keys, l->count, lo); l != NULL; l = l->next) {
+      for (; i < l->count; i++) {
+        if (hi < l->keys[i]) {
+          return;
+        }
+        f(l->keys[i], l->values[i]);
+      }
+      i = 0;
+    }
+  }
+
+  std::pair<K, V> select(int i) const {
+    if (i < 0 || i >= num_entries) {
+      throw std::runtime_error("i must be smaller than the size of the tree.");
+    }
+    const node_t *n = root;
+    while (!n->leaf) {
+      const inner_t *in = static_cast<const inner_t*>(n);
+      int j = 0;
+      for (; i >= in->sizes[j]; j++) {
+        i -= in->sizes[j];
+      }
+      n = in->child[j];
+    }
+    const leaf_t *l = static_cast<const leaf_t*>(n);
+    return std::make_pair(l->keys[i], l->values[i]);
+  }
+
+  int rank(const K &k) const {
+    const node_t *n = root;
+    int res = 0;
+    while (!n->leaf) {
+      const inner_t *in = static_cast<const inner_t*>(n);
+      int i = count_not_greater(in->keys, in->count, k);
+      for (int j = 0; j < i; j++) {
+        res += in->sizes[j];
+      }
+      n = in->child[i];
+    }
+    const leaf_t *l = static_cast<const leaf_t*>(n);
+    int i = count_less(l->keys, l->count, k);
+    if (i == l->count || k < l->keys[i]) {
+      throw std::runtime_error("Cannot rank key not in tree.");
+    }
+    return res + i;
+  }
+};
+
+/*** Example Usage and Output:
+
+Rank of 4: 3
+Value of 3rd smallest key: c
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+#include <set>
+using namespace std;
+
+int main() {
+  {
+    order_statistic_tree<int, char> t;
+    t.insert(2, 'b');
+    t.insert(1, 'a');
+    t.insert(3, 'c');
+    t.insert(5, 'e');
+    t.insert(4, 'd');
+    cout << "Rank of 4: " << t.rank(4) << endl;
+    cout << "Value of 3rd smallest key: " << t.select(2).second << endl;
+    t.erase(3);
+    assert(t.rank(5) == 3 && t.select(2).first == 4);
+    bool thrown = false;
+    try {
+      t.rank(3);
+    } catch (runtime_error &) {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+  {
+    // Bulk load a leaderboard of (score, player) keys, then update it randomly
+    // and compare ranks and selections against a sorted std::set.
+    vector<pair<pair<int, int>, int> > entries;
+    set<pair<int, int> > s;
+    for (int i = 0; i < 100000; i++) {
+      s.insert(make_pair(rand() % 1000, i));
+    }
+    for (set<pair<int, int> >::iterator it = s.begin(); it != s.end(); ++it) {
+      entries.push_back(make_pair(*it, it->second));
+    }
+    order_statistic_tree<pair<int, int>, int> t(entries.begin(), entries.end());
+    for (int i = 0; i < 200000; i++) {
+      pair<int, int> k(rand() % 1000, rand() % 150000);
+      if (rand() % 2 == 0) {
+        assert(t.insert(k, k.second) == s.insert(k).second);
+      } else {
+        assert(t.erase(k) == (s.erase(k) == 1));
+      }
+    }
+    assert(t.size() == (int)s.size());
+    vector<pair<int, int> > sorted(s.begin(), s.end());
+    for (int i = 0; i < (int)sorted.size(); i += 7) {
+      assert(t.select(i).first == sorted[i] && t.rank(sorted[i]) == i);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,429 @@
+/*
+
+Maintain a sorted map, that is, a collection of key-value pairs ordered by key
+with each key appearing at most once, which may be read and written by many
+threads at once without locks. This implementation requires an ordering on the
+set of possible keys defined by the < operator on the key type. As in section
+3.5.5, the entries form a linked list at level 0 ordered by keys, and each node
+appears in the lists of levels 1, 2, ... with probability 1/2 each, so that a
+search skips along the sparse upper levels before descending.
+
+- The lists are updated by compare-and-swap (CAS) on the next pointers, as in
+  the lock-free skip list of Fraser and Herlihy-Shavit. A node is inserted by a
+  CAS into the level 0 list, which makes it present, and then linked into the
+  upper levels one level at a time.
+- A node is erased by setting the lowest bit (the mark) of each of its next
+  pointers from the top down. Whoever marks the level 0 pointer has erased the
+  entry. A marked pointer can no longer be changed by a CAS, so nothing can be
+  linked after an erased node, and every search unlinks marked nodes which it
+  passes with a CAS on the pointer to them, retrying from the top if this fails.
+- Erased nodes are freed by epoch-based reclamation. Each operation runs inside
+  a critical section, which announces the global epoch seen on entry. A node is
+  retired once it is unlinked from every level, and is tagged with the global
+  epoch at that moment. The epoch advances when all threads inside critical
+  sections have announced it, so once it is two past the tag of a node, every
+  thread which could have reached the node has left its critical section, and
+  the node is freed. A node being erased while its insertion is still linking
+  it into upper levels is retired by whichever of the two finishes last.
+
+Every operation takes the id of the calling thread, from 0 up to the number of
+threads given to the constructor, and no two threads may use the same id at the
+same time. The atomic operations are the __atomic builtins of GCC and Clang.
+
+- concurrent_skip_list(threads) constructs an empty map for up to the given
+  number of threads.
+- size() returns the number of entries, which may be out of date under
+  concurrent writes.
+- insert(k, v, tid) adds an entry with key k and value v, returning true if it
+  was added or false if the key was already present.
+- erase(k, tid) removes the entry with key k, returning true if it was removed
+  or false if the key was not found.
+- find(k, v, tid) copies the value of key k into v and returns true if it is
+  present, or returns false.
+- walk(lo, hi, f, tid) calls f(k, v) for the entries with lo <= k <= hi in
+  ascending order of keys. The walk is weakly consistent: every entry present
+  throughout the walk is reported once, entries inserted or erased during the
+  walk may or may not be, and f must not call other methods of the map.
+
+Time Complexity:
+- O(log n) expected per call to insert(), erase(), and find() without
+  contention, where n is the number of entries. Each failed CAS restarts a
+  search, so an operation may be delayed by the operations which overlap it,
+  but some operation always completes.
+- O(log n + m) expected per call to walk(), where m is the number of entries
+  in the range.
+
+Space Complexity:
+- O(n) expected for storage of the entries, plus the retired nodes of each
+  thread until the epoch advances past them.
+- O(log n) auxiliary per call to insert() and erase(), and O(1) for find() and
+  walk().
+
+*/
+
+#include <cstddef>  // size_t
+#include <new>  // operator new(), placement new
+#include <vector>
+
+template<class key_t, class val_t> class concurrent_skip_list {
+  static const int MAX_LEVEL = 32;
+
+  struct node_t {
+    key_t key;
+    val_t val;
+    int height, done;
+    size_t next[1];  // height pointers, the lowest bit marking erasure.
+
+    node_t(const key_t &k, const val_t &v, int h)
+        : key(k), val(v), height(h), done(0) {}
+  };
+
+  // The state of each thread, padded to its own cache line.
+  struct thread_t {
+    unsigned long long state;  // Twice the epoch announced, plus 1 if active.
+    unsigned long long rng, tag[3];
+    std::vector<node_t*> limbo[3];  // Retired nodes tagged with tag[i].
+    int retired;
+    char padding[64];
+  };
+
+  node_t *head;
+  unsigned long long epoch;
+  size_t num_entries;
+  std::vector<thread_t> threads;
+
+  static node_t* ptr(size_t p) {
+    return (node_t*)(p & ~(size_t)1);
+  }
+
+  static size_t load(const size_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+  }
+
+  static bool cas(size_t *p, size_t expected, size_t desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE);
+  }
+
+  static node_t* new_node(const key_t &k, const val_t &v, int h) {
+    void *p = operator new(sizeof(node_t) + (h - 1)*sizeof(size_t));
+    return new (p) node_t(k, v, h);
+  }
+
+  static void free_node(node_t *n) {
+    n->~node_t();
+    operator delete(n);
+  }
+
+  static void free_all(std::vector<node_t*> &v) {
+    for (size_t i = 0; i < v.size(); i++) {
+      free_node(v[i]);
+    }
+    v.clear();
+  }
+
+  void enter(int tid) {
+    thread_t &t = threads[tid];
+    unsigned long long g = __atomic_load_n(&epoch, __ATOMIC_SEQ_CST);
+    for (;;) {
+      __atomic_store_n(&t.state, 2*g + 1, __ATOMIC_SEQ_CST);
+      unsigned long long now = __atomic_load_n(&epoch, __ATOMIC_SEQ_CST);
+      if (now == g) {
+        break;
+      }
+      g = now;
+    }
+    for (int i = 0; i < 3; i++) {
+      if (!t.limbo[i].empty() && t.tag[i] + 2 <= g) {
+        free_all(t.limbo[i]);
+      }
+    }
+  }
+
+  void leave(int tid) {
+    __atomic_store_n(&threads[tid].state, 0ULL, __ATOMIC_SEQ_CST);
+  }
+
+  // Advances the epoch if every active thread has announced it.
+  void try_advance() {
+    unsigned long long g = __atomic_load_n(&epoch, __ATOMIC_SEQ_CST);
+    for (size_t i = 0; i < threads.size(); i++) {
+      unsigned long long s = __atomic_load_n(&threads[i].state,
+                                             __ATOMIC_SEQ_CST);
+      if ((s & 1) && (s >> 1) != g) {
+        return;
+      }
+    }
+    __atomic_compare_exchange_n(&epoch, &g, g + 1, false, __ATOMIC_SEQ_CST,
+                                __ATOMIC_SEQ_CST);
+  }
+
+  void retire(node_t *n, int tid) {
+    thread_t &t = threads[tid];
+    unsigned long long g = __atomic_load_n(&epoch, __ATOMIC_SEQ_CST);
+    int i = (int)(g % 3);
+    if (t.tag[i] != g) {
+      free_all(t.limbo[i]);  // Tagged at most g - 3, so safe to free.
+      t.tag[i] = g;
+    }
+    t.limbo[i].push_back(n);
+    if (++t.retired % 64 == 0) {
+      try_advance();
+    }
+  }
+
+  // Called by the inserter and the eraser of a node once neither will link or
+  // unlink it again. The second caller retires it.
+  void finish(node_t *n, int tid) {
+    if (__atomic_add_fetch(&n->done, 1, __ATOMIC_ACQ_REL) == 2) {
+      retire(n, tid);
+    }
+  }
+
+  int random_height(int tid) {
+    unsigned long long &x = threads[tid].rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    unsigned long long r = x*2685821657736338717ULL;
+    return 1 + __builtin_ctzll(r | (1ULL << (MAX_LEVEL - 1)));
+  }
+
+  // Sets preds[l] and succs[l] to the last node before k and the first node
+  // not before k at each level l, unlinking marked nodes on the way. Returns
+  // whether succs[0] has key k.
+  bool search(const key_t &k, node_t **preds, node_t **succs) {
+  retry:
+    node_t *pred = head;
+    for (int l = MAX_LEVEL - 1; l >= 0; l--) {
+      node_t *curr = ptr(load(&pred->next[l]));
+      while (curr != NULL) {
+        size_t succ = load(&curr->next[l]);
+        if (succ & 1) {
+          if (!cas(&pred->next[l], (size_t)curr, succ & ~(size_t)1)) {
+            goto retry;
+          }
+          curr = ptr(succ);
+        } else if (curr->key < k) {
+          pred = curr;
+          curr = ptr(succ);
+        } else {
+          break;
+        }
+      }
+      preds[l] = pred;
+      succs[l] = curr;
+    }
+    return succs[0] != NULL && !(k < succs[0]->key);
+  }
+
+  // Returns the first node not before k at level 0, skipping but not
+  // unlinking marked nodes.
+  node_t* lower_bound(const key_t &k) const {
+    node_t *pred = head, *curr = NULL;
+    for (int l = MAX_LEVEL - 1; l >= 0; l--) {
+      curr = ptr(load(&pred->next[l]));
+      while (curr != NULL) {
+        size_t succ = load(&curr->next[l]);
+        if (!(succ & 1) && !(curr->key < k)) {
+          break;
+        }
+        if (!(succ & 1)) {
+          pred = curr;
+        }
+        curr = ptr(succ);
+      }
+    }
+    return curr;
+  }
+
+  concurrent_skip_list(const concurrent_skip_list &);
+  concurrent_skip_list& operator=(const concurrent_skip_list &);
+
+ public:
+  concurrent_skip_list(int num_threads) : epoch(0), num_entries(0) {
+    head = new_node(key_t(), val_t(), MAX_LEVEL);
+    for (int l = 0; l < MAX_LEVEL; l++) {
+      head->next[l] = 0;
+    }
+    threads.resize(num_threads);
+    for (int i = 0; i < num_threads; i++) {
+      thread_t &t = threads[i];
+      t.state = 0;
+      t.rng = 0x9e3779b97f4a7c15ULL*(i + 1);
+      t.tag[0] = t.tag[1] = t.tag[2] = 0;
+      t.retired = 0;
+    }
+  }
+
+  // Must not run concurrently with any other method.
+  ~concurrent_skip_list() {
+    for (node_t *n = ptr(head->next[0]); n != NULL; ) {
+      node_t *next = ptr(n->next[0]);
+      free_node(n);
+      n = next;
+    }
+    free_node(head);
+    for (size_t i = 0; i < threads.size(); i++) {
+      for (int j = 0; j < 3; j++) {
+        free_all(threads[i].limbo[j]);
+      }
+    }
+  }
+
+  size_t size() const {
+    return __atomic_load_n(&num_entries, __ATOMIC_RELAXED);
+  }
+
+  bool insert(const key_t &k, const val_t &v, int tid) {
+    node_t *preds[MAX_LEVEL], *succs[MAX_LEVEL], *n = NULL;
+    enter(tid);
+    for (;;) {
+      if (search(k, preds, succs)) {
+        if (n != NULL) {
+          free_node(n);  // Never published.
+        }
+        leave(tid);
+        return false;
+      }
+      if (n == NULL) {
+        n = new_node(k, v, random_height(tid));
+      }
+      for (int l = 0; l < n->height; l++) {
+        n->next[l] = (size_t)succs[l];
+      }
+      if (cas(&preds[0]->next[0], (size_t)succs[0], (size_t)n)) {
+        break;
+      }
+    }
+    __atomic_add_fetch(&num_entries, 1, __ATOMIC_RELAXED);
+    for (int l = 1; l < n->height; l++) {
+      for (;;) {
+        size_t old = load(&n->next[l]);
+        if (old & 1) {
+          goto done;  // Being erased.
+        }
+        size_t succ = (size_t)succs[l];
+        if (old != succ && !cas(&n->next[l], old, succ)) {
+          continue;
+        }
+        if (cas(&preds[l]->next[l], succ, (size_t)n)) {
+          // If marked meanwhile, the eraser may have missed this level.
+          if (load(&n->next[l]) & 1) {
+            search(k, preds, succs);
+            goto done;
+          }
+          break;
+        }
+        search(k, preds, succs);
+        if (succs[0] != n) {
+          goto done;  // Erased and unlinked from level 0.
+        }
+      }
+    }
+  done:
+    finish(n, tid);
+    leave(tid);
+    return true;
+  }
+
+  bool erase(const key_t &k, int tid) {
+    node_t *preds[MAX_LEVEL], *succs[MAX_LEVEL];
+    bool res = false;
+    enter(tid);
+    if (search(k, preds, succs)) {
+      node_t *n = succs[0];
+      for (int l = n->height - 1; l >= 1; l--) {
+        size_t s = load(&n->next[l]);
+        while (!(s & 1) && !cas(&n->next[l], s, s | 1)) {
+          s = load(&n->next[l]);
+        }
+      }
+      for (size_t s = load(&n->next[0]); !(s & 1); s = load(&n->next[0])) {
+        if (cas(&n->next[0], s, s | 1)) {
+          res = true;
+          break;
+        }
+      }
+      if (res) {
+        __atomic_sub_fetch(&num_entries, 1, __ATOMIC_RELAXED);
+        search(k, preds, succs);
+        finish(n, tid);
+      }
+    }
+    leave(tid);
+    return res;
+  }
+
+  bool find(const key_t &k, val_t &v, int tid) {
+    enter(tid);
+    node_t *n = lower_bound(k);
+    bool res = n != NULL && !(k < n->key);
+    if (res) {
+      v = n->val;
+    }
+    leave(tid);
+    return res;
+  }
+
+  template<class KVFunction>
+  void walk(const key_t &lo, const key_t &hi, KVFunction f, int tid) {
+    enter(tid);
+    for (node_t *n = lower_bound(lo); n != NULL && !(hi < n->key); ) {
+      size_t next = load(&n->next[0]);
+      if (!(next & 1)) {
+        f(n->key, n->val);
+      }
+      n = ptr(next);
+    }
+    leave(tid);
+  }
+};
+
+/*** Example Usage and Output:
+
+Range [20, 30]: 20 22 24 26 28 30
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+#include <map>
+using namespace std;
+
+void printkey(int k, int v) {
+  cout << " " << k;
+}
+
+int main() {
+  // Each call may come from a different thread, given its own id.
+  concurrent_skip_list<int, int> s(4);
+  for (int i = 0; i < 100000; i++) {
+    assert(s.insert(2*i, -2*i, i % 4));
+  }
+  assert(!s.insert(10, 0, 0) && s.size() == 100000);
+  cout << "Range [20, 30]:";
+  s.walk(19, 30, printkey, 1);
+  cout << endl;
+  map<int, int> m;
+  for (int i = 0; i < 100000; i++) {
+    m[2*i] = -2*i;
+  }
+  for (int i = 0; i < 300000; i++) {
+    int k = rand() % 250000, tid = rand() % 4;
+    if (rand() % 2 == 0) {
+      assert(s.insert(k, k, tid) == m.insert(make_pair(k, k)).second);
+    } else {
+      assert(s.erase(k, tid) == (m.erase(k) == 1));
+    }
+  }
+  assert(s.size() == m.size());
+  for (int i = 0; i < 250000; i++) {
+    int v = 0;
+    map<int, int>::iterator it = m.find(i);
+    assert(s.find(i, v, 2) == (it != m.end()));
+    assert(it == m.end() || v == it->second);
+  }
+  return 0;
+}
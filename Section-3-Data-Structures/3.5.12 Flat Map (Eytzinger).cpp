@@ -0,0 +1,452 @@
+/*
+
+Maintain a map, that is, a collection of key-value pairs such that each possible
+key appears at most once in the collection. This implementation requires an
+ordering on the set of possible keys defined by the < operator on the key type.
+A flat map keeps its entries in plain arrays of keys and values rather than in
+nodes, using about as little memory as the entries themselves, and is suited to
+maps which are read far more often than they are changed.
+
+The main arrays are in Eytzinger order, that is, the order of a breadth-first
+traversal of a complete binary search tree, where entry i has children 2i and
+2i + 1 in the arrays. A search descends from entry 1 with a single comparison
+and no unpredictable branch per level, while prefetching the 16 entries four
+levels below the current one, which for 4-byte keys fill one cache line.
+Following entries in order of keys takes amortized O(1) steps per entry.
+
+Changes go to a small delta buffer sorted by key, holding new entries and
+erasures of entries in the main arrays, which takes precedence over the main
+arrays. Once the buffer holds more than 64 + 8 sqrt(n) changes, it is merged
+with the main arrays in a single linear pass (which may also be forced by
+calling flush()), and the main arrays are rebuilt in Eytzinger order.
+
+- flat_map() constructs an empty map.
+- flat_map(lo, hi) constructs a map from a range of std::pair entries in any
+  order, keeping the first of any entries with equal keys.
+- size() returns the size of the map.
+- empty() returns whether the map is empty.
+- insert(k, v) adds an entry with key k and value v to the map, returning true
+  if an new entry was added or false if the key already exists (in which case
+  the map is unchanged and the old value associated with the key is preserved).
+- insert(lo, hi) inserts a range of std::pair entries in any order as if by
+  insert(k, v) for each, merging them into the delta buffer in a single pass.
+- erase(k) removes the entry with key k from the map, returning true if the
+  removal was successful or false if the key to be removed was not found.
+- find(k) returns a pointer to a const value associated with key k, or NULL if
+  the key was not found.
+- flush() merges the delta buffer into the main arrays.
+- walk(f) calls the function f(k, v) on each entry of the map, in ascending
+  order of keys.
+- walk(lo, hi, f) calls f(k, v) on each entry with lo <= k <= hi in ascending
+  order of keys.
+
+Time Complexity:
+- O(1) per call to the first constructor, size(), and empty().
+- O(n log n) per call to the second constructor, where n is the number of
+  entries.
+- O(log n) per call to find(), where n is the number of entries currently in
+  the map, with about log(n)/4 cache misses which are not overlapped.
+- O(sqrt n) amortized per call to insert(k, v) and erase(), and O(sqrt n +
+  m log(m + n)) amortized per call to insert(lo, hi) for m entries.
+- O(n) per call to flush() and walk(f), and O(log n + m) per call to
+  walk(lo, hi, f), where m is the number of entries reported.
+
+Space Complexity:
+- O(n) for storage of the map elements, with no overhead beyond the keys and
+  values besides the delta buffer of O(sqrt n) entries.
+- O(n) auxiliary per call to flush(), O(m + sqrt n) auxiliary per call to
+  insert(lo, hi), and O(1) auxiliary per call to all other operations.
+
+*/
+
+#include <algorithm>  // std::stable_sort()
+#include <cmath>  // std::sqrt()
+#include <cstdlib>  // NULL
+#include <utility>  // std::pair
+#include <vector>
+
+template<class K, class V> class flat_map {
+  struct entry_t {
+    K key;
+    V value;
+    bool present;  // False for an erasure of a key in the main arrays.
+  };
+
+  struct key_less {
+    bool operator()(const entry_t &a, const entry_t &b) const {
+      return a.key < b.key;
+    }
+
+    bool operator()(const std::pair<K, V> &a, const std::pair<K, V> &b) const {
+      return a.first < b.first;
+    }
+  };
+
+  // The number of keys in a cache line, which are the descendants four levels
+  // below a node i in the main arrays for 4-byte keys.
+  static const long long PREFETCH = (sizeof(K) < 64) ? 64/sizeof(K) : 1;
+
+  // The main arrays hold the entries in Eytzinger order from index 1.
+  std::vector<K> keys;
+  std::vector<V> values;
+  std::vector<entry_t> delta;
+  int num_entries;
+
+  int main_size() const {
+    return (int)keys.size() - 1;
+  }
+
+  // Returns the index of the first key in the main arrays not less than k, or
+  // 0 if there is none.
+  int lower_bound(const K &k) const {
+    int n = main_size(), i = 1;
+    const K *a = &keys[0];
+    while (i <= n) {
+      if (PREFETCH*i <= n) {
+        __builtin_prefetch(a + PREFETCH*i);
+      }
+      i = 2*i + (a[i] < k);
+    }
+    return i >> __builtin_ffs(~i);
+  }
+
+  int find_main(const K &k) const {
+    int i = lower_bound(k);
+    return (i != 0 && !(k < keys[i])) ? i : 0;
+  }
+
+  // Returns the index of the first key in the main arrays, or 0 if empty.
+  int first() const {
+    int n = main_size(), i = (n > 0) ? 1 : 0;
+    while (i != 0 && 2*i <= n) {
+      i *= 2;
+    }
+    return i;
+  }
+
+  // Returns the index of the next key after that at index i, or 0 if none.
+  int next(int i) const {
+    int n = main_size();
+    if (2*i + 1 <= n) {
+      for (i = 2*i + 1; 2*i <= n; i *= 2) {}
+      return i;
+    }
+    while (i & 1) {
+      i >>= 1;
+    }
+    return i >> 1;
+  }
+
+  // Returns the position of the first change in the delta buffer with a key
+  // not less than k.
+  int delta_lower_bound(const K &k) const {
+    int lo = 0, hi = (int)delta.size();
+    while (lo < hi) {
+      int mid = lo + (hi - lo)/2;
+      if (delta[mid].key < k) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  bool in_delta(int j, const K &k) const {
+    return j < (int)delta.size() && !(k < delta[j].key);
+  }
+
+  int delta_capacity() const {
+    return 64 + 8*(int)std::sqrt((double)main_size());
+  }
+
+  // Rebuilds the main arrays from the sorted arrays sk and sv.
+  void build(const std::vector<K> &sk, const std::vector<V> &sv) {
+    keys.resize(sk.size() + 1);
+    values.resize(sv.size() + 1);
+    int j = 0;
+    for (int i = first(); i != 0; i = next(i), j++) {
+      keys[i] = sk[j];
+      values[i] = sv[j];
+    }
+  }
+
+  // Calls f(k, v) on each entry from the index i of the main arrays and the
+  // position j of the delta buffer onwards, stopping after the key *hi.
+  template<class KVFunction>
+  void walk_from(int i, int j, const K *hi, KVFunction &f) const {
+    int d = (int)delta.size();
+    while (i != 0 || j < d) {
+      if (j == d || (i != 0 && keys[i] < delta[j].key)) {
+        if (hi != NULL && *hi < keys[i]) {
+          return;
+        }
+        f(keys[i], values[i]);
+        i = next(i);
+        continue;
+      }
+      if (hi != NULL && *hi < delta[j].key) {
+        return;
+      }
+      if (i != 0 && !(delta[j].key < keys[i])) {
+        i = next(i);
+      }
+      if (delta[j].present) {
+        f(delta[j].key, delta[j].value);
+      }
+      j++;
+    }
+  }
+
+ public:
+  flat_map() : keys(1), values(1), num_entries(0) {}
+
+  template<class It> flat_map(It lo, It hi) : keys(1), values(1) {
+    std::vector<std::pair<K, V> > v(lo, hi);
+    std::stable_sort(v.begin(), v.end(), key_less());
+    std::vector<K> sk;
+    std::vector<V> sv;
+    for (int i = 0; i < (int)v.size(); i++) {
+      if (i == 0 || v[i - 1].first < v[i].first) {
+        sk.push_back(v[i].first);
+        sv.push_back(v[i].second);
+      }
+    }
+    build(sk, sv);
+    num_entries = (int)sk.size();
+  }
+
+  int size() const {
+    return num_entries;
+  }
+
+  bool empty() const {
+    return num_entries == 0;
+  }
+
+  bool insert(const K &k, const V &v) {
+    int j = delta_lower_bound(k);
+    if (in_delta(j, k)) {
+      if (delta[j].present) {
+        return false;
+      }
+      delta[j].value = v;
+      delta[j].present = true;
+      num_entries++;
+      return true;
+    }
+    if (find_main(k) != 0) {
+      return false;
+    }
+    entry_t e = {k, v, true};
+    delta.insert(delta.begin() + j, e);
+    num_entries++;
+    if ((int)delta.size() > delta_capacity()) {
+      flush();
+    }
+    return true;
+  }
+
+  template<class It> void insert(It lo, It hi) {
+    std::vector<entry_t> batch, merged;
+    for (; lo != hi; ++lo) {
+      entry_t e = {lo->first, lo->second, true};
+      batch.push_back(e);
+    }
+    std::stable_sort(batch.begin(), batch.end(), key_less());
+    merged.reserve(delta.size() + batch.size());
+    int j = 0;
+    for (int b = 0; b < (int)batch.size(); b++) {
+      const K &k = batch[b].key;
+      if (b > 0 && !(batch[b - 1].key < k)) {
+        continue;
+      }
+      for (; j < (int)delta.size() && delta[j].key < k; j++) {
+        merged.push_back(delta[j]);
+      }
+      if (in_delta(j, k)) {
+        if (!delta[j].present) {
+          delta[j].value = batch[b].value;
+          delta[j].present = true;
+          num_entries++;
+        }
+      } else if (find_main(k) == 0) {
+        merged.push_back(batch[b]);
+        num_entries++;
+      }
+    }
+    merged.insert(merged.end(), delta.begin() + j, delta.end());
+    delta.swap(merged);
+    if ((int)delta.size() > delta_capacity()) {
+      flush();
+    }
+  }
+
+  bool erase(const K &k) {
+    int j = delta_lower_bound(k);
+    if (in_delta(j, k)) {
+      if (!delta[j].present) {
+        return false;
+      }
+      if (find_main(k) != 0) {
+        delta[j].present = false;
+      } else {
+        delta.erase(delta.begin() + j);
+      }
+      num_entries--;
+      return true;
+    }
+    int i = find_main(k);
+    if (i == 0) {
+      return false;
+    }
+    entry_t e = {k, values[i], false};
+    delta.insert(delta.begin() + j, e);
+    num_entries--;
+    if ((int)delta.size() > delta_capacity()) {
+      flush();
+    }
+    return true;
+  }
+
+  const V* find(const K &k) const {
+    int j = delta_lower_bound(k);
+    if (in_delta(j, k)) {
+      return delta[j].present ? &delta[j].value : NULL;
+    }
+    int i = find_main(k);
+    return (i != 0) ? &values[i] : NULL;
+  }
+
+  void flush() {
+    if (delta.empty()) {
+      return;
+    }
+    std::vector<K> sk;
+    std::vector<V> sv;
+    sk.reserve(num_entries);
+    sv.reserve(num_entries);
+    int i = first(), j = 0, d = (int)delta.size();
+    while (i != 0 || j < d) {
+      if (j == d || (i != 0 && keys[i] < delta[j].key)) {
+        sk.push_back(keys[i]);
+        sv.push_back(values[i]);
+        i = next(i);
+        continue;
+      }
+      if (i != 0 && !(delta[j].key < keys[i])) {
+        i = next(i);
+      }
+      if (delta[j].present) {
+        sk.push_back(delta[j].key);
+        sv.push_back(delta[j].value);
+      }
+      j++;
+    }
+    delta.clear();
+    build(sk, sv);
+  }
+
+  template<class KVFunction> void walk(KVFunction f) const {
+    walk_from(first(), 0, (const K*)NULL, f);
+  }
+
+  template<class KVFunction>
+  void walk(const K &lo, const K &hi, KVFunction f) const {
+    walk_from(lower_bound(lo), delta_lower_bound(lo), &hi, f);
+  }
+};
+
+/*** Example Usage and Output:
+
+abcde
+bcde
+Range [20, 30]: 20 22 24 26 28 30
+
+***/
+
+#include <cassert>
+#include <iostream>
+#include <map>
+using namespace std;
+
+void printch(int k, char v) {
+  cout << v;
+}
+
+void printkey(int k, int v) {
+  cout << " " << k;
+}
+
+vector<pair<int, int> > walked;
+
+void record(int k, int v) {
+  walked.push_back(make_pair(k, v));
+}
+
+int main() {
+  {
+    flat_map<int, char> t;
+    t.insert(2, 'b');
+    t.insert(1, 'a');
+    t.insert(3, 'c');
+    t.insert(5, 'e');
+    assert(t.insert(4, 'd'));
+    assert(*t.find(4) == 'd');
+    assert(!t.insert(4, 'd'));
+    t.walk(printch);
+    cout << endl;
+    t.flush();
+    assert(t.erase(1));
+    assert(!t.erase(1));
+    assert(t.find(1) == NULL);
+    t.walk(printch);
+    cout << endl;
+  }
+  {
+    // Bulk build the even numbers below 2000000, then compare against std::map.
+    vector<pair<int, int> > entries;
+    for (int i = 2000000 - 2; i >= 0; i -= 2) {
+      entries.push_back(make_pair(i, -i));
+    }
+    flat_map<int, int> t(entries.begin(), entries.end());
+    map<int, int> m(entries.begin(), entries.end());
+    assert(t.size() == 1000000 && *t.find(123456) == -123456);
+    assert(t.find(123457) == NULL);
+    cout << "Range [20, 30]:";
+    t.walk(19, 30, printkey);
+    cout << endl;
+    for (int i = 0; i < 300000; i++) {
+      int k = rand() % 2500000, op = rand() % 3;
+      if (op == 0) {
+        assert(t.insert(k, k) == m.insert(make_pair(k, k)).second);
+      } else if (op == 1) {
+        assert(t.erase(k) == (m.erase(k) == 1));
+      } else {
+        const int *v = t.find(k);
+        assert((v == NULL) == (m.count(k) == 0) && (v == NULL || *v == m[k]));
+      }
+    }
+    vector<pair<int, int> > batch;
+    for (int i = 0; i < 5000; i++) {
+      batch.push_back(make_pair(rand() % 2500000, i));
+      m.insert(batch.back());
+    }
+    t.insert(batch.begin(), batch.end());
+    assert(t.size() == (int)m.size());
+    walked.clear();
+    t.walk(record);
+    vector<pair<int, int> > expected(m.begin(), m.end());
+    assert(walked == expected);
+    walked.clear();
+    t.walk(1000, 200000, record);
+    expected.assign(m.lower_bound(1000), m.upper_bound(200000));
+    assert(walked == expected);
+    t.flush();
+    for (int i = 0; i < 2500000; i += 7) {
+      const int *v = t.find(i);
+      assert((v == NULL) == (m.count(i) == 0) && (v == NULL || *v == m[i]));
+    }
+  }
+  return 0;
+}
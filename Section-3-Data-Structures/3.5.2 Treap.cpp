@@ -19,12 +19,19 @@ insertions and deletions run in O(log n) with high probability.
   the key was not found.
 - walk(f) calls the function f(k, v) on each entry of the map, in ascending
   order of keys.
+- clear() removes all entries from the map.
+
+Nodes come from the template argument Pool, by default a node_pool which hands
+out nodes from large slabs and recycles erased nodes, avoiding a heap allocation
+per insertion. The map is destroyed or cleared by a sweep over the slabs rather
+than a traversal of the tree.
 
 Time Complexity:
 - O(1) per call to the constructor, size(), and empty().
 - O(log n) on average per call to insert(), erase(), and find(), where n is the
   number of entries currently in the map.
-- O(n) per call to walk().
+- O(n) per call to walk(), and O(n) per call to clear() and the destructor, or
+  O(log n) if K and V have trivial destructors.
 
 Space Complexity:
 - O(n) for storage of the map elements.
@@ -34,8 +41,81 @@ Space Complexity:
 */
 
 #include <cstdlib>  // srand(), rand()
+#include <new>  // placement new
+#include <utility>  // std::pair
+#include <vector>
+
+// A slab allocator for nodes with a free list, as in section 3.5.1.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  std::vector<std::pair<slot*, size_t> > slabs;
+  slot *free_list;
+  size_t used;  // The number of slots handed out from the last slab.
+
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
+
+ public:
+  node_pool() : free_list(NULL), used(0) {}
+
+  ~node_pool() {
+    clear();
+  }
 
-template<class K, class V> class treap {
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != NULL) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || used == slabs.back().second) {
+        size_t n = slabs.empty() ? 64 : 2*slabs.back().second;
+        slabs.push_back(std::make_pair(new slot[n], n));
+        used = 0;
+      }
+      s = slabs.back().first + used++;
+    }
+    s->next = s;
+    return s->u.data;
+  }
+
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    s->next = free_list;
+    free_list = s;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        size_t n = (i + 1 == slabs.size()) ? used : slabs[i].second;
+        for (size_t j = 0; j < n; j++) {
+          slot *s = slabs[i].first + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].first;
+    }
+    slabs.clear();
+    free_list = NULL;
+    used = 0;
+  }
+};
+
+template<class K, class V, template<class> class Pool = node_pool>
+class treap {
   struct node_t {
     K key;
     V value;
@@ -51,6 +131,7 @@ template<class K, class V> class treap {
   } *root;
 
   int num_nodes;
+  Pool<node_t> pool;
 
   static void rotate_l(node_t *&n) {
     node_t *tmp = n;
@@ -66,9 +147,9 @@ template<class K, class V> class treap {
     n->right = tmp;
   }
 
-  static bool insert(node_t *&n, const K &k, const V &v) {
+  bool insert(node_t *&n, const K &k, const V &v) {
     if (n == NULL) {
-      n = new node_t(k, v);
+      n = new (pool.allocate()) node_t(k, v);
       return true;
     }
     if (k < n->key && insert(n->left, k, v)) {
@@ -86,7 +167,7 @@ template<class K, class V> class treap {
     return false;
   }
 
-  static bool erase(node_t *&n, const K &k) {
+  bool erase(node_t *&n, const K &k) {
     if (n == NULL) {
       return false;
     }
@@ -104,7 +185,7 @@ template<class K, class V> class treap {
       return erase(n->left, k);
     }
     node_t *tmp = (n->left != NULL) ? n->left : n->right;
-    delete n;
+    pool.destroy(n);
     n = tmp;
     return true;
   }
@@ -118,24 +199,12 @@ template<class K, class V> class treap {
     }
   }
 
-  static void clean_up(node_t *n) {
-    if (n != NULL) {
-      clean_up(n->left);
-      clean_up(n->right);
-      delete n;
-    }
-  }
-
  public:
   treap() {
     root = NULL;
     num_nodes = 0;
   }
 
-  ~treap() {
-    clean_up(root);
-  }
-
   int size() const {
     return num_nodes;
   }
@@ -144,6 +213,12 @@ template<class K, class V> class treap {
     return root == NULL;
   }
 
+  void clear() {
+    pool.clear();
+    root = NULL;
+    num_nodes = 0;
+  }
+
   bool insert(const K &k, const V &v) {
     if (insert(root, k, v)) {
       num_nodes++;
@@ -210,5 +285,7 @@ int main() {
   assert(t.find(1) == NULL);
   t.walk(printch);
   cout << endl;
+  t.clear();
+  assert(t.empty() && t.insert(1, 'a') && t.size() == 1);
   return 0;
 }
@@ -27,17 +27,94 @@ std::multiset or std::multimap is a more complex issue. Refer to the
 articles above and determine the correct way to preserve the binary search
 tree property with maintain() if equivalent keys are allowed.
 
+Nodes are allocated from the template argument Pool, which by default is a
+slab allocator recycling erased nodes through a free list. clear() and the
+destructor release all nodes by a sweep over the slabs, without recursion.
+
 Time Complexity: insert(), erase(), find(), select() and rank() are
-O(log N) on the number of elements in the tree. walk() is O(N).
+O(log N) on the number of elements in the tree. walk() is O(N). clear()
+is O(N), or O(log N) if the keys and values have trivial destructors.
 
 Space Complexity: O(N) on the number of nodes in the tree.
 
 */
 
+#include <new>       /* placement new */
 #include <stdexcept> /* std::runtime_error */
 #include <utility>   /* pair */
+#include <vector>
+
+// A slab allocator for nodes with a free list, as in section 3.5.1.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  std::vector<std::pair<slot*, size_t> > slabs;
+  slot *free_list;
+  size_t used;  // The number of slots handed out from the last slab.
+
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
+
+ public:
+  node_pool() : free_list(0), used(0) {}
 
-template<class key_t, class val_t> class size_balanced_tree {
+  ~node_pool() {
+    clear();
+  }
+
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != 0) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || used == slabs.back().second) {
+        size_t n = slabs.empty() ? 64 : 2*slabs.back().second;
+        slabs.push_back(std::make_pair(new slot[n], n));
+        used = 0;
+      }
+      s = slabs.back().first + used++;
+    }
+    s->next = s;
+    return s->u.data;
+  }
+
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    s->next = free_list;
+    free_list = s;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        size_t n = (i + 1 == slabs.size()) ? used : slabs[i].second;
+        for (size_t j = 0; j < n; j++) {
+          slot *s = slabs[i].first + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].first;
+    }
+    slabs.clear();
+    free_list = 0;
+    used = 0;
+  }
+};
+
+template<class key_t, class val_t, template<class> class Pool = node_pool>
+class size_balanced_tree {
   struct node_t {
     key_t key;
     val_t val;
@@ -57,6 +134,8 @@ template<class key_t, class val_t> class size_balanced_tree {
     }
   } *root;
 
+  Pool<node_t> pool;
+
   static inline int size(node_t * n) {
     return n ? n->size : 0;
   }
@@ -85,9 +164,9 @@ template<class key_t, class val_t> class size_balanced_tree {
     maintain(n, 1);
   }
 
-  static void insert(node_t *& n, const key_t & k, const val_t & v) {
+  void insert(node_t *& n, const key_t & k, const val_t & v) {
     if (n == 0) {
-      n = new node_t(k, v);
+      n = new (pool.allocate()) node_t(k, v);
       return;
     }
     if (k < n->key) {
@@ -100,7 +179,7 @@ template<class key_t, class val_t> class size_balanced_tree {
     n->update();
   }
 
-  static void erase(node_t *& n, const key_t & k) {
+  void erase(node_t *& n, const key_t & k) {
     if (n == 0) return;
     bool d = k < n->key;
     if (k < n->key) {
@@ -109,13 +188,15 @@ template<class key_t, class val_t> class size_balanced_tree {
       erase(n->c[1], k);
     } else {
       if (n->c[1] == 0 || n->c[0] == 0) {
-        delete n;
-        n = n->c[1] == 0 ? n->c[0] : n->c[1];
+        node_t * p = n->c[1] == 0 ? n->c[0] : n->c[1];
+        pool.destroy(n);
+        n = p;
         return;
       }
       node_t * p = n->c[1];
       while (p->c[0] != 0) p = p->c[0];
       n->key = p->key;
+      n->val = p->val;
       erase(n->c[1], p->key);
     }
     maintain(n, d);
@@ -146,18 +227,11 @@ template<class key_t, class val_t> class size_balanced_tree {
     return r;
   }
 
-  static void clean_up(node_t * n) {
-    if (n == 0) return;
-    clean_up(n->c[0]);
-    clean_up(n->c[1]);
-    delete n;
-  }
-
  public:
   size_balanced_tree() : root(0) {}
-  ~size_balanced_tree() { clean_up(root); }
   int size() { return size(root); }
   bool empty() const { return root == 0; }
+  void clear() { pool.clear(); root = 0; }
 
   void insert(const key_t & key, const val_t & val) {
     insert(root, key, val);
@@ -222,5 +296,10 @@ int main() {
     T2.insert(i, i*1337);
   for (int i = 0; i < 1000000; i++)
     assert(*T2.find(i) == i*1337);
+  for (int i = 0; i < 1000000; i += 2)
+    T2.erase(i);
+  assert(T2.size() == 500000 && T2.select(0).second == 1337);
+  T2.clear();
+  assert(T2.empty());
   return 0;
 }
@@ -8,8 +8,13 @@ been found, one smaller and one larger than the element searched for.
 Skip lists are generally slower than binary search trees, but can
 be easier to implement. The following version uses randomized levels.
 
+Nodes are allocated from the template argument Pool, by default a slab
+allocator with a free list, while the array of forward pointers of each
+node, whose length depends on its level, remains on the heap. clear()
+and the destructor release all nodes by a sweep over the slabs.
+
 Time Complexity: insert(), erase(), count() and find() are O(log(N))
-on average, but O(N) in the worst case. walk() is O(N).
+on average, but O(N) in the worst case. walk() and clear() are O(N).
 
 Space Complexity: O(N) on the number of elements inserted on average,
 but O(N log N) in the worst case.
@@ -20,8 +25,81 @@ but O(N log N) in the worst case.
 #include <cstdlib> /* rand(), srand() */
 #include <cstring> /* memset() */
 #include <ctime>   /* time() */
+#include <new>     /* placement new */
+#include <utility> /* std::pair */
+#include <vector>
+
+// A slab allocator for nodes with a free list, as in section 3.5.1.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  std::vector<std::pair<slot*, size_t> > slabs;
+  slot *free_list;
+  size_t used;  // The number of slots handed out from the last slab.
+
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
+
+ public:
+  node_pool() : free_list(0), used(0) {}
+
+  ~node_pool() {
+    clear();
+  }
+
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != 0) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || used == slabs.back().second) {
+        size_t n = slabs.empty() ? 64 : 2*slabs.back().second;
+        slabs.push_back(std::make_pair(new slot[n], n));
+        used = 0;
+      }
+      s = slabs.back().first + used++;
+    }
+    s->next = s;
+    return s->u.data;
+  }
+
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    s->next = free_list;
+    free_list = s;
+  }
 
-template<class key_t, class val_t> struct skip_list {
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        size_t n = (i + 1 == slabs.size()) ? used : slabs[i].second;
+        for (size_t j = 0; j < n; j++) {
+          slot *s = slabs[i].first + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].first;
+    }
+    slabs.clear();
+    free_list = 0;
+    used = 0;
+  }
+};
+
+template<class key_t, class val_t, template<class> class Pool = node_pool>
+struct skip_list {
   static const int MAX_LEVEL = 32; //~ log2(max # of keys)
 
   static int random_level() { //geometric distribution
@@ -46,14 +124,19 @@ template<class key_t, class val_t> struct skip_list {
   } *head, *update[MAX_LEVEL + 1];
 
   int level, num_nodes;
+  Pool<node_t> pool;
 
   skip_list() {
     srand(time(0));
-    head = new node_t(MAX_LEVEL, key_t(), val_t());
+    clear();
+  }
+
+  void clear() {
+    pool.clear();
+    head = new (pool.allocate()) node_t(MAX_LEVEL, key_t(), val_t());
     level = num_nodes = 0;
   }
 
-  ~skip_list() { delete head; }
   int size() { return num_nodes; }
   bool empty() { return num_nodes == 0; }
   int count(const key_t & k) { return find(k) != 0; }
@@ -72,7 +155,7 @@ template<class key_t, class val_t> struct skip_list {
         for (int i = level + 1; i <= lvl; i++) update[i] = head;
         level = lvl;
       }
-      n = new node_t(lvl, k, v);
+      n = new (pool.allocate()) node_t(lvl, k, v);
       num_nodes++;
       for (int i = 0; i <= lvl; i++) {
         n->next[i] = update[i]->next[i];
@@ -91,12 +174,12 @@ template<class key_t, class val_t> struct skip_list {
       update[i] = n;
     }
     n = n->next[0];
-    if (n->key == k) {
+    if (n && n->key == k) {
       for (int i = 0; i <= level; i++) {
         if (update[i]->next[i] != n) break;
         update[i]->next[i] = n->next[i];
       }
-      delete n;
+      pool.destroy(n);
       num_nodes--;
       while (level > 0 && !head->next[level]) level--;
     }
@@ -148,5 +231,7 @@ int main() {
       }
     }
   }
+  s.clear();
+  assert(s.empty() && s.find(rand()) == 0);
   return 0;
 }
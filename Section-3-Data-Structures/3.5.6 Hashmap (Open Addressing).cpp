@@ -0,0 +1,260 @@
+/*
+
+A hashmap storing its entries directly in a single array of slots, probed
+linearly, in the style of the Swiss tables by Google. Next to the slots is an
+array of control bytes, one per slot, which is either EMPTY or holds the low 7
+bits of the hash of the slot's key (its tag). A lookup computes the hash once,
+starts from the slot given by its remaining bits, and compares the tag against
+16 control bytes at a time using SSE2 instructions where available (or one at a
+time otherwise). Only the slots whose tags match, one in 128 of the others on
+average, have their keys compared. Since probing is linear, the entries from a
+slot up to the next empty slot include every key whose probe sequence passes
+through it, so a lookup stops at the first empty control byte. The first 15
+control bytes are mirrored past the end of the array, so that the 16 bytes from
+any slot can be loaded without wrapping around.
+
+Removing an entry shifts later entries of the same run backward into the hole,
+wherever that brings them closer to their starting slot, instead of leaving a
+tombstone. Lookups thus never slow down after many removals. The capacity is a
+power of two and is doubled when the table is 7/8 full, moving every entry into
+a new array without comparing keys. insert() probes once, either finding the
+key or the empty slot to place it in.
+
+find() accepts any type of key which Hash can hash consistently with key_t and
+which compares equal to key_t with ==, such as a const char* for std::string
+keys, so that looking up a literal does not construct a temporary string.
+
+Time Complexity:
+- O(1) expected per call to insert(), remove(), find(), and operator[], with
+  O(n) for a call which doubles the capacity, where n is the number of entries.
+
+Space Complexity: O(n) on the number of entries, with one control byte per slot.
+
+*/
+
+#include <cstring>  // std::memset()
+#include <new>  // operator new(), placement new
+#include <utility>  // std::pair
+#ifdef __SSE2__
+#include <emmintrin.h>  // _mm_cmpeq_epi8(), _mm_movemask_epi8(), ...
+#endif
+
+template<class key_t, class val_t, class Hash> class flat_hashmap {
+  static const int GROUP = 16;
+  static const signed char EMPTY = -128;
+
+  typedef std::pair<key_t, val_t> entry_t;
+
+  signed char *ctrl;
+  entry_t *slots;
+  size_t mask, map_size;
+
+  static signed char tag(size_t h) {
+    return (signed char)(h & 0x7f);
+  }
+
+  // Returns a bitmask of which of the GROUP control bytes from i equal t.
+  unsigned int match(size_t i, signed char t) const {
+#ifdef __SSE2__
+    __m128i g = _mm_loadu_si128((const __m128i*)(ctrl + i));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(t)));
+#else
+    unsigned int res = 0;
+    for (int j = 0; j < GROUP; j++) {
+      res |= (unsigned int)(ctrl[i + j] == t) << j;
+    }
+    return res;
+#endif
+  }
+
+  void set_ctrl(size_t i, signed char c) {
+    ctrl[i] = c;
+    if (i < GROUP - 1) {
+      ctrl[mask + 1 + i] = c;
+    }
+  }
+
+  // Returns the slot holding key, or else the empty slot ending its run with
+  // found set to false.
+  template<class K>
+  size_t probe(const K &key, size_t h, bool &found) const {
+    signed char t = tag(h);
+    for (size_t i = (h >> 7) & mask; ; i = (i + GROUP) & mask) {
+      unsigned int empty = match(i, EMPTY);
+      // Tags at or past the first empty byte belong to other runs. If there
+      // is no empty byte, then (empty & -empty) - 1 has all bits set.
+      unsigned int hits = match(i, t) & ((empty & -empty) - 1);
+      for (; hits != 0; hits &= hits - 1) {
+        size_t j = (i + __builtin_ctz(hits)) & mask;
+        if (slots[j].first == key) {
+          found = true;
+          return j;
+        }
+      }
+      if (empty != 0) {
+        found = false;
+        return (i + __builtin_ctz(empty)) & mask;
+      }
+    }
+  }
+
+  void allocate(size_t capacity) {
+    mask = capacity - 1;
+    ctrl = new signed char[capacity + GROUP - 1];
+    std::memset(ctrl, EMPTY, capacity + GROUP - 1);
+    slots = (entry_t*)operator new(capacity*sizeof(entry_t));
+  }
+
+  void rehash() {
+    signed char *old_ctrl = ctrl;
+    entry_t *old_slots = slots;
+    size_t old_capacity = mask + 1;
+    allocate(2*old_capacity);
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] != EMPTY) {
+        size_t h = Hash()(old_slots[i].first);
+        size_t j = (h >> 7) & mask;
+        while (ctrl[j] != EMPTY) {
+          j = (j + 1) & mask;
+        }
+        set_ctrl(j, tag(h));
+        new (slots + j) entry_t(old_slots[i]);
+        old_slots[i].~entry_t();
+      }
+    }
+    delete[] old_ctrl;
+    operator delete(old_slots);
+  }
+
+  flat_hashmap(const flat_hashmap &);
+  flat_hashmap& operator=(const flat_hashmap &);
+
+ public:
+  // The capacity is rounded up to a power of two of at least GROUP.
+  flat_hashmap(size_t capacity = GROUP) : map_size(0) {
+    size_t c = GROUP;
+    while (c < capacity) {
+      c *= 2;
+    }
+    allocate(c);
+  }
+
+  ~flat_hashmap() {
+    for (size_t i = 0; i <= mask; i++) {
+      if (ctrl[i] != EMPTY) {
+        slots[i].~entry_t();
+      }
+    }
+    delete[] ctrl;
+    operator delete(slots);
+  }
+
+  size_t size() const {
+    return map_size;
+  }
+
+  // Inserts the entry if key is not yet present, and returns its value.
+  val_t& insert(const key_t &key, const val_t &val) {
+    size_t h = Hash()(key);
+    bool found;
+    size_t i = probe(key, h, found);
+    if (!found) {
+      if (8*(map_size + 1) > 7*(mask + 1)) {
+        rehash();
+        i = probe(key, h, found);
+      }
+      set_ctrl(i, tag(h));
+      new (slots + i) entry_t(key, val);
+      map_size++;
+    }
+    return slots[i].second;
+  }
+
+  template<class K>
+  bool remove(const K &key) {
+    bool found;
+    size_t i = probe(key, Hash()(key), found);
+    if (!found) {
+      return false;
+    }
+    slots[i].~entry_t();
+    map_size--;
+    // Move each later entry of the run into the hole unless its starting slot
+    // lies cyclically after the hole, up to its own position.
+    for (size_t j = (i + 1) & mask; ctrl[j] != EMPTY; j = (j + 1) & mask) {
+      size_t home = (Hash()(slots[j].first) >> 7) & mask;
+      if (((j - home) & mask) >= ((j - i) & mask)) {
+        set_ctrl(i, ctrl[j]);
+        new (slots + i) entry_t(slots[j]);
+        slots[j].~entry_t();
+        i = j;
+      }
+    }
+    set_ctrl(i, EMPTY);
+    return true;
+  }
+
+  template<class K>
+  val_t* find(const K &key) {
+    bool found;
+    size_t i = probe(key, Hash()(key), found);
+    return found ? &slots[i].second : 0;
+  }
+
+  val_t& operator[](const key_t &key) {
+    return insert(key, val_t());
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <string>
+using namespace std;
+
+// FNV-1a, defined for both std::string and C strings so that they hash alike.
+struct string_hash {
+  size_t operator()(const char *s) const {
+    unsigned long long h = 14695981039346656037ULL;
+    for (; *s != 0; s++) {
+      h = (h ^ (unsigned char)*s)*1099511628211ULL;
+    }
+    return (size_t)h;
+  }
+
+  size_t operator()(const string &s) const {
+    return (*this)(s.c_str());
+  }
+};
+
+// A 64-bit finalizer (from MurmurHash3), spreading all bits of the key.
+struct int_hash {
+  size_t operator()(long long k) const {
+    unsigned long long h = (unsigned long long)k;
+    h = (h ^ (h >> 33))*0xff51afd7ed558ccdULL;
+    h = (h ^ (h >> 33))*0xc4ceb9fe1a85ec53ULL;
+    return (size_t)(h ^ (h >> 33));
+  }
+};
+
+int main() {
+  flat_hashmap<string, int, string_hash> m;
+  m["foo"] = 1;
+  m.insert("bar", 2);
+  assert(*m.find("foo") == 1 && *m.find("bar") == 2);
+  assert(m["baz"] == 0 && m.size() == 3);
+  assert(m.remove("foo") && !m.remove("foo"));
+  assert(m.find("foo") == 0 && m.size() == 2);
+  flat_hashmap<long long, long long, int_hash> squares;
+  for (long long i = 0; i < 100000; i++) {
+    squares[i] = i*i;
+  }
+  for (long long i = 0; i < 100000; i += 2) {
+    assert(squares.remove(i));
+  }
+  for (long long i = 0; i < 100000; i++) {
+    long long *v = squares.find(i);
+    assert((i % 2 == 0) ? v == 0 : *v == i*i);
+  }
+  return 0;
+}
@@ -0,0 +1,283 @@
+/*
+
+A hashmap which may be used by many threads at once, where lookups take no
+locks and never block writers. The keys are split by their hash among a fixed
+power of two number of shards, each an independent open-addressing table with
+linear probing (as in section 3.5.6). The shard of a key is chosen by the high
+bits of its hash, and its starting slot within the shard by the low bits.
+
+- Writers (insert() and remove()) take a spin lock of the shard, so writers to
+  different shards never contend. Removal shifts later entries of the run
+  backward into the hole, so there are no tombstones.
+- Readers (find()) use a sequence lock per shard. A writer makes the sequence
+  number of its shard odd before modifying it and even again afterwards. A
+  reader notes the (even) sequence number, probes the table and copies out the
+  value, then retries if the sequence number has changed in the meantime. A
+  read thus never sees a half-written entry, and readers never write to shared
+  memory, so they do not bounce cache lines between cores.
+- Each shard grows on its own, by doubling when it is 3/4 full, so a resize
+  only stalls the readers and writers of one shard, for time proportional to
+  that shard's size. Old tables are kept until the map is destroyed, since a
+  reader may still be probing one. Their total size is less than that of the
+  current tables, since each is half the size of the next.
+- shard_stats(s) reports the number of entries, the capacity, and the longest
+  displacement of an entry from its starting slot in shard s, which reveals hot
+  shards and poorly distributed hashes.
+
+Since readers may copy a key or value while it is being overwritten (and
+discard the copy), key_t and val_t must be plain data types which can be
+copied bytewise, such as integers or structs of them. The atomic operations are
+the __atomic builtins of GCC and Clang.
+
+Time Complexity:
+- O(1) expected per call to insert(), remove(), and find() without contention,
+  with O(n) for an insert() which grows a shard of n entries. A find() retries
+  once for each write to its shard which overlaps it.
+
+Space Complexity: O(n) on the number of entries.
+
+*/
+
+#include <cstddef>  // size_t
+#include <vector>
+
+template<class key_t, class val_t, class Hash> class concurrent_hashmap {
+  struct slot {
+    key_t key;
+    val_t val;
+    bool used;
+  };
+
+  struct table_t {
+    slot *slots;
+    size_t mask;
+  };
+
+  // Each shard is padded to its own cache line.
+  struct shard {
+    table_t *table;
+    unsigned int seq;
+    char locked;
+    size_t size, max_displacement;
+    std::vector<table_t*> retired;
+    char padding[64];
+  };
+
+  std::vector<shard> shards;
+  int shard_bits;
+
+  static table_t* new_table(size_t capacity) {
+    table_t *t = new table_t;
+    t->slots = new slot[capacity];
+    t->mask = capacity - 1;
+    for (size_t i = 0; i < capacity; i++) {
+      t->slots[i].used = false;
+    }
+    return t;
+  }
+
+  shard& shard_of(size_t h) {
+    return shards[(shard_bits == 0) ? 0 : h >> (8*sizeof(size_t) - shard_bits)];
+  }
+
+  void lock(shard &s) {
+    while (__atomic_test_and_set(&s.locked, __ATOMIC_ACQUIRE)) {}
+    __atomic_store_n(&s.seq, s.seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+  }
+
+  void unlock(shard &s) {
+    __atomic_store_n(&s.seq, s.seq + 1, __ATOMIC_RELEASE);
+    __atomic_clear(&s.locked, __ATOMIC_RELEASE);
+  }
+
+  // Places an entry known to be absent, with the shard locked.
+  void place(shard &s, const key_t &key, const val_t &val, size_t h) {
+    table_t *t = s.table;
+    size_t home = h & t->mask, i = home;
+    while (t->slots[i].used) {
+      i = (i + 1) & t->mask;
+    }
+    t->slots[i].key = key;
+    t->slots[i].val = val;
+    t->slots[i].used = true;
+    size_t d = (i - home) & t->mask;
+    if (d > s.max_displacement) {
+      s.max_displacement = d;
+    }
+  }
+
+  void grow(shard &s) {
+    table_t *old = s.table;
+    __atomic_store_n(&s.table, new_table(2*(old->mask + 1)), __ATOMIC_RELEASE);
+    s.max_displacement = 0;
+    for (size_t i = 0; i <= old->mask; i++) {
+      if (old->slots[i].used) {
+        place(s, old->slots[i].key, old->slots[i].val,
+              Hash()(old->slots[i].key));
+      }
+    }
+    s.retired.push_back(old);
+  }
+
+  concurrent_hashmap(const concurrent_hashmap &);
+  concurrent_hashmap& operator=(const concurrent_hashmap &);
+
+ public:
+  // The number of shards is 2^shard_bits, each starting with 16 slots.
+  concurrent_hashmap(int shard_bits = 6)
+      : shards(1 << shard_bits), shard_bits(shard_bits) {
+    for (int i = 0; i < (int)shards.size(); i++) {
+      shards[i].table = new_table(16);
+      shards[i].seq = 0;
+      shards[i].locked = 0;
+      shards[i].size = shards[i].max_displacement = 0;
+    }
+  }
+
+  ~concurrent_hashmap() {
+    for (int i = 0; i < (int)shards.size(); i++) {
+      shards[i].retired.push_back(shards[i].table);
+      for (int j = 0; j < (int)shards[i].retired.size(); j++) {
+        delete[] shards[i].retired[j]->slots;
+        delete shards[i].retired[j];
+      }
+    }
+  }
+
+  // Returns true if the entry was inserted, or false if key was present, in
+  // which case its value is replaced by val if overwrite is set.
+  bool insert(const key_t &key, const val_t &val, bool overwrite = false) {
+    size_t h = Hash()(key);
+    shard &s = shard_of(h);
+    lock(s);
+    table_t *t = s.table;
+    for (size_t i = h & t->mask; t->slots[i].used; i = (i + 1) & t->mask) {
+      if (t->slots[i].key == key) {
+        if (overwrite) {
+          t->slots[i].val = val;
+        }
+        unlock(s);
+        return false;
+      }
+    }
+    if (4*(s.size + 1) > 3*(t->mask + 1)) {
+      grow(s);
+    }
+    place(s, key, val, h);
+    s.size++;
+    unlock(s);
+    return true;
+  }
+
+  bool remove(const key_t &key) {
+    size_t h = Hash()(key);
+    shard &s = shard_of(h);
+    lock(s);
+    table_t *t = s.table;
+    size_t i = h & t->mask;
+    while (t->slots[i].used && !(t->slots[i].key == key)) {
+      i = (i + 1) & t->mask;
+    }
+    bool found = t->slots[i].used;
+    if (found) {
+      for (size_t j = (i + 1) & t->mask; t->slots[j].used;
+           j = (j + 1) & t->mask) {
+        size_t home = Hash()(t->slots[j].key) & t->mask;
+        if (((j - home) & t->mask) >= ((j - i) & t->mask)) {
+          t->slots[i] = t->slots[j];
+          i = j;
+        }
+      }
+      t->slots[i].used = false;
+      s.size--;
+    }
+    unlock(s);
+    return found;
+  }
+
+  // Copies the value of key into val and returns true if key is present.
+  bool find(const key_t &key, val_t &val) {
+    size_t h = Hash()(key);
+    shard &s = shard_of(h);
+    for (;;) {
+      unsigned int seq = __atomic_load_n(&s.seq, __ATOMIC_ACQUIRE);
+      if (seq & 1) {
+        continue;
+      }
+      table_t *t = __atomic_load_n(&s.table, __ATOMIC_ACQUIRE);
+      bool found = false;
+      // A concurrent write may leave the run without an empty slot, so the
+      // probe is bounded by the capacity.
+      for (size_t i = h & t->mask, k = 0; k <= t->mask && t->slots[i].used;
+           i = (i + 1) & t->mask, k++) {
+        if (t->slots[i].key == key) {
+          val = t->slots[i].val;
+          found = true;
+          break;
+        }
+      }
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&s.seq, __ATOMIC_RELAXED) == seq) {
+        return found;
+      }
+    }
+  }
+
+  int shards_count() const {
+    return (int)shards.size();
+  }
+
+  // Sets the number of entries, the capacity, and the longest displacement of
+  // an entry since the last resize for shard i. The values may be slightly
+  // out of date under concurrent writes.
+  void shard_stats(int i, size_t &size, size_t &capacity,
+                   size_t &max_displacement) const {
+    const shard &s = shards[i];
+    size = s.size;
+    capacity = s.table->mask + 1;
+    max_displacement = s.max_displacement;
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+using namespace std;
+
+struct int_hash {
+  size_t operator()(long long k) const {
+    unsigned long long h = (unsigned long long)k;
+    h = (h ^ (h >> 33))*0xff51afd7ed558ccdULL;
+    h = (h ^ (h >> 33))*0xc4ceb9fe1a85ec53ULL;
+    return (size_t)(h ^ (h >> 33));
+  }
+};
+
+int main() {
+  // Each of these calls may come from a different thread.
+  concurrent_hashmap<long long, long long, int_hash> m(4);
+  for (long long i = 0; i < 100000; i++) {
+    assert(m.insert(i, i*i));
+  }
+  assert(!m.insert(5, 0) && m.insert(-1, 1));
+  assert(!m.insert(-1, 7, true));
+  long long v = 0;
+  assert(m.find(-1, v) && v == 7);
+  for (long long i = 0; i < 100000; i += 2) {
+    assert(m.remove(i));
+  }
+  for (long long i = 1; i < 100000; i += 2) {
+    assert(m.find(i, v) && v == i*i);
+    assert(!m.find(i - 1, v));
+  }
+  size_t total = 0;
+  for (int i = 0; i < m.shards_count(); i++) {
+    size_t size, capacity, displacement;
+    m.shard_stats(i, size, capacity, displacement);
+    assert(4*size <= 3*capacity);
+    total += size;
+  }
+  assert(total == 50001);
+  return 0;
+}
@@ -0,0 +1,532 @@
+/*
+
+Maintain a map, that is, a collection of key-value pairs such that each possible
+key appears at most once in the collection. This implementation requires an
+ordering on the set of possible keys defined by the < operator on the key type.
+A B+ tree is a search tree whose nodes each hold up to B keys in a sorted array,
+where B (here 32) is chosen so that a node spans a few cache lines. Entries are
+stored only in the leaves, which are linked in order of keys, while each inner
+node holds up to B separating keys and B + 1 children, the i-th child holding
+the keys from separator i - 1 (inclusive) to separator i (exclusive). The tree
+is thus only about log(n)/log(B) levels deep, with one or two cache misses per
+level rather than one per comparison as in a binary search tree.
+
+A node is searched by counting the keys less than the one sought, which takes a
+fixed sequence of comparisons without unpredictable branches. For int keys this
+is done four keys at a time with SSE2 instructions where available.
+
+- bplus_tree() constructs an empty map.
+- bplus_tree(lo, hi) constructs a map from a range of std::pair entries which
+  are sorted by strictly increasing keys. The tree is built bottom-up with every
+  node full, in a single pass over the range.
+- size() returns the size of the map.
+- empty() returns whether the map is empty.
+- insert(k, v) adds an entry with key k and value v to the map, returning true
+  if an new entry was added or false if the key already exists (in which case
+  the map is unchanged and the old value associated with the key is preserved).
+  A full node is split into two halves before the entry is added.
+- erase(k) removes the entry with key k from the map, returning true if the
+  removal was successful or false if the key to be removed was not found. Nodes
+  are not merged until they become empty, so that erasures never move entries
+  between nodes. A map shrunk by many erasures may be rebuilt with bulk loading.
+- find(k) returns a pointer to a const value associated with key k, or NULL if
+  the key was not found.
+- walk(f) calls the function f(k, v) on each entry of the map, in ascending
+  order of keys.
+- walk(lo, hi, f) calls f(k, v) on each entry with lo <= k <= hi in ascending
+  order of keys, following the links between leaves after finding the first.
+
+Time Complexity:
+- O(1) per call to the first constructor, size(), and empty().
+- O(n) per call to the second constructor, where n is the number of entries.
+- O(B log n/log B) per call to insert(), erase(), and find(), where n is the
+  number of entries currently in the map, with O(log n/log B) cache misses.
+- O(n) per call to walk(f), and O(B log n/log B + m) per call to walk(lo, hi, f)
+  where m is the number of entries reported.
+
+Space Complexity:
+- O(n) for storage of the map elements, two thirds of which are occupied on
+  average after random insertions, or all after bulk loading.
+- O(log n/log B) auxiliary stack space per call to insert() and erase(), and
+  O(1) auxiliary per call to all other operations.
+
+*/
+
+#include <cstdlib>  // NULL
+#include <utility>  // std::pair
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>  // _mm_cmpgt_epi32(), _mm_movemask_epi8(), ...
+#endif
+
+template<class K, class V> class bplus_tree {
+  static const int B = 32;
+
+  struct node_t {
+    int count;
+    bool leaf;
+    K keys[B];
+  };
+
+  struct leaf_t : node_t {
+    V values[B];
+    leaf_t *prev, *next;
+  };
+
+  struct inner_t : node_t {
+    node_t *child[B + 1];
+  };
+
+  node_t *root;
+  leaf_t *head;
+  int num_entries;
+
+  // Returns the number of keys in a[0..n) which are less than k.
+  template<class T>
+  static int count_less(const T *a, int n, const T &k) {
+    int res = 0;
+    for (int i = 0; i < n; i++) {
+      res += (a[i] < k);
+    }
+    return res;
+  }
+
+  // Returns the number of keys in a[0..n) which are not greater than k.
+  template<class T>
+  static int count_not_greater(const T *a, int n, const T &k) {
+    int res = 0;
+    for (int i = 0; i < n; i++) {
+      res += !(k < a[i]);
+    }
+    return res;
+  }
+
+#ifdef __SSE2__
+  // Each comparison sets all 4 bytes of a 32-bit lane, so the number of bits
+  // set in the byte mask is 4 times the number of keys satisfying it.
+  static int count_less(const int *a, int n, int k) {
+    __m128i key = _mm_set1_epi32(k);
+    int i = 0, bits = 0;
+    for (; i + 4 <= n; i += 4) {
+      __m128i g = _mm_loadu_si128((const __m128i*)(a + i));
+      bits += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi32(key, g)));
+    }
+    int res = bits/4;
+    for (; i < n; i++) {
+      res += (a[i] < k);
+    }
+    return res;
+  }
+
+  static int count_not_greater(const int *a, int n, int k) {
+    __m128i key = _mm_set1_epi32(k);
+    int i = 0, bits = 0;
+    for (; i + 4 <= n; i += 4) {
+      __m128i g = _mm_loadu_si128((const __m128i*)(a + i));
+      bits += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi32(g, key)));
+    }
+    int res = i - bits/4;
+    for (; i < n; i++) {
+      res += !(k < a[i]);
+    }
+    return res;
+  }
+#endif
+
+  static leaf_t* new_leaf() {
+    leaf_t *n = new leaf_t;
+    n->count = 0;
+    n->leaf = true;
+    n->prev = n->next = NULL;
+    return n;
+  }
+
+  static inner_t* new_inner() {
+    inner_t *n = new inner_t;
+    n->count = 0;
+    n->leaf = false;
+    return n;
+  }
+
+  // Returns the leaf which would hold key k.
+  leaf_t* find_leaf(const K &k) const {
+    node_t *n = root;
+    while (!n->leaf) {
+      inner_t *in = static_cast<inner_t*>(n);
+      n = in->child[count_not_greater(in->keys, in->count, k)];
+    }
+    return static_cast<leaf_t*>(n);
+  }
+
+  // Moves the upper half of a full leaf into a new leaf after it.
+  leaf_t* split(leaf_t *n) {
+    leaf_t *r = new_leaf();
+    r->count = B - B/2;
+    for (int i = 0; i < r->count; i++) {
+      r->keys[i] = n->keys[B/2 + i];
+      r->values[i] = n->values[B/2 + i];
+    }
+    n->count = B/2;
+    r->prev = n;
+    r->next = n->next;
+    if (n->next != NULL) {
+      n->next->prev = r;
+    }
+    n->next = r;
+    return r;
+  }
+
+  static void insert_at(leaf_t *n, int i, const K &k, const V &v) {
+    for (int j = n->count; j > i; j--) {
+      n->keys[j] = n->keys[j - 1];
+      n->values[j] = n->values[j - 1];
+    }
+    n->keys[i] = k;
+    n->values[i] = v;
+    n->count++;
+  }
+
+  static void insert_at(inner_t *n, int i, const K &sep, node_t *c) {
+    for (int j = n->count; j > i; j--) {
+      n->keys[j] = n->keys[j - 1];
+      n->child[j + 1] = n->child[j];
+    }
+    n->keys[i] = sep;
+    n->child[i + 1] = c;
+    n->count++;
+  }
+
+  // Inserts the entry into the subtree of n. If n is split, sets r to the new
+  // node holding its upper part and sep to the least key under r.
+  bool insert(node_t *n, const K &k, const V &v, K &sep, node_t *&r) {
+    r = NULL;
+    if (n->leaf) {
+      leaf_t *l = static_cast<leaf_t*>(n);
+      int i = count_less(l->keys, l->count, k);
+      if (i < l->count && !(k < l->keys[i])) {
+        return false;
+      }
+      if (l->count == B) {
+        leaf_t *s = split(l);
+        if (i > B/2) {
+          insert_at(s, i - B/2, k, v);
+        } else {
+          insert_at(l, i, k, v);
+        }
+        sep = s->keys[0];
+        r = s;
+      } else {
+        insert_at(l, i, k, v);
+      }
+      return true;
+    }
+    inner_t *in = static_cast<inner_t*>(n);
+    int i = count_not_greater(in->keys, in->count, k);
+    K child_sep;
+    node_t *child_r;
+    if (!insert(in->child[i], k, v, child_sep, child_r)) {
+      return false;
+    }
+    if (child_r == NULL) {
+      return true;
+    }
+    if (in->count < B) {
+      insert_at(in, i, child_sep, child_r);
+      return true;
+    }
+    // Split around the middle key, which moves up to the parent.
+    const int h = B/2;
+    inner_t *s = new_inner();
+    s->count = B - h - 1;
+    for (int j = 0; j < s->count; j++) {
+      s->keys[j] = in->keys[h + 1 + j];
+      s->child[j] = in->child[h + 1 + j];
+    }
+    s->child[s->count] = in->child[B];
+    sep = in->keys[h];
+    in->count = h;
+    if (i <= h) {
+      insert_at(in, i, child_sep, child_r);
+    } else {
+      insert_at(s, i - h - 1, child_sep, child_r);
+    }
+    r = s;
+    return true;
+  }
+
+  // Returns 0 if k is not under n, 1 if it was erased, or 2 if it was erased
+  // and n became empty, in which case n has been freed.
+  int erase(node_t *n, const K &k) {
+    if (n->leaf) {
+      leaf_t *l = static_cast<leaf_t*>(n);
+      int i = count_less(l->keys, l->count, k);
+      if (i == l->count || k < l->keys[i]) {
+        return 0;
+      }
+      for (int j = i + 1; j < l->count; j++) {
+        l->keys[j - 1] = l->keys[j];
+        l->values[j - 1] = l->values[j];
+      }
+      if (--l->count > 0) {
+        return 1;
+      }
+      if (l->prev != NULL) {
+        l->prev->next = l->next;
+      } else {
+        head = l->next;
+      }
+      if (l->next != NULL) {
+        l->next->prev = l->prev;
+      }
+      delete l;
+      return 2;
+    }
+    inner_t *in = static_cast<inner_t*>(n);
+    int i = count_not_greater(in->keys, in->count, k);
+    int res = erase(in->child[i], k);
+    if (res != 2) {
+      return res;
+    }
+    if (in->count == 0) {
+      delete in;
+      return 2;
+    }
+    // Remove the child along with the separator on one of its sides.
+    int s = (i > 0) ? i - 1 : 0;
+    for (int j = s + 1; j < in->count; j++) {
+      in->keys[j - 1] = in->keys[j];
+    }
+    for (int j = i + 1; j <= in->count; j++) {
+      in->child[j - 1] = in->child[j];
+    }
+    in->count--;
+    return 1;
+  }
+
+  static void clean_up(node_t *n) {
+    if (n->leaf) {
+      delete static_cast<leaf_t*>(n);
+      return;
+    }
+    inner_t *in = static_cast<inner_t*>(n);
+    for (int i = 0; i <= in->count; i++) {
+      clean_up(in->child[i]);
+    }
+    delete in;
+  }
+
+  bplus_tree(const bplus_tree &);
+  bplus_tree& operator=(const bplus_tree &);
+
+ public:
+  bplus_tree() {
+    root = head = new_leaf();
+    num_entries = 0;
+  }
+
+  template<class It> bplus_tree(It lo, It hi) {
+    root = head = new_leaf();
+    num_entries = 0;
+    std::vector<node_t*> level;
+    std::vector<K> mins;
+    for (leaf_t *l = head; lo != hi; ++lo) {
+      if (l->count == B) {
+        leaf_t *next = new_leaf();
+        next->prev = l;
+        l = l->next = next;
+      }
+      if (l->count == 0) {
+        level.push_back(l);
+        mins.push_back(lo->first);
+      }
+      l->keys[l->count] = lo->first;
+      l->values[l->count++] = lo->second;
+      num_entries++;
+    }
+    // Group each level into parents of B + 1 children until one node remains.
+    while (level.size() > 1) {
+      std::vector<node_t*> parents;
+      std::vector<K> parent_mins;
+      for (size_t i = 0; i < level.size(); i += B + 1) {
+        inner_t *p = new_inner();
+        p->child[0] = level[i];
+        for (size_t j = i + 1; j < level.size() && j < i + B + 1; j++) {
+          p->keys[p->count] = mins[j];
+          p->child[++p->count] = level[j];
+        }
+        parents.push_back(p);
+        parent_mins.push_back(mins[i]);
+      }
+      // Avoid an inner node with a single child by borrowing from the left.
+      inner_t *last = static_cast<inner_t*>(parents.back());
+      if (parents.size() > 1 && last->count == 0) {
+        inner_t *prev = static_cast<inner_t*>(parents[parents.size() - 2]);
+        last->child[1] = last->child[0];
+        last->keys[0] = parent_mins.back();
+        last->child[0] = prev->child[prev->count];
+        parent_mins.back() = mins[level.size() - 2];
+        last->count = 1;
+        prev->count--;
+      }
+      level.swap(parents);
+      mins.swap(parent_mins);
+    }
+    if (!level.empty()) {
+      root = level[0];
+    }
+  }
+
+  ~bplus_tree() {
+    clean_up(root);
+  }
+
+  int size() const {
+    return num_entries;
+  }
+
+  bool empty() const {
+    return num_entries == 0;
+  }
+
+  bool insert(const K &k, const V &v) {
+    K sep;
+    node_t *r;
+    if (!insert(root, k, v, sep, r)) {
+      return false;
+    }
+    if (r != NULL) {
+      inner_t *p = new_inner();
+      p->count = 1;
+      p->keys[0] = sep;
+      p->child[0] = root;
+      p->child[1] = r;
+      root = p;
+    }
+    num_entries++;
+    return true;
+  }
+
+  bool erase(const K &k) {
+    int res = erase(root, k);
+    if (res == 0) {
+      return false;
+    }
+    num_entries--;
+    if (res == 2) {
+      root = head = new_leaf();
+    }
+    while (!root->leaf && root->count == 0) {
+      inner_t *in = static_cast<inner_t*>(root);
+      root = in->child[0];
+      delete in;
+    }
+    return true;
+  }
+
+  const V* find(const K &k) const {
+    leaf_t *l = find_leaf(k);
+    int i = count_less(l->keys, l->count, k);
+    if (i < l->count && !(k < l->keys[i])) {
+      return &(l->values[i]);
+    }
+    return NULL;
+  }
+
+  template<class KVFunction> void walk(KVFunction f) const {
+    for (leaf_t *l = head; l != NULL; l = l->next) {
+      for (int i = 0; i < l->count; i++) {
+        f(l->keys[i], l->values[i]);
+      }
+    }
+  }
+
+  template<class KVFunction>
+  void walk(const K &lo, const K &hi, KVFunction f) const {
+    leaf_t *l = find_leaf(lo);
+    for (int i = count_less(l->keys, l->count, lo); l != NULL; l = l->next) {
+      for (; i < l->count; i++) {
+        if (hi < l->keys[i]) {
+          return;
+        }
+        f(l->keys[i], l->values[i]);
+      }
+      i = 0;
+    }
+  }
+};
+
+/*** Example Usage and Output:
+
+abcde
+bcde
+Range [20, 30]: 20 22 24 26 28 30
+
+***/
+
+#include <cassert>
+#include <iostream>
+#include <map>
+using namespace std;
+
+void printch(int k, char v) {
+  cout << v;
+}
+
+void printkey(int k, int v) {
+  cout << " " << k;
+}
+
+int main() {
+  {
+    bplus_tree<int, char> t;
+    t.insert(2, 'b');
+    t.insert(1, 'a');
+    t.insert(3, 'c');
+    t.insert(5, 'e');
+    assert(t.insert(4, 'd'));
+    assert(*t.find(4) == 'd');
+    assert(!t.insert(4, 'd'));
+    t.walk(printch);
+    cout << endl;
+    assert(t.erase(1));
+    assert(!t.erase(1));
+    assert(t.find(1) == NULL);
+    t.walk(printch);
+    cout << endl;
+  }
+  {
+    // Bulk load the even numbers below 2000000, then compare against std::map.
+    vector<pair<int, int> > entries;
+    for (int i = 0; i < 2000000; i += 2) {
+      entries.push_back(make_pair(i, -i));
+    }
+    bplus_tree<int, int> t(entries.begin(), entries.end());
+    map<int, int> m(entries.begin(), entries.end());
+    assert(t.size() == 1000000 && *t.find(123456) == -123456);
+    assert(t.find(123457) == NULL);
+    cout << "Range [20, 30]:";
+    t.walk(19, 30, printkey);
+    cout << endl;
+    for (int i = 0; i < 1000000; i++) {
+      int k = rand() % 2500000;
+      if (rand() % 2 == 0) {
+        assert(t.insert(k, k) == m.insert(make_pair(k, k)).second);
+      } else {
+        assert(t.erase(k) == (m.erase(k) == 1));
+      }
+    }
+    assert(t.size() == (int)m.size());
+    for (int i = 0; i < 2500000; i++) {
+      const int *v = t.find(i);
+      map<int, int>::iterator it = m.find(i);
+      assert((v == NULL) == (it == m.end()));
+      assert(v == NULL || *v == it->second);
+    }
+    // Erase everything, then reuse the emptied tree.
+    for (map<int, int>::iterator it = m.begin(); it != m.end(); ++it) {
+      assert(t.erase(it->first));
+    }
+    assert(t.empty() && t.insert(7, 7) && *t.find(7) == 7);
+  }
+  return 0;
+}
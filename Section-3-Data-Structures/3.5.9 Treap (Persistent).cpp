@@ -0,0 +1,325 @@
+/*
+
+Maintain a map, that is, a collection of key-value pairs such that each possible
+key appears at most once in the collection, while keeping old versions of the
+map available. This implementation requires an ordering on the set of possible
+keys defined by the < operator on the key type. The map is a treap (as in
+section 3.5.2) whose nodes may be shared between any number of versions, each
+node counting the versions and parent nodes which refer to it.
+
+Taking a snapshot merely shares the root. Before a version modifies a node on
+the path to a key, it makes the node unique: a node referred to only once is
+modified in place, while a shared node is replaced by a copy whose children
+gain a reference each (and so are copied in turn when reached). An update thus
+copies only the O(log n) nodes on its path which are shared with a snapshot,
+and no node reachable from another version is ever modified. A version may hence
+be read on one thread while a new version is written on another, provided each
+persistent_treap object is used by a single thread at a time. The reference
+counts are updated with the __atomic builtins of GCC and Clang, so that versions
+can be destroyed on any thread, freeing the nodes no other version refers to.
+
+- persistent_treap() constructs an empty map.
+- persistent_treap(t), the assignment operator, and snapshot() return a version
+  holding the current entries, which is unaffected by later modifications of
+  either version.
+- size() returns the size of the map.
+- empty() returns whether the map is empty.
+- insert(k, v) adds an entry with key k and value v to the map, returning true
+  if an new entry was added or false if the key already exists (in which case
+  the map is unchanged and the old value associated with the key is preserved).
+- erase(k) removes the entry with key k from the map, returning true if the
+  removal was successful or false if the key to be removed was not found.
+- find(k) returns a pointer to a const value associated with key k, or NULL if
+  the key was not found.
+- walk(f) calls the function f(k, v) on each entry of the map, in ascending
+  order of keys.
+- clear() removes all entries from the map.
+
+Time Complexity:
+- O(1) per call to the constructors, snapshot(), size(), and empty().
+- O(log n) on average per call to insert(), erase(), and find(), where n is the
+  number of entries currently in the map.
+- O(n) per call to walk(), and O(n) for the destructor, the assignment operator,
+  and clear() in the worst case, when no other version shares the nodes freed.
+
+Space Complexity:
+- O(n + u log n) on average for storage of all versions, where n is the number
+  of entries of the largest version and u is the number of updates made while
+  a snapshot was alive.
+- O(log n) auxiliary stack space on average per call to insert(), erase(),
+  walk(), and the destructor, and O(1) auxiliary for all other operations.
+
+*/
+
+#include <cstdlib>  // NULL, rand()
+
+template<class K, class V> class persistent_treap {
+  struct node_t {
+    K key;
+    V value;
+    node_t *left, *right;
+    int priority, refs;
+
+    node_t(const K &k, const V &v) {
+      key = k;
+      value = v;
+      left = right = NULL;
+      priority = (rand() & 0x7fff) | ((rand() & 0x7fff) << 15);
+      refs = 1;
+    }
+
+    // Copies n except for its reference count, which other threads may be
+    // modifying, taking a new reference to each child.
+    explicit node_t(const node_t *n) {
+      key = n->key;
+      value = n->value;
+      left = retain(n->left);
+      right = retain(n->right);
+      priority = n->priority;
+      refs = 1;
+    }
+  } *root;
+
+  int num_nodes;
+
+  static node_t* retain(node_t *n) {
+    if (n != NULL) {
+      __atomic_add_fetch(&n->refs, 1, __ATOMIC_RELAXED);
+    }
+    return n;
+  }
+
+  static void release(node_t *n) {
+    if (n != NULL && __atomic_sub_fetch(&n->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+      release(n->left);
+      release(n->right);
+      delete n;
+    }
+  }
+
+  // Replaces n by a copy if another version or node also refers to it, so that
+  // it may be modified.
+  static void make_unique(node_t *&n) {
+    if (__atomic_load_n(&n->refs, __ATOMIC_ACQUIRE) != 1) {
+      node_t *c = new node_t(n);
+      release(n);
+      n = c;
+    }
+  }
+
+  static void rotate_l(node_t *&n) {
+    make_unique(n->right);
+    node_t *tmp = n;
+    n = n->right;
+    tmp->right = n->left;
+    n->left = tmp;
+  }
+
+  static void rotate_r(node_t *&n) {
+    make_unique(n->left);
+    node_t *tmp = n;
+    n = n->left;
+    tmp->left = n->right;
+    n->right = tmp;
+  }
+
+  // Inserts a key known to be absent.
+  static void insert(node_t *&n, const K &k, const V &v) {
+    if (n == NULL) {
+      n = new node_t(k, v);
+      return;
+    }
+    make_unique(n);
+    if (k < n->key) {
+      insert(n->left, k, v);
+      if (n->left->priority < n->priority) {
+        rotate_r(n);
+      }
+    } else {
+      insert(n->right, k, v);
+      if (n->right->priority < n->priority) {
+        rotate_l(n);
+      }
+    }
+  }
+
+  // Erases a key known to be present.
+  static void erase(node_t *&n, const K &k) {
+    make_unique(n);
+    if (k < n->key) {
+      erase(n->left, k);
+    } else if (n->key < k) {
+      erase(n->right, k);
+    } else if (n->left != NULL && n->right != NULL) {
+      if (n->left->priority < n->right->priority) {
+        rotate_r(n);
+        erase(n->right, k);
+      } else {
+        rotate_l(n);
+        erase(n->left, k);
+      }
+    } else {
+      // The reference of n to its child passes to the parent of n.
+      node_t *tmp = (n->left != NULL) ? n->left : n->right;
+      delete n;
+      n = tmp;
+    }
+  }
+
+  template<class KVFunction>
+  static void walk(const node_t *n, KVFunction f) {
+    if (n != NULL) {
+      walk(n->left, f);
+      f(n->key, n->value);
+      walk(n->right, f);
+    }
+  }
+
+ public:
+  persistent_treap() {
+    root = NULL;
+    num_nodes = 0;
+  }
+
+  persistent_treap(const persistent_treap &t) {
+    root = retain(t.root);
+    num_nodes = t.num_nodes;
+  }
+
+  persistent_treap& operator=(const persistent_treap &t) {
+    node_t *old = root;
+    root = retain(t.root);
+    num_nodes = t.num_nodes;
+    release(old);
+    return *this;
+  }
+
+  ~persistent_treap() {
+    release(root);
+  }
+
+  persistent_treap snapshot() const {
+    return *this;
+  }
+
+  int size() const {
+    return num_nodes;
+  }
+
+  bool empty() const {
+    return root == NULL;
+  }
+
+  bool insert(const K &k, const V &v) {
+    if (find(k) != NULL) {
+      return false;
+    }
+    insert(root, k, v);
+    num_nodes++;
+    return true;
+  }
+
+  bool erase(const K &k) {
+    if (find(k) == NULL) {
+      return false;
+    }
+    erase(root, k);
+    num_nodes--;
+    return true;
+  }
+
+  const V* find(const K &k) const {
+    const node_t *n = root;
+    while (n != NULL) {
+      if (k < n->key) {
+        n = n->left;
+      } else if (n->key < k) {
+        n = n->right;
+      } else {
+        return &(n->value);
+      }
+    }
+    return NULL;
+  }
+
+  template<class KVFunction> void walk(KVFunction f) const {
+    walk(root, f);
+  }
+
+  void clear() {
+    release(root);
+    root = NULL;
+    num_nodes = 0;
+  }
+};
+
+/*** Example Usage and Output:
+
+abcde
+bcde
+abcde
+
+***/
+
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <vector>
+using namespace std;
+
+void printch(int k, char v) {
+  cout << v;
+}
+
+int main() {
+  {
+    persistent_treap<int, char> t;
+    t.insert(2, 'b');
+    t.insert(1, 'a');
+    t.insert(3, 'c');
+    t.insert(5, 'e');
+    assert(t.insert(4, 'd'));
+    assert(*t.find(4) == 'd');
+    assert(!t.insert(4, 'd'));
+    persistent_treap<int, char> old = t.snapshot();
+    t.walk(printch);
+    cout << endl;
+    assert(t.erase(1));
+    assert(!t.erase(1));
+    assert(t.find(1) == NULL && *old.find(1) == 'a');
+    t.walk(printch);
+    cout << endl;
+    old.walk(printch);
+    cout << endl;
+  }
+  {
+    // Keep a snapshot after every 1000 random updates, then check each one
+    // against a copy of std::map taken at the same time.
+    persistent_treap<int, int> t;
+    map<int, int> m;
+    vector<persistent_treap<int, int> > versions;
+    vector<map<int, int> > expected;
+    for (int i = 0; i < 100000; i++) {
+      int k = rand() % 5000;
+      if (rand() % 3 == 0) {
+        assert(t.erase(k) == (m.erase(k) == 1));
+      } else {
+        assert(t.insert(k, i) == m.insert(make_pair(k, i)).second);
+      }
+      if (i % 1000 == 0) {
+        versions.push_back(t.snapshot());
+        expected.push_back(m);
+      }
+    }
+    for (int i = 0; i < (int)versions.size(); i++) {
+      assert(versions[i].size() == (int)expected[i].size());
+      for (int k = 0; k < 5000; k++) {
+        const int *v = versions[i].find(k);
+        map<int, int>::iterator it = expected[i].find(k);
+        assert((v == NULL) == (it == expected[i].end()));
+        assert(v == NULL || *v == it->second);
+      }
+    }
+  }
+  return 0;
+}
@@ -8,197 +8,407 @@ See: http://wcipeg.com/wiki/Heavy-light_decomposition
 and: http://blog.anudeep2011.com/heavy-light-decomposition/
 To support dynamic adding and removal of edges, see link/cut tree.
 
-Note: The adjacency list tree[] that is passed to the constructor must
-not be changed afterwards in order for modify() and query() to work.
+The decomposition is computed without recursion in two passes. The
+first visits the nodes in breadth-first order from node 0, and then in
+reverse order computes the subtree sizes and the heavy child (the child
+with the largest subtree) of each node. The second numbers the nodes so
+that every heavy path occupies consecutive positions of a single base
+array, walking down each path from its top and deferring the light
+children onto an explicit stack. A path between two nodes thus covers
+O(log N) contiguous ranges of the base array, which is stored in the
+bottom-up segment tree of section 3.3.3.
 
-Time Complexity: O(N) for the constructor and O(log N) in the worst
-case for both modify() and query(), where N is the number of nodes.
+The operations are defined by the template argument Policy, as in the
+segment trees of section 3.3 (any policy from there may be used), where
+join_values() must be commutative, since the ranges of a path are not
+joined in order along the path. The default policy defines "max" queries
+and "add" updates. query(paths, res) answers a batch of path queries,
+pushing down all pending deltas of the segment tree only once.
+
+Note: The adjacency list tree[] that is passed to the constructor is
+only read by the constructor.
+
+Time Complexity: O(N) for the constructor, and O(log N (B + log N)) in
+the worst case for both modify() and query(), where N is the number of
+nodes and B = 16 is the block size of the segment tree. A batch of Q
+path queries takes O(N/B + Q log N (B + log N)).
 
 Space Complexity: O(N) on the number of nodes in the tree.
 
 */
 
-#include <algorithm> /* std::max(), std::min() */
-#include <climits>   /* INT_MIN */
+#include <algorithm> /* std::min(), std::swap() */
+#include <limits>    /* std::numeric_limits */
+#include <utility>   /* std::make_pair(), std::pair */
 #include <vector>
 
-template<class T> class heavy_light {
-  //true if you want values on edges, false if you want values on nodes
-  static const bool VALUES_ON_EDGES = true;
+template<class T> struct max_add_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return -std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? b : a; }
 
-  //Modify the following 6 functions to implement your custom
-  //operations on the tree. This implements the Add/Max operations.
-  //Operations like Add/Sum, Set/Max can also be implemented.
-  static inline T modify_op(const T & x, const T & y) {
-    return x + y;
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return v + d;
   }
 
-  static inline T query_op(const T & x, const T & y) {
-    return std::max(x, y);
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d1 + d2;
   }
+};
 
-  static inline T delta_on_segment(const T & delta, int seglen) {
-    if (delta == null_delta()) return null_delta();
-    //Here you must write a fast equivalent of following slow code:
-    //  T result = delta;
-    //  for (int i = 1; i < seglen; i++) result = query_op(result, delta);
-    //  return result;
-    return delta;
-  }
+// The bottom-up segment tree of section 3.3.3, without at() and the range
+// constructor.
+template<class T, class Policy> class segment_tree {
+  typedef typename Policy::delta_t delta_t;
 
-  static inline T init_value() { return 0; }
-  static inline T null_delta() { return 0; }
-  static inline T null_value() { return INT_MIN; }
+  static const int BLOCK = 16;
 
-  static inline T join_value_with_delta(const T & v, const T & delta) {
-    return delta == null_delta() ? v : modify_op(v, delta);
+  int len, levels, leaves;
+  std::vector<T> elem, value;
+  std::vector<delta_t> delta;
+  std::vector<char> pending;
+  std::vector<int> count;  // The number of array values under each node.
+
+  void apply(int k, const delta_t &d) {
+    value[k] = Policy::join_value_with_delta(value[k], d, count[k]);
+    delta[k] = pending[k] ? Policy::join_deltas(delta[k], d) : d;
+    pending[k] = true;
   }
 
-  static T join_deltas(const T & delta1, const T & delta2) {
-    if (delta1 == null_delta()) return delta2;
-    if (delta2 == null_delta()) return delta1;
-    return modify_op(delta1, delta2);
+  void push(int k) {
+    if (pending[k]) {
+      if (count[2*k] > 0) {
+        apply(2*k, delta[k]);
+      }
+      if (count[2*k + 1] > 0) {
+        apply(2*k + 1, delta[k]);
+      }
+      pending[k] = false;
+    }
   }
 
-  int counter, paths;
-  std::vector<int> *adj;
-  std::vector<std::vector<T> > value, delta;
-  std::vector<std::vector<int> > len;
-  std::vector<int> size, parent, tin, tout;
-  std::vector<int> path, pathlen, pathpos, pathroot;
+  void pull(int k) {
+    if (count[2*k + 1] > 0) {
+      value[k] = Policy::join_values(value[2*k], value[2*k + 1]);
+    } else {
+      value[k] = value[2*k];
+    }
+  }
 
-  void precompute_dfs(int u, int p) {
-    tin[u] = counter++;
-    parent[u] = p;
-    size[u] = 1;
-    for (int j = 0, v; j < (int)adj[u].size(); j++) {
-      if ((v = adj[u][j]) == p) continue;
-      precompute_dfs(v, u);
-      size[u] += size[v];
+  // Pushes the deltas of all proper ancestors of node k, from the root down.
+  void push_path(int k) {
+    for (int i = levels; i > 0; i--) {
+      push(k >> i);
     }
-    tout[u] = counter++;
   }
 
-  int new_path(int u) {
-    pathroot[paths] = u;
-    return paths++;
+  void pull_path(int k) {
+    for (k >>= 1; k > 0; k >>= 1) {
+      pull(k);
+    }
+  }
+
+  // Applies the pending delta of leaf b to the values of block b.
+  void push_block(int b) {
+    int k = leaves + b;
+    if (pending[k]) {
+      for (int i = b*BLOCK, hi = std::min(len, i + BLOCK); i < hi; i++) {
+        elem[i] = Policy::join_value_with_delta(elem[i], delta[k], 1);
+      }
+      pending[k] = false;
+    }
   }
 
-  void build_paths(int u, int path) {
-    this->path[u] = path;
-    pathpos[u] = pathlen[path]++;
-    for (int j = 0, v; j < (int)adj[u].size(); j++) {
-      if ((v = adj[u][j]) == parent[u]) continue;
-      build_paths(v, 2*size[v] >= size[u] ? path : new_path(v));
+  T reduce(int lo, int hi) const {
+    T res = elem[lo];
+    for (int i = lo + 1; i <= hi; i++) {
+      res = Policy::join_values(res, elem[i]);
     }
+    return res;
   }
 
-  inline T join_value_with_delta0(int path, int i) {
-    return join_value_with_delta(value[path][i],
-              delta_on_segment(delta[path][i], len[path][i]));
+  void pull_block(int b) {
+    value[leaves + b] = reduce(b*BLOCK, std::min(len, (b + 1)*BLOCK) - 1);
   }
 
-  void push_delta(int path, int i) {
-    int d = 0;
-    while ((i >> d) > 0) d++;
-    for (d -= 2; d >= 0; d--) {
-      int x = i >> d;
-      value[path][x >> 1] = join_value_with_delta0(path, x >> 1);
-      delta[path][x] = join_deltas(delta[path][x], delta[path][x >> 1]);
-      delta[path][x ^ 1] = join_deltas(delta[path][x ^ 1], delta[path][x >> 1]);
-      delta[path][x >> 1] = null_delta();
+  void init() {
+    int blocks = (len + BLOCK - 1)/BLOCK;
+    for (levels = 0, leaves = 1; leaves < blocks; levels++) {
+      leaves *= 2;
+    }
+    value.resize(2*leaves);
+    delta.resize(2*leaves);
+    pending.assign(2*leaves, false);
+    count.assign(2*leaves, 0);
+    for (int b = 0; b < blocks; b++) {
+      count[leaves + b] = std::min(len, (b + 1)*BLOCK) - b*BLOCK;
+      pull_block(b);
+    }
+    for (int k = leaves - 1; k > 0; k--) {
+      count[k] = count[2*k] + count[2*k + 1];
+      if (count[2*k] > 0) {
+        pull(k);
+      }
     }
   }
 
-  T query(int path, int a, int b) {
-    push_delta(path, a += value[path].size() >> 1);
-    push_delta(path, b += value[path].size() >> 1);
-    T res = null_value();
-    for (; a <= b; a = (a + 1) >> 1, b = (b - 1) >> 1) {
-      if ((a & 1) != 0)
-        res = query_op(res, join_value_with_delta0(path, a));
-      if ((b & 1) == 0)
-        res = query_op(res, join_value_with_delta0(path, b));
+  // Returns the join over the blocks from bl to br, inclusive.
+  T query_blocks(int bl, int br, bool push_paths) {
+    int l = leaves + bl, r = leaves + br + 1;
+    if (push_paths) {
+      for (int i = levels; i > 0; i--) {
+        if (((l >> i) << i) != l) {
+          push(l >> i);
+        }
+        if (((r >> i) << i) != r) {
+          push((r - 1) >> i);
+        }
+      }
     }
-    return res;
+    // A commutative join needs no separate accumulator for the right side.
+    T left = Policy::identity(), right = Policy::identity();
+    for (; l < r; l >>= 1, r >>= 1) {
+      if (l & 1) {
+        left = Policy::join_values(left, value[l++]);
+      }
+      if (r & 1) {
+        r--;
+        if (Policy::commutative) {
+          left = Policy::join_values(left, value[r]);
+        } else {
+          right = Policy::join_values(value[r], right);
+        }
+      }
+    }
+    return Policy::commutative ? left : Policy::join_values(left, right);
   }
 
-  void modify(int path, int a, int b, const T & delta) {
-    push_delta(path, a += value[path].size() >> 1);
-    push_delta(path, b += value[path].size() >> 1);
-    int ta = -1, tb = -1;
-    for (; a <= b; a = (a + 1) >> 1, b = (b - 1) >> 1) {
-      if ((a & 1) != 0) {
-        this->delta[path][a] = join_deltas(this->delta[path][a], delta);
-        if (ta == -1) ta = a;
+  void update_blocks(int bl, int br, const delta_t &d) {
+    int l0 = leaves + bl, r0 = leaves + br + 1;
+    for (int i = levels; i > 0; i--) {
+      if (((l0 >> i) << i) != l0) {
+        push(l0 >> i);
+      }
+      if (((r0 >> i) << i) != r0) {
+        push((r0 - 1) >> i);
+      }
+    }
+    for (int l = l0, r = r0; l < r; l >>= 1, r >>= 1) {
+      if (l & 1) {
+        apply(l++, d);
       }
-      if ((b & 1) == 0) {
-        this->delta[path][b] = join_deltas(this->delta[path][b], delta);
-        if (tb == -1) tb = b;
+      if (r & 1) {
+        apply(--r, d);
       }
     }
-    for (int i = ta; i > 1; i >>= 1)
-      value[path][i >> 1] = query_op(join_value_with_delta0(path, i),
-                                     join_value_with_delta0(path, i ^ 1));
-    for (int i = tb; i > 1; i >>= 1)
-      value[path][i >> 1] = query_op(join_value_with_delta0(path, i),
-                                     join_value_with_delta0(path, i ^ 1));
+    for (int i = 1; i <= levels; i++) {
+      if (((l0 >> i) << i) != l0) {
+        pull(l0 >> i);
+      }
+      if (((r0 >> i) << i) != r0) {
+        pull((r0 - 1) >> i);
+      }
+    }
+  }
+
+  // Returns the join of the values from lo to hi within block b.
+  T query_partial(int b, int lo, int hi, bool push_paths) {
+    if (push_paths) {
+      push_path(leaves + b);
+    }
+    push_block(b);
+    return reduce(lo, hi);
+  }
+
+  void update_partial(int b, int lo, int hi, const delta_t &d) {
+    push_path(leaves + b);
+    push_block(b);
+    for (int i = lo; i <= hi; i++) {
+      elem[i] = Policy::join_value_with_delta(elem[i], d, 1);
+    }
+    pull_block(b);
+    pull_path(leaves + b);
+  }
+
+  // Splits [lo, hi] into a partial block at each end and the whole blocks from
+  // bl to br in between, which may be empty (bl > br).
+  void split(int lo, int hi, int &bl, int &br) const {
+    bl = (lo % BLOCK == 0) ? lo/BLOCK : lo/BLOCK + 1;
+    br = (hi == len - 1 || hi % BLOCK == BLOCK - 1) ? hi/BLOCK : hi/BLOCK - 1;
+  }
+
+  T query(int lo, int hi, bool push_paths) {
+    if (lo/BLOCK == hi/BLOCK) {
+      return query_partial(lo/BLOCK, lo, hi, push_paths);
+    }
+    int bl, br;
+    split(lo, hi, bl, br);
+    T res = Policy::identity();
+    if (lo < bl*BLOCK) {
+      res = query_partial(lo/BLOCK, lo, bl*BLOCK - 1, push_paths);
+    }
+    if (bl <= br) {
+      res = Policy::join_values(res, query_blocks(bl, br, push_paths));
+    }
+    if ((br + 1)*BLOCK <= hi) {
+      res = Policy::join_values(res, query_partial(hi/BLOCK, (br + 1)*BLOCK, hi,
+                                           push_paths));
+    }
+    return res;
+  }
+
+ public:
+  segment_tree(int n, const T &v = T()) : len(n), elem(n, v) {
+    init();
+  }
+
+  int size() const {
+    return len;
+  }
+
+  T query(int lo, int hi) {
+    return query(lo, hi, true);
   }
 
-  inline bool is_ancestor(int p, int ch) {
-    return tin[p] <= tin[ch] && tout[ch] <= tout[p];
+  void query(const std::vector<std::pair<int, int> > &ranges,
+             std::vector<T> &res) {
+    for (int k = 1; k < leaves; k++) {
+      push(k);
+    }
+    res.resize(ranges.size());
+    for (int j = 0; j < (int)ranges.size(); j++) {
+      res[j] = query(ranges[j].first, ranges[j].second, false);
+    }
+  }
+
+  void update(int i, const delta_t &d) {
+    update(i, i, d);
+  }
+
+  void update(int lo, int hi, const delta_t &d) {
+    if (lo/BLOCK == hi/BLOCK) {
+      update_partial(lo/BLOCK, lo, hi, d);
+      return;
+    }
+    int bl, br;
+    split(lo, hi, bl, br);
+    if (lo < bl*BLOCK) {
+      update_partial(lo/BLOCK, lo, bl*BLOCK - 1, d);
+    }
+    if ((br + 1)*BLOCK <= hi) {
+      update_partial(hi/BLOCK, (br + 1)*BLOCK, hi, d);
+    }
+    if (bl <= br) {
+      update_blocks(bl, br, d);
+    }
+  }
+};
+
+template<class T, class Policy = max_add_policy<T> > class heavy_light {
+  typedef typename Policy::delta_t delta_t;
+  typedef char commutative_policy_required[Policy::commutative ? 1 : -1];
+
+  //true if you want values on edges, false if you want values on nodes
+  static const bool VALUES_ON_EDGES = true;
+
+  std::vector<int> parent, depth, head, pos;
+  std::vector<std::pair<int, int> > ranges;
+  segment_tree<T, Policy> seg;
+
+  //appends to r the ranges of positions covering the path from a to b
+  void path_ranges(int a, int b, std::vector<std::pair<int, int> > &r) {
+    for (; head[a] != head[b]; a = parent[head[a]]) {
+      if (depth[head[a]] < depth[head[b]]) std::swap(a, b);
+      r.push_back(std::make_pair(pos[head[a]], pos[a]));
+    }
+    if (depth[a] > depth[b]) std::swap(a, b);
+    if (!VALUES_ON_EDGES || a != b)
+      r.push_back(std::make_pair(pos[a] + VALUES_ON_EDGES, pos[b]));
   }
 
  public:
-  heavy_light(int N, std::vector<int> tree[]): size(N), parent(N),
-   tin(N), tout(N), path(N), pathlen(N), pathpos(N), pathroot(N) {
-    adj = tree;
-    counter = paths = 0;
-    precompute_dfs(0, -1);
-    build_paths(0, new_path(0));
-    value.resize(paths);
-    delta.resize(paths);
-    len.resize(paths);
-    for (int i = 0; i < paths; i++) {
-      int m = pathlen[i];
-      value[i].assign(2*m, init_value());
-      delta[i].assign(2*m, null_delta());
-      len[i].assign(2*m, 1);
-      for (int j = 2*m - 1; j > 1; j -= 2) {
-        value[i][j >> 1] = query_op(value[i][j], value[i][j ^ 1]);
-        len[i][j >> 1] = len[i][j] + len[i][j ^ 1];
+  heavy_light(int N, std::vector<int> tree[], const T & v = T())
+   : parent(N, -1), depth(N, 0), head(N), pos(N), seg(N, v) {
+    std::vector<int> order(1, 0), heavy(N, -1), size(N, 1);
+    order.reserve(N);
+    for (int i = 0; i < (int)order.size(); i++) {
+      int u = order[i];
+      for (int j = 0, v; j < (int)tree[u].size(); j++) {
+        if ((v = tree[u][j]) == parent[u]) continue;
+        parent[v] = u;
+        depth[v] = depth[u] + 1;
+        order.push_back(v);
+      }
+    }
+    for (int i = N - 1; i > 0; i--) {
+      int u = order[i], p = parent[u];
+      size[p] += size[u];
+      if (heavy[p] == -1 || size[u] > size[heavy[p]]) heavy[p] = u;
+    }
+    std::vector<int> &stack = order;
+    stack.assign(1, 0);
+    for (int counter = 0; !stack.empty(); ) {
+      int h = stack.back();
+      stack.pop_back();
+      for (int u = h; u != -1; u = heavy[u]) {
+        head[u] = h;
+        pos[u] = counter++;
+        for (int j = 0, v; j < (int)tree[u].size(); j++) {
+          if ((v = tree[u][j]) != parent[u] && v != heavy[u])
+            stack.push_back(v);
+        }
       }
     }
   }
 
   T query(int a, int b) {
-    T res = null_value();
-    for (int root; !is_ancestor(root = pathroot[path[a]], b); a = parent[root])
-      res = query_op(res, query(path[a], 0, pathpos[a]));
-    for (int root; !is_ancestor(root = pathroot[path[b]], a); b = parent[root])
-      res = query_op(res, query(path[b], 0, pathpos[b]));
-    if (VALUES_ON_EDGES && a == b) return res;
-    return query_op(res, query(path[a], std::min(pathpos[a], pathpos[b]) +
-                            VALUES_ON_EDGES, std::max(pathpos[a], pathpos[b])));
-  }
-
-  void modify(int a, int b, const T & delta) {
-    for (int root; !is_ancestor(root = pathroot[path[a]], b); a = parent[root])
-      modify(path[a], 0, pathpos[a], delta);
-    for (int root; !is_ancestor(root = pathroot[path[b]], a); b = parent[root])
-      modify(path[b], 0, pathpos[b], delta);
-    if (VALUES_ON_EDGES && a == b) return;
-    modify(path[a], std::min(pathpos[a], pathpos[b]) + VALUES_ON_EDGES,
-            std::max(pathpos[a], pathpos[b]), delta);
+    ranges.clear();
+    path_ranges(a, b, ranges);
+    T res = Policy::identity();
+    for (int i = 0; i < (int)ranges.size(); i++)
+      res = Policy::join_values(res, seg.query(ranges[i].first,
+                                               ranges[i].second));
+    return res;
+  }
+
+  //sets res[j] to query(paths[j].first, paths[j].second) for each j
+  void query(const std::vector<std::pair<int, int> > & paths,
+             std::vector<T> & res) {
+    std::vector<int> start(paths.size() + 1);
+    ranges.clear();
+    for (int j = 0; j < (int)paths.size(); j++) {
+      start[j] = ranges.size();
+      path_ranges(paths[j].first, paths[j].second, ranges);
+    }
+    start[paths.size()] = ranges.size();
+    std::vector<T> values;
+    seg.query(ranges, values);
+    res.assign(paths.size(), Policy::identity());
+    for (int j = 0; j < (int)paths.size(); j++)
+      for (int i = start[j]; i < start[j + 1]; i++)
+        res[j] = Policy::join_values(res[j], values[i]);
+  }
+
+  void modify(int a, int b, const delta_t & delta) {
+    ranges.clear();
+    path_ranges(a, b, ranges);
+    for (int i = 0; i < (int)ranges.size(); i++)
+      seg.update(ranges[i].first, ranges[i].second, delta);
   }
 };
 
 /*** Example Usage ***/
 
+#include <cassert>
+#include <climits>  /* INT_MAX */
+#include <cstdlib>  /* rand() */
 #include <iostream>
 using namespace std;
 
-const int MAXN = 1000;
+const int MAXN = 1000000;
 vector<int> adj[MAXN];
 
 /*
@@ -226,5 +436,54 @@ int main() {
   cout << hld.query(2, 4) << "\n"; //30
   hld.modify(3, 4, 50); //w[every edge from 3 to 4] += 50
   cout << hld.query(1, 4) << "\n"; //80
+
+  //random trees checked against walking the paths naively
+  for (int n = 2; n <= 300; n += 37) {
+    vector<int> par(n, -1), dep(n, 0), w(n, 0);
+    for (int i = 0; i < n; i++) adj[i].clear();
+    for (int i = 1; i < n; i++) {
+      par[i] = rand() % i;
+      dep[i] = dep[par[i]] + 1;
+      adj[i].push_back(par[i]);
+      adj[par[i]].push_back(i);
+    }
+    heavy_light<int> h(n, adj);
+    for (int it = 0; it < 300; it++) {
+      int a = rand() % n, b = rand() % n, d = rand() % 100 - 50;
+      for (int x = a, y = b; x != y; ) {
+        if (dep[x] < dep[y]) swap(x, y);
+        w[x] += d;
+        x = par[x];
+      }
+      h.modify(a, b, d);
+      vector<pair<int, int> > paths;
+      vector<int> expected;
+      for (int j = 0; j < 5; j++) {
+        int x = rand() % n, y = rand() % n, m = -INT_MAX;
+        paths.push_back(make_pair(x, y));
+        while (x != y) {
+          if (dep[x] < dep[y]) swap(x, y);
+          m = max(m, w[x]);
+          x = par[x];
+        }
+        expected.push_back(m);
+        assert(h.query(paths[j].first, paths[j].second) == m);
+      }
+      vector<int> res;
+      h.query(paths, res);
+      assert(res == expected);
+    }
+  }
+
+  //a path of 10^6 nodes, which is too deep for a recursive decomposition
+  for (int i = 0; i < MAXN; i++) adj[i].clear();
+  for (int i = 1; i < MAXN; i++) {
+    adj[i - 1].push_back(i);
+    adj[i].push_back(i - 1);
+  }
+  heavy_light<int> chain(MAXN, adj);
+  chain.modify(0, MAXN - 1, 1);
+  chain.modify(MAXN/2, MAXN/2 + 1, 5);
+  assert(chain.query(MAXN - 1, 0) == 6 && chain.query(0, MAXN/2) == 1);
   return 0;
 }
@@ -0,0 +1,367 @@
+/*
+
+Description: Given a forest of N nodes numbered from 0 to N - 1, each
+with an associated value, maintain the forest under the linking and
+cutting of edges while supporting queries and modifications of the
+values on the path between pairs of nodes, as in the link/cut tree of
+the previous section. This version allocates no nodes: the splay trees
+are stored as parallel arrays indexed by node (parent, left and right
+children, values, and pending deltas), with index 0 reserved as a null
+node whose subtree is empty, so that no operation tests for null links.
+Splaying first pushes the pending deltas and reversals down the path
+from the root of the splay tree by a loop over an explicit stack, and
+then rotates without recursion.
+
+The operations are defined by the template argument Policy, as in the
+segment trees of section 3.3 (any policy from there may be used), where
+join_values() must be commutative, since rerooting a tree reverses the
+order of the paths through it. The default policy defines "max" queries
+and "add" updates.
+
+query(paths, res) and cut(edges) process a batch of operations, sorting
+them by their first node so that the tree is rerooted at each distinct
+first node only once, while link(edges) simply links the edges in order.
+
+Time Complexity: O(N) for the constructor, and O(log N) amortized for
+connected(), link(), cut(), modify(), and query(). A batch of Q
+operations takes O(Q log Q + Q log N) amortized.
+
+Space Complexity: O(N) on the number of nodes in the forest, and O(Q)
+auxiliary for a batch of Q operations.
+
+*/
+
+#include <algorithm> /* std::sort(), std::swap() */
+#include <limits>    /* std::numeric_limits */
+#include <stdexcept> /* std::runtime_error() */
+#include <utility>   /* std::pair */
+#include <vector>
+
+template<class T> struct max_add_policy {
+  typedef T delta_t;
+  static const bool commutative = true;
+  static T identity() { return -std::numeric_limits<T>::max(); }
+  static T join_repeated(const T &v, long long n) { return v; }
+  static T join_values(const T &a, const T &b) { return a < b ? b : a; }
+
+  static T join_value_with_delta(const T &v, const delta_t &d,
+                                  long long len) {
+    return v + d;
+  }
+
+  static delta_t join_deltas(const delta_t &d1, const delta_t &d2) {
+    return d1 + d2;
+  }
+};
+
+template<class T, class Policy = max_add_policy<T> > class linkcut_tree {
+  typedef typename Policy::delta_t delta_t;
+  typedef char commutative_policy_required[Policy::commutative ? 1 : -1];
+
+  //node i of the forest is index i + 1, and index 0 is the null node
+  std::vector<int> parent, child[2], size, stack;
+  std::vector<T> value, subtree_value;
+  std::vector<delta_t> delta;
+  std::vector<char> pending, rev;
+
+  bool is_root(int x) const { //is x the root of a splay tree?
+    int p = parent[x];
+    return child[0][p] != x && child[1][p] != x;
+  }
+
+  void apply(int x, const delta_t & d) {
+    value[x] = Policy::join_value_with_delta(value[x], d, 1);
+    subtree_value[x] = Policy::join_value_with_delta(subtree_value[x], d,
+                                                     size[x]);
+    delta[x] = pending[x] ? Policy::join_deltas(delta[x], d) : d;
+    pending[x] = true;
+  }
+
+  void reverse(int x) {
+    std::swap(child[0][x], child[1][x]);
+    rev[x] = !rev[x];
+  }
+
+  void push(int x) {
+    for (int d = 0; d < 2; d++) {
+      int c = child[d][x];
+      if (c == 0) continue;
+      if (rev[x]) reverse(c);
+      if (pending[x]) apply(c, delta[x]);
+    }
+    rev[x] = pending[x] = false;
+  }
+
+  void pull(int x) {
+    int l = child[0][x], r = child[1][x];
+    size[x] = size[l] + 1 + size[r];
+    subtree_value[x] = Policy::join_values(
+        Policy::join_values(subtree_value[l], value[x]), subtree_value[r]);
+  }
+
+  void rotate(int x) {
+    int p = parent[x], g = parent[p], d = (child[1][p] == x);
+    if (!is_root(p)) child[child[1][g] == p][g] = x;
+    parent[x] = g;
+    child[d][p] = child[!d][x];
+    parent[child[!d][x]] = p;
+    child[!d][x] = p;
+    parent[p] = x;
+    pull(p);
+    pull(x);
+  }
+
+  void splay(int x) {
+    int top = 0;
+    stack[top++] = x;
+    for (int y = x; !is_root(y); y = parent[y]) stack[top++] = parent[y];
+    while (top > 0) push(stack[--top]);
+    while (!is_root(x)) {
+      int p = parent[x], g = parent[p];
+      if (!is_root(p))
+        rotate((child[0][p] == x) == (child[0][g] == p) ? p : x);
+      rotate(x);
+    }
+  }
+
+  //makes the path from the root of x's tree to x preferred, and x the
+  //root of its splay tree, with the rest of the path on its left
+  void access(int x) {
+    for (int y = x, last = 0; y != 0; last = y, y = parent[y]) {
+      splay(y);
+      child[1][y] = last;
+      pull(y);
+    }
+    splay(x);
+  }
+
+  void evert(int x) { //makes x the root of its tree
+    access(x);
+    reverse(x);
+  }
+
+  int find_root(int x) {
+    access(x);
+    for (push(x); child[0][x] != 0; push(x)) x = child[0][x];
+    splay(x);
+    return x;
+  }
+
+  int index(int i) const {
+    if (i < 0 || i + 1 >= (int)parent.size())
+      throw std::runtime_error("Error: node does not exist in forest.");
+    return i + 1;
+  }
+
+  //cuts the edge (r, b) where r has been everted
+  void cut_from_root(int r, int b) {
+    access(b);
+    if (child[0][b] != r || child[1][r] != 0)
+      throw std::runtime_error("Error: edge (a, b) does not exist.");
+    child[0][b] = parent[r] = 0;
+    pull(b);
+  }
+
+  //sorts the positions of pairs by their first node into order
+  static void sort_by_first(const std::vector<std::pair<int, int> > & pairs,
+                            std::vector<std::pair<int, int> > & order) {
+    order.resize(pairs.size());
+    for (int j = 0; j < (int)pairs.size(); j++)
+      order[j] = std::make_pair(pairs[j].first, j);
+    std::sort(order.begin(), order.end());
+  }
+
+  void init(int N) {
+    parent.assign(N + 1, 0);
+    child[0].assign(N + 1, 0);
+    child[1].assign(N + 1, 0);
+    size.assign(N + 1, 1);
+    stack.resize(N + 1);
+    value.assign(N + 1, Policy::identity());
+    subtree_value.assign(N + 1, Policy::identity());
+    delta.resize(N + 1);
+    pending.assign(N + 1, false);
+    rev.assign(N + 1, false);
+    size[0] = 0;
+  }
+
+ public:
+  linkcut_tree(int N, const T & v = T()) {
+    init(N);
+    for (int i = 1; i <= N; i++) value[i] = subtree_value[i] = v;
+  }
+
+  template<class It> linkcut_tree(It lo, It hi) {
+    init((int)(hi - lo));
+    for (int i = 1; lo != hi; ++lo, i++) value[i] = subtree_value[i] = *lo;
+  }
+
+  int nodes() const {
+    return (int)parent.size() - 1;
+  }
+
+  bool connected(int a, int b) {
+    int u = index(a), v = index(b);
+    return u == v || find_root(u) == find_root(v);
+  }
+
+  void link(int a, int b) {
+    int u = index(a), v = index(b);
+    evert(u);
+    if (u == v || find_root(v) == u)
+      throw std::runtime_error("Error: a and b are already connected.");
+    parent[u] = v;
+  }
+
+  void link(const std::vector<std::pair<int, int> > & edges) {
+    for (int j = 0; j < (int)edges.size(); j++)
+      link(edges[j].first, edges[j].second);
+  }
+
+  void cut(int a, int b) {
+    int u = index(a), v = index(b);
+    evert(u);
+    cut_from_root(u, v);
+  }
+
+  void cut(const std::vector<std::pair<int, int> > & edges) {
+    std::vector<std::pair<int, int> > order;
+    sort_by_first(edges, order);
+    for (int j = 0; j < (int)order.size(); j++) {
+      int u = index(order[j].first);
+      if (j == 0 || order[j].first != order[j - 1].first) evert(u);
+      cut_from_root(u, index(edges[order[j].second].second));
+    }
+  }
+
+  T query(int a, int b) {
+    if (!connected(a, b))
+      throw std::runtime_error("Error: a and b are not connected.");
+    int v = index(b);
+    evert(index(a));
+    access(v);
+    return subtree_value[v];
+  }
+
+  //sets res[j] to query(paths[j].first, paths[j].second) for each j
+  void query(const std::vector<std::pair<int, int> > & paths,
+             std::vector<T> & res) {
+    std::vector<std::pair<int, int> > order;
+    sort_by_first(paths, order);
+    res.resize(paths.size());
+    for (int j = 0, u = 0; j < (int)order.size(); j++) {
+      int v = index(paths[order[j].second].second);
+      if (j == 0 || order[j].first != order[j - 1].first) {
+        evert(u = index(order[j].first));
+      }
+      //u stays the root of its tree, so it must be the root found for v
+      if (u != v && find_root(v) != u)
+        throw std::runtime_error("Error: a and b are not connected.");
+      access(v);
+      res[order[j].second] = subtree_value[v];
+    }
+  }
+
+  void modify(int a, int b, const delta_t & delta) {
+    if (!connected(a, b))
+      throw std::runtime_error("Error: a and b are not connected.");
+    int v = index(b);
+    evert(index(a));
+    access(v);
+    apply(v, delta);
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <cstdlib>  /* rand() */
+#include <iostream>
+using namespace std;
+
+int main() {
+/*
+ v=10      v=40      v=20      v=10
+  0---------1---------2---------3
+                      \
+                       ---------4
+                               v=30
+*/
+  int v[] = {10, 40, 20, 10, 30};
+  linkcut_tree<int> F(v, v + 5);
+  F.link(0, 1);
+  F.link(1, 2);
+  F.link(2, 3);
+  F.link(2, 4);
+  cout << F.query(1, 4) << "\n"; //40
+  F.modify(1, 1, -10);
+  F.modify(3, 4, -10);
+/*
+ v=10      v=30      v=10      v=0
+  0---------1---------2---------3
+                      \
+                       ---------4
+                               v=20
+*/
+  cout << F.query(0, 4) << "\n"; //30
+  cout << F.query(3, 4) << "\n"; //20
+  F.cut(1, 2);
+  cout << F.connected(1, 2) << "\n"; //0
+  cout << F.connected(0, 4) << "\n"; //0
+  cout << F.connected(2, 3) << "\n"; //1
+
+  //random links, cuts, and path operations checked against a naive forest
+  const int n = 60;
+  linkcut_tree<int> t(n, 0);
+  vector<int> w(n, 0);
+  vector<vector<int> > adj(n);
+  for (int it = 0; it < 20000; it++) {
+    int a = rand() % n, b = rand() % n, op = rand() % 4;
+    //find the path from a to b in the naive forest by a search from a
+    vector<int> prev(n, -1), q(1, a);
+    prev[a] = a;
+    for (int i = 0; i < (int)q.size(); i++) {
+      for (int j = 0; j < (int)adj[q[i]].size(); j++) {
+        int c = adj[q[i]][j];
+        if (prev[c] == -1) {
+          prev[c] = q[i];
+          q.push_back(c);
+        }
+      }
+    }
+    assert(t.connected(a, b) == (prev[b] != -1));
+    if (op == 0 && prev[b] == -1) {
+      t.link(a, b);
+      adj[a].push_back(b);
+      adj[b].push_back(a);
+    } else if (op == 1 && prev[b] == a && a != b) {
+      if (rand() % 2 == 0) {
+        t.cut(a, b);
+      } else {
+        t.cut(vector<pair<int, int> >(1, make_pair(b, a)));
+      }
+      adj[a].erase(find(adj[a].begin(), adj[a].end(), b));
+      adj[b].erase(find(adj[b].begin(), adj[b].end(), a));
+    } else if (op == 2 && prev[b] != -1) {
+      int d = rand() % 100 - 50;
+      t.modify(a, b, d);
+      for (int x = b; ; x = prev[x]) {
+        w[x] += d;
+        if (x == a) break;
+      }
+    } else if (prev[b] != -1) {
+      int m = w[a];
+      for (int x = b; x != a; x = prev[x]) m = max(m, w[x]);
+      assert(t.query(a, b) == m);
+      //a batch of queries from a, b, and a again
+      vector<pair<int, int> > paths;
+      paths.push_back(make_pair(a, b));
+      paths.push_back(make_pair(b, a));
+      paths.push_back(make_pair(a, a));
+      vector<int> res;
+      t.query(paths, res);
+      assert(res[0] == m && res[1] == m && res[2] == w[a]);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,330 @@
+/*
+
+Description: Given an undirected graph that is a tree, the lowest
+common ancestor (LCA) of two nodes v and w is the lowest (i.e. deepest)
+node that has both v and w as descendants, where we define each node to
+be a descendant of itself. The following class answers LCA queries on
+an unchanging tree either online in O(1) time each, or offline for a
+batch of queries given in advance.
+
+The constructor walks the Euler tour of the tree (the sequence of nodes
+visited by a depth-first traversal, listing a node again each time the
+traversal returns to it) with an explicit stack of adjacency positions
+rather than recursion, so trees of any depth may be used. The LCA of
+nodes v and w is the shallowest node of the tour between the first
+occurrences of v and w, which is found by the O(n)-memory range minimum
+query structure of section 3.3.6 over the depths of the tour.
+
+For a batch of queries, lca(queries, res) instead applies Tarjan's
+offline algorithm along the same tour. Each query is attached to the
+one of its two nodes which occurs first later in the tour. Walking the
+tour, returning from a child to its parent unites their sets in a
+disjoint set forest, whose ancestor is then the parent, so that on
+reaching a node for the first time, the LCA with each earlier node w is
+the ancestor of the set of w. This takes only O(n + q) memory for q
+queries, and the range minimum query structure may be skipped entirely
+by passing false to the constructor.
+
+Time Complexity: O(N) for the constructor, where N is the number of
+nodes, O(1) for lca(a, b) and depth(), and O(N + Q a(N)) for a batch of
+Q queries, where a(N) is the extremely slow growing inverse of the
+Ackermann function.
+
+Space Complexity: O(N) for the tour and the range minimum query
+structure, and O(N + Q) auxiliary for a batch of Q queries.
+
+*/
+
+#include <algorithm>  /* std::min(), std::swap() */
+#include <cstddef>    /* NULL, size_t */
+#include <functional> /* std::less */
+#include <stdexcept>  /* std::runtime_error() */
+#include <utility>    /* std::pair */
+#include <vector>
+
+// The sparse table and linear range minimum query of section 3.3.6.
+template<class T, class Compare = std::less<T> > class sparse_table {
+  const T *a;
+  int n;
+  std::vector<int> table;
+  Compare comp;
+
+  static int log2(int x) {
+    return 31 - __builtin_clz(x);
+  }
+
+  int min_index(int x, int y) const {
+    return comp(a[y], a[x]) ? y : x;
+  }
+
+ public:
+  sparse_table(const T *a, int n) : a(a), n(n) {
+    int levels = (n > 0) ? log2(n) + 1 : 1;
+    table.resize((size_t)levels*n);
+    for (int i = 0; i < n; i++) {
+      table[i] = i;
+    }
+    for (int j = 1; j < levels; j++) {
+      const int *prev = &table[(size_t)(j - 1)*n];
+      int *cur = &table[(size_t)j*n];
+      for (int i = 0, half = 1 << (j - 1); i + 2*half <= n; i++) {
+        cur[i] = min_index(prev[i], prev[i + half]);
+      }
+    }
+  }
+
+  int query_index(int lo, int hi) const {
+    int j = log2(hi - lo + 1);
+    const int *level = &table[(size_t)j*n];
+    return min_index(level[lo], level[hi - (1 << j) + 1]);
+  }
+
+  T query(int lo, int hi) const {
+    return a[query_index(lo, hi)];
+  }
+};
+
+template<class T, class Compare = std::less<T> > class linear_rmq {
+  static const int BLOCK = 32;
+
+  const T *a;
+  int n;
+  std::vector<unsigned int> mask;
+  std::vector<T> block_min;
+  std::vector<int> block_index;
+  sparse_table<T, Compare> *blocks;
+  Compare comp;
+
+  // Returns the index of the minimum from lo to hi, both within one block.
+  int query_block(int lo, int hi) const {
+    unsigned int m = mask[hi] & (~0u << (lo % BLOCK));
+    return hi - hi % BLOCK + __builtin_ctz(m);
+  }
+
+  int min_index(int x, int y) const {
+    return comp(a[y], a[x]) ? y : x;
+  }
+
+  linear_rmq(const linear_rmq &);
+  linear_rmq& operator=(const linear_rmq &);
+
+ public:
+  linear_rmq(const T *a, int n) : a(a), n(n), mask(n) {
+    int nblocks = (n + BLOCK - 1)/BLOCK;
+    block_min.resize(nblocks);
+    block_index.resize(nblocks);
+    for (int b = 0; b < nblocks; b++) {
+      int lo = b*BLOCK, hi = std::min(n, lo + BLOCK);
+      unsigned int stack = 0;
+      for (int i = lo; i < hi; i++) {
+        // The highest set bit is the top of the stack.
+        while (stack != 0 && comp(a[i], a[lo + 31 - __builtin_clz(stack)])) {
+          stack &= ~(1u << (31 - __builtin_clz(stack)));
+        }
+        stack |= 1u << (i - lo);
+        mask[i] = stack;
+      }
+      block_index[b] = query_block(lo, hi - 1);
+      block_min[b] = a[block_index[b]];
+    }
+    blocks = new sparse_table<T, Compare>(block_min.empty() ? NULL :
+                                          &block_min[0], nblocks);
+  }
+
+  ~linear_rmq() {
+    delete blocks;
+  }
+
+  int query_index(int lo, int hi) const {
+    int bl = lo/BLOCK, br = hi/BLOCK;
+    if (bl == br) {
+      return query_block(lo, hi);
+    }
+    int res = query_block(lo, bl*BLOCK + BLOCK - 1);
+    if (bl + 1 < br) {
+      res = min_index(res, block_index[blocks->query_index(bl + 1, br - 1)]);
+    }
+    return min_index(res, query_block(br*BLOCK, hi));
+  }
+
+  T query(int lo, int hi) const {
+    return a[query_index(lo, hi)];
+  }
+};
+
+class lca_tree {
+  //node euler[i] is visited at step i of the tour, at depth depth[i],
+  //and first[u] is the first step at which u is visited
+  std::vector<int> euler, depth, first;
+  linear_rmq<int> *rmq;
+
+  lca_tree(const lca_tree &);
+  lca_tree& operator=(const lca_tree &);
+
+ public:
+  lca_tree(int N, std::vector<int> tree[], int root = 0, bool online = true)
+   : first(N, -1), rmq(NULL) {
+    euler.reserve(2*N - 1);
+    depth.reserve(2*N - 1);
+    std::vector<int> parent(N, -1), next(N, 0);
+    first[root] = 0;
+    euler.push_back(root);
+    depth.push_back(0);
+    for (int u = root, d = 0; ; ) {
+      if (next[u] < (int)tree[u].size()) {
+        int v = tree[u][next[u]++];
+        if (v == parent[u]) continue;
+        parent[v] = u;
+        first[v] = (int)euler.size();
+        u = v;
+        d++;
+      } else if (u != root) {
+        u = parent[u];
+        d--;
+      } else {
+        break;
+      }
+      euler.push_back(u);
+      depth.push_back(d);
+    }
+    if (online) rmq = new linear_rmq<int>(&depth[0], (int)depth.size());
+  }
+
+  ~lca_tree() {
+    delete rmq;
+  }
+
+  int depth_of(int u) const {
+    return depth[first[u]];
+  }
+
+  int lca(int a, int b) const {
+    if (rmq == NULL)
+      throw std::runtime_error("Error: lca_tree was built offline only.");
+    int l = first[a], r = first[b];
+    if (l > r) std::swap(l, r);
+    return euler[rmq->query_index(l, r)];
+  }
+
+  //sets res[j] to lca(queries[j].first, queries[j].second) for each j
+  void lca(const std::vector<std::pair<int, int> > & queries,
+           std::vector<int> & res) const {
+    int N = (int)first.size(), Q = (int)queries.size();
+    //attach query j to the node of its pair which is reached later
+    std::vector<int> start(N + 1, 0), attached(Q);
+    for (int j = 0; j < Q; j++) {
+      int a = queries[j].first, b = queries[j].second;
+      start[first[a] > first[b] ? a : b]++;
+    }
+    for (int u = 0; u < N; u++) start[u + 1] += start[u];
+    for (int j = Q - 1; j >= 0; j--) {
+      int a = queries[j].first, b = queries[j].second;
+      attached[--start[first[a] > first[b] ? a : b]] = j;
+    }
+    //a disjoint set forest with union by rank and path halving
+    std::vector<int> root(N), rank(N, 0), ancestor(N);
+    for (int u = 0; u < N; u++) root[u] = ancestor[u] = u;
+    res.resize(Q);
+    for (int i = 0; i < (int)euler.size(); i++) {
+      int u = euler[i];
+      if (i > 0 && depth[i] < depth[i - 1]) {
+        int r1 = euler[i - 1], r2 = u;
+        while (root[r1] != r1) r1 = root[r1] = root[root[r1]];
+        while (root[r2] != r2) r2 = root[r2] = root[root[r2]];
+        if (rank[r1] > rank[r2]) std::swap(r1, r2);
+        root[r1] = r2;
+        if (rank[r1] == rank[r2]) rank[r2]++;
+        ancestor[r2] = u;
+      }
+      if (i != first[u]) continue;
+      for (int k = start[u]; k < start[u + 1]; k++) {
+        int j = attached[k];
+        int w = (queries[j].first == u) ? queries[j].second : queries[j].first;
+        while (root[w] != w) w = root[w] = root[root[w]];
+        res[j] = ancestor[w];
+      }
+    }
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <cstdlib>  /* rand() */
+#include <iostream>
+using namespace std;
+
+const int MAXN = 1000000;
+vector<int> adj[MAXN];
+
+int main() {
+  adj[0].push_back(1);
+  adj[1].push_back(0);
+  adj[1].push_back(2);
+  adj[2].push_back(1);
+  adj[3].push_back(1);
+  adj[1].push_back(3);
+  adj[0].push_back(4);
+  adj[4].push_back(0);
+  lca_tree t(5, adj);
+  cout << t.lca(3, 2) << "\n"; //1
+  cout << t.lca(2, 4) << "\n"; //0
+
+  //random trees checked against climbing parents naively
+  for (int n = 1; n <= 500; n += 71) {
+    vector<int> par(n, -1), dep(n, 0);
+    for (int i = 0; i < n; i++) adj[i].clear();
+    int root = rand() % n;
+    for (int i = 0; i < n; i++) {
+      if (i == root) continue;
+      //attach each node to an earlier node, or to the root if none
+      int p = (i == 0 || (root > i && rand() % 2)) ? root : rand() % i;
+      adj[i].push_back(p);
+      adj[p].push_back(i);
+    }
+    lca_tree t(n, adj, root);
+    //recover parents and depths from the tree by a naive search
+    vector<int> q(1, root);
+    par[root] = root;
+    for (int i = 0; i < (int)q.size(); i++) {
+      for (int j = 0; j < (int)adj[q[i]].size(); j++) {
+        int v = adj[q[i]][j];
+        if (par[v] == -1) {
+          par[v] = q[i];
+          dep[v] = dep[q[i]] + 1;
+          q.push_back(v);
+        }
+      }
+    }
+    assert((int)q.size() == n);
+    vector<pair<int, int> > queries;
+    vector<int> expected;
+    for (int k = 0; k < 1000; k++) {
+      int a = rand() % n, b = rand() % n;
+      queries.push_back(make_pair(a, b));
+      while (a != b) {
+        if (dep[a] < dep[b]) swap(a, b);
+        a = par[a];
+      }
+      expected.push_back(a);
+      assert(t.lca(queries[k].first, queries[k].second) == a);
+      assert(t.depth_of(a) == dep[a]);
+    }
+    vector<int> res;
+    t.lca(queries, res);
+    assert(res == expected);
+  }
+
+  //a path of 10^6 nodes, which is too deep for a recursive traversal
+  for (int i = 0; i < MAXN; i++) adj[i].clear();
+  for (int i = 1; i < MAXN; i++) {
+    adj[i - 1].push_back(i);
+    adj[i].push_back(i - 1);
+  }
+  lca_tree chain(MAXN, adj, 0, false);
+  vector<pair<int, int> > queries(1, make_pair(MAXN - 1, MAXN/2));
+  vector<int> res;
+  chain.lca(queries, res);
+  assert(res[0] == MAXN/2);
+  return 0;
+}
@@ -0,0 +1,514 @@
+/*
+
+Measure the throughput, latency, memory footprint, and comparison counts of any
+map, priority queue, or range query structure of this section under a common
+set of synthetic workloads, so that structures can be compared on equal terms.
+The harness includes the snippet named by the macro BENCH_FILE, with its main()
+renamed so that it does not run, and drives the class named by exactly one of
+the macros BENCH_MAP, BENCH_HEAP, or BENCH_RANGE. For example:
+
+  g++ -O2 -DBENCH_FILE='"3.5.8 B+ Tree.cpp"' \
+      -DBENCH_MAP='bplus_tree<bench_key, int>' \
+      "3.8.1 Data Structure Benchmarks.cpp"
+  ./a.out all 1000000 10000000
+
+runs every workload on a B+ tree of one million keys for ten million operations.
+The arguments are the workload (uniform, zipf, sequential, adversarial, or all),
+the number of elements n, the number of operations, and a random seed. Without
+BENCH_FILE, the binary heap is benchmarked at a small default size.
+
+Each workload is a deterministic stream of keys in [0, 2n), or for the
+adversarial workload, in [0, 2n + 4096):
+- uniform draws keys uniformly at random.
+- zipf draws keys from a Zipfian distribution with exponent 0.99, as in the
+  YCSB benchmark, with ranks scattered over the key range by a hash.
+- sequential counts upward through the key range, wrapping around.
+- adversarial alternates ascending and descending runs of length sqrt(2n) in
+  which consecutive keys differ by 4096, so that unbalanced trees degenerate,
+  weak hashes into power-of-two tables collide, and heaps see each key of a
+  descending run as a new minimum.
+
+The measured phases are:
+- for BENCH_MAP, inserting n keys, then a mix of find(), insert(), and erase()
+  in proportions of BENCH_READ_PERCENT (default 80) and the rest split evenly.
+- for BENCH_HEAP, pushing n keys, then the hold model of a pop() followed by a
+  push() of a new key per operation, then popping until empty. Defining
+  BENCH_MONOTONE offsets each pushed key by the last minimum popped, as radix
+  heaps and bucket queues require.
+- for BENCH_RANGE, constructing over n elements, then a mix of query(lo, hi) and
+  update(lo, hi, d) on ranges of random length, with BENCH_UPDATE_PERCENT
+  (default 20) percent of updates. Defining BENCH_POINT_UPDATE instead calls
+  update(lo, d) for structures that only support point updates. The latencies
+  reported for construction are its total time divided by n.
+
+Member names which differ between structures may be given by the macros
+BENCH_FIND, BENCH_INSERT, BENCH_ERASE, BENCH_QUERY, and BENCH_UPDATE (for
+instance, -DBENCH_ERASE=remove for the hashmaps and -DBENCH_QUERY=sum
+-DBENCH_UPDATE=add for the Fenwick trees), and constructor arguments by
+BENCH_ARGS, which defaults to (n) for range query structures. find() must
+return a pointer which is null for a missing key.
+
+For each phase, the harness reports operations per second, the 50th, 90th, 99th,
+and 99.9th percentile latencies in nanoseconds (timing one operation in every
+16, so the totals carry 1/16 of the cost of reading the clock), heap allocations
+per operation, and the bytes allocated by the structure per element, counted by
+replacing the global operator new and operator delete, less the buffers which
+hold the harness's own latency samples. Defining BENCH_COUNT makes bench_key a
+wrapper around int that counts the comparisons made between keys, and bench_hash
+a hash function for the hashmaps that counts its calls. Counters internal to a
+class, such as rotations or node splits, are not observable from outside of it,
+so the harness reports only these counts.
+
+Time Complexity:
+- O(n) to generate a uniform, sequential, or adversarial workload, and O(n) to
+  precompute the normalization constant of the zipf workload.
+- The benchmark itself costs whatever the operations of the structure cost.
+
+Space Complexity:
+- O(n + m) for the keys of n elements and m operations and for the latency
+  samples, apart from the structure being measured.
+
+*/
+
+#include <algorithm>  // std::max(), std::min(), std::sort()
+#include <cmath>  // std::pow(), std::sqrt()
+#include <cstdio>  // std::printf()
+#include <cstdlib>  // std::atoi(), std::atoll(), std::free(), std::malloc()
+#include <new>  // std::bad_alloc
+#include <string>
+#include <time.h>  // clock_gettime()
+#include <vector>
+
+// Every allocation is prefixed by its size, keeping 16-byte alignment.
+long long bench_live_bytes = 0, bench_allocs = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+  char *p = (char*)std::malloc(size + 16);
+  if (p == 0) {
+    throw std::bad_alloc();
+  }
+  *(size_t*)p = size;
+  bench_live_bytes += size;
+  bench_allocs++;
+  return p + 16;
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc) {
+  return operator new(size);
+}
+
+void operator delete(void *p) throw() {
+  if (p != 0) {
+    char *q = (char*)p - 16;
+    bench_live_bytes -= *(size_t*)q;
+    std::free(q);
+  }
+}
+
+void operator delete[](void *p) throw() {
+  operator delete(p);
+}
+
+long long bench_comparisons = 0, bench_hashes = 0;
+
+#ifdef BENCH_COUNT
+struct bench_key {
+  int v;
+
+  bench_key(int v = 0) : v(v) {}
+
+  bool operator<(const bench_key &k) const {
+    bench_comparisons++;
+    return v < k.v;
+  }
+
+  bool operator>(const bench_key &k) const {
+    bench_comparisons++;
+    return v > k.v;
+  }
+
+  bool operator<=(const bench_key &k) const {
+    bench_comparisons++;
+    return v <= k.v;
+  }
+
+  bool operator>=(const bench_key &k) const {
+    bench_comparisons++;
+    return v >= k.v;
+  }
+
+  bool operator==(const bench_key &k) const {
+    bench_comparisons++;
+    return v == k.v;
+  }
+
+  bool operator!=(const bench_key &k) const {
+    bench_comparisons++;
+    return v != k.v;
+  }
+};
+
+int bench_value(const bench_key &k) {
+  return k.v;
+}
+#else
+typedef int bench_key;
+
+int bench_value(int k) {
+  return k;
+}
+#endif
+
+struct bench_hash {
+  unsigned int operator()(const bench_key &k) const {
+    bench_hashes++;
+    unsigned long long x = (unsigned long long)bench_value(k);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return (unsigned int)(x ^ (x >> 31));
+  }
+};
+
+#ifndef BENCH_FILE
+#define BENCH_FILE "Binary Heap.cpp"
+#define BENCH_HEAP binary_heap<bench_key>
+#define BENCH_DEFAULT_N 100000
+#endif
+
+#define main bench_snippet_main
+#include BENCH_FILE
+#undef main
+
+#ifndef BENCH_DEFAULT_N
+#define BENCH_DEFAULT_N 1000000
+#endif
+#ifndef BENCH_FIND
+#define BENCH_FIND find
+#endif
+#ifndef BENCH_INSERT
+#define BENCH_INSERT insert
+#endif
+#ifndef BENCH_ERASE
+#define BENCH_ERASE erase
+#endif
+#ifndef BENCH_QUERY
+#define BENCH_QUERY query
+#endif
+#ifndef BENCH_UPDATE
+#define BENCH_UPDATE update
+#endif
+#ifndef BENCH_READ_PERCENT
+#define BENCH_READ_PERCENT 80
+#endif
+#ifndef BENCH_UPDATE_PERCENT
+#define BENCH_UPDATE_PERCENT 20
+#endif
+
+// xorshift64*, seeded by splitmix64 so that any seed works.
+class bench_rng {
+  unsigned long long s;
+
+ public:
+  bench_rng(unsigned long long seed) {
+    s = (seed + 0x9e3779b97f4a7c15ULL) * 0xbf58476d1ce4e5b9ULL;
+    s ^= s >> 31;
+    if (s == 0) {
+      s = 1;
+    }
+  }
+
+  unsigned long long next() {
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    return s * 0x2545f4914f6cdd1dULL;
+  }
+
+  // Returns a uniform real number in [0, 1).
+  double real() {
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+  }
+};
+
+// Fills keys with m keys in [0, u) for the named workload.
+void bench_workload(const std::string &name, int u, long long m,
+                    unsigned long long seed, std::vector<int> &keys) {
+  bench_rng rng(seed);
+  keys.resize(m);
+  if (name == "uniform") {
+    for (long long i = 0; i < m; i++) {
+      keys[i] = (int)(rng.next() % u);
+    }
+  } else if (name == "zipf") {
+    // The method of Gray et al., "Quickly Generating Billion-Record Synthetic
+    // Databases", with the zeta constants of the YCSB ZipfianGenerator.
+    const double theta = 0.99;
+    double zetan = 0;
+    for (int i = 1; i <= u; i++) {
+      zetan += 1 / std::pow((double)i, theta);
+    }
+    double zeta2 = 1 + 1 / std::pow(2.0, theta);
+    double alpha = 1 / (1 - theta);
+    double eta = (1 - std::pow(2.0 / u, 1 - theta)) / (1 - zeta2 / zetan);
+    for (long long i = 0; i < m; i++) {
+      double uz = rng.real() * zetan;
+      unsigned long long rank;
+      if (uz < 1) {
+        rank = 0;
+      } else if (uz < zeta2) {
+        rank = 1;
+      } else {
+        rank = (unsigned long long)(u * std::pow(eta * uz / zetan - eta + 1,
+                                                 alpha));
+      }
+      unsigned long long h = (rank + 1) * 0x9e3779b97f4a7c15ULL;
+      keys[i] = (int)((h ^ (h >> 32)) % u);
+    }
+  } else if (name == "sequential") {
+    for (long long i = 0; i < m; i++) {
+      keys[i] = (int)(i % u);
+    }
+  } else if (name == "adversarial") {
+    long long run = std::max(1LL, (long long)std::sqrt((double)u));
+    long long slots = (u + 4095) / 4096;
+    for (long long i = 0; i < m; i++) {
+      long long r = i % u / run, j = i % u % run;
+      long long k = std::min(r * run + ((r % 2 == 0) ? j : run - 1 - j),
+                             (long long)u - 1);
+      keys[i] = (int)(k % slots * 4096 + k / slots);
+    }
+  } else {
+    keys.clear();
+  }
+}
+
+double bench_now() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// The bytes held by the samples of live phases, which are not counted as
+// bytes of the structure.
+long long bench_phase_bytes = 0;
+
+// Accumulates the measurements of one phase, timing every 16th operation.
+class bench_phase {
+  const char *name;
+  std::vector<float> samples;
+  double start;
+  long long allocs, comparisons, hashes, ops, own_bytes;
+
+ public:
+  bench_phase(const char *name, long long ops) : name(name), ops(ops) {
+    own_bytes = bench_live_bytes;
+    samples.reserve(ops / 16 + 1);
+    own_bytes = bench_live_bytes - own_bytes;
+    bench_phase_bytes += own_bytes;
+    allocs = bench_allocs;
+    comparisons = bench_comparisons;
+    hashes = bench_hashes;
+    start = bench_now();
+  }
+
+  ~bench_phase() {
+    bench_phase_bytes -= own_bytes;
+  }
+
+  bool sampled(long long i) const {
+    return (i & 15) == 0;
+  }
+
+  void sample(double t) {
+    samples.push_back((float)t);
+  }
+
+  void report(const std::string &workload, long long bytes, long long elems) {
+    double elapsed = bench_now() - start;
+    bytes -= bench_phase_bytes;
+    std::sort(samples.begin(), samples.end());
+    double p[4] = {0, 0, 0, 0}, q[4] = {0.5, 0.9, 0.99, 0.999};
+    for (int j = 0; j < 4 && !samples.empty(); j++) {
+      p[j] = samples[(size_t)(q[j] * (samples.size() - 1))];
+    }
+    double n = std::max(1LL, ops);
+    std::printf("%-11s %-5s %7.2f %5.0f %5.0f %5.0f %5.0f %8.3f %6.2f %7.2f"
+                " %6.1f\n", workload.c_str(), name, ops / elapsed * 1e3,
+                p[0], p[1], p[2], p[3], (bench_allocs - allocs) / n,
+                (bench_comparisons - comparisons) / n,
+                (bench_hashes - hashes) / n,
+                elems > 0 ? (double)bytes / elems : 0.0);
+  }
+};
+
+long long bench_sink = 0;
+
+#if defined(BENCH_MAP)
+void bench_run(const std::string &workload, int n, long long m,
+               unsigned long long seed) {
+  std::vector<int> keys, mix;
+  bench_workload(workload, 2 * n, n + m, seed, keys);
+  bench_rng rng(seed ^ 0x5bd1e995);
+  mix.resize(m);
+  for (long long i = 0; i < m; i++) {
+    int r = (int)(rng.next() % 100);
+    mix[i] = (r < BENCH_READ_PERCENT) ? 0 : (r % 2 == 0) ? 1 : 2;
+  }
+  long long base = bench_live_bytes, size = 0;
+  {
+#ifdef BENCH_ARGS
+    BENCH_MAP s BENCH_ARGS;
+#else
+    BENCH_MAP s;
+#endif
+    {
+      bench_phase p("build", n);
+      for (long long i = 0; i < n; i++) {
+        double t = p.sampled(i) ? bench_now() : 0;
+        s.BENCH_INSERT(bench_key(keys[i]), (int)i);
+        if (t != 0) {
+          p.sample(bench_now() - t);
+        }
+      }
+      p.report(workload, bench_live_bytes - base, n);
+      size = n;
+    }
+    bench_phase p("mixed", m);
+    for (long long i = 0; i < m; i++) {
+      bench_key k(keys[n + i]);
+      double t = p.sampled(i) ? bench_now() : 0;
+      if (mix[i] == 0) {
+        bench_sink += (s.BENCH_FIND(k) != 0);
+      } else if (mix[i] == 1) {
+        s.BENCH_INSERT(k, (int)i);
+      } else {
+        s.BENCH_ERASE(k);
+      }
+      if (t != 0) {
+        p.sample(bench_now() - t);
+      }
+    }
+    p.report(workload, bench_live_bytes - base, size);
+  }
+}
+#elif defined(BENCH_HEAP)
+void bench_run(const std::string &workload, int n, long long m,
+               unsigned long long seed) {
+  std::vector<int> keys;
+  bench_workload(workload, 2 * n, n + m, seed, keys);
+  long long base = bench_live_bytes;
+#ifdef BENCH_ARGS
+  BENCH_HEAP s BENCH_ARGS;
+#else
+  BENCH_HEAP s;
+#endif
+  {
+    bench_phase p("build", n);
+    for (long long i = 0; i < n; i++) {
+      double t = p.sampled(i) ? bench_now() : 0;
+      s.push(bench_key(keys[i]));
+      if (t != 0) {
+        p.sample(bench_now() - t);
+      }
+    }
+    p.report(workload, bench_live_bytes - base, n);
+  }
+  {
+    bench_phase p("hold", m);
+    for (long long i = 0; i < m; i++) {
+      double t = p.sampled(i) ? bench_now() : 0;
+      int last = bench_value(s.top());
+      s.pop();
+#ifdef BENCH_MONOTONE
+      s.push(bench_key(last + keys[n + i]));
+#else
+      bench_sink += last;
+      s.push(bench_key(keys[n + i]));
+#endif
+      if (t != 0) {
+        p.sample(bench_now() - t);
+      }
+    }
+    p.report(workload, bench_live_bytes - base, n);
+  }
+  bench_phase p("drain", n);
+  for (long long i = 0; i < n; i++) {
+    double t = p.sampled(i) ? bench_now() : 0;
+    bench_sink += bench_value(s.top());
+    s.pop();
+    if (t != 0) {
+      p.sample(bench_now() - t);
+    }
+  }
+  p.report(workload, bench_live_bytes - base, n);
+}
+#elif defined(BENCH_RANGE)
+void bench_run(const std::string &workload, int n, long long m,
+               unsigned long long seed) {
+  std::vector<int> keys, mix;
+  bench_workload(workload, 2 * n, 2 * m, seed, keys);
+  bench_rng rng(seed ^ 0x5bd1e995);
+  mix.resize(m);
+  for (long long i = 0; i < m; i++) {
+    mix[i] = (int)(rng.next() % 100) < BENCH_UPDATE_PERCENT;
+  }
+  long long base = bench_live_bytes;
+  bench_phase build("build", n);
+  double t = bench_now();
+#ifdef BENCH_ARGS
+  BENCH_RANGE s BENCH_ARGS;
+#else
+  BENCH_RANGE s(n);
+#endif
+  build.sample((bench_now() - t) / n);
+  build.report(workload, bench_live_bytes - base, n);
+  bench_phase p("mixed", m);
+  for (long long i = 0; i < m; i++) {
+    int lo = keys[2 * i] % n;
+    int hi = lo + keys[2 * i + 1] % (n - lo);
+    double t = p.sampled(i) ? bench_now() : 0;
+    if (mix[i]) {
+#ifdef BENCH_POINT_UPDATE
+      s.BENCH_UPDATE(lo, keys[2 * i + 1] % 1000);
+#else
+      s.BENCH_UPDATE(lo, hi, keys[2 * i + 1] % 1000);
+#endif
+    } else {
+      bench_sink += (long long)s.BENCH_QUERY(lo, hi);
+    }
+    if (t != 0) {
+      p.sample(bench_now() - t);
+    }
+  }
+  p.report(workload, bench_live_bytes - base, n);
+}
+#else
+#error "Define one of BENCH_MAP, BENCH_HEAP, or BENCH_RANGE."
+#endif
+
+/*** Example Usage (timings vary by machine):
+
+$ g++ -O2 "3.8.1 Data Structure Benchmarks.cpp" && ./a.out uniform
+workload    phase  Mops/s   p50   p90   p99 p99.9 alloc/op cmp/op hash/op B/elem
+uniform     build   30.08    55    70   101  2720    0.000   0.00    0.00    5.2
+uniform     hold    13.67    82   193   238   282    0.000   0.00    0.00    5.2
+uniform     drain    8.49   155   185   208   230    0.000   0.00    0.00    5.2
+
+***/
+
+int main(int argc, char *argv[]) {
+  std::string workload = (argc > 1) ? argv[1] : "all";
+  int n = (argc > 2) ? std::atoi(argv[2]) : BENCH_DEFAULT_N;
+  long long m = (argc > 3) ? std::atoll(argv[3]) : 10LL * n;
+  unsigned long long seed = (argc > 4) ? std::atoll(argv[4]) : 1;
+  const char *names[] = {"uniform", "zipf", "sequential", "adversarial"};
+  std::printf("%-11s %-5s %7s %5s %5s %5s %5s %8s %6s %7s %6s\n", "workload",
+              "phase", "Mops/s", "p50", "p90", "p99", "p99.9", "alloc/op",
+              "cmp/op", "hash/op", "B/elem");
+  for (int j = 0; j < 4; j++) {
+    if (workload == "all" || workload == names[j]) {
+      bench_run(names[j], std::max(n, 1), m, seed);
+    }
+  }
+  return 0;
+}
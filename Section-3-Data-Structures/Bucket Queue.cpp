@@ -0,0 +1,230 @@
+/*
+
+Maintain a monotone min-priority queue of elements with non-negative integer
+keys, that is, a priority queue in which no element is ever pushed with a key
+smaller than the current minimum, as in Dijkstra's algorithm with small integer
+edge weights or a discrete-event simulation whose events are scheduled at most
+a bounded time ahead. A bucket queue, or calendar queue with buckets of unit
+width, keeps a ring of W buckets, where W is a power of two, and the key cur of
+the current minimum. An element with key k in the window [cur, cur + W) is kept
+in bucket k mod W, so all elements in a bucket have equal keys, and the rest are
+kept in an overflow binary heap ordered by key.
+
+Finding the minimum advances cur one key at a time until its bucket is nonempty,
+moving the elements of the overflow heap into the ring as the window covers
+their keys. If the ring is empty, cur jumps directly to the smallest key in the
+overflow heap. When every key pushed is less than W past the current minimum,
+the overflow heap stays empty and all operations cost O(1) plus the number of
+keys cur skips, which is amortized O(1) whenever the keys popped are dense.
+
+The key of an element v is given by bucket_key(v), which converts integers and
+takes the first member of a std::pair, and may be overloaded for other types.
+
+- bucket_queue(span) constructs an empty priority queue with a ring of the
+  smallest power of two W not less than span.
+- size() returns the size of the priority queue.
+- empty() returns whether the priority queue is empty.
+- push(v) inserts the value v into the priority queue, throwing an exception if
+  its key is smaller than the key of the last minimum returned by top() or
+  removed by pop().
+- pop() removes an element with the minimum key from the priority queue.
+- top() returns an element with the minimum key in the priority queue.
+
+Time Complexity:
+- O(W) per call to the constructor.
+- O(1) per call to size() and empty().
+- O(1) per call to push() for keys within the window, and O(log m) otherwise,
+  where m is the number of elements in the overflow heap.
+- O(1 + s + t log m) amortized per call to top() and pop(), where s is the
+  number of keys skipped by cur and t is the number of elements moved from the
+  overflow heap into the ring.
+
+Space Complexity:
+- O(n + W) for storage of the priority queue elements.
+- O(1) auxiliary per call to all operations.
+
+*/
+
+#include <queue>
+#include <stdexcept>  // std::runtime_error
+#include <utility>  // std::pair
+#include <vector>
+
+template<class T> unsigned long long bucket_key(const T &v) {
+  return (unsigned long long)v;
+}
+
+template<class K, class V>
+unsigned long long bucket_key(const std::pair<K, V> &p) {
+  return (unsigned long long)p.first;
+}
+
+template<class T> class bucket_queue {
+  struct key_greater {
+    bool operator()(const T &a, const T &b) const {
+      return bucket_key(a) > bucket_key(b);
+    }
+  };
+
+  // top() may advance cur, which only moves elements from overflow to ring.
+  mutable std::vector<std::vector<T> > ring;
+  mutable std::priority_queue<T, std::vector<T>, key_greater> overflow;
+  mutable unsigned long long cur;
+  unsigned long long mask;
+  mutable int in_ring;
+  int n;
+
+  // Advances cur to the smallest key, whose bucket is then nonempty.
+  void settle() const {
+    while (ring[cur & mask].empty()) {
+      if (in_ring == 0) {
+        cur = bucket_key(overflow.top());
+      } else {
+        cur++;
+      }
+      while (!overflow.empty() && bucket_key(overflow.top()) - cur <= mask) {
+        ring[bucket_key(overflow.top()) & mask].push_back(overflow.top());
+        overflow.pop();
+        in_ring++;
+      }
+    }
+  }
+
+ public:
+  bucket_queue(int span) : cur(0), in_ring(0), n(0) {
+    int w = 1;
+    while (w < span) {
+      w *= 2;
+    }
+    ring.resize(w);
+    mask = w - 1;
+  }
+
+  int size() const {
+    return n;
+  }
+
+  bool empty() const {
+    return n == 0;
+  }
+
+  void push(const T &v) {
+    unsigned long long k = bucket_key(v);
+    if (k < cur) {
+      throw std::runtime_error("Cannot push a key below the current minimum.");
+    }
+    if (k - cur <= mask) {
+      ring[k & mask].push_back(v);
+      in_ring++;
+    } else {
+      overflow.push(v);
+    }
+    n++;
+  }
+
+  void pop() {
+    if (n == 0) {
+      throw std::runtime_error("Cannot pop from empty heap.");
+    }
+    settle();
+    ring[cur & mask].pop_back();
+    in_ring--;
+    n--;
+  }
+
+  const T& top() const {
+    if (n == 0) {
+      throw std::runtime_error("Cannot get top of empty heap.");
+    }
+    settle();
+    return ring[cur & mask].back();
+  }
+};
+
+/*** Example Usage and Output:
+
+0 5 10 12 12 1000
+Dijkstra distances: 0 3 1 4
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+using namespace std;
+
+int main() {
+  {
+    bucket_queue<int> h(8);
+    int a[] = {12, 5, 1000, 0, 12};
+    for (int i = 0; i < 5; i++) {
+      h.push(a[i]);
+    }
+    h.push(10);
+    const bucket_queue<int> &c = h;
+    assert(c.top() == 0 && c.size() == 6);
+    cout << h.top();
+    for (h.pop(); !h.empty(); h.pop()) {
+      cout << " " << h.top();
+    }
+    cout << endl;
+  }
+  {
+    // Dijkstra's algorithm with (distance, node) pairs and lazy deletion, where
+    // a ring spanning the largest edge weight never overflows.
+    int w[4][4] = {{0, 4, 1, 0}, {4, 0, 2, 1}, {1, 2, 0, 5}, {0, 1, 5, 0}};
+    int d[] = {0, -1, -1, -1};
+    bucket_queue<pair<int, int> > h(5 + 1);
+    h.push(make_pair(0, 0));
+    while (!h.empty()) {
+      pair<int, int> p = h.top();
+      h.pop();
+      if (p.first > d[p.second] && d[p.second] >= 0) {
+        continue;
+      }
+      for (int v = 0; v < 4; v++) {
+        int nd = p.first + w[p.second][v];
+        if (w[p.second][v] > 0 && (d[v] < 0 || nd < d[v])) {
+          d[v] = nd;
+          h.push(make_pair(nd, v));
+        }
+      }
+    }
+    cout << "Dijkstra distances: " << d[0] << " " << d[1] << " " << d[2] << " "
+         << d[3] << endl;
+  }
+  {
+    // Compare a random event simulation against std::priority_queue.
+    bucket_queue<unsigned long long> h(64);
+    priority_queue<unsigned long long, vector<unsigned long long>,
+                   greater<unsigned long long> > q;
+    for (int i = 0; i < 1000; i++) {
+      unsigned long long k = rand() % 1000;
+      h.push(k);
+      q.push(k);
+    }
+    for (int i = 0; i < 200000; i++) {
+      assert(h.top() == q.top() && h.size() == (int)q.size());
+      unsigned long long t = h.top();
+      h.pop();
+      q.pop();
+      for (int j = rand() % 3; j > 0; j--) {
+        unsigned long long k = t + rand() % ((rand() % 10 == 0) ? 100000 : 100);
+        h.push(k);
+        q.push(k);
+      }
+      if (q.empty()) {
+        h.push(t);
+        q.push(t);
+      }
+    }
+    bool thrown = false;
+    try {
+      h.push(h.top() - 1);
+    } catch (runtime_error &) {
+      thrown = true;
+    }
+    assert(thrown || h.top() == 0);
+  }
+  return 0;
+}
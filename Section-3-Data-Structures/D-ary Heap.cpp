@@ -0,0 +1,388 @@
+/*
+
+Maintain a min-priority queue, that is, a collection of elements with support
+for querying and extraction of the minimum. This implementation requires an
+ordering on the set of possible elements defined by the < operator. A d-ary
+min-heap is a complete tree in which each node has up to D children and is
+never greater than them, stored as an array in level order. A wider node makes
+the tree only log(n)/log(D) levels deep, so push() and decrease_key() move an
+element up fewer levels, while pop() compares up to D children per level.
+
+The heap array is offset so that the D children of every node start at an index
+divisible by D, and the array itself is aligned to a cache line of 64 bytes.
+When D times the size of an entry (an element and its handle) is at most 64
+bytes, as for the default D = 4 with elements of up to 12 bytes, every group of
+siblings is within one cache line, so each level of pop() costs at most one
+cache miss. A larger D makes the tree shallower but pop() compares more
+children, and D = 4 is usually the fastest.
+
+Every element inserted is identified by an integer handle. The position of each
+handle in the heap is kept up to date, so that any element may later have its
+value decreased or be erased. Handles of removed elements are reused by push().
+
+- d_ary_heap() constructs an empty priority queue.
+- d_ary_heap(lo, hi) constructs a priority queue from the elements in the range
+  [lo, hi), with the handles 0, 1, ... in order, by heapifying them bottom-up.
+- size() returns the size of the priority queue.
+- empty() returns whether the priority queue is empty.
+- push(v) inserts the value v and returns its handle.
+- push_range(lo, hi) inserts the elements in the range [lo, hi), which receive
+  consecutive new handles, and returns the handle of the first. If the range is
+  large compared to the heap, the whole heap is heapified again instead of
+  inserting the elements one at a time.
+- top() returns the minimum element, and top_handle() its handle.
+- pop() removes the minimum element.
+- pop_k(k, out) removes the k smallest elements, writing them to the output
+  iterator out in ascending order.
+- contains(h) returns whether the element with handle h is in the heap.
+- value(h) returns the element with handle h.
+- decrease_key(h, v) sets the element with handle h to v, which must not be
+  greater than its current value.
+- erase(h) removes the element with handle h.
+
+Time Complexity:
+- O(1) per call to the first constructor, size(), empty(), top(), top_handle(),
+  contains(), and value().
+- O(n) per call to the second constructor, where n is the number of elements.
+- O(log n/log D) per call to push() and decrease_key(), and O(D log n/log D)
+  per call to pop() and erase(), where n is the number of elements currently in
+  the priority queue.
+- O(min(m log n/log D, n + m)) per call to push_range(), where m is the number
+  of elements in the range, and O(k D log n/log D) per call to pop_k().
+
+Space Complexity:
+- O(n) for storage of the priority queue elements and O(h) for storage of the
+  handles, where h is the largest number of elements ever in the heap.
+- O(1) auxiliary per call to all operations.
+
+*/
+
+#include <cstddef>  // size_t
+#include <iterator>  // std::distance()
+#include <new>  // operator new(), placement new
+#include <stdexcept>  // std::runtime_error
+#include <vector>
+
+template<class T, int D = 4> class d_ary_heap {
+  struct entry_t {
+    T value;
+    int handle;
+  };
+
+  char *raw;  // The allocation holding the aligned array.
+  entry_t *a;  // Element i of the heap is a[i + D - 1], so that child groups
+               // start at multiples of D.
+  int n, capacity;
+  std::vector<int> pos, free_handles;  // pos[h] is -1 if h is not in the heap.
+
+  void reserve(int c) {
+    if (c <= capacity) {
+      return;
+    }
+    c = (c < 2*capacity) ? 2*capacity : c;
+    char *r = (char*)operator new((c + D)*sizeof(entry_t) + 64);
+    entry_t *b = (entry_t*)(r + (64 - (size_t)r % 64) % 64);
+    for (int i = 0; i < n; i++) {
+      new (b + i + D - 1) entry_t(a[i + D - 1]);
+      a[i + D - 1].~entry_t();
+    }
+    operator delete(raw);
+    raw = r;
+    a = b;
+    capacity = c;
+  }
+
+  void place(int i, const entry_t &e) {
+    a[i + D - 1] = e;
+    pos[e.handle] = i;
+  }
+
+  void sift_up(int i) {
+    entry_t e = a[i + D - 1];
+    while (i > 0) {
+      int parent = (i - 1)/D;
+      if (!(e.value < a[parent + D - 1].value)) {
+        break;
+      }
+      place(i, a[parent + D - 1]);
+      i = parent;
+    }
+    place(i, e);
+  }
+
+  void sift_down(int i) {
+    entry_t e = a[i + D - 1];
+    for (;;) {
+      int first = D*i + 1;
+      if (first >= n) {
+        break;
+      }
+      int last = (first + D < n) ? first + D : n, child = first;
+      for (int j = first + 1; j < last; j++) {
+        if (a[j + D - 1].value < a[child + D - 1].value) {
+          child = j;
+        }
+      }
+      if (!(a[child + D - 1].value < e.value)) {
+        break;
+      }
+      place(i, a[child + D - 1]);
+      i = child;
+    }
+    place(i, e);
+  }
+
+  void heapify() {
+    for (int i = (n - 2)/D; i >= 0 && n > 1; i--) {
+      sift_down(i);
+    }
+  }
+
+  int new_handle() {
+    pos.push_back(-1);
+    return (int)pos.size() - 1;
+  }
+
+  // Appends an entry without restoring the heap property.
+  void append(const T &v, int h) {
+    reserve(n + 1);
+    entry_t e = {v, h};
+    new (a + n + D - 1) entry_t(e);
+    pos[h] = n++;
+  }
+
+  // Removes the element at heap position i.
+  void remove_at(int i) {
+    int h = a[i + D - 1].handle;
+    pos[h] = -1;
+    free_handles.push_back(h);
+    if (i != --n) {
+      place(i, a[n + D - 1]);
+    }
+    a[n + D - 1].~entry_t();
+    if (i < n && i > 0 && a[i + D - 1].value < a[(i - 1)/D + D - 1].value) {
+      sift_up(i);
+    } else if (i < n) {
+      sift_down(i);
+    }
+  }
+
+  void check(int h) const {
+    if (!contains(h)) {
+      throw std::runtime_error("Handle is not in the heap.");
+    }
+  }
+
+  d_ary_heap(const d_ary_heap &);
+  d_ary_heap& operator=(const d_ary_heap &);
+
+ public:
+  d_ary_heap() : raw(0), a(0), n(0), capacity(0) {}
+
+  template<class It>
+  d_ary_heap(It lo, It hi) : raw(0), a(0), n(0), capacity(0) {
+    reserve((int)std::distance(lo, hi));
+    for (; lo != hi; ++lo) {
+      append(*lo, new_handle());
+    }
+    heapify();
+  }
+
+  ~d_ary_heap() {
+    for (int i = 0; i < n; i++) {
+      a[i + D - 1].~entry_t();
+    }
+    operator delete(raw);
+  }
+
+  int size() const {
+    return n;
+  }
+
+  bool empty() const {
+    return n == 0;
+  }
+
+  int push(const T &v) {
+    int h;
+    if (free_handles.empty()) {
+      h = new_handle();
+    } else {
+      h = free_handles.back();
+      free_handles.pop_back();
+    }
+    append(v, h);
+    sift_up(n - 1);
+    return h;
+  }
+
+  template<class It> int push_range(It lo, It hi) {
+    int m = (int)std::distance(lo, hi), old = n, first = (int)pos.size();
+    reserve(n + m);
+    for (; lo != hi; ++lo) {
+      append(*lo, new_handle());
+    }
+    int depth = 1;
+    for (long long s = D; s < n; s *= D) {
+      depth++;
+    }
+    if ((long long)m*depth > n) {
+      heapify();
+    } else {
+      for (int i = old; i < n; i++) {
+        sift_up(i);
+      }
+    }
+    return first;
+  }
+
+  const T& top() const {
+    if (n == 0) {
+      throw std::runtime_error("Cannot get top of empty heap.");
+    }
+    return a[D - 1].value;
+  }
+
+  int top_handle() const {
+    if (n == 0) {
+      throw std::runtime_error("Cannot get top of empty heap.");
+    }
+    return a[D - 1].handle;
+  }
+
+  void pop() {
+    if (n == 0) {
+      throw std::runtime_error("Cannot pop from empty heap.");
+    }
+    remove_at(0);
+  }
+
+  template<class OutputIt> OutputIt pop_k(int k, OutputIt out) {
+    for (; k > 0 && n > 0; k--) {
+      *(out++) = a[D - 1].value;
+      remove_at(0);
+    }
+    return out;
+  }
+
+  bool contains(int h) const {
+    return h >= 0 && h < (int)pos.size() && pos[h] >= 0;
+  }
+
+  const T& value(int h) const {
+    check(h);
+    return a[pos[h] + D - 1].value;
+  }
+
+  void decrease_key(int h, const T &v) {
+    check(h);
+    int i = pos[h];
+    if (a[i + D - 1].value < v) {
+      throw std::runtime_error("Cannot increase a key with decrease_key().");
+    }
+    a[i + D - 1].value = v;
+    sift_up(i);
+  }
+
+  void erase(int h) {
+    check(h);
+    remove_at(pos[h]);
+  }
+};
+
+/*** Example Usage and Output:
+
+-1 0 5 10 12
+Dijkstra distances: 0 3 1 4
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+#include <set>
+#include <utility>  // std::make_pair(), std::pair
+using namespace std;
+
+int main() {
+  {
+    int a[] = {0, 5, -1, 12};
+    d_ary_heap<int> h(a, a + 4);
+    h.push(10);
+    cout << h.top();
+    for (h.pop(); !h.empty(); h.pop()) {
+      cout << " " << h.top();
+    }
+    cout << endl;
+  }
+  {
+    // Dijkstra's algorithm, with handle i for node i.
+    int w[4][4] = {{0, 4, 1, 0}, {4, 0, 2, 1}, {1, 2, 0, 5}, {0, 1, 5, 0}};
+    const int INF = 1000000;
+    int d[] = {0, INF, INF, INF};
+    d_ary_heap<int, 4> h(d, d + 4);
+    while (!h.empty()) {
+      int u = h.top_handle();
+      h.pop();
+      for (int v = 0; v < 4; v++) {
+        if (w[u][v] > 0 && h.contains(v) && d[u] + w[u][v] < d[v]) {
+          d[v] = d[u] + w[u][v];
+          h.decrease_key(v, d[v]);
+        }
+      }
+    }
+    cout << "Dijkstra distances: " << d[0] << " " << d[1] << " " << d[2] << " "
+         << d[3] << endl;
+  }
+  {
+    // Compare random operations against a std::set of (value, handle).
+    d_ary_heap<int> h;
+    set<pair<int, int> > s;
+    vector<int> handles;
+    for (int k = 0; k < 200000; k++) {
+      int op = rand() % 6;
+      if (op <= 1) {
+        int v = rand() % 100000, x = h.push(v);
+        s.insert(make_pair(v, x));
+        handles.push_back(x);
+      } else if (op == 2 && !s.empty()) {
+        assert(h.top() == s.begin()->first);
+        s.erase(make_pair(h.top(), h.top_handle()));
+        h.pop();
+      } else if (op == 3 && !handles.empty()) {
+        int x = handles[rand() % handles.size()];
+        if (h.contains(x)) {
+          int v = h.value(x), nv = v - rand() % 1000;
+          s.erase(make_pair(v, x));
+          s.insert(make_pair(nv, x));
+          h.decrease_key(x, nv);
+        }
+      } else if (op == 4 && !handles.empty()) {
+        int x = handles[rand() % handles.size()];
+        if (h.contains(x)) {
+          s.erase(make_pair(h.value(x), x));
+          h.erase(x);
+        }
+      } else if (op == 5) {
+        vector<int> v(rand() % 50);
+        for (int i = 0; i < (int)v.size(); i++) {
+          v[i] = rand() % 100000;
+        }
+        int first = h.push_range(v.begin(), v.end());
+        for (int i = 0; i < (int)v.size(); i++) {
+          s.insert(make_pair(v[i], first + i));
+          handles.push_back(first + i);
+        }
+      }
+      assert(h.size() == (int)s.size());
+    }
+    vector<int> out;
+    h.pop_k(100, back_inserter(out));
+    for (int i = 0; i < (int)out.size(); i++) {
+      assert(out[i] == s.begin()->first);
+      s.erase(s.begin());
+    }
+    assert(h.size() == (int)s.size());
+  }
+  return 0;
+}
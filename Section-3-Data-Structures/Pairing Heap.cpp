@@ -11,48 +11,159 @@ multi-way tree, using a two-pass merge to self-adjust during each deletion.
   consisting of elements in the range [lo, hi).
 - size() returns the size of the priority queue.
 - empty() returns whether the priority queue is empty.
-- push(v) inserts the value v into the priority queue.
+- push(v) inserts the value v into the priority queue, returning a handle to
+  its node which remains valid until the element is popped.
 - pop() removes the minimum element from the priority queue.
+- decrease_key(h, v) sets the element with handle h to v, which must not be
+  greater than its current value, by cutting its subtree from its parent and
+  merging the subtree with the root.
 - top() returns the minimum element in the priority queue.
 - absorb(h) inserts every value from h and sets h to the empty priority queue.
+- clear() removes every element from the priority queue.
+
+Nodes are allocated from the template argument Pool, by default a slab allocator
+which recycles the nodes of popped elements through a free list. absorb() hands
+the slabs of h over to this queue along with its nodes, and clear() and the
+destructor release the nodes with a sweep over the slabs instead of a traversal.
+Each node links to its parent if it is the first child, or else to its previous
+sibling, so that decrease_key() can cut it out in O(1). The two passes of the
+merge after pop() run in loops, so that no shape of the tree can overflow the
+stack.
 
 Time Complexity:
 - O(1) per call to the first constructor, size(), empty(), top(), push(), and
   absorb().
-- O(log n) amortized per call to pop().
+- O(log n) amortized per call to pop(), and O(log n) amortized (conjectured
+  o(log n)) per call to decrease_key().
 - O(n) per call to the second constructor on the distance between lo and hi.
+- O(n) per call to clear() and the destructor, or O(s) if T has a trivial
+  destructor, where s is the number of slabs (O(log n) unless heaps have been
+  absorbed). absorb() takes an additional O(s) to take over the slabs of h.
 
 Space Complexity:
 - O(n) for storage of the priority queue elements.
-- O(log n) amortized auxiliary per call to pop().
-- O(1) auxiliary per call to all other operations.
+- O(1) auxiliary per call to all operations.
 
 */
 
 #include <cstdlib>
+#include <new>
 #include <stdexcept>
+#include <vector>
+
+// A slab allocator for nodes with a free list, as in section 3.5.1, which can
+// also take over the nodes of another pool when two heaps are merged.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  struct slab {
+    slot *slots;
+    size_t size, used;
+  };
+
+  std::vector<slab> slabs;
+  slot *free_list, *free_tail;
+
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
+
+ public:
+  node_pool() : free_list(NULL), free_tail(NULL) {}
+
+  ~node_pool() {
+    clear();
+  }
+
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != NULL) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || slabs.back().used == slabs.back().size) {
+        slab b;
+        b.size = slabs.empty() ? 64 : 2*slabs.back().size;
+        b.slots = new slot[b.size];
+        b.used = 0;
+        slabs.push_back(b);
+      }
+      s = slabs.back().slots + slabs.back().used++;
+    }
+    s->next = s;
+    return s->u.data;
+  }
 
-template<class T> class pairing_heap {
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    if (free_list == NULL) {
+      free_tail = s;
+    }
+    s->next = free_list;
+    free_list = s;
+  }
+
+  // Takes over the slabs and free slots of p, leaving p empty.
+  void absorb(node_pool &p) {
+    slabs.insert(slabs.end(), p.slabs.begin(), p.slabs.end());
+    if (p.free_list != NULL) {
+      p.free_tail->next = free_list;
+      if (free_list == NULL) {
+        free_tail = p.free_tail;
+      }
+      free_list = p.free_list;
+    }
+    p.slabs.clear();
+    p.free_list = NULL;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        for (size_t j = 0; j < slabs[i].used; j++) {
+          slot *s = slabs[i].slots + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].slots;
+    }
+    slabs.clear();
+    free_list = NULL;
+  }
+};
+
+template<class T, template<class> class Pool = node_pool> class pairing_heap {
   struct node_t {
     T value;
-    node_t *left, *next;
+    node_t *left, *next, *prev;  // prev is the parent for a first child.
 
     node_t(const T &v) {
       value = v;
-      left = next = NULL;
+      left = next = prev = NULL;
     }
 
     void add_child(node_t *n) {
-      if (left == NULL) {
-        left = n;
-      } else {
-        n->next = left;
-        left = n;
+      n->next = left;
+      if (left != NULL) {
+        left->prev = n;
       }
+      n->prev = this;
+      left = n;
     }
   } *root;
 
   int num_nodes;
+  Pool<node_t> pool;
 
   static node_t* merge(node_t *a, node_t *b) {
     if (a == NULL) {
@@ -69,28 +180,34 @@ template<class T> class pairing_heap {
     return b;
   }
 
+  // Merges the siblings from n in pairs from left to right, then merges the
+  // pairs into one from right to left.
   static node_t* merge_pairs(node_t *n) {
-    if (n == NULL || n->next == NULL) {
-      return n;
+    node_t *pairs = NULL;  // The merged pairs, last first.
+    while (n != NULL) {
+      node_t *a = n, *b = n->next;
+      n = (b != NULL) ? b->next : NULL;
+      a->next = NULL;
+      if (b != NULL) {
+        b->next = NULL;
+        a = merge(a, b);
+      }
+      a->next = pairs;
+      pairs = a;
     }
-    node_t *a = n;
-    node_t *b = n->next;
-    node_t *c = n->next->next;
-    a->next = NULL;
-    b->next = NULL;
-    return merge(merge(a, b), merge_pairs(c));
-  }
-
-  static void clean_up(node_t *n) {
-    if (n == NULL) {
-      return;
+    node_t *res = NULL;
+    while (pairs != NULL) {
+      node_t *p = pairs;
+      pairs = p->next;
+      p->next = NULL;
+      res = merge(res, p);
     }
-    clean_up(n->left);
-    clean_up(n->next);
-    delete n;
+    return res;
   }
 
  public:
+  typedef node_t *handle;
+
   pairing_heap() {
     root = NULL;
     num_nodes = 0;
@@ -104,10 +221,6 @@ template<class T> class pairing_heap {
     }
   }
 
-  ~pairing_heap() {
-    clean_up(root);
-  }
-
   int size() {
     return num_nodes;
   }
@@ -116,9 +229,17 @@ template<class T> class pairing_heap {
     return root == NULL;
   }
 
-  void push(const T &v) {
-    root = merge(root, new node_t(v));
+  void clear() {
+    pool.clear();
+    root = NULL;
+    num_nodes = 0;
+  }
+
+  handle push(const T &v) {
+    node_t *n = new (pool.allocate()) node_t(v);
+    root = merge(root, n);
     num_nodes++;
+    return n;
   }
 
   void pop() {
@@ -127,10 +248,33 @@ template<class T> class pairing_heap {
     }
     node_t *tmp = root;
     root = merge_pairs(root->left);
-    delete tmp;
+    if (root != NULL) {
+      root->prev = NULL;
+    }
+    pool.destroy(tmp);
     num_nodes--;
   }
 
+  void decrease_key(handle n, const T &v) {
+    if (n->value < v) {
+      throw std::runtime_error("Cannot increase a key with decrease_key().");
+    }
+    n->value = v;
+    if (n == root) {
+      return;
+    }
+    if (n->prev->left == n) {
+      n->prev->left = n->next;
+    } else {
+      n->prev->next = n->next;
+    }
+    if (n->next != NULL) {
+      n->next->prev = n->prev;
+    }
+    n->next = n->prev = NULL;
+    root = merge(root, n);
+  }
+
   T top() {
     if (empty()) {
       throw std::runtime_error("Cannot get top of empty heap.");
@@ -140,7 +284,10 @@ template<class T> class pairing_heap {
 
   void absorb(pairing_heap &h) {
     root = merge(root, h.root);
+    pool.absorb(h.pool);
+    num_nodes += h.num_nodes;
     h.root = NULL;
+    h.num_nodes = 0;
   }
 };
 
@@ -154,7 +301,10 @@ template<class T> class pairing_heap {
 
 ***/
 
+#include <cassert>
+#include <cstdlib>  // rand()
 #include <iostream>
+#include <set>
 using namespace std;
 
 int main() {
@@ -165,9 +315,43 @@ int main() {
   h2.push(-1);
   h2.push(0);
   h.absorb(h2);
+  assert(h.size() == 5 && h2.empty());
   while (!h.empty()) {
     cout << h.top() << endl;
     h.pop();
   }
+  h2.push(1);
+  h2.clear();
+  assert(h2.empty() && h2.size() == 0);
+
+  // A million children of the root, merged in pairs without recursion.
+  for (int i = 0; i < 1000000; i++) {
+    h.push(i);
+  }
+  h.pop();
+  assert(h.top() == 1 && h.size() == 999999);
+  h.clear();
+
+  // Compare decrease_key() against a std::multiset.
+  vector<pairing_heap<int>::handle> handles;
+  vector<int> values;
+  multiset<int> m;
+  for (int i = 0; i < 1000; i++) {
+    values.push_back(rand() % 100000);
+    handles.push_back(h.push(values[i]));
+    m.insert(values[i]);
+  }
+  for (int i = 0; i < 10000; i++) {
+    int j = rand() % 1000, v = values[j] - rand() % 1000;
+    m.erase(m.find(values[j]));
+    m.insert(v);
+    h.decrease_key(handles[j], values[j] = v);
+    assert(h.top() == *m.begin());
+  }
+  for (multiset<int>::iterator it = m.begin(); it != m.end(); ++it) {
+    assert(h.top() == *it);
+    h.pop();
+  }
+  assert(h.empty());
   return 0;
 }
@@ -0,0 +1,219 @@
+/*
+
+Maintain a monotone min-priority queue of elements with non-negative integer
+keys, that is, a priority queue in which no element is ever pushed with a key
+smaller than that of the last element popped, as in Dijkstra's algorithm or a
+discrete-event simulation. A radix heap exploits this to avoid comparisons
+between elements: remembering the key last of the last minimum found, it keeps
+each element with key k in bucket 0 if k = last, or else in bucket b, where b
+is the position of the highest bit in which k and last differ (counting from 1),
+so the buckets hold ever wider ranges of keys. Bucket 0 holds the minima.
+
+Once bucket 0 runs out, the first nonempty bucket b is emptied: last becomes
+the smallest key in it, and each of its elements moves to the bucket for its key
+relative to the new last, which is always below b. The elements of higher
+buckets stay where they are, since the new last agrees with the old in all bits
+above the b-th. Each element thus moves down at most 64 times over its life.
+
+The key of an element v is given by radix_key(v), which converts integers and
+takes the first member of a std::pair, and may be overloaded for other types.
+
+- radix_heap() constructs an empty priority queue.
+- radix_heap(lo, hi) constructs a priority queue from the elements in the range
+  [lo, hi).
+- size() returns the size of the priority queue.
+- empty() returns whether the priority queue is empty.
+- push(v) inserts the value v into the priority queue, throwing an exception if
+  its key is smaller than the key of the last minimum returned by top() or
+  removed by pop().
+- pop() removes an element with the minimum key from the priority queue.
+- top() returns an element with the minimum key in the priority queue.
+
+Time Complexity:
+- O(1) per call to the first constructor, size(), empty(), and push().
+- O(n) per call to the second constructor, where n is the number of elements.
+- O(log C) amortized per call to top() and pop(), where C is the largest
+  difference between the key of an element pushed and the last minimum found
+  at that time (at most 2^64).
+
+Space Complexity:
+- O(n) for storage of the priority queue elements.
+- O(1) auxiliary per call to all operations.
+
+*/
+
+#include <stdexcept>  // std::runtime_error
+#include <utility>  // std::pair
+#include <vector>
+
+template<class T> unsigned long long radix_key(const T &v) {
+  return (unsigned long long)v;
+}
+
+template<class K, class V>
+unsigned long long radix_key(const std::pair<K, V> &p) {
+  return (unsigned long long)p.first;
+}
+
+template<class T> class radix_heap {
+  // top() may refill bucket 0, which only moves elements between buckets.
+  mutable std::vector<T> buckets[65];
+  mutable unsigned long long last;
+  int n;
+
+  int bucket(unsigned long long k) const {
+    return (k == last) ? 0 : 64 - __builtin_clzll(k ^ last);
+  }
+
+  // Refills bucket 0 from the first nonempty bucket.
+  void refill() const {
+    if (!buckets[0].empty()) {
+      return;
+    }
+    int b = 1;
+    while (buckets[b].empty()) {
+      b++;
+    }
+    std::vector<T> &v = buckets[b];
+    last = radix_key(v[0]);
+    for (size_t i = 1; i < v.size(); i++) {
+      unsigned long long k = radix_key(v[i]);
+      if (k < last) {
+        last = k;
+      }
+    }
+    for (size_t i = 0; i < v.size(); i++) {
+      buckets[bucket(radix_key(v[i]))].push_back(v[i]);
+    }
+    v.clear();
+  }
+
+ public:
+  radix_heap() : last(0), n(0) {}
+
+  template<class It> radix_heap(It lo, It hi) : last(0), n(0) {
+    for (; lo != hi; ++lo) {
+      buckets[bucket(radix_key(*lo))].push_back(*lo);
+      n++;
+    }
+  }
+
+  int size() const {
+    return n;
+  }
+
+  bool empty() const {
+    return n == 0;
+  }
+
+  void push(const T &v) {
+    unsigned long long k = radix_key(v);
+    if (k < last) {
+      throw std::runtime_error("Cannot push a key below the last popped.");
+    }
+    buckets[bucket(k)].push_back(v);
+    n++;
+  }
+
+  void pop() {
+    if (n == 0) {
+      throw std::runtime_error("Cannot pop from empty heap.");
+    }
+    refill();
+    buckets[0].pop_back();
+    n--;
+  }
+
+  const T& top() const {
+    if (n == 0) {
+      throw std::runtime_error("Cannot get top of empty heap.");
+    }
+    refill();
+    return buckets[0].back();
+  }
+};
+
+/*** Example Usage and Output:
+
+0 5 10 12 12
+Dijkstra distances: 0 3 1 4
+
+***/
+
+#include <cassert>
+#include <cstdlib>  // rand()
+#include <iostream>
+#include <queue>
+using namespace std;
+
+int main() {
+  {
+    int a[] = {12, 5, 0, 12};
+    radix_heap<int> h(a, a + 4);
+    h.push(10);
+    const radix_heap<int> &c = h;
+    assert(c.top() == 0 && c.size() == 5);
+    cout << h.top();
+    for (h.pop(); !h.empty(); h.pop()) {
+      cout << " " << h.top();
+    }
+    cout << endl;
+  }
+  {
+    // Dijkstra's algorithm with (distance, node) pairs and lazy deletion.
+    int w[4][4] = {{0, 4, 1, 0}, {4, 0, 2, 1}, {1, 2, 0, 5}, {0, 1, 5, 0}};
+    int d[] = {0, -1, -1, -1};
+    radix_heap<pair<int, int> > h;
+    h.push(make_pair(0, 0));
+    while (!h.empty()) {
+      pair<int, int> p = h.top();
+      h.pop();
+      if (p.first > d[p.second] && d[p.second] >= 0) {
+        continue;
+      }
+      for (int v = 0; v < 4; v++) {
+        int nd = p.first + w[p.second][v];
+        if (w[p.second][v] > 0 && (d[v] < 0 || nd < d[v])) {
+          d[v] = nd;
+          h.push(make_pair(nd, v));
+        }
+      }
+    }
+    cout << "Dijkstra distances: " << d[0] << " " << d[1] << " " << d[2] << " "
+         << d[3] << endl;
+  }
+  {
+    // Compare a random event simulation against std::priority_queue.
+    radix_heap<unsigned long long> h;
+    priority_queue<unsigned long long, vector<unsigned long long>,
+                   greater<unsigned long long> > q;
+    for (int i = 0; i < 1000; i++) {
+      unsigned long long k = rand() % 1000;
+      h.push(k);
+      q.push(k);
+    }
+    for (int i = 0; i < 200000; i++) {
+      assert(h.top() == q.top() && h.size() == (int)q.size());
+      unsigned long long t = h.top();
+      h.pop();
+      q.pop();
+      for (int j = rand() % 3; j > 0; j--) {
+        unsigned long long k = t + rand() % ((rand() % 10 == 0) ? 100000 : 100);
+        h.push(k);
+        q.push(k);
+      }
+      if (q.empty()) {
+        h.push(t);
+        q.push(t);
+      }
+    }
+    bool thrown = false;
+    try {
+      h.push(h.top() - 1);
+    } catch (runtime_error &) {
+      thrown = true;
+    }
+    assert(thrown || h.top() == 0);
+  }
+  return 0;
+}
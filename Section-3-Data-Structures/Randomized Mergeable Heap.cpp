@@ -15,25 +15,126 @@ coin-toss to recursively combine nodes of two binary trees.
 - pop() removes the minimum element from the priority queue.
 - top() returns the minimum element in the priority queue.
 - absorb(h) inserts every value from h and sets h to the empty priority queue.
+- clear() removes every element from the priority queue.
+
+Nodes are allocated from the template argument Pool, by default a slab allocator
+which recycles the nodes of popped elements through a free list. absorb() hands
+the slabs of h over to this queue along with its nodes, and clear() and the
+destructor release the nodes with a sweep over the slabs instead of a traversal.
 
 Time Complexity:
 - O(1) per call to the first constructor, size(), empty(), and top().
 - O(log n) expected worst case per call to push(), pop(), and absorb(), where n
-is the number of elements currently in the priority queue.
+  is the number of elements currently in the priority queue.
 - O(n) per call to the second constructor on the distance between lo and hi.
+- O(n) per call to clear() and the destructor, or O(s) if T has a trivial
+  destructor, where s is the number of slabs (O(log n) unless heaps have been
+  absorbed). absorb() takes an additional O(s) to take over the slabs of h.
 
 Space Complexity:
 - O(n) for storage of the priority queue elements.
-- O(log n) auxiliary per call to push(), pop(), and absorb().
-- O(1) auxiliary per call to all other operations.
+- O(1) auxiliary per call to all operations, since merging is iterative.
 
 */
 
 #include <algorithm>
 #include <cstdlib>
+#include <new>
 #include <stdexcept>
+#include <vector>
+
+// A slab allocator for nodes with a free list, as in section 3.5.1, which can
+// also take over the nodes of another pool when two heaps are merged.
+template<class T> class node_pool {
+  struct slot {
+    union {
+      char data[sizeof(T)];
+      long double align_float;
+      long long align_int;
+      void *align_pointer;
+    } u;
+    slot *next;
+  };
+
+  struct slab {
+    slot *slots;
+    size_t size, used;
+  };
+
+  std::vector<slab> slabs;
+  slot *free_list, *free_tail;
+
+  node_pool(const node_pool &);
+  node_pool& operator=(const node_pool &);
 
-template<class T> class randomized_heap {
+ public:
+  node_pool() : free_list(NULL), free_tail(NULL) {}
+
+  ~node_pool() {
+    clear();
+  }
+
+  // Returns uninitialized memory for an object, to be constructed in place.
+  void* allocate() {
+    slot *s = free_list;
+    if (s != NULL) {
+      free_list = s->next;
+    } else {
+      if (slabs.empty() || slabs.back().used == slabs.back().size) {
+        slab b;
+        b.size = slabs.empty() ? 64 : 2*slabs.back().size;
+        b.slots = new slot[b.size];
+        b.used = 0;
+        slabs.push_back(b);
+      }
+      s = slabs.back().slots + slabs.back().used++;
+    }
+    s->next = s;
+    return s->u.data;
+  }
+
+  void destroy(T *p) {
+    p->~T();
+    slot *s = (slot*)p;
+    if (free_list == NULL) {
+      free_tail = s;
+    }
+    s->next = free_list;
+    free_list = s;
+  }
+
+  // Takes over the slabs and free slots of p, leaving p empty.
+  void absorb(node_pool &p) {
+    slabs.insert(slabs.end(), p.slabs.begin(), p.slabs.end());
+    if (p.free_list != NULL) {
+      p.free_tail->next = free_list;
+      if (free_list == NULL) {
+        free_tail = p.free_tail;
+      }
+      free_list = p.free_list;
+    }
+    p.slabs.clear();
+    p.free_list = NULL;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < slabs.size(); i++) {
+      if (!__has_trivial_destructor(T)) {
+        for (size_t j = 0; j < slabs[i].used; j++) {
+          slot *s = slabs[i].slots + j;
+          if (s->next == s) {
+            ((T*)s->u.data)->~T();
+          }
+        }
+      }
+      delete[] slabs[i].slots;
+    }
+    slabs.clear();
+    free_list = NULL;
+  }
+};
+
+template<class T, template<class> class Pool = node_pool> class randomized_heap {
   struct node_t {
     T value;
     node_t *left, *right;
@@ -45,31 +146,25 @@ template<class T> class randomized_heap {
   } *root;
 
   int num_nodes;
+  Pool<node_t> pool;
 
+  // Merges down random paths of a and b, linking each node taken to the left
+  // of the previous one.
   static node_t* merge(node_t *a, node_t *b) {
-    if (a == NULL) {
-      return b;
-    }
-    if (b == NULL) {
-      return a;
-    }
-    if (b->value < a->value) {
-      std::swap(a, b);
-    }
-    if (rand() % 2 == 0) {
-      std::swap(a->left, a->right);
-    }
-    a->left = merge(a->left, b);
-    return a;
-  }
-
-  static void clean_up(node_t *n) {
-    if (n == NULL) {
-      return;
+    node_t *res = NULL, **link = &res;
+    while (a != NULL && b != NULL) {
+      if (b->value < a->value) {
+        std::swap(a, b);
+      }
+      if (rand() % 2 == 0) {
+        std::swap(a->left, a->right);
+      }
+      *link = a;
+      link = &a->left;
+      a = a->left;
     }
-    clean_up(n->left);
-    clean_up(n->right);
-    delete n;
+    *link = (a != NULL) ? a : b;
+    return res;
   }
 
  public:
@@ -86,10 +181,6 @@ template<class T> class randomized_heap {
     }
   }
 
-  ~randomized_heap() {
-    clean_up(root);
-  }
-
   int size() {
     return num_nodes;
   }
@@ -98,8 +189,14 @@ template<class T> class randomized_heap {
     return root == NULL;
   }
 
+  void clear() {
+    pool.clear();
+    root = NULL;
+    num_nodes = 0;
+  }
+
   void push(const T &v) {
-    root = merge(root, new node_t(v));
+    root = merge(root, new (pool.allocate()) node_t(v));
     num_nodes++;
   }
 
@@ -109,7 +206,7 @@ template<class T> class randomized_heap {
     }
     node_t *tmp = root;
     root = merge(root->left, root->right);
-    delete tmp;
+    pool.destroy(tmp);
     num_nodes--;
   }
 
@@ -122,7 +219,10 @@ template<class T> class randomized_heap {
 
   void absorb(randomized_heap &h) {
     root = merge(root, h.root);
+    pool.absorb(h.pool);
+    num_nodes += h.num_nodes;
     h.root = NULL;
+    h.num_nodes = 0;
   }
 };
 
@@ -136,6 +236,7 @@ template<class T> class randomized_heap {
 
 ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -147,9 +248,24 @@ int main() {
   h2.push(-1);
   h2.push(0);
   h.absorb(h2);
+  assert(h.size() == 5 && h2.empty());
   while (!h.empty()) {
     cout << h.top() << endl;
     h.pop();
   }
+  h2.push(1);
+  h2.clear();
+  assert(h2.empty() && h2.size() == 0);
+  // Long merge paths are followed in a loop rather than by recursion.
+  for (int i = 0; i < 1000000; i++) {
+    h.push((i % 2 == 0) ? i : -i);
+  }
+  for (int i = -999999; i < 1000000; i++) {
+    if (i % 2 == 0 ? i >= 0 : i < 0) {
+      assert(h.top() == i);
+      h.pop();
+    }
+  }
+  assert(h.empty());
   return 0;
 }
@@ -11,6 +11,9 @@ Note: The following are only defined for nonnegative inputs.
 
 */
 
+#include <algorithm> /* std::min() */
+#include <map>
+#include <stdexcept> /* std::runtime_error() */
 #include <vector>
 
 typedef std::vector<std::vector<long long> > table;
@@ -84,14 +87,19 @@ long long permute(int n, int k, long long m = 1000000007) {
   return res % m;
 }
 
-//number of partitions of n (mod m) in O(n^2)
+//number of partitions of n (mod m) in O(n^1.5), by the recurrence
+//p(i) = sum of (-1)^(j+1) p(i - j(3j -+ 1)/2) over j >= 1 from Euler's
+//pentagonal theorem (see partitions_row() below)
 long long partitions(int n, long long m = 1000000007) {
   std::vector<long long> p(n + 1, 0);
-  p[0] = 1;
+  p[0] = 1 % m;
   for (int i = 1; i <= n; i++)
-    for (int j = i; j <= n; j++)
-      p[j] = (p[j] + p[j - i]) % m;
-  return p[n] % m;
+    for (int j = 1; j * (3 * j - 1) / 2 <= i; j++) {
+      long long s = p[i - j * (3 * j - 1) / 2];
+      if (j * (3 * j + 1) / 2 <= i) s += p[i - j * (3 * j + 1) / 2];
+      p[i] = (j % 2 == 1) ? (p[i] + s) % m : (p[i] + 2 * m - s) % m;
+    }
+  return p[n];
 }
 
 //partitions of n into exactly k parts (mod m) in O(n * k)
@@ -164,6 +172,414 @@ long long catalan(int n, long long p = 1000000007) {
   return choose(2 * n, n, p) * powmod(n + 1, p - 2, p) % p;
 }
 
+/*
+
+combinatorics(n, p) precomputes i! and 1/i! modulo a prime p for every i
+up to min(n, p - 1) in O(n), using only one modular inverse: that of the
+largest factorial, from which 1/(i - 1)! = i * (1/i!) going down. Then
+choose(), multichoose(), permute(), catalan(), and inverse() each take
+O(1) instead of the O(k) of the functions above. For n >= p, choose()
+applies Lucas' theorem, multiplying choose(n_i, k_i) over the base p
+digits n_i and k_i of n and k, which needs the tables to reach p - 1.
+Otherwise, choose() throws an exception for n beyond the tables.
+
+The row functions compute every value for one n at once in O(n log n) by
+convolutions modulo p, through the number-theoretic transform of section
+4.4.3, using three NTT primes and Garner's algorithm when p is not such a
+prime itself. This replaces the O(n^2) tables above for n up to 10^6.
+
+- stirling1_row(n)[k] is the unsigned Stirling number of the first kind,
+  the coefficient of x^k in x(x + 1)...(x + n - 1). The product for 2j
+  factors is that for j times itself with x shifted by j, and this shift
+  of a polynomial P is the convolution of j^t/t! with i!*P_i.
+- stirling2_row(n)[k] is the Stirling number of the second kind, the sum
+  of (-1)^j/j! * (k - j)^n/(k - j)! over j in [0, k].
+- partitions_row(n)[i] is the number of partitions of i. It is the power
+  series inverse of (1 - x)(1 - x^2)..., which by Euler's pentagonal
+  theorem is the sum of (-1)^j * x^(j(3j - 1)/2) over all integers j and
+  is inverted by Newton's iteration g = g(2 - fg) in O(n log n).
+
+binomial_mod(m) computes choose(n, k) modulo any m, after precomputing,
+for each prime power p^e dividing m, the table of the products of the
+integers in [1, i] that are prime to p, for i < p^e. By Granville's
+generalization of Lucas' theorem, n! = p^v * N(n), where v = n/p +
+n/p^2 + ... counts the factors of p, and N(n) = F(n)F(n/p)F(n/p^2)...
+for F(x) the product of the integers in [1, x] prime to p. Since F(p^e)
+is -1 modulo p^e (except 1 for p = 2 and e >= 3), F(x) is +-F(x mod p^e).
+So choose(n, k) is p^v * N(n)/(N(k)N(n - k)) modulo p^e, where v is 0
+unless a carry occurs adding k and n - k in base p. The results for the
+prime powers are combined by the Chinese remainder theorem.
+
+Time Complexity: O(n) for combinatorics(n, p), O(1) per choose() for n
+within the tables, O(log_p n) beyond, and O(n log n) per row. O(m) for
+binomial_mod(m) and O(log m log n) per choose().
+
+Space Complexity: O(n) for combinatorics(n, p) and O(m) for binomial_mod.
+
+*/
+
+class ntt_prime {
+  unsigned int p, pinv, r2; //pinv = -p^-1 mod 2^32, r2 = 2^64 mod p
+  unsigned int g;           //a primitive root modulo p
+  std::vector<unsigned int> roots, iroots;
+
+  unsigned int fix(unsigned int x) const {
+    return x + (p & -(x >> 31));
+  }
+
+  unsigned int reduce(unsigned long long t) const { //t * 2^-32 mod p
+    unsigned int m = (unsigned int)t * pinv;
+    return fix((unsigned int)((t + (unsigned long long)m * p) >> 32) - p);
+  }
+
+  unsigned int add(unsigned int a, unsigned int b) const {
+    return fix(a + b - p);
+  }
+
+  unsigned int sub(unsigned int a, unsigned int b) const {
+    return fix(a - b);
+  }
+
+  void grow(int n) {
+    if ((int)roots.size() >= n) return;
+    if ((p - 1) % n != 0)
+      throw std::runtime_error("Error: transform size does not divide p - 1.");
+    roots.assign(n, 0);
+    iroots.assign(n, 0);
+    for (int len = 1; len < n; len <<= 1) {
+      unsigned int w = to(powmod(g, (p - 1) / (2 * len), p));
+      unsigned int iw = to(powmod(g, p - 1 - (p - 1) / (2 * len), p));
+      roots[len] = iroots[len] = to(1);
+      for (int j = 1; j < len; j++) {
+        roots[len + j] = mul(roots[len + j - 1], w);
+        iroots[len + j] = mul(iroots[len + j - 1], iw);
+      }
+    }
+  }
+
+ public:
+  explicit ntt_prime(unsigned int p): p(p), pinv(1) {
+    for (int i = 0; i < 5; i++) pinv *= 2 - p * pinv; //Newton's iteration
+    pinv = -pinv;
+    r2 = (unsigned int)((((unsigned long long)1 << 32) % p) *
+                        (((unsigned long long)1 << 32) % p) % p);
+    std::vector<unsigned int> factors;
+    unsigned int q = p - 1;
+    for (unsigned int d = 2; d * d <= q; d++) {
+      if (q % d == 0) factors.push_back(d);
+      while (q % d == 0) q /= d;
+    }
+    if (q > 1) factors.push_back(q);
+    for (g = 2; ; g++) {
+      bool ok = true;
+      for (int i = 0; i < (int)factors.size() && ok; i++)
+        ok = powmod(g, (p - 1) / factors[i], p) != 1;
+      if (ok) break;
+    }
+  }
+
+  static ntt_prime & get(unsigned int p) {
+    static std::map<unsigned int, ntt_prime> cache;
+    std::map<unsigned int, ntt_prime>::iterator it = cache.find(p);
+    if (it == cache.end())
+      it = cache.insert(std::make_pair(p, ntt_prime(p))).first;
+    return it->second;
+  }
+
+  unsigned int from(unsigned int a) const { return reduce(a); }
+
+  unsigned int to(unsigned int a) const {
+    return reduce((unsigned long long)a * r2);
+  }
+
+  unsigned int mul(unsigned int a, unsigned int b) const {
+    return reduce((unsigned long long)a * b);
+  }
+
+  //natural to bit-reversed order, or back if inverse is set
+  void transform(unsigned int * a, int n, bool inverse = false) {
+    grow(n);
+    if (!inverse) {
+      for (int len = n >> 1; len >= 1; len >>= 1) {
+        const unsigned int * w = &roots[len];
+        for (int i = 0; i < n; i += 2 * len) {
+          unsigned int * x = a + i, * y = a + i + len;
+          for (int j = 0; j < len; j++) {
+            unsigned int u = x[j], v = y[j];
+            x[j] = add(u, v);
+            y[j] = mul(sub(u, v), w[j]);
+          }
+        }
+      }
+      return;
+    }
+    for (int len = 1; len < n; len <<= 1) {
+      const unsigned int * w = &iroots[len];
+      for (int i = 0; i < n; i += 2 * len) {
+        unsigned int * x = a + i, * y = a + i + len;
+        for (int j = 0; j < len; j++) {
+          unsigned int u = x[j], v = mul(y[j], w[j]);
+          x[j] = add(u, v);
+          y[j] = sub(u, v);
+        }
+      }
+    }
+    unsigned int ninv = to(powmod(n, p - 2, p));
+    for (int i = 0; i < n; i++) a[i] = mul(a[i], ninv);
+  }
+};
+
+typedef std::vector<long long> row;
+
+//the product of a and b modulo the NTT prime q, for entries in [0, m)
+std::vector<unsigned int> ntt_convolve(const row & a, const row & b,
+                                       unsigned int q) {
+  ntt_prime & P = ntt_prime::get(q);
+  int len = a.size() + b.size() - 1, n = 1;
+  while (n < len) n <<= 1;
+  std::vector<unsigned int> fa(n, 0), fb(n, 0);
+  for (int i = 0; i < (int)a.size(); i++) fa[i] = P.to(a[i] % q);
+  for (int i = 0; i < (int)b.size(); i++) fb[i] = P.to(b[i] % q);
+  P.transform(&fa[0], n);
+  P.transform(&fb[0], n);
+  for (int i = 0; i < n; i++) fa[i] = P.mul(fa[i], fb[i]);
+  P.transform(&fa[0], n, true);
+  fa.resize(len);
+  for (int i = 0; i < len; i++) fa[i] = P.from(fa[i]);
+  return fa;
+}
+
+//the product of a and b with entries in [0, m), modulo any m < 2^31
+row convolve_mod(const row & a, const row & b, long long m) {
+  if (a.empty() || b.empty()) return row();
+  int len = a.size() + b.size() - 1;
+  row res(len, 0);
+  if ((int)std::min(a.size(), b.size()) <= 32) {
+    for (int i = 0; i < (int)a.size(); i++)
+      for (int j = 0; j < (int)b.size(); j++)
+        res[i + j] = (res[i + j] + a[i] * b[j]) % m;
+    return res;
+  }
+  static const unsigned int p0 = 998244353, p1 = 167772161, p2 = 469762049;
+  std::vector<unsigned int> c0 = ntt_convolve(a, b, p0);
+  if (m == p0) return row(c0.begin(), c0.end());
+  std::vector<unsigned int> c1 = ntt_convolve(a, b, p1);
+  std::vector<unsigned int> c2 = ntt_convolve(a, b, p2);
+  //Garner's algorithm: c = x0 + x1*p0 + x2*p0*p1 with xi in [0, pi), which
+  //is exact since every coefficient is below len*m^2 < p0*p1*p2
+  long long inv01 = powmod(p0, p1 - 2, p1);
+  long long inv012 = powmod((long long)p0 * p1 % p2, p2 - 2, p2);
+  long long p01 = (long long)p0 * p1 % m;
+  for (int i = 0; i < len; i++) {
+    long long x0 = c0[i];
+    long long x1 = (c1[i] + p1 - x0 % p1) % p1 * inv01 % p1;
+    long long y = (x0 + x1 * p0) % p2;
+    long long x2 = (c2[i] + p2 - y) % p2 * inv012 % p2;
+    res[i] = (x0 + x1 * p0 % m + x2 * p01) % m;
+  }
+  return res;
+}
+
+class combinatorics {
+  long long p;
+
+  //the coefficients of P(x + c) for P of degree below the table size
+  row shift(const row & P, long long c) const {
+    int d = P.size() - 1;
+    row a(d + 1), b(d + 1);
+    long long ct = 1;
+    for (int t = 0; t <= d; t++) {
+      a[t] = P[d - t] * fact[d - t] % p;
+      b[t] = ct * inv_fact[t] % p;
+      ct = ct * (c % p) % p;
+    }
+    row conv = convolve_mod(a, b, p), res(d + 1);
+    for (int i = 0; i <= d; i++) res[i] = conv[d - i] * inv_fact[i] % p;
+    return res;
+  }
+
+ public:
+  row fact, inv_fact;
+
+  explicit combinatorics(int n, long long p = 1000000007): p(p) {
+    if (n >= p) n = p - 1;
+    fact.resize(n + 1);
+    inv_fact.resize(n + 1);
+    fact[0] = 1;
+    for (int i = 1; i <= n; i++) fact[i] = fact[i - 1] * i % p;
+    inv_fact[n] = powmod(fact[n], p - 2, p);
+    for (int i = n; i > 0; i--) inv_fact[i - 1] = inv_fact[i] * i % p;
+  }
+
+  int size() const { return (int)fact.size() - 1; }
+
+  //1/i mod p, for i in [1, size()]
+  long long inverse(int i) const {
+    return inv_fact[i] * fact[i - 1] % p;
+  }
+
+  //n choose k, where n <= size() or size() = p - 1 (for Lucas' theorem)
+  long long choose(long long n, long long k) const {
+    if (k < 0 || k > n) return 0;
+    if (n <= size()) return fact[n] * inv_fact[k] % p * inv_fact[n - k] % p;
+    if (size() < p - 1)
+      throw std::runtime_error("choose() needs n <= size() or size() = p - 1");
+    long long res = 1;
+    for (; n > 0 && res != 0; n /= p, k /= p)
+      res = res * choose(n % p, k % p) % p;
+    return res;
+  }
+
+  long long multichoose(long long n, long long k) const {
+    return choose(n + k - 1, k);
+  }
+
+  //n permute k, where n <= size()
+  long long permute(int n, int k) const {
+    if (k < 0 || k > n) return 0;
+    return fact[n] * inv_fact[n - k] % p;
+  }
+
+  //choose(2n, n) - choose(2n, n + 1), which also works by Lucas' theorem
+  long long catalan(long long n) const {
+    return (choose(2 * n, n) - choose(2 * n, n + 1) + p) % p;
+  }
+
+  //unsigned Stirling numbers of the 1st kind for k in [0, n], n <= size()
+  row stirling1_row(int n) const {
+    row P(1, 1);
+    int h = 0; //P = x(x + 1)...(x + h - 1)
+    for (int bit = 30; bit >= 0; bit--) {
+      if (h > 0) {
+        P = convolve_mod(P, shift(P, h), p);
+        h *= 2;
+      }
+      if ((n >> bit) & 1) {
+        P.push_back(0); //P *= x + h
+        for (int i = h + 1; i > 0; i--)
+          P[i] = (P[i - 1] + P[i] * h) % p;
+        P[0] = P[0] * h % p;
+        h++;
+      }
+    }
+    return P;
+  }
+
+  //Stirling numbers of the 2nd kind for k in [0, n], n <= size()
+  row stirling2_row(int n) const {
+    row a(n + 1), b(n + 1);
+    for (int i = 0; i <= n; i++) {
+      a[i] = (i % 2 == 0) ? inv_fact[i] : (p - inv_fact[i]) % p;
+      b[i] = powmod(i, n, p) * inv_fact[i] % p;
+    }
+    row res = convolve_mod(a, b, p);
+    res.resize(n + 1);
+    return res;
+  }
+
+  //the numbers of partitions of i for i in [0, n]
+  row partitions_row(int n) const {
+    row f(n + 1, 0), g(1, 1);
+    for (long long j = 0; j * (3 * j - 1) / 2 <= n; j++) {
+      long long s = (j % 2 == 0) ? 1 : p - 1;
+      f[j * (3 * j - 1) / 2] = s;
+      if (j > 0 && j * (3 * j + 1) / 2 <= n) f[j * (3 * j + 1) / 2] = s;
+    }
+    for (int len = 1; len <= n; len *= 2) { //g = g(2 - fg) mod x^(2 len)
+      row fg(f.begin(), f.begin() + std::min(2 * len, n + 1));
+      fg = convolve_mod(fg, g, p);
+      fg.resize(std::min(2 * len, n + 1));
+      for (int i = 0; i < (int)fg.size(); i++) fg[i] = (p - fg[i]) % p;
+      fg[0] = (fg[0] + 2) % p;
+      g = convolve_mod(g, fg, p);
+      g.resize(fg.size());
+    }
+    g.resize(n + 1);
+    return g;
+  }
+};
+
+class binomial_mod {
+  struct prime_power {
+    long long p, pe;
+    int e;
+    std::vector<int> F; //F[i] = product of j in [1, i] prime to p, mod pe
+  };
+
+  long long m;
+  std::vector<prime_power> factors;
+
+  //a^-1 mod n by the extended Euclidean algorithm, for gcd(a, n) = 1
+  static long long inverse(long long a, long long n) {
+    long long b = n, x = 1, y = 0;
+    while (b != 0) {
+      long long q = a / b, t = a - q * b;
+      a = b;
+      b = t;
+      t = x - q * y;
+      x = y;
+      y = t;
+    }
+    return (x % n + n) % n;
+  }
+
+  //N(n) mod p^e, the product of n! without its factors of p
+  static long long reduced_factorial(long long n, const prime_power & q) {
+    long long res = 1;
+    for (; n > 0; n /= q.p) {
+      res = res * q.F[n % q.pe] % q.pe;
+      if ((n / q.pe) % 2 == 1) res = res * q.F[q.pe - 1] % q.pe;
+    }
+    return res;
+  }
+
+  static long long choose(long long n, long long k, const prime_power & q) {
+    long long v = 0;
+    for (long long x = n / q.p; x > 0; x /= q.p) v += x;
+    for (long long x = k / q.p; x > 0; x /= q.p) v -= x;
+    for (long long x = (n - k) / q.p; x > 0; x /= q.p) v -= x;
+    if (v >= q.e) return 0;
+    long long res = reduced_factorial(n, q);
+    res = res * inverse(reduced_factorial(k, q), q.pe) % q.pe;
+    res = res * inverse(reduced_factorial(n - k, q), q.pe) % q.pe;
+    for (; v > 0; v--) res = res * q.p % q.pe;
+    return res;
+  }
+
+ public:
+  explicit binomial_mod(long long m): m(m) {
+    for (long long p = 2, r = m; r > 1; p++) {
+      if (p * p > r) p = r;
+      if (r % p != 0) continue;
+      prime_power q;
+      q.p = p;
+      q.pe = 1;
+      for (q.e = 0; r % p == 0; q.e++) {
+        r /= p;
+        q.pe *= p;
+      }
+      q.F.resize(q.pe);
+      q.F[0] = 1 % q.pe;
+      for (long long i = 1; i < q.pe; i++)
+        q.F[i] = (i % p == 0) ? q.F[i - 1] : q.F[i - 1] * i % q.pe;
+      factors.push_back(q);
+    }
+  }
+
+  long long choose(long long n, long long k) const {
+    if (k < 0 || k > n) return 0;
+    long long res = 0, mod = 1; //res mod (the prime powers so far)
+    for (int i = 0; i < (int)factors.size(); i++) {
+      const prime_power & q = factors[i];
+      long long r = choose(n, k, q), t = (r - res % q.pe + q.pe) % q.pe;
+      t = t * inverse(mod % q.pe, q.pe) % q.pe;
+      res += mod * t;
+      mod *= q.pe;
+    }
+    return res % m;
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -189,5 +605,42 @@ int main() {
   assert(eulerian1(9, 5)    == 88234);
   assert(eulerian2(8, 3)    == 195800);
   assert(catalan(10)        == 16796);
+
+  combinatorics c(1000000);
+  assert(c.choose(20, 7) == 77520 && c.multichoose(20, 7) == 657800);
+  assert(c.permute(10, 4) == 5040 && c.catalan(10) == 16796);
+  assert(c.choose(1000000, 500000) == choose(1000000, 500000));
+  assert(c.inverse(12345) * 12345 % 1000000007 == 1);
+  row s1 = c.stirling1_row(50000), s2 = c.stirling2_row(50000);
+  assert(s1[2] == stirling1(50000, 2) && s2[3] == stirling2(50000, 3));
+  row p = c.partitions_row(1000000);
+  assert(p[4] == 5 && p[5000] == partitions(5000));
+  cout << p[1000000] << "\n"; //419139981
+  for (int n = 0; n <= 30; n++) {
+    row a = c.stirling1_row(n), b = c.stirling2_row(n);
+    for (int k = 0; k <= n; k++)
+      assert(a[k] == stirling1(n, k) && b[k] == stirling2(n, k));
+  }
+
+  //Lucas' theorem for n beyond p, with tables covering [0, p)
+  combinatorics small(100, 13);
+  assert(small.choose(1000, 300) == 10);
+  assert(binomial_mod(13).choose(1000, 300) == 10);
+  assert(small.catalan(100) == catalan(100, 13));
+  bool thrown = false;
+  try {
+    combinatorics(10, 13).choose(20, 7);
+  } catch (std::runtime_error &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  //choose(n, k) modulo composite numbers
+  binomial_mod b(720720); //2^4 * 3^2 * 5 * 7 * 11 * 13
+  t = binomial_table(60, 720720);
+  for (int n = 0; n <= 60; n++)
+    for (int k = 0; k <= n; k++)
+      assert(b.choose(n, k) == t[n][k]);
+  assert(binomial_mod(1000000000).choose(1000000, 123456) == 397250000);
   return 0;
 }
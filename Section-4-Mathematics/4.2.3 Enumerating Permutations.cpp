@@ -10,7 +10,7 @@ of any type, not just the integers from 0 to n - 1.
 
 */
 
-#include <algorithm> /* copy, iter_swap, reverse, swap */
+#include <algorithm> /* copy, iter_swap, max, min, reverse, swap */
 #include <vector>
 
 //identical to std::next_permutation()
@@ -160,6 +160,182 @@ template<class T> long long rank_by_permutation(int n, T a[]) {
 
 /*
 
+Enumerates the permutations of the integers in [0, n) in
+independent chunks of consecutive ranks, so that a search
+over all n! of them may be split among processes or
+machines. permutation_chunk() returns the range of ranks
+[lo, hi) of chunk c when [0, n!) is divided into the given
+number of nearly equal chunks. The first enumerate version
+calls report(c, p) on every permutation p with a rank in
+[lo, hi), in lexicographical order, by jumping to the first
+with permutation_by_rank() and then calling next_permutation()
+for the rest in amortized O(1) each, so equal chunks take
+equal time. The chunks share no state, so each may run on its
+own with report accumulating into a separate slot for each
+chunk. The second version simply runs all of the chunks one
+after another.
+
+*/
+
+void permutation_chunk(int n, int chunks, int c,
+                       long long & lo, long long & hi) {
+  long long total = 1;
+  for (int i = 2; i <= n; i++) total *= i;
+  lo = total / chunks * c + std::min<long long>(c, total % chunks);
+  hi = lo + total / chunks + (c < total % chunks ? 1 : 0);
+}
+
+template<class ReportFunction>
+void enumerate_permutations(int n, long long lo, long long hi, int c,
+                            ReportFunction report) {
+  if (lo >= hi) return;
+  std::vector<int> p = permutation_by_rank(n, lo);
+  do {
+    report(c, p);
+  } while (++lo < hi && next_permutation(n, &p[0]));
+}
+
+template<class ReportFunction>
+void enumerate_permutations(int n, int chunks, ReportFunction report) {
+  for (int c = 0; c < chunks; c++) {
+    long long lo, hi;
+    permutation_chunk(n, chunks, c, lo, hi);
+    enumerate_permutations(n, lo, hi, c, report);
+  }
+}
+
+/*
+
+Generates all permutations of the integers in [0, n) in the
+order of the Steinhaus-Johnson-Trotter algorithm ("plain
+changes"), where each permutation differs from the previous
+one by a swap of two adjacent positions. This lets a search
+update the cost of each permutation from the last in O(1),
+instead of evaluating it from scratch. The factorial digits
+of the plain changes order form a reflected Gray code with
+radices n, n - 1, ..., 2, where the fastest digit belongs
+to element n - 1 and counts its moves across the smaller
+elements. Focus pointers find the digit to change without a
+search (Knuth's Algorithm H), so that next() is loopless,
+taking O(1) time in the worst case, not only on average.
+
+next() advances to the next permutation and returns the i
+such that positions i and i + 1 were swapped, or -1 (leaving
+the permutation unchanged) if it was already the last.
+
+*/
+
+class plain_changes {
+  int n;
+  std::vector<int> a, pos; //the permutation and its inverse
+  std::vector<int> digit, dir, focus;
+
+ public:
+  explicit plain_changes(int n)
+      : n(n), a(n), pos(n), digit(std::max(n - 1, 0), 0),
+        dir(std::max(n - 1, 0), 1), focus(std::max(n, 1)) {
+    for (int i = 0; i < n; i++) a[i] = pos[i] = i;
+    for (int j = 0; j < (int)focus.size(); j++) focus[j] = j;
+  }
+
+  const std::vector<int> & permutation() const { return a; }
+
+  int next() {
+    int j = focus[0], d = focus.size() - 1;
+    if (j == d) return -1;
+    focus[0] = 0;
+    digit[j] += dir[j];
+    //element n - 1 - j moves left while its direction is 1
+    int e = n - 1 - j, i = pos[e], k = i - dir[j];
+    std::swap(a[i], a[k]);
+    pos[a[i]] = i;
+    pos[a[k]] = k;
+    if (digit[j] == 0 || digit[j] == n - 1 - j) {
+      dir[j] = -dir[j];
+      focus[j] = focus[j + 1];
+      focus[j + 1] = j + 1;
+    }
+    return std::min(i, k);
+  }
+};
+
+/*
+
+Ranks and unranks permutations of [0, n) in lexicographical
+order like rank_by_permutation() and permutation_by_rank(),
+but with the rank in any integer type Int, such as unsigned
+__int128 (for n up to 34) or the bigint of section 4.4.2
+(for any n), since n! overflows a long long past n = 20. Int
+only needs construction from int, addition, and products,
+quotients, and remainders by an int, never a full division.
+The rank is evaluated by Horner's rule in the factorial
+number system, and unranking takes its digits from the low
+end by dividing by 1, 2, ..., n. Each digit is converted to
+or from an element by a Fenwick tree of the unused elements,
+so each direction takes O(n log n) small operations and O(n)
+operations on Int, instead of the O(n^2) of the above.
+
+*/
+
+template<class Int> class permutation_ranking {
+  int n, high; //high = the highest power of two up to n
+  Int total;
+
+  //add adds v to the count of unused elements at index i
+  static void add(std::vector<int> & bit, int i, int v) {
+    for (i++; i < (int)bit.size(); i += i & -i) bit[i] += v;
+  }
+
+  void reset(std::vector<int> & bit) const { //all n elements unused
+    bit.assign(n + 1, 0);
+    for (int i = 1; i <= n; i++) bit[i] = i & -i;
+  }
+
+ public:
+  explicit permutation_ranking(int n): n(n), high(1), total(1) {
+    while (2 * high <= n) high *= 2;
+    for (int i = 2; i <= n; i++) total = total * i;
+  }
+
+  Int count() const { return total; }
+
+  Int rank(const std::vector<int> & a) const {
+    std::vector<int> bit;
+    reset(bit);
+    Int res(0);
+    for (int i = 0; i < n; i++) {
+      int v = 0; //the number of unused elements below a[i]
+      for (int j = a[i]; j > 0; j -= j & -j) v += bit[j];
+      add(bit, a[i], -1);
+      res = res * (n - i) + Int(v);
+    }
+    return res;
+  }
+
+  std::vector<int> unrank(Int x) const {
+    std::vector<int> d(n), res(n), bit;
+    for (int m = 1; m <= n; m++) {
+      d[n - m] = (int)(x % m);
+      x = x / m;
+    }
+    reset(bit);
+    for (int i = 0; i < n; i++) {
+      //finds the (d[i] + 1)-th unused element by descending the tree
+      int at = 0, left = d[i];
+      for (int step = high; step > 0; step >>= 1)
+        if (at + step <= n && bit[at + step] <= left) {
+          at += step;
+          left -= bit[at];
+        }
+      res[i] = at;
+      add(bit, at, -1);
+    }
+    return res;
+  }
+};
+
+/*
+
 Given a permutation a[] of the integers from 0 to n - 1,
 returns a decomposition of the permutation into cycles.
 A permutation cycle is a subset of a permutation whose
@@ -209,6 +385,17 @@ template<class it> void print(it lo, it hi) {
   cout << "\n";
 }
 
+//checks that each chunk visits its ranks in order, and counts them
+struct chunk_checker {
+  int n;
+  long long * next, * count;
+
+  void operator () (int c, const vector<int> & p) const {
+    assert(rank_by_permutation(n, &p[0]) == next[c]++);
+    count[c]++;
+  }
+};
+
 int main() {
   { //method 1: ordered
     int n = 4, a[] = {0, 1, 2, 3};
@@ -259,5 +446,52 @@ int main() {
       cout << "\n";
     }
   }
+
+  { //chunked enumeration
+    int n = 8, chunks = 7;
+    long long next[7], count[7] = {0}, lo, hi;
+    for (int c = 0; c < chunks; c++)
+      permutation_chunk(n, chunks, c, next[c], hi);
+    chunk_checker check = {n, next, count};
+    enumerate_permutations(n, chunks, check);
+    cout << "\nPermutations of 8 items per chunk:";
+    for (int c = 0; c < chunks; c++) {
+      cout << " " << count[c];
+      permutation_chunk(n, chunks, c, lo, hi);
+      assert(next[c] == hi && count[c] == hi - lo);
+    }
+    cout << "\n";
+    assert(hi == 40320);
+  }
+
+  { //plain changes, each differing from the last by one adjacent swap
+    cout << "\nPlain changes of 0 to 3:\n";
+    plain_changes pc(4);
+    int i, cnt = 1;
+    print(pc.permutation().begin(), pc.permutation().end());
+    while ((i = pc.next()) >= 0) {
+      cout << "swap " << i << " and " << i + 1 << ": ";
+      print(pc.permutation().begin(), pc.permutation().end());
+      cnt++;
+    }
+    assert(cnt == 24 && pc.next() == -1);
+  }
+
+  { //ranks beyond 64 bits
+    permutation_ranking<long long> r(8);
+    vector<int> a = permutation_by_rank(8, 12345);
+    assert(r.rank(a) == 12345 && r.unrank(12345) == a);
+#ifdef __SIZEOF_INT128__
+    typedef unsigned __int128 uint128;
+    permutation_ranking<uint128> big(30);
+    vector<int> b(30);
+    for (int i = 0; i < 30; i++) b[i] = 29 - i;
+    assert(big.rank(b) == big.count() - 1);
+    uint128 x = big.count() / 3;
+    assert(big.rank(big.unrank(x)) == x);
+    assert((unsigned long long)(big.count() >> 64) == 14379386343318ULL);
+    assert((unsigned long long)big.count() == 9682165104862298112ULL);
+#endif
+  }
   return 0;
 }
@@ -9,7 +9,7 @@ combination for purposes of the functions below.
 
 */
 
-#include <algorithm> /* iter_swap, rotate, swap, swap_ranges */
+#include <algorithm> /* iter_swap, min, rotate, swap, swap_ranges */
 #include <iterator>  /* std::iterator_traits */
 #include <vector>
 
@@ -179,6 +179,162 @@ long long rank_by_combination(int n, int k, int a[]) {
 
 /*
 
+Enumerates the combinations of k distinct integers in [0, n)
+in independent chunks of consecutive ranks, as is done for
+permutations in the previous section. combination_chunk()
+returns the range of ranks [lo, hi) of chunk c when the
+ranks [0, n choose k) are divided into the given number of
+nearly equal chunks. The first enumerate version calls
+report(c, a) on every combination a with a rank in [lo, hi),
+in lexicographical order, starting at combination_by_rank()
+and stepping with next_combination(), and since the chunks
+share no state, each may run on its own. The second version
+runs all of the chunks one after another.
+
+*/
+
+void combination_chunk(int n, int k, int chunks, int c,
+                       long long & lo, long long & hi) {
+  long long total = n_choose_k(n, k);
+  lo = total / chunks * c + std::min<long long>(c, total % chunks);
+  hi = lo + total / chunks + (c < total % chunks ? 1 : 0);
+}
+
+template<class ReportFunction>
+void enumerate_combinations(int n, int k, long long lo, long long hi,
+                            int c, ReportFunction report) {
+  if (lo >= hi) return;
+  std::vector<int> a = combination_by_rank(n, k, lo);
+  do {
+    report(c, a);
+  } while (++lo < hi && next_combination(n, k, &a[0]));
+}
+
+template<class ReportFunction>
+void enumerate_combinations(int n, int k, int chunks, ReportFunction report) {
+  for (int c = 0; c < chunks; c++) {
+    long long lo, hi;
+    combination_chunk(n, k, chunks, c, lo, hi);
+    enumerate_combinations(n, k, lo, hi, c, report);
+  }
+}
+
+/*
+
+Generates all combinations of k distinct integers in [0, n)
+in the revolving door order, a Gray code in which each one
+differs from the previous one by removing a single element
+and adding another, so that a search may update the cost of
+each combination from the last in O(1). The order is given by
+C(n, k) = C(n - 1, k) followed by the reverse of C(n - 1, k - 1)
+with n - 1 added to each, and the elements are kept in sorted
+order. next() follows Knuth's Algorithm R, which only scans
+past the first few elements rarely, taking O(1) amortized time
+per combination. It advances to the next combination, storing
+the element removed in out and the element added in in, and
+returns false (leaving the combination unchanged) if it was
+already the last.
+
+*/
+
+class revolving_door {
+  int n, k;
+  std::vector<int> c; //c[1..k] is the combination, and c[k + 1] = n
+
+ public:
+  revolving_door(int n, int k): n(n), k(k), c(k + 2) {
+    for (int j = 1; j <= k; j++) c[j] = j - 1;
+    c[k + 1] = n;
+  }
+
+  int size() const { return k; }
+  int operator [] (int i) const { return c[i + 1]; }
+
+  bool next(int & out, int & in) {
+    if (k == 0 || k == n) return false;
+    if (k % 2 == 1 && c[1] + 1 < c[2]) {
+      out = c[1]++;
+      in = c[1];
+      return true;
+    }
+    if (k % 2 == 0 && c[1] > 0) {
+      out = c[1]--;
+      in = c[1];
+      return true;
+    }
+    //alternately tries to decrease and to increase c[j] for j = 2, 3, ...
+    bool decrease = (k % 2 == 1);
+    for (int j = 2; j <= k; j++, decrease = !decrease) {
+      if (decrease && c[j] >= j) { //here c[j] = c[j - 1] + 1
+        out = c[j];
+        in = j - 2;
+        c[j] = c[j - 1];
+        c[j - 1] = j - 2;
+        return true;
+      }
+      if (!decrease && c[j] + 1 < c[j + 1]) { //here c[j - 1] = j - 2
+        out = j - 2;
+        in = c[j] + 1;
+        c[j - 1] = c[j];
+        c[j]++;
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+/*
+
+Ranks and unranks combinations of k distinct integers in [0, n)
+in lexicographical order like rank_by_combination() and
+combination_by_rank(), but with the rank in any integer type
+Int, such as unsigned __int128 or the bigint of section 4.4.2,
+since n choose k overflows a long long for n as small as 67.
+The constructor precomputes a table of every i choose j for
+i <= n and j <= k by Pascal's rule, using only additions of
+Int, so that both directions take O(n) additions, subtractions,
+and comparisons of Int, and no products or divisions at all.
+
+*/
+
+template<class Int> class combination_ranking {
+  int n, k;
+  std::vector<std::vector<Int> > C; //C[i][j] = i choose j
+
+ public:
+  combination_ranking(int n, int k)
+      : n(n), k(k), C(n + 1, std::vector<Int>(k + 1, Int(0))) {
+    for (int i = 0; i <= n; i++) {
+      C[i][0] = Int(1);
+      for (int j = 1; j <= k && j <= i; j++)
+        C[i][j] = C[i - 1][j - 1] + C[i - 1][j];
+    }
+  }
+
+  Int count() const { return C[n][k]; }
+
+  Int rank(const std::vector<int> & a) const {
+    Int res(0);
+    for (int i = 0, j = 0; i < k; i++, j++)
+      for (; j < a[i]; j++) res = res + C[n - 1 - j][k - 1 - i];
+    return res;
+  }
+
+  std::vector<int> unrank(Int x) const {
+    std::vector<int> res(k);
+    for (int i = 0, j = 0; i < k; i++, j++) {
+      //skips the C[n - 1 - j][k - 1 - i] combinations that start with j
+      for (; !(x < C[n - 1 - j][k - 1 - i]); j++)
+        x = x - C[n - 1 - j][k - 1 - i];
+      res[i] = j;
+    }
+    return res;
+  }
+};
+
+/*
+
 Changes a[] to the next lexicographically greater
 combination of any k (not necessarily distinct) integers
 in range [0, n). The values of a[] that's passed should
@@ -209,6 +365,17 @@ template<class it> void print(it lo, it hi) {
   cout << "\n";
 }
 
+//checks that each chunk visits its ranks in order, and counts them
+struct chunk_checker {
+  int n, k;
+  long long * next, * count;
+
+  void operator () (int c, vector<int> & a) const {
+    assert(rank_by_combination(n, k, &a[0]) == next[c]++);
+    count[c]++;
+  }
+};
+
 int main() {
   { //like std::next_permutation(), repeats in the range allowed
     int k = 3;
@@ -256,6 +423,53 @@ int main() {
     do {
       print(a, a + k);
     } while (next_combination_with_repeats(n, k, a));
+    cout << "\n";
+  }
+
+  { //chunked enumeration
+    int n = 20, k = 6, chunks = 4;
+    long long next[4], count[4] = {0}, lo, hi;
+    for (int c = 0; c < chunks; c++)
+      combination_chunk(n, k, chunks, c, next[c], hi);
+    chunk_checker check = {n, k, next, count};
+    enumerate_combinations(n, k, chunks, check);
+    cout << "20 choose 6 per chunk:";
+    for (int c = 0; c < chunks; c++) {
+      cout << " " << count[c];
+      combination_chunk(n, k, chunks, c, lo, hi);
+      assert(next[c] == hi && count[c] == hi - lo);
+    }
+    cout << "\n";
+    assert(hi == 38760);
+  }
+
+  { //revolving door, each differing from the last by one element
+    cout << "\n5 choose 3 in revolving door order:\n";
+    revolving_door rd(5, 3);
+    int out, in, cnt = 1;
+    for (int i = 0; i < rd.size(); i++) cout << rd[i] << " ";
+    cout << "\n";
+    while (rd.next(out, in)) {
+      for (int i = 0; i < rd.size(); i++) cout << rd[i] << " ";
+      cout << "(-" << out << " +" << in << ")\n";
+      cnt++;
+    }
+    assert(cnt == 10);
+  }
+
+  { //ranks beyond 64 bits
+    combination_ranking<long long> r(20, 6);
+    vector<int> a = combination_by_rank(20, 6, 12345);
+    assert(r.rank(a) == 12345 && r.unrank(12345) == a);
+#ifdef __SIZEOF_INT128__
+    typedef unsigned __int128 uint128;
+    combination_ranking<uint128> big(100, 50);
+    vector<int> b(50);
+    for (int i = 0; i < 50; i++) b[i] = 50 + i;
+    assert(big.rank(b) == big.count() - 1);
+    uint128 x = big.count() / 3;
+    assert(big.rank(big.unrank(x)) == x);
+#endif
   }
   return 0;
 }
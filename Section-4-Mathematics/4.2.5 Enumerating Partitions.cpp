@@ -62,7 +62,7 @@ long long partition_function(int a, int b) {
     p[0].resize(a + 1);
     for (int i = 1; i <= a; i++) {
       p[i].resize(a + 1);
-      for (int j = old; j <= i; j++)
+      for (int j = (i < old) ? old : 1; j <= i; j++)
         p[i][j] = p[i - 1][j - 1] + p[i - j][j];
     }
   }
@@ -123,6 +123,50 @@ long long rank_by_partition(const std::vector<int> & p) {
 
 /*
 
+Enumerates the partitions of n in independent chunks of
+consecutive ranks, as is done for permutations in section
+4.2.3. partition_chunk() returns the range of ranks [lo, hi)
+of chunk c when the ranks [0, count_partitions(n)) are split
+into the given number of nearly equal chunks. It also fills
+the memoization table of partition_function() up to n, after
+which partition_by_rank() only reads it, so that the chunks
+may then run concurrently. The first enumerate version calls
+report(c, p) on every partition p with a rank in [lo, hi),
+in lexicographical order, starting at partition_by_rank()
+and stepping with next_partition(). The second version runs
+all of the chunks one after another.
+
+*/
+
+void partition_chunk(int n, int chunks, int c,
+                     long long & lo, long long & hi) {
+  partition_function(n, 0);
+  long long total = count_partitions(n);
+  lo = total / chunks * c + (c < total % chunks ? c : total % chunks);
+  hi = lo + total / chunks + (c < total % chunks ? 1 : 0);
+}
+
+template<class ReportFunction>
+void enumerate_partitions(int n, long long lo, long long hi, int c,
+                          ReportFunction report) {
+  if (lo >= hi) return;
+  std::vector<int> p = partition_by_rank(n, lo);
+  do {
+    report(c, p);
+  } while (++lo < hi && next_partition(p));
+}
+
+template<class ReportFunction>
+void enumerate_partitions(int n, int chunks, ReportFunction report) {
+  for (int c = 0; c < chunks; c++) {
+    long long lo, hi;
+    partition_chunk(n, chunks, c, lo, hi);
+    enumerate_partitions(n, lo, hi, c, report);
+  }
+}
+
+/*
+
 Calls the custom function f(vector) on all partitions
 which consist of strictly *increasing* integers.
 This will exclude partitions such as {1, 1, 1, 1}.
@@ -159,6 +203,16 @@ void print(const vector<int> & v) {
   cout << "\n";
 }
 
+//checks that each chunk visits its ranks in order, and counts them
+struct chunk_checker {
+  long long * next, * count;
+
+  void operator () (int c, const vector<int> & p) const {
+    assert(rank_by_partition(p) == next[c]++);
+    count[c]++;
+  }
+};
+
 int main() {
   assert(count_partitions(5) == 7);
   assert(count_partitions(20) == 627);
@@ -185,6 +239,24 @@ int main() {
     int n = 8;
     cout << "Increasing partitions of " << n << ":\n";
     gen_increasing_partitons(n, print);
+    cout << "\n";
+  }
+
+  { //chunked enumeration
+    int n = 40, chunks = 5;
+    long long next[5], count[5] = {0}, lo, hi;
+    for (int c = 0; c < chunks; c++)
+      partition_chunk(n, chunks, c, next[c], hi);
+    chunk_checker check = {next, count};
+    enumerate_partitions(n, chunks, check);
+    cout << "Partitions of 40 per chunk:";
+    for (int c = 0; c < chunks; c++) {
+      cout << " " << count[c];
+      partition_chunk(n, chunks, c, lo, hi);
+      assert(next[c] == hi && count[c] == hi - lo);
+    }
+    cout << "\n";
+    assert(hi == 37338);
   }
   return 0;
 }
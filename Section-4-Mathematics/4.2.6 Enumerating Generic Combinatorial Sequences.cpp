@@ -3,71 +3,141 @@
 The follow provides a universal method for enumerating
 abstract combinatorial sequences in O(n^2) time.
 
+A sequence of length values in [0, range) is described by
+a derived class D of enumeration<D> (the curiously recurring
+template pattern) defining count(pre, size), the number of
+valid sequences that start with the prefix pre[0..size), so
+that every call is resolved at compile time and may be
+inlined, with no virtual dispatch. to_number() and
+from_number() rank and unrank sequences in lexicographical
+order with O(length * range) calls to count().
+
+enumerate(report, lo, hi) calls report(seq) on each sequence
+with a rank in [lo, hi) (by default, all of them), passing a
+const reference to one buffer that is updated in place, so
+no sequence is copied. It unranks lo once and then steps
+with next(seq), which the base class defines generically, by
+finding the last position that can be increased to a value
+with a nonzero count and completing the rest minimally, but
+which a derived class may hide with a faster successor, as
+permutations, combinations, and partitions below do in O(1)
+amortized time. enumerate_until(visit, lo, hi) stops at the
+first sequence for which visit(seq) returns true, returning
+its rank (or hi if there is none). chunk(chunks, c, lo, hi)
+gives the ranks of chunk c of a split of all sequences into
+nearly equal chunks. Every method is const, so that chunks
+may be enumerated concurrently on one shared object.
+
 */
 
+#include <algorithm> /* std::min(), std::next_permutation() */
 #include <vector>
 
-class abstract_enumeration {
+template<class Derived> class enumeration {
  protected:
   int range, length;
 
-  abstract_enumeration(int r, int l): range(r), length(l) {}
+  enumeration(int r, int l): range(r), length(l) {}
 
-  virtual long long count(const std::vector<int> & pre) {
-    return 0;
+  const Derived & self() const {
+    return static_cast<const Derived &>(*this);
   }
 
-  std::vector<int> next(std::vector<int> & seq) {
-    return from_number(to_number(seq) + 1);
+  //the elements of seq for count(), which never indexes an empty vector
+  static const int * prefix(const std::vector<int> & seq) {
+    return seq.empty() ? 0 : &seq[0];
   }
 
-  long long total_count() {
-    return count(std::vector<int>(0));
+  //sets seq[i..length) to the smallest valid completion of seq[0..i)
+  void complete(std::vector<int> & seq, int i) const {
+    for (; i < length; i++)
+      for (seq[i] = 0; self().count(prefix(seq), i + 1) == 0; seq[i]++)
+        /* pass */;
+  }
+
+ public:
+  long long total_count() const {
+    int empty = 0;
+    return self().count(&empty, 0);
   }
 
-public:
-  long long to_number(const std::vector<int> & seq) {
+  long long to_number(const std::vector<int> & seq) const {
+    std::vector<int> pre(seq);
     long long res = 0;
     for (int i = 0; i < (int)seq.size(); i++) {
-      std::vector<int> pre(seq.begin(), seq.end());
-      pre.resize(i + 1);
       for (pre[i] = 0; pre[i] < seq[i]; ++pre[i])
-        res += count(pre);
+        res += self().count(prefix(pre), i + 1);
     }
     return res;
   }
 
-  std::vector<int> from_number(long long x) {
-    std::vector<int> seq(length);
-    for (int i = 0; i < (int)seq.size(); i++) {
-      std::vector<int> pre(seq.begin(), seq.end());
-      pre.resize(i + 1);
-      for (pre[i] = 0; pre[i] < range; ++pre[i]) {
-        long long cur = count(pre);
+  void from_number(long long x, std::vector<int> & seq) const {
+    seq.assign(length, 0);
+    for (int i = 0; i < length; i++)
+      for (seq[i] = 0; seq[i] < range; ++seq[i]) {
+        long long cur = self().count(prefix(seq), i + 1);
         if (x < cur) break;
         x -= cur;
       }
-      seq[i] = pre[i];
-    }
+  }
+
+  std::vector<int> from_number(long long x) const {
+    std::vector<int> seq;
+    from_number(x, seq);
     return seq;
   }
 
+  //advances seq to its successor, or returns false (leaving seq
+  //unspecified) if it is the last
+  bool next(std::vector<int> & seq) const {
+    for (int i = length - 1; i >= 0; i--)
+      for (seq[i]++; seq[i] < range; seq[i]++)
+        if (self().count(prefix(seq), i + 1) > 0) {
+          complete(seq, i + 1);
+          return true;
+        }
+    return false;
+  }
+
   template<class ReportFunction>
-  void enumerate(ReportFunction report) {
+  void enumerate(ReportFunction report, long long lo = 0,
+                 long long hi = -1) const {
+    if (hi < 0) hi = total_count();
+    if (lo >= hi) return;
+    std::vector<int> seq;
+    const std::vector<int> & view = seq;
+    from_number(lo, seq);
+    do {
+      report(view);
+    } while (++lo < hi && self().next(seq));
+  }
+
+  template<class VisitFunction>
+  long long enumerate_until(VisitFunction visit, long long lo = 0,
+                            long long hi = -1) const {
+    if (hi < 0) hi = total_count();
+    if (lo >= hi) return hi;
+    std::vector<int> seq;
+    const std::vector<int> & view = seq;
+    from_number(lo, seq);
+    do {
+      if (visit(view)) return lo;
+    } while (++lo < hi && self().next(seq));
+    return hi;
+  }
+
+  void chunk(int chunks, int c, long long & lo, long long & hi) const {
     long long total = total_count();
-    for (long long i = 0; i < total; i++) {
-      //assert(i == to_number(from_number(i));
-      report(from_number(i));
-    }
+    lo = total / chunks * c + std::min<long long>(c, total % chunks);
+    hi = lo + total / chunks + (c < total % chunks ? 1 : 0);
   }
 };
 
-class arrangements: public abstract_enumeration {
+class arrangements: public enumeration<arrangements> {
  public:
-  arrangements(int n, int k) : abstract_enumeration(n, k) {}
+  arrangements(int n, int k) : enumeration<arrangements>(n, k) {}
 
-  long long count(const std::vector<int> & pre) {
-    int sz = pre.size();
+  long long count(const int * pre, int sz) const {
     for (int i = 0; i < sz - 1; i++)
       if (pre[i] == pre[sz - 1]) return 0;
     long long res = 1;
@@ -77,16 +147,28 @@ class arrangements: public abstract_enumeration {
   }
 };
 
-class permutations: public arrangements {
+class permutations: public enumeration<permutations> {
  public:
-  permutations(int n) : arrangements(n, n) {}
+  permutations(int n) : enumeration<permutations>(n, n) {}
+
+  long long count(const int * pre, int sz) const {
+    for (int i = 0; i < sz - 1; i++)
+      if (pre[i] == pre[sz - 1]) return 0;
+    long long res = 1;
+    for (int i = 2; i <= length - sz; i++) res *= i;
+    return res;
+  }
+
+  bool next(std::vector<int> & seq) const {
+    return std::next_permutation(seq.begin(), seq.end());
+  }
 };
 
-class combinations: public abstract_enumeration {
+class combinations: public enumeration<combinations> {
   std::vector<std::vector<long long> > binomial;
 
  public:
-  combinations(int n, int k) : abstract_enumeration(n, k),
+  combinations(int n, int k) : enumeration<combinations>(n, k),
    binomial(n + 1, std::vector<long long>(n + 1, 0)) {
     for (int i = 0; i <= n; i++)
       for (int j = 0; j <= i; j++)
@@ -94,19 +176,29 @@ class combinations: public abstract_enumeration {
               binomial[i - 1][j - 1] + binomial[i - 1][j];
   }
 
-  long long count(const std::vector<int> & pre) {
-    int sz = pre.size();
+  long long count(const int * pre, int sz) const {
     if (sz >= 2 && pre[sz - 1] <= pre[sz - 2]) return 0;
     int last = sz > 0 ? pre[sz - 1] : -1;
+    if (range - 1 - last < length - sz) return 0;
     return binomial[range - 1 - last][length - sz];
   }
+
+  bool next(std::vector<int> & seq) const {
+    for (int i = length - 1; i >= 0; i--)
+      if (seq[i] < range - length + i) {
+        for (++seq[i]; ++i < length; ) seq[i] = seq[i - 1] + 1;
+        return true;
+      }
+    return false;
+  }
 };
 
-class partitions: public abstract_enumeration {
+//partitions of n as nonincreasing sequences of length n, padded with 0
+class partitions: public enumeration<partitions> {
   std::vector<std::vector<long long> > p;
 
  public:
-  partitions(int n) : abstract_enumeration(n + 1, n),
+  partitions(int n) : enumeration<partitions>(n + 1, n),
    p(n + 1, std::vector<long long>(n + 1, 0)) {
     std::vector<std::vector<long long> > pp(p);
     pp[0][0] = 1;
@@ -118,19 +210,35 @@ class partitions: public abstract_enumeration {
         p[i][j] = pp[i][j] + p[i][j - 1];
   }
 
-  long long count(const std::vector<int> & pre) {
-    int size = pre.size(), sum = 0;
-    for (int i = 0; i < (int)pre.size(); i++) sum += pre[i];
+  long long count(const int * pre, int size) const {
+    int sum = 0;
+    for (int i = 0; i < size; i++) sum += pre[i];
     if (sum == range - 1) return 1;
     if (sum > range - 1 || (size > 0 && pre[size - 1] == 0) ||
         (size >= 2 && pre[size - 1] > pre[size - 2])) return 0;
     int last = size > 0 ? pre[size - 1] : range - 1;
     return p[range - 1 - sum][last];
   }
+
+  //as next_partition() of section 4.2.5, with the padding
+  bool next(std::vector<int> & seq) const {
+    int m = 0;
+    while (m < length && seq[m] > 0) m++;
+    if (m <= 1) return false;
+    int s = seq[m - 1] - 1, i = m - 2;
+    seq[m - 1] = 0;
+    for (; i > 0 && seq[i] == seq[i - 1]; i--) {
+      s += seq[i];
+      seq[i] = 0;
+    }
+    for (seq[i]++; s > 0; s--) seq[++i] = 1;
+    return true;
+  }
 };
 
 /*** Example Usage ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -140,6 +248,32 @@ void print(const std::vector<int> & v) {
   cout << "\n";
 }
 
+//checks that the sequences arrive in order of their ranks
+template<class Enumeration> struct rank_checker {
+  const Enumeration * e;
+  long long * next;
+
+  void operator () (const std::vector<int> & seq) const {
+    assert(e->to_number(seq) == (*next)++);
+  }
+};
+
+template<class Enumeration> void check(const Enumeration & e) {
+  for (int chunks = 1; chunks <= 3; chunks++)
+    for (int c = 0; c < chunks; c++) {
+      long long lo, hi;
+      e.chunk(chunks, c, lo, hi);
+      rank_checker<Enumeration> r = {&e, &lo};
+      e.enumerate(r, lo, hi);
+      assert(lo == hi);
+    }
+}
+
+//the first permutation whose first element exceeds its last by 3
+bool spread(const std::vector<int> & v) {
+  return v[0] - v[v.size() - 1] == 3;
+}
+
 int main() {
   cout << "Arrangement(3, 2):\n";
   arrangements arrg(3, 2);
@@ -156,5 +290,14 @@ int main() {
   cout << "Partition(4):\n";
   partitions part(4);
   part.enumerate(print);
+
+  check(arrangements(6, 3));
+  check(permutations(6));
+  check(combinations(8, 3));
+  check(partitions(12));
+  long long x = perm.enumerate_until(spread);
+  assert(x == perm.total_count()); //none exist for 3 items
+  x = permutations(5).enumerate_until(spread);
+  print(permutations(5).from_number(x)); //3 1 2 4 0
   return 0;
 }
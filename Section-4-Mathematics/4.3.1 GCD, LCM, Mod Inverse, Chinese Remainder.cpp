@@ -4,9 +4,14 @@ GCD, LCM, Modular Inverse, Chinese Remainder Theorem
 
 */
 
-#include <utility> /* std::pair */
+#include <algorithm> /* std::copy(), std::fill(), std::min(), std::swap() */
+#include <utility>   /* std::pair */
 #include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h> /* _mm_mul_epu32(), _mm_add_epi64(), ... */
+#endif
+
 //C++98 does not have abs() declared for long long
 template<class T> inline T _abs(const T & x) {
   return x < 0 ? -x : x;
@@ -27,6 +32,31 @@ template<class Int> Int gcd2(Int a, Int b) {
   return _abs(a);
 }
 
+inline int trailing_zeros(unsigned long long x) {
+#ifdef __GNUC__
+  return __builtin_ctzll(x);
+#else
+  int s = 0;
+  for (; (x & 1) == 0; x >>= 1) s++;
+  return s;
+#endif
+}
+
+//binary GCD (Stein's algorithm), which replaces the divisions of Euclid's
+//algorithm by shifts and subtractions - O(log(a + b))
+template<class Int> Int binary_gcd(Int a, Int b) {
+  unsigned long long u = _abs(a), v = _abs(b);
+  if (u == 0 || v == 0) return (Int)(u | v);
+  int shift = trailing_zeros(u | v);
+  u >>= trailing_zeros(u);
+  do {
+    v >>= trailing_zeros(v);
+    if (u > v) std::swap(u, v);
+    v -= u;
+  } while (v != 0);
+  return (Int)(u << shift);
+}
+
 template<class Int> Int lcm(Int a, Int b) {
   return _abs(a / gcd(a, b) * b);
 }
@@ -104,6 +134,26 @@ std::vector<int> generate_inverses(int p) {
   return res;
 }
 
+//returns a vector where a[i]*v[i] = 1 (mod m) using one call to
+//mod_inverse() and 3(n - 1) multiplications (Montgomery's trick): the
+//inverse of the product of all a[i] is multiplied back by prefix products
+//precondition: m > 0, m*m fits in a long long, and gcd(a[i], m) = 1
+std::vector<long long> batch_inverses(const std::vector<long long> & a,
+                                      long long m) {
+  int n = a.size();
+  std::vector<long long> res(n);
+  if (n == 0) return res;
+  res[0] = mod(a[0], m); //res[i] = a[0]*a[1]*...*a[i] (mod m)
+  for (int i = 1; i < n; i++) res[i] = res[i - 1] * mod(a[i], m) % m;
+  long long inv = mod_inverse(res[n - 1], m);
+  for (int i = n - 1; i > 0; i--) {
+    res[i] = inv * res[i - 1] % m;
+    inv = inv * mod(a[i], m) % m;
+  }
+  res[0] = inv;
+  return res;
+}
+
 /*
 
 Chinese Remainder Theorem
@@ -146,12 +196,10 @@ long long simple_restore(int n, int a[], int p[]) {
 long long garner_restore(int n, int a[], int p[]) {
   int x[n];
   for (int i = 0; i < n; i++) x[i] = a[i];
-  for (int i = 0; i < n; i++) {
+  for (int i = 0; i < n; i++)
     for (int j = 0; j < i; j++)
-      x[i] = mod_inverse((long long)p[j], (long long)p[i]) *
-                         (long long)(x[i] - x[j]);
-      x[i] = (x[i] % p[i] + p[i]) % p[i];
-  }
+      x[i] = (int)mod(mod_inverse((long long)p[j], (long long)p[i]) *
+                      (long long)(x[i] - x[j]), (long long)p[i]);
   long long res = x[0], m = 1;
   for (int i = 1; i < n; i++) {
     m *= p[i - 1];
@@ -160,6 +208,363 @@ long long garner_restore(int n, int a[], int p[]) {
   return res;
 }
 
+/*
+
+Montgomery and Barrett Modular Arithmetic
+
+modint<MOD> is a value type for arithmetic modulo an odd constant
+MOD < 2^30, stored in Montgomery form (x*2^32 mod MOD), in which a
+product takes two integer multiplications and no division. Its
+constants -MOD^-1 mod 2^32 and 2^64 mod MOD are computed at compile
+time as static constants (by Newton's iteration for the inverse,
+which doubles its number of correct bits in each of four steps
+from the 3 bits of MOD itself). add(), mul(), and pow() apply an
+operation to whole arrays of modint, using SSE2 for four products
+at a time where it is available, and branch-free loops which the
+compiler may vectorize otherwise.
+
+barrett reduces modulo any runtime modulus m < 2^32 without a
+division, by multiplying with the precomputed floor(2^64 / m) and
+correcting the estimated quotient by at most one.
+
+garner_batch(p) precomputes, for pairwise coprime moduli p[i] < 2^31,
+the tables of the products p[0]p[1]...p[j - 1] modulo each p[i] and
+their inverses, in Montgomery form. restore() then reconstructs each
+of n values x[t] from its residues r[i][t] modulo the p[i] by Garner's
+algorithm: the mixed radix digits v[i] = (r[i] - v[0] - v[1]p[0] -
+... - v[i - 1]p[0]...p[i - 2]) / (p[0]...p[i - 1]) mod p[i], computed
+for four values at a time by SSE2, without any division or modular
+inverse per value. The result is x[t] mod m, or with restore_signed(),
+the value x[t] in (-M/2, M/2] for M = p[0]...p[k - 1] as a long long
+(when it fits), which is how multi-modular algorithms recover signed
+integers. The sign is found by comparing the digits of x[t] with those
+of (M - 1)/2, which are those of the residues (p[i] - 1)/2.
+
+Time Complexity: O(1) per modint operation besides pow() in O(log e)
+and the O(log MOD) inverse. O(k^2 n) for garner_batch::restore() with
+k moduli and n values, after O(k^2 log p) preprocessing.
+
+Space Complexity: O(k^2) auxiliary for garner_batch, and O(n) for
+pow() and restore().
+
+*/
+
+//t*2^-32 mod p for t < p*2^32, where p < 2^31 and pinv = -p^-1 mod 2^32
+inline unsigned int mont_reduce(unsigned long long t, unsigned int p,
+                                unsigned int pinv) {
+  unsigned int m = (unsigned int)t * pinv;
+  unsigned int u = (unsigned int)((t + (unsigned long long)m * p) >> 32);
+  return u >= p ? u - p : u;
+}
+
+inline unsigned int mont_neg_inverse(unsigned int p) {
+  unsigned int x = p;
+  for (int i = 0; i < 4; i++) x *= 2 - p * x;
+  return -x;
+}
+
+#ifdef __SSE2__
+//four Montgomery products a*b*2^-32 mod p, given p and pinv in every lane
+inline __m128i mont_mul4(__m128i a, __m128i b, __m128i p, __m128i pinv) {
+  __m128i t02 = _mm_mul_epu32(a, b);
+  __m128i t13 = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  __m128i m02 = _mm_mul_epu32(t02, pinv), m13 = _mm_mul_epu32(t13, pinv);
+  __m128i u02 = _mm_srli_epi64(_mm_add_epi64(t02, _mm_mul_epu32(m02, p)), 32);
+  __m128i u13 = _mm_srli_epi64(_mm_add_epi64(t13, _mm_mul_epu32(m13, p)), 32);
+  __m128i u = _mm_sub_epi32(_mm_or_si128(u02, _mm_slli_epi64(u13, 32)), p);
+  return _mm_add_epi32(u, _mm_and_si128(p, _mm_srai_epi32(u, 31)));
+}
+#endif
+
+//c[t] = a[t]*b[t]*2^-32 mod p for t in [0, n), where b is a single
+//value if b_step is 0, and any of the arrays may coincide
+inline void mont_mul_array(const unsigned int * a, const unsigned int * b,
+                           int b_step, unsigned int * c, int n,
+                           unsigned int p, unsigned int pinv) {
+  int t = 0;
+#ifdef __SSE2__
+  __m128i vp = _mm_set1_epi32(p), vpinv = _mm_set1_epi32(pinv);
+  __m128i vb = _mm_set1_epi32(b[0]);
+  for (; t + 4 <= n; t += 4) {
+    __m128i va = _mm_loadu_si128((const __m128i *)(a + t));
+    if (b_step != 0) vb = _mm_loadu_si128((const __m128i *)(b + t));
+    _mm_storeu_si128((__m128i *)(c + t), mont_mul4(va, vb, vp, vpinv));
+  }
+#endif
+  for (; t < n; t++)
+    c[t] = mont_reduce((unsigned long long)a[t] * b[t * b_step], p, pinv);
+}
+
+template<unsigned int MOD> struct montgomery_constants {
+  static const unsigned int x1 = MOD * (2 - MOD * MOD);
+  static const unsigned int x2 = x1 * (2 - MOD * x1);
+  static const unsigned int x3 = x2 * (2 - MOD * x2);
+  static const unsigned int x4 = x3 * (2 - MOD * x3);
+  static const unsigned int pinv = 0u - x4;
+  static const unsigned int r2 = (unsigned int)(
+      (((unsigned long long)1 << 32) % MOD) *
+      (((unsigned long long)1 << 32) % MOD) % MOD);
+};
+
+template<unsigned int MOD> class modint {
+  typedef montgomery_constants<MOD> C;
+  unsigned int v; //the value times 2^32, modulo MOD
+
+  static unsigned int reduce(unsigned long long t) {
+    return mont_reduce(t, MOD, C::pinv);
+  }
+
+ public:
+  modint(): v(0) {}
+
+  modint(long long x) {
+    x %= (long long)MOD;
+    if (x < 0) x += MOD;
+    v = reduce((unsigned long long)x * C::r2);
+  }
+
+  static modint raw(unsigned int montgomery_form) {
+    modint res;
+    res.v = montgomery_form;
+    return res;
+  }
+
+  unsigned int montgomery_form() const { return v; }
+  unsigned int value() const { return reduce(v); }
+
+  modint & operator += (const modint & b) {
+    v += b.v;
+    if (v >= MOD) v -= MOD;
+    return *this;
+  }
+
+  modint & operator -= (const modint & b) {
+    v = (v >= b.v) ? v - b.v : v + MOD - b.v;
+    return *this;
+  }
+
+  modint & operator *= (const modint & b) {
+    v = reduce((unsigned long long)v * b.v);
+    return *this;
+  }
+
+  modint & operator /= (const modint & b) { return *this *= b.inverse(); }
+  modint operator + (const modint & b) const { return modint(*this) += b; }
+  modint operator - (const modint & b) const { return modint(*this) -= b; }
+  modint operator * (const modint & b) const { return modint(*this) *= b; }
+  modint operator / (const modint & b) const { return modint(*this) /= b; }
+  modint operator - () const { return modint() - *this; }
+  bool operator == (const modint & b) const { return v == b.v; }
+  bool operator != (const modint & b) const { return v != b.v; }
+
+  modint pow(unsigned long long e) const {
+    modint res(1), x(*this);
+    for (; e > 0; e >>= 1, x *= x)
+      if (e & 1) res *= x;
+    return res;
+  }
+
+  //by Fermat's little theorem, so MOD must be prime
+  modint inverse() const { return pow(MOD - 2); }
+};
+
+//c[i] = a[i] + b[i] for i in [0, n), where the arrays may coincide
+template<unsigned int MOD>
+void add(const modint<MOD> * a, const modint<MOD> * b, modint<MOD> * c,
+         int n) {
+  const unsigned int * x = (const unsigned int *)a;
+  const unsigned int * y = (const unsigned int *)b;
+  unsigned int * z = (unsigned int *)c;
+  for (int i = 0; i < n; i++) {
+    unsigned int s = x[i] + y[i] - MOD;
+    z[i] = s + (MOD & -(s >> 31));
+  }
+}
+
+//c[i] = a[i] * b[i] for i in [0, n), where the arrays may coincide
+template<unsigned int MOD>
+void mul(const modint<MOD> * a, const modint<MOD> * b, modint<MOD> * c,
+         int n) {
+  mont_mul_array((const unsigned int *)a, (const unsigned int *)b, 1,
+                 (unsigned int *)c, n, MOD, montgomery_constants<MOD>::pinv);
+}
+
+//c[i] = a[i]^e for i in [0, n), where the arrays may coincide
+template<unsigned int MOD>
+void pow(const modint<MOD> * a, unsigned long long e, modint<MOD> * c,
+         int n) {
+  std::vector<modint<MOD> > x(a, a + n);
+  std::fill(c, c + n, modint<MOD>(1));
+  for (; e > 0; e >>= 1) {
+    if (e & 1) mul(c, &x[0], c, n);
+    if (e > 1) mul(&x[0], &x[0], &x[0], n);
+  }
+}
+
+class barrett {
+  unsigned int m;
+  unsigned long long im; //floor((2^64 - 1) / m)
+
+ public:
+  explicit barrett(unsigned int m): m(m), im((unsigned long long)-1 / m) {}
+
+  unsigned int modulus() const { return m; }
+
+  //x mod m, for any x < 2^64
+  unsigned int reduce(unsigned long long x) const {
+#ifdef __SIZEOF_INT128__
+    unsigned long long q = (unsigned long long)(((unsigned __int128)x * im)
+                                                >> 64);
+    unsigned long long r = x - q * m;
+    return (unsigned int)(r >= m ? r - m : r);
+#else
+    return (unsigned int)(x % m);
+#endif
+  }
+
+  unsigned int mul(unsigned int a, unsigned int b) const {
+    return reduce((unsigned long long)a * b);
+  }
+};
+
+class garner_batch {
+  int k;
+  std::vector<unsigned int> p, pinv;
+  //radix[i][j] = p[0]...p[j - 1] mod p[i] and inv[i] = 1/radix[i][i],
+  //both times 2^32 mod p[i] so that Montgomery products remove it
+  std::vector<std::vector<unsigned int> > radix;
+  std::vector<unsigned int> inv, half; //half = digits of (M - 1)/2
+
+  static const int block = 256; //the values processed at once, in cache
+
+  //writes the mixed radix digits of the values r[i][lo..lo + n) to
+  //v[i*block..i*block + n), for n <= block, using prod as scratch space
+  void digits(const std::vector<const unsigned int *> & r, int lo, int n,
+              unsigned int * v, unsigned int * prod) const {
+    for (int i = 0; i < k; i++) {
+      unsigned int * acc = v + i * block, q = p[i];
+      std::copy(r[i] + lo, r[i] + lo + n, acc);
+      for (int j = 0; j < i; j++) {
+        mont_mul_array(v + j * block, &radix[i][j], 0, prod, n, q, pinv[i]);
+        for (int t = 0; t < n; t++) { //acc = acc - prod (mod q)
+          unsigned int s = acc[t] - prod[t];
+          acc[t] = s + (q & -(s >> 31));
+        }
+      }
+      mont_mul_array(acc, &inv[i], 0, acc, n, q, pinv[i]);
+    }
+  }
+
+  static unsigned int power(unsigned long long b, unsigned long long e,
+                            unsigned int m) {
+    unsigned long long r = 1 % m;
+    for (b %= m; e > 0; e >>= 1, b = b * b % m)
+      if (e & 1) r = r * b % m;
+    return (unsigned int)r;
+  }
+
+  //b*2^32 mod q
+  static unsigned int to_montgomery(unsigned long long b, unsigned int q) {
+    return (unsigned int)(((b % q) << 32) % q);
+  }
+
+ public:
+  explicit garner_batch(const std::vector<unsigned int> & p)
+      : k(p.size()), p(p), pinv(p.size()), radix(p.size()), inv(p.size()) {
+    for (int i = 0; i < k; i++) {
+      pinv[i] = mont_neg_inverse(p[i]);
+      unsigned long long prod = 1 % p[i];
+      for (int j = 0; j < i; j++) {
+        radix[i].push_back(to_montgomery(prod, p[i]));
+        prod = prod * p[j] % p[i];
+      }
+      radix[i].push_back(to_montgomery(prod, p[i]));
+      //the inverse of prod by the extended Euclidean algorithm
+      long long a = prod, b = p[i], x = 1, y = 0;
+      while (b != 0) {
+        long long q = a / b, t = a - q * b;
+        a = b;
+        b = t;
+        t = x - q * y;
+        x = y;
+        y = t;
+      }
+      inv[i] = to_montgomery((unsigned long long)(x % (long long)p[i] +
+                                                  p[i]), p[i]);
+    }
+    std::vector<unsigned int> h(k);
+    std::vector<const unsigned int *> r(k);
+    for (int i = 0; i < k; i++) {
+      h[i] = (p[i] - 1) / 2;
+      r[i] = &h[i];
+    }
+    std::vector<unsigned int> v(k * block), prod(block);
+    if (k > 0) digits(r, 0, 1, &v[0], &prod[0]);
+    for (int i = 0; i < k; i++) half.push_back(v[i * block]);
+  }
+
+  //out[t] = x[t] mod m, for the x[t] in [0, M) with x[t] = r[i][t] mod p[i]
+  void restore(const std::vector<const unsigned int *> & r, int n,
+               unsigned int m, unsigned int * out) const {
+    std::vector<unsigned int> v(k * block), prod(block), w(k);
+    barrett b(m);
+    //w[i] = p[0]...p[i - 1] mod m, in Montgomery form if m is odd and
+    //below 2^31, so that the products with the digits vectorize
+    bool mont = (m % 2 == 1 && m < (1u << 31));
+    unsigned int minv = mont ? mont_neg_inverse(m) : 0, x = 1 % m;
+    for (int i = 0; i < k; i++) {
+      w[i] = mont ? to_montgomery(x, m) : x;
+      x = b.mul(x, p[i]);
+    }
+    for (int lo = 0; lo < n; lo += block) {
+      int len = std::min(block, n - lo);
+      unsigned int * o = out + lo;
+      digits(r, lo, len, &v[0], &prod[0]);
+      std::fill(o, o + len, 0);
+      for (int i = 0; i < k; i++) {
+        unsigned int * d = &v[i * block];
+        if (mont) {
+          mont_mul_array(d, &w[i], 0, &prod[0], len, m, minv);
+          for (int t = 0; t < len; t++) {
+            unsigned int s = o[t] + prod[t] - m;
+            o[t] = s + (m & -(s >> 31));
+          }
+        } else {
+          for (int t = 0; t < len; t++) {
+            unsigned int s = o[t] + b.mul(d[t], w[i]);
+            o[t] = (s >= m || s < o[t]) ? s - m : s;
+          }
+        }
+      }
+    }
+  }
+
+  //out[t] = the x[t] in (-M/2, M/2] with x[t] = r[i][t] mod p[i], where the
+  //moduli are odd and every x[t] must fit in a long long
+  void restore_signed(const std::vector<const unsigned int *> & r, int n,
+                      long long * out) const {
+    std::vector<unsigned int> v(k * block), prod(block);
+    for (int lo = 0; lo < n; lo += block) {
+      int len = std::min(block, n - lo);
+      digits(r, lo, len, &v[0], &prod[0]);
+      for (int t = 0; t < len; t++) {
+        int i = k - 1;
+        while (i >= 0 && v[i * block + t] == half[i]) i--;
+        bool negative = (i >= 0 && v[i * block + t] > half[i]);
+        //Horner's rule modulo 2^64 on x, or on M - x - 1 = -x - 1
+        unsigned long long x = 0;
+        for (i = k - 1; i >= 0; i--) {
+          unsigned int d = v[i * block + t];
+          x = x * p[i] + (negative ? p[i] - 1 - d : d);
+        }
+        out[lo + t] = negative ? -(long long)x - 1 : (long long)x;
+      }
+    }
+  }
+};
+
+const int garner_batch::block;
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -175,7 +580,7 @@ int main() {
       int a = rand() % 200 - 10;
       int b = rand() % 200 - 10;
       int g1 = gcd(a, b), g2 = gcd2(a, b);
-      assert(g1 == g2);
+      assert(g1 == g2 && g1 == binary_gcd(a, b));
       if (g1 == 1 && b > 1) {
         int inv1 = mod_inverse(a, b);
         int inv2 = mod_inverse2(a, b);
@@ -206,6 +611,11 @@ int main() {
       cout << res[i] << " ";
     }
     cout << "\n";
+    vector<long long> a;
+    for (int i = 0; i < 1000; i++) a.push_back(rand() % 999999999 + 1);
+    vector<long long> inv = batch_inverses(a, 1000000007);
+    for (int i = 0; i < (int)a.size(); i++)
+      assert(a[i] * inv[i] % 1000000007 == 1);
   }
 
   {
@@ -222,5 +632,55 @@ int main() {
     cout << "Solution: " << x1 << "\n"; //11
   }
 
+  {
+    typedef modint<998244353> mint;
+    mint a(123456789), b(-5);
+    assert((a * b).value() == (123456789LL * (998244353 - 5)) % 998244353);
+    assert((a / b * b) == a && (a - a) == mint(0) && (-b).value() == 5);
+    assert(mint(3).pow(998244352) == mint(1));
+    //array operations agree with the scalar ones
+    vector<mint> x(1001), y(1001), z(1001);
+    for (int i = 0; i < 1001; i++) {
+      x[i] = mint(rand());
+      y[i] = mint(rand());
+    }
+    add(&x[0], &y[0], &z[0], 1001);
+    for (int i = 0; i < 1001; i++) assert(z[i] == x[i] + y[i]);
+    mul(&x[0], &y[0], &z[0], 1001);
+    for (int i = 0; i < 1001; i++) assert(z[i] == x[i] * y[i]);
+    pow(&x[0], 1000000007, &z[0], 1001);
+    for (int i = 0; i < 1001; i++) assert(z[i] == x[i].pow(1000000007));
+    barrett br(1000000007);
+    assert(br.reduce(18446744073709551615ULL) == 582344007);
+  }
+
+  {
+    //reconstructs 10^5 signed values below 2^62 from three residues
+    const int n = 100000, k = 3;
+    unsigned int pr[] = {998244353, 167772161, 469762049};
+    vector<unsigned int> primes(pr, pr + k);
+    garner_batch g(primes);
+    vector<long long> x(n);
+    vector<vector<unsigned int> > r(k, vector<unsigned int>(n));
+    vector<const unsigned int *> rp(k);
+    for (int t = 0; t < n; t++) {
+      x[t] = ((long long)rand() << 31 | rand()) * (t % 2 == 0 ? 1 : -1);
+      for (int i = 0; i < k; i++) r[i][t] = mod(x[t], (long long)pr[i]);
+    }
+    for (int i = 0; i < k; i++) rp[i] = &r[i][0];
+    vector<long long> res(n);
+    g.restore_signed(rp, n, &res[0]);
+    vector<unsigned int> res_mod(n);
+    g.restore(rp, n, 1000000007, &res_mod[0]);
+    //restore() gives the representative in [0, M), which is x + M if x < 0
+    long long M = (long long)pr[0] * pr[1] % 1000000007 * pr[2] % 1000000007;
+    for (int t = 0; t < n; t++) {
+      assert(res[t] == x[t]);
+      long long expected = mod(x[t], 1000000007LL);
+      if (x[t] < 0) expected = (expected + M) % 1000000007;
+      assert(res_mod[t] == expected);
+    }
+  }
+
   return 0;
 }
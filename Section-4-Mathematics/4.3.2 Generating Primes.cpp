@@ -12,9 +12,25 @@ applications. For the computation of larger primes,
 you should replace int with long long or an arbitrary
 precision class.
 
+For bounds beyond the range of int, or for enumerating
+far more primes than fit in memory, segmented_sieve
+sieves [lo, hi) one segment at a time, with 64-bit
+bounds and one bit per odd number in the style of a
+wheel modulo 2: the multiples of 3, 5, 7, and 11 are
+removed by copying a precomputed bit pattern into each
+segment, and only primes from 13 up cross off their
+multiples. Segments are the size of an L1 cache (or of
+sqrt(hi) bits if that is larger, so that every sieving
+prime hits each segment), and for_each_prime() streams
+the primes to a callback while count_primes() only
+counts the bits, so the primes need never be stored.
+Since each sieve owns its state, disjoint ranges may
+be sieved separately and their results joined.
+
 */
 
-#include <cmath> /* ceil(), sqrt() */
+#include <algorithm> /* std::max(), std::min() */
+#include <cmath>     /* ceil(), sqrt() */
 #include <vector>
 
 //Sieve of Eratosthenes in ~ O(n log log n)
@@ -108,6 +124,110 @@ std::vector<int> gen_primes(int l, int h) {
   return res;
 }
 
+inline int trailing_zeros(unsigned long long x) {
+#ifdef __GNUC__
+  return __builtin_ctzll(x);
+#else
+  int s = 0;
+  for (; (x & 1) == 0; x >>= 1) s++;
+  return s;
+#endif
+}
+
+inline int popcount(unsigned long long x) {
+#ifdef __GNUC__
+  return __builtin_popcountll(x);
+#else
+  int s = 0;
+  for (; x != 0; x &= x - 1) s++;
+  return s;
+#endif
+}
+
+//Segmented sieve of Eratosthenes for primes in [lo, hi)
+//O(hi log log hi) time, O(sqrt(hi)) space, for hi < 2^62
+class segmented_sieve {
+  typedef unsigned long long u64;
+  static const int l1_words = 4096; //32KB of bits per segment
+  static const int period = 3 * 5 * 7 * 11; //pattern words to repeat
+
+  //bit i of seg represents the odd number 2(base + i) + 1
+  std::vector<u64> pattern, seg, next;
+  std::vector<int> primes; //sieving primes from 13 to sqrt(hi)
+  u64 lo, hi, base, start;
+  int nwords;
+
+  void clear_bit(u64 i) { seg[i >> 6] &= ~(1ULL << (i & 63)); }
+
+ public:
+  segmented_sieve(u64 lo, u64 hi)
+  : lo(lo / 2), hi(hi / 2), base(0), start(lo / 2 / 64 * 64), nwords(0) {
+    u64 root = (u64)sqrt((double)hi);
+    while (root * root > hi) root--;
+    while ((root + 1) * (root + 1) <= hi) root++;
+    std::vector<int> p = gen_primes((int)root);
+    for (int i = 0; i < (int)p.size(); i++) {
+      if (p[i] < 13) continue;
+      u64 q = p[i], m = std::max(q * q, (2 * start + 1 + q - 1) / q * q);
+      if (m % 2 == 0) m += q;
+      primes.push_back(p[i]);
+      next.push_back(m / 2);
+    }
+    pattern.assign(period, 0);
+    for (u64 k = 0; k < 64 * (u64)period; k++) {
+      u64 n = 2 * k + 1;
+      if (n % 3 != 0 && n % 5 != 0 && n % 7 != 0 && n % 11 != 0)
+        pattern[k >> 6] |= 1ULL << (k & 63);
+    }
+    seg.resize(std::max((u64)l1_words, root / 64 + 1));
+  }
+
+  //sieves the next segment, returning false if none is left
+  bool next_segment() {
+    if (start >= hi) return false;
+    base = start;
+    nwords = (int)std::min((u64)seg.size(), (hi - base + 63) / 64);
+    u64 end = base + 64 * (u64)nwords;
+    for (int j = 0, w = (int)(base / 64 % period); j < nwords; j++) {
+      seg[j] = pattern[w];
+      if (++w == period) w = 0;
+    }
+    for (int j = 0; j < (int)primes.size(); j++) {
+      u64 i = next[j];
+      for (; i < end; i += primes[j]) clear_bit(i - base);
+      next[j] = i;
+    }
+    if (base == 0) seg[0] = (seg[0] | 0x2e) & ~1ULL; //3, 5, 7, 11, but not 1
+    for (u64 i = base; i < lo && i < end; i++) clear_bit(i - base);
+    for (u64 i = std::max(hi, base); i < end; i++) clear_bit(i - base);
+    start = end;
+    return true;
+  }
+
+  int words() const { return nwords; }
+  u64 word(int j) const { return seg[j]; }
+  u64 number(int j, int b) const { return 2 * (base + 64 * j + b) + 1; }
+};
+
+//calls f(p) for each prime p in [lo, hi) in increasing order
+template<class F>
+void for_each_prime(unsigned long long lo, unsigned long long hi, F f) {
+  if (lo <= 2 && hi > 2) f(2ULL);
+  for (segmented_sieve s(lo, hi); s.next_segment(); )
+    for (int j = 0; j < s.words(); j++)
+      for (unsigned long long x = s.word(j); x != 0; x &= x - 1)
+        f(s.number(j, trailing_zeros(x)));
+}
+
+//returns the number of primes in [lo, hi)
+unsigned long long count_primes(unsigned long long lo,
+                                unsigned long long hi) {
+  unsigned long long res = (lo <= 2 && hi > 2) ? 1 : 0;
+  for (segmented_sieve s(lo, hi); s.next_segment(); )
+    for (int j = 0; j < s.words(); j++) res += popcount(s.word(j));
+  return res;
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -120,6 +240,12 @@ template<class It> void print(It lo, It hi) {
   cout << "\n";
 }
 
+struct collect {
+  vector<int> * v;
+  collect(vector<int> * v) : v(v) {}
+  void operator()(unsigned long long p) { v->push_back((int)p); }
+};
+
 int main() {
   int pmax = 10000000;
   vector<int> p;
@@ -157,5 +283,22 @@ int main() {
   delta = (double)(clock() - start)/CLOCKS_PER_SEC;
   cout << "Generated " << p.size() << " primes in " << delta << "s.\n";
   print(p.begin(), p.end());
+
+  for (int i = 0; i < 2000; i++) {
+    int lo = rand() % 3000, hi = lo + rand() % 3000;
+    vector<int> q;
+    for_each_prime(lo, hi, collect(&q));
+    assert(q == gen_primes(max(lo, 2), hi - 1));
+    assert(count_primes(lo, hi) == q.size());
+  }
+  for_each_prime(l, h + 1, collect(&(p = vector<int>())));
+  assert(p == gen_primes(l, h));
+
+  start = clock();
+  unsigned long long n = count_primes(0, 1000000000);
+  delta = (double)(clock() - start)/CLOCKS_PER_SEC;
+  cout << "Counted " << n << " primes under 10^9 in " << delta << "s.\n";
+  n = count_primes(1000000000000ULL, 1000000000000ULL + 100000000);
+  cout << n << " primes in [10^12, 10^12 + 10^8).\n"; //3618282
   return 0;
 }
@@ -4,10 +4,12 @@ Integer Factorization
 
 */
 
-#include <algorithm> /* std::sort() */
+#include <algorithm> /* std::min(), std::sort(), std::swap() */
 #include <cmath>     /* sqrt() */
-#include <cstdlib>   /* rand(), srand() */
+#include <cstdlib>   /* abs(), rand(), srand() */
+#include <stdexcept> /* std::runtime_error() */
 #include <stdint.h>  /* uint64_t */
+#include <string>
 #include <vector>
 
 /*
@@ -185,6 +187,579 @@ std::vector<long long> prime_factorize_big(long long n) {
   return res;
 }
 
+/*
+
+Pollard-Brent with Montgomery Arithmetic
+
+The following is a faster version of the above for all 64-bit
+inputs, which requires a compiler with 128-bit integers.
+Products mod n are computed in Montgomery form (a*2^64 mod n)
+with two multiplications instead of the loop of mulmod(), and
+the differences |x - y| of Brent's method are multiplied
+together for 128 steps at a time so that one GCD serves them
+all, backtracking from the start of the block if the product
+collects every factor of n at once. Primality is decided by the
+deterministic Miller-Rabin test of the previous section.
+
+prime_factorize_u64(n, spf) returns the prime factors of n in
+increasing order, reading them off the table spf of smallest
+prime factors from smallest_prime_factors() whenever n falls
+within the table. Random values come from a seed kept by each
+call instead of rand(), so distinct numbers may be factored on
+separate threads at once, sharing one read-only table.
+
+Complexity: O(n^(1/4)) expected multiplications mod n.
+
+*/
+
+#ifdef __SIZEOF_INT128__
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+//returns a table where spf[i] is the smallest prime factor of i, i > 1,
+//by a linear sieve in O(n)
+std::vector<int> smallest_prime_factors(int n) {
+  std::vector<int> spf(n, 0), primes;
+  for (int i = 2; i < n; i++) {
+    if (spf[i] == 0) {
+      spf[i] = i;
+      primes.push_back(i);
+    }
+    for (int j = 0; j < (int)primes.size() && primes[j] <= spf[i] &&
+                    (long long)i * primes[j] < n; j++)
+      spf[i * primes[j]] = primes[j];
+  }
+  return spf;
+}
+
+//xorshift generator, advancing the seed
+uint64_t next_random(uint64_t & s) {
+  s ^= s << 13;
+  s ^= s >> 7;
+  s ^= s << 17;
+  return s;
+}
+
+uint64_t binary_gcd(uint64_t a, uint64_t b) {
+  if (a == 0 || b == 0) return a | b;
+  int shift = __builtin_ctzll(a | b);
+  a >>= __builtin_ctzll(a);
+  do {
+    b >>= __builtin_ctzll(b);
+    if (a > b) std::swap(a, b);
+    b -= a;
+  } while (b != 0);
+  return a << shift;
+}
+
+struct montgomery64 {
+  uint64_t n, ninv, one; //ninv = n^-1 mod 2^64, one = 2^64 mod n
+
+  explicit montgomery64(uint64_t n) : n(n), ninv(n), one(-n % n) {
+    for (int i = 0; i < 5; i++) ninv *= 2 - n * ninv;
+  }
+
+  uint64_t reduce(uint128_t t) const { //t*2^-64 mod n for t < n*2^64
+    uint64_t m = (uint64_t)t * ninv;
+    uint64_t hi = (uint64_t)(t >> 64);
+    uint64_t mn = (uint64_t)(((uint128_t)m * n) >> 64);
+    return hi >= mn ? hi - mn : hi - mn + n;
+  }
+
+  uint64_t mul(uint64_t a, uint64_t b) const {
+    return reduce((uint128_t)a * b);
+  }
+
+  uint64_t add(uint64_t a, uint64_t b) const {
+    uint64_t s = a + b;
+    return (s < a || s >= n) ? s - n : s;
+  }
+
+  uint64_t to(uint64_t a) const {
+    return (uint64_t)(((uint128_t)(a % n) << 64) % n);
+  }
+
+  uint64_t pow(uint64_t a, uint64_t e) const {
+    uint64_t r = one;
+    for (; e > 0; e >>= 1, a = mul(a, a))
+      if (e & 1) r = mul(r, a);
+    return r;
+  }
+};
+
+bool is_prime_u64(uint64_t n) {
+  static const uint64_t bases[] =
+    {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+  if (n < 4) return n >= 2;
+  if (n % 2 == 0) return false;
+  montgomery64 m(n);
+  uint64_t d = n - 1, minus_one = n - m.one;
+  int s = 0;
+  for (; (d & 1) == 0; s++) d >>= 1;
+  for (int i = 0; i < 7; i++) {
+    if (bases[i] % n == 0) continue;
+    uint64_t x = m.pow(m.to(bases[i]), d);
+    if (x == m.one || x == minus_one) continue;
+    for (int j = 1; j < s && x != minus_one; j++) x = m.mul(x, x);
+    if (x != minus_one) return false;
+  }
+  return true;
+}
+
+//returns a proper factor of the odd composite n
+uint64_t pollard_brent(uint64_t n, uint64_t & seed) {
+  const uint64_t block = 128;
+  montgomery64 m(n);
+  for (;;) {
+    uint64_t c = next_random(seed) % n, y = next_random(seed) % n;
+    uint64_t x = y, ys = y, q = m.one, g = 1;
+    for (uint64_t r = 1; g == 1; r <<= 1) {
+      x = y;
+      for (uint64_t i = 0; i < r; i++) y = m.add(m.mul(y, y), c);
+      for (uint64_t k = 0; k < r && g == 1; k += block) {
+        ys = y;
+        for (uint64_t i = 0; i < block && i < r - k; i++) {
+          y = m.add(m.mul(y, y), c);
+          q = m.mul(q, x > y ? x - y : y - x);
+        }
+        g = binary_gcd(q, n);
+      }
+    }
+    if (g == n) { //retrace the last block one step at a time
+      do {
+        ys = m.add(m.mul(ys, ys), c);
+        g = binary_gcd(x > ys ? x - ys : ys - x, n);
+      } while (g == 1);
+    }
+    if (g != n) return g;
+  }
+}
+
+std::vector<uint64_t> prime_factorize_u64(uint64_t n,
+    const std::vector<int> & spf = std::vector<int>()) {
+  std::vector<uint64_t> res, todo;
+  uint64_t seed = 88172645463325252ull ^ n;
+  for (uint64_t p = 2; p < 64 && p * p <= n; p++)
+    for (; n % p == 0; n /= p) res.push_back(p);
+  for (todo.push_back(n); !todo.empty(); ) {
+    uint64_t x = todo.back();
+    todo.pop_back();
+    if (x < spf.size()) {
+      for (; x > 1; x /= spf[x]) res.push_back(spf[x]);
+    } else if (is_prime_u64(x)) {
+      res.push_back(x);
+    } else if (x > 1) {
+      uint64_t d = pollard_brent(x, seed);
+      todo.push_back(d);
+      todo.push_back(x / d);
+    }
+  }
+  std::sort(res.begin(), res.end());
+  return res;
+}
+
+/*
+
+Elliptic Curve Method (ECM)
+
+Lenstra's elliptic curve method finds a prime factor p of n in
+time depending mostly on the size of p rather than of n, so it
+finds factors of 10 to 20 digits (as in the semiprimes of 20 to
+40 digits) where Pollard's rho would need over 10^10 steps.
+
+Numbers of up to wide_limbs 64-bit limbs (57 decimal digits) are
+stored in the fixed-size type wide and multiplied in Montgomery
+form. Each curve is a Montgomery curve By^2 = x^3 + Ax^2 + x with
+Suyama's parametrization, on which points are kept as projective
+(X : Z) so that no modular inverse is needed. Stage 1 multiplies a
+point by every prime power up to B1 with Montgomery's ladder, and
+stage 2 checks every prime q in (B1, 100*B1] by baby and giant
+steps, writing q = kD +/- j and multiplying together the values
+X(kDP)Z(jP) - X(jP)Z(kDP), which vanish mod p if qP vanishes mod p.
+A GCD with n then reveals p. The bound B1 grows with the number of
+curves tried, as in the usual tables for factors of increasing size.
+
+prime_factorize_decimal(s) returns the prime factors, in increasing
+order, of the number with decimal representation s, so it can take
+the output of any bigint class. Factors above 2^64 are proven
+composite or declared prime by Miller-Rabin to the first 12 prime
+bases, which has no known counterexample.
+
+Complexity: about exp(sqrt(2 ln p ln ln p)) multiplications mod n to
+find a prime factor p.
+
+*/
+
+const int wide_limbs = 3;
+
+struct wide {
+  uint64_t v[wide_limbs]; //least significant limb first
+
+  wide(uint64_t x = 0) {
+    v[0] = x;
+    for (int i = 1; i < wide_limbs; i++) v[i] = 0;
+  }
+
+  bool operator < (const wide & w) const {
+    for (int i = wide_limbs - 1; i >= 0; i--)
+      if (v[i] != w.v[i]) return v[i] < w.v[i];
+    return false;
+  }
+
+  bool operator == (const wide & w) const {
+    return !(*this < w) && !(w < *this);
+  }
+
+  bool is_u64() const {
+    for (int i = 1; i < wide_limbs; i++)
+      if (v[i] != 0) return false;
+    return true;
+  }
+
+  bool bit(int i) const { return (v[i >> 6] >> (i & 63)) & 1; }
+
+  int bits() const {
+    for (int i = 64 * wide_limbs - 1; i >= 0; i--)
+      if (bit(i)) return i + 1;
+    return 0;
+  }
+
+  //sets *this to *this + w and returns the carry
+  uint64_t add(const wide & w) {
+    uint64_t carry = 0;
+    for (int i = 0; i < wide_limbs; i++) {
+      uint128_t s = (uint128_t)v[i] + w.v[i] + carry;
+      v[i] = (uint64_t)s;
+      carry = (uint64_t)(s >> 64);
+    }
+    return carry;
+  }
+
+  //sets *this to *this - w and returns the borrow
+  uint64_t sub(const wide & w) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < wide_limbs; i++) {
+      uint128_t d = (uint128_t)v[i] - w.v[i] - borrow;
+      v[i] = (uint64_t)d;
+      borrow = (uint64_t)(d >> 64) & 1;
+    }
+    return borrow;
+  }
+
+  void shr() {
+    for (int i = 0; i < wide_limbs; i++)
+      v[i] = (v[i] >> 1) | (i + 1 < wide_limbs ? v[i + 1] << 63 : 0);
+  }
+
+  //sets *this to *this*m + c and returns the overflow
+  uint64_t mul_add(uint64_t m, uint64_t c) {
+    for (int i = 0; i < wide_limbs; i++) {
+      uint128_t t = (uint128_t)v[i] * m + c;
+      v[i] = (uint64_t)t;
+      c = (uint64_t)(t >> 64);
+    }
+    return c;
+  }
+
+  //sets *this to *this / d and returns the remainder
+  uint64_t div(uint64_t d) {
+    uint128_t rem = 0;
+    for (int i = wide_limbs - 1; i >= 0; i--) {
+      uint128_t cur = rem << 64 | v[i];
+      v[i] = (uint64_t)(cur / d);
+      rem = cur % d;
+    }
+    return (uint64_t)rem;
+  }
+
+  //returns *this / w by binary long division
+  wide operator / (const wide & w) const {
+    wide q, r;
+    for (int i = 64 * wide_limbs - 1; i >= 0; i--) {
+      uint64_t top = r.v[wide_limbs - 1] >> 63;
+      r.add(r);
+      r.v[0] |= (uint64_t)bit(i);
+      if (top || !(r < w)) {
+        r.sub(w);
+        q.v[i >> 6] |= 1ull << (i & 63);
+      }
+    }
+    return q;
+  }
+
+  std::string to_string() const {
+    std::string s;
+    wide t(*this);
+    do {
+      s += (char)('0' + t.div(10));
+    } while (!(t == wide(0)));
+    return std::string(s.rbegin(), s.rend());
+  }
+};
+
+wide gcd(wide a, wide b) {
+  int shift = 0;
+  if (a == wide(0)) return b;
+  if (b == wide(0)) return a;
+  for (; !a.bit(0) && !b.bit(0); shift++) {
+    a.shr();
+    b.shr();
+  }
+  while (!a.bit(0)) a.shr();
+  while (!(b == wide(0))) {
+    while (!b.bit(0)) b.shr();
+    if (b < a) std::swap(a, b);
+    b.sub(a);
+  }
+  for (; shift > 0; shift--) a.add(a);
+  return a;
+}
+
+struct montgomery_wide {
+  wide n, one, r2; //one = R mod n, r2 = R^2 mod n, for R = 2^(64*limbs)
+  uint64_t ninv;   //-n^-1 mod 2^64
+
+  explicit montgomery_wide(const wide & n) : n(n), one(1), ninv(n.v[0]) {
+    for (int i = 0; i < 5; i++) ninv *= 2 - n.v[0] * ninv;
+    ninv = -ninv;
+    for (int i = 0; i < 64 * wide_limbs; i++) one = add(one, one);
+    r2 = one;
+    for (int i = 0; i < 64 * wide_limbs; i++) r2 = add(r2, r2);
+  }
+
+  wide add(wide a, const wide & b) const {
+    if (a.add(b) || !(a < n)) a.sub(n);
+    return a;
+  }
+
+  wide sub(wide a, const wide & b) const {
+    if (a.sub(b)) a.add(n);
+    return a;
+  }
+
+  //coarsely integrated operand scanning, for n < R
+  wide mul(const wide & a, const wide & b) const {
+    uint64_t t[wide_limbs + 2] = {0};
+    for (int i = 0; i < wide_limbs; i++) {
+      uint128_t c = 0;
+      for (int j = 0; j < wide_limbs; j++) {
+        c += (uint128_t)a.v[j] * b.v[i] + t[j];
+        t[j] = (uint64_t)c;
+        c >>= 64;
+      }
+      c += t[wide_limbs];
+      t[wide_limbs] = (uint64_t)c;
+      t[wide_limbs + 1] = (uint64_t)(c >> 64);
+      uint64_t m = t[0] * ninv;
+      c = ((uint128_t)m * n.v[0] + t[0]) >> 64;
+      for (int j = 1; j < wide_limbs; j++) {
+        c += (uint128_t)m * n.v[j] + t[j];
+        t[j - 1] = (uint64_t)c;
+        c >>= 64;
+      }
+      c += t[wide_limbs];
+      t[wide_limbs - 1] = (uint64_t)c;
+      t[wide_limbs] = t[wide_limbs + 1] + (uint64_t)(c >> 64);
+    }
+    wide res;
+    for (int i = 0; i < wide_limbs; i++) res.v[i] = t[i];
+    if (t[wide_limbs] || !(res < n)) res.sub(n);
+    return res;
+  }
+
+  wide to(const wide & a) const { return mul(a, r2); } //for a < n
+};
+
+bool is_probable_prime(const wide & n) {
+  static const int bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+  if (n.is_u64()) return is_prime_u64(n.v[0]);
+  if (!n.bit(0)) return false;
+  montgomery_wide m(n);
+  wide d(n), minus_one = m.sub(wide(0), m.one);
+  d.sub(wide(1));
+  int s = 0;
+  for (; !d.bit(0); s++) d.shr();
+  for (int i = 0; i < 12; i++) {
+    wide a = m.to(wide(bases[i])), x = m.one;
+    for (int b = d.bits() - 1; b >= 0; b--) {
+      x = m.mul(x, x);
+      if (d.bit(b)) x = m.mul(x, a);
+    }
+    if (x == m.one || x == minus_one) continue;
+    for (int j = 1; j < s && !(x == minus_one); j++) x = m.mul(x, x);
+    if (!(x == minus_one)) return false;
+  }
+  return true;
+}
+
+//a point (X : Z) on a Montgomery curve, with its y-coordinate dropped
+struct ecm_point {
+  wide x, z;
+};
+
+class ecm_curve {
+  const montgomery_wide & m;
+  wide num, den; //(A + 2)/4 = num/den
+  ecm_point p;
+
+  ecm_point dbl(const ecm_point & a) const {
+    wide t = m.add(a.x, a.z), s = m.sub(a.x, a.z);
+    t = m.mul(t, t);
+    s = m.mul(s, s);
+    wide u = m.sub(t, s), ds = m.mul(den, s);
+    ecm_point r;
+    r.x = m.mul(ds, t);
+    r.z = m.mul(u, m.add(ds, m.mul(num, u)));
+    return r;
+  }
+
+  //returns a + b, given d = a - b
+  ecm_point add(const ecm_point & a, const ecm_point & b,
+                const ecm_point & d) const {
+    wide u = m.mul(m.sub(a.x, a.z), m.add(b.x, b.z));
+    wide v = m.mul(m.add(a.x, a.z), m.sub(b.x, b.z));
+    wide s = m.add(u, v), t = m.sub(u, v);
+    ecm_point r;
+    r.x = m.mul(d.z, m.mul(s, s));
+    r.z = m.mul(d.x, m.mul(t, t));
+    return r;
+  }
+
+  //returns k*a for k >= 1 by Montgomery's ladder
+  ecm_point multiply(const ecm_point & a, uint64_t k) const {
+    ecm_point r0 = a, r1 = dbl(a);
+    int b = 63;
+    while (((k >> b) & 1) == 0) b--;
+    for (b--; b >= 0; b--) {
+      if ((k >> b) & 1) {
+        r0 = add(r1, r0, a);
+        r1 = dbl(r1);
+      } else {
+        r1 = add(r1, r0, a);
+        r0 = dbl(r0);
+      }
+    }
+    return r0;
+  }
+
+ public:
+  //Suyama's curve for sigma: u = sigma^2 - 5, v = 4*sigma, the point
+  //(u^3 : v^3), and (A + 2)/4 = (v - u)^3 (3u + v) / (16 u^3 v)
+  ecm_curve(const montgomery_wide & m, uint64_t sigma) : m(m) {
+    wide s = m.to(wide(sigma)), u = m.sub(m.mul(s, s), m.to(wide(5)));
+    wide v = m.add(m.add(s, s), m.add(s, s)), w = m.sub(v, u);
+    wide u3 = m.mul(m.mul(u, u), u);
+    p.x = u3;
+    p.z = m.mul(m.mul(v, v), v);
+    num = m.mul(m.mul(m.mul(w, w), w), m.add(m.add(u, u), m.add(u, v)));
+    den = m.mul(u3, v);
+    for (int i = 0; i < 4; i++) den = m.add(den, den);
+  }
+
+  //returns a factor of n found in stages 1 and 2, or 1 if none is found,
+  //where primes lists the primes up to 100*B1
+  wide run(int B1, const std::vector<int> & primes) {
+    const int D = 210;
+    int i = 0;
+    for (; i < (int)primes.size() && primes[i] <= B1; i++) {
+      uint64_t q = primes[i];
+      while (q * primes[i] <= (uint64_t)B1) q *= primes[i];
+      p = multiply(p, q);
+    }
+    wide g = gcd(p.z, m.n);
+    if (!(g == wide(1))) return g == m.n ? wide(1) : g;
+    //baby[j/2] = jP for odd j <= D/2, and G = kDP for the giant steps
+    std::vector<ecm_point> baby(D / 4 + 1);
+    ecm_point p2 = dbl(p);
+    baby[0] = p;
+    baby[1] = add(p2, p, p);
+    for (int j = 2; j < (int)baby.size(); j++)
+      baby[j] = add(baby[j - 1], p2, baby[j - 2]);
+    int k = (B1 + D / 2) / D;
+    ecm_point step = multiply(p, D), prev = multiply(p, (k - 1) * D);
+    ecm_point giant = multiply(p, k * D);
+    wide prod = m.one;
+    for (; i < (int)primes.size(); i++) {
+      while (primes[i] > k * D + D / 2) {
+        ecm_point next = add(giant, step, prev);
+        prev = giant;
+        giant = next;
+        k++;
+      }
+      const ecm_point & b = baby[std::abs(primes[i] - k * D) / 2];
+      prod = m.mul(prod, m.sub(m.mul(giant.x, b.z), m.mul(b.x, giant.z)));
+    }
+    g = gcd(prod, m.n);
+    return g == m.n ? wide(1) : g;
+  }
+};
+
+//returns the primes up to n
+std::vector<int> primes_up_to(int n) {
+  std::vector<bool> composite(n + 1, false);
+  std::vector<int> res;
+  for (int i = 2; i <= n; i++) {
+    if (composite[i]) continue;
+    res.push_back(i);
+    for (long long j = (long long)i * i; j <= n; j += i) composite[j] = true;
+  }
+  return res;
+}
+
+//returns a proper factor of the odd composite n > 2^64 with n < 2^190
+wide ecm_factor(const wide & n, uint64_t & seed) {
+  //B1 and the number of curves to try for factors of 15, 20, 25, and 30
+  //digits, and then tens of digits beyond
+  static const int bounds[][2] = {
+    {2000, 25}, {11000, 90}, {50000, 300}, {250000, 700}, {1000000, 1800}
+  };
+  montgomery_wide m(n);
+  for (int level = 0; ; level = std::min(level + 1, 4)) {
+    std::vector<int> primes = primes_up_to(100 * bounds[level][0]);
+    for (int c = 0; c < bounds[level][1]; c++) {
+      ecm_curve curve(m, 6 + next_random(seed) % 4294967291ull);
+      wide g = curve.run(bounds[level][0], primes);
+      if (!(g == wide(1))) return g;
+    }
+  }
+}
+
+std::vector<std::string> prime_factorize_decimal(const std::string & s) {
+  wide n;
+  for (int i = 0; i < (int)s.size(); i++)
+    if (n.mul_add(10, s[i] - '0') != 0 || (n.v[wide_limbs - 1] >> 62) != 0)
+      throw std::runtime_error("Number too large to factor.");
+  std::vector<wide> res, todo;
+  if (n == wide(0)) return std::vector<std::string>();
+  uint64_t seed = 88172645463325252ull;
+  for (uint64_t p = 2; p < 1000; p++) {
+    for (wide q = n; q.div(p) == 0 && !(n == wide(p)); q = n) {
+      res.push_back(wide(p));
+      n = q;
+    }
+  }
+  for (todo.push_back(n); !todo.empty(); ) {
+    wide x = todo.back();
+    todo.pop_back();
+    if (x.is_u64()) {
+      std::vector<uint64_t> f = prime_factorize_u64(x.v[0]);
+      res.insert(res.end(), f.begin(), f.end());
+    } else if (is_probable_prime(x)) {
+      res.push_back(x);
+    } else {
+      wide d = ecm_factor(x, seed);
+      todo.push_back(d);
+      todo.push_back(x / d);
+    }
+  }
+  std::sort(res.begin(), res.end());
+  std::vector<std::string> out;
+  for (int i = 0; i < (int)res.size(); i++) out.push_back(res[i].to_string());
+  return out;
+}
+
+#endif
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -218,5 +793,18 @@ int main() {
   vector<long long> v3 = prime_factorize_big(n);
   print(v3.begin(), v3.end());
 
+#ifdef __SIZEOF_INT128__
+  vector<int> spf = smallest_prime_factors(1000000);
+  vector<uint64_t> v4 = prime_factorize_u64(1000000007ull*998244353ull, spf);
+  assert(v4.size() == 2 && v4[0] == 998244353ull && v4[1] == 1000000007ull);
+  assert(prime_factorize_u64(720720, spf).size() == 10);
+
+  vector<string> v5 =
+      prime_factorize_decimal("90000000000000409131000000000153139841");
+  assert(v5.size() == 2);
+  assert(v5[0] == "3000000000000012403" && v5[1] == "30000000000000012347");
+  v5 = prime_factorize_decimal("340282366920938463463374607431768211457");
+  print(v5.begin(), v5.end()); //59649589127497217 5704689200685129054721
+#endif
   return 0;
 }
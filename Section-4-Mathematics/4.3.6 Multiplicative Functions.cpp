@@ -0,0 +1,284 @@
+/*
+
+A function f on the positive integers is multiplicative
+if f(1) = 1 and f(ab) = f(a)f(b) whenever gcd(a, b) = 1,
+so that it is determined by its values on prime powers.
+Examples are Euler's totient phi(n), the Mobius function
+mu(n) (0 if n has a squared prime factor, else -1 raised
+to the number of prime factors of n), the number of
+divisors d(n), and the sum of divisors sigma(n).
+
+multiplicative_sieve(n) runs the linear sieve of section
+4.3.2 once, and while crossing off each composite i * p
+at its smallest prime p, it also fills the tables of the
+smallest prime factor, phi, mu, d, and sigma for every
+index up to n, each from the entry for i in O(1). Every
+composite is visited exactly once, so building all five
+tables takes O(n), less than phi_table() of the previous
+section alone takes for one table in O(n log n).
+
+table(f) evaluates an arbitrary multiplicative function
+on [0, n] from the sieve, where f(p, k, p^k) gives its
+value on the prime power p^k, and each other value is
+the product of a prime power and a smaller entry.
+
+multiplicative_segment(lo, hi, f, primes) evaluates the
+same kind of f on [lo, hi] for bounds beyond the range
+of a table, taking the primes up to sqrt(hi) (e.g. the
+member primes of a sieve on sqrt(hi)). Each sieving
+prime divides its powers out of its multiples in the
+segment, and what remains of each number is 1 or one
+last prime. This takes O((hi - lo) log log hi) time, so
+a large range may be processed a segment at a time.
+
+dirichlet_sums(n) computes the prefix sums Phi(x) of phi
+and M(x) of mu (the Mertens function) for every x of the
+form n / k, by the sieve of Du Jiao. Since the divisor
+sums of phi and mu are n and [n = 1], the hyperbola
+method gives the identities n(n + 1)/2 = sum of Phi(n/d)
+and 1 = sum of M(n/d) over d in [1, n], in which n / d
+takes only O(sqrt n) distinct values. Tabulating both
+sums up to n^(2/3) with the sieve above and memoizing
+the rest by k = n / x takes O(n^(2/3)) time and space.
+All sums fit in a long long for n up to 4 billion.
+
+Time Complexity: O(n) for multiplicative_sieve(n) and
+for table(), O((hi - lo) log log hi) for the segmented
+version, and O(n^(2/3)) for dirichlet_sums(n).
+
+Space Complexity: O(n) for multiplicative_sieve(n),
+O(hi - lo) auxiliary for the segmented version, and
+O(n^(2/3)) for dirichlet_sums(n).
+
+*/
+
+#include <cmath>  /* pow() */
+#include <vector>
+
+class multiplicative_sieve {
+  //pw[i] is the largest power of spf[i] dividing i
+  std::vector<int> pw;
+
+ public:
+  std::vector<int> primes, spf, phi, mu, num_divisors;
+  std::vector<long long> sum_divisors;
+
+  explicit multiplicative_sieve(int n)
+      : pw(n + 1), spf(n + 1), phi(n + 1), mu(n + 1),
+        num_divisors(n + 1), sum_divisors(n + 1) {
+    if (n >= 1) {
+      pw[1] = phi[1] = mu[1] = num_divisors[1] = 1;
+      sum_divisors[1] = 1;
+    }
+    for (int i = 2; i <= n; i++) {
+      if (spf[i] == 0) {
+        primes.push_back(i);
+        spf[i] = pw[i] = i;
+        phi[i] = i - 1;
+        mu[i] = -1;
+        num_divisors[i] = 2;
+        sum_divisors[i] = i + 1;
+      }
+      for (int j = 0; j < (int)primes.size(); j++) {
+        int p = primes[j];
+        if (p > spf[i] || (long long)i * p > n)
+          break;
+        int x = i * p;
+        spf[x] = p;
+        if (p < spf[i]) { //p is a new prime factor of x
+          pw[x] = p;
+          phi[x] = phi[i] * (p - 1);
+          mu[x] = -mu[i];
+          num_divisors[x] = num_divisors[i] * 2;
+          sum_divisors[x] = sum_divisors[i] * (p + 1);
+        } else { //x = rest * pw[x], where rest < x has no factor p
+          pw[x] = pw[i] * p;
+          phi[x] = phi[i] * p;
+          mu[x] = 0;
+          int rest = i / pw[i];
+          if (rest == 1) {
+            num_divisors[x] = num_divisors[i] + 1;
+            sum_divisors[x] = sum_divisors[i] * p + 1;
+          } else {
+            num_divisors[x] = num_divisors[rest] * num_divisors[pw[x]];
+            sum_divisors[x] = sum_divisors[rest] * sum_divisors[pw[x]];
+          }
+        }
+      }
+    }
+  }
+
+  int size() const {
+    return (int)spf.size() - 1;
+  }
+
+  //f(p, k, pk) is the value of the function on pk = p^k
+  template<class T, class F> std::vector<T> table(F f) const {
+    std::vector<T> res(spf.size());
+    std::vector<int> exponent(spf.size());
+    if (size() >= 1) res[1] = 1;
+    for (int i = 2; i <= size(); i++) {
+      if (pw[i] == i) {
+        int j = i / spf[i];
+        exponent[i] = (j == 1) ? 1 : exponent[j] + 1;
+        res[i] = f(spf[i], exponent[i], i);
+      } else {
+        res[i] = res[i / pw[i]] * res[pw[i]];
+      }
+    }
+    return res;
+  }
+};
+
+//evaluates f on [lo, hi], where f(p, k, pk) is its value on pk = p^k,
+//and primes holds (at least) every prime up to sqrt(hi)
+template<class T, class F>
+std::vector<T> multiplicative_segment(long long lo, long long hi, F f,
+                                      const std::vector<int> & primes) {
+  if (lo < 1) lo = 1;
+  if (hi < lo) return std::vector<T>();
+  std::vector<long long> rest(hi - lo + 1);
+  std::vector<T> res(hi - lo + 1, T(1));
+  for (long long x = lo; x <= hi; x++)
+    rest[x - lo] = x;
+  for (int j = 0; j < (int)primes.size(); j++) {
+    long long p = primes[j];
+    if (p * p > hi) break;
+    for (long long x = (lo + p - 1) / p * p; x <= hi; x += p) {
+      long long pk = 1;
+      int k = 0;
+      do {
+        rest[x - lo] /= p;
+        pk *= p;
+        k++;
+      } while (rest[x - lo] % p == 0);
+      res[x - lo] = res[x - lo] * f(p, k, pk);
+    }
+  }
+  for (long long x = lo; x <= hi; x++)
+    if (rest[x - lo] > 1)
+      res[x - lo] = res[x - lo] * f(rest[x - lo], 1, rest[x - lo]);
+  return res;
+}
+
+class dirichlet_sums {
+  long long n;
+  int limit;
+  std::vector<long long> phi_small, mu_small, phi_large, mu_large;
+  std::vector<char> done;
+
+  //computes Phi(x) and M(x) for x = n / k > limit, stored at index k
+  void compute(long long x) {
+    int k = (int)(n / x);
+    if (done[k]) return;
+    long long p = (x % 2 == 0) ? (x / 2) * (x + 1) : x * ((x + 1) / 2);
+    long long m = 1;
+    for (long long d = 2, next; d <= x; d = next + 1) {
+      long long q = x / d;
+      next = x / q;
+      if (q <= limit) {
+        p -= (next - d + 1) * phi_small[q];
+        m -= (next - d + 1) * mu_small[q];
+      } else {
+        compute(q);
+        p -= (next - d + 1) * phi_large[n / q];
+        m -= (next - d + 1) * mu_large[n / q];
+      }
+    }
+    phi_large[k] = p;
+    mu_large[k] = m;
+    done[k] = true;
+  }
+
+ public:
+  explicit dirichlet_sums(long long n) : n(n) {
+    limit = (int)pow((double)n, 2.0 / 3);
+    while ((long long)limit * limit <= n) limit++;
+    if (limit > n) limit = (int)n;
+    multiplicative_sieve s(limit);
+    phi_small.assign(limit + 1, 0);
+    mu_small.assign(limit + 1, 0);
+    for (int i = 1; i <= limit; i++) {
+      phi_small[i] = phi_small[i - 1] + s.phi[i];
+      mu_small[i] = mu_small[i - 1] + s.mu[i];
+    }
+    phi_large.assign(n / limit + 2, 0);
+    mu_large.assign(n / limit + 2, 0);
+    done.assign(n / limit + 2, false);
+  }
+
+  //Phi(x) = phi(1) + ... + phi(x), for x of the form n / k
+  long long phi_sum(long long x) {
+    if (x <= limit) return phi_small[x];
+    compute(x);
+    return phi_large[n / x];
+  }
+
+  //M(x) = mu(1) + ... + mu(x), for x of the form n / k
+  long long mu_sum(long long x) {
+    if (x <= limit) return mu_small[x];
+    compute(x);
+    return mu_large[n / x];
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+//phi as a function on prime powers, for table()
+long long phi_power(long long p, int k, long long pk) {
+  return pk / p * (p - 1);
+}
+
+//the number of squarefree divisors, 2^(number of distinct primes)
+int two_power(long long p, int k, long long pk) {
+  return 2;
+}
+
+int main() {
+  multiplicative_sieve s(1000);
+  cout << s.phi[9] << " " << s.mu[30] << " " << s.num_divisors[12]
+       << " " << s.sum_divisors[12] << "\n"; //6 -1 6 28
+  vector<long long> phi = s.table<long long>(phi_power);
+  vector<int> w = s.table<int>(two_power);
+  for (int i = 1; i <= 1000; i++) {
+    int d = 0, mu = 1, two = 1, m = i;
+    long long sigma = 0;
+    for (int j = 1; j <= i; j++)
+      if (i % j == 0) {
+        d++;
+        sigma += j;
+      }
+    for (int p = 2; p <= m; p++)
+      for (int e = 0; m % p == 0; e++) {
+        m /= p;
+        mu = (e == 0) ? -mu : 0;
+        two *= (e == 0) ? 2 : 1;
+      }
+    assert(s.num_divisors[i] == d && s.sum_divisors[i] == sigma);
+    assert(s.mu[i] == mu && s.phi[i] == phi[i] && w[i] == two);
+  }
+
+  //the segmented version agrees with the table near its end
+  vector<long long> seg = multiplicative_segment<long long>(900, 1000,
+      phi_power, s.primes);
+  for (int i = 900; i <= 1000; i++)
+    assert(seg[i - 900] == s.phi[i]);
+  seg = multiplicative_segment<long long>(1000000000000ll,
+      1000000000010ll, phi_power, multiplicative_sieve(1000000).primes);
+  cout << seg[0] << "\n"; //400000000000
+
+  dirichlet_sums ds(1000000000);
+  long long P = 0, M = 0;
+  for (int i = 1; i <= 1000; i++) {
+    P += s.phi[i];
+    M += s.mu[i];
+  }
+  assert(ds.phi_sum(1000) == P && ds.mu_sum(1000) == M);
+  cout << ds.phi_sum(1000000000) << "\n"; //303963551173008414
+  cout << ds.mu_sum(1000000000) << "\n";  //-222
+  return 0;
+}
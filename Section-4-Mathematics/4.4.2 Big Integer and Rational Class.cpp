@@ -4,8 +4,19 @@ The following bigint class is implemented by storing "chunks"
 of the big integer in a large base that is a power of 10 so
 it can be efficiently stored, operated on, and printed.
 
-It has extensive features including karatsuba multiplication,
-exponentiation by squaring, and n-th root using binary search.
+It has extensive features including multiplication which picks
+between the schoolbook, Karatsuba, Toom-3, and NTT algorithms by
+size, division by Newton's iteration for reciprocals, exponentiation
+by squaring, and n-th root using binary search. Since the base is a
+power of 10, conversions to and from strings take linear time.
+
+The base-digits are kept in a small_vector, which stores numbers of up
+to 4 base-digits (36 decimal digits) without allocating, and compound
+assignments such as += and -= work in place. Products and quotients of
+small numbers take direct paths in the base (or in long long), and
+x.add_mul(y, z) and fma(y, z, x) compute x + y*z without a temporary
+for the product when either factor is small. These keep arithmetic on
+small values, such as most rationals, free of heap allocations.
 The class is thoroughly templatized, so you can use it as
 easily as you do for normal ints. For example, you may use
 operators with a bigint and a string (e.g. bigint(1234)+"-567"
@@ -23,11 +34,11 @@ operations are needed.
 
 */
 
-#include <algorithm> /* std::max(), std::swap() */
+#include <algorithm> /* std::max(), std::min(), std::swap() */
 #include <cmath>     /* sqrt() */
 #include <cstdlib>   /* rand() */
-#include <iomanip>   /* std::setw(), std::setfill() */
 #include <istream>
+#include <map>
 #include <ostream>
 #include <sstream>
 #include <stdexcept> /* std::runtime_error() */
@@ -35,12 +46,270 @@ operations are needed.
 #include <utility>   /* std::pair */
 #include <vector>
 
+/*
+
+The number-theoretic transform of section 4.4.3, which bigint uses to
+multiply numbers of more than a few thousand digits.
+
+*/
+
+unsigned int pow_mod(unsigned int b, unsigned long long e, unsigned int m) {
+  unsigned long long r = 1, x = b % m;
+  for (; e > 0; e >>= 1, x = x * x % m)
+    if (e & 1) r = r * x % m;
+  return (unsigned int)r;
+}
+
+class ntt_prime {
+  unsigned int p, pinv, r2; //pinv = -p^-1 mod 2^32, r2 = 2^64 mod p
+  unsigned int g;           //a primitive root modulo p
+  std::vector<unsigned int> roots, iroots;
+
+  //adds p back to x in (-p, p) if it is negative, without a branch,
+  //since the branches of butterflies on random data are unpredictable
+  unsigned int fix(unsigned int x) const {
+    return x + (p & -(x >> 31));
+  }
+
+  unsigned int reduce(unsigned long long t) const { //t * 2^-32 mod p
+    unsigned int m = (unsigned int)t * pinv;
+    return fix((unsigned int)((t + (unsigned long long)m * p) >> 32) - p);
+  }
+
+  unsigned int add(unsigned int a, unsigned int b) const {
+    return fix(a + b - p);
+  }
+
+  unsigned int sub(unsigned int a, unsigned int b) const {
+    return fix(a - b);
+  }
+
+  //roots[len + j] = w^j for w a root of unity of order 2*len, as in fft_plan
+  void grow(int n) {
+    if ((int)roots.size() >= n) return;
+    if ((p - 1) % n != 0)
+      throw std::runtime_error("Error: transform size does not divide p - 1.");
+    roots.assign(n, 0);
+    iroots.assign(n, 0);
+    for (int len = 1; len < n; len <<= 1) {
+      unsigned int w = to(pow_mod(g, (p - 1) / (2 * len), p));
+      unsigned int iw = to(pow_mod(g, p - 1 - (p - 1) / (2 * len), p));
+      roots[len] = iroots[len] = to(1);
+      for (int j = 1; j < len; j++) {
+        roots[len + j] = mul(roots[len + j - 1], w);
+        iroots[len + j] = mul(iroots[len + j - 1], iw);
+      }
+    }
+  }
+
+ public:
+  explicit ntt_prime(unsigned int p): p(p), pinv(1) {
+    for (int i = 0; i < 5; i++) pinv *= 2 - p * pinv; //Newton's iteration
+    pinv = -pinv;
+    r2 = (unsigned int)((((unsigned long long)1 << 32) % p) *
+                        (((unsigned long long)1 << 32) % p) % p);
+    std::vector<unsigned int> factors;
+    unsigned int q = p - 1;
+    for (unsigned int d = 2; d * d <= q; d++) {
+      if (q % d == 0) factors.push_back(d);
+      while (q % d == 0) q /= d;
+    }
+    if (q > 1) factors.push_back(q);
+    for (g = 2; ; g++) {
+      bool ok = true;
+      for (int i = 0; i < (int)factors.size() && ok; i++)
+        ok = pow_mod(g, (p - 1) / factors[i], p) != 1;
+      if (ok) break;
+    }
+  }
+
+  static ntt_prime & get(unsigned int p) {
+    static std::map<unsigned int, ntt_prime> cache;
+    std::map<unsigned int, ntt_prime>::iterator it = cache.find(p);
+    if (it == cache.end())
+      it = cache.insert(std::make_pair(p, ntt_prime(p))).first;
+    return it->second;
+  }
+
+  unsigned int modulus() const { return p; }
+  unsigned int from(unsigned int a) const { return reduce(a); }
+
+  unsigned int to(unsigned int a) const {
+    return reduce((unsigned long long)a * r2);
+  }
+
+  unsigned int mul(unsigned int a, unsigned int b) const {
+    return reduce((unsigned long long)a * b);
+  }
+
+  //transforms n values in Montgomery form, from natural to bit-reversed
+  //order, or back from bit-reversed to natural order if inverse is set
+  void transform(unsigned int * a, int n, bool inverse = false) {
+    grow(n);
+    if (!inverse) {
+      for (int len = n >> 1; len >= 1; len >>= 1) {
+        const unsigned int * w = &roots[len];
+        for (int i = 0; i < n; i += 2 * len) {
+          unsigned int * x = a + i, * y = a + i + len;
+          for (int j = 0; j < len; j++) {
+            unsigned int u = x[j], v = y[j];
+            x[j] = add(u, v);
+            y[j] = mul(sub(u, v), w[j]);
+          }
+        }
+      }
+      return;
+    }
+    for (int len = 1; len < n; len <<= 1) {
+      const unsigned int * w = &iroots[len];
+      for (int i = 0; i < n; i += 2 * len) {
+        unsigned int * x = a + i, * y = a + i + len;
+        for (int j = 0; j < len; j++) {
+          unsigned int u = x[j], v = mul(y[j], w[j]);
+          x[j] = add(u, v);
+          y[j] = sub(u, v);
+        }
+      }
+    }
+    unsigned int ninv = to(pow_mod(n, p - 2, p));
+    for (int i = 0; i < n; i++) a[i] = mul(a[i], ninv);
+  }
+};
+
+//skips the slow 64-bit division for the common case of 0 <= x < p
+inline unsigned int residue(long long x, unsigned int p) {
+  if (x >= 0 && x < p) return (unsigned int)x;
+  return (unsigned int)((x % (long long)p + p) % p);
+}
+
+//returns the coefficients of the product of a and b, each modulo p
+std::vector<unsigned int> ntt_mul(const std::vector<long long> & va,
+                                  const std::vector<long long> & vb,
+                                  unsigned int p) {
+  if (va.empty() || vb.empty()) return std::vector<unsigned int>();
+  ntt_prime & P = ntt_prime::get(p);
+  int m = va.size() + vb.size() - 1, n = 1;
+  while (n < m) n <<= 1;
+  std::vector<unsigned int> a(n, 0), b(n, 0);
+  for (int i = 0; i < (int)va.size(); i++) a[i] = P.to(residue(va[i], p));
+  for (int i = 0; i < (int)vb.size(); i++) b[i] = P.to(residue(vb[i], p));
+  P.transform(&a[0], n);
+  P.transform(&b[0], n);
+  for (int i = 0; i < n; i++) a[i] = P.mul(a[i], b[i]);
+  P.transform(&a[0], n, true);
+  a.resize(m);
+  for (int i = 0; i < m; i++) a[i] = P.from(a[i]);
+  return a;
+}
+
+
+/*
+
+A small_vector stores up to N elements in a buffer inside itself, and
+only allocates an array on the heap once it grows past them, so that
+bigints of up to N base-digits never allocate. It implements the part
+of the interface of std::vector which bigint uses, where ranges are
+given by pointers.
+
+*/
+
+template<class T, int N> class small_vector {
+  T * p, buf[N];
+  size_t n, cap;
+
+ public:
+  small_vector(): p(buf), n(0), cap(N) {}
+  small_vector(const small_vector & v): p(buf), n(0), cap(N) { *this = v; }
+  ~small_vector() { if (p != buf) delete[] p; }
+
+  small_vector & operator = (const small_vector & v) {
+    if (this != &v) assign(v.begin(), v.end());
+    return *this;
+  }
+
+  void reserve(size_t c) {
+    if (c <= cap) return;
+    c = std::max(c, 2 * cap);
+    T * q = new T[c];
+    std::copy(p, p + n, q);
+    if (p != buf) delete[] p;
+    p = q;
+    cap = c;
+  }
+
+  //exchanges the contents, in constant time unless v or this is small
+  void swap(small_vector & v) {
+    if (p != buf && v.p != v.buf) {
+      std::swap(p, v.p);
+      std::swap(n, v.n);
+      std::swap(cap, v.cap);
+      return;
+    }
+    small_vector t(v);
+    v = *this;
+    *this = t;
+  }
+
+  size_t size() const { return n; }
+  bool empty() const { return n == 0; }
+  T * begin() { return p; }
+  T * end() { return p + n; }
+  const T * begin() const { return p; }
+  const T * end() const { return p + n; }
+  T & operator [] (size_t i) { return p[i]; }
+  const T & operator [] (size_t i) const { return p[i]; }
+  T & back() { return p[n - 1]; }
+  const T & back() const { return p[n - 1]; }
+  void pop_back() { n--; }
+  void clear() { n = 0; }
+
+  void push_back(const T & v) {
+    if (n == cap) {
+      T t(v); //v may be an element of this vector
+      reserve(n + 1);
+      p[n++] = t;
+    } else {
+      p[n++] = v;
+    }
+  }
+
+  void resize(size_t m, const T & v = T()) {
+    reserve(m);
+    for (size_t i = n; i < m; i++) p[i] = v;
+    n = m;
+  }
+
+  void assign(size_t m, const T & v) {
+    n = 0;
+    resize(m, v);
+  }
+
+  void assign(const T * lo, const T * hi) {
+    if (lo >= p && lo <= p + n) { //a range within this vector
+      std::copy(lo, hi, p);
+      n = hi - lo;
+      return;
+    }
+    n = 0;
+    reserve(hi - lo);
+    n = std::copy(lo, hi, p) - p;
+  }
+
+  void insert(T * pos, const T * lo, const T * hi) {
+    size_t i = pos - p, k = hi - lo;
+    reserve(n + k);
+    std::copy_backward(p + i, p + n, p + n + k);
+    std::copy(lo, hi, p + i);
+    n += k;
+  }
+};
+
 struct bigint {
   //base should be a power of 10 for I/O to work
   //base and base_digits should be consistent
   static const int base = 1000000000, base_digits = 9;
 
-  typedef std::vector<int> vint;
+  typedef small_vector<int, 4> vint;
   typedef std::vector<long long> vll;
 
   vint a; //a[0] stores right-most (least significant) base-digit
@@ -86,36 +355,75 @@ struct bigint {
     for (; v > 0; v /= base) a.push_back(v % base);
   }
 
-  bigint operator + (const bigint & v) const {
-    if (sign == v.sign) {
-      bigint res = v;
-      int carry = 0;
-      for (int i = 0; i < (int)std::max(a.size(), v.a.size()) || carry; i++) {
-        if (i == (int)res.a.size()) res.a.push_back(0);
-        res.a[i] += carry + (i < (int)a.size() ? a[i] : 0);
-        carry = res.a[i] >= base;
-        if (carry) res.a[i] -= base;
-      }
-      return res;
+  void swap(bigint & v) {
+    a.swap(v.a);
+    std::swap(sign, v.sign);
+  }
+
+  //compares the absolute values of x and y, returning -1, 0, or 1
+  static int compare_abs(const bigint & x, const bigint & y) {
+    if (x.a.size() != y.a.size()) return x.a.size() < y.a.size() ? -1 : 1;
+    for (int i = x.a.size() - 1; i >= 0; i--)
+      if (x.a[i] != y.a[i]) return x.a[i] < y.a[i] ? -1 : 1;
+    return 0;
+  }
+
+  //adds |v| to |*this|, where v may be *this
+  void add_abs(const bigint & v) {
+    int n = v.a.size();
+    if ((int)a.size() < n) a.resize(n, 0);
+    int carry = 0;
+    for (int i = 0; i < n || (carry && i < (int)a.size()); i++) {
+      a[i] += carry + (i < n ? v.a[i] : 0);
+      carry = a[i] >= base;
+      if (carry) a[i] -= base;
     }
-    return *this - (-v);
+    if (carry) a.push_back(carry);
   }
 
-  bigint operator - (const bigint & v) const {
+  //sets |*this| to the absolute difference of |*this| and |v|
+  void sub_abs(const bigint & v) {
+    bool swapped = compare_abs(*this, v) < 0;
+    if (swapped) a.resize(v.a.size(), 0);
+    int n = a.size(), m = v.a.size();
+    for (int i = 0, carry = 0; i < n && (i < m || carry); i++) {
+      int x = a[i], y = (i < m ? v.a[i] : 0);
+      int d = swapped ? y - x - carry : x - y - carry;
+      carry = d < 0;
+      a[i] = carry ? d + base : d;
+    }
+    if (swapped) sign = -sign;
+    trim();
+  }
+
+  bigint & operator += (const bigint & v) {
     if (sign == v.sign) {
-      if (abs() >= v.abs()) {
-        bigint res(*this);
-        for (int i = 0, carry = 0; i < (int)v.a.size() || carry; i++) {
-          res.a[i] -= carry + (i < (int)v.a.size() ? v.a[i] : 0);
-          carry = res.a[i] < 0;
-          if (carry) res.a[i] += base;
-        }
-        res.trim();
-        return res;
-      }
-      return -(v - *this);
+      add_abs(v);
+    } else {
+      sub_abs(v);
     }
-    return *this + (-v);
+    return *this;
+  }
+
+  bigint & operator -= (const bigint & v) {
+    if (sign != v.sign) {
+      add_abs(v);
+    } else {
+      sub_abs(v);
+    }
+    return *this;
+  }
+
+  bigint operator + (const bigint & v) const {
+    bigint res(*this);
+    res += v;
+    return res;
+  }
+
+  bigint operator - (const bigint & v) const {
+    bigint res(*this);
+    res -= v;
+    return res;
   }
 
   void operator *= (int v) {
@@ -156,54 +464,195 @@ struct bigint {
     return res;
   }
 
+  /*
+
+  Multiplication works on digits of base 10^4, so that the sums of the
+  products of digits fit in a long long, and picks an algorithm by size:
+  schoolbook multiplication below 32 digits, Karatsuba below 160 digits,
+  Toom-3 below 2048 digits, and the NTT above, with the products taken
+  modulo the two primes 469762049 = 7*2^26 + 1 and 167772161 = 5*2^25 + 1
+  and combined by the Chinese remainder theorem, since they are less
+  than their product. The NTT thus handles products of up to 2^25 digits
+  of base 10^4, or more than 130 million decimal digits.
+  Karatsuba and Toom-3 split numbers into 2 and 3 parts of k digits, and
+  multiply 3 and 5 pairs of combinations of them recursively. The
+  recursive products may have negative or large digits, so they never
+  use the NTT, whose inputs must be digits in [0, 10^4).
+
+  */
+
+  static const int mul_base = 10000, mul_digits = 4;
+
+  //complexity: O(N*M)
+  static vll schoolbook_multiply(const vll & a, const vll & b) {
+    vll res(a.size() + b.size());
+    for (int i = 0; i < (int)a.size(); i++)
+      for (int j = 0; j < (int)b.size(); j++)
+        res[i + j] += a[i] * b[j];
+    return res;
+  }
+
   //complexity: O(3N^log2(3)) ~ O(3N^1.585)
   static vll karatsuba_multiply(const vll & a, const vll & b) {
-    int n = a.size();
+    int n = a.size(), k = n >> 1;
     vll res(n + n);
-    if (n <= 32) {
-      for (int i = 0; i < n; i++)
-        for (int j = 0; j < n; j++)
-          res[i + j] += a[i] * b[j];
-      return res;
-    }
-    int k = n >> 1;
     vll a1(a.begin(), a.begin() + k), a2(a.begin() + k, a.end());
     vll b1(b.begin(), b.begin() + k), b2(b.begin() + k, b.end());
-    vll a1b1 = karatsuba_multiply(a1, b1);
-    vll a2b2 = karatsuba_multiply(a2, b2);
+    vll a1b1 = multiply_same(a1, b1);
+    vll a2b2 = multiply_same(a2, b2);
     for (int i = 0; i < k; i++) a2[i] += a1[i];
     for (int i = 0; i < k; i++) b2[i] += b1[i];
-    vll r = karatsuba_multiply(a2, b2);
+    vll r = multiply_same(a2, b2);
     for (int i = 0; i < (int)a1b1.size(); i++) r[i] -= a1b1[i];
     for (int i = 0; i < (int)a2b2.size(); i++) r[i] -= a2b2[i];
     for (int i = 0; i < (int)r.size(); i++) res[i + k] += r[i];
     for (int i = 0; i < (int)a1b1.size(); i++) res[i] += a1b1[i];
-    for (int i = 0; i < (int)a2b2.size(); i++) res[i + n] += a2b2[i];
+    for (int i = 0; i < (int)a2b2.size(); i++) res[i + 2 * k] += a2b2[i];
+    return res;
+  }
+
+  //complexity: O(N^log3(5)) ~ O(N^1.465), evaluating at 0, 1, -1, -2,
+  //and infinity and interpolating with the sequence of Bodrato
+  static vll toom3_multiply(const vll & a, const vll & b) {
+    int n = a.size(), k = (n + 2) / 3;
+    vll x[5], y[5], r[5];
+    const vll * in[2] = {&a, &b};
+    vll * out[2] = {x, y};
+    for (int t = 0; t < 2; t++) {
+      const vll & v = *in[t];
+      vll * e = out[t];
+      vll p0(v.begin(), v.begin() + k), p1(v.begin() + k, v.begin() + 2 * k);
+      vll p2(v.begin() + 2 * k, v.end());
+      p2.resize(k);
+      e[0] = p0;
+      e[1] = e[2] = e[3] = vll(k);
+      for (int i = 0; i < k; i++) {
+        e[1][i] = p0[i] + p1[i] + p2[i];
+        e[2][i] = p0[i] - p1[i] + p2[i];
+        e[3][i] = (e[2][i] + p2[i]) * 2 - p0[i];
+      }
+      e[4] = p2;
+    }
+    for (int t = 0; t < 5; t++) r[t] = multiply_same(x[t], y[t]);
+    vll & r0 = r[0], & r1 = r[1], & rm1 = r[2], & rm2 = r[3], & rinf = r[4];
+    for (int i = 0; i < 2 * k; i++) {
+      long long c3 = (rm2[i] - r1[i]) / 3;
+      long long c1 = (r1[i] - rm1[i]) / 2;
+      long long c2 = rm1[i] - r0[i];
+      c3 = (c2 - c3) / 2 + 2 * rinf[i];
+      c2 += c1 - rinf[i];
+      c1 -= c3;
+      r1[i] = c1;
+      rm1[i] = c2;
+      rm2[i] = c3;
+    }
+    vll res(6 * k);
+    for (int i = 0; i < 2 * k; i++) {
+      res[i] += r0[i];
+      res[i + k] += r1[i];
+      res[i + 2 * k] += rm1[i];
+      res[i + 3 * k] += rm2[i];
+      res[i + 4 * k] += rinf[i];
+    }
+    res.resize(n + n);
+    return res;
+  }
+
+  //multiplies two sequences of equal size N
+  static vll multiply_same(const vll & a, const vll & b) {
+    int n = a.size();
+    if (n <= 32) return schoolbook_multiply(a, b);
+    if (n < 160) return karatsuba_multiply(a, b);
+    return toom3_multiply(a, b);
+  }
+
+  //complexity: O(N log N) for digits in [0, 10^4)
+  static vll ntt_multiply(const vll & a, const vll & b) {
+    static const unsigned int p0 = 469762049, p1 = 167772161;
+    std::vector<unsigned int> c0 = ntt_mul(a, b, p0), c1 = ntt_mul(a, b, p1);
+    unsigned long long inv = pow_mod(p0, p1 - 2, p1);
+    vll res(c0.size() + 1);
+    for (int i = 0; i < (int)c0.size(); i++) {
+      unsigned long long x1 = (c1[i] + p1 - c0[i] % p1) % p1 * inv % p1;
+      res[i] = c0[i] + (long long)x1 * p0;
+    }
+    return res;
+  }
+
+  static vll multiply(const vll & a, const vll & b) {
+    int n = a.size(), m = b.size();
+    if (std::min(n, m) <= 32) return schoolbook_multiply(a, b);
+    if (n + m >= 4096) return ntt_multiply(a, b);
+    vll x(a), y(b);
+    x.resize(std::max(n, m));
+    y.resize(std::max(n, m));
+    vll res = multiply_same(x, y);
+    res.resize(n + m);
+    return res;
+  }
+
+  //adds |x|*|y| to |*this| by schoolbook multiplication in the base
+  void add_mul_abs(const bigint & x, const bigint & y) {
+    int n = x.a.size(), m = y.a.size();
+    if ((int)a.size() < n + m) a.resize(n + m, 0);
+    for (int i = 0; i < n; i++) {
+      long long carry = 0;
+      for (int j = 0; j < m; j++) {
+        long long cur = a[i + j] + (long long)x.a[i] * y.a[j] + carry;
+        carry = cur / base;
+        a[i + j] = (int)(cur - carry * base);
+      }
+      for (int k = i + m; carry > 0; k++) {
+        if (k == (int)a.size()) a.push_back(0);
+        long long cur = a[k] + carry;
+        carry = cur / base;
+        a[k] = (int)(cur - carry * base);
+      }
+    }
+    trim();
+  }
+
+  //sets *this to *this + x*y, without temporaries if x or y is small
+  //and the product has the sign of *this
+  bigint & add_mul(const bigint & x, const bigint & y) {
+    bool small = std::min(x.a.size(), y.a.size()) <= 8;
+    if (small && sign == x.sign * y.sign && this != &x && this != &y) {
+      if (is_zero()) sign = x.sign * y.sign;
+      add_mul_abs(x, y);
+    } else {
+      bigint t = x * y;
+      *this += t;
+    }
+    return *this;
+  }
+
+  friend bigint fma(const bigint & x, const bigint & y, const bigint & z) {
+    bigint res(z);
+    res.add_mul(x, y);
     return res;
   }
 
   bigint operator * (const bigint & v) const {
-    //if really big values cause overflow, use smaller _base
-    static const int _base = 10000, _base_digits = 4;
-    vint _a = convert_base(this->a, base_digits, _base_digits);
-    vint _b = convert_base(v.a, base_digits, _base_digits);
-    vll a(_a.begin(), _a.end());
-    vll b(_b.begin(), _b.end());
-    while (a.size() < b.size()) a.push_back(0);
-    while (b.size() < a.size()) b.push_back(0);
-    while (a.size() & (a.size() - 1)) {
-      a.push_back(0);
-      b.push_back(0);
-    }
-    vll c = karatsuba_multiply(a, b);
+    if (std::min(a.size(), v.a.size()) <= 8) {
+      bigint res;
+      res.add_mul_abs(*this, v);
+      res.sign = res.a.empty() ? 1 : sign * v.sign;
+      return res;
+    }
+    vint _a = convert_base(this->a, base_digits, mul_digits);
+    vint _b = convert_base(v.a, base_digits, mul_digits);
+    if (_a.empty() || _b.empty()) return bigint(0);
+    vll c = multiply(vll(_a.begin(), _a.end()), vll(_b.begin(), _b.end()));
     bigint res;
     res.sign = sign * v.sign;
-    for (int i = 0, carry = 0; i < (int)c.size(); i++) {
+    long long carry = 0;
+    for (int i = 0; i < (int)c.size(); i++) {
       long long cur = c[i] + carry;
-      res.a.push_back((int)(cur % _base));
-      carry = (int)(cur / _base);
+      res.a.push_back((int)(cur % mul_base));
+      carry = cur / mul_base;
     }
-    res.a = convert_base(res.a, _base_digits, base_digits);
+    for (; carry > 0; carry /= mul_base) res.a.push_back(carry % mul_base);
+    res.a = convert_base(res.a, mul_digits, base_digits);
     res.trim();
     return res;
   }
@@ -219,19 +668,96 @@ struct bigint {
     return res;
   }
 
+  //returns x * base^k, truncating the base-digits shifted out if k < 0
+  static bigint shift(const bigint & x, int k) {
+    bigint res;
+    res.sign = x.sign;
+    if (k >= 0) {
+      res.a.assign(k, 0);
+      res.a.insert(res.a.end(), x.a.begin(), x.a.end());
+    } else if (-k < (int)x.a.size()) {
+      res.a.assign(x.a.begin() - k, x.a.end());
+    }
+    res.trim();
+    return res;
+  }
+
+  /*
+
+  Division of an N-digit number by an M-digit number takes O((N - M)*M)
+  by schoolbook division, which divmod_small() implements. For large
+  numbers, divmod() instead multiplies by a reciprocal, so division costs
+  a constant number of multiplications. reciprocal(c, L) returns
+  floor(base^(2L) / c) for c of L base-digits by Newton's iteration
+  x' = 2x - c*x^2/base^(2L), starting from the reciprocal of the top half
+  of the base-digits of c, since each step doubles the number of correct
+  digits, and then corrects the last few units with the remainder
+  base^(2L) - c*x.
+
+  */
+
+  static bigint reciprocal(const bigint & c, int L) {
+    bigint one;
+    one.a.assign(2 * L, 0);
+    one.a.push_back(1);
+    if (L <= 32) return divmod_small(one, c).first;
+    //two more base-digits than half, since the top base-digit of c may be
+    //as small as 1 and carry almost none of the precision
+    int h = L / 2 + 2;
+    bigint y = reciprocal(shift(c, h - L), h);
+    //y*base^(L - h) approximates the result from above, and one Newton
+    //step from it leaves an error of a few units
+    bigint x = shift(y * 2, L - h) - shift(c * (y * y), -2 * h);
+    bigint r = one - c * x;
+    for (; r < 0; r += c) x -= 1;
+    for (; r >= c; r -= c) x += 1;
+    return x;
+  }
+
   friend std::pair<bigint, bigint> divmod(const bigint & a1, const bigint & b1) {
+    int n = a1.a.size(), m = b1.a.size();
+    if (b1.is_zero()) throw std::runtime_error("Division by zero.");
+    if (n <= 2) { //both fit in a long long
+      long long x = a1.to_llong(), y = b1.to_llong();
+      if (m <= 2) return std::make_pair(bigint(x / y), bigint(x % y));
+      return std::make_pair(bigint(0), a1);
+    }
+    if (m == 1) {
+      int d = b1.a[0];
+      bigint q = a1 / d;
+      if (b1.sign == -1 && !q.is_zero()) q.sign = -q.sign;
+      return std::make_pair(q, bigint(a1 % d));
+    }
+    if (m <= 32 || n - m <= 32) return divmod_small(a1, b1);
+    bigint a = a1.abs(), b = b1.abs();
+    //x = floor(base^(2N) / (b*base^(N - M))) ~ base^(N + M) / b
+    bigint x = reciprocal(shift(b, n - m), n);
+    bigint q = shift(a * x, -(n + m)), r = a - q * b;
+    for (; r < 0; r += b) q -= 1;
+    for (; r >= b; r -= b) q += 1;
+    q.sign = a1.sign * b1.sign;
+    r.sign = a1.sign;
+    q.trim();
+    r.trim();
+    return std::make_pair(q, r);
+  }
+
+  static std::pair<bigint, bigint> divmod_small(const bigint & a1,
+                                                const bigint & b1) {
     int norm = base / (b1.a.back() + 1);
     bigint a = a1.abs() * norm;
     bigint b = b1.abs() * norm;
-    bigint q, r;
+    bigint q, r, bd; //bd holds b*d, reusing its storage
     q.a.resize(a.a.size());
     for (int i = a.a.size() - 1; i >= 0; i--) {
-      r *= base;
-      r += a.a[i];
+      r.a.insert(r.a.begin(), &a.a[i], &a.a[i] + 1); //r = r*base + a.a[i]
+      r.trim();
       int s1 = r.a.size() <= b.a.size() ? 0 : r.a[b.a.size()];
       int s2 = r.a.size() <= b.a.size() - 1 ? 0 : r.a[b.a.size() - 1];
       int d = ((long long)base * s1 + s2) / b.a.back();
-      for (r -= b * d; r < 0; r += b) d--;
+      bd = b;
+      bd *= d;
+      for (r -= bd; r.sign < 0; r += b) d--;
       q.a[i] = d;
     }
     q.sign = a1.sign * b1.sign;
@@ -273,12 +799,10 @@ struct bigint {
   bigint operator --(int) { bigint t(*this); operator--(); return t; }
   bigint & operator ++() { *this = *this + bigint(1); return *this; }
   bigint & operator --() { *this = *this - bigint(1); return *this; }
-  bigint & operator += (const bigint & v) { *this = *this + v; return *this; }
-  bigint & operator -= (const bigint & v) { *this = *this - v; return *this; }
-  bigint & operator *= (const bigint & v) { *this = *this * v; return *this; }
-  bigint & operator /= (const bigint & v) { *this = *this / v; return *this; }
-  bigint & operator %= (const bigint & v) { *this = *this % v; return *this; }
-  bigint & operator ^= (const bigint & v) { *this = *this ^ v; return *this; }
+  bigint & operator *= (const bigint & v) { bigint t = *this * v; swap(t); return *this; }
+  bigint & operator /= (const bigint & v) { bigint t = *this / v; swap(t); return *this; }
+  bigint & operator %= (const bigint & v) { bigint t = *this % v; swap(t); return *this; }
+  bigint & operator ^= (const bigint & v) { bigint t = *this ^ v; swap(t); return *this; }
 
   bool operator < (const bigint & v) const {
     if (sign != v.sign) return sign < v.sign;
@@ -323,8 +847,60 @@ struct bigint {
     return a.abs();
   }
 
-  friend bigint gcd(const bigint & a, const bigint & b) {
-    return b.is_zero() ? a : gcd(b, a % b);
+  /*
+
+  Lehmer's GCD runs Euclid's algorithm on the leading two base-digits x
+  and y of a and b for as long as the quotients agree with those of the
+  full numbers, which holds while both (x + A)/(y + C) and (x + B)/(y + D)
+  give the same quotient, where A, B, C, and D are the cofactors so far.
+  The many quotients found are then applied to a and b at once as the
+  matrix [A B; C D], so each pass over the base-digits of a and b removes
+  about half of the digits of x instead of one quotient's worth.
+
+  */
+
+  friend bigint gcd(const bigint & a0, const bigint & b0) {
+    bigint a = a0.abs(), b = b0.abs();
+    if (a < b) a.swap(b);
+    while (!b.is_zero()) {
+      int n = a.a.size();
+      if (n <= 2) {
+        long long x = a.to_llong(), y = b.to_llong();
+        while (y != 0) {
+          long long t = x % y;
+          x = y;
+          y = t;
+        }
+        return bigint(x);
+      }
+      long long x = (long long)a.a[n - 1] * base + a.a[n - 2], y = 0;
+      for (int i = n - 1; i >= n - 2; i--)
+        y = y * base + (i < (int)b.a.size() ? b.a[i] : 0);
+      long long A = 1, B = 0, C = 0, D = 1;
+      while (y + C != 0 && y + D != 0) {
+        long long q = (x + A) / (y + C);
+        if (q != (x + B) / (y + D)) break;
+        long long t = A - q * C;
+        A = C;
+        C = t;
+        t = B - q * D;
+        B = D;
+        D = t;
+        t = x - q * y;
+        x = y;
+        y = t;
+      }
+      if (B == 0) {
+        bigint t = a % b;
+        a.swap(b);
+        b.swap(t);
+      } else {
+        bigint t = a * bigint(A) + b * bigint(B);
+        b = a * bigint(C) + b * bigint(D);
+        a.swap(t);
+      }
+    }
+    return a;
   }
 
   friend bigint lcm(const bigint & a, const bigint & b) {
@@ -391,20 +967,21 @@ struct bigint {
   }
 
   friend std::ostream & operator << (std::ostream & out, const bigint & v) {
-    if (v.sign == -1) out << '-';
-    out << (v.a.empty() ? 0 : v.a.back());
-    for (int i = v.a.size() - 2; i >= 0; i--)
-      out << std::setw(base_digits) << std::setfill('0') << v.a[i];
-    return out;
+    return out << v.to_string();
   }
 
+  //writes the digits directly instead of formatting each base-digit
   std::string to_string() const {
     std::ostringstream oss;
     if (sign == -1) oss << '-';
     oss << (a.empty() ? 0 : a.back());
-    for (int i = a.size() - 2; i >= 0; i--)
-      oss << std::setw(base_digits) << std::setfill('0') << a[i];
-    return oss.str();
+    std::string s = oss.str();
+    int pos = s.size();
+    if (a.size() > 1) s.resize(pos + base_digits * (a.size() - 1));
+    for (int i = (int)a.size() - 2; i >= 0; i--, pos += base_digits)
+      for (int j = base_digits - 1, x = a[i]; j >= 0; j--, x /= 10)
+        s[pos + j] = '0' + x % 10;
+    return s;
   }
 
   long long to_llong() const {
@@ -456,7 +1033,19 @@ bigint operator % (bigint a, bigint b) vs. int operator % (bigint a, int b)
 
 */
 
+/*
+
+A rational number is kept with a positive denominator, but the numbers
+made by arithmetic operators are only reduced to lowest terms once the
+numerator and denominator together exceed lazy_size base-digits, so
+that small fractions skip the GCD entirely. Comparisons are made by
+cross-multiplication, and output and normalize() reduce fully.
+
+*/
+
 struct rational {
+  static const int lazy_size = 8;
+
   bigint num, den;
 
   rational(): num(0), den(1) {}
@@ -471,15 +1060,31 @@ struct rational {
       num = -num;
       den = -den;
     }
-    bigint a(num < 0 ? -num : num), b(den), tmp;
-    while (a != 0 && b != 0) {
-      tmp = a % b;
-      a = b;
-      b = tmp;
+    normalize();
+  }
+
+  //returns n/d for d != 0, reducing it only if it is large
+  static rational lazy(const bigint & n, const bigint & d) {
+    rational r;
+    r.num = n;
+    r.den = d;
+    if (r.den.is_zero())
+      throw std::runtime_error("Rational division by zero.");
+    if (r.den.sign < 0) {
+      r.num.sign = -r.num.sign;
+      r.den.sign = 1;
+      r.num.trim();
+    }
+    if ((int)(r.num.a.size() + r.den.a.size()) > lazy_size) r.normalize();
+    return r;
+  }
+
+  void normalize() {
+    bigint g = gcd(num, den);
+    if (g != 1) {
+      num /= g;
+      den /= g;
     }
-    bigint gcd = (b == 0) ? a : b;
-    num /= gcd;
-    den /= gcd;
   }
 
   bool operator < (const rational & r) const {
@@ -499,27 +1104,27 @@ struct rational {
   }
 
   bool operator == (const rational & r) const {
-    return num == r.num && den == r.den;
+    return num * r.den == r.num * den;
   }
 
   bool operator != (const rational & r) const {
-    return num != r.num || den != r.den;
+    return !(*this == r);
   }
 
   rational operator + (const rational & r) const {
-    return rational(num * r.den + r.num * den, den * r.den);
+    return lazy(num * r.den + r.num * den, den * r.den);
   }
 
   rational operator - (const rational & r) const {
-    return rational(num * r.den - r.num * den, r.den * den);
+    return lazy(num * r.den - r.num * den, r.den * den);
   }
 
   rational operator * (const rational & r) const {
-    return rational(num * r.num, r.den * den);
+    return lazy(num * r.num, r.den * den);
   }
 
   rational operator / (const rational & r) const {
-    return rational(num * r.den, den * r.num);
+    return lazy(num * r.den, den * r.num);
   }
 
   rational operator % (const rational & r) const {
@@ -527,7 +1132,7 @@ struct rational {
   }
 
   rational operator ^ (const bigint & p) const {
-    return rational(num ^ p, den ^ p);
+    return lazy(num ^ p, den ^ p);
   }
 
   rational operator ++(int) { rational t(*this); operator++(); return t; }
@@ -542,11 +1147,11 @@ struct rational {
   rational & operator ^= (const bigint & r) { *this = *this ^ r; return *this; }
 
   rational operator - () const {
-    return rational(-num, den);
+    return lazy(-num, den);
   }
 
   rational abs() const {
-    return rational(num.abs(), den);
+    return lazy(num.abs(), den);
   }
 
   long long to_llong() const {
@@ -558,7 +1163,7 @@ struct rational {
   }
 
   friend rational abs(const rational & r) {
-    return rational(r.num.abs(), r.den);
+    return r.abs();
   }
 
   friend std::istream & operator >> (std::istream & in, rational & r) {
@@ -569,7 +1174,9 @@ struct rational {
   }
 
   friend std::ostream & operator << (std::ostream & out, const rational & r) {
-    out << r.num << "/" << r.den;
+    rational t(r);
+    t.normalize();
+    out << t.num << "/" << t.den;
     return out;
   }
 
@@ -619,9 +1226,29 @@ int main() {
     assert(a >= xx && a < yy);
   }
 
+  //large products and quotients against the schoolbook algorithms
+  for (int i = 0; i < 20; i++) {
+    bigint a = bigint::rand(rand() % 40000 + 1);
+    bigint b = bigint::rand(rand() % 20000 + 1) + 1;
+    if (rand() % 2) a = -a;
+    pair<bigint, bigint> q = divmod(a, b), r = bigint::divmod_small(a, b);
+    assert(q.first == r.first && q.second == r.second);
+    assert(q.first * b + q.second == a);
+    bigint::vll x(rand() % 3000 + 1), y(rand() % 3000 + 1);
+    for (int j = 0; j < (int)x.size(); j++) x[j] = rand() % 10000;
+    for (int j = 0; j < (int)y.size(); j++) y[j] = rand() % 10000;
+    assert(bigint::multiply(x, y) == bigint::schoolbook_multiply(x, y));
+  }
+
   assert("995291497" ==
     nthroot(bigint("981298591892498189249182998429898124"), 4));
 
+  bigint f("-123456789123456789");
+  assert(fma(f, f, bigint(1)) == f * f + 1);
+  assert(bigint(7).add_mul(f, bigint(-2)) == bigint(7) - f * 2);
+  assert(gcd(f * bigint::rand(500), f * 6) % f == 0);
+  assert(rational(1, 3) + rational(1, 6) == rational(2, 4));
+
   bigint x(5);
   x = -6;
   assert(x.to_llong() == -6ll);
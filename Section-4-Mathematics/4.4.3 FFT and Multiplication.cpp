@@ -14,38 +14,27 @@ work well in many applications beyond just multiplying
 big integers. While Karatsuba multiplication is ~ O(n^1.58),
 the complexity of the fft multiplication is only O(n log n).
 
+The transforms require the size of the input to be a power of two.
 Note that mul(string, string) in the following implementation
 only works for strings of strictly digits from '0' to '9'.
 It is also easy to adapt this for the bigint class in the
 previous section. Simply replace the old bigint operator *
-definition with the following modified version of mul():
+definition with the following, which calls mul(vll, vll) below:
 
   bigint operator * (const bigint & v) const {
     static const int _base = 10000, _base_digits = 4;
     vint _a = convert_base(this->a, base_digits, _base_digits);
     vint _b = convert_base(v.a, base_digits, _base_digits);
-    int len = 32 - __builtin_clz(std::max(_a.size(), _b.size()) - 1);
-    len = 1 << (len + 1);
-    vcd a(len), b(len);
-    for (int i = 0; i < _a.size(); i++) a[i] = cd(_a[i], 0);
-    for (int i = 0; i < _b.size(); i++) b[i] = cd(_b[i], 0);
-    a = fft(a);
-    b = fft(b);
-    for (int i = 0; i < len; i++) {
-      double real = a[i].real() * b[i].real() - a[i].imag() * b[i].imag();
-      a[i].imag() = a[i].imag() * b[i].real() + b[i].imag() * a[i].real();
-      a[i].real() = real;
-    }
-    a = fft(a, true);
-    vll c(len);
-    for (int i = 0; i < len; i++) c[i] = (long long)(a[i].real() + 0.5);
+    vll c = mul(vll(_a.begin(), _a.end()), vll(_b.begin(), _b.end()));
     bigint res;
     res.sign = sign * v.sign;
-    for (int i = 0, carry = 0; i < c.size(); i++) {
+    long long carry = 0;
+    for (int i = 0; i < (int)c.size(); i++) {
       long long cur = c[i] + carry;
       res.a.push_back((int)(cur % _base));
-      carry = (int)(cur / _base);
+      carry = cur / _base;
     }
+    for (; carry > 0; carry /= _base) res.a.push_back(carry % _base);
     res.a = convert_base(res.a, _base_digits, base_digits);
     res.trim();
     return res;
@@ -53,74 +42,351 @@ definition with the following modified version of mul():
 
 */
 
-#include <algorithm> /* std::max(), std::reverse() */
-#include <cmath>     /* M_PI, cos(), sin() */
+#include <algorithm> /* std::max(), std::reverse(), std::swap() */
+#include <cmath>     /* acos(), cos(), floor(), sin() */
 #include <complex>
 #include <iomanip>   /* std::setw(), std::setfill() */
+#include <map>
 #include <sstream>
+#include <stdexcept> /* std::runtime_error() */
 #include <string>
 #include <vector>
 
 typedef std::complex<double> cd;
 typedef std::vector<cd> vcd;
 
-vcd fft(const vcd & v, bool inverse = false) {
-  static const double PI = acos(-1.0);
-  int n = v.size(), k = 0, high1 = -1;
-  while ((1 << k) < n) k++;
-  std::vector<int> rev(n);
-  rev[0] = 0;
-  for (int i = 1; i < n; i++) {
-    if ((i & (i - 1)) == 0) high1++;
-    rev[i] = rev[i ^ (1 << high1)];
-    rev[i] |= (1 << (k - high1 - 1));
-  }
-  vcd roots(n), res(n);
-  for (int i = 0; i < n; i++) {
-    double alpha = 2 * PI * i / n;
-    roots[i] = cd(cos(alpha), sin(alpha));
-  }
-  for (int i = 0; i < n; i++) res[i] = v[rev[i]];
-  for (int len = 1; len < n; len <<= 1) {
-    vcd tmp(n);
-    int rstep = roots.size() / (len * 2);
-    for (int pdest = 0; pdest < n;) {
-      int p1 = pdest;
-      for (int i = 0; i < len; i++) {
-        cd val = roots[i * rstep] * res[p1 + len];
-        tmp[pdest] = res[p1] + val;
-        tmp[pdest + len] = res[p1] - val;
-        pdest++, p1++;
+/*
+
+An fft_plan holds the bit-reversal permutation and the twiddle factors
+for transforms of one size n (a power of two), so that they are computed
+once with cos() and sin() instead of on every call. fft_plan::get(n)
+returns the plan for size n from a cache, building it on first use, and
+transform(a, inverse) transforms the n values at a in place. The first
+two levels of butterflies are merged into one radix-4 pass, since their
+twiddle factors are 1 and i and need no multiplications, and the rest
+multiply complex numbers by their real and imaginary parts directly,
+which avoids the checks for infinities in operator * of std::complex.
+
+*/
+
+class fft_plan {
+  int n;
+  std::vector<int> rev;
+  vcd roots; //roots[k + j] = e^(i*pi*j/k) for each power of two k < n
+
+ public:
+  explicit fft_plan(int n): n(n), rev(n), roots(std::max(n, 2)) {
+    static const double PI = acos(-1.0);
+    int k = 0;
+    while ((1 << k) < n) k++;
+    for (int i = 1; i < n; i++)
+      rev[i] = (rev[i >> 1] >> 1) | ((i & 1) << (k - 1));
+    for (int len = 1; len < n; len <<= 1)
+      for (int j = 0; j < len; j++)
+        roots[len + j] = cd(cos(PI * j / len), sin(PI * j / len));
+  }
+
+  static const fft_plan & get(int n) {
+    static std::map<int, fft_plan> cache;
+    std::map<int, fft_plan>::iterator it = cache.find(n);
+    if (it == cache.end())
+      it = cache.insert(std::make_pair(n, fft_plan(n))).first;
+    return it->second;
+  }
+
+  int size() const { return n; }
+
+  void transform(cd * a, bool inverse = false) const {
+    for (int i = 1; i < n; i++)
+      if (i < rev[i]) std::swap(a[i], a[rev[i]]);
+    int len = 1;
+    if (n >= 4) {
+      for (int i = 0; i < n; i += 4) {
+        cd s0 = a[i] + a[i + 1], d0 = a[i] - a[i + 1];
+        cd s1 = a[i + 2] + a[i + 3], d1 = a[i + 2] - a[i + 3];
+        cd t = cd(-d1.imag(), d1.real()); //d1 * i
+        a[i] = s0 + s1;
+        a[i + 1] = d0 + t;
+        a[i + 2] = s0 - s1;
+        a[i + 3] = d0 - t;
       }
-      pdest += len;
+      len = 4;
+    } else if (n == 2) {
+      cd u = a[0];
+      a[0] = u + a[1];
+      a[1] = u - a[1];
+      len = 2;
+    }
+    for (; len < n; len <<= 1) {
+      for (int i = 0; i < n; i += 2 * len) {
+        cd * x = a + i, * y = a + i + len;
+        const cd * w = &roots[len];
+        for (int j = 0; j < len; j++) {
+          double wr = w[j].real(), wi = w[j].imag();
+          double yr = y[j].real() * wr - y[j].imag() * wi;
+          double yi = y[j].real() * wi + y[j].imag() * wr;
+          double xr = x[j].real(), xi = x[j].imag();
+          x[j] = cd(xr + yr, xi + yi);
+          y[j] = cd(xr - yr, xi - yi);
+        }
+      }
+    }
+    if (inverse) {
+      std::reverse(a + 1, a + n);
+      for (int i = 0; i < n; i++) a[i] /= n;
     }
-    res.swap(tmp);
-  }
-  if (inverse) {
-    for (int i = 0; i < (int)res.size(); i++) res[i] /= v.size();
-    std::reverse(res.begin() + 1, res.end());
   }
+};
+
+vcd fft(const vcd & v, bool inverse = false) {
+  vcd res(v);
+  if (!res.empty()) fft_plan::get(res.size()).transform(&res[0], inverse);
   return res;
 }
 
 typedef std::vector<long long> vll;
 
+/*
+
+mul() packs va into the real parts and vb into the imaginary parts of a
+single complex sequence z, so that one forward transform yields both of
+their transforms: A[k] = (Z[k] + conj(Z[-k]))/2 and B[k] = (Z[k] -
+conj(Z[-k]))/2i, whence A[k]*B[k] = (Z[k]^2 - conj(Z[-k])^2)/4i. The
+product then takes one inverse transform instead of the three transforms
+of multiplying separately transformed inputs.
+
+*/
+
 vll mul(const vll & va, const vll & vb) {
-  int len = 32 - __builtin_clz(std::max(va.size(), vb.size()) - 1);
-  len = 1 << (len + 1);
-  vcd a(len), b(len);
-  for (int i = 0; i < (int)va.size(); i++) a[i] = cd(va[i], 0);
-  for (int i = 0; i < (int)vb.size(); i++) b[i] = cd(vb[i], 0);
-  a = fft(a);
-  b = fft(b);
-  for (int i = 0; i < len; i++) {
-    double real = a[i].real() * b[i].real() - a[i].imag() * b[i].imag();
-    a[i].imag() = a[i].imag() * b[i].real() + b[i].imag() * a[i].real();
-    a[i].real() = real;
-  }
-  a = fft(a, true);
-  vll res(len);
-  for (int i = 0; i < len; i++) res[i] = (long long)(a[i].real() + 0.5);
+  if (va.empty() || vb.empty()) return vll();
+  int m = va.size() + vb.size() - 1, n = 1;
+  while (n < m) n <<= 1;
+  const fft_plan & plan = fft_plan::get(n);
+  vcd z(n), c(n);
+  for (int i = 0; i < (int)va.size(); i++) z[i] = cd(va[i], z[i].imag());
+  for (int i = 0; i < (int)vb.size(); i++) z[i] = cd(z[i].real(), vb[i]);
+  plan.transform(&z[0]);
+  for (int i = 0; i < n; i++) {
+    cd p = z[i], q = std::conj(z[(n - i) & (n - 1)]);
+    double sr = p.real() * p.real() - p.imag() * p.imag();
+    double si = 2 * p.real() * p.imag();
+    double tr = q.real() * q.real() - q.imag() * q.imag();
+    double ti = 2 * q.real() * q.imag();
+    c[i] = cd((si - ti) / 4, (tr - sr) / 4); //(p^2 - q^2) / 4i
+  }
+  plan.transform(&c[0], true);
+  vll res(m);
+  for (int i = 0; i < m; i++) res[i] = (long long)floor(c[i].real() + 0.5);
+  return res;
+}
+
+/*
+
+A number-theoretic transform (NTT) is the analogue of the FFT over the
+integers modulo a prime p = c*2^k + 1, where a primitive root of unity
+of order 2^k exists, so that convolutions are computed exactly modulo p
+without rounding. ntt_prime::get(p) returns, from a cache, the state for
+such a prime: its Montgomery constants, a primitive root found by trial
+factorization of p - 1, and the tables of roots of unity in Montgomery
+form, which grow to the largest size transformed so far. All arithmetic
+stays in Montgomery form (x*2^32 mod p), where a modular multiplication
+takes two integer multiplications and no division.
+
+The forward transform uses decimation in frequency, which maps natural
+order to bit-reversed order, and the inverse uses decimation in time,
+which maps it back, so that a convolution needs no bit reversal at all.
+transform() requires p < 2^30 and a power of two n dividing p - 1.
+
+mul_mod(a, b, p) returns the product of the polynomials a and b with
+coefficients reduced modulo the NTT prime p (by default 998244353).
+
+mul_exact(a, b) returns the exact product, computed modulo the three
+primes 998244353, 167772161, and 469762049 and combined with Garner's
+algorithm for the Chinese remainder theorem, as in garner_restore() of
+section 4.3.1. A coefficient is exact whenever its absolute value is
+less than half the product of the primes (about 3.8 * 10^25), and its
+result is then its value modulo 2^64, which is the value itself if it
+fits in a long long.
+
+*/
+
+unsigned int pow_mod(unsigned int b, unsigned long long e, unsigned int m) {
+  unsigned long long r = 1, x = b % m;
+  for (; e > 0; e >>= 1, x = x * x % m)
+    if (e & 1) r = r * x % m;
+  return (unsigned int)r;
+}
+
+class ntt_prime {
+  unsigned int p, pinv, r2; //pinv = -p^-1 mod 2^32, r2 = 2^64 mod p
+  unsigned int g;           //a primitive root modulo p
+  std::vector<unsigned int> roots, iroots;
+
+  //adds p back to x in (-p, p) if it is negative, without a branch,
+  //since the branches of butterflies on random data are unpredictable
+  unsigned int fix(unsigned int x) const {
+    return x + (p & -(x >> 31));
+  }
+
+  unsigned int reduce(unsigned long long t) const { //t * 2^-32 mod p
+    unsigned int m = (unsigned int)t * pinv;
+    return fix((unsigned int)((t + (unsigned long long)m * p) >> 32) - p);
+  }
+
+  unsigned int add(unsigned int a, unsigned int b) const {
+    return fix(a + b - p);
+  }
+
+  unsigned int sub(unsigned int a, unsigned int b) const {
+    return fix(a - b);
+  }
+
+  //roots[len + j] = w^j for w a root of unity of order 2*len, as in fft_plan
+  void grow(int n) {
+    if ((int)roots.size() >= n) return;
+    if ((p - 1) % n != 0)
+      throw std::runtime_error("Error: transform size does not divide p - 1.");
+    roots.assign(n, 0);
+    iroots.assign(n, 0);
+    for (int len = 1; len < n; len <<= 1) {
+      unsigned int w = to(pow_mod(g, (p - 1) / (2 * len), p));
+      unsigned int iw = to(pow_mod(g, p - 1 - (p - 1) / (2 * len), p));
+      roots[len] = iroots[len] = to(1);
+      for (int j = 1; j < len; j++) {
+        roots[len + j] = mul(roots[len + j - 1], w);
+        iroots[len + j] = mul(iroots[len + j - 1], iw);
+      }
+    }
+  }
+
+ public:
+  explicit ntt_prime(unsigned int p): p(p), pinv(1) {
+    for (int i = 0; i < 5; i++) pinv *= 2 - p * pinv; //Newton's iteration
+    pinv = -pinv;
+    r2 = (unsigned int)((((unsigned long long)1 << 32) % p) *
+                        (((unsigned long long)1 << 32) % p) % p);
+    std::vector<unsigned int> factors;
+    unsigned int q = p - 1;
+    for (unsigned int d = 2; d * d <= q; d++) {
+      if (q % d == 0) factors.push_back(d);
+      while (q % d == 0) q /= d;
+    }
+    if (q > 1) factors.push_back(q);
+    for (g = 2; ; g++) {
+      bool ok = true;
+      for (int i = 0; i < (int)factors.size() && ok; i++)
+        ok = pow_mod(g, (p - 1) / factors[i], p) != 1;
+      if (ok) break;
+    }
+  }
+
+  static ntt_prime & get(unsigned int p) {
+    static std::map<unsigned int, ntt_prime> cache;
+    std::map<unsigned int, ntt_prime>::iterator it = cache.find(p);
+    if (it == cache.end())
+      it = cache.insert(std::make_pair(p, ntt_prime(p))).first;
+    return it->second;
+  }
+
+  unsigned int modulus() const { return p; }
+  unsigned int from(unsigned int a) const { return reduce(a); }
+
+  unsigned int to(unsigned int a) const {
+    return reduce((unsigned long long)a * r2);
+  }
+
+  unsigned int mul(unsigned int a, unsigned int b) const {
+    return reduce((unsigned long long)a * b);
+  }
+
+  //transforms n values in Montgomery form, from natural to bit-reversed
+  //order, or back from bit-reversed to natural order if inverse is set
+  void transform(unsigned int * a, int n, bool inverse = false) {
+    grow(n);
+    if (!inverse) {
+      for (int len = n >> 1; len >= 1; len >>= 1) {
+        const unsigned int * w = &roots[len];
+        for (int i = 0; i < n; i += 2 * len) {
+          unsigned int * x = a + i, * y = a + i + len;
+          for (int j = 0; j < len; j++) {
+            unsigned int u = x[j], v = y[j];
+            x[j] = add(u, v);
+            y[j] = mul(sub(u, v), w[j]);
+          }
+        }
+      }
+      return;
+    }
+    for (int len = 1; len < n; len <<= 1) {
+      const unsigned int * w = &iroots[len];
+      for (int i = 0; i < n; i += 2 * len) {
+        unsigned int * x = a + i, * y = a + i + len;
+        for (int j = 0; j < len; j++) {
+          unsigned int u = x[j], v = mul(y[j], w[j]);
+          x[j] = add(u, v);
+          y[j] = sub(u, v);
+        }
+      }
+    }
+    unsigned int ninv = to(pow_mod(n, p - 2, p));
+    for (int i = 0; i < n; i++) a[i] = mul(a[i], ninv);
+  }
+};
+
+//skips the slow 64-bit division for the common case of 0 <= x < p
+inline unsigned int residue(long long x, unsigned int p) {
+  if (x >= 0 && x < p) return (unsigned int)x;
+  return (unsigned int)((x % (long long)p + p) % p);
+}
+
+//returns the coefficients of the product of a and b, each modulo p
+std::vector<unsigned int> ntt_mul(const vll & va, const vll & vb,
+                                  unsigned int p) {
+  if (va.empty() || vb.empty()) return std::vector<unsigned int>();
+  ntt_prime & P = ntt_prime::get(p);
+  int m = va.size() + vb.size() - 1, n = 1;
+  while (n < m) n <<= 1;
+  std::vector<unsigned int> a(n, 0), b(n, 0);
+  for (int i = 0; i < (int)va.size(); i++) a[i] = P.to(residue(va[i], p));
+  for (int i = 0; i < (int)vb.size(); i++) b[i] = P.to(residue(vb[i], p));
+  P.transform(&a[0], n);
+  P.transform(&b[0], n);
+  for (int i = 0; i < n; i++) a[i] = P.mul(a[i], b[i]);
+  P.transform(&a[0], n, true);
+  a.resize(m);
+  for (int i = 0; i < m; i++) a[i] = P.from(a[i]);
+  return a;
+}
+
+vll mul_mod(const vll & va, const vll & vb, unsigned int p = 998244353) {
+  std::vector<unsigned int> c = ntt_mul(va, vb, p);
+  return vll(c.begin(), c.end());
+}
+
+vll mul_exact(const vll & va, const vll & vb) {
+  static const unsigned int p0 = 998244353, p1 = 167772161, p2 = 469762049;
+  std::vector<unsigned int> c0 = ntt_mul(va, vb, p0);
+  std::vector<unsigned int> c1 = ntt_mul(va, vb, p1);
+  std::vector<unsigned int> c2 = ntt_mul(va, vb, p2);
+  //Garner's algorithm: c = x0 + x1*p0 + x2*p0*p1 with xi in [0, pi)
+  unsigned long long inv01 = pow_mod(p0, p1 - 2, p1);
+  unsigned long long inv012 = pow_mod((unsigned long long)p0 * p1 % p2,
+                                      p2 - 2, p2);
+  unsigned long long p01 = (unsigned long long)p0 * p1;
+  unsigned long long M = p01 * p2; //the product of the primes mod 2^64
+  vll res(c0.size());
+  for (int i = 0; i < (int)c0.size(); i++) {
+    unsigned long long x0 = c0[i];
+    unsigned long long x1 = (c1[i] + p1 - x0 % p1) % p1 * inv01 % p1;
+    unsigned long long y = (x0 + x1 * p0) % p2;
+    unsigned long long x2 = (c2[i] + p2 - y) % p2 * inv012 % p2;
+    unsigned long long low = x0 + x1 * p0, v = low + x2 * p01;
+    //the residues above M/2 stand for negative coefficients, and since M
+    //is odd, those are x2 > (p2 - 1)/2, or x2 == (p2 - 1)/2 and low above
+    //p01/2, exactly
+    bool negative = x2 > p2 / 2 || (x2 == p2 / 2 && 2 * low > p01);
+    res[i] = (long long)(negative ? v - M : v);
+  }
   return res;
 }
 
@@ -147,7 +413,8 @@ std::string mul(const std::string & as, const std::string & bs) {
     carry = c[i] / base;
     c[i] %= base;
   }
-  while (c.back() == 0) c.pop_back();
+  for (; carry > 0; carry /= base) c.push_back(carry % base);
+  while (!c.empty() && c.back() == 0) c.pop_back();
   if (c.empty()) c.push_back(0);
   std::ostringstream oss;
   oss << (c.empty() ? 0 : c.back());
@@ -159,8 +426,56 @@ std::string mul(const std::string & as, const std::string & bs) {
 /*** Example Usage ***/
 
 #include <cassert>
+#include <cstdlib> /* rand() */
 
 int main() {
   assert(mul("98904189", "244212") == "24153589804068");
+  assert(mul("0", "12345") == "0");
+  assert(mul("99999999", "99999999") == "9999999800000001");
+  //random polynomial products against the naive convolution
+  for (int it = 0; it < 100; it++) {
+    vll a(1 + rand() % 300), b(1 + rand() % 300);
+    for (int i = 0; i < (int)a.size(); i++) a[i] = rand() % 20001 - 10000;
+    for (int i = 0; i < (int)b.size(); i++) b[i] = rand() % 20001 - 10000;
+    vll c = mul(a, b), naive(a.size() + b.size() - 1);
+    for (int i = 0; i < (int)a.size(); i++)
+      for (int j = 0; j < (int)b.size(); j++)
+        naive[i + j] += a[i] * b[j];
+    assert(c == naive);
+  }
+  //NTT products modulo a prime, and exact products of large coefficients
+  for (int it = 0; it < 100; it++) {
+    vll a(1 + rand() % 300), b(1 + rand() % 300);
+    for (int i = 0; i < (int)a.size(); i++)
+      a[i] = ((long long)rand() << 15 ^ rand()) % 2000000001 - 1000000000;
+    for (int i = 0; i < (int)b.size(); i++)
+      b[i] = ((long long)rand() << 15 ^ rand()) % 10000000;
+    vll c = mul_exact(a, b), d = mul_mod(a, b, 469762049);
+    vll naive(a.size() + b.size() - 1), naive_mod(naive.size());
+    for (int i = 0; i < (int)a.size(); i++) {
+      for (int j = 0; j < (int)b.size(); j++) {
+        naive[i + j] += a[i] * b[j];
+        long long x = (a[i] % 469762049 + 469762049) % 469762049;
+        naive_mod[i + j] = (naive_mod[i + j] + x * (b[j] % 469762049)) %
+                           469762049;
+      }
+    }
+    assert(c == naive && d == naive_mod);
+  }
+  //coefficients of +-(M - 1)/2, the largest magnitudes that are exact,
+  //formed as X*Y + Z with (M - 1)/2 = 39337313159918103358865408
+  const long long X = 4000000000000000000LL, Y = 9834328;
+  const long long Z = 1159918103358865408LL;
+  unsigned long long half = (unsigned long long)X * Y + Z; //mod 2^64
+  vll a(2), b(2);
+  a[0] = 1, a[1] = X, b[0] = Y, b[1] = Z;
+  assert(mul_exact(a, b)[1] == (long long)half);
+  b[0] = -Y, b[1] = -Z;
+  assert(mul_exact(a, b)[1] == (long long)(0 - half));
+  //the inverse transform undoes the forward transform
+  vcd v(64);
+  for (int i = 0; i < 64; i++) v[i] = cd(rand() % 100, rand() % 100);
+  vcd w = fft(fft(v), true);
+  for (int i = 0; i < 64; i++) assert(abs(w[i] - v[i]) < 1e-9);
   return 0;
 }
@@ -0,0 +1,718 @@
+/*
+
+The following bigint class has the same interface as the bigint class
+of the previous sections, so either may be used in place of the other,
+but stores the magnitude in binary "limbs" of 64 bits (or 32 bits on
+compilers without a 128-bit integer type) instead of base-10^9 digits.
+Every carry is then a shift instead of a division by 10^9, and every
+bit of a limb is used, so sums, products, and quotients of numbers of a
+few hundred to a few thousand bits, such as those of RSA moduli or
+modular exponentiation, are several times faster. The price is that
+decimal conversion is no longer linear: reading and printing take
+O(n^2) on the number of limbs, so this class suits computations that
+print far fewer numbers than they compute with.
+
+Multiplication uses the schoolbook algorithm for short operands and
+Karatsuba's algorithm for long ones, and division uses Knuth's
+algorithm D, normalizing the divisor so that each quotient limb is
+estimated from the top two limbs and corrected at most twice. Since the
+representation is binary, shifts (x << k and x >> k, which multiply and
+divide |x| by 2^k) and bit_length() are also available, along with
+rand_bits(k), which returns a random number of exactly k bits.
+
+As with the previous bigint, operators may mix bigints with built-in
+integers and strings (e.g. bigint(1234)+"-567" is 667), and I/O is done
+using <iostream>:
+  bigint a, b; cin >> a >> b; cout << a + b << "\n";
+
+Time Complexity:
+- O(n + m) for addition, subtraction, comparison, and shifts of an
+  n-limb and an m-limb number.
+- O(n*m) for products with min(n, m) < 32, and O(n*m^0.59) otherwise.
+- O(m*(n - m + 1)) for the quotient and remainder of an n-limb number by
+  an m-limb number.
+- O(n^2) for conversion to and from decimal strings.
+
+Space Complexity: O(n) for a number of n limbs, and O(n + m) auxiliary
+for all operations.
+
+*/
+
+#include <algorithm> /* std::max(), std::min(), std::swap() */
+#include <cmath>     /* std::ldexp() */
+#include <cstdlib>   /* rand() */
+#include <istream>
+#include <ostream>
+#include <stdexcept> /* std::runtime_error() */
+#include <string>
+#include <utility>   /* std::pair */
+#include <vector>
+
+#ifdef __SIZEOF_INT128__
+typedef unsigned long long limb;
+__extension__ typedef unsigned __int128 dlimb;
+#else
+typedef unsigned int limb;
+typedef unsigned long long dlimb;
+#endif
+
+struct bigint {
+  static const int limb_bits = 8 * sizeof(limb);
+  //the largest power of 10 that fits in a limb is 10^dec_digits
+  static const int dec_digits = sizeof(limb) == 8 ? 19 : 9;
+  static const int karatsuba_cutoff = 32;
+
+  typedef std::vector<limb> vlimb;
+
+  vlimb a; //a[0] stores the least significant limb
+  int sign;
+
+  bigint() : sign(1) {}
+  bigint(int v) { *this = (long long)v; }
+  bigint(long long v) { *this = v; }
+  bigint(const std::string & s) { read(s); }
+  bigint(const char * s) { read(std::string(s)); }
+
+  static limb dec_base() {
+    limb p = 1;
+    for (int i = 0; i < dec_digits; i++) p *= 10;
+    return p;
+  }
+
+  static int leading_zeros(limb x) {
+    int s = 0;
+    for (; !(x >> (limb_bits - 1)); x <<= 1) s++;
+    return s;
+  }
+
+  static void trim(vlimb & x) {
+    while (!x.empty() && x.back() == 0) x.pop_back();
+  }
+
+  void trim() {
+    trim(a);
+    if (a.empty()) sign = 1;
+  }
+
+  void read(const std::string & s) {
+    sign = 1;
+    a.clear();
+    int pos = 0;
+    while (pos < (int)s.size() && (s[pos] == '-' || s[pos] == '+')) {
+      if (s[pos] == '-') sign = -sign;
+      pos++;
+    }
+    //the first chunk takes the leftover digits, the rest dec_digits each
+    int len = (s.size() - pos) % dec_digits;
+    if (len == 0) len = dec_digits;
+    for (int i = pos; i < (int)s.size(); i += len, len = dec_digits) {
+      limb x = 0, p = 1;
+      for (int j = i; j < i + len; j++, p *= 10) x = x * 10 + s[j] - '0';
+      mul_add_1(a, p, x);
+    }
+    trim();
+  }
+
+  void operator = (const bigint & v) {
+    sign = v.sign;
+    a = v.a;
+  }
+
+  void operator = (long long v) {
+    sign = v < 0 ? -1 : 1;
+    unsigned long long u = v < 0 ? -(unsigned long long)v : v;
+    a.clear();
+    for (; u > 0; u = (unsigned long long)((dlimb)u >> limb_bits))
+      a.push_back((limb)u);
+  }
+
+  void swap(bigint & v) {
+    a.swap(v.a);
+    std::swap(sign, v.sign);
+  }
+
+  /*
+
+  The following static functions operate on magnitudes: vectors of limbs
+  with no leading zero limbs, or raw arrays of limbs with given lengths.
+
+  */
+
+  static int compare_abs(const vlimb & x, const vlimb & y) {
+    if (x.size() != y.size()) return x.size() < y.size() ? -1 : 1;
+    for (int i = x.size() - 1; i >= 0; i--)
+      if (x[i] != y[i]) return x[i] < y[i] ? -1 : 1;
+    return 0;
+  }
+
+  //x = x*m + c
+  static void mul_add_1(vlimb & x, limb m, limb c) {
+    for (int i = 0; i < (int)x.size(); i++) {
+      dlimb cur = (dlimb)x[i] * m + c;
+      x[i] = (limb)cur;
+      c = (limb)(cur >> limb_bits);
+    }
+    if (c > 0) x.push_back(c);
+  }
+
+  //x = x / d, returning the remainder
+  static limb divmod_1(vlimb & x, limb d) {
+    dlimb rem = 0;
+    for (int i = x.size() - 1; i >= 0; i--) {
+      dlimb cur = rem << limb_bits | x[i];
+      x[i] = (limb)(cur / d);
+      rem = cur % d;
+    }
+    trim(x);
+    return (limb)rem;
+  }
+
+  //r[0, n) += x[0, n), returning the carry
+  static limb add_n(limb * r, const limb * x, int n) {
+    limb carry = 0;
+    for (int i = 0; i < n; i++) {
+      dlimb s = (dlimb)r[i] + x[i] + carry;
+      r[i] = (limb)s;
+      carry = (limb)(s >> limb_bits);
+    }
+    return carry;
+  }
+
+  //r[0, n) += x[0, n)*y, returning the carry
+  static limb addmul_1(limb * r, const limb * x, int n, limb y) {
+    limb carry = 0;
+    for (int i = 0; i < n; i++) {
+      dlimb cur = (dlimb)x[i] * y + r[i] + carry;
+      r[i] = (limb)cur;
+      carry = (limb)(cur >> limb_bits);
+    }
+    return carry;
+  }
+
+  //r[0, n) -= x[0, n)*y, returning the borrow
+  static limb submul_1(limb * r, const limb * x, int n, limb y) {
+    limb borrow = 0;
+    for (int i = 0; i < n; i++) {
+      dlimb p = (dlimb)x[i] * y + borrow;
+      limb lo = (limb)p;
+      borrow = (limb)(p >> limb_bits) + (r[i] < lo);
+      r[i] -= lo;
+    }
+    return borrow;
+  }
+
+  //x += y
+  static void add_to(vlimb & x, const vlimb & y) {
+    int m = y.size();
+    if ((int)x.size() < m) x.resize(m, 0);
+    limb carry = m > 0 ? add_n(&x[0], &y[0], m) : 0;
+    for (int i = m; carry && i < (int)x.size(); i++) carry = (++x[i] == 0);
+    if (carry) x.push_back(1);
+  }
+
+  //x[k, ...) += y, where the sum fits in x
+  static void add_at(vlimb & x, const vlimb & y, int k) {
+    int m = y.size();
+    limb carry = m > 0 ? add_n(&x[k], &y[0], m) : 0;
+    for (int i = k + m; carry; i++) carry = (++x[i] == 0);
+  }
+
+  //x -= y, where x >= y
+  static void sub_from(vlimb & x, const vlimb & y) {
+    limb borrow = 0;
+    int i = 0;
+    for (; i < (int)y.size(); i++) {
+      limb d = x[i] - y[i];
+      limb b = (x[i] < y[i]) + (d < borrow);
+      x[i] = d - borrow;
+      borrow = b;
+    }
+    for (; borrow; i++) borrow = (x[i]-- == 0);
+    trim(x);
+  }
+
+  static vlimb shift_left(const vlimb & x, int s) {
+    if (x.empty()) return x;
+    int k = s / limb_bits, b = s % limb_bits;
+    vlimb res(x.size() + k + 1, 0);
+    for (int i = 0; i < (int)x.size(); i++) {
+      res[i + k] |= x[i] << b;
+      if (b > 0) res[i + k + 1] = x[i] >> (limb_bits - b);
+    }
+    trim(res);
+    return res;
+  }
+
+  static vlimb shift_right(const vlimb & x, int s) {
+    int k = s / limb_bits, b = s % limb_bits;
+    if (k >= (int)x.size()) return vlimb();
+    vlimb res(x.size() - k);
+    for (int i = 0; i < (int)res.size(); i++) {
+      res[i] = x[i + k] >> b;
+      if (b > 0 && i + k + 1 < (int)x.size())
+        res[i] |= x[i + k + 1] << (limb_bits - b);
+    }
+    trim(res);
+    return res;
+  }
+
+  static vlimb schoolbook_multiply(const vlimb & x, const vlimb & y) {
+    int n = x.size(), m = y.size();
+    if (n == 0 || m == 0) return vlimb();
+    vlimb res(n + m, 0);
+    for (int j = 0; j < m; j++) res[j + n] = addmul_1(&res[j], &x[0], n, y[j]);
+    trim(res);
+    return res;
+  }
+
+  //splits the longer operand x at k limbs into x1*B^k + x0 and y likewise,
+  //and computes x0*y0, x1*y1, and (x0 + x1)*(y0 + y1) recursively, or
+  //multiplies y by k-limb pieces of x if y is at most k limbs long
+  static vlimb multiply(const vlimb & x, const vlimb & y) {
+    int n = x.size(), m = y.size();
+    if (n < m) return multiply(y, x);
+    if (m < karatsuba_cutoff) return schoolbook_multiply(x, y);
+    vlimb res(n + m, 0);
+    int k = n / 2;
+    if (m <= k) {
+      for (int i = 0; i < n; i += m) {
+        vlimb piece(x.begin() + i, x.begin() + std::min(i + m, n));
+        trim(piece);
+        add_at(res, multiply(piece, y), i);
+      }
+    } else {
+      vlimb x0(x.begin(), x.begin() + k), x1(x.begin() + k, x.end());
+      vlimb y0(y.begin(), y.begin() + k), y1(y.begin() + k, y.end());
+      trim(x0);
+      trim(y0);
+      vlimb z0 = multiply(x0, y0), z2 = multiply(x1, y1);
+      add_to(x0, x1);
+      add_to(y0, y1);
+      vlimb z1 = multiply(x0, y0);
+      sub_from(z1, z0);
+      sub_from(z1, z2);
+      add_at(res, z0, 0);
+      add_at(res, z1, k);
+      add_at(res, z2, 2 * k);
+    }
+    trim(res);
+    return res;
+  }
+
+  //sets q and r to the quotient and remainder of x / y, where y has at
+  //least two limbs and x >= y (Knuth's algorithm D)
+  static void divide(const vlimb & x, const vlimb & y, vlimb & q, vlimb & r) {
+    int n = x.size(), m = y.size(), s = leading_zeros(y.back());
+    vlimb u = shift_left(x, s), v = shift_left(y, s);
+    u.resize(n + 1, 0);
+    q.assign(n - m + 1, 0);
+    limb v1 = v[m - 1], v2 = v[m - 2];
+    for (int j = n - m; j >= 0; j--) {
+      //estimate the quotient limb from the top two limbs of u and v
+      dlimb top = (dlimb)u[j + m] << limb_bits | u[j + m - 1];
+      dlimb qhat = top / v1, rhat = top % v1;
+      while ((qhat >> limb_bits) != 0 ||
+             qhat * v2 > (rhat << limb_bits | u[j + m - 2])) {
+        qhat--;
+        rhat += v1;
+        if ((rhat >> limb_bits) != 0) break;
+      }
+      limb borrow = submul_1(&u[j], &v[0], m, (limb)qhat);
+      if (u[j + m] < borrow) { //qhat was one too large
+        qhat--;
+        u[j + m] += add_n(&u[j], &v[0], m);
+      }
+      u[j + m] -= borrow;
+      q[j] = (limb)qhat;
+    }
+    u.resize(m);
+    r = shift_right(u, s);
+    trim(q);
+  }
+
+  bigint & operator += (const bigint & v) {
+    if (sign == v.sign) {
+      add_to(a, v.a);
+    } else if (compare_abs(a, v.a) >= 0) {
+      sub_from(a, v.a);
+    } else {
+      vlimb t(v.a);
+      sub_from(t, a);
+      a.swap(t);
+      sign = -sign;
+    }
+    trim();
+    return *this;
+  }
+
+  bigint & operator -= (const bigint & v) {
+    if (this == &v) {
+      *this = 0;
+      return *this;
+    }
+    sign = -sign;
+    *this += v;
+    sign = a.empty() ? 1 : -sign;
+    return *this;
+  }
+
+  bigint operator + (const bigint & v) const {
+    bigint res(*this);
+    res += v;
+    return res;
+  }
+
+  bigint operator - (const bigint & v) const {
+    bigint res(*this);
+    res -= v;
+    return res;
+  }
+
+  void operator *= (int v) {
+    if (v < 0) sign = -sign;
+    mul_add_1(a, (limb)(v < 0 ? -(long long)v : v), 0);
+    trim();
+  }
+
+  bigint operator * (int v) const {
+    bigint res(*this);
+    res *= v;
+    return res;
+  }
+
+  bigint operator * (const bigint & v) const {
+    bigint res;
+    res.a = multiply(a, v.a);
+    res.sign = res.a.empty() ? 1 : sign * v.sign;
+    return res;
+  }
+
+  //sets *this to *this + x*y, without temporaries if x or y is short
+  //and the product has the sign of *this
+  bigint & add_mul(const bigint & x, const bigint & y) {
+    int n = x.a.size(), m = y.a.size();
+    if (n == 0 || m == 0) return *this;
+    if (std::min(n, m) < karatsuba_cutoff && sign == x.sign * y.sign &&
+        this != &x && this != &y) {
+      a.resize(std::max((int)a.size(), n + m) + 1, 0);
+      for (int j = 0; j < m; j++) {
+        limb carry = addmul_1(&a[j], &x.a[0], n, y.a[j]);
+        for (int k = j + n; carry; k++) {
+          a[k] += carry;
+          carry = (a[k] < carry);
+        }
+      }
+      trim();
+    } else {
+      bigint t = x * y;
+      *this += t;
+    }
+    return *this;
+  }
+
+  friend bigint fma(const bigint & x, const bigint & y, const bigint & z) {
+    bigint res(z);
+    res.add_mul(x, y);
+    return res;
+  }
+
+  bigint operator ^ (const bigint & v) const {
+    if (v.sign == -1) return bigint(0);
+    bigint x(*this), res(1);
+    for (int i = 0, bits = v.bit_length(); i < bits; i++) {
+      if ((v.a[i / limb_bits] >> (i % limb_bits)) & 1) res *= x;
+      if (i + 1 < bits) x *= x;
+    }
+    return res;
+  }
+
+  bigint operator << (int k) const {
+    bigint res;
+    res.a = shift_left(a, k);
+    res.sign = res.a.empty() ? 1 : sign;
+    return res;
+  }
+
+  bigint operator >> (int k) const {
+    bigint res;
+    res.a = shift_right(a, k);
+    res.sign = res.a.empty() ? 1 : sign;
+    return res;
+  }
+
+  friend std::pair<bigint, bigint> divmod(const bigint & a1, const bigint & b1) {
+    if (b1.is_zero()) throw std::runtime_error("Division by zero.");
+    bigint q, r;
+    if (compare_abs(a1.a, b1.a) < 0) {
+      r = a1;
+    } else if (b1.a.size() == 1) {
+      q.a = a1.a;
+      r.a.assign(1, divmod_1(q.a, b1.a[0]));
+    } else {
+      divide(a1.a, b1.a, q.a, r.a);
+    }
+    q.sign = a1.sign * b1.sign;
+    r.sign = a1.sign;
+    q.trim();
+    r.trim();
+    return std::make_pair(q, r);
+  }
+
+  bigint operator / (const bigint & v) const { return divmod(*this, v).first; }
+  bigint operator % (const bigint & v) const { return divmod(*this, v).second; }
+
+  bigint & operator /= (int v) {
+    if (v < 0) sign = -sign;
+    divmod_1(a, (limb)(v < 0 ? -(long long)v : v));
+    trim();
+    return *this;
+  }
+
+  bigint operator / (int v) const {
+    bigint res(*this);
+    res /= v;
+    return res;
+  }
+
+  int operator % (int v) const {
+    vlimb t(a);
+    int m = (int)divmod_1(t, (limb)(v < 0 ? -(long long)v : v));
+    return m * sign;
+  }
+
+  bigint operator ++(int) { bigint t(*this); operator++(); return t; }
+  bigint operator --(int) { bigint t(*this); operator--(); return t; }
+  bigint & operator ++() { *this += bigint(1); return *this; }
+  bigint & operator --() { *this -= bigint(1); return *this; }
+  bigint & operator *= (const bigint & v) { bigint t = *this * v; swap(t); return *this; }
+  bigint & operator /= (const bigint & v) { bigint t = *this / v; swap(t); return *this; }
+  bigint & operator %= (const bigint & v) { bigint t = *this % v; swap(t); return *this; }
+  bigint & operator ^= (const bigint & v) { bigint t = *this ^ v; swap(t); return *this; }
+  bigint & operator <<= (int k) { a = shift_left(a, k); return *this; }
+  bigint & operator >>= (int k) { a = shift_right(a, k); trim(); return *this; }
+
+  bool operator < (const bigint & v) const {
+    if (sign != v.sign) return sign < v.sign;
+    int c = compare_abs(a, v.a);
+    return sign == 1 ? c < 0 : c > 0;
+  }
+
+  bool operator >  (const bigint & v) const { return v < *this; }
+  bool operator <= (const bigint & v) const { return !(v < *this); }
+  bool operator >= (const bigint & v) const { return !(*this < v); }
+  bool operator == (const bigint & v) const { return sign == v.sign && a == v.a; }
+  bool operator != (const bigint & v) const { return !(*this == v); }
+
+  int size() const { //the number of decimal digits
+    return abs().to_string().size();
+  }
+
+  int bit_length() const {
+    if (a.empty()) return 0;
+    return a.size() * limb_bits - leading_zeros(a.back());
+  }
+
+  bool is_zero() const {
+    return a.empty();
+  }
+
+  bigint operator - () const {
+    bigint res(*this);
+    if (!res.a.empty()) res.sign = -sign;
+    return res;
+  }
+
+  bigint abs() const {
+    bigint res(*this);
+    res.sign = 1;
+    return res;
+  }
+
+  friend bigint abs(const bigint & a) {
+    return a.abs();
+  }
+
+  friend bigint gcd(const bigint & a, const bigint & b) {
+    return b.is_zero() ? a : gcd(b, a % b);
+  }
+
+  friend bigint lcm(const bigint & a, const bigint & b) {
+    return a / gcd(a, b) * b;
+  }
+
+  //Newton's iteration r' = (r + x/r)/2 decreases from any r >= sqrt(x)
+  //until it reaches floor(sqrt(x))
+  friend bigint sqrt(const bigint & x) {
+    if (x.sign == -1 || x.is_zero()) return bigint(0);
+    bigint r = bigint(1) << ((x.bit_length() + 1) / 2);
+    for (;;) {
+      bigint y = (r + x / r) >> 1;
+      if (!(y < r)) return r;
+      r.swap(y);
+    }
+  }
+
+  friend bigint nthroot(const bigint & x, const bigint & n) {
+    bigint hi = 1;
+    while ((hi ^ n) <= x) hi *= 2;
+    bigint lo = hi / 2, mid, midn;
+    while (lo < hi) {
+      mid = (lo + hi) / 2;
+      midn = mid ^ n;
+      if (lo < mid && midn < x) {
+        lo = mid;
+      } else if (mid < hi && x < midn) {
+        hi = mid;
+      } else {
+        return mid;
+      }
+    }
+    return mid + 1;
+  }
+
+  friend std::istream & operator >> (std::istream & in, bigint & v) {
+    std::string s;
+    in >> s;
+    v.read(s);
+    return in;
+  }
+
+  friend std::ostream & operator << (std::ostream & out, const bigint & v) {
+    return out << v.to_string();
+  }
+
+  //divides off dec_digits decimal digits at a time from the bottom
+  std::string to_string() const {
+    vlimb t(a);
+    std::vector<limb> chunks;
+    do {
+      chunks.push_back(divmod_1(t, dec_base()));
+    } while (!t.empty());
+    std::string s(sign == -1 ? "-" : "");
+    for (limb x = chunks.back(); ; x /= 10) {
+      s += '0' + (int)(x % 10);
+      if (x < 10) break;
+    }
+    std::reverse(s.begin() + (sign == -1), s.end());
+    int pos = s.size();
+    s.resize(pos + dec_digits * (chunks.size() - 1));
+    for (int i = (int)chunks.size() - 2; i >= 0; i--, pos += dec_digits) {
+      limb x = chunks[i];
+      for (int j = dec_digits - 1; j >= 0; j--, x /= 10)
+        s[pos + j] = '0' + (int)(x % 10);
+    }
+    return s;
+  }
+
+  long long to_llong() const {
+    unsigned long long res = 0;
+    for (int i = a.size() - 1; i >= 0; i--)
+      res = (unsigned long long)((dlimb)res << limb_bits | a[i]);
+    return (long long)res * sign;
+  }
+
+  double to_double() const {
+    return (double)to_ldouble();
+  }
+
+  long double to_ldouble() const {
+    long double res = 0;
+    for (int i = a.size() - 1; i >= 0; i--)
+      res = std::ldexp(res, limb_bits) + a[i];
+    return res * sign;
+  }
+
+  static bigint rand(int len) {
+    if (len == 0) return bigint(0);
+    std::string s(1, '1' + (::rand() % 9));
+    for (int i = 1; i < len; i++) s += '0' + (::rand() % 10);
+    return bigint(s);
+  }
+
+  static bigint rand_bits(int bits) {
+    bigint res;
+    res.a.resize((bits + limb_bits - 1) / limb_bits);
+    for (int i = 0; i < (int)res.a.size(); i++)
+      for (int j = 0; j < limb_bits; j += 8)
+        res.a[i] |= (limb)(::rand() & 255) << j;
+    if (bits % limb_bits != 0)
+      res.a.back() &= ((limb)1 << bits % limb_bits) - 1;
+    if (bits > 0) res.a.back() |= (limb)1 << (bits - 1) % limb_bits;
+    return res;
+  }
+};
+
+template<class T> bool operator > (const T & a, const bigint & b) { return bigint(a) > b; }
+template<class T> bool operator < (const T & a, const bigint & b) { return bigint(a) < b; }
+template<class T> bool operator >= (const T & a, const bigint & b) { return bigint(a) >= b; }
+template<class T> bool operator <= (const T & a, const bigint & b) { return bigint(a) <= b; }
+template<class T> bool operator == (const T & a, const bigint & b) { return bigint(a) == b; }
+template<class T> bool operator != (const T & a, const bigint & b) { return bigint(a) != b; }
+template<class T> bigint operator + (const T & a, const bigint & b) { return bigint(a) + b;  }
+template<class T> bigint operator - (const T & a, const bigint & b) { return bigint(a) - b;  }
+template<class T> bigint operator ^ (const T & a, const bigint & b) { return bigint(a) ^ b;  }
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <ctime>
+#include <iostream>
+using namespace std;
+
+int main() {
+  //small values against long long arithmetic
+  for (int i = 0; i < 100000; i++) {
+    long long x = rand() % 2000001 - 1000000, y = rand() % 2001 - 1000;
+    x *= rand() % 1000000;
+    bigint a(x), b(y);
+    assert((a + b).to_llong() == x + y && (a - b).to_llong() == x - y);
+    assert((a * b).to_llong() == x * y && (a < b) == (x < y));
+    if (y != 0) {
+      assert((a / b).to_llong() == x / y && (a % b).to_llong() == x % y);
+      assert((a / (int)y).to_llong() == x / y && a % (int)y == x % y);
+    }
+  }
+
+  //large values against identities, crossing the Karatsuba cutoff
+  for (int i = 0; i < 200; i++) {
+    bigint a = bigint::rand_bits(rand() % 6000 + 1);
+    bigint b = bigint::rand_bits(rand() % 3000 + 1);
+    if (rand() % 2) a = -a;
+    if (rand() % 2) b = -b;
+    assert(bigint(a.to_string()) == a);
+    bigint::vlimb p = bigint::multiply(a.a, b.a);
+    assert(p == bigint::schoolbook_multiply(a.a, b.a));
+    pair<bigint, bigint> qr = divmod(a, b);
+    assert(qr.first * b + qr.second == a && qr.second.abs() < b.abs());
+    assert(fma(a, b, qr.second) == a * b + qr.second);
+    assert(((a << 100) >> 100) == a);
+    bigint r = sqrt(a.abs());
+    assert(r * r <= a.abs() && (r + 1) * (r + 1) > a.abs());
+  }
+
+  assert("995291497" ==
+    nthroot(bigint("981298591892498189249182998429898124"), 4));
+  assert(bigint("-123456789012345678901234567890").to_string() ==
+         "-123456789012345678901234567890");
+  assert((bigint(1) << 64).to_string() == "18446744073709551616");
+  assert((20^bigint(12345)).size() == 16062);
+
+  //Fermat's test to many bases on the Mersenne prime 2^521 - 1
+  clock_t start = clock();
+  bigint m = (bigint(1) << 521) - 1, e = m - 1;
+  for (int i = 0; i < 1000; i++) {
+    bigint res = 1, x = i + 2;
+    for (int j = 0, bits = e.bit_length(); j < bits; j++) {
+      if ((e.a[j / bigint::limb_bits] >> (j % bigint::limb_bits)) & 1)
+        res = res * x % m;
+      x = x * x % m;
+    }
+    assert(res == 1);
+  }
+  cout << "1000 modular exponentiations took "
+       << (float)(clock() - start)/CLOCKS_PER_SEC << "s\n";
+
+  bigint c = bigint::rand(10000) / bigint::rand(2000);
+  cout << c.size() << "\n"; //8000 or 8001
+  return 0;
+}
@@ -8,12 +8,92 @@ to a reference to its internal 2d vector is defined. This
 makes it compatible with the 2d vector functions such as
 det() and lu_decompose() in later sections.
 
+Matrix multiplication copies both operands into contiguous
+row-major buffers and runs gemm_add(), which multiplies in
+blocks sized for the cache: the rows of a block of depth kc
+of b are packed into panels of gemm_cols columns, rows of a
+into panels of gemm_rows rows, and a micro-kernel accumulates
+each gemm_rows by gemm_cols tile of the product in local
+variables (registers, which the compiler may vectorize) while
+streaming through one panel of each. The copies take O(n^2)
+of the O(n^3) total, and each output tile is independent of
+the others.
+
+mod_multiply() and mod_pow() do the same for integer matrices
+modulo m < 2^32, accumulating the products in 64-bit unsigned
+integers and reducing them only once per block of as many
+products as can be summed without overflow, rather than after
+every multiplication as a matrix of modular integers would.
+
 */
 
+#include <algorithm> /* std::min() */
 #include <ostream>
 #include <stdexcept> /* std::runtime_error() */
 #include <vector>
 
+enum { gemm_rows = 4, gemm_cols = 4, gemm_depth = 128, gemm_width = 256 };
+
+//adds the product of the M by K matrix a and the K by N matrix b to the
+//M by N matrix c, all row-major and contiguous. After each block of kc
+//steps of depth, reduce(x) is applied to every entry x of c.
+template<class T, class Reduce>
+void gemm_add(int M, int N, int K, const T * a, const T * b, T * c,
+              int kc, Reduce reduce) {
+  std::vector<T> ap(gemm_rows * kc), bp(gemm_cols * kc * (gemm_width /
+                                                          gemm_cols));
+  for (int k0 = 0; k0 < K; k0 += kc) {
+    int kn = std::min(kc, K - k0);
+    for (int j0 = 0; j0 < N; j0 += gemm_width) {
+      int jn = std::min((int)gemm_width, N - j0);
+      //pack b[k0.., j0..] into panels of gemm_cols columns, zero padded
+      for (int jp = 0; jp < jn; jp += gemm_cols) {
+        T * panel = &bp[jp * kn];
+        for (int k = 0; k < kn; k++)
+          for (int j = 0; j < gemm_cols; j++)
+            panel[k * gemm_cols + j] = (jp + j < jn) ?
+                b[(k0 + k) * N + j0 + jp + j] : T(0);
+      }
+      for (int i0 = 0; i0 < M; i0 += gemm_rows) {
+        int in = std::min((int)gemm_rows, M - i0);
+        for (int k = 0; k < kn; k++)
+          for (int i = 0; i < gemm_rows; i++)
+            ap[k * gemm_rows + i] = (i < in) ?
+                a[(i0 + i) * K + k0 + k] : T(0);
+        for (int jp = 0; jp < jn; jp += gemm_cols) {
+          const T * x = &ap[0], * y = &bp[jp * kn];
+          T acc[gemm_rows][gemm_cols];
+          for (int i = 0; i < gemm_rows; i++)
+            for (int j = 0; j < gemm_cols; j++)
+              acc[i][j] = T(0);
+          for (int k = 0; k < kn; k++, x += gemm_rows, y += gemm_cols)
+            for (int i = 0; i < gemm_rows; i++)
+              for (int j = 0; j < gemm_cols; j++)
+                acc[i][j] += x[i] * y[j];
+          int width = std::min((int)gemm_cols, jn - jp);
+          for (int i = 0; i < in; i++)
+            for (int j = 0; j < width; j++)
+              c[(i0 + i) * N + j0 + jp + j] += acc[i][j];
+        }
+      }
+    }
+    for (int i = 0; i < M * N; i++) c[i] = reduce(c[i]);
+  }
+}
+
+template<class T> struct gemm_no_reduce {
+  T operator() (const T & x) const { return x; }
+};
+
+struct gemm_mod_reduce {
+  unsigned long long m;
+  gemm_mod_reduce(unsigned long long m) : m(m) {}
+
+  unsigned long long operator() (unsigned long long x) const {
+    return x % m;
+  }
+};
+
 template<class val_t> class matrix {
   int r, c;
   std::vector<std::vector<val_t> > mat;
@@ -42,6 +122,14 @@ template<class val_t> class matrix {
         mat[i][j] = init[i][j];
   }
 
+  //copies the matrix into a contiguous row-major buffer
+  template<class T> std::vector<T> flatten() const {
+    std::vector<T> res(r * c);
+    for (int i = 0; i < r; i++)
+      for (int j = 0; j < c; j++) res[i * c + j] = mat[i][j];
+    return res;
+  }
+
   operator std::vector<std::vector<val_t> > &() { return mat; }
   val_t & operator() (int r, int c) { return mat[r][c]; }
   std::vector<val_t> & operator[] (int r) { return mat[r]; }
@@ -80,10 +168,51 @@ template<class val_t> class matrix {
     if (a.c != b.r)
       throw std::runtime_error("# of a cols must equal # of b rows.");
     matrix res(a.r, b.c, 0);
+    if (a.r == 0 || b.c == 0 || a.c == 0) return res;
+    std::vector<val_t> x(a.flatten<val_t>()), y(b.flatten<val_t>());
+    std::vector<val_t> z(a.r * b.c, val_t(0));
+    gemm_add(a.r, b.c, a.c, &x[0], &y[0], &z[0], (int)gemm_depth,
+             gemm_no_reduce<val_t>());
     for (int i = 0; i < a.r; i++)
+      for (int j = 0; j < b.c; j++) res.mat[i][j] = z[i * b.c + j];
+    return res;
+  }
+
+  //a * b with every entry reduced modulo m, 1 <= m < 2^32
+  friend matrix mod_multiply(const matrix & a, const matrix & b,
+                             const val_t & m) {
+    if (a.c != b.r)
+      throw std::runtime_error("# of a cols must equal # of b rows.");
+    typedef unsigned long long u64;
+    matrix res(a.r, b.c, 0);
+    if (a.r == 0 || b.c == 0 || a.c == 0) return res;
+    std::vector<u64> x(a.r * a.c), y(b.r * b.c), z(a.r * b.c, 0);
+    for (int i = 0; i < a.r; i++)
+      for (int j = 0; j < a.c; j++)
+        x[i * a.c + j] = (a.mat[i][j] % m + m) % m;
+    for (int i = 0; i < b.r; i++)
       for (int j = 0; j < b.c; j++)
-        for (int k = 0; k < a.c; k++)
-          res.mat[i][j] += a.mat[i][k] * b.mat[k][j];
+        y[i * b.c + j] = (b.mat[i][j] % m + m) % m;
+    //entries below m, plus kc products below (m - 1)^2, must not overflow
+    u64 sq = (u64)(m - 1) * (u64)(m - 1), kc = gemm_depth;
+    if (sq > 0 && (~0ull - (u64)m) / sq < kc) kc = (~0ull - (u64)m) / sq;
+    gemm_add(a.r, b.c, a.c, &x[0], &y[0], &z[0], (int)kc,
+             gemm_mod_reduce((u64)m));
+    for (int i = 0; i < a.r; i++)
+      for (int j = 0; j < b.c; j++) res.mat[i][j] = (val_t)z[i * b.c + j];
+    return res;
+  }
+
+  //a^n with every entry reduced modulo m. precondition: a must be square
+  friend matrix mod_pow(matrix a, unsigned long long n, const val_t & m) {
+    if (a.r != a.c)
+      throw std::runtime_error("Matrix must be square for exponentiation.");
+    matrix res(identity_matrix(a.r));
+    for (int i = 0; i < a.r; i++) res.mat[i][i] %= m;
+    for (; n > 0; n >>= 1) {
+      if (n & 1) res = mod_multiply(res, a, m);
+      if (n > 1) a = mod_multiply(a, a, m);
+    }
     return res;
   }
 
@@ -174,5 +303,25 @@ int main() {
   m[0][0] += 10;
   assert(m[0][0] == 30 && m[1][1] == 20);
   assert(powsum(m2, 3) == m2 + m2*m2 + (m2^3));
+
+  //fibonacci numbers modulo 10^9 + 7 by a power of [[1,1],[1,0]]
+  long long f[2][2] = {{1, 1}, {1, 0}};
+  matrix<long long> F(f);
+  assert(mod_pow(F, 10, 1000000007ll)(0, 1) == 55);
+  cout << mod_pow(F, 1000000000000ll, 1000000007ll)(0, 1) << "\n";
+  //871022367 (rows and columns beyond a block are checked at 7 by 300)
+  matrix<long long> A(7, 300), B(300, 9);
+  for (int i = 0; i < 7; i++)
+    for (int j = 0; j < 300; j++) A[i][j] = (i * 31 + j * 17) % 1000 - 500;
+  for (int i = 0; i < 300; i++)
+    for (int j = 0; j < 9; j++) B[i][j] = (i * 7 + j * 13) % 100;
+  matrix<long long> C = A * B, D = mod_multiply(A, B, 4294967291ll);
+  for (int i = 0; i < 7; i++)
+    for (int j = 0; j < 9; j++) {
+      long long s = 0;
+      for (int k = 0; k < 300; k++) s += A[i][k] * B[k][j];
+      assert(C[i][j] == s && D[i][j] == (s % 4294967291ll + 4294967291ll) %
+                                          4294967291ll);
+    }
   return 0;
 }
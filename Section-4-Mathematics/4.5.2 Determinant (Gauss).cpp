@@ -7,6 +7,10 @@ decompositions. Since the determinant can get very large,
 look out for overflows and floating-point inaccuracies.
 Bignums are recommended for maximal correctness.
 
+Exact determinants of integer matrices are best found by
+det_bareiss() or det_multimodular() at the end of this file,
+with a bigint type such as the one in section 4.4.4.
+
 Complexity: O(N^3), except for the adjustment for
 overflow in the integer det() function.
 
@@ -16,7 +20,7 @@ Precondition: All input matrices must be square.
 
 #include <algorithm> /* std::swap() */
 #include <cassert>
-#include <cmath>     /* fabs() */
+#include <cmath>     /* fabs(), log() */
 #include <map>
 #include <vector>
 
@@ -131,6 +135,221 @@ long long det(const vvi & a) {
   return sign < 0 ? -det : det;
 }
 
+/*
+
+Fraction-Free Determinant (Bareiss)
+
+Bareiss' algorithm eliminates as the integer det() above
+does, multiplying each row by the pivot instead of dividing,
+but then divides every entry by the previous pivot, which
+Sylvester's identity guarantees to be exact. Each entry
+stays a minor of the input, so that its size is bounded by
+Hadamard's inequality instead of doubling at each step. T
+can be any integer type with exact +, -, *, /, and ==, e.g.
+a bigint, or long long if every product of two minors fits,
+since each step forms a[i][j]*a[k][k] - a[i][k]*a[k][j]
+before the division. That takes twice the bits of the
+largest minor, which may itself exceed the answer.
+
+Complexity: O(N^3) operations on numbers of O(N log(N M))
+bits, for entries of absolute value at most M.
+
+*/
+
+template<class T> T det_bareiss(std::vector<std::vector<T> > a) {
+  int n = a.size();
+  assert(!a.empty() && n == (int)a[0].size());
+  int sign = 1;
+  T prev(1);
+  for (int k = 0; k + 1 < n; k++) {
+    if (a[k][k] == T(0)) {
+      int p = k + 1;
+      while (p < n && a[p][k] == T(0)) p++;
+      if (p == n) return T(0);
+      a[k].swap(a[p]);
+      sign = -sign;
+    }
+    for (int i = k + 1; i < n; i++) {
+      for (int j = k + 1; j < n; j++)
+        a[i][j] = (a[i][j] * a[k][k] - a[i][k] * a[k][j]) / prev;
+    }
+    prev = a[k][k];
+  }
+  return sign < 0 ? T(0) - a[n - 1][n - 1] : a[n - 1][n - 1];
+}
+
+/*
+
+Multi-Modular Determinant
+
+det_mod(a, p) is the determinant modulo a prime p < 2^62 by
+Gaussian elimination, with products reduced by Montgomery
+multiplication. det_multimodular() finds it modulo enough of
+the largest primes below 2^62 that their product P is more
+than twice Hadamard's bound on the absolute value of the
+determinant, which is the product of the Euclidean lengths
+of the rows, and then reconstructs it as the residue of
+least absolute value modulo P with the Chinese remainder
+theorem, in the mixed-radix form of Garner's algorithm. The
+primes are independent of each other, so det_mod() may be
+called for them in any order.
+
+Complexity: O(N^3) per prime, for O(N log(N M) / 62) primes,
+and O(N^2 log(N M)^2) for the reconstruction with a bigint T.
+
+*/
+
+typedef unsigned long long uint64;
+
+//computes the full 128-bit product of a and b as hi*2^64 + lo
+inline void mul128(uint64 a, uint64 b, uint64 & hi, uint64 & lo) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 uint128;
+  uint128 p = (uint128)a * b;
+  hi = (uint64)(p >> 64);
+  lo = (uint64)p;
+#else
+  uint64 a0 = a & 0xffffffffULL, a1 = a >> 32;
+  uint64 b0 = b & 0xffffffffULL, b1 = b >> 32;
+  uint64 p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  uint64 mid = (p00 >> 32) + (p01 & 0xffffffffULL) + (p10 & 0xffffffffULL);
+  hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+  lo = (mid << 32) | (p00 & 0xffffffffULL);
+#endif
+}
+
+//arithmetic modulo an odd m < 2^63 on values in Montgomery form x*2^64 mod m
+class montgomery64 {
+  uint64 m, neg_inv, r2;
+
+  uint64 reduce(uint64 hi, uint64 lo) const {
+    uint64 qhi, qlo;
+    mul128(lo * neg_inv, m, qhi, qlo);
+    uint64 t = hi + qhi + (lo != 0);
+    return (t >= m) ? t - m : t;
+  }
+
+ public:
+  montgomery64(uint64 m) : m(m) {
+    uint64 inv = m;
+    for (int i = 0; i < 5; i++) inv *= 2 - m * inv;
+    neg_inv = -inv;
+    r2 = -m % m;
+    for (int i = 0; i < 64; i++) {
+      r2 <<= 1;
+      if (r2 >= m) r2 -= m;
+    }
+  }
+
+  uint64 to(uint64 x) const { return mul(x % m, r2); }
+  uint64 from(uint64 x) const { return reduce(0, x); }
+  uint64 sub(uint64 a, uint64 b) const { return a >= b ? a - b : a + m - b; }
+
+  uint64 mul(uint64 a, uint64 b) const {
+    uint64 hi, lo;
+    mul128(a, b, hi, lo);
+    return reduce(hi, lo);
+  }
+
+  uint64 power(uint64 x, uint64 n) const {
+    uint64 res = to(1);
+    for (; n > 0; n >>= 1, x = mul(x, x))
+      if (n & 1) res = mul(res, x);
+    return res;
+  }
+};
+
+//deterministic Miller-Rabin for odd n < 2^63
+bool is_prime_u64(uint64 n) {
+  static const uint64 bases[] = {2, 325, 9375, 28178, 450775, 9780504,
+                                 1795265022};
+  montgomery64 mg(n);
+  uint64 d = n - 1, one = mg.to(1), minus_one = mg.to(n - 1);
+  int s = 0;
+  for (; d % 2 == 0; s++) d /= 2;
+  for (int i = 0; i < 7; i++) {
+    if (bases[i] % n == 0) continue;
+    uint64 x = mg.power(mg.to(bases[i]), d);
+    if (x == one || x == minus_one) continue;
+    bool composite = true;
+    for (int r = 1; r < s && composite; r++) {
+      x = mg.mul(x, x);
+      composite = (x != minus_one);
+    }
+    if (composite) return false;
+  }
+  return true;
+}
+
+uint64 det_mod(const vvi & a, uint64 p) {
+  int n = a.size();
+  assert(!a.empty() && n == (int)a[0].size());
+  montgomery64 mg(p);
+  std::vector<std::vector<uint64> > b(n, std::vector<uint64>(n));
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      b[i][j] = mg.to(a[i][j] < 0 ? p - (uint64)-(long long)a[i][j] % p
+                                  : (uint64)a[i][j]);
+  uint64 det = mg.to(1);
+  for (int k = 0; k < n; k++) {
+    int r = k;
+    while (r < n && b[r][k] == 0) r++;
+    if (r == n) return 0;
+    if (r != k) {
+      b[k].swap(b[r]);
+      det = mg.sub(0, det);
+    }
+    det = mg.mul(det, b[k][k]);
+    uint64 inv = mg.power(b[k][k], p - 2);
+    for (int i = k + 1; i < n; i++) {
+      if (b[i][k] == 0) continue;
+      uint64 f = mg.mul(b[i][k], inv), * x = &b[i][0];
+      const uint64 * y = &b[k][0];
+      for (int j = k + 1; j < n; j++) x[j] = mg.sub(x[j], mg.mul(f, y[j]));
+    }
+  }
+  return mg.from(det);
+}
+
+//T must be constructible from long long, with +, -, *, and <, and must
+//hold values up to the product P of the primes used
+template<class T> T det_multimodular(const vvi & a) {
+  int n = a.size();
+  assert(!a.empty() && n == (int)a[0].size());
+  double bits = 1; //log2 of twice Hadamard's bound
+  for (int i = 0; i < n; i++) {
+    double s = 0;
+    for (int j = 0; j < n; j++) s += (double)a[i][j] * a[i][j];
+    if (s == 0) return T(0);
+    bits += 0.5 * log(s) / log(2.0);
+  }
+  std::vector<uint64> primes, residues;
+  for (uint64 q = (1ULL << 62) - 1; bits > 0; q -= 2) {
+    if (!is_prime_u64(q)) continue;
+    primes.push_back(q);
+    residues.push_back(det_mod(a, q));
+    bits -= 61.99;
+  }
+  //Garner: x = d[0] + d[1] p[0] + d[2] p[0] p[1] + ..., 0 <= d[i] < p[i]
+  int k = primes.size();
+  std::vector<uint64> d(k);
+  for (int i = 0; i < k; i++) {
+    montgomery64 mg(primes[i]);
+    uint64 x = mg.to(residues[i]);
+    for (int j = 0; j < i; j++) {
+      x = mg.mul(mg.sub(x, mg.to(d[j])), mg.power(mg.to(primes[j]),
+                                                  primes[i] - 2));
+    }
+    d[i] = mg.from(x);
+  }
+  T res(0), P(1);
+  for (int i = k - 1; i >= 0; i--)
+    res = res * T((long long)primes[i]) + T((long long)d[i]);
+  for (int i = 0; i < k; i++) P = P * T((long long)primes[i]);
+  if (P < res + res) res = res - P;
+  return res;
+}
+
 /*** Example Usage ***/
 
 #include <iostream>
@@ -148,5 +367,22 @@ int main() {
   int d1 = det(v1);
   int d2 = (int)det(v2);
   assert(d1 == d2 && d2 == -306);
+
+  //Kirchhoff's theorem: the complete graph on m nodes has m^(m - 2)
+  //spanning trees, the determinant of its Laplacian without a row/column
+  const int m = 9;
+  vvi L(m - 1, vector<int>(m - 1, -1));
+  vector<vector<long long> > Ll(m - 1, vector<long long>(m - 1, -1));
+  for (int i = 0; i < m - 1; i++) L[i][i] = Ll[i][i] = m - 1;
+  long long trees = 1;
+  for (int i = 0; i < m - 2; i++) trees *= m;
+  assert(det_bareiss(Ll) == trees);
+  assert(det_multimodular<long long>(L) == trees);
+  v1[0][0] = 0;
+  vector<vector<long long> > v3(n);
+  for (int i = 0; i < n; i++) v3[i] = vector<long long>(v1[i].begin(),
+                                                        v1[i].end());
+  assert(det_bareiss(v3) == det(v1) && det_multimodular<long long>(v1) ==
+                                       det(v1));
   return 0;
 }
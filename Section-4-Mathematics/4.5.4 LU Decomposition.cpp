@@ -8,17 +8,29 @@ of linear equations, and the inverse of a matrix.
 
 Note: in the following implementation, each call to det(),
 solve_system(), and inverse() recomputes the lu decomposition.
-For the same matrix, you should precompute the lu decomposition
-and reuse it for several of these operations afterwards.
+For the same matrix, construct an lu_factorization once instead,
+and reuse it for any number of these operations afterwards.
+
+The factorization is blocked: columns are factored in panels of
+lu_block columns, and the updates which each panel makes to the
+columns right of it are deferred and applied at once, as a single
+matrix product through gemm_add() of section 4.5.1, which makes
+most of the O(n^3) work run in cache-sized blocks. Likewise, the
+substitutions for many right-hand sides are done a block of rows
+at a time. Rows are exchanged by swapping the row vectors. If a
+column without a usable pivot is met, the rest of the matrix is
+finished unblocked, so that the result is always that of the
+plain algorithm.
 
 Complexity: O(n^3) for lu_decompose(). det() uses the running time
 of lu_decompose(), plus an addition O(n) term. solve_system() and
 inverse() both have the running time of lu_decompose(), plus an
-additional O(n^3) term.
+additional O(n^3) term. Given an lu_factorization, solving for an
+n by m matrix B takes O(n^2 m), and det() takes O(n).
 
 */
 
-#include <algorithm> /* std::swap() */
+#include <algorithm> /* std::max(), std::min(), std::swap() */
 #include <cassert>
 #include <cmath>     /* fabs() */
 #include <vector>
@@ -27,6 +39,82 @@ static const double eps = 1e-10;
 typedef std::vector<double> vd;
 typedef std::vector<vd> vvd;
 
+/*** Blocked matrix multiplication of section 4.5.1 ***/
+
+enum { gemm_rows = 4, gemm_cols = 4, gemm_depth = 128, gemm_width = 256 };
+
+template<class T, class Reduce>
+void gemm_add(int M, int N, int K, const T * a, const T * b, T * c,
+              int kc, Reduce reduce) {
+  std::vector<T> ap(gemm_rows * kc), bp(gemm_cols * kc * (gemm_width /
+                                                          gemm_cols));
+  for (int k0 = 0; k0 < K; k0 += kc) {
+    int kn = std::min(kc, K - k0);
+    for (int j0 = 0; j0 < N; j0 += gemm_width) {
+      int jn = std::min((int)gemm_width, N - j0);
+      for (int jp = 0; jp < jn; jp += gemm_cols) {
+        T * panel = &bp[jp * kn];
+        for (int k = 0; k < kn; k++)
+          for (int j = 0; j < gemm_cols; j++)
+            panel[k * gemm_cols + j] = (jp + j < jn) ?
+                b[(k0 + k) * N + j0 + jp + j] : T(0);
+      }
+      for (int i0 = 0; i0 < M; i0 += gemm_rows) {
+        int in = std::min((int)gemm_rows, M - i0);
+        for (int k = 0; k < kn; k++)
+          for (int i = 0; i < gemm_rows; i++)
+            ap[k * gemm_rows + i] = (i < in) ?
+                a[(i0 + i) * K + k0 + k] : T(0);
+        for (int jp = 0; jp < jn; jp += gemm_cols) {
+          const T * x = &ap[0], * y = &bp[jp * kn];
+          T acc[gemm_rows][gemm_cols];
+          for (int i = 0; i < gemm_rows; i++)
+            for (int j = 0; j < gemm_cols; j++)
+              acc[i][j] = T(0);
+          for (int k = 0; k < kn; k++, x += gemm_rows, y += gemm_cols)
+            for (int i = 0; i < gemm_rows; i++)
+              for (int j = 0; j < gemm_cols; j++)
+                acc[i][j] += x[i] * y[j];
+          int width = std::min((int)gemm_cols, jn - jp);
+          for (int i = 0; i < in; i++)
+            for (int j = 0; j < width; j++)
+              c[(i0 + i) * N + j0 + jp + j] += acc[i][j];
+        }
+      }
+    }
+    for (int i = 0; i < M * N; i++) c[i] = reduce(c[i]);
+  }
+}
+
+template<class T> struct gemm_no_reduce {
+  T operator() (const T & x) const { return x; }
+};
+
+/*** LU decomposition ***/
+
+const int lu_block = 64;
+
+//subtracts the product of the block of a in rows [i0, i1) and columns
+//[k0, k1) and the block of b in rows [k0, k1) and columns [j0, m) from
+//the block of c in rows [i0, i1) and columns [j0, m), where the blocks
+//which are read must not overlap the one which is written
+void subtract_product(const vvd & a, const vvd & b, vvd & c,
+                      int i0, int i1, int k0, int k1, int j0) {
+  int M = i1 - i0, N = (int)c[0].size() - j0, K = k1 - k0;
+  if (M <= 0 || N <= 0 || K <= 0) return;
+  vd x(M * K), y(K * N), z(M * N);
+  for (int i = 0; i < M; i++)
+    for (int k = 0; k < K; k++) x[i * K + k] = -a[i0 + i][k0 + k];
+  for (int k = 0; k < K; k++)
+    for (int j = 0; j < N; j++) y[k * N + j] = b[k0 + k][j0 + j];
+  for (int i = 0; i < M; i++)
+    for (int j = 0; j < N; j++) z[i * N + j] = c[i0 + i][j0 + j];
+  gemm_add(M, N, K, &x[0], &y[0], &z[0], (int)gemm_depth,
+           gemm_no_reduce<double>());
+  for (int i = 0; i < M; i++)
+    for (int j = 0; j < N; j++) c[i0 + i][j0 + j] = z[i * N + j];
+}
+
 /*
 
 LU decomposition with Gauss-Jordan elimination. This is generalized
@@ -38,17 +126,49 @@ Optionally determine the permutation vector p. If an array p is
 passed, p[i] will be populated such that p[i] is the only column of
 the i-th row of the permutation matrix that is equal to 1.
 
+lu_decompose_in_place() is the same, but overwrites a with the
+result instead of working on a copy.
+
 Returns: a matrix m, the merged lower/upper triangular matrix:
          m[i][j] = l[i][j] (for i > j) or u[i][j] (for i <= j)
 
 */
 
-vvd lu_decompose(vvd a, int * detsign = 0, int * p = 0) {
+void lu_decompose_in_place(vvd & a, int * detsign = 0, int * p = 0) {
   int n = a.size(), m = a[0].size();
-  int sign = 1;
+  int sign = 1, r = 0, c = 0;
   if (p != 0)
     for (int i = 0; i < n; i++) p[i] = i;
-  for (int r = 0, c = 0; r < n && c < m; r++, c++) {
+  //blocked phase, with r == c until a column without a pivot is met
+  while (r < n && c < m) {
+    int end = r + std::min(lu_block, std::min(n - r, m - c)), k;
+    for (k = r; k < end; k++) {
+      int pr = k;
+      for (int i = k + 1; i < n; i++)
+        if (fabs(a[i][k]) > fabs(a[pr][k]))
+          pr = i;
+      if (fabs(a[pr][k]) <= eps) break;
+      if (pr != k) {
+        if (p != 0) std::swap(p[k], p[pr]);
+        sign = -sign;
+        a[k].swap(a[pr]);
+      }
+      for (int s = k + 1; s < n; s++) {
+        a[s][k] /= a[k][k];
+        for (int d = k + 1; d < end; d++)
+          a[s][d] -= a[s][k] * a[k][d];
+      }
+    }
+    //apply the deferred updates of columns [r, k) to the columns from end
+    for (int i = r + 1; i < k; i++)
+      for (int t = r; t < i; t++)
+        for (int d = end; d < m; d++)
+          a[i][d] -= a[i][t] * a[t][d];
+    subtract_product(a, a, a, k, n, r, k, end);
+    r = c = k;
+    if (k < end) break;
+  }
+  for (; r < n && c < m; r++, c++) {
     int pr = r;
     for (int i = r + 1; i < n; i++)
       if (fabs(a[i][c]) > fabs(a[pr][c]))
@@ -60,8 +180,7 @@ vvd lu_decompose(vvd a, int * detsign = 0, int * p = 0) {
     if (pr != r) {
       if (p != 0) std::swap(p[r], p[pr]);
       sign = -sign;
-      for (int i = 0; i < m; i++)
-        std::swap(a[r][i], a[pr][i]);
+      a[r].swap(a[pr]);
     }
     for (int s = r + 1; s < n; s++) {
       a[s][c] /= a[r][c];
@@ -70,6 +189,10 @@ vvd lu_decompose(vvd a, int * detsign = 0, int * p = 0) {
     }
   }
   if (detsign != 0) *detsign = sign;
+}
+
+vvd lu_decompose(vvd a, int * detsign = 0, int * p = 0) {
+  lu_decompose_in_place(a, detsign, p);
   return a;
 }
 
@@ -82,15 +205,110 @@ double getu(const vvd & lu, int i, int j) {
   return i <= j ? lu[i][j] : 0.0;
 }
 
+/*
+
+A factorization of a square matrix A which is computed once and then
+reused. Constructing it from a const matrix copies A, while factor(a)
+factors a in place, taking over its storage and leaving it empty.
+solve(B) returns X such that A*X = B for an n by m matrix B (or for a
+single vector b), where the substitutions for all m columns of B are
+done together, one block of rows of L or U at a time.
+
+*/
+
+class lu_factorization {
+  vvd lu;
+  std::vector<int> p;
+  int sign;
+
+  //solves L*Y = P*B and then U*X = Y for X, overwriting y = B
+  void substitute(vvd & y) const {
+    int n = lu.size();
+    for (int i0 = 0; i0 < n; i0 += lu_block) {
+      int i1 = std::min(n, i0 + lu_block);
+      for (int i = i0 + 1; i < i1; i++)
+        for (int k = i0; k < i; k++)
+          for (int j = 0; j < (int)y[i].size(); j++)
+            y[i][j] -= lu[i][k] * y[k][j];
+      subtract_product(lu, y, y, i1, n, i0, i1, 0);
+    }
+    for (int i1 = n; i1 > 0; i1 -= lu_block) {
+      int i0 = std::max(0, i1 - lu_block);
+      for (int i = i1 - 1; i >= i0; i--) {
+        for (int k = i + 1; k < i1; k++)
+          for (int j = 0; j < (int)y[i].size(); j++)
+            y[i][j] -= lu[i][k] * y[k][j];
+        for (int j = 0; j < (int)y[i].size(); j++)
+          y[i][j] /= lu[i][i];
+      }
+      subtract_product(lu, y, y, 0, i0, i0, i1, 0);
+    }
+  }
+
+ public:
+  lu_factorization() : sign(1) {}
+
+  explicit lu_factorization(const vvd & a) {
+    vvd b(a);
+    factor(b);
+  }
+
+  //precondition: a is square and not empty
+  void factor(vvd & a) {
+    assert(!a.empty() && a.size() == a[0].size());
+    lu.swap(a);
+    a.clear();
+    p.resize(lu.size());
+    lu_decompose_in_place(lu, &sign, &p[0]);
+  }
+
+  int size() const { return lu.size(); }
+  const vvd & decomposition() const { return lu; }
+  const std::vector<int> & permutation() const { return p; }
+
+  double det() const {
+    double res = (sign < 0) ? -1 : 1;
+    for (int i = 0; i < (int)lu.size(); i++)
+      res *= lu[i][i];
+    return res;
+  }
+
+  //precondition: B is n by m
+  vvd solve(const vvd & b) const {
+    int n = lu.size();
+    assert(n == (int)b.size());
+    vvd y(n);
+    for (int i = 0; i < n; i++) y[i] = b[p[i]];
+    substitute(y);
+    return y;
+  }
+
+  vd solve(const vd & b) const {
+    int n = lu.size();
+    assert(n == (int)b.size());
+    vd x(n);
+    for (int i = 0; i < n; i++) {
+      x[i] = b[p[i]];
+      for (int k = 0; k < i; k++) x[i] -= lu[i][k] * x[k];
+    }
+    for (int i = n - 1; i >= 0; i--) {
+      for (int k = i + 1; k < n; k++) x[i] -= lu[i][k] * x[k];
+      x[i] /= lu[i][i];
+    }
+    return x;
+  }
+
+  vvd inverse() const {
+    int n = lu.size();
+    vvd I(n, vd(n));
+    for (int i = 0; i < n; i++) I[i][i] = 1;
+    return solve(I);
+  }
+};
+
 //Precondition: A is square matrix.
 double det(const vvd & a) {
-  int n = a.size(), detsign;
-  assert(!a.empty() && n == (int)a[0].size());
-  vvd lu = lu_decompose(a, &detsign);
-  double det = 1;
-  for (int i = 0; i < n; i++)
-    det *= lu[i][i];
-  return detsign < 0 ? -det : det;
+  return lu_factorization(a).det();
 }
 
 /*
@@ -102,33 +320,8 @@ Returns: an n by m matrix X such that A*X = B.
 */
 
 vvd solve_system(const vvd & a, const vvd & b) {
-  int n = b.size(), m = b[0].size();
-  assert(!a.empty() && n == (int)a.size() && n == (int)a[0].size());
-  int detsign, p[a.size()];
-  vvd lu = lu_decompose(a, &detsign, p);
-  //forward substitute for Y in L*Y = B
-  vvd y(n, vd(m));
-  for (int j = 0; j < m; j++) {
-    y[0][j] = b[p[0]][j] / getl(lu, 0, 0);
-    for (int i = 1; i < n; i++) {
-      double s = 0;
-      for (int k = 0; k < i; k++)
-        s += getl(lu, i, k) * y[k][j];
-      y[i][j] = (b[p[i]][j] - s) / getl(lu, i, i);
-    }
-  }
-  //backward substitute for X in U*X = Y
-  vvd x(n, vd(m));
-  for (int j = 0; j < m; j++) {
-    x[n - 1][j] = y[n - 1][j] / getu(lu, n-1, n-1);
-    for (int i = n - 2; i >= 0; i--) {
-      double s = 0;
-      for (int k = i + 1; k < n; k++)
-        s += getu(lu, i, k) * x[k][j];
-      x[i][j] = (y[i][j] - s) / getu(lu, i, i);
-    }
-  }
-  return x;
+  assert(!a.empty() && b.size() == a.size());
+  return lu_factorization(a).solve(b);
 }
 
 /*
@@ -137,18 +330,13 @@ Find the inverse A^-1 of a matrix A. The inverse of a matrix
 satisfies A * A^-1 = I, where I is the identity matrix (for
 all pairs (i, j), I[i][j] = 1 iff i = j, else I[i][j] = 0).
 The inverse of a matrix exists if and only if det(a) is not 0.
-We're lazy, so we just generate I and call solve_system().
 
 Precondition: A is a square and det(A) != 0.
 
 */
 
 vvd inverse(const vvd & a) {
-  int n = a.size();
-  assert(!a.empty() && n == (int)a[0].size());
-  vvd I(n, vd(n));
-  for (int i = 0; i < n; i++) I[i][i] = 1;
-  return solve_system(a, I);
+  return lu_factorization(a).inverse();
 }
 
 /*** Example Usage ***/
@@ -227,5 +415,30 @@ int main() {
       v[i] = vector<double>(a[i], a[i] + n);
     print(inverse(v)); //[[2,-3],[-1,2]]
   }
+
+  { //factor once, then solve for many right-hand sides
+    const int n = 150, m = 40;
+    vvd a(n, vd(n)), b(n, vd(m));
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) a[i][j] = (i * 37 + j * 11) % 19 - 9;
+      a[i][i] += 100;
+      for (int j = 0; j < m; j++) b[i][j] = (i + j) % 7;
+    }
+    lu_factorization f(a);
+    vvd x = f.solve(b);
+    vd x0 = f.solve(vd(b.size(), 1.0));
+    for (int i = 0; i < n; i++) {
+      double s0 = 0;
+      for (int j = 0; j < m; j++) {
+        double s = 0;
+        for (int k = 0; k < n; k++) s += a[i][k] * x[k][j];
+        assert(fabs(s - b[i][j]) < 1e-9);
+      }
+      for (int k = 0; k < n; k++) s0 += a[i][k] * x0[k];
+      assert(fabs(s0 - 1.0) < 1e-9);
+    }
+    f.factor(a); //in place, leaving a empty
+    assert(a.empty() && f.size() == n);
+  }
   return 0;
 }
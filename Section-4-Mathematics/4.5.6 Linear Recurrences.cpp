@@ -0,0 +1,378 @@
+/*
+
+A linear recurrence of order d is a sequence a[0], a[1], ... in which
+every term from a[d] on is a fixed linear combination of the d terms
+before it, a[n] = c[1]a[n - 1] + c[2]a[n - 2] + ... + c[d]a[n - d].
+Computing a[k] by raising the d by d companion matrix to the k-th power
+with the matrix class of section 4.5.1 takes O(d^3 log k). The following
+instead work with polynomials modulo a prime p, where every function is
+templated on one of the modular reduction engines of section 1.5.1 (the
+three engines are repeated below), which keep values in an internal form
+given by to(), multiply them with mul(), and convert them back by from().
+
+berlekamp_massey(r, s) returns the coefficients c[1..d] of the shortest
+linear recurrence which generates the sequence s modulo p. If s is
+generated by a recurrence of order d, then its first 2d terms suffice to
+find it.
+
+kitamasa(r, c, a, k) returns a[k] given the recurrence c and the first d
+terms a[0..d - 1], by computing the remainder of x^k divided by the
+characteristic polynomial x^d - c[1]x^(d - 1) - ... - c[d] by repeated
+squaring, since a[k] is the same combination of a[0..d - 1] as the
+remainder is of 1, x, ..., x^(d - 1). Each squaring and reduction takes
+O(d^2) schoolbook.
+
+bostan_mori(r, c, a, k) returns the same term as the coefficient of x^k
+in the power series P(x)/Q(x), where Q(x) = 1 - c[1]x - ... - c[d]x^d
+and P(x) = A(x)Q(x) mod x^d for A(x) = a[0] + ... + a[d - 1]x^(d - 1).
+Multiplying the numerator and denominator by Q(-x) makes the denominator
+even, so that only the half of the numerator of the same parity as k is
+needed, and k halves at each step. If p - 1 is divisible by a power of 2
+of at least 2d + 1 (as for p = 998244353 = 119*2^23 + 1), the products
+are taken by the number-theoretic transform in O(d log d), and otherwise
+by the schoolbook method.
+
+linear_recurrence_term(r, s, k) recovers the recurrence of s with
+berlekamp_massey(), and then finds a[k] with whichever of the above is
+faster for its order.
+
+Time Complexity: O(N^2) for berlekamp_massey() on N terms, O(d^2 log k)
+for kitamasa(), and O(d log d log k) for bostan_mori() when the NTT
+applies (otherwise O(d^2 log k)). All values are taken modulo the prime
+p = r.modulus().
+
+Space Complexity: O(N) auxiliary for berlekamp_massey() on N terms, and
+O(d) auxiliary for kitamasa() and bostan_mori().
+
+*/
+
+#include <algorithm> /* std::swap() */
+#include <vector>
+
+typedef unsigned long long uint64;
+
+/*** Reduction engines of section 1.5.1 ***/
+
+//computes the full 128-bit product of a and b as hi*2^64 + lo
+inline void mul128(uint64 a, uint64 b, uint64 & hi, uint64 & lo) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 uint128;
+  uint128 p = (uint128)a * b;
+  hi = (uint64)(p >> 64);
+  lo = (uint64)p;
+#else
+  uint64 a0 = a & 0xffffffffULL, a1 = a >> 32;
+  uint64 b0 = b & 0xffffffffULL, b1 = b >> 32;
+  uint64 p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  uint64 mid = (p00 >> 32) + (p01 & 0xffffffffULL) + (p10 & 0xffffffffULL);
+  hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+  lo = (mid << 32) | (p00 & 0xffffffffULL);
+#endif
+}
+
+class montgomery64 {
+  uint64 m, neg_inv, r2;
+
+  //returns t*2^-64 (mod m) for t = hi*2^64 + lo, given hi < m
+  uint64 reduce(uint64 hi, uint64 lo) const {
+    uint64 qhi, qlo;
+    mul128(lo * neg_inv, m, qhi, qlo);
+    uint64 t = hi + qhi + (lo != 0);
+    return (t >= m) ? t - m : t;
+  }
+
+ public:
+  montgomery64(uint64 m) : m(m) {
+    uint64 inv = m;
+    for (int i = 0; i < 5; i++) inv *= 2 - m * inv;
+    neg_inv = -inv;
+    r2 = -m % m;
+    for (int i = 0; i < 64; i++) {
+      r2 <<= 1;
+      if (r2 >= m) r2 -= m;
+    }
+  }
+
+  uint64 modulus() const { return m; }
+  uint64 to(uint64 x) const { return mul(x % m, r2); }
+  uint64 from(uint64 x) const { return reduce(0, x); }
+
+  uint64 mul(uint64 a, uint64 b) const {
+    uint64 hi, lo;
+    mul128(a, b, hi, lo);
+    return reduce(hi, lo);
+  }
+};
+
+class barrett32 {
+  uint64 m, inv;
+
+ public:
+  barrett32(uint64 m) : m(m), inv(~0ULL / m) {}
+
+  uint64 modulus() const { return m; }
+  uint64 to(uint64 x) const { return x % m; }
+  uint64 from(uint64 x) const { return x; }
+
+  uint64 mul(uint64 a, uint64 b) const {
+    uint64 x = a * b, q, lo;
+    mul128(x, inv, q, lo);
+    uint64 r = x - q * m;
+    if (r >= m) r -= m;
+    return (r >= m) ? r - m : r;
+  }
+};
+
+template<uint64 M> struct static_mod {
+  uint64 modulus() const { return M; }
+  uint64 to(uint64 x) const { return x % M; }
+  uint64 from(uint64 x) const { return x; }
+  uint64 mul(uint64 a, uint64 b) const { return a * b % M; }
+};
+
+/*** Polynomial arithmetic on values in the internal form of an engine ***/
+
+//every engine keeps values reduced below the modulus, in a form which is
+//linear, so that sums are taken as for plain residues
+template<class R> inline uint64 add(const R & r, uint64 a, uint64 b) {
+  uint64 m = r.modulus();
+  return (a >= m - b) ? a - (m - b) : a + b;
+}
+
+template<class R> inline uint64 sub(const R & r, uint64 a, uint64 b) {
+  return (a >= b) ? a - b : a + (r.modulus() - b);
+}
+
+template<class R> uint64 power(const R & r, uint64 x, uint64 n) {
+  uint64 res = r.to(1);
+  for (; n > 0; n >>= 1, x = r.mul(x, x))
+    if (n & 1) res = r.mul(res, x);
+  return res;
+}
+
+template<class R> uint64 inverse(const R & r, uint64 x) {
+  return power(r, x, r.modulus() - 2);
+}
+
+//the largest n = 2^j dividing p - 1, for which there is an NTT modulo p
+template<class R> uint64 ntt_limit(const R & r) {
+  uint64 q = r.modulus() - 1;
+  return q & -q;
+}
+
+//transforms a.size() = n values in place, where n divides ntt_limit(r)
+template<class R>
+void ntt(const R & r, std::vector<uint64> & a, bool inverse = false) {
+  int n = a.size();
+  uint64 p = r.modulus(), one = r.to(1), w = 0;
+  //w = x^((p - 1)/n) has order n iff w^(n/2) != 1, for some small x
+  for (uint64 x = 2; n > 1; x++) {
+    w = power(r, r.to(x), (p - 1) / n);
+    if (power(r, w, n / 2) != one) break;
+  }
+  if (inverse) w = ::inverse(r, w);
+  for (int i = 1, j = 0; i < n; i++) {
+    int bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) std::swap(a[i], a[j]);
+  }
+  std::vector<uint64> roots(n / 2 + 1, one);
+  for (int len = 1; len < n; len <<= 1) {
+    uint64 step = power(r, w, n / (2 * len));
+    for (int j = 1; j < len; j++) roots[j] = r.mul(roots[j - 1], step);
+    for (int i = 0; i < n; i += 2 * len)
+      for (int j = 0; j < len; j++) {
+        uint64 u = a[i + j], v = r.mul(a[i + j + len], roots[j]);
+        a[i + j] = add(r, u, v);
+        a[i + j + len] = sub(r, u, v);
+      }
+  }
+  if (inverse) {
+    uint64 ninv = ::inverse(r, r.to(n));
+    for (int i = 0; i < n; i++) a[i] = r.mul(a[i], ninv);
+  }
+}
+
+//the product of polynomials a and b, by the NTT if it applies
+template<class R>
+std::vector<uint64> multiply(const R & r, const std::vector<uint64> & a,
+                             const std::vector<uint64> & b) {
+  if (a.empty() || b.empty()) return std::vector<uint64>();
+  int m = a.size() + b.size() - 1, n = 1;
+  while (n < m) n <<= 1;
+  std::vector<uint64> res(m, 0);
+  if (a.size() < 32 || b.size() < 32 || ntt_limit(r) % n != 0) {
+    for (int i = 0; i < (int)a.size(); i++)
+      for (int j = 0; j < (int)b.size(); j++)
+        res[i + j] = add(r, res[i + j], r.mul(a[i], b[j]));
+    return res;
+  }
+  std::vector<uint64> x(a), y(b);
+  x.resize(n, 0);
+  y.resize(n, 0);
+  ntt(r, x);
+  ntt(r, y);
+  for (int i = 0; i < n; i++) x[i] = r.mul(x[i], y[i]);
+  ntt(r, x, true);
+  x.resize(m);
+  return x;
+}
+
+/*** Linear recurrences ***/
+
+//returns c[1..d] (as c[0..d - 1]) for the shortest recurrence generating s
+template<class R>
+std::vector<uint64> berlekamp_massey(const R & r,
+                                     const std::vector<uint64> & s) {
+  int n = s.size(), L = 0, m = 1;
+  std::vector<uint64> x(n), C(n + 1, 0), B(n + 1, 0), T;
+  for (int i = 0; i < n; i++) x[i] = r.to(s[i]);
+  C[0] = B[0] = r.to(1);
+  uint64 b = C[0];
+  for (int i = 0; i < n; i++, m++) {
+    uint64 d = x[i];
+    for (int j = 1; j <= L; j++) d = add(r, d, r.mul(C[j], x[i - j]));
+    if (d == 0) continue;
+    uint64 coef = r.mul(d, inverse(r, b));
+    T = C;
+    for (int j = m; j <= n; j++)
+      C[j] = sub(r, C[j], r.mul(coef, B[j - m]));
+    if (2 * L <= i) {
+      L = i + 1 - L;
+      B = T;
+      b = d;
+      m = 0;
+    }
+  }
+  std::vector<uint64> res(L);
+  for (int j = 1; j <= L; j++) res[j - 1] = r.from(sub(r, 0, C[j]));
+  return res;
+}
+
+//returns a[k] for a[n] = c[0]a[n - 1] + ... + c[d - 1]a[n - d]
+template<class R>
+uint64 kitamasa(const R & r, const std::vector<uint64> & c,
+                const std::vector<uint64> & a, uint64 k) {
+  int d = c.size();
+  if (k < a.size()) return a[k] % r.modulus();
+  if (d == 0) return 0;
+  std::vector<uint64> cc(d), res(d, 0), sq(2 * d, 0);
+  for (int i = 0; i < d; i++) cc[i] = r.to(c[i]);
+  int top = 63;
+  while (!((k >> top) & 1)) top--;
+  res[0] = r.to(1); //res = x^0, with the bits of k consumed from the top
+  for (int bit = top; bit >= 0; bit--) {
+    //square res, and reduce by x^d = c[0]x^(d - 1) + ... + c[d - 1]
+    std::fill(sq.begin(), sq.end(), 0);
+    for (int i = 0; i < d; i++)
+      if (res[i] != 0)
+        for (int j = 0; j < d; j++)
+          sq[i + j] = add(r, sq[i + j], r.mul(res[i], res[j]));
+    if ((k >> bit) & 1) { //multiply by x
+      for (int i = 2 * d - 1; i > 0; i--) sq[i] = sq[i - 1];
+      sq[0] = 0;
+    }
+    for (int i = 2 * d - 1; i >= d; i--)
+      if (sq[i] != 0)
+        for (int j = 0; j < d; j++)
+          sq[i - 1 - j] = add(r, sq[i - 1 - j], r.mul(sq[i], cc[j]));
+    std::copy(sq.begin(), sq.begin() + d, res.begin());
+  }
+  uint64 sum = 0;
+  for (int i = 0; i < d; i++) sum = add(r, sum, r.mul(res[i], r.to(a[i])));
+  return r.from(sum);
+}
+
+//returns the same a[k] as kitamasa(), as the coefficient of x^k in P/Q
+template<class R>
+uint64 bostan_mori(const R & r, const std::vector<uint64> & c,
+                   const std::vector<uint64> & a, uint64 k) {
+  int d = c.size();
+  if (k < a.size()) return a[k] % r.modulus();
+  if (d == 0) return 0;
+  std::vector<uint64> Q(d + 1), A(d), P, Qm, U, V;
+  Q[0] = r.to(1);
+  for (int i = 0; i < d; i++) {
+    Q[i + 1] = sub(r, 0, r.to(c[i]));
+    A[i] = r.to(a[i]);
+  }
+  P = multiply(r, A, Q);
+  P.resize(d);
+  for (; k > 0; k >>= 1) {
+    Qm = Q;
+    for (int i = 1; i <= d; i += 2) Qm[i] = sub(r, 0, Qm[i]);
+    U = multiply(r, P, Qm);
+    V = multiply(r, Q, Qm);
+    for (int i = 0; i < d; i++) {
+      int j = 2 * i + (int)(k & 1);
+      P[i] = (j < (int)U.size()) ? U[j] : 0;
+    }
+    for (int i = 0; i <= d; i++) Q[i] = V[2 * i];
+  }
+  return r.from(r.mul(P[0], inverse(r, Q[0])));
+}
+
+//returns a[k] for the linear recurrence found for the first terms s
+template<class R>
+uint64 linear_recurrence_term(const R & r, const std::vector<uint64> & s,
+                              uint64 k) {
+  if (k < s.size()) return s[k] % r.modulus();
+  std::vector<uint64> c = berlekamp_massey(r, s);
+  if (c.empty()) return 0;
+  std::vector<uint64> a(s.begin(), s.begin() + c.size());
+  uint64 n = 1;
+  while (n < 2 * c.size() + 1) n <<= 1;
+  if (c.size() >= 128 && ntt_limit(r) % n == 0)
+    return bostan_mori(r, c, a, k);
+  return kitamasa(r, c, a, k);
+}
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+
+int main() {
+  //fibonacci numbers, a[n] = a[n - 1] + a[n - 2]
+  static_mod<1000000007> r;
+  uint64 f[] = {0, 1, 1, 2, 3, 5, 8, 13};
+  vector<uint64> fib(f, f + 8), c = berlekamp_massey(r, fib);
+  assert(c.size() == 2 && c[0] == 1 && c[1] == 1);
+  assert(kitamasa(r, c, fib, 10) == 55);
+  assert(bostan_mori(r, c, fib, 10) == 55);
+  vector<uint64> none;
+  assert(kitamasa(r, none, none, 10) == 0);
+  assert(bostan_mori(r, none, none, 10) == 0);
+  cout << linear_recurrence_term(r, fib, 1000000000000ull) << "\n";
+  //871022367, as by mod_pow() of section 4.5.1
+
+  //a random recurrence of order 200, modulo NTT-friendly and other primes
+  static_mod<998244353> ntt_mod;
+  montgomery64 mont(1000000000000000003ull);
+  barrett32 barr(1000000007);
+  int d = 200;
+  vector<uint64> cs(d), s(2 * d);
+  for (int i = 0; i < d; i++) {
+    cs[i] = rand() % 998244353;
+    s[i] = rand() % 998244353;
+  }
+  for (int i = d; i < 2 * d; i++) {
+    unsigned long long v = 0;
+    for (int j = 0; j < d; j++)
+      v = (v + cs[j] * s[i - 1 - j]) % 998244353;
+    s[i] = v;
+  }
+  assert(berlekamp_massey(ntt_mod, s) == cs);
+  for (uint64 k = 0; k < s.size(); k++)
+    assert(kitamasa(ntt_mod, cs, s, k) == s[k] &&
+           bostan_mori(ntt_mod, cs, s, k) == s[k]);
+  uint64 k = 987654321987654321ull;
+  assert(kitamasa(ntt_mod, cs, s, k) == bostan_mori(ntt_mod, cs, s, k));
+  assert(linear_recurrence_term(ntt_mod, s, k) == kitamasa(ntt_mod, cs, s, k));
+  assert(kitamasa(mont, cs, s, k) == bostan_mori(mont, cs, s, k));
+  assert(kitamasa(barr, cs, s, k) == bostan_mori(barr, cs, s, k));
+  return 0;
+}
@@ -0,0 +1,358 @@
+/*
+
+Solve a system of n linear equations A*x = b in n unknowns, where
+A is sparse (most of its n^2 entries are 0), by iterative methods
+which only ever multiply A by vectors. A is stored in compressed
+sparse row (CSR) format: the nonzero entries of row i, sorted by
+column, are at positions [start[i], start[i + 1]) of the parallel
+arrays index (their columns) and value. A csr_matrix is built from
+a list of (row, column, value) triplets, in which duplicates
+are summed as when a finite element stiffness matrix is assembled.
+
+Each solver starts from the initial guess passed in x, stops once
+the residual |b - A*x| is at most tol*|b|, and returns the number
+of iterations taken, or -1 if max_iter iterations did not suffice.
+
+- conjugate_gradient() requires A to be symmetric and positive
+  definite, and then converges in at most n steps in exact
+  arithmetic, in practice in O(sqrt(condition number)) steps.
+- bicgstab() is the stabilized biconjugate gradient method for
+  general matrices, taking two multiplications per iteration.
+- gmres() is the generalized minimal residual method restarted
+  after every restart steps of building an orthonormal basis of
+  the Krylov space, which minimizes the residual over the basis
+  with Givens rotations.
+
+A preconditioner M approximates A^-1 cheaply, where apply(r, z)
+sets z = M*r, and all of the solvers converge much faster on the
+better conditioned M*A. The identity_preconditioner does nothing.
+The jacobi_preconditioner divides by the diagonal of A. The
+ilu0_preconditioner computes the incomplete LU factorization of A
+which keeps exactly the nonzero pattern of A, and applies it by a
+forward and a backward substitution, which requires every entry
+of the diagonal of A to be nonzero.
+
+Multiplication by A may be split over ranges of rows, as with the
+optional arguments of multiply(), where every row is computed
+independently of the others.
+
+Time Complexity: O(nnz log nnz) to build a matrix with nnz entries
+from triplets, O(n + nnz) for multiply() and for each iteration of
+conjugate_gradient() and bicgstab(), both with the preconditioners
+above, and O(restart*(n + nnz)) per iteration of gmres(). The
+ilu0_preconditioner takes O(sum of the squared row lengths) time
+to construct.
+
+Space Complexity: O(n + nnz) for a matrix and the preconditioners,
+and O(n) auxiliary for conjugate_gradient() and bicgstab(), and
+O(restart*n) auxiliary for gmres().
+
+*/
+
+#include <algorithm> /* std::sort() */
+#include <cmath>     /* fabs(), sqrt() */
+#include <utility>   /* std::make_pair(), std::pair */
+#include <vector>
+
+typedef std::vector<double> vd;
+
+struct triplet {
+  int row, col;
+  double value;
+
+  triplet(int r, int c, double v): row(r), col(c), value(v) {}
+
+  bool operator < (const triplet & t) const {
+    return row != t.row ? row < t.row : col < t.col;
+  }
+};
+
+struct csr_matrix {
+  int rows, cols;
+  std::vector<int> start, index;
+  vd value;
+
+  csr_matrix(int rows, int cols, std::vector<triplet> t)
+      : rows(rows), cols(cols), start(rows + 1, 0) {
+    std::sort(t.begin(), t.end());
+    for (int j = 0; j < (int)t.size(); j++) {
+      if (j > 0 && t[j].row == t[j - 1].row && t[j].col == t[j - 1].col) {
+        value.back() += t[j].value;
+        continue;
+      }
+      index.push_back(t[j].col);
+      value.push_back(t[j].value);
+      start[t[j].row + 1]++;
+    }
+    for (int i = 0; i < rows; i++) start[i + 1] += start[i];
+  }
+
+  int nonzeros() const { return index.size(); }
+
+  //sets y[i] = (A*x)[i] for the rows i in [lo, hi), by default all rows
+  void multiply(const vd & x, vd & y, int lo = 0, int hi = -1) const {
+    if (hi < 0) hi = rows;
+    y.resize(rows);
+    for (int i = lo; i < hi; i++) {
+      double s = 0;
+      for (int j = start[i]; j < start[i + 1]; j++)
+        s += value[j] * x[index[j]];
+      y[i] = s;
+    }
+  }
+};
+
+double dot(const vd & a, const vd & b) {
+  double s = 0;
+  for (int i = 0; i < (int)a.size(); i++) s += a[i] * b[i];
+  return s;
+}
+
+double norm(const vd & a) {
+  return sqrt(dot(a, a));
+}
+
+struct identity_preconditioner {
+  void apply(const vd & r, vd & z) const { z = r; }
+};
+
+struct jacobi_preconditioner {
+  vd inv_diag;
+
+  jacobi_preconditioner(const csr_matrix & A) : inv_diag(A.rows, 1.0) {
+    for (int i = 0; i < A.rows; i++)
+      for (int j = A.start[i]; j < A.start[i + 1]; j++)
+        if (A.index[j] == i && A.value[j] != 0)
+          inv_diag[i] = 1.0 / A.value[j];
+  }
+
+  void apply(const vd & r, vd & z) const {
+    z.resize(r.size());
+    for (int i = 0; i < (int)r.size(); i++) z[i] = r[i] * inv_diag[i];
+  }
+};
+
+struct ilu0_preconditioner {
+  csr_matrix LU; //L below the diagonal (with a unit diagonal), U on and above
+  std::vector<int> diag; //the position of the diagonal entry of each row
+
+  ilu0_preconditioner(const csr_matrix & A) : LU(A), diag(A.rows, -1) {
+    const std::vector<int> & st = LU.start, & ix = LU.index;
+    vd & v = LU.value;
+    std::vector<int> pos(A.cols, -1); //position of each column in row i
+    for (int i = 0; i < A.rows; i++) {
+      for (int j = st[i]; j < st[i + 1]; j++) {
+        pos[ix[j]] = j;
+        if (ix[j] == i) diag[i] = j;
+      }
+      for (int j = st[i]; j < st[i + 1] && ix[j] < i; j++) {
+        int k = ix[j];
+        v[j] /= v[diag[k]];
+        for (int t = diag[k] + 1; t < st[k + 1]; t++)
+          if (pos[ix[t]] >= 0) v[pos[ix[t]]] -= v[j] * v[t];
+      }
+      for (int j = st[i]; j < st[i + 1]; j++) pos[ix[j]] = -1;
+    }
+  }
+
+  void apply(const vd & r, vd & z) const {
+    const std::vector<int> & st = LU.start, & ix = LU.index;
+    const vd & v = LU.value;
+    int n = r.size();
+    z.resize(n);
+    for (int i = 0; i < n; i++) {
+      double s = r[i];
+      for (int j = st[i]; j < diag[i]; j++) s -= v[j] * z[ix[j]];
+      z[i] = s;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+      double s = z[i];
+      for (int j = diag[i] + 1; j < st[i + 1]; j++) s -= v[j] * z[ix[j]];
+      z[i] = s / v[diag[i]];
+    }
+  }
+};
+
+template<class Preconditioner>
+int conjugate_gradient(const csr_matrix & A, const vd & b, vd & x,
+                       const Preconditioner & M, double tol = 1e-10,
+                       int max_iter = 10000) {
+  int n = A.rows;
+  vd r(n), z(n), p(n), q(n);
+  x.resize(n, 0);
+  A.multiply(x, q);
+  for (int i = 0; i < n; i++) r[i] = b[i] - q[i];
+  double bnorm = norm(b), rz;
+  if (bnorm == 0) bnorm = 1;
+  if (norm(r) <= tol * bnorm) return 0;
+  M.apply(r, z);
+  p = z;
+  rz = dot(r, z);
+  for (int it = 1; it <= max_iter; it++) {
+    A.multiply(p, q);
+    double alpha = rz / dot(p, q);
+    for (int i = 0; i < n; i++) {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+    }
+    if (norm(r) <= tol * bnorm) return it;
+    M.apply(r, z);
+    double rz2 = dot(r, z), beta = rz2 / rz;
+    rz = rz2;
+    for (int i = 0; i < n; i++) p[i] = z[i] + beta * p[i];
+  }
+  return -1;
+}
+
+template<class Preconditioner>
+int bicgstab(const csr_matrix & A, const vd & b, vd & x,
+             const Preconditioner & M, double tol = 1e-10,
+             int max_iter = 10000) {
+  int n = A.rows;
+  vd r(n), r0, p(n, 0), v(n, 0), s(n), t(n), y(n), z(n);
+  x.resize(n, 0);
+  A.multiply(x, t);
+  for (int i = 0; i < n; i++) r[i] = b[i] - t[i];
+  r0 = r;
+  double bnorm = norm(b), rho = 1, alpha = 1, omega = 1;
+  if (bnorm == 0) bnorm = 1;
+  if (norm(r) <= tol * bnorm) return 0;
+  for (int it = 1; it <= max_iter; it++) {
+    double rho2 = dot(r0, r);
+    if (rho2 == 0 || omega == 0) return -1; //the method broke down
+    double beta = (rho2 / rho) * (alpha / omega);
+    rho = rho2;
+    for (int i = 0; i < n; i++) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    M.apply(p, y);
+    A.multiply(y, v);
+    alpha = rho / dot(r0, v);
+    for (int i = 0; i < n; i++) s[i] = r[i] - alpha * v[i];
+    if (norm(s) <= tol * bnorm) {
+      for (int i = 0; i < n; i++) x[i] += alpha * y[i];
+      return it;
+    }
+    M.apply(s, z);
+    A.multiply(z, t);
+    double tt = dot(t, t);
+    omega = (tt == 0) ? 0 : dot(t, s) / tt;
+    for (int i = 0; i < n; i++) {
+      x[i] += alpha * y[i] + omega * z[i];
+      r[i] = s[i] - omega * t[i];
+    }
+    if (norm(r) <= tol * bnorm) return it;
+  }
+  return -1;
+}
+
+//preconditioned on the right, so that the residual minimized is that of
+//the system itself; max_iter counts the total steps over all restarts
+template<class Preconditioner>
+int gmres(const csr_matrix & A, const vd & b, vd & x,
+          const Preconditioner & M, double tol = 1e-10,
+          int max_iter = 10000, int restart = 30) {
+  int n = A.rows, steps = 0;
+  std::vector<vd> V(restart + 1, vd(n)), H(restart + 1, vd(restart, 0));
+  vd cs(restart), sn(restart), g(restart + 1), w(n), z(n), y(restart);
+  x.resize(n, 0);
+  double bnorm = norm(b);
+  if (bnorm == 0) bnorm = 1;
+  while (true) {
+    A.multiply(x, w);
+    for (int i = 0; i < n; i++) V[0][i] = b[i] - w[i];
+    double beta = norm(V[0]);
+    if (beta <= tol * bnorm) return steps;
+    if (steps >= max_iter) return -1;
+    for (int i = 0; i < n; i++) V[0][i] /= beta;
+    std::fill(g.begin(), g.end(), 0.0);
+    g[0] = beta;
+    int k = 0;
+    for (; k < restart && steps < max_iter; k++) {
+      steps++;
+      M.apply(V[k], z);
+      A.multiply(z, w);
+      for (int j = 0; j <= k; j++) { //modified Gram-Schmidt
+        H[j][k] = dot(w, V[j]);
+        for (int i = 0; i < n; i++) w[i] -= H[j][k] * V[j][i];
+      }
+      H[k + 1][k] = norm(w);
+      if (H[k + 1][k] != 0)
+        for (int i = 0; i < n; i++) V[k + 1][i] = w[i] / H[k + 1][k];
+      for (int j = 0; j < k; j++) { //apply the previous rotations
+        double h = cs[j] * H[j][k] + sn[j] * H[j + 1][k];
+        H[j + 1][k] = -sn[j] * H[j][k] + cs[j] * H[j + 1][k];
+        H[j][k] = h;
+      }
+      double d = sqrt(H[k][k] * H[k][k] + H[k + 1][k] * H[k + 1][k]);
+      cs[k] = (d == 0) ? 1 : H[k][k] / d;
+      sn[k] = (d == 0) ? 0 : H[k + 1][k] / d;
+      H[k][k] = d;
+      H[k + 1][k] = 0;
+      g[k + 1] = -sn[k] * g[k];
+      g[k] *= cs[k];
+      if (fabs(g[k + 1]) <= tol * bnorm) {
+        k++;
+        break;
+      }
+    }
+    //solve the k by k triangular system H*y = g, and add M*V*y to x
+    for (int i = k - 1; i >= 0; i--) {
+      y[i] = g[i];
+      for (int j = i + 1; j < k; j++) y[i] -= H[i][j] * y[j];
+      y[i] = (H[i][i] == 0) ? 0 : y[i] / H[i][i];
+    }
+    std::fill(w.begin(), w.end(), 0.0);
+    for (int j = 0; j < k; j++)
+      for (int i = 0; i < n; i++) w[i] += y[j] * V[j][i];
+    M.apply(w, z);
+    for (int i = 0; i < n; i++) x[i] += z[i];
+  }
+}
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+double residual(const csr_matrix & A, const vd & b, const vd & x) {
+  vd y;
+  A.multiply(x, y);
+  for (int i = 0; i < (int)y.size(); i++) y[i] -= b[i];
+  return norm(y) / norm(b);
+}
+
+int main() {
+  //the 5-point Laplacian on a k by k grid (symmetric positive definite),
+  //plus a convection term c in x which makes it nonsymmetric if c != 0
+  int k = 60, n = k * k;
+  for (int c = 0; c <= 1; c++) {
+    vector<triplet> t;
+    for (int i = 0; i < k; i++)
+      for (int j = 0; j < k; j++) {
+        int u = i * k + j;
+        t.push_back(triplet(u, u, 4));
+        if (i > 0) t.push_back(triplet(u, u - k, -1));
+        if (i + 1 < k) t.push_back(triplet(u, u + k, -1));
+        if (j > 0) t.push_back(triplet(u, u - 1, -1 - 0.5 * c));
+        if (j + 1 < k) t.push_back(triplet(u, u + 1, -1 + 0.5 * c));
+      }
+    csr_matrix A(n, n, t);
+    assert(A.nonzeros() == 5 * n - 4 * k);
+    vd b(n, 1.0), x;
+    jacobi_preconditioner J(A);
+    ilu0_preconditioner L(A);
+    if (c == 0) {
+      int it1 = conjugate_gradient(A, b, x = vd(), identity_preconditioner());
+      assert(it1 > 0 && residual(A, b, x) < 1e-9);
+      int it2 = conjugate_gradient(A, b, x = vd(), L);
+      assert(it2 > 0 && it2 < it1 && residual(A, b, x) < 1e-9);
+      cout << "CG: " << it1 << " iterations, " << it2 << " with ILU(0)\n";
+    }
+    int it3 = bicgstab(A, b, x = vd(), J);
+    assert(it3 > 0 && residual(A, b, x) < 1e-9);
+    int it4 = gmres(A, b, x = vd(), L);
+    assert(it4 > 0 && residual(A, b, x) < 1e-9);
+    cout << "BiCGSTAB: " << it3 << ", GMRES(30) with ILU(0): " << it4 << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,754 @@
+/*
+
+Description: Minimize c^T*x over n variables subject to m constraints
+row_lo[i] <= A[i]*x <= row_hi[i] and bounds col_lo[j] <= x[j] <= col_hi[j],
+where any bound may be infinite (lp_inf) and A is sparse, given as a list
+of its nonzero entries (where duplicates are summed). To maximize, negate
+c. Unlike the dense tableau of section 4.5.5, the revised simplex method
+only keeps an LU factorization of the m by m basis matrix B, so that each
+iteration costs O(nnz(A)) for pricing plus a few sparse triangular solves,
+instead of O(mn) for updating a tableau.
+
+The problem is solved in the equivalent form [A | -I][x; s] = 0 with
+bounds on every variable, where the m logical variables s hold the rows
+A*x and take the row bounds, so that the basis of logicals B = -I is
+always a valid start. Nonbasic variables sit at one of their bounds (or
+at 0 if they are free), and basic variables B^-1 times the rest of the
+columns. The primal simplex first minimizes the sum of infeasibilities
+of the basic variables (phase 1), and then the objective (phase 2). Its
+ratio test is that of Harris, which among the nearly tied candidates
+picks the largest pivot, and it prices by Dantzig's rule (the largest
+reduced cost), by Devex reference weights (an approximation of steepest
+edge pricing), or by Bland's rule (the first eligible variable), where
+the former two fall back to Bland's rule after a run of degenerate
+pivots to avoid cycling.
+
+B is factored as a permutation of L*U by a right-looking sparse LU, which
+chooses each pivot by Markowitz's rule to limit the fill, among entries
+within a factor of 10 of the largest of their column for stability. Each
+change of the basis appends one eta column of the product form to the
+factorization, until it is redone every refactor_period changes.
+
+Warm starts: after changes to the costs, the bounds, or the row bounds,
+solve() continues from the last basis. If the basis remains primal
+feasible (as after changing the costs), the primal simplex continues in
+phase 2. If it is only dual feasible (as after changing the bounds), the
+dual simplex restores primal feasibility while keeping optimality, which
+usually takes few iterations for small changes. Its ratio test flips
+boxed variables to their other bound while the leaving variable remains
+infeasible, instead of pivoting them in one at a time. Otherwise, the
+primal simplex starts over in phase 1.
+
+Time Complexity: O(nnz(A) + nnz(L + U + etas)) per iteration; the number
+of iterations is usually between m and 3m from the slack basis, and
+much smaller when warm started. Each refactorization takes O(m^2 + flops)
+for the pivot searches and the elimination.
+
+Space Complexity: O(n + m + nnz(A) + nnz(L + U + etas)).
+
+*/
+
+#include <algorithm> /* std::max(), std::min(), std::sort() */
+#include <cmath>     /* fabs() */
+#include <utility>   /* std::make_pair(), std::pair */
+#include <vector>
+
+typedef std::vector<double> vd;
+
+const double lp_inf = 1e30;
+
+/*
+
+basis_factor holds B^-1 for a sparse m by m matrix B given by columns,
+as L*U (with the rows and columns of B permuted) followed by etas. The
+vectors of ftran() are indexed by rows on input and by positions of B
+on output, and those of btran() the other way around.
+
+*/
+
+class basis_factor {
+  int m;
+  //step k pivots on row prow[k] of column qpos[k] of B, with L column k
+  //(besides its unit diagonal) in [lstart[k], lstart[k + 1]) of
+  //lindex/lvalue, and U column k above its diagonal udiag[k] in
+  //[ustart[k], ustart[k + 1]) of ustep/uvalue
+  std::vector<int> prow, qpos, lstart, lindex, ustart, ustep;
+  vd lvalue, uvalue, udiag;
+  //eta j replaces position epos[j] with the column of epivot[j] there
+  //and the entries [estart[j], estart[j + 1]) of eindex/evalue elsewhere
+  std::vector<int> epos, estart, eindex;
+  vd epivot, evalue;
+  mutable vd tmp;
+
+ public:
+  basis_factor() : m(0) {}
+
+  int updates() const { return epos.size(); }
+
+  //B's column p is in [cs[p], cs[p + 1]) of ci/cv; false if B is singular
+  bool factor(int m, const std::vector<int> & cs, const std::vector<int> & ci,
+              const vd & cv) {
+    this->m = m;
+    prow.assign(m, -1);
+    qpos.assign(m, -1);
+    lstart.assign(1, 0);
+    lindex.clear(); lvalue.clear(); ustep.clear(); uvalue.clear();
+    udiag.assign(m, 0);
+    epos.clear(); estart.assign(1, 0); eindex.clear(); epivot.clear();
+    evalue.clear();
+    //the active submatrix by columns, and the columns of each row
+    std::vector<std::vector<int> > rows(m), cols_of(m);
+    std::vector<vd> vals(m);
+    std::vector<int> pos(m, -1), row_count(m, 0), active(m), apos(m);
+    std::vector<int> step_of(m, -1), ut, uc;
+    std::vector<char> row_done(m, false);
+    vd uv;
+    for (int p = 0; p < m; p++) {
+      for (int e = cs[p]; e < cs[p + 1]; e++) {
+        int i = ci[e];
+        if (pos[i] >= 0) {
+          vals[p][pos[i]] += cv[e];
+          continue;
+        }
+        pos[i] = rows[p].size();
+        rows[p].push_back(i);
+        vals[p].push_back(cv[e]);
+        cols_of[i].push_back(p);
+        row_count[i]++;
+      }
+      for (int e = 0; e < (int)rows[p].size(); e++) pos[rows[p][e]] = -1;
+      active[p] = apos[p] = p;
+    }
+    for (int k = 0; k < m; k++) {
+      int na = m - k, c1 = -1, c2 = -1, r1 = -1, r2 = -1;
+      for (int a = 0; a < na; a++) {
+        int c = active[a], s = rows[c].size();
+        if (s == 0) return false;
+        if (c1 < 0 || s < (int)rows[c1].size()) {
+          c2 = c1;
+          c1 = c;
+        } else if (c2 < 0 || s < (int)rows[c2].size()) {
+          c2 = c;
+        }
+      }
+      for (int i = 0; i < m; i++) {
+        if (row_done[i]) continue;
+        if (r1 < 0 || row_count[i] < row_count[r1]) {
+          r2 = r1;
+          r1 = i;
+        } else if (r2 < 0 || row_count[i] < row_count[r2]) {
+          r2 = i;
+        }
+      }
+      //Markowitz's rule: among the entries of the sparsest two columns and
+      //rows within a factor of 10 of the largest in their column, the one
+      //with the least (row count - 1) * (column count - 1)
+      int pr = -1, pc = -1;
+      double piv = 0;
+      long long best = 0;
+      int cand[4] = {c1, c2, -1, -1};
+      for (int t = 0; t < 2; t++) {
+        int i = (t == 0) ? r1 : r2;
+        if (i < 0) continue;
+        for (int e = 0; e < (int)cols_of[i].size(); e++) {
+          int c = cols_of[i][e];
+          if (step_of[c] < 0 && c != cand[0] && c != cand[1] &&
+              c != cand[2]) {
+            cand[2 + t] = c;
+            break;
+          }
+        }
+      }
+      for (int t = 0; t < 4; t++) {
+        int c = cand[t];
+        if (c < 0 || (t > 0 && c == cand[0]) || (t > 1 && c == cand[1]) ||
+            (t > 2 && c == cand[2]))
+          continue;
+        double big = 0;
+        for (int e = 0; e < (int)vals[c].size(); e++)
+          big = std::max(big, fabs(vals[c][e]));
+        for (int e = 0; e < (int)rows[c].size(); e++) {
+          double v = vals[c][e];
+          if (fabs(v) < 0.1 * big || fabs(v) < 1e-11) continue;
+          long long cost = (long long)(row_count[rows[c][e]] - 1) *
+                           ((int)rows[c].size() - 1);
+          if (pr < 0 || cost < best ||
+              (cost == best && fabs(v) > fabs(piv))) {
+            pr = rows[c][e];
+            pc = c;
+            piv = v;
+            best = cost;
+          }
+        }
+      }
+      if (pr < 0) return false;
+      int l0 = lindex.size();
+      for (int e = 0; e < (int)rows[pc].size(); e++) {
+        int i = rows[pc][e];
+        row_count[i]--;
+        if (i != pr) {
+          lindex.push_back(i);
+          lvalue.push_back(vals[pc][e] / piv);
+        }
+      }
+      lstart.push_back(lindex.size());
+      //subtracts the multiples of column pc from the other columns in row pr
+      for (int e = 0; e < (int)cols_of[pr].size(); e++) {
+        int j = cols_of[pr][e];
+        if (j == pc || step_of[j] >= 0) continue;
+        std::vector<int> & rj = rows[j];
+        vd & vj = vals[j];
+        for (int f = 0; f < (int)rj.size(); f++) pos[rj[f]] = f;
+        int f = pos[pr];
+        double a = vj[f];
+        ut.push_back(k);
+        uc.push_back(j);
+        uv.push_back(a);
+        pos[pr] = -1;
+        rj[f] = rj.back();
+        vj[f] = vj.back();
+        rj.pop_back();
+        vj.pop_back();
+        if (f < (int)rj.size()) pos[rj[f]] = f;
+        for (int g = l0; g < (int)lindex.size(); g++) {
+          int i = lindex[g];
+          if (pos[i] >= 0) {
+            vj[pos[i]] -= lvalue[g] * a;
+          } else {
+            rj.push_back(i);
+            vj.push_back(-lvalue[g] * a);
+            cols_of[i].push_back(j);
+            row_count[i]++;
+          }
+        }
+        for (int g = 0; g < (int)rj.size(); g++) pos[rj[g]] = -1;
+      }
+      udiag[k] = piv;
+      prow[k] = pr;
+      qpos[k] = pc;
+      step_of[pc] = k;
+      row_done[pr] = true;
+      int a = apos[pc], last = active[na - 1];
+      active[a] = last;
+      apos[last] = a;
+    }
+    //U was produced by rows, and is stored by the step of its columns
+    ustart.assign(m + 1, 0);
+    for (int e = 0; e < (int)ut.size(); e++) ustart[step_of[uc[e]] + 1]++;
+    for (int k = 0; k < m; k++) ustart[k + 1] += ustart[k];
+    ustep.resize(ut.size());
+    uvalue.resize(ut.size());
+    std::vector<int> fill(ustart.begin(), ustart.end() - 1);
+    for (int e = 0; e < (int)ut.size(); e++) {
+      int f = fill[step_of[uc[e]]]++;
+      ustep[f] = ut[e];
+      uvalue[f] = uv[e];
+    }
+    return true;
+  }
+
+  void ftran(vd & a) const {
+    tmp.resize(m);
+    for (int t = 0; t < m; t++) {
+      double v = a[prow[t]];
+      if (v != 0)
+        for (int e = lstart[t]; e < lstart[t + 1]; e++)
+          a[lindex[e]] -= lvalue[e] * v;
+      tmp[t] = v;
+    }
+    for (int k = m - 1; k >= 0; k--) {
+      double w = tmp[k] / udiag[k];
+      tmp[k] = w;
+      if (w != 0)
+        for (int e = ustart[k]; e < ustart[k + 1]; e++)
+          tmp[ustep[e]] -= uvalue[e] * w;
+    }
+    for (int k = 0; k < m; k++) a[qpos[k]] = tmp[k];
+    for (int j = 0; j < (int)epos.size(); j++) {
+      double w = a[epos[j]] / epivot[j];
+      a[epos[j]] = w;
+      if (w != 0)
+        for (int e = estart[j]; e < estart[j + 1]; e++)
+          a[eindex[e]] -= evalue[e] * w;
+    }
+  }
+
+  void btran(vd & a) const {
+    tmp.resize(m);
+    for (int j = (int)epos.size() - 1; j >= 0; j--) {
+      double s = a[epos[j]];
+      for (int e = estart[j]; e < estart[j + 1]; e++)
+        s -= evalue[e] * a[eindex[e]];
+      a[epos[j]] = s / epivot[j];
+    }
+    for (int k = 0; k < m; k++) {
+      double s = a[qpos[k]];
+      for (int e = ustart[k]; e < ustart[k + 1]; e++)
+        s -= uvalue[e] * tmp[ustep[e]];
+      tmp[k] = s / udiag[k];
+    }
+    for (int t = m - 1; t >= 0; t--) {
+      double s = tmp[t];
+      for (int e = lstart[t]; e < lstart[t + 1]; e++)
+        s -= lvalue[e] * a[lindex[e]];
+      a[prow[t]] = s;
+    }
+  }
+
+  //replaces position p of B by the column a, given d = B^-1 a by ftran()
+  void update(int p, const vd & d) {
+    epos.push_back(p);
+    epivot.push_back(d[p]);
+    for (int i = 0; i < m; i++)
+      if (i != p && d[i] != 0) {
+        eindex.push_back(i);
+        evalue.push_back(d[i]);
+      }
+    estart.push_back(eindex.size());
+  }
+};
+
+struct lp_entry {
+  int row, col;
+  double value;
+
+  lp_entry(int r, int c, double v): row(r), col(c), value(v) {}
+};
+
+class revised_simplex {
+ public:
+  enum status { optimal, infeasible, unbounded, iteration_limit };
+  enum pricing_rule { dantzig, devex, bland };
+
+ private:
+  static const int refactor_period = 64;
+  int m, n, iters;
+  std::vector<int> cstart, cindex; //A by columns
+  vd cvalue;
+  //variables 0..n-1 are the columns of A, and n..n+m-1 the logicals
+  vd cost, lo, hi, x, weight;
+  std::vector<int> head, where; //basic variable at each position, and back
+  std::vector<char> at_upper;
+  basis_factor lu;
+  pricing_rule rule;
+
+  //basic variables may violate their bounds by up to primal_tol(), and
+  //the ratio test relaxes the bounds by the smaller harris_tol()
+  double primal_tol() const { return 1e-7; }
+  double dual_tol() const { return 1e-9; }
+  double harris_tol() const { return 1e-9; }
+
+  void add_column(int j, double f, vd & a) const {
+    if (j >= n) {
+      a[j - n] -= f;
+      return;
+    }
+    for (int e = cstart[j]; e < cstart[j + 1]; e++)
+      a[cindex[e]] += f * cvalue[e];
+  }
+
+  double dot_column(int j, const vd & y) const {
+    if (j >= n) return -y[j - n];
+    double s = 0;
+    for (int e = cstart[j]; e < cstart[j + 1]; e++)
+      s += cvalue[e] * y[cindex[e]];
+    return s;
+  }
+
+  bool is_free(int j) const { return lo[j] <= -lp_inf && hi[j] >= lp_inf; }
+
+  //moves the nonbasic variables to their bounds, in case these changed
+  void snap() {
+    for (int j = 0; j < n + m; j++) {
+      if (where[j] >= 0) continue;
+      if (at_upper[j] && hi[j] < lp_inf) {
+        x[j] = hi[j];
+      } else if (lo[j] > -lp_inf) {
+        x[j] = lo[j];
+        at_upper[j] = false;
+      } else if (hi[j] < lp_inf) {
+        x[j] = hi[j];
+        at_upper[j] = true;
+      } else {
+        x[j] = 0;
+      }
+    }
+  }
+
+  //refactors B, falling back to the slack basis if B became singular,
+  //and recomputes the basic variables x_B = -B^-1 * N * x_N
+  void refactor() {
+    std::vector<int> cs(1, 0), ci;
+    vd cv;
+    for (int p = 0; p < m; p++) {
+      int j = head[p];
+      if (j >= n) {
+        ci.push_back(j - n);
+        cv.push_back(-1);
+      } else {
+        for (int e = cstart[j]; e < cstart[j + 1]; e++) {
+          ci.push_back(cindex[e]);
+          cv.push_back(cvalue[e]);
+        }
+      }
+      cs.push_back(ci.size());
+    }
+    if (!lu.factor(m, cs, ci, cv)) {
+      for (int p = 0; p < m; p++) where[head[p]] = -1;
+      for (int i = 0; i < m; i++) {
+        head[i] = n + i;
+        where[n + i] = i;
+      }
+      snap();
+      refactor();
+      return;
+    }
+    vd r(m, 0);
+    for (int j = 0; j < n + m; j++)
+      if (where[j] < 0 && x[j] != 0) add_column(j, -x[j], r);
+    lu.ftran(r);
+    for (int p = 0; p < m; p++) x[head[p]] = r[p];
+  }
+
+  //makes q basic at position r, given alpha = B^-1 * a_q
+  void pivot(int q, int r, const vd & alpha) {
+    int k = head[r];
+    if (rule == devex) {
+      vd rho(m, 0);
+      rho[r] = 1;
+      lu.btran(rho);
+      double wq = weight[q], ar = alpha[r];
+      for (int j = 0; j < n + m; j++)
+        if (where[j] < 0 && j != q) {
+          double a = dot_column(j, rho) / ar;
+          weight[j] = std::max(weight[j], a * a * wq);
+        }
+      weight[k] = std::max(wq / (ar * ar), 1.0);
+    }
+    where[k] = -1;
+    where[q] = r;
+    head[r] = q;
+    lu.update(r, alpha);
+    if (lu.updates() >= refactor_period) refactor();
+    iters++;
+  }
+
+  //the basic costs for phase 2, or for phase 1 if the basis is infeasible
+  bool basic_costs(vd & cb) const {
+    bool feasible = true;
+    for (int p = 0; p < m; p++) {
+      int k = head[p];
+      cb[p] = (x[k] < lo[k] - primal_tol()) ? -1
+              : (x[k] > hi[k] + primal_tol()) ? 1 : 0;
+      if (cb[p] != 0) feasible = false;
+    }
+    if (feasible)
+      for (int p = 0; p < m; p++) cb[p] = cost[head[p]];
+    return feasible;
+  }
+
+  //returns an entering variable for the duals y, or -1 if there is none
+  int price(bool phase2, const vd & y, bool first, double & dq) const {
+    int q = -1;
+    double best = 0;
+    for (int j = 0; j < n + m; j++) {
+      if (where[j] >= 0 || lo[j] == hi[j]) continue;
+      double d = (phase2 ? cost[j] : 0) - dot_column(j, y);
+      if (is_free(j) ? fabs(d) <= dual_tol()
+                     : at_upper[j] ? d <= dual_tol() : d >= -dual_tol())
+        continue;
+      double score = (rule == devex && !first) ? d * d / weight[j] : d * d;
+      if (q < 0 || score > best) {
+        q = j;
+        best = score;
+        dq = d;
+        if (first) break;
+      }
+    }
+    return q;
+  }
+
+  status primal(int max_iter) {
+    vd cb(m), y(m), alpha(m);
+    int degenerate = 0;
+    while (true) {
+      if (iters >= max_iter) return iteration_limit;
+      bool phase2 = basic_costs(cb);
+      y = cb;
+      lu.btran(y);
+      double dq = 0;
+      int q = price(phase2, y, rule == bland || degenerate > 50, dq);
+      if (q < 0) return phase2 ? optimal : infeasible;
+      double sigma = (dq < 0) ? 1 : -1;
+      std::fill(alpha.begin(), alpha.end(), 0.0);
+      add_column(q, 1, alpha);
+      lu.ftran(alpha);
+      //Harris' ratio test: bound the step with relaxed bounds, then take
+      //the largest pivot among the rows which block within that bound
+      double range = (hi[q] < lp_inf && lo[q] > -lp_inf) ? hi[q] - lo[q]
+                                                         : lp_inf;
+      double theta_max = range;
+      for (int pass = 0, r = -1; pass < 2; pass++) {
+        double theta = lp_inf, best = 0, target = 0;
+        for (int p = 0; p < m; p++) {
+          double rate = -sigma * alpha[p];
+          if (fabs(rate) < 1e-9) continue;
+          int k = head[p];
+          double b;
+          if (rate < 0) {
+            if (!phase2 && x[k] > hi[k] + primal_tol()) b = hi[k];
+            else if (x[k] >= lo[k] - primal_tol() && lo[k] > -lp_inf) b = lo[k];
+            else continue;
+          } else {
+            if (!phase2 && x[k] < lo[k] - primal_tol()) b = lo[k];
+            else if (x[k] <= hi[k] + primal_tol() && hi[k] < lp_inf) b = hi[k];
+            else continue;
+          }
+          double ratio = (b - x[k]) / rate;
+          if (pass == 0) {
+            theta_max = std::min(theta_max, ratio + harris_tol() / fabs(rate));
+          } else if (ratio <= theta_max && fabs(rate) > best) {
+            best = fabs(rate);
+            r = p;
+            theta = std::max(ratio, 0.0);
+            target = b;
+          }
+        }
+        if (pass == 0) {
+          if (theta_max >= lp_inf) return phase2 ? unbounded : infeasible;
+          continue;
+        }
+        bool flip = (r < 0 || range <= theta);
+        if (flip) theta = range;
+        degenerate = (theta < 1e-12) ? degenerate + 1 : 0;
+        for (int p = 0; p < m; p++)
+          x[head[p]] -= theta * sigma * alpha[p];
+        if (flip) {
+          at_upper[q] = (sigma > 0);
+          x[q] = (sigma > 0) ? hi[q] : lo[q];
+          iters++;
+        } else {
+          int k = head[r];
+          x[q] += sigma * theta;
+          x[k] = target;
+          at_upper[k] = (target == hi[k] && lo[k] != hi[k]);
+          pivot(q, r, alpha);
+        }
+      }
+    }
+  }
+
+  status dual(int max_iter) {
+    vd cb(m), y(m), rho(m), alpha(m), arow(n + m);
+    while (true) {
+      if (iters >= max_iter) return iteration_limit;
+      int r = -1;
+      double worst = primal_tol();
+      for (int p = 0; p < m; p++) {
+        int k = head[p];
+        double v = std::max(lo[k] - x[k], x[k] - hi[k]);
+        if (v > worst) {
+          worst = v;
+          r = p;
+        }
+      }
+      if (r < 0) return optimal;
+      int k = head[r];
+      double target = (x[k] < lo[k]) ? lo[k] : hi[k];
+      double delta = (x[k] < lo[k]) ? 1 : -1;
+      for (int p = 0; p < m; p++) cb[p] = cost[head[p]];
+      y = cb;
+      lu.btran(y);
+      std::fill(rho.begin(), rho.end(), 0.0);
+      rho[r] = 1;
+      lu.btran(rho);
+      //x_k changes by -a * dx_j, so the entering j must move it by delta
+      std::vector<std::pair<double, int> > cand;
+      for (int j = 0; j < n + m; j++) {
+        if (where[j] >= 0 || lo[j] == hi[j]) continue;
+        double a = dot_column(j, rho);
+        if (fabs(a) < 1e-9) continue;
+        bool up = is_free(j) ? (a * delta < 0) : !at_upper[j];
+        if ((up && a * delta >= 0) || (!up && a * delta <= 0)) continue;
+        double d = cost[j] - dot_column(j, y);
+        arow[j] = a;
+        cand.push_back(std::make_pair(
+            (up ? std::max(d, 0.0) : std::max(-d, 0.0)) / fabs(a), j));
+      }
+      //the bound flipping ratio test: passing the breakpoint of a boxed
+      //candidate flips it to its other bound, which is worth it while the
+      //infeasibility of x_k still exceeds what the flips have reduced
+      std::sort(cand.begin(), cand.end());
+      double slope = std::max(lo[k] - x[k], x[k] - hi[k]);
+      int c = 0;
+      for (; c < (int)cand.size(); c++) {
+        int j = cand[c].second;
+        if (hi[j] >= lp_inf || lo[j] <= -lp_inf) break;
+        slope -= fabs(arow[j]) * (hi[j] - lo[j]);
+        if (slope <= primal_tol()) break;
+      }
+      if (c == (int)cand.size()) return infeasible;
+      //among the candidates tied with the breakpoint, the largest pivot
+      int q = cand[c].second;
+      for (int e = c + 1; e < (int)cand.size() &&
+                          cand[e].first <= cand[c].first + 1e-9; e++)
+        if (fabs(arow[cand[e].second]) > fabs(arow[q])) q = cand[e].second;
+      std::fill(alpha.begin(), alpha.end(), 0.0);
+      bool flips = false;
+      for (int e = 0; e < c; e++) {
+        int j = cand[e].second;
+        double dj = at_upper[j] ? lo[j] - hi[j] : hi[j] - lo[j];
+        x[j] += dj;
+        at_upper[j] = !at_upper[j];
+        add_column(j, dj, alpha);
+        flips = true;
+      }
+      if (flips) {
+        lu.ftran(alpha);
+        for (int p = 0; p < m; p++) x[head[p]] -= alpha[p];
+        std::fill(alpha.begin(), alpha.end(), 0.0);
+      }
+      add_column(q, 1, alpha);
+      lu.ftran(alpha);
+      double dx = (x[k] - target) / alpha[r];
+      for (int p = 0; p < m; p++) x[head[p]] -= dx * alpha[p];
+      x[q] += dx;
+      x[k] = target;
+      at_upper[k] = (target == hi[k] && lo[k] != hi[k]);
+      pivot(q, r, alpha);
+    }
+  }
+
+  bool dual_feasible() {
+    vd cb(m), y(m);
+    for (int p = 0; p < m; p++) cb[p] = cost[head[p]];
+    y = cb;
+    lu.btran(y);
+    double dq;
+    return price(true, y, true, dq) < 0;
+  }
+
+ public:
+  //the variables default to 0 <= x[j] < lp_inf, and the rows to be free
+  revised_simplex(int m, int n, const std::vector<lp_entry> & A,
+                  pricing_rule rule = devex)
+      : m(m), n(n), iters(0), cstart(n + 1, 0), cost(n + m, 0),
+        lo(n + m, 0), hi(n + m, lp_inf), x(n + m, 0), weight(n + m, 1),
+        head(m), where(n + m, -1), at_upper(n + m, false), rule(rule) {
+    for (int e = 0; e < (int)A.size(); e++) cstart[A[e].col + 1]++;
+    for (int j = 0; j < n; j++) cstart[j + 1] += cstart[j];
+    cindex.resize(A.size());
+    cvalue.resize(A.size());
+    std::vector<int> fill(cstart.begin(), cstart.end() - 1);
+    for (int e = 0; e < (int)A.size(); e++) {
+      cindex[fill[A[e].col]] = A[e].row;
+      cvalue[fill[A[e].col]++] = A[e].value;
+    }
+    for (int i = 0; i < m; i++) {
+      lo[n + i] = -lp_inf;
+      head[i] = n + i;
+      where[n + i] = i;
+    }
+    refactor();
+  }
+
+  void set_cost(int j, double c) { cost[j] = c; }
+
+  void set_bounds(int j, double l, double h) {
+    lo[j] = l;
+    hi[j] = h;
+  }
+
+  void set_row_bounds(int i, double l, double h) {
+    lo[n + i] = l;
+    hi[n + i] = h;
+  }
+
+  status solve(int max_iter = 1000000) {
+    snap();
+    refactor();
+    max_iter += iters;
+    vd cb(m);
+    if (!basic_costs(cb) && dual_feasible()) {
+      status s = dual(max_iter);
+      if (s != optimal) return s;
+    }
+    return primal(max_iter);
+  }
+
+  int iterations() const { return iters; }
+  double value(int j) const { return x[j]; }
+  double row_value(int i) const { return x[n + i]; }
+
+  double objective() const {
+    double s = 0;
+    for (int j = 0; j < n; j++) s += cost[j] * x[j];
+    return s;
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+
+int main() {
+  /*
+    Maximize 3x + 4y + 5, subject to x, y >= 0 and:
+        -2x +    1y <=  0
+         1x + 0.85y <=  9
+         1x +    2y <= 14
+    The solution is 38.3043 at (5.30435, 4.34783).
+  */
+  vector<lp_entry> A;
+  double a[3][2] = {{-2, 1}, {1, 0.85}, {1, 2}}, b[3] = {0, 9, 14};
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 2; j++) A.push_back(lp_entry(i, j, a[i][j]));
+  revised_simplex lp(3, 2, A);
+  lp.set_cost(0, -3);
+  lp.set_cost(1, -4);
+  for (int i = 0; i < 3; i++) lp.set_row_bounds(i, -lp_inf, b[i]);
+  assert(lp.solve() == revised_simplex::optimal);
+  cout << "Solution = " << 5 - lp.objective() << " at (" << lp.value(0)
+       << ", " << lp.value(1) << ").\n";
+
+  //warm restarts: a tighter row is fixed by the dual simplex, and a new
+  //objective is optimized by the primal simplex from the last basis
+  lp.set_row_bounds(2, -lp_inf, 10);
+  assert(lp.solve() == revised_simplex::optimal);
+  assert(fabs(lp.objective() + 650.0 / 23) < 1e-9);
+  assert(fabs(lp.value(0) - 190.0 / 23) < 1e-9);
+  lp.set_cost(1, -10);
+  assert(lp.solve() == revised_simplex::optimal);
+  assert(fabs(lp.value(0) - 2) < 1e-9 && fabs(lp.value(1) - 4) < 1e-9);
+  lp.set_bounds(0, 3, 3); //now x = 3 is fixed, which leaves y <= 3.5
+  assert(lp.solve() == revised_simplex::optimal);
+  assert(fabs(lp.value(1) - 3.5) < 1e-9);
+  lp.set_row_bounds(0, 1, lp_inf); //-2x + y >= 1 contradicts y <= 3.5
+  assert(lp.solve() == revised_simplex::infeasible);
+
+  //x + y + z >= 0.8 with x <= 0.1, y <= 0.3 and z <= 0.4 holds only at
+  //the upper bounds, where the ratio test of the warm started dual simplex
+  //is left with a slope of 0.8 - 0.1 - 0.3 - 0.4 = 5.6e-17 by roundoff,
+  //and must agree with the primal simplex of a cold start
+  double ub[4] = {0.1, 0.3, 0.4, 11}, c[4] = {10, 20, 30, -1};
+  vector<lp_entry> B;
+  for (int j = 0; j < 3; j++) B.push_back(lp_entry(0, j, 1));
+  revised_simplex warm(1, 4, B), cold(1, 4, B);
+  for (int j = 0; j < 4; j++) {
+    warm.set_cost(j, c[j]);
+    warm.set_bounds(j, 0, ub[j]);
+    cold.set_cost(j, c[j]);
+    cold.set_bounds(j, 0, ub[j]);
+  }
+  assert(warm.solve() == revised_simplex::optimal);
+  warm.set_row_bounds(0, 0.8, lp_inf);
+  cold.set_row_bounds(0, 0.8, lp_inf);
+  assert(cold.solve() == revised_simplex::optimal);
+  assert(warm.solve() == revised_simplex::optimal);
+  assert(fabs(cold.objective() - 8) < 1e-9);
+  assert(fabs(warm.objective() - 8) < 1e-9);
+  return 0;
+}
@@ -9,8 +9,11 @@ regardless of what initial guess is chosen.
 
 */
 
+#include <algorithm> /* std::fill(), std::min() */
+#include <cmath>     /* acosl(), cos(), pow(), powl(), sin(), sqrt() */
 #include <complex>
-#include <cstdlib> /* rand(), RAND_MAX */
+#include <cstdlib>   /* rand(), RAND_MAX */
+#include <limits>    /* std::numeric_limits */
 #include <vector>
 
 typedef long double Double;
@@ -75,8 +78,194 @@ std::vector<cdouble> find_all_roots(const poly & p) {
   return res;
 }
 
+/*
+
+aberth_roots(p) finds all roots of p at once by the Aberth-Ehrlich
+iteration, which moves each approximation z[i] by the Newton correction
+N = p(z[i])/p'(z[i]) of p divided by the product of (x - z[j]) over all
+j != i, that is by w[i] = N/(1 - N*S[i]) for S[i] the sum of 1/(z[i] -
+z[j]). The roots repel each other, so that there is no deflation, and
+the convergence is cubic for simple roots (linear for multiple roots).
+The approximations start on a circle with the geometric mean of the
+root moduli as its radius, and every correction w[i] is computed from
+the previous approximations before any is applied, so that all roots
+are updated independently of each other. Each root stops moving once
+its correction falls below the rounding error of the root, or once p at
+the root is within the rounding error of evaluating it (as bounded with
+the sum of |p[k]|*|z[i]|^k), and the others continue until all of them
+have converged, or for at most max_iter iterations.
+
+aberth_roots_batch(c, n, roots) solves count = c.size()/(n + 1) such
+polynomials of one degree n in double precision, with coefficient k of
+polynomial t in c[t*(n + 1) + k], and stores its roots in roots[t*n..].
+The polynomials are processed 8 at a time in lockstep, with the arrays
+of coefficients and roots laid out by lane, so that every inner loop
+runs over 8 independent lanes and the compiler can vectorize it. The
+converged roots of each lane are masked out of the updates of its
+block, which continues until every lane has converged.
+
+Time Complexity: O(n^2) per iteration of aberth_roots(), which usually
+takes few iterations beyond O(log n) to approach the roots, and the same
+per polynomial for aberth_roots_batch().
+
+*/
+
+const Double PI = acosl(-1.0L);
+
+std::vector<cdouble> aberth_roots(const poly & p, int max_iter = 1000) {
+  poly q(p);
+  while (q.size() > 1 && q.back() == cdouble(0)) q.pop_back();
+  std::vector<cdouble> res;
+  int zeros = 0;
+  while (zeros + 1 < (int)q.size() && q[zeros] == cdouble(0)) zeros++;
+  res.assign(zeros, cdouble(0));
+  q.erase(q.begin(), q.begin() + zeros);
+  int n = q.size() - 1;
+  if (n <= 0) return res;
+  Double r = powl(std::abs(q[0] / q[n]), 1.0L / n);
+  const Double tol = std::numeric_limits<Double>::epsilon();
+  std::vector<cdouble> z(n), w(n);
+  std::vector<Double> qa(n + 1);
+  for (int k = 0; k <= n; k++) qa[k] = std::abs(q[k]);
+  std::vector<char> done(n, false), stop(n, false);
+  for (int i = 0; i < n; i++) z[i] = std::polar(r, 2 * PI * i / n + 0.4);
+  for (int it = 0, active = n; it < max_iter && active > 0; it++) {
+    for (int i = 0; i < n; i++) {
+      if (done[i]) continue;
+      cdouble f = q[n], d = 0, s = 0;
+      Double x = std::abs(z[i]), bound = qa[n];
+      for (int k = n - 1; k >= 0; k--) {
+        d = d * z[i] + f;
+        f = f * z[i] + q[k];
+        bound = bound * x + qa[k];
+      }
+      for (int j = 0; j < n; j++)
+        if (j != i) s += Double(1) / (z[i] - z[j]);
+      w[i] = (f == cdouble(0)) ? cdouble(0) : f / (d - f * s);
+      //p(z[i]) is within the rounding error of its evaluation
+      if (std::abs(f) <= 4 * n * tol * bound) stop[i] = true;
+    }
+    for (int i = 0; i < n; i++) {
+      if (done[i]) continue;
+      z[i] -= w[i];
+      if (stop[i] || std::abs(w[i]) <= tol * std::abs(z[i])) {
+        done[i] = true;
+        active--;
+      }
+    }
+  }
+  res.insert(res.end(), z.begin(), z.end());
+  return res;
+}
+
+typedef std::complex<double> cd;
+
+void aberth_roots_batch(const std::vector<cd> & c, int n,
+                        std::vector<cd> & roots, int max_iter = 1000) {
+  const int L = 8;
+  int count = c.size() / (n + 1);
+  roots.assign((size_t)count * n, cd(0));
+  if (n <= 0) return;
+  std::vector<double> ar((n + 1) * L), ai((n + 1) * L), zr(n * L), zi(n * L);
+  std::vector<double> am((n + 1) * L), wr(n * L), wi(n * L), live(n * L);
+  std::vector<double> sr(n * L), si(n * L), stop(n * L);
+  const double tol = 4 * n * std::numeric_limits<double>::epsilon();
+  for (int t0 = 0; t0 < count; t0 += L) {
+    //the coefficients of lane l divided by the leading one, with the
+    //lanes past the end repeating the last polynomial
+    for (int l = 0; l < L; l++) {
+      int t = std::min(t0 + l, count - 1);
+      cd lead = c[(size_t)t * (n + 1) + n];
+      for (int k = 0; k <= n; k++) {
+        cd a = c[(size_t)t * (n + 1) + k] / lead;
+        ar[k * L + l] = a.real();
+        ai[k * L + l] = a.imag();
+        am[k * L + l] = std::abs(a);
+      }
+      double r = pow(std::abs(cd(ar[l], ai[l])), 1.0 / n);
+      if (r == 0 || r != r) r = 1;
+      for (int i = 0; i < n; i++) {
+        double angle = 2 * PI * i / n + 0.4;
+        zr[i * L + l] = r * cos(angle);
+        zi[i * L + l] = r * sin(angle);
+        live[i * L + l] = 1;
+      }
+    }
+    for (int it = 0, active = n * L; it < max_iter && active > 0; it++) {
+      //s[i] = sum of 1/(z[i] - z[j]), one division for each pair
+      std::fill(sr.begin(), sr.end(), 0.0);
+      std::fill(si.begin(), si.end(), 0.0);
+      for (int i = 0; i < n; i++)
+        for (int j = i + 1; j < n; j++) {
+          const double * x = &zr[i * L], * y = &zi[i * L];
+          const double * u = &zr[j * L], * v = &zi[j * L];
+          double * s1r = &sr[i * L], * s1i = &si[i * L];
+          double * s2r = &sr[j * L], * s2i = &si[j * L];
+          for (int l = 0; l < L; l++) {
+            double ex = x[l] - u[l], ey = y[l] - v[l];
+            double q = ex * ex + ey * ey;
+            q = (q > 0) ? 1 / q : 0;
+            s1r[l] += ex * q;
+            s1i[l] -= ey * q;
+            s2r[l] -= ex * q;
+            s2i[l] += ey * q;
+          }
+        }
+      for (int i = 0; i < n; i++) {
+        double fr[L], fi[L], dr[L], di[L], b[L], m[L];
+        const double * x = &zr[i * L], * y = &zi[i * L];
+        for (int l = 0; l < L; l++) {
+          fr[l] = b[l] = 1;
+          fi[l] = dr[l] = di[l] = 0;
+          m[l] = sqrt(x[l] * x[l] + y[l] * y[l]);
+        }
+        for (int k = n - 1; k >= 0; k--) {
+          const double * br = &ar[k * L], * bi = &ai[k * L];
+          const double * bm = &am[k * L];
+          for (int l = 0; l < L; l++) {
+            double tr = dr[l] * x[l] - di[l] * y[l] + fr[l];
+            double ti = dr[l] * y[l] + di[l] * x[l] + fi[l];
+            dr[l] = tr;
+            di[l] = ti;
+            tr = fr[l] * x[l] - fi[l] * y[l] + br[l];
+            ti = fr[l] * y[l] + fi[l] * x[l] + bi[l];
+            fr[l] = tr;
+            fi[l] = ti;
+            b[l] = b[l] * m[l] + bm[l];
+          }
+        }
+        //w = f / (d - f*s), or 0 where the root has converged, and the
+        //root stops once f is within the rounding error bound tol*b
+        const double * s1r = &sr[i * L], * s1i = &si[i * L];
+        for (int l = 0; l < L; l++) {
+          double er = dr[l] - (fr[l] * s1r[l] - fi[l] * s1i[l]);
+          double ei = di[l] - (fr[l] * s1i[l] + fi[l] * s1r[l]);
+          double q = er * er + ei * ei, bt = tol * b[l];
+          q = (q > 0) ? live[i * L + l] / q : 0;
+          wr[i * L + l] = (fr[l] * er + fi[l] * ei) * q;
+          wi[i * L + l] = (fi[l] * er - fr[l] * ei) * q;
+          stop[i * L + l] = (fr[l] * fr[l] + fi[l] * fi[l] <= bt * bt);
+        }
+      }
+      active = 0;
+      for (int e = 0; e < n * L; e++) {
+        zr[e] -= wr[e];
+        zi[e] -= wi[e];
+        double w2 = wr[e] * wr[e] + wi[e] * wi[e];
+        double z2 = zr[e] * zr[e] + zi[e] * zi[e];
+        if (w2 <= 1e-30 * z2 || stop[e] != 0) live[e] = 0;
+        active += (live[e] != 0);
+      }
+    }
+    for (int l = 0; l < L && t0 + l < count; l++)
+      for (int i = 0; i < n; i++)
+        roots[(size_t)(t0 + l) * n + i] = cd(zr[i * L + l], zi[i * L + l]);
+  }
+}
+
 /*** Example Usage ***/
 
+#include <cassert>
 #include <cstdio>
 #include <iostream>
 using namespace std;
@@ -98,6 +287,8 @@ int main() {
     p.push_back(1);
     vector<cdouble> roots = find_all_roots(p);
     print_roots(roots);
+    printf("Simultaneously, by Aberth's method:\n");
+    print_roots(aberth_roots(p));
   }
 
   { //(-6+4i)x^4 + (-26+12i)x^3 + (-30+40i)x^2 + (-26+12i)x + (-24+36i)
@@ -111,6 +302,32 @@ int main() {
     p.push_back(cdouble(-6, 4));
     vector<cdouble> roots = find_all_roots(p);
     print_roots(roots);
+    printf("Simultaneously, by Aberth's method:\n");
+    print_roots(aberth_roots(p));
+  }
+
+  { //a batch of 1000 polynomials of degree 6 with random roots
+    const int count = 1000, n = 6;
+    vector<cd> c, all_roots, roots;
+    for (int t = 0; t < count; t++) {
+      vector<cd> a(1, cd(1));
+      for (int i = 0; i < n; i++) {
+        cd r(rand() % 2001 / 100.0 - 10, rand() % 2001 / 100.0 - 10);
+        all_roots.push_back(r);
+        a.push_back(0);
+        for (int k = i + 1; k > 0; k--) a[k] = a[k - 1] - r * a[k];
+        a[0] = -r * a[0];
+      }
+      c.insert(c.end(), a.begin(), a.end());
+    }
+    aberth_roots_batch(c, n, roots);
+    for (int t = 0; t < count; t++)
+      for (int i = 0; i < n; i++) { //each true root is close to a found one
+        double best = 1e9;
+        for (int j = 0; j < n; j++)
+          best = std::min(best, abs(roots[t * n + j] - all_roots[t * n + i]));
+        assert(best < 1e-6);
+      }
   }
   return 0;
 }
@@ -13,14 +13,26 @@ from FORTRAN to C++, with a simple wrapper at the end for the C++
 extremely efficient and robust, capable of achieving an accuracy
 of at least 5 decimal places for even the most strenuous inputs.
 
+The stages are templated on the floating point type T. rpoly<double>
+runs on SSE2 doubles, as TOMS493 did, and is several times faster than
+rpoly<long double>, which uses x87 arithmetic on x86 but gains 11 bits
+of precision. An rpoly object keeps its work arrays between calls to
+solve(), so solving many polynomials with one object allocates only
+once, and solve_batch() solves an array of polynomials of the same
+degree stored one after another. Objects share no state, so a batch
+may also be split into ranges, each solved by its own rpoly object.
+find_roots() is the original long double interface.
+
 */
 
-#include <cfloat> /* LDBL_EPSILON, LDBL_MAX, LDBL_MIN */
-#include <cmath>  /* cosl, expl, fabsl, logl, powl, sinl, sqrtl */
+#include <cmath>  /* std::cos(), std::exp(), std::fabs(), std::log(), ... */
+#include <limits> /* std::numeric_limits */
+#include <vector>
 
 typedef long double LD;
 
-void divide_quadratic(int n, LD u, LD v, LD p[], LD q[], LD * a, LD * b) {
+template<class T>
+void divide_quadratic(int n, T u, T v, T p[], T q[], T * a, T * b) {
   q[0] = *b = p[0];
   q[1] = *a = -((*b) * u) + p[1];
   for (int i = 2; i < n; i++) {
@@ -30,14 +42,16 @@ void divide_quadratic(int n, LD u, LD v, LD p[], LD q[], LD * a, LD * b) {
   }
 }
 
-int get_flag(int n, LD a, LD b, LD * a1, LD * a3, LD * a7,
-             LD * c, LD * d, LD * e, LD * f, LD * g, LD * h,
-             LD k[], LD u, LD v, LD qk[]) {
+template<class T>
+int get_flag(int n, T a, T b, T * a1, T * a3, T * a7,
+             T * c, T * d, T * e, T * f, T * g, T * h,
+             T k[], T u, T v, T qk[]) {
+  const T eps = std::numeric_limits<T>::epsilon();
   divide_quadratic(n, u, v, k, qk, c, d);
-  if (fabsl(*c) <= 100.0 * LDBL_EPSILON * fabsl(k[n - 1]) &&
-      fabsl(*d) <= 100.0 * LDBL_EPSILON * fabsl(k[n - 2])) return 3;
+  if (std::fabs(*c) <= 100.0 * eps * std::fabs(k[n - 1]) &&
+      std::fabs(*d) <= 100.0 * eps * std::fabs(k[n - 2])) return 3;
   *h = v * b;
-  if (fabsl(*d) >= fabsl(*c)) {
+  if (std::fabs(*d) >= std::fabs(*c)) {
     *e = a / (*d);
     *f = (*c) / (*d);
     *g = u * b;
@@ -55,14 +69,16 @@ int get_flag(int n, LD a, LD b, LD * a1, LD * a3, LD * a7,
   return 1;
 }
 
-void find_polynomials(int n, int flag, LD a, LD b, LD a1, LD * a3,
-                      LD * a7, LD k[], LD qk[], LD qp[]) {
+template<class T>
+void find_polynomials(int n, int flag, T a, T b, T a1, T * a3,
+                      T * a7, T k[], T qk[], T qp[]) {
+  const T eps = std::numeric_limits<T>::epsilon();
   if (flag == 3) {
     k[1] = k[0] = 0.0;
     for (int i = 2; i < n; i++) k[i] = qk[i - 2];
     return;
   }
-  if (fabsl(a1) > 10.0 * LDBL_EPSILON * fabsl(flag == 1 ? b : a)) {
+  if (std::fabs(a1) > 10.0 * eps * std::fabs(flag == 1 ? b : a)) {
     *a7 /= a1;
     *a3 /= a1;
     k[0] = qp[0];
@@ -77,10 +93,11 @@ void find_polynomials(int n, int flag, LD a, LD b, LD a1, LD * a3,
   }
 }
 
-void estimate_coeff(int flag, LD * uu, LD * vv, LD a, LD a1, LD a3, LD a7,
-                    LD b, LD c, LD d, LD f, LD g, LD h, LD u, LD v, LD k[],
-                    int n, LD p[]) {
-  LD a4, a5, b1, b2, c1, c2, c3, c4, temp;
+template<class T>
+void estimate_coeff(int flag, T * uu, T * vv, T a, T a1, T a3, T a7,
+                    T b, T c, T d, T f, T g, T h, T u, T v, T k[],
+                    int n, T p[]) {
+  T a4, a5, b1, b2, c1, c2, c3, c4, temp;
   *vv = *uu = 0.0;
   if (flag == 3) return;
   if (flag != 2) {
@@ -103,8 +120,9 @@ void estimate_coeff(int flag, LD * uu, LD * vv, LD a, LD a1, LD a3, LD a7,
   }
 }
 
-void solve_quadratic(LD a, LD b1, LD c, LD * sr, LD * si, LD * lr, LD * li) {
-  LD b, d, e;
+template<class T>
+void solve_quadratic(T a, T b1, T c, T * sr, T * si, T * lr, T * li) {
+  T b, d, e;
   *sr = *si = *lr = *li = 0.0;
   if (a == 0) {
     *sr = (b1 != 0) ? -c / b1 : *sr;
@@ -115,13 +133,13 @@ void solve_quadratic(LD a, LD b1, LD c, LD * sr, LD * si, LD * lr, LD * li) {
     return;
   }
   b = b1 / 2.0;
-  if (fabsl(b) < fabsl(c)) {
+  if (std::fabs(b) < std::fabs(c)) {
     e = (c >= 0) ? a : -a;
-    e = b * (b / fabsl(c)) - e;
-    d = sqrtl(fabsl(e)) * sqrtl(fabsl(c));
+    e = b * (b / std::fabs(c)) - e;
+    d = std::sqrt(std::fabs(e)) * std::sqrt(std::fabs(c));
   } else {
     e = 1.0 - (a / b) * (c / b);
-    d = sqrtl(fabsl(e)) * fabsl(b);
+    d = std::sqrt(std::fabs(e)) * std::fabs(b);
   }
   if (e >= 0) {
     d = (b >= 0) ? -d : d;
@@ -129,40 +147,44 @@ void solve_quadratic(LD a, LD b1, LD c, LD * sr, LD * si, LD * lr, LD * li) {
     *sr = (*lr != 0) ? (c / *lr / a) : *sr;
   } else {
     *lr = *sr = -b / a;
-    *si = fabsl(d / a);
+    *si = std::fabs(d / a);
     *li = -(*si);
   }
 }
 
-void quadratic_iterate(int N, int * NZ, LD uu, LD vv,
-                       LD * szr, LD * szi, LD * lzr, LD * lzi, LD qp[],
-                       int n, LD * a, LD * b, LD p[], LD qk[],
-                       LD * a1, LD * a3, LD * a7, LD * c, LD * d, LD * e,
-                       LD * f, LD * g, LD * h, LD k[]) {
+template<class T>
+void quadratic_iterate(int N, int * NZ, T uu, T vv,
+                       T * szr, T * szi, T * lzr, T * lzi, T qp[],
+                       int n, T * a, T * b, T p[], T qk[],
+                       T * a1, T * a3, T * a7, T * c, T * d, T * e,
+                       T * f, T * g, T * h, T k[]) {
+  const T eps = std::numeric_limits<T>::epsilon();
   int steps = 0, flag, tried_flag = 0;
-  LD ee, mp, omp = 0.0, relstp = 0.0, t, u, ui, v, vi, zm;
+  T ee, mp, omp = 0.0, relstp = 0.0, t, u, ui, v, vi, zm;
   *NZ = 0;
   u = uu;
   v = vv;
   do {
-    solve_quadratic(1.0, u, v, szr, szi, lzr, lzi);
-    if (fabsl(fabsl(*szr) - fabsl(*lzr)) > 0.01 * fabsl(*lzr)) break;
+    solve_quadratic(T(1), u, v, szr, szi, lzr, lzi);
+    if (std::fabs(std::fabs(*szr) - std::fabs(*lzr)) > 0.01 * std::fabs(*lzr))
+      break;
     divide_quadratic(n, u, v, p, qp, a, b);
-    mp = fabsl(-((*szr) * (*b)) + *a) + fabsl((*szi) * (*b));
-    zm = sqrtl(fabsl(v));
-    ee = 2.0 * fabsl(qp[0]);
+    mp = std::fabs(-((*szr) * (*b)) + *a) + std::fabs((*szi) * (*b));
+    zm = std::sqrt(std::fabs(v));
+    ee = 2.0 * std::fabs(qp[0]);
     t = -(*szr) * (*b);
-    for (int i = 1; i < N; i++) ee = ee * zm + fabsl(qp[i]);
-    ee = ee * zm + fabsl(*a + t);
-    ee = ee * 9.0 + 2.0 * fabsl(t) - 7.0 * (fabsl(*a + t) + zm * fabsl(*b));
-    ee *= LDBL_EPSILON;
+    for (int i = 1; i < N; i++) ee = ee * zm + std::fabs(qp[i]);
+    ee = ee * zm + std::fabs(*a + t);
+    ee = ee * 9.0 + 2.0 * std::fabs(t) -
+         7.0 * (std::fabs(*a + t) + zm * std::fabs(*b));
+    ee *= eps;
     if (mp <= 20.0 * ee) {
       *NZ = 2;
       break;
     }
     if (++steps > 20) break;
     if (steps >= 2 && relstp <= 0.01 && mp >= omp && !tried_flag) {
-      relstp = (relstp < LDBL_EPSILON) ? sqrtl(LDBL_EPSILON) : sqrtl(relstp);
+      relstp = (relstp < eps) ? std::sqrt(eps) : std::sqrt(relstp);
       u -= u * relstp;
       v += v * relstp;
       divide_quadratic(n, u, v, p, qp, a, b);
@@ -180,34 +202,36 @@ void quadratic_iterate(int N, int * NZ, LD uu, LD vv,
     estimate_coeff(flag, &ui, &vi, *a, *a1, *a3, *a7, *b, *c, *d, *f, *g, *h,
                    u, v, k, N, p);
     if (vi != 0) {
-      relstp = fabsl((-v + vi) / vi);
+      relstp = std::fabs((-v + vi) / vi);
       u = ui;
       v = vi;
     }
   } while (vi != 0);
 }
 
-void real_iterate(int * flag, int * nz, LD * sss, int n, LD p[],
-                  int nn, LD qp[], LD * szr, LD * szi, LD k[], LD qk[]) {
+template<class T>
+void real_iterate(int * flag, int * nz, T * sss, int n, T p[],
+                  int nn, T qp[], T * szr, T * szi, T k[], T qk[]) {
+  const T eps = std::numeric_limits<T>::epsilon();
   int steps = 0;
-  LD ee, kv, mp, ms, omp = 0.0, pv, s, t = 0.0;
+  T ee, kv, mp, ms, omp = 0.0, pv, s, t = 0.0;
   *flag = *nz = 0;
   for (s = *sss; ; s += t) {
     pv = p[0];
     qp[0] = pv;
     for (int i = 1; i < nn; i++) qp[i] = pv = pv * s + p[i];
-    mp = fabsl(pv);
-    ms = fabsl(s);
-    ee = 0.5 * fabsl(qp[0]);
-    for (int i = 1; i < nn; i++) ee = ee * ms + fabsl(qp[i]);
-    if (mp <= 20.0 * LDBL_EPSILON * (2.0 * ee - mp)) {
+    mp = std::fabs(pv);
+    ms = std::fabs(s);
+    ee = 0.5 * std::fabs(qp[0]);
+    for (int i = 1; i < nn; i++) ee = ee * ms + std::fabs(qp[i]);
+    if (mp <= 20.0 * eps * (2.0 * ee - mp)) {
       *nz = 1;
       *szr = s;
       *szi = 0.0;
       break;
     }
     if (++steps > 10) break;
-    if (steps >= 2 && fabsl(t) <= 0.001 * fabsl(s - t) && mp > omp) {
+    if (steps >= 2 && std::fabs(t) <= 0.001 * std::fabs(s - t) && mp > omp) {
       *flag = 1;
       *sss = s;
       break;
@@ -215,7 +239,7 @@ void real_iterate(int * flag, int * nz, LD * sss, int n, LD p[],
     omp = mp;
     qk[0] = kv = k[0];
     for (int i = 1; i < n; i++) qk[i] = kv = kv * s + k[i];
-    if (fabsl(kv) > fabsl(k[n - 1]) * 10.0 * LDBL_EPSILON) {
+    if (std::fabs(kv) > std::fabs(k[n - 1]) * 10.0 * eps) {
       t = -pv / kv;
       k[0] = qp[0];
       for (int i = 1; i < n; i++)
@@ -227,16 +251,17 @@ void real_iterate(int * flag, int * nz, LD * sss, int n, LD p[],
     }
     kv = k[0];
     for (int i = 1; i < n; i++) kv = kv * s + k[i];
-    t = fabsl(kv) > (fabsl(k[n - 1]) * 10.0 * LDBL_EPSILON) ? -pv / kv : 0.0;
+    t = std::fabs(kv) > (std::fabs(k[n - 1]) * 10.0 * eps) ? -pv / kv : 0.0;
   }
 }
 
-void solve_fixedshift(int l2, int * nz, LD sr, LD v, LD k[], int n,
-                      LD p[], int nn, LD qp[], LD u, LD qk[], LD svk[],
-                      LD * lzi, LD * lzr, LD * szi, LD * szr) {
+template<class T>
+void solve_fixedshift(int l2, int * nz, T sr, T v, T k[], int n,
+                      T p[], int nn, T qp[], T u, T qk[], T svk[],
+                      T * lzi, T * lzr, T * szi, T * szr) {
   int flag, _flag, __flag = 1, spass, stry, vpass, vtry;
-  LD a, a1, a3, a7, b, betas, betav, c, d, e, f, g, h;
-  LD oss, ots = 0.0, otv = 0.0, ovv, s, ss, ts, tss, tv, tvv, ui, vi, vv;
+  T a, a1, a3, a7, b, betas, betav, c, d, e, f, g, h;
+  T oss, ots = 0.0, otv = 0.0, ovv, s, ss, ts, tss, tv, tvv, ui, vi, vv;
   *nz = 0;
   betav = betas = 0.25;
   oss = sr;
@@ -255,8 +280,8 @@ void solve_fixedshift(int l2, int * nz, LD sr, LD v, LD k[], int n,
     ss = k[n - 1] != 0.0 ? -p[n] / k[n - 1] : 0.0;
     ts = tv = 1.0;
     if (j != 0 && flag != 3) {
-      tv = (vv != 0.0) ? fabsl((vv - ovv) / vv) : tv;
-      ts = (ss != 0.0) ? fabsl((ss - oss) / ss) : ts;
+      tv = (vv != 0.0) ? std::fabs((vv - ovv) / vv) : tv;
+      ts = (ss != 0.0) ? std::fabs((ss - oss) / ss) : ts;
       tvv = (tv < otv) ? tv * otv : 1.0;
       tss = (ts < ots) ? ts * ots : 1.0;
       vpass = (tvv < betav) ? 1 : 0;
@@ -304,131 +329,177 @@ void solve_fixedshift(int l2, int * nz, LD sr, LD v, LD k[], int n,
   }
 }
 
-void find_roots(int degree, LD co[], LD re[], LD im[]) {
-  int j, jj, n, nm1, nn, nz, zero, SZ = degree + 1;
-  LD k[SZ], p[SZ], pt[SZ], qp[SZ], temp[SZ], qk[SZ], svk[SZ];
-  LD bnd, df, dx, factor, ff, moduli_max, moduli_min, sc, x, xm;
-  LD aa, bb, cc, lzi, lzr, sr, szi, szr, t, u, xx, xxx, yy;
-  n = degree;
-  xx = sqrtl(0.5);
-  yy = -xx;
-  for (j = 0; co[n] == 0; n--, j++) re[j] = im[j] = 0.0;
-  nn = n + 1;
-  for (int i = 0; i < nn; i++) p[i] = co[i];
-  while (n >= 1) {
-    if (n <= 2) {
-      if (n < 2) {
-        re[degree - 1] = -p[1] / p[0];
-        im[degree - 1] = 0.0;
-      } else {
-        solve_quadratic(p[0], p[1], p[2], &re[degree - 2], &im[degree - 2],
-                                          &re[degree - 1], &im[degree - 1]);
+template<class T> class rpoly {
+  std::vector<T> k, p, pt, qp, temp, qk, svk;
+
+ public:
+  explicit rpoly(int max_degree = 0) {
+    reserve(max_degree);
+  }
+
+  //grows the workspaces for polynomials of degree up to max_degree
+  void reserve(int max_degree) {
+    if ((int)p.size() > max_degree) return;
+    int SZ = max_degree + 1;
+    k.resize(SZ);
+    p.resize(SZ);
+    pt.resize(SZ);
+    qp.resize(SZ);
+    temp.resize(SZ);
+    qk.resize(SZ);
+    svk.resize(SZ);
+  }
+
+  //finds the roots of co[0]*x^degree + ... + co[degree], storing their real
+  //and imaginary parts in re[] and im[], and returns the number found
+  int solve(int degree, const T co[], T re[], T im[]) {
+    const T eps = std::numeric_limits<T>::epsilon();
+    const T tiny = std::numeric_limits<T>::min();
+    const T huge = std::numeric_limits<T>::max();
+    const T DEG = T(0.01745329251994329576923690768489L);
+    const T cos94 = std::cos(94 * DEG), sin94 = std::sin(94 * DEG);
+    int j, jj, n, nm1, nn, nz, zero;
+    T bnd, df, dx, factor, ff, moduli_max, moduli_min, sc, x, xm;
+    T aa, bb, cc, lzi, lzr, sr, szi, szr, t, u, xx, xxx, yy;
+    reserve(degree);
+    n = degree;
+    xx = std::sqrt(T(0.5));
+    yy = -xx;
+    for (j = 0; n > 0 && co[n] == 0; n--, j++) re[j] = im[j] = 0.0;
+    nn = n + 1;
+    for (int i = 0; i < nn; i++) p[i] = co[i];
+    while (n >= 1) {
+      if (n <= 2) {
+        if (n < 2) {
+          re[degree - 1] = -p[1] / p[0];
+          im[degree - 1] = 0.0;
+        } else {
+          solve_quadratic(p[0], p[1], p[2], &re[degree - 2], &im[degree - 2],
+                                            &re[degree - 1], &im[degree - 1]);
+        }
+        return degree;
       }
-      break;
-    }
-    moduli_max = 0.0;
-    moduli_min = LDBL_MAX;
-    for (int i = 0; i < nn; i++) {
-      x = fabsl(p[i]);
-      if (x > moduli_max) moduli_max = x;
-      if (x != 0 && x < moduli_min) moduli_min = x;
-    }
-    sc = LDBL_MIN / LDBL_EPSILON / moduli_min;
-    if ((sc <= 1.0 && moduli_max >= 10) ||
-        (sc > 1.0 && LDBL_MAX / sc >= moduli_max)) {
-      sc = (sc == 0) ? LDBL_MIN : sc;
-      factor = powl(2.0, logl(sc) / logl(2.0));
-      if (factor != 1.0)
-        for (int i = 0; i < nn; i++) p[i] *= factor;
-    }
-    for (int i = 0; i < nn; i++) pt[i] = fabsl(p[i]);
-    pt[n] = -pt[n];
-    nm1 = n - 1;
-    x = expl((logl(-pt[n]) - logl(pt[0])) / (LD)n);
-    if (pt[nm1] != 0) {
-      xm = -pt[n] / pt[nm1];
-      if (xm < x) x = xm;
-    }
-    xm = x;
-    do {
-      x = xm;
-      xm = 0.1 * x;
-      ff = pt[0];
-      for (int i = 1; i < nn; i++) ff = ff * xm + pt[i];
-    } while (ff > 0);
-    dx = x;
-    do {
-      df = ff = pt[0];
-      for (int i = 1; i < n; i++) {
-        ff = x * ff + pt[i];
-        df = x * df + ff;
+      moduli_max = 0.0;
+      moduli_min = huge;
+      for (int i = 0; i < nn; i++) {
+        x = std::fabs(p[i]);
+        if (x > moduli_max) moduli_max = x;
+        if (x != 0 && x < moduli_min) moduli_min = x;
       }
-      ff = x * ff + pt[n];
-      dx = ff / df;
-      x -= dx;
-    } while (fabsl(dx / x) > 0.005);
-    bnd = x;
-    for (int i = 1; i < n; i++)
-      k[i] = (LD)(n - i) * p[i] / (LD)n;
-    k[0] = p[0];
-    aa = p[n];
-    bb = p[nm1];
-    zero = (k[nm1] == 0) ? 1 : 0;
-    for (jj = 0; jj < 5; jj++) {
-      cc = k[nm1];
-      if (zero) {
-        for (int i = 0; i < nm1; i++) {
-          j = nm1 - i;
-          k[j] = k[j - 1];
+      sc = tiny / eps / moduli_min;
+      if ((sc <= 1.0 && moduli_max >= 10) ||
+          (sc > 1.0 && huge / sc >= moduli_max)) {
+        sc = (sc == 0) ? tiny : sc;
+        factor = std::pow(T(2), std::log(sc) / std::log(T(2)));
+        if (factor != 1.0)
+          for (int i = 0; i < nn; i++) p[i] *= factor;
+      }
+      for (int i = 0; i < nn; i++) pt[i] = std::fabs(p[i]);
+      pt[n] = -pt[n];
+      nm1 = n - 1;
+      x = std::exp((std::log(-pt[n]) - std::log(pt[0])) / (T)n);
+      if (pt[nm1] != 0) {
+        xm = -pt[n] / pt[nm1];
+        if (xm < x) x = xm;
+      }
+      xm = x;
+      do {
+        x = xm;
+        xm = 0.1 * x;
+        ff = pt[0];
+        for (int i = 1; i < nn; i++) ff = ff * xm + pt[i];
+      } while (ff > 0);
+      dx = x;
+      do {
+        df = ff = pt[0];
+        for (int i = 1; i < n; i++) {
+          ff = x * ff + pt[i];
+          df = x * df + ff;
         }
-        k[0] = 0;
-        zero = (k[nm1] == 0) ? 1 : 0;
-      } else {
-        t = -aa / cc;
-        for (int i = 0; i < nm1; i++) {
-          j = nm1 - i;
-          k[j] = t * k[j - 1] + p[j];
+        ff = x * ff + pt[n];
+        dx = ff / df;
+        x -= dx;
+      } while (std::fabs(dx / x) > 0.005);
+      bnd = x;
+      for (int i = 1; i < n; i++)
+        k[i] = (T)(n - i) * p[i] / (T)n;
+      k[0] = p[0];
+      aa = p[n];
+      bb = p[nm1];
+      zero = (k[nm1] == 0) ? 1 : 0;
+      for (jj = 0; jj < 5; jj++) {
+        cc = k[nm1];
+        if (zero) {
+          for (int i = 0; i < nm1; i++) {
+            j = nm1 - i;
+            k[j] = k[j - 1];
+          }
+          k[0] = 0;
+          zero = (k[nm1] == 0) ? 1 : 0;
+        } else {
+          t = -aa / cc;
+          for (int i = 0; i < nm1; i++) {
+            j = nm1 - i;
+            k[j] = t * k[j - 1] + p[j];
+          }
+          k[0] = p[0];
+          zero = (std::fabs(k[nm1]) <= std::fabs(bb) * eps * 10.0) ? 1 : 0;
         }
-        k[0] = p[0];
-        zero = (fabsl(k[nm1]) <= fabsl(bb) * LDBL_EPSILON * 10.0) ? 1 : 0;
       }
-    }
-    for (int i = 0; i < n; i++) temp[i] = k[i];
-    static const LD DEG = 0.01745329251994329576923690768489L;
-    for (jj = 1; jj <= 20; jj++) {
-      xxx = -sinl(94.0 * DEG) * yy + cosl(94.0 * DEG) * xx;
-      yy = sinl(94.0 * DEG) * xx + cosl(94.0 * DEG) * yy;
-      xx = xxx;
-      sr = bnd * xx;
-      u = -2.0 * sr;
-      for (int i = 0; i < nn; i++) qk[i] = svk[i] = 0.0;
-      solve_fixedshift(20 * jj, &nz, sr, bnd, k, n, p, nn, qp, u,
-                       qk, svk, &lzi, &lzr, &szi, &szr);
-      if (nz != 0) {
-        j = degree - n;
-        re[j] = szr;
-        im[j] = szi;
-        nn = nn - nz;
-        n = nn - 1;
-        for (int i = 0; i < nn; i++) p[i] = qp[i];
-        if (nz != 1) {
-          re[j + 1] = lzr;
-          im[j + 1] = lzi;
+      for (int i = 0; i < n; i++) temp[i] = k[i];
+      for (jj = 1; jj <= 20; jj++) {
+        xxx = -sin94 * yy + cos94 * xx;
+        yy = sin94 * xx + cos94 * yy;
+        xx = xxx;
+        sr = bnd * xx;
+        u = -2.0 * sr;
+        for (int i = 0; i < nn; i++) qk[i] = svk[i] = 0.0;
+        solve_fixedshift(20 * jj, &nz, sr, bnd, &k[0], n, &p[0], nn, &qp[0],
+                         u, &qk[0], &svk[0], &lzi, &lzr, &szi, &szr);
+        if (nz != 0) {
+          j = degree - n;
+          re[j] = szr;
+          im[j] = szi;
+          nn = nn - nz;
+          n = nn - 1;
+          for (int i = 0; i < nn; i++) p[i] = qp[i];
+          if (nz != 1) {
+            re[j + 1] = lzr;
+            im[j + 1] = lzi;
+          }
+          break;
+        } else {
+          for (int i = 0; i < n; i++) k[i] = temp[i];
         }
-        break;
-      } else {
-        for (int i = 0; i < n; i++) k[i] = temp[i];
       }
+      if (jj > 20) break;
     }
-    if (jj > 20) break;
+    return degree - n;
   }
+
+  //solves count polynomials of the same degree, the i-th of which has its
+  //coefficients at co + i*(degree + 1) and its roots stored at re + i*degree
+  //and im + i*degree, returning the number of polynomials fully solved
+  int solve_batch(int count, int degree, const T co[], T re[], T im[]) {
+    int solved = 0;
+    reserve(degree);
+    for (int i = 0; i < count; i++) {
+      int d = solve(degree, co + i * (degree + 1), re + i * degree,
+                    im + i * degree);
+      if (d == degree) solved++;
+    }
+    return solved;
+  }
+};
+
+void find_roots(int degree, LD co[], LD re[], LD im[]) {
+  rpoly<LD>(degree).solve(degree, co, re, im);
 }
 
 /*** Wrapper ***/
 
 #include <algorithm> /* std::reverse(), std::sort() */
 #include <complex>
-#include <vector>
 
 typedef std::complex<LD> root;
 
@@ -450,6 +521,8 @@ std::vector<root> find_roots(int degree, LD coefficients[]) {
 
 /*** Example Usage (http://wcipeg.com/problem/rootsolve) ***/
 
+#include <cassert>
+#include <cfloat> /* LDBL_EPSILON */
 #include <iostream>
 using namespace std;
 
@@ -457,6 +530,22 @@ int T, degree, p;
 LD c, coeff[101];
 
 int main() {
+  //x^3 - 6x^2 + 11x - 6 = (x - 1)(x - 2)(x - 3), and x^3 - x^2 + x - 1
+  //= (x - 1)(x^2 + 1), solved as a batch in double precision
+  double cubics[] = {1, -6, 11, -6, 1, -1, 1, -1}, re[6], im[6];
+  rpoly<double> solver(3);
+  assert(solver.solve_batch(2, 3, cubics, re, im) == 2);
+  double sum = 0, prod = 1, sum2 = 0, norm2 = 0;
+  for (int i = 0; i < 3; i++) {
+    sum += re[i];
+    prod *= re[i];
+    sum2 += re[3 + i];
+    norm2 += im[3 + i] * im[3 + i];
+    assert(fabs(im[i]) < 1e-12);
+  }
+  assert(fabs(sum - 6) < 1e-9 && fabs(prod - 6) < 1e-9);
+  assert(fabs(sum2 - 1) < 1e-9 && fabs(norm2 - 2) < 1e-9);
+
   degree = 0;
   cin >> T;
   for (int i = 0; i < T; i++) {
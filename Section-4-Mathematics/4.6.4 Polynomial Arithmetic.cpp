@@ -0,0 +1,663 @@
+/*
+
+A polynomial a[0] + a[1]x + ... + a[n]x^n is stored as the vector of its
+coefficients a, without zeros at the end, over either the integers modulo
+a prime P, as mod_int<P>, or the doubles. The following operations are
+asymptotically fast, in contrast to the quadratic coefficient-by-
+coefficient methods of the previous sections.
+
+Multiplication is the convolution of the coefficients. For mod_int<P>
+with an NTT prime P = c*2^k + 1 (such as 998244353 = 119*2^23 + 1), it
+uses the number-theoretic transform of section 4.4.3, and for doubles it
+uses the FFT of that section, with both factors packed into one complex
+transform. For any other modulus P (such as 10^9 + 7), or a transform
+size which does not divide P - 1, the product is found modulo the three
+NTT primes of mul_exact() in section 4.4.3 and combined with Garner's
+algorithm, which is exact for P < 2^31 up to their limit of 2^23 terms.
+Short factors are multiplied naively, and so are longer products than
+that, and polynomials over any other field T for which only the naive
+convolution is defined.
+
+inverse(n) returns the power series 1/p modulo x^n, given p[0] != 0, by
+Newton's iteration b' = b(2 - pb), which doubles the number of correct
+terms of b with each step, so that it takes O(M(n)) for the cost M(n) of
+one multiplication. Division with remainder (operator / and operator %)
+finds the quotient of p by q of degrees n >= m from the reversed
+polynomials, as rev(p) * rev(q)^-1 modulo x^(n - m + 1). log(n) returns
+the integral of p'/p (given p[0] = 1), and exp(n) returns the inverse of
+log() by the Newton iteration e' = e(1 + p - log(e)) (given p[0] = 0),
+both modulo x^n. The latter two divide by integers up to n, which must be
+invertible in T.
+
+evaluate(x) evaluates p at many points with a subproduct tree, which
+holds the products of (X - x[i]) over a segment tree on the points. The
+remainder of p by each node is divided down by its children, and blocks
+of at most 64 points evaluate their remainder directly with Horner's
+method. interpolate(x, y) returns the polynomial of degree less than n
+through the n points (x[i], y[i]) with distinct x[i], weighting each y[i]
+by the inverse of M'(x[i]) for the product M of all (X - x[i]) and
+combining the weighted sums of the children with the same tree. With
+doubles, the remainders of the tree lose accuracy quickly as the degree
+grows, so evaluate_many(p, x) below evaluates by Horner's method for
+each point instead, but 8 points at a time with SSE2 where available,
+which keeps 8 independent chains of multiply-adds in flight rather than
+waiting for the latency of each one.
+
+Time Complexity: O(n log n) for multiplication, inverse(), division,
+log(), and exp() of degree n, and O(n log^2 n) for evaluate() and
+interpolate() at n points, where the NTT or FFT applies. evaluate_many()
+takes O(nm) for degree n and m points.
+
+Space Complexity: O(n) auxiliary for all operations, besides O(n log n)
+for the subproduct trees.
+
+*/
+
+#include <algorithm> /* std::max(), std::min(), std::reverse(), std::swap() */
+#include <cmath>     /* acos(), cos(), sin() */
+#include <complex>
+#include <map>
+#include <stdexcept> /* std::runtime_error() */
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h> /* _mm_add_pd(), _mm_mul_pd(), ... */
+#endif
+
+typedef std::complex<double> cd;
+typedef std::vector<cd> vcd;
+
+class fft_plan {
+  int n;
+  std::vector<int> rev;
+  vcd roots; //roots[k + j] = e^(i*pi*j/k) for each power of two k < n
+
+ public:
+  explicit fft_plan(int n): n(n), rev(n), roots(std::max(n, 2)) {
+    static const double PI = acos(-1.0);
+    int k = 0;
+    while ((1 << k) < n) k++;
+    for (int i = 1; i < n; i++)
+      rev[i] = (rev[i >> 1] >> 1) | ((i & 1) << (k - 1));
+    for (int len = 1; len < n; len <<= 1)
+      for (int j = 0; j < len; j++)
+        roots[len + j] = cd(cos(PI * j / len), sin(PI * j / len));
+  }
+
+  static const fft_plan & get(int n) {
+    static std::map<int, fft_plan> cache;
+    std::map<int, fft_plan>::iterator it = cache.find(n);
+    if (it == cache.end())
+      it = cache.insert(std::make_pair(n, fft_plan(n))).first;
+    return it->second;
+  }
+
+  int size() const { return n; }
+
+  void transform(cd * a, bool inverse = false) const {
+    for (int i = 1; i < n; i++)
+      if (i < rev[i]) std::swap(a[i], a[rev[i]]);
+    int len = 1;
+    if (n >= 4) {
+      for (int i = 0; i < n; i += 4) {
+        cd s0 = a[i] + a[i + 1], d0 = a[i] - a[i + 1];
+        cd s1 = a[i + 2] + a[i + 3], d1 = a[i + 2] - a[i + 3];
+        cd t = cd(-d1.imag(), d1.real()); //d1 * i
+        a[i] = s0 + s1;
+        a[i + 1] = d0 + t;
+        a[i + 2] = s0 - s1;
+        a[i + 3] = d0 - t;
+      }
+      len = 4;
+    } else if (n == 2) {
+      cd u = a[0];
+      a[0] = u + a[1];
+      a[1] = u - a[1];
+      len = 2;
+    }
+    for (; len < n; len <<= 1) {
+      for (int i = 0; i < n; i += 2 * len) {
+        cd * x = a + i, * y = a + i + len;
+        const cd * w = &roots[len];
+        for (int j = 0; j < len; j++) {
+          double wr = w[j].real(), wi = w[j].imag();
+          double yr = y[j].real() * wr - y[j].imag() * wi;
+          double yi = y[j].real() * wi + y[j].imag() * wr;
+          double xr = x[j].real(), xi = x[j].imag();
+          x[j] = cd(xr + yr, xi + yi);
+          y[j] = cd(xr - yr, xi - yi);
+        }
+      }
+    }
+    if (inverse) {
+      std::reverse(a + 1, a + n);
+      for (int i = 0; i < n; i++) a[i] /= n;
+    }
+  }
+};
+
+unsigned int pow_mod(unsigned int b, unsigned long long e, unsigned int m) {
+  unsigned long long r = 1, x = b % m;
+  for (; e > 0; e >>= 1, x = x * x % m)
+    if (e & 1) r = r * x % m;
+  return (unsigned int)r;
+}
+
+class ntt_prime {
+  unsigned int p, pinv, r2; //pinv = -p^-1 mod 2^32, r2 = 2^64 mod p
+  unsigned int g;           //a primitive root modulo p
+  std::vector<unsigned int> roots, iroots;
+
+  //adds p back to x in (-p, p) if it is negative, without a branch,
+  //since the branches of butterflies on random data are unpredictable
+  unsigned int fix(unsigned int x) const {
+    return x + (p & -(x >> 31));
+  }
+
+  unsigned int reduce(unsigned long long t) const { //t * 2^-32 mod p
+    unsigned int m = (unsigned int)t * pinv;
+    return fix((unsigned int)((t + (unsigned long long)m * p) >> 32) - p);
+  }
+
+  unsigned int add(unsigned int a, unsigned int b) const {
+    return fix(a + b - p);
+  }
+
+  unsigned int sub(unsigned int a, unsigned int b) const {
+    return fix(a - b);
+  }
+
+  //roots[len + j] = w^j for w a root of unity of order 2*len, as in fft_plan
+  void grow(int n) {
+    if ((int)roots.size() >= n) return;
+    if ((p - 1) % n != 0)
+      throw std::runtime_error("Error: transform size does not divide p - 1.");
+    roots.assign(n, 0);
+    iroots.assign(n, 0);
+    for (int len = 1; len < n; len <<= 1) {
+      unsigned int w = to(pow_mod(g, (p - 1) / (2 * len), p));
+      unsigned int iw = to(pow_mod(g, p - 1 - (p - 1) / (2 * len), p));
+      roots[len] = iroots[len] = to(1);
+      for (int j = 1; j < len; j++) {
+        roots[len + j] = mul(roots[len + j - 1], w);
+        iroots[len + j] = mul(iroots[len + j - 1], iw);
+      }
+    }
+  }
+
+ public:
+  explicit ntt_prime(unsigned int p): p(p), pinv(1) {
+    for (int i = 0; i < 5; i++) pinv *= 2 - p * pinv; //Newton's iteration
+    pinv = -pinv;
+    r2 = (unsigned int)((((unsigned long long)1 << 32) % p) *
+                        (((unsigned long long)1 << 32) % p) % p);
+    std::vector<unsigned int> factors;
+    unsigned int q = p - 1;
+    for (unsigned int d = 2; d * d <= q; d++) {
+      if (q % d == 0) factors.push_back(d);
+      while (q % d == 0) q /= d;
+    }
+    if (q > 1) factors.push_back(q);
+    for (g = 2; ; g++) {
+      bool ok = true;
+      for (int i = 0; i < (int)factors.size() && ok; i++)
+        ok = pow_mod(g, (p - 1) / factors[i], p) != 1;
+      if (ok) break;
+    }
+  }
+
+  static ntt_prime & get(unsigned int p) {
+    static std::map<unsigned int, ntt_prime> cache;
+    std::map<unsigned int, ntt_prime>::iterator it = cache.find(p);
+    if (it == cache.end())
+      it = cache.insert(std::make_pair(p, ntt_prime(p))).first;
+    return it->second;
+  }
+
+  unsigned int modulus() const { return p; }
+  unsigned int from(unsigned int a) const { return reduce(a); }
+
+  unsigned int to(unsigned int a) const {
+    return reduce((unsigned long long)a * r2);
+  }
+
+  unsigned int mul(unsigned int a, unsigned int b) const {
+    return reduce((unsigned long long)a * b);
+  }
+
+  //transforms n values in Montgomery form, from natural to bit-reversed
+  //order, or back from bit-reversed to natural order if inverse is set
+  void transform(unsigned int * a, int n, bool inverse = false) {
+    grow(n);
+    if (!inverse) {
+      for (int len = n >> 1; len >= 1; len >>= 1) {
+        const unsigned int * w = &roots[len];
+        for (int i = 0; i < n; i += 2 * len) {
+          unsigned int * x = a + i, * y = a + i + len;
+          for (int j = 0; j < len; j++) {
+            unsigned int u = x[j], v = y[j];
+            x[j] = add(u, v);
+            y[j] = mul(sub(u, v), w[j]);
+          }
+        }
+      }
+      return;
+    }
+    for (int len = 1; len < n; len <<= 1) {
+      const unsigned int * w = &iroots[len];
+      for (int i = 0; i < n; i += 2 * len) {
+        unsigned int * x = a + i, * y = a + i + len;
+        for (int j = 0; j < len; j++) {
+          unsigned int u = x[j], v = mul(y[j], w[j]);
+          x[j] = add(u, v);
+          y[j] = sub(u, v);
+        }
+      }
+    }
+    unsigned int ninv = to(pow_mod(n, p - 2, p));
+    for (int i = 0; i < n; i++) a[i] = mul(a[i], ninv);
+  }
+};
+
+template<unsigned int P> struct mod_int {
+  unsigned int v;
+
+  mod_int(long long x = 0) {
+    x %= (long long)P;
+    v = (unsigned int)(x < 0 ? x + P : x);
+  }
+
+  static mod_int raw(unsigned int x) {
+    mod_int r;
+    r.v = x;
+    return r;
+  }
+
+  mod_int operator + (const mod_int & b) const {
+    unsigned int s = v + b.v;
+    return raw(s >= P ? s - P : s);
+  }
+
+  mod_int operator - (const mod_int & b) const {
+    return raw(v >= b.v ? v - b.v : v + P - b.v);
+  }
+
+  mod_int operator * (const mod_int & b) const {
+    return raw((unsigned int)((unsigned long long)v * b.v % P));
+  }
+
+  mod_int operator / (const mod_int & b) const { return *this * b.inverse(); }
+  mod_int operator - () const { return raw(v == 0 ? 0 : P - v); }
+  mod_int & operator += (const mod_int & b) { return *this = *this + b; }
+  mod_int & operator -= (const mod_int & b) { return *this = *this - b; }
+  mod_int & operator *= (const mod_int & b) { return *this = *this * b; }
+  bool operator == (const mod_int & b) const { return v == b.v; }
+  bool operator != (const mod_int & b) const { return v != b.v; }
+  mod_int inverse() const { return raw(pow_mod(v, P - 2, P)); }
+};
+
+template<class T>
+std::vector<T> naive_convolve(const std::vector<T> & a,
+                              const std::vector<T> & b) {
+  if (a.empty() || b.empty()) return std::vector<T>();
+  std::vector<T> c(a.size() + b.size() - 1, T(0));
+  for (int i = 0; i < (int)a.size(); i++)
+    for (int j = 0; j < (int)b.size(); j++)
+      c[i + j] += a[i] * b[j];
+  return c;
+}
+
+template<class T>
+std::vector<T> convolve(const std::vector<T> & a, const std::vector<T> & b) {
+  return naive_convolve(a, b);
+}
+
+//the cyclic convolution of size n of a and b modulo the NTT prime p
+template<unsigned int P>
+std::vector<unsigned int> ntt_convolve(unsigned int p,
+                                       const std::vector<mod_int<P> > & a,
+                                       const std::vector<mod_int<P> > & b,
+                                       int n) {
+  ntt_prime & R = ntt_prime::get(p);
+  std::vector<unsigned int> fa(n, 0), fb(n, 0);
+  for (int i = 0; i < (int)a.size(); i++) fa[i] = R.to(a[i].v);
+  for (int i = 0; i < (int)b.size(); i++) fb[i] = R.to(b[i].v);
+  R.transform(&fa[0], n);
+  R.transform(&fb[0], n);
+  for (int i = 0; i < n; i++) fa[i] = R.mul(fa[i], fb[i]);
+  R.transform(&fa[0], n, true);
+  for (int i = 0; i < n; i++) fa[i] = R.from(fa[i]);
+  return fa;
+}
+
+template<unsigned int P>
+std::vector<mod_int<P> > convolve(const std::vector<mod_int<P> > & a,
+                                  const std::vector<mod_int<P> > & b) {
+  static const unsigned int p0 = 998244353, p1 = 167772161, p2 = 469762049;
+  if (std::min(a.size(), b.size()) <= 32) return naive_convolve(a, b);
+  int m = a.size() + b.size() - 1, n = 1;
+  while (n < m) n <<= 1;
+  std::vector<mod_int<P> > c(m);
+  if ((P - 1) % n == 0) {
+    std::vector<unsigned int> r = ntt_convolve(P, a, b, n);
+    for (int i = 0; i < m; i++) c[i] = mod_int<P>::raw(r[i]);
+    return c;
+  }
+  if ((p0 - 1) % n != 0) return naive_convolve(a, b); //past 2^23 terms
+  std::vector<unsigned int> r0 = ntt_convolve(p0, a, b, n);
+  std::vector<unsigned int> r1 = ntt_convolve(p1, a, b, n);
+  std::vector<unsigned int> r2 = ntt_convolve(p2, a, b, n);
+  //Garner's algorithm: c = x0 + x1*p0 + x2*p0*p1 with xi in [0, pi)
+  unsigned long long i01 = pow_mod(p0, p1 - 2, p1);
+  unsigned long long i012 = pow_mod((unsigned long long)p0 * p1 % p2, p2 - 2,
+                                    p2);
+  mod_int<P> m0(p0), m01((long long)p0 * p1);
+  for (int i = 0; i < m; i++) {
+    unsigned long long x0 = r0[i];
+    unsigned long long x1 = (r1[i] + p1 - x0 % p1) * i01 % p1;
+    unsigned long long x2 = (r2[i] + p2 - (x0 + x1 * p0) % p2) * i012 % p2;
+    c[i] = mod_int<P>(x0) + mod_int<P>(x1) * m0 + mod_int<P>(x2) * m01;
+  }
+  return c;
+}
+
+//packs a and b into one complex transform, as mul() of section 4.4.3
+std::vector<double> convolve(const std::vector<double> & a,
+                             const std::vector<double> & b) {
+  if (std::min(a.size(), b.size()) <= 32) return naive_convolve(a, b);
+  int m = a.size() + b.size() - 1, n = 1;
+  while (n < m) n <<= 1;
+  const fft_plan & plan = fft_plan::get(n);
+  vcd z(n), c(n);
+  for (int i = 0; i < (int)a.size(); i++) z[i] = cd(a[i], 0);
+  for (int i = 0; i < (int)b.size(); i++) z[i] = cd(z[i].real(), b[i]);
+  plan.transform(&z[0]);
+  for (int i = 0; i < n; i++) {
+    cd p = z[i], q = std::conj(z[(n - i) & (n - 1)]);
+    double sr = p.real() * p.real() - p.imag() * p.imag();
+    double si = 2 * p.real() * p.imag();
+    double tr = q.real() * q.real() - q.imag() * q.imag();
+    double ti = 2 * q.real() * q.imag();
+    c[i] = cd((si - ti) / 4, (tr - sr) / 4);
+  }
+  plan.transform(&c[0], true);
+  std::vector<double> res(m);
+  for (int i = 0; i < m; i++) res[i] = c[i].real();
+  return res;
+}
+
+template<class T> class poly {
+  //t[v] is the product of (X - x[i]) for i in [l, r) at node v of a
+  //segment tree on the points, where v = 1 covers [0, n)
+  static void build(std::vector<poly> & t, const std::vector<T> & x, int v,
+                    int l, int r) {
+    if (r - l == 1) {
+      t[v].a.resize(2);
+      t[v].a[0] = T(0) - x[l];
+      t[v].a[1] = T(1);
+      return;
+    }
+    int mid = (l + r) / 2;
+    build(t, x, 2 * v, l, mid);
+    build(t, x, 2 * v + 1, mid, r);
+    t[v] = t[2 * v] * t[2 * v + 1];
+  }
+
+  //evaluates this remainder of some p modulo t[v] at x[l..r - 1]
+  void evaluate_down(const std::vector<poly> & t, const std::vector<T> & x,
+                     int v, int l, int r, std::vector<T> & res) const {
+    if (r - l <= 64) {
+      for (int i = l; i < r; i++) res[i] = (*this)(x[i]);
+      return;
+    }
+    int mid = (l + r) / 2;
+    (*this % t[2 * v]).evaluate_down(t, x, 2 * v, l, mid, res);
+    (*this % t[2 * v + 1]).evaluate_down(t, x, 2 * v + 1, mid, r, res);
+  }
+
+  //the sum of w[i] times the product of (X - x[j]) for j != i in [l, r)
+  static poly combine(const std::vector<poly> & t, const std::vector<T> & w,
+                      int v, int l, int r) {
+    if (r - l == 1) return poly(std::vector<T>(1, w[l]));
+    int mid = (l + r) / 2;
+    return combine(t, w, 2 * v, l, mid) * t[2 * v + 1] +
+           combine(t, w, 2 * v + 1, mid, r) * t[2 * v];
+  }
+
+ public:
+  std::vector<T> a; //a[i] is the coefficient of x^i
+
+  poly() {}
+
+  poly(const std::vector<T> & a): a(a) { trim(); }
+
+  void trim() {
+    while (!a.empty() && a.back() == T(0)) a.pop_back();
+  }
+
+  int degree() const { return (int)a.size() - 1; } //-1 for zero
+
+  T operator [] (int i) const {
+    return (i >= 0 && i < (int)a.size()) ? a[i] : T(0);
+  }
+
+  //the value at x by Horner's method
+  T operator () (const T & x) const {
+    T res(0);
+    for (int i = (int)a.size() - 1; i >= 0; i--) res = res * x + a[i];
+    return res;
+  }
+
+  poly operator + (const poly & p) const {
+    std::vector<T> c(std::max(a.size(), p.a.size()));
+    for (int i = 0; i < (int)c.size(); i++) c[i] = (*this)[i] + p[i];
+    return poly(c);
+  }
+
+  poly operator - (const poly & p) const {
+    std::vector<T> c(std::max(a.size(), p.a.size()));
+    for (int i = 0; i < (int)c.size(); i++) c[i] = (*this)[i] - p[i];
+    return poly(c);
+  }
+
+  poly operator * (const poly & p) const { return poly(convolve(a, p.a)); }
+
+  poly operator * (const T & x) const {
+    std::vector<T> c(a);
+    for (int i = 0; i < (int)c.size(); i++) c[i] = c[i] * x;
+    return poly(c);
+  }
+
+  //this modulo x^n
+  poly mod_xk(int n) const {
+    return poly(std::vector<T>(a.begin(), a.begin() + std::min(n,
+                                                   (int)a.size())));
+  }
+
+  //the n coefficients of x^(n - 1) * p(1/x), for n > degree()
+  poly reverse(int n) const {
+    std::vector<T> c(n, T(0));
+    for (int i = 0; i < (int)a.size() && i < n; i++) c[n - 1 - i] = a[i];
+    return poly(c);
+  }
+
+  poly derivative() const {
+    std::vector<T> c(std::max(0, (int)a.size() - 1));
+    for (int i = 1; i < (int)a.size(); i++) c[i - 1] = a[i] * T(i);
+    return poly(c);
+  }
+
+  poly integral() const {
+    std::vector<T> c(a.size() + 1, T(0));
+    for (int i = 0; i < (int)a.size(); i++) c[i + 1] = a[i] / T(i + 1);
+    return poly(c);
+  }
+
+  //1/p modulo x^n, given p[0] != 0
+  poly inverse(int n) const {
+    poly b(std::vector<T>(1, T(1) / a[0]));
+    for (int k = 1; k < n; k *= 2) {
+      poly pb = (mod_xk(2 * k) * b).mod_xk(2 * k);
+      b = (b * (poly(std::vector<T>(1, T(2))) - pb)).mod_xk(2 * k);
+    }
+    return b.mod_xk(n);
+  }
+
+  poly operator / (const poly & q) const {
+    int n = degree(), m = q.degree();
+    if (n < m) return poly();
+    if (m < 64 || n - m < 64) { //the long division is faster
+      std::vector<T> r(a), res(n - m + 1);
+      T lead = T(1) / q.a[m];
+      for (int i = n - m; i >= 0; i--) {
+        res[i] = r[i + m] * lead;
+        for (int j = 0; j <= m; j++) r[i + j] -= res[i] * q.a[j];
+      }
+      return poly(res);
+    }
+    int k = n - m + 1;
+    poly res = (reverse(n + 1).mod_xk(k) * q.reverse(m + 1).inverse(k));
+    return res.mod_xk(k).reverse(k);
+  }
+
+  poly operator % (const poly & q) const {
+    if (degree() < q.degree()) return *this;
+    return (*this - *this / q * q).mod_xk(q.degree());
+  }
+
+  //log(p) modulo x^n, given p[0] = 1
+  poly log(int n) const {
+    return (derivative() * inverse(n)).mod_xk(n - 1).integral();
+  }
+
+  //exp(p) modulo x^n, given p[0] = 0
+  poly exp(int n) const {
+    poly e(std::vector<T>(1, T(1)));
+    for (int k = 1; k < n; k *= 2) {
+      poly f = mod_xk(2 * k) - e.log(2 * k);
+      f.a.resize(std::max((int)f.a.size(), 1), T(0));
+      f.a[0] += T(1);
+      e = (e * f).mod_xk(2 * k);
+    }
+    return e.mod_xk(n);
+  }
+
+  std::vector<T> evaluate(const std::vector<T> & x) const {
+    std::vector<T> res(x.size());
+    if (x.empty()) return res;
+    std::vector<poly> t(4 * x.size());
+    build(t, x, 1, 0, x.size());
+    (*this % t[1]).evaluate_down(t, x, 1, 0, x.size(), res);
+    return res;
+  }
+
+  static poly interpolate(const std::vector<T> & x, const std::vector<T> & y) {
+    if (x.empty()) return poly();
+    std::vector<poly> t(4 * x.size());
+    build(t, x, 1, 0, x.size());
+    std::vector<T> w(x.size());
+    (t[1].derivative() % t[1]).evaluate_down(t, x, 1, 0, x.size(), w);
+    for (int i = 0; i < (int)x.size(); i++) w[i] = y[i] / w[i];
+    return combine(t, w, 1, 0, x.size());
+  }
+};
+
+//p(x[i]) for every i by Horner's method, on 8 points at a time
+template<class T>
+std::vector<double> evaluate_many(const poly<T> & p,
+                                  const std::vector<double> & x) {
+  int n = p.a.size(), m = x.size(), i = 0;
+  std::vector<double> res(m);
+#ifdef __SSE2__
+  for (; i + 8 <= m; i += 8) {
+    __m128d x0 = _mm_loadu_pd(&x[i]), x1 = _mm_loadu_pd(&x[i + 2]);
+    __m128d x2 = _mm_loadu_pd(&x[i + 4]), x3 = _mm_loadu_pd(&x[i + 6]);
+    __m128d r0 = _mm_setzero_pd(), r1 = r0, r2 = r0, r3 = r0;
+    for (int k = n - 1; k >= 0; k--) {
+      __m128d c = _mm_set1_pd(p.a[k]);
+      r0 = _mm_add_pd(_mm_mul_pd(r0, x0), c);
+      r1 = _mm_add_pd(_mm_mul_pd(r1, x1), c);
+      r2 = _mm_add_pd(_mm_mul_pd(r2, x2), c);
+      r3 = _mm_add_pd(_mm_mul_pd(r3, x3), c);
+    }
+    _mm_storeu_pd(&res[i], r0);
+    _mm_storeu_pd(&res[i + 2], r1);
+    _mm_storeu_pd(&res[i + 4], r2);
+    _mm_storeu_pd(&res[i + 6], r3);
+  }
+#endif
+  for (; i < m; i++) res[i] = p(x[i]);
+  return res;
+}
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <cstdlib> /* rand() */
+#include <iostream>
+using namespace std;
+
+typedef mod_int<998244353> mint;
+
+poly<mint> random_poly(int n) {
+  vector<mint> a(n);
+  for (int i = 0; i < n; i++) a[i] = mint(rand());
+  return poly<mint>(a);
+}
+
+int main() {
+  //products, inverses, and division against the naive methods
+  for (int it = 0; it < 20; it++) {
+    poly<mint> p = random_poly(1 + rand() % 500);
+    poly<mint> q = random_poly(1 + rand() % 500);
+    assert((p * q).a == naive_convolve(p.a, q.a));
+    poly<mint> inv = p.inverse(300), one = (p * inv).mod_xk(300);
+    assert(one.degree() == 0 && one[0] == mint(1));
+    poly<mint> d = p / q, r = p % q;
+    assert(r.degree() < q.degree() && (d * q + r).a == p.a);
+  }
+  //10^9 + 7 is not an NTT prime, so its products go through Garner's
+  //algorithm, even for coefficients near P with the longest factors
+  typedef mod_int<1000000007> mint7;
+  vector<mint7> s(3000), t(3000);
+  for (int i = 0; i < 3000; i++) {
+    s[i] = mint7(rand());
+    t[i] = mint7(-1 - i % 2);
+  }
+  assert((poly<mint7>(s) * poly<mint7>(t)).a == naive_convolve(s, t));
+  //exp() and log() are inverses, and exp(x) = sum of x^k/k!
+  poly<mint> f = random_poly(1000);
+  f.a[0] = 0;
+  assert(f.exp(1000).log(1000).a == f.a);
+  vector<mint> id(2);
+  id[1] = 1;
+  poly<mint> e = poly<mint>(id).exp(10);
+  assert(e[4] == mint(1) / mint(24));
+  //multipoint evaluation and interpolation
+  vector<mint> x(2000), y;
+  for (int i = 0; i < 2000; i++) x[i] = mint(i * 7 + 3);
+  poly<mint> p = random_poly(2000);
+  y = p.evaluate(x);
+  for (int i = 0; i < 2000; i += 97) assert(y[i] == p(x[i]));
+  assert(poly<mint>::interpolate(x, y).a == p.a);
+
+  //doubles: (x - 1)(x - 2)(x - 3) = x^3 - 6x^2 + 11x - 6
+  double c[] = {-6, 11, -6, 1};
+  poly<double> g(vector<double>(c, c + 4));
+  vector<double> pts(20);
+  for (int i = 0; i < 20; i++) pts[i] = i * 0.5;
+  vector<double> v = evaluate_many(g, pts);
+  for (int i = 0; i < 20; i++) assert(fabs(v[i] - g(pts[i])) < 1e-9);
+  cout << v[2] << " " << v[3] << "\n"; //0 0.375
+  //refines rough roots of g by Newton's method, for all roots at once
+  poly<double> dg = g.derivative();
+  vector<double> roots(3);
+  roots[0] = 0.9;
+  roots[1] = 2.2;
+  roots[2] = 2.8;
+  for (int step = 0; step < 8; step++) {
+    vector<double> gv = evaluate_many(g, roots), dv = evaluate_many(dg, roots);
+    for (int i = 0; i < 3; i++) roots[i] -= gv[i] / dv[i];
+  }
+  for (int i = 0; i < 3; i++) assert(fabs(roots[i] - (i + 1)) < 1e-12);
+  return 0;
+}
@@ -7,13 +7,19 @@ operations (e.g. overloaded operators for vector addition, subtraction,
 multiplication, and division; dot/cross products, etc.) pertaining to
 2D cartesian vectors.
 
-All operations are O(1) in time and space.
+All operations are O(1) in time and space. See below for point_batch,
+which performs operations on many points at once.
 
 */
 
-#include <cmath>   /* atan(), fabs(), sqrt() */
+#include <algorithm> /* std::max(), std::min() */
+#include <cmath>     /* atan(), fabs(), sqrt() */
 #include <ostream>
-#include <utility> /* std::pair */
+#include <utility>   /* std::pair */
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h> /* _mm_add_pd(), _mm_mul_pd(), ... */
+#endif
 
 const double eps = 1e-9;
 
@@ -126,6 +132,187 @@ struct point {
   }
 };
 
+/*
+
+Point Batches
+
+point_batch stores points as separate arrays of x and y coordinates (a
+structure of arrays), so that operations over all of its points can run
+two points at a time with SSE2, falling back to a scalar loop otherwise.
+
+transform(a, b, c, d, e, f) maps every point (x, y) to the point
+(a*x + b*y + e, c*x + d*y + f) in one pass. translate(), scale(), and
+the rotations are special cases of it, and a composition of any of them
+is also of that form. dist(p, res) stores the distance from each point
+to p in res[]. cross(a, b, res) stores cross(b - a, q - a) for each point
+q in res[], and orientation(a, b, res) stores its sign with epsilon
+comparisons (1 if q is left of the directed line from a to b, -1 if it
+is right of it, and 0 if the three points are collinear).
+bounding_box(lo, hi) sets lo and hi to the lower-left and upper-right
+corners of the smallest axis-aligned box containing every point.
+
+All operations are O(n) in time on the number of points, and O(1) in
+auxiliary space.
+
+*/
+
+struct point_batch {
+
+  std::vector<double> x, y;
+
+  point_batch() {}
+
+  template<class It> point_batch(It lo, It hi) {
+    for (; lo != hi; ++lo) push_back(*lo);
+  }
+
+  int size() const { return x.size(); }
+  point operator [] (int i) const { return point(x[i], y[i]); }
+
+  void push_back(const point & p) {
+    x.push_back(p.x);
+    y.push_back(p.y);
+  }
+
+  void transform(double a, double b, double c, double d, double e, double f) {
+    int n = size(), i = 0;
+    if (n == 0) return;
+    double * px = &x[0], * py = &y[0];
+#ifdef __SSE2__
+    __m128d A = _mm_set1_pd(a), B = _mm_set1_pd(b), C = _mm_set1_pd(c);
+    __m128d D = _mm_set1_pd(d), E = _mm_set1_pd(e), F = _mm_set1_pd(f);
+    for (; i + 2 <= n; i += 2) {
+      __m128d u = _mm_loadu_pd(px + i), v = _mm_loadu_pd(py + i);
+      __m128d s = _mm_add_pd(_mm_mul_pd(A, u), _mm_mul_pd(B, v));
+      __m128d t = _mm_add_pd(_mm_mul_pd(C, u), _mm_mul_pd(D, v));
+      _mm_storeu_pd(px + i, _mm_add_pd(s, E));
+      _mm_storeu_pd(py + i, _mm_add_pd(t, F));
+    }
+#endif
+    for (; i < n; i++) {
+      double u = px[i], v = py[i];
+      px[i] = a * u + b * v + e;
+      py[i] = c * u + d * v + f;
+    }
+  }
+
+  void translate(const point & p) { transform(1, 0, 0, 1, p.x, p.y); }
+  void scale(const double & v) { transform(v, 0, 0, v, 0, 0); }
+
+  //rotate t radians CCW about origin
+  void rotateCCW(const double & t) {
+    transform(cos(t), -sin(t), sin(t), cos(t), 0, 0);
+  }
+
+  //rotate t radians CW about origin
+  void rotateCW(const double & t) { rotateCCW(-t); }
+
+  //rotate t radians CCW about point p
+  void rotateCCW(const point & p, const double & t) {
+    double c = cos(t), s = sin(t);
+    transform(c, -s, s, c, p.x - (c * p.x - s * p.y),
+              p.y - (s * p.x + c * p.y));
+  }
+
+  //rotate t radians CW about point p
+  void rotateCW(const point & p, const double & t) { rotateCCW(p, -t); }
+
+  void dist(const point & p, double res[]) const {
+    int n = size(), i = 0;
+    if (n == 0) return;
+    const double * px = &x[0], * py = &y[0];
+#ifdef __SSE2__
+    __m128d X = _mm_set1_pd(p.x), Y = _mm_set1_pd(p.y);
+    for (; i + 2 <= n; i += 2) {
+      __m128d dx = _mm_sub_pd(_mm_loadu_pd(px + i), X);
+      __m128d dy = _mm_sub_pd(_mm_loadu_pd(py + i), Y);
+      __m128d d2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+      _mm_storeu_pd(res + i, _mm_sqrt_pd(d2));
+    }
+#endif
+    for (; i < n; i++) {
+      double dx = px[i] - p.x, dy = py[i] - p.y;
+      res[i] = sqrt(dx * dx + dy * dy);
+    }
+  }
+
+  void cross(const point & a, const point & b, double res[]) const {
+    int n = size(), i = 0;
+    if (n == 0) return;
+    const double * px = &x[0], * py = &y[0];
+    double ux = b.x - a.x, uy = b.y - a.y;
+#ifdef __SSE2__
+    __m128d AX = _mm_set1_pd(a.x), AY = _mm_set1_pd(a.y);
+    __m128d UX = _mm_set1_pd(ux), UY = _mm_set1_pd(uy);
+    for (; i + 2 <= n; i += 2) {
+      __m128d vx = _mm_sub_pd(_mm_loadu_pd(px + i), AX);
+      __m128d vy = _mm_sub_pd(_mm_loadu_pd(py + i), AY);
+      _mm_storeu_pd(res + i, _mm_sub_pd(_mm_mul_pd(UX, vy),
+                                        _mm_mul_pd(UY, vx)));
+    }
+#endif
+    for (; i < n; i++)
+      res[i] = ux * (py[i] - a.y) - uy * (px[i] - a.x);
+  }
+
+  void orientation(const point & a, const point & b, int res[]) const {
+    int n = size(), i = 0;
+    if (n == 0) return;
+    const double * px = &x[0], * py = &y[0];
+    double ux = b.x - a.x, uy = b.y - a.y;
+#ifdef __SSE2__
+    __m128d AX = _mm_set1_pd(a.x), AY = _mm_set1_pd(a.y);
+    __m128d UX = _mm_set1_pd(ux), UY = _mm_set1_pd(uy);
+    __m128d pos = _mm_set1_pd(eps), neg = _mm_set1_pd(-eps);
+    for (; i + 2 <= n; i += 2) {
+      __m128d vx = _mm_sub_pd(_mm_loadu_pd(px + i), AX);
+      __m128d vy = _mm_sub_pd(_mm_loadu_pd(py + i), AY);
+      __m128d c = _mm_sub_pd(_mm_mul_pd(UX, vy), _mm_mul_pd(UY, vx));
+      int l = _mm_movemask_pd(_mm_cmpgt_pd(c, pos));
+      int r = _mm_movemask_pd(_mm_cmplt_pd(c, neg));
+      res[i] = (l & 1) - (r & 1);
+      res[i + 1] = (l >> 1) - (r >> 1);
+    }
+#endif
+    for (; i < n; i++) {
+      double c = ux * (py[i] - a.y) - uy * (px[i] - a.x);
+      res[i] = (c > eps) - (c < -eps);
+    }
+  }
+
+  //requires a nonempty batch
+  void bounding_box(point & lo, point & hi) const {
+    int n = size(), i = 0;
+    const double * px = &x[0], * py = &y[0];
+    lo = hi = point(px[0], py[0]);
+#ifdef __SSE2__
+    if (n >= 2) {
+      __m128d lx = _mm_loadu_pd(px), hx = lx, ly = _mm_loadu_pd(py), hy = ly;
+      for (i = 2; i + 2 <= n; i += 2) {
+        __m128d u = _mm_loadu_pd(px + i), v = _mm_loadu_pd(py + i);
+        lx = _mm_min_pd(lx, u);
+        hx = _mm_max_pd(hx, u);
+        ly = _mm_min_pd(ly, v);
+        hy = _mm_max_pd(hy, v);
+      }
+      double t[8];
+      _mm_storeu_pd(t, lx);
+      _mm_storeu_pd(t + 2, hx);
+      _mm_storeu_pd(t + 4, ly);
+      _mm_storeu_pd(t + 6, hy);
+      lo = point(std::min(t[0], t[1]), std::min(t[4], t[5]));
+      hi = point(std::max(t[2], t[3]), std::max(t[6], t[7]));
+    }
+#endif
+    for (; i < n; i++) {
+      lo.x = std::min(lo.x, px[i]);
+      lo.y = std::min(lo.y, py[i]);
+      hi.x = std::max(hi.x, px[i]);
+      hi.y = std::max(hi.y, py[i]);
+    }
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -148,5 +335,27 @@ int main() {
   assert(pt(1, -10)  == p.rotateCCW(pt(2, 2), PI / 2));
   assert(pt(10, -3)  == p.reflect(pt(0, 0)));
   assert(pt(-10, -3) == p.reflect(pt(-2, 0), pt(5, 0)));
+
+  //the batch operations agree with the ones on each point
+  pt q[] = {pt(-10, 3), pt(1, 1), pt(2.5, -4), pt(0, 7), pt(3, 3)};
+  point_batch b(q, q + 5);
+  double d[5];
+  int o[5];
+  b.dist(pt(1, 1), d);
+  b.orientation(pt(0, 0), pt(1, 1), o);
+  for (int i = 0; i < 5; i++) {
+    assert(EQ(d[i], (q[i] - pt(1, 1)).abs()));
+    assert(o[i] == (LT(0, cross(q[i], pt(1, 1))) ? -1 :
+                    LT(cross(q[i], pt(1, 1)), 0) ? 1 : 0));
+  }
+  assert(o[0] == 1 && o[1] == 0 && o[2] == -1 && o[4] == 0);
+  pt lo, hi;
+  b.bounding_box(lo, hi);
+  assert(lo == pt(-10, -4) && hi == pt(3, 7));
+  b.rotateCW(pt(1, 1), PI / 2);
+  b.translate(pt(1, -2));
+  b.scale(2);
+  for (int i = 0; i < 5; i++)
+    assert(b[i] == (q[i].rotateCW(pt(1, 1), PI / 2) + pt(1, -2)) * 2);
   return 0;
 }
@@ -0,0 +1,239 @@
+/*
+
+The orientation and incircle predicates decide the combinatorial
+structure of hulls, triangulations, and segment arrangements, so a wrong
+sign can produce an invalid result or send an algorithm into a loop.
+Testing cross products against an epsilon (as with the EQ() macros of
+section 5.0) is fast, but gives wrong answers for nearly degenerate
+inputs. The following predicates, after J. R. Shewchuk's "Adaptive
+Precision Floating-Point Arithmetic and Fast Robust Geometric
+Predicates", always return a value with the sign of the exact
+determinant of the input coordinates.
+
+orient2d(a, b, c) is positive if a, b, and c are in counterclockwise
+order, negative if they are in clockwise order, and zero if they are
+collinear. It equals twice the signed area of the triangle abc.
+
+incircle(a, b, c, d) is positive if d lies inside the circle through a,
+b, and c, negative if it lies outside, and zero if the four points are
+cocircular, where a, b, and c must be in counterclockwise order (the
+sign is reversed if they are clockwise).
+
+Each predicate first evaluates its determinant in ordinary floating
+point, along with a bound on the rounding error of that evaluation. If
+the magnitude of the determinant exceeds the bound, its sign is correct
+and it is returned at once, which is the case for nearly all inputs.
+Otherwise, the determinant is recomputed exactly by expansion arithmetic,
+in which a number is represented as a sum of doubles of increasing
+magnitude whose nonzero bits do not overlap. The error-free sums and
+products of doubles (two_sum() and two_product()) make every operation
+on expansions exact, and the largest component of the result has the
+sign of the exact determinant.
+
+Time Complexity: O(1) per call. The exact fallback is from 40 (for
+orient2d) to 300 (for incircle) times slower than the filter, but is
+rarely needed.
+
+Space Complexity: O(1) auxiliary.
+
+Note: The predicates require that double arithmetic rounds to double
+precision with ties to even, as it does with SSE2 (the default on
+x86-64). With x87 extended precision, compile with -mfpmath=sse or
+-ffloat-store. Overflow and underflow of intermediate results are not
+handled.
+
+*/
+
+#include <cmath>   /* fabs() */
+#include <utility> /* std::pair */
+#include <vector>
+
+typedef std::pair<double, double> point;
+#define x first
+#define y second
+
+//a sum of nonoverlapping doubles in order of increasing magnitude
+typedef std::vector<double> expansion;
+
+//half the distance between 1 and the next double, i.e. 2^-53
+const double round_eps = 1.1102230246251565e-16;
+const double ccw_bound = (3 + 16 * round_eps) * round_eps;
+const double icc_bound = (10 + 96 * round_eps) * round_eps;
+
+//s + t = a + b exactly, where s is the rounded sum
+void two_sum(double a, double b, double & s, double & t) {
+  s = a + b;
+  double bv = s - a, av = s - bv;
+  t = (a - av) + (b - bv);
+}
+
+//hi + lo = a exactly, where each half has at most 26 significant bits
+void split(double a, double & hi, double & lo) {
+  double c = 134217729.0 * a; //2^27 + 1
+  hi = c - (c - a);
+  lo = a - hi;
+}
+
+//p + t = a*b exactly, where p is the rounded product
+void two_product(double a, double b, double & p, double & t) {
+  p = a * b;
+  double ahi, alo, bhi, blo;
+  split(a, ahi, alo);
+  split(b, bhi, blo);
+  t = alo * blo - (((p - ahi * bhi) - alo * bhi) - ahi * blo);
+}
+
+//the exact difference a - b
+expansion difference(double a, double b) {
+  expansion e;
+  double s, t;
+  two_sum(a, -b, s, t);
+  if (t != 0) e.push_back(t);
+  if (s != 0) e.push_back(s);
+  return e;
+}
+
+//merges the components by magnitude, then accumulates them in order
+expansion sum(const expansion & e, const expansion & f) {
+  expansion h;
+  int m = e.size(), n = f.size(), i = 0, j = 0;
+  double q = 0, s, t;
+  while (i < m || j < n) {
+    double g = (j == n || (i < m && fabs(e[i]) < fabs(f[j]))) ? e[i++] : f[j++];
+    two_sum(q, g, s, t);
+    if (t != 0) h.push_back(t);
+    q = s;
+  }
+  if (q != 0) h.push_back(q);
+  return h;
+}
+
+expansion scale(const expansion & e, double b) {
+  expansion h;
+  double q = 0, p, pt, s, t;
+  for (int i = 0; i < (int)e.size(); i++) {
+    two_product(e[i], b, p, pt);
+    two_sum(q, pt, s, t);
+    if (t != 0) h.push_back(t);
+    two_sum(p, s, q, t);
+    if (t != 0) h.push_back(t);
+  }
+  if (q != 0) h.push_back(q);
+  return h;
+}
+
+expansion product(const expansion & e, const expansion & f) {
+  expansion h;
+  for (int i = 0; i < (int)f.size(); i++) h = sum(h, scale(e, f[i]));
+  return h;
+}
+
+expansion negate(expansion e) {
+  for (int i = 0; i < (int)e.size(); i++) e[i] = -e[i];
+  return e;
+}
+
+//an approximation of the value of e with the same sign
+double estimate(const expansion & e) {
+  return e.empty() ? 0 : e.back();
+}
+
+double orient2d_exact(double ax, double ay, double bx, double by,
+                      double cx, double cy) {
+  expansion l = product(difference(ax, cx), difference(by, cy));
+  expansion r = product(difference(ay, cy), difference(bx, cx));
+  return estimate(sum(l, negate(r)));
+}
+
+double orient2d(double ax, double ay, double bx, double by,
+                double cx, double cy) {
+  double l = (ax - cx) * (by - cy), r = (ay - cy) * (bx - cx);
+  double det = l - r, bound = ccw_bound * (fabs(l) + fabs(r));
+  if (det > bound || -det > bound) return det;
+  return orient2d_exact(ax, ay, bx, by, cx, cy);
+}
+
+double incircle_exact(double ax, double ay, double bx, double by,
+                      double cx, double cy, double dx, double dy) {
+  expansion adx = difference(ax, dx), ady = difference(ay, dy);
+  expansion bdx = difference(bx, dx), bdy = difference(by, dy);
+  expansion cdx = difference(cx, dx), cdy = difference(cy, dy);
+  expansion alift = sum(product(adx, adx), product(ady, ady));
+  expansion blift = sum(product(bdx, bdx), product(bdy, bdy));
+  expansion clift = sum(product(cdx, cdx), product(cdy, cdy));
+  expansion bc = sum(product(bdx, cdy), negate(product(cdx, bdy)));
+  expansion ca = sum(product(cdx, ady), negate(product(adx, cdy)));
+  expansion ab = sum(product(adx, bdy), negate(product(bdx, ady)));
+  expansion det = sum(sum(product(alift, bc), product(blift, ca)),
+                      product(clift, ab));
+  return estimate(det);
+}
+
+double incircle(double ax, double ay, double bx, double by,
+                double cx, double cy, double dx, double dy) {
+  double adx = ax - dx, ady = ay - dy, bdx = bx - dx, bdy = by - dy;
+  double cdx = cx - dx, cdy = cy - dy;
+  double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+  double cdxady = cdx * ady, adxcdy = adx * cdy;
+  double adxbdy = adx * bdy, bdxady = bdx * ady;
+  double alift = adx * adx + ady * ady;
+  double blift = bdx * bdx + bdy * bdy;
+  double clift = cdx * cdx + cdy * cdy;
+  double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) +
+               clift * (adxbdy - bdxady);
+  double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * alift +
+                     (fabs(cdxady) + fabs(adxcdy)) * blift +
+                     (fabs(adxbdy) + fabs(bdxady)) * clift;
+  double bound = icc_bound * permanent;
+  if (det > bound || -det > bound) return det;
+  return incircle_exact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+double orient2d(const point & a, const point & b, const point & c) {
+  return orient2d(a.x, a.y, b.x, b.y, c.x, c.y);
+}
+
+double incircle(const point & a, const point & b,
+                const point & c, const point & d) {
+  return incircle(a.x, a.y, b.x, b.y, c.x, c.y, d.x, d.y);
+}
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+double cross(const point & o, const point & a, const point & b) {
+  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+int sign(double v) { return (v > 0) - (v < 0); }
+
+int main() {
+  //points on a 64 by 64 grid of adjacent doubles around (0.5, 0.5),
+  //tested against the line y = x through (12, 12) and (24, 24)
+  point a(12, 12), b(24, 24);
+  int wrong = 0;
+  for (int i = 0; i < 64; i++) {
+    for (int j = 0; j < 64; j++) {
+      point c(0.5 + i * 1.1102230246251565e-16,
+              0.5 + j * 1.1102230246251565e-16);
+      assert(sign(orient2d(a, b, c)) == sign(j - i));
+      assert(sign(orient2d(c, a, b)) == sign(j - i));
+      wrong += sign(cross(a, b, c)) != sign(j - i);
+    }
+  }
+  cout << "naive cross products with the wrong sign: " << wrong << "\n";
+  assert(wrong > 0);
+
+  //the unit circle through three counterclockwise points
+  point p(1, 0), q(0, 1), r(-1, 0);
+  assert(incircle(p, q, r, point(0, -1)) == 0);
+  assert(incircle(p, q, r, point(0, -(1 - 1.1102230246251565e-16))) > 0);
+  assert(incircle(p, q, r, point(0, -(1 + 2.2204460492503131e-16))) < 0);
+  assert(incircle(r, q, p, point(0, 0)) < 0); //clockwise reverses the sign
+  assert(orient2d(p, q, r) > 0 && orient2d(p, r, q) < 0);
+  assert(orient2d(p, q, point(0.5, 0.5)) == 0);
+  return 0;
+}
@@ -0,0 +1,266 @@
+/*
+
+The geometry of sections 5.1.1 to 5.1.3 uses double coordinates with
+epsilon comparisons. The following point, line, and circle templates
+take the type of their coordinates as a parameter instead, along with
+the core routines built on them: orientation, segment intersection,
+point in polygon, convex hull, and polygon area. For integer types,
+all of them are exact and have no epsilons, while float gives the most
+throughput when precision matters less, such as for rendering.
+
+coord_traits<T> gives the type wide in which products of two
+coordinates are computed, and sign(), which is exact for an integer
+type and tests against eps for a floating point type. Coordinates of
+type int are multiplied in long long, and those of type long long in
+__int128 where the compiler supports it. Differences are taken in the
+wide type before they are multiplied, so that every cross product and
+squared distance is exact if the absolute values of the coordinates
+are less than 2^30 for int, or 2^62 for long long (for circles, radii
+are bounded likewise).
+
+Time Complexity: O(1) per operation, except O(n) for point_in_polygon()
+and polygon_area2(), and O(n log n) for convex_hull(), on the number of
+points given.
+
+Space Complexity: O(1) auxiliary, except O(n) for convex_hull().
+
+*/
+
+#include <algorithm> /* std::max(), std::min(), std::sort() */
+#include <iterator>  /* std::iterator_traits */
+#include <vector>
+
+const double eps = 1e-9;
+
+template<class T> struct coord_traits {
+  typedef T wide;
+  static int sign(const wide & v) { return (v > eps) - (v < -eps); }
+};
+
+template<> struct coord_traits<int> {
+  typedef long long wide;
+  static int sign(const wide & v) { return (v > 0) - (v < 0); }
+};
+
+#ifdef __SIZEOF_INT128__
+template<> struct coord_traits<long long> {
+  typedef __int128 wide;
+  static int sign(const wide & v) { return (v > 0) - (v < 0); }
+};
+#endif
+
+//the sign of a - b
+template<class T> int compare(const T & a, const T & b) {
+  typedef typename coord_traits<T>::wide W;
+  return coord_traits<T>::sign((W)a - (W)b);
+}
+
+template<class T> struct basic_point {
+  typedef T coord;
+  T x, y;
+
+  basic_point() : x(0), y(0) {}
+  basic_point(const T & x, const T & y) : x(x), y(y) {}
+
+  bool operator < (const basic_point & p) const {
+    int c = compare(x, p.x);
+    return c != 0 ? c < 0 : compare(y, p.y) < 0;
+  }
+
+  bool operator == (const basic_point & p) const {
+    return compare(x, p.x) == 0 && compare(y, p.y) == 0;
+  }
+
+  bool operator != (const basic_point & p) const { return !(*this == p); }
+
+  basic_point operator + (const basic_point & p) const {
+    return basic_point(x + p.x, y + p.y);
+  }
+
+  basic_point operator - (const basic_point & p) const {
+    return basic_point(x - p.x, y - p.y);
+  }
+};
+
+//the cross product of b - a and c - a, twice the signed area of abc
+template<class T> typename coord_traits<T>::wide
+cross(const basic_point<T> & a, const basic_point<T> & b,
+      const basic_point<T> & c) {
+  typedef typename coord_traits<T>::wide W;
+  return ((W)b.x - a.x) * ((W)c.y - a.y) - ((W)b.y - a.y) * ((W)c.x - a.x);
+}
+
+//the dot product of b - a and c - a
+template<class T> typename coord_traits<T>::wide
+dot(const basic_point<T> & a, const basic_point<T> & b,
+    const basic_point<T> & c) {
+  typedef typename coord_traits<T>::wide W;
+  return ((W)b.x - a.x) * ((W)c.x - a.x) + ((W)b.y - a.y) * ((W)c.y - a.y);
+}
+
+//1 if c is left of the directed line from a to b, -1 if right, else 0
+template<class T>
+int orientation(const basic_point<T> & a, const basic_point<T> & b,
+                const basic_point<T> & c) {
+  return coord_traits<T>::sign(cross(a, b, c));
+}
+
+template<class T> struct basic_line {
+  basic_point<T> p, q; //two distinct points on the line
+
+  basic_line() {}
+  basic_line(const basic_point<T> & p, const basic_point<T> & q)
+      : p(p), q(q) {}
+
+  //1 if r is left of the line directed from p to q, -1 if right, else 0
+  int side(const basic_point<T> & r) const { return orientation(p, q, r); }
+
+  bool parallel(const basic_line & l) const {
+    return orientation(basic_point<T>(), q - p, l.q - l.p) == 0;
+  }
+
+  //the intersection of this line with nonparallel line l
+  template<class F> basic_point<F> intersection(const basic_line & l) const {
+    F a = (F)cross(l.p, l.q, p), b = (F)cross(l.p, l.q, q);
+    F t = a / (a - b);
+    return basic_point<F>(p.x + t * ((F)q.x - p.x), p.y + t * ((F)q.y - p.y));
+  }
+};
+
+//whether p lies on the closed segment ab
+template<class T>
+bool on_segment(const basic_point<T> & p, const basic_point<T> & a,
+                const basic_point<T> & b) {
+  return orientation(a, b, p) == 0 &&
+         compare(std::min(a.x, b.x), p.x) <= 0 &&
+         compare(p.x, std::max(a.x, b.x)) <= 0 &&
+         compare(std::min(a.y, b.y), p.y) <= 0 &&
+         compare(p.y, std::max(a.y, b.y)) <= 0;
+}
+
+//whether the closed segments ab and cd share a point
+template<class T>
+bool segments_intersect(const basic_point<T> & a, const basic_point<T> & b,
+                        const basic_point<T> & c, const basic_point<T> & d) {
+  int o1 = orientation(a, b, c), o2 = orientation(a, b, d);
+  int o3 = orientation(c, d, a), o4 = orientation(c, d, b);
+  if (o1 * o2 < 0 && o3 * o4 < 0) return true;
+  return on_segment(c, a, b) || on_segment(d, a, b) ||
+         on_segment(a, c, d) || on_segment(b, c, d);
+}
+
+//1 if p is strictly inside the polygon given by the range of vertices,
+//0 if it is on its boundary, or -1 if it is strictly outside
+template<class It, class T>
+int point_in_polygon(const basic_point<T> & p, It lo, It hi) {
+  bool inside = false;
+  for (It i = lo, j = hi - 1; i != hi; j = i++) {
+    if (on_segment(p, *j, *i)) return 0;
+    bool up = compare(j->y, p.y) <= 0 && compare(p.y, i->y) < 0;
+    bool down = compare(i->y, p.y) <= 0 && compare(p.y, j->y) < 0;
+    int o = orientation(*j, *i, p);
+    if ((up && o > 0) || (down && o < 0)) inside = !inside;
+  }
+  return inside ? 1 : -1;
+}
+
+//twice the signed area of the polygon, positive if it is counterclockwise
+template<class It> typename coord_traits<
+    typename std::iterator_traits<It>::value_type::coord>::wide
+polygon_area2(It lo, It hi) {
+  typename coord_traits<
+      typename std::iterator_traits<It>::value_type::coord>::wide res = 0;
+  if (lo == hi) return res;
+  for (It i = lo + 1; i + 1 < hi; ++i) res += cross(*lo, *i, *(i + 1));
+  return res;
+}
+
+//the vertices of the convex hull in counterclockwise order, without
+//collinear points, by the monotone chain algorithm
+template<class It> std::vector<typename std::iterator_traits<It>::value_type>
+convex_hull(It lo, It hi) {
+  typedef typename std::iterator_traits<It>::value_type P;
+  std::vector<P> p(lo, hi), res;
+  std::sort(p.begin(), p.end());
+  p.erase(std::unique(p.begin(), p.end()), p.end());
+  int n = p.size(), k = 0;
+  if (n < 3) return p;
+  res.resize(2 * n);
+  for (int i = 0; i < n; i++) {
+    while (k >= 2 && orientation(res[k - 2], res[k - 1], p[i]) <= 0) k--;
+    res[k++] = p[i];
+  }
+  for (int i = n - 2, t = k + 1; i >= 0; i--) {
+    while (k >= t && orientation(res[k - 2], res[k - 1], p[i]) <= 0) k--;
+    res[k++] = p[i];
+  }
+  res.resize(k - 1);
+  return res;
+}
+
+template<class T> struct basic_circle {
+  basic_point<T> c;
+  T r;
+
+  basic_circle(const basic_point<T> & c, const T & r) : c(c), r(r) {}
+
+  //1 if p is strictly inside, 0 if it is on the edge, or else -1
+  int locate(const basic_point<T> & p) const {
+    typedef typename coord_traits<T>::wide W;
+    W d = dot(c, p, p);
+    return coord_traits<T>::sign((W)r * r - d);
+  }
+
+  bool contains(const basic_point<T> & p) const { return locate(p) >= 0; }
+  bool on_edge(const basic_point<T> & p) const { return locate(p) == 0; }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+typedef basic_point<long long> ipoint;
+typedef basic_point<double> dpoint;
+
+int main() {
+  //b - a and c - a are nearly parallel: their cross product is 1, far
+  //below the rounding error of the double products of about 1e31
+  ipoint a(0, 0), b(3000000000000001LL, 3000000000000000LL);
+  ipoint c(6000000000000003LL, 6000000000000001LL);
+  assert(cross(a, b, c) == 1 && orientation(a, b, c) == 1);
+  dpoint da(0, 0), db(b.x, b.y), dc(c.x, c.y);
+  cout << "double cross product: " << (double)cross(da, db, dc) << "\n";
+
+  //a square with a point on its boundary
+  vector<basic_point<int> > sq;
+  sq.push_back(basic_point<int>(0, 0));
+  sq.push_back(basic_point<int>(4, 0));
+  sq.push_back(basic_point<int>(4, 4));
+  sq.push_back(basic_point<int>(2, 2));
+  sq.push_back(basic_point<int>(0, 4));
+  sq.push_back(basic_point<int>(2, 4));
+  vector<basic_point<int> > h = convex_hull(sq.begin(), sq.end());
+  assert(h.size() == 4 && polygon_area2(h.begin(), h.end()) == 32);
+  assert(point_in_polygon(basic_point<int>(1, 1), h.begin(), h.end()) == 1);
+  assert(point_in_polygon(basic_point<int>(4, 2), h.begin(), h.end()) == 0);
+  assert(point_in_polygon(basic_point<int>(5, 2), h.begin(), h.end()) == -1);
+  assert(segments_intersect(h[0], h[2], h[1], h[3]));
+
+  basic_line<int> l1(basic_point<int>(0, 0), basic_point<int>(2, 2));
+  basic_line<int> l2(basic_point<int>(0, 2), basic_point<int>(2, 0));
+  assert(!l1.parallel(l2) && l1.side(basic_point<int>(0, 1)) == 1);
+  basic_point<double> p = l1.intersection<double>(l2);
+  assert(p.x == 1 && p.y == 1);
+
+  basic_circle<int> circ(basic_point<int>(1, 1), 5);
+  assert(circ.on_edge(basic_point<int>(4, 5)));
+  assert(circ.contains(basic_point<int>(4, 4)));
+  assert(!circ.contains(basic_point<int>(5, 5)));
+
+  //float coordinates, with epsilon comparisons
+  basic_point<float> f1(0, 0), f2(1, 0), f3(0.5f, 1);
+  assert(orientation(f1, f2, f3) == 1);
+  return 0;
+}
@@ -0,0 +1,277 @@
+/*
+
+Given a range of circles, determine which pairs of them intersect, the
+area of their union, and whether points lie inside or on the boundary
+of their union, in batch rather than one pair at a time as in section
+5.2.4.
+
+The circles are bucketed by the cells of a uniform grid covering their
+bounding boxes, with about as many cells as circles, as for segments in
+section 5.3.7. For each cell, the centers and radii of its circles are
+kept in their own arrays in the order of the cell, so that testing a
+point against all of them is a branch-free loop over contiguous memory
+which compilers can vectorize. An intersecting pair is reported only
+from the cell holding the lower left corner of the overlap of their
+bounding boxes, so that each pair is found once.
+
+The union area is found by Green's theorem: the area enclosed by a
+curve is the integral of (x dy - y dx)/2 along it, counterclockwise,
+and the boundary of the union consists of the arcs of the circles that
+are not covered by any other circle. The arc of a circle covered by
+another one that crosses it is an interval of angles around its center,
+and merging the intervals from all of its neighbors in the grid leaves
+the uncovered arcs, each of which contributes a closed form term. A
+circle inside another one, or equal to an earlier one, contributes
+nothing.
+
+Time Complexity: O(n + m) to build the grid on n circles, where m is
+the total number of cells covered by their bounding boxes. O(c) for
+contains() and on_edge(), where c is the number of circles in the cell
+of the point. O(m + p log p) for union_area(), and O(m + p) for
+intersecting_pairs(), where p is the number of pairs of circles which
+share a cell.
+
+Space Complexity: O(n + m) for the grid.
+
+*/
+
+#include <algorithm> /* std::min(), std::max(), std::sort() */
+#include <cmath>     /* acos(), atan2(), cos(), fabs(), sin(), sqrt() */
+#include <utility>   /* std::pair */
+#include <vector>
+
+const double eps = 1e-9;
+
+#define EQ(a, b) (fabs((a) - (b)) <= eps) /* equal to */
+#define LT(a, b) ((a) < (b) - eps)        /* less than */
+#define LE(a, b) ((a) <= (b) + eps)       /* less than or equal to */
+
+const double PI = acos(-1.0);
+
+typedef std::pair<double, double> point;
+#define x first
+#define y second
+
+struct circle {
+  double h, k, r;
+
+  circle(const double & h, const double & k, const double & r) {
+    this->h = h;
+    this->k = k;
+    this->r = r;
+  }
+};
+
+class circle_set {
+  std::vector<circle> c;
+  double lx, ly, inv;
+  int w, h;
+  std::vector<int> start, list; //the circles of each cell, by rows
+  std::vector<double> ch, ck, cr; //the same circles, in the same order
+  std::vector<int> seen;
+
+  int cell_x(double v) const {
+    return std::max(0, std::min((int)((v - lx) * inv), w - 1));
+  }
+
+  int cell_y(double v) const {
+    return std::max(0, std::min((int)((v - ly) * inv), h - 1));
+  }
+
+  //the cell of p, or -1 if p is outside of the grid
+  int cell(const point & p) const {
+    double u = (p.x - lx) * inv, v = (p.y - ly) * inv;
+    if (!(u >= 0 && v >= 0 && u <= w && v <= h)) return -1;
+    return cell_y(p.y) * w + cell_x(p.x);
+  }
+
+  //the circles which share a cell with circle i, other than itself
+  void neighbors(int i, int stamp, std::vector<int> & res) {
+    res.clear();
+    seen[i] = stamp;
+    for (int v = cell_y(c[i].k - c[i].r); v <= cell_y(c[i].k + c[i].r); v++) {
+      for (int u = cell_x(c[i].h - c[i].r); u <= cell_x(c[i].h + c[i].r);
+           u++) {
+        for (int q = start[v * w + u]; q < start[v * w + u + 1]; q++) {
+          if (seen[list[q]] != stamp) {
+            seen[list[q]] = stamp;
+            res.push_back(list[q]);
+          }
+        }
+      }
+    }
+  }
+
+ public:
+  template<class It> circle_set(It lo, It hi) : c(lo, hi) {
+    int n = c.size();
+    double hx = 0, hy = 0;
+    lx = ly = 0;
+    for (int i = 0; i < n; i++) {
+      lx = (i == 0) ? c[i].h - c[i].r : std::min(lx, c[i].h - c[i].r);
+      ly = (i == 0) ? c[i].k - c[i].r : std::min(ly, c[i].k - c[i].r);
+      hx = (i == 0) ? c[i].h + c[i].r : std::max(hx, c[i].h + c[i].r);
+      hy = (i == 0) ? c[i].k + c[i].r : std::max(hy, c[i].k + c[i].r);
+    }
+    //about one cell per circle, and at most n along either side
+    double side = std::max(sqrt((hx - lx) * (hy - ly) / std::max(n, 1)),
+                           std::max(hx - lx, hy - ly) / std::max(n, 1));
+    inv = side > 0 ? 1 / side : 1;
+    w = std::min((int)((hx - lx) * inv), n) + 1;
+    h = std::min((int)((hy - ly) * inv), n) + 1;
+    start.assign(w * h + 1, 0);
+    for (int pass = 0; pass < 2; pass++) {
+      for (int i = 0; i < n; i++) {
+        int v0 = cell_y(c[i].k - c[i].r), v1 = cell_y(c[i].k + c[i].r);
+        int u0 = cell_x(c[i].h - c[i].r), u1 = cell_x(c[i].h + c[i].r);
+        for (int v = v0; v <= v1; v++) {
+          for (int u = u0; u <= u1; u++) {
+            if (pass == 0) start[v * w + u + 1]++;
+            else list[start[v * w + u]++] = i;
+          }
+        }
+      }
+      if (pass == 0) {
+        for (int i = 0; i < w * h; i++) start[i + 1] += start[i];
+        list.resize(start[w * h]);
+      } else { //each start[i] has advanced to where cell i + 1 begins
+        for (int i = w * h; i > 0; i--) start[i] = start[i - 1];
+        start[0] = 0;
+      }
+    }
+    for (int q = 0; q < (int)list.size(); q++) {
+      ch.push_back(c[list[q]].h);
+      ck.push_back(c[list[q]].k);
+      cr.push_back(c[list[q]].r * c[list[q]].r);
+    }
+    seen.assign(n, -1);
+  }
+
+  //whether p is inside or on the edge of some circle
+  bool contains(const point & p) const {
+    int i = cell(p);
+    if (i < 0) return false;
+    int in = 0;
+    for (int q = start[i]; q < start[i + 1]; q++) {
+      double dx = p.x - ch[q], dy = p.y - ck[q];
+      in |= LE(dx * dx + dy * dy, cr[q]);
+    }
+    return in != 0;
+  }
+
+  //whether p is on the boundary of the union, i.e. on the edge of some
+  //circle and strictly inside none of them
+  bool on_edge(const point & p) const {
+    int i = cell(p);
+    if (i < 0) return false;
+    int edge = 0, inside = 0;
+    for (int q = start[i]; q < start[i + 1]; q++) {
+      double dx = p.x - ch[q], dy = p.y - ck[q], d = dx * dx + dy * dy;
+      edge |= EQ(d, cr[q]);
+      inside |= LT(d, cr[q]);
+    }
+    return edge != 0 && inside == 0;
+  }
+
+  //the pairs (i, j) with i < j of circles whose disks share a point
+  std::vector<std::pair<int, int> > intersecting_pairs() const {
+    std::vector<std::pair<int, int> > res;
+    for (int i = 0; i < w * h; i++) {
+      for (int q = start[i]; q < start[i + 1]; q++) {
+        for (int s = q + 1; s < start[i + 1]; s++) {
+          const circle & a = c[list[q]], & b = c[list[s]];
+          //the lower left corner of the overlap of their bounding boxes
+          double ox = std::max(a.h - a.r, b.h - b.r);
+          double oy = std::max(a.k - a.r, b.k - b.r);
+          double dx = a.h - b.h, dy = a.k - b.k;
+          if (cell_y(oy) * w + cell_x(ox) != i ||
+              !LE(sqrt(dx * dx + dy * dy), a.r + b.r))
+            continue;
+          res.push_back(std::make_pair(std::min(list[q], list[s]),
+                                       std::max(list[q], list[s])));
+        }
+      }
+    }
+    return res;
+  }
+
+  double union_area() {
+    double res = 0;
+    std::vector<int> nb;
+    std::vector<std::pair<double, double> > arcs;
+    for (int i = 0; i < (int)c.size(); i++) {
+      const circle & a = c[i];
+      if (a.r <= 0) continue;
+      neighbors(i, i, nb);
+      bool covered = false;
+      arcs.clear();
+      for (int j = 0; j < (int)nb.size() && !covered; j++) {
+        const circle & b = c[nb[j]];
+        double dx = b.h - a.h, dy = b.k - a.k, d = sqrt(dx * dx + dy * dy);
+        if (EQ(d, 0) && EQ(a.r, b.r)) {
+          covered = nb[j] < i;
+        } else if (LE(d, b.r - a.r)) {
+          covered = true;
+        } else if (LT(d, a.r + b.r) && !LE(d, a.r - b.r)) {
+          double mid = atan2(dy, dx);
+          double cs = (a.r * a.r + d * d - b.r * b.r) / (2 * a.r * d);
+          double half = acos(std::max(-1.0, std::min(1.0, cs)));
+          double lo = mid - half, hi = mid + half;
+          if (lo < -PI) {
+            arcs.push_back(std::make_pair(lo + 2 * PI, PI));
+            lo = -PI;
+          }
+          if (hi > PI) {
+            arcs.push_back(std::make_pair(-PI, hi - 2 * PI));
+            hi = PI;
+          }
+          arcs.push_back(std::make_pair(lo, hi));
+        }
+      }
+      if (covered) continue;
+      //integrates over the gaps between the merged covered intervals
+      std::sort(arcs.begin(), arcs.end());
+      arcs.push_back(std::make_pair(PI, PI));
+      double from = -PI;
+      for (int j = 0; j < (int)arcs.size(); j++) {
+        if (arcs[j].first > from) {
+          double to = arcs[j].first;
+          res += a.r * a.r * (to - from) +
+                 a.h * a.r * (sin(to) - sin(from)) -
+                 a.k * a.r * (cos(to) - cos(from));
+        }
+        from = std::max(from, arcs[j].second);
+      }
+    }
+    return res / 2;
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+int main() {
+  //two circles through each other's centers, one inside the first, and
+  //one equal to the second, as well as a separate one
+  vector<circle> v;
+  v.push_back(circle(-1.5, 0, 3));
+  v.push_back(circle(1.5, 0, 3));
+  v.push_back(circle(-2, 0, 1));
+  v.push_back(circle(1.5, 0, 3));
+  v.push_back(circle(20, 0, 1));
+  circle_set s(v.begin(), v.end());
+  double lens = 9 * (2 * PI / 3 - sqrt(3) / 2); //see section 5.2.4
+  double area = s.union_area();
+  cout << "union area: " << area << "\n";
+  assert(EQ(area, 2 * 9 * PI - lens + PI));
+  vector<pair<int, int> > p = s.intersecting_pairs();
+  assert(p.size() == 6); //every pair among the first four
+  assert(s.contains(point(0, 2)) && s.contains(point(20, 1)));
+  assert(!s.contains(point(0, 3)) && !s.contains(point(10, 0)));
+  assert(s.on_edge(point(-4.5, 0)) && s.on_edge(point(20, -1)));
+  assert(!s.on_edge(point(-3, 0)) && !s.on_edge(point(1.5, 0)));
+  return 0;
+}
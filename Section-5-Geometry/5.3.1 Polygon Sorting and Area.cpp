@@ -14,6 +14,15 @@ well be the result of mean_point(). ccw_comp() is the opposite
 function, which produces the points in counterclockwise order.
 Complexity: O(1) per call.
 
+cw_radix_sort() and ccw_radix_sort() - Sort a range of points in the
+same order as sorting with cw_comp() and ccw_comp(), but by a radix sort
+in 4 passes of 16 bits over the bit patterns of their pseudo-angles,
+which are monotonic in the angle around ctr, but cheaper than atan2().
+A final insertion sort by cw_comp() orders the points on the same ray
+from ctr, and any whose pseudo-angles differ only by rounding.
+Complexity: O(n) on the number of points in the range, plus O(k^2) for
+each group of k points on the same ray.
+
 polygon_area() - A given range of points is interpreted as a polygon
 based on the ordering they're given in. The shoelace formula is used
 to determine its area. The polygon does not necessarily have to be
@@ -23,11 +32,28 @@ the range equal to the first point and still expect the correct result.
 Complexity: O(n) on the number of points in the range, assuming that
 the points are already sorted in the order that specifies the polygon.
 
+polygon_area(b) computes the same for the vertices of a point_batch
+(see section 5.1.1), which stores their coordinates in separate arrays,
+so that the terms of the shoelace formula are computed two at a time by
+SSE2 where available.
+
+polygon_batch_stats() - Given a polygon_batch holding many polygons in
+one buffer, where polygon k has the vertices at [offset[k], offset[k +
+1]) of its coordinate arrays, computes the area, the centroid of the
+area, and the orientation of each, computing the terms of the shoelace
+formula and of the centroid two at a time by SSE2 where available.
+Complexity: O(n) on the total number of vertices.
+
 */
 
-#include <algorithm> /* std::sort() */
+#include <algorithm> /* std::sort(), std::reverse() */
 #include <cmath>     /* fabs() */
+#include <cstring>   /* memcpy() */
 #include <utility>   /* std::pair */
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h> /* _mm_add_pd(), _mm_mul_pd(), ... */
+#endif
 
 typedef std::pair<double, double> point;
 #define x first
@@ -78,6 +104,63 @@ bool ccw_comp(const point & a, const point & b) {
   return cw_comp(b, a);
 }
 
+//a pseudo-angle increasing clockwise from the ray pointing up from ctr,
+//in [0, 2] for points with x >= ctr.x and in (2, 4) for the others, and
+//2 for ctr itself, which cw_comp() orders after the other points with
+//x >= ctr.x, except for those straight below ctr
+double cw_pseudo_angle(const point & p) {
+  double dx = p.x - ctr.x, dy = p.y - ctr.y, d = fabs(dx) + fabs(dy);
+  if (d == 0) return 2;
+  return GE(dx, 0) ? 1 - dy / d : 3 + dy / d;
+}
+
+//sorts [lo, hi) in the order of cw_comp, with ctr defined beforehand
+template<class It> void cw_radix_sort(It lo, It hi) {
+  int n = hi - lo;
+  std::vector<unsigned long long> key(n), key2(n);
+  std::vector<int> idx(n), idx2(n);
+  for (int i = 0; i < n; i++) {
+    //the bits of a non-negative double compare like the double itself
+    double a = cw_pseudo_angle(lo[i]);
+    memcpy(&key[i], &a, sizeof a);
+    idx[i] = i;
+  }
+  std::vector<int> cnt(1 << 16);
+  for (int shift = 0; shift < 64; shift += 16) {
+    std::fill(cnt.begin(), cnt.end(), 0);
+    for (int i = 0; i < n; i++) cnt[(key[i] >> shift) & 0xffff]++;
+    if (n == 0 || cnt[(key[0] >> shift) & 0xffff] == n) continue;
+    for (int d = 0, sum = 0; d < (1 << 16); d++) {
+      int c = cnt[d];
+      cnt[d] = sum;
+      sum += c;
+    }
+    for (int i = 0; i < n; i++) {
+      int j = cnt[(key[i] >> shift) & 0xffff]++;
+      key2[j] = key[i];
+      idx2[j] = idx[i];
+    }
+    key.swap(key2);
+    idx.swap(idx2);
+  }
+  std::vector<point> res(n);
+  for (int i = 0; i < n; i++) res[i] = lo[idx[i]];
+  //an insertion sort by cw_comp() then only moves points on the same ray
+  //from ctr, or with pseudo-angles equal up to rounding
+  for (int i = 1; i < n; i++) {
+    point p = res[i];
+    int j = i;
+    for (; j > 0 && cw_comp(p, res[j - 1]); j--) res[j] = res[j - 1];
+    res[j] = p;
+  }
+  std::copy(res.begin(), res.end(), lo);
+}
+
+template<class It> void ccw_radix_sort(It lo, It hi) {
+  cw_radix_sort(lo, hi);
+  std::reverse(lo, hi);
+}
+
 //area of a polygon specified by range [lo, hi) - shoelace formula in O(n)
 //[lo, hi) must point to the polygon vertices, sorted in CW or CCW order
 template<class It> double polygon_area(It lo, It hi) {
@@ -90,6 +173,135 @@ template<class It> double polygon_area(It lo, It hi) {
   return fabs(area / 2.0);
 }
 
+//a batch of points stored as separate arrays of coordinates
+struct point_batch {
+  std::vector<double> x, y;
+
+  int size() const { return x.size(); }
+  point operator [] (int i) const { return point(x[i], y[i]); }
+
+  void push_back(const point & p) {
+    x.push_back(p.x);
+    y.push_back(p.y);
+  }
+};
+
+//area of the polygon with the vertices of b in CW or CCW order
+double polygon_area(const point_batch & b) {
+  int n = b.size(), i = 1;
+  if (n == 0) return 0;
+  const double * px = &b.x[0], * py = &b.y[0];
+  //the edge from the last vertex to the first, which is 0 if they're equal
+  double area = (px[0] - px[n - 1]) * (py[0] + py[n - 1]);
+#ifdef __SSE2__
+  __m128d sum = _mm_setzero_pd();
+  for (; i + 2 <= n; i += 2) {
+    __m128d dx = _mm_sub_pd(_mm_loadu_pd(px + i), _mm_loadu_pd(px + i - 1));
+    __m128d sy = _mm_add_pd(_mm_loadu_pd(py + i), _mm_loadu_pd(py + i - 1));
+    sum = _mm_add_pd(sum, _mm_mul_pd(dx, sy));
+  }
+  double s[2];
+  _mm_storeu_pd(s, sum);
+  area += s[0] + s[1];
+#endif
+  for (; i < n; i++)
+    area += (px[i] - px[i - 1]) * (py[i] + py[i - 1]);
+  return fabs(area / 2.0);
+}
+
+//many polygons stored back to back, where the vertices of polygon k are at
+//indices [offset[k], offset[k + 1]) of the coordinate arrays
+struct polygon_batch {
+  std::vector<double> x, y;
+  std::vector<int> offset;
+
+  polygon_batch(): offset(1, 0) {}
+
+  int size() const { return offset.size() - 1; }
+
+  template<class It> void push_back(It lo, It hi) {
+    for (; lo != hi; ++lo) {
+      x.push_back(lo->x);
+      y.push_back(lo->y);
+    }
+    offset.push_back(x.size());
+  }
+};
+
+//the area, the centroid of the area (not the average of the vertices, as
+//from centroid()), and the orientation (1 for CCW, -1 for CW, or 0 if the
+//area is 0, in which case the centroid is the average of the vertices)
+//of every polygon in b
+void polygon_batch_stats(const polygon_batch & b, std::vector<double> & area,
+                         std::vector<point> & centroid,
+                         std::vector<int> & orientation) {
+  int m = b.size();
+  area.resize(m);
+  centroid.resize(m);
+  orientation.resize(m);
+  if (b.x.empty()) {
+    std::fill(area.begin(), area.end(), 0);
+    std::fill(centroid.begin(), centroid.end(), point(0, 0));
+    std::fill(orientation.begin(), orientation.end(), 0);
+    return;
+  }
+  const double * bx = &b.x[0], * by = &b.y[0];
+  for (int k = 0; k < m; k++) {
+    int lo = b.offset[k], n = b.offset[k + 1] - lo, i = 1;
+    if (n == 0) {
+      area[k] = orientation[k] = 0;
+      centroid[k] = point(0, 0);
+      continue;
+    }
+    const double * px = bx + lo, * py = by + lo;
+    //coordinates are taken relative to the first vertex for precision,
+    //so the terms of the shoelace formula are the fan of triangles from it
+    double x0 = px[0], y0 = py[0], a = 0, cx = 0, cy = 0;
+#ifdef __SSE2__
+    __m128d ox = _mm_set1_pd(x0), oy = _mm_set1_pd(y0);
+    __m128d sa = _mm_setzero_pd(), sx = sa, sy = sa;
+    for (; i + 2 < n; i += 2) {
+      __m128d xi = _mm_sub_pd(_mm_loadu_pd(px + i), ox);
+      __m128d yi = _mm_sub_pd(_mm_loadu_pd(py + i), oy);
+      __m128d xj = _mm_sub_pd(_mm_loadu_pd(px + i + 1), ox);
+      __m128d yj = _mm_sub_pd(_mm_loadu_pd(py + i + 1), oy);
+      __m128d c = _mm_sub_pd(_mm_mul_pd(xi, yj), _mm_mul_pd(xj, yi));
+      sa = _mm_add_pd(sa, c);
+      sx = _mm_add_pd(sx, _mm_mul_pd(_mm_add_pd(xi, xj), c));
+      sy = _mm_add_pd(sy, _mm_mul_pd(_mm_add_pd(yi, yj), c));
+    }
+    double s[2];
+    _mm_storeu_pd(s, sa);
+    a = s[0] + s[1];
+    _mm_storeu_pd(s, sx);
+    cx = s[0] + s[1];
+    _mm_storeu_pd(s, sy);
+    cy = s[0] + s[1];
+#endif
+    for (; i + 1 < n; i++) {
+      double xi = px[i] - x0, yi = py[i] - y0;
+      double xj = px[i + 1] - x0, yj = py[i + 1] - y0;
+      double c = xi * yj - xj * yi;
+      a += c;
+      cx += (xi + xj) * c;
+      cy += (yi + yj) * c;
+    }
+    if (EQ(a, 0)) {
+      area[k] = orientation[k] = 0;
+      double tx = 0, ty = 0;
+      for (i = 0; i < n; i++) {
+        tx += px[i];
+        ty += py[i];
+      }
+      centroid[k] = point(tx / n, ty / n);
+    } else {
+      area[k] = fabs(a) / 2;
+      orientation[k] = (a > 0) ? 1 : -1;
+      centroid[k] = point(x0 + cx / (3 * a), y0 + cy / (3 * a));
+    }
+  }
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -109,5 +321,27 @@ int main() {
   sort(v.begin(), v.end(), cw_comp);
   for (int i = 0; i < (int)v.size(); i++) assert(v[i] == pts[i]);
   assert(EQ(polygon_area(v.begin(), v.end()), 5));
+  point_batch b;
+  for (int i = 0; i < (int)v.size(); i++) b.push_back(v[i]);
+  assert(EQ(polygon_area(b), 5));
+  b.push_back(v[0]); //the first vertex repeated as the last
+  assert(EQ(polygon_area(b), 5));
+
+  std::random_shuffle(v.begin(), v.end());
+  cw_radix_sort(v.begin(), v.end());
+  for (int i = 0; i < (int)v.size(); i++) assert(v[i] == pts[i]);
+  ccw_radix_sort(v.begin(), v.end());
+  for (int i = 0; i < (int)v.size(); i++) assert(v[i] == pts[4 - i]);
+
+  polygon_batch pb;
+  pt square[] = {pt(0, 0), pt(2, 0), pt(2, 2), pt(0, 2)};
+  pb.push_back(square, square + 4);    //ccw
+  pb.push_back(v.rbegin(), v.rend());  //cw
+  vector<double> area;
+  vector<point> c;
+  vector<int> orientation;
+  polygon_batch_stats(pb, area, c, orientation);
+  assert(EQ(area[0], 4) && EQ(c[0].x, 1) && EQ(c[0].y, 1));
+  assert(EQ(area[1], 5) && orientation[0] == 1 && orientation[1] == -1);
   return 0;
 }
@@ -8,11 +8,45 @@ the polygon to be inside it.
 
 Complexity: O(n) on the number of vertices in the polygon.
 
+point_in_polygon(q, lo, hi, res) answers the query for every point of
+the point_batch q (see section 5.1.1), which stores their coordinates in
+separate arrays, setting res[i] to whether q[i] is within the polygon.
+It sorts the query points by y once, and each edge of the polygon then
+updates the crossing count and the edge flag of only the points within
+its range of y-coordinates (up to eps), which are contiguous in sorted
+order and found by binary search.
+Complexity: O((n + m) log m + k) for m query points, where k is the
+number of pairs of an edge and a point in its range of y-coordinates,
+and is often far less than the O(nm) of m separate queries. For small
+polygons, the sort dominates and separate queries may be faster.
+
+polygon_index preprocesses a fixed polygon for many queries. If the
+polygon is convex, its vertices are stored in CCW order, and a query
+binary searches for the triangle of the fan from the first vertex that
+contains the point, in O(log n). Otherwise, the plane is cut into slabs
+by horizontal lines through the vertices. No two edges of a simple
+polygon cross inside a slab, so the edges spanning each slab are stored
+in order of x, and a query binary searches for its slab by y, then for
+the number of edges to its left, whose parity is the answer. A point
+within eps of the height of a vertex uses the slab above it, which
+realizes the same half-open rule for edges as point_in_polygon(), after
+first checking the vertices and horizontal edges at that height.
+contains(q, res) answers a point_batch of queries, which are
+independent of each other.
+Complexity: O(n log n) to build a convex index and O(n log n + k log k)
+for slabs, with k the total number of edges over all slabs, which is
+O(n^2) in the worst case but far smaller for most polygons (e.g. O(n) if
+any horizontal line meets few edges). Either kind answers a query in
+O(log n). Both agree with point_in_polygon(), except possibly for
+points within eps of an edge, and within eps of the height of a vertex.
+
 */
 
-#include <algorithm> /* std::sort() */
+#include <algorithm> /* std::lower_bound(), std::sort(), ... */
+#include <cfloat>    /* DBL_MAX */
 #include <cmath>     /* fabs() */
 #include <utility>   /* std::pair */
+#include <vector>
 
 typedef std::pair<double, double> point;
 #define x first
@@ -21,6 +55,7 @@ typedef std::pair<double, double> point;
 const double eps = 1e-9;
 
 #define EQ(a, b) (fabs((a) - (b)) <= eps) /* equal to */
+#define LT(a, b) ((a) < (b) - eps)        /* less than */
 #define GT(a, b) ((a) > (b) + eps)        /* greater than */
 #define LE(a, b) ((a) <= (b) + eps)       /* less than or equal to */
 
@@ -40,7 +75,7 @@ template<class It> bool point_in_polygon(const point & p, It lo, It hi) {
   int cnt = 0;
   for (It i = lo, j = hi - 1; i != hi; j = i++) {
     if (EQ(i->y, p.y) && (EQ(i->x, p.x) ||
-                         (EQ(j->y, p.y) && (LE(i->x, p.x) || LE(j->x, p.x)))))
+                         (EQ(j->y, p.y) && (LE(i->x, p.x) != LE(j->x, p.x)))))
       return EDGE_IS_INSIDE; //on an edge
     if (GT(i->y, p.y) != GT(j->y, p.y)) {
       double det = cross(p, *i, *j);
@@ -51,6 +86,249 @@ template<class It> bool point_in_polygon(const point & p, It lo, It hi) {
   return cnt % 2 == 1;
 }
 
+//a batch of points stored as separate arrays of coordinates
+struct point_batch {
+  std::vector<double> x, y;
+
+  int size() const { return x.size(); }
+  point operator [] (int i) const { return point(x[i], y[i]); }
+
+  void push_back(const point & p) {
+    x.push_back(p.x);
+    y.push_back(p.y);
+  }
+};
+
+//sets res[i] to whether point q[i] is in the polygon specified by [lo, hi)
+template<class It>
+void point_in_polygon(const point_batch & q, It lo, It hi, bool res[]) {
+  int m = q.size();
+  std::vector<std::pair<double, int> > order(m);
+  for (int k = 0; k < m; k++) order[k] = std::make_pair(q.y[k], k);
+  std::sort(order.begin(), order.end());
+  std::vector<double> px(m), py(m);
+  for (int k = 0; k < m; k++) {
+    px[k] = q.x[order[k].second];
+    py[k] = order[k].first;
+  }
+  //bit 0 of flags[k] is the parity of the crossings, bit 1 the edge flag
+  std::vector<unsigned char> flags(m, 0);
+  for (It i = lo, j = hi - 1; i != hi; j = i++) {
+    double ix = i->x, iy = i->y, jx = j->x, jy = j->y;
+    bool down = GT(jy, iy);
+    int a = std::lower_bound(py.begin(), py.end(), std::min(iy, jy) - eps) -
+            py.begin();
+    int b = std::upper_bound(py.begin(), py.end(), std::max(iy, jy) + eps) -
+            py.begin();
+    for (int k = a; k < b; k++) {
+      double x = px[k], y = py[k];
+      if (EQ(iy, y) && (EQ(ix, x) || (EQ(jy, y) && (LE(ix, x) != LE(jx, x)))))
+        flags[k] |= 2; //on an edge
+      if (GT(iy, y) != GT(jy, y)) {
+        double det = (ix - x) * (jy - y) - (iy - y) * (jx - x);
+        if (EQ(det, 0)) flags[k] |= 2; //on an edge
+        if (GT(det, 0) != down) flags[k] ^= 1;
+      }
+    }
+  }
+  for (int k = 0; k < m; k++)
+    res[order[k].second] = (flags[k] & 2) ? EDGE_IS_INSIDE : (flags[k] & 1);
+}
+
+//an edge from its lower endpoint a to its upper endpoint b
+struct slab_edge {
+  point a, b;
+
+  slab_edge(const point & a, const point & b): a(a), b(b) {}
+};
+
+//compares edges spanning the same slab by their x at height ym
+struct slab_less {
+  double ym;
+
+  slab_less(double ym): ym(ym) {}
+
+  double at(const slab_edge & e) const {
+    return e.a.x + (e.b.x - e.a.x) * (ym - e.a.y) / (e.b.y - e.a.y);
+  }
+
+  bool operator () (const slab_edge & e, const slab_edge & f) const {
+    return at(e) < at(f);
+  }
+};
+
+class polygon_index {
+  std::vector<point> v; //the vertices of a convex polygon in CCW order
+  bool convex;
+  std::vector<double> ys; //the distinct heights of the vertices
+  std::vector<int> start, level_start;
+  std::vector<slab_edge> edges; //the edges of slab k from start[k]
+  //the vertices and horizontal edges at height ys[k] from level_start[k],
+  //as pairs of the least and greatest x, sorted
+  std::vector<std::pair<double, double> > level;
+
+  bool is_convex(const std::vector<point> & p) {
+    int n = p.size(), sign = 0;
+    for (int i = 0; i < n; i++) {
+      //the turns at every vertex and the fan from p[0] must agree
+      double turn = cross(p[i], p[(i + 1) % n], p[(i + 2) % n]);
+      double fan = (i + 1 < n - 1) ? cross(p[0], p[i], p[i + 1]) : 0;
+      for (int k = 0; k < 2; k++) {
+        double c = (k == 0) ? turn : fan;
+        if (EQ(c, 0)) continue;
+        if (sign == 0) sign = (c > 0) ? 1 : -1;
+        if ((c > 0) != (sign > 0)) return false;
+      }
+    }
+    return sign != 0;
+  }
+
+  void build_convex(const std::vector<point> & p) {
+    double area = 0;
+    for (int i = 0, n = p.size(); i < n; i++)
+      area += cross(point(0, 0), p[i], p[(i + 1) % n]);
+    int n = p.size();
+    for (int i = 0; i < n; i++) {
+      const point & q = p[(area > 0) ? i : n - 1 - i];
+      //skips repeated and collinear vertices
+      while (v.size() >= 2 && EQ(cross(v[v.size() - 2], v.back(), q), 0))
+        v.pop_back();
+      if (v.empty() || v.back() != q) v.push_back(q);
+    }
+    while (v.size() >= 3 && EQ(cross(v[v.size() - 2], v.back(), v[0]), 0))
+      v.pop_back();
+    while (v.size() >= 3 && EQ(cross(v.back(), v[0], v[1]), 0))
+      v.erase(v.begin());
+  }
+
+  void build_slabs(const std::vector<point> & p) {
+    int n = p.size();
+    for (int i = 0; i < n; i++) ys.push_back(p[i].y);
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+    int s = ys.size();
+    std::vector<std::vector<slab_edge> > slabs(s);
+    std::vector<std::vector<std::pair<double, double> > > levels(s);
+    for (int i = 0; i < n; i++) {
+      const point & a = p[i], & b = p[(i + 1) % n];
+      int ka = std::lower_bound(ys.begin(), ys.end(), a.y) - ys.begin();
+      int kb = std::lower_bound(ys.begin(), ys.end(), b.y) - ys.begin();
+      levels[ka].push_back(std::make_pair(a.x, a.x));
+      if (ka == kb) {
+        levels[ka].push_back(std::make_pair(std::min(a.x, b.x),
+                                            std::max(a.x, b.x)));
+        continue;
+      }
+      slab_edge e = (a.y < b.y) ? slab_edge(a, b) : slab_edge(b, a);
+      for (int k = std::min(ka, kb); k < std::max(ka, kb); k++)
+        slabs[k].push_back(e);
+    }
+    for (int k = 0; k < s; k++) {
+      if (k + 1 < s)
+        std::sort(slabs[k].begin(), slabs[k].end(),
+                  slab_less((ys[k] + ys[k + 1]) / 2));
+      start.push_back(edges.size());
+      edges.insert(edges.end(), slabs[k].begin(), slabs[k].end());
+      std::sort(levels[k].begin(), levels[k].end());
+      level_start.push_back(level.size());
+      level.insert(level.end(), levels[k].begin(), levels[k].end());
+    }
+    start.push_back(edges.size());
+    level_start.push_back(level.size());
+  }
+
+  bool convex_contains(const point & p) const {
+    int n = v.size();
+    if (n < 3) {
+      for (int i = 0; i < n; i++)
+        if (EQ(cross(v[i], v[(i + 1) % n], p), 0) &&
+            LE(std::min(v[i].x, v[(i + 1) % n].x), p.x) &&
+            LE(p.x, std::max(v[i].x, v[(i + 1) % n].x)) &&
+            LE(std::min(v[i].y, v[(i + 1) % n].y), p.y) &&
+            LE(p.y, std::max(v[i].y, v[(i + 1) % n].y)))
+          return EDGE_IS_INSIDE;
+      return false;
+    }
+    double first = cross(v[0], v[1], p), last = cross(v[0], v[n - 1], p);
+    if (LT(first, 0) || GT(last, 0)) return false;
+    //on the lines of the edges from v[0], of which the polygon is on one side
+    if (EQ(first, 0) || EQ(last, 0)) {
+      const point & q = EQ(first, 0) ? v[1] : v[n - 1];
+      bool on = LE(std::min(v[0].x, q.x), p.x) &&
+                LE(p.x, std::max(v[0].x, q.x)) &&
+                LE(std::min(v[0].y, q.y), p.y) &&
+                LE(p.y, std::max(v[0].y, q.y));
+      return on ? EDGE_IS_INSIDE : false;
+    }
+    int lo = 1, hi = n - 1;
+    while (hi - lo > 1) {
+      int mid = (lo + hi) / 2;
+      if (cross(v[0], v[mid], p) >= 0) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    double c = cross(v[lo], v[lo + 1], p);
+    if (EQ(c, 0)) return EDGE_IS_INSIDE;
+    return c > 0;
+  }
+
+  bool slab_contains(const point & p) const {
+    int s = ys.size();
+    //the vertices and horizontal edges within eps of this height
+    int k = std::lower_bound(ys.begin(), ys.end(), p.y - eps) - ys.begin();
+    for (; k < s && LE(ys[k], p.y); k++) {
+      std::vector<std::pair<double, double> >::const_iterator it =
+          std::upper_bound(level.begin() + level_start[k],
+                           level.begin() + level_start[k + 1],
+                           std::make_pair(p.x + eps, DBL_MAX));
+      if (it != level.begin() + level_start[k] && LE(p.x, (--it)->second))
+        return EDGE_IS_INSIDE;
+    }
+    //the slab above every vertex which is not more than eps above p
+    if (--k < 0 || k >= s - 1) return false;
+    //the number of edges of slab k left of p, by binary search
+    int lo = start[k], hi = start[k + 1];
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (cross(edges[mid].a, edges[mid].b, p) < 0) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    for (int i = std::max(lo - 1, start[k]); i <= lo && i < start[k + 1]; i++)
+      if (EQ(cross(edges[i].a, edges[i].b, p), 0)) return EDGE_IS_INSIDE;
+    return (lo - start[k]) % 2 == 1;
+  }
+
+ public:
+  //[lo, hi) must point to the vertices of a simple polygon, in CW or
+  //CCW order, which is convex or otherwise
+  template<class It> polygon_index(It lo, It hi) {
+    std::vector<point> p(lo, hi);
+    convex = is_convex(p);
+    if (convex) {
+      build_convex(p);
+    } else {
+      build_slabs(p);
+    }
+  }
+
+  bool is_convex() const { return convex; }
+
+  bool contains(const point & p) const {
+    return convex ? convex_contains(p) : slab_contains(p);
+  }
+
+  //sets res[i] to whether point q[i] is in the polygon
+  void contains(const point_batch & q, bool res[]) const {
+    for (int i = 0, m = q.size(); i < m; i++)
+      res[i] = contains(point(q.x[i], q.y[i]));
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -64,5 +342,30 @@ int main() {
   assert(point_in_polygon(pt(0, 3), p, p + 4));
   assert(!point_in_polygon(pt(0, 3.01), p, p + 4));
   assert(!point_in_polygon(pt(2, 2), p, p + 4));
+
+  //the same queries as a batch
+  point_batch q;
+  q.push_back(pt(1, 2));
+  q.push_back(pt(0, 3));
+  q.push_back(pt(0, 3.01));
+  q.push_back(pt(2, 2));
+  bool res[4];
+  point_in_polygon(q, p, p + 4, res);
+  assert(res[0] && res[1] && !res[2] && !res[3]);
+
+  //the same queries against a preprocessed index
+  polygon_index convex(p, p + 4);
+  assert(convex.is_convex());
+  convex.contains(q, res);
+  assert(res[0] && res[1] && !res[2] && !res[3]);
+
+  //a nonconvex polygon with a notch in its top edge
+  pt r[] = {pt(0, 0), pt(4, 0), pt(4, 4), pt(2, 2), pt(0, 4)};
+  polygon_index notched(r, r + 5);
+  assert(!notched.is_convex());
+  assert(notched.contains(pt(1, 1)) && notched.contains(pt(3, 3)));
+  assert(!notched.contains(pt(2, 3)) && !notched.contains(pt(5, 2)));
+  assert(notched.contains(pt(2, 2)) && notched.contains(pt(4, 4)));
+  assert(notched.contains(pt(1, 0)) && !notched.contains(pt(2, 2.5)));
   return 0;
 }
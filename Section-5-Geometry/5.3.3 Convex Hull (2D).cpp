@@ -6,6 +6,13 @@ crosses through it will only cross through it once) that contains
 all of the points. This function uses the monotone chain algorithm
 to compute the upper and lower hulls separately.
 
+Before sorting, convex_hull() discards every point that lies strictly
+inside the octagon of the points extreme in x, y, x + y, and x - y,
+since none of them can be on the hull (the Akl-Toussaint heuristic).
+Finding the extremes and testing the points each take one pass. For
+points distributed uniformly in a square or a disk, fewer than 1% and
+10% respectively survive, so the O(n log n) sort is of a small subset.
+
 Returns: a vector of the convex hull points in clockwise order.
 Complexity: O(n log n) on the number of points given
 
@@ -13,11 +20,45 @@ Notes: To yield the hull points in counterclockwise order,
        replace every usage of GE() in the function with LE().
        To have the first point on the hull repeated as the last,
        replace the last line of the function to res.resize(k);
+       The turns are decided by the robust orient2d() predicate of
+       section 5.1.4, so that nearly collinear points can never yield
+       a hull that is not convex.
+
+convex_hull_chunked(lo, hi, chunks) splits the range into chunks equal
+parts and merges their hulls with merge_hulls(). The hull of each part
+depends only on its own points, so that the parts may be processed
+separately (e.g. as they are read), and only the hull vertices of each
+part need to be kept for the merge.
+
+convex_hull_chan(lo, hi) is Chan's output-sensitive algorithm, taking
+O(n log h) time for h hull points. For m = 4, 16, 256, ..., it splits
+the points into groups of m, finds the hull of each group by monotone
+chain, then gift-wraps around the groups for up to m steps, finding the
+tangent from the current hull point to each group hull by binary search
+in O(log m). The first m with at least h steps completes the hull, and
+the rounds before it take a geometrically decreasing total time. The
+octagon filter is applied first. The constant factor is larger than
+that of sorting, so that after the filter, convex_hull() is usually as
+fast, and Chan's algorithm only pays off when h is tiny relative to n.
+
+incremental_hull maintains the hull of a stream of points, keeping the
+upper and lower hulls in maps from x to y. insert(p) takes O(log n)
+amortized time, since each point is erased from a map at most once,
+contains(p) takes O(log n), and hull() lists the points in O(h), in the
+same order as convex_hull().
+
+convex_hull(b) takes a point_batch (see section 5.1.1), which stores
+the coordinates of the points in separate arrays, and returns the
+indices of the hull points of b in clockwise order, without moving the
+points. It applies the same octagon filter, where both the extremes and
+the tests run over the contiguous coordinate arrays.
 
 */
 
-#include <algorithm> /* std::sort() */
+#include <algorithm> /* std::min_element(), std::partition(), ... */
+#include <cfloat>    /* DBL_EPSILON */
 #include <cmath>     /* fabs() */
+#include <map>
 #include <utility>   /* std::pair */
 #include <vector>
 
@@ -25,17 +66,190 @@ typedef std::pair<double, double> point;
 #define x first
 #define y second
 
+//robust orientation by exact expansion arithmetic (see section 5.1.4)
+
+//a sum of nonoverlapping doubles in order of increasing magnitude
+typedef std::vector<double> expansion;
+
+//half the distance between 1 and the next double, i.e. 2^-53
+const double round_eps = 1.1102230246251565e-16;
+const double ccw_bound = (3 + 16 * round_eps) * round_eps;
+
+//s + t = a + b exactly, where s is the rounded sum
+void two_sum(double a, double b, double & s, double & t) {
+  s = a + b;
+  double bv = s - a, av = s - bv;
+  t = (a - av) + (b - bv);
+}
+
+//hi + lo = a exactly, where each half has at most 26 significant bits
+void split(double a, double & hi, double & lo) {
+  double c = 134217729.0 * a; //2^27 + 1
+  hi = c - (c - a);
+  lo = a - hi;
+}
+
+//p + t = a*b exactly, where p is the rounded product
+void two_product(double a, double b, double & p, double & t) {
+  p = a * b;
+  double ahi, alo, bhi, blo;
+  split(a, ahi, alo);
+  split(b, bhi, blo);
+  t = alo * blo - (((p - ahi * bhi) - alo * bhi) - ahi * blo);
+}
+
+//the exact difference a - b
+expansion difference(double a, double b) {
+  expansion e;
+  double s, t;
+  two_sum(a, -b, s, t);
+  if (t != 0) e.push_back(t);
+  if (s != 0) e.push_back(s);
+  return e;
+}
+
+//merges the components by magnitude, then accumulates them in order
+expansion sum(const expansion & e, const expansion & f) {
+  expansion h;
+  int m = e.size(), n = f.size(), i = 0, j = 0;
+  double q = 0, s, t;
+  while (i < m || j < n) {
+    double g = (j == n || (i < m && fabs(e[i]) < fabs(f[j]))) ? e[i++] : f[j++];
+    two_sum(q, g, s, t);
+    if (t != 0) h.push_back(t);
+    q = s;
+  }
+  if (q != 0) h.push_back(q);
+  return h;
+}
+
+expansion scale(const expansion & e, double b) {
+  expansion h;
+  double q = 0, p, pt, s, t;
+  for (int i = 0; i < (int)e.size(); i++) {
+    two_product(e[i], b, p, pt);
+    two_sum(q, pt, s, t);
+    if (t != 0) h.push_back(t);
+    two_sum(p, s, q, t);
+    if (t != 0) h.push_back(t);
+  }
+  if (q != 0) h.push_back(q);
+  return h;
+}
+
+expansion product(const expansion & e, const expansion & f) {
+  expansion h;
+  for (int i = 0; i < (int)f.size(); i++) h = sum(h, scale(e, f[i]));
+  return h;
+}
+
+expansion negate(expansion e) {
+  for (int i = 0; i < (int)e.size(); i++) e[i] = -e[i];
+  return e;
+}
+
+//an approximation of the value of e with the same sign
+double estimate(const expansion & e) {
+  return e.empty() ? 0 : e.back();
+}
+
+double orient2d_exact(double ax, double ay, double bx, double by,
+                      double cx, double cy) {
+  expansion l = product(difference(ax, cx), difference(by, cy));
+  expansion r = product(difference(ay, cy), difference(bx, cx));
+  return estimate(sum(l, negate(r)));
+}
+
+double orient2d(double ax, double ay, double bx, double by,
+                double cx, double cy) {
+  double l = (ax - cx) * (by - cy), r = (ay - cy) * (bx - cx);
+  double det = l - r, bound = ccw_bound * (fabs(l) + fabs(r));
+  if (det > bound || -det > bound) return det;
+  return orient2d_exact(ax, ay, bx, by, cx, cy);
+}
+
+double orient2d(const point & a, const point & b, const point & c) {
+  return orient2d(a.x, a.y, b.x, b.y, c.x, c.y);
+}
+
 //change < 0 comparisons to > 0 to produce hull points in CCW order
-double cw(const point & o, const point & a, const point & b) {
-  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x) < 0;
+bool cw(const point & o, const point & a, const point & b) {
+  return orient2d(o, a, b) < 0;
+}
+
+//the extreme points in the directions of the outward normals (-1, 0),
+//(-1, -1), (0, -1), (1, -1), (1, 0), (1, 1), (0, 1), and (-1, 1), which
+//are in CCW order along the hull, as are the points
+const int octagon_dx[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+const int octagon_dy[8] = {0, -1, -1, -1, 0, 1, 1, 1};
+
+struct octagon {
+  double ox[8], oy[8], ux[8], uy[8];
+  int edges;
+
+  //the edges between the extremes e, skipping those between repeats
+  octagon(const point e[8]): edges(0) {
+    for (int k = 0; k < 8; k++) {
+      ox[edges] = e[k].x;
+      oy[edges] = e[k].y;
+      ux[edges] = e[(k + 1) % 8].x - ox[edges];
+      uy[edges] = e[(k + 1) % 8].y - oy[edges];
+      if (ux[edges] != 0 || uy[edges] != 0) edges++;
+    }
+  }
+
+  //whether (px, py) is left of every edge by more than the rounding
+  //error of the cross products, and hence not on the hull
+  bool strictly_contains(double px, double py) const {
+    bool inside = (edges >= 3);
+    for (int k = 0; k < edges; k++) {
+      double s = ux[k] * (py - oy[k]), t = uy[k] * (px - ox[k]);
+      inside &= (s - t > 8 * DBL_EPSILON * (fabs(s) + fabs(t)));
+    }
+    return inside;
+  }
+};
+
+struct outside_octagon {
+  const octagon & o;
+
+  outside_octagon(const octagon & o): o(o) {}
+
+  bool operator () (const point & p) const {
+    return !o.strictly_contains(p.x, p.y);
+  }
+};
+
+//moves the points of [lo, hi) that may be on the hull to the front, and
+//returns the end of them
+template<class It> It discard_interior(It lo, It hi) {
+  if (lo == hi) return hi;
+  point e[8];
+  double best[8];
+  for (int k = 0; k < 8; k++) {
+    e[k] = *lo;
+    best[k] = octagon_dx[k] * lo->x + octagon_dy[k] * lo->y;
+  }
+  for (It it = lo; it != hi; ++it)
+    for (int k = 0; k < 8; k++) {
+      double d = octagon_dx[k] * it->x + octagon_dy[k] * it->y;
+      if (d > best[k]) {
+        best[k] = d;
+        e[k] = *it;
+      }
+    }
+  octagon o(e);
+  return std::partition(lo, hi, outside_octagon(o));
 }
 
 //convex hull from a range [lo, hi) of points
 //monotone chain in O(n log n) to find hull points in CW order
-//notes: the range of input points will be sorted lexicographically
+//notes: the range of input points will be reordered, with the points
+//that may be on the hull sorted lexicographically at the front
 template<class It> std::vector<point> convex_hull(It lo, It hi) {
   int k = 0;
   if (hi - lo <= 1) return std::vector<point>(lo, hi);
+  hi = discard_interior(lo, hi);
   std::vector<point> res(2 * (int)(hi - lo));
   std::sort(lo, hi); //compare by x, then by y if x-values are equal
   for (It it = lo; it != hi; ++it) {
@@ -51,8 +265,261 @@ template<class It> std::vector<point> convex_hull(It lo, It hi) {
   return res;
 }
 
+//the hull of the points of two hulls, in CW order
+std::vector<point> merge_hulls(const std::vector<point> & a,
+                               const std::vector<point> & b) {
+  std::vector<point> v(a);
+  v.insert(v.end(), b.begin(), b.end());
+  return convex_hull(v.begin(), v.end());
+}
+
+//the hull of [lo, hi), merging the hulls of chunks equal parts in turn
+template<class It>
+std::vector<point> convex_hull_chunked(It lo, It hi, int chunks) {
+  long long n = hi - lo;
+  std::vector<point> res;
+  for (int i = 0; i < chunks; i++)
+    res = merge_hulls(res, convex_hull(lo + n * i / chunks,
+                                       lo + n * (i + 1) / chunks));
+  return res;
+}
+
+//whether b is further clockwise than a as seen from p, or in the same
+//direction and further away, where p is never between a and b because
+//it is a vertex of the hull
+bool further_cw(const point & p, const point & a, const point & b) {
+  double o = orient2d(p, a, b);
+  if (o != 0) return o < 0;
+  double da = (a.x - p.x) * (a.x - p.x) + (a.y - p.y) * (a.y - p.y);
+  double db = (b.x - p.x) * (b.x - p.x) + (b.y - p.y) * (b.y - p.y);
+  return db > da;
+}
+
+//whether the edge from h[i] is visible from p, i.e. p is right of it
+bool visible(const std::vector<point> & h, const point & p, int i) {
+  return orient2d(p, h[i], h[(i + 1) % h.size()]) < 0;
+}
+
+//the index of the vertex of the CCW hull h that is furthest clockwise as
+//seen from p outside of it, i.e. where the edges visible from p end
+int tangent(const std::vector<point> & h, const point & p) {
+  int k = h.size(), best = 0;
+  if (k > 3) {
+    //binary search by the side of h[0], since the visible edges are
+    //contiguous and the directions to the vertices are bitonic
+    bool v0 = visible(h, p, 0);
+    int lo = 1, hi = k - 1;
+    if (!v0 && visible(h, p, k - 1)) lo = hi = 0;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      bool before = v0 ? (visible(h, p, mid) && orient2d(p, h[0], h[mid]) < 0)
+                       : (visible(h, p, mid) || orient2d(p, h[0], h[mid]) >= 0);
+      if (before) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    int prev = (lo + k - 1) % k, next = (lo + 1) % k;
+    if (h[lo] != p && orient2d(p, h[lo], h[prev]) >= 0 &&
+        orient2d(p, h[lo], h[next]) >= 0)
+      return further_cw(p, h[lo], h[next]) ? next : lo;
+  }
+  //small hulls, and p on h (in which case the search may fail)
+  for (int i = 1; i < k; i++)
+    if (further_cw(p, h[best], h[i])) best = i;
+  return best;
+}
+
+//Chan's algorithm for the hull of [lo, hi) in CW order, in O(n log h)
+//notes: the range of input points will be reordered
+template<class It> std::vector<point> convex_hull_chan(It lo, It hi) {
+  if (hi - lo <= 1) return std::vector<point>(lo, hi);
+  hi = discard_interior(lo, hi);
+  int n = hi - lo;
+  const point start = *std::min_element(lo, hi);
+  for (int m = 4; ; m = (m > n / m) ? n : m * m) {
+    int groups = (n + m - 1) / m, cg = -1, ci = -1;
+    std::vector<std::vector<point> > h(groups);
+    for (int g = 0; g < groups; g++) {
+      h[g] = convex_hull(lo + g * m, lo + std::min(n, (g + 1) * m));
+      std::reverse(h[g].begin(), h[g].end());
+      for (int i = 0; cg < 0 && i < (int)h[g].size(); i++)
+        if (h[g][i] == start) {
+          cg = g;
+          ci = i;
+        }
+    }
+    //gift wraps in CCW order, where h[cg][ci] is the current point and
+    //its successor on its own group hull is its tangent there
+    std::vector<point> res(1, start);
+    for (int step = 0; step < m; step++) {
+      point p = res.back(), best = p;
+      int bg = -1, bi = -1;
+      for (int g = 0; g < groups; g++) {
+        int i = (g == cg) ? (ci + 1) % h[g].size() : tangent(h[g], p);
+        if (further_cw(p, best, h[g][i])) {
+          best = h[g][i];
+          bg = g;
+          bi = i;
+        }
+      }
+      if (bg < 0 || best == start) {
+        std::reverse(res.begin() + 1, res.end());
+        return res;
+      }
+      res.push_back(best);
+      cg = bg;
+      ci = bi;
+    }
+  }
+}
+
+//the upper hull of points as a map from x to y, which maintains the
+//lower hull when given the points (x, -y) instead
+struct half_hull {
+  typedef std::map<double, double>::iterator iter;
+  typedef std::map<double, double>::const_iterator citer;
+  std::map<double, double> h;
+
+  //whether (px, py) is on or below the hull
+  bool covers(double px, double py) const {
+    citer it = h.lower_bound(px);
+    if (it == h.end()) return false;
+    if (it->x == px) return py <= it->y;
+    if (it == h.begin()) return false;
+    citer prev = it;
+    --prev;
+    return orient2d(prev->x, prev->y, it->x, it->y, px, py) <= 0;
+  }
+
+  //adds (px, py), returning whether it is a vertex of the new hull
+  bool insert(double px, double py) {
+    iter it = h.find(px);
+    if (it != h.end()) {
+      if (py <= it->y) return false;
+      h.erase(it);
+    } else if (covers(px, py)) {
+      return false;
+    }
+    it = h.insert(std::make_pair(px, py)).first;
+    while (it != h.begin()) {
+      iter a = it, b = --a;
+      if (b == h.begin()) break;
+      --b;
+      if (orient2d(b->x, b->y, a->x, a->y, px, py) < 0) break;
+      h.erase(a);
+    }
+    for (;;) {
+      iter a = it, b = ++a;
+      if (a == h.end() || ++b == h.end()) break;
+      if (orient2d(px, py, a->x, a->y, b->x, b->y) < 0) break;
+      h.erase(a);
+    }
+    return true;
+  }
+};
+
+class incremental_hull {
+  half_hull upper, lower;
+
+ public:
+  //adds p, returning whether it is a vertex of the new hull
+  bool insert(const point & p) {
+    bool u = upper.insert(p.x, p.y);
+    bool l = lower.insert(p.x, -p.y);
+    return u || l;
+  }
+
+  //whether p is inside or on the hull
+  bool contains(const point & p) const {
+    return upper.covers(p.x, p.y) && lower.covers(p.x, -p.y);
+  }
+
+  //the hull points in CW order, starting from the lexicographically least
+  std::vector<point> hull() const {
+    std::vector<point> res, l;
+    half_hull::citer it;
+    for (it = lower.h.begin(); it != lower.h.end(); ++it)
+      l.push_back(point(it->x, -it->y));
+    if (l.empty()) return res;
+    if (l[0] != point(upper.h.begin()->x, upper.h.begin()->y))
+      res.push_back(l[0]);
+    for (it = upper.h.begin(); it != upper.h.end(); ++it)
+      res.push_back(point(it->x, it->y));
+    for (int i = (int)l.size() - 1; i > 0; i--)
+      if (i < (int)l.size() - 1 || l[i] != res.back()) res.push_back(l[i]);
+    return res;
+  }
+};
+
+//a batch of points stored as separate arrays of coordinates
+struct point_batch {
+  std::vector<double> x, y;
+
+  int size() const { return x.size(); }
+  point operator [] (int i) const { return point(x[i], y[i]); }
+
+  void push_back(const point & p) {
+    x.push_back(p.x);
+    y.push_back(p.y);
+  }
+};
+
+//compares the indices of points in a batch by x, then by y
+struct batch_less {
+  const point_batch & b;
+
+  batch_less(const point_batch & b): b(b) {}
+
+  bool operator () (int i, int j) const {
+    return b.x[i] < b.x[j] || (b.x[i] == b.x[j] && b.y[i] < b.y[j]);
+  }
+};
+
+//convex hull from a batch of points, as indices into b in CW order
+std::vector<int> convex_hull(const point_batch & b) {
+  int n = b.size();
+  std::vector<int> idx;
+  if (n == 0) return idx;
+  const double * x = &b.x[0], * y = &b.y[0];
+  int e[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  double best[8];
+  for (int k = 0; k < 8; k++)
+    best[k] = octagon_dx[k] * x[0] + octagon_dy[k] * y[0];
+  for (int i = 1; i < n; i++)
+    for (int k = 0; k < 8; k++) {
+      double d = octagon_dx[k] * x[i] + octagon_dy[k] * y[i];
+      if (d > best[k]) {
+        best[k] = d;
+        e[k] = i;
+      }
+    }
+  point ext[8];
+  for (int k = 0; k < 8; k++) ext[k] = b[e[k]];
+  octagon o(ext);
+  for (int i = 0; i < n; i++)
+    if (!o.strictly_contains(x[i], y[i])) idx.push_back(i);
+  std::sort(idx.begin(), idx.end(), batch_less(b));
+  int m = idx.size(), k = 0;
+  if (m <= 1) return idx;
+  std::vector<int> res(2 * m);
+  for (int i = 0; i < m; i++) {
+    while (k >= 2 && !cw(b[res[k - 2]], b[res[k - 1]], b[idx[i]])) k--;
+    res[k++] = idx[i];
+  }
+  int t = k + 1;
+  for (int i = m - 2; i >= 0; i--) {
+    while (k >= t && !cw(b[res[k - 2]], b[res[k - 1]], b[idx[i]])) k--;
+    res[k++] = idx[i];
+  }
+  res.resize(k - 1);
+  return res;
+}
+
 /*** Example Usage ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -70,5 +537,22 @@ int main() {
   for (int i = 0; i < (int)h.size(); i++)
     cout << " (" << h[i].x << "," << h[i].y << ")";
   cout << "\n";
+
+  //the batch version reports the same hull, by indices into the batch
+  point_batch b;
+  for (int i = 0; i < (int)v.size(); i++) b.push_back(v[i]);
+  vector<int> hb = convex_hull(b);
+  assert(hb.size() == h.size());
+  for (int i = 0; i < (int)h.size(); i++) assert(b[hb[i]] == h[i]);
+
+  //the other methods report the same hull in the same order
+  assert(convex_hull_chan(v.begin(), v.end()) == h);
+  assert(convex_hull_chunked(v.begin(), v.end(), 2) == h);
+  incremental_hull ih;
+  for (int i = 0; i < (int)v.size(); i++) ih.insert(v[i]);
+  assert(ih.hull() == h);
+  assert(ih.contains(point(1, 2)) && !ih.contains(point(2, 2)));
+  assert(!ih.insert(point(0, 1)) && ih.insert(point(3, 3)));
+  assert(ih.hull().size() == 4 && !ih.contains(point(1, 3.5)));
   return 0;
 }
@@ -10,12 +10,28 @@ be preserved.
 
 Time Complexity: O(n) average on the number of points given.
 
+circle_solver computes the same circle for many sets of points, reusing
+one buffer for them and leaving the input unchanged. It first discards
+the points strictly inside the quadrilateral of the leftmost, lowest,
+rightmost, and highest points (after Akl and Toussaint), which are not
+on the hull and so cannot determine the circle. The rest are shuffled
+by a xorshift generator, and whenever a point lies outside the circle
+of the points before it, it is moved to the front once the new circle
+is found, so that the points most likely to be on the boundary are
+tested first. The circle is kept as its center and squared radius, and
+a circle through three points costs one division. Its state is in the
+object, so separate solvers are independent. smallest_circles()
+solves many sets stored consecutively in one array with one solver.
+
+Time Complexity: O(n) average per set of n points.
+
 */
 
-#include <algorithm>
-#include <cmath>
-#include <stdexcept>
-#include <utility>
+#include <algorithm> /* std::rotate(), std::swap() */
+#include <cmath>     /* fabs(), sqrt() */
+#include <stdexcept> /* std::runtime_error */
+#include <utility>   /* std::pair */
+#include <vector>
 
 const double eps = 1e-9;
 
@@ -83,10 +99,111 @@ template<class It> circle smallest_circle(It lo, It hi) {
   return res;
 }
 
+class circle_solver {
+  std::vector<point> p;
+  unsigned long long state;
+  double h, k, r2; //the current circle
+
+  unsigned int next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state >> 32;
+  }
+
+  bool contains(const point & a) const {
+    double dx = a.x - h, dy = a.y - k;
+    return LE(dx * dx + dy * dy, r2);
+  }
+
+  void set(const point & a, const point & b) {
+    h = (a.x + b.x) / 2;
+    k = (a.y + b.y) / 2;
+    r2 = norm(point(a.x - h, a.y - k));
+  }
+
+  void set(const point & a, const point & b, const point & c) {
+    double bx = b.x - a.x, by = b.y - a.y, cx = c.x - a.x, cy = c.y - a.y;
+    double bn = bx * bx + by * by, cn = cx * cx + cy * cy;
+    double d = 2 * (bx * cy - by * cx);
+    if (fabs(d) <= eps * (bn + cn)) {
+      //nearly collinear, so the farthest two points span the circle
+      double an = norm(point(b.x - c.x, b.y - c.y));
+      if (an >= bn && an >= cn) set(b, c);
+      else if (bn >= cn) set(a, b);
+      else set(a, c);
+      return;
+    }
+    double inv = 1 / d, ux = (cy * bn - by * cn) * inv;
+    double uy = (bx * cn - cx * bn) * inv;
+    h = a.x + ux;
+    k = a.y + uy;
+    r2 = ux * ux + uy * uy;
+  }
+
+  //removes the points strictly inside the quadrilateral of extremes
+  void discard_interior() {
+    int n = p.size(), e[4] = {0, 0, 0, 0};
+    for (int i = 1; i < n; i++) {
+      if (p[i].x < p[e[0]].x) e[0] = i;
+      if (p[i].y < p[e[1]].y) e[1] = i;
+      if (p[i].x > p[e[2]].x) e[2] = i;
+      if (p[i].y > p[e[3]].y) e[3] = i;
+    }
+    point q[4];
+    for (int j = 0; j < 4; j++) q[j] = p[e[j]];
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+      bool inside = true;
+      for (int j = 0; j < 4 && inside; j++) {
+        const point & a = q[j], & b = q[(j + 1) % 4];
+        inside = (b.x - a.x) * (p[i].y - a.y) > (b.y - a.y) * (p[i].x - a.x);
+      }
+      if (!inside) p[m++] = p[i];
+    }
+    p.resize(m);
+  }
+
+ public:
+  explicit circle_solver(unsigned long long seed = 88172645463325252ULL)
+      : state(seed | 1) {}
+
+  template<class It> circle solve(It lo, It hi) {
+    if (lo == hi) return circle(0, 0, 0);
+    p.assign(lo, hi);
+    discard_interior();
+    int n = p.size();
+    for (int i = n - 1; i > 0; i--)
+      std::swap(p[i], p[(unsigned long long)next() * (i + 1) >> 32]);
+    if (n == 1) return circle(p[0].x, p[0].y, 0);
+    set(p[0], p[1]);
+    for (int i = 2; i < n; i++) {
+      if (contains(p[i])) continue;
+      set(p[i], p[0]);
+      for (int j = 1; j < i; j++) {
+        if (contains(p[j])) continue;
+        set(p[i], p[j]);
+        for (int l = 0; l < j; l++)
+          if (!contains(p[l])) set(p[i], p[j], p[l]);
+      }
+      std::rotate(p.begin(), p.begin() + i, p.begin() + i + 1);
+    }
+    return circle(h, k, sqrt(r2));
+  }
+};
+
+//solves the sets [pts[start[i]], pts[start[i + 1]]) for each i into res[i]
+void smallest_circles(const std::vector<point> & pts,
+                      const std::vector<int> & start, circle res[]) {
+  circle_solver s;
+  for (int i = 0; i + 1 < (int)start.size(); i++)
+    res[i] = s.solve(pts.begin() + start[i], pts.begin() + start[i + 1]);
+}
+
 /*** Example Usage ***/
 
+#include <cassert>
 #include <iostream>
-#include <vector>
 using namespace std;
 
 int main() {
@@ -98,5 +215,27 @@ int main() {
   circle res = smallest_circle(v.begin(), v.end());
   cout << "center: (" << res.h << ", " << res.k << ")\n";
   cout << "radius: " << res.r << "\n";
+
+  //the same circle with a solver, a second set of collinear points, and
+  //a third of a single point
+  circle_solver s;
+  circle c = s.solve(v.begin(), v.end());
+  assert(fabs(c.h - 0.5) < eps && fabs(c.k - 0.5) < eps);
+  assert(fabs(c.r - sqrt(0.5)) < eps);
+  v.push_back(point(0, 5));
+  v.push_back(point(1, 5));
+  v.push_back(point(2, 5));
+  v.push_back(point(7, 7));
+  vector<int> start;
+  start.push_back(0);
+  start.push_back(4);
+  start.push_back(7);
+  start.push_back(8);
+  circle r[3];
+  smallest_circles(v, start, r);
+  assert(fabs(r[0].r - c.r) < eps);
+  assert(fabs(r[1].h - 1) < eps && fabs(r[1].k - 5) < eps);
+  assert(fabs(r[1].r - 1) < eps);
+  assert(r[2].h == 7 && r[2].k == 7 && r[2].r == 0);
   return 0;
 }
@@ -8,9 +8,30 @@ program uses rotating calipers method to find a solution.
 
 Time Complexity: O(n log n) on the number of points in the set.
 
+rotating_calipers(h) takes a convex polygon h with its vertices in
+either order and no three collinear, such as a convex hull from section
+5.3.3, and measures it in a single sweep. For each edge, it maintains
+the vertices farthest forward and backward along the edge's direction
+and the vertex farthest from its line, each of which only advances as
+the edge rotates. The vertex farthest from the line forms antipodal
+pairs with the edge's endpoints, among which is a diametral pair. The
+width of the polygon is the smallest height of a vertex from an edge,
+and each of the minimum area and minimum perimeter rectangles enclosing
+it has a side flush with some edge (Freeman and Shapira), so that each
+is found among the rectangles spanned by the three caliper vertices.
+The corners of a rectangle are in order around it, starting with the
+two on the line of the edge. batch_calipers() measures many small point
+sets stored consecutively in one array, reusing a single buffer for
+their convex hulls.
+
+Time Complexity: O(h) for rotating_calipers() on a polygon of h
+vertices. For batch_calipers(), O(n log n) in the total number n of
+points, for sorting each set.
+
 */
 
-#include <algorithm> /* std::sort() */
+#include <algorithm> /* std::copy(), std::min(), std::sort() */
+#include <cfloat>    /* DBL_MAX */
 #include <cmath>     /* fabs(), sqrt() */
 #include <utility>   /* std::pair */
 #include <vector>
@@ -36,10 +57,14 @@ double area(const point & o, const point & a, const point & b) {
   return fabs(cross(o, a, b));
 }
 
-template<class It> std::vector<point> convex_hull(It lo, It hi) {
+//stores the hull into res, reusing its memory
+template<class It> void convex_hull(It lo, It hi, std::vector<point> & res) {
   int k = 0;
-  if (hi - lo <= 1) return std::vector<point>(lo, hi);
-  std::vector<point> res(2 * (int)(hi - lo));
+  if (hi - lo <= 1) {
+    res.assign(lo, hi);
+    return;
+  }
+  res.resize(2 * (int)(hi - lo));
   std::sort(lo, hi); //compare by x, then by y if x-values are equal
   for (It it = lo; it != hi; ++it) {
     while (k >= 2 && !cw(res[k - 2], res[k - 1], *it)) k--;
@@ -51,6 +76,11 @@ template<class It> std::vector<point> convex_hull(It lo, It hi) {
     res[k++] = *it;
   }
   res.resize(k - 1);
+}
+
+template<class It> std::vector<point> convex_hull(It lo, It hi) {
+  std::vector<point> res;
+  convex_hull(lo, hi, res);
   return res;
 }
 
@@ -83,8 +113,88 @@ template<class It> std::pair<point, point> diametral_pair(It lo, It hi) {
   return res;
 }
 
+struct calipers {
+  double diameter, width, min_area, min_perimeter;
+  std::pair<point, point> diametral;
+  point area_rect[4], perimeter_rect[4];
+};
+
+//the positions of p along the unit direction e from o, and from the line
+double along(const point & p, const point & o, const point & e) {
+  return (p.x - o.x) * e.x + (p.y - o.y) * e.y;
+}
+
+double from(const point & p, const point & o, const point & e) {
+  return fabs((p.x - o.x) * e.y - (p.y - o.y) * e.x);
+}
+
+calipers rotating_calipers(const std::vector<point> & h) {
+  calipers c;
+  int m = h.size();
+  c.diameter = c.width = c.min_area = c.min_perimeter = 0;
+  c.diametral = std::make_pair(h[0], h[0]);
+  for (int k = 0; k < 4; k++) c.area_rect[k] = c.perimeter_rect[k] = h[0];
+  if (m == 1) return c;
+  c.width = c.min_area = c.min_perimeter = DBL_MAX;
+  int j = 1, l = 0, r = 1;
+  for (int i = 0; i < m; i++) {
+    const point & o = h[i], & o1 = h[(i + 1) % m];
+    double len = sqdist(o, o1); //the distance, despite the name
+    point e((o1.x - o.x) / len, (o1.y - o.y) / len);
+    while (along(h[(r + 1) % m], o, e) > along(h[r], o, e)) r = (r + 1) % m;
+    if (i == 0) j = r;
+    while (from(h[(j + 1) % m], o, e) > from(h[j], o, e)) j = (j + 1) % m;
+    if (i == 0) l = j;
+    while (along(h[(l + 1) % m], o, e) < along(h[l], o, e)) l = (l + 1) % m;
+    //an edge parallel to this one has both vertices antipodal to it, but
+    //rounding may leave j at either of them
+    for (int t = j + m - 1; t <= j + m + 1; t++) {
+      const point & q = h[t % m];
+      if (sqdist(o, q) > c.diameter) {
+        c.diameter = sqdist(o, q);
+        c.diametral = std::make_pair(o, q);
+      }
+      if (sqdist(o1, q) > c.diameter) {
+        c.diameter = sqdist(o1, q);
+        c.diametral = std::make_pair(o1, q);
+      }
+    }
+    //the rectangle with a side along the edge, toward the polygon
+    double a = along(h[l], o, e), b = along(h[r], o, e), w = from(h[j], o, e);
+    point n(e.y, -e.x);
+    if (along(h[j], o, n) < 0) n = point(-e.y, e.x);
+    point rect[4];
+    rect[0] = point(o.x + a * e.x, o.y + a * e.y);
+    rect[1] = point(o.x + b * e.x, o.y + b * e.y);
+    rect[2] = point(rect[1].x + w * n.x, rect[1].y + w * n.y);
+    rect[3] = point(rect[0].x + w * n.x, rect[0].y + w * n.y);
+    c.width = std::min(c.width, w);
+    if ((b - a) * w < c.min_area) {
+      c.min_area = (b - a) * w;
+      std::copy(rect, rect + 4, c.area_rect);
+    }
+    if (2 * (b - a + w) < c.min_perimeter) {
+      c.min_perimeter = 2 * (b - a + w);
+      std::copy(rect, rect + 4, c.perimeter_rect);
+    }
+  }
+  return c;
+}
+
+//measures the sets of points [pts[start[k]], pts[start[k + 1]]) for
+//each k into res[k], reordering the points of each set
+void batch_calipers(std::vector<point> & pts, const std::vector<int> & start,
+                    calipers res[]) {
+  std::vector<point> h;
+  for (int k = 0; k + 1 < (int)start.size(); k++) {
+    convex_hull(pts.begin() + start[k], pts.begin() + start[k + 1], h);
+    res[k] = rotating_calipers(h);
+  }
+}
+
 /*** Example Usage ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -98,6 +208,29 @@ int main() {
   pair<point, point> res = diametral_pair(v.begin(), v.end());
   cout << "diametral pair: (" << res.first.x << "," << res.first.y << ") ";
   cout << "(" << res.second.x << "," << res.second.y << ")\n";
-  cout << "diameter: " << sqrt(sqdist(res.first, res.second)) << "\n";
+  cout << "diameter: " << sqdist(res.first, res.second) << "\n"; //5.65685
+
+  //all measures of the hull of the same points
+  calipers c = rotating_calipers(convex_hull(v.begin(), v.end()));
+  assert(c.diameter == sqdist(res.first, res.second));
+  assert(fabs(c.width - 15 / sqrt(17.0)) < 1e-9); //from (0, 3) to the
+  assert(fabs(c.min_area - 16) < 1e-9);            //edge (3, 0)-(4, 4)
+  assert(fabs(c.min_perimeter - 16) < 1e-9);
+
+  //two point sets in one array, a unit square and a 2 by 1 rectangle
+  //turned by 45 degrees
+  point a[] = {point(0, 0), point(1, 0), point(1, 1), point(0, 1),
+               point(0, 0), point(1, 1), point(0.5, 1.5), point(-0.5, 0.5)};
+  vector<point> pts(a, a + 8);
+  vector<int> start;
+  start.push_back(0);
+  start.push_back(4);
+  start.push_back(8);
+  calipers res2[2];
+  batch_calipers(pts, start, res2);
+  assert(fabs(res2[0].width - 1) < 1e-9 && fabs(res2[0].min_area - 1) < 1e-9);
+  assert(fabs(res2[1].width - sqrt(0.5)) < 1e-9);
+  assert(fabs(res2[1].min_area - 1) < 1e-9);
+  assert(fabs(res2[1].diameter - sqrt(2.5)) < 1e-9);
   return 0;
 }
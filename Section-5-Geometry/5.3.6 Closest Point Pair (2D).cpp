@@ -7,12 +7,62 @@ of points in the input range may be changed by the function.
 
 Time Complexity: O(n log^2 n) where n is the number of points.
 
+closest_pair(b) takes a point_batch (see section 5.1.1), which stores
+the coordinates of the points in separate arrays, and returns the
+indices of a closest pair of points in b, leaving b unchanged. It sorts
+copies of the coordinates by x once, and each level of the recursion
+merges its halves by y instead of sorting them again, so that it takes
+O(n log n) time, scanning the strip along the dividing line with the
+arrays of coordinates sorted by y. It requires at least two points, and
+returns (0, 1) without reading b if there are fewer.
+
+closest_pair_grid(b) also returns the indices of a closest pair in a
+point_batch b, by the randomized incremental algorithm of Golin, Raman,
+Schwarz, and Smid, which refines the grid idea of Rabin. The points are
+shuffled and inserted one at a time into a grid of square cells whose
+side is the closest distance d among the points inserted so far, so that
+any point within d of a new point lies in one of the 3 by 3 cells around
+it, each holding at most 4 points. Whenever a new point is closer than d
+to one of them, d shrinks and the grid is rebuilt from the points so
+far. The i-th point causes a rebuild with probability at most 2/i, so
+the expected total work is O(n). The cells are stored in a hash table
+with linear probing, holding the index of the last point of each cell,
+and the points of a cell are chained by index, so that the grid uses
+O(n) memory however far apart the points are. Unlike closest_pair(),
+the points need not be distinct. It also requires at least two points,
+and returns (0, 1) like closest_pair() if there are fewer.
+
+all_nearest_neighbors(b, res) stores into res[i] the index of a point
+of b other than b[i] which is nearest to it, for every i, or -1 if b has
+a single point. Since the side of its cells is fixed, the grid is an
+array of about n/2 cells over the bounding box of the points, which are
+sorted into it by a counting sort and stored in order of cells. The rings of cells around each point are
+searched outward, until the distance to the next ring is at least that
+of the nearest point found. nearest_neighbor_grid is the underlying
+index, whose nearest(i) is const, so that ranges of points (such as the
+consecutive cells of point_at()) may be answered independently of each
+other.
+
+Time Complexity: O(n) expected for closest_pair_grid(). O(n) for
+all_nearest_neighbors() on points of bounded density, such as points
+drawn uniformly from a region. If many points crowd into a few cells,
+a query degrades toward the O(n) of scanning them, and a k-d tree (see
+section 3.4.11) is the better choice.
+
+Space Complexity: O(n) auxiliary for both.
+
+Note: The cell coordinates of closest_pair_grid() are the floors of the
+coordinates divided by the side of a cell, which must be less than 2^53
+in magnitude (e.g. the closest distance may not be less than 1e-12 for
+coordinates up to 1e3).
+
 */
 
-#include <algorithm> /* std::min, std::sort */
+#include <algorithm> /* std::min(), std::random_shuffle(), std::sort(), ... */
 #include <cfloat>    /* DBL_MAX */
-#include <cmath>     /* fabs */
+#include <cmath>     /* floor(), sqrt() */
 #include <utility>   /* std::pair */
+#include <vector>
 
 typedef std::pair<double, double> point;
 #define x first
@@ -39,12 +89,12 @@ double rec(It lo, It hi, std::pair<point, point> & res, double mindist) {
   int size = 0;
   It t[hi - lo];
   for (It it = lo; it != hi; ++it)
-    if (fabs(it->x - midx) < mindist)
+    if ((it->x - midx) * (it->x - midx) < mindist)
       t[size++] = it;
   for (int i = 0; i < size; i++) {
     for (int j = i + 1; j < size; j++) {
       point a = *t[i], b = *t[j];
-      if (b.y - a.y >= mindist) break;
+      if ((b.y - a.y) * (b.y - a.y) >= mindist) break;
       double dist = sqdist(a, b);
       if (mindist > dist) {
         mindist = dist;
@@ -62,10 +112,320 @@ template<class It> std::pair<point, point> closest_pair(It lo, It hi) {
   return res;
 }
 
+//a batch of points stored as separate arrays of coordinates
+struct point_batch {
+  std::vector<double> x, y;
+
+  int size() const { return x.size(); }
+  point operator [] (int i) const { return point(x[i], y[i]); }
+
+  void push_back(const point & p) {
+    x.push_back(p.x);
+    y.push_back(p.y);
+  }
+};
+
+class batch_closest_pair {
+  //the coordinates and original indices of the points, and buffers for
+  //merging and for the strip
+  std::vector<double> x, y, bx, by;
+  std::vector<int> id, bid;
+  double best;
+
+  void merge(int lo, int mid, int hi) {
+    int i = lo, j = mid, k = 0;
+    while (i < mid || j < hi) {
+      int s = (j == hi || (i < mid && y[i] <= y[j])) ? i++ : j++;
+      bx[k] = x[s];
+      by[k] = y[s];
+      bid[k++] = id[s];
+    }
+    std::copy(bx.begin(), bx.begin() + k, x.begin() + lo);
+    std::copy(by.begin(), by.begin() + k, y.begin() + lo);
+    std::copy(bid.begin(), bid.begin() + k, id.begin() + lo);
+  }
+
+  void check(double ax, double ay, int a, double cx, double cy, int c) {
+    double dx = ax - cx, dy = ay - cy, d = dx * dx + dy * dy;
+    if (d < best) {
+      best = d;
+      res = std::make_pair(a, c);
+    }
+  }
+
+  //on return, [lo, hi) is sorted by y
+  void rec(int lo, int hi) {
+    if (hi - lo <= 3) {
+      for (int i = lo; i < hi; i++)
+        for (int j = i + 1; j < hi; j++)
+          check(x[i], y[i], id[i], x[j], y[j], id[j]);
+      for (int i = lo + 1; i < hi; i++)
+        for (int j = i; j > lo && y[j] < y[j - 1]; j--) {
+          std::swap(x[j], x[j - 1]);
+          std::swap(y[j], y[j - 1]);
+          std::swap(id[j], id[j - 1]);
+        }
+      return;
+    }
+    int mid = lo + (hi - lo) / 2;
+    double midx = x[mid];
+    rec(lo, mid);
+    rec(mid, hi);
+    merge(lo, mid, hi);
+    int k = 0;
+    for (int i = lo; i < hi; i++) {
+      double dx = x[i] - midx;
+      if (dx * dx < best) {
+        for (int j = k - 1; j >= 0; j--) {
+          double dy = y[i] - by[j];
+          if (dy * dy >= best) break;
+          check(bx[j], by[j], bid[j], x[i], y[i], id[i]);
+        }
+        bx[k] = x[i];
+        by[k] = y[i];
+        bid[k++] = id[i];
+      }
+    }
+  }
+
+ public:
+  std::pair<int, int> res;
+
+  explicit batch_closest_pair(const point_batch & b)
+      : x(b.size()), y(b.size()), bx(b.size()), by(b.size()),
+        id(b.size()), bid(b.size()), best(DBL_MAX), res(0, 1) {
+    int n = b.size();
+    std::vector<std::pair<double, int> > order(n);
+    for (int i = 0; i < n; i++) order[i] = std::make_pair(b.x[i], i);
+    std::sort(order.begin(), order.end());
+    for (int i = 0; i < n; i++) {
+      id[i] = order[i].second;
+      x[i] = b.x[id[i]];
+      y[i] = b.y[id[i]];
+    }
+    rec(0, n);
+  }
+};
+
+std::pair<int, int> closest_pair(const point_batch & b) {
+  return batch_closest_pair(b).res;
+}
+
+//a hash table with linear probing from the cells of a grid to the last
+//point inserted into each, where the points of a cell are chained by
+//index, and clear() empties it in O(1) by advancing the generation
+class cell_table {
+  struct slot_t {
+    long long cx, cy;
+    int head, gen;
+  };
+
+  std::vector<slot_t> slots;
+  std::vector<int> next;
+  int gen;
+  unsigned long long mask;
+
+  //the slot of cell (cx, cy), or the empty slot where it would go
+  unsigned long long find(long long cx, long long cy) const {
+    unsigned long long h = (unsigned long long)cx * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (unsigned long long)cy) * 0xc2b2ae3d27d4eb4fULL;
+    unsigned long long i = (h >> 32) & mask;
+    while (slots[i].gen == gen && (slots[i].cx != cx || slots[i].cy != cy))
+      i = (i + 1) & mask;
+    return i;
+  }
+
+ public:
+  //holds the points with indices in [0, n)
+  explicit cell_table(int n) : next(n), gen(1), mask(15) {
+    while (mask + 1 < 2 * (unsigned long long)n) mask = 2 * mask + 1;
+    slot_t empty = {0, 0, -1, 0};
+    slots.assign(mask + 1, empty);
+  }
+
+  void clear() { gen++; }
+
+  void insert(long long cx, long long cy, int i) {
+    slot_t & s = slots[find(cx, cy)];
+    if (s.gen != gen) {
+      s.cx = cx;
+      s.cy = cy;
+      s.head = -1;
+      s.gen = gen;
+    }
+    next[i] = s.head;
+    s.head = i;
+  }
+
+  //the first point of cell (cx, cy), then follow next_in_cell() until -1
+  int first(long long cx, long long cy) const {
+    const slot_t & s = slots[find(cx, cy)];
+    return s.gen == gen ? s.head : -1;
+  }
+
+  int next_in_cell(int i) const { return next[i]; }
+};
+
+//cells are made slightly larger than needed, allowing for the rounding
+//of the cell coordinates
+const double grid_slack = 1 + 1e-9;
+
+long long cell_of(double v, double inv) { return (long long)floor(v * inv); }
+
+std::pair<int, int> closest_pair_grid(const point_batch & b) {
+  //a shuffled copy, so that the grid is rebuilt from consecutive points
+  int n = b.size();
+  if (n < 2) return std::make_pair(0, 1);
+  std::vector<int> id(n);
+  for (int i = 0; i < n; i++) id[i] = i;
+  std::random_shuffle(id.begin(), id.end());
+  std::vector<double> x(n), y(n);
+  for (int i = 0; i < n; i++) {
+    x[i] = b.x[id[i]];
+    y[i] = b.y[id[i]];
+  }
+  int r1 = 0, r2 = 1;
+  double best = sqdist(point(x[0], y[0]), point(x[1], y[1])), inv = 0;
+  cell_table t(n);
+  for (int i = 0; i < n && best > 0; i++) {
+    if (i == 2) {
+      inv = 1 / (sqrt(best) * grid_slack);
+      for (int j = 0; j < 2; j++)
+        t.insert(cell_of(x[j], inv), cell_of(y[j], inv), j);
+    }
+    if (i < 2) continue;
+    long long cx = cell_of(x[i], inv), cy = cell_of(y[i], inv);
+    double d = best;
+    for (long long u = cx - 1; u <= cx + 1; u++) {
+      for (long long v = cy - 1; v <= cy + 1; v++) {
+        for (int j = t.first(u, v); j != -1; j = t.next_in_cell(j)) {
+          double dx = x[j] - x[i], dy = y[j] - y[i];
+          if (dx * dx + dy * dy < d) {
+            d = dx * dx + dy * dy;
+            r1 = j;
+            r2 = i;
+          }
+        }
+      }
+    }
+    if (d < best) {
+      best = d;
+      if (best > 0) {
+        inv = 1 / (sqrt(best) * grid_slack);
+        t.clear();
+        for (int j = 0; j <= i; j++)
+          t.insert(cell_of(x[j], inv), cell_of(y[j], inv), j);
+      }
+    } else {
+      t.insert(cx, cy, i);
+    }
+  }
+  return std::make_pair(id[r1], id[r2]);
+}
+
+class nearest_neighbor_grid {
+  //the coordinates and original indices of the points in order of their
+  //cells, the position of each point in that order, and the position of
+  //the first point of each cell, which are numbered by rows
+  std::vector<double> x, y;
+  std::vector<int> id, pos, start;
+  double lx, ly, inv, side;
+  int w, h;
+
+  void scan(int c, int k, double & best, int & res) const {
+    for (int j = start[c]; j < start[c + 1]; j++) {
+      double dx = x[j] - x[k], dy = y[j] - y[k];
+      if (j != k && dx * dx + dy * dy < best) {
+        best = dx * dx + dy * dy;
+        res = j;
+      }
+    }
+  }
+
+ public:
+  //requires at least two points
+  explicit nearest_neighbor_grid(const point_batch & b)
+      : x(b.size()), y(b.size()), id(b.size()), pos(b.size()) {
+    int n = b.size();
+    lx = *std::min_element(b.x.begin(), b.x.end());
+    ly = *std::min_element(b.y.begin(), b.y.end());
+    double wx = *std::max_element(b.x.begin(), b.x.end()) - lx;
+    double wy = *std::max_element(b.y.begin(), b.y.end()) - ly;
+    //about 2 points per cell, and at most n/2 cells along either side
+    side = std::max(sqrt(2 * wx * wy / n), 2 * std::max(wx, wy) / n);
+    if (side == 0) side = 1;
+    inv = 1 / side;
+    w = std::min((int)(wx * inv), n) + 1;
+    h = std::min((int)(wy * inv), n) + 1;
+    std::vector<int> cell(n);
+    start.assign(w * h + 1, 0);
+    for (int i = 0; i < n; i++) {
+      int u = std::min((int)((b.x[i] - lx) * inv), w - 1);
+      int v = std::min((int)((b.y[i] - ly) * inv), h - 1);
+      start[(cell[i] = v * w + u) + 1]++;
+    }
+    for (int c = 0; c < w * h; c++) start[c + 1] += start[c];
+    std::vector<int> fill(start.begin(), start.end() - 1);
+    for (int i = 0; i < n; i++) {
+      int k = fill[cell[i]]++;
+      x[k] = b.x[i];
+      y[k] = b.y[i];
+      id[k] = i;
+      pos[i] = k;
+    }
+  }
+
+  int size() const { return id.size(); }
+
+  //the index of the k-th point in order of cells, so that nearby points
+  //may be answered together
+  int point_at(int k) const { return id[k]; }
+
+  //the index of a point nearest to the i-th point, other than itself
+  int nearest(int i) const {
+    int k = pos[i];
+    int cu = std::min((int)((x[k] - lx) * inv), w - 1);
+    int cv = std::min((int)((y[k] - ly) * inv), h - 1);
+    double best = DBL_MAX;
+    int res = -1;
+    for (int r = 0; best > 0; r++) {
+      //the ring of cells at distance r, clipped to the grid
+      int ulo = std::max(cu - r, 0), uhi = std::min(cu + r, w - 1);
+      int vlo = std::max(cv - r + 1, 0), vhi = std::min(cv + r - 1, h - 1);
+      for (int u = ulo; u <= uhi; u++) {
+        if (cv - r >= 0) scan((cv - r) * w + u, k, best, res);
+        if (r > 0 && cv + r < h) scan((cv + r) * w + u, k, best, res);
+      }
+      for (int v = vlo; v <= vhi; v++) {
+        if (cu - r >= 0) scan(v * w + cu - r, k, best, res);
+        if (r > 0 && cu + r < w) scan(v * w + cu + r, k, best, res);
+      }
+      //every point not yet scanned is at least r sides away
+      double reach = r * side / grid_slack;
+      if (res != -1 && best <= reach * reach) break;
+      if (cu - r <= 0 && cu + r >= w - 1 && cv - r <= 0 && cv + r >= h - 1)
+        break;
+    }
+    return id[res];
+  }
+};
+
+void all_nearest_neighbors(const point_batch & b, int res[]) {
+  if (b.size() < 2) {
+    if (b.size() == 1) res[0] = -1;
+    return;
+  }
+  nearest_neighbor_grid g(b);
+  for (int k = 0; k < g.size(); k++) {
+    int i = g.point_at(k);
+    res[i] = g.nearest(i);
+  }
+}
+
 /*** Example Usage ***/
 
+#include <cassert>
 #include <iostream>
-#include <vector>
 using namespace std;
 
 int main() {
@@ -80,5 +440,32 @@ int main() {
   cout << "closest pair: (" << res.first.x << "," << res.first.y << ") ";
   cout << "(" << res.second.x << "," << res.second.y << ")\n";
   cout << "dist: " << sqrt(sqdist(res.first, res.second)) << "\n"; //1.41421
+
+  //the batch version, which finds the indices of the same pair
+  point_batch b;
+  for (int i = 0; i < (int)v.size(); i++) b.push_back(v[i]);
+  pair<int, int> ij = closest_pair(b);
+  assert(sqdist(b[ij.first], b[ij.second]) == sqdist(res.first, res.second));
+  ij = closest_pair_grid(b);
+  assert(sqdist(b[ij.first], b[ij.second]) == sqdist(res.first, res.second));
+
+  //the nearest neighbor of every point
+  point_batch c;
+  c.push_back(point(0, 0));
+  c.push_back(point(1, 0));
+  c.push_back(point(3, 0));
+  c.push_back(point(7, 1));
+  c.push_back(point(7, 3));
+  int nn[5];
+  all_nearest_neighbors(c, nn);
+  assert(nn[0] == 1 && nn[1] == 0 && nn[2] == 1 && nn[3] == 4 && nn[4] == 3);
+
+  //fewer than two points have no pair
+  point_batch one;
+  one.push_back(point(1, 2));
+  assert(closest_pair(one) == make_pair(0, 1));
+  assert(closest_pair_grid(one) == make_pair(0, 1));
+  all_nearest_neighbors(one, nn);
+  assert(nn[0] == -1);
   return 0;
 }
@@ -4,64 +4,222 @@ Given a range of segments on the Cartesian plane, identify one
 pair of segments which intersect each other. This is done using
 a sweep line algorithm.
 
+Every test of which side of a segment a point lies on is decided by
+the robust orient2d() predicate of section 5.1.4, so that the ordering
+of the sweep line stays consistent and nearly touching segments are
+classified exactly, without an epsilon.
+
 Time Complexity: O(n log n) where n is the number of segments.
 
+all_intersections(s) reports every pair of intersecting segments in the
+vector s by the Bentley-Ottmann sweep, as extended to degenerate inputs
+by de Berg et al. Each event point handles together the segments which
+start at it, end at it, and pass through it, so that any number of
+segments may meet at a point, and segments may be vertical, overlap, or
+have zero length. Every such pair is reported once, at the first point
+(in order of x, then y) that the two segments share, together with an
+approximation of that point.
+
+The event points are the endpoints and the crossings found between
+segments adjacent on the sweep line. Since a crossing is generally not
+representable in doubles, it is kept as an approximation with a bound
+on its error, and as the pair of segments defining it, from which its
+exact value as the rational point (X/D, Y/D) of expansions (see section
+5.1.4) is computed whenever the approximations are not far enough apart
+to decide the order of two events, or the side of a segment on which
+an event lies. All such decisions are thus exact. The
+events are kept in a binary heap, and the sweep line in a treap whose
+nodes are in a pool, with parent pointers and links to the neighboring
+nodes, so that a segment may be removed by its node and its neighbors
+found in O(1).
+
+segment_grid is an alternative for many short segments spread densely
+over a region, such as the roads of a map. It buckets the segments by
+the cells of a uniform grid over their bounding boxes, with about as
+many cells as segments, then tests the pairs within each cell, each of
+which is reported from the one cell holding the lower left corner of
+the overlap of their bounding boxes. The cells are independent of each
+other, and all_intersections_grid(s) reports them in order.
+
+Time Complexity: O((n + k) log n) for all_intersections(), where k is
+the number of intersecting pairs. O(n + m + p) for the grid, where m is
+the total number of cells covered by the bounding boxes of segments
+and p is the number of pairs of segments in the same cell.
+
 */
 
 #include <algorithm> /* std::min(), std::max(), std::sort() */
-#include <cmath>     /* fabs() */
+#include <cmath>     /* fabs(), sqrt() */
+#include <queue>     /* std::priority_queue */
 #include <set>
 #include <utility>   /* std::pair */
+#include <vector>
 
 typedef std::pair<double, double> point;
 #define x first
 #define y second
 
-const double eps = 1e-9;
+//robust orientation by exact expansion arithmetic (see section 5.1.4)
+
+//a sum of nonoverlapping doubles in order of increasing magnitude
+typedef std::vector<double> expansion;
 
-#define EQ(a, b) (fabs((a) - (b)) <= eps)  /* equal to */
-#define LT(a, b) ((a) < (b) - eps)         /* less than */
-#define LE(a, b) ((a) <= (b) + eps)        /* less than or equal to */
+//half the distance between 1 and the next double, i.e. 2^-53
+const double round_eps = 1.1102230246251565e-16;
+const double ccw_bound = (3 + 16 * round_eps) * round_eps;
 
-double norm(const point & a) { return a.x * a.x + a.y * a.y; }
-double dot(const point & a, const point & b) { return a.x * b.x + a.y * b.y; }
-double cross(const point & a, const point & b) { return a.x * b.y - a.y * b.x; }
-double cross(const point & o, const point & a, const point & b) {
-  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+//s + t = a + b exactly, where s is the rounded sum
+void two_sum(double a, double b, double & s, double & t) {
+  s = a + b;
+  double bv = s - a, av = s - bv;
+  t = (a - av) + (b - bv);
 }
 
-const bool TOUCH_IS_INTERSECT = true;
+//hi + lo = a exactly, where each half has at most 26 significant bits
+void split(double a, double & hi, double & lo) {
+  double c = 134217729.0 * a; //2^27 + 1
+  hi = c - (c - a);
+  lo = a - hi;
+}
+
+//p + t = a*b exactly, where p is the rounded product
+void two_product(double a, double b, double & p, double & t) {
+  p = a * b;
+  double ahi, alo, bhi, blo;
+  split(a, ahi, alo);
+  split(b, bhi, blo);
+  t = alo * blo - (((p - ahi * bhi) - alo * bhi) - ahi * blo);
+}
+
+//the exact difference a - b
+expansion difference(double a, double b) {
+  expansion e;
+  double s, t;
+  two_sum(a, -b, s, t);
+  if (t != 0) e.push_back(t);
+  if (s != 0) e.push_back(s);
+  return e;
+}
+
+//merges the components by magnitude, then accumulates them in order
+expansion sum(const expansion & e, const expansion & f) {
+  expansion h;
+  int m = e.size(), n = f.size(), i = 0, j = 0;
+  h.reserve(m + n);
+  double q = 0, s, t;
+  while (i < m || j < n) {
+    double g = (j == n || (i < m && fabs(e[i]) < fabs(f[j]))) ? e[i++] : f[j++];
+    two_sum(q, g, s, t);
+    if (t != 0) h.push_back(t);
+    q = s;
+  }
+  if (q != 0) h.push_back(q);
+  return h;
+}
+
+expansion scale(const expansion & e, double b) {
+  expansion h;
+  h.reserve(2 * e.size());
+  double q = 0, p, pt, s, t;
+  for (int i = 0; i < (int)e.size(); i++) {
+    two_product(e[i], b, p, pt);
+    two_sum(q, pt, s, t);
+    if (t != 0) h.push_back(t);
+    two_sum(p, s, q, t);
+    if (t != 0) h.push_back(t);
+  }
+  if (q != 0) h.push_back(q);
+  return h;
+}
+
+expansion product(const expansion & e, const expansion & f) {
+  expansion h;
+  for (int i = 0; i < (int)f.size(); i++) h = sum(h, scale(e, f[i]));
+  return h;
+}
+
+expansion negate(expansion e) {
+  for (int i = 0; i < (int)e.size(); i++) e[i] = -e[i];
+  return e;
+}
+
+//an approximation of the value of e with the same sign
+double estimate(const expansion & e) {
+  return e.empty() ? 0 : e.back();
+}
+
+//the same value in as few components as possible
+expansion compress(const expansion & e) {
+  int m = e.size(), bottom = m - 1;
+  if (m == 0) return e;
+  expansion g(m), h;
+  double q = e[m - 1], s, t;
+  for (int i = m - 2; i >= 0; i--) {
+    s = q + e[i];
+    t = e[i] - (s - q);
+    if (t != 0) {
+      g[bottom--] = s;
+      q = t;
+    } else {
+      q = s;
+    }
+  }
+  g[bottom] = q;
+  for (int i = bottom + 1; i < m; i++) {
+    s = g[i] + q;
+    t = q - (s - g[i]);
+    if (t != 0) h.push_back(t);
+    q = s;
+  }
+  h.push_back(q);
+  return h;
+}
+
+//the sum of the components, within 2*m*round_eps of the value
+double approximate(const expansion & e) {
+  double s = 0;
+  for (int i = 0; i < (int)e.size(); i++) s += e[i];
+  return s;
+}
+
+double orient2d_exact(double ax, double ay, double bx, double by,
+                      double cx, double cy) {
+  expansion l = product(difference(ax, cx), difference(by, cy));
+  expansion r = product(difference(ay, cy), difference(bx, cx));
+  return estimate(sum(l, negate(r)));
+}
 
-bool contain(const double & l, const double & m, const double & h) {
-  if (TOUCH_IS_INTERSECT) return LE(l, m) && LE(m, h);
-  return LT(l, m) && LT(m, h);
+double orient2d(double ax, double ay, double bx, double by,
+                double cx, double cy) {
+  double l = (ax - cx) * (by - cy), r = (ay - cy) * (bx - cx);
+  double det = l - r, bound = ccw_bound * (fabs(l) + fabs(r));
+  if (det > bound || -det > bound) return det;
+  return orient2d_exact(ax, ay, bx, by, cx, cy);
 }
 
-bool overlap(const double & l1, const double & h1,
-             const double & l2, const double & h2) {
-  if (TOUCH_IS_INTERSECT) return LE(l1, h2) && LE(l2, h1);
-  return LT(l1, h2) && LT(l2, h1);
+double orient2d(const point & a, const point & b, const point & c) {
+  return orient2d(a.x, a.y, b.x, b.y, c.x, c.y);
 }
 
+int sign(double v) { return (v > 0) - (v < 0); }
+
+const bool TOUCH_IS_INTERSECT = true;
+
+//-1 if the segments ab and cd are disjoint, 0 if they meet at one
+//point, and 1 if they overlap along a segment
 int seg_intersection(const point & a, const point & b,
                      const point & c, const point & d) {
-  point ab(b.x - a.x, b.y - a.y);
-  point ac(c.x - a.x, c.y - a.y);
-  point cd(d.x - c.x, d.y - c.y);
-  double c1 = cross(ab, cd), c2 = cross(ac, ab);
-  if (EQ(c1, 0) && EQ(c2, 0)) {
-    double t0 = dot(ac, ab) / norm(ab);
-    double t1 = t0 + dot(cd, ab) / norm(ab);
-    if (overlap(std::min(t0, t1), std::max(t0, t1), 0, 1)) {
-      point res1 = std::max(std::min(a, b), std::min(c, d));
-      point res2 = std::min(std::max(a, b), std::max(c, d));
-      return (res1 == res2) ? 0 : 1;
-    }
-    return -1;
-  }
-  if (EQ(c1, 0)) return -1;
-  double t = cross(ac, cd) / c1, u = c2 / c1;
-  if (contain(0, t, 1) && contain(0, u, 1)) return 0;
+  int o1 = sign(orient2d(a, b, c)), o2 = sign(orient2d(a, b, d));
+  int o3 = sign(orient2d(c, d, a)), o4 = sign(orient2d(c, d, b));
+  if (o1 == 0 && o2 == 0 && o3 == 0 && o4 == 0) { //collinear
+    //lexicographic order is monotonic along the common line
+    point res1 = std::max(std::min(a, b), std::min(c, d));
+    point res2 = std::min(std::max(a, b), std::max(c, d));
+    if (res2 < res1 || (!TOUCH_IS_INTERSECT && res1 == res2)) return -1;
+    return (res1 == res2) ? 0 : 1;
+  }
+  if (TOUCH_IS_INTERSECT && o1 * o2 <= 0 && o3 * o4 <= 0) return 0;
+  if (o1 * o2 < 0 && o3 * o4 < 0) return 0;
   return -1;
 }
 
@@ -81,10 +239,10 @@ struct segment {
 
   bool operator < (const segment & rhs) const {
     if (p.x < rhs.p.x) {
-      double c = cross(p, q, rhs.p);
+      double c = orient2d(p, q, rhs.p);
       if (c != 0) return c > 0;
     } else if (p.x > rhs.p.x) {
-      double c = cross(rhs.p, rhs.q, q);
+      double c = orient2d(rhs.p, rhs.q, q);
       if (c != 0) return c < 0;
     }
     return p.y < rhs.p.y;
@@ -160,10 +318,496 @@ bool find_intersection(It lo, It hi, segment * res1, segment * res2) {
   return false;
 }
 
+struct intersection {
+  int a, b; //the indices of the segments, with a < b
+  point p;  //an approximation of the first point they share
+};
+
+//an event point, which is either exactly (x, y) when k is -1, or else
+//the k-th rational point of a sweep, for which (x, y) is within (ex, ey)
+struct sweep_point {
+  double x, y, ex, ey;
+  int k;
+
+  sweep_point() {}
+  sweep_point(const point & p) : x(p.x), y(p.y), ex(0), ey(0), k(-1) {}
+};
+
+class segment_sweep {
+  //the crossing of segments i and j, which is the point (X/D, Y/D) with
+  //D > 0, computed only when needed
+  struct rational_point {
+    int i, j;
+    bool done;
+    expansion X, Y, D;
+  };
+
+  //a node of the treap of segments on the sweep line, from the bottom
+  struct node {
+    int seg, left, right, parent, prev, next;
+    unsigned int prio;
+  };
+
+  struct event {
+    sweep_point p;
+    int seg; //the segment starting at p, or -1 for any other event
+  };
+
+  struct later {
+    const segment_sweep * s;
+    later(const segment_sweep * s) : s(s) {}
+    bool operator () (const event & a, const event & b) const {
+      return s->compare(a.p, b.p) > 0;
+    }
+  };
+
+  const std::vector<segment> & s;
+  mutable std::vector<rational_point> rat;
+  std::vector<node> pool;
+  std::vector<int> free_nodes, node_of, mark;
+  int root, stamp;
+  unsigned int seed;
+  std::priority_queue<event, std::vector<event>, later> events;
+  sweep_point cur;
+
+  expansion one_of(double v) const { return expansion(1, v); }
+
+  const rational_point & exact(int k) const {
+    rational_point & q = rat[k];
+    if (q.done) return q;
+    const point & a = s[q.i].p, & b = s[q.i].q;
+    const point & c = s[q.j].p, & d = s[q.j].q;
+    expansion dx = difference(b.x, a.x), dy = difference(b.y, a.y);
+    expansion ex = difference(d.x, c.x), ey = difference(d.y, c.y);
+    expansion den = sum(product(dx, ey), negate(product(dy, ex)));
+    expansion num = sum(product(difference(c.x, a.x), ey),
+                        negate(product(difference(c.y, a.y), ex)));
+    q.X = compress(sum(scale(den, a.x), product(num, dx)));
+    q.Y = compress(sum(scale(den, a.y), product(num, dy)));
+    q.D = compress(den);
+    if (estimate(q.D) < 0) {
+      q.X = negate(q.X);
+      q.Y = negate(q.Y);
+      q.D = negate(q.D);
+    }
+    q.done = true;
+    return q;
+  }
+
+  bool same_pair(int k, int l) const {
+    return (rat[k].i == rat[l].i && rat[k].j == rat[l].j) ||
+           (rat[k].i == rat[l].j && rat[k].j == rat[l].i);
+  }
+
+  void exact(const sweep_point & p, expansion & X, expansion & Y,
+             expansion & D) const {
+    if (p.k >= 0) {
+      exact(p.k);
+      X = rat[p.k].X;
+      Y = rat[p.k].Y;
+      D = rat[p.k].D;
+    } else {
+      X = one_of(p.x);
+      Y = one_of(p.y);
+      D = one_of(1);
+    }
+  }
+
+  //the order of a and b by x when c is 0, or else by y
+  int compare(const sweep_point & a, const sweep_point & b, int c) const {
+    double d = c == 0 ? a.x - b.x : a.y - b.y;
+    double err = c == 0 ? a.ex + b.ex : a.ey + b.ey;
+    if (d > err) return 1;
+    if (-d > err) return -1;
+    if (a.k == b.k || (a.k >= 0 && b.k >= 0 && same_pair(a.k, b.k))) return 0;
+    expansion AX, AY, AD, BX, BY, BD;
+    exact(a, AX, AY, AD);
+    exact(b, BX, BY, BD);
+    expansion l = product(c == 0 ? AX : AY, BD);
+    expansion r = product(c == 0 ? BX : BY, AD);
+    return sign(estimate(sum(l, negate(r))));
+  }
+
+ public:
+  //the order of events, by x and then by y
+  int compare(const sweep_point & a, const sweep_point & b) const {
+    int c = compare(a, b, 0);
+    return c != 0 ? c : compare(a, b, 1);
+  }
+
+ private:
+  //1 if p is above the line of segment i, -1 if below, and 0 if on it
+  int side(int i, const sweep_point & p) const {
+    const point & a = s[i].p, & b = s[i].q;
+    if (p.k < 0) {
+      point q(p.x, p.y);
+      return (q == a || q == b) ? 0 : sign(orient2d(a, b, q));
+    }
+    if (rat[p.k].i == i || rat[p.k].j == i) return 0;
+    double dx = b.x - a.x, dy = b.y - a.y;
+    double l = dx * (p.y - a.y), r = dy * (p.x - a.x), det = l - r;
+    double err = (fabs(dx) * p.ey + fabs(dy) * p.ex) * (1 + 8 * round_eps) +
+                 8 * round_eps * (fabs(l) + fabs(r));
+    if (det > err) return 1;
+    if (-det > err) return -1;
+    const rational_point & q = exact(p.k);
+    expansion u = product(difference(b.x, a.x),
+                          sum(q.Y, negate(scale(q.D, a.y))));
+    expansion v = product(difference(b.y, a.y),
+                          sum(q.X, negate(scale(q.D, a.x))));
+    return sign(estimate(sum(u, negate(v))));
+  }
+
+  //1 if segment j turns counterclockwise from segment i, -1 if
+  //clockwise, and 0 if they are parallel
+  int turn(int i, int j) const {
+    const point & a = s[i].p, & b = s[i].q, & c = s[j].p, & d = s[j].q;
+    double l = (b.x - a.x) * (d.y - c.y), r = (b.y - a.y) * (d.x - c.x);
+    if (l - r > 8 * round_eps * (fabs(l) + fabs(r))) return 1;
+    if (r - l > 8 * round_eps * (fabs(l) + fabs(r))) return -1;
+    expansion u = product(difference(b.x, a.x), difference(d.y, c.y));
+    expansion v = product(difference(b.y, a.y), difference(d.x, c.x));
+    return sign(estimate(sum(u, negate(v))));
+  }
+
+  //the crossing of segments i and j, which must cross properly, as a
+  //point a + t*(b - a) computed in doubles along with a bound on its
+  //error, or from its exact value if the bound is too large
+  sweep_point crossing(int i, int j) {
+    const point & a = s[i].p, & b = s[i].q, & c = s[j].p, & d = s[j].q;
+    double dx = b.x - a.x, dy = b.y - a.y, ex = d.x - c.x, ey = d.y - c.y;
+    double fx = c.x - a.x, fy = c.y - a.y;
+    double den = dx * ey - dy * ex, num = fx * ey - fy * ex;
+    double eden = 8 * round_eps * (fabs(dx * ey) + fabs(dy * ex));
+    double enum_ = 8 * round_eps * (fabs(fx * ey) + fabs(fy * ex));
+    rational_point q;
+    q.i = i;
+    q.j = j;
+    q.done = false;
+    sweep_point p;
+    p.k = rat.size();
+    rat.push_back(q);
+    if (fabs(den) > 4 * eden) {
+      double t = num / den;
+      double et = (enum_ + fabs(t) * eden) / (fabs(den) - eden) +
+                  round_eps * fabs(t);
+      p.x = a.x + t * dx;
+      p.y = a.y + t * dy;
+      p.ex = 2 * (fabs(dx) * et + 3 * round_eps * (fabs(p.x) + fabs(t * dx)));
+      p.ey = 2 * (fabs(dy) * et + 3 * round_eps * (fabs(p.y) + fabs(t * dy)));
+    } else {
+      const rational_point & r = exact(p.k);
+      double D = approximate(r.D);
+      p.x = approximate(r.X) / D;
+      p.y = approximate(r.Y) / D;
+      double m = 2.0 * (r.X.size() + r.Y.size() + r.D.size() + 2);
+      p.ex = 2 * fabs(p.x) * m * round_eps;
+      p.ey = 2 * fabs(p.y) * m * round_eps;
+    }
+    return p;
+  }
+
+  //whether segment i lies below segment j just after the current event,
+  //where i passes through it
+  bool below(int i, int j) const {
+    int c = side(j, cur);
+    if (c != 0) return c < 0;
+    c = turn(i, j);
+    return c != 0 ? c > 0 : i < j;
+  }
+
+  void rotate(int n) {
+    int p = pool[n].parent, g = pool[p].parent;
+    if (pool[p].left == n) {
+      pool[p].left = pool[n].right;
+      if (pool[n].right != -1) pool[pool[n].right].parent = p;
+      pool[n].right = p;
+    } else {
+      pool[p].right = pool[n].left;
+      if (pool[n].left != -1) pool[pool[n].left].parent = p;
+      pool[n].left = p;
+    }
+    pool[p].parent = n;
+    pool[n].parent = g;
+    if (g == -1) root = n;
+    else if (pool[g].left == p) pool[g].left = n;
+    else pool[g].right = n;
+  }
+
+  void insert(int i) {
+    int n;
+    if (free_nodes.empty()) {
+      n = pool.size();
+      pool.push_back(node());
+    } else {
+      n = free_nodes.back();
+      free_nodes.pop_back();
+    }
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    node & x = pool[n];
+    x.seg = i;
+    x.left = x.right = x.parent = x.prev = x.next = -1;
+    x.prio = seed;
+    node_of[i] = n;
+    for (int t = root; t != -1; ) {
+      pool[n].parent = t;
+      if (below(i, pool[t].seg)) {
+        pool[n].next = t;
+        if (pool[t].left == -1) {
+          pool[t].left = n;
+          break;
+        }
+        t = pool[t].left;
+      } else {
+        pool[n].prev = t;
+        if (pool[t].right == -1) {
+          pool[t].right = n;
+          break;
+        }
+        t = pool[t].right;
+      }
+    }
+    if (root == -1) root = n;
+    if (pool[n].prev != -1) pool[pool[n].prev].next = n;
+    if (pool[n].next != -1) pool[pool[n].next].prev = n;
+    while (pool[n].parent != -1 && pool[pool[n].parent].prio < pool[n].prio)
+      rotate(n);
+  }
+
+  void erase(int n) {
+    while (pool[n].left != -1 || pool[n].right != -1) {
+      int l = pool[n].left, r = pool[n].right;
+      rotate((r == -1 || (l != -1 && pool[l].prio > pool[r].prio)) ? l : r);
+    }
+    int p = pool[n].parent;
+    if (p == -1) root = -1;
+    else if (pool[p].left == n) pool[p].left = -1;
+    else pool[p].right = -1;
+    if (pool[n].prev != -1) pool[pool[n].prev].next = pool[n].next;
+    if (pool[n].next != -1) pool[pool[n].next].prev = pool[n].prev;
+    free_nodes.push_back(n);
+  }
+
+  //schedules the crossing of the segments of nodes m and n, if any
+  void check(int m, int n) {
+    if (m == -1 || n == -1) return;
+    int i = pool[m].seg, j = pool[n].seg;
+    const point & a = s[i].p, & b = s[i].q, & c = s[j].p, & d = s[j].q;
+    if (sign(orient2d(a, b, c)) * sign(orient2d(a, b, d)) >= 0 ||
+        sign(orient2d(c, d, a)) * sign(orient2d(c, d, b)) >= 0)
+      return; //any touching is at an endpoint, which is already an event
+    event e;
+    e.p = crossing(i, j);
+    e.seg = -1;
+    if (compare(e.p, cur) > 0) events.push(e);
+    else rat.pop_back();
+  }
+
+  bool collinear(int i, int j) const {
+    return orient2d(s[i].p, s[i].q, s[j].p) == 0 &&
+           orient2d(s[i].p, s[i].q, s[j].q) == 0;
+  }
+
+  void report(int i, int j) {
+    intersection r;
+    r.a = std::min(i, j);
+    r.b = std::max(i, j);
+    r.p = point(cur.x, cur.y);
+    res.push_back(r);
+  }
+
+ public:
+  std::vector<intersection> res;
+
+  explicit segment_sweep(const std::vector<segment> & s)
+      : s(s), node_of(s.size(), -1), mark(s.size(), 0), root(-1),
+        stamp(0), seed(2463534242u), events(later(this)) {
+    for (int i = 0; i < (int)s.size(); i++) {
+      event e;
+      e.p = sweep_point(s[i].p);
+      e.seg = i;
+      events.push(e);
+      e.p = sweep_point(s[i].q);
+      e.seg = -1;
+      events.push(e);
+    }
+    std::vector<int> upper, through;
+    while (!events.empty()) {
+      cur = events.top().p;
+      upper.clear();
+      while (!events.empty() && compare(events.top().p, cur) == 0) {
+        if (events.top().seg >= 0) upper.push_back(events.top().seg);
+        events.pop();
+      }
+      //the segments on the sweep line through cur are consecutive
+      int first = -1, below_cur = -1;
+      for (int n = root; n != -1; ) {
+        if (side(pool[n].seg, cur) > 0) {
+          below_cur = n;
+          n = pool[n].right;
+        } else {
+          first = n;
+          n = pool[n].left;
+        }
+      }
+      through.clear();
+      for (int n = first; n != -1 && side(pool[n].seg, cur) == 0;
+           n = pool[n].next)
+        through.push_back(pool[n].seg);
+      int above_cur = first;
+      for (int k = 0; k < (int)through.size(); k++)
+        above_cur = pool[above_cur].next;
+      //pairs of overlapping segments are reported where the later starts
+      stamp++;
+      for (int k = 0; k < (int)upper.size(); k++) mark[upper[k]] = stamp;
+      for (int k = 0; k < (int)through.size(); k++) {
+        for (int l = k + 1; l < (int)through.size(); l++)
+          if (!collinear(through[k], through[l]))
+            report(through[k], through[l]);
+        for (int l = 0; l < (int)upper.size(); l++)
+          report(through[k], upper[l]);
+      }
+      for (int k = 0; k < (int)upper.size(); k++)
+        for (int l = k + 1; l < (int)upper.size(); l++)
+          report(upper[k], upper[l]);
+      //the segments continuing past cur are inserted in their new order
+      for (int k = 0; k < (int)through.size(); k++) {
+        erase(node_of[through[k]]);
+        node_of[through[k]] = -1;
+      }
+      stamp++;
+      int inserted = -1;
+      for (int k = 0; k < (int)through.size(); k++) {
+        if (compare(sweep_point(s[through[k]].q), cur) != 0) {
+          insert(inserted = through[k]);
+          mark[inserted] = stamp;
+        }
+      }
+      for (int k = 0; k < (int)upper.size(); k++) {
+        if (s[upper[k]].p != s[upper[k]].q) {
+          insert(inserted = upper[k]);
+          mark[inserted] = stamp;
+        }
+      }
+      if (inserted == -1) {
+        check(below_cur, above_cur);
+        continue;
+      }
+      int lo = node_of[inserted], hi = lo;
+      while (pool[lo].prev != -1 && mark[pool[pool[lo].prev].seg] == stamp)
+        lo = pool[lo].prev;
+      while (pool[hi].next != -1 && mark[pool[pool[hi].next].seg] == stamp)
+        hi = pool[hi].next;
+      check(pool[lo].prev, lo);
+      check(hi, pool[hi].next);
+    }
+  }
+};
+
+std::vector<intersection> all_intersections(const std::vector<segment> & s) {
+  return segment_sweep(s).res;
+}
+
+//an approximation of the first point shared by two intersecting segments
+point first_common_point(const segment & s, const segment & t) {
+  double c1 = orient2d(s.p, s.q, t.p), c2 = orient2d(s.p, s.q, t.q);
+  if (c1 == 0 && c2 == 0) return std::max(s.p, t.p);
+  if (c1 == 0) return t.p;
+  if (c2 == 0) return t.q;
+  if (orient2d(t.p, t.q, s.p) == 0) return s.p;
+  if (orient2d(t.p, t.q, s.q) == 0) return s.q;
+  double f = c1 / (c1 - c2);
+  return point(t.p.x + f * (t.q.x - t.p.x), t.p.y + f * (t.q.y - t.p.y));
+}
+
+class segment_grid {
+  const std::vector<segment> & s;
+  double lx, ly, inv;
+  int w, h;
+  std::vector<int> start, segs; //the segments of each cell, by rows
+
+  int cell_x(double v) const { return std::min((int)((v - lx) * inv), w - 1); }
+  int cell_y(double v) const { return std::min((int)((v - ly) * inv), h - 1); }
+
+ public:
+  explicit segment_grid(const std::vector<segment> & s) : s(s) {
+    int n = s.size();
+    double hx, hy;
+    lx = hx = n > 0 ? s[0].p.x : 0;
+    ly = hy = n > 0 ? s[0].p.y : 0;
+    for (int i = 0; i < n; i++) {
+      lx = std::min(lx, s[i].p.x);
+      hx = std::max(hx, s[i].q.x);
+      ly = std::min(ly, std::min(s[i].p.y, s[i].q.y));
+      hy = std::max(hy, std::max(s[i].p.y, s[i].q.y));
+    }
+    //about one cell per segment, and at most n along either side
+    double side = std::max(sqrt((hx - lx) * (hy - ly) / std::max(n, 1)),
+                           std::max(hx - lx, hy - ly) / std::max(n, 1));
+    inv = side > 0 ? 1 / side : 1;
+    w = std::min((int)((hx - lx) * inv), n) + 1;
+    h = std::min((int)((hy - ly) * inv), n) + 1;
+    start.assign(w * h + 1, 0);
+    for (int pass = 0; pass < 2; pass++) {
+      for (int i = 0; i < n; i++) {
+        int v0 = cell_y(std::min(s[i].p.y, s[i].q.y));
+        int v1 = cell_y(std::max(s[i].p.y, s[i].q.y));
+        for (int v = v0; v <= v1; v++) {
+          for (int u = cell_x(s[i].p.x); u <= cell_x(s[i].q.x); u++) {
+            if (pass == 0) start[v * w + u + 1]++;
+            else segs[start[v * w + u]++] = i;
+          }
+        }
+      }
+      if (pass == 0) {
+        for (int c = 0; c < w * h; c++) start[c + 1] += start[c];
+        segs.resize(start[w * h]);
+      } else { //each start[c] has advanced to where cell c + 1 begins
+        for (int c = w * h; c > 0; c--) start[c] = start[c - 1];
+        start[0] = 0;
+      }
+    }
+  }
+
+  int cells() const { return w * h; }
+
+  //appends the intersecting pairs reported from cell c to res
+  void report(int c, std::vector<intersection> & res) const {
+    for (int k = start[c]; k < start[c + 1]; k++) {
+      for (int l = k + 1; l < start[c + 1]; l++) {
+        const segment & a = s[segs[k]], & b = s[segs[l]];
+        //the lower left corner of the overlap of their bounding boxes
+        double ox = std::max(a.p.x, b.p.x);
+        double oy = std::max(std::min(a.p.y, a.q.y), std::min(b.p.y, b.q.y));
+        if (ox > std::min(a.q.x, b.q.x) ||
+            oy > std::min(std::max(a.p.y, a.q.y), std::max(b.p.y, b.q.y)) ||
+            cell_y(oy) * w + cell_x(ox) != c ||
+            seg_intersection(a.p, a.q, b.p, b.q) < 0)
+          continue;
+        intersection r;
+        r.a = std::min(segs[k], segs[l]);
+        r.b = std::max(segs[k], segs[l]);
+        r.p = first_common_point(a, b);
+        res.push_back(r);
+      }
+    }
+  }
+};
+
+std::vector<intersection>
+all_intersections_grid(const std::vector<segment> & s) {
+  segment_grid g(s);
+  std::vector<intersection> res;
+  for (int c = 0; c < g.cells(); c++) g.report(c, res);
+  return res;
+}
+
 /*** Example Usage ***/
 
+#include <cassert>
 #include <iostream>
-#include <vector>
 using namespace std;
 
 void print(const segment & s) {
@@ -185,5 +829,29 @@ int main() {
   } else {
     cout << "No intersections.\n";
   }
+  //a segment ending 1e-12 above the line y = x does not touch it
+  point o(0, 0), p(2, 2);
+  assert(seg_intersection(o, p, point(1, 1 + 1e-12), point(0, 3)) == -1);
+  assert(seg_intersection(o, p, point(1, 1), point(0, 3)) == 0);
+  assert(seg_intersection(o, p, point(1, 1), point(3, 3)) == 1);
+  assert(seg_intersection(o, p, point(2, 2), point(3, 3)) == 0);
+  assert(seg_intersection(o, p, point(2.5, 2.5), point(3, 3)) == -1);
+
+  //every intersecting pair: three segments through (1, 1), a vertical
+  //segment touching one of them, and two overlapping collinear segments
+  vector<segment> w;
+  w.push_back(segment(point(0, 0), point(2, 2)));
+  w.push_back(segment(point(0, 2), point(2, 0)));
+  w.push_back(segment(point(1, 0), point(1, 3)));
+  w.push_back(segment(point(3, 0), point(3, 5)));
+  w.push_back(segment(point(3, 4), point(5, 4)));
+  w.push_back(segment(point(4, 4), point(6, 4)));
+  vector<intersection> r1 = all_intersections(w);
+  vector<intersection> r2 = all_intersections_grid(w);
+  assert(r1.size() == 5 && r2.size() == 5);
+  for (int i = 0; i < (int)r1.size(); i++) {
+    cout << r1[i].a << " and " << r1[i].b << " at (" << r1[i].p.x << ","
+         << r1[i].p.y << ")\n";
+  }
   return 0;
 }
@@ -0,0 +1,182 @@
+/*
+
+Given a range of points in 3D space, determine the sphere of smallest
+possible radius which encloses all of the points. This generalizes the
+randomized incremental algorithm of Welzl for the minimum enclosing
+circle (see section 5.3.4) by one more level. After the points are
+shuffled by a xorshift generator, each point which lies outside the
+sphere of the points before it must be on the boundary of their new
+sphere, which is found the same way among the points before it with the
+new point fixed on the boundary, and so on, down to four points which
+determine their circumscribed sphere. As in section 5.3.4, a point on
+the boundary is moved to the front once its sphere is found, and the
+sphere is kept as its center and squared radius.
+
+The smallest sphere through three points is centered at the center of
+their circumscribed circle, in their plane. If the three points are
+nearly collinear, or four points are nearly coplanar, the boundary is
+instead taken as the smallest of the spheres through fewer of them that
+encloses the rest.
+
+Time Complexity: O(n) average on the number of points given.
+
+Space Complexity: O(n) auxiliary, for a shuffled copy of the points.
+
+*/
+
+#include <algorithm> /* std::rotate(), std::swap() */
+#include <cmath>     /* fabs(), sqrt() */
+#include <vector>
+
+const double eps = 1e-9;
+
+#define LE(a, b) ((a) <= (b) + eps)       /* less than or equal to */
+
+struct point3 {
+  double x, y, z;
+
+  point3(): x(0), y(0), z(0) {}
+  point3(double X, double Y, double Z): x(X), y(Y), z(Z) {}
+};
+
+point3 operator - (const point3 & a, const point3 & b) {
+  return point3(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+double dot(const point3 & a, const point3 & b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+point3 cross(const point3 & a, const point3 & b) {
+  return point3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+                a.x * b.y - a.y * b.x);
+}
+
+struct sphere {
+  point3 c;
+  double r2; //the squared radius
+
+  sphere(): r2(0) {}
+  sphere(const point3 & C, double R2): c(C), r2(R2) {}
+
+  double radius() const { return sqrt(r2); }
+
+  bool contains(const point3 & p) const {
+    point3 d = p - c;
+    return LE(dot(d, d), r2);
+  }
+};
+
+sphere sphere2(const point3 & a, const point3 & b) {
+  point3 c((a.x + b.x) / 2, (a.y + b.y) / 2, (a.z + b.z) / 2);
+  point3 d = a - c;
+  return sphere(c, dot(d, d));
+}
+
+//the circumscribed circle of a, b, and c, in their plane
+sphere sphere3(const point3 & a, const point3 & b, const point3 & c) {
+  point3 u = b - a, v = c - a, w = cross(u, v);
+  double uu = dot(u, u), vv = dot(v, v), ww = dot(w, w);
+  if (ww <= eps * uu * vv) { //nearly collinear
+    double bc = dot(c - b, c - b);
+    if (bc >= uu && bc >= vv) return sphere2(b, c);
+    return uu >= vv ? sphere2(a, b) : sphere2(a, c);
+  }
+  point3 p = cross(w, u), q = cross(v, w);
+  double inv = 1 / (2 * ww);
+  point3 o((vv * p.x + uu * q.x) * inv, (vv * p.y + uu * q.y) * inv,
+           (vv * p.z + uu * q.z) * inv);
+  return sphere(point3(a.x + o.x, a.y + o.y, a.z + o.z), dot(o, o));
+}
+
+//the circumscribed sphere of a, b, c, and d
+sphere sphere4(const point3 & a, const point3 & b, const point3 & c,
+               const point3 & d) {
+  point3 u = b - a, v = c - a, w = d - a;
+  point3 vw = cross(v, w), wu = cross(w, u), uv = cross(u, v);
+  double det = dot(u, vw), uu = dot(u, u), vv = dot(v, v), ww = dot(w, w);
+  if (fabs(det) <= eps * sqrt(uu * vv * ww)) { //nearly coplanar
+    const point3 * p[4] = {&a, &b, &c, &d};
+    sphere best;
+    bool found = false;
+    for (int i = 0; i < 4; i++) {
+      for (int j = i + 1; j < 4; j++) {
+        for (int k = j; k < 4; k++) {
+          sphere s = (k == j) ? sphere2(*p[i], *p[j])
+                              : sphere3(*p[i], *p[j], *p[k]);
+          bool all = true;
+          for (int l = 0; l < 4; l++) all = all && s.contains(*p[l]);
+          if (all && (!found || s.r2 < best.r2)) {
+            best = s;
+            found = true;
+          }
+        }
+      }
+    }
+    return best;
+  }
+  double inv = 1 / (2 * det);
+  point3 o((uu * vw.x + vv * wu.x + ww * uv.x) * inv,
+           (uu * vw.y + vv * wu.y + ww * uv.y) * inv,
+           (uu * vw.z + vv * wu.z + ww * uv.z) * inv);
+  return sphere(point3(a.x + o.x, a.y + o.y, a.z + o.z), dot(o, o));
+}
+
+template<class It> sphere smallest_sphere(It lo, It hi) {
+  if (lo == hi) return sphere();
+  std::vector<point3> p(lo, hi);
+  int n = p.size();
+  unsigned long long state = 88172645463325252ULL;
+  for (int i = n - 1; i > 0; i--) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    std::swap(p[i], p[(state >> 32) * (i + 1) >> 32]);
+  }
+  if (n == 1) return sphere(p[0], 0);
+  sphere s = sphere2(p[0], p[1]);
+  for (int i = 2; i < n; i++) {
+    if (s.contains(p[i])) continue;
+    s = sphere2(p[i], p[0]);
+    for (int j = 1; j < i; j++) {
+      if (s.contains(p[j])) continue;
+      s = sphere2(p[i], p[j]);
+      for (int k = 0; k < j; k++) {
+        if (s.contains(p[k])) continue;
+        s = sphere3(p[i], p[j], p[k]);
+        for (int l = 0; l < k; l++)
+          if (!s.contains(p[l])) s = sphere4(p[i], p[j], p[k], p[l]);
+      }
+    }
+    std::rotate(p.begin(), p.begin() + i, p.begin() + i + 1);
+  }
+  return s;
+}
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+int main() {
+  //the corners of a unit cube, and a point at its center
+  vector<point3> v;
+  for (int i = 0; i < 8; i++)
+    v.push_back(point3(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+  v.push_back(point3(0.5, 0.5, 0.5));
+  sphere s = smallest_sphere(v.begin(), v.end());
+  cout << "center: (" << s.c.x << ", " << s.c.y << ", " << s.c.z << ")\n";
+  cout << "radius: " << s.radius() << "\n"; //0.866025
+  assert(fabs(s.radius() - sqrt(0.75)) < eps);
+
+  //points on a circle in a plane are enclosed by that circle's sphere
+  vector<point3> w;
+  w.push_back(point3(1, 0, 2));
+  w.push_back(point3(0, 1, 2));
+  w.push_back(point3(-1, 0, 2));
+  w.push_back(point3(0, -1, 2));
+  s = smallest_sphere(w.begin(), w.end());
+  assert(fabs(s.c.z - 2) < eps && fabs(s.radius() - 1) < eps);
+  return 0;
+}
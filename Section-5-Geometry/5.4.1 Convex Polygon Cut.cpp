@@ -5,12 +5,27 @@ plane, as well as two points specifying an infinite line, "cut"
 off the right part of the polygon with the line and return the
 resulting polygon that is the left part.
 
-Time Complexity: O(n) on the number of points in the poylgon.
+To clip against a whole convex window, such as a viewport, the class
+convex_clipper keeps the line of each window edge and cuts by all of
+them in turn, alternating between two buffers that it keeps from call
+to call, so that no memory is allocated once they have grown. For many
+polygons at once, clip_all() first tests the bounding box of each one
+against every edge, copying it whole when the box is inside the window
+and dropping it when the box is outside of some edge, so that only the
+polygons that straddle the border of the window are cut.
+
+Time Complexity: O(n) on the number of points in the poylgon for
+convex_cut(). For convex_clipper, O(m) for construction and O(nm) per
+polygon clipped, where m is the number of vertices of the window, or
+O(n + m) per polygon which clip_all() can accept or drop whole.
+
+Space Complexity: O(n + m) auxiliary for convex_clipper.
 
 */
 
-#include <cmath>   /* fabs() */
-#include <utility> /* std::pair */
+#include <algorithm> /* std::min(), std::max() */
+#include <cmath>     /* fabs() */
+#include <utility>   /* std::pair */
 #include <vector>
 
 typedef std::pair<double, double> point;
@@ -61,8 +76,98 @@ std::vector<point> convex_cut(It lo, It hi, const point & p, const point & q) {
   return res;
 }
 
+class convex_clipper {
+  std::vector<double> a, b, c; //edge i keeps points where ax + by + c >= 0
+  std::vector<point> buf[2];
+
+  double side(int i, const point & p) const {
+    return a[i] * p.x + b[i] * p.y + c[i];
+  }
+
+  //cuts buf[0] by every edge of the window, leaving the result in it
+  void cut() {
+    for (int k = 0; k < (int)a.size() && !buf[0].empty(); k++) {
+      std::vector<point> & in = buf[0], & out = buf[1];
+      out.clear();
+      int n = in.size();
+      double dj = side(k, in[n - 1]);
+      for (int i = 0, j = n - 1; i < n; j = i++) {
+        double di = side(k, in[i]);
+        if (!LT(dj, 0)) out.push_back(in[j]);
+        if ((LT(dj, 0) && GT(di, 0)) || (GT(dj, 0) && LT(di, 0))) {
+          double t = dj / (dj - di);
+          out.push_back(point(in[j].x + (in[i].x - in[j].x) * t,
+                              in[j].y + (in[i].y - in[j].y) * t));
+        }
+        dj = di;
+      }
+      buf[0].swap(buf[1]);
+    }
+  }
+
+  //0 if the box [lx, hx] by [ly, hy] is outside of some edge of the
+  //window, 2 if it is inside the window, or else 1
+  int classify(double lx, double ly, double hx, double hy) const {
+    int res = 2;
+    for (int i = 0; i < (int)a.size(); i++) {
+      double lo = a[i] * (a[i] > 0 ? lx : hx) + b[i] * (b[i] > 0 ? ly : hy);
+      double hi = a[i] * (a[i] > 0 ? hx : lx) + b[i] * (b[i] > 0 ? hy : ly);
+      if (LT(hi + c[i], 0)) return 0;
+      if (LT(lo + c[i], 0)) res = 1;
+    }
+    return res;
+  }
+
+ public:
+  //the window is given by its vertices in counterclockwise order
+  template<class It> convex_clipper(It lo, It hi) {
+    for (It i = lo, j = hi - 1; i != hi; j = i++) {
+      a.push_back(j->y - i->y);
+      b.push_back(i->x - j->x);
+      c.push_back(-(a.back() * j->x + b.back() * j->y));
+    }
+  }
+
+  //the part of a polygon inside the window, valid until the next call
+  template<class It>
+  const std::vector<point> & clip(It lo, It hi) {
+    buf[0].assign(lo, hi);
+    cut();
+    return buf[0];
+  }
+
+  //clips every polygon in a range of point vectors, appending the
+  //vertices of the i-th result to res and setting end[i] to their end
+  template<class It>
+  void clip_all(It lo, It hi, std::vector<point> & res,
+                std::vector<int> & end) {
+    res.clear();
+    end.clear();
+    for (It p = lo; p != hi; ++p) {
+      if (!p->empty()) {
+        double lx = (*p)[0].x, ly = (*p)[0].y, hx = lx, hy = ly;
+        for (int i = 1; i < (int)p->size(); i++) {
+          lx = std::min(lx, (*p)[i].x);
+          ly = std::min(ly, (*p)[i].y);
+          hx = std::max(hx, (*p)[i].x);
+          hy = std::max(hy, (*p)[i].y);
+        }
+        int k = classify(lx, ly, hx, hy);
+        if (k == 2) {
+          res.insert(res.end(), p->begin(), p->end());
+        } else if (k == 1) {
+          const std::vector<point> & r = clip(p->begin(), p->end());
+          res.insert(res.end(), r.begin(), r.end());
+        }
+      }
+      end.push_back(res.size());
+    }
+  }
+};
+
 /*** Example Usage ***/
 
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -79,5 +184,33 @@ int main() {
   cout << "left cut:\n";
   for (int i = 0; i < (int)res.size(); i++)
     cout << "(" << res[i].x << "," << res[i].y << ")\n";
+
+  //clip to the window [0, 2] by [0, 2], which agrees with four cuts
+  vector<point> w;
+  w.push_back(point(0, 0));
+  w.push_back(point(2, 0));
+  w.push_back(point(2, 2));
+  w.push_back(point(0, 2));
+  convex_clipper cc(w.begin(), w.end());
+  vector<point> cut = v;
+  for (int i = 0; i < 4; i++)
+    cut = convex_cut(cut.begin(), cut.end(), w[i], w[(i + 1) % 4]);
+  const vector<point> & r = cc.clip(v.begin(), v.end());
+  assert(r.size() == cut.size());
+  for (int i = 0; i < (int)r.size(); i++)
+    assert(EQ(r[i].x, cut[i].x) && EQ(r[i].y, cut[i].y));
+
+  //many at once: the pentagon, one inside, and one outside the window
+  vector<vector<point> > polys(3, vector<point>(3, point(1, 1)));
+  polys[0] = v;
+  polys[1][1] = point(1.5, 1);
+  polys[1][2] = point(1, 1.5);
+  polys[2][0] = point(3, 3);
+  polys[2][1] = point(4, 3);
+  polys[2][2] = point(3, 4);
+  vector<int> end;
+  cc.clip_all(polys.begin(), polys.end(), res, end);
+  assert(end[0] == (int)cut.size() && end[1] == end[0] + 3);
+  assert(end[2] == end[1]);
   return 0;
 }
@@ -5,6 +5,9 @@ two polygons, determine the intersection area of those polygons.
 Using this, we can easily calculate their union with the forumla:
   union_area(A, B) = area(A) + area(B) - intersection_area(A, B)
 
+To obtain the resulting polygons themselves rather than their areas,
+see the sweep line boolean operations in section 5.4.5.
+
 Time Complexity: O(n^2 log n), where n is the total number of vertices.
 
 */
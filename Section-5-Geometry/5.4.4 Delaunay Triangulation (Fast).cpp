@@ -20,16 +20,161 @@ via the following link. It contains more thorough documentation,
 comments, and debugging messages associated with the current asserts().
 http://people.sc.fsu.edu/~burkardt/f_src/table_delaunay/table_delaunay.html
 
+The orientation and incircle tests (lrline() and diaedg()), which were
+originally tolerance-based, are decided by the robust predicates of
+section 5.1.4. An edge is only swapped if the opposite point lies
+strictly inside the circumcircle, so cocircular and nearly collinear
+inputs can neither produce inverted triangles nor swap edges forever.
+
 Time Complexity: O(n log n) on the number of input points.
 
 */
 
 #include <algorithm> /* std::min(), std::max() */
 #include <cassert>
-#include <cmath>     /* fabs(), sqrt() */
+#include <cmath>     /* fabs() */
 #include <utility>   /* std::pair */
 #include <vector>
 
+//robust predicates by exact expansion arithmetic (see section 5.1.4)
+
+//a sum of nonoverlapping doubles in order of increasing magnitude
+typedef std::vector<double> expansion;
+
+//half the distance between 1 and the next double, i.e. 2^-53
+const double round_eps = 1.1102230246251565e-16;
+const double ccw_bound = (3 + 16 * round_eps) * round_eps;
+const double icc_bound = (10 + 96 * round_eps) * round_eps;
+
+//s + t = a + b exactly, where s is the rounded sum
+void two_sum(double a, double b, double & s, double & t) {
+  s = a + b;
+  double bv = s - a, av = s - bv;
+  t = (a - av) + (b - bv);
+}
+
+//hi + lo = a exactly, where each half has at most 26 significant bits
+void split(double a, double & hi, double & lo) {
+  double c = 134217729.0 * a; //2^27 + 1
+  hi = c - (c - a);
+  lo = a - hi;
+}
+
+//p + t = a*b exactly, where p is the rounded product
+void two_product(double a, double b, double & p, double & t) {
+  p = a * b;
+  double ahi, alo, bhi, blo;
+  split(a, ahi, alo);
+  split(b, bhi, blo);
+  t = alo * blo - (((p - ahi * bhi) - alo * bhi) - ahi * blo);
+}
+
+//the exact difference a - b
+expansion difference(double a, double b) {
+  expansion e;
+  double s, t;
+  two_sum(a, -b, s, t);
+  if (t != 0) e.push_back(t);
+  if (s != 0) e.push_back(s);
+  return e;
+}
+
+//merges the components by magnitude, then accumulates them in order
+expansion sum(const expansion & e, const expansion & f) {
+  expansion h;
+  int m = e.size(), n = f.size(), i = 0, j = 0;
+  double q = 0, s, t;
+  while (i < m || j < n) {
+    double g = (j == n || (i < m && fabs(e[i]) < fabs(f[j]))) ? e[i++] : f[j++];
+    two_sum(q, g, s, t);
+    if (t != 0) h.push_back(t);
+    q = s;
+  }
+  if (q != 0) h.push_back(q);
+  return h;
+}
+
+expansion scale(const expansion & e, double b) {
+  expansion h;
+  double q = 0, p, pt, s, t;
+  for (int i = 0; i < (int)e.size(); i++) {
+    two_product(e[i], b, p, pt);
+    two_sum(q, pt, s, t);
+    if (t != 0) h.push_back(t);
+    two_sum(p, s, q, t);
+    if (t != 0) h.push_back(t);
+  }
+  if (q != 0) h.push_back(q);
+  return h;
+}
+
+expansion product(const expansion & e, const expansion & f) {
+  expansion h;
+  for (int i = 0; i < (int)f.size(); i++) h = sum(h, scale(e, f[i]));
+  return h;
+}
+
+expansion negate(expansion e) {
+  for (int i = 0; i < (int)e.size(); i++) e[i] = -e[i];
+  return e;
+}
+
+//an approximation of the value of e with the same sign
+double estimate(const expansion & e) {
+  return e.empty() ? 0 : e.back();
+}
+
+double orient2d_exact(double ax, double ay, double bx, double by,
+                      double cx, double cy) {
+  expansion l = product(difference(ax, cx), difference(by, cy));
+  expansion r = product(difference(ay, cy), difference(bx, cx));
+  return estimate(sum(l, negate(r)));
+}
+
+double orient2d(double ax, double ay, double bx, double by,
+                double cx, double cy) {
+  double l = (ax - cx) * (by - cy), r = (ay - cy) * (bx - cx);
+  double det = l - r, bound = ccw_bound * (fabs(l) + fabs(r));
+  if (det > bound || -det > bound) return det;
+  return orient2d_exact(ax, ay, bx, by, cx, cy);
+}
+
+double incircle_exact(double ax, double ay, double bx, double by,
+                      double cx, double cy, double dx, double dy) {
+  expansion adx = difference(ax, dx), ady = difference(ay, dy);
+  expansion bdx = difference(bx, dx), bdy = difference(by, dy);
+  expansion cdx = difference(cx, dx), cdy = difference(cy, dy);
+  expansion alift = sum(product(adx, adx), product(ady, ady));
+  expansion blift = sum(product(bdx, bdx), product(bdy, bdy));
+  expansion clift = sum(product(cdx, cdx), product(cdy, cdy));
+  expansion bc = sum(product(bdx, cdy), negate(product(cdx, bdy)));
+  expansion ca = sum(product(cdx, ady), negate(product(adx, cdy)));
+  expansion ab = sum(product(adx, bdy), negate(product(bdx, ady)));
+  expansion det = sum(sum(product(alift, bc), product(blift, ca)),
+                      product(clift, ab));
+  return estimate(det);
+}
+
+double incircle(double ax, double ay, double bx, double by,
+                double cx, double cy, double dx, double dy) {
+  double adx = ax - dx, ady = ay - dy, bdx = bx - dx, bdy = by - dy;
+  double cdx = cx - dx, cdy = cy - dy;
+  double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+  double cdxady = cdx * ady, adxcdy = adx * cdy;
+  double adxbdy = adx * bdy, bdxady = bdx * ady;
+  double alift = adx * adx + ady * ady;
+  double blift = bdx * bdx + bdy * bdy;
+  double clift = cdx * cdx + cdy * cdy;
+  double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) +
+               clift * (adxbdy - bdxady);
+  double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * alift +
+                     (fabs(cdxady) + fabs(adxcdy)) * blift +
+                     (fabs(adxbdy) + fabs(bdxady)) * clift;
+  double bound = icc_bound * permanent;
+  if (det > bound || -det > bound) return det;
+  return incircle_exact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
 int wrap(int ival, int ilo, int ihi) {
   int jlo = std::min(ilo, ihi), jhi = std::max(ilo, ihi);
   int wide = jhi + 1 - jlo, res = jlo;
@@ -42,12 +187,6 @@ int wrap(int ival, int ilo, int ihi) {
   return res;
 }
 
-double epsilon() {
-  double r = 1;
-  while (1 < (double)(r + 1)) r /= 2;
-  return 2 * r;
-}
-
 void permute(int n, double a[][2], int p[]) {
   for (int istart = 1; istart <= n; istart++) {
     if (p[istart - 1] < 0) continue;
@@ -129,17 +268,11 @@ int * sort_heap(int n, double a[][2]) {
   return idx;
 }
 
+//1 if u is right of the directed line from v1 to v2, -1 if left, else 0
 int lrline(double xu, double yu, double xv1, double yv1,
-           double xv2, double yv2, double dv) {
-  double tol = 1e-7;
-  double dx = xv2 - xv1, dy = yv2 - yv1;
-  double dxu = xu - xv1, dyu = yu - yv1;
-  double t = dy * dxu - dx * dyu + dv * sqrt(dx * dx + dy * dy);
-  double tolabs = tol * std::max(std::max(fabs(dx), fabs(dy)),
-                         std::max(fabs(dxu), std::max(fabs(dyu), fabs(dv))));
-  if (tolabs < t) return 1;
-  if (-tolabs <= t) return 0;
-  return -1;
+           double xv2, double yv2) {
+  double t = orient2d(xv1, yv1, xv2, yv2, xu, yu);
+  return (t < 0) - (t > 0);
 }
 
 void vbedg(double x, double y, int point_num, double point_xy[][2],
@@ -170,7 +303,7 @@ void vbedg(double x, double y, int point_num, double point_xy[][2],
     ay = point_xy[a - 1][1];
     bx = point_xy[b - 1][0];
     by = point_xy[b - 1][1];
-    if (lrline(x, y, ax, ay, bx, by, 0.0) <= 0) break;
+    if (lrline(x, y, ax, ay, bx, by) <= 0) break;
     *rtri = t;
     *redg = e;
   }
@@ -195,44 +328,22 @@ void vbedg(double x, double y, int point_num, double point_xy[][2],
     ay = point_xy[a - 1][1];
     bx = point_xy[b - 1][0];
     by = point_xy[b - 1][1];
-    if (lrline(x, y, ax, ay, bx, by, 0.0) <= 0) break;
+    if (lrline(x, y, ax, ay, bx, by) <= 0) break;
   }
   *ltri = t;
   *ledg = e;
   return;
 }
 
+//1 if (x0, y0) is strictly inside the circumcircle of the other three
+//points (so that the diagonal 1-3 should be swapped for 0-2), -1 if it
+//is strictly outside, and 0 if the four points are cocircular
 int diaedg(double x0, double y0, double x1, double y1,
            double x2, double y2, double x3, double y3) {
-  double ca, cb, s, tol, tola, tolb;
-  int value;
-  tol = 100.0 * epsilon();
-  double dx10 = x1 - x0, dy10 = y1 - y0;
-  double dx12 = x1 - x2, dy12 = y1 - y2;
-  double dx30 = x3 - x0, dy30 = y3 - y0;
-  double dx32 = x3 - x2, dy32 = y3 - y2;
-  tola = tol * std::max(std::max(fabs(dx10), fabs(dy10)),
-                        std::max(fabs(dx30), fabs(dy30)));
-  tolb = tol * std::max(std::max(fabs(dx12), fabs(dy12)),
-                        std::max(fabs(dx32), fabs(dy32)));
-  ca = dx10 * dx30 + dy10 * dy30;
-  cb = dx12 * dx32 + dy12 * dy32;
-  if (tola < ca && tolb < cb) {
-    value = -1;
-  } else if (ca < -tola && cb < -tolb) {
-    value = 1;
-  } else {
-    tola = std::max(tola, tolb);
-    s = (dx10 * dy30 - dx30 * dy10) * cb + (dx32 * dy12 - dx12 * dy32) * ca;
-    if (tola < s) {
-      value = -1;
-    } else if (s < -tola) {
-      value = 1;
-    } else {
-      value = 0;
-    }
-  }
-  return value;
+  double o = orient2d(x1, y1, x2, y2, x3, y3);
+  double d = incircle(x1, y1, x2, y2, x3, y3, x0, y0);
+  if (o < 0) d = -d;
+  return (o == 0) ? 0 : (d > 0) - (d < 0);
 }
 
 int swapec(int i, int *top, int *btri, int *bedg,
@@ -381,13 +492,10 @@ void perm_inv(int n, int p[]) {
 
 int dtris2(int point_num, double point_xy[][2],
            int tri_nodes[][3], int tri_neigh[][3]) {
-  double cmax;
   int e, error;
   int i, j, k, l, m, m1, m2, n;
   int ledg, lr, ltri, redg, rtri, t, top;
-  double tol;
   int *stack = new int[point_num];
-  tol = 100.0 * epsilon();
   int *idx = sort_heap(point_num, point_xy);
   permute(point_num, point_xy, idx);
   m1 = 0;
@@ -396,8 +504,7 @@ int dtris2(int point_num, double point_xy[][2],
     m1 = i;
     k = -1;
     for (j = 0; j <= 1; j++) {
-      cmax = std::max(fabs(point_xy[m][j]), fabs(point_xy[m1][j]));
-      if (tol * (cmax + 1.0) < fabs(point_xy[m][j] - point_xy[m1][j])) {
+      if (point_xy[m][j] != point_xy[m1][j]) { //the points must be distinct
         k = j;
         break;
       }
@@ -412,7 +519,7 @@ int dtris2(int point_num, double point_xy[][2],
     m = j;
     lr = lrline(point_xy[m - 1][0], point_xy[m - 1][1],
                 point_xy[m1 - 1][0], point_xy[m1 - 1][1],
-                point_xy[m2 - 1][0], point_xy[m2 - 1][1], 0.0);
+                point_xy[m2 - 1][0], point_xy[m2 - 1][1]);
     if (lr != 0) break;
     j++;
   }
@@ -467,7 +574,7 @@ int dtris2(int point_num, double point_xy[][2],
     }
     lr = lrline(point_xy[m - 1][0], point_xy[m - 1][1],
                 point_xy[m1 - 1][0], point_xy[m1 - 1][1],
-                point_xy[m2 - 1][0], point_xy[m2 - 1][1], 0.0);
+                point_xy[m2 - 1][0], point_xy[m2 - 1][1]);
     if (0 < lr) {
       rtri = ltri;
       redg = ledg;
@@ -0,0 +1,721 @@
+/*
+
+Given two polygons on the Cartesian plane, each as a set of rings of
+vertices (which may be in either order, and which are combined by the
+even-odd rule, so that a ring inside another is a hole), compute their
+intersection, union, difference, or symmetric difference as polygons.
+The result is a list of polygons, each with an outer ring in counter-
+clockwise order and any number of holes in clockwise order. A polygon
+inside a hole of another one is output as a separate polygon.
+
+The algorithm of Martinez, Rueda, and Feito sweeps a vertical line from
+left to right over the edges of both polygons. Each edge has an event at
+each endpoint, which are kept in a pool and ordered by a binary heap,
+while the edges crossing the sweep line are kept in order from the
+bottom in a balanced tree. Whenever two edges become adjacent on the
+sweep line, they are split at their intersection, so that every edge
+processed lies on one side of the other polygon. Each inserted edge
+learns from the edge below it whether the regions above it are inside
+its polygon and the other polygon, which decides whether the edge
+belongs to the boundary of the result. Overlapping edges of different
+polygons are kept once if the regions on both sides agree. The edges of
+the result are then joined into rings at their endpoints, and each ring
+is a hole of the ring below it or an outer ring, in turn decided by the
+result edge just below it.
+
+polygon_clipper applies one operation of many subject polygons with a
+single clipping polygon, reusing the pool and skipping, for an
+intersection, any subject whose bounding box is disjoint from it.
+
+Time Complexity: O((n + k) log n), where n is the total number of
+vertices, and k is the number of intersections between edges.
+
+Space Complexity: O(n + k) auxiliary.
+
+Note: Coordinates of the intersections are rounded to doubles, so that
+nearly parallel edges and vertices very close to edges of the other
+polygon (less than about 1e-15 times the coordinates) may perturb the
+result. In particular, overlapping edges of the two polygons may be split
+at slightly different points by a third edge crossing them, which can
+leave slivers in the result. Overlapping edges within the same polygon
+are not supported.
+
+*/
+
+#include <algorithm> /* std::min(), std::max(), std::stable_sort() */
+#include <cmath>     /* acos(), atan2(), floor() */
+#include <queue>     /* std::priority_queue */
+#include <set>
+#include <utility>   /* std::pair, std::make_pair() */
+#include <vector>
+
+typedef std::pair<double, double> point;
+#define x first
+#define y second
+
+const double PI = acos(-1.0);
+
+typedef std::vector<point> contour;
+
+struct polygon {
+  contour outer;
+  std::vector<contour> holes;
+};
+
+enum boolean_op { INTERSECTION, UNION, DIFFERENCE, XOR };
+
+//twice the signed area of the triangle abc
+double signed_area(const point & a, const point & b, const point & c) {
+  return (a.x - c.x) * (b.y - c.y) - (b.x - c.x) * (a.y - c.y);
+}
+
+class boolean_engine {
+  enum edge_type { NORMAL, NON_CONTRIBUTING, SAME_TRANSITION,
+                   DIFFERENT_TRANSITION };
+
+  struct sweep_event {
+    point p;
+    bool left, subject, in_out, other_in_out;
+    int other, contour_id, edge, type, prev_in_result, transition, pos, ring;
+  };
+
+  std::vector<sweep_event> ev; //the pool of events, referred to by index
+  std::vector<std::pair<point, point> > edges; //the input edges
+  point origin; //a whole lower left corner of the input edges
+  double right[2]; //the rightmost x of the subject and clipping edges
+  boolean_op op;
+
+  const point & other_point(int e) const { return ev[ev[e].other].p; }
+
+  bool below(int e, const point & p) const {
+    return ev[e].left ? signed_area(ev[e].p, other_point(e), p) > 0
+                      : signed_area(other_point(e), ev[e].p, p) > 0;
+  }
+
+  bool vertical(int e) const { return ev[e].p.x == other_point(e).x; }
+
+  //whether the edges of events a and b lie on one line, which is decided
+  //by their input edges, since the pieces of those are rounded
+  bool collinear(int a, int b) const {
+    const std::pair<point, point> & l = edges[ev[a].edge];
+    const std::pair<point, point> & m = edges[ev[b].edge];
+    return signed_area(l.first, l.second, m.first) == 0 &&
+           signed_area(l.first, l.second, m.second) == 0;
+  }
+
+  //1 if event a is processed after event b, or else -1
+  int compare_events(int a, int b) const {
+    const point & p = ev[a].p, & q = ev[b].p;
+    if (p.x != q.x) return p.x > q.x ? 1 : -1;
+    if (p.y != q.y) return p.y > q.y ? 1 : -1;
+    //right endpoints first, then the lower of two edges
+    if (ev[a].left != ev[b].left) return ev[a].left ? 1 : -1;
+    if (!collinear(a, b)) return below(a, other_point(b)) ? -1 : 1;
+    return (!ev[a].subject && ev[b].subject) ? 1 : -1;
+  }
+
+  struct later {
+    const boolean_engine * g;
+    later(const boolean_engine * g) : g(g) {}
+    bool operator () (int a, int b) const {
+      return g->compare_events(a, b) > 0;
+    }
+  };
+
+  //whether the edge of left event a is below that of b on the sweep line
+  struct lower {
+    const boolean_engine * g;
+    lower(const boolean_engine * g) : g(g) {}
+
+    bool operator () (int a, int b) const {
+      if (a == b) return false;
+      const std::vector<sweep_event> & ev = g->ev;
+      const point & pa = ev[a].p, & qa = g->other_point(a);
+      const point & pb = ev[b].p, & qb = g->other_point(b);
+      if (!g->collinear(a, b)) {
+        if (pa == pb) return g->below(a, qb);
+        if (pa.x == pb.x) return pa.y < pb.y;
+        if (g->compare_events(a, b) == 1) return !g->below(b, pa);
+        return g->below(a, pb);
+      }
+      if (ev[a].subject != ev[b].subject) return ev[a].subject;
+      if (pa == pb && qa == qb) return a < b;
+      if (pa == pb) return ev[a].contour_id < ev[b].contour_id;
+      return g->compare_events(a, b) != 1;
+    }
+  };
+
+  std::priority_queue<int, std::vector<int>, later> queue;
+  std::set<int, lower> sweep;
+
+  int new_event(const point & p, bool left, int other, bool subject,
+                int contour_id, int edge) {
+    sweep_event e;
+    e.p = p;
+    e.left = left;
+    e.subject = subject;
+    e.in_out = e.other_in_out = false;
+    e.other = other;
+    e.contour_id = contour_id;
+    e.edge = edge;
+    e.type = NORMAL;
+    e.prev_in_result = -1;
+    e.transition = 0;
+    e.pos = e.ring = -1;
+    ev.push_back(e);
+    return ev.size() - 1;
+  }
+
+  bool in_result(int e) const {
+    switch (ev[e].type) {
+      case NORMAL:
+        switch (op) {
+          case INTERSECTION: return !ev[e].other_in_out;
+          case UNION: return ev[e].other_in_out;
+          case DIFFERENCE: return ev[e].subject == ev[e].other_in_out;
+          case XOR: return true;
+        }
+        return false;
+      case SAME_TRANSITION: return op == INTERSECTION || op == UNION;
+      case DIFFERENT_TRANSITION: return op == DIFFERENCE;
+    }
+    return false;
+  }
+
+  //1 if the region just above the edge of e is in the result, else -1
+  int result_transition(int e) const {
+    bool here = !ev[e].in_out, there = !ev[e].other_in_out;
+    //along an overlap, the other polygon changes sides with this one
+    if (ev[e].type == SAME_TRANSITION) there = here;
+    if (ev[e].type == DIFFERENT_TRANSITION) there = !here;
+    bool in = false;
+    switch (op) {
+      case INTERSECTION: in = here && there; break;
+      case UNION: in = here || there; break;
+      case XOR: in = here != there; break;
+      case DIFFERENCE: in = ev[e].subject ? here && !there : there && !here;
+    }
+    return in ? 1 : -1;
+  }
+
+  //the fields of left event e, from the edge of left event prev below it
+  void compute_fields(int e, int prev) {
+    sweep_event & c = ev[e];
+    if (prev == -1) {
+      c.in_out = false;
+      c.other_in_out = true;
+      c.prev_in_result = -1;
+    } else {
+      const sweep_event & b = ev[prev];
+      if (c.subject == b.subject) {
+        c.in_out = !b.in_out;
+        c.other_in_out = b.other_in_out;
+      } else {
+        c.in_out = !b.other_in_out;
+        c.other_in_out = vertical(prev) ? !b.in_out : b.in_out;
+      }
+      bool skip = b.transition == 0 || vertical(prev);
+      c.prev_in_result = skip ? b.prev_in_result : prev;
+    }
+    c.transition = in_result(e) ? result_transition(e) : 0;
+  }
+
+  //splits the edge of left event e at p, which must be inside it (p is
+  //copied, since it may be in the pool as it grows)
+  void divide(int e, point p) {
+    int o = ev[e].other;
+    int r = new_event(p, false, e, ev[e].subject, ev[e].contour_id,
+                      ev[e].edge);
+    int l = new_event(p, true, o, ev[e].subject, ev[e].contour_id,
+                      ev[e].edge);
+    if (compare_events(l, o) > 0) { //o is now left of p, due to rounding
+      ev[o].left = true;
+      ev[l].left = false;
+    }
+    ev[o].other = l;
+    ev[e].other = r;
+    queue.push(l);
+    queue.push(r);
+  }
+
+  //stores into p the points shared by the edges of left events u and v,
+  //returning their number, where 2 means they overlap from p[0] to p[1].
+  //The edges are tested as pieces of their input edges, so that a vertex
+  //on the other input edge is found exactly, rather than as a rounded
+  //point near it which would split an edge into a sliver.
+  int shared(int u, int v, point p[2]) const {
+    const point & a = ev[u].p, & b = other_point(u);
+    const point & c = ev[v].p, & d = other_point(v);
+    const std::pair<point, point> & l = edges[ev[u].edge];
+    const std::pair<point, point> & m = edges[ev[v].edge];
+    if (collinear(u, v)) {
+      p[0] = std::max(std::min(a, b), std::min(c, d));
+      p[1] = std::min(std::max(a, b), std::max(c, d));
+      if (p[1] < p[0]) return 0;
+      return p[0] == p[1] ? 1 : 2;
+    }
+    double o1 = signed_area(l.first, l.second, c);
+    double o2 = signed_area(l.first, l.second, d);
+    double o3 = signed_area(m.first, m.second, a);
+    double o4 = signed_area(m.first, m.second, b);
+    if ((o1 > 0 && o2 > 0) || (o1 < 0 && o2 < 0) ||
+        (o3 > 0 && o4 > 0) || (o3 < 0 && o4 < 0))
+      return 0;
+    if (o3 == 0) {
+      p[0] = a;
+    } else if (o4 == 0) {
+      p[0] = b;
+    } else if (o1 == 0) {
+      p[0] = c;
+    } else if (o2 == 0) {
+      p[0] = d;
+    } else {
+      //the crossing of the input edges, taken from the corner of all of
+      //them, so that input edges through one point agree on it as long as
+      //the products are exact, as they are for whole coordinates
+      double ex = l.first.x - origin.x, ey = l.first.y - origin.y;
+      double fx = l.second.x - origin.x, fy = l.second.y - origin.y;
+      double gx = m.first.x - origin.x, gy = m.first.y - origin.y;
+      double hx = m.second.x - origin.x, hy = m.second.y - origin.y;
+      double den = (ex - fx) * (gy - hy) - (ey - fy) * (gx - hx);
+      double ef = ex * fy - ey * fx, gh = gx * hy - gy * hx;
+      p[0] = point((ef * (gx - hx) - (ex - fx) * gh) / den + origin.x,
+                   (ef * (gy - hy) - (ey - fy) * gh) / den + origin.y);
+      //rounding must not carry it off either piece, such as off an
+      //axis-parallel one, or only one of them would be split there
+      p[0].x = std::min(std::max(p[0].x, std::max(std::min(a.x, b.x),
+                                                  std::min(c.x, d.x))),
+                        std::min(std::max(a.x, b.x), std::max(c.x, d.x)));
+      p[0].y = std::min(std::max(p[0].y, std::max(std::min(a.y, b.y),
+                                                  std::min(c.y, d.y))),
+                        std::min(std::max(a.y, b.y), std::max(c.y, d.y)));
+    }
+    return 1;
+  }
+
+  //whether p is strictly inside the edge of left event e
+  bool inside(int e, const point & p) const {
+    return ev[e].p < p && p < other_point(e);
+  }
+
+  //splits the edges of left events a and b at their intersections,
+  //returning 2 if they overlap from the same left endpoint
+  int check(int a, int b) {
+    point p[2];
+    int n = shared(a, b, p);
+    if (n == 0) return 0;
+    if (n == 1) {
+      if (ev[a].p == ev[b].p || other_point(a) == other_point(b)) return 0;
+      if (inside(a, p[0])) divide(a, p[0]);
+      if (inside(b, p[0])) divide(b, p[0]);
+      return 1;
+    }
+    if (ev[a].subject == ev[b].subject) return 0;
+    //the events at the ends of the overlap, in order
+    int e[4], m = 0;
+    bool same_left = ev[a].p == ev[b].p;
+    bool same_right = other_point(a) == other_point(b);
+    if (!same_left) {
+      bool later_a = compare_events(a, b) == 1;
+      e[m++] = later_a ? b : a;
+      e[m++] = later_a ? a : b;
+    }
+    if (!same_right) {
+      int oa = ev[a].other, ob = ev[b].other;
+      bool later_a = compare_events(oa, ob) == 1;
+      e[m++] = later_a ? ob : oa;
+      e[m++] = later_a ? oa : ob;
+    }
+    if (same_left) {
+      ev[b].type = NON_CONTRIBUTING;
+      ev[a].type = ev[b].in_out == ev[a].in_out ? SAME_TRANSITION
+                                                : DIFFERENT_TRANSITION;
+      if (!same_right) divide(ev[e[1]].other, ev[e[0]].p);
+      return 2;
+    }
+    if (same_right) {
+      divide(e[0], ev[e[1]].p);
+      return 3;
+    }
+    if (e[0] != ev[e[3]].other) { //neither edge contains the other
+      divide(e[0], ev[e[1]].p);
+      divide(e[1], ev[e[2]].p);
+      return 3;
+    }
+    divide(e[0], ev[e[1]].p); //the edge of e[0] contains the other
+    divide(ev[e[3]].other, ev[e[2]].p);
+    return 3;
+  }
+
+  //the processed events, in order
+  std::vector<int> order;
+
+  void subdivide(double right_bound) {
+    while (!queue.empty()) {
+      int e = queue.top();
+      queue.pop();
+      if ((op == INTERSECTION || op == DIFFERENCE) && ev[e].p.x > right_bound)
+        break;
+      order.push_back(e);
+      if (ev[e].left) {
+        int created = ev.size();
+        std::set<int, lower>::iterator self = sweep.insert(e).first;
+        std::set<int, lower>::iterator it = self, nx = self;
+        int prev = -1, next = -1;
+        if (it != sweep.begin()) prev = *--it;
+        if (++nx != sweep.end()) next = *nx;
+        compute_fields(e, prev);
+        if (next != -1 && check(e, next) == 2) {
+          compute_fields(e, prev);
+          compute_fields(next, e);
+        }
+        if (prev != -1 && check(prev, e) == 2) {
+          std::set<int, lower>::iterator pp = sweep.find(prev);
+          int prev2 = pp == sweep.begin() ? -1 : *--pp;
+          compute_fields(prev, prev2);
+          compute_fields(e, prev);
+        }
+        //an edge through the point of e was split there, so its right
+        //event there has to be processed first, and e again after it
+        if (queue.top() >= created && later(this)(e, queue.top())) {
+          sweep.erase(self);
+          order.pop_back();
+          queue.push(e);
+        }
+      } else {
+        std::set<int, lower>::iterator it = sweep.find(ev[e].other);
+        if (it == sweep.end()) continue;
+        std::set<int, lower>::iterator nx = it;
+        int prev = -1, next = -1;
+        if (it != sweep.begin()) {
+          std::set<int, lower>::iterator pv = it;
+          prev = *--pv;
+        }
+        if (++nx != sweep.end()) next = *nx;
+        sweep.erase(it);
+        if (prev != -1 && next != -1) check(prev, next);
+      }
+    }
+  }
+
+  struct ring_info {
+    contour points;
+    int hole_of;
+    std::vector<int> holes;
+  };
+
+  struct before {
+    const boolean_engine * g;
+    before(const boolean_engine * g) : g(g) {}
+    bool operator () (int a, int b) const {
+      return a != b && g->compare_events(a, b) < 0;
+    }
+  };
+
+  //the clockwise angle in (0, 2 pi] from direction d to direction e
+  static double clockwise(const point & d, const point & e) {
+    double a = atan2(d.x * e.y - d.y * e.x, d.x * e.x + d.y * e.y);
+    if (a < 0) a += 2 * PI;
+    return a == 0 ? 2 * PI : 2 * PI - a;
+  }
+
+  std::vector<polygon> connect() {
+    std::vector<int> res;
+    for (int i = 0; i < (int)order.size(); i++) ev[order[i]].pos = 0;
+    for (int i = 0; i < (int)order.size(); i++) {
+      int e = order[i];
+      //an edge past the early stop of the sweep is never in the result
+      if (ev[ev[e].left ? e : ev[e].other].transition != 0 &&
+          ev[ev[e].other].pos != -1)
+        res.push_back(e);
+    }
+    //overlapping edges may have left the events slightly out of order
+    std::stable_sort(res.begin(), res.end(), before(this));
+    int n = res.size();
+    for (int i = 0; i < n; i++) ev[res[i]].pos = i;
+    //each edge is directed to have the result on its left, and the events
+    //at the same point are in a contiguous range of res
+    std::vector<int> partner(n), first(n);
+    std::vector<bool> out(n), done(n, false);
+    for (int i = 0; i < n; i++) {
+      int e = res[i], l = ev[e].left ? e : ev[e].other;
+      partner[i] = ev[ev[e].other].pos;
+      out[i] = ev[e].left == (ev[l].transition > 0);
+      first[i] = (i > 0 && ev[res[i - 1]].p == ev[e].p) ? first[i - 1] : i;
+    }
+    std::vector<ring_info> rings;
+    for (int i = 0; i < n; i++) {
+      if (done[i]) continue;
+      int id = rings.size();
+      ring_info r;
+      r.hole_of = -1;
+      //the ring is a hole if the region above the result edge below it
+      //is inside the result
+      int below = ev[res[i]].prev_in_result;
+      if (below != -1 && ev[below].transition > 0 && ev[below].ring != -1) {
+        int low = ev[below].ring;
+        r.hole_of = rings[low].hole_of != -1 ? rings[low].hole_of : low;
+        rings[r.hole_of].holes.push_back(id);
+      }
+      rings.push_back(r);
+      contour & pts = rings[id].points;
+      int start = out[i] ? i : partner[i], k = start;
+      //at each vertex, the result lies clockwise from the edge arriving
+      //up to the next edge leaving, so taking that edge keeps the rings
+      //from crossing or touching themselves
+      for (;;) {
+        int v = partner[k];
+        done[k] = done[v] = true;
+        int e = res[k];
+        ev[ev[e].left ? e : ev[e].other].ring = id;
+        const point & p = ev[res[v]].p, & q = ev[e].p;
+        pts.push_back(q);
+        point d(q.x - p.x, q.y - p.y);
+        int next = -1;
+        double best = 0;
+        for (int j = first[v]; j < n && ev[res[j]].p == p; j++) {
+          if (!out[j] || (done[j] && j != start)) continue;
+          const point & w = ev[res[partner[j]]].p;
+          double a = clockwise(d, point(w.x - p.x, w.y - p.y));
+          if (next == -1 || a < best) {
+            next = j;
+            best = a;
+          }
+        }
+        if (next == -1 || next == start) break;
+        k = next;
+      }
+    }
+    //rings of two points are left by nearly coincident edges, and have no
+    //area
+    std::vector<polygon> result;
+    for (int i = 0; i < (int)rings.size(); i++) {
+      if (rings[i].hole_of != -1 || rings[i].points.size() < 3) continue;
+      polygon p;
+      p.outer = rings[i].points;
+      for (int j = 0; j < (int)rings[i].holes.size(); j++) {
+        const contour & h = rings[rings[i].holes[j]].points;
+        if (h.size() >= 3) p.holes.push_back(h);
+      }
+      result.push_back(p);
+    }
+    return result;
+  }
+
+ public:
+  boolean_engine() : queue(later(this)), sweep(lower(this)) {}
+
+  //starts an operation, keeping the memory of the pool from the last one
+  void reset(boolean_op op) {
+    this->op = op;
+    ev.clear();
+    edges.clear();
+    order.clear();
+    sweep.clear();
+    while (!queue.empty()) queue.pop();
+    origin = point(1e300, 1e300);
+    right[0] = right[1] = -1e300;
+  }
+
+  //adds edge ab of the subject polygon, or else of the clipping polygon,
+  //where id identifies the ring of the edge among those of its polygon,
+  //and ab is a piece of the input edge l
+  void add(const point & a, const point & b, bool subject, int id,
+           const std::pair<point, point> & l) {
+    if (a == b) return;
+    origin.x = std::min(origin.x, floor(std::min(a.x, b.x)));
+    origin.y = std::min(origin.y, floor(std::min(a.y, b.y)));
+    double & r = right[subject ? 0 : 1];
+    r = std::max(r, std::max(a.x, b.x));
+    edges.push_back(l);
+    int e1 = new_event(a, false, -1, subject, id, edges.size() - 1);
+    int e2 = new_event(b, false, e1, subject, id, edges.size() - 1);
+    ev[e1].other = e2;
+    ev[compare_events(e1, e2) > 0 ? e2 : e1].left = true;
+    queue.push(e1);
+    queue.push(e2);
+  }
+
+  void add(const point & a, const point & b, bool subject, int id) {
+    add(a, b, subject, id, std::make_pair(a, b));
+  }
+
+  std::vector<polygon> solve() {
+    subdivide(op == INTERSECTION ? std::min(right[0], right[1]) : right[0]);
+    return connect();
+  }
+
+  std::vector<polygon> run(const std::vector<contour> & a,
+                           const std::vector<contour> & b, boolean_op op) {
+    reset(op);
+    for (int k = 0; k < 2; k++) {
+      const std::vector<contour> & poly = k == 0 ? a : b;
+      for (int i = 0; i < (int)poly.size(); i++) {
+        const contour & c = poly[i];
+        for (int j = 0; j < (int)c.size(); j++)
+          add(c[j], c[(j + 1) % c.size()], k == 0, i);
+      }
+    }
+    return solve();
+  }
+};
+
+std::vector<polygon> boolean_operation(const std::vector<contour> & a,
+                                       const std::vector<contour> & b,
+                                       boolean_op op) {
+  boolean_engine g;
+  return g.run(a, b, op);
+}
+
+//The edges of the clipping polygon are bucketed by vertical slabs of its
+//bounding box. The intersection and difference lie inside the subject,
+//and the sweep over the x-range of the subject only depends on the edges
+//crossing it. So only the edges in its slabs are added, cut at a vertical
+//line left of the subject, where all edges crossing it are added.
+class polygon_clipper {
+  std::vector<std::pair<point, point> > edges;
+  std::vector<int> ring, start, list, seen;
+  double lx, ly, hx, hy; //the bounding box of the clipping polygon
+  int slabs, stamp;
+  boolean_engine g;
+
+  int slab(double x) const {
+    if (hx == lx) return 0;
+    int s = (int)((x - lx) / (hx - lx) * slabs);
+    return std::max(0, std::min(slabs - 1, s));
+  }
+
+ public:
+  explicit polygon_clipper(const std::vector<contour> & clip)
+      : lx(1e300), ly(1e300), hx(-1e300), hy(-1e300), stamp(0) {
+    for (int i = 0; i < (int)clip.size(); i++) {
+      for (int j = 0; j < (int)clip[i].size(); j++) {
+        const point & a = clip[i][j], & b = clip[i][(j + 1) % clip[i].size()];
+        if (a == b) continue;
+        edges.push_back(std::make_pair(a, b));
+        ring.push_back(i);
+        lx = std::min(lx, a.x);
+        ly = std::min(ly, a.y);
+        hx = std::max(hx, a.x);
+        hy = std::max(hy, a.y);
+      }
+    }
+    int n = edges.size();
+    slabs = 1;
+    while (slabs * slabs < n) slabs++;
+    start.assign(slabs + 1, 0);
+    for (int i = 0; i < n; i++) {
+      int lo = slab(std::min(edges[i].first.x, edges[i].second.x));
+      int hi = slab(std::max(edges[i].first.x, edges[i].second.x));
+      for (int s = lo; s <= hi; s++) start[s + 1]++;
+    }
+    for (int s = 0; s < slabs; s++) start[s + 1] += start[s];
+    list.resize(start[slabs]);
+    std::vector<int> fill(start.begin(), start.end() - 1);
+    for (int i = 0; i < n; i++) {
+      int lo = slab(std::min(edges[i].first.x, edges[i].second.x));
+      int hi = slab(std::max(edges[i].first.x, edges[i].second.x));
+      for (int s = lo; s <= hi; s++) list[fill[s]++] = i;
+    }
+    seen.assign(n, -1);
+  }
+
+  //the result of subject op clip
+  std::vector<polygon> apply(const std::vector<contour> & subject,
+                             boolean_op op) {
+    double sx = 1e300, sy = 1e300, tx = -1e300, ty = -1e300;
+    g.reset(op);
+    for (int i = 0; i < (int)subject.size(); i++) {
+      const contour & c = subject[i];
+      for (int j = 0; j < (int)c.size(); j++) {
+        sx = std::min(sx, c[j].x);
+        sy = std::min(sy, c[j].y);
+        tx = std::max(tx, c[j].x);
+        ty = std::max(ty, c[j].y);
+        g.add(c[j], c[(j + 1) % c.size()], true, i);
+      }
+    }
+    bool disjoint = sx > hx || tx < lx || sy > hy || ty < ly;
+    if (op == INTERSECTION && disjoint) return std::vector<polygon>();
+    if (op == UNION || op == XOR) {
+      for (int i = 0; i < (int)edges.size(); i++)
+        g.add(edges[i].first, edges[i].second, false, ring[i]);
+    } else if (!disjoint) {
+      //left of the subject by its width, a slab, and 1 if both are empty
+      double x0 = sx - (tx - sx) - (hx - lx) / slabs - 1;
+      stamp++;
+      for (int s = slab(x0); s <= slab(tx); s++) {
+        for (int k = start[s]; k < start[s + 1]; k++) {
+          int i = list[k];
+          point a = std::min(edges[i].first, edges[i].second);
+          point b = std::max(edges[i].first, edges[i].second);
+          if (seen[i] == stamp || b.x < x0 || a.x > tx) continue;
+          seen[i] = stamp;
+          if (a.x < x0)
+            a = point(x0, a.y + (x0 - a.x) * (b.y - a.y) / (b.x - a.x));
+          g.add(a, b, false, ring[i], edges[i]);
+        }
+      }
+    }
+    return g.solve();
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+double area(const contour & c) {
+  double a = 0;
+  for (int i = 0, j = c.size() - 1; i < (int)c.size(); j = i++)
+    a += (c[j].x - c[i].x) * (c[j].y + c[i].y);
+  return a / 2;
+}
+
+double area(const vector<polygon> & res) {
+  double a = 0;
+  for (int i = 0; i < (int)res.size(); i++) {
+    a += area(res[i].outer);
+    for (int j = 0; j < (int)res[i].holes.size(); j++)
+      a += area(res[i].holes[j]);
+  }
+  return a;
+}
+
+contour square(double x0, double y0, double side) {
+  contour c;
+  c.push_back(point(x0, y0));
+  c.push_back(point(x0 + side, y0));
+  c.push_back(point(x0 + side, y0 + side));
+  c.push_back(point(x0, y0 + side));
+  return c;
+}
+
+int main() {
+  //a 4 by 4 square with a 2 by 2 hole, and a 2 by 2 square over its
+  //right edge
+  vector<contour> a, b;
+  a.push_back(square(0, 0, 4));
+  a.push_back(square(1, 1, 2));
+  b.push_back(square(3, 1, 2));
+  assert(fabs(area(boolean_operation(a, b, INTERSECTION)) - 2) < 1e-9);
+  assert(fabs(area(boolean_operation(a, b, UNION)) - 14) < 1e-9);
+  assert(fabs(area(boolean_operation(a, b, DIFFERENCE)) - 10) < 1e-9);
+  assert(fabs(area(boolean_operation(a, b, XOR)) - 12) < 1e-9);
+  vector<polygon> u = boolean_operation(a, b, UNION);
+  assert(u.size() == 1 && u[0].holes.size() == 1);
+  for (int i = 0; i < (int)u[0].outer.size(); i++)
+    cout << "(" << u[0].outer[i].x << "," << u[0].outer[i].y << ") ";
+  cout << "\n";
+
+  //clipping many squares against one
+  polygon_clipper clipper(b);
+  for (int i = 0; i < 8; i++) {
+    vector<contour> s(1, square(i, 1.5, 1));
+    double expected = (i == 3 || i == 4) ? 1 : 0;
+    assert(fabs(area(clipper.apply(s, INTERSECTION)) - expected) < 1e-9);
+  }
+  return 0;
+}
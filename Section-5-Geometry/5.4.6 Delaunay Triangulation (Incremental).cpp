@@ -0,0 +1,610 @@
+/*
+
+Given a range of points P on the Cartesian plane, build their Delaunay
+triangulation (see sections 5.4.3 and 5.4.4) as a mesh of half-edges,
+by inserting the points one at a time with the Bowyer-Watson algorithm.
+Each new point is located by walking from the last triangle created
+towards it, across any edge which has the point strictly on its right.
+Every triangle whose circumcircle strictly contains the point is then
+removed, and the cavity left behind is filled by joining the point to
+each of the edges on its boundary. The new triangles reuse the places
+of the ones removed, so that the arrays only grow by two per point.
+
+The points are inserted in a biased randomized insertion order: after
+a shuffle, they are split into rounds of doubling size, and the points
+of each round are sorted along a Hilbert curve over their bounding box.
+The rounds keep the expected work of a random order, while the curve
+keeps each point close to the one before it, so that the walks are
+short and the mesh is visited with few cache misses.
+
+The mesh is kept in flat arrays, where triangle t has the half-edges
+3t, 3t + 1 and 3t + 2 in counterclockwise order. vertex(h) is the index
+in P of the point that half-edge h starts from, and twin(h) is the
+half-edge going the opposite way in the neighboring triangle. So that
+every half-edge has a twin, every edge of the convex hull is also the
+edge of a ghost triangle whose third vertex is the ghost vertex P.size()
+at infinity, which are skipped with is_ghost(). A point equal to one
+that was already inserted is skipped, and so is every point if all of
+them are collinear, in which case there are no triangles.
+
+The mesh also gives the Voronoi diagram, as the dual graph whose
+vertices are the circumcenters of the triangles, so that the cell of a
+point is found by turning around it. The Euclidean minimum spanning tree
+only uses edges of the triangulation, so Kruskal's algorithm is run on
+those O(n) edges alone. The natural neighbors of a query point are the
+vertices of the triangles that it would remove if it were inserted,
+and their Sibson coordinates, the shares of the area of its would-be
+Voronoi cell taken from each of theirs, weigh their values for smooth
+interpolation. Queries walk from the triangle of the previous one, so
+they are fastest when consecutive queries are close to each other.
+
+The orientation and incircle tests are decided by the robust predicates
+of section 5.1.4, so that cocircular and collinear inputs, such as the
+points of a grid, are triangulated consistently.
+
+Time Complexity: O(n log n) expected on the number of input points for
+construction and euclidean_mst(), and O(d) for voronoi_cell() of a point
+with d neighbors. natural_neighbors() and interpolate() take O(k^2) for
+k natural neighbors, after walking to the query point.
+
+Space Complexity: O(n) for the mesh.
+
+*/
+
+#include <algorithm> /* std::find(), std::sort(), std::swap() */
+#include <cmath>     /* fabs(), sqrt() */
+#include <utility>   /* std::pair */
+#include <vector>
+
+//robust predicates by exact expansion arithmetic (see section 5.1.4)
+
+//a sum of nonoverlapping doubles in order of increasing magnitude
+typedef std::vector<double> expansion;
+
+//half the distance between 1 and the next double, i.e. 2^-53
+const double round_eps = 1.1102230246251565e-16;
+const double ccw_bound = (3 + 16 * round_eps) * round_eps;
+const double icc_bound = (10 + 96 * round_eps) * round_eps;
+
+//s + t = a + b exactly, where s is the rounded sum
+void two_sum(double a, double b, double & s, double & t) {
+  s = a + b;
+  double bv = s - a, av = s - bv;
+  t = (a - av) + (b - bv);
+}
+
+//hi + lo = a exactly, where each half has at most 26 significant bits
+void split(double a, double & hi, double & lo) {
+  double c = 134217729.0 * a; //2^27 + 1
+  hi = c - (c - a);
+  lo = a - hi;
+}
+
+//p + t = a*b exactly, where p is the rounded product
+void two_product(double a, double b, double & p, double & t) {
+  p = a * b;
+  double ahi, alo, bhi, blo;
+  split(a, ahi, alo);
+  split(b, bhi, blo);
+  t = alo * blo - (((p - ahi * bhi) - alo * bhi) - ahi * blo);
+}
+
+//the exact difference a - b
+expansion difference(double a, double b) {
+  expansion e;
+  double s, t;
+  two_sum(a, -b, s, t);
+  if (t != 0) e.push_back(t);
+  if (s != 0) e.push_back(s);
+  return e;
+}
+
+//merges the components by magnitude, then accumulates them in order
+expansion sum(const expansion & e, const expansion & f) {
+  expansion h;
+  int m = e.size(), n = f.size(), i = 0, j = 0;
+  double q = 0, s, t;
+  while (i < m || j < n) {
+    double g = (j == n || (i < m && fabs(e[i]) < fabs(f[j]))) ? e[i++] : f[j++];
+    two_sum(q, g, s, t);
+    if (t != 0) h.push_back(t);
+    q = s;
+  }
+  if (q != 0) h.push_back(q);
+  return h;
+}
+
+expansion scale(const expansion & e, double b) {
+  expansion h;
+  double q = 0, p, pt, s, t;
+  for (int i = 0; i < (int)e.size(); i++) {
+    two_product(e[i], b, p, pt);
+    two_sum(q, pt, s, t);
+    if (t != 0) h.push_back(t);
+    two_sum(p, s, q, t);
+    if (t != 0) h.push_back(t);
+  }
+  if (q != 0) h.push_back(q);
+  return h;
+}
+
+expansion product(const expansion & e, const expansion & f) {
+  expansion h;
+  for (int i = 0; i < (int)f.size(); i++) h = sum(h, scale(e, f[i]));
+  return h;
+}
+
+expansion negate(expansion e) {
+  for (int i = 0; i < (int)e.size(); i++) e[i] = -e[i];
+  return e;
+}
+
+//an approximation of the value of e with the same sign
+double estimate(const expansion & e) {
+  return e.empty() ? 0 : e.back();
+}
+
+double orient2d_exact(double ax, double ay, double bx, double by,
+                      double cx, double cy) {
+  expansion l = product(difference(ax, cx), difference(by, cy));
+  expansion r = product(difference(ay, cy), difference(bx, cx));
+  return estimate(sum(l, negate(r)));
+}
+
+double orient2d(double ax, double ay, double bx, double by,
+                double cx, double cy) {
+  double l = (ax - cx) * (by - cy), r = (ay - cy) * (bx - cx);
+  double det = l - r, bound = ccw_bound * (fabs(l) + fabs(r));
+  if (det > bound || -det > bound) return det;
+  return orient2d_exact(ax, ay, bx, by, cx, cy);
+}
+
+double incircle_exact(double ax, double ay, double bx, double by,
+                      double cx, double cy, double dx, double dy) {
+  expansion adx = difference(ax, dx), ady = difference(ay, dy);
+  expansion bdx = difference(bx, dx), bdy = difference(by, dy);
+  expansion cdx = difference(cx, dx), cdy = difference(cy, dy);
+  expansion alift = sum(product(adx, adx), product(ady, ady));
+  expansion blift = sum(product(bdx, bdx), product(bdy, bdy));
+  expansion clift = sum(product(cdx, cdx), product(cdy, cdy));
+  expansion bc = sum(product(bdx, cdy), negate(product(cdx, bdy)));
+  expansion ca = sum(product(cdx, ady), negate(product(adx, cdy)));
+  expansion ab = sum(product(adx, bdy), negate(product(bdx, ady)));
+  expansion det = sum(sum(product(alift, bc), product(blift, ca)),
+                      product(clift, ab));
+  return estimate(det);
+}
+
+double incircle(double ax, double ay, double bx, double by,
+                double cx, double cy, double dx, double dy) {
+  double adx = ax - dx, ady = ay - dy, bdx = bx - dx, bdy = by - dy;
+  double cdx = cx - dx, cdy = cy - dy;
+  double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+  double cdxady = cdx * ady, adxcdy = adx * cdy;
+  double adxbdy = adx * bdy, bdxady = bdx * ady;
+  double alift = adx * adx + ady * ady;
+  double blift = bdx * bdx + bdy * bdy;
+  double clift = cdx * cdx + cdy * cdy;
+  double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) +
+               clift * (adxbdy - bdxady);
+  double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * alift +
+                     (fabs(cdxady) + fabs(adxcdy)) * blift +
+                     (fabs(adxbdy) + fabs(bdxady)) * clift;
+  double bound = icc_bound * permanent;
+  if (det > bound || -det > bound) return det;
+  return incircle_exact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+typedef std::pair<double, double> point;
+#define x first
+#define y second
+
+//the index of (x, y) along the Hilbert curve over a 2^b by 2^b grid
+unsigned long long hilbert(unsigned x, unsigned y, int b) {
+  unsigned long long d = 0;
+  for (unsigned s = 1u << (b - 1); s > 0; s >>= 1) {
+    unsigned rx = (x & s) != 0, ry = (y & s) != 0;
+    d += (unsigned long long)s * s * ((3 * rx) ^ ry);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = ~x;
+        y = ~y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+class delaunay_mesh {
+  std::vector<point> p;
+  std::vector<int> tri, adj; //the start vertex and twin of each half-edge
+  std::vector<int> mark, by_end, cavity, from, to, outer;
+  std::vector<int> out, same; //a half-edge from each vertex, and its copy
+  int ghost;
+  mutable int last; //the triangle to walk from, which queries move
+
+  double orient(int a, int b, const point & q) const {
+    return orient2d(p[a].x, p[a].y, p[b].x, p[b].y, q.x, q.y);
+  }
+
+  //whether q is strictly inside the circumcircle of triangle t, which
+  //for a ghost triangle is the open half-plane beyond its real edge,
+  //along with the open segment of that edge
+  bool conflict(int t, const point & q) const {
+    int a = tri[3 * t], b = tri[3 * t + 1], c = tri[3 * t + 2];
+    if (a == ghost || b == ghost || c == ghost) {
+      while (c != ghost) {
+        std::swap(a, b);
+        std::swap(a, c);
+      }
+      double o = orient(a, b, q);
+      if (o != 0) return o > 0;
+      return std::min(p[a], p[b]) < q && q < std::max(p[a], p[b]);
+    }
+    return incircle(p[a].x, p[a].y, p[b].x, p[b].y, p[c].x, p[c].y,
+                    q.x, q.y) > 0;
+  }
+
+  //a triangle whose closure contains q, or else a ghost triangle whose
+  //real edge has q strictly beyond it
+  int locate(const point & q) const {
+    int t = last;
+    if (is_ghost(t)) {
+      int h = 3 * t;
+      while (tri[h] == ghost || tri[next(h)] == ghost) h = next(h);
+      t = adj[h] / 3;
+    }
+    for (;;) {
+      int k = 0;
+      while (k < 3 && orient(tri[3 * t + k], tri[next(3 * t + k)], q) >= 0)
+        k++;
+      if (k == 3) return t;
+      t = adj[3 * t + k] / 3;
+      if (is_ghost(t)) return t;
+    }
+  }
+
+  //the center of the circumcircle of triangle abc
+  static point center(const point & a, const point & b, const point & c) {
+    double bx = b.x - a.x, by = b.y - a.y, cx = c.x - a.x, cy = c.y - a.y;
+    double b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+    double d = 2 * (bx * cy - by * cx);
+    return point(a.x + (cy * b2 - by * c2) / d, a.y + (bx * c2 - cx * b2) / d);
+  }
+
+  void link(int g, int h) {
+    adj[g] = h;
+    adj[h] = g;
+  }
+
+  void insert(int v) {
+    int t = locate(p[v]);
+    for (int k = 0; k < 3; k++) {
+      if (tri[3 * t + k] != ghost && p[tri[3 * t + k]] == p[v]) {
+        same[v] = tri[3 * t + k];
+        return;
+      }
+    }
+    cavity.assign(1, t);
+    mark[t] = v;
+    from.clear();
+    to.clear();
+    outer.clear();
+    for (int i = 0; i < (int)cavity.size(); i++) {
+      for (int h = 3 * cavity[i]; h < 3 * cavity[i] + 3; h++) {
+        int u = adj[h] / 3;
+        if (mark[u] == v) continue;
+        if (conflict(u, p[v])) {
+          mark[u] = v;
+          cavity.push_back(u);
+        } else {
+          from.push_back(tri[h]);
+          to.push_back(tri[next(h)]);
+          outer.push_back(adj[h]);
+        }
+      }
+    }
+    //the boundary has two more edges than the cavity has triangles
+    for (int i = 0; i < 2; i++) {
+      cavity.push_back(tri.size() / 3);
+      tri.resize(tri.size() + 3);
+      adj.resize(adj.size() + 3);
+      mark.push_back(-1);
+    }
+    for (int i = 0; i < (int)from.size(); i++) {
+      int s = 3 * cavity[i];
+      tri[s] = from[i];
+      tri[s + 1] = to[i];
+      tri[s + 2] = v;
+      link(s, outer[i]);
+      by_end[to[i]] = cavity[i];
+      out[from[i]] = s;
+    }
+    out[v] = 3 * cavity[0] + 2;
+    for (int i = 0; i < (int)from.size(); i++)
+      link(3 * cavity[i] + 2, 3 * by_end[from[i]] + 1);
+    last = cavity[0];
+  }
+
+ public:
+  template<class It> delaunay_mesh(It lo, It hi) : p(lo, hi), last(0) {
+    int n = p.size();
+    ghost = n;
+    p.push_back(point(0, 0));
+    by_end.resize(n + 1);
+    out.assign(n + 1, -1);
+    for (int i = 0; i <= n; i++) same.push_back(i);
+    if (n < 3) return;
+    //a biased randomized insertion order, sorted by a Hilbert curve
+    double lx = p[0].x, ly = p[0].y, hx = lx, hy = ly;
+    for (int i = 1; i < n; i++) {
+      lx = std::min(lx, p[i].x);
+      ly = std::min(ly, p[i].y);
+      hx = std::max(hx, p[i].x);
+      hy = std::max(hy, p[i].y);
+    }
+    double w = std::max(hx - lx, hy - ly);
+    double scale = w > 0 ? ((1 << 20) - 1) / w : 0;
+    std::vector<std::pair<unsigned long long, int> > order(n);
+    unsigned long long state = 88172645463325252ULL;
+    for (int i = 0; i < n; i++) {
+      order[i].first = hilbert((unsigned)((p[i].x - lx) * scale),
+                               (unsigned)((p[i].y - ly) * scale), 20);
+      order[i].second = i;
+    }
+    for (int i = n - 1; i > 0; i--) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      std::swap(order[i], order[(state >> 32) * (i + 1) >> 32]);
+    }
+    for (int hi = n, lo; hi > 0; hi = lo) {
+      lo = hi / 2 < 64 ? 0 : hi / 2;
+      std::sort(order.begin() + lo, order.begin() + hi);
+    }
+    //the first triangle is the first three points which are not collinear
+    int a = order[0].second, j = 1, k;
+    while (j < n && p[order[j].second] == p[a]) j++;
+    if (j == n) return;
+    int b = order[j].second;
+    for (k = j + 1; k < n && orient(a, b, p[order[k].second]) == 0; k++) {}
+    if (k == n) return;
+    int c = order[k].second;
+    order.erase(order.begin() + k);
+    order.erase(order.begin() + j);
+    if (orient(a, b, p[c]) < 0) std::swap(b, c);
+    int v[3] = {a, b, c};
+    tri.resize(12);
+    adj.resize(12);
+    mark.assign(4, -1);
+    for (int i = 0; i < 3; i++) {
+      tri[i] = v[i];
+      tri[3 * i + 3] = v[(i + 1) % 3];
+      tri[3 * i + 4] = v[i];
+      tri[3 * i + 5] = ghost;
+      link(i, 3 * i + 3);
+      link(3 * i + 4, 3 * ((i + 2) % 3) + 5);
+      out[v[i]] = i;
+    }
+    out[ghost] = 5;
+    for (int i = 1; i < n - 2; i++) insert(order[i].second);
+  }
+
+  //the number of triangles, including ghost triangles
+  int triangles() const { return tri.size() / 3; }
+
+  bool is_ghost(int t) const {
+    return tri[3 * t] == ghost || tri[3 * t + 1] == ghost ||
+           tri[3 * t + 2] == ghost;
+  }
+
+  int vertex(int h) const { return tri[h]; }
+  int twin(int h) const { return adj[h]; }
+  static int next(int h) { return h % 3 == 2 ? h - 2 : h + 1; }
+  static int prev(int h) { return h % 3 == 0 ? h + 2 : h - 1; }
+
+  //a half-edge starting from vertex v, or -1 if v is not in the mesh
+  int edge_of(int v) const { return out[v]; }
+
+  //the vertex that was inserted in place of v, which is v unless it is
+  //a copy of an earlier point
+  int original(int v) const { return same[v]; }
+
+  //the center of the circumcircle of real triangle t, which is a vertex
+  //of the Voronoi diagram, the dual graph of the mesh
+  point circumcenter(int t) const {
+    return center(p[tri[3 * t]], p[tri[3 * t + 1]], p[tri[3 * t + 2]]);
+  }
+
+  //the Voronoi cell of vertex v as a counterclockwise polygon, where the
+  //unbounded cell of a vertex on the hull is closed off by taking, for
+  //each ghost triangle, the point at distance far beyond the middle of
+  //its hull edge, which should be farther than any circumcenter
+  std::vector<point> voronoi_cell(int v, double far) const {
+    std::vector<point> res;
+    if (out[v] < 0) return res;
+    int h = out[v];
+    do {
+      int t = h / 3;
+      if (is_ghost(t)) {
+        int g = 3 * t;
+        while (tri[g] == ghost || tri[next(g)] == ghost) g = next(g);
+        const point & a = p[tri[g]], & b = p[tri[next(g)]];
+        double dx = b.x - a.x, dy = b.y - a.y, d = sqrt(dx * dx + dy * dy);
+        res.push_back(point((a.x + b.x) / 2 - dy / d * far,
+                            (a.y + b.y) / 2 + dx / d * far));
+      } else {
+        res.push_back(circumcenter(t));
+      }
+      h = adj[prev(h)];
+    } while (h != out[v]);
+    return res;
+  }
+
+  //the natural neighbors of q by Sibson's coordinates, as pairs of a
+  //vertex and the fraction of the Voronoi cell of q that it would lose
+  //to q if q were inserted, or no pairs if q is not strictly inside
+  //the hull
+  std::vector<std::pair<int, double> >
+  natural_neighbors(const point & q) const {
+    std::vector<std::pair<int, double> > res;
+    if (tri.empty()) return res;
+    int t = last = locate(q);
+    if (is_ghost(t)) return res;
+    for (int k = 0; k < 3; k++) {
+      if (p[tri[3 * t + k]] == q) {
+        res.push_back(std::make_pair(tri[3 * t + k], 1.0));
+        return res;
+      }
+    }
+    std::vector<int> cav(1, t), bnd;
+    for (int i = 0; i < (int)cav.size(); i++) {
+      for (int h = 3 * cav[i]; h < 3 * cav[i] + 3; h++) {
+        int u = adj[h] / 3;
+        if (std::find(cav.begin(), cav.end(), u) != cav.end()) continue;
+        if (!conflict(u, q)) {
+          bnd.push_back(h);
+        } else if (is_ghost(u)) {
+          return res;
+        } else {
+          cav.push_back(u);
+        }
+      }
+    }
+    //the area taken from b is bounded by the centers of the two new
+    //triangles at b and of the triangles around b that are removed
+    double total = 0;
+    for (int i = 0; i < (int)bnd.size(); i++) {
+      int b = tri[next(bnd[i])], j = 0;
+      while (tri[bnd[j]] != b) j++;
+      std::vector<point> cell(1, center(p[tri[bnd[i]]], p[b], q));
+      for (int h = next(bnd[i]); ; h = next(adj[h])) {
+        cell.push_back(circumcenter(h / 3));
+        if (h == bnd[j]) break;
+      }
+      cell.push_back(center(p[b], p[tri[next(bnd[j])]], q));
+      double area = 0;
+      for (int k = 0, l = cell.size() - 1; k < (int)cell.size(); l = k++)
+        area += (cell[l].x - cell[k].x) * (cell[l].y + cell[k].y);
+      res.push_back(std::make_pair(b, fabs(area)));
+      total += fabs(area);
+    }
+    for (int i = 0; i < (int)res.size(); i++) res[i].second /= total;
+    return res;
+  }
+
+  //the natural neighbor interpolation at q of the values f[i] at the
+  //points, or def if q is not strictly inside the hull
+  double interpolate(const point & q, const std::vector<double> & f,
+                     double def = 0) const {
+    std::vector<std::pair<int, double> > w = natural_neighbors(q);
+    if (w.empty()) return def;
+    double res = 0;
+    for (int i = 0; i < (int)w.size(); i++)
+      res += w[i].second * f[w[i].first];
+    return res;
+  }
+
+  //the edges of a Euclidean minimum spanning tree of all of the points,
+  //which are among the O(n) edges of the mesh, by Kruskal's algorithm
+  //(see section 2.4.2)
+  std::vector<std::pair<int, int> > euclidean_mst() const {
+    int n = ghost;
+    std::vector<std::pair<double, std::pair<int, int> > > e;
+    for (int h = 0; h < (int)tri.size(); h++) {
+      int a = tri[h], b = tri[next(h)];
+      if (a < b && b != ghost) {
+        double dx = p[a].x - p[b].x, dy = p[a].y - p[b].y;
+        e.push_back(std::make_pair(dx * dx + dy * dy, std::make_pair(a, b)));
+      }
+    }
+    for (int i = 0; i < n; i++)
+      if (same[i] != i)
+        e.push_back(std::make_pair(0, std::make_pair(i, same[i])));
+    if (tri.empty()) { //the points are collinear, so they form a path
+      std::vector<std::pair<point, int> > s;
+      for (int i = 0; i < n; i++) s.push_back(std::make_pair(p[i], i));
+      std::sort(s.begin(), s.end());
+      e.clear();
+      for (int i = 0; i + 1 < n; i++)
+        e.push_back(std::make_pair(0, std::make_pair(s[i].second,
+                                                     s[i + 1].second)));
+    }
+    std::sort(e.begin(), e.end());
+    std::vector<int> root(n);
+    for (int i = 0; i < n; i++) root[i] = i;
+    std::vector<std::pair<int, int> > res;
+    for (int i = 0; i < (int)e.size(); i++) {
+      int a = e[i].second.first, b = e[i].second.second;
+      while (root[a] != a) a = root[a] = root[root[a]];
+      while (root[b] != b) b = root[b] = root[root[b]];
+      if (a != b) {
+        root[a] = b;
+        res.push_back(e[i].second);
+      }
+    }
+    return res;
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+int main() {
+  vector<point> v;
+  v.push_back(point(1, 3));
+  v.push_back(point(1, 2));
+  v.push_back(point(2, 1));
+  v.push_back(point(0, 0));
+  v.push_back(point(-1, 3));
+  delaunay_mesh dt(v.begin(), v.end());
+  int real = 0;
+  for (int t = 0; t < dt.triangles(); t++) {
+    if (dt.is_ghost(t)) continue;
+    real++;
+    cout << "Triangle:";
+    for (int h = 3 * t; h < 3 * t + 3; h++) {
+      const point & q = v[dt.vertex(h)];
+      cout << " (" << q.x << "," << q.y << ")";
+      assert(dt.vertex(dt.twin(h)) == dt.vertex(dt.next(h)));
+    }
+    cout << "\n";
+  }
+  //2n - 2 - h triangles, where h = 4 points are on the hull
+  assert(real == 4);
+
+  //(1, 2) is inside the hull, so its Voronoi cell has one vertex for
+  //each of its 4 triangles, all equally far from it and a neighbor
+  vector<point> cell = dt.voronoi_cell(1, 100);
+  assert(cell.size() == 4);
+  for (int i = 0; i < (int)cell.size(); i++) {
+    double dx = cell[i].x - 1, dy = cell[i].y - 2, d = dx * dx + dy * dy;
+    bool equal = false;
+    for (int j = 0; j < (int)v.size(); j++) {
+      double ex = cell[i].x - v[j].x, ey = cell[i].y - v[j].y;
+      equal = equal || (j != 1 && fabs(ex * ex + ey * ey - d) < 1e-9);
+    }
+    assert(equal);
+  }
+
+  //natural neighbor interpolation reproduces linear functions
+  vector<double> f;
+  for (int i = 0; i < (int)v.size(); i++) f.push_back(2 * v[i].x + 3 * v[i].y);
+  double g = dt.interpolate(point(0.5, 2), f);
+  cout << "interpolated: " << g << "\n"; //7
+  assert(fabs(g - 7) < 1e-9);
+
+  vector<pair<int, int> > mst = dt.euclidean_mst();
+  double total = 0;
+  for (int i = 0; i < (int)mst.size(); i++) {
+    const point & a = v[mst[i].first], & b = v[mst[i].second];
+    total += sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+  }
+  cout << "MST length: " << total << "\n"; //3 + sqrt(2) + sqrt(5)
+  assert(mst.size() == 4 && fabs(total - 3 - sqrt(2) - sqrt(5)) < 1e-9);
+  return 0;
+}
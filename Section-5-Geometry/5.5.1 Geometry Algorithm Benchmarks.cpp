@@ -0,0 +1,352 @@
+/*
+
+Benchmark harness for the geometry algorithms of this section on large
+synthetic point sets. As in section 2.9.1, each implementation is compiled
+straight from its own file, which is included into a namespace of its own so
+that the globals and example main() of different files do not clash. Every
+standard header used by the included files is included beforehand, so that
+their include guards keep them out of the namespaces. The point type of every
+file is the same std::pair<double, double>, so one generated point set can be
+passed to all of them, and the macros x and y, defined identically by each
+file, apply to the harness as well.
+
+The point sets have 2^s points, for s given as the first program argument (16
+by default), generated in the unit square by:
+
+- uniform: independent uniform coordinates.
+- clustered: 2^(s/2) / 4 clusters with uniform centers, each point drawn from a
+  normal distribution around a random center with a standard deviation of
+  0.01, so that the density varies by orders of magnitude.
+- circle: points at uniformly random angles on the circle of radius 0.5 around
+  (0.5, 0.5), on which every point is a hull vertex and the Delaunay
+  triangulation is nearly degenerate.
+
+On each point set, the harness times the convex hulls of section 5.3.3, the
+closest pairs of section 5.3.6, the angular sorts of section 5.3.1, and the
+Delaunay triangulations of sections 5.4.4 and 5.4.6. For the polygon routines,
+every point is made the center of a small polygon: a random quadrilateral for
+polygon_batch_stats() of section 5.3.1, and a square of side 0.002 for the
+clipping of section 5.4.1 against a convex 32-gon and of section 5.4.5 against
+a 64-vertex star, both centered in the square. The Delaunay triangulation of
+section 5.4.4 keeps its arrays on the stack, so it is run on the first 2^15
+points at most, and the boolean clipping of section 5.4.5 on the first 2^14
+polygons at most.
+
+The results are printed as a JSON array with one object per run, holding the
+number of elements (points or polygons) processed, the running time in
+seconds and in nanoseconds per element, the peak resident memory of the
+process as in section 2.9.1 (an upper bound for any single run), and a result
+(such as the number of hull vertices) to check that different
+implementations agree.
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __unix__
+#include <sys/resource.h>  // getrusage()
+#endif
+
+namespace polygon_5_3_1 {
+#include "5.3.1 Polygon Sorting and Area.cpp"
+}
+namespace hull_5_3_3 {
+#include "5.3.3 Convex Hull (2D).cpp"
+}
+namespace closest_5_3_6 {
+#include "5.3.6 Closest Point Pair (2D).cpp"
+}
+namespace cut_5_4_1 {
+#include "5.4.1 Convex Polygon Cut.cpp"
+}
+namespace delaunay_5_4_4 {
+#include "5.4.4 Delaunay Triangulation (Fast).cpp"
+}
+namespace boolean_5_4_5 {
+#include "5.4.5 Polygon Boolean Operations.cpp"
+}
+namespace delaunay_5_4_6 {
+#include "5.4.6 Delaunay Triangulation (Incremental).cpp"
+}
+
+typedef std::pair<double, double> point;
+
+// SplitMix64, so that the inputs do not depend on the platform's rand().
+class splitmix64 {
+  unsigned long long state;
+
+ public:
+  splitmix64(unsigned long long seed) : state(seed) {}
+
+  unsigned long long next() {
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  // Returns a uniformly random integer in [0, n).
+  int below(int n) {
+    return (int)(next() % (unsigned long long)n);
+  }
+
+  double uniform() {
+    return (next() >> 11)*(1.0/9007199254740992.0);
+  }
+
+  // Returns a standard normal variate by the Box-Muller transform.
+  double normal() {
+    double u = 1 - uniform(), v = uniform();
+    return sqrt(-2*log(u))*cos(2*acos(-1.0)*v);
+  }
+};
+
+struct point_set {
+  std::string name;
+  std::vector<point> p;
+};
+
+point_set uniform_points(int n, splitmix64 &rng) {
+  point_set s;
+  s.name = "uniform";
+  for (int i = 0; i < n; i++) {
+    double px = rng.uniform();
+    s.p.push_back(point(px, rng.uniform()));
+  }
+  return s;
+}
+
+point_set clustered_points(int scale, splitmix64 &rng) {
+  point_set s;
+  s.name = "clustered";
+  int n = 1 << scale, k = std::max(1, (1 << (scale/2))/4);
+  std::vector<point> center;
+  for (int i = 0; i < k; i++) {
+    double cx = rng.uniform();
+    center.push_back(point(cx, rng.uniform()));
+  }
+  for (int i = 0; i < n; i++) {
+    const point &c = center[rng.below(k)];
+    double px = c.x + 0.01*rng.normal();
+    s.p.push_back(point(px, c.y + 0.01*rng.normal()));
+  }
+  return s;
+}
+
+point_set circle_points(int n, splitmix64 &rng) {
+  point_set s;
+  s.name = "circle";
+  for (int i = 0; i < n; i++) {
+    double a = 2*acos(-1.0)*rng.uniform();
+    s.p.push_back(point(0.5 + 0.5*cos(a), 0.5 + 0.5*sin(a)));
+  }
+  return s;
+}
+
+// Returns a polygon of k vertices at radius r around (cx, cy), alternating
+// with radius r*inner (a star unless inner is 1), in counterclockwise order.
+std::vector<point> star(double cx, double cy, double r, double inner, int k) {
+  std::vector<point> res;
+  for (int i = 0; i < k; i++) {
+    double a = 2*acos(-1.0)*i/k, d = (i % 2 == 0) ? r : r*inner;
+    res.push_back(point(cx + d*cos(a), cy + d*sin(a)));
+  }
+  return res;
+}
+
+std::vector<point> square(const point &c, double side) {
+  std::vector<point> res;
+  res.push_back(point(c.x - side/2, c.y - side/2));
+  res.push_back(point(c.x + side/2, c.y - side/2));
+  res.push_back(point(c.x + side/2, c.y + side/2));
+  res.push_back(point(c.x - side/2, c.y + side/2));
+  return res;
+}
+
+long long peak_memory_kb() {
+#ifdef __unix__
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return usage.ru_maxrss;
+  }
+#endif
+  return -1;
+}
+
+double seconds_since(std::clock_t start) {
+  return (double)(std::clock() - start)/CLOCKS_PER_SEC;
+}
+
+bool first_row = true;
+
+void report(const point_set &s, const char *algorithm, long long elements,
+            double run, double result) {
+  std::cout << (first_row ? "" : ",\n");
+  std::cout << "{\"suite\": \"geometry\", \"input\": \"" << s.name
+            << "\", \"algorithm\": \"" << algorithm << "\", \"elements\": "
+            << elements << ", \"run_seconds\": " << run
+            << ", \"ns_per_element\": "
+            << (elements > 0 ? run*1e9/elements : 0.0)
+            << ", \"peak_memory_kb\": " << peak_memory_kb()
+            << ", \"result\": " << result << "}";
+  first_row = false;
+}
+
+void benchmark_hull(const point_set &s) {
+  std::vector<point> v(s.p);
+  std::clock_t start = std::clock();
+  int h = hull_5_3_3::convex_hull(v.begin(), v.end()).size();
+  report(s, "convex_hull", v.size(), seconds_since(start), h);
+  v = s.p;
+  start = std::clock();
+  h = hull_5_3_3::convex_hull_chan(v.begin(), v.end()).size();
+  report(s, "convex_hull_chan", v.size(), seconds_since(start), h);
+  hull_5_3_3::point_batch b;
+  for (int i = 0; i < (int)s.p.size(); i++) {
+    b.push_back(s.p[i]);
+  }
+  start = std::clock();
+  h = hull_5_3_3::convex_hull(b).size();
+  report(s, "convex_hull(point_batch)", b.size(), seconds_since(start), h);
+}
+
+void benchmark_closest_pair(const point_set &s) {
+  std::vector<point> v(s.p);
+  std::clock_t start = std::clock();
+  std::pair<point, point> r = closest_5_3_6::closest_pair(v.begin(), v.end());
+  report(s, "closest_pair", v.size(), seconds_since(start),
+         closest_5_3_6::sqdist(r.first, r.second));
+  closest_5_3_6::point_batch b;
+  for (int i = 0; i < (int)s.p.size(); i++) {
+    b.push_back(s.p[i]);
+  }
+  start = std::clock();
+  std::pair<int, int> k = closest_5_3_6::closest_pair(b);
+  report(s, "closest_pair(point_batch)", b.size(), seconds_since(start),
+         closest_5_3_6::sqdist(b[k.first], b[k.second]));
+  start = std::clock();
+  k = closest_5_3_6::closest_pair_grid(b);
+  report(s, "closest_pair_grid", b.size(), seconds_since(start),
+         closest_5_3_6::sqdist(b[k.first], b[k.second]));
+}
+
+void benchmark_angular_sort(const point_set &s) {
+  using namespace polygon_5_3_1;
+  std::vector<point> v(s.p);
+  ctr = centroid(v.begin(), v.end());
+  std::clock_t start = std::clock();
+  std::sort(v.begin(), v.end(), cw_comp);
+  report(s, "sort(cw_comp)", v.size(), seconds_since(start), v[0].x);
+  v = s.p;
+  start = std::clock();
+  cw_radix_sort(v.begin(), v.end());
+  report(s, "cw_radix_sort", v.size(), seconds_since(start), v[0].x);
+}
+
+void benchmark_polygon_stats(const point_set &s, splitmix64 &rng) {
+  using namespace polygon_5_3_1;
+  polygon_batch b;
+  for (int i = 0; i < (int)s.p.size(); i++) {
+    std::vector<point> q;
+    for (int k = 0; k < 4; k++) {
+      double r = 0.001*(0.5 + rng.uniform());
+      double a = (k + rng.uniform())*0.5*acos(-1.0);
+      q.push_back(point(s.p[i].x + r*cos(a), s.p[i].y + r*sin(a)));
+    }
+    b.push_back(q.begin(), q.end());
+  }
+  std::vector<double> area;
+  std::vector<point> c;
+  std::vector<int> orientation;
+  std::clock_t start = std::clock();
+  polygon_batch_stats(b, area, c, orientation);
+  double run = seconds_since(start), total = 0;
+  for (int i = 0; i < (int)area.size(); i++) {
+    total += area[i];
+  }
+  report(s, "polygon_batch_stats", b.size(), run, total);
+}
+
+void benchmark_clipping(const point_set &s) {
+  std::vector<std::vector<point> > squares;
+  for (int i = 0; i < (int)s.p.size(); i++) {
+    squares.push_back(square(s.p[i], 0.002));
+  }
+  std::vector<point> window = star(0.5, 0.5, 0.5, 1, 32), res;
+  std::vector<int> end;
+  cut_5_4_1::convex_clipper cc(window.begin(), window.end());
+  std::clock_t start = std::clock();
+  cc.clip_all(squares.begin(), squares.end(), res, end);
+  report(s, "convex_clipper::clip_all", squares.size(), seconds_since(start),
+         res.size());
+
+  using namespace boolean_5_4_5;
+  std::vector<contour> clip(1, star(0.5, 0.5, 0.5, 0.5, 64));
+  polygon_clipper pc(clip);
+  int m = std::min((int)squares.size(), 1 << 14), pieces = 0;
+  start = std::clock();
+  for (int i = 0; i < m; i++) {
+    std::vector<contour> subject(1, squares[i]);
+    pieces += pc.apply(subject, INTERSECTION).size();
+  }
+  report(s, "polygon_clipper::apply", m, seconds_since(start), pieces);
+}
+
+void benchmark_delaunay(const point_set &s) {
+  int m = std::min((int)s.p.size(), 1 << 15);
+  std::vector<point> v(s.p.begin(), s.p.begin() + m);
+  std::clock_t start = std::clock();
+  int t = delaunay_5_4_4::delaunay_triangulation(v.begin(), v.end()).size();
+  report(s, "delaunay_triangulation", m, seconds_since(start), t);
+  start = std::clock();
+  delaunay_5_4_6::delaunay_mesh mesh(s.p.begin(), s.p.end());
+  double run = seconds_since(start);
+  int real = 0;
+  for (int i = 0; i < mesh.triangles(); i++) {
+    real += !mesh.is_ghost(i);
+  }
+  report(s, "delaunay_mesh", s.p.size(), run, real);
+}
+
+/*** Example Usage ***/
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+  int scale = (argc > 1) ? atoi(argv[1]) : 16;
+  assert(scale >= 4 && scale <= 24);
+  splitmix64 rng(12345);
+  cout.precision(6);
+  cout << "[\n";
+  for (int kind = 0; kind < 3; kind++) {
+    point_set s;
+    switch (kind) {
+      case 0: s = uniform_points(1 << scale, rng); break;
+      case 1: s = clustered_points(scale, rng); break;
+      case 2: s = circle_points(1 << scale, rng); break;
+    }
+    benchmark_hull(s);
+    benchmark_closest_pair(s);
+    benchmark_angular_sort(s);
+    benchmark_polygon_stats(s, rng);
+    benchmark_clipping(s);
+    benchmark_delaunay(s);
+  }
+  cout << "\n]" << endl;
+  return 0;
+}
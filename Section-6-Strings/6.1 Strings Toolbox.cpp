@@ -7,7 +7,11 @@ have an unspecified complexity. They may not be optimally efficient.
 
 */
 
-#include <cstdlib>
+#include <algorithm> /* std::copy(), std::equal() */
+#include <cstddef>   /* size_t */
+#include <cstdio>    /* sprintf() */
+#include <cstdlib>   /* strtod() */
+#include <cstring>   /* strlen() */
 #include <sstream>
 #include <string>
 #include <vector>
@@ -61,28 +65,208 @@ char* itoa(int value, char * str, int base = 10) {
 
 /*
 
+Fast number parsing and formatting without streams, in the manner of
+std::from_chars() and std::to_chars() in C++17. parse() reads a long
+long or a double from the characters [p, end). On success, it stores
+the value, advances p past the number, and returns true. If there is no
+number at p, or an integer does not fit in a long long, it returns false
+and leaves both p and the value unchanged. Unlike to_int() above, no
+leading whitespace or '+' sign is accepted, and "inf" and "nan" are not.
+
+Integers are read 8 digits at a time by SWAR (SIMD within a register):
+8 characters are packed into a 64-bit word, checked to all be digits by
+a few bitwise operations, and combined into their value by 3 multiplies.
+A double whose significand has at most 19 digits and fits in 53 bits,
+and whose decimal exponent is at most 22 in magnitude, is computed
+exactly as the product or quotient of two exact doubles (the fast path
+of Clinger). Otherwise, the characters are passed to strtod().
+
+format() writes a number to out and returns the end of the characters
+written, which are not null-terminated. Integers are written two digits
+at a time from a table of the 100 pairs of digits. A double is written
+by sprintf() with 15 significant digits, or with 17 if 15 do not read
+back as the same value. parse_all() reads numbers separated by the
+character sep, such as a column of a file already read into memory, and
+returns the position where it stops. format_all() appends the values in
+a range to a string, separated by sep.
+
+Time Complexity: O(n) for n characters parsed or written.
+
+Space Complexity: O(1) auxiliary, except for the copy passed to strtod().
+
+*/
+
+bool parse_eight(const char * p, unsigned long long & v) {
+  unsigned long long x = 0;
+  for (int i = 0; i < 8; i++)
+    x |= (unsigned long long)(unsigned char)p[i] << (8 * i);
+  unsigned long long hi = x & 0xF0F0F0F0F0F0F0F0ULL;
+  unsigned long long lo = (x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL;
+  if ((hi | lo >> 4) != 0x3333333333333333ULL) return false;
+  x -= 0x3030303030303030ULL;
+  x = x * 10 + (x >> 8);
+  x = ((x & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)) +
+       ((x >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))) >> 32;
+  v = v * 100000000 + (x & 0xFFFFFFFF);
+  return true;
+}
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+bool parse(const char *& p, const char * end, long long & res) {
+  const char * q = p;
+  bool neg = (q != end && *q == '-');
+  if (neg) q++;
+  const char * start = q;
+  while (q != end && *q == '0') q++;
+  const char * first = q;
+  unsigned long long v = 0;
+  while (end - q >= 8 && q - first <= 11 && parse_eight(q, v)) q += 8;
+  for (; q != end && is_digit(*q); q++) {
+    if (q - first >= 19) return false;
+    v = v * 10 + (*q - '0');
+  }
+  if (q == start || v > 9223372036854775807ULL + neg) return false;
+  res = neg ? -(long long)(v - 1) - 1 : (long long)v;
+  p = q;
+  return true;
+}
+
+bool parse(const char *& p, const char * end, double & res) {
+  static const double exact[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  const char * q = p;
+  bool neg = (q != end && *q == '-'), any = false, truncated = false;
+  if (neg) q++;
+  unsigned long long m = 0;
+  int digits = 0, exp10 = 0;
+  for (; q != end && is_digit(*q); q++, any = true) {
+    if (digits < 19) {
+      m = m * 10 + (*q - '0');
+      if (m != 0) digits++;
+    } else {
+      exp10++;
+      truncated = truncated || *q != '0';
+    }
+  }
+  if (q != end && *q == '.') {
+    for (q++; q != end && is_digit(*q); q++, any = true) {
+      if (digits < 19) {
+        m = m * 10 + (*q - '0');
+        if (m != 0) digits++;
+        exp10--;
+      } else {
+        truncated = truncated || *q != '0';
+      }
+    }
+  }
+  if (!any) return false;
+  if (q != end && (*q == 'e' || *q == 'E')) {
+    const char * r = q + 1;
+    bool eneg = (r != end && *r == '-');
+    if (r != end && (*r == '-' || *r == '+')) r++;
+    if (r != end && is_digit(*r)) {
+      int e = 0;
+      for (; r != end && is_digit(*r); r++)
+        if (e < 100000) e = e * 10 + (*r - '0');
+      exp10 += eneg ? -e : e;
+      q = r;
+    }
+  }
+  if (!truncated && m <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+    double v = (double)m;
+    v = (exp10 < 0) ? v / exact[-exp10] : v * exact[exp10];
+    res = neg ? -v : v;
+  } else {
+    res = strtod(std::string(p, q).c_str(), 0);
+  }
+  p = q;
+  return true;
+}
+
+char * format(long long v, char * out) {
+  static const char pairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+  unsigned long long u = v;
+  if (v < 0) {
+    *out++ = '-';
+    u = 0 - u;
+  }
+  char buf[20], * b = buf + 20;
+  for (; u >= 100; u /= 100) {
+    int i = u % 100 * 2;
+    *--b = pairs[i + 1];
+    *--b = pairs[i];
+  }
+  if (u >= 10) {
+    *--b = pairs[u * 2 + 1];
+    *--b = pairs[u * 2];
+  } else {
+    *--b = '0' + u;
+  }
+  return std::copy(b, buf + 20, out);
+}
+
+char * format(int v, char * out) { return format((long long)v, out); }
+char * format(long v, char * out) { return format((long long)v, out); }
+
+char * format(double v, char * out) {
+  int n = sprintf(out, "%.15g", v);
+  if (strtod(out, 0) != v) n = sprintf(out, "%.17g", v);
+  return out + n;
+}
+
+template<class T>
+const char * parse_all(const char * p, const char * end, char sep,
+                       std::vector<T> & res) {
+  T v;
+  while (p != end && parse(p, end, v)) {
+    res.push_back(v);
+    if (p == end || *p != sep) break;
+    p++;
+  }
+  return p;
+}
+
+template<class It>
+void format_all(It lo, It hi, char sep, std::string & res) {
+  char buf[32];
+  for (It it = lo; it != hi; ++it) {
+    if (it != lo) res += sep;
+    res.append(buf, format(*it, buf) - buf);
+  }
+}
+
+/*
+
 Trimming functions (in place). Given a string and optionally a series
 of characters to be considered for trimming, trims the string's ends
 (left, right, or both) and returns the string. Note that the ORIGINAL
 string is trimmed as it's passed by reference, despite the original
-reference being returned for convenience.
+reference being returned for convenience. A string consisting only of
+delimiters is trimmed to the empty string. To trim without copying or
+with a lookup table of delimiters, see trim() on a string_ref below.
 
 */
 
 std::string& ltrim(std::string & s, const std::string & delim = " \n\t\v\f\r") {
-  unsigned int pos = s.find_first_not_of(delim);
-  if (pos != std::string::npos) s.erase(0, pos);
+  s.erase(0, s.find_first_not_of(delim));
   return s;
 }
 
 std::string& rtrim(std::string & s, const std::string & delim = " \n\t\v\f\r") {
-  unsigned int pos = s.find_last_not_of(delim);
-  if (pos != std::string::npos) s.erase(pos);
+  s.erase(s.find_last_not_of(delim) + 1); //npos + 1 == 0 erases all
   return s;
 }
 
 std::string& trim(std::string & s, const std::string & delim = " \n\t\v\f\r") {
-  return ltrim(rtrim(s));
+  return ltrim(rtrim(s, delim), delim);
 }
 
 /*
@@ -100,7 +284,7 @@ std::string replace(std::string s,
                     const std::string & search,
                     const std::string & replace) {
   if (search.empty()) return s;
-  unsigned int pos = 0;
+  std::string::size_type pos = 0;
   while ((pos = s.find(search, pos)) != std::string::npos) {
     s.replace(pos, search.length(), replace);
     pos += replace.length();
@@ -165,7 +349,7 @@ Time Complexity: O(s.length() * delim.length())
 std::vector<std::string> explode(const std::string & s,
                                  const std::string & delim) {
   std::vector<std::string> res;
-  unsigned int last = 0, next = 0;
+  std::string::size_type last = 0, next = 0;
   while ((next = s.find(delim, last)) != std::string::npos) {
     res.push_back(s.substr(last, next - last));
     last = next + delim.size();
@@ -174,6 +358,124 @@ std::vector<std::string> explode(const std::string & s,
   return res;
 }
 
+/*
+
+Zero-copy tokenizing. A string_ref refers to a range of characters that
+it does not own (like std::string_view in C++17), so that tokens can be
+examined without allocating a copy of each. It is only valid for as long
+as the string it refers to is neither destroyed nor modified.
+
+A delim_set classifies characters as delimiters by a table of 256 bits,
+so that each test is O(1) regardless of the number of delimiters. Its
+find(lo, hi, want) returns a pointer to the first character in [lo, hi)
+which is a delimiter if want is true, or else which is not, or hi if
+there is none. When SSE2 is available and there are at most 16 distinct
+delimiters, 16 characters at a time are compared against every delimiter
+and the first match is read off the resulting bit mask.
+
+A tokenizer lazily yields the tokens of a string like split() version 2,
+skipping empty tokens, without building a vector. Each call to next(tok)
+stores the next token in tok and returns true, or returns false once the
+string is exhausted. trim() on a string_ref narrows the range in place.
+
+Time Complexity: O(d) to construct a delim_set from d delimiters. O(n)
+over all calls to next() for a string of length n, and O(n) for trim().
+With SSE2, comparisons are done on 16 characters at a time.
+
+Space Complexity: O(1) auxiliary.
+
+*/
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+struct string_ref {
+  const char * data;
+  size_t size;
+
+  string_ref(): data(0), size(0) {}
+  string_ref(const char * d, size_t n): data(d), size(n) {}
+  string_ref(const char * s): data(s), size(strlen(s)) {}
+  string_ref(const std::string & s): data(s.data()), size(s.size()) {}
+
+  bool empty() const { return size == 0; }
+  const char * begin() const { return data; }
+  const char * end() const { return data + size; }
+  std::string str() const { return std::string(data, size); }
+
+  bool operator == (const string_ref & s) const {
+    return size == s.size && std::equal(data, data + size, s.data);
+  }
+};
+
+class delim_set {
+  unsigned long long bits[4];
+  char list[16];
+  int n; //number of distinct delimiters, or more than 16 if too many
+
+ public:
+  explicit delim_set(const std::string & delim = " \n\t\v\f\r"): n(0) {
+    bits[0] = bits[1] = bits[2] = bits[3] = 0;
+    for (int i = 0; i < (int)delim.size(); i++) {
+      unsigned char c = delim[i];
+      if (bits[c >> 6] >> (c & 63) & 1) continue;
+      bits[c >> 6] |= 1ULL << (c & 63);
+      if (n < 16) list[n] = c;
+      n++;
+    }
+  }
+
+  bool operator () (char ch) const {
+    unsigned char c = ch;
+    return bits[c >> 6] >> (c & 63) & 1;
+  }
+
+  const char * find(const char * lo, const char * hi, bool want) const {
+#ifdef __SSE2__
+    if (n <= 16) {
+      for (; hi - lo >= 16; lo += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)lo);
+        __m128i m = _mm_setzero_si128();
+        for (int i = 0; i < n; i++)
+          m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(list[i])));
+        int mask = _mm_movemask_epi8(m);
+        if (!want) mask ^= 0xffff;
+        if (mask != 0) return lo + __builtin_ctz(mask);
+      }
+    }
+#endif
+    while (lo != hi && (*this)(*lo) != want) lo++;
+    return lo;
+  }
+};
+
+class tokenizer {
+  const char * pos, * end;
+  delim_set delim;
+
+ public:
+  tokenizer(const string_ref & s, const delim_set & d)
+  : pos(s.begin()), end(s.end()), delim(d) {}
+
+  bool next(string_ref & tok) {
+    const char * lo = delim.find(pos, end, false);
+    if (lo == end) {
+      pos = end;
+      return false;
+    }
+    pos = delim.find(lo, end, true);
+    tok = string_ref(lo, pos - lo);
+    return true;
+  }
+};
+
+string_ref & trim(string_ref & s, const delim_set & delim) {
+  const char * lo = delim.find(s.begin(), s.end(), false), * hi = s.end();
+  while (hi != lo && delim(hi[-1])) hi--;
+  return s = string_ref(lo, hi - lo);
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -196,10 +498,47 @@ int main() {
   assert(string(itoa(1750, buffer, 16)) == "6d6");
   assert(string(itoa(1750, buffer, 2)) == "11011010110");
 
+  string num("-9223372036854775808 12345678901234567890 0.1 2.5e-3x");
+  const char * p = num.data(), * end = p + num.size();
+  long long l;
+  double d;
+  assert(parse(p, end, l) && l == -9223372036854775807LL - 1 && *p == ' ');
+  assert(!parse(++p, end, l) && *p == '1'); //overflow
+  p += 21;
+  assert(parse(p, end, d) && d == 0.1);
+  assert(parse(++p, end, d) && d == 2.5e-3 && *p == 'x');
+  assert(!parse(p, end, d));
+  assert(string(buffer, format(-1750, buffer)) == "-1750");
+  assert(string(buffer, format(0.1, buffer)) == "0.1");
+
+  //a column of numbers, and two columns of a CSV file
+  string col("17\n-4\n300000000000\n"), csv("1,0.5\n2,-1e3\n"), out;
+  vector<long long> vl;
+  assert(parse_all(col.data(), col.data() + col.size(), '\n', vl) ==
+         col.data() + col.size());
+  assert(vl.size() == 3 && vl[2] == 300000000000LL);
+  format_all(vl.begin(), vl.end(), ',', out);
+  assert(out == "17,-4,300000000000");
+  vector<double> x, y;
+  p = csv.data();
+  end = p + csv.size();
+  while (p != end) {
+    parse(p, end, d);
+    x.push_back(d);
+    parse(++p, end, d); //skip ','
+    y.push_back(d);
+    p++; //skip '\n'
+  }
+  assert(x.size() == 2 && x[1] == 2 && y[1] == -1000);
+
   string s("   abc \n");
   string t = s;
   assert(ltrim(s) == "abc \n");
   assert(rtrim(s) == trim(t));
+  s = " \t ";
+  assert(rtrim(s).empty());
+  s = "--abc+-";
+  assert(trim(s, "+-") == "abc");
   assert(replace("abcdabba", "ab", "00") == "00cd00ba");
 
   vector<string> tokens;
@@ -214,6 +553,23 @@ int main() {
 
   tokens = explode("a..b.cde....f", "..");
   cout << "explode: ";
-  print(tokens); //["a", ".b.cde", "", ".f"]
+  print(tokens); //["a", "b.cde", "", "f"]
+
+  //the same tokens as split v2, without copying any of them
+  string line("a::b,cde:,f with a longer tail:::of,,many tokens,");
+  tokenizer tk(line, delim_set(":, "));
+  tokens = split(line, ":, ");
+  string_ref tok;
+  for (int i = 0; tk.next(tok); i++) {
+    assert(tok == tokens[i] && tok.str() == tokens[i]);
+    assert(tok.begin() >= line.data());
+    assert(tok.end() <= line.data() + line.size());
+  }
+  assert(!tk.next(tok));
+
+  string_ref r("  \n padded text\t ");
+  assert(trim(r, delim_set()).str() == "padded text");
+  r = string_ref("   ");
+  assert(trim(r, delim_set()).empty());
   return 0;
 }
@@ -3,6 +3,8 @@
 Evaluate a mathematical expression in accordance to the order
 of operations (parentheses, exponents, multiplication, division,
 addition, subtraction). Does not handle unary operators like '-'.
+To evaluate the same expression many times, possibly with variables,
+see the bytecode compiler in section 6.2.4.
 
 */
 
@@ -0,0 +1,268 @@
+/*
+
+Compile a mathematical expression once into a flat postfix bytecode,
+then evaluate it many times for different values of its variables. The
+expression may contain numbers, the variables named to the constructor,
+parentheses, the binary operators '+', '-', '*', '/', and '^' (with the
+usual precedences, '^' being right associative), and the unary operators
+'-' and '+'. For example, "-x^2 + 3*(y - 1)" with the variables {"x", "y"}.
+A syntax error or an unknown name throws a std::runtime_error.
+
+The parser is a recursive descent parser like the one in section 6.2.1,
+except that rather than computing a value, each rule emits instructions
+for a stack machine: pushing a constant or a variable, negating the top
+of the stack, or replacing the top two values by the result of a binary
+operator. Constants are folded as the code is emitted. Whenever an
+operator would be emitted directly after pushes of all of its operands
+as constants, those pushes are instead replaced by a push of the result.
+The greatest depth of the stack is found once after compiling.
+
+eval(x) evaluates the expression where x[i] is the value of the i-th
+variable. eval_all(col, rows, out) evaluates the expression for rows
+rows at once, where col[i][r] is the value of the i-th variable in the
+r-th row, storing the results in out[0..rows-1]. Rather than dispatching
+on every instruction for every row, it executes each instruction on a
+block of up to 256 rows at a time, so that the cost of interpreting the
+bytecode is shared by each block and the inner loops can be vectorized.
+
+Time Complexity: O(n) to compile an expression of length n. O(m) per
+call to eval() and O(m*rows) per call to eval_all(), where m is the
+number of instructions after folding.
+
+Space Complexity: O(n) for the bytecode and O(d) auxiliary stack space
+per row evaluated at once, where d is the greatest depth of the stack.
+
+*/
+
+#include <algorithm> /* std::copy(), std::fill(), std::find(), std::max() */
+#include <cctype>    /* isalnum(), isalpha(), isdigit(), isspace() */
+#include <cmath>     /* pow() */
+#include <cstdlib>   /* strtod() */
+#include <stdexcept> /* std::runtime_error */
+#include <string>
+#include <vector>
+
+class expression {
+  enum opcode { CONST, VAR, NEG, ADD, SUB, MUL, DIV, POW };
+
+  struct instr {
+    opcode op;
+    int var;
+    double val;
+
+    instr(opcode o, int v, double x): op(o), var(v), val(x) {}
+  };
+
+  static const int BLOCK = 256;
+
+  std::vector<instr> code;
+  std::vector<std::string> names;
+  int depth;
+  const char * p; //the position of the parser while compiling
+  mutable std::vector<double> stack, block;
+
+  static double apply(opcode op, double x, double y) {
+    switch (op) {
+      case ADD: return x + y;
+      case SUB: return x - y;
+      case MUL: return x * y;
+      case DIV: return x / y;
+      default: return pow(x, y);
+    }
+  }
+
+  void emit(opcode op) {
+    int n = code.size();
+    if (op == NEG && code[n - 1].op == CONST) {
+      code[n - 1].val = -code[n - 1].val;
+    } else if (op != NEG && code[n - 1].op == CONST &&
+               code[n - 2].op == CONST) {
+      code[n - 2].val = apply(op, code[n - 2].val, code[n - 1].val);
+      code.pop_back();
+    } else {
+      code.push_back(instr(op, 0, 0));
+    }
+  }
+
+  void fail() {
+    if (*p == '\0') throw std::runtime_error("Unexpected end of expression");
+    throw std::runtime_error(std::string("Bad character: ") + *p);
+  }
+
+  void space() {
+    while (isspace((unsigned char)*p)) p++;
+  }
+
+  // primary ::= number | variable | '(' sum ')'
+  void primary() {
+    space();
+    if (*p == '(') {
+      p++;
+      sum();
+      space();
+      if (*p != ')') fail();
+      p++;
+    } else if (isdigit((unsigned char)*p) || *p == '.') {
+      char * end;
+      double v = strtod(p, &end);
+      if (end == p) fail();
+      p = end;
+      code.push_back(instr(CONST, 0, v));
+    } else if (isalpha((unsigned char)*p) || *p == '_') {
+      const char * lo = p;
+      while (isalnum((unsigned char)*p) || *p == '_') p++;
+      std::string name(lo, p);
+      int i = std::find(names.begin(), names.end(), name) - names.begin();
+      if (i == (int)names.size())
+        throw std::runtime_error("Unknown variable: " + name);
+      code.push_back(instr(VAR, i, 0));
+    } else {
+      fail();
+    }
+  }
+
+  // unary ::= '-' unary | '+' unary | primary | primary '^' unary
+  void unary() {
+    space();
+    if (*p == '-' || *p == '+') {
+      bool neg = (*p++ == '-');
+      unary();
+      if (neg) emit(NEG);
+      return;
+    }
+    primary();
+    space();
+    if (*p == '^') {
+      p++;
+      unary();
+      emit(POW);
+    }
+  }
+
+  // term ::= unary | term '*' unary | term '/' unary
+  void term() {
+    unary();
+    for (space(); *p == '*' || *p == '/'; space()) {
+      opcode op = (*p++ == '*') ? MUL : DIV;
+      unary();
+      emit(op);
+    }
+  }
+
+  // sum ::= term | sum '+' term | sum '-' term
+  void sum() {
+    term();
+    for (space(); *p == '+' || *p == '-'; space()) {
+      opcode op = (*p++ == '+') ? ADD : SUB;
+      term();
+      emit(op);
+    }
+  }
+
+ public:
+  expression(const std::string & s,
+             const std::vector<std::string> & vars =
+                 std::vector<std::string>()): names(vars) {
+    p = s.c_str();
+    sum();
+    if (*p != '\0') fail();
+    p = 0;
+    depth = 0;
+    for (int i = 0, top = 0; i < (int)code.size(); i++) {
+      if (code[i].op == CONST || code[i].op == VAR) {
+        depth = std::max(depth, ++top);
+      } else if (code[i].op != NEG) {
+        top--;
+      }
+    }
+    stack.resize(depth);
+    block.resize(depth * BLOCK);
+  }
+
+  int size() const { return code.size(); }
+
+  bool is_constant() const { return code.size() == 1 && code[0].op == CONST; }
+
+  double eval(const double * x = 0) const {
+    double * st = &stack[0];
+    int top = -1;
+    for (int i = 0; i < (int)code.size(); i++) {
+      const instr & c = code[i];
+      switch (c.op) {
+        case CONST: st[++top] = c.val; break;
+        case VAR: st[++top] = x[c.var]; break;
+        case NEG: st[top] = -st[top]; break;
+        default: top--; st[top] = apply(c.op, st[top], st[top + 1]);
+      }
+    }
+    return st[0];
+  }
+
+  void eval_all(const double * const * col, int rows, double * out) const {
+    for (int lo = 0; lo < rows; lo += BLOCK) {
+      int m = (rows - lo < BLOCK) ? rows - lo : BLOCK, top = -1;
+      for (int i = 0; i < (int)code.size(); i++) {
+        const instr & c = code[i];
+        if (c.op == CONST || c.op == VAR) top++;
+        double * a = &block[top * BLOCK];
+        switch (c.op) {
+          case CONST: std::fill(a, a + m, c.val); continue;
+          case VAR: std::copy(col[c.var] + lo, col[c.var] + lo + m, a);
+                    continue;
+          case NEG: for (int j = 0; j < m; j++) a[j] = -a[j]; continue;
+          default: top--; a -= BLOCK;
+        }
+        const double * b = a + BLOCK;
+        switch (c.op) {
+          case ADD: for (int j = 0; j < m; j++) a[j] += b[j]; break;
+          case SUB: for (int j = 0; j < m; j++) a[j] -= b[j]; break;
+          case MUL: for (int j = 0; j < m; j++) a[j] *= b[j]; break;
+          case DIV: for (int j = 0; j < m; j++) a[j] /= b[j]; break;
+          default: for (int j = 0; j < m; j++) a[j] = pow(a[j], b[j]);
+        }
+      }
+      std::copy(&block[0], &block[0] + m, out + lo);
+    }
+  }
+};
+
+/*** Example Usage ***/
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+int main() {
+  expression e("1+2*3*4+3*(2+2)-100");
+  assert(e.is_constant() && e.eval() == -63);
+
+  vector<string> vars;
+  vars.push_back("x");
+  vars.push_back("y");
+  expression f("-x^2 + 3*(y - 1) * (2^3 - 4/2)", vars);
+  assert(f.size() == 12); //(2^3 - 4/2) is folded into 6
+  double x[] = {3, 2};
+  cout << f.eval(x) << "\n"; //9
+  assert(f.eval(x) == 9);
+
+  //evaluate f over columns of x and y values
+  double xs[1000], ys[1000], out[1000];
+  const double * cols[] = {xs, ys};
+  for (int i = 0; i < 1000; i++) {
+    xs[i] = i % 7;
+    ys[i] = i / 10.0;
+  }
+  f.eval_all(cols, 1000, out);
+  for (int i = 0; i < 1000; i++) {
+    double row[] = {xs[i], ys[i]};
+    assert(out[i] == f.eval(row));
+  }
+
+  try {
+    expression g("x * z", vars);
+    assert(false);
+  } catch (const runtime_error & ex) {
+    cout << ex.what() << "\n"; //Unknown variable: z
+  }
+  return 0;
+}
@@ -17,13 +17,15 @@ Space Complexity: O(m) auxiliary on the length of the pattern.
 
 */
 
+#include <algorithm> /* std::min() */
+#include <cstring>   /* memcmp() */
 #include <string>
 #include <vector>
 
 int find(const std::string & text, const std::string & pattern) {
   if (pattern.empty()) return 0;
   //generate table using pattern
-  std::vector<int> p(pattern.size());
+  std::vector<int> p(pattern.size() + 1);
   for (int i = 0, j = p[0] = -1; i < (int)pattern.size(); ) {
     while (j >= 0 && pattern[i] != pattern[j])
       j = p[j];
@@ -41,14 +43,186 @@ int find(const std::string & text, const std::string & pattern) {
     if (i >= (int)pattern.size())
       return j - i;
   }
-  return std::string::npos;
+  return -1; //not found
 }
 
+/*
+
+A precompiled pattern for repeated searches, finding every occurrence
+(possibly overlapping) rather than just the first. The KMP table of the
+pattern is built once by the constructor. advance(state, c) is a single
+step of the KMP automaton, where a state is the length of the longest
+prefix of the pattern that is a suffix of the text so far. It returns
+the pattern's length exactly when an occurrence ends at c.
+
+Searching first filters the candidate positions by comparing both the
+first and the last character of the pattern against 16 positions of the
+text at a time using SSE2 (or one position at a time without it), and
+only the candidates passing both tests are compared in full. Since this
+is quadratic on texts like "aaa...a" with patterns like "aa...ab", the
+number of characters compared in full is counted, and once it exceeds
+twice the text scanned (plus m), the rest of the text is searched by the
+KMP automaton instead, so the worst case remains linear.
+
+find(t, n) returns the position of the first occurrence in the n chars
+at t, or -1 if there is none. find_all(t, n, res, offset) appends offset
+plus the position of every occurrence to res. The empty pattern occurs
+at every position from 0 to n inclusive.
+
+A search_stream finds the occurrences in a text given as a sequence of
+chunks, such as a file read 1MB at a time, carrying the KMP state from
+each chunk to the next. Every call to feed(t, n, res) appends the
+positions of the occurrences ending in the chunk to res, as positions in
+the whole text. The occurrences which begin in a previous chunk must end
+within the first m - 1 characters of the chunk, which are searched by
+the automaton, while the rest of the chunk is searched as above. Its
+pattern must not be empty, and must outlive it.
+
+Time Complexity: O(m) to construct a search_pattern. O(n + m) per call
+to find() or find_all(), and O(n + m) per call to feed(), for a text or
+chunk of length n. Filtering examines 16 positions per step with SSE2.
+
+Space Complexity: O(m) for the pattern, and O(1) auxiliary per search.
+
+*/
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+class search_pattern {
+  std::string s;
+  std::vector<int> fail;
+
+  int scan(const char * t, int n, std::vector<long long> * res,
+           long long offset) const {
+    int m = s.size(), i = 0;
+    if (m == 0) {
+      if (res == 0) return 0;
+      for (int k = 0; k <= n; k++) res->push_back(offset + k);
+      return -1;
+    }
+    const char * p = s.data();
+    char first = p[0], last = p[m - 1];
+    long long work = 0;
+#ifdef __SSE2__
+    __m128i F = _mm_set1_epi8(first), L = _mm_set1_epi8(last);
+    for (; i + m + 15 <= n && work <= 2LL * i + m; i += 16) {
+      __m128i a = _mm_loadu_si128((const __m128i *)(t + i));
+      __m128i b = _mm_loadu_si128((const __m128i *)(t + i + m - 1));
+      int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, F),
+                                                 _mm_cmpeq_epi8(b, L)));
+      for (; mask != 0; mask &= mask - 1) {
+        int k = i + __builtin_ctz(mask);
+        work += m;
+        if (m < 3 || memcmp(t + k + 1, p + 1, m - 2) == 0) {
+          if (res == 0) return k;
+          res->push_back(offset + k);
+        }
+      }
+    }
+#endif
+    for (; i + m <= n && work <= 2LL * i + m; i++) {
+      if (t[i] != first || t[i + m - 1] != last) continue;
+      work += m;
+      if (m < 3 || memcmp(t + i + 1, p + 1, m - 2) == 0) {
+        if (res == 0) return i;
+        res->push_back(offset + i);
+      }
+    }
+    if (i + m <= n) { //too many candidates, so finish by KMP from i
+      for (int state = 0; i < n; i++) {
+        if ((state = advance(state, t[i])) == m) {
+          if (res == 0) return i - m + 1;
+          res->push_back(offset + i - m + 1);
+        }
+      }
+    }
+    return -1;
+  }
+
+ public:
+  explicit search_pattern(const std::string & pattern)
+  : s(pattern), fail(pattern.size() + 1) {
+    int m = s.size();
+    fail[0] = -1;
+    for (int i = 0, j = -1; i < m; ) {
+      while (j >= 0 && s[i] != s[j]) j = fail[j];
+      i++;
+      j++;
+      fail[i] = (i < m && s[i] == s[j]) ? fail[j] : j;
+    }
+  }
+
+  int size() const { return s.size(); }
+
+  int advance(int state, char c) const {
+    if (state == (int)s.size()) state = fail[state];
+    while (state >= 0 && s[state] != c) state = fail[state];
+    return state + 1;
+  }
+
+  int find(const char * t, int n) const { return scan(t, n, 0, 0); }
+
+  int find(const std::string & text) const {
+    return scan(text.data(), text.size(), 0, 0);
+  }
+
+  void find_all(const char * t, int n, std::vector<long long> & res,
+                long long offset = 0) const {
+    scan(t, n, &res, offset);
+  }
+
+  void find_all(const std::string & text, std::vector<long long> & res) const {
+    scan(text.data(), text.size(), &res, 0);
+  }
+};
+
+class search_stream {
+  const search_pattern & pat;
+  int state;
+  long long pos; //the position in the whole text of the next chunk
+
+ public:
+  search_stream(const search_pattern & p): pat(p), state(0), pos(0) {}
+
+  void feed(const char * t, int n, std::vector<long long> & res) {
+    int m = pat.size(), head = (n < 2 * m) ? n : m - 1, i;
+    for (i = 0; i < head; i++)
+      if ((state = pat.advance(state, t[i])) == m)
+        res.push_back(pos + i - m + 1);
+    if (head < n) {
+      pat.find_all(t, n, res, pos);
+      for (i = n - (m - 1), state = 0; i < n; i++)
+        state = pat.advance(state, t[i]);
+    }
+    pos += n;
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
+using namespace std;
 
 int main() {
   assert(15 == find("ABC ABCDAB ABCDABCDABDE", "ABCDABD"));
+
+  search_pattern p("ABCDABD");
+  string text("ABC ABCDAB ABCDABCDABDE, ABCDABCDABD!");
+  assert(p.find(text) == 15 && p.find("ABCDAB") == -1);
+  vector<long long> res;
+  p.find_all(text, res);
+  assert(res.size() == 2 && res[0] == 15 && res[1] == 29);
+
+  //the same text fed in chunks of 5 characters, and overlapping matches
+  search_stream ss(p);
+  res.clear();
+  for (int i = 0; i < (int)text.size(); i += 5)
+    ss.feed(text.data() + i, min(5, (int)text.size() - i), res);
+  assert(res.size() == 2 && res[0] == 15 && res[1] == 29);
+  res.clear();
+  search_pattern("aa").find_all("aaaa", res);
+  assert(res.size() == 3 && res[2] == 2);
   return 0;
 }
@@ -24,6 +24,7 @@ lengths and c is the size of the alphabet.
 
 */
 
+#include <algorithm> /* std::sort(), std::lower_bound() */
 #include <bitset>
 #include <cstring>
 #include <queue>
@@ -95,11 +96,234 @@ int next_state(int curr, char ch) {
   return g[next][c];
 }
 
+/*
+
+A dynamically sized Aho-Corasick automaton over arbitrary bytes, for
+very large pattern sets (millions of patterns). It is immutable once
+constructed, and all searching is done through an ac_scanner, which
+holds only the current state and position. Therefore, any number of
+scanners may share one automaton, e.g. to scan independent inputs from
+separate threads without locking.
+
+The trie is built in bulk by sorting the patterns, so that the children
+of every node are created in increasing order, and is then renumbered
+in BFS order so that the states nearest the root, which a scan visits
+most often, have the smallest indices. Bytes are mapped to equivalence
+classes: every byte which occurs in some pattern gets a class of its
+own, and all other bytes share a single class, on which every state
+transitions to the root. The first dense_states states in BFS order
+store a complete DFA row over the classes, while every other state
+stores only its trie edges, sorted by class, plus its failure link. A
+transition from a sparse state follows failure links until an edge is
+found or a dense state is reached. Since failure links strictly reduce
+the depth, and a dense state's failure link is always dense, this is
+O(1) amortized per byte. If dense_states is -1, as many states are made
+dense as fit in about 16MB.
+
+feed(t, n, f) of a scanner advances over the n bytes at t, which may be
+any chunk of a longer input, and calls f(pattern, pos) for every match,
+where pattern is the index of the matched pattern in the input vector
+and pos is its starting position in the whole input. Identical patterns
+are each reported. Empty patterns are ignored.
+
+Time Complexity: O(l log l + s * c) to construct, where l is the sum of
+all pattern lengths, s is the number of dense states, and c is the
+number of byte classes. O(n + z) per call to feed() for a chunk of
+length n with z matches.
+
+Space Complexity: O(l + p + s * c) for the automaton with p patterns,
+i.e. about 20 bytes per trie state plus 4 bytes per dense row entry.
+O(1) per scanner.
+
+*/
+
+class aho_corasick {
+  struct pattern_less {
+    const std::vector<std::string> * p;
+    pattern_less(const std::vector<std::string> * p): p(p) {}
+    bool operator()(int a, int b) const { return (*p)[a] < (*p)[b]; }
+  };
+
+  //out is the longest suffix of the state (itself included) at which some
+  //pattern ends, or 0 if none, and [begin, next state's begin) its edges
+  struct state_t { int fail, out, begin; };
+
+  int nclasses, ndense;
+  unsigned char cls[256];
+  std::vector<state_t> st;               //including a sentinel at the end
+  std::vector<int> term, next_same, len;
+  std::vector<int> edge_to;              //sparse trie edges, sorted by class
+  std::vector<unsigned char> edge_cls;
+  std::vector<int> row;                  //ndense rows of nclasses entries
+
+  //transitions to a state t are stored as ~t if st[t].out > 0, so that
+  //the scan can tell when to report without touching st[t]
+  int encode(int t) const { return (st[t].out > 0) ? ~t : t; }
+
+  int child(int s, int c) const {
+    const unsigned char * b = &edge_cls[0] + st[s].begin;
+    const unsigned char * e = &edge_cls[0] + st[s + 1].begin;
+    const unsigned char * it = std::lower_bound(b, e, (unsigned char)c);
+    return (it != e && *it == c) ? edge_to[it - &edge_cls[0]] : 0;
+  }
+
+  int delta(int s, int c) const {  //returns the encoded transition
+    for (int t; s >= ndense; s = st[s].fail)
+      if ((t = child(s, c)) != 0) return t;
+    return row[s * nclasses + c];
+  }
+
+ public:
+  aho_corasick(const std::vector<std::string> & patterns,
+               int dense_states = -1)
+  : next_same(patterns.size(), -1), len(patterns.size()) {
+    //map bytes to classes, with class 0 for bytes in no pattern
+    bool used[256] = {false};
+    for (int i = 0; i < (int)patterns.size(); i++) {
+      len[i] = patterns[i].size();
+      for (int j = 0; j < len[i]; j++)
+        used[(unsigned char)patterns[i][j]] = true;
+    }
+    nclasses = 0;
+    for (int c = 0; c < 256; c++)
+      if (!used[c]) nclasses = 1;
+    for (int c = 0; c < 256; c++)
+      cls[c] = used[c] ? nclasses++ : 0;
+    //build the trie from the sorted patterns as first-child/next-sibling
+    std::vector<int> order(patterns.size());
+    for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), pattern_less(&patterns));
+    std::vector<int> first(1, -1), last(1, -1), next(1, -1), tterm(1, -1);
+    std::vector<int> path(1, 0);
+    std::vector<unsigned char> label(1, 0);
+    const std::string * prev = 0;
+    for (int k = 0; k < (int)order.size(); k++) {
+      const std::string & s = patterns[order[k]];
+      if (s.empty()) continue;
+      int d = 0;
+      if (prev != 0)
+        while (d < (int)s.size() && d < (int)prev->size() && s[d] == (*prev)[d])
+          d++;
+      path.resize(d + 1);
+      for (int j = d; j < (int)s.size(); j++) {
+        int u = path[j], v = first.size();
+        first.push_back(-1);
+        tterm.push_back(-1);
+        label.push_back(cls[(unsigned char)s[j]]);
+        last.push_back(-1);
+        next.push_back(-1);
+        //children are created in increasing order, so append to the list
+        if (last[u] < 0) first[u] = v; else next[last[u]] = v;
+        last[u] = v;
+        path.push_back(v);
+      }
+      int u = path[s.size()];
+      next_same[order[k]] = tterm[u];
+      tterm[u] = order[k];
+      prev = &s;
+    }
+    //renumber in BFS order into the sparse edge arrays
+    int n = first.size();
+    std::vector<int> bfs(1, 0), id(n);
+    id[0] = 0;
+    st.resize(n + 1);
+    edge_to.reserve(n - 1);
+    edge_cls.reserve(n);
+    term.resize(n);
+    for (int i = 0; i < (int)bfs.size(); i++) {
+      int u = bfs[i];
+      term[i] = tterm[u];
+      st[i].begin = edge_to.size();
+      for (int v = first[u]; v >= 0; v = next[v]) {
+        id[v] = bfs.size();
+        bfs.push_back(v);
+        edge_to.push_back(id[v]);
+        edge_cls.push_back(label[v]);
+      }
+    }
+    st[n].begin = edge_to.size();
+    edge_cls.push_back(0);  //so that &edge_cls[0] is always valid
+    //compute failure links, dictionary links and dense rows in BFS order
+    if (dense_states < 0) dense_states = (1 << 22) / nclasses;
+    ndense = std::max(1, std::min(dense_states, n));
+    row.assign((size_t)ndense * nclasses, 0);
+    st[0].fail = st[0].out = 0;
+    for (int s = 0; s < n; s++) {
+      for (int e = st[s].begin; e < st[s + 1].begin; e++) {
+        int t = edge_to[e], f = (s == 0) ? 0 : delta(st[s].fail, edge_cls[e]);
+        st[t].fail = f = (f < 0) ? ~f : f;
+        st[t].out = (term[t] >= 0) ? t : st[f].out;
+        edge_to[e] = encode(t);
+      }
+      if (s < ndense) {
+        int * r = &row[s * nclasses], * fr = &row[st[s].fail * nclasses];
+        if (s > 0) std::copy(fr, fr + nclasses, r);
+        for (int e = st[s].begin; e < st[s + 1].begin; e++)
+          r[edge_cls[e]] = edge_to[e];
+      }
+    }
+  }
+
+  int states() const { return st.size() - 1; }
+  int classes() const { return nclasses; }
+
+  int next_state(int s, char c) const {
+    int t = delta(s, cls[(unsigned char)c]);
+    return (t < 0) ? ~t : t;
+  }
+
+  template<class ReportFunction>
+  void report(int s, long long end, ReportFunction f) const {
+    for (s = st[s].out; s > 0; s = st[st[s].fail].out)
+      for (int p = term[s]; p >= 0; p = next_same[p])
+        f(p, end - len[p] + 1);
+  }
+
+  friend class ac_scanner;
+};
+
+class ac_scanner {
+  const aho_corasick & ac;
+  int state;
+  long long pos;  //the position in the whole input of the next chunk
+
+ public:
+  ac_scanner(const aho_corasick & a): ac(a), state(0), pos(0) {}
+
+  void reset() { state = pos = 0; }
+
+  template<class ReportFunction>
+  void feed(const char * t, int n, ReportFunction f) {
+    const int * row = &ac.row[0];
+    int nc = ac.nclasses, nd = ac.ndense, s = state;
+    for (int i = 0; i < n; i++) {
+      int c = ac.cls[(unsigned char)t[i]];
+      s = (s < nd) ? row[s * nc + c] : ac.delta(s, c);
+      if (s < 0) ac.report(s = ~s, pos + i, f);
+    }
+    state = s;
+    pos += n;
+  }
+
+  template<class ReportFunction>
+  void feed(const std::string & chunk, ReportFunction f) {
+    feed(chunk.data(), chunk.size(), f);
+  }
+};
+
 /*** Example Usage (en.wikipedia.org/wiki/Aho–Corasick_algorithm) ***/
 
 #include <iostream>
 using namespace std;
 
+struct print_match {
+  const vector<string> * patterns;
+  print_match(const vector<string> * p): patterns(p) {}
+  void operator()(int p, long long pos) const {
+    cout << "'" << (*patterns)[p] << "' at position " << pos << endl;
+  }
+};
+
 int main() {
   vector<string> patterns;
   patterns.push_back("a");
@@ -121,5 +345,12 @@ int main() {
         if (out[state][j])
           cout << "'" << patterns[j] << "'" << endl;
   }
+
+  //the same search, with the text fed to a scanner in 2 chunks
+  cout << endl << "Scanning in chunks:" << endl;
+  aho_corasick ac(patterns);
+  ac_scanner sc(ac);
+  sc.feed("abc", 3, print_match(&patterns));
+  sc.feed(string("cab"), print_match(&patterns));
   return 0;
 }
@@ -33,6 +33,184 @@ std::vector<int> z_function(const std::string & s) {
   return z;
 }
 
+/*
+
+A reusable-buffer version of the above. z_function(s, n, z) writes the
+Z function of the n characters at s to the caller's buffer z, which may
+hold any integer type that can represent n, e.g. unsigned short for
+inputs shorter than 65536 characters, halving the memory of int.
+Likewise, prefix_function(s, n, pi) writes the prefix function, where
+pi[i] is the length of the longest proper prefix of s[0..i] which is
+also a suffix of it. Neither allocates memory, so scanning many short
+reads with one buffer avoids an allocation per read.
+
+smallest_period(s, n, pi) returns the smallest p such that s[i] equals
+s[i + p] for all valid i, which is n minus the longest border of s, and
+is n for a string without any border. The string is a repetition of a
+shorter string exactly when this p divides n and is less than n.
+smallest_periods(s, offset, count, period, pi) does the same for each of
+count reads, where read k occupies [offset[k], offset[k + 1]) of s, and
+reuses the buffer pi, which must hold the longest read.
+
+Time Complexity: O(n) for each of the functions on an input of length
+n, and O(total length) for smallest_periods().
+
+Space Complexity: O(1) auxiliary, beyond the caller's buffer.
+
+*/
+
+template<class Int>
+void z_function(const char * s, int n, Int * z) {
+  if (n > 0) z[0] = 0;
+  for (int i = 1, l = 0, r = 0; i < n; i++) {
+    int k = (i <= r) ? std::min(r - i + 1, (int)z[i - l]) : 0;
+    while (i + k < n && s[k] == s[i + k])
+      k++;
+    z[i] = k;
+    if (r < i + k - 1) {
+      l = i;
+      r = i + k - 1;
+    }
+  }
+}
+
+template<class Int>
+void prefix_function(const char * s, int n, Int * pi) {
+  if (n > 0) pi[0] = 0;
+  for (int i = 1, k = 0; i < n; i++) {
+    while (k > 0 && s[i] != s[k])
+      k = pi[k - 1];
+    if (s[i] == s[k]) k++;
+    pi[i] = k;
+  }
+}
+
+template<class Int>
+int smallest_period(const char * s, int n, Int * pi) {
+  if (n == 0) return 0;
+  prefix_function(s, n, pi);
+  return n - (int)pi[n - 1];
+}
+
+template<class Int>
+void smallest_periods(const char * s, const long long * offset, int count,
+                      int * period, Int * pi) {
+  for (int k = 0; k < count; k++)
+    period[k] = smallest_period(s + offset[k], offset[k + 1] - offset[k], pi);
+}
+
+/*
+
+Find all runs (maximal repetitions) of a string by the divide and
+conquer of Main and Lorentz. A run is a maximal substring s[a, b) with
+smallest period p such that b - a >= 2p, where maximal means that the
+period does not extend to s[a - 1] or s[b]. Every square (tandem
+repeat) xx of the string lies in exactly one run, whose period divides
+|x|, and a string of length n has fewer than n runs.
+
+Each call splits its window [lo, hi) at m into u = s[lo, m) and
+v = s[m, hi), and for every p finds the interval of period p through
+the pairs (m - p, m) and (m, m + p), extended both ways by the Z
+functions of v, of the reversed u, and of the concatenations v#u and
+rev(u)#rev(v) (where # is a position that never matches). Every run is
+found whole by the first window whose split point it crosses, and
+candidates cut off by the window's borders are discarded, since they
+are pieces of runs found higher up. Duplicates, and intervals found for
+multiples of the smallest period, are removed by sorting.
+
+runs(s) returns the runs of s as (start, length, period) triples sorted
+by start, then by length.
+
+Time Complexity: O(n log n) on the length n of the string.
+
+Space Complexity: O(n log n) auxiliary for the candidate intervals.
+
+*/
+
+struct run_t {
+  int start, length, period;
+
+  bool operator<(const run_t & r) const {
+    if (start != r.start) return start < r.start;
+    if (length != r.length) return length < r.length;
+    return period < r.period;
+  }
+};
+
+namespace runs_impl {
+
+//the Z function of the string t of length n, where a '#' at position gap
+//matches no character, so z[] never extends across it
+void z_gapped(const char * t, int n, int gap, int * z) {
+  if (n > 0) z[0] = 0;
+  for (int i = 1, l = 0, r = 0; i < n; i++) {
+    int k = (i <= r) ? std::min(r - i + 1, z[i - l]) : 0;
+    while (i + k < n && k != gap && i + k != gap && t[k] == t[i + k])
+      k++;
+    z[i] = k;
+    if (r < i + k - 1) {
+      l = i;
+      r = i + k - 1;
+    }
+  }
+}
+
+void add(const std::string & s, int lo, int hi, int a, int b, int p,
+         std::vector<run_t> & res) {
+  if (b - a < 2 * p) return;
+  if (a == lo && lo > 0 && s[lo - 1] == s[lo - 1 + p]) return;
+  if (b == hi && hi < (int)s.size() && s[hi] == s[hi - p]) return;
+  run_t r = {a, b - a, p};
+  res.push_back(r);
+}
+
+void rec(const std::string & s, int lo, int hi, std::vector<char> & buf,
+         std::vector<int> & z1, std::vector<int> & z2,
+         std::vector<int> & z3, std::vector<int> & z4,
+         std::vector<run_t> & res) {
+  if (hi - lo < 2) return;
+  int m = (lo + hi) / 2, nu = m - lo, nv = hi - m;
+  rec(s, lo, m, buf, z1, z2, z3, z4, res);
+  rec(s, m, hi, buf, z1, z2, z3, z4, res);
+  char * t = &buf[0];
+  //z1 = Z(v), z2 = Z(rev(u)), z3 = Z(v # u), z4 = Z(rev(u) # rev(v))
+  z_gapped(s.data() + m, nv, -1, &z1[0]);
+  for (int i = 0; i < nu; i++) t[i] = s[m - 1 - i];
+  z_gapped(t, nu, -1, &z2[0]);
+  std::copy(s.begin() + m, s.begin() + hi, t);
+  std::copy(s.begin() + lo, s.begin() + m, t + nv + 1);
+  z_gapped(t, nv + 1 + nu, nv, &z3[0]);
+  for (int i = 0; i < nu; i++) t[i] = s[m - 1 - i];
+  for (int i = 0; i < nv; i++) t[nu + 1 + i] = s[hi - 1 - i];
+  z_gapped(t, nu + 1 + nv, nu, &z4[0]);
+  for (int p = 1; p <= nu; p++) {  //pairs (i, i + p) through (m - p, m)
+    int back = (p < nu) ? z2[p] : 0, fwd = z3[nv + 1 + nu - p];
+    if (fwd == p) fwd += (p < nv) ? z1[p] : 0;
+    add(s, lo, hi, m - p - back, m + fwd, p, res);
+  }
+  for (int p = 1; p <= nv; p++) {  //pairs (i, i + p) through (m, m + p)
+    int fwd = (p < nv) ? z1[p] : 0, back = z4[nu + 1 + nv - p];
+    if (back == p) back += (p < nu) ? z2[p] : 0;
+    add(s, lo, hi, m - back, m + p + fwd, p, res);
+  }
+}
+
+} //namespace runs_impl
+
+std::vector<run_t> runs(const std::string & s) {
+  int n = s.size();
+  std::vector<char> buf(n + 1);
+  std::vector<int> z1(n + 1), z2(n + 1), z3(n + 1), z4(n + 1);
+  std::vector<run_t> res, uniq;
+  runs_impl::rec(s, 0, n, buf, z1, z2, z3, z4, res);
+  std::sort(res.begin(), res.end());
+  for (int i = 0; i < (int)res.size(); i++)
+    if (uniq.empty() || uniq.back().start != res[i].start ||
+        uniq.back().length != res[i].length)
+      uniq.push_back(res[i]);
+  return uniq;
+}
+
 /*** Example Usage ***/
 
 #include <iostream>
@@ -47,5 +225,19 @@ int main() {
       cout << "Pattern found starting at index "
            << (i - (int)pattern.size() - 1) << "." << endl;
   }
+
+  //reads share one 16-bit buffer
+  const char * reads = "abababacgtacgtacgtaaaaa";
+  long long offset[] = {0, 6, 19, 23};
+  int period[3];
+  unsigned short pi[32];
+  smallest_periods(reads, offset, 3, period, pi);
+  cout << "Periods: " << period[0] << " " << period[1] << " "
+       << period[2] << endl;  //2 4 1
+
+  vector<run_t> r = runs("aababaababb");
+  for (int i = 0; i < (int)r.size(); i++)
+    cout << "Run at " << r[i].start << " of length " << r[i].length
+         << " with period " << r[i].period << "." << endl;
   return 0;
 }
@@ -10,6 +10,9 @@ input strings, respectively.
 
 Space Complexity: O(min(n, m)) auxiliary.
 
+For many strings, or long ones, see the version on the generalized
+suffix array in section 6.5.3, which takes linear time.
+
 */
 
 #include <string>
@@ -53,11 +53,118 @@ std::string longest_common_subsequence
   return ret;
 }
 
+/*
+
+The length of the LCS by the bit-parallel algorithm of Allison and Dix,
+in the formulation of Hyyrö. For each prefix of s1, a bit vector V over
+the positions of s2 has a 0 bit at every position j where the LCS of the
+prefix of s1 with s2[0..j] is one longer than with s2[0..j-1], so the
+LCS with s2 is the number of 0 bits. Appending c to the prefix updates
+V by V' = (V + U) | (V - U), where U = V & M[c] and M[c] has a 1 bit at
+every position of c in s2. Since U is a subset of V, V - U is V & ~U, so
+only the addition propagates a carry across the 64-bit words.
+
+lcs_row(s1, n, s2, m, rev, row) writes row[j] = LCS(s1[0, n), s2[0, j))
+for j = 0..m, or row[j] = LCS(s1[0, n), s2[m - j, m)) if rev is true, by
+reading both strings backwards. The match masks are only built for the
+characters present in s2.
+
+lcs_hirschberg(s1, s2) reconstructs an LCS in linear space by the
+divide and conquer of Hirschberg: s1 is split in half, the first half
+is matched against every prefix of s2 and the second half against every
+suffix, the split of s2 maximizing the sum is chosen, and both halves
+are solved recursively. Small subproblems use the quadratic DP above.
+
+Time Complexity: O(n * m / w) for lcs_length() and lcs_row(), where w
+is the word size of 64 bits, and O(n * m / w) for lcs_hirschberg(),
+since each level of its recursion does half the work of the previous.
+
+Space Complexity: O(m / w * c) auxiliary for lcs_length() and lcs_row(),
+where c is the number of distinct characters in s2, and O(n + m) plus
+that for lcs_hirschberg().
+
+*/
+
+typedef unsigned long long word_t;
+
+void lcs_row(const char * s1, int n, const char * s2, int m, bool rev,
+             int * row) {
+  int words = (m + 63) / 64, idx[256], distinct = 0;
+  for (int c = 0; c < 256; c++) idx[c] = -1;
+  for (int j = 0; j < m; j++) {
+    int c = (unsigned char)s2[j];
+    if (idx[c] < 0) idx[c] = distinct++;
+  }
+  std::vector<word_t> mask((size_t)distinct * words, 0), v(words, ~0ULL);
+  for (int j = 0; j < m; j++) {
+    int c = (unsigned char)s2[rev ? m - 1 - j : j];
+    mask[(size_t)idx[c] * words + j / 64] |= 1ULL << (j % 64);
+  }
+  for (int i = 0; i < n; i++) {
+    int c = idx[(unsigned char)s1[rev ? n - 1 - i : i]];
+    if (c < 0) continue;
+    const word_t * mc = &mask[(size_t)c * words];
+    word_t carry = 0;
+    for (int k = 0; k < words; k++) {
+      word_t x = v[k], u = x & mc[k], sum = x + u + carry;
+      carry = (sum < x || (carry && sum == x)) ? 1 : 0;
+      v[k] = sum | (x & ~u);
+    }
+  }
+  row[0] = 0;
+  for (int j = 0; j < m; j++)
+    row[j + 1] = row[j] + (int)(~v[j / 64] >> (j % 64) & 1);
+}
+
+int lcs_length(const std::string & s1, const std::string & s2) {
+  std::vector<int> row(s2.size() + 1);
+  lcs_row(s1.data(), s1.size(), s2.data(), s2.size(), false, &row[0]);
+  return row.back();
+}
+
+void lcs_hirschberg(const char * s1, int n, const char * s2, int m,
+                    std::string & res) {
+  if (n == 0 || m == 0) return;
+  if ((long long)n * m <= 4096) {
+    res += longest_common_subsequence(std::string(s1, n), std::string(s2, m));
+    return;
+  }
+  if (n < m) { //split the longer string, which halves the work every level
+    lcs_hirschberg(s2, m, s1, n, res);
+    return;
+  }
+  int mid = n / 2, best = 0, split = 0;
+  {
+    std::vector<int> l1(m + 1), l2(m + 1);
+    lcs_row(s1, mid, s2, m, false, &l1[0]);
+    lcs_row(s1 + mid, n - mid, s2, m, true, &l2[0]);
+    for (int j = 0; j <= m; j++) {
+      if (l1[j] + l2[m - j] > best) {
+        best = l1[j] + l2[m - j];
+        split = j;
+      }
+    }
+  }
+  lcs_hirschberg(s1, mid, s2, split, res);
+  lcs_hirschberg(s1 + mid, n - mid, s2 + split, m - split, res);
+}
+
+std::string lcs_hirschberg(const std::string & s1, const std::string & s2) {
+  std::string res;
+  lcs_hirschberg(s1.data(), s1.size(), s2.data(), s2.size(), res);
+  return res;
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
 
 int main() {
   assert(longest_common_subsequence("xmjyauz", "mzjawxu") == "mjau");
+  assert(lcs_length("xmjyauz", "mzjawxu") == 4);
+  assert(lcs_hirschberg("xmjyauz", "mzjawxu").size() == 4);
+  std::string s1(3000, 'a'), s2(2000, 'b');
+  for (int i = 0; i < 3000; i += 3) s1[i] = 'b';
+  assert(lcs_length(s1, s2) == 1000 && lcs_hirschberg(s1, s2) == std::string(1000, 'b'));
   return 0;
 }
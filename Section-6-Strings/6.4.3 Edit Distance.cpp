@@ -38,11 +38,251 @@ int edit_distance(const std::string & s1, const std::string & s2) {
   return dp[n][m];
 }
 
+/*
+
+Myers' bit-parallel edit distance, in the block-based formulation which
+handles patterns of any length. For a pattern s2 of length m, the DP
+column over the positions of s2 is represented by the bit vectors Pv
+and Mv of its vertical deltas (+1 and -1 respectively), 64 rows per
+word, and each character of the text s1 advances every word in O(1)
+word operations. Words pass the horizontal delta of their top row on to
+the next word, and the top row of the matrix (distance from the empty
+pattern) increases by 1 per character.
+
+edit_row(s1, n, s2, m, rev, row) writes row[j] = the edit distance of
+s1[0, n) and s2[0, j) for j = 0..m, or of s1[0, n) and s2[m - j, m) if
+rev is true, by reading both strings backwards.
+
+A myers_pattern precompiles the match masks of a query once, for
+computing its distance to many candidate strings. distance(t, n, k)
+returns the edit distance of the query to the n characters at t, or
+k + 1 if it exceeds k (where k < 0 means no bound). Candidates whose
+length differs from the query's by more than k are rejected in O(1).
+distance_all(candidates, k, res) does this for a whole batch.
+
+edit_distance_banded(s1, s2, k) computes the DP of Ukkonen restricted
+to the diagonals within k of the main diagonal, where the distance may
+be at most k, and returns k + 1 as soon as every cell in a row of the
+band exceeds k.
+
+edit_script(s1, s2) returns an optimal alignment as a string of
+operations, where 'M' is a match, 'R' replaces a letter of s1 by one of
+s2, 'I' inserts a letter of s2, and 'D' deletes a letter of s1. It uses
+the divide and conquer of Hirschberg with edit_row(), so the space is
+linear, and small subproblems are traced back through the full DP.
+
+Time Complexity: O(n * m / w) for edit_row(), distance() and
+edit_script(), where w is the word size of 64 bits. O(k * min(n, m))
+for edit_distance_banded().
+
+Space Complexity: O(m / w * c) auxiliary for edit_row(), where c is
+the number of distinct characters in s2, and O(n + m) plus that for
+edit_script(). O(k) auxiliary for edit_distance_banded().
+
+*/
+
+typedef unsigned long long word_t;
+
+//advances one word of the column by a text character with match mask eq,
+//given the horizontal delta hin entering its lowest row, returning the
+//horizontal delta leaving its highest row
+inline int advance_block(word_t & pv, word_t & mv, word_t eq, int hin) {
+  word_t xv = eq | mv;
+  if (hin < 0) eq |= 1;
+  word_t xh = (((eq & pv) + pv) ^ pv) | eq;
+  word_t ph = mv | ~(xh | pv), mh = pv & xh;
+  int hout = (ph >> 63) ? 1 : ((mh >> 63) ? -1 : 0);
+  ph <<= 1;
+  mh <<= 1;
+  if (hin < 0) mh |= 1; else if (hin > 0) ph |= 1;
+  pv = mh | ~(xv | ph);
+  mv = ph & xv;
+  return hout;
+}
+
+class myers_pattern {
+  int m, words, idx[256];
+  std::vector<word_t> mask, pv, mv;
+
+  void init(const char * s, bool rev) {
+    int distinct = 0;
+    for (int c = 0; c < 256; c++) idx[c] = -1;
+    for (int j = 0; j < m; j++) {
+      int c = (unsigned char)s[j];
+      if (idx[c] < 0) idx[c] = distinct++;
+    }
+    mask.assign((size_t)(distinct + 1) * words, 0);  //the last is all 0
+    for (int j = 0; j < m; j++) {
+      int c = (unsigned char)s[rev ? m - 1 - j : j];
+      mask[(size_t)idx[c] * words + j / 64] |= 1ULL << (j % 64);
+    }
+    for (int c = 0; c < 256; c++)
+      if (idx[c] < 0) idx[c] = distinct;
+  }
+
+ public:
+  myers_pattern(const char * s, int len, bool rev = false)
+  : m(len), words((len + 63) / 64), pv(words), mv(words) {
+    init(s, rev);
+  }
+
+  explicit myers_pattern(const std::string & s)
+  : m(s.size()), words((m + 63) / 64), pv(words), mv(words) {
+    init(s.data(), false);
+  }
+
+  //processes the n characters of t (backwards if rev), leaving the
+  //vertical deltas of the last column in pv and mv
+  void run(const char * t, int n, bool rev) {
+    if (m == 0) return;  //no columns, and mask is empty
+    std::fill(pv.begin(), pv.end(), ~0ULL);
+    std::fill(mv.begin(), mv.end(), 0);
+    for (int i = 0; i < n; i++) {
+      const word_t * eq = &mask[(size_t)idx[(unsigned char)t[rev ? n - 1 - i
+                                                                 : i]] * words];
+      for (int k = 0, h = 1; k < words; k++)
+        h = advance_block(pv[k], mv[k], eq[k], h);
+    }
+  }
+
+  void column(int n, int * row) const {
+    row[0] = n;
+    for (int j = 0; j < m; j++)
+      row[j + 1] = row[j] + (int)(pv[j / 64] >> (j % 64) & 1)
+                          - (int)(mv[j / 64] >> (j % 64) & 1);
+  }
+
+  int distance(const char * t, int n, int k = -1) {
+    if (k >= 0 && (n - m > k || m - n > k)) return k + 1;
+    run(t, n, false);
+    int d = n;
+    for (int j = 0; j < m; j++)
+      d += (int)(pv[j / 64] >> (j % 64) & 1) - (int)(mv[j / 64] >> (j % 64) & 1);
+    return (k >= 0 && d > k) ? k + 1 : d;
+  }
+
+  void distance_all(const std::vector<std::string> & candidates, int k,
+                    std::vector<int> & res) {
+    res.resize(candidates.size());
+    for (int i = 0; i < (int)candidates.size(); i++)
+      res[i] = distance(candidates[i].data(), candidates[i].size(), k);
+  }
+};
+
+void edit_row(const char * s1, int n, const char * s2, int m, bool rev,
+              int * row) {
+  myers_pattern p(s2, m, rev);
+  p.run(s1, n, rev);
+  p.column(n, row);
+}
+
+int edit_distance_banded(const std::string & s1, const std::string & s2,
+                         int k) {
+  int n = s1.size(), m = s2.size();
+  if (n - m > k || m - n > k) return k + 1;
+  //band[d + k] holds the cell of the current row i on diagonal j - i = d
+  std::vector<int> band(2 * k + 1, k + 1), next(2 * k + 1);
+  for (int d = 0; d <= k && d <= m; d++) band[d + k] = d;
+  for (int i = 1; i <= n; i++) {
+    int best = k + 1;
+    for (int d = -k; d <= k; d++) {
+      int j = i + d, v = k + 1;
+      if (j >= 0 && j <= m) {
+        if (j == 0) {
+          v = i;
+        } else {
+          v = band[d + k] + (s1[i - 1] == s2[j - 1] ? 0 : 1);   //diagonal
+          if (d + 1 <= k) v = std::min(v, band[d + 1 + k] + 1); //from above
+          if (d - 1 >= -k) v = std::min(v, next[d - 1 + k] + 1); //from left
+        }
+      }
+      next[d + k] = v = std::min(v, k + 1);
+      best = std::min(best, v);
+    }
+    if (best > k) return k + 1;
+    band.swap(next);
+  }
+  return band[m - n + k];
+}
+
+void edit_script(const char * s1, int n, const char * s2, int m,
+                 std::string & res) {
+  if (n == 0 || m == 0) {
+    res.append(n, 'D');
+    res.append(m, 'I');
+    return;
+  }
+  if (n == 1 || (long long)n * m <= 4096) { //trace back through the DP
+    std::vector< std::vector<int> > dp(n + 1, std::vector<int>(m + 1));
+    for (int i = 0; i <= n; i++) dp[i][0] = i;
+    for (int j = 0; j <= m; j++) dp[0][j] = j;
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < m; j++)
+        dp[i + 1][j + 1] = std::min(dp[i][j] + (s1[i] == s2[j] ? 0 : 1),
+                                    std::min(dp[i + 1][j], dp[i][j + 1]) + 1);
+    std::string ops;
+    for (int i = n, j = m; i > 0 || j > 0; ) {
+      if (i > 0 && j > 0 &&
+          dp[i][j] == dp[i - 1][j - 1] + (s1[i - 1] == s2[j - 1] ? 0 : 1)) {
+        ops += (s1[i - 1] == s2[j - 1]) ? 'M' : 'R';
+        i--;
+        j--;
+      } else if (i > 0 && dp[i][j] == dp[i - 1][j] + 1) {
+        ops += 'D';
+        i--;
+      } else {
+        ops += 'I';
+        j--;
+      }
+    }
+    res.append(ops.rbegin(), ops.rend());
+    return;
+  }
+  int mid = n / 2, best = -1, split = 0;
+  {
+    std::vector<int> r1(m + 1), r2(m + 1);
+    edit_row(s1, mid, s2, m, false, &r1[0]);
+    edit_row(s1 + mid, n - mid, s2, m, true, &r2[0]);
+    for (int j = 0; j <= m; j++) {
+      if (best < 0 || r1[j] + r2[m - j] < best) {
+        best = r1[j] + r2[m - j];
+        split = j;
+      }
+    }
+  }
+  edit_script(s1, mid, s2, split, res);
+  edit_script(s1 + mid, n - mid, s2 + split, m - split, res);
+}
+
+std::string edit_script(const std::string & s1, const std::string & s2) {
+  std::string res;
+  edit_script(s1.data(), s1.size(), s2.data(), s2.size(), res);
+  return res;
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
 
 int main() {
   assert(edit_distance("abxdef", "abcdefg") == 2);
+  assert(edit_distance_banded("abxdef", "abcdefg", 3) == 2);
+  assert(edit_distance_banded("abxdef", "abcdefg", 1) == 2);  //i.e. > 1
+  assert(edit_script("abxdef", "abcdefg") == "MMRMMMI");
+
+  std::vector<std::string> candidates;
+  candidates.push_back("abcdefg");
+  candidates.push_back("xbcdef");
+  candidates.push_back("zzzzzzzzzzzz");
+  std::vector<int> res;
+  myers_pattern("abxdef").distance_all(candidates, 3, res);
+  assert(res[0] == 2 && res[1] == 2 && res[2] == 4);
+
+  //an empty query is as far from a candidate as the candidate is long
+  assert(myers_pattern("").distance("abc", 3) == 3);
+  int row[1];
+  edit_row("abc", 3, "", 0, false, row);
+  assert(row[0] == 3);
+  assert(edit_distance("", "abc") == 3 && edit_script("abc", "") == "DDD");
   return 0;
 }
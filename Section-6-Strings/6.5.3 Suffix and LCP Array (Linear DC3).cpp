@@ -141,6 +141,101 @@ std::vector<int> lcp_array(const std::string & s,
   return lcp;
 }
 
+/*
+
+The longest common substring of k strings, or of at least r of them, by
+a sliding window over the generalized suffix array. The strings are
+concatenated into one integer array, with each character c mapped to
+c + 1 and the end of the i-th string marked by the unique separator
+257 + i, so that no common prefix of two suffixes extends past the end
+of a string. The suffix array is built by suffix_array() above, and
+the LCP array by Kasai's algorithm. Since the separators are greater
+than every character, the suffixes beginning at them are sorted last,
+and the other suffixes form a contiguous range of the suffix array.
+
+A substring is common to r of the strings exactly when it is a prefix
+of r suffixes owned by different strings, and the longest such prefix
+of a range of sorted suffixes is the minimum LCP between consecutive
+ones. Two pointers therefore sweep the suffix array, keeping the
+shortest window ending at each suffix which covers r distinct strings,
+and a monotonic deque maintains the minimum LCP within the window.
+
+longest_common_substring(v, r) returns a longest string which is a
+substring of at least r strings of v, or of all of them if r is -1.
+For r = 1, this is simply the longest string of v.
+
+Time Complexity: O(n + k) on the total length n of the k strings.
+
+Space Complexity: O(n + k) auxiliary.
+
+*/
+
+#include <deque>
+
+std::string longest_common_substring(const std::vector<std::string> & v,
+                                     int r = -1) {
+  int k = v.size(), n = 0;
+  if (r < 0) r = k;
+  if (r <= 0 || r > k) return "";
+  if (r == 1) { //the longest whole string
+    int longest = 0;
+    for (int i = 1; i < k; i++)
+      if (v[i].size() > v[longest].size()) longest = i;
+    return v[longest];
+  }
+  for (int i = 0; i < k; i++) n += v[i].size() + 1;
+  std::vector<int> str(n + 5, 0), sa(n + 1), owner(n, -1);
+  for (int i = 0, p = 0; i < k; i++) {
+    for (int j = 0; j < (int)v[i].size(); j++, p++) {
+      str[p] = (unsigned char)v[i][j] + 1;
+      owner[p] = i;
+    }
+    str[p++] = 257 + i;
+  }
+  suffix_array(&str[0], &sa[0], n + 1, 256 + k);
+  //the suffixes beginning inside strings are at sa[1..m], before those
+  //beginning at separators; lcp[i] is the LCP of sa[i] and sa[i + 1]
+  int m = n - k;
+  std::vector<int> rank(n + 1), lcp(m + 1, 0);
+  for (int i = 0; i <= n; i++) rank[sa[i]] = i;
+  for (int i = 0, h = 0; i < n; i++) {
+    if (owner[i] < 0) {
+      h = 0;
+      continue;
+    }
+    if (rank[i] < m) {
+      int j = sa[rank[i] + 1];
+      while (str[i + h] == str[j + h]) h++;
+      lcp[rank[i]] = h;
+      if (h > 0) h--;
+    } else {
+      h = 0;
+    }
+  }
+  std::vector<int> count(k, 0);
+  std::deque<int> dq;  //indices of lcp[] in the window, increasing values
+  int covered = 0, best = 0, bestpos = 0;
+  for (int lo = 1, hi = 1; hi <= m; hi++) {
+    if (count[owner[sa[hi]]]++ == 0) covered++;
+    if (hi > lo) {
+      while (!dq.empty() && lcp[dq.back()] >= lcp[hi - 1]) dq.pop_back();
+      dq.push_back(hi - 1);
+    }
+    //drop suffixes from the left while the window still covers r strings
+    while (lo < hi && (count[owner[sa[lo]]] > 1 || covered > r)) {
+      if (--count[owner[sa[lo++]]] == 0) covered--;
+      while (!dq.empty() && dq.front() < lo) dq.pop_front();
+    }
+    if (covered >= r && lcp[dq.front()] > best) {
+      best = lcp[dq.front()];
+      bestpos = sa[hi];
+    }
+  }
+  std::string res(best, ' ');
+  for (int i = 0; i < best; i++) res[i] = (char)(str[bestpos + i] - 1);
+  return res;
+}
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -154,5 +249,12 @@ int main() {
   int lcp_ans[] = {1, 3, 0, 0, 2};
   assert(equal(sa.begin(), sa.end(), sa_ans));
   assert(equal(lcp.begin(), lcp.end(), lcp_ans));
+
+  vector<string> v;
+  v.push_back("xabcdefy");
+  v.push_back("zzabcdz");
+  v.push_back("bcdefab");
+  assert(longest_common_substring(v) == "bcd");
+  assert(longest_common_substring(v, 2) == "bcdef");
   return 0;
 }
@@ -0,0 +1,257 @@
+/*
+
+A suffix array SA of a string S[1, n] is a sorted array of indices of
+all the suffixes of S ("abc" has suffixes "abc", "bc", and "c").
+SA[i] contains the starting position of the i-th smallest suffix in S,
+ensuring that for all 1 < i <= n, S[SA[i - 1], n] < S[A[i], n] holds.
+The longest common prefix array (LCP array) stores the lengths of the
+longest common prefixes between all pairs of consecutive suffixes in
+a sorted suffix array.
+
+The following implementation uses the SA-IS algorithm by Nong, Zhang &
+Chan (2009), which is linear like DC3 in section 6.5.3, but needs much
+less memory. Every suffix is classified as S-type if it is smaller than
+the suffix following it, or L-type otherwise, where the suffix past the
+end of the string is a virtual sentinel smaller than all others. An
+S-type suffix preceded by an L-type one is called leftmost S-type
+(LMS). Once the LMS suffixes are sorted, a left to right scan over the
+buckets of first characters induces the order of all L-type suffixes
+from them, and a right to left scan induces all S-type suffixes. The
+LMS suffixes are sorted by first sorting the LMS substrings (which run
+from one LMS position to the next) in the same way, naming them by
+their ranks, and recursively sorting the suffixes of the string of
+names, which is at most half as long.
+
+As in the original paper, the string of names and the suffix array of
+the recursion are both kept within the suffix array of the caller, and
+the bucket array of a recursion is also kept there whenever it fits in
+the space left between them. The types are kept as one bit per
+character. The remaining buffers are owned by a suffix_array_builder
+and reused across calls, so that indexing many texts allocates nothing
+after the first. For a text of n bytes, the peak memory is therefore
+about n bytes for the text, n * sizeof(Index) for the suffix array,
+and n / 4 bytes for the types of all levels of recursion.
+
+The index type is a template parameter, which must be signed and able
+to hold n, e.g. int for texts under 2GB, or long long for longer ones,
+where a 32-bit index halves the memory of the suffix array.
+
+lcp(s, n, sa, lcp) computes lcp[i] as the LCP of the suffixes at sa[i]
+and sa[i + 1] for 0 <= i < n - 1, by the permuted LCP (PLCP) variant of
+Kasai's algorithm. The phi array, holding the suffix preceding each
+suffix in sorted order, is built first. The PLCP values are then
+computed in text order, overwriting phi, where each is at least one less
+than the previous. Unlike Kasai's algorithm, which compares the text at
+random positions in suffix array order, this reads the text mostly
+sequentially, and the phi array doubles as the PLCP array, so only one
+n-element buffer is needed besides the output.
+
+Time Complexity: O(n) for build() and lcp(), where n is the length of
+the input string.
+
+Space Complexity: O(n) auxiliary, as described above.
+
+*/
+
+#include <algorithm> /* std::fill() */
+#include <string>
+#include <vector>
+
+template<class Index>
+class suffix_array_builder {
+  std::vector< std::vector<unsigned char> > types;  //per recursion level
+  std::vector< std::vector<Index> > buckets;        //per recursion level
+  std::vector<Index> phi;
+
+  static bool is_s(const unsigned char * t, Index i) {
+    return (t[i >> 3] >> (i & 7)) & 1;
+  }
+
+  static bool is_lms(const unsigned char * t, Index i) {
+    return i > 0 && is_s(t, i) && !is_s(t, i - 1);
+  }
+
+  template<class Char>
+  static void get_buckets(const Char * s, Index n, Index * bkt, Index K,
+                          bool end) {
+    std::fill(bkt, bkt + K, 0);
+    for (Index i = 0; i < n; i++) bkt[s[i]]++;
+    for (Index i = 0, sum = 0; i < K; i++) {
+      sum += bkt[i];
+      bkt[i] = end ? sum : sum - bkt[i];
+    }
+  }
+
+  template<class Char>
+  static void induce(const Char * s, Index * sa, Index n, Index K,
+                     const unsigned char * t, Index * bkt) {
+    get_buckets(s, n, bkt, K, false);
+    sa[bkt[s[n - 1]]++] = n - 1;  //induced by the virtual sentinel
+    for (Index i = 0; i < n; i++) {
+      Index j = sa[i] - 1;
+      if (j >= 0 && !is_s(t, j)) sa[bkt[s[j]]++] = j;
+    }
+    get_buckets(s, n, bkt, K, true);
+    for (Index i = n - 1; i >= 0; i--) {
+      Index j = sa[i] - 1;
+      if (j >= 0 && is_s(t, j)) sa[--bkt[s[j]]] = j;
+    }
+  }
+
+  //sorts the suffixes of s[0, n) over the alphabet [0, K), where sa has
+  //fs unused entries past its end which may hold the bucket array
+  template<class Char>
+  void sais(const Char * s, Index * sa, Index n, Index K, Index fs,
+            int depth) {
+    if (n <= 1) {
+      if (n == 1) sa[0] = 0;
+      return;
+    }
+    std::vector<unsigned char> & tv = types[depth];
+    if ((Index)tv.size() < n / 8 + 1) tv.resize(n / 8 + 1);
+    unsigned char * t = &tv[0];
+    std::fill(t, t + n / 8 + 1, 0);
+    bool next_s = false;  //the last suffix is L-type, before the sentinel
+    for (Index i = n - 2; i >= 0; i--) {
+      if (s[i] < s[i + 1] || (s[i] == s[i + 1] && next_s)) {
+        t[i >> 3] |= 1 << (i & 7);
+        next_s = true;
+      } else {
+        next_s = false;
+      }
+    }
+    Index * bkt = sa + n;
+    if (K > fs) {
+      if ((Index)buckets[depth].size() < K) buckets[depth].resize(K);
+      bkt = &buckets[depth][0];
+    }
+    //stage 1: sort the LMS substrings
+    get_buckets(s, n, bkt, K, true);
+    std::fill(sa, sa + n, -1);
+    for (Index i = 1; i < n; i++)
+      if (is_lms(t, i)) sa[--bkt[s[i]]] = i;
+    induce(s, sa, n, K, t, bkt);
+    Index n1 = 0;
+    for (Index i = 0; i < n; i++)
+      if (is_lms(t, sa[i])) sa[n1++] = sa[i];
+    //name the LMS substrings by rank, storing the name of the one at
+    //position p at sa[n1 + p / 2], since LMS positions are never adjacent
+    std::fill(sa + n1, sa + n, -1);
+    Index name = 0, prev = -1;
+    for (Index i = 0; i < n1; i++) {
+      Index pos = sa[i];
+      bool diff = (prev < 0);
+      for (Index d = 0; !diff; d++) {
+        if (pos + d == n || prev + d == n || s[pos + d] != s[prev + d] ||
+            is_s(t, pos + d) != is_s(t, prev + d)) {
+          diff = true;
+        } else if (d > 0 && is_lms(t, pos + d)) {
+          break;
+        }
+      }
+      if (diff) {
+        name++;
+        prev = pos;
+      }
+      sa[n1 + pos / 2] = name - 1;
+    }
+    for (Index i = n - 1, j = n - 1; i >= n1; i--)
+      if (sa[i] >= 0) sa[j--] = sa[i];
+    //stage 2: sort the suffixes of the string of names
+    Index * s1 = sa + n - n1;
+    if (name < n1) {
+      sais(s1, sa, n1, name, n - 2 * n1, depth + 1);
+    } else {
+      for (Index i = 0; i < n1; i++) sa[s1[i]] = i;
+    }
+    //stage 3: induce the suffix array from the sorted LMS suffixes
+    for (Index i = 1, j = 0; i < n; i++)
+      if (is_lms(t, i)) s1[j++] = i;
+    for (Index i = 0; i < n1; i++) sa[i] = s1[sa[i]];
+    std::fill(sa + n1, sa + n, -1);
+    get_buckets(s, n, bkt, K, true);
+    for (Index i = n1 - 1; i >= 0; i--) {
+      Index j = sa[i];
+      sa[i] = -1;
+      sa[--bkt[s[j]]] = j;
+    }
+    induce(s, sa, n, K, t, bkt);
+  }
+
+ public:
+  //the string of names is at most half as long at each level, so there
+  //are fewer than 64 levels, which are allocated up front to keep the
+  //per-level buffers in place during the recursion
+  suffix_array_builder(): types(64), buckets(64) {}
+
+  void build(const unsigned char * s, Index n, Index * sa) {
+    sais(s, sa, n, (Index)256, (Index)0, 0);
+  }
+
+  void lcp(const unsigned char * s, Index n, const Index * sa, Index * lcp) {
+    if (n <= 1) return;
+    if ((Index)phi.size() < n) phi.resize(n);
+    Index * p = &phi[0];
+    p[sa[0]] = -1;
+    for (Index i = 1; i < n; i++) p[sa[i]] = sa[i - 1];
+    for (Index i = 0, h = 0; i < n; i++) {
+      Index j = p[i];
+      if (j < 0) {
+        h = 0;
+      } else {
+        while (i + h < n && j + h < n && s[i + h] == s[j + h]) h++;
+      }
+      p[i] = h;
+      if (h > 0) h--;
+    }
+    for (Index i = 1; i < n; i++) lcp[i - 1] = p[sa[i]];
+  }
+};
+
+// C++ wrapper functions
+std::vector<int> suffix_array(const std::string & s) {
+  std::vector<int> sa(s.size());
+  if (!s.empty()) {
+    suffix_array_builder<int>().build((const unsigned char *)s.data(),
+                                      s.size(), &sa[0]);
+  }
+  return sa;
+}
+
+std::vector<int> lcp_array(const std::string & s,
+                           const std::vector<int> & sa) {
+  std::vector<int> lcp(sa.empty() ? 0 : sa.size() - 1);
+  if (!lcp.empty()) {
+    suffix_array_builder<int>().lcp((const unsigned char *)s.data(),
+                                    s.size(), &sa[0], &lcp[0]);
+  }
+  return lcp;
+}
+
+/*** Example Usage ***/
+
+#include <cassert>
+using namespace std;
+
+int main() {
+  string s("banana");
+  vector<int> sa = suffix_array(s);
+  vector<int> lcp = lcp_array(s, sa);
+  int sa_ans[] = {5, 3, 1, 0, 4, 2};
+  int lcp_ans[] = {1, 3, 0, 0, 2};
+  assert(equal(sa.begin(), sa.end(), sa_ans));
+  assert(equal(lcp.begin(), lcp.end(), lcp_ans));
+
+  //one builder reused over several texts, with 64-bit indices
+  suffix_array_builder<long long> b;
+  const char * texts[] = {"mississippi", "abracadabra"};
+  long long sa64[11], lcp64[10];
+  long long mississippi[] = {10, 7, 4, 1, 0, 9, 8, 6, 3, 5, 2};
+  for (int k = 0; k < 2; k++) {
+    b.build((const unsigned char *)texts[k], 11, sa64);
+    b.lcp((const unsigned char *)texts[k], 11, sa64, lcp64);
+  }
+  b.build((const unsigned char *)texts[0], 11, sa64);
+  assert(equal(sa64, sa64 + 11, mississippi));
+  return 0;
+}
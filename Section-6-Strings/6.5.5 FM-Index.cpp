@@ -0,0 +1,268 @@
+/*
+
+An FM-index (Ferragina & Manzini, 2000) is a compressed full-text index
+built from the suffix array of a text, which counts and locates the
+occurrences of a pattern without storing either the suffix array or
+the text itself. Its rows are the sorted suffixes of the text followed
+by a virtual sentinel '$', smaller than every character, so that row 0
+is the empty suffix "$". The Burrows-Wheeler transform (BWT) of the
+text is the character preceding each row's suffix (with '$' preceding
+the whole text), and the last-to-first mapping LF(i) = C[c] + rank(c, i)
+takes a row i whose BWT character is c to the row of the suffix one
+position earlier, where C[c] is the number of rows beginning with a
+character less than c (the sentinel included), and rank(c, i) is the
+number of occurrences of c in the BWT before row i.
+
+count(p) finds the range of rows prefixed by a pattern p by backward
+search: starting from all rows, each character of p from last to first
+narrows the range [lo, hi) to [C[c] + rank(c, lo), C[c] + rank(c, hi)).
+locate(p, res) appends the text positions of all occurrences of p to
+res. The position of every row whose suffix starts at a multiple of the
+sample rate s is stored, and for any other row, LF is applied until a
+sampled row is reached, which takes fewer than s steps.
+
+The BWT is stored in a wavelet matrix: 8 bit vectors, one per bit of
+the characters from the most significant, where the characters are
+stably partitioned by each bit before the next level. rank(c, i) then
+takes 8 binary ranks, each of which is a popcount within a block of
+512 bits plus a precomputed count for the block. The rows which are
+sampled are marked in another bit vector, whose binary rank gives the
+index of a row's sample.
+
+All of the index is kept in one array of 64-bit words: a header holding
+n, s, the row of '$' in the BWT and the C array, followed by the bit
+vectors, their rank directories and the samples. The array can thus be
+written to a file as-is, and an fm_index(data) constructed on a pointer
+to it (e.g. from mmap()) answers queries without any deserialization.
+Its layout depends only on n, and the words are in native byte order.
+
+For a text of n bytes, the index takes about 9n/8 bytes for the BWT and
+its rank directories, n/8 bytes for the marks, and 8n/s bytes for the
+samples, i.e. about 1.5n bytes for the default s = 32, against the 5n
+bytes of a text with a 32-bit suffix array.
+
+The constructor takes a text and its suffix array, as built by any of
+the algorithms in this section.
+
+Time Complexity: O(n) to construct. O(m) binary ranks for count() on a
+pattern of length m, and O(m + s * z) binary ranks for locate() with z
+occurrences.
+
+Space Complexity: O(n) words for the index, as described above.
+
+*/
+
+#include <string>
+#include <vector>
+
+class fm_index {
+  typedef unsigned long long word_t;
+
+  //header entries: START[c] is the first position of c in the last level
+  //of the wavelet matrix, and COUNT[c] is C[c] for 0 <= c <= 256
+  enum { N, RATE, PRIMARY, START, COUNT = START + 256, HEADER = COUNT + 257 };
+
+  std::vector<word_t> storage;
+  const word_t * ext;
+  word_t n, words, blocks;  //rows n + 1, in words of 64 bits
+
+  const word_t * data_ptr() const { return ext ? ext : &storage[0]; }
+
+  //each bit vector is followed by the number of 1 bits before each block
+  //of 8 words, and each level of the wavelet matrix is preceded by its
+  //number of 0 bits
+  word_t level(int l) const { return HEADER + 1 + l * (1 + words + blocks); }
+  word_t marks() const { return level(8) - 1; }
+  word_t samples() const { return marks() + words + blocks; }
+
+  void layout(word_t len) {
+    n = len;
+    words = (len + 1 + 63) / 64;
+    blocks = words / 8 + 1;
+  }
+
+  static int bit(const word_t * b, word_t i) {
+    return (b[i / 64] >> (i % 64)) & 1;
+  }
+
+  word_t rank1(const word_t * b, word_t i) const {
+    const word_t * dir = b + words;
+    word_t r = dir[i / 512];
+    for (word_t k = i / 512 * 8; k < i / 64; k++)
+      r += __builtin_popcountll(b[k]);
+    if (i % 64 != 0) r += __builtin_popcountll(b[i / 64] << (64 - i % 64));
+    return r;
+  }
+
+  //the position of row i in the last level, if its character were c
+  word_t descend(int c, word_t i) const {
+    const word_t * d = data_ptr();
+    for (int l = 0; l < 8; l++) {
+      const word_t * b = d + level(l);
+      word_t r = rank1(b, i);
+      i = ((c >> (7 - l)) & 1) ? b[-1] + r : i - r;
+    }
+    return i;
+  }
+
+  word_t rank(int c, word_t i) const {
+    const word_t * d = data_ptr();
+    //the sentinel is stored as a 0 byte, which must not be counted
+    return descend(c, i) - d[START + c] - (c == 0 && d[PRIMARY] < i ? 1 : 0);
+  }
+
+  word_t lf(word_t row) const {
+    const word_t * d = data_ptr();
+    if (row == d[PRIMARY]) return 0;
+    word_t i = row;
+    int c = 0;
+    for (int l = 0; l < 8; l++) {
+      const word_t * b = d + level(l);
+      word_t r = rank1(b, i);
+      if (bit(b, i)) {
+        c |= 1 << (7 - l);
+        i = b[-1] + r;
+      } else {
+        i = i - r;
+      }
+    }
+    return d[COUNT + c] + i - d[START + c] -
+           (c == 0 && d[PRIMARY] < row ? 1 : 0);
+  }
+
+  void build_rank(word_t * b) {
+    word_t * dir = b + words;
+    for (word_t k = 0, r = 0; k <= words; k++) {
+      if (k % 8 == 0) dir[k / 8] = r;
+      if (k < words) r += __builtin_popcountll(b[k]);
+    }
+  }
+
+  bool range(const std::string & p, word_t & lo, word_t & hi) const {
+    const word_t * d = data_ptr();
+    lo = 0;
+    hi = n + 1;
+    for (int k = (int)p.size() - 1; k >= 0 && lo < hi; k--) {
+      int c = (unsigned char)p[k];
+      lo = d[COUNT + c] + rank(c, lo);
+      hi = d[COUNT + c] + rank(c, hi);
+    }
+    return lo < hi;
+  }
+
+ public:
+  fm_index(const std::string & text, const std::vector<int> & sa,
+           int sample_rate = 32): ext(0) {
+    layout(text.size());
+    word_t rows = n + 1, nsamples = 0;
+    std::vector<long long> pos(rows);  //the suffix array with '$' first
+    pos[0] = n;
+    for (word_t i = 0; i < n; i++) pos[i + 1] = sa[i];
+    for (word_t i = 0; i < rows; i++)
+      if (pos[i] % sample_rate == 0 || pos[i] == (long long)n) nsamples++;
+    storage.assign(samples() + nsamples, 0);
+    word_t * d = &storage[0];
+    d[N] = n;
+    d[RATE] = sample_rate;
+    std::vector<unsigned char> cur(rows), next(rows);
+    for (word_t i = 0; i < rows; i++) {
+      if (pos[i] == 0) d[PRIMARY] = i;
+      cur[i] = (pos[i] == 0) ? 0 : (unsigned char)text[pos[i] - 1];
+    }
+    word_t freq[256] = {0};
+    for (word_t i = 0; i < n; i++) freq[(unsigned char)text[i]]++;
+    d[COUNT] = 1;
+    for (int c = 0; c < 256; c++) d[COUNT + c + 1] = d[COUNT + c] + freq[c];
+    for (int l = 0; l < 8; l++) {
+      word_t * b = d + level(l), zeros = 0;
+      for (word_t i = 0; i < rows; i++) {
+        if ((cur[i] >> (7 - l)) & 1)
+          b[i / 64] |= 1ULL << (i % 64);
+        else
+          zeros++;
+      }
+      b[-1] = zeros;
+      build_rank(b);
+      word_t z = 0, o = zeros;
+      for (word_t i = 0; i < rows; i++)
+        next[((cur[i] >> (7 - l)) & 1) ? o++ : z++] = cur[i];
+      cur.swap(next);
+    }
+    for (int c = 0; c < 256; c++) d[START + c] = descend(c, 0);
+    word_t * m = d + marks(), * smp = d + samples();
+    for (word_t i = 0, k = 0; i < rows; i++) {
+      if (pos[i] % sample_rate == 0 || pos[i] == (long long)n) {
+        m[i / 64] |= 1ULL << (i % 64);
+        smp[k++] = pos[i];
+      }
+    }
+    build_rank(m);
+  }
+
+  //a read-only view of an index serialized by data() and size()
+  explicit fm_index(const unsigned long long * data): ext(data) {
+    layout(data[N]);
+  }
+
+  const unsigned long long * data() const { return data_ptr(); }
+
+  size_t size() const {  //in words
+    return samples() + rank1(data_ptr() + marks(), n + 1);
+  }
+
+  long long length() const { return n; }
+
+  long long count(const std::string & p) const {
+    word_t lo, hi;
+    return range(p, lo, hi) ? hi - lo : 0;
+  }
+
+  void locate(const std::string & p, std::vector<long long> & res) const {
+    word_t lo, hi;
+    if (!range(p, lo, hi)) return;
+    const word_t * d = data_ptr(), * m = d + marks(), * smp = d + samples();
+    for (word_t row = lo; row < hi; row++) {
+      word_t i = row, steps = 0;
+      while (!bit(m, i)) {
+        i = lf(i);
+        steps++;
+      }
+      res.push_back(smp[rank1(m, i)] + steps);
+    }
+  }
+};
+
+/*** Example Usage ***/
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+using namespace std;
+
+const char * text_ptr;
+
+bool suffix_less(int a, int b) {
+  return strcmp(text_ptr + a, text_ptr + b) < 0;
+}
+
+int main() {
+  string text("mississippi, missouri");
+  vector<int> sa(text.size());
+  for (int i = 0; i < (int)sa.size(); i++) sa[i] = i;
+  text_ptr = text.c_str();
+  sort(sa.begin(), sa.end(), suffix_less);
+
+  fm_index fm(text, sa, 4);
+  assert(fm.count("ss") == 3 && fm.count("issi") == 2 && fm.count("x") == 0);
+  assert(fm.count("") == (long long)text.size() + 1);
+  vector<long long> res;
+  fm.locate("mis", res);
+  sort(res.begin(), res.end());
+  assert(res.size() == 2 && res[0] == 0 && res[1] == 13);
+
+  //a copy of the serialized words, as if read from a file by mmap()
+  vector<unsigned long long> file(fm.data(), fm.data() + fm.size());
+  fm_index view(&file[0]);
+  assert(view.count("ssi") == 2 && view.count("ri") == 1);
+  return 0;
+}
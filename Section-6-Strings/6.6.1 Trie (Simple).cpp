@@ -95,8 +95,296 @@ class trie {
   }
 };
 
+/*
+
+A double-array trie (Aoe, 1989) stores a static trie of byte strings in
+two integer arrays, base and check, kept interleaved in one array of
+units. The child of node s by the label c is the node t = base[s] + c,
+which exists exactly when check[t] = s. Labels are the bytes plus 1,
+and the label 0 leads from a node to a terminal unit, whose base holds
+the value of the key ending at the node as -1 - value. A step down the
+trie is therefore two array reads at nearby addresses, instead of a
+pointer chase per node, and there are no per-node allocations.
+
+The trie is built in bulk from keys in sorted order, without
+duplicates, whose values are their indices. Each node's children are
+placed at the first base, found by a forward scan over the free units,
+for which every child's unit is free, where the scan starts where the
+array was last more than 95% full, and no two nodes share a base. The
+arrays grow as needed.
+
+find(key) returns the value of the key, or -1 if it is absent.
+longest_prefix(t, n, len) returns the value of the longest key which is
+a prefix of the n bytes at t, storing its length in len, or -1 (and a
+length of 0) if none.
+with_prefix(prefix, res) appends the values of all keys beginning with
+the prefix to res, in sorted order of the keys.
+
+The units are the only state, so data() and size() can be written to a
+file and a double_array_trie(data, size) constructed on a pointer to
+them, e.g. from mmap(), to answer queries without loading anything.
+
+Time Complexity: O(l * c) to construct in the worst case, where l is
+the sum of all key lengths and c is the alphabet size, but typically
+O(l), since the scan for free units starts near the front of the free
+space. O(m) for find() and longest_prefix() on a key or text of length
+m, and O(m + c * k) for with_prefix() over the k nodes below the prefix.
+
+Space Complexity: O(l) units of 8 bytes.
+
+*/
+
+#include <algorithm> /* std::max() */
+#include <vector>
+
+class double_array_trie {
+  std::vector<int> units;  //base of node i at 2i, check at 2i + 1
+  const int * ext;
+  int nunits;
+
+  const int * u() const { return ext ? ext : &units[0]; }
+  int base(int s) const { return u()[2 * s]; }
+  int check(int s) const { return u()[2 * s + 1]; }
+
+  //children of s by label, or -1 if there is none
+  int child(int s, int label) const {
+    int t = base(s) + label;
+    return (t > 0 && t < nunits && check(t) == s) ? t : -1;
+  }
+
+  struct builder {
+    const std::vector<std::string> & keys;
+    std::vector<int> & units;
+    std::vector<bool> used_base;
+    int next_check, size;
+
+    builder(const std::vector<std::string> & k, std::vector<int> & u)
+    : keys(k), units(u), next_check(1), size(1) {}
+
+    void reserve(int n) {
+      if (n * 2 <= (int)units.size()) return;
+      int cap = std::max(n, (int)units.size());  //doubling the units
+      units.resize(2 * cap, -1);
+      used_base.resize(cap, false);
+    }
+
+    int label(int k, int depth) const {
+      return (depth < (int)keys[k].size())
+                 ? (unsigned char)keys[k][depth] + 1 : 0;
+    }
+
+    //places the children of node s, for keys [lo, hi) sharing the first
+    //depth bytes, and recurses on each child
+    void insert(int s, int lo, int hi, int depth) {
+      std::vector<int> labels, start;
+      for (int k = lo; k < hi; k++) {
+        int c = label(k, depth);
+        if (labels.empty() || labels.back() != c) {
+          labels.push_back(c);
+          start.push_back(k);
+        }
+      }
+      start.push_back(hi);
+      int pos = std::max(labels[0] + 1, next_check) - 1, filled = 0;
+      int first = 1, b;
+      for (;;) {
+        pos++;
+        reserve(pos + 1);
+        if (units[2 * pos + 1] >= 0) {
+          filled++;
+          continue;
+        }
+        if (first) {
+          next_check = pos;
+          first = 0;
+        }
+        b = pos - labels[0];
+        reserve(b + labels.back() + 1);
+        if (used_base[b]) continue;
+        bool ok = true;
+        for (int i = 1; i < (int)labels.size() && ok; i++)
+          ok = (units[2 * (b + labels[i]) + 1] < 0);
+        if (ok) break;
+      }
+      //move the scan's start past densely filled regions
+      if (filled * 20 >= (pos - next_check + 1) * 19) next_check = pos;
+      used_base[b] = true;
+      units[2 * s] = b;
+      size = std::max(size, b + labels.back() + 1);
+      for (int i = 0; i < (int)labels.size(); i++)
+        units[2 * (b + labels[i]) + 1] = s;
+      for (int i = 0; i < (int)labels.size(); i++) {
+        int t = b + labels[i];
+        if (labels[i] == 0)
+          units[2 * t] = -1 - start[i];
+        else
+          insert(t, start[i], start[i + 1], depth + 1);
+      }
+    }
+  };
+
+  void collect(int s, std::vector<int> & res) const {
+    for (int c = 0; c <= 256; c++) {
+      int t = child(s, c);
+      if (t < 0) continue;
+      if (c == 0)
+        res.push_back(-1 - base(t));
+      else
+        collect(t, res);
+    }
+  }
+
+ public:
+  explicit double_array_trie(const std::vector<std::string> & sorted_keys)
+  : ext(0) {
+    builder b(sorted_keys, units);
+    b.reserve(1024);
+    units[1] = 0;  //the root, which is its own parent
+    if (!sorted_keys.empty())
+      b.insert(0, 0, sorted_keys.size(), 0);
+    units.resize(2 * (nunits = b.size));
+  }
+
+  //a read-only view of units serialized by data() and size()
+  double_array_trie(const int * data, int size)
+  : ext(data), nunits(size / 2) {}
+
+  const int * data() const { return u(); }
+  int size() const { return 2 * nunits; }
+
+  int find(const std::string & key) const {
+    int s = 0;
+    for (int i = 0; i < (int)key.size() && s >= 0; i++)
+      s = child(s, (unsigned char)key[i] + 1);
+    if (s < 0 || (s = child(s, 0)) < 0) return -1;
+    return -1 - base(s);
+  }
+
+  int longest_prefix(const char * t, int n, int & len) const {
+    int res = -1, s = 0, e;
+    len = 0;
+    for (int i = 0; ; i++) {
+      if ((e = child(s, 0)) >= 0) {
+        res = -1 - base(e);
+        len = i;
+      }
+      if (i == n || (s = child(s, (unsigned char)t[i] + 1)) < 0) break;
+    }
+    return res;
+  }
+
+  void with_prefix(const std::string & prefix, std::vector<int> & res) const {
+    int s = 0;
+    for (int i = 0; i < (int)prefix.size() && s >= 0; i++)
+      s = child(s, (unsigned char)prefix[i] + 1);
+    if (s >= 0) collect(s, res);
+  }
+};
+
+/*
+
+A dynamic trie over bytes whose nodes live in a pooled arena, i.e. one
+vector of nodes addressed by index, rather than separate allocations
+holding an array of child pointers for the whole alphabet. The children
+of a node are kept in a list sorted by label, linked through the nodes
+themselves, so a node takes 12 bytes whatever the alphabet. Nodes freed
+by erase() are kept in a free list and reused by later insertions.
+
+Time Complexity: O(n * c) for insert(), contains(), and erase(), where
+n is the length of the string and c is the largest number of children
+of a node on its path, which is at most the alphabet size.
+
+Space Complexity: O(l) nodes of 12 bytes, where l is the sum of all
+lengths of strings that have been inserted so far.
+
+*/
+
+class pooled_trie {
+  struct node_t {
+    int child, next;  //first child and next sibling, or -1 if none
+    unsigned char label;
+    bool leaf;
+  };
+
+  std::vector<node_t> pool;
+  int free_list;  //linked through next
+
+  int new_node(unsigned char label, int next) {
+    int i;
+    if (free_list >= 0) {
+      i = free_list;
+      free_list = pool[i].next;
+    } else {
+      i = pool.size();
+      pool.push_back(node_t());
+    }
+    node_t & n = pool[i];
+    n.child = -1;
+    n.next = next;
+    n.label = label;
+    n.leaf = false;
+    return i;
+  }
+
+  //the child of s by label c, or -1, where prev is its previous sibling
+  int find_child(int s, unsigned char c, int & prev) const {
+    prev = -1;
+    int t = pool[s].child;
+    for (; t >= 0 && pool[t].label < c; t = pool[t].next) prev = t;
+    return (t >= 0 && pool[t].label == c) ? t : -1;
+  }
+
+ public:
+  pooled_trie(): free_list(-1) { new_node(0, -1); }
+
+  void insert(const std::string & s) {
+    int n = 0, prev;
+    for (int i = 0; i < (int)s.size(); i++) {
+      unsigned char c = s[i];
+      int t = find_child(n, c, prev);
+      if (t < 0) {
+        int next = (prev < 0) ? pool[n].child : pool[prev].next;
+        t = new_node(c, next);
+        if (prev < 0) pool[n].child = t; else pool[prev].next = t;
+      }
+      n = t;
+    }
+    pool[n].leaf = true;
+  }
+
+  bool contains(const std::string & s) const {
+    int n = 0, prev;
+    for (int i = 0; i < (int)s.size() && n >= 0; i++)
+      n = find_child(n, s[i], prev);
+    return n >= 0 && pool[n].leaf;
+  }
+
+  bool erase(const std::string & s) {
+    std::vector<int> path(1, 0), prevs(1, -1);
+    for (int i = 0; i < (int)s.size(); i++) {
+      int prev, t = find_child(path.back(), s[i], prev);
+      if (t < 0) return false;
+      path.push_back(t);
+      prevs.push_back(prev);
+    }
+    if (!pool[path.back()].leaf) return false;
+    pool[path.back()].leaf = false;
+    //free the nodes which no longer lead to any string
+    for (int i = s.size(); i > 0; i--) {
+      int t = path[i], p = path[i - 1];
+      if (pool[t].leaf || pool[t].child >= 0) break;
+      if (prevs[i] < 0) pool[p].child = pool[t].next;
+      else pool[prevs[i]].next = pool[t].next;
+      pool[t].next = free_list;
+      free_list = t;
+    }
+    return true;
+  }
+};
+
 /*** Example Usage ***/
 
+#include <algorithm>
 #include <cassert>
 using namespace std;
 
@@ -108,5 +396,24 @@ int main() {
   assert(t.contains("ten"));
   t.erase("tea");
   assert(!t.contains("tea"));
+
+  vector<string> keys(s, s + 8);
+  sort(keys.begin(), keys.end());  //a i in inn tea ted ten to
+  double_array_trie da(keys);
+  assert(da.find("ted") == 5 && da.find("te") == -1);
+  int len;
+  assert(da.longest_prefix("inner", 5, len) == 3 && len == 3);
+  vector<int> res;
+  da.with_prefix("te", res);
+  assert(res.size() == 3 && res[0] == 4 && res[2] == 6);
+  //a view of the units, as if loaded from a file by mmap()
+  vector<int> file(da.data(), da.data() + da.size());
+  assert(double_array_trie(&file[0], file.size()).find("inn") == 3);
+
+  pooled_trie pt;
+  for (int i = 0; i < 8; i++)
+    pt.insert(s[i]);
+  pt.erase("tea");
+  assert(pt.contains("ten") && !pt.contains("tea") && !pt.contains("te"));
   return 0;
 }
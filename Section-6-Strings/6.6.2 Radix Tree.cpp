@@ -15,6 +15,7 @@ of strings that have been inserted so far.
 
 */
 
+#include <algorithm> /* std::min() */
 #include <string>
 #include <vector>
 
@@ -120,6 +121,500 @@ class radix_trie {
   }
 };
 
+/*
+
+An adaptive radix tree (ART, Leis et al., 2013) is a radix tree over
+the bytes of binary keys whose inner nodes adapt their layout to their
+number of children: Node4 and Node16 hold sorted arrays of up to 4 and
+16 key bytes beside their child pointers, Node48 maps all 256 bytes to
+up to 48 child slots, and Node256 holds a child pointer per byte. Nodes
+grow to the next type when they fill up, and shrink to the previous
+type when they fall well below its capacity, so that memory stays
+proportional to the number of keys while lookups in the dense nodes
+are a single array access. A Node16 is searched by comparing all of
+its key bytes at once with SSE2, where available.
+
+Paths are compressed: a chain of inner nodes with one child each is
+merged into its bottom node, which stores the skipped bytes as its
+prefix. Up to MAX_PREFIX bytes of a prefix are stored, and longer ones
+are skipped optimistically on lookup and verified against the full key
+kept in every leaf. Keys may be prefixes of one another, as a key which
+ends at an inner node is kept in that node's end slot.
+
+insert(key, value) inserts a key, or updates its value if it already
+exists, and returns whether it was inserted. find(key) returns a
+pointer to the value of the key, or 0 if it is absent. erase(key)
+removes a key and returns whether it was present.
+
+Time Complexity: O(k) for insert(), find(), and erase(), where k is the
+length of the key, plus O(k) to compare with the key of a leaf.
+
+Space Complexity: O(n) nodes for n keys, each inner node being at most
+the size of a Node256, and each leaf holding its key.
+
+*/
+
+#include <cstring>  /* memcpy(), memmove() */
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+template<class V>
+class adaptive_radix_tree {
+  enum { LEAF, N4, N16, N48, N256 };
+  static const int MAX_PREFIX = 8;
+
+  struct node_t {
+    unsigned char type;
+  };
+
+  struct leaf_t : node_t {
+    std::string key;
+    V value;
+    leaf_t(const std::string & k, const V & v): key(k), value(v) {
+      this->type = LEAF;
+    }
+  };
+
+  struct inner_t : node_t {
+    int count, prefix_len;
+    unsigned char prefix[MAX_PREFIX];
+    leaf_t * end;  //the leaf of the key ending at this node, if any
+  };
+
+  struct node4_t : inner_t { unsigned char keys[4]; node_t * child[4]; };
+  struct node16_t : inner_t { unsigned char keys[16]; node_t * child[16]; };
+  struct node48_t : inner_t { unsigned char index[256]; node_t * child[48]; };
+  struct node256_t : inner_t { node_t * child[256]; };
+
+  node_t * root;
+  int num_keys;
+
+  template<class Node>
+  static Node * make(int type, const inner_t * header) {
+    Node * n = new Node;
+    if (header != 0) {
+      *(inner_t *)n = *header;
+    } else {
+      n->count = n->prefix_len = 0;
+      n->end = 0;
+    }
+    n->type = type;
+    if (type == N48) memset(((node48_t *)n)->index, 0, 256);
+    if (type == N256)
+      memset(((node256_t *)n)->child, 0, sizeof(node_t *) * 256);
+    return n;
+  }
+
+  static node_t ** find_child(node_t * p, unsigned char c) {
+    switch (p->type) {
+      case N4: {
+        node4_t * n = (node4_t *)p;
+        for (int i = 0; i < n->count; i++)
+          if (n->keys[i] == c) return &n->child[i];
+        return 0;
+      }
+      case N16: {
+        node16_t * n = (node16_t *)p;
+#ifdef __SSE2__
+        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(c),
+            _mm_loadu_si128((const __m128i *)n->keys));
+        int mask = _mm_movemask_epi8(cmp) & ((1 << n->count) - 1);
+        return mask ? &n->child[__builtin_ctz(mask)] : 0;
+#else
+        for (int i = 0; i < n->count; i++)
+          if (n->keys[i] == c) return &n->child[i];
+        return 0;
+#endif
+      }
+      case N48: {
+        node48_t * n = (node48_t *)p;
+        return n->index[c] ? &n->child[n->index[c] - 1] : 0;
+      }
+      default: {
+        node256_t * n = (node256_t *)p;
+        return n->child[c] ? &n->child[c] : 0;
+      }
+    }
+  }
+
+  static leaf_t * minimum(node_t * p) {
+    while (p->type != LEAF) {
+      inner_t * n = (inner_t *)p;
+      if (n->end != 0) return n->end;
+      switch (p->type) {
+        case N4: p = ((node4_t *)p)->child[0]; break;
+        case N16: p = ((node16_t *)p)->child[0]; break;
+        case N48: {
+          node48_t * m = (node48_t *)p;
+          int c = 0;
+          while (m->index[c] == 0) c++;
+          p = m->child[m->index[c] - 1];
+          break;
+        }
+        default: {
+          node256_t * m = (node256_t *)p;
+          int c = 0;
+          while (m->child[c] == 0) c++;
+          p = m->child[c];
+        }
+      }
+    }
+    return (leaf_t *)p;
+  }
+
+  //inserts child under the byte c into the node at ref, growing it if full
+  static void add_child(node_t *& ref, unsigned char c, node_t * child) {
+    inner_t * h = (inner_t *)ref;
+    switch (ref->type) {
+      case N4:
+      case N16: {
+        int cap = (ref->type == N4) ? 4 : 16;
+        unsigned char * keys = (ref->type == N4) ? ((node4_t *)ref)->keys
+                                                 : ((node16_t *)ref)->keys;
+        node_t ** ch = (ref->type == N4) ? ((node4_t *)ref)->child
+                                         : ((node16_t *)ref)->child;
+        if (h->count < cap) {
+          int i = 0;
+          while (i < h->count && keys[i] < c) i++;
+          memmove(keys + i + 1, keys + i, h->count - i);
+          memmove(ch + i + 1, ch + i, (h->count - i) * sizeof(node_t *));
+          keys[i] = c;
+          ch[i] = child;
+          h->count++;
+          return;
+        }
+        if (ref->type == N4) {
+          node16_t * n = make<node16_t>(N16, h);
+          memcpy(n->keys, keys, 4);
+          memcpy(n->child, ch, 4 * sizeof(node_t *));
+          delete (node4_t *)ref;
+          ref = n;
+        } else {
+          node48_t * n = make<node48_t>(N48, h);
+          for (int i = 0; i < 16; i++) {
+            n->index[keys[i]] = i + 1;
+            n->child[i] = ch[i];
+          }
+          delete (node16_t *)ref;
+          ref = n;
+        }
+        add_child(ref, c, child);
+        return;
+      }
+      case N48: {
+        node48_t * n = (node48_t *)ref;
+        if (n->count < 48) {  //slots [0, count) are in use
+          n->child[n->count] = child;
+          n->index[c] = ++n->count;
+          return;
+        }
+        node256_t * m = make<node256_t>(N256, h);
+        for (int i = 0; i < 256; i++)
+          if (n->index[i]) m->child[i] = n->child[n->index[i] - 1];
+        delete n;
+        ref = m;
+        add_child(ref, c, child);
+        return;
+      }
+      default:
+        ((node256_t *)ref)->child[c] = child;
+        h->count++;
+    }
+  }
+
+  //merges a Node4 with no end leaf and one child into that child
+  static void collapse(node_t *& ref) {
+    node4_t * n = (node4_t *)ref;
+    node_t * child = n->child[0];
+    if (child->type != LEAF) {
+      inner_t * c = (inner_t *)child;
+      unsigned char buf[MAX_PREFIX];
+      int len = 0;
+      for (int i = 0; i < n->prefix_len && len < MAX_PREFIX; i++)
+        buf[len++] = n->prefix[i];
+      if (len < MAX_PREFIX) buf[len++] = n->keys[0];
+      for (int i = 0; i < c->prefix_len && len < MAX_PREFIX; i++)
+        buf[len++] = c->prefix[i];
+      memcpy(c->prefix, buf, len);
+      c->prefix_len += n->prefix_len + 1;
+    }
+    delete n;
+    ref = child;
+  }
+
+  //removes the child under the byte c from the node at ref, shrinking it
+  static void remove_child(node_t *& ref, unsigned char c) {
+    inner_t * h = (inner_t *)ref;
+    switch (ref->type) {
+      case N4:
+      case N16: {
+        unsigned char * keys = (ref->type == N4) ? ((node4_t *)ref)->keys
+                                                 : ((node16_t *)ref)->keys;
+        node_t ** ch = (ref->type == N4) ? ((node4_t *)ref)->child
+                                         : ((node16_t *)ref)->child;
+        int i = 0;
+        while (keys[i] != c) i++;
+        h->count--;
+        memmove(keys + i, keys + i + 1, h->count - i);
+        memmove(ch + i, ch + i + 1, (h->count - i) * sizeof(node_t *));
+        if (ref->type == N16 && h->count <= 3) {
+          node4_t * n = make<node4_t>(N4, h);
+          memcpy(n->keys, keys, h->count);
+          memcpy(n->child, ch, h->count * sizeof(node_t *));
+          delete (node16_t *)ref;
+          ref = n;
+        }
+        return;
+      }
+      case N48: {
+        node48_t * n = (node48_t *)ref;
+        int slot = n->index[c] - 1, last = --n->count;
+        n->index[c] = 0;
+        if (slot != last) {  //move the last slot into the freed one
+          for (int i = 0; i < 256; i++) {
+            if (n->index[i] == last + 1) {
+              n->index[i] = slot + 1;
+              break;
+            }
+          }
+          n->child[slot] = n->child[last];
+        }
+        if (n->count <= 12) {
+          node16_t * m = make<node16_t>(N16, h);
+          for (int i = 0, k = 0; i < 256; i++) {
+            if (n->index[i]) {
+              m->keys[k] = i;
+              m->child[k++] = n->child[n->index[i] - 1];
+            }
+          }
+          delete n;
+          ref = m;
+        }
+        return;
+      }
+      default: {
+        node256_t * n = (node256_t *)ref;
+        n->child[c] = 0;
+        if (--n->count <= 37) {
+          node48_t * m = make<node48_t>(N48, h);
+          for (int i = 0, k = 0; i < 256; i++) {
+            if (n->child[i]) {
+              m->child[k] = n->child[i];
+              m->index[i] = ++k;
+            }
+          }
+          delete n;
+          ref = m;
+        }
+      }
+    }
+  }
+
+  //after a removal, replaces a node left with one entry by that entry
+  static void compact(node_t *& ref) {
+    inner_t * n = (inner_t *)ref;
+    if (n->count == 0) {
+      node_t * end = n->end;
+      delete (node4_t *)ref;  //a node with at most one child is a Node4
+      ref = end;
+    } else if (n->count == 1 && n->end == 0 && ref->type == N4) {
+      collapse(ref);
+    }
+  }
+
+  //the number of bytes of the node's prefix matching key from depth
+  static int prefix_match(inner_t * n, const std::string & key, int depth) {
+    int i = 0, k = key.size();
+    for (; i < n->prefix_len && i < MAX_PREFIX; i++)
+      if (depth + i >= k || n->prefix[i] != (unsigned char)key[depth + i])
+        return i;
+    if (n->prefix_len > MAX_PREFIX) {
+      const std::string & full = minimum(n)->key;
+      for (; i < n->prefix_len; i++)
+        if (depth + i >= k || full[depth + i] != key[depth + i]) return i;
+    }
+    return i;
+  }
+
+  bool insert(node_t *& ref, const std::string & key, int depth,
+              const V & value) {
+    if (ref == 0) {
+      ref = new leaf_t(key, value);
+      return true;
+    }
+    if (ref->type == LEAF) {
+      leaf_t * l = (leaf_t *)ref;
+      if (l->key == key) {
+        l->value = value;
+        return false;
+      }
+      //split the leaf into a Node4 over the rest of their common prefix
+      node4_t * n = make<node4_t>(N4, 0);
+      int p = 0;
+      while (depth + p < (int)key.size() && depth + p < (int)l->key.size() &&
+             key[depth + p] == l->key[depth + p])
+        p++;
+      n->prefix_len = p;
+      for (int i = 0; i < p && i < MAX_PREFIX; i++)
+        n->prefix[i] = key[depth + i];
+      node_t * nn = n;
+      leaf_t * nl = new leaf_t(key, value);
+      if (depth + p == (int)l->key.size()) n->end = l;
+      else add_child(nn, l->key[depth + p], l);
+      if (depth + p == (int)key.size()) n->end = nl;
+      else add_child(nn, key[depth + p], nl);
+      ref = nn;
+      return true;
+    }
+    inner_t * n = (inner_t *)ref;
+    if (n->prefix_len > 0) {
+      int p = prefix_match(n, key, depth);
+      if (p < n->prefix_len) {
+        //split the prefix at the first mismatch
+        node4_t * m = make<node4_t>(N4, 0);
+        m->prefix_len = p;
+        memcpy(m->prefix, n->prefix, std::min(p, (int)MAX_PREFIX));
+        const std::string * full = 0;
+        if (n->prefix_len > MAX_PREFIX) full = &minimum(n)->key;
+        unsigned char c = (p < MAX_PREFIX) ? n->prefix[p]
+                                           : (*full)[depth + p];
+        n->prefix_len -= p + 1;
+        if (full == 0) {
+          memmove(n->prefix, n->prefix + p + 1, n->prefix_len);
+        } else {
+          for (int i = 0; i < n->prefix_len && i < MAX_PREFIX; i++)
+            n->prefix[i] = (*full)[depth + p + 1 + i];
+        }
+        node_t * mm = m;
+        add_child(mm, c, n);
+        leaf_t * nl = new leaf_t(key, value);
+        if (depth + p == (int)key.size()) m->end = nl;
+        else add_child(mm, key[depth + p], nl);
+        ref = mm;
+        return true;
+      }
+      depth += n->prefix_len;
+    }
+    if (depth == (int)key.size()) {
+      if (n->end != 0) {
+        n->end->value = value;
+        return false;
+      }
+      n->end = new leaf_t(key, value);
+      return true;
+    }
+    node_t ** child = find_child(ref, key[depth]);
+    if (child != 0) return insert(*child, key, depth + 1, value);
+    add_child(ref, key[depth], new leaf_t(key, value));
+    return true;
+  }
+
+  bool erase(node_t *& ref, const std::string & key, int depth) {
+    if (ref == 0) return false;
+    if (ref->type == LEAF) {
+      if (((leaf_t *)ref)->key != key) return false;
+      delete (leaf_t *)ref;
+      ref = 0;
+      return true;
+    }
+    inner_t * n = (inner_t *)ref;
+    if (prefix_match(n, key, depth) < n->prefix_len) return false;
+    depth += n->prefix_len;
+    if (depth == (int)key.size()) {
+      if (n->end == 0) return false;
+      delete n->end;
+      n->end = 0;
+      compact(ref);
+      return true;
+    }
+    node_t ** child = find_child(ref, key[depth]);
+    if (child == 0 || !erase(*child, key, depth + 1)) return false;
+    if (*child == 0) {
+      remove_child(ref, key[depth]);
+      if (ref->type == N4) compact(ref);
+    }
+    return true;
+  }
+
+  static void clean_up(node_t * p) {
+    if (p == 0) return;
+    if (p->type == LEAF) {
+      delete (leaf_t *)p;
+      return;
+    }
+    inner_t * h = (inner_t *)p;
+    if (h->end != 0) delete h->end;
+    switch (p->type) {
+      case N4: {
+        node4_t * n = (node4_t *)p;
+        for (int i = 0; i < n->count; i++) clean_up(n->child[i]);
+        delete n;
+        break;
+      }
+      case N16: {
+        node16_t * n = (node16_t *)p;
+        for (int i = 0; i < n->count; i++) clean_up(n->child[i]);
+        delete n;
+        break;
+      }
+      case N48: {
+        node48_t * n = (node48_t *)p;
+        for (int i = 0; i < n->count; i++) clean_up(n->child[i]);
+        delete n;
+        break;
+      }
+      default: {
+        node256_t * n = (node256_t *)p;
+        for (int i = 0; i < 256; i++) clean_up(n->child[i]);
+        delete n;
+      }
+    }
+  }
+
+  //not copyable, since the nodes are owned
+  adaptive_radix_tree(const adaptive_radix_tree &);
+  adaptive_radix_tree & operator=(const adaptive_radix_tree &);
+
+ public:
+  adaptive_radix_tree(): root(0), num_keys(0) {}
+  ~adaptive_radix_tree() { clean_up(root); }
+
+  int size() const { return num_keys; }
+
+  bool insert(const std::string & key, const V & value) {
+    bool inserted = insert(root, key, 0, value);
+    if (inserted) num_keys++;
+    return inserted;
+  }
+
+  V * find(const std::string & key) const {
+    node_t * p = root;
+    int depth = 0, k = key.size();
+    while (p != 0 && p->type != LEAF) {
+      inner_t * n = (inner_t *)p;
+      for (int i = 0; i < n->prefix_len && i < MAX_PREFIX; i++)
+        if (depth + i >= k || n->prefix[i] != (unsigned char)key[depth + i])
+          return 0;
+      depth += n->prefix_len;  //bytes past MAX_PREFIX are checked at the leaf
+      if (depth >= k) {
+        p = (depth == k) ? n->end : 0;
+        break;
+      }
+      node_t ** child = find_child(p, key[depth++]);
+      p = (child != 0) ? *child : 0;
+    }
+    if (p == 0 || ((leaf_t *)p)->key != key) return 0;
+    return &((leaf_t *)p)->value;
+  }
+
+  bool erase(const std::string & key) {
+    bool erased = erase(root, key, 0);
+    if (erased) num_keys--;
+    return erased;
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
@@ -152,5 +647,21 @@ int main() {
     t.walk(concat);
     assert(preorder == "t est oast er ing slow ly ");
   }
+  {
+    adaptive_radix_tree<int> t;
+    string s[6] = {"to", "tea", "ted", "ten", "tea", "t"};
+    for (int i = 0; i < 6; i++)
+      t.insert(s[i], i);
+    assert(t.size() == 5 && *t.find("tea") == 4 && *t.find("t") == 5);
+    assert(t.find("te") == 0 && t.find("teas") == 0);
+    for (int i = 0; i < 100; i++)  //grows the node under "k" to a Node256
+      t.insert(string("k") + char(i) + "-long-shared-suffix", i);
+    assert(*t.find(string("k") + char(42) + "-long-shared-suffix") == 42);
+    assert(t.find(string("k") + char(42) + "-long-shared-suffiX") == 0);
+    for (int i = 0; i < 100; i++)
+      assert(t.erase(string("k") + char(i) + "-long-shared-suffix"));
+    assert(t.erase("t") && !t.erase("t") && t.size() == 4);
+    assert(*t.find("ted") == 2);
+  }
   return 0;
 }
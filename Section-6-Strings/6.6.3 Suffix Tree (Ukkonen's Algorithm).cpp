@@ -123,11 +123,291 @@ std::string longest_common_substring
   return s.substr(lcs_begin - 1, lcs_len);
 }
 
+/*
+
+The suffix tree below is a compact version of the one above, built by
+Ukkonen's algorithm over a generalized input of one or more strings of
+arbitrary bytes, each followed by a separator byte (by default '\0')
+which must not occur within them. The whole text is followed by a
+virtual sentinel, so that every suffix ends at a leaf.
+
+Nodes are indices into flat arrays instead of heap-allocated objects,
+and the children of a node are a linked list of siblings. Every node v
+stores a position pos(v) at which its path label occurs in the text,
+which then spans [pos(v), pos(v) + depth(v)), so that the label of an
+edge from u to v is [pos(v) + depth(u), pos(v) + depth(v)). The leaf
+for the suffix at i has pos = i and depth = n + 1 - i, and thus only
+stores its next sibling, while internal nodes store their position,
+depth, first child, next sibling and suffix link. For a text of n
+bytes with about 0.6n internal nodes (typical of DNA and natural
+text), the tree takes about 1 + 4 + 0.6 * 20 = 17 bytes per character,
+and at most 25 bytes per character.
+
+Queries traverse the tree iteratively, and never recurse on its depth:
+
+- longest_common_substring(r) returns the longest substring occurring
+  in at least r of the strings (by default all of them), for at most 64
+  strings. The set of strings below each internal node is computed as
+  a bit mask in reverse preorder.
+- longest_repeat(k) returns the longest substring occurring at least k
+  times in the strings, by counting the leaves below each node.
+- matching_statistics(q) returns, for each position i of q, the length
+  of the longest prefix of q[i, |q|) occurring in the strings, walking
+  down the tree and following suffix links from each position to the
+  next. q should not contain the separator.
+
+Substrings across a separator are never reported, as a label is cut at
+its first separator.
+
+Time Complexity: O(n * k) for construction, where k is the number of
+distinct bytes, which bounds the number of siblings scanned per child
+lookup. O(n) for longest_common_substring() and longest_repeat(), plus
+O(log m) per leaf to find its string among m strings, and O(|q| * k)
+for matching_statistics().
+
+Space Complexity: O(n), as described above, plus 12 bytes per internal
+node for longest_common_substring() and 8 for longest_repeat().
+
+*/
+
+#include <algorithm> /* std::upper_bound() */
+#include <vector>
+
+class compact_suffix_tree {
+  struct inner_t {
+    int pos, depth, child, next, link;
+  };
+
+  //the root is node 0, which is never a child, so 0 also marks the end of
+  //a sibling list; the leaf of the suffix at i is ~i
+  std::string text;
+  std::vector<int> starts;  //the start of each string, then text.size()
+  std::vector<inner_t> in;
+  std::vector<int> leaf_next;
+  int end;  //one past the last position of every leaf edge
+
+  int sym(int i) const {
+    return (i < (int)text.size()) ? (unsigned char)text[i] : 256;
+  }
+
+  int pos(int v) const { return (v >= 0) ? in[v].pos : ~v; }
+  int depth(int v) const { return (v >= 0) ? in[v].depth : end - ~v; }
+  int next(int v) const { return (v >= 0) ? in[v].next : leaf_next[~v]; }
+  int * next_slot(int v) { return (v >= 0) ? &in[v].next : &leaf_next[~v]; }
+
+  int find_child(int u, int c) const {
+    for (int v = in[u].child; v != 0; v = next(v))
+      if (sym(pos(v) + in[u].depth) == c) return v;
+    return 0;
+  }
+
+  int add_node(int pos, int depth) {
+    inner_t t = {pos, depth, 0, 0, 0};
+    in.push_back(t);
+    return in.size() - 1;
+  }
+
+  void build() {
+    int n = text.size();
+    leaf_next.assign(n + 1, 0);
+    add_node(0, 0);
+    int node = 0, edge = 0, len = 0, rem = 0;
+    for (int i = 0; i <= n; i++) {
+      int c = sym(i), last = 0;
+      end = i + 1;
+      rem++;
+      while (rem > 0) {
+        if (len == 0) edge = i;
+        int v = find_child(node, sym(edge));
+        if (v == 0) {
+          int j = i - rem + 1;
+          leaf_next[j] = in[node].child;
+          in[node].child = ~j;
+          if (last != 0) {
+            in[last].link = node;
+            last = 0;
+          }
+        } else {
+          int d = in[node].depth, elen = depth(v) - d;
+          if (len >= elen) {  //walk down to the next node
+            edge += elen;
+            len -= elen;
+            node = v;
+            continue;
+          }
+          if (sym(pos(v) + d + len) == c) {
+            if (last != 0 && node != 0) in[last].link = node;
+            len++;
+            break;
+          }
+          //split the edge to v, and add the leaf for the suffix at j
+          int j = i - rem + 1, m = add_node(pos(v), d + len);
+          int * s = &in[node].child;
+          while (*s != v) s = next_slot(*s);
+          *s = m;
+          in[m].next = next(v);
+          in[m].child = v;
+          *next_slot(v) = ~j;
+          leaf_next[j] = 0;
+          if (last != 0) in[last].link = m;
+          last = m;
+        }
+        rem--;
+        if (node == 0 && len > 0) {
+          len--;
+          edge = i - rem + 1;
+        } else if (node != 0) {
+          node = in[node].link;
+        }
+      }
+    }
+  }
+
+  int string_of(int p) const {
+    return std::upper_bound(starts.begin(), starts.end(), p) -
+           starts.begin() - 1;
+  }
+
+  //the length of the label [p, p + d) up to its first separator
+  int clip(int p, int d) const {
+    if (p >= (int)text.size()) return 0;
+    return std::min(d, starts[string_of(p) + 1] - 1 - p);
+  }
+
+  void preorder(std::vector<int> & order) const {
+    order.clear();
+    order.reserve(in.size());
+    std::vector<int> stack(1, 0);
+    while (!stack.empty()) {
+      int u = stack.back();
+      stack.pop_back();
+      order.push_back(u);
+      for (int v = in[u].child; v != 0; v = next(v))
+        if (v > 0) stack.push_back(v);
+    }
+  }
+
+  void init(const std::vector<std::string> & s, char separator) {
+    for (int i = 0; i < (int)s.size(); i++) {
+      starts.push_back(text.size());
+      text += s[i];
+      text += separator;
+    }
+    starts.push_back(text.size());
+    build();
+  }
+
+ public:
+  explicit compact_suffix_tree(const std::string & s, char separator = 0) {
+    init(std::vector<std::string>(1, s), separator);
+  }
+
+  explicit compact_suffix_tree(const std::vector<std::string> & s,
+                               char separator = 0) {
+    init(s, separator);
+  }
+
+  int internal_nodes() const { return in.size(); }
+
+  std::string longest_common_substring(int r = -1) const {
+    int n = text.size(), best = 0, best_pos = 0;
+    if (r < 0) r = starts.size() - 1;
+    std::vector<int> order;
+    preorder(order);
+    std::vector<unsigned long long> mask(in.size());
+    for (int t = (int)order.size() - 1; t >= 0; t--) {
+      int u = order[t];
+      unsigned long long m = 0;
+      for (int v = in[u].child; v != 0; v = next(v)) {
+        if (v > 0) {
+          m |= mask[v];
+        } else if (~v < n) {
+          m |= 1ULL << string_of(~v);
+          if (r <= 1 && clip(~v, n - ~v) > best) {
+            best = clip(~v, n - ~v);
+            best_pos = ~v;
+          }
+        }
+      }
+      mask[u] = m;
+      int len = clip(in[u].pos, in[u].depth);
+      if (__builtin_popcountll(m) >= r && len > best) {
+        best = len;
+        best_pos = in[u].pos;
+      }
+    }
+    return text.substr(best_pos, best);
+  }
+
+  std::string longest_repeat(int k = 2) const {
+    int n = text.size(), best = 0, best_pos = 0;
+    std::vector<int> order;
+    preorder(order);
+    std::vector<int> count(in.size());
+    for (int t = (int)order.size() - 1; t >= 0; t--) {
+      int u = order[t];
+      for (int v = in[u].child; v != 0; v = next(v))
+        count[u] += (v > 0) ? count[v] : (~v < n);
+      int len = clip(in[u].pos, in[u].depth);
+      if (count[u] >= k && len > best) {
+        best = len;
+        best_pos = in[u].pos;
+      }
+    }
+    if (k <= 1) {
+      for (int i = 0; i < n; i++) {
+        if (clip(i, n - i) > best) {
+          best = clip(i, n - i);
+          best_pos = i;
+        }
+      }
+    }
+    return text.substr(best_pos, best);
+  }
+
+  std::vector<int> matching_statistics(const std::string & q) const {
+    int m = q.size(), u = 0, len = 0, v = 0;
+    std::vector<int> ms(m);
+    for (int i = 0; i < m; i++) {
+      //q[i, i + len) is in the tree, and u is the deepest node on its path
+      //with depth(u) <= len, where v is the child of u on the path
+      while (i + len < m) {
+        int c = (unsigned char)q[i + len];
+        if (len == in[u].depth) v = find_child(u, c);
+        if (v == 0 || sym(pos(v) + len) != c) break;
+        if (++len == depth(v) && v > 0) u = v;
+      }
+      ms[i] = len;
+      if (len == 0) continue;
+      if (u != 0) u = in[u].link;
+      len--;
+      while (in[u].depth < len) {  //skip down to depth len on the path
+        v = find_child(u, (unsigned char)q[i + 1 + in[u].depth]);
+        if (v < 0 || in[v].depth > len) break;
+        u = v;
+      }
+    }
+    return ms;
+  }
+};
+
 /*** Example Usage ***/
 
 #include <cassert>
 
 int main() {
   assert(longest_common_substring("bbbabca", "aababcd") == "babc");
+
+  std::vector<std::string> s;
+  s.push_back("xabcdefy");
+  s.push_back("zzabcdz");
+  s.push_back("bcdefab");
+  compact_suffix_tree t(s);
+  assert(t.longest_common_substring() == "bcd");
+  assert(t.longest_common_substring(2) == "bcdef");
+  assert(t.longest_repeat(3) == "bcd" && t.longest_repeat(4) == "b");
+  std::vector<int> ms = t.matching_statistics("cdefz");
+  int ms_ans[] = {4, 3, 2, 1, 1};
+  assert(std::equal(ms.begin(), ms.end(), ms_ans));
   return 0;
 }
@@ -131,6 +131,166 @@ struct suffix_automaton {
   }
 };
 
+/*
+
+The suffix automaton below is a variant for large alphabets and
+unbounded input, over symbols which are arbitrary non-negative ints
+(e.g. token ids from a vocabulary of 64k words) rather than letters.
+Instead of an array of transitions per state, all transitions are kept
+in one pool of edges, each linked into the list of its source state,
+and found by a hash table from (state, symbol) to the edge, using open
+addressing with linear probing over a power of two number of slots that
+is doubled when half full. Cloning a state copies its edge list. The
+states are likewise pooled in one array, and both pools only grow.
+
+extend(s, n) appends a chunk of n symbols to the text, so that the
+automaton grows online as data streams in, and queries may be made
+between chunks. The number of distinct nonempty substrings of the text
+is maintained as each state is added, as the sum of
+len(v) - len(link(v)) over the states v other than the root.
+occurrences(p, m) returns the number of occurrences of a pattern of m
+symbols, from the size of the endpos set of each state, which is
+computed by a pass over the states in decreasing order of length (a
+topological order of the suffix links, found by counting sort), where
+each state adds its count to that of its suffix link. The pass is
+repeated on the first query after the text has been extended.
+
+Time Complexity: O(1) expected amortized per symbol for extend(), O(m)
+expected for contains() and occurrences(), plus O(n) for the first
+occurrences() after extending a text of length n.
+
+Space Complexity: O(n), where the automaton has fewer than 2n states
+and 3n edges, taking 16 bytes per state, 16 per edge, and 4 to 8 per
+edge in the hash table.
+
+*/
+
+class hashed_suffix_automaton {
+  struct state_t {
+    int length, link, edges;
+    bool clone;
+  };
+
+  struct edge_t {
+    int from, symbol, target, next;
+  };
+
+  std::vector<state_t> states;
+  std::vector<edge_t> edges;
+  std::vector<int> table;  //edge indices, or -1 for empty slots
+  std::vector<int> occ;
+  int last, counted_length;
+  long long distinct;
+
+  int slot(int from, int symbol) const {
+    unsigned long long h = ((unsigned long long)from << 32) | (unsigned)symbol;
+    h *= 0x9E3779B97F4A7C15ULL;
+    int mask = table.size() - 1;
+    int i = (h >> 32) & mask;
+    while (table[i] != -1 &&
+           (edges[table[i]].from != from || edges[table[i]].symbol != symbol))
+      i = (i + 1) & mask;
+    return i;
+  }
+
+  int find(int from, int symbol) const {
+    return table[slot(from, symbol)];
+  }
+
+  void add_edge(int from, int symbol, int target) {
+    if (2 * (edges.size() + 1) > table.size()) {
+      table.assign(2 * table.size(), -1);
+      for (int e = 0; e < (int)edges.size(); e++)
+        table[slot(edges[e].from, edges[e].symbol)] = e;
+    }
+    edge_t e = {from, symbol, target, states[from].edges};
+    states[from].edges = edges.size();
+    table[slot(from, symbol)] = edges.size();
+    edges.push_back(e);
+  }
+
+  int add_state(int length, int link, bool clone) {
+    state_t s = {length, link, -1, clone};
+    states.push_back(s);
+    return states.size() - 1;
+  }
+
+  void count_occurrences() {
+    int n = states[last].length, size = states.size();
+    std::vector<int> bucket(n + 2, 0), order(size);
+    for (int v = 0; v < size; v++) bucket[states[v].length + 1]++;
+    for (int l = 1; l <= n + 1; l++) bucket[l] += bucket[l - 1];
+    for (int v = 0; v < size; v++) order[bucket[states[v].length]++] = v;
+    occ.resize(size);
+    for (int v = 0; v < size; v++) occ[v] = states[v].clone ? 0 : 1;
+    for (int i = size - 1; i > 0; i--)
+      occ[states[order[i]].link] += occ[order[i]];
+    counted_length = n;
+  }
+
+  //the state reached by a pattern from the root, or -1 if none
+  int walk(const int * p, int m) const {
+    int v = 0;
+    for (int i = 0; i < m && v != -1; i++) {
+      int e = find(v, p[i]);
+      v = (e == -1) ? -1 : edges[e].target;
+    }
+    return v;
+  }
+
+ public:
+  hashed_suffix_automaton(): table(16, -1), last(0), counted_length(-1),
+                             distinct(0) {
+    add_state(0, -1, false);
+  }
+
+  void extend(int c) {
+    int cur = add_state(states[last].length + 1, 0, false), p = last, e;
+    while (p != -1 && (e = find(p, c)) == -1) {
+      add_edge(p, c, cur);
+      p = states[p].link;
+    }
+    if (p != -1) {
+      int q = edges[e].target;
+      if (states[p].length + 1 == states[q].length) {
+        states[cur].link = q;
+      } else {
+        int clone = add_state(states[p].length + 1, states[q].link, true);
+        for (int f = states[q].edges; f != -1; f = edges[f].next)
+          add_edge(clone, edges[f].symbol, edges[f].target);
+        while (p != -1 && (e = find(p, c)) != -1 && edges[e].target == q) {
+          edges[e].target = clone;
+          p = states[p].link;
+        }
+        states[q].link = states[cur].link = clone;
+      }
+    }
+    distinct += states[cur].length - states[states[cur].link].length;
+    last = cur;
+  }
+
+  void extend(const int * s, int n) {
+    for (int i = 0; i < n; i++) extend(s[i]);
+  }
+
+  void extend(const std::vector<int> & s) {
+    for (int i = 0; i < (int)s.size(); i++) extend(s[i]);
+  }
+
+  int length() const { return states[last].length; }
+  long long distinct_substrings() const { return distinct; }
+
+  bool contains(const int * p, int m) const { return walk(p, m) != -1; }
+
+  //the empty pattern occurs at each of the length() + 1 positions
+  int occurrences(const int * p, int m) {
+    int v = walk(p, m);
+    if (v == -1) return 0;
+    if (counted_length != length()) count_occurrences();
+    return occ[v];
+  }
+};
+
 /*** Example Usage ***/
 
 #include <algorithm>
@@ -155,5 +315,17 @@ int main() {
     suffix_automaton sa("bbbabca");
     assert(sa.longest_common_substring("aababcd") == "babc");
   }
+  {
+    //token ids of "to be or not to be", streamed in two chunks
+    int s1[] = {40000, 7, 512}, s2[] = {3, 40000, 7};
+    int to_be[] = {40000, 7}, be_to[] = {7, 40000};
+    hashed_suffix_automaton sa;
+    sa.extend(s1, 3);
+    assert(sa.distinct_substrings() == 6 && sa.occurrences(to_be, 2) == 1);
+    sa.extend(s2, 3);
+    assert(sa.length() == 6 && sa.distinct_substrings() == 18);
+    assert(sa.occurrences(to_be, 2) == 2 && sa.occurrences(to_be, 1) == 2);
+    assert(!sa.contains(be_to, 2) && sa.occurrences(to_be, 0) == 7);
+  }
   return 0;
 }
@@ -0,0 +1,415 @@
+/*
+
+Benchmark harness for the string algorithms of this section on large
+synthetic texts. As in section 2.9.1, each implementation is compiled straight
+from its own file, which is included into a namespace of its own so that the
+globals and example main() of different files do not clash. Every standard
+header used by the included files is included beforehand, so that their
+include guards keep them out of the namespaces.
+
+The texts have 2^s bytes, for s given as the first program argument (20 by
+default), generated by:
+
+- random: independent uniform letters from 'a' to 'z'.
+- dna: the letters A, C, G and T, where at each step a segment of 100 to 5000
+  earlier bases is copied with 1% of its bases mutated (with probability 1/4),
+  or else 100 uniform bases are appended, so that the text has the long
+  approximate repeats of a genome.
+- natural: words separated by spaces, drawn from a vocabulary of 20000 random
+  words of 2 to 12 letters with Zipfian frequencies (the k-th most frequent
+  word having a probability proportional to 1/k), as in natural language.
+
+For each text, a Zipfian pattern set is generated: 4000 substrings of 6 to 16
+bytes are taken at random positions as candidates, and 1000 patterns are drawn
+from them with probabilities proportional to 1/k for the k-th candidate, so
+that the set has duplicates, as in a stream of queries.
+
+On each text, the harness times the KMP searches of section 6.3.1 for the 16
+most frequent patterns, the Aho-Corasick automaton of section 6.3.2 over the
+whole pattern set, the Z function and smallest period of section 6.3.3, the
+suffix arrays of sections 6.5.2, 6.5.3 and 6.5.4 with the LCP array of the
+latter, the FM-index of section 6.5.5 for counting the whole pattern set, and
+the edit distances of section 6.4.3 between the 64-byte prefix of the text and
+every 64-byte block of it, by the bit-parallel myers_pattern with and without a
+bound of 8, and by the banded and full DPs on the first 2^12 blocks.
+
+The results are printed as a JSON array with one object per run, holding the
+number of bytes of text processed, the running time in seconds, in nanoseconds
+per byte and in megabytes per second, the peak resident memory of the process
+as in section 2.9.1 (an upper bound for any single run), and a result (such as
+the number of matches) to check that different implementations agree.
+
+*/
+
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __unix__
+#include <sys/resource.h>  // getrusage()
+#endif
+
+namespace kmp_6_3_1 {
+#include "6.3.1 String Searching (KMP).cpp"
+}
+namespace aho_corasick_6_3_2 {
+#include "6.3.2 String Searching (Aho-Corasick).cpp"
+}
+namespace z_6_3_3 {
+#include "6.3.3 String Searching (Z Algorithm).cpp"
+}
+namespace edit_6_4_3 {
+#include "6.4.3 Edit Distance.cpp"
+}
+namespace prefix_doubling_6_5_2 {
+#include "6.5.2 Suffix and LCP Array (N log N).cpp"
+}
+namespace dc3_6_5_3 {
+#include "6.5.3 Suffix and LCP Array (Linear DC3).cpp"
+}
+namespace sais_6_5_4 {
+#include "6.5.4 Suffix and LCP Array (Linear SA-IS).cpp"
+}
+namespace fm_index_6_5_5 {
+#include "6.5.5 FM-Index.cpp"
+}
+
+// SplitMix64, so that the inputs do not depend on the platform's rand().
+class splitmix64 {
+  unsigned long long state;
+
+ public:
+  splitmix64(unsigned long long seed) : state(seed) {}
+
+  unsigned long long next() {
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  // Returns a uniformly random integer in [0, n).
+  int below(int n) {
+    return (int)(next() % (unsigned long long)n);
+  }
+
+  double uniform() {
+    return (next() >> 11)*(1.0/9007199254740992.0);
+  }
+};
+
+// Draws ranks in [0, n) with probabilities proportional to 1/(rank + 1).
+class zipf_sampler {
+  std::vector<double> cdf;
+
+ public:
+  explicit zipf_sampler(int n) : cdf(n) {
+    double sum = 0;
+    for (int k = 0; k < n; k++) {
+      cdf[k] = (sum += 1.0/(k + 1));
+    }
+    for (int k = 0; k < n; k++) {
+      cdf[k] /= sum;
+    }
+  }
+
+  int sample(splitmix64 &rng) const {
+    int k = std::lower_bound(cdf.begin(), cdf.end(), rng.uniform()) -
+            cdf.begin();
+    return std::min(k, (int)cdf.size() - 1);
+  }
+};
+
+struct input_text {
+  std::string name, text;
+  std::vector<std::string> patterns;
+};
+
+input_text random_text(int n, splitmix64 &rng) {
+  input_text t;
+  t.name = "random";
+  for (int i = 0; i < n; i++) {
+    t.text += (char)('a' + rng.below(26));
+  }
+  return t;
+}
+
+input_text dna_text(int n, splitmix64 &rng) {
+  static const char BASES[] = "ACGT";
+  input_text t;
+  t.name = "dna";
+  while ((int)t.text.size() < n) {
+    int len = 100 + rng.below(4901);
+    if (rng.below(4) == 0 && (int)t.text.size() > len) {
+      int from = rng.below(t.text.size() - len);
+      for (int i = 0; i < len; i++) {
+        char c = t.text[from + i];
+        t.text += (rng.below(100) == 0) ? BASES[rng.below(4)] : c;
+      }
+    } else {
+      for (int i = 0; i < 100; i++) {
+        t.text += BASES[rng.below(4)];
+      }
+    }
+  }
+  t.text.resize(n);
+  return t;
+}
+
+input_text natural_text(int n, splitmix64 &rng) {
+  static const int WORDS = 20000;
+  input_text t;
+  t.name = "natural";
+  std::vector<std::string> vocabulary(WORDS);
+  for (int i = 0; i < WORDS; i++) {
+    int len = 2 + rng.below(11);
+    for (int j = 0; j < len; j++) {
+      vocabulary[i] += (char)('a' + rng.below(26));
+    }
+  }
+  zipf_sampler zipf(WORDS);
+  while ((int)t.text.size() < n) {
+    t.text += vocabulary[zipf.sample(rng)];
+    t.text += ' ';
+  }
+  t.text.resize(n);
+  return t;
+}
+
+void add_patterns(input_text &t, splitmix64 &rng) {
+  static const int CANDIDATES = 4000, PATTERNS = 1000;
+  std::vector<std::string> candidates;
+  for (int i = 0; i < CANDIDATES; i++) {
+    int len = 6 + rng.below(11);
+    candidates.push_back(t.text.substr(rng.below(t.text.size() - len), len));
+  }
+  zipf_sampler zipf(CANDIDATES);
+  for (int i = 0; i < PATTERNS; i++) {
+    t.patterns.push_back(candidates[zipf.sample(rng)]);
+  }
+}
+
+long long peak_memory_kb() {
+#ifdef __unix__
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return usage.ru_maxrss;
+  }
+#endif
+  return -1;
+}
+
+double seconds_since(std::clock_t start) {
+  return (double)(std::clock() - start)/CLOCKS_PER_SEC;
+}
+
+bool first_row = true;
+
+void report(const input_text &t, const char *algorithm, long long bytes,
+            double run, long long result) {
+  std::cout << (first_row ? "" : ",\n");
+  std::cout << "{\"suite\": \"strings\", \"input\": \"" << t.name
+            << "\", \"algorithm\": \"" << algorithm << "\", \"bytes\": "
+            << bytes << ", \"run_seconds\": " << run
+            << ", \"ns_per_byte\": " << (bytes > 0 ? run*1e9/bytes : 0.0)
+            << ", \"mb_per_second\": " << (run > 0 ? bytes/run/1e6 : 0.0)
+            << ", \"peak_memory_kb\": " << peak_memory_kb()
+            << ", \"result\": " << result << "}";
+  first_row = false;
+}
+
+// The patterns in decreasing order of their number of draws.
+std::vector<std::string> most_frequent(const std::vector<std::string> &p,
+                                       int k) {
+  std::vector<std::string> sorted(p);
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<std::pair<int, std::string> > counts;
+  for (int i = 0, j; i < (int)sorted.size(); i = j) {
+    for (j = i; j < (int)sorted.size() && sorted[j] == sorted[i]; j++) {}
+    counts.push_back(std::make_pair(i - j, sorted[i]));
+  }
+  std::sort(counts.begin(), counts.end());
+  std::vector<std::string> res;
+  for (int i = 0; i < k && i < (int)counts.size(); i++) {
+    res.push_back(counts[i].second);
+  }
+  return res;
+}
+
+void benchmark_kmp(const input_text &t) {
+  std::vector<std::string> top = most_frequent(t.patterns, 16);
+  std::vector<long long> res;
+  long long bytes = (long long)top.size()*t.text.size();
+  std::clock_t start = std::clock();
+  for (int i = 0; i < (int)top.size(); i++) {
+    kmp_6_3_1::search_pattern(top[i]).find_all(t.text, res);
+  }
+  report(t, "search_pattern::find_all", bytes, seconds_since(start),
+         res.size());
+  long long found = 0;
+  start = std::clock();
+  for (int i = 0; i < (int)top.size(); i++) {
+    found += kmp_6_3_1::find(t.text, top[i]) >= 0;
+  }
+  report(t, "find", bytes, seconds_since(start), found);
+}
+
+struct count_matches {
+  long long *count;
+
+  count_matches(long long *count) : count(count) {}
+
+  void operator()(int, long long) const {
+    ++*count;
+  }
+};
+
+void benchmark_aho_corasick(const input_text &t) {
+  using namespace aho_corasick_6_3_2;
+  long long bytes = 0;
+  for (int i = 0; i < (int)t.patterns.size(); i++) {
+    bytes += t.patterns[i].size();
+  }
+  std::clock_t start = std::clock();
+  aho_corasick ac(t.patterns);
+  report(t, "aho_corasick::aho_corasick", bytes, seconds_since(start),
+         ac.states());
+  long long count = 0;
+  ac_scanner scanner(ac);
+  start = std::clock();
+  scanner.feed(t.text, count_matches(&count));
+  report(t, "ac_scanner::feed", t.text.size(), seconds_since(start), count);
+}
+
+void benchmark_z(const input_text &t) {
+  int n = t.text.size();
+  std::vector<int> buf(n);
+  std::clock_t start = std::clock();
+  z_6_3_3::z_function(t.text.data(), n, &buf[0]);
+  long long sum = 0;
+  for (int i = 0; i < n; i++) {
+    sum += buf[i];
+  }
+  report(t, "z_function", n, seconds_since(start), sum);
+  start = std::clock();
+  int period = z_6_3_3::smallest_period(t.text.data(), n, &buf[0]);
+  report(t, "smallest_period", n, seconds_since(start), period);
+}
+
+void benchmark_suffix_arrays(const input_text &t) {
+  int n = t.text.size();
+  std::clock_t start = std::clock();
+  std::vector<int> sa = prefix_doubling_6_5_2::suffix_array(t.text);
+  report(t, "suffix_array (6.5.2)", n, seconds_since(start), sa[n/2]);
+  start = std::clock();
+  sa = dc3_6_5_3::suffix_array(t.text);
+  report(t, "suffix_array (6.5.3)", n, seconds_since(start), sa[n/2]);
+  sais_6_5_4::suffix_array_builder<int> builder;
+  const unsigned char *s = (const unsigned char *)t.text.data();
+  start = std::clock();
+  builder.build(s, n, &sa[0]);
+  report(t, "suffix_array_builder::build", n, seconds_since(start), sa[n/2]);
+  std::vector<int> lcp(n - 1);
+  start = std::clock();
+  builder.lcp(s, n, &sa[0], &lcp[0]);
+  long long sum = 0;
+  for (int i = 0; i < n - 1; i++) {
+    sum += lcp[i];
+  }
+  report(t, "suffix_array_builder::lcp", n, seconds_since(start), sum);
+
+  start = std::clock();
+  fm_index_6_5_5::fm_index fm(t.text, sa);
+  report(t, "fm_index::fm_index", n, seconds_since(start), fm.size()*8);
+  long long bytes = 0, count = 0;
+  for (int i = 0; i < (int)t.patterns.size(); i++) {
+    bytes += t.patterns[i].size();
+  }
+  start = std::clock();
+  for (int i = 0; i < (int)t.patterns.size(); i++) {
+    count += fm.count(t.patterns[i]);
+  }
+  report(t, "fm_index::count", bytes, seconds_since(start), count);
+}
+
+void benchmark_edit_distance(const input_text &t) {
+  static const int BLOCK = 64, BOUND = 8;
+  using namespace edit_6_4_3;
+  std::string query = t.text.substr(0, BLOCK);
+  std::vector<std::string> blocks;
+  for (int i = 0; i + BLOCK <= (int)t.text.size(); i += BLOCK) {
+    blocks.push_back(t.text.substr(i, BLOCK));
+  }
+  long long bytes = (long long)blocks.size()*BLOCK;
+  myers_pattern pattern(query);
+  std::vector<int> res;
+  std::clock_t start = std::clock();
+  pattern.distance_all(blocks, -1, res);
+  long long sum = 0;
+  for (int i = 0; i < (int)res.size(); i++) {
+    sum += res[i];
+  }
+  report(t, "myers_pattern::distance_all", bytes, seconds_since(start), sum);
+  start = std::clock();
+  pattern.distance_all(blocks, BOUND, res);
+  long long close = 0;
+  for (int i = 0; i < (int)res.size(); i++) {
+    close += res[i] <= BOUND;
+  }
+  report(t, "myers_pattern::distance_all (k = 8)", bytes,
+         seconds_since(start), close);
+  int m = std::min((int)blocks.size(), 1 << 12);
+  bytes = (long long)m*BLOCK;
+  close = 0;
+  start = std::clock();
+  for (int i = 0; i < m; i++) {
+    close += edit_distance_banded(query, blocks[i], BOUND) <= BOUND;
+  }
+  report(t, "edit_distance_banded (k = 8)", bytes, seconds_since(start),
+         close);
+  sum = 0;
+  start = std::clock();
+  for (int i = 0; i < m; i++) {
+    sum += edit_distance(query, blocks[i]);
+  }
+  report(t, "edit_distance", bytes, seconds_since(start), sum);
+}
+
+/*** Example Usage ***/
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+  int scale = (argc > 1) ? atoi(argv[1]) : 20;
+  assert(scale >= 8 && scale <= 28);
+  splitmix64 rng(12345);
+  cout.precision(6);
+  cout << "[\n";
+  for (int kind = 0; kind < 3; kind++) {
+    input_text t;
+    switch (kind) {
+      case 0: t = random_text(1 << scale, rng); break;
+      case 1: t = dna_text(1 << scale, rng); break;
+      case 2: t = natural_text(1 << scale, rng); break;
+    }
+    add_patterns(t, rng);
+    benchmark_kmp(t);
+    benchmark_aho_corasick(t);
+    benchmark_z(t);
+    benchmark_suffix_arrays(t);
+    benchmark_edit_distance(t);
+  }
+  cout << "\n]" << endl;
+  return 0;
+}